@@ -0,0 +1,280 @@
+/// @file bench_analytics.cpp
+/// @brief Per-event cost of AnalyticsEngine::on_event over a steady
+///        synthetic stream, with a heap-allocation counter.
+///
+/// The book holds 60 levels per side; the stream is three quote events per
+/// trade, trades alternating aggressor side, so every rolling window is
+/// full and sliding during the timed loop. The second argument keeps the
+/// depth profile from level deltas (AnalyticsConfig::depth_from_level_updates)
+/// instead of a book walk per event: one quote event in three is then a
+/// LevelUpdate changing a level near the touch. The `allocs_per_event` counter
+/// counts operator new calls made inside the loop (expected: 0).
+///
+/// BM_MultiInstrumentAnalytics feeds the same stream, spread over 256
+/// instruments, through MultiInstrumentAnalytics with 0 (serial) to 8
+/// worker threads, including the final drain (finish()).
+///
+/// BM_AnalyticsSampled is the depth-50 scan case with the depth profile
+/// and price impact sampled every Nth event (AnalyticsConfig::*_sampling;
+/// trades still reach the impact regression).
+///
+/// BM_BatchQuoteKernels and BM_BatchTickVolatility time the column kernels
+/// of batch_analytics.h over 1M synthetic rows on 1 to 4 threads, for
+/// comparison with the per-event cost above.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_counters.h"
+#include "analytics/analytics_config.h"
+#include "analytics/analytics_engine.h"
+#include "analytics/batch_analytics.h"
+#include "core/order.h"
+#include "analytics/multi_instrument_analytics.h"
+#include "core/types.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
+#include "transport/message.h"
+
+using namespace hft;
+
+// ---------------------------------------------------------------------------
+// Allocation counter
+// ---------------------------------------------------------------------------
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+// Inputs
+// ---------------------------------------------------------------------------
+
+static constexpr Price MID = 50'000 * PRICE_SCALE;
+static constexpr Price TICK = PRICE_SCALE;
+static constexpr size_t STREAM_EVENTS = 1 << 16;  // Power of two (index mask)
+static constexpr size_t TIMED_EVENTS = 1 << 20;
+
+static void fill_book(OrderBook& book, MemoryPool<Order>& pool) {
+    OrderId id = 1;
+    for (int i = 1; i <= 60; ++i) {
+        for (Side side : {Side::Buy, Side::Sell}) {
+            Order* o = pool.allocate();
+            *o = Order{};
+            o->order_id = id++;
+            o->side = side;
+            o->type = OrderType::Limit;
+            o->time_in_force = TimeInForce::GTC;
+            o->price = (side == Side::Buy) ? MID - i * TICK : MID + i * TICK;
+            o->quantity = 100 + static_cast<Quantity>(i);
+            o->visible_quantity = o->quantity;
+            book.add_order(o);
+        }
+    }
+}
+
+static std::vector<EventMessage> make_stream(size_t events, bool level_updates) {
+    std::vector<EventMessage> stream(events);
+    for (size_t i = 0; i < events; ++i) {
+        EventMessage& e = stream[i];
+        e = EventMessage{};
+        e.sequence_num = i + 1;
+        const Timestamp ts = 1'000'000'000 + i * 1000;
+        if (i % 4 == 3) {
+            e.type = EventType::Trade;
+            Trade t{};
+            t.trade_id = i / 4 + 1;
+            t.flags = TRADE_AGGRESSOR;
+            t.aggressor_side = (i / 4) % 2 ? Side::Sell : Side::Buy;
+            t.price = (t.aggressor_side == Side::Buy) ? MID + TICK : MID - TICK;
+            t.quantity = 1 + i % 7;
+            t.timestamp = ts;
+            set_trade(e, t);
+        } else if (level_updates && i % 4 == 1) {
+            e.type = EventType::LevelUpdate;
+            LevelUpdateEventData& l = e.data.level_update;
+            l.side = static_cast<uint8_t>((i / 4) % 2);
+            const Price offset = static_cast<Price>(1 + i % 5) * TICK;
+            l.price = l.side == 0 ? MID - offset : MID + offset;
+            l.total_quantity = 100 + i % 13;
+            l.order_count = 1;
+        } else {
+            e.type = EventType::OrderAccepted;
+            e.data.order_event.order_id = i + 1000;
+            e.data.order_event.status = OrderStatus::Accepted;
+            e.data.order_event.price = MID + static_cast<Price>(i % 5) * TICK;
+            e.data.order_event.timestamp = ts;
+        }
+    }
+    return stream;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+static void BM_AnalyticsOnEvent(benchmark::State& state) {
+    OrderBook book(MID - 1000 * TICK, MID + 1000 * TICK, TICK, 1024);
+    MemoryPool<Order> pool(1024);
+    fill_book(book, pool);
+    const std::vector<EventMessage> stream = make_stream(STREAM_EVENTS, state.range(1) != 0);
+
+    AnalyticsConfig config;
+    config.depth_max_levels = static_cast<size_t>(state.range(0));
+    config.depth_from_level_updates = state.range(1) != 0;
+    // One row per trade is output, not window state: reserve the run's rows
+    config.time_series_reserve = (STREAM_EVENTS + TIMED_EVENTS) / 4 + 1;
+    AnalyticsEngine engine(book, config);
+    for (const EventMessage& e : stream) engine.on_event(e);  // Fill the windows
+
+    size_t i = 0;
+    uint64_t events = 0;
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        engine.on_event(stream[i]);
+        i = (i + 1) & (stream.size() - 1);
+        ++events;
+    }
+    const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+    state.counters["allocs_per_event"] =
+        benchmark::Counter(static_cast<double>(allocations) / static_cast<double>(events));
+}
+BENCHMARK(BM_AnalyticsOnEvent)
+    ->ArgNames({"levels", "level_updates"})
+    ->ArgsProduct({{5, 10, 20, 50}, {0, 1}})
+    ->Iterations(TIMED_EVENTS);
+
+static void BM_AnalyticsSampled(benchmark::State& state) {
+    OrderBook book(MID - 1000 * TICK, MID + 1000 * TICK, TICK, 1024);
+    MemoryPool<Order> pool(1024);
+    fill_book(book, pool);
+    const std::vector<EventMessage> stream = make_stream(STREAM_EVENTS, false);
+
+    AnalyticsConfig config;
+    config.depth_max_levels = 50;
+    const SampleConfig sampling{SampleTrigger::EveryNth, static_cast<uint64_t>(state.range(0)), true};
+    config.depth_sampling = sampling;
+    config.impact_sampling = sampling;
+    config.time_series_reserve = (STREAM_EVENTS + TIMED_EVENTS) / 4 + 1;
+    AnalyticsEngine engine(book, config);
+    for (const EventMessage& e : stream) engine.on_event(e);
+
+    size_t i = 0;
+    uint64_t events = 0;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        engine.on_event(stream[i]);
+        i = (i + 1) & (stream.size() - 1);
+        ++events;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+BENCHMARK(BM_AnalyticsSampled)
+    ->ArgName("every")
+    ->Arg(1)->Arg(4)->Arg(16)
+    ->Iterations(TIMED_EVENTS);
+
+static void BM_MultiInstrumentAnalytics(benchmark::State& state) {
+    constexpr InstrumentId INSTRUMENTS = 256;
+    InstrumentRegistry registry;
+    for (InstrumentId id = 0; id < INSTRUMENTS; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = "SYM" + std::to_string(id);
+        cfg.min_price = MID - 100 * TICK;
+        cfg.max_price = MID + 100 * TICK;
+        cfg.tick_size = TICK;
+        cfg.max_orders = 64;
+        (void)registry.register_instrument(cfg);
+    }
+    InstrumentRouter router(registry, nullptr);
+
+    std::vector<EventMessage> stream = make_stream(STREAM_EVENTS, false);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        stream[i].instrument_id = static_cast<InstrumentId>((i / 4) % INSTRUMENTS);
+    }
+
+    const auto workers = static_cast<size_t>(state.range(0));
+    uint64_t events = 0;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        counters.pause();
+        auto analytics = std::make_unique<MultiInstrumentAnalytics>(router, AnalyticsConfig{},
+                                                                    workers);
+        counters.resume();
+        for (const EventMessage& e : stream) analytics->on_event(e);
+        analytics->finish();
+        events += stream.size();
+        counters.pause();
+        analytics.reset();
+        counters.resume();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+BENCHMARK(BM_MultiInstrumentAnalytics)
+    ->ArgName("workers")
+    ->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_BatchQuoteKernels(benchmark::State& state) {
+    constexpr size_t ROWS = 1 << 20;
+    std::vector<Price> bid(ROWS), ask(ROWS);
+    std::vector<Quantity> bid_qty(ROWS), ask_qty(ROWS);
+    for (size_t i = 0; i < ROWS; ++i) {
+        bid[i] = MID - static_cast<Price>(1 + i % 3) * TICK;
+        ask[i] = MID + static_cast<Price>(1 + i % 5) * TICK;
+        bid_qty[i] = 1 + i % 97;
+        ask_qty[i] = (i % 1000 == 0) ? 0 : 1 + i % 89;
+    }
+    const QuoteColumns quotes{bid.data(), bid_qty.data(), ask.data(), ask_qty.data(), ROWS};
+    BatchOptions options;
+    options.threads = static_cast<size_t>(state.range(0));
+    std::vector<double> spread(ROWS), micro(ROWS);
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        batch_spread_bps(quotes, spread.data(), options);
+        batch_microprice(quotes, micro.data(), options);
+        benchmark::DoNotOptimize(spread.data());
+        benchmark::DoNotOptimize(micro.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ROWS));
+    state.SetLabel(batch_kernel_isa());
+}
+BENCHMARK(BM_BatchQuoteKernels)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+static void BM_BatchTickVolatility(benchmark::State& state) {
+    constexpr size_t ROWS = 1 << 20;
+    std::vector<Price> price(ROWS);
+    for (size_t i = 0; i < ROWS; ++i) {
+        price[i] = MID + static_cast<Price>((i * 7919) % 21) * TICK - 10 * TICK;
+    }
+    BatchOptions options;
+    options.threads = static_cast<size_t>(state.range(0));
+    std::vector<double> out(ROWS);
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        batch_tick_volatility(price.data(), ROWS, 50, out.data(), options);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ROWS));
+}
+BENCHMARK(BM_BatchTickVolatility)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,70 @@
+#pragma once
+
+/// @file bench_counters.h
+/// @brief Hardware counters as Google Benchmark user counters.
+///
+/// Declare a ScopedBenchCounters before the `for (auto _ : state)` loop:
+/// it counts the loop and, when it goes out of scope, adds cycles / IPC /
+/// instructions / branch, L1D, LLC and dTLB misses per iteration to the
+/// benchmark's counters. Use its pause() / resume() in place of
+/// state.PauseTiming() / ResumeTiming() so untimed setup is not counted
+/// either. Without perf_event_open (see utils/perf_counters.h) nothing is
+/// added, and the reason is printed once.
+
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+
+#include "utils/perf_counters.h"
+
+namespace hft {
+
+class ScopedBenchCounters {
+public:
+    explicit ScopedBenchCounters(benchmark::State& state) : state_(state) {
+        if (group().available()) group().start();
+    }
+
+    ~ScopedBenchCounters() {
+        if (!group().available()) return;
+        const PerfSample sample = group().stop();
+        const auto per_iteration = benchmark::Counter::kAvgIterations;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            const auto event = static_cast<PerfEvent>(i);
+            if (!sample.has(event)) continue;
+            state_.counters[perf_event_name(event)] =
+                benchmark::Counter(static_cast<double>(sample[event]), per_iteration);
+        }
+        if (sample.ipc() > 0.0) state_.counters["IPC"] = sample.ipc();
+    }
+
+    ScopedBenchCounters(const ScopedBenchCounters&) = delete;
+    ScopedBenchCounters& operator=(const ScopedBenchCounters&) = delete;
+
+    void pause() {
+        state_.PauseTiming();
+        if (group().available()) group().pause();
+    }
+    void resume() {
+        if (group().available()) group().resume();
+        state_.ResumeTiming();
+    }
+
+private:
+    /// One set of counters for the (single-threaded) benchmark process.
+    static PerfCounterGroup& group() {
+        static PerfCounterGroup counters;
+        static const bool reported = [] {
+            if (!counters.error().empty()) {
+                std::cerr << "Hardware counters: " << counters.error() << "\n";
+            }
+            return true;
+        }();
+        (void)reported;
+        return counters;
+    }
+
+    benchmark::State& state_;
+};
+
+}  // namespace hft
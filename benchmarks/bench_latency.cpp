@@ -1,7 +1,9 @@
 /// @file bench_latency.cpp
 /// @brief Custom percentile latency harness for HFT order book engine.
 ///
-/// Measures per-operation latency using rdtsc and reports p50/p90/p99/p99.9/max.
+/// Measures per-operation latency using rdtsc and reports p50/p90/p99/p99.9/max,
+/// with hardware counters per operation over each measurement loop where
+/// perf_event_open is available (utils/perf_counters.h).
 /// Standalone executable — does NOT use Google Benchmark.
 
 #include <algorithm>
@@ -21,6 +23,7 @@
 
 #include "core/order.h"
 #include "core/types.h"
+#include "gateway/pre_trade_risk.h"
 #include "matching/matching_engine.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
@@ -28,6 +31,8 @@
 #include "transport/spsc_ring_buffer.h"
 #include "utils/clock.h"
 #include "utils/latency_histogram.h"
+#include "utils/perf_counters.h"
+#include "utils/thread_placement.h"
 
 using namespace hft;
 
@@ -145,7 +150,39 @@ static void print_stats(const char* name, const LatencyStats& stats,
 }
 
 // ---------------------------------------------------------------------------
-// Pin thread and elevate priority (Windows)
+// Hardware counters around each measurement loop
+// ---------------------------------------------------------------------------
+
+// Opened in main(); counts include the loop's rdtsc and histogram work
+static PerfCounterGroup* g_counters = nullptr;
+
+static void start_counters() {
+    if (g_counters && g_counters->available()) g_counters->start();
+}
+
+static PerfSample stop_counters() {
+    return g_counters && g_counters->available() ? g_counters->stop() : PerfSample{};
+}
+
+static void print_counters(const PerfSample& sample, size_t ops) {
+    if (sample.empty()) return;
+    std::cout << "  per op : " << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        const auto event = static_cast<PerfEvent>(i);
+        if (!sample.has(event)) continue;
+        if (event == PerfEvent::Cycles || event == PerfEvent::Instructions) {
+            std::cout << std::setprecision(1);
+        } else {
+            std::cout << std::setprecision(3);
+        }
+        std::cout << perf_event_name(event) << " " << sample.per_op(event, ops) << "  ";
+    }
+    if (sample.ipc() > 0.0) std::cout << "IPC " << std::setprecision(2) << sample.ipc();
+    std::cout << "\n";
+}
+
+// ---------------------------------------------------------------------------
+// Pin thread (and elevate priority on Windows)
 // ---------------------------------------------------------------------------
 
 static void setup_thread_affinity() {
@@ -154,7 +191,11 @@ static void setup_thread_affinity() {
     SetThreadAffinityMask(GetCurrentThread(), 1);  // Pin to core 0
     std::cout << "Thread pinned to core 0, process priority elevated.\n";
 #else
-    std::cout << "Thread affinity: not configured (non-Windows).\n";
+    // Pinned to core 0 until exit
+    ThreadingConfig threading;
+    threading.matching_cpus = {0};
+    static ScopedThreadPlacement placement(threading, ThreadRole::Matching);
+    std::cout << "Thread placement:\n" << thread_topology_report();
 #endif
 }
 
@@ -191,6 +232,7 @@ static void bench_add_order_no_match(size_t iterations, double tsc_freq) {
     next_id = 1;
 
     // Measurement
+    start_counters();
     for (size_t i = 0; i < iterations; ++i) {
         Price px = MID - 100 * TICK + static_cast<Price>(next_id % 200) * TICK;
         Side side = (px < MID) ? Side::Buy : Side::Sell;
@@ -214,8 +256,10 @@ static void bench_add_order_no_match(size_t iterations, double tsc_freq) {
         }
     }
 
+    const PerfSample counters = stop_counters();
     auto stats = hist.compute();
     print_stats("AddOrder_NoMatch", stats, 100.0, 500.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -256,6 +300,7 @@ static void bench_cancel_order(size_t iterations, double tsc_freq) {
     }
 
     // Measurement
+    start_counters();
     for (size_t i = 0; i < iterations; ++i) {
         uint64_t t0 = rdtsc_start();
         auto cr = book.cancel_order(cancel_id);
@@ -276,8 +321,10 @@ static void bench_cancel_order(size_t iterations, double tsc_freq) {
         ++cancel_id;
     }
 
+    const PerfSample counters = stop_counters();
     auto stats = hist.compute();
     print_stats("CancelOrder", stats, 50.0, 200.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -308,6 +355,7 @@ static void bench_match_single_level(size_t iterations, double tsc_freq) {
     }
 
     // Measurement
+    start_counters();
     for (size_t i = 0; i < iterations; ++i) {
         Order* sell = pool.allocate();
         *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 100);
@@ -324,8 +372,10 @@ static void bench_match_single_level(size_t iterations, double tsc_freq) {
         hist.record(t1 - t0);
     }
 
+    const PerfSample counters = stop_counters();
     auto stats = hist.compute();
     print_stats("Match_SingleLevel", stats, 200.0, 1000.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -359,6 +409,7 @@ static void bench_match_multi_level(size_t iterations, double tsc_freq) {
     }
 
     // Measurement
+    start_counters();
     for (size_t i = 0; i < iterations; ++i) {
         for (int j = 0; j < 5; ++j) {
             Order* sell = pool.allocate();
@@ -379,8 +430,10 @@ static void bench_match_multi_level(size_t iterations, double tsc_freq) {
         hist.record(t1 - t0);
     }
 
+    const PerfSample counters = stop_counters();
     auto stats = hist.compute();
     print_stats("Match_MultiLevel", stats, 500.0, 2000.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -402,6 +455,7 @@ static void bench_spsc_push_pop(size_t iterations, double tsc_freq) {
     }
 
     // Measurement
+    start_counters();
     for (size_t i = 0; i < iterations; ++i) {
         uint64_t t0 = rdtsc_start();
         (void)rb.try_push(val);
@@ -412,8 +466,10 @@ static void bench_spsc_push_pop(size_t iterations, double tsc_freq) {
         hist.record(t1 - t0);
     }
 
+    const PerfSample counters = stop_counters();
     auto stats = hist.compute();
     print_stats("SPSC_PushPop", stats, 20.0, 50.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -448,6 +504,7 @@ static void bench_throughput_sustained(size_t iterations, double /*tsc_freq*/) {
         return rng;
     };
 
+    start_counters();
     auto start = std::chrono::steady_clock::now();
 
     size_t completed = 0;
@@ -484,6 +541,7 @@ static void bench_throughput_sustained(size_t iterations, double /*tsc_freq*/) {
     }
 
     auto end = std::chrono::steady_clock::now();
+    const PerfSample counters = stop_counters();
     double elapsed_ns = static_cast<double>(
         std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
     double msgs_per_sec = static_cast<double>(completed) / (elapsed_ns / 1e9);
@@ -498,6 +556,49 @@ static void bench_throughput_sustained(size_t iterations, double /*tsc_freq*/) {
     else
         std::cout << "    [TARGET: > 5M msgs/s]  MISS";
     std::cout << "\n";
+    print_counters(counters, completed);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark 7: Pre-trade risk check (all limits enabled, order passes)
+// ---------------------------------------------------------------------------
+
+static void bench_pre_trade_risk_check(size_t iterations, double tsc_freq) {
+    RiskConfig config;
+    config.limits.max_order_quantity = 10'000;
+    config.limits.max_order_notional = 1'000'000'000;
+    config.limits.price_band_bps = 500;
+    config.limits.max_open_orders = 1'000'000;
+    config.limits.max_position = 1'000'000;
+    config.max_participants = 1024;
+    PreTradeRisk risk(config);
+    LatencyHistogram hist(iterations);
+    hist.set_tsc_frequency(tsc_freq);
+    hist.set_overhead(g_rdtsc_overhead);
+
+    // Spread the checks over many accounts so they are not all L1-hot
+    Order order = make_order(1, Side::Buy, OrderType::Limit, MID - 10 * TICK, 100);
+    for (size_t i = 0; i < 10'000; ++i) {
+        order.participant_id = static_cast<ParticipantId>(i % 1024);
+        do_not_optimize(risk.check(order, MID));
+    }
+
+    start_counters();
+    for (size_t i = 0; i < iterations; ++i) {
+        order.participant_id = static_cast<ParticipantId>((i * 617) % 1024);
+        order.side = (i & 1) ? Side::Buy : Side::Sell;
+        uint64_t t0 = rdtsc_start();
+        RiskReject reason = risk.check(order, MID);
+        uint64_t t1 = rdtsc_end();
+
+        do_not_optimize(reason);
+        hist.record(t1 - t0);
+    }
+
+    const PerfSample counters = stop_counters();
+    auto stats = hist.compute();
+    print_stats("PreTradeRiskCheck", stats, 20.0, 50.0);
+    print_counters(counters, iterations);
 }
 
 // ---------------------------------------------------------------------------
@@ -537,12 +638,20 @@ int main(int argc, char* argv[]) {
               << static_cast<double>(g_rdtsc_overhead) / tsc_freq << " ns)\n";
     std::cout << "Iterations per benchmark: " << iterations << "\n";
 
+    PerfCounterGroup counters;
+    g_counters = &counters;
+    if (counters.available()) {
+        std::cout << "Hardware counters: on (per op over each measurement loop)\n";
+    }
+    if (!counters.error().empty()) std::cout << "Hardware counters: " << counters.error() << "\n";
+
     // Latency benchmarks (smaller iteration count for multi-level to avoid
     // pool exhaustion — each iteration allocates 6 orders)
     size_t multi_iters = iterations < 150'000 ? iterations : 150'000;
 
     bench_add_order_no_match(iterations, tsc_freq);
     bench_cancel_order(iterations, tsc_freq);
+    bench_pre_trade_risk_check(iterations, tsc_freq);
     bench_match_single_level(iterations, tsc_freq);
     bench_match_multi_level(multi_iters, tsc_freq);
     bench_spsc_push_pop(iterations, tsc_freq);
@@ -1,7 +1,13 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "bench_counters.h"
 #include "core/order.h"
 #include "core/types.h"
+#include "matching/match_result.h"
 #include "matching/matching_engine.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
@@ -39,10 +45,10 @@ static Order make_order(OrderId id, Side side, OrderType type,
 }
 
 // ---------------------------------------------------------------------------
-// Helper: place a sentinel order on the ask side so that
-// update_best_ask_after_remove terminates in 1 step instead of
-// scanning ~1M empty levels to the end of the flat array.
-// This isolates the matching cost from O(N) best-price scan overhead.
+// Helper: place a sentinel order on the ask side so the book never goes
+// one-sided. Originally this kept update_best_ask_after_remove from
+// scanning ~1M empty levels; with the occupancy bitmap that scan is cheap,
+// and the sentinel keeps results comparable with earlier runs.
 // ---------------------------------------------------------------------------
 
 static constexpr OrderId SENTINEL_ID = UINT64_MAX;
@@ -79,6 +85,7 @@ static void BM_LimitMatch_SingleLevel(benchmark::State& state) {
     place_ask_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Place a resting sell
         Order* sell = pool.allocate();
@@ -106,6 +113,7 @@ static void BM_LimitMatch_MultiLevel(benchmark::State& state) {
     place_ask_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Place 5 resting sells at increasing prices
         for (int i = 0; i < 5; ++i) {
@@ -125,6 +133,99 @@ static void BM_LimitMatch_MultiLevel(benchmark::State& state) {
 }
 BENCHMARK(BM_LimitMatch_MultiLevel)->MinTime(1.0);
 
+// ---------------------------------------------------------------------------
+// BM_LimitMatch_DeepQueue — aggressive IOC eats 64 resting orders from the
+// head of a 64k-deep queue. The head was enqueued long ago, so each
+// resting order is a cache miss: the cost is dominated by how many lines
+// the walk touches per resting order.
+// ---------------------------------------------------------------------------
+
+static void BM_LimitMatch_DeepQueue(benchmark::State& state) {
+    constexpr size_t DEPTH = 65'536;
+    constexpr Quantity EAT = 64;
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    place_ask_sentinel(book, pool);
+
+    OrderId next_id = 1;
+    for (size_t i = 0; i < DEPTH; ++i) {
+        Order* sell = pool.allocate();
+        *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 1);
+        book.add_order(sell);
+    }
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::IOC, MID, EAT);
+        auto result = engine.submit_order(buy);
+        benchmark::DoNotOptimize(result);
+
+        // Refill the tail so the queue depth stays constant
+        counters.pause();
+        for (Quantity i = 0; i < EAT; ++i) {
+            Order* sell = pool.allocate();
+            *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 1);
+            book.add_order(sell);
+        }
+        counters.resume();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EAT));
+}
+BENCHMARK(BM_LimitMatch_DeepQueue)->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_Sweep64 — IOC takes 64 one-lot orders. Arg 0 returns the trades in a
+// MatchResult (3 KB returned by value, read back by the caller); arg 1
+// streams each trade into a TradeSink.
+// ---------------------------------------------------------------------------
+
+static void BM_Sweep64(benchmark::State& state) {
+    constexpr Quantity EAT = 64;
+    const bool streaming = state.range(0) != 0;
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    place_ask_sentinel(book, pool);
+
+    Quantity traded = 0;
+    auto on_trade = [&traded](const Trade& trade) noexcept {
+        traded += trade.quantity;
+    };
+    const TradeSink sink = make_trade_sink(on_trade);
+
+    OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        counters.pause();
+        for (Quantity i = 0; i < EAT; ++i) {
+            Order* sell = pool.allocate();
+            *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 1);
+            book.add_order(sell);
+        }
+        counters.resume();
+
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::IOC, MID, EAT);
+        if (streaming) {
+            auto summary = engine.submit_order(buy, sink);
+            benchmark::DoNotOptimize(summary);
+        } else {
+            auto result = engine.submit_order(buy);
+            for (uint32_t i = 0; i < result.trade_count; ++i) {
+                traded += result.trades[i].quantity;
+            }
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    benchmark::DoNotOptimize(traded);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EAT));
+}
+BENCHMARK(BM_Sweep64)->Arg(0)->Arg(1)->MinTime(1.0);
+
 // ---------------------------------------------------------------------------
 // BM_LimitNoMatch_Rest — submit order that doesn't cross (baseline)
 // ---------------------------------------------------------------------------
@@ -143,6 +244,7 @@ static void BM_LimitNoMatch_Rest(benchmark::State& state) {
         book.add_order(sell);
     }
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Buy below the best ask — no match, rests on book
         Order* buy = pool.allocate();
@@ -152,10 +254,10 @@ static void BM_LimitNoMatch_Rest(benchmark::State& state) {
         benchmark::DoNotOptimize(result);
 
         // Clean up to avoid exhausting pool
-        state.PauseTiming();
+        counters.pause();
         book.cancel_order(next_id - 1);
         pool.deallocate(buy);
-        state.ResumeTiming();
+        counters.resume();
     }
 }
 BENCHMARK(BM_LimitNoMatch_Rest)->MinTime(1.0);
@@ -172,6 +274,7 @@ static void BM_MarketOrder(benchmark::State& state) {
     place_ask_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Place resting sell
         Order* sell = pool.allocate();
@@ -199,6 +302,7 @@ static void BM_IOC_Match(benchmark::State& state) {
     place_ask_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         Order* sell = pool.allocate();
         *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 100);
@@ -224,6 +328,7 @@ static void BM_FOK_Accept(benchmark::State& state) {
     place_ask_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         Order* sell = pool.allocate();
         *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 100);
@@ -252,6 +357,7 @@ static void BM_FOK_Reject(benchmark::State& state) {
     *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 50);
     book.add_order(sell);
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // FOK wants 100 but only 50 available — rejected
         Order* buy = pool.allocate();
@@ -288,6 +394,7 @@ static void BM_ModifyOrder_SamePrice(benchmark::State& state) {
     OrderId modify_id = buy->order_id;
 
     Quantity qty = 100;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         qty = (qty == 100) ? 200 : 100;
         auto result = engine.modify_order(modify_id, MID, qty, next_id++);
@@ -296,6 +403,39 @@ static void BM_ModifyOrder_SamePrice(benchmark::State& state) {
 }
 BENCHMARK(BM_ModifyOrder_SamePrice)->MinTime(1.0);
 
+// ---------------------------------------------------------------------------
+// BM_ModifyOrder_SizeDown — same-price quantity decrease, behind 64 older
+// orders at the level (amended in place, keeps its queue position)
+// ---------------------------------------------------------------------------
+
+static void BM_ModifyOrder_SizeDown(benchmark::State& state) {
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    place_ask_sentinel(book, pool);
+
+    OrderId next_id = 1;
+    for (int i = 0; i < 64; ++i) {
+        Order* o = pool.allocate();
+        *o = make_order(next_id++, Side::Buy, OrderType::Limit, MID, 100);
+        book.add_order(o);
+    }
+
+    Quantity qty = 1'000'000'000;
+    Order* buy = pool.allocate();
+    *buy = make_order(next_id++, Side::Buy, OrderType::Limit, MID, qty);
+    book.add_order(buy);
+    OrderId modify_id = buy->order_id;
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        auto result = engine.modify_order(modify_id, MID, --qty, next_id++);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ModifyOrder_SizeDown)->MinTime(1.0);
+
 // ---------------------------------------------------------------------------
 // BM_ModifyOrder_NewPrice — price change, no cross
 // ---------------------------------------------------------------------------
@@ -321,6 +461,7 @@ static void BM_ModifyOrder_NewPrice(benchmark::State& state) {
     OrderId modify_id = buy->order_id;
 
     bool toggle = false;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         Price new_price = toggle ? MID : (MID - TICK);
         toggle = !toggle;
@@ -343,6 +484,7 @@ static void BM_ModifyOrder_Crossing(benchmark::State& state) {
     place_bid_sentinel(book, pool);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Place a resting sell at MID
         Order* sell = pool.allocate();
@@ -363,4 +505,317 @@ static void BM_ModifyOrder_Crossing(benchmark::State& state) {
 }
 BENCHMARK(BM_ModifyOrder_Crossing)->MinTime(1.0);
 
+// ---------------------------------------------------------------------------
+// BM_SubmitBatch — 64 non-crossing adds scattered over a 400k-order book,
+// either one submit_order() at a time (arg 0) or through process_batch()
+// with prefetching (arg 1). Each add misses on its level head and its
+// order-map slot; the batch overlaps those misses.
+// ---------------------------------------------------------------------------
+
+static void BM_SubmitBatch(benchmark::State& state) {
+    constexpr size_t LIVE = 400'000;
+    constexpr size_t BATCH = 64;
+    constexpr size_t SPREAD_LEVELS = 500'000;  // Levels each side of MID
+    const bool batched = state.range(0) != 0;
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    uint64_t rng = 88172645463325252ULL;
+    auto next_rand = [&rng]() {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        return rng;
+    };
+    // Bids strictly below MID, asks strictly above: nothing ever crosses.
+    auto random_order = [&](OrderId id) {
+        Side side = (next_rand() & 1) ? Side::Buy : Side::Sell;
+        Price offset = static_cast<Price>(1 + next_rand() % SPREAD_LEVELS) * TICK;
+        return make_order(id, side, OrderType::Limit,
+                          side == Side::Buy ? MID - offset : MID + offset, 1);
+    };
+
+    OrderId next_id = 1;
+    for (size_t i = 0; i < LIVE; ++i) {
+        Order* o = pool.allocate();
+        *o = random_order(next_id++);
+        book.add_order(o);
+    }
+
+    auto ignore_trade = [](const Trade&) noexcept {};
+    const TradeSink sink = make_trade_sink(ignore_trade);
+    Order* orders[BATCH];
+    MatchSummary results[BATCH];
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        counters.pause();
+        for (size_t i = 0; i < BATCH; ++i) {
+            orders[i] = pool.allocate();
+            *orders[i] = random_order(next_id++);
+        }
+        counters.resume();
+
+        if (batched) {
+            engine.process_batch(orders, BATCH, results, sink);
+        } else {
+            for (size_t i = 0; i < BATCH; ++i) {
+                results[i] = engine.submit_order(orders[i], sink);
+            }
+        }
+        benchmark::DoNotOptimize(results);
+
+        // Keep the live set constant
+        counters.pause();
+        for (size_t i = 0; i < BATCH; ++i) {
+            (void)engine.cancel_order(next_id - BATCH + i);
+        }
+        counters.resume();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+BENCHMARK(BM_SubmitBatch)->Arg(0)->Arg(1)->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_PolicySweep — the BM_Sweep64 workload on BasicMatchingEngine directly:
+// the general policy (CancelNewest STP, icebergs, FOK) against the lean
+// one (no STP, limit/market/IOC only), whose inner loop has no STP or
+// iceberg branches.
+// ---------------------------------------------------------------------------
+
+template <typename Policy>
+static void BM_PolicySweep(benchmark::State& state) {
+    constexpr Quantity EAT = 64;
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    BasicMatchingEngine<Policy> engine(book, pool);
+
+    place_ask_sentinel(book, pool);
+
+    auto ignore_trade = [](const Trade&) noexcept {};
+    const TradeSink sink = make_trade_sink(ignore_trade);
+
+    OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        counters.pause();
+        for (Quantity i = 0; i < EAT; ++i) {
+            Order* sell = pool.allocate();
+            *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, 1);
+            sell->participant_id = 2;  // Never a self-trade
+            book.add_order(sell);
+        }
+        counters.resume();
+
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::IOC, MID, EAT);
+        auto summary = engine.submit_order(buy, sink);
+        benchmark::DoNotOptimize(summary);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EAT));
+}
+BENCHMARK_TEMPLATE(BM_PolicySweep, DefaultMatchingPolicy)->MinTime(1.0);
+BENCHMARK_TEMPLATE(BM_PolicySweep,
+                   MatchingPolicy<SelfTradePreventionMode::None, false, false>)
+    ->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_OpeningCross — 4096 overlapping limit orders (bids and asks scattered
+// over the same 64 ticks) submitted continuously (arg 0: every crossing
+// add matches on arrival) or accumulated in auction mode and uncrossed
+// once (arg 1).
+// ---------------------------------------------------------------------------
+
+static void BM_OpeningCross(benchmark::State& state) {
+    constexpr size_t N = 4096;
+    const bool auction = state.range(0) != 0;
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    auto ignore_trade = [](const Trade&) noexcept {};
+    const TradeSink sink = make_trade_sink(ignore_trade);
+
+    uint64_t rng = 2463534242ULL;
+    Order orders[N];
+    for (size_t i = 0; i < N; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        Side side = (rng & 1) ? Side::Buy : Side::Sell;
+        Price price = MID + static_cast<Price>((rng >> 8) % 64) * TICK;
+        orders[i] = make_order(0, side, OrderType::Limit, price,
+                               1 + (rng >> 20) % 10);
+    }
+
+    OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        OrderId first_id = next_id;
+        if (auction) engine.begin_auction();
+        for (size_t i = 0; i < N; ++i) {
+            Order* o = pool.allocate();
+            *o = orders[i];
+            o->order_id = next_id;
+            o->timestamp = next_id++;
+            auto summary = engine.submit_order(o, sink);
+            benchmark::DoNotOptimize(summary);
+        }
+        if (auction) {
+            auto result = engine.uncross(next_id, sink);
+            benchmark::DoNotOptimize(result);
+        }
+
+        // Clear the residual book for the next round
+        counters.pause();
+        for (OrderId id = first_id; id < next_id; ++id) {
+            (void)engine.cancel_order(id);
+        }
+        counters.resume();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * N));
+}
+BENCHMARK(BM_OpeningCross)->Arg(0)->Arg(1)->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_DeepLevelAllocation — IOC takes half of a 1024-order level (100 lots
+// each). Arg = AllocationMode: 0 FIFO (fills the first 512 orders), 1
+// pro-rata (50 lots from every order), 2 price-time pro-rata. Items are
+// fills, so the rate is the cost per fill.
+// ---------------------------------------------------------------------------
+
+static void BM_DeepLevelAllocation(benchmark::State& state) {
+    constexpr size_t DEPTH = 1024;
+    constexpr Quantity LOT = 100;
+    MatchingFeatures features;
+    features.allocation = static_cast<AllocationMode>(state.range(0));
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None, features);
+
+    place_ask_sentinel(book, pool);
+
+    uint64_t fills = 0;
+    auto on_trade = [&fills](const Trade&) noexcept { ++fills; };
+    const TradeSink sink = make_trade_sink(on_trade);
+
+    OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        counters.pause();
+        OrderId first_id = next_id;
+        for (size_t i = 0; i < DEPTH; ++i) {
+            Order* sell = pool.allocate();
+            *sell = make_order(next_id++, Side::Sell, OrderType::Limit, MID, LOT);
+            book.add_order(sell);
+        }
+        counters.resume();
+
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::IOC, MID,
+                          DEPTH * LOT / 2);
+        auto summary = engine.submit_order(buy, sink);
+        benchmark::DoNotOptimize(summary);
+
+        counters.pause();
+        for (OrderId id = first_id; id < next_id; ++id) {
+            (void)engine.cancel_order(id);
+        }
+        counters.resume();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(fills));
+}
+BENCHMARK(BM_DeepLevelAllocation)->Arg(0)->Arg(1)->Arg(2)->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_ChurnedBookMatchWalk — IOC takes 64 one-lot asks from the touch of a
+// book aged by a long replay: 4M adds and cancels, biased towards the
+// touch, over 256 levels a side, with ~64k orders resting throughout. By
+// then a single LIFO free list hands out slots in effectively random
+// order, so consecutive orders in a level's FIFO sit on unrelated lines
+// and pages. Arg 0: single free list. Arg 1: 64 colours allocated by level
+// index (PoolLocality, four neighbouring levels per colour), as
+// OrderGateway does. Counter pages_per_walk: distinct 4 KB pages under the
+// first 64 orders of the best ask, sampled after the churn.
+// ---------------------------------------------------------------------------
+
+static void BM_ChurnedBookMatchWalk(benchmark::State& state) {
+    constexpr size_t LEVELS = 256;
+    constexpr size_t RESTING = 65'536;
+    constexpr size_t CHURN = 4'000'000;
+    constexpr size_t POOL = 4 * RESTING;
+    constexpr Quantity EAT = 64;
+    PoolLocality locality;
+    if (state.range(0) != 0) locality.colours = 64;
+    MemoryPool<Order> pool(POOL, {}, {}, locality);
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    place_ask_sentinel(book, pool);
+    place_bid_sentinel(book, pool);
+
+    // Level offsets from the touch, skewed towards it (min of two uniforms)
+    std::mt19937_64 rng(42);
+    auto level_offset = [&rng]() {
+        const size_t a = rng() % LEVELS;
+        const size_t b = rng() % LEVELS;
+        return static_cast<Price>(std::min(a, b));
+    };
+    OrderId next_id = 1;
+    auto add = [&](Side side, Price price) {
+        Order* o = pool.allocate(book.level_hint(price));
+        *o = make_order(next_id++, side, OrderType::Limit, price, 1);
+        book.add_order(o);
+        return o->order_id;
+    };
+    auto add_random = [&]() {
+        const Side side = (rng() & 1) ? Side::Sell : Side::Buy;
+        const Price offset = level_offset() * TICK;
+        return add(side, side == Side::Sell ? MID + offset : MID - TICK - offset);
+    };
+
+    // Live ids in a swap-remove vector: cancel a random one per add
+    std::vector<OrderId> live;
+    live.reserve(RESTING);
+    for (size_t i = 0; i < RESTING; ++i) live.push_back(add_random());
+    for (size_t i = 0; i < CHURN; ++i) {
+        const size_t victim = rng() % live.size();
+        (void)engine.cancel_order(live[victim]);
+        live[victim] = add_random();
+    }
+
+    std::vector<uintptr_t> pages;
+    for (const Order* o = book.best_ask_level()->head; o && pages.size() < EAT; o = o->next) {
+        pages.push_back(reinterpret_cast<uintptr_t>(o) >> 12);
+    }
+    std::sort(pages.begin(), pages.end());
+    const auto distinct = std::unique(pages.begin(), pages.end()) - pages.begin();
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::IOC, MID + LEVELS * TICK, EAT);
+        auto result = engine.submit_order(buy);
+        benchmark::DoNotOptimize(result);
+
+        // Replace what was taken and keep churning, so the touch is always
+        // refilled from aged slots. Ids the IOC filled are dropped when drawn.
+        counters.pause();
+        for (Quantity i = 0; i < EAT; ++i) {
+            live.push_back(add(Side::Sell, MID + level_offset() * TICK));
+            const size_t victim = rng() % live.size();
+            if (engine.cancel_order(live[victim])) {
+                live[victim] = add_random();
+            } else {
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+        counters.resume();
+    }
+    state.counters["pages_per_walk"] = static_cast<double>(distinct);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * EAT));
+}
+BENCHMARK(BM_ChurnedBookMatchWalk)->Arg(0)->Arg(1)->MinTime(1.0);
+
 BENCHMARK_MAIN();
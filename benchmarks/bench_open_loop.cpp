@@ -0,0 +1,366 @@
+/// @file bench_open_loop.cpp
+/// @brief Open-loop end-to-end latency harness, swept across offered load.
+///
+/// bench_latency times each operation back to back on one thread, so a
+/// slow message delays the next one's start instead of queueing it, and
+/// the queueing delay a burst causes never shows up (coordinated
+/// omission). Here three threads run the production path:
+///   - load generator: sends each OrderMessage into the IngressBuffer at
+///     its scheduled time (Poisson arrivals at the offered rate, from
+///     generate_workload), never waiting for the engine;
+///   - matching: drains the ring through OrderGateway::process();
+///   - consumer: drains the EventBuffer and timestamps what it reads.
+/// A message completes when the consumer reads its last event (or, if it
+/// published none, when matching finishes it). Latency is measured from
+/// the message's intended send time, so time spent queued behind a burst,
+/// or behind a full ring, counts. The same run is also reported from the
+/// actual send time, which is what a coordinated-omission-prone harness
+/// would have shown.
+///
+/// Standalone executable — does NOT use Google Benchmark.
+///
+/// Usage:
+///   bench_open_loop                                   # default sweep, unpinned
+///   bench_open_loop --cpus 2,3,4 --wait spin          # pinned, busy-polling
+///   bench_open_loop --rates 500000,1000000,2000000 --messages 2000000 --csv sweep.csv
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/order.h"
+#include "core/types.h"
+#include "feed/workload_generator.h"
+#include "gateway/order_gateway.h"
+#include "matching/matching_engine.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
+#include "transport/event_buffer.h"
+#include "transport/ingress_buffer.h"
+#include "transport/message.h"
+#include "transport/wait_strategy.h"
+#include "utils/clock.h"
+#include "utils/latency_histogram.h"
+#include "utils/thread_placement.h"
+
+using namespace hft;
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+struct Options {
+    std::vector<double> rates = {100'000, 250'000, 500'000, 1'000'000, 2'000'000, 4'000'000};
+    size_t messages = 500'000;       // Per load level
+    double warmup = 0.1;             // Leading fraction left out of the stats
+    WorkloadConfig generator;
+    ThreadingConfig threading;       // Ingress = generator, Publisher = consumer
+    WaitConfig wait{WaitStrategy::Backoff};
+    std::string csv_path;
+};
+
+/// One load level's outcome.
+struct LevelResult {
+    double offered_rate = 0.0;
+    double achieved_rate = 0.0;
+    LatencyStats from_intended{};
+    LatencyStats from_sent{};
+    double mean_send_lag_ns = 0.0;   // Generator behind schedule (ring full, descheduled)
+};
+
+// ---------------------------------------------------------------------------
+// One load level
+// ---------------------------------------------------------------------------
+
+/// Consumer's per-event read times, indexed by sequence number. A message
+/// is resolved once matching has finished it, so entries are only needed
+/// for the events of a few in-flight messages.
+static constexpr size_t EVENT_TIME_RING = size_t{1} << 20;
+
+static LevelResult run_level(const Options& options, double rate, double tsc_freq) {
+    WorkloadConfig config = options.generator;
+    config.messages = options.messages;
+    config.arrival_rate = rate;
+    const Workload workload = generate_workload(config);
+    const size_t n = workload.messages.size();
+    const size_t warmup = static_cast<size_t>(static_cast<double>(n) * options.warmup);
+
+    // Engine, sized like bench_workload's
+    const Price margin = 16 * workload.tick_size;
+    const size_t max_orders = workload.adds + 1024;
+    OrderBook book(std::max<Price>(workload.tick_size, workload.min_price - margin),
+                   workload.max_price + margin, workload.tick_size, max_orders);
+    MemoryPool<Order> pool(max_orders);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+    auto events = std::make_unique<EventBuffer>();
+    auto ingress = std::make_unique<IngressBuffer>();
+    OrderGateway gateway(engine, pool, events.get());
+
+    // Schedule, relative to the start, in TSC ticks
+    std::vector<uint64_t> intended(n);
+    const Timestamp first = workload.messages.front().order.timestamp;
+    for (size_t i = 0; i < n; ++i) {
+        intended[i] = static_cast<uint64_t>(
+            static_cast<double>(workload.messages[i].order.timestamp - first) * tsc_freq);
+    }
+    std::vector<uint64_t> sent(n);
+    std::vector<uint64_t> end_sequence(n);
+    std::vector<uint64_t> done(n);
+    std::vector<uint64_t> event_time(EVENT_TIME_RING);
+    std::atomic<size_t> processed{0};
+    std::atomic<bool> go{false};
+    uint64_t start = 0;
+
+    LatencyHistogram from_intended;
+    LatencyHistogram from_sent;
+    from_intended.set_tsc_frequency(tsc_freq);
+    from_sent.set_tsc_frequency(tsc_freq);
+    uint64_t send_lag_ticks = 0;
+    uint64_t last_done = 0;
+
+    std::thread generator([&] {
+        ScopedThreadPlacement placement(options.threading, ThreadRole::Ingress);
+        Waiter waiter(options.wait);
+        while (!go.load(std::memory_order_acquire)) cpu_relax();
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t due = start + intended[i];
+            while (rdtsc() < due) waiter.idle();
+            waiter.reset();
+            const uint64_t now = rdtsc();
+            sent[i] = now;
+            send_lag_ticks += now - due;
+            while (!ingress->try_push(workload.messages[i])) waiter.idle();
+            waiter.reset();
+        }
+    });
+
+    std::thread matching([&] {
+        ScopedThreadPlacement placement(options.threading, ThreadRole::Matching);
+        Waiter waiter(options.wait);
+        OrderMessage msg{};
+        for (size_t i = 0; i < n;) {
+            if (!ingress->try_pop(msg)) {
+                waiter.idle();
+                continue;
+            }
+            waiter.reset();
+            (void)gateway.process(msg);
+            end_sequence[i] = gateway.sequence_number();
+            done[i] = rdtsc();
+            processed.store(++i, std::memory_order_release);
+        }
+    });
+
+    std::thread consumer([&] {
+        ScopedThreadPlacement placement(options.threading, ThreadRole::Publisher);
+        Waiter waiter(options.wait);
+        std::array<EventMessage, 256> batch;
+        uint64_t last_sequence = 0;
+        uint64_t previous_end = 0;
+        for (size_t m = 0; m < n;) {
+            const size_t k = events->try_pop_n(batch.data(), batch.size());
+            if (k != 0) {
+                const uint64_t now = rdtsc();
+                for (size_t j = 0; j < k; ++j) {
+                    event_time[batch[j].sequence_num & (EVENT_TIME_RING - 1)] = now;
+                }
+                last_sequence = batch[k - 1].sequence_num;
+            }
+            // Complete every finished message whose events have all been read
+            const size_t ready = processed.load(std::memory_order_acquire);
+            bool progressed = k != 0;
+            while (m < ready && end_sequence[m] <= last_sequence) {
+                const uint64_t end = end_sequence[m];
+                const uint64_t finished =
+                    end == previous_end ? done[m] : event_time[end & (EVENT_TIME_RING - 1)];
+                if (m >= warmup) {
+                    from_intended.record(finished - (start + intended[m]));
+                    from_sent.record(finished - sent[m]);
+                }
+                last_done = finished;
+                previous_end = end;
+                ++m;
+                progressed = true;
+            }
+            if (progressed) {
+                waiter.reset();
+            } else {
+                waiter.idle();
+            }
+        }
+    });
+
+    // Give the threads time to place themselves before the clock starts
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    start = rdtsc() + static_cast<uint64_t>(1e6 * tsc_freq);
+    go.store(true, std::memory_order_release);
+    generator.join();
+    matching.join();
+    consumer.join();
+
+    LevelResult result;
+    result.offered_rate = rate;
+    const double elapsed_ns = static_cast<double>(last_done - start) / tsc_freq;
+    result.achieved_rate = elapsed_ns > 0.0 ? static_cast<double>(n) / elapsed_ns * 1e9 : 0.0;
+    result.from_intended = from_intended.compute();
+    result.from_sent = from_sent.compute();
+    result.mean_send_lag_ns = static_cast<double>(send_lag_ticks) / tsc_freq /
+                              static_cast<double>(n);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+static void print_usage(const char* program) {
+    std::cerr
+        << "Usage: " << program << " [options]\n"
+        << "  --rates <r1,r2,...>      Offered loads in msgs/s (default 100k..4M)\n"
+        << "  --messages <n>           Messages per load level (default 500000)\n"
+        << "  --warmup <fraction>      Leading fraction excluded from stats (default 0.1)\n"
+        << "  --cancel-ratio <r>       Cancels per add (default 0.9)\n"
+        << "  --aggressive <f>         Fraction of adds crossing the spread (default 0.05)\n"
+        << "  --seed <n>               Workload seed (default 42)\n"
+        << "  --cpus <gen>,<match>,<consumer>  Pin the three threads\n"
+        << "  --wait <spin|pause|yield|backoff>  Idle poll of all threads (default backoff)\n"
+        << "  --csv <path>             Write one row per load level\n";
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) return false;
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires a value\n";
+            return false;
+        }
+        const std::string v = argv[++i];
+        if (std::strcmp(arg, "--rates") == 0) {
+            options.rates.clear();
+            for (size_t pos = 0; pos <= v.size();) {
+                const size_t comma = std::min(v.find(',', pos), v.size());
+                const double rate = std::atof(v.substr(pos, comma - pos).c_str());
+                if (rate <= 0.0) {
+                    std::cerr << "Error: bad rate in --rates " << v << "\n";
+                    return false;
+                }
+                options.rates.push_back(rate);
+                pos = comma + 1;
+            }
+        } else if (std::strcmp(arg, "--messages") == 0) {
+            options.messages = std::strtoull(v.c_str(), nullptr, 10);
+        } else if (std::strcmp(arg, "--warmup") == 0) {
+            options.warmup = std::clamp(std::atof(v.c_str()), 0.0, 0.9);
+        } else if (std::strcmp(arg, "--cancel-ratio") == 0) {
+            options.generator.cancel_to_add = std::atof(v.c_str());
+        } else if (std::strcmp(arg, "--aggressive") == 0) {
+            options.generator.aggressive_fraction = std::atof(v.c_str());
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.generator.seed = std::strtoull(v.c_str(), nullptr, 10);
+        } else if (std::strcmp(arg, "--cpus") == 0) {
+            int gen = -1, match = -1, consume = -1;
+            if (std::sscanf(v.c_str(), "%d,%d,%d", &gen, &match, &consume) != 3) {
+                std::cerr << "Error: --cpus requires <gen>,<match>,<consumer>\n";
+                return false;
+            }
+            options.threading.ingress_cpus = {gen};
+            options.threading.matching_cpus = {match};
+            options.threading.publisher_cpus = {consume};
+        } else if (std::strcmp(arg, "--wait") == 0) {
+            if (v == "spin") {
+                options.wait.strategy = WaitStrategy::BusySpin;
+            } else if (v == "pause") {
+                options.wait.strategy = WaitStrategy::Pause;
+            } else if (v == "yield") {
+                options.wait.strategy = WaitStrategy::Yield;
+            } else if (v == "backoff") {
+                options.wait.strategy = WaitStrategy::Backoff;
+            } else {
+                std::cerr << "Error: unknown wait strategy: " << v << "\n";
+                return false;
+            }
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            options.csv_path = v;
+        } else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.messages < 2) {
+        std::cerr << "Error: --messages must be at least 2\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "================================================================\n";
+    std::cout << " HFT Order Book Engine — Open-Loop Latency Sweep\n";
+    std::cout << "================================================================\n\n";
+    const double tsc_freq = calibrate_tsc_frequency();
+    std::cout << "TSC frequency: " << std::fixed << std::setprecision(3) << tsc_freq
+              << " ticks/ns; " << options.messages << " messages per level, first "
+              << std::setprecision(0) << options.warmup * 100 << "% excluded\n";
+    if (std::thread::hardware_concurrency() < 3 || options.threading.matching_cpus.empty()) {
+        std::cout << "Note: threads unpinned or sharing CPUs; queueing includes scheduling\n";
+    }
+
+    std::ofstream csv;
+    if (!options.csv_path.empty()) {
+        csv.open(options.csv_path);
+        if (!csv.is_open()) {
+            std::cerr << "Error: cannot write " << options.csv_path << "\n";
+            return 1;
+        }
+        csv << "offered_msgs_per_s,achieved_msgs_per_s,p50_ns,p90_ns,p99_ns,p99_9_ns,max_ns,"
+               "mean_ns,sent_p99_ns,sent_p99_9_ns,mean_send_lag_ns\n";
+    }
+
+    std::cout << "\n  latency from intended send time (ns)                        "
+                 "from actual send (ns)\n";
+    std::cout << std::right << std::setw(10) << "offered" << std::setw(10) << "achieved"
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+              << std::setw(11) << "p99.9" << std::setw(11) << "max" << std::setw(12)
+              << "p99" << std::setw(11) << "p99.9" << "\n";
+    for (double rate : options.rates) {
+        const LevelResult r = run_level(options, rate, tsc_freq);
+        const LatencyStats& s = r.from_intended;
+        std::cout << std::setprecision(2) << std::setw(9) << r.offered_rate / 1e6 << "M"
+                  << std::setw(9) << r.achieved_rate / 1e6 << "M" << std::setprecision(0)
+                  << std::setw(10) << s.p50_ns << std::setw(10) << s.p90_ns << std::setw(10)
+                  << s.p99_ns << std::setw(11) << s.p99_9_ns << std::setw(11) << s.max_ns
+                  << std::setw(12) << r.from_sent.p99_ns << std::setw(11)
+                  << r.from_sent.p99_9_ns;
+        if (r.achieved_rate < 0.95 * r.offered_rate) std::cout << "  saturated";
+        std::cout << "\n";
+        if (csv.is_open()) {
+            csv << r.offered_rate << "," << r.achieved_rate << "," << s.p50_ns << ","
+                << s.p90_ns << "," << s.p99_ns << "," << s.p99_9_ns << "," << s.max_ns << ","
+                << s.mean_ns << "," << r.from_sent.p99_ns << "," << r.from_sent.p99_9_ns << ","
+                << r.mean_send_lag_ns << "\n";
+        }
+    }
+    std::cout << "\n(achieved < 95% of offered: the engine cannot keep up at that load;\n"
+                 " the intended-time tail is then queueing, not service time)\n";
+    if (csv.is_open()) std::cout << "Results written to: " << options.csv_path << "\n";
+    return 0;
+}
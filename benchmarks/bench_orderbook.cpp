@@ -1,5 +1,8 @@
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
+#include "bench_counters.h"
 #include "core/order.h"
 #include "core/types.h"
 #include "orderbook/memory_pool.h"
@@ -44,6 +47,7 @@ static void BM_AddOrder_NoMatch(benchmark::State& state) {
     MemoryPool<Order> pool(POOL_SIZE);
 
     OrderId next_id = 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         // Alternate bids and asks spread around mid
         Price px = MID_PRICE - 100 * TICK +
@@ -58,14 +62,14 @@ static void BM_AddOrder_NoMatch(benchmark::State& state) {
 
         // Periodically drain to avoid exhausting pool
         if (next_id % (POOL_SIZE / 2) == 0) {
-            state.PauseTiming();
+            counters.pause();
             for (OrderId id = next_id - POOL_SIZE / 2; id < next_id; ++id) {
                 auto cr = book.cancel_order(id);
                 if (cr.success) {
                     pool.deallocate(cr.order);
                 }
             }
-            state.ResumeTiming();
+            counters.resume();
         }
     }
 }
@@ -92,6 +96,7 @@ static void BM_CancelOrder(benchmark::State& state) {
 
     OrderId cancel_id = 1;
     OrderId add_id = N + 1;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         auto cr = book.cancel_order(cancel_id);
         benchmark::DoNotOptimize(cr);
@@ -134,6 +139,7 @@ static void BM_AddCancel_Mixed(benchmark::State& state) {
 
     OrderId cancel_id = 1;
     size_t iter = 0;
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         if (iter % 2 == 0) {
             // Add
@@ -161,4 +167,140 @@ static void BM_AddCancel_Mixed(benchmark::State& state) {
 }
 BENCHMARK(BM_AddCancel_Mixed)->MinTime(1.0);
 
+// ---------------------------------------------------------------------------
+// BM_AvailableQuantity / BM_Depth10 — FOK liquidity and depth-10 snapshot
+// scans. Arg(0) = PriceLevel layout, Arg(1) = dense level stats.
+// ---------------------------------------------------------------------------
+
+static void fill_two_sided(OrderBook& book, MemoryPool<Order>& pool,
+                           size_t levels_per_side) {
+    OrderId id = 1;
+    for (size_t i = 0; i < levels_per_side; ++i) {
+        Price off = static_cast<Price>(i + 1) * TICK;
+        Order* b = pool.allocate();
+        *b = make_order(id++, Side::Buy, MID_PRICE - off, 100);
+        book.add_order(b);
+        Order* a = pool.allocate();
+        *a = make_order(id++, Side::Sell, MID_PRICE + off, 100);
+        book.add_order(a);
+    }
+}
+
+static void BM_AvailableQuantity(benchmark::State& state) {
+    OrderBookOptions opts;
+    opts.dense_level_stats = state.range(0) != 0;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 4096, opts);
+    MemoryPool<Order> pool(4096);
+    fill_two_sided(book, pool, 1000);
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        Quantity q = book.available_quantity(Side::Sell, MID_PRICE + 500 * TICK);
+        benchmark::DoNotOptimize(q);
+    }
+}
+BENCHMARK(BM_AvailableQuantity)->Arg(0)->Arg(1)->MinTime(1.0);
+
+static void BM_Depth10(benchmark::State& state) {
+    OrderBookOptions opts;
+    opts.dense_level_stats = state.range(0) != 0;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 4096, opts);
+    MemoryPool<Order> pool(4096);
+    fill_two_sided(book, pool, 1000);
+
+    DepthEntry bids[10];
+    DepthEntry asks[10];
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        size_t nb = book.get_bid_depth(bids, 10);
+        size_t na = book.get_ask_depth(asks, 10);
+        benchmark::DoNotOptimize(nb);
+        benchmark::DoNotOptimize(na);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Depth10)->Arg(0)->Arg(1)->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_OrderMapLookup — order-id map find at load factor 0.5
+//   Arg 0: probe mode (0 = linear, 1 = group/SIMD)
+//   Arg 1: 1 = hits, 0 = misses (cancels for already-gone orders)
+// ---------------------------------------------------------------------------
+
+static void BM_OrderMapLookup(benchmark::State& state) {
+    constexpr size_t N = 500'000;
+    OrderMapProbe probe = state.range(0) ? OrderMapProbe::Group
+                                         : OrderMapProbe::Linear;
+    FlatOrderMap map(N, {}, probe);
+    std::vector<Order> orders(N);
+
+    // Random 64-bit ids (splitmix64) so probe chains look like live flow.
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto next_id = [&x]() {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (z ^ (z >> 31)) | 1;
+    };
+
+    // Fill to the map's nominal load of 0.5, with some churn so the group
+    // mode's tombstone path is exercised too.
+    std::vector<OrderId> hits;
+    hits.reserve(N);
+    for (size_t i = 0; i < N; ++i) {
+        OrderId id = next_id();
+        if (map.insert(id, &orders[i])) hits.push_back(id);
+    }
+    for (size_t i = 0; i < N / 4; ++i) {
+        map.erase(hits[i]);
+        OrderId id = next_id();
+        if (map.insert(id, &orders[i])) hits[i] = id;
+    }
+
+    std::vector<OrderId> queries(4096);
+    for (auto& q : queries) {
+        q = state.range(1) ? hits[next_id() % hits.size()] : next_id();
+    }
+
+    size_t i = 0;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(queries[i]));
+        i = (i + 1) & (queries.size() - 1);
+    }
+}
+BENCHMARK(BM_OrderMapLookup)
+    ->Args({0, 1})->Args({1, 1})->Args({0, 0})->Args({1, 0})
+    ->MinTime(1.0);
+
+// ---------------------------------------------------------------------------
+// BM_FindOrder — OrderBook::find_order on sequential venue IDs
+//   Arg 0: 0 = hash map, 1 = direct-indexed window
+// ---------------------------------------------------------------------------
+
+static void BM_FindOrder(benchmark::State& state) {
+    constexpr size_t N = 100'000;
+    OrderBookOptions opts;
+    opts.direct_index_pages = state.range(0) ? 64 : 0;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, N, opts);
+    MemoryPool<Order> pool(N);
+
+    for (size_t i = 0; i < N; ++i) {
+        Price px = MID_PRICE - 50 * TICK + static_cast<Price>(i % 100) * TICK;
+        Side side = (px < MID_PRICE) ? Side::Buy : Side::Sell;
+        Order* o = pool.allocate();
+        *o = make_order(static_cast<OrderId>(i + 1), side, px, 100);
+        book.add_order(o);
+    }
+
+    // Scattered lookups so the hash path pays its real probe cost.
+    OrderId id = 1;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(book.find_order(id));
+        id = (id * 7919) % N + 1;
+    }
+}
+BENCHMARK(BM_FindOrder)->Arg(0)->Arg(1)->MinTime(1.0);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,331 @@
+/// @file bench_parser.cpp
+/// @brief Tokenizer, framer, parser and serializer throughput for the L3
+///        CSV and FIX text paths.
+///
+/// The L3 input is synthesised in the shape of data/btcusdt_l3_sample.csv
+/// (6-column rows, ~44 bytes each) so the benchmark needs no data files.
+/// The *_Scalar variants split the same bytes with std::string_view::find,
+/// as the parsers did before the structural scanner.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_counters.h"
+#include "feed/cl_ord_id_table.h"
+#include "feed/fix_framer.h"
+#include "feed/fix_parser.h"
+#include "feed/fix_serializer.h"
+#include "feed/l3_feed_parser.h"
+#include "feed/structural_scanner.h"
+
+using namespace hft;
+
+// ---------------------------------------------------------------------------
+// Inputs
+// ---------------------------------------------------------------------------
+
+/// `rows` lines shaped like data/btcusdt_l3_sample.csv, header included.
+static std::string make_l3_csv(size_t rows) {
+    static const char* const events[] = {"ADD", "ADD", "ADD", "CANCEL", "MODIFY", "TRADE"};
+    std::string csv = "timestamp,event_type,order_id,side,price,quantity\n";
+    csv.reserve(rows * 48);
+    char line[96];
+    for (size_t i = 0; i < rows; ++i) {
+        const unsigned ticks = static_cast<unsigned>(i * 7919 % 200);
+        std::snprintf(line, sizeof(line), "%llu,%s,%zu,%s,%u.%02u,%zu\n",
+                      1704067200000000000ULL + i * 100000ULL, events[i % 6], i + 1,
+                      (i & 1) ? "SELL" : "BUY", 41950 + ticks / 2, (ticks & 1) * 50,
+                      1 + i % 9);
+        csv += line;
+    }
+    return csv;
+}
+
+static const std::string& l3_csv() {
+    static const std::string csv = make_l3_csv(100000);
+    return csv;
+}
+
+/// Lines of l3_csv(), newline stripped.
+static const std::vector<std::string_view>& l3_lines() {
+    static const std::vector<std::string_view> lines = [] {
+        std::vector<std::string_view> out;
+        std::string_view rest = l3_csv();
+        while (!rest.empty()) {
+            const size_t nl = rest.find('\n');
+            out.push_back(rest.substr(0, nl));
+            rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+        }
+        return out;
+    }();
+    return lines;
+}
+
+static const std::string& fix_message() {
+    static const std::string msg =
+        "8=FIX.4.2|9=120|35=D|49=TRADER1|56=HFT-ENGINE|11=ORD-000123|55=BTCUSDT|"
+        "54=1|60=20240101-00:00:01.000|40=2|38=10|44=42000.50|59=1|10=000|";
+    return msg;
+}
+
+/// 10,000 framed (length- and checksum-correct) NewOrderSingles.
+static const std::string& fix_session() {
+    static const std::string stream = [] {
+        std::string out;
+        char body[160];
+        for (int i = 0; i < 10000; ++i) {
+            const int n = std::snprintf(body, sizeof(body),
+                                        "35=D|49=TRADER1|56=HFT-ENGINE|11=ORD-%06d|55=BTCUSDT|"
+                                        "54=%d|40=2|38=%d|44=42000.50|59=1|",
+                                        i, 1 + (i & 1), 1 + i % 9);
+            std::string msg = "8=FIX.4.2|9=" + std::to_string(n) + "|" + body;
+            char trailer[8];
+            std::snprintf(trailer, sizeof(trailer), "10=%03u|",
+                          static_cast<unsigned>(fix::FixParser::compute_checksum(msg)));
+            out += msg + trailer;
+        }
+        return out;
+    }();
+    return stream;
+}
+
+// ---------------------------------------------------------------------------
+// Tokenizer only
+// ---------------------------------------------------------------------------
+
+static void BM_L3SplitFields(benchmark::State& state) {
+    const auto& lines = l3_lines();
+    std::string_view fields[L3FeedParser::MAX_FIELDS];
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        for (std::string_view line : lines) {
+            benchmark::DoNotOptimize(
+                L3FeedParser::split_fields(line, fields, L3FeedParser::MAX_FIELDS));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * l3_csv().size()));
+    state.SetLabel(structural_scanner_isa());
+}
+BENCHMARK(BM_L3SplitFields);
+
+static void BM_L3SplitFields_Scalar(benchmark::State& state) {
+    const auto& lines = l3_lines();
+    std::string_view fields[L3FeedParser::MAX_FIELDS];
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        for (std::string_view line : lines) {
+            size_t count = 0;
+            size_t start = 0;
+            while (count < L3FeedParser::MAX_FIELDS) {
+                const size_t comma = line.find(',', start);
+                if (comma == std::string_view::npos) {
+                    fields[count++] = line.substr(start);
+                    break;
+                }
+                fields[count++] = line.substr(start, comma - start);
+                start = comma + 1;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * l3_csv().size()));
+}
+BENCHMARK(BM_L3SplitFields_Scalar);
+
+static void BM_FindStructurals(benchmark::State& state) {
+    const std::string& csv = l3_csv();
+    std::vector<uint32_t> offsets(csv.size());
+    const StructuralSet set(',', '\n');
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            find_structurals(csv.data(), csv.size(), set, offsets.data(), offsets.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * csv.size()));
+    state.SetLabel(structural_scanner_isa());
+}
+BENCHMARK(BM_FindStructurals);
+
+// ---------------------------------------------------------------------------
+// Full parsers
+// ---------------------------------------------------------------------------
+
+static void BM_L3ParseFile(benchmark::State& state) {
+    const std::string path = "bench_parser_l3.csv";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << l3_csv();
+    }
+    L3FeedParser parser;
+    if (!parser.open(path)) {
+        state.SkipWithError("cannot open generated CSV");
+        return;
+    }
+    L3Record record;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        parser.reset();
+        while (parser.next(record)) benchmark::DoNotOptimize(record.price);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * parser.file_size()));
+    parser.close();
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_L3ParseFile);
+
+static void BM_FixParse(benchmark::State& state) {
+    const std::string& raw = fix_message();
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        auto msg = fix::FixParser::parse(raw);
+        benchmark::DoNotOptimize(msg.price);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+}
+BENCHMARK(BM_FixParse);
+
+static void BM_FixParseInto(benchmark::State& state) {
+    const std::string& raw = fix_message();
+    OrderMessage om{};
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fix::FixParser::parse_into(raw, om));
+        benchmark::DoNotOptimize(om.order.price);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+}
+BENCHMARK(BM_FixParseInto);
+
+/// Framing plus parse_into of a session stream delivered in 1500-byte reads.
+static void BM_FixFrameAndParse(benchmark::State& state) {
+    const std::string& stream = fix_session();
+    fix::FixFramer framer;
+    OrderMessage om{};
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        framer.reset();
+        for (size_t pos = 0; pos < stream.size();) {
+            size_t space = 0;
+            char* p = framer.prepare(space);
+            const size_t n = std::min({space, size_t{1500}, stream.size() - pos});
+            std::memcpy(p, stream.data() + pos, n);
+            framer.commit(n);
+            pos += n;
+            std::string_view msg;
+            while (framer.next(msg)) {
+                benchmark::DoNotOptimize(fix::FixParser::parse_into(msg, om));
+            }
+        }
+    }
+    if (framer.errors() != 0) state.SkipWithError("framing errors");
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 10000));
+}
+BENCHMARK(BM_FixFrameAndParse);
+
+// ---------------------------------------------------------------------------
+// ClOrdID bindings: a new order, a cancel lookup and the terminal release,
+// with 10k orders open, through ClOrdIdTable and through the string-keyed
+// map a caller would otherwise keep
+// ---------------------------------------------------------------------------
+
+static const std::vector<std::string>& cl_ord_ids() {
+    static const std::vector<std::string> ids = [] {
+        std::vector<std::string> v;
+        for (int i = 0; i < 20000; ++i) v.push_back("TRADER1-20240101-" + std::to_string(i));
+        return v;
+    }();
+    return ids;
+}
+
+static constexpr size_t OPEN_ORDERS = 10000;
+
+static void BM_ClOrdIdTable(benchmark::State& state) {
+    const auto& names = cl_ord_ids();
+    fix::ClOrdIdTable table(2 * OPEN_ORDERS);
+    std::vector<OrderId> open(names.size(), fix::ClOrdIdTable::NO_ORDER);
+    for (size_t i = 0; i < OPEN_ORDERS; ++i) open[i] = table.assign(names[i]);
+    size_t next = OPEN_ORDERS;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        const size_t oldest = (next + names.size() - OPEN_ORDERS) % names.size();
+        open[next] = table.assign(names[next]);
+        benchmark::DoNotOptimize(table.find(names[oldest]));
+        (void)table.release(open[oldest]);
+        next = (next + 1) % names.size();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ClOrdIdTable);
+
+static void BM_ClOrdIdStringMap(benchmark::State& state) {
+    const auto& names = cl_ord_ids();
+    std::unordered_map<std::string, OrderId> table;
+    OrderId next_id = 1;
+    for (size_t i = 0; i < OPEN_ORDERS; ++i) table.emplace(names[i], next_id++);
+    size_t next = OPEN_ORDERS;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        const size_t oldest = (next + names.size() - OPEN_ORDERS) % names.size();
+        // A session builds the key from the view of the raw message
+        table.emplace(std::string(std::string_view(names[next])), next_id++);
+        auto it = table.find(std::string(std::string_view(names[oldest])));
+        benchmark::DoNotOptimize(it->second);
+        table.erase(it);
+        next = (next + 1) % names.size();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ClOrdIdStringMap);
+
+// ---------------------------------------------------------------------------
+// Serializer
+// ---------------------------------------------------------------------------
+
+static EventMessage make_fill_event() {
+    EventMessage ev{};
+    ev.type = EventType::OrderPartialFill;
+    ev.sequence_num = 123456;
+    ev.data.order_event.order_id = 9876543210ULL;
+    ev.data.order_event.filled_quantity = 3;
+    ev.data.order_event.remaining_quantity = 7;
+    ev.data.order_event.price = 4200050000000LL;
+    ev.data.order_event.timestamp = 1704067200000000000ULL;
+    return ev;
+}
+
+static void BM_ExecutionReportString(benchmark::State& state) {
+    const EventMessage ev = make_fill_event();
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fix::FixSerializer::to_execution_report(ev, "BTCUSDT"));
+    }
+}
+BENCHMARK(BM_ExecutionReportString);
+
+static void BM_ExecutionReportWriter(benchmark::State& state) {
+    EventMessage ev = make_fill_event();
+    const fix::ExecutionReportWriter writer("BTCUSDT");
+    std::vector<char> buf(writer.max_report_bytes());
+    size_t bytes = 0;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        ++ev.sequence_num;
+        bytes += writer.write(ev, buf.data(), buf.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ExecutionReportWriter);
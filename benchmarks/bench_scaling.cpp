@@ -0,0 +1,332 @@
+/// @file bench_scaling.cpp
+/// @brief Google Benchmark sweeps over the dimensions where latency
+///        degrades with book size: price range, resident orders, orders
+///        per level, order-map load and instrument count.
+///
+/// The other benchmarks run against a near-empty book, where everything
+/// sits in L1. Each benchmark here first fills a book to a steady state,
+/// then times "replace" operations: cancel a randomly chosen resting order
+/// and add a new one at a random passive price (resting count stays
+/// constant). Comparing the per-op time and the hardware counters
+/// (bench_counters.h) across one argument shows where the book, its order
+/// map or its levels stop fitting a cache level or the TLB reach.
+///
+///   BM_Replace_PriceRange     1k .. 1M ticks, 100k resident orders
+///   BM_Replace_ResidentOrders 1k .. 10M orders over 10k ticks
+///   BM_Replace_OrdersPerLevel 1 .. 4096 orders per level, 100k resident
+///   BM_Fill_OrdersPerLevel    fill the head order of the touch, re-add at the back
+///   BM_Replace_MapLoad        order-map load factor 95% .. 6%, Linear / Group probing
+///   BM_Router_Instruments     1 .. 1024 instruments behind one InstrumentRouter
+///
+/// Run with --benchmark_format=csv (or --benchmark_out) for plotting; the
+/// swept argument is the first column and the user counters carry the
+/// derived shape (orders_per_level, load_factor).
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_counters.h"
+#include "core/order.h"
+#include "core/types.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "matching/matching_engine.h"
+#include "orderbook/flat_order_map.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
+#include "transport/message.h"
+
+using namespace hft;
+
+// ---------------------------------------------------------------------------
+// Constants
+// ---------------------------------------------------------------------------
+
+static constexpr Price TICK = 1'000'000;  // 0.01 in fixed-point
+static constexpr Price MID = 50'000 * PRICE_SCALE;
+
+// Fixed iteration count: GBench then runs each (expensive) setup once
+static constexpr int64_t REPLACES = 1'000'000;
+static constexpr size_t WARMUP_REPLACES = 100'000;
+
+static Order make_order(OrderId id, Side side, OrderType type,
+                        Price price, Quantity qty) {
+    Order o{};
+    o.order_id = id;
+    o.participant_id = 1;
+    o.side = side;
+    o.type = type;
+    o.time_in_force = TimeInForce::GTC;
+    o.status = OrderStatus::New;
+    o.price = price;
+    o.quantity = qty;
+    o.visible_quantity = qty;
+    o.iceberg_slice_qty = 0;
+    o.filled_quantity = 0;
+    o.timestamp = id;
+    o.next = nullptr;
+    o.prev = nullptr;
+    return o;
+}
+
+/// xorshift64: cheap enough not to show in the timed loop.
+struct Rng {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t next() noexcept {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// RestingBook — a book held at `resident` orders over `levels` ticks
+// ---------------------------------------------------------------------------
+
+/// Bids on the `levels / 2` ticks below MID, asks on those above, so adds
+/// never cross. Orders per level average resident / levels.
+class RestingBook {
+public:
+    RestingBook(size_t resident, size_t levels, const OrderBookOptions& options = {},
+                size_t max_orders = 0)
+        : half_(std::max<size_t>(levels / 2, 1)),
+          book_(MID - static_cast<Price>(half_ + 1) * TICK,
+                MID + static_cast<Price>(half_ + 1) * TICK, TICK,
+                max_orders != 0 ? max_orders : resident, options),
+          pool_(resident + 1),
+          ids_(resident) {
+        for (size_t i = 0; i < resident; ++i) ids_[i] = add();
+        for (size_t i = 0; i < WARMUP_REPLACES; ++i) replace();
+    }
+
+    /// Cancel a random resting order, add one at a random passive price.
+    void replace() noexcept {
+        const uint64_t r = rng_.next();
+        const size_t slot = static_cast<size_t>(r % ids_.size());
+        const CancelResult cancelled = book_.cancel_order(ids_[slot]);
+        if (cancelled.success) pool_.deallocate(cancelled.order);
+        ids_[slot] = add();
+    }
+
+    [[nodiscard]] const OrderBook& book() const noexcept { return book_; }
+
+private:
+    OrderId add() noexcept {
+        const uint64_t r = rng_.next();
+        const Side side = (r & 1) ? Side::Buy : Side::Sell;
+        const Price offset = static_cast<Price>(1 + (r >> 1) % half_) * TICK;
+        Order* o = pool_.allocate();
+        *o = make_order(next_id_, side, OrderType::Limit,
+                        side == Side::Buy ? MID - offset : MID + offset, 100);
+        (void)book_.add_order(o);
+        return next_id_++;
+    }
+
+    size_t half_;
+    OrderBook book_;
+    MemoryPool<Order> pool_;
+    std::vector<OrderId> ids_;   // Slot -> resting order id
+    OrderId next_id_ = 1;
+    Rng rng_;
+};
+
+static void run_replaces(benchmark::State& state, RestingBook& book, size_t resident,
+                         size_t levels) {
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        book.replace();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["levels"] = static_cast<double>(levels);
+    state.counters["orders_per_level"] =
+        static_cast<double>(resident) / static_cast<double>(levels);
+    benchmark::DoNotOptimize(book.book().order_count());
+}
+
+// ---------------------------------------------------------------------------
+// Price range, resident orders, orders per level
+// ---------------------------------------------------------------------------
+
+static void BM_Replace_PriceRange(benchmark::State& state) {
+    constexpr size_t RESIDENT = 100'000;
+    const auto levels = static_cast<size_t>(state.range(0));
+    RestingBook book(RESIDENT, levels);
+    run_replaces(state, book, RESIDENT, levels);
+}
+BENCHMARK(BM_Replace_PriceRange)
+    ->ArgName("ticks")
+    ->RangeMultiplier(10)->Range(1'000, 1'000'000)
+    ->Iterations(REPLACES);
+
+static void BM_Replace_ResidentOrders(benchmark::State& state) {
+    constexpr size_t LEVELS = 10'000;
+    const auto resident = static_cast<size_t>(state.range(0));
+    RestingBook book(resident, LEVELS);
+    run_replaces(state, book, resident, LEVELS);
+}
+BENCHMARK(BM_Replace_ResidentOrders)
+    ->ArgName("orders")
+    ->RangeMultiplier(10)->Range(1'000, 10'000'000)
+    ->Iterations(REPLACES);
+
+static void BM_Replace_OrdersPerLevel(benchmark::State& state) {
+    constexpr size_t RESIDENT = 100'000;
+    const auto per_level = static_cast<size_t>(state.range(0));
+    const size_t levels = std::max<size_t>(RESIDENT / per_level, 2);
+    RestingBook book(RESIDENT, levels);
+    run_replaces(state, book, RESIDENT, levels);
+}
+BENCHMARK(BM_Replace_OrdersPerLevel)
+    ->ArgName("per_level")
+    ->RangeMultiplier(8)->Range(1, 4096)
+    ->Iterations(REPLACES);
+
+// ---------------------------------------------------------------------------
+// BM_Fill_OrdersPerLevel — queue depth at the touch
+// ---------------------------------------------------------------------------
+
+/// 16 ask levels of `per_level` orders each (plus bids to keep the book
+/// two-sided). Each iteration an IOC buy fills the head order of the best
+/// ask and a new order joins the back of that level, so the queue walk,
+/// the fill and the re-add all see a level `per_level` orders deep.
+static void BM_Fill_OrdersPerLevel(benchmark::State& state) {
+    constexpr size_t LEVELS = 16;
+    const auto per_level = static_cast<size_t>(state.range(0));
+    const size_t resident = 2 * LEVELS * per_level;
+    OrderBook book(MID - 64 * TICK, MID + 64 * TICK, TICK, resident + 16);
+    MemoryPool<Order> pool(resident + 16);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    OrderId next_id = 1;
+    for (size_t level = 0; level < LEVELS; ++level) {
+        for (size_t i = 0; i < per_level; ++i) {
+            for (Side side : {Side::Buy, Side::Sell}) {
+                const Price offset = static_cast<Price>(level + 1) * TICK;
+                Order* o = pool.allocate();
+                *o = make_order(next_id++, side, OrderType::Limit,
+                                side == Side::Buy ? MID - offset : MID + offset, 1);
+                (void)book.add_order(o);
+            }
+        }
+    }
+
+    const Price touch = MID + TICK;
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        Order* buy = pool.allocate();
+        *buy = make_order(next_id++, Side::Buy, OrderType::Limit, touch, 1);
+        buy->time_in_force = TimeInForce::IOC;
+        auto result = engine.submit_order(buy);
+        benchmark::DoNotOptimize(result);
+
+        Order* sell = pool.allocate();
+        *sell = make_order(next_id++, Side::Sell, OrderType::Limit, touch, 1);
+        (void)book.add_order(sell);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["orders_per_level"] = static_cast<double>(per_level);
+}
+BENCHMARK(BM_Fill_OrdersPerLevel)
+    ->ArgName("per_level")
+    ->RangeMultiplier(8)->Range(1, 32'768)
+    ->Iterations(REPLACES);
+
+// ---------------------------------------------------------------------------
+// BM_Replace_MapLoad — FlatOrderMap load factor and probe strategy
+// ---------------------------------------------------------------------------
+
+/// 1M resting orders in an order-id map of 1x .. 16x the next power of two
+/// (capacity is the next power of two >= 2 * max_orders): load factor 95%
+/// down to 6%.
+static void BM_Replace_MapLoad(benchmark::State& state) {
+    constexpr size_t RESIDENT = 1'000'000;
+    constexpr size_t LEVELS = 10'000;
+    const size_t capacity = next_pow2(RESIDENT) * static_cast<size_t>(state.range(0));
+    OrderBookOptions options;
+    options.order_map_probe = static_cast<OrderMapProbe>(state.range(1));
+
+    RestingBook book(RESIDENT, LEVELS, options, capacity / 2);
+    run_replaces(state, book, RESIDENT, LEVELS);
+    state.counters["load_factor"] = static_cast<double>(RESIDENT) / static_cast<double>(capacity);
+    state.SetLabel(options.order_map_probe == OrderMapProbe::Group ? "group" : "linear");
+}
+BENCHMARK(BM_Replace_MapLoad)
+    ->ArgNames({"capacity_x", "probe"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 1}})
+    ->Iterations(REPLACES);
+
+// ---------------------------------------------------------------------------
+// BM_Router_Instruments — many books behind one InstrumentRouter
+// ---------------------------------------------------------------------------
+
+/// `instruments` books of 1000 resting orders over 2000 ticks each; every
+/// iteration replaces an order on a random instrument through the router,
+/// so the working set grows with the instrument count.
+static void BM_Router_Instruments(benchmark::State& state) {
+    constexpr size_t RESIDENT = 1'000;
+    constexpr Price HALF = 1'000;
+    const auto instruments = static_cast<InstrumentId>(state.range(0));
+
+    InstrumentRegistry registry;
+    for (InstrumentId id = 0; id < instruments; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = "SYM" + std::to_string(id);
+        cfg.min_price = MID - (HALF + 1) * TICK;
+        cfg.max_price = MID + (HALF + 1) * TICK;
+        cfg.tick_size = TICK;
+        cfg.max_orders = RESIDENT + 16;
+        (void)registry.register_instrument(cfg);
+    }
+    InstrumentRouter router(registry, nullptr);
+
+    Rng rng;
+    OrderId next_id = 1;
+    std::vector<OrderId> ids(static_cast<size_t>(instruments) * RESIDENT);
+    auto add = [&](InstrumentId id) {
+        const uint64_t r = rng.next();
+        const Side side = (r & 1) ? Side::Buy : Side::Sell;
+        const Price offset = static_cast<Price>(1 + (r >> 1) % HALF) * TICK;
+        OrderMessage msg{};
+        msg.type = MessageType::Add;
+        msg.instrument_id = id;
+        msg.order = make_order(next_id, side, OrderType::Limit,
+                               side == Side::Buy ? MID - offset : MID + offset, 100);
+        msg.order.instrument_id = id;
+        (void)router.process_order(msg);
+        return next_id++;
+    };
+    auto replace = [&] {
+        const size_t slot = static_cast<size_t>(rng.next() % ids.size());
+        const auto id = static_cast<InstrumentId>(slot / RESIDENT);
+        (void)router.process_cancel(id, ids[slot]);
+        ids[slot] = add(id);
+    };
+    for (size_t slot = 0; slot < ids.size(); ++slot) {
+        ids[slot] = add(static_cast<InstrumentId>(slot / RESIDENT));
+    }
+    for (size_t i = 0; i < WARMUP_REPLACES; ++i) replace();
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        replace();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["resident_orders"] = static_cast<double>(ids.size());
+}
+BENCHMARK(BM_Router_Instruments)
+    ->ArgName("instruments")
+    ->RangeMultiplier(4)->Range(1, 1024)
+    ->Iterations(REPLACES);
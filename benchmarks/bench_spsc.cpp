@@ -1,13 +1,17 @@
 /// @file bench_spsc.cpp
-/// @brief Throughput and latency benchmarks for SPSC ring buffer.
+/// @brief Throughput and latency benchmarks for the SPSC / MPSC ring buffers.
 
 #include <atomic>
 #include <cstdint>
 #include <thread>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 
+#include "bench_counters.h"
+#include "transport/ingress_buffer.h"
 #include "transport/message.h"
+#include "transport/mpsc_ring_buffer.h"
 #include "transport/spsc_ring_buffer.h"
 
 using namespace hft;
@@ -20,6 +24,7 @@ static void BM_SPSCPushPop(benchmark::State& state) {
     SPSCRingBuffer<uint64_t, 1024> rb;
     uint64_t val = 0;
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         (void)rb.try_push(val);
         (void)rb.try_pop(val);
@@ -39,6 +44,7 @@ static void BM_SPSCPushPop_EventMessage(benchmark::State& state) {
 
     EventMessage out{};
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         (void)rb.try_push(msg);
         (void)rb.try_pop(out);
@@ -57,6 +63,7 @@ static void BM_SPSCPushPop_OrderMessage(benchmark::State& state) {
 
     OrderMessage out{};
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         (void)rb.try_push(msg);
         (void)rb.try_pop(out);
@@ -72,6 +79,7 @@ BENCHMARK(BM_SPSCPushPop_OrderMessage);
 static void BM_SPSCThroughput(benchmark::State& state) {
     const size_t count = static_cast<size_t>(state.range(0));
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         SPSCRingBuffer<uint64_t, 8192> rb;
         std::atomic<bool> producer_done{false};
@@ -108,6 +116,7 @@ BENCHMARK(BM_SPSCThroughput)->Arg(1'000'000)->Arg(10'000'000);
 static void BM_SPSCThroughput_EventMessage(benchmark::State& state) {
     const size_t count = static_cast<size_t>(state.range(0));
 
+    ScopedBenchCounters counters(state);
     for (auto _ : state) {
         SPSCRingBuffer<EventMessage, 8192> rb;
 
@@ -138,3 +147,159 @@ static void BM_SPSCThroughput_EventMessage(benchmark::State& state) {
                             state.range(0));
 }
 BENCHMARK(BM_SPSCThroughput_EventMessage)->Arg(1'000'000);
+
+// ---------------------------------------------------------------------------
+// Batch-size sweeps: one index publish per batch (range(0) = batch size)
+// ---------------------------------------------------------------------------
+
+static void BM_SPSCPushPopBatch_EventMessage(benchmark::State& state) {
+    const size_t batch = static_cast<size_t>(state.range(0));
+    SPSCRingBuffer<EventMessage, 1024> rb;
+    EventMessage in[64] = {};
+    EventMessage out[64];
+    for (size_t i = 0; i < batch; ++i) {
+        in[i].type = EventType::Trade;
+        in[i].sequence_num = i;
+    }
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        (void)rb.try_push_n(in, batch);
+        benchmark::DoNotOptimize(rb.try_pop_n(out, batch));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(BM_SPSCPushPopBatch_EventMessage)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_SPSCThroughputBatch_EventMessage(benchmark::State& state) {
+    constexpr size_t count = 1'000'000;
+    const size_t batch = static_cast<size_t>(state.range(0));
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        SPSCRingBuffer<EventMessage, 8192> rb;
+
+        std::thread consumer([&] {
+            EventMessage out[64];
+            size_t popped = 0;
+            while (popped < count) {
+                size_t n = rb.try_pop_n(out, batch);
+                benchmark::DoNotOptimize(out);
+                popped += n;
+            }
+        });
+
+        EventMessage in[64] = {};
+        for (size_t sent = 0; sent < count;) {
+            size_t n = (count - sent < batch) ? count - sent : batch;
+            for (size_t i = 0; i < n; ++i) {
+                in[i].type = EventType::Trade;
+                in[i].sequence_num = sent + i;
+            }
+            for (size_t pushed = 0; pushed < n;) {
+                pushed += rb.try_push_n(in + pushed, n - pushed);
+            }
+            sent += n;
+        }
+
+        consumer.join();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(count));
+}
+BENCHMARK(BM_SPSCThroughputBatch_EventMessage)
+    ->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+// ---------------------------------------------------------------------------
+// Zero-copy: build in place with claim()/commit(), read with peek()/release()
+// ---------------------------------------------------------------------------
+
+static void BM_SPSCThroughputClaim_EventMessage(benchmark::State& state) {
+    constexpr size_t count = 1'000'000;
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        SPSCRingBuffer<EventMessage, 8192> rb;
+
+        std::thread consumer([&] {
+            size_t popped = 0;
+            while (popped < count) {
+                if (const EventMessage* msg = rb.peek()) {
+                    benchmark::DoNotOptimize(msg->sequence_num);
+                    rb.release();
+                    ++popped;
+                }
+            }
+        });
+
+        for (uint64_t i = 0; i < count; ++i) {
+            EventMessage* slot;
+            while ((slot = rb.claim()) == nullptr) {
+                // spin
+            }
+            slot->type = EventType::Trade;
+            slot->sequence_num = i;
+            rb.commit();
+        }
+
+        consumer.join();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(count));
+}
+BENCHMARK(BM_SPSCThroughputClaim_EventMessage);
+
+// ---------------------------------------------------------------------------
+// MPSC ingress contention: range(0) producers share one OrderMessage queue
+// ---------------------------------------------------------------------------
+
+static void BM_MPSCThroughput_OrderMessage(benchmark::State& state) {
+    const size_t producers = static_cast<size_t>(state.range(0));
+    constexpr size_t per_producer = 250'000;
+    const size_t total = producers * per_producer;
+    auto queue = std::make_unique<IngressBuffer>();
+    uint64_t failed_pushes = 0;
+
+    ScopedBenchCounters counters(state);
+    for (auto _ : state) {
+        std::atomic<uint64_t> failed{0};
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                OrderMessage msg{};
+                msg.type = MessageType::Add;
+                msg.order.participant_id = static_cast<ParticipantId>(p);
+                uint64_t local_failed = 0;
+                for (size_t i = 0; i < per_producer; ++i) {
+                    msg.order.order_id = i;
+                    while (!queue->try_push(msg)) {
+                        ++local_failed;  // full: spin
+                    }
+                }
+                failed.fetch_add(local_failed, std::memory_order_relaxed);
+            });
+        }
+
+        OrderMessage out[32];
+        for (size_t popped = 0; popped < total;) {
+            size_t n = queue->try_pop_n(out, 32);
+            benchmark::DoNotOptimize(out);
+            popped += n;
+        }
+        for (auto& t : threads) t.join();
+        failed_pushes += failed.load(std::memory_order_relaxed);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(total));
+    state.counters["full_spins_per_msg"] = benchmark::Counter(
+        static_cast<double>(failed_pushes) /
+        static_cast<double>(state.iterations() * total));
+}
+BENCHMARK(BM_MPSCThroughput_OrderMessage)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
@@ -0,0 +1,405 @@
+/// @file bench_workload.cpp
+/// @brief Workload-driven benchmark: realistic order flow through the
+///        gateway, with latency percentiles and throughput per message type.
+///
+/// The microbenchmarks (bench_matching, bench_orderbook) time one operation
+/// against a sentinel-guarded, mostly empty book. This harness instead
+/// replays whole sessions: recorded L3 traces (CSV or binary, see
+/// load_workload) and synthetic flow from generate_workload (Poisson
+/// arrivals, power-law distance from the touch, cancel/modify-to-add
+/// ratios). Each workload runs twice on a fresh book:
+///   - latency pass: every message through OrderGateway::process() alone,
+///     timed with rdtsc and filed under its outcome (add that rested / add
+///     that matched / cancel / cancel of a missing order / modify / modify
+///     rejected);
+///   - throughput pass: process_batch() over fixed-size batches, or over
+///     the messages arriving within each --batch-window-ns of feed time.
+/// Events go to an EventBuffer drained outside the timed regions.
+///
+/// Standalone executable — does NOT use Google Benchmark.
+///
+/// Usage:
+///   bench_workload                          # sample trace + synthetic profiles
+///   bench_workload --trace day.l3b --passes 1
+///   bench_workload --synthetic --messages 2000000 --cancel-ratio 0.97 --alpha 1.2
+///   bench_workload --csv results.csv        # one row per workload and type
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/order.h"
+#include "core/types.h"
+#include "feed/workload_generator.h"
+#include "gateway/order_gateway.h"
+#include "matching/matching_engine.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
+#include "transport/event_buffer.h"
+#include "transport/message.h"
+#include "utils/clock.h"
+#include "utils/latency_histogram.h"
+#include "utils/thread_placement.h"
+
+using namespace hft;
+
+// ---------------------------------------------------------------------------
+// Message outcomes
+// ---------------------------------------------------------------------------
+
+enum class Outcome : uint8_t { AddRested, AddMatched, Cancel, CancelMiss, Modify, ModifyReject };
+
+static constexpr size_t OUTCOME_COUNT = 6;
+
+static const char* outcome_name(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::AddRested: return "add_rested";
+        case Outcome::AddMatched: return "add_matched";
+        case Outcome::Cancel: return "cancel";
+        case Outcome::CancelMiss: return "cancel_miss";
+        case Outcome::Modify: return "modify";
+        case Outcome::ModifyReject: return "modify_reject";
+    }
+    return "unknown";
+}
+
+static Outcome classify(const OrderMessage& msg, const GatewayResult& result) {
+    switch (msg.type) {
+        case MessageType::Add:
+            return result.trade_count != 0 ? Outcome::AddMatched : Outcome::AddRested;
+        case MessageType::Cancel:
+            return result.accepted ? Outcome::Cancel : Outcome::CancelMiss;
+        case MessageType::Modify:
+            return result.accepted ? Outcome::Modify : Outcome::ModifyReject;
+    }
+    return Outcome::AddRested;
+}
+
+// ---------------------------------------------------------------------------
+// Engine under test
+// ---------------------------------------------------------------------------
+
+/// A fresh book sized for `workload`, with the gateway publishing events.
+struct Pipeline {
+    explicit Pipeline(const Workload& workload) {
+        const Price margin = 16 * workload.tick_size;
+        const Price low = std::max<Price>(workload.tick_size, workload.min_price - margin);
+        const size_t max_orders = workload.adds + 1024;
+        book = std::make_unique<OrderBook>(low, workload.max_price + margin, workload.tick_size,
+                                           max_orders);
+        pool = std::make_unique<MemoryPool<Order>>(max_orders);
+        // Feeds carry no participant: STP off, as in ReplayEngine
+        engine = std::make_unique<MatchingEngine>(*book, *pool, SelfTradePreventionMode::None);
+        events = std::make_unique<EventBuffer>();
+        gateway = std::make_unique<OrderGateway>(*engine, *pool, events.get());
+    }
+
+    void drain_events() {
+        while (events->try_pop_n(drained.data(), drained.size()) != 0) {
+        }
+    }
+
+    std::unique_ptr<OrderBook> book;
+    std::unique_ptr<MemoryPool<Order>> pool;
+    std::unique_ptr<MatchingEngine> engine;
+    std::unique_ptr<EventBuffer> events;
+    std::unique_ptr<OrderGateway> gateway;
+    std::array<EventMessage, 256> drained{};
+};
+
+struct Options {
+    std::vector<std::string> traces;
+    bool synthetic = false;          // Only the --synthetic workload, from the flags
+    WorkloadConfig generator;
+    size_t passes = 0;               // Trace repetitions (0 = enough for ~500k messages)
+    size_t batch_size = 64;
+    uint64_t batch_window_ns = 0;    // Batch by arrival time instead
+    std::string csv_path;
+};
+
+struct WorkloadResult {
+    std::array<LatencyStats, OUTCOME_COUNT> latency{};
+    double messages_per_second = 0.0;
+    double mean_batch = 0.0;
+    size_t messages = 0;
+};
+
+static uint64_t g_rdtsc_overhead = 0;
+
+static WorkloadResult run_workload(const Workload& workload, const Options& options,
+                                   double tsc_freq) {
+    WorkloadResult result;
+    const size_t passes =
+        options.passes != 0
+            ? options.passes
+            : std::max<size_t>(1, 500'000 / std::max<size_t>(workload.messages.size(), 1));
+
+    std::array<LatencyHistogram, OUTCOME_COUNT> latency;
+    for (LatencyHistogram& h : latency) {
+        h.set_tsc_frequency(tsc_freq);
+        h.set_overhead(g_rdtsc_overhead);
+    }
+
+    // Latency pass: one message per call
+    for (size_t pass = 0; pass < passes; ++pass) {
+        Pipeline p(workload);
+        for (const OrderMessage& msg : workload.messages) {
+            const uint64_t t0 = rdtsc_start();
+            const GatewayResult r = p.gateway->process(msg);
+            const uint64_t t1 = rdtsc_end();
+            latency[static_cast<size_t>(classify(msg, r))].record(t1 - t0);
+            p.drain_events();
+        }
+    }
+    for (size_t i = 0; i < OUTCOME_COUNT; ++i) result.latency[i] = latency[i].compute();
+
+    // Throughput pass: batches, timed per process_batch
+    const size_t batch_size = std::max<size_t>(options.batch_size, 1);
+    std::vector<GatewayResult> results(workload.messages.size());
+    uint64_t ticks = 0;
+    size_t batches = 0;
+    for (size_t pass = 0; pass < passes; ++pass) {
+        Pipeline p(workload);
+        const OrderMessage* msgs = workload.messages.data();
+        const size_t n = workload.messages.size();
+        for (size_t begin = 0; begin < n;) {
+            size_t end = std::min(n, begin + batch_size);
+            if (options.batch_window_ns != 0) {
+                // Everything that arrived within the window, up to the
+                // event ring's comfort
+                const Timestamp close = msgs[begin].order.timestamp + options.batch_window_ns;
+                end = begin + 1;
+                while (end < n && end - begin < 4096 && msgs[end].order.timestamp < close) ++end;
+            }
+            const uint64_t t0 = rdtsc_start();
+            p.gateway->process_batch(msgs + begin, end - begin, results.data() + begin);
+            ticks += rdtsc_end() - t0;
+            p.drain_events();
+            ++batches;
+            begin = end;
+        }
+        result.messages += n;
+    }
+    const double seconds = static_cast<double>(ticks) / tsc_freq * 1e-9;
+    result.messages_per_second = seconds > 0.0 ? static_cast<double>(result.messages) / seconds
+                                               : 0.0;
+    result.mean_batch = static_cast<double>(result.messages) / static_cast<double>(batches);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Reporting
+// ---------------------------------------------------------------------------
+
+static void print_result(const Workload& workload, const WorkloadResult& result,
+                         const Options& options) {
+    std::cout << "\n=== " << workload.name << " (" << workload.messages.size() << " messages: "
+              << workload.adds << " adds, " << workload.cancels << " cancels, "
+              << workload.modifies << " modifies) ===\n";
+    std::cout << "  " << std::left << std::setw(14) << "type" << std::right << std::setw(10)
+              << "count" << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9)
+              << "p99" << std::setw(9) << "p99.9" << std::setw(10) << "max" << std::setw(9)
+              << "mean" << std::setw(12) << "M ops/s" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < OUTCOME_COUNT; ++i) {
+        const LatencyStats& s = result.latency[i];
+        if (s.sample_count == 0) continue;
+        std::cout << "  " << std::left << std::setw(14) << outcome_name(static_cast<Outcome>(i))
+                  << std::right << std::setw(10) << s.sample_count << std::setw(9) << s.p50_ns
+                  << std::setw(9) << s.p90_ns << std::setw(9) << s.p99_ns << std::setw(9)
+                  << s.p99_9_ns << std::setw(10) << s.max_ns << std::setw(9) << s.mean_ns
+                  << std::setw(12) << std::setprecision(2)
+                  << (s.mean_ns > 0.0 ? 1e3 / s.mean_ns : 0.0) << std::setprecision(1) << "\n";
+    }
+    std::cout << "  (latencies in ns; M ops/s = 1 / mean, one message per call)\n";
+    std::cout << "  Batched throughput: " << std::setprecision(2)
+              << result.messages_per_second / 1e6 << " M msgs/s over " << result.messages
+              << " messages, mean batch " << std::setprecision(1) << result.mean_batch;
+    if (options.batch_window_ns != 0) {
+        std::cout << " (" << options.batch_window_ns << " ns arrival windows)\n";
+    } else {
+        std::cout << " (fixed)\n";
+    }
+}
+
+static void write_csv_rows(std::ofstream& out, const Workload& workload,
+                           const WorkloadResult& result) {
+    for (size_t i = 0; i < OUTCOME_COUNT; ++i) {
+        const LatencyStats& s = result.latency[i];
+        if (s.sample_count == 0) continue;
+        out << workload.name << "," << outcome_name(static_cast<Outcome>(i)) << ","
+            << s.sample_count << "," << s.p50_ns << "," << s.p90_ns << "," << s.p99_ns << ","
+            << s.p99_9_ns << "," << s.max_ns << "," << s.mean_ns << ","
+            << result.messages_per_second << "\n";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------
+
+static void print_usage(const char* program) {
+    std::cerr
+        << "Usage: " << program << " [options]\n"
+        << "  --trace <path>           Recorded L3 trace, CSV or binary (repeatable)\n"
+        << "  --synthetic              Run one synthetic workload from the flags below\n"
+        << "  --messages <n>           Synthetic messages (default 1000000)\n"
+        << "  --cancel-ratio <r>       Cancels per add (default 0.9)\n"
+        << "  --modify-ratio <r>       Modifies per add (default 0.1)\n"
+        << "  --aggressive <f>         Fraction of adds crossing the spread (default 0.05)\n"
+        << "  --alpha <a>              Power-law exponent of distance from touch (default 1.5)\n"
+        << "  --max-distance <ticks>   Cap of that distance (default 500)\n"
+        << "  --rate <msgs/s>          Poisson arrival rate in feed time (default 1000000)\n"
+        << "  --seed <n>               Generator seed (default 42)\n"
+        << "  --passes <n>             Runs of each workload (default: ~500k messages)\n"
+        << "  --batch <n>              Messages per process_batch (default 64)\n"
+        << "  --batch-window-ns <ns>   Batch by arrival window instead of fixed size\n"
+        << "  --csv <path>             Write one row per workload and message type\n"
+        << "Without --trace or --synthetic: data/btcusdt_l3_sample.csv and three\n"
+        << "synthetic profiles (balanced, cancel_heavy, aggressive).\n";
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a value\n";
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char* v = nullptr;
+        if (std::strcmp(arg, "--synthetic") == 0) {
+            options.synthetic = true;
+            continue;
+        }
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) return false;
+        if ((v = value()) == nullptr) return false;
+        if (std::strcmp(arg, "--trace") == 0) {
+            options.traces.emplace_back(v);
+        } else if (std::strcmp(arg, "--messages") == 0) {
+            options.generator.messages = std::strtoull(v, nullptr, 10);
+        } else if (std::strcmp(arg, "--cancel-ratio") == 0) {
+            options.generator.cancel_to_add = std::atof(v);
+        } else if (std::strcmp(arg, "--modify-ratio") == 0) {
+            options.generator.modify_to_add = std::atof(v);
+        } else if (std::strcmp(arg, "--aggressive") == 0) {
+            options.generator.aggressive_fraction = std::atof(v);
+        } else if (std::strcmp(arg, "--alpha") == 0) {
+            options.generator.distance_alpha = std::atof(v);
+        } else if (std::strcmp(arg, "--max-distance") == 0) {
+            options.generator.max_distance_ticks = static_cast<uint32_t>(std::atoi(v));
+        } else if (std::strcmp(arg, "--rate") == 0) {
+            options.generator.arrival_rate = std::atof(v);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.generator.seed = std::strtoull(v, nullptr, 10);
+        } else if (std::strcmp(arg, "--passes") == 0) {
+            options.passes = std::strtoull(v, nullptr, 10);
+        } else if (std::strcmp(arg, "--batch") == 0) {
+            options.batch_size = std::strtoull(v, nullptr, 10);
+        } else if (std::strcmp(arg, "--batch-window-ns") == 0) {
+            options.batch_window_ns = std::strtoull(v, nullptr, 10);
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            options.csv_path = v;
+        } else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.generator.messages == 0 || options.generator.arrival_rate <= 0.0) {
+        std::cerr << "Error: --messages and --rate must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Workload> workloads;
+    std::vector<std::string> traces = options.traces;
+    if (traces.empty() && !options.synthetic) {
+        for (const char* path : {"data/btcusdt_l3_sample.csv", "../data/btcusdt_l3_sample.csv"}) {
+            if (std::filesystem::exists(path)) {
+                traces.emplace_back(path);
+                break;
+            }
+        }
+    }
+    for (const std::string& path : traces) {
+        Workload workload;
+        std::string error;
+        if (!load_workload(path, workload, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        workloads.push_back(std::move(workload));
+    }
+    if (options.synthetic) {
+        workloads.push_back(generate_workload(options.generator));
+    } else if (options.traces.empty()) {
+        WorkloadConfig balanced = options.generator;
+        workloads.push_back(generate_workload(balanced));
+        workloads.back().name = "balanced";
+
+        WorkloadConfig cancel_heavy = options.generator;
+        cancel_heavy.cancel_to_add = 0.97;
+        cancel_heavy.modify_to_add = 0.02;
+        cancel_heavy.distance_alpha = 1.2;
+        workloads.push_back(generate_workload(cancel_heavy));
+        workloads.back().name = "cancel_heavy";
+
+        WorkloadConfig aggressive = options.generator;
+        aggressive.aggressive_fraction = 0.25;
+        aggressive.cancel_to_add = 0.6;
+        workloads.push_back(generate_workload(aggressive));
+        workloads.back().name = "aggressive";
+    }
+
+    std::cout << "================================================================\n";
+    std::cout << " HFT Order Book Engine — Workload Benchmark\n";
+    std::cout << "================================================================\n\n";
+
+#ifndef _WIN32
+    ThreadingConfig threading;
+    threading.matching_cpus = {0};
+    ScopedThreadPlacement placement(threading, ThreadRole::Matching);
+#endif
+    const double tsc_freq = calibrate_tsc_frequency();
+    g_rdtsc_overhead = measure_rdtsc_overhead();
+    std::cout << "TSC frequency: " << std::fixed << std::setprecision(3) << tsc_freq
+              << " ticks/ns, rdtsc overhead " << g_rdtsc_overhead << " ticks\n";
+
+    std::ofstream csv;
+    if (!options.csv_path.empty()) {
+        csv.open(options.csv_path);
+        if (!csv.is_open()) {
+            std::cerr << "Error: cannot write " << options.csv_path << "\n";
+            return 1;
+        }
+        csv << "workload,type,count,p50_ns,p90_ns,p99_ns,p99_9_ns,max_ns,mean_ns,"
+               "batched_msgs_per_s\n";
+    }
+
+    for (const Workload& workload : workloads) {
+        const WorkloadResult result = run_workload(workload, options, tsc_freq);
+        print_result(workload, result, options);
+        if (csv.is_open()) write_csv_rows(csv, workload, result);
+    }
+    if (csv.is_open()) std::cout << "\nResults written to: " << options.csv_path << "\n";
+    return 0;
+}
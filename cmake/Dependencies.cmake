@@ -39,6 +39,15 @@ else()
     message(STATUS "TBB not found — install via 'sudo apt install libtbb-dev' when needed (Phase 7)")
 endif()
 
+# Compression codecs — compressed replay input (cold path only). Each is
+# optional: zlib1g-dev, libzstd-dev, liblz4-dev
+find_package(ZLIB QUIET)
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARY NAMES zstd)
+find_path(LZ4_INCLUDE_DIR lz4frame.h)
+find_library(LZ4_LIBRARY NAMES lz4)
+message(STATUS "Compressed input: zlib=${ZLIB_FOUND} zstd=${ZSTD_LIBRARY} lz4=${LZ4_LIBRARY}")
+
 # pybind11 — Python bindings (cold path only, guarded by option)
 if(BUILD_PYTHON_BINDINGS)
     FetchContent_Declare(pybind11
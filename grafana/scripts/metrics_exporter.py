@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Scrape the engine's shared-memory metrics region into InfluxDB.
+
+The replay (./build/replay --metrics <name>) publishes live counters,
+gauges and latency histograms in /dev/shm/<name> (see
+src/gateway/metrics_region.h). This sidecar maps the region read-only,
+samples it every --interval seconds and writes one point per metric to
+the 'engine_metrics' measurement, tagged with the metric name and its
+writer thread. Counters also get a per-second rate; histograms are
+reported as count / mean / p50 / p99 / p99.9 / max (TSC-tick histograms,
+named *_ticks, are converted to *_ns with the region's clock.tsc_per_us).
+
+Usage:
+    python metrics_exporter.py --name hft_metrics
+    python metrics_exporter.py --name hft_metrics --stdout   # line protocol, no InfluxDB
+"""
+
+import argparse
+import mmap
+import os
+import struct
+import sys
+import time
+
+DEFAULT_URL = "http://localhost:8086"
+DEFAULT_TOKEN = "hft-dev-token"
+DEFAULT_ORG = "hft-engine"
+DEFAULT_BUCKET = "analytics"
+MEASUREMENT = "engine_metrics"
+
+MAGIC = b"HFTMETR1"
+VERSION = 1
+HEADER = struct.Struct("<8sIIIIIIIIQQQ")     # MetricsHeader, 64 bytes
+SLOT = struct.Struct("<40sIIQQ")             # MetricSlot, 64 bytes
+STORAGE = struct.Struct("<QQQQ")             # HdrHistogram::Storage: total, sum, min, max
+COUNTER, GAUGE, HISTOGRAM = 1, 2, 3
+PERCENTILES = (("p50", 0.50), ("p99", 0.99), ("p99_9", 0.999))
+
+
+class Region:
+    """Read-only view of one metrics region."""
+
+    def __init__(self, name):
+        self.path = "/dev/shm/" + name.lstrip("/")
+        fd = os.open(self.path, os.O_RDONLY)
+        try:
+            self.size = os.fstat(fd).st_size
+            self.map = mmap.mmap(fd, self.size, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        self.inode = os.stat(self.path).st_ino
+        (magic, version, self.slot_capacity, self.histogram_capacity, self.buckets,
+         self.sub_bucket_bits, self.pid, _, _, self.histogram_offset,
+         self.histogram_stride, _) = HEADER.unpack_from(self.map, 0)
+        if magic != MAGIC or version != VERSION:
+            self.map.close()
+            raise ValueError(f"{self.path}: not a version {VERSION} metrics region")
+
+    def replaced(self):
+        """True once the engine is gone or has created a new region."""
+        try:
+            return os.stat(self.path).st_ino != self.inode
+        except FileNotFoundError:
+            return True
+
+    def slots(self):
+        slot_count = HEADER.unpack_from(self.map, 0)[7]
+        for i in range(min(slot_count, self.slot_capacity)):
+            raw, kind, thread, value, _ = SLOT.unpack_from(self.map, HEADER.size + SLOT.size * i)
+            yield raw.split(b"\0", 1)[0].decode(), kind, thread, value
+
+    def histogram(self, index):
+        offset = self.histogram_offset + self.histogram_stride * index
+        total, total_sum, low, high = STORAGE.unpack_from(self.map, offset)
+        counts = struct.unpack_from(f"<{self.buckets}Q", self.map, offset + STORAGE.size)
+        return total, total_sum, low, high, counts
+
+    def close(self):
+        self.map.close()
+
+
+def bucket_bounds(i, sub_bucket_bits):
+    """Smallest and largest value of bucket i (HdrHistogram::bucket_lowest / _highest)."""
+    sub_buckets = 1 << sub_bucket_bits
+    if i < 2 * sub_buckets:
+        return i, i
+    shift = i // sub_buckets - 1
+    low = (i - shift * sub_buckets) << shift
+    return low, low + (1 << shift) - 1
+
+
+def percentiles(total, low, high, counts, sub_bucket_bits):
+    """Values at each PERCENTILES rank, as HdrHistogram::value_at_percentile."""
+    result = {}
+    if total == 0:
+        return {key: 0 for key, _ in PERCENTILES}
+    ranks = sorted((int(p * (total - 1)), key) for key, p in PERCENTILES)
+    seen = 0
+    r = 0
+    for i, c in enumerate(counts):
+        if c == 0:
+            continue
+        seen += c
+        while r < len(ranks) and seen > ranks[r][0]:
+            lo, hi = bucket_bounds(i, sub_bucket_bits)
+            mid = lo + (hi - lo) // 2
+            result[ranks[r][1]] = min(max(mid, low), high)
+            r += 1
+        if r == len(ranks):
+            break
+    for _, key in ranks[r:]:
+        result[key] = high
+    return result
+
+
+def scrape(region, previous, now):
+    """One sample of every metric: [(name, thread, fields)]."""
+    slots = list(region.slots())
+    tsc_per_us = next((v for n, k, _, v in slots if n == "clock.tsc_per_us" and k == GAUGE), 0)
+    samples = []
+    for name, kind, thread, value in slots:
+        if kind == COUNTER:
+            fields = {"value": value}
+            last = previous.get((name, thread))
+            if last is not None and now > last[1]:
+                fields["rate"] = (value - last[0]) / (now - last[1])
+            previous[(name, thread)] = (value, now)
+        elif kind == GAUGE:
+            fields = {"value": value - (1 << 64) if value >= (1 << 63) else value}
+        elif kind == HISTOGRAM:
+            total, total_sum, low, high, counts = region.histogram(value)
+            fields = percentiles(total, low, high, counts, region.sub_bucket_bits)
+            fields["mean"] = total_sum / total if total else 0.0
+            fields["max"] = high
+            scale = 1.0
+            if name.endswith("_ticks") and tsc_per_us > 0:
+                name = name[:-len("_ticks")] + "_ns"
+                scale = 1000.0 / tsc_per_us
+            fields = {k: v * scale for k, v in fields.items()}
+            fields["count"] = total
+        else:
+            continue
+        samples.append((name, thread, fields))
+    return samples
+
+
+def line_protocol(name, thread, fields, timestamp_ns):
+    values = ",".join(f"{k}={v}i" if isinstance(v, int) else f"{k}={v}"
+                      for k, v in fields.items())
+    return f"{MEASUREMENT},metric={name},thread={thread} {values} {timestamp_ns}"
+
+
+def attach(name, retries):
+    """Map the region, waiting up to `retries` seconds for the engine."""
+    for i in range(retries + 1):
+        try:
+            return Region(name)
+        except FileNotFoundError:
+            if i < retries:
+                time.sleep(1)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Export the engine's shared-memory metrics to InfluxDB"
+    )
+    parser.add_argument("--name", default="hft_metrics",
+                        help="Region name (replay --metrics <name>)")
+    parser.add_argument("--interval", type=float, default=1.0, help="Seconds between scrapes")
+    parser.add_argument("--wait", type=int, default=60,
+                        help="Seconds to wait for the region to appear")
+    parser.add_argument("--stdout", action="store_true",
+                        help="Print InfluxDB line protocol instead of writing it")
+    parser.add_argument("--url", default=DEFAULT_URL, help="InfluxDB URL")
+    parser.add_argument("--token", default=DEFAULT_TOKEN, help="InfluxDB token")
+    parser.add_argument("--org", default=DEFAULT_ORG, help="InfluxDB org")
+    parser.add_argument("--bucket", default=DEFAULT_BUCKET, help="InfluxDB bucket")
+    args = parser.parse_args()
+
+    write = None
+    client = None
+    if args.stdout:
+        def write(lines):
+            print("\n".join(lines), flush=True)
+    else:
+        try:
+            from influxdb_client import InfluxDBClient
+            from influxdb_client.client.write_api import SYNCHRONOUS
+        except ImportError:
+            print("ERROR: influxdb-client not installed.")
+            print("  pip install influxdb-client>=1.36.0")
+            sys.exit(1)
+        client = InfluxDBClient(url=args.url, token=args.token, org=args.org)
+        write_api = client.write_api(write_options=SYNCHRONOUS)
+
+        def write(lines):
+            write_api.write(bucket=args.bucket, org=args.org, record=lines)
+
+    region = attach(args.name, args.wait)
+    if region is None:
+        print(f"ERROR: no metrics region /dev/shm/{args.name.lstrip('/')}")
+        print("  Start the replay with: ./build/replay --input <file> --metrics "
+              f"{args.name.lstrip('/')}")
+        sys.exit(1)
+    print(f"Exporting {region.path} (engine pid {region.pid}) every {args.interval} s",
+          file=sys.stderr)
+
+    previous = {}
+    try:
+        while True:
+            now = time.time()
+            samples = scrape(region, previous, now)
+            stamp = int(now * 1e9)
+            write([line_protocol(n, t, f, stamp) for n, t, f in samples])
+            if region.replaced():
+                region.close()
+                print("Engine exited; metrics region closed", file=sys.stderr)
+                break
+            time.sleep(max(0.0, args.interval - (time.time() - now)))
+    except KeyboardInterrupt:
+        region.close()
+    if client is not None:
+        client.close()
+
+
+if __name__ == "__main__":
+    main()
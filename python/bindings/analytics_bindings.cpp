@@ -1,14 +1,27 @@
 /// @file analytics_bindings.cpp
 /// @brief pybind11 bindings for AnalyticsEngine, all 6 analytics modules,
-///        and MultiInstrumentAnalytics.
+///        bar aggregation, MultiInstrumentAnalytics, the time-series
+///        column file and the numpy batch kernels (submodule `batch`).
 
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 #include "analytics/analytics_config.h"
 #include "analytics/analytics_engine.h"
+#include "analytics/bar_aggregator.h"
+#include "analytics/batch_analytics.h"
 #include "analytics/depth_profile.h"
 #include "analytics/microprice_calculator.h"
 #include "analytics/multi_instrument_analytics.h"
@@ -16,20 +29,156 @@
 #include "analytics/price_impact.h"
 #include "analytics/realized_volatility.h"
 #include "analytics/spread_analytics.h"
+#include "analytics/time_series_columns.h"
 #include "core/types.h"
 #include "gateway/instrument_router.h"
 #include "orderbook/order_book.h"
 #include "transport/message.h"
 
 #include "converters.h"
+#include "numpy_views.h"
 
 namespace py = pybind11;
 
 namespace hft {
 namespace python {
 
+namespace {
+
+size_t time_series_column_index(const std::string& name) {
+    for (size_t c = 0; c < TIME_SERIES_COLUMN_COUNT; ++c) {
+        if (name == TIME_SERIES_COLUMNS[c].name) return c;
+    }
+    throw py::key_error(name);
+}
+
+py::dtype time_series_dtype(const TimeSeriesColumnInfo& info) {
+    return py::dtype(std::string("<") + info.kind + std::to_string(info.width));
+}
+
+/// TimeSeriesRow as a structured dtype (fields in declaration order).
+py::dtype time_series_row_dtype() {
+    return structured_dtype({
+        view_field<uint64_t>("sequence_num", offsetof(TimeSeriesRow, sequence_num)),
+        view_field<Timestamp>("timestamp", offsetof(TimeSeriesRow, timestamp)),
+        view_field<Price>("trade_price", offsetof(TimeSeriesRow, trade_price)),
+        view_field<Quantity>("trade_quantity", offsetof(TimeSeriesRow, trade_quantity)),
+        view_field<Price>("spread", offsetof(TimeSeriesRow, spread)),
+        view_field<double>("spread_bps", offsetof(TimeSeriesRow, spread_bps)),
+        view_field<double>("microprice", offsetof(TimeSeriesRow, microprice)),
+        view_field<double>("imbalance", offsetof(TimeSeriesRow, imbalance)),
+        view_field<double>("tick_vol", offsetof(TimeSeriesRow, tick_vol)),
+        view_field<double>("depth_imbalance", offsetof(TimeSeriesRow, depth_imbalance)),
+        view_field<Side>("aggressor_side", offsetof(TimeSeriesRow, aggressor_side)),
+    }, sizeof(TimeSeriesRow));
+}
+
+/// Read-only view of a vector of quantities owned by `owner`.
+py::array quantity_view(const std::vector<Quantity>& values, py::handle owner) {
+    return readonly_view(py::dtype::of<Quantity>(), values.size(), values.data(), owner);
+}
+
+template <typename T>
+using Column = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+/// Check that every column has `rows` entries.
+void check_rows(size_t rows, std::initializer_list<py::ssize_t> sizes) {
+    for (py::ssize_t size : sizes) {
+        if (static_cast<size_t>(size) != rows) throw py::value_error("columns differ in length");
+    }
+}
+
+QuoteColumns quote_columns(const Column<int64_t>& bid_price, const Column<uint64_t>& bid_quantity,
+                           const Column<int64_t>& ask_price, const Column<uint64_t>& ask_quantity) {
+    const auto rows = static_cast<size_t>(bid_price.size());
+    check_rows(rows, {bid_quantity.size(), ask_price.size(), ask_quantity.size()});
+    return QuoteColumns{bid_price.data(), bid_quantity.data(), ask_price.data(),
+                        ask_quantity.data(), rows};
+}
+
+BatchOptions batch_options(size_t threads) {
+    BatchOptions options;
+    options.threads = threads;
+    return options;
+}
+
+}  // namespace
+
 void bind_analytics(py::module_& m) {
 
+    // --- Bars ---
+
+    py::enum_<BarType>(m, "BarType")
+        .value("Time", BarType::Time)
+        .value("Tick", BarType::Tick)
+        .value("Volume", BarType::Volume)
+        .value("Dollar", BarType::Dollar);
+
+    py::class_<BarConfig>(m, "BarConfig")
+        .def(py::init<>())
+        .def(py::init([](BarType type, uint64_t threshold) {
+            return BarConfig{type, threshold};
+        }), py::arg("type"), py::arg("threshold"))
+        .def_readwrite("type", &BarConfig::type)
+        .def_readwrite("threshold", &BarConfig::threshold);
+
+    py::class_<Bar>(m, "Bar")
+        .def_readonly("instrument_id", &Bar::instrument_id)
+        .def_readonly("type", &Bar::type)
+        .def_readonly("first_sequence", &Bar::first_sequence)
+        .def_readonly("last_sequence", &Bar::last_sequence)
+        .def_readonly("open_time", &Bar::open_time)
+        .def_readonly("close_time", &Bar::close_time)
+        .def_readonly("open", &Bar::open)
+        .def_readonly("high", &Bar::high)
+        .def_readonly("low", &Bar::low)
+        .def_readonly("close", &Bar::close)
+        .def_readonly("volume", &Bar::volume)
+        .def_readonly("buy_volume", &Bar::buy_volume)
+        .def_readonly("notional", &Bar::notional)
+        .def_readonly("vwap", &Bar::vwap)
+        .def_readonly("trade_count", &Bar::trade_count)
+        .def_readonly("spread_samples", &Bar::spread_samples)
+        .def_readonly("avg_spread_bps", &Bar::avg_spread_bps)
+        .def_readonly("max_spread_bps", &Bar::max_spread_bps);
+
+    py::class_<BarAggregator>(m, "BarAggregator")
+        .def(py::init<const BarConfig&, BarSink>(),
+             py::arg("config"), py::arg("sink") = BarSink{})
+        .def("on_event", [](BarAggregator& bars, const EventMessage& event,
+                            const OrderBook& book, Side aggressor) {
+            bars.on_event(event, book, aggressor);
+        }, py::arg("event"), py::arg("book"), py::arg("aggressor"))
+        .def("flush", &BarAggregator::flush)
+        .def("set_sink", &BarAggregator::set_sink, py::arg("sink"))
+        .def_property_readonly("bars_emitted", &BarAggregator::bars_emitted)
+        .def_property_readonly("has_open_bar", &BarAggregator::has_open_bar)
+        .def_property_readonly("current", &BarAggregator::current,
+            py::return_value_policy::reference_internal)
+        .def_property_readonly("last_bar", &BarAggregator::last_bar,
+            py::return_value_policy::reference_internal)
+        .def("to_dict", [](const BarAggregator& bars) {
+            return json_to_py(bars.to_json());
+        }, "Bar counts and the last bar as a Python dict");
+
+    // --- Sampling ---
+
+    py::enum_<SampleTrigger>(m, "SampleTrigger")
+        .value("EveryEvent", SampleTrigger::EveryEvent)
+        .value("Trades", SampleTrigger::Trades)
+        .value("EveryNth", SampleTrigger::EveryNth)
+        .value("Interval", SampleTrigger::Interval)
+        .value("BboChange", SampleTrigger::BboChange);
+
+    py::class_<SampleConfig>(m, "SampleConfig")
+        .def(py::init<>())
+        .def(py::init([](SampleTrigger trigger, uint64_t every, bool include_trades) {
+            return SampleConfig{trigger, every, include_trades};
+        }), py::arg("trigger"), py::arg("every") = 1, py::arg("include_trades") = true)
+        .def_readwrite("trigger", &SampleConfig::trigger)
+        .def_readwrite("every", &SampleConfig::every)
+        .def_readwrite("include_trades", &SampleConfig::include_trades);
+
     // --- AnalyticsConfig ---
 
     py::class_<AnalyticsConfig>(m, "AnalyticsConfig")
@@ -39,6 +188,14 @@ void bind_analytics(py::module_& m) {
         .def_readwrite("vol_time_bar_ns", &AnalyticsConfig::vol_time_bar_ns)
         .def_readwrite("impact_regression_window", &AnalyticsConfig::impact_regression_window)
         .def_readwrite("depth_max_levels", &AnalyticsConfig::depth_max_levels)
+        .def_readwrite("spread_sampling", &AnalyticsConfig::spread_sampling)
+        .def_readwrite("microprice_sampling", &AnalyticsConfig::microprice_sampling)
+        .def_readwrite("volatility_sampling", &AnalyticsConfig::volatility_sampling)
+        .def_readwrite("impact_sampling", &AnalyticsConfig::impact_sampling)
+        .def_readwrite("depth_sampling", &AnalyticsConfig::depth_sampling)
+        .def_readwrite("time_series_columns_path", &AnalyticsConfig::time_series_columns_path)
+        .def_readwrite("time_series_block_rows", &AnalyticsConfig::time_series_block_rows)
+        .def_readwrite("bars", &AnalyticsConfig::bars)
         .def_readwrite("csv_path", &AnalyticsConfig::csv_path)
         .def_readwrite("json_path", &AnalyticsConfig::json_path);
 
@@ -57,6 +214,54 @@ void bind_analytics(py::module_& m) {
         .def_readonly("depth_imbalance", &TimeSeriesRow::depth_imbalance)
         .def_readonly("aggressor_side", &TimeSeriesRow::aggressor_side);
 
+    // --- TimeSeriesFile ---
+    // Memory-mapped column file; column() arrays are views into the mapping
+    // and keep the file object alive.
+
+    py::class_<TimeSeriesColumnReader>(m, "TimeSeriesFile")
+        .def(py::init([](const std::string& path) {
+            auto reader = std::make_unique<TimeSeriesColumnReader>();
+            if (!reader->open(path)) throw std::runtime_error(reader->error());
+            return reader;
+        }), py::arg("path"))
+        .def_property_readonly("row_count", &TimeSeriesColumnReader::row_count)
+        .def_property_readonly("block_count", &TimeSeriesColumnReader::block_count)
+        .def_property_readonly("price_scale", [](const TimeSeriesColumnReader& r) {
+            return r.header().price_scale;
+        })
+        .def_property_readonly_static("columns", [](const py::object&) {
+            py::list names;
+            for (const auto& info : TIME_SERIES_COLUMNS) names.append(info.name);
+            return names;
+        })
+        .def("column", [](py::object self, const std::string& name, size_t block) {
+            const auto& reader = self.cast<const TimeSeriesColumnReader&>();
+            const size_t c = time_series_column_index(name);
+            if (block >= reader.block_count()) throw py::index_error("block out of range");
+            const TimeSeriesColumnInfo& info = TIME_SERIES_COLUMNS[c];
+            const py::dtype dtype = time_series_dtype(info);
+            const auto rows = static_cast<py::ssize_t>(reader.block(block).rows);
+            py::array array(dtype, {rows}, {static_cast<py::ssize_t>(info.width)},
+                            reader.column(block, static_cast<TimeSeriesColumn>(c)), self);
+            py::detail::array_proxy(array.ptr())->flags &=
+                ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+            return array;
+        }, py::arg("name"), py::arg("block"),
+           "Zero-copy read-only numpy view of one column of one block")
+        .def("read", [](const TimeSeriesColumnReader& reader, const std::string& name) {
+            const size_t c = time_series_column_index(name);
+            const TimeSeriesColumnInfo& info = TIME_SERIES_COLUMNS[c];
+            py::array array(time_series_dtype(info),
+                            {static_cast<py::ssize_t>(reader.row_count())});
+            char* out = static_cast<char*>(array.mutable_data());
+            for (size_t b = 0; b < reader.block_count(); ++b) {
+                const size_t bytes = reader.block(b).rows * info.width;
+                std::memcpy(out, reader.column(b, static_cast<TimeSeriesColumn>(c)), bytes);
+                out += bytes;
+            }
+            return array;
+        }, py::arg("name"), "One column over all blocks, as a contiguous numpy copy");
+
     // --- SpreadAnalytics ---
 
     py::class_<SpreadAnalytics>(m, "SpreadAnalytics")
@@ -110,6 +315,12 @@ void bind_analytics(py::module_& m) {
     py::class_<DepthProfile>(m, "DepthProfile")
         .def("bid_depth", &DepthProfile::bid_depth)
         .def("ask_depth", &DepthProfile::ask_depth)
+        .def("bid_depth_array", [](py::object self) {
+            return quantity_view(self.cast<const DepthProfile&>().bid_depth(), self);
+        }, "Zero-copy read-only view of the last bid depth snapshot (best first)")
+        .def("ask_depth_array", [](py::object self) {
+            return quantity_view(self.cast<const DepthProfile&>().ask_depth(), self);
+        }, "Zero-copy read-only view of the last ask depth snapshot (best first)")
         .def("depth_imbalance", &DepthProfile::depth_imbalance)
         .def("to_dict", [](const DepthProfile& dp) {
             return json_to_py(dp.to_json());
@@ -125,6 +336,12 @@ void bind_analytics(py::module_& m) {
         .def("on_event", &AnalyticsEngine::on_event, py::arg("event"))
         .def("write_json", &AnalyticsEngine::write_json, py::arg("path"))
         .def("write_csv", &AnalyticsEngine::write_csv, py::arg("path"))
+        .def("close_time_series", &AnalyticsEngine::close_time_series)
+        .def("set_bar_sink", &AnalyticsEngine::set_bar_sink, py::arg("sink"))
+        .def("flush_bars", &AnalyticsEngine::flush_bars)
+        .def_property_readonly("bars",
+            &AnalyticsEngine::bars,
+            py::return_value_policy::reference_internal)
         .def("print_summary", &AnalyticsEngine::print_summary)
         .def("to_dict", [](const AnalyticsEngine& engine) {
             return json_to_py(engine.to_json());
@@ -147,7 +364,13 @@ void bind_analytics(py::module_& m) {
         .def_property_readonly("depth",
             &AnalyticsEngine::depth,
             py::return_value_policy::reference_internal)
-        .def_property_readonly("trade_count", &AnalyticsEngine::trade_count);
+        .def_property_readonly("trade_count", &AnalyticsEngine::trade_count)
+        .def("time_series", [](py::object self) {
+            const auto& rows = self.cast<const AnalyticsEngine&>().time_series();
+            return readonly_view(time_series_row_dtype(), rows.size(), rows.data(), self);
+        }, "Zero-copy read-only structured numpy view of the per-trade time series "
+           "(pandas.DataFrame(view) loads it). Keeps the engine alive; take it again "
+           "after more events, which may move the storage.");
 
     // --- MultiInstrumentAnalytics ---
 
@@ -165,8 +388,104 @@ void bind_analytics(py::module_& m) {
             },
             py::arg("instrument_id"),
             "Access per-instrument analytics. Returns None if unknown ID.")
+        .def("set_bar_sink", &MultiInstrumentAnalytics::set_bar_sink, py::arg("sink"))
+        .def("flush_bars", &MultiInstrumentAnalytics::flush_bars)
         .def("write_json", &MultiInstrumentAnalytics::write_json, py::arg("path"))
         .def("print_summary", &MultiInstrumentAnalytics::print_summary);
+
+    // --- Batch kernels (numpy in, numpy out; the GIL is released) ---
+
+    py::module_ batch = m.def_submodule(
+        "batch", "Whole-column analytics matching the streaming modules row for row");
+
+    batch.def("spread_bps", [](const Column<int64_t>& bid_price, const Column<uint64_t>& bid_quantity,
+                               const Column<int64_t>& ask_price, const Column<uint64_t>& ask_quantity,
+                               size_t threads) {
+        const QuoteColumns quotes = quote_columns(bid_price, bid_quantity, ask_price, ask_quantity);
+        py::array_t<double> out(static_cast<py::ssize_t>(quotes.rows));
+        double* data = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            batch_spread_bps(quotes, data, batch_options(threads));
+        }
+        return out;
+    }, py::arg("bid_price"), py::arg("bid_quantity"), py::arg("ask_price"),
+       py::arg("ask_quantity"), py::arg("threads") = 1);
+
+    batch.def("spread_summary", [](const Column<int64_t>& bid_price,
+                                   const Column<uint64_t>& bid_quantity,
+                                   const Column<int64_t>& ask_price,
+                                   const Column<uint64_t>& ask_quantity, size_t threads) {
+        const QuoteColumns quotes = quote_columns(bid_price, bid_quantity, ask_price, ask_quantity);
+        SpreadSummary summary;
+        {
+            py::gil_scoped_release release;
+            summary = batch_spread_summary(quotes, batch_options(threads));
+        }
+        py::dict d;
+        d["avg_spread_bps"] = summary.avg_spread_bps;
+        d["min_spread_bps"] = summary.min_spread_bps;
+        d["max_spread_bps"] = summary.max_spread_bps;
+        d["spread_samples"] = summary.spread_samples;
+        return d;
+    }, py::arg("bid_price"), py::arg("bid_quantity"), py::arg("ask_price"),
+       py::arg("ask_quantity"), py::arg("threads") = 1);
+
+    batch.def("microprice", [](const Column<int64_t>& bid_price, const Column<uint64_t>& bid_quantity,
+                               const Column<int64_t>& ask_price, const Column<uint64_t>& ask_quantity,
+                               size_t threads) {
+        const QuoteColumns quotes = quote_columns(bid_price, bid_quantity, ask_price, ask_quantity);
+        py::array_t<double> out(static_cast<py::ssize_t>(quotes.rows));
+        double* data = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            batch_microprice(quotes, data, batch_options(threads));
+        }
+        return out;
+    }, py::arg("bid_price"), py::arg("bid_quantity"), py::arg("ask_price"),
+       py::arg("ask_quantity"), py::arg("threads") = 1);
+
+    batch.def("order_flow_imbalance", [](const Column<uint64_t>& quantity,
+                                         const Column<uint8_t>& aggressor_side, size_t window) {
+        const auto rows = static_cast<size_t>(quantity.size());
+        check_rows(rows, {aggressor_side.size()});
+        const TradeColumns trades{nullptr, quantity.data(), aggressor_side.data(), rows};
+        py::array_t<double> out(static_cast<py::ssize_t>(rows));
+        double* data = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            batch_order_flow_imbalance(trades, window, data);
+        }
+        return out;
+    }, py::arg("quantity"), py::arg("aggressor_side"), py::arg("window") = 100);
+
+    batch.def("tick_volatility", [](const Column<int64_t>& price, size_t window, size_t threads) {
+        const auto rows = static_cast<size_t>(price.size());
+        py::array_t<double> out(static_cast<py::ssize_t>(rows));
+        double* data = out.mutable_data();
+        const int64_t* prices = price.data();
+        {
+            py::gil_scoped_release release;
+            batch_tick_volatility(prices, rows, window, data, batch_options(threads));
+        }
+        return out;
+    }, py::arg("price"), py::arg("window") = 50, py::arg("threads") = 1);
+
+    batch.def("time_bar_volatility", [](const Column<uint64_t>& timestamp, const Column<int64_t>& mid,
+                                        uint64_t bar_ns, size_t window) {
+        const auto rows = static_cast<size_t>(timestamp.size());
+        check_rows(rows, {mid.size()});
+        py::array_t<double> out(static_cast<py::ssize_t>(rows));
+        double* data = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            batch_time_bar_volatility(timestamp.data(), mid.data(), rows, bar_ns, window, data);
+        }
+        return out;
+    }, py::arg("timestamp"), py::arg("mid"), py::arg("bar_ns") = 1'000'000'000,
+       py::arg("window") = 50);
+
+    batch.def("kernel_isa", &batch_kernel_isa);
 }
 
 }  // namespace python
@@ -34,6 +34,8 @@ void bind_core(py::module_& m) {
         .value("FOK", OrderType::FOK)
         .value("GTC", OrderType::GTC)
         .value("Iceberg", OrderType::Iceberg)
+        .value("Stop", OrderType::Stop)
+        .value("StopLimit", OrderType::StopLimit)
 ;
 
     py::enum_<TimeInForce>(m, "TimeInForce")
@@ -41,6 +43,7 @@ void bind_core(py::module_& m) {
         .value("IOC", TimeInForce::IOC)
         .value("FOK", TimeInForce::FOK)
         .value("DAY", TimeInForce::DAY)
+        .value("GTD", TimeInForce::GTD)
 ;
 
     py::enum_<OrderStatus>(m, "OrderStatus")
@@ -50,6 +53,7 @@ void bind_core(py::module_& m) {
         .value("Filled", OrderStatus::Filled)
         .value("Cancelled", OrderStatus::Cancelled)
         .value("Rejected", OrderStatus::Rejected)
+        .value("Expired", OrderStatus::Expired)
 ;
 
     py::enum_<EventType>(m, "EventType")
@@ -60,6 +64,10 @@ void bind_core(py::module_& m) {
         .value("OrderFilled", EventType::OrderFilled)
         .value("OrderPartialFill", EventType::OrderPartialFill)
         .value("OrderModified", EventType::OrderModified)
+        .value("MassCancel", EventType::MassCancel)
+        .value("OrderExpired", EventType::OrderExpired)
+        .value("LevelUpdate", EventType::LevelUpdate)
+        .value("BookDigest", EventType::BookDigest)
 ;
 
     py::enum_<MessageType>(m, "MessageType")
@@ -100,6 +108,15 @@ void bind_core(py::module_& m) {
         .def_readonly("price", &Trade::price)
         .def_readonly("quantity", &Trade::quantity)
         .def_readonly("timestamp", &Trade::timestamp)
+        .def_readonly("aggressor_side", &Trade::aggressor_side)
+        .def_readonly("resting_participant_id", &Trade::resting_participant_id)
+        .def_readonly("flags", &Trade::flags)
+        .def("has_aggressor", &Trade::has_aggressor,
+             "Whether aggressor_side and resting_participant_id are set")
+        .def("level_exhausted", &Trade::level_exhausted,
+             "Whether the fill emptied its resting price level")
+        .def("resting_filled", &Trade::resting_filled,
+             "Whether the fill completed the resting order")
         .def("price_as_float", [](const Trade& t) {
             return price_to_float(t.price);
         }, "Price as floating-point value")
@@ -0,0 +1,181 @@
+/// @file matching_bindings.cpp
+/// @brief pybind11 bindings for MatchingSession: a standalone matching
+///        pipeline driven by whole numpy order batches.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "core/types.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "gateway/order_columns.h"
+#include "gateway/order_gateway.h"
+#include "orderbook/order_book.h"
+
+#include "numpy_views.h"
+
+namespace py = pybind11;
+
+namespace hft {
+namespace python {
+
+namespace {
+
+template <typename T>
+using Column = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+/// One instrument's book, pool, engine and gateway, publishing no events.
+/// Orders arrive as columns and go through the gateway in C++ without
+/// the GIL; each call returns one result record per order.
+class MatchingSession {
+public:
+    explicit MatchingSession(const InstrumentConfig& config)
+        : pipeline_(build_instrument_pipeline(config, nullptr)) {}
+
+    py::array submit_batch(const Column<OrderId>& order_ids, const Column<uint8_t>& sides,
+                           const Column<Price>& prices, const Column<Quantity>& quantities,
+                           const std::optional<Column<uint8_t>>& types,
+                           const std::optional<Column<uint8_t>>& time_in_force,
+                           const std::optional<Column<ParticipantId>>& participant_ids,
+                           const std::optional<Column<Timestamp>>& timestamps) {
+        const size_t n = column_length(order_ids, "order_ids");
+        check_length(sides, n, "sides");
+        check_length(prices, n, "prices");
+        check_length(quantities, n, "quantities");
+        check_range(sides, static_cast<uint8_t>(Side::Sell), "sides");
+
+        OrderColumns orders;
+        orders.count = n;
+        orders.order_ids = order_ids.data();
+        orders.sides = sides.data();
+        orders.prices = prices.data();
+        orders.quantities = quantities.data();
+        if (types) {
+            check_length(*types, n, "types");
+            check_range(*types, static_cast<uint8_t>(OrderType::StopLimit), "types");
+            orders.types = types->data();
+        }
+        if (time_in_force) {
+            check_length(*time_in_force, n, "time_in_force");
+            check_range(*time_in_force, static_cast<uint8_t>(TimeInForce::GTD), "time_in_force");
+            orders.time_in_force = time_in_force->data();
+        }
+        if (participant_ids) {
+            check_length(*participant_ids, n, "participant_ids");
+            orders.participant_ids = participant_ids->data();
+        }
+        if (timestamps) {
+            check_length(*timestamps, n, "timestamps");
+            orders.timestamps = timestamps->data();
+        }
+
+        py::array results = record_array(result_dtype(), n);
+        auto* out = static_cast<GatewayResult*>(results.mutable_data());
+        {
+            py::gil_scoped_release release;
+            submit_order_columns(*pipeline_->gateway, orders, out);
+        }
+        return results;
+    }
+
+    py::array cancel_batch(const Column<OrderId>& order_ids,
+                           const std::optional<Column<Timestamp>>& timestamps) {
+        const size_t n = column_length(order_ids, "order_ids");
+        const Timestamp* stamps = nullptr;
+        if (timestamps) {
+            check_length(*timestamps, n, "timestamps");
+            stamps = timestamps->data();
+        }
+        py::array results = record_array(result_dtype(), n);
+        auto* out = static_cast<GatewayResult*>(results.mutable_data());
+        {
+            py::gil_scoped_release release;
+            cancel_order_columns(*pipeline_->gateway, order_ids.data(), n, out, stamps);
+        }
+        return results;
+    }
+
+    [[nodiscard]] const OrderBook& order_book() const { return *pipeline_->book; }
+    [[nodiscard]] uint64_t orders_processed() const {
+        return pipeline_->gateway->orders_processed();
+    }
+    [[nodiscard]] uint64_t orders_rejected() const {
+        return pipeline_->gateway->orders_rejected();
+    }
+
+private:
+    /// GatewayResult as a numpy record.
+    static py::dtype result_dtype() {
+        return structured_dtype({
+            view_field<bool>("accepted", offsetof(GatewayResult, accepted)),
+            view_field<GatewayRejectReason>("reject_reason",
+                                            offsetof(GatewayResult, reject_reason)),
+            view_field<MatchStatus>("match_status", offsetof(GatewayResult, match_status)),
+            view_field<uint32_t>("trade_count", offsetof(GatewayResult, trade_count)),
+            view_field<Quantity>("filled_quantity", offsetof(GatewayResult, filled_quantity)),
+            view_field<Quantity>("remaining_quantity",
+                                 offsetof(GatewayResult, remaining_quantity)),
+            view_field<bool>("deferred", offsetof(GatewayResult, deferred)),
+        }, sizeof(GatewayResult));
+    }
+
+    template <typename T>
+    static size_t column_length(const Column<T>& column, const char* name) {
+        if (column.ndim() != 1) {
+            throw py::value_error(std::string(name) + " must be one-dimensional");
+        }
+        return static_cast<size_t>(column.shape(0));
+    }
+
+    template <typename T>
+    static void check_length(const Column<T>& column, size_t n, const char* name) {
+        if (column_length(column, name) != n) {
+            throw py::value_error(std::string(name) + " must have one entry per order");
+        }
+    }
+
+    /// Enum columns: every value must name an enumerator.
+    static void check_range(const Column<uint8_t>& column, uint8_t max, const char* name) {
+        const uint8_t* values = column.data();
+        for (py::ssize_t i = 0; i < column.shape(0); ++i) {
+            if (values[i] > max) {
+                throw py::value_error(std::string(name) + " holds an out-of-range value");
+            }
+        }
+    }
+
+    std::unique_ptr<InstrumentPipeline> pipeline_;
+};
+
+}  // namespace
+
+void bind_matching(py::module_& m) {
+    py::class_<MatchingSession>(m, "MatchingSession")
+        .def(py::init<const InstrumentConfig&>(), py::arg("config"))
+        .def("submit_batch", &MatchingSession::submit_batch,
+             py::arg("order_ids"), py::arg("sides"), py::arg("prices"), py::arg("quantities"),
+             py::arg("types") = py::none(), py::arg("time_in_force") = py::none(),
+             py::arg("participant_ids") = py::none(), py::arg("timestamps") = py::none(),
+             "Add a batch of orders given as arrays (sides / types / time_in_force as "
+             "their integer values; omitted columns default to Limit, GTC, participant "
+             "0, timestamp 0). Matched in C++ without the GIL, in array order. Returns "
+             "a structured array of results, one per order.")
+        .def("cancel_batch", &MatchingSession::cancel_batch,
+             py::arg("order_ids"), py::arg("timestamps") = py::none(),
+             "Cancel a batch of orders by ID. Returns a structured array of results "
+             "(accepted is False for IDs not on the book).")
+        .def_property_readonly("order_book", &MatchingSession::order_book,
+             py::return_value_policy::reference_internal)
+        .def_property_readonly("orders_processed", &MatchingSession::orders_processed)
+        .def_property_readonly("orders_rejected", &MatchingSession::orders_rejected);
+}
+
+}  // namespace python
+}  // namespace hft
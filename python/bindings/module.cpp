@@ -13,6 +13,7 @@ void bind_core(py::module_& m);
 void bind_orderbook(py::module_& m);
 void bind_replay(py::module_& m);
 void bind_analytics(py::module_& m);
+void bind_matching(py::module_& m);
 
 }  // namespace python
 }  // namespace hft
@@ -24,4 +25,5 @@ PYBIND11_MODULE(hft_orderbook, m) {
     hft::python::bind_orderbook(m);
     hft::python::bind_replay(m);
     hft::python::bind_analytics(m);
+    hft::python::bind_matching(m);
 }
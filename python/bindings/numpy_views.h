@@ -0,0 +1,78 @@
+#pragma once
+
+/// @file numpy_views.h
+/// @brief Structured numpy arrays over C++ record storage.
+///
+/// readonly_view() wraps existing records without copying: the array's
+/// base is the Python object owning the storage, so the owner lives as
+/// long as any view of it. Storage that can still grow (a vector the
+/// engine appends to) must not be appended to while a view is in use —
+/// take views once the replay has finished, or take them again.
+/// record_array() allocates a fresh array for records built on demand
+/// (depth snapshots, stats rows), filled in C++ without Python objects.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+
+namespace py = pybind11;
+
+namespace hft {
+namespace python {
+
+/// One field of a structured dtype.
+struct ViewField {
+    const char* name;
+    py::dtype type;
+    size_t offset;
+};
+
+namespace detail {
+template <typename T, bool = std::is_enum_v<T>>
+struct stored_type {
+    using type = T;
+};
+template <typename T>
+struct stored_type<T, true> {
+    using type = std::underlying_type_t<T>;  // Side etc. as their integer
+};
+}  // namespace detail
+
+/// Field `name` of C++ type T at byte `offset` of the record.
+template <typename T>
+ViewField view_field(const char* name, size_t offset) {
+    return ViewField{name, py::dtype::of<typename detail::stored_type<T>::type>(), offset};
+}
+
+/// Structured dtype of `itemsize`-byte records (padding left unnamed).
+inline py::dtype structured_dtype(std::initializer_list<ViewField> fields, size_t itemsize) {
+    py::list names;
+    py::list formats;
+    py::list offsets;
+    for (const ViewField& f : fields) {
+        names.append(f.name);
+        formats.append(f.type);
+        offsets.append(f.offset);
+    }
+    return py::dtype(names, formats, offsets, static_cast<py::ssize_t>(itemsize));
+}
+
+/// Read-only zero-copy view of `rows` records at `data`; `owner` is kept
+/// alive by the array.
+inline py::array readonly_view(const py::dtype& dtype, size_t rows, const void* data,
+                               py::handle owner) {
+    py::array array(dtype, {static_cast<py::ssize_t>(rows)}, {dtype.itemsize()}, data, owner);
+    py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return array;
+}
+
+/// New array of `rows` records of `dtype`; fill it through data().
+inline py::array record_array(const py::dtype& dtype, size_t rows) {
+    return py::array(dtype, {static_cast<py::ssize_t>(rows)});
+}
+
+}  // namespace python
+}  // namespace hft
@@ -4,6 +4,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <cstddef>
+#include <cstring>
 #include <sstream>
 #include <vector>
 
@@ -12,12 +14,33 @@
 #include "orderbook/order_book.h"
 
 #include "converters.h"
+#include "numpy_views.h"
 
 namespace py = pybind11;
 
 namespace hft {
 namespace python {
 
+namespace {
+
+/// Top `n` levels of one side as a structured array (price, quantity,
+/// order_count), best first.
+py::array depth_array(const OrderBook& book, Side side, size_t n) {
+    std::vector<DepthEntry> entries(n);
+    const size_t filled = (side == Side::Buy) ? book.get_bid_depth(entries.data(), n)
+                                              : book.get_ask_depth(entries.data(), n);
+    const py::dtype dtype = structured_dtype({
+        view_field<Price>("price", offsetof(DepthEntry, price)),
+        view_field<Quantity>("quantity", offsetof(DepthEntry, quantity)),
+        view_field<uint32_t>("order_count", offsetof(DepthEntry, order_count)),
+    }, sizeof(DepthEntry));
+    py::array out = record_array(dtype, filled);
+    std::memcpy(out.mutable_data(), entries.data(), filled * sizeof(DepthEntry));
+    return out;
+}
+
+}  // namespace
+
 void bind_orderbook(py::module_& m) {
     py::class_<OrderBook>(m, "OrderBook")
         // Read-only query methods only — no mutation exposed to Python.
@@ -94,6 +117,10 @@ void bind_orderbook(py::module_& m) {
         }, py::arg("levels") = 10,
            "Get ask depth as list of dicts, ordered best (lowest) to worst.")
 
+        .def("depth_array", &depth_array, py::arg("side"), py::arg("levels") = 10,
+           "Depth of one side as a structured numpy array (price, quantity, "
+           "order_count), best first; no Python object per level.")
+
         .def_property_readonly("order_count", &OrderBook::order_count)
         .def_property_readonly("empty", &OrderBook::empty)
         .def_property_readonly("min_price", &OrderBook::min_price)
@@ -3,27 +3,306 @@
 ///        and their configs/stats.
 
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "analytics/analytics_engine.h"
 #include "analytics/multi_instrument_analytics.h"
+#include "core/trade.h"
 #include "core/types.h"
+#include "feed/background_replay.h"
 #include "feed/multi_instrument_replay_engine.h"
 #include "feed/replay_engine.h"
+#include "gateway/event_overflow.h"
 #include "gateway/instrument_registry.h"
 #include "gateway/instrument_router.h"
+#include "gateway/sharded_router.h"
 #include "transport/message.h"
+#include "utils/thread_placement.h"
 
 #include "converters.h"
+#include "numpy_views.h"
 
 namespace py = pybind11;
 
 namespace hft {
 namespace python {
 
+namespace {
+
+/// A Python callable for an engine callback. run() releases the GIL and
+/// copies its callbacks, so the std::function holds a shared pointer
+/// (copies touch no Python refcount) whose deleter takes the GIL.
+std::function<void(const EventMessage&)> python_event_callback(py::function callback) {
+    std::shared_ptr<py::function> holder(new py::function(std::move(callback)),
+                                         [](py::function* f) {
+                                             py::gil_scoped_acquire acquire;
+                                             delete f;
+                                         });
+    return [holder](const EventMessage& msg) {
+        py::gil_scoped_acquire acquire;
+        (*holder)(event_message_to_dict(msg));
+    };
+}
+
+/// EventMessage as a numpy record. The payload fields overlap (EventData
+/// is a union): read the ones of each row's type.
+py::dtype event_message_dtype() {
+    constexpr size_t D = offsetof(EventMessage, data);
+    return structured_dtype({
+        view_field<EventType>("type", offsetof(EventMessage, type)),
+        view_field<InstrumentId>("instrument_id", offsetof(EventMessage, instrument_id)),
+        view_field<uint64_t>("sequence_num", offsetof(EventMessage, sequence_num)),
+        // Order state events
+        view_field<OrderId>("order_id", D + offsetof(OrderEventData, order_id)),
+        view_field<OrderStatus>("status", D + offsetof(OrderEventData, status)),
+        view_field<Quantity>("filled_quantity", D + offsetof(OrderEventData, filled_quantity)),
+        view_field<Quantity>("remaining_quantity",
+                             D + offsetof(OrderEventData, remaining_quantity)),
+        view_field<Price>("price", D + offsetof(OrderEventData, price)),
+        view_field<Timestamp>("timestamp", D + offsetof(OrderEventData, timestamp)),
+        // Trade
+        // (trade_flags includes TRADE_EVENT_SELL_AGGRESSOR for the side)
+        view_field<uint64_t>("trade_id", D + offsetof(TradeEventData, trade_id)),
+        view_field<uint8_t>("trade_flags", offsetof(EventMessage, trade_flags)),
+        view_field<uint16_t>("resting_participant_id",
+                             offsetof(EventMessage, trade_participant)),
+        view_field<OrderId>("buy_order_id", D + offsetof(TradeEventData, buy_order_id)),
+        view_field<OrderId>("sell_order_id", D + offsetof(TradeEventData, sell_order_id)),
+        view_field<Price>("trade_price", D + offsetof(TradeEventData, price)),
+        view_field<Quantity>("trade_quantity", D + offsetof(TradeEventData, quantity)),
+        view_field<Timestamp>("trade_timestamp", D + offsetof(TradeEventData, timestamp)),
+        // LevelUpdate
+        view_field<Price>("level_price", D + offsetof(LevelUpdateEventData, price)),
+        view_field<Quantity>("level_quantity", D + offsetof(LevelUpdateEventData, total_quantity)),
+        view_field<uint32_t>("level_order_count",
+                             D + offsetof(LevelUpdateEventData, order_count)),
+        view_field<uint8_t>("level_side", D + offsetof(LevelUpdateEventData, side)),
+        // MassCancel
+        view_field<uint32_t>("cancelled_count", D + offsetof(MassCancelEventData, cancelled_count)),
+        view_field<Quantity>("cancelled_quantity",
+                             D + offsetof(MassCancelEventData, cancelled_quantity)),
+        // BookDigest
+        view_field<uint64_t>("book_digest", D + offsetof(BookDigestEventData, digest)),
+    }, sizeof(EventMessage));
+}
+
+/// Python iterator over a replay running on its own thread (see
+/// BackgroundReplay): each step waits, without the GIL, for the next batch
+/// of events from the ring and returns it as one structured array.
+template <typename Engine, typename Stats>
+class EventStream {
+public:
+    EventStream(Engine& engine, size_t batch_size, bool gating)
+        : batch_(std::max<size_t>(batch_size, 1)) {
+        if (!engine.event_buffer()) {
+            throw py::value_error("events() needs the event publisher (enable_publisher)");
+        }
+        BackgroundReplayConfig config;
+        config.gating = gating;
+        replay_ = std::make_unique<BackgroundReplay>(
+            *engine.event_buffer(), [this, &engine] { stats_ = engine.run(); }, config);
+        if (!replay_->start()) throw py::value_error("the event ring has no free cursor");
+    }
+
+    ~EventStream() { close(); }
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    py::array next() {
+        size_t n = 0;
+        {
+            py::gil_scoped_release release;
+            n = replay_->next_batch(batch_.data(), batch_.size());
+        }
+        if (n == 0) throw py::stop_iteration();
+        py::array array = record_array(event_message_dtype(), n);
+        std::memcpy(array.mutable_data(), batch_.data(), n * sizeof(EventMessage));
+        return array;
+    }
+
+    /// Stop reading; the replay still runs to its end (engine callbacks
+    /// may need the GIL meanwhile).
+    void close() {
+        py::gil_scoped_release release;
+        replay_->stop();
+    }
+
+    [[nodiscard]] py::object stats() const {
+        if (!replay_->finished()) return py::none();
+        return py::cast(stats_);
+    }
+
+    [[nodiscard]] bool finished() const { return replay_->finished(); }
+    [[nodiscard]] uint64_t events_read() const { return replay_->events_read(); }
+    [[nodiscard]] uint64_t lost() const { return replay_->lost(); }
+
+private:
+    std::vector<EventMessage> batch_;
+    Stats stats_{};
+    std::unique_ptr<BackgroundReplay> replay_;   // Last: joined before stats_ goes
+};
+
+template <typename Stream>
+void bind_event_stream(py::module_& m, const char* name) {
+    py::class_<Stream>(m, name)
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &Stream::next,
+             "Next batch of events as a structured numpy array (waits without the GIL)")
+        .def("close", &Stream::close,
+             "Stop reading; the replay runs to its end and unread events are dropped")
+        .def_property_readonly("stats", &Stream::stats,
+             "The replay's stats once it has finished, else None")
+        .def_property_readonly("finished", &Stream::finished)
+        .def_property_readonly("events_read", &Stream::events_read)
+        .def_property_readonly("lost", &Stream::lost,
+             "Events overwritten before they were read (gating=False only)");
+}
+
+using ReplayEventStream = EventStream<ReplayEngine, ReplayStats>;
+using MultiReplayEventStream = EventStream<MultiInstrumentReplayEngine, MultiReplayStats>;
+
+/// One trade as a numpy record: the Trade payload plus its event header.
+struct TradeRecord {
+    uint64_t sequence_num;
+    Timestamp timestamp;
+    OrderId buy_order_id;
+    OrderId sell_order_id;
+    Price price;
+    Quantity quantity;
+    uint64_t trade_id;
+    InstrumentId instrument_id;
+    Side aggressor_side;
+    uint8_t flags;           // TradeFlags
+};
+
+/// Trades collected in C++ from the event stream (no Python call per
+/// event); array() views them without copying.
+class TradeLog {
+public:
+    void on_event(const EventMessage& msg) {
+        if (msg.type != EventType::Trade) return;
+        const Trade t = event_trade(msg);
+        records_.push_back(TradeRecord{msg.sequence_num, t.timestamp, t.buy_order_id,
+                                       t.sell_order_id, t.price, t.quantity, t.trade_id,
+                                       msg.instrument_id, t.aggressor_side, t.flags});
+    }
+
+    [[nodiscard]] const std::vector<TradeRecord>& records() const noexcept { return records_; }
+    void clear() noexcept { records_.clear(); }
+
+private:
+    std::vector<TradeRecord> records_;
+};
+
+py::dtype trade_record_dtype() {
+    return structured_dtype({
+        view_field<uint64_t>("sequence_num", offsetof(TradeRecord, sequence_num)),
+        view_field<Timestamp>("timestamp", offsetof(TradeRecord, timestamp)),
+        view_field<OrderId>("buy_order_id", offsetof(TradeRecord, buy_order_id)),
+        view_field<OrderId>("sell_order_id", offsetof(TradeRecord, sell_order_id)),
+        view_field<Price>("price", offsetof(TradeRecord, price)),
+        view_field<Quantity>("quantity", offsetof(TradeRecord, quantity)),
+        view_field<uint64_t>("trade_id", offsetof(TradeRecord, trade_id)),
+        view_field<InstrumentId>("instrument_id", offsetof(TradeRecord, instrument_id)),
+        view_field<Side>("aggressor_side", offsetof(TradeRecord, aggressor_side)),
+        view_field<uint8_t>("flags", offsetof(TradeRecord, flags)),
+    }, sizeof(TradeRecord));
+}
+
+/// Numeric PerInstrumentStats fields, packed for per_instrument_array()
+/// (PerInstrumentStats itself holds a std::string).
+struct InstrumentStatsRecord {
+    uint64_t add_messages;
+    uint64_t cancel_messages;
+    uint64_t modify_messages;
+    uint64_t trade_messages;
+    uint64_t orders_accepted;
+    uint64_t orders_rejected;
+    uint64_t orders_cancelled;
+    uint64_t cancel_failures;
+    uint64_t orders_modified;
+    uint64_t modify_failures;
+    uint64_t trades_generated;
+    Price final_best_bid;
+    Price final_best_ask;
+    uint64_t final_order_count;
+    uint64_t memory_reserved_bytes;
+    uint64_t memory_touched_bytes;
+    InstrumentId instrument_id;
+};
+
+py::array per_instrument_array(const MultiReplayStats& stats) {
+    using R = InstrumentStatsRecord;
+    const py::dtype dtype = structured_dtype({
+        view_field<InstrumentId>("instrument_id", offsetof(R, instrument_id)),
+        view_field<uint64_t>("add_messages", offsetof(R, add_messages)),
+        view_field<uint64_t>("cancel_messages", offsetof(R, cancel_messages)),
+        view_field<uint64_t>("modify_messages", offsetof(R, modify_messages)),
+        view_field<uint64_t>("trade_messages", offsetof(R, trade_messages)),
+        view_field<uint64_t>("orders_accepted", offsetof(R, orders_accepted)),
+        view_field<uint64_t>("orders_rejected", offsetof(R, orders_rejected)),
+        view_field<uint64_t>("orders_cancelled", offsetof(R, orders_cancelled)),
+        view_field<uint64_t>("cancel_failures", offsetof(R, cancel_failures)),
+        view_field<uint64_t>("orders_modified", offsetof(R, orders_modified)),
+        view_field<uint64_t>("modify_failures", offsetof(R, modify_failures)),
+        view_field<uint64_t>("trades_generated", offsetof(R, trades_generated)),
+        view_field<Price>("final_best_bid", offsetof(R, final_best_bid)),
+        view_field<Price>("final_best_ask", offsetof(R, final_best_ask)),
+        view_field<uint64_t>("final_order_count", offsetof(R, final_order_count)),
+        view_field<uint64_t>("memory_reserved_bytes", offsetof(R, memory_reserved_bytes)),
+        view_field<uint64_t>("memory_touched_bytes", offsetof(R, memory_touched_bytes)),
+    }, sizeof(R));
+
+    py::array array = record_array(dtype, stats.per_instrument.size());
+    auto* out = static_cast<R*>(array.mutable_data());
+    for (const PerInstrumentStats& ps : stats.per_instrument) {
+        const MemoryUsage memory = ps.memory.total();
+        *out++ = R{ps.add_messages, ps.cancel_messages, ps.modify_messages,
+                   ps.trade_messages, ps.orders_accepted, ps.orders_rejected,
+                   ps.orders_cancelled, ps.cancel_failures, ps.orders_modified,
+                   ps.modify_failures, ps.trades_generated, ps.final_best_bid,
+                   ps.final_best_ask, ps.final_order_count, memory.reserved_bytes,
+                   memory.touched_bytes, ps.instrument_id};
+    }
+    return array;
+}
+
+}  // namespace
+
 void bind_replay(py::module_& m) {
 
+    // --- TradeLog ---
+
+    py::class_<TradeLog>(m, "TradeLog")
+        .def(py::init<>())
+        .def("array",
+            [](py::object self) {
+                const TradeLog& log = self.cast<const TradeLog&>();
+                return readonly_view(trade_record_dtype(), log.records().size(),
+                                     log.records().data(), self);
+            },
+            "Read-only structured numpy view of the collected trades (no copy). "
+            "Take it after run(): the log grows while the replay runs.")
+        .def("__len__", [](const TradeLog& log) { return log.records().size(); })
+        .def("clear", &TradeLog::clear);
+
+    // --- Event streams (ReplayEngine.events()) ---
+
+    bind_event_stream<ReplayEventStream>(m, "ReplayEventStream");
+    bind_event_stream<MultiReplayEventStream>(m, "MultiReplayEventStream");
+
     // --- InstrumentRouter (opaque, used by MultiInstrumentAnalytics) ---
 
     py::class_<InstrumentRouter>(m, "InstrumentRouter")
@@ -37,6 +316,74 @@ void bind_replay(py::module_& m) {
             "Access an instrument's order book by ID. Returns None if unknown.")
         .def_property_readonly("instrument_count", &InstrumentRouter::instrument_count);
 
+    // --- ThreadingConfig ---
+
+    py::class_<ThreadingConfig>(m, "ThreadingConfig")
+        .def(py::init<>())
+        .def_readwrite("ingress_cpus", &ThreadingConfig::ingress_cpus)
+        .def_readwrite("matching_cpus", &ThreadingConfig::matching_cpus)
+        .def_readwrite("publisher_cpus", &ThreadingConfig::publisher_cpus)
+        .def_readwrite("analytics_cpus", &ThreadingConfig::analytics_cpus)
+        .def_readwrite("journal_cpus", &ThreadingConfig::journal_cpus)
+        .def_readwrite("multicast_cpus", &ThreadingConfig::multicast_cpus)
+        .def_readwrite("lock_memory", &ThreadingConfig::lock_memory)
+        .def_readwrite("realtime", &ThreadingConfig::realtime)
+        .def_readwrite("realtime_priority", &ThreadingConfig::realtime_priority);
+
+    m.def("thread_topology_report", &thread_topology_report,
+          "Where every placed engine thread ran (CPU, SCHED_FIFO, mlockall).");
+
+    // --- BackpressureConfig ---
+
+    py::enum_<BackpressurePolicy>(m, "BackpressurePolicy")
+        .value("Block", BackpressurePolicy::Block)
+        .value("Spill", BackpressurePolicy::Spill)
+        .value("Conflate", BackpressurePolicy::Conflate);
+
+    py::class_<BackpressureConfig>(m, "BackpressureConfig")
+        .def(py::init<>())
+        .def_readwrite("policy", &BackpressureConfig::policy)
+        .def_readwrite("block_timeout_ns", &BackpressureConfig::block_timeout_ns)
+        .def_readwrite("overflow_capacity", &BackpressureConfig::overflow_capacity)
+        .def_readwrite("conflate_window", &BackpressureConfig::conflate_window);
+
+    py::enum_<JournalFsync>(m, "JournalFsync")
+        .value("NoSync", JournalFsync::None)
+        .value("PerBatch", JournalFsync::PerBatch)
+        .value("Timed", JournalFsync::Timed);
+
+    py::class_<JournalConfig>(m, "JournalConfig")
+        .def(py::init<>())
+        .def_readwrite("directory", &JournalConfig::directory)
+        .def_readwrite("prefix", &JournalConfig::prefix)
+        .def_readwrite("buffer_bytes", &JournalConfig::buffer_bytes)
+        .def_readwrite("buffers", &JournalConfig::buffers)
+        .def_readwrite("segment_bytes", &JournalConfig::segment_bytes)
+        .def_readwrite("fsync", &JournalConfig::fsync)
+        .def_readwrite("fsync_interval_ms", &JournalConfig::fsync_interval_ms)
+        .def_readwrite("direct_io", &JournalConfig::direct_io);
+
+    py::enum_<MulticastContent>(m, "MulticastContent")
+        .value("Events", MulticastContent::Events)
+        .value("Levels", MulticastContent::Levels);
+
+    py::class_<MulticastConfig>(m, "MulticastConfig")
+        .def(py::init<>())
+        .def_readwrite("group", &MulticastConfig::group)
+        .def_readwrite("port", &MulticastConfig::port)
+        .def_readwrite("interface_address", &MulticastConfig::interface_address)
+        .def_readwrite("ttl", &MulticastConfig::ttl)
+        .def_readwrite("loopback", &MulticastConfig::loopback)
+        .def_readwrite("mtu", &MulticastConfig::mtu)
+        .def_readwrite("content", &MulticastConfig::content)
+        .def_readwrite("datagrams", &MulticastConfig::datagrams)
+        .def_readwrite("send_batch", &MulticastConfig::send_batch)
+        .def_readwrite("retransmit_history", &MulticastConfig::retransmit_history)
+        .def_readwrite("retransmit_port", &MulticastConfig::retransmit_port)
+        .def_readwrite("snapshot_group", &MulticastConfig::snapshot_group)
+        .def_readwrite("snapshot_port", &MulticastConfig::snapshot_port)
+        .def_readwrite("snapshot_interval_ms", &MulticastConfig::snapshot_interval_ms);
+
     // --- ReplayConfig ---
 
     py::class_<ReplayConfig>(m, "ReplayConfig")
@@ -45,12 +392,24 @@ void bind_replay(py::module_& m) {
         .def_readwrite("output_path", &ReplayConfig::output_path)
         .def_readwrite("speed", &ReplayConfig::speed)
         .def_readwrite("speed_multiplier", &ReplayConfig::speed_multiplier)
+        .def_readwrite("pacing_spin_ns", &ReplayConfig::pacing_spin_ns)
         .def_readwrite("min_price", &ReplayConfig::min_price)
         .def_readwrite("max_price", &ReplayConfig::max_price)
         .def_readwrite("tick_size", &ReplayConfig::tick_size)
         .def_readwrite("max_orders", &ReplayConfig::max_orders)
         .def_readwrite("enable_publisher", &ReplayConfig::enable_publisher)
-        .def_readwrite("verbose", &ReplayConfig::verbose);
+        .def_readwrite("verbose", &ReplayConfig::verbose)
+        .def_readwrite("pipelined", &ReplayConfig::pipelined)
+        .def_readwrite("threading", &ReplayConfig::threading)
+        .def_readwrite("backpressure", &ReplayConfig::backpressure)
+        .def_readwrite("parse_threads", &ReplayConfig::parse_threads)
+        .def_readwrite("parse_chunk_bytes", &ReplayConfig::parse_chunk_bytes)
+        .def_readwrite("journal", &ReplayConfig::journal)
+        .def_readwrite("multicast", &ReplayConfig::multicast)
+        .def_readwrite("checkpoint_directory", &ReplayConfig::checkpoint_directory)
+        .def_readwrite("checkpoint_every_records", &ReplayConfig::checkpoint_every_records)
+        .def_readwrite("checkpoint_every_ns", &ReplayConfig::checkpoint_every_ns)
+        .def_readwrite("end_timestamp", &ReplayConfig::end_timestamp);
 
     // --- ReplayStats ---
 
@@ -74,6 +433,48 @@ void bind_replay(py::module_& m) {
         .def_readonly("final_order_count", &ReplayStats::final_order_count)
         .def_readonly("elapsed_seconds", &ReplayStats::elapsed_seconds)
         .def_readonly("messages_per_second", &ReplayStats::messages_per_second)
+        .def_readonly("parse_messages_per_second", &ReplayStats::parse_messages_per_second)
+        .def_readonly("match_messages_per_second", &ReplayStats::match_messages_per_second)
+        .def_readonly("publish_events_per_second", &ReplayStats::publish_events_per_second)
+        .def_readonly("events_published", &ReplayStats::events_published)
+        .def_readonly("parser_stalls", &ReplayStats::parser_stalls)
+        .def_readonly("matching_idle_polls", &ReplayStats::matching_idle_polls)
+        .def_readonly("publisher_idle_polls", &ReplayStats::publisher_idle_polls)
+        .def_readonly("matching_wakeups", &ReplayStats::matching_wakeups)
+        .def_readonly("publisher_wakeups", &ReplayStats::publisher_wakeups)
+        .def_readonly("ingress_depth_max", &ReplayStats::ingress_depth_max)
+        .def_readonly("ingress_depth_avg", &ReplayStats::ingress_depth_avg)
+        .def_readonly("event_depth_max", &ReplayStats::event_depth_max)
+        .def_readonly("event_depth_avg", &ReplayStats::event_depth_avg)
+        .def_readonly("backpressure_events", &ReplayStats::backpressure_events)
+        .def_readonly("backpressure_seconds", &ReplayStats::backpressure_seconds)
+        .def_readonly("events_spilled", &ReplayStats::events_spilled)
+        .def_readonly("events_conflated", &ReplayStats::events_conflated)
+        .def_readonly("events_dropped", &ReplayStats::events_dropped)
+        .def_readonly("overflow_high_water", &ReplayStats::overflow_high_water)
+        .def_readonly("paced_records", &ReplayStats::paced_records)
+        .def_readonly("pacing_sleeps", &ReplayStats::pacing_sleeps)
+        .def_readonly("pacing_overdue", &ReplayStats::pacing_overdue)
+        .def_readonly("pacing_error_p50_ns", &ReplayStats::pacing_error_p50_ns)
+        .def_readonly("pacing_error_p99_ns", &ReplayStats::pacing_error_p99_ns)
+        .def_readonly("pacing_error_p99_9_ns", &ReplayStats::pacing_error_p99_9_ns)
+        .def_readonly("pacing_error_max_ns", &ReplayStats::pacing_error_max_ns)
+        .def_readonly("journal_events", &ReplayStats::journal_events)
+        .def_readonly("journal_dropped", &ReplayStats::journal_dropped)
+        .def_readonly("journal_bytes", &ReplayStats::journal_bytes)
+        .def_readonly("journal_segments", &ReplayStats::journal_segments)
+        .def_readonly("journal_fsyncs", &ReplayStats::journal_fsyncs)
+        .def_readonly("journal_write_errors", &ReplayStats::journal_write_errors)
+        .def_readonly("multicast_datagrams", &ReplayStats::multicast_datagrams)
+        .def_readonly("multicast_bytes", &ReplayStats::multicast_bytes)
+        .def_readonly("multicast_dropped", &ReplayStats::multicast_dropped)
+        .def_readonly("multicast_snapshots", &ReplayStats::multicast_snapshots)
+        .def_readonly("multicast_retransmitted", &ReplayStats::multicast_retransmitted)
+        .def_readonly("multicast_send_errors", &ReplayStats::multicast_send_errors)
+        .def_readonly("checkpoints_written", &ReplayStats::checkpoints_written)
+        .def_readonly("seek_checkpoint_timestamp", &ReplayStats::seek_checkpoint_timestamp)
+        .def_readonly("seek_warmup_records", &ReplayStats::seek_warmup_records)
+        .def_readonly("seek_seconds", &ReplayStats::seek_seconds)
         .def("to_dict", [](const ReplayStats& s) {
             py::dict d;
             d["total_messages"] = s.total_messages;
@@ -103,18 +504,29 @@ void bind_replay(py::module_& m) {
     py::class_<ReplayEngine>(m, "ReplayEngine")
         .def(py::init<const ReplayConfig&>(), py::arg("config"))
         .def("run", &ReplayEngine::run,
-             "Run replay to completion. Returns ReplayStats.")
+             py::call_guard<py::gil_scoped_release>(),
+             "Run replay to completion (without the GIL). Returns ReplayStats.")
+        .def("seek", &ReplayEngine::seek, py::arg("timestamp"),
+             py::call_guard<py::gil_scoped_release>(),
+             "Before run(): restore the nearest checkpoint at or before timestamp "
+             "and replay up to it. Returns False if the input cannot seek.")
+        .def("events",
+            [](ReplayEngine& engine, size_t batch_size, bool gating) {
+                return std::make_unique<ReplayEventStream>(engine, batch_size, gating);
+            },
+            py::arg("batch_size") = 65536, py::arg("gating") = true,
+            py::keep_alive<0, 1>(),
+            "Instead of run(): replay on a native thread and iterate over its events "
+            "in structured numpy batches drained from the event ring. gating=True "
+            "loses nothing (the replay waits for the reader); gating=False never "
+            "holds it back and counts overwritten events in lost.")
         .def_property_readonly("order_book",
             &ReplayEngine::order_book,
             py::return_value_policy::reference_internal,
             "Access the order book (valid after run() completes)")
         .def("register_event_callback",
             [](ReplayEngine& engine, py::function callback) {
-                engine.register_event_callback(
-                    [callback](const EventMessage& msg) {
-                        py::gil_scoped_acquire acquire;
-                        callback(event_message_to_dict(msg));
-                    });
+                engine.register_event_callback(python_event_callback(std::move(callback)));
             },
             py::arg("callback"),
             "Register a Python callback to receive event dicts during replay")
@@ -127,7 +539,15 @@ void bind_replay(py::module_& m) {
             },
             py::arg("analytics"),
             py::keep_alive<1, 2>(),
-            "Wire an AnalyticsEngine to receive events directly (no Python overhead)");
+            "Wire an AnalyticsEngine to receive events directly (no Python overhead)")
+        .def("register_trade_log",
+            [](ReplayEngine& engine, TradeLog& log) {
+                engine.register_event_callback(
+                    [&log](const EventMessage& msg) { log.on_event(msg); });
+            },
+            py::arg("log"),
+            py::keep_alive<1, 2>(),
+            "Collect trades into a TradeLog directly (no Python overhead)");
 
     // --- InstrumentConfig ---
 
@@ -142,6 +562,10 @@ void bind_replay(py::module_& m) {
 
     // --- MultiReplayConfig ---
 
+    py::enum_<ShardAssignment>(m, "ShardAssignment")
+        .value("RoundRobin", ShardAssignment::RoundRobin)
+        .value("ByLoad", ShardAssignment::ByLoad);
+
     py::class_<MultiReplayConfig>(m, "MultiReplayConfig")
         .def(py::init<>())
         .def_readwrite("input_path", &MultiReplayConfig::input_path)
@@ -152,7 +576,13 @@ void bind_replay(py::module_& m) {
         .def_readwrite("default_max_price", &MultiReplayConfig::default_max_price)
         .def_readwrite("default_tick_size", &MultiReplayConfig::default_tick_size)
         .def_readwrite("default_max_orders", &MultiReplayConfig::default_max_orders)
-        .def_readwrite("verbose", &MultiReplayConfig::verbose);
+        .def_readwrite("verbose", &MultiReplayConfig::verbose)
+        .def_readwrite("threading", &MultiReplayConfig::threading)
+        .def_readwrite("parse_threads", &MultiReplayConfig::parse_threads)
+        .def_readwrite("parse_chunk_bytes", &MultiReplayConfig::parse_chunk_bytes)
+        .def_readwrite("matching_workers", &MultiReplayConfig::matching_workers)
+        .def_readwrite("worker_assignment", &MultiReplayConfig::worker_assignment)
+        .def_readwrite("merge_events", &MultiReplayConfig::merge_events);
 
     // --- PerInstrumentStats ---
 
@@ -182,6 +612,8 @@ void bind_replay(py::module_& m) {
         .def_readonly("elapsed_seconds", &MultiReplayStats::elapsed_seconds)
         .def_readonly("messages_per_second", &MultiReplayStats::messages_per_second)
         .def_readonly("per_instrument", &MultiReplayStats::per_instrument)
+        .def("per_instrument_array", &per_instrument_array,
+             "Numeric per-instrument stats as one structured numpy array")
         .def("to_dict", [](const MultiReplayStats& s) {
             py::dict d;
             d["total_messages"] = s.total_messages;
@@ -208,14 +640,20 @@ void bind_replay(py::module_& m) {
     py::class_<MultiInstrumentReplayEngine>(m, "MultiInstrumentReplayEngine")
         .def(py::init<const MultiReplayConfig&>(), py::arg("config"))
         .def("run", &MultiInstrumentReplayEngine::run,
-             "Run multi-instrument replay to completion. Returns MultiReplayStats.")
+             py::call_guard<py::gil_scoped_release>(),
+             "Run multi-instrument replay to completion (without the GIL). "
+             "Returns MultiReplayStats.")
+        .def("events",
+            [](MultiInstrumentReplayEngine& engine, size_t batch_size, bool gating) {
+                return std::make_unique<MultiReplayEventStream>(engine, batch_size, gating);
+            },
+            py::arg("batch_size") = 65536, py::arg("gating") = true,
+            py::keep_alive<0, 1>(),
+            "Instead of run(): replay on a native thread and iterate over the events "
+            "of every instrument in structured numpy batches (see ReplayEngine.events).")
         .def("register_event_callback",
             [](MultiInstrumentReplayEngine& engine, py::function callback) {
-                engine.register_event_callback(
-                    [callback](const EventMessage& msg) {
-                        py::gil_scoped_acquire acquire;
-                        callback(event_message_to_dict(msg));
-                    });
+                engine.register_event_callback(python_event_callback(std::move(callback)));
             },
             py::arg("callback"),
             "Register a Python callback to receive event dicts during replay")
@@ -229,13 +667,22 @@ void bind_replay(py::module_& m) {
             py::arg("analytics"),
             py::keep_alive<1, 2>(),
             "Wire MultiInstrumentAnalytics to receive events directly (no Python overhead)")
+        .def("register_trade_log",
+            [](MultiInstrumentReplayEngine& engine, TradeLog& log) {
+                engine.register_event_callback(
+                    [&log](const EventMessage& msg) { log.on_event(msg); });
+            },
+            py::arg("log"),
+            py::keep_alive<1, 2>(),
+            "Collect trades of every instrument into a TradeLog (no Python overhead)")
         .def("router",
             &MultiInstrumentReplayEngine::router,
             py::return_value_policy::reference_internal,
-            "Access the InstrumentRouter")
+            "Access the InstrumentRouter (serial replays; with matching_workers the "
+            "books are reached through order_book)")
         .def("order_book",
             [](const MultiInstrumentReplayEngine& engine, InstrumentId id) -> py::object {
-                const OrderBook* book = engine.router().order_book(id);
+                const OrderBook* book = engine.order_book(id);
                 if (!book) return py::none();
                 return py::cast(book, py::return_value_policy::reference);
             },
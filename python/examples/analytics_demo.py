@@ -47,6 +47,10 @@ def main():
     # Wire analytics to receive events directly in C++ (no Python overhead).
     engine.register_analytics(analytics)
 
+    # Collect trades in C++ as well, for a numpy view after the run.
+    trades = hft.TradeLog()
+    engine.register_trade_log(trades)
+
     # Run replay.
     stats = engine.run()
 
@@ -71,6 +75,14 @@ def main():
     results = analytics.to_dict()
     print(f"\n  Analytics dict keys: {list(results.keys())}")
 
+    # Zero-copy numpy views (structured arrays; pandas.DataFrame(view) works).
+    series = analytics.time_series()
+    trade_array = trades.array()
+    print(f"\n  Time series rows: {len(series)}, fields: {series.dtype.names}")
+    print(f"  Trades: {len(trade_array)}, "
+          f"volume={int(trade_array['quantity'].sum())}")
+    print(f"  Top of book: {engine.order_book.depth_array(hft.Side.Buy, 5)}")
+
     # Write outputs.
     output_dir = os.path.join(repo_root, "build")
     os.makedirs(output_dir, exist_ok=True)
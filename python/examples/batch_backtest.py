@@ -0,0 +1,57 @@
+"""Vectorized backtest: submit whole numpy order batches to a matching session.
+
+Generates random limit and IOC orders around a mid price, runs them
+through the matching engine in batches, cancels what is left resting and
+prints the fill statistics.
+
+Usage:
+    python python/examples/batch_backtest.py
+"""
+
+import os
+import sys
+
+import numpy as np
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+python_dir = os.path.dirname(script_dir)
+sys.path.insert(0, python_dir)
+
+import hft_orderbook as hft
+
+
+def main():
+    config = hft.InstrumentConfig()
+    config.symbol = "BTCUSDT"
+    config.min_price = hft.float_to_price(41000.0)
+    config.max_price = hft.float_to_price(43000.0)
+    config.tick_size = hft.float_to_price(0.01)
+    config.max_orders = 1_000_000
+
+    session = hft.MatchingSession(config)
+
+    rng = np.random.default_rng(42)
+    n = 200_000
+    ids = np.arange(1, n + 1, dtype=np.uint64)
+    sides = rng.integers(0, 2, n, dtype=np.uint8)
+    ticks = rng.integers(-50, 51, n)
+    prices = hft.float_to_price(42000.0) + ticks * config.tick_size
+    quantities = rng.integers(1, 100, n, dtype=np.uint64)
+    types = np.where(rng.random(n) < 0.9, int(hft.OrderType.Limit),
+                     int(hft.OrderType.IOC)).astype(np.uint8)
+
+    results = session.submit_batch(ids, sides, prices, quantities, types=types)
+    filled = results["filled_quantity"]
+    print("=== Batch Submission ===")
+    print(f"  Orders:    {len(results)} ({int(results['accepted'].sum())} accepted)")
+    print(f"  Trades:    {int(results['trade_count'].sum())}")
+    print(f"  Filled:    {int(filled.sum())} of {int(quantities.sum())}")
+    print(f"  Resting:   {session.order_book.order_count}")
+
+    cancels = session.cancel_batch(ids)
+    print(f"  Cancelled: {int(cancels['accepted'].sum())}")
+    print(f"  Book empty: {session.order_book.order_count == 0}")
+
+
+if __name__ == "__main__":
+    main()
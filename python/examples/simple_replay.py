@@ -76,6 +76,22 @@ def main():
     print(f"  float_to_price(42000.50) = {hft.float_to_price(42000.50)}")
     print(f"  price_to_float(4200050000000) = {hft.price_to_float(4200050000000)}")
 
+    # Stream the events instead: the replay runs on a native thread while
+    # Python works through numpy batches drained from the event ring.
+    config.enable_publisher = True
+    streamed = hft.ReplayEngine(config)
+    trade_type = int(hft.EventType.Trade)
+    events = trades = volume = 0
+    stream = streamed.events(batch_size=16384)
+    for batch in stream:
+        is_trade = batch["type"] == trade_type
+        events += len(batch)
+        trades += int(is_trade.sum())
+        volume += int(batch["trade_quantity"][is_trade].sum())
+    print(f"\n=== Streamed Events ===")
+    print(f"  Events: {events}, trades: {trades}, volume: {volume}")
+    print(f"  Replay messages: {stream.stats.total_messages}")
+
 
 if __name__ == "__main__":
     main()
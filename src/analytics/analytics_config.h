@@ -6,9 +6,29 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace hft {
 
+/// How a BarAggregator closes bars (see bar_aggregator.h).
+enum class BarType : uint8_t { Time, Tick, Volume, Dollar };
+
+struct BarConfig {
+    BarType type = BarType::Time;
+    /// Time: bar width in ns. Tick: trades. Volume: quantity. Dollar:
+    /// notional in whole currency units.
+    uint64_t threshold = 1'000'000'000;
+};
+
+/// Which events a module processes (see sample_gate.h).
+enum class SampleTrigger : uint8_t { EveryEvent, Trades, EveryNth, Interval, BboChange };
+
+struct SampleConfig {
+    SampleTrigger trigger = SampleTrigger::EveryEvent;
+    uint64_t every = 1;           // EveryNth: events; Interval: ns of feed time
+    bool include_trades = true;   // Trades pass whatever the trigger
+};
+
 /// Configuration for all analytics modules.
 struct AnalyticsConfig {
     size_t imbalance_window = 100;
@@ -16,6 +36,32 @@ struct AnalyticsConfig {
     uint64_t vol_time_bar_ns = 1'000'000'000;  // 1 second
     size_t impact_regression_window = 200;
     size_t depth_max_levels = 10;
+    /// Maintain the depth profile from LevelUpdate events instead of a book
+    /// walk per event (the book must journal level deltas; see DepthProfile).
+    bool depth_from_level_updates = false;
+    /// Per-module sampling. Order flow imbalance and bars see every trade
+    /// and nothing else, so they have none; with depth_from_level_updates,
+    /// level deltas always reach the depth profile and only its snapshots
+    /// are sampled.
+    SampleConfig spread_sampling;
+    SampleConfig microprice_sampling;
+    SampleConfig volatility_sampling;
+    SampleConfig impact_sampling;
+    SampleConfig depth_sampling;
+    /// MultiInstrumentAnalytics: build each instrument's engine on its
+    /// QuoteSnapshotSlot (InstrumentConfig::quote_snapshot) instead of its
+    /// book, so the engines can run on an AnalyticsThread. Instruments
+    /// without a slot keep reading their book.
+    bool use_quote_snapshots = false;
+    /// One BarAggregator per entry, fed every trade (AnalyticsEngine::bars).
+    std::vector<BarConfig> bars;
+    size_t time_series_reserve = 0;  // Trade rows to preallocate (0 = grow on demand)
+    /// Stream the per-trade time series to this column file (see
+    /// time_series_columns.h) instead of keeping it in memory. Memory then
+    /// stays at a few blocks of time_series_block_rows rows however long
+    /// the run. MultiInstrumentAnalytics writes `<path>.<instrument id>`.
+    std::string time_series_columns_path;
+    size_t time_series_block_rows = 65536;
     std::string csv_path;   // empty = no CSV output
     std::string json_path;  // empty = no JSON output
 };
@@ -11,12 +11,54 @@ namespace hft {
 
 AnalyticsEngine::AnalyticsEngine(const OrderBook& book,
                                    const AnalyticsConfig& config)
-    : book_(book),
+    : AnalyticsEngine(MarketView(book), config) {}
+
+AnalyticsEngine::AnalyticsEngine(const QuoteSnapshotSlot& quote,
+                                   const AnalyticsConfig& config)
+    : AnalyticsEngine(MarketView(quote), config) {}
+
+AnalyticsEngine::AnalyticsEngine(const MarketView& view,
+                                   const AnalyticsConfig& config)
+    : view_(view),
       config_(config),
       order_flow_(config.imbalance_window),
       volatility_(config.vol_tick_window, config.vol_time_bar_ns),
       price_impact_(config.impact_regression_window),
-      depth_(config.depth_max_levels) {}
+      depth_(config.depth_max_levels, config.depth_from_level_updates),
+      spread_gate_(config.spread_sampling),
+      microprice_gate_(config.microprice_sampling),
+      volatility_gate_(config.volatility_sampling),
+      impact_gate_(config.impact_sampling),
+      depth_gate_(config.depth_sampling) {
+    bars_.reserve(config.bars.size());
+    for (const BarConfig& bar : config.bars) bars_.emplace_back(bar);
+    if (!config.time_series_columns_path.empty()) {
+        TimeSeriesWriterConfig writer_config;
+        writer_config.path = config.time_series_columns_path;
+        writer_config.block_rows = config.time_series_block_rows;
+        columns_ = std::make_unique<TimeSeriesColumnWriter>(writer_config);
+        if (!columns_->open()) {
+            std::cerr << "Analytics time series: " << columns_->error()
+                      << "; keeping it in memory\n";
+            columns_.reset();
+        }
+    }
+    if (!columns_) time_series_.reserve(config.time_series_reserve);
+}
+
+AnalyticsEngine::~AnalyticsEngine() { close_time_series(); }
+
+void AnalyticsEngine::close_time_series() const {
+    if (columns_) columns_->close();
+}
+
+void AnalyticsEngine::set_bar_sink(const BarSink& sink) {
+    for (BarAggregator& bar : bars_) bar.set_sink(sink);
+}
+
+void AnalyticsEngine::flush_bars() {
+    for (BarAggregator& bar : bars_) bar.flush();
+}
 
 Side AnalyticsEngine::infer_aggressor(Price trade_price) const {
     // Lee-Ready tick test: trade at or above mid => buyer-initiated
@@ -25,22 +67,36 @@ Side AnalyticsEngine::infer_aggressor(Price trade_price) const {
 }
 
 void AnalyticsEngine::on_event(const EventMessage& event) {
+    (void)view_.refresh();  // Snapshot views: the latest publish
+
+    // Level deltas only feed the depth profile; the other modules sample
+    // per order event and would count them as extra observations
+    if (event.type == EventType::LevelUpdate) {
+        depth_.on_event(event, view_);
+        return;
+    }
+    if (event.type == EventType::BookDigest) return;  // Verification only
+
     // Cache pre-trade mid for Lee-Ready
-    Price current_mid = book_.mid_price();
+    Price current_mid = view_.mid_price();
 
-    // Infer aggressor side before dispatching (only meaningful for trades)
+    // Aggressor side as matched, or inferred for prints that carry none
+    // (auction uncrosses, trades from other producers)
     Side aggressor = Side::Buy;
     if (event.type == EventType::Trade) {
-        aggressor = infer_aggressor(event.data.trade.price);
+        const Trade trade = event_trade(event);
+        aggressor = trade.has_aggressor() ? trade.aggressor_side
+                                          : infer_aggressor(trade.price);
     }
 
-    // Dispatch to all modules
-    spread_.on_event(event, book_);
-    microprice_.on_event(event, book_);
-    order_flow_.on_event(event, book_, aggressor);
-    volatility_.on_event(event, book_);
-    price_impact_.on_event(event, book_, aggressor);
-    depth_.on_event(event, book_);
+    // Dispatch to every module whose gate admits the event
+    if (spread_gate_.admit(event, view_)) spread_.on_event(event, view_);
+    if (microprice_gate_.admit(event, view_)) microprice_.on_event(event, view_);
+    order_flow_.on_event(event, view_, aggressor);
+    if (volatility_gate_.admit(event, view_)) volatility_.on_event(event, view_);
+    if (impact_gate_.admit(event, view_)) price_impact_.on_event(event, view_, aggressor);
+    if (depth_gate_.admit(event, view_)) depth_.on_event(event, view_);
+    for (BarAggregator& bar : bars_) bar.on_event(event, view_, aggressor);
 
     // Capture time-series row on trade
     if (event.type == EventType::Trade) {
@@ -49,14 +105,19 @@ void AnalyticsEngine::on_event(const EventMessage& event) {
         row.timestamp = event.data.trade.timestamp;
         row.trade_price = event.data.trade.price;
         row.trade_quantity = event.data.trade.quantity;
-        row.spread = book_.spread();
+        row.spread = view_.spread();
         row.spread_bps = spread_.current_spread_bps();
         row.microprice = microprice_.is_valid() ? microprice_.current_microprice() : 0.0;
         row.imbalance = order_flow_.current_imbalance();
         row.tick_vol = volatility_.tick_volatility();
         row.depth_imbalance = depth_.depth_imbalance();
         row.aggressor_side = aggressor;
-        time_series_.push_back(row);
+        ++trade_count_;
+        if (columns_) {
+            columns_->append(row);
+        } else {
+            time_series_.push_back(row);
+        }
     }
 
     // Update prev_mid after processing
@@ -73,10 +134,25 @@ nlohmann::json AnalyticsEngine::to_json() const {
     j["realized_volatility"] = volatility_.to_json();
     j["price_impact"] = price_impact_.to_json();
     j["depth_profile"] = depth_.to_json();
-    j["trade_count"] = time_series_.size();
+    j["trade_count"] = trade_count_;
+    if (!bars_.empty()) {
+        nlohmann::json bars = nlohmann::json::array();
+        for (const BarAggregator& bar : bars_) bars.push_back(bar.to_json());
+        j["bars"] = bars;
+    }
     return j;
 }
 
+size_t AnalyticsEngine::consume(PackedEventBuffer& buffer, size_t max) {
+    size_t count = 0;
+    EventMessage event{};
+    while (count < max && buffer.try_pop(event)) {
+        on_event(event);
+        ++count;
+    }
+    return count;
+}
+
 void AnalyticsEngine::write_json(const std::string& path) const {
     std::ofstream out(path);
     if (!out.is_open()) {
@@ -103,7 +179,7 @@ void AnalyticsEngine::write_csv(const std::string& path) const {
     };
 
     out << std::fixed << std::setprecision(8);
-    for (const auto& row : time_series_) {
+    auto write_row = [&](const TimeSeriesRow& row) {
         out << row.sequence_num << ","
             << row.timestamp << ","
             << price_to_double(row.trade_price) << ","
@@ -116,7 +192,19 @@ void AnalyticsEngine::write_csv(const std::string& path) const {
             << row.depth_imbalance << ","
             << (row.aggressor_side == Side::Buy ? "BUY" : "SELL")
             << "\n";
+    };
+
+    if (!columns_) {
+        for (const auto& row : time_series_) write_row(row);
+        return;
     }
+    close_time_series();
+    TimeSeriesColumnReader reader;
+    if (!reader.open(columns_->path())) {
+        std::cerr << "Failed to read analytics time series: " << reader.error() << "\n";
+        return;
+    }
+    for (uint64_t i = 0; i < reader.row_count(); ++i) write_row(reader.row(i));
 }
 
 void AnalyticsEngine::print_summary() const {
@@ -163,6 +251,14 @@ void AnalyticsEngine::print_summary() const {
     std::cout << "  Bid levels: " << depth_.bid_depth().size() << "\n";
     std::cout << "  Ask levels: " << depth_.ask_depth().size() << "\n";
 
+    if (!bars_.empty()) {
+        std::cout << "\nBars:\n";
+        for (const BarAggregator& bar : bars_) {
+            std::cout << "  " << bar_type_name(bar.config().type) << ":" << bar.config().threshold
+                      << "  " << bar.bars_emitted() << " bars\n";
+        }
+    }
+
     (void)price_to_double;  // suppress unused warning when not needed
 }
 
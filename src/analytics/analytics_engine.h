@@ -3,42 +3,56 @@
 /// @file analytics_engine.h
 /// @brief Orchestrator for all analytics modules with JSON/CSV output.
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
 #include "analytics/analytics_config.h"
+#include "analytics/bar_aggregator.h"
 #include "analytics/depth_profile.h"
+#include "analytics/market_view.h"
 #include "analytics/microprice_calculator.h"
 #include "analytics/order_flow_imbalance.h"
 #include "analytics/price_impact.h"
 #include "analytics/realized_volatility.h"
+#include "analytics/sample_gate.h"
 #include "analytics/spread_analytics.h"
+#include "analytics/time_series_columns.h"
 #include "core/types.h"
 #include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
 #include "transport/message.h"
+#include "transport/packed_event_buffer.h"
 
 namespace hft {
 
-/// A single time-series row captured on each Trade event.
-struct TimeSeriesRow {
-    uint64_t sequence_num;
-    Timestamp timestamp;
-    Price trade_price;
-    Quantity trade_quantity;
-    Price spread;
-    double spread_bps;
-    double microprice;
-    double imbalance;
-    double tick_vol;
-    double depth_imbalance;
-    Side aggressor_side;
-};
-
-/// Orchestrates all 6 analytics modules. Single callback to register with
-/// ReplayEngine. Infers aggressor side via Lee-Ready tick test, dispatches
-/// to all modules, captures time-series rows for CSV output.
+/// Orchestrates all 6 analytics modules, plus one BarAggregator per
+/// AnalyticsConfig::bars entry. Single callback to register with
+/// ReplayEngine. Takes the aggressor side from the trade (the engine sets
+/// it on every continuous fill), inferring it via Lee-Ready tick test only
+/// for trades without one; dispatches to all modules, captures time-series
+/// rows for CSV output.
+///
+/// Each of the spread, microprice, volatility, impact and depth modules
+/// sits behind a SampleGate built from its AnalyticsConfig::*_sampling, so
+/// a module configured to sample (every Nth event, every T ns, on BBO
+/// change) skips the rest of the events.
+///
+/// Every module's rolling window and depth buffer is allocated at
+/// construction from AnalyticsConfig, so on_event() does not touch the heap
+/// in steady state; the per-trade time series only grows past
+/// AnalyticsConfig::time_series_reserve rows. With
+/// AnalyticsConfig::time_series_columns_path set it is not held at all:
+/// rows stream to a column file through a TimeSeriesColumnWriter.
+///
+/// Built on an OrderBook, on_event() must run on the book's thread (a
+/// replay callback). Built on the book's QuoteSnapshotSlot, it reads the
+/// gateway's published BBO and depth instead (see market_view.h) and can
+/// consume the event stream on its own core (AnalyticsThread), off the
+/// matching path.
 class AnalyticsEngine {
 public:
     /// @param book   Reference to the order book (must outlive this object).
@@ -46,15 +60,45 @@ public:
     AnalyticsEngine(const OrderBook& book,
                     const AnalyticsConfig& config = {});
 
+    /// @param quote  Snapshot slot the book's gateway publishes into (must
+    ///               outlive this object).
+    /// @param config Configuration for all modules.
+    AnalyticsEngine(const QuoteSnapshotSlot& quote,
+                    const AnalyticsConfig& config = {});
+
+    ~AnalyticsEngine();
+
     /// Process an event — dispatches to all modules.
     void on_event(const EventMessage& event);
 
+    /// Decode and process up to `max` events from a packed event buffer
+    /// (as its only consumer). Returns the number processed.
+    size_t consume(PackedEventBuffer& buffer, size_t max = SIZE_MAX);
+
     /// Write aggregate JSON summary to file.
     void write_json(const std::string& path) const;
 
-    /// Write time-series CSV (one row per trade) to file.
+    /// Write time-series CSV (one row per trade) to file. When streaming to
+    /// a column file, finishes it (close_time_series) and reads it back.
     void write_csv(const std::string& path) const;
 
+    /// Streaming: flush the last block and finish the column file, so it
+    /// can be read. Later trades are no longer recorded. No-op otherwise;
+    /// also done on destruction.
+    void close_time_series() const;
+
+    /// Send every completed bar of every aggregator to `sink` (called on
+    /// the on_event() thread).
+    void set_bar_sink(const BarSink& sink);
+
+    /// Emit the open bars (end of stream).
+    void flush_bars();
+
+    /// The column writer when streaming (nullptr otherwise).
+    [[nodiscard]] const TimeSeriesColumnWriter* time_series_writer() const {
+        return columns_.get();
+    }
+
     /// Print human-readable summary to stdout.
     void print_summary() const;
 
@@ -68,14 +112,30 @@ public:
     [[nodiscard]] const RealizedVolatility& volatility() const { return volatility_; }
     [[nodiscard]] const PriceImpact& price_impact() const { return price_impact_; }
     [[nodiscard]] const DepthProfile& depth() const { return depth_; }
-
-    [[nodiscard]] size_t trade_count() const { return time_series_.size(); }
+    /// Gates in front of the sampled modules (admitted / skipped counts).
+    [[nodiscard]] const SampleGate& spread_gate() const { return spread_gate_; }
+    [[nodiscard]] const SampleGate& microprice_gate() const { return microprice_gate_; }
+    [[nodiscard]] const SampleGate& volatility_gate() const { return volatility_gate_; }
+    [[nodiscard]] const SampleGate& impact_gate() const { return impact_gate_; }
+    [[nodiscard]] const SampleGate& depth_gate() const { return depth_gate_; }
+    /// One per AnalyticsConfig::bars entry, in that order.
+    [[nodiscard]] const std::vector<BarAggregator>& bars() const { return bars_; }
+
+    [[nodiscard]] size_t trade_count() const { return trade_count_; }
+
+    /// The in-memory per-trade time series (empty when streaming to a
+    /// column file). Grows with on_event(): pointers into it are valid
+    /// until the next event.
+    [[nodiscard]] const std::vector<TimeSeriesRow>& time_series() const { return time_series_; }
 
 private:
-    /// Infer aggressor side using Lee-Ready tick test.
+    AnalyticsEngine(const MarketView& view, const AnalyticsConfig& config);
+
+    /// Infer aggressor side using Lee-Ready tick test (trades that do not
+    /// carry one).
     [[nodiscard]] Side infer_aggressor(Price trade_price) const;
 
-    const OrderBook& book_;
+    MarketView view_;
     AnalyticsConfig config_;
 
     SpreadAnalytics spread_;
@@ -84,12 +144,21 @@ private:
     RealizedVolatility volatility_;
     PriceImpact price_impact_;
     DepthProfile depth_;
+    std::vector<BarAggregator> bars_;
+
+    SampleGate spread_gate_;
+    SampleGate microprice_gate_;
+    SampleGate volatility_gate_;
+    SampleGate impact_gate_;
+    SampleGate depth_gate_;
 
     // Lee-Ready state
     Price prev_mid_ = 0;
 
-    // Time series
+    // Time series, in memory or streamed to columns_
     std::vector<TimeSeriesRow> time_series_;
+    std::unique_ptr<TimeSeriesColumnWriter> columns_;
+    size_t trade_count_ = 0;
 };
 
 }  // namespace hft
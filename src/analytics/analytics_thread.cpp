@@ -0,0 +1,62 @@
+#include "analytics/analytics_thread.h"
+
+#include <utility>
+
+namespace hft {
+
+AnalyticsThread::AnalyticsThread(EventBuffer& buffer, const AnalyticsThreadConfig& config)
+    : buffer_(buffer), config_(config) {}
+
+AnalyticsThread::~AnalyticsThread() { stop(); }
+
+void AnalyticsThread::register_callback(std::function<void(const EventMessage&)> callback) {
+    callbacks_.push_back(std::move(callback));
+}
+
+bool AnalyticsThread::start() {
+    if (running()) return false;
+    consumer_ = buffer_.add_consumer(config_.gating);
+    if (consumer_ == EventBuffer::INVALID_CONSUMER) return false;
+
+    publisher_ = std::make_unique<MarketDataPublisher>(buffer_, consumer_, config_.wait);
+    for (const auto& cb : callbacks_) publisher_->register_callback(cb);
+    stopping_.store(false, std::memory_order_relaxed);
+    lost_ = 0;
+    thread_ = std::thread([this] { run(); });
+    return true;
+}
+
+void AnalyticsThread::stop() {
+    if (!running()) return;
+    stopping_.store(true, std::memory_order_release);
+    if (WakeupSignal* signal = buffer_.wakeup()) signal->notify();
+    thread_.join();
+    lost_ = buffer_.lost(consumer_);
+    buffer_.remove_consumer(consumer_);
+    consumer_ = EventBuffer::INVALID_CONSUMER;
+}
+
+uint64_t AnalyticsThread::lost() const noexcept {
+    return consumer_ != EventBuffer::INVALID_CONSUMER ? buffer_.lost(consumer_) : lost_;
+}
+
+// Not MarketDataPublisher::run(): a stop() issued before that loop starts
+// would be overwritten by its own start flag.
+void AnalyticsThread::run() {
+    ScopedThreadPlacement placement(config_.threading, ThreadRole::Analytics);
+    Waiter waiter(config_.wait, buffer_.wakeup());
+    auto ready = [this] {
+        return buffer_.size(consumer_) != 0 || stopping_.load(std::memory_order_acquire);
+    };
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (publisher_->poll() == 0) {
+            waiter.idle(ready);
+        } else {
+            waiter.reset();
+        }
+    }
+    while (publisher_->poll() != 0) {
+    }
+}
+
+}  // namespace hft
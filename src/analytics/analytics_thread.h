@@ -0,0 +1,96 @@
+#pragma once
+
+/// @file analytics_thread.h
+/// @brief Runs event consumers (typically an AnalyticsEngine) on a thread
+///        of their own, reading the event ring through their own cursor.
+///
+/// Cold-path component. A replay callback runs on the thread that polls
+/// the ring's PRIMARY cursor, which in the inline replay is the matching
+/// thread, so every module added to the analytics adds to matching
+/// latency. An AnalyticsThread instead adds a cursor to the EventBuffer
+/// (EventBuffer::add_consumer), drains it with a MarketDataPublisher on
+/// its own thread (placed as ThreadRole::Analytics), and calls the
+/// registered callbacks there.
+///
+/// Callbacks then run concurrently with matching, so they must not read
+/// the book: build the AnalyticsEngine on the book's QuoteSnapshotSlot
+/// (InstrumentConfig::quote_snapshot, ReplayConfig::quote_snapshot).
+///
+/// A non-gating cursor (the default) never holds the producer back. If
+/// the consumers fall a whole ring behind, the oldest events are skipped
+/// and counted in lost(). A gating cursor loses nothing, but then the
+/// matching thread waits whenever the ring is full.
+///
+/// Usage:
+///   AnalyticsEngine analytics(*engine.quote_snapshot());
+///   AnalyticsThread thread(*engine.event_buffer());
+///   thread.register_callback([&](const EventMessage& e) { analytics.on_event(e); });
+///   thread.start();
+///   engine.run();
+///   thread.stop();   // Drains what was published, then joins
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gateway/market_data_publisher.h"
+#include "transport/event_buffer.h"
+#include "transport/message.h"
+#include "transport/wait_strategy.h"
+#include "utils/thread_placement.h"
+
+namespace hft {
+
+struct AnalyticsThreadConfig {
+    bool gating = false;          // Hold the producer back rather than lose events
+    WaitConfig wait;              // How the thread waits on an empty ring
+    ThreadingConfig threading;    // CPU of ThreadRole::Analytics, SCHED_FIFO
+};
+
+class AnalyticsThread {
+public:
+    explicit AnalyticsThread(EventBuffer& buffer, const AnalyticsThreadConfig& config = {});
+    ~AnalyticsThread();
+
+    AnalyticsThread(const AnalyticsThread&) = delete;
+    AnalyticsThread& operator=(const AnalyticsThread&) = delete;
+
+    /// Add a consumer. Call before start().
+    void register_callback(std::function<void(const EventMessage&)> callback);
+
+    /// Add the cursor (at the ring's head: events published from now on)
+    /// and start the thread. Returns false if already started or the ring
+    /// has no free cursor.
+    bool start();
+
+    /// Drain everything published so far, then join the thread and remove
+    /// the cursor. Call once the producer has stopped publishing.
+    void stop();
+
+    [[nodiscard]] bool running() const noexcept { return thread_.joinable(); }
+
+    /// Events passed to the callbacks (approximate while running).
+    [[nodiscard]] uint64_t events_processed() const noexcept {
+        return publisher_ ? publisher_->events_processed() : 0;
+    }
+
+    /// Events skipped because the thread fell a whole ring behind.
+    [[nodiscard]] uint64_t lost() const noexcept;
+
+private:
+    void run();
+
+    EventBuffer& buffer_;
+    AnalyticsThreadConfig config_;
+    std::vector<std::function<void(const EventMessage&)>> callbacks_;
+    EventBuffer::ConsumerId consumer_ = EventBuffer::INVALID_CONSUMER;
+    std::unique_ptr<MarketDataPublisher> publisher_;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+    uint64_t lost_ = 0;  // Captured when the cursor is removed
+};
+
+}  // namespace hft
@@ -0,0 +1,192 @@
+#include "analytics/bar_aggregator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+#include <nlohmann/json.hpp>
+
+namespace hft {
+
+BarAggregator::BarAggregator(const BarConfig& config, BarSink sink)
+    : config_(config), sink_(std::move(sink)) {
+    config_.threshold = std::max<uint64_t>(config_.threshold, 1);
+}
+
+void BarAggregator::open_bar(const EventMessage& event) {
+    const TradeEventData& trade = event.data.trade;
+    bar_ = Bar{};
+    bar_.instrument_id = event.instrument_id;
+    bar_.type = config_.type;
+    bar_.first_sequence = event.sequence_num;
+    bar_.open = trade.price;
+    bar_.high = trade.price;
+    bar_.low = trade.price;
+    if (config_.type == BarType::Time) {
+        bar_.open_time = trade.timestamp / config_.threshold * config_.threshold;
+        bar_.close_time = bar_.open_time + config_.threshold;
+    } else {
+        bar_.open_time = trade.timestamp;
+    }
+    spread_bps_sum_ = 0.0;
+    price_quantity_sum_ = 0.0;
+    open_ = true;
+}
+
+void BarAggregator::on_event(const EventMessage& event, const MarketView& book, Side aggressor) {
+    if (event.type != EventType::Trade) return;
+    const TradeEventData& trade = event.data.trade;
+
+    if (open_ && config_.type == BarType::Time && trade.timestamp >= bar_.close_time) emit();
+    if (!open_) open_bar(event);
+
+    bar_.last_sequence = event.sequence_num;
+    if (config_.type != BarType::Time) bar_.close_time = trade.timestamp;
+    bar_.high = std::max(bar_.high, trade.price);
+    bar_.low = std::min(bar_.low, trade.price);
+    bar_.close = trade.price;
+    bar_.volume += trade.quantity;
+    if (aggressor == Side::Buy) bar_.buy_volume += trade.quantity;
+    const double price_quantity =
+        static_cast<double>(trade.price) * static_cast<double>(trade.quantity);
+    price_quantity_sum_ += price_quantity;
+    bar_.notional += price_quantity / static_cast<double>(PRICE_SCALE);
+    ++bar_.trade_count;
+    if (bar_.volume > 0) bar_.vwap = price_quantity_sum_ / static_cast<double>(bar_.volume);
+
+    const Price spread = book.spread();
+    const Price mid = book.mid_price();
+    if (spread >= 0 && mid > 0) {
+        const double bps = static_cast<double>(spread) / static_cast<double>(mid) * 10000.0;
+        spread_bps_sum_ += bps;
+        ++bar_.spread_samples;
+        bar_.avg_spread_bps = spread_bps_sum_ / static_cast<double>(bar_.spread_samples);
+        bar_.max_spread_bps = std::max(bar_.max_spread_bps, bps);
+    }
+
+    bool complete = false;
+    switch (config_.type) {
+        case BarType::Time:
+            break;
+        case BarType::Tick:
+            complete = bar_.trade_count >= config_.threshold;
+            break;
+        case BarType::Volume:
+            complete = bar_.volume >= config_.threshold;
+            break;
+        case BarType::Dollar:
+            complete = bar_.notional >= static_cast<double>(config_.threshold);
+            break;
+    }
+    if (complete) emit();
+}
+
+void BarAggregator::flush() {
+    if (open_) emit();
+}
+
+void BarAggregator::emit() {
+    open_ = false;
+    last_ = bar_;
+    ++bars_emitted_;
+    if (sink_) sink_(last_);
+}
+
+nlohmann::json BarAggregator::to_json() const {
+    auto price_to_double = [](double p) { return p / static_cast<double>(PRICE_SCALE); };
+
+    nlohmann::json j;
+    j["type"] = bar_type_name(config_.type);
+    j["threshold"] = config_.threshold;
+    j["bars_emitted"] = bars_emitted_;
+    j["open_bar_trades"] = open_ ? bar_.trade_count : 0;
+    if (bars_emitted_ > 0) {
+        nlohmann::json last;
+        last["open_time"] = last_.open_time;
+        last["close_time"] = last_.close_time;
+        last["open"] = price_to_double(static_cast<double>(last_.open));
+        last["high"] = price_to_double(static_cast<double>(last_.high));
+        last["low"] = price_to_double(static_cast<double>(last_.low));
+        last["close"] = price_to_double(static_cast<double>(last_.close));
+        last["volume"] = last_.volume;
+        last["vwap"] = price_to_double(last_.vwap);
+        last["trade_count"] = last_.trade_count;
+        last["avg_spread_bps"] = last_.avg_spread_bps;
+        j["last_bar"] = last;
+    }
+    return j;
+}
+
+// ---------------------------------------------------------------------------
+// Names, specs and CSV
+// ---------------------------------------------------------------------------
+
+const char* bar_type_name(BarType type) {
+    switch (type) {
+        case BarType::Time: return "time";
+        case BarType::Tick: return "tick";
+        case BarType::Volume: return "volume";
+        case BarType::Dollar: return "dollar";
+    }
+    return "unknown";
+}
+
+bool parse_bar_spec(const char* spec, BarConfig& out) {
+    const char* colon = std::strchr(spec, ':');
+    if (colon == nullptr || colon[1] == '\0') return false;
+    const size_t length = static_cast<size_t>(colon - spec);
+
+    BarConfig config;
+    bool known = false;
+    for (BarType type : {BarType::Time, BarType::Tick, BarType::Volume, BarType::Dollar}) {
+        const char* name = bar_type_name(type);
+        if (std::strlen(name) == length && std::strncmp(spec, name, length) == 0) {
+            config.type = type;
+            known = true;
+        }
+    }
+    if (!known) return false;
+
+    char* end = nullptr;
+    config.threshold = std::strtoull(colon + 1, &end, 10);
+    if (*end != '\0' || config.threshold == 0) return false;
+    out = config;
+    return true;
+}
+
+void write_bar_csv_header(std::ostream& out) {
+    out << "instrument_id,type,first_sequence,last_sequence,open_time,close_time,"
+        << "open,high,low,close,volume,buy_volume,notional,vwap,trade_count,"
+        << "avg_spread_bps,max_spread_bps\n";
+}
+
+void write_bar_csv_row(std::ostream& out, const Bar& bar) {
+    auto price_to_double = [](double p) { return p / static_cast<double>(PRICE_SCALE); };
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(8);
+    out << bar.instrument_id << ","
+        << bar_type_name(bar.type) << ","
+        << bar.first_sequence << ","
+        << bar.last_sequence << ","
+        << bar.open_time << ","
+        << bar.close_time << ","
+        << price_to_double(static_cast<double>(bar.open)) << ","
+        << price_to_double(static_cast<double>(bar.high)) << ","
+        << price_to_double(static_cast<double>(bar.low)) << ","
+        << price_to_double(static_cast<double>(bar.close)) << ","
+        << bar.volume << ","
+        << bar.buy_volume << ","
+        << bar.notional << ","
+        << price_to_double(bar.vwap) << ","
+        << bar.trade_count << ","
+        << bar.avg_spread_bps << ","
+        << bar.max_spread_bps << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // namespace hft
@@ -0,0 +1,117 @@
+#pragma once
+
+/// @file bar_aggregator.h
+/// @brief Streaming time, tick, volume and dollar bars (OHLCV, VWAP, spread)
+///        built from the trade stream.
+///
+/// Cold-path component. A BarAggregator keeps one open bar and nothing
+/// else: each Trade updates its OHLC, volume, notional, VWAP and trade
+/// count, the quoted spread at the trade feeds its spread stats, and when
+/// the bar is complete it goes to the sink and a new one opens on the next
+/// trade. Memory is constant however long the run is. This replaces
+/// re-bucketing the time-series CSV after the replay.
+///
+/// Bar boundaries (BarConfig::threshold):
+///   Time    Bars cover [k * threshold, (k + 1) * threshold) ns of trade
+///           time and are emitted by the first trade at or past their end
+///           (or flush()). Intervals without trades produce no bar.
+///   Tick    Every `threshold` trades.
+///   Volume  Once the bar's quantity reaches `threshold`.
+///   Dollar  Once the bar's notional (price * quantity, in whole currency
+///           units) reaches `threshold`.
+/// Trades are never split: the trade that crosses a volume or dollar
+/// threshold closes its bar, so bars overshoot by at most one trade.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <utility>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "analytics/analytics_config.h"
+#include "analytics/market_view.h"
+#include "core/types.h"
+#include "transport/message.h"
+
+namespace hft {
+
+/// A completed (or, from current(), open) bar.
+struct Bar {
+    InstrumentId instrument_id;
+    BarType type;
+    uint64_t first_sequence;
+    uint64_t last_sequence;
+    Timestamp open_time;        // Time bars: bucket start; otherwise first trade
+    Timestamp close_time;       // Time bars: bucket end; otherwise last trade
+    Price open;
+    Price high;
+    Price low;
+    Price close;
+    Quantity volume;
+    Quantity buy_volume;        // Of buyer-initiated trades
+    double notional;            // Sum of price * quantity, whole currency units
+    double vwap;                // Fixed-point, as prices
+    uint64_t trade_count;
+    uint64_t spread_samples;    // Trades with a two-sided book
+    double avg_spread_bps;
+    double max_spread_bps;
+};
+
+using BarSink = std::function<void(const Bar&)>;
+
+class BarAggregator {
+public:
+    /// @param config Bar type and threshold (0 is treated as 1).
+    /// @param sink   Receives each completed bar (may be empty and set later).
+    explicit BarAggregator(const BarConfig& config, BarSink sink = {});
+
+    /// Process an event. Only trades change the bar; `aggressor` is the
+    /// trade's aggressor side and `book` gives the spread at the trade.
+    void on_event(const EventMessage& event, const MarketView& book, Side aggressor);
+
+    /// Emit the open bar, if any, as it stands (end of stream).
+    void flush();
+
+    void set_sink(BarSink sink) { sink_ = std::move(sink); }
+
+    [[nodiscard]] const BarConfig& config() const { return config_; }
+    [[nodiscard]] bool has_open_bar() const { return open_; }
+    /// The open bar (valid while has_open_bar()).
+    [[nodiscard]] const Bar& current() const { return bar_; }
+    /// The last completed bar (valid once bars_emitted() > 0).
+    [[nodiscard]] const Bar& last_bar() const { return last_; }
+    [[nodiscard]] uint64_t bars_emitted() const { return bars_emitted_; }
+
+    /// Serialize bar counts and the last completed bar to JSON.
+    [[nodiscard]] nlohmann::json to_json() const;
+
+private:
+    void open_bar(const EventMessage& event);
+    void emit();
+
+    BarConfig config_;
+    BarSink sink_;
+    Bar bar_{};
+    Bar last_{};
+    bool open_ = false;
+    double spread_bps_sum_ = 0.0;
+    double price_quantity_sum_ = 0.0;   // Fixed-point price * quantity, for the VWAP
+    uint64_t bars_emitted_ = 0;
+};
+
+/// Short name of a bar type ("time", "tick", "volume", "dollar").
+[[nodiscard]] const char* bar_type_name(BarType type);
+
+/// Parse a "<type>:<threshold>" spec ("time:1000000000", "volume:500").
+/// Returns false if it is malformed.
+[[nodiscard]] bool parse_bar_spec(const char* spec, BarConfig& out);
+
+/// CSV header for write_bar_csv_row(), with trailing newline.
+void write_bar_csv_header(std::ostream& out);
+
+/// One bar as a CSV line (prices in currency units).
+void write_bar_csv_row(std::ostream& out, const Bar& bar);
+
+}  // namespace hft
@@ -0,0 +1,287 @@
+#include "analytics/batch_analytics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#include <immintrin.h>
+#define HFT_BATCH_AVX512 1
+#endif
+
+#include "analytics/rolling_window.h"
+
+namespace hft {
+
+namespace {
+
+/// Run fn(begin, end) over chunk_rows-sized ranges of [0, rows), on up to
+/// options.threads threads (the caller is one of them).
+template <typename Fn>
+void for_each_chunk(size_t rows, const BatchOptions& options, Fn&& fn) {
+    const size_t chunk = std::max<size_t>(options.chunk_rows, 1);
+    const size_t chunks = (rows + chunk - 1) / chunk;
+    const size_t threads = std::min(std::max<size_t>(options.threads, 1), chunks);
+    if (threads <= 1) {
+        if (rows > 0) fn(size_t{0}, rows);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            fn(c * chunk, std::min(rows, (c + 1) * chunk));
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (std::thread& thread : pool) thread.join();
+}
+
+/// Whether SpreadAnalytics samples the row (both sides, mid > 0, not crossed).
+bool spread_sampled(const QuoteColumns& q, size_t i) {
+    if (q.bid_quantity[i] == 0 || q.ask_quantity[i] == 0) return false;
+    const Price mid = (q.bid_price[i] + q.ask_price[i]) / 2;
+    return mid > 0 && q.ask_price[i] - q.bid_price[i] >= 0;
+}
+
+void spread_bps_scalar(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!spread_sampled(q, i)) {
+            out[i] = 0.0;
+            continue;
+        }
+        const Price spread = q.ask_price[i] - q.bid_price[i];
+        const Price mid = (q.bid_price[i] + q.ask_price[i]) / 2;
+        out[i] = static_cast<double>(spread) / static_cast<double>(mid) * 10000.0;
+    }
+}
+
+void microprice_scalar(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    for (size_t i = begin; i < end; ++i) {
+        if (q.bid_quantity[i] == 0 || q.ask_quantity[i] == 0) {
+            out[i] = 0.0;
+            continue;
+        }
+        const auto bid_qty = static_cast<double>(q.bid_quantity[i]);
+        const auto ask_qty = static_cast<double>(q.ask_quantity[i]);
+        const auto bid_px = static_cast<double>(q.bid_price[i]);
+        const auto ask_px = static_cast<double>(q.ask_price[i]);
+        out[i] = (bid_qty * ask_px + ask_qty * bid_px) / (bid_qty + ask_qty);
+    }
+}
+
+#if defined(HFT_BATCH_AVX512)
+
+void spread_bps_kernel(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512d bps = _mm512_set1_pd(10000.0);
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m512i bid = _mm512_loadu_si512(q.bid_price + i);
+        const __m512i ask = _mm512_loadu_si512(q.ask_price + i);
+        const __m512i bid_qty = _mm512_loadu_si512(q.bid_quantity + i);
+        const __m512i ask_qty = _mm512_loadu_si512(q.ask_quantity + i);
+        const __m512i spread = _mm512_sub_epi64(ask, bid);
+        // (bid + ask) / 2: the shift rounds negative sums down rather than
+        // toward zero, but those rows fail mid > 0 either way. (Masked form:
+        // the plain _mm512_srai_epi64 trips -Wmaybe-uninitialized in GCC
+        // 12's headers.)
+        const __m512i mid =
+            _mm512_maskz_srai_epi64(static_cast<__mmask8>(0xFF), _mm512_add_epi64(bid, ask), 1);
+        const __mmask8 sampled = _mm512_cmpneq_epu64_mask(bid_qty, zero) &
+                                 _mm512_cmpneq_epu64_mask(ask_qty, zero) &
+                                 _mm512_cmpgt_epi64_mask(mid, zero) &
+                                 _mm512_cmpge_epi64_mask(spread, zero);
+        const __m512d value = _mm512_mul_pd(
+            _mm512_div_pd(_mm512_cvtepi64_pd(spread), _mm512_cvtepi64_pd(mid)), bps);
+        _mm512_storeu_pd(out + i, _mm512_maskz_mov_pd(sampled, value));
+    }
+    spread_bps_scalar(q, i, end, out);
+}
+
+void microprice_kernel(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    const __m512i zero = _mm512_setzero_si512();
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m512i bid_qty = _mm512_loadu_si512(q.bid_quantity + i);
+        const __m512i ask_qty = _mm512_loadu_si512(q.ask_quantity + i);
+        const __mmask8 valid =
+            _mm512_cmpneq_epu64_mask(bid_qty, zero) & _mm512_cmpneq_epu64_mask(ask_qty, zero);
+        const __m512d bq = _mm512_cvtepu64_pd(bid_qty);
+        const __m512d aq = _mm512_cvtepu64_pd(ask_qty);
+        const __m512d bp = _mm512_cvtepi64_pd(_mm512_loadu_si512(q.bid_price + i));
+        const __m512d ap = _mm512_cvtepi64_pd(_mm512_loadu_si512(q.ask_price + i));
+        const __m512d value = _mm512_div_pd(
+            _mm512_add_pd(_mm512_mul_pd(bq, ap), _mm512_mul_pd(aq, bp)), _mm512_add_pd(bq, aq));
+        _mm512_storeu_pd(out + i, _mm512_maskz_mov_pd(valid, value));
+    }
+    microprice_scalar(q, i, end, out);
+}
+
+#else
+
+void spread_bps_kernel(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    spread_bps_scalar(q, begin, end, out);
+}
+
+void microprice_kernel(const QuoteColumns& q, size_t begin, size_t end, double* out) {
+    microprice_scalar(q, begin, end, out);
+}
+
+#endif
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Element-wise kernels
+// ---------------------------------------------------------------------------
+
+void batch_spread_bps(const QuoteColumns& quotes, double* out, const BatchOptions& options) {
+    for_each_chunk(quotes.rows, options, [&](size_t begin, size_t end) {
+        spread_bps_kernel(quotes, begin, end, out);
+    });
+}
+
+SpreadSummary batch_spread_summary(const QuoteColumns& quotes, const BatchOptions& options) {
+    // Values in parallel; the sums in row order, as the module adds them
+    std::vector<double> bps(quotes.rows);
+    batch_spread_bps(quotes, bps.data(), options);
+
+    SpreadSummary summary;
+    double sum = 0.0;
+    for (size_t i = 0; i < quotes.rows; ++i) {
+        if (!spread_sampled(quotes, i)) continue;
+        sum += bps[i];
+        if (summary.spread_samples++ == 0) {
+            summary.min_spread_bps = bps[i];
+            summary.max_spread_bps = bps[i];
+        } else {
+            summary.min_spread_bps = std::min(summary.min_spread_bps, bps[i]);
+            summary.max_spread_bps = std::max(summary.max_spread_bps, bps[i]);
+        }
+    }
+    if (summary.spread_samples > 0) {
+        summary.avg_spread_bps = sum / static_cast<double>(summary.spread_samples);
+    }
+    return summary;
+}
+
+void batch_microprice(const QuoteColumns& quotes, double* out, const BatchOptions& options) {
+    for_each_chunk(quotes.rows, options, [&](size_t begin, size_t end) {
+        microprice_kernel(quotes, begin, end, out);
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Rolling kernels
+// ---------------------------------------------------------------------------
+
+void batch_order_flow_imbalance(const TradeColumns& trades, size_t window, double* out) {
+    // As OrderFlowImbalance: evict once `window` samples are held (a window
+    // of 0 behaves as 1), then add
+    const size_t w = std::max<size_t>(window, 1);
+    double buy_vol = 0.0;
+    double sell_vol = 0.0;
+    for (size_t i = 0; i < trades.rows; ++i) {
+        if (i >= w) {
+            const auto oldest = static_cast<double>(trades.quantity[i - w]);
+            if (trades.aggressor_side[i - w] == 0) {
+                buy_vol -= oldest;
+            } else {
+                sell_vol -= oldest;
+            }
+        }
+        const auto qty = static_cast<double>(trades.quantity[i]);
+        if (trades.aggressor_side[i] == 0) {
+            buy_vol += qty;
+        } else {
+            sell_vol += qty;
+        }
+        const double total = buy_vol + sell_vol;
+        out[i] = total <= 0.0 ? 0.0 : (buy_vol - sell_vol) / total;
+    }
+}
+
+void batch_tick_volatility(const Price* trade_price, size_t rows, size_t window, double* out,
+                           const BatchOptions& options) {
+    // The last positive price before each row (0 = none)
+    std::vector<double> prev(rows);
+    double last = 0.0;
+    for (size_t i = 0; i < rows; ++i) {
+        prev[i] = last;
+        if (trade_price[i] > 0) last = static_cast<double>(trade_price[i]);
+    }
+
+    // Log returns, in parallel (NaN marks rows without one)
+    std::vector<double> returns(rows);
+    for_each_chunk(rows, options, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto price = static_cast<double>(trade_price[i]);
+            returns[i] = (trade_price[i] > 0 && prev[i] > 0.0) ? std::log(price / prev[i])
+                                                               : std::nan("");
+        }
+    });
+
+    // The module's running sum, in row order
+    RollingWindow<double> held(window);
+    double sum = 0.0;
+    for (size_t i = 0; i < rows; ++i) {
+        const double r = returns[i];
+        if (!std::isnan(r)) {
+            if (!held.empty() && held.size() >= window) {
+                sum -= held.front() * held.front();
+                held.pop_front();
+            }
+            held.push_back(r);
+            sum += r * r;
+        }
+        out[i] = held.empty() ? 0.0 : std::sqrt(std::max(0.0, sum));
+    }
+}
+
+void batch_time_bar_volatility(const Timestamp* timestamp, const Price* mid, size_t rows,
+                               uint64_t bar_ns, size_t window, double* out) {
+    RollingWindow<double> held(window);
+    double sum = 0.0;
+    Timestamp bar_start = 0;
+    double bar_start_mid = 0.0;
+    bool initialized = false;
+    for (size_t i = 0; i < rows; ++i) {
+        const Timestamp ts = timestamp[i];
+        if (!initialized && ts > 0) {
+            bar_start = ts;
+            if (mid[i] > 0) {
+                bar_start_mid = static_cast<double>(mid[i]);
+                initialized = true;
+            }
+        } else if (initialized && ts >= bar_start + bar_ns) {
+            if (mid[i] > 0 && bar_start_mid > 0.0) {
+                const auto new_mid = static_cast<double>(mid[i]);
+                const double r = std::log(new_mid / bar_start_mid);
+                if (!held.empty() && held.size() >= window) {
+                    sum -= held.front() * held.front();
+                    held.pop_front();
+                }
+                held.push_back(r);
+                sum += r * r;
+                bar_start_mid = new_mid;
+            }
+            bar_start = ts;
+        }
+        out[i] = held.empty() ? 0.0 : std::sqrt(std::max(0.0, sum));
+    }
+}
+
+const char* batch_kernel_isa() noexcept {
+#if defined(HFT_BATCH_AVX512)
+    return "avx512";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace hft
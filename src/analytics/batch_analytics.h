@@ -0,0 +1,93 @@
+#pragma once
+
+/// @file batch_analytics.h
+/// @brief Whole-column versions of the spread, microprice, order-flow
+///        imbalance and realized-volatility modules.
+///
+/// Cold-path component. Recomputing a day of analytics through the
+/// event-driven modules costs a virtual book walk and a module dispatch
+/// per event. These kernels take the same inputs as contiguous columns
+/// and write one output value per row: the value the streaming module
+/// reports after processing that row. Sources are the time-series column
+/// file (TimeSeriesColumnReader: trade price, quantity and aggressor
+/// side), captured BBO columns, or numpy arrays from Python.
+///
+/// The element-wise kernels (spread, microprice) use AVX-512 where the
+/// build targets it; batch_analytics.cpp is compiled with -march=native
+/// and without floating-point contraction, so every row is rounded
+/// exactly as in the streaming modules. The rolling kernels are
+/// recurrences: their log returns are computed in parallel chunks, the
+/// running sums in row order, adding and evicting exactly as the
+/// modules do, so outputs are bit-identical too.
+///
+/// Quote rows follow MarketView: a side is empty when its quantity is 0.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types.h"
+
+namespace hft {
+
+/// Top of book per row, as MarketView reports it after the event.
+struct QuoteColumns {
+    const Price* bid_price = nullptr;
+    const Quantity* bid_quantity = nullptr;   // 0 = no bid
+    const Price* ask_price = nullptr;
+    const Quantity* ask_quantity = nullptr;   // 0 = no ask
+    size_t rows = 0;
+};
+
+/// One row per trade.
+struct TradeColumns {
+    const Price* price = nullptr;
+    const Quantity* quantity = nullptr;
+    const uint8_t* aggressor_side = nullptr;   // 0 = Buy, 1 = Sell (as TimeSeriesColumn)
+    size_t rows = 0;
+};
+
+struct BatchOptions {
+    size_t threads = 1;             // Chunks processed in parallel (1 = caller only)
+    size_t chunk_rows = 1 << 16;    // Rows per chunk
+};
+
+/// SpreadAnalytics over all rows: the running stats of its to_json().
+struct SpreadSummary {
+    double avg_spread_bps = 0.0;
+    double min_spread_bps = 0.0;
+    double max_spread_bps = 0.0;
+    uint64_t spread_samples = 0;
+};
+
+/// out[i] = SpreadAnalytics::current_spread_bps() after row i (0 for an
+/// empty side or a crossed book).
+void batch_spread_bps(const QuoteColumns& quotes, double* out, const BatchOptions& options = {});
+
+/// Spread statistics as SpreadAnalytics accumulates them over the rows
+/// (summed in row order).
+[[nodiscard]] SpreadSummary batch_spread_summary(const QuoteColumns& quotes,
+                                                 const BatchOptions& options = {});
+
+/// out[i] = MicropriceCalculator::current_microprice() after row i, or 0
+/// where it is not valid (as TimeSeriesRow::microprice).
+void batch_microprice(const QuoteColumns& quotes, double* out, const BatchOptions& options = {});
+
+/// out[i] = OrderFlowImbalance(window).current_imbalance() after trade i.
+void batch_order_flow_imbalance(const TradeColumns& trades, size_t window, double* out);
+
+/// out[i] = RealizedVolatility(window).tick_volatility() after trade i
+/// (prices <= 0 are skipped, as the module does).
+void batch_tick_volatility(const Price* trade_price, size_t rows, size_t window, double* out,
+                           const BatchOptions& options = {});
+
+/// out[i] = RealizedVolatility(window, bar_ns).time_bar_volatility() after
+/// row i, where rows are the events the module samples (trades and order
+/// acceptances) with their timestamp and the mid price after the event
+/// (0 = no mid).
+void batch_time_bar_volatility(const Timestamp* timestamp, const Price* mid, size_t rows,
+                               uint64_t bar_ns, size_t window, double* out);
+
+/// Instruction set of the element-wise kernels ("avx512" or "scalar").
+[[nodiscard]] const char* batch_kernel_isa() noexcept;
+
+}  // namespace hft
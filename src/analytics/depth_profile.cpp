@@ -1,56 +1,133 @@
 #include "analytics/depth_profile.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
 namespace hft {
 
-DepthProfile::DepthProfile(size_t max_levels)
-    : max_levels_(max_levels),
-      avg_bid_depth_(max_levels, 0.0),
-      avg_ask_depth_(max_levels, 0.0) {}
+DepthProfile::DepthProfile(size_t max_levels, bool from_level_updates)
+    : max_levels_(max_levels), from_level_updates_(from_level_updates) {
+    for (SideImage* side : {&bid_, &ask_}) {
+        side->entries.resize(max_levels);
+        side->prices.reserve(max_levels);
+        side->depth.reserve(max_levels);
+        side->accumulated.assign(max_levels, 0.0);
+        side->settled_at.assign(max_levels, 0);
+    }
+}
 
-void DepthProfile::on_event(const EventMessage& /*event*/,
-                             const OrderBook& book) {
-    // Allocate stack buffer for depth entries
-    std::vector<DepthEntry> bid_entries(max_levels_);
-    std::vector<DepthEntry> ask_entries(max_levels_);
+void DepthProfile::on_event(const EventMessage& event, const MarketView& book) {
+    if (!from_level_updates_) {
+        rescan(bid_, true, book);
+        rescan(ask_, false, book);
+    } else {
+        if (!seeded_) {
+            rescan(bid_, true, book);
+            rescan(ask_, false, book);
+            seeded_ = true;
+        }
+        if (event.type == EventType::LevelUpdate) {
+            apply(event.data.level_update, book);
+            return;  // A delta is not a snapshot
+        }
+    }
+    ++snapshot_count_;
+}
 
-    size_t bid_count = book.get_bid_depth(bid_entries.data(), max_levels_);
-    size_t ask_count = book.get_ask_depth(ask_entries.data(), max_levels_);
+// ---------------------------------------------------------------------------
+// Slot maintenance
+// ---------------------------------------------------------------------------
 
-    // Store current depth
-    bid_depth_.resize(bid_count);
-    for (size_t i = 0; i < bid_count; ++i) {
-        bid_depth_[i] = bid_entries[i].quantity;
-    }
+void DepthProfile::settle(SideImage& side, size_t level) noexcept {
+    const double qty = level < side.depth.size() ? static_cast<double>(side.depth[level]) : 0.0;
+    side.accumulated[level] += qty * static_cast<double>(snapshot_count_ - side.settled_at[level]);
+    side.settled_at[level] = snapshot_count_;
+}
 
-    ask_depth_.resize(ask_count);
-    for (size_t i = 0; i < ask_count; ++i) {
-        ask_depth_[i] = ask_entries[i].quantity;
-    }
+void DepthProfile::settle_from(SideImage& side, size_t level) noexcept {
+    for (size_t i = level; i < max_levels_; ++i) settle(side, i);
+}
 
-    // Update running average depth
-    ++snapshot_count_;
-    auto n = static_cast<double>(snapshot_count_);
+void DepthProfile::rescan(SideImage& side, bool bid, const MarketView& book) {
+    const size_t count = bid ? book.get_bid_depth(side.entries.data(), max_levels_)
+                             : book.get_ask_depth(side.entries.data(), max_levels_);
+    ++rescans_;
 
+    // Settle only the slots whose quantity changes
     for (size_t i = 0; i < max_levels_; ++i) {
-        double bid_qty = (i < bid_count) ? static_cast<double>(bid_entries[i].quantity) : 0.0;
-        double ask_qty = (i < ask_count) ? static_cast<double>(ask_entries[i].quantity) : 0.0;
+        const Quantity now = i < count ? side.entries[i].quantity : 0;
+        const Quantity was = i < side.depth.size() ? side.depth[i] : 0;
+        if (now != was) settle(side, i);
+    }
 
-        // Incremental mean: avg = avg + (x - avg) / n
-        avg_bid_depth_[i] += (bid_qty - avg_bid_depth_[i]) / n;
-        avg_ask_depth_[i] += (ask_qty - avg_ask_depth_[i]) / n;
+    side.prices.resize(count);
+    side.depth.resize(count);
+    side.total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        side.prices[i] = side.entries[i].price;
+        side.depth[i] = side.entries[i].quantity;
+        side.total += side.depth[i];
     }
 }
 
-double DepthProfile::depth_imbalance() const {
-    double sum_bid = 0.0;
-    double sum_ask = 0.0;
+void DepthProfile::apply(const LevelUpdateEventData& update, const MarketView& book) {
+    const bool bid = update.side == static_cast<uint8_t>(Side::Buy);
+    SideImage& side = bid ? bid_ : ask_;
+
+    // First slot at or behind the price (slots are best first)
+    const auto at = bid ? std::lower_bound(side.prices.begin(), side.prices.end(), update.price,
+                                           [](Price a, Price p) { return a > p; })
+                        : std::lower_bound(side.prices.begin(), side.prices.end(), update.price);
+    const auto level = static_cast<size_t>(at - side.prices.begin());
+    const bool known = at != side.prices.end() && *at == update.price;
+
+    if (known && update.total_quantity != 0) {
+        settle(side, level);
+        side.total = side.total - side.depth[level] + update.total_quantity;
+        side.depth[level] = update.total_quantity;
+    } else if (known) {
+        // The next level beyond a full window is not in the image
+        if (side.depth.size() == max_levels_) {
+            rescan(side, bid, book);
+            return;
+        }
+        settle_from(side, level);
+        side.total -= side.depth[level];
+        side.prices.erase(at);
+        side.depth.erase(side.depth.begin() + static_cast<std::ptrdiff_t>(level));
+    } else if (update.total_quantity != 0 && level < max_levels_) {
+        settle_from(side, level);
+        if (side.depth.size() == max_levels_) {
+            side.total -= side.depth.back();
+            side.prices.pop_back();
+            side.depth.pop_back();
+        }
+        side.prices.insert(side.prices.begin() + static_cast<std::ptrdiff_t>(level),
+                           update.price);
+        side.depth.insert(side.depth.begin() + static_cast<std::ptrdiff_t>(level),
+                          update.total_quantity);
+        side.total += update.total_quantity;
+    }
+    // Otherwise: a level beyond the window, or a removal of one never seen
+}
 
-    for (auto q : bid_depth_) sum_bid += static_cast<double>(q);
-    for (auto q : ask_depth_) sum_ask += static_cast<double>(q);
+double DepthProfile::average(const SideImage& side, size_t level) const {
+    if (snapshot_count_ == 0 || level >= max_levels_) return 0.0;
+    const double qty = level < side.depth.size() ? static_cast<double>(side.depth[level]) : 0.0;
+    return (side.accumulated[level] +
+            qty * static_cast<double>(snapshot_count_ - side.settled_at[level])) /
+           static_cast<double>(snapshot_count_);
+}
+
+// ---------------------------------------------------------------------------
+// Metrics
+// ---------------------------------------------------------------------------
+
+double DepthProfile::depth_imbalance() const {
+    const auto sum_bid = static_cast<double>(bid_.total);
+    const auto sum_ask = static_cast<double>(ask_.total);
 
     double total = sum_bid + sum_ask;
     if (total <= 0.0) return 0.0;
@@ -61,28 +138,30 @@ nlohmann::json DepthProfile::to_json() const {
     nlohmann::json j;
     j["depth_imbalance"] = depth_imbalance();
     j["max_levels"] = max_levels_;
-    j["bid_levels_filled"] = bid_depth_.size();
-    j["ask_levels_filled"] = ask_depth_.size();
+    j["from_level_updates"] = from_level_updates_;
+    j["bid_levels_filled"] = bid_.depth.size();
+    j["ask_levels_filled"] = ask_.depth.size();
 
     // Current depth
     j["current_bid_depth"] = nlohmann::json::array();
-    for (auto q : bid_depth_) j["current_bid_depth"].push_back(q);
+    for (auto q : bid_.depth) j["current_bid_depth"].push_back(q);
 
     j["current_ask_depth"] = nlohmann::json::array();
-    for (auto q : ask_depth_) j["current_ask_depth"].push_back(q);
+    for (auto q : ask_.depth) j["current_ask_depth"].push_back(q);
 
     // Average depth
     j["avg_bid_depth"] = nlohmann::json::array();
     for (size_t i = 0; i < max_levels_; ++i) {
-        j["avg_bid_depth"].push_back(avg_bid_depth_[i]);
+        j["avg_bid_depth"].push_back(average(bid_, i));
     }
 
     j["avg_ask_depth"] = nlohmann::json::array();
     for (size_t i = 0; i < max_levels_; ++i) {
-        j["avg_ask_depth"].push_back(avg_ask_depth_[i]);
+        j["avg_ask_depth"].push_back(average(ask_, i));
     }
 
     j["snapshot_count"] = snapshot_count_;
+    j["rescans"] = rescans_;
     return j;
 }
 
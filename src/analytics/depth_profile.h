@@ -4,50 +4,97 @@
 /// @brief Order book depth profile analysis.
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
 
 /// Tracks cumulative depth profile and depth imbalance across top N price levels.
 ///
-/// On each event: calls book.get_bid_depth() / book.get_ask_depth() to walk
-/// levels from BBO. Stores cumulative quantity per level and tracks average
-/// depth profile across all snapshots.
+/// Scan mode (the default): on each event, calls book.get_bid_depth() /
+/// book.get_ask_depth() to walk levels from BBO into scratch buffers sized
+/// at construction.
+///
+/// Level-update mode (`from_level_updates`): the profile keeps its own
+/// top-N image (price and quantity per slot), seeded by one scan, and
+/// applies the L2 delta stream (EventType::LevelUpdate, published when the
+/// book journals level deltas). A quantity change updates one slot, and a
+/// level entering the window shifts the slots below it; other events take
+/// no book access at all. The book is walked again only when a level leaves
+/// a full window, since the level that slides in from beyond N is not in
+/// the image. So the cost per event no longer grows with N. The delta
+/// stream lags the book by whatever the event ring holds, and a rescan
+/// reads the book's later state; the image converges once the deltas of
+/// that gap have been applied, since each carries its level's absolute
+/// quantity.
+///
+/// Either way, every event except a LevelUpdate counts as one snapshot. The
+/// average per slot is kept as an accumulated quantity x snapshots, settled
+/// only when the slot changes, so unchanged slots cost nothing per event.
+/// No allocation after construction.
 class DepthProfile {
 public:
-    explicit DepthProfile(size_t max_levels = 10);
+    explicit DepthProfile(size_t max_levels = 10, bool from_level_updates = false);
 
     /// Process an event and snapshot depth profile.
-    void on_event(const EventMessage& event, const OrderBook& book);
+    void on_event(const EventMessage& event, const MarketView& book);
 
     /// Current bid depth (quantity per level, ordered best to worst).
-    [[nodiscard]] const std::vector<Quantity>& bid_depth() const { return bid_depth_; }
+    [[nodiscard]] const std::vector<Quantity>& bid_depth() const { return bid_.depth; }
 
     /// Current ask depth (quantity per level, ordered best to worst).
-    [[nodiscard]] const std::vector<Quantity>& ask_depth() const { return ask_depth_; }
+    [[nodiscard]] const std::vector<Quantity>& ask_depth() const { return ask_.depth; }
 
     /// Depth imbalance = (sum_bid - sum_ask) / (sum_bid + sum_ask) over top N levels.
     /// Range [-1, +1]. Returns 0 if both sides are empty.
     [[nodiscard]] double depth_imbalance() const;
 
+    /// Average quantity of level `level` (0 = best) over all snapshots.
+    [[nodiscard]] double avg_bid_depth(size_t level) const { return average(bid_, level); }
+    [[nodiscard]] double avg_ask_depth(size_t level) const { return average(ask_, level); }
+
+    [[nodiscard]] uint64_t snapshot_count() const { return snapshot_count_; }
+    /// Book walks of one side (scan mode: two per event).
+    [[nodiscard]] uint64_t rescans() const { return rescans_; }
+
     /// Serialize metrics to JSON.
     [[nodiscard]] nlohmann::json to_json() const;
 
 private:
+    /// One side's top-N image. Vectors hold max_levels_ and never regrow.
+    struct SideImage {
+        std::vector<DepthEntry> entries;  // Scratch for get_*_depth()
+        std::vector<Price> prices;        // Per filled slot, best first
+        std::vector<Quantity> depth;
+        std::vector<double> accumulated;  // Quantity x snapshots, per slot
+        std::vector<uint64_t> settled_at; // snapshot_count_ when last settled
+        Quantity total = 0;               // Sum of depth
+    };
+
+    /// Fold slot `level`'s current quantity into its accumulated sum, up to
+    /// the current snapshot. Called before every change of the slot.
+    void settle(SideImage& side, size_t level) noexcept;
+    void settle_from(SideImage& side, size_t level) noexcept;
+
+    void rescan(SideImage& side, bool bid, const MarketView& book);
+    void apply(const LevelUpdateEventData& update, const MarketView& book);
+
+    [[nodiscard]] double average(const SideImage& side, size_t level) const;
+
     size_t max_levels_;
-    std::vector<Quantity> bid_depth_;
-    std::vector<Quantity> ask_depth_;
+    bool from_level_updates_;
+    bool seeded_ = false;
+    SideImage bid_;
+    SideImage ask_;
 
-    // Average depth tracking
-    std::vector<double> avg_bid_depth_;
-    std::vector<double> avg_ask_depth_;
     uint64_t snapshot_count_ = 0;
+    uint64_t rescans_ = 0;
 };
 
 }  // namespace hft
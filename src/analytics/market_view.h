@@ -0,0 +1,126 @@
+#pragma once
+
+/// @file market_view.h
+/// @brief The top of book as the analytics modules read it: either the
+///        live OrderBook or the last published QuoteSnapshot.
+///
+/// Cold-path component, header-only. Every analytics module reads the
+/// book only through a MarketView: best bid and ask (price and quantity),
+/// spread, mid and top-N depth. A view over an OrderBook forwards to it,
+/// so it is only usable on the book's (matching) thread. A view over a
+/// QuoteSnapshotSlot holds a private copy of the last snapshot the gateway
+/// published, refreshed by refresh() (a version check, and a copy only
+/// when the state changed). It never touches the book, so the analytics
+/// can run on their own thread (see analytics_thread.h).
+///
+/// A snapshot is the state as of the latest publish, not as of the event
+/// being processed, and it holds QUOTE_SNAPSHOT_DEPTH levels per side.
+/// Trade-driven metrics do not depend on it, since Trade carries the
+/// aggressor side. A DepthProfile keeps its image in step with the event
+/// stream when it is fed level deltas.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types.h"
+#include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
+
+namespace hft {
+
+class MarketView {
+public:
+    /// Live view over `book` (must outlive the view). Implicit, so code
+    /// holding a book passes it wherever a view is expected.
+    MarketView(const OrderBook& book) noexcept : book_(&book) {}
+
+    /// Snapshot view over `slot` (must outlive the view). Empty until the
+    /// first refresh() that finds a publish.
+    explicit MarketView(const QuoteSnapshotSlot& slot) noexcept : slot_(&slot) {}
+
+    /// Snapshot views: pick up the latest publish. Returns true if the
+    /// state changed. Live views: no-op.
+    bool refresh() noexcept {
+        if (slot_ == nullptr) return false;
+        const uint64_t version = slot_->version();
+        if (version == version_ || !slot_->read(quote_)) return false;
+        version_ = version;
+        return true;
+    }
+
+    /// Whether the view reads the live book (and so belongs on its thread).
+    [[nodiscard]] bool live() const noexcept { return book_ != nullptr; }
+
+    /// Deepest level per side get_*_depth() can return.
+    [[nodiscard]] size_t max_depth() const noexcept {
+        return live() ? SIZE_MAX : QUOTE_SNAPSHOT_DEPTH;
+    }
+
+    [[nodiscard]] bool has_bid() const noexcept {
+        return live() ? book_->best_bid() != nullptr : quote_.has_bid();
+    }
+    [[nodiscard]] bool has_ask() const noexcept {
+        return live() ? book_->best_ask() != nullptr : quote_.has_ask();
+    }
+
+    /// Best prices and their level quantities (0 if the side is empty).
+    [[nodiscard]] Price best_bid_price() const noexcept {
+        if (!live()) return quote_.has_bid() ? quote_.bids[0].price : 0;
+        const PriceLevel* level = book_->best_bid();
+        return level ? level->price : 0;
+    }
+    [[nodiscard]] Price best_ask_price() const noexcept {
+        if (!live()) return quote_.has_ask() ? quote_.asks[0].price : 0;
+        const PriceLevel* level = book_->best_ask();
+        return level ? level->price : 0;
+    }
+    [[nodiscard]] Quantity best_bid_quantity() const noexcept {
+        if (!live()) return quote_.has_bid() ? quote_.bids[0].quantity : 0;
+        const PriceLevel* level = book_->best_bid();
+        return level ? level->total_quantity : 0;
+    }
+    [[nodiscard]] Quantity best_ask_quantity() const noexcept {
+        if (!live()) return quote_.has_ask() ? quote_.asks[0].quantity : 0;
+        const PriceLevel* level = book_->best_ask();
+        return level ? level->total_quantity : 0;
+    }
+
+    /// Spread, or -1 if either side is empty (as OrderBook::spread).
+    [[nodiscard]] Price spread() const noexcept {
+        if (live()) return book_->spread();
+        return (quote_.has_bid() && quote_.has_ask()) ? quote_.asks[0].price - quote_.bids[0].price
+                                                      : -1;
+    }
+
+    /// Mid price, or 0 if either side is empty (as OrderBook::mid_price).
+    [[nodiscard]] Price mid_price() const noexcept {
+        return live() ? book_->mid_price() : quote_.mid_price();
+    }
+
+    /// Copy up to `max` levels per side, best first (as
+    /// OrderBook::get_bid_depth). Returns the number written.
+    size_t get_bid_depth(DepthEntry* out, size_t max) const noexcept {
+        if (live()) return book_->get_bid_depth(out, max);
+        return copy_levels(quote_.bids, quote_.bid_levels, out, max);
+    }
+    size_t get_ask_depth(DepthEntry* out, size_t max) const noexcept {
+        if (live()) return book_->get_ask_depth(out, max);
+        return copy_levels(quote_.asks, quote_.ask_levels, out, max);
+    }
+
+private:
+    static size_t copy_levels(const DepthEntry* levels, uint32_t count, DepthEntry* out,
+                              size_t max) noexcept {
+        const size_t n = std::min<size_t>(count, max);
+        std::copy(levels, levels + n, out);
+        return n;
+    }
+
+    const OrderBook* book_ = nullptr;
+    const QuoteSnapshotSlot* slot_ = nullptr;
+    uint64_t version_ = 0;   // Of the copy in quote_ (0 = none)
+    QuoteSnapshot quote_{};
+};
+
+}  // namespace hft
@@ -5,19 +5,16 @@
 namespace hft {
 
 void MicropriceCalculator::on_event(const EventMessage& /*event*/,
-                                     const OrderBook& book) {
-    const PriceLevel* bid = book.best_bid();
-    const PriceLevel* ask = book.best_ask();
-
-    if (!bid || !ask) {
+                                     const MarketView& book) {
+    if (!book.has_bid() || !book.has_ask()) {
         valid_ = false;
         return;
     }
 
-    auto bid_qty = static_cast<double>(bid->total_quantity);
-    auto ask_qty = static_cast<double>(ask->total_quantity);
-    auto bid_px = static_cast<double>(bid->price);
-    auto ask_px = static_cast<double>(ask->price);
+    auto bid_qty = static_cast<double>(book.best_bid_quantity());
+    auto ask_qty = static_cast<double>(book.best_ask_quantity());
+    auto bid_px = static_cast<double>(book.best_bid_price());
+    auto ask_px = static_cast<double>(book.best_ask_price());
 
     double total_qty = bid_qty + ask_qty;
     if (total_qty <= 0.0) {
@@ -5,8 +5,8 @@
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
@@ -18,7 +18,7 @@ namespace hft {
 class MicropriceCalculator {
 public:
     /// Process an event and recalculate microprice.
-    void on_event(const EventMessage& event, const OrderBook& book);
+    void on_event(const EventMessage& event, const MarketView& book);
 
     /// Current microprice as a double (raw Price would lose fractional precision).
     [[nodiscard]] double current_microprice() const { return microprice_; }
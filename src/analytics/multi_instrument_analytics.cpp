@@ -2,49 +2,122 @@
 
 #include <fstream>
 #include <iostream>
+#include <string>
 
 #include <nlohmann/json.hpp>
 
+#include "transport/wait_strategy.h"
+
 namespace hft {
 
 MultiInstrumentAnalytics::MultiInstrumentAnalytics(
-    const InstrumentRouter& router, const AnalyticsConfig& config) {
-    for (size_t i = 0; i < router.instrument_count(); ++i) {
-        // Iterate via pipeline accessor — try sequential IDs
-        // We need to find all valid instrument IDs. Since the router uses
-        // a flat array, iterate possible IDs up to a reasonable bound.
+    const InstrumentRouter& router, const AnalyticsConfig& config, size_t workers,
+    const ThreadingConfig& threading)
+    : threading_(threading) {
+    const size_t count = router.instrument_count();
+    ids_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const InstrumentPipeline& p = router.pipeline_at(i);
+        const InstrumentId id = p.instrument_id;
+        if (id >= engines_.size()) {
+            engines_.resize(static_cast<size_t>(id) + 1);
+            worker_of_.resize(static_cast<size_t>(id) + 1, 0);
+        }
+        AnalyticsConfig engine_config = config;
+        if (!config.time_series_columns_path.empty()) {
+            engine_config.time_series_columns_path += "." + std::to_string(id);
+        }
+        if (p.quote && config.use_quote_snapshots) {
+            engines_[id] = std::make_unique<AnalyticsEngine>(*p.quote, engine_config);
+        } else {
+            engines_[id] = std::make_unique<AnalyticsEngine>(*p.book, engine_config);
+        }
+        worker_of_[id] = workers ? static_cast<uint32_t>(ids_.size() % workers) : 0;
+        ids_.push_back(id);
     }
 
-    // Alternative: use a brute-force scan of reasonable IDs.
-    // The router stores pipelines in a vector; we check IDs 0..max.
-    for (InstrumentId id = 0; engines_.size() < router.instrument_count(); ++id) {
-        const OrderBook* book = router.order_book(id);
-        if (book) {
-            engines_[id] = std::make_unique<AnalyticsEngine>(*book, config);
-        }
-        if (id == UINT32_MAX) break;  // prevent infinite loop
+    workers_.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) workers_.push_back(std::make_unique<Worker>());
+    for (size_t w = 0; w < workers; ++w) {
+        workers_[w]->thread = std::thread([this, w] { run_worker(w); });
     }
+    parallel_ = workers != 0;
 }
 
+MultiInstrumentAnalytics::~MultiInstrumentAnalytics() { finish(); }
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
 void MultiInstrumentAnalytics::on_event(const EventMessage& event) {
-    auto it = engines_.find(event.instrument_id);
-    if (it != engines_.end()) {
-        it->second->on_event(event);
+    AnalyticsEngine* target = engine(event.instrument_id);
+    if (!target) return;
+    if (!parallel_) {
+        target->on_event(event);
+        return;
     }
+    Lane& lane = workers_[worker_of_[event.instrument_id]]->lane;
+    while (!lane.try_push(event)) std::this_thread::yield();
 }
 
-const AnalyticsEngine* MultiInstrumentAnalytics::analytics(
-    InstrumentId id) const {
-    auto it = engines_.find(id);
-    return (it != engines_.end()) ? it->second.get() : nullptr;
+void MultiInstrumentAnalytics::run_worker(size_t index) {
+    ScopedThreadPlacement placement(threading_, ThreadRole::Analytics, index);
+    Worker& worker = *workers_[index];
+    Waiter waiter;
+    EventMessage batch[64];
+    for (;;) {
+        const size_t n = worker.lane.try_pop_n(batch, 64);
+        if (n == 0) {
+            // The producer has stopped pushing once stopping_ is set
+            if (stopping_.load(std::memory_order_acquire) && worker.lane.empty()) return;
+            waiter.idle([&] {
+                return !worker.lane.empty() || stopping_.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+        waiter.reset();
+        for (size_t i = 0; i < n; ++i) engine(batch[i].instrument_id)->on_event(batch[i]);
+        worker.events.fetch_add(n, std::memory_order_relaxed);
+    }
 }
 
-void MultiInstrumentAnalytics::write_json(const std::string& path) const {
-    nlohmann::json report;
+void MultiInstrumentAnalytics::finish() {
+    if (!parallel_) return;
+    stopping_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) worker->thread.join();
+    parallel_ = false;  // Workers stay listed for their counters
+}
 
-    for (const auto& [id, engine] : engines_) {
-        report["instruments"][std::to_string(id)] = engine->to_json();
+void MultiInstrumentAnalytics::set_bar_sink(const BarSink& sink) {
+    for (InstrumentId id : ids_) engines_[id]->set_bar_sink(sink);
+}
+
+void MultiInstrumentAnalytics::flush_bars() {
+    finish();
+    for (InstrumentId id : ids_) engines_[id]->flush_bars();
+}
+
+const AnalyticsEngine* MultiInstrumentAnalytics::analytics(InstrumentId id) const {
+    return engine(id);
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+nlohmann::json MultiInstrumentAnalytics::to_json() {
+    finish();
+    nlohmann::json report;
+    report["instruments"] = nlohmann::json::object();
+    for (InstrumentId id : ids_) {
+        report["instruments"][std::to_string(id)] = engines_[id]->to_json();
     }
+    return report;
+}
+
+void MultiInstrumentAnalytics::write_json(const std::string& path) {
+    const nlohmann::json report = to_json();
 
     std::ofstream out(path);
     if (out.is_open()) {
@@ -54,10 +127,11 @@ void MultiInstrumentAnalytics::write_json(const std::string& path) const {
     }
 }
 
-void MultiInstrumentAnalytics::print_summary() const {
-    for (const auto& [id, engine] : engines_) {
+void MultiInstrumentAnalytics::print_summary() {
+    finish();
+    for (InstrumentId id : ids_) {
         std::cout << "\n--- Instrument " << id << " ---";
-        engine->print_summary();
+        engines_[id]->print_summary();
     }
 }
 
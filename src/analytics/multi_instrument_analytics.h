@@ -3,42 +3,121 @@
 /// @file multi_instrument_analytics.h
 /// @brief Per-instrument analytics orchestrator.
 ///
-/// Manages one AnalyticsEngine per instrument, routing events by instrument_id.
+/// Manages one AnalyticsEngine per instrument, routing events by instrument_id
+/// through a flat id-indexed array (ids are dense, as in the router's own
+/// table). With AnalyticsConfig::use_quote_snapshots the engines read the
+/// instruments' published quotes rather than their books, and on_event()
+/// can run on an AnalyticsThread reading the router's event ring.
+///
+/// With `workers` > 0, the engines are split across that many worker
+/// threads, each owning a disjoint set (instruments are dealt round-robin
+/// in registration order) and fed through its own SPSC lane. on_event()
+/// then only copies the event into the owning worker's lane, waiting if
+/// that lane is full, so one instrument's events are still processed in
+/// order and nothing is dropped. Engines on live books read them from the
+/// workers, which is safe only while the books do not change (analytics
+/// over a finished run) unless they read quote snapshots. Call finish()
+/// to drain the lanes and join the workers before reading results; the
+/// output methods and the destructor do so.
+///
+/// on_event() has a single caller thread at a time.
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
 
 #include "analytics/analytics_config.h"
 #include "analytics/analytics_engine.h"
 #include "core/types.h"
 #include "gateway/instrument_router.h"
 #include "transport/message.h"
+#include "transport/spsc_ring_buffer.h"
+#include "utils/thread_placement.h"
 
 namespace hft {
 
 /// Manages per-instrument AnalyticsEngine instances.
 class MultiInstrumentAnalytics {
 public:
-    /// @param router Reference to the instrument router (must outlive this).
-    /// @param config Shared analytics configuration for all instruments.
+    /// @param router    Reference to the instrument router (must outlive this).
+    /// @param config    Shared analytics configuration for all instruments.
+    /// @param workers   Worker threads (0 = process on the caller of on_event()).
+    /// @param threading CPUs of the workers (ThreadRole::Analytics, by index).
     explicit MultiInstrumentAnalytics(const InstrumentRouter& router,
-                                       const AnalyticsConfig& config = {});
+                                       const AnalyticsConfig& config = {},
+                                       size_t workers = 0,
+                                       const ThreadingConfig& threading = {});
+    ~MultiInstrumentAnalytics();
+
+    MultiInstrumentAnalytics(const MultiInstrumentAnalytics&) = delete;
+    MultiInstrumentAnalytics& operator=(const MultiInstrumentAnalytics&) = delete;
 
     /// Route an event to the correct per-instrument analytics engine.
     void on_event(const EventMessage& event);
 
+    /// Process every event handed to on_event() so far and stop the
+    /// workers (no-op without workers or when already finished). Later
+    /// events are processed on the calling thread.
+    void finish();
+
+    /// AnalyticsEngine::set_bar_sink on every engine; call before the first
+    /// on_event(). With workers the sink is called on their threads,
+    /// concurrently, so it must be thread-safe.
+    void set_bar_sink(const BarSink& sink);
+
+    /// Emit every engine's open bars (finishes first).
+    void flush_bars();
+
     /// Access per-instrument analytics. Returns nullptr if unknown id.
+    /// With workers, valid once finish() has returned.
     [[nodiscard]] const AnalyticsEngine* analytics(InstrumentId id) const;
 
-    /// Write aggregate JSON for all instruments.
-    void write_json(const std::string& path) const;
+    [[nodiscard]] size_t instrument_count() const { return ids_.size(); }
+    [[nodiscard]] size_t worker_count() const { return workers_.size(); }
 
-    /// Print per-instrument summary to stdout.
-    void print_summary() const;
+    /// Events processed by worker `index` (approximate while running).
+    [[nodiscard]] uint64_t worker_events(size_t index) const {
+        return workers_[index]->events.load(std::memory_order_relaxed);
+    }
+
+    /// Every instrument's AnalyticsEngine::to_json(), keyed by id (finishes first).
+    [[nodiscard]] nlohmann::json to_json();
+
+    /// Write aggregate JSON for all instruments (finishes first).
+    void write_json(const std::string& path);
+
+    /// Print per-instrument summary to stdout (finishes first).
+    void print_summary();
 
 private:
-    std::unordered_map<InstrumentId, std::unique_ptr<AnalyticsEngine>> engines_;
+    /// Events per lane (256 KB).
+    using Lane = SPSCRingBuffer<EventMessage, 4096>;
+
+    struct Worker {
+        Lane lane;
+        std::thread thread;
+        std::atomic<uint64_t> events{0};
+    };
+
+    [[nodiscard]] AnalyticsEngine* engine(InstrumentId id) const noexcept {
+        return id < engines_.size() ? engines_[id].get() : nullptr;
+    }
+
+    void run_worker(size_t index);
+
+    std::vector<std::unique_ptr<AnalyticsEngine>> engines_;  // By id (nullptr = none)
+    std::vector<uint32_t> worker_of_;                         // By id
+    std::vector<InstrumentId> ids_;                           // Registration order
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool parallel_ = false;                                   // Workers running
+    std::atomic<bool> stopping_{false};
+    ThreadingConfig threading_;
 };
 
 }  // namespace hft
@@ -5,10 +5,10 @@
 namespace hft {
 
 OrderFlowImbalance::OrderFlowImbalance(size_t window_size)
-    : window_size_(window_size) {}
+    : window_size_(window_size), samples_(window_size) {}
 
 void OrderFlowImbalance::on_event(const EventMessage& event,
-                                   const OrderBook& /*book*/,
+                                   const MarketView& /*book*/,
                                    Side aggressor_side) {
     if (event.type != EventType::Trade) return;
 
@@ -16,7 +16,7 @@ void OrderFlowImbalance::on_event(const EventMessage& event,
     auto qty_d = static_cast<double>(qty);
 
     // Evict oldest if window full
-    if (samples_.size() >= window_size_) {
+    if (!samples_.empty() && samples_.size() >= window_size_) {
         const auto& oldest = samples_.front();
         if (oldest.side == Side::Buy) {
             buy_vol_ -= static_cast<double>(oldest.quantity);
@@ -4,28 +4,29 @@
 /// @brief Rolling order flow imbalance tracker.
 
 #include <cstddef>
-#include <deque>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
+#include "analytics/rolling_window.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
 
 /// Tracks rolling buy/sell volume imbalance over a configurable window.
 ///
-/// On Trade: adds {side, quantity} to rolling deque, maintains running sums.
-/// Evicts oldest entry when window is full.
+/// On Trade: adds {side, quantity} to a preallocated rolling window,
+/// maintains running sums. Evicts oldest entry when window is full.
 /// Imbalance = (buy_vol - sell_vol) / (buy_vol + sell_vol), range [-1, +1].
 class OrderFlowImbalance {
 public:
     explicit OrderFlowImbalance(size_t window_size = 100);
 
     /// Process an event. Only trades affect imbalance.
-    /// @param aggressor_side  The inferred aggressor side (from Lee-Ready tick test).
-    void on_event(const EventMessage& event, const OrderBook& book,
+    /// @param aggressor_side  The trade's aggressor side (Trade::aggressor_side,
+    ///                        or inferred when the trade carries none).
+    void on_event(const EventMessage& event, const MarketView& book,
                   Side aggressor_side);
 
     /// Current imbalance in [-1, +1]. 0 if no samples.
@@ -44,7 +45,7 @@ private:
     };
 
     size_t window_size_;
-    std::deque<FlowSample> samples_;
+    RollingWindow<FlowSample> samples_;
     double buy_vol_ = 0.0;
     double sell_vol_ = 0.0;
 };
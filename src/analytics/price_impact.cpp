@@ -7,9 +7,9 @@
 namespace hft {
 
 PriceImpact::PriceImpact(size_t regression_window)
-    : regression_window_(regression_window) {}
+    : regression_window_(regression_window), samples_(regression_window) {}
 
-void PriceImpact::on_event(const EventMessage& event, const OrderBook& book,
+void PriceImpact::on_event(const EventMessage& event, const MarketView& book,
                             Side aggressor_side) {
     // Cache pre-trade mid on every event
     Price current_mid = book.mid_price();
@@ -35,7 +35,7 @@ void PriceImpact::on_event(const EventMessage& event, const OrderBook& book,
     double signed_flow = (aggressor_side == Side::Buy) ? qty : -qty;
 
     // Evict oldest if window full
-    if (samples_.size() >= regression_window_) {
+    if (!samples_.empty() && samples_.size() >= regression_window_) {
         const auto& oldest = samples_.front();
         sum_x_ -= oldest.signed_flow;
         sum_y_ -= oldest.delta_mid_bps;
@@ -4,12 +4,12 @@
 /// @brief Price impact analysis: Kyle's Lambda, temporary and permanent impact.
 
 #include <cstddef>
-#include <deque>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
+#include "analytics/rolling_window.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
@@ -28,8 +28,8 @@ class PriceImpact {
 public:
     explicit PriceImpact(size_t regression_window = 200);
 
-    /// Process an event with the inferred aggressor side.
-    void on_event(const EventMessage& event, const OrderBook& book,
+    /// Process an event with the trade's aggressor side (carried or inferred).
+    void on_event(const EventMessage& event, const MarketView& book,
                   Side aggressor_side);
 
     /// Kyle's Lambda (price impact coefficient). NaN if < 10 observations.
@@ -51,7 +51,7 @@ private:
     };
 
     size_t regression_window_;
-    std::deque<ImpactSample> samples_;
+    RollingWindow<ImpactSample> samples_;
 
     // Running sums for OLS
     double sum_x_ = 0.0;   // sum of signed_flow
@@ -65,7 +65,7 @@ private:
 
     // For permanent impact: track mid prices to compare with N-trade-ago mid
     static constexpr size_t PERMANENT_LAG = 5;
-    std::deque<Price> mid_history_;
+    RollingWindow<Price> mid_history_{PERMANENT_LAG + 1};
     double permanent_impact_sum_ = 0.0;
     uint64_t permanent_impact_count_ = 0;
 };
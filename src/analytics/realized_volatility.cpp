@@ -7,10 +7,13 @@
 namespace hft {
 
 RealizedVolatility::RealizedVolatility(size_t tick_window, uint64_t time_bar_ns)
-    : tick_window_(tick_window), time_bar_ns_(time_bar_ns) {}
+    : tick_window_(tick_window),
+      time_bar_ns_(time_bar_ns),
+      tick_returns_(tick_window),
+      bar_returns_(tick_window) {}
 
 void RealizedVolatility::on_event(const EventMessage& event,
-                                   const OrderBook& book) {
+                                   const MarketView& book) {
     // --- Time-bar volatility: check bar boundaries on every event ---
     if (event.type == EventType::Trade || event.type == EventType::OrderAccepted) {
         // Use trade timestamp for timing
@@ -36,7 +39,7 @@ void RealizedVolatility::on_event(const EventMessage& event,
                 double log_ret = std::log(new_mid / bar_start_mid_);
 
                 // Evict oldest if window full
-                if (bar_returns_.size() >= tick_window_) {
+                if (!bar_returns_.empty() && bar_returns_.size() >= tick_window_) {
                     double oldest = bar_returns_.front();
                     bar_return_sq_sum_ -= oldest * oldest;
                     bar_returns_.pop_front();
@@ -61,7 +64,7 @@ void RealizedVolatility::on_event(const EventMessage& event,
         double log_ret = std::log(trade_price / prev_trade_price_);
 
         // Evict oldest if window full
-        if (tick_returns_.size() >= tick_window_) {
+        if (!tick_returns_.empty() && tick_returns_.size() >= tick_window_) {
             double oldest = tick_returns_.front();
             tick_return_sq_sum_ -= oldest * oldest;
             tick_returns_.pop_front();
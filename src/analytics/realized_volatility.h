@@ -5,12 +5,12 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
+#include "analytics/rolling_window.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
@@ -19,7 +19,7 @@ namespace hft {
 /// time-bar mid price samples.
 ///
 /// Tick-level: On each Trade, compute log(price / prev_trade_price), store in
-///   deque. Vol = sqrt(sum(r^2)) over the window.
+///   a preallocated rolling window. Vol = sqrt(sum(r^2)) over the window.
 ///
 /// Time-bar: When timestamp crosses bar boundary, sample mid price, compute
 ///   log return. Vol = sqrt(sum(r^2)) over the window.
@@ -31,7 +31,7 @@ public:
                                 uint64_t time_bar_ns = 1'000'000'000);
 
     /// Process an event and update volatility estimates.
-    void on_event(const EventMessage& event, const OrderBook& book);
+    void on_event(const EventMessage& event, const MarketView& book);
 
     /// Tick-level realized volatility (sqrt of sum of squared log returns).
     [[nodiscard]] double tick_volatility() const;
@@ -48,14 +48,14 @@ private:
 
     // Tick-level state
     double prev_trade_price_ = 0.0;
-    std::deque<double> tick_returns_;
+    RollingWindow<double> tick_returns_;
     double tick_return_sq_sum_ = 0.0;
 
     // Time-bar state
     uint64_t current_bar_start_ = 0;
     double bar_start_mid_ = 0.0;
     bool bar_initialized_ = false;
-    std::deque<double> bar_returns_;
+    RollingWindow<double> bar_returns_;
     double bar_return_sq_sum_ = 0.0;
 };
 
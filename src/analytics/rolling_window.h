@@ -0,0 +1,69 @@
+#pragma once
+
+/// @file rolling_window.h
+/// @brief Fixed-capacity FIFO ring for the analytics rolling windows.
+///
+/// Cold-path component, header-only. Replaces std::deque in the sliding
+/// windows of the analytics modules: slots are allocated once, up front, at
+/// the next power of two of the window size, and push_back / pop_front only
+/// move a masked head index, so a window that slides on every trade never
+/// touches the heap. The ring does not evict on its own: callers pop the
+/// oldest sample (to update their running sums) before pushing past the
+/// window, exactly as they did with a deque.
+
+#include <cstddef>
+#include <memory>
+
+namespace hft {
+
+template <typename T>
+class RollingWindow {
+public:
+    /// @param window Most samples the caller keeps (rounded up to a power of
+    ///               two for the ring; at least one slot).
+    explicit RollingWindow(size_t window)
+        : mask_(ring_size(window) - 1), slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    /// Append a sample. The caller pops first if the ring is full.
+    void push_back(const T& value) noexcept {
+        slots_[(head_ + size_) & mask_] = value;
+        ++size_;
+    }
+
+    /// Drop the oldest sample. The window must not be empty.
+    void pop_front() noexcept {
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    [[nodiscard]] const T& front() const noexcept { return slots_[head_]; }
+    [[nodiscard]] const T& back() const noexcept { return slots_[(head_ + size_ - 1) & mask_]; }
+    /// The i-th oldest sample.
+    [[nodiscard]] const T& operator[](size_t i) const noexcept {
+        return slots_[(head_ + i) & mask_];
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] bool full() const noexcept { return size_ == mask_ + 1; }
+    [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+    void clear() noexcept {
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    static size_t ring_size(size_t window) noexcept {
+        size_t n = 1;
+        while (n < window) n <<= 1;
+        return n;
+    }
+
+    size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace hft
@@ -0,0 +1,116 @@
+#pragma once
+
+/// @file sample_gate.h
+/// @brief Per-module event filter: decides which events an analytics
+///        module processes.
+///
+/// Cold-path component, header-only. AnalyticsEngine runs every module on
+/// every event by default. Several modules (depth profile averages, the
+/// price impact regression, quoted spread stats) only need samples of
+/// the book, so each has a SampleConfig in AnalyticsConfig and a gate
+/// in front of it. The triggers are:
+///   EveryEvent  every event (the default, as before)
+///   Trades      trades only
+///   EveryNth    every `every`-th event
+///   Interval    the first event in each `every`-ns bucket of feed time
+///               (event timestamps; events without one use the last seen)
+///   BboChange   events after which the best bid or ask (price or
+///               quantity) differs from the last admitted event
+/// With `include_trades` (the default) trades pass regardless of the
+/// trigger, so trade-driven statistics (effective spread, impact
+/// samples, tick volatility) stay exact and only book sampling is
+/// decimated. Between admitted events a module's values are as of its
+/// last admitted event.
+
+#include <cstdint>
+
+#include "analytics/analytics_config.h"
+#include "analytics/market_view.h"
+#include "core/types.h"
+#include "transport/message.h"
+
+namespace hft {
+
+class SampleGate {
+public:
+    explicit SampleGate(const SampleConfig& config = {}) noexcept : config_(config) {
+        if (config_.every == 0) config_.every = 1;
+    }
+
+    /// Whether the module should process `event` (`book` as after it).
+    bool admit(const EventMessage& event, const MarketView& book) noexcept {
+        const bool pass = decide(event, book);
+        ++(pass ? admitted_ : skipped_);
+        return pass;
+    }
+
+    [[nodiscard]] const SampleConfig& config() const noexcept { return config_; }
+    [[nodiscard]] uint64_t admitted() const noexcept { return admitted_; }
+    [[nodiscard]] uint64_t skipped() const noexcept { return skipped_; }
+
+private:
+    bool decide(const EventMessage& event, const MarketView& book) noexcept {
+        const bool trade = event.type == EventType::Trade;
+        switch (config_.trigger) {
+            case SampleTrigger::EveryEvent:
+                return true;
+            case SampleTrigger::Trades:
+                return trade;
+            case SampleTrigger::EveryNth:
+                if (++count_ >= config_.every) {
+                    count_ = 0;
+                    return true;
+                }
+                return trade && config_.include_trades;
+            case SampleTrigger::Interval: {
+                if (trade) {
+                    last_ts_ = event.data.trade.timestamp;
+                } else if (event.type != EventType::MassCancel &&
+                           event.type != EventType::LevelUpdate &&
+                           event.type != EventType::BookDigest) {
+                    last_ts_ = event.data.order_event.timestamp;
+                }
+                if (last_ts_ >= next_due_) {
+                    next_due_ = (last_ts_ / config_.every + 1) * config_.every;
+                    return true;
+                }
+                return trade && config_.include_trades;
+            }
+            case SampleTrigger::BboChange: {
+                const Price bid = book.best_bid_price();
+                const Price ask = book.best_ask_price();
+                const Quantity bid_qty = book.best_bid_quantity();
+                const Quantity ask_qty = book.best_ask_quantity();
+                if (!seen_ || bid != bid_ || ask != ask_ || bid_qty != bid_qty_ ||
+                    ask_qty != ask_qty_) {
+                    seen_ = true;
+                    bid_ = bid;
+                    ask_ = ask;
+                    bid_qty_ = bid_qty;
+                    ask_qty_ = ask_qty;
+                    return true;
+                }
+                return trade && config_.include_trades;
+            }
+        }
+        return true;
+    }
+
+    SampleConfig config_;
+    uint64_t admitted_ = 0;
+    uint64_t skipped_ = 0;
+
+    // EveryNth
+    uint64_t count_ = 0;
+    // Interval
+    Timestamp last_ts_ = 0;
+    Timestamp next_due_ = 0;
+    // BboChange
+    bool seen_ = false;
+    Price bid_ = 0;
+    Price ask_ = 0;
+    Quantity bid_qty_ = 0;
+    Quantity ask_qty_ = 0;
+};
+
+}  // namespace hft
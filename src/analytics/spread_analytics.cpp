@@ -7,7 +7,7 @@
 
 namespace hft {
 
-void SpreadAnalytics::on_event(const EventMessage& event, const OrderBook& book) {
+void SpreadAnalytics::on_event(const EventMessage& event, const MarketView& book) {
     // Cache previous mid before updating
     prev_mid_ = current_mid_;
 
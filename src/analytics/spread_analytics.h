@@ -7,8 +7,8 @@
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "analytics/market_view.h"
 #include "core/types.h"
-#include "orderbook/order_book.h"
 #include "transport/message.h"
 
 namespace hft {
@@ -20,7 +20,7 @@ namespace hft {
 class SpreadAnalytics {
 public:
     /// Process an event and update spread metrics.
-    void on_event(const EventMessage& event, const OrderBook& book);
+    void on_event(const EventMessage& event, const MarketView& book);
 
     /// Current bid-ask spread (fixed-point). Returns -1 if either side empty.
     [[nodiscard]] Price current_spread() const { return current_spread_; }
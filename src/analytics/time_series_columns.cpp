@@ -0,0 +1,306 @@
+#include "analytics/time_series_columns.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFT_TS_MMAP 1
+#endif
+
+namespace hft {
+
+namespace {
+
+template <typename T>
+void put(char* column, size_t index, T value) {
+    std::memcpy(column + index * sizeof(T), &value, sizeof(T));
+}
+
+template <typename T>
+T get(const void* column, size_t index) {
+    T value;
+    std::memcpy(&value, static_cast<const char*>(column) + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TimeSeriesColumnWriter
+// ---------------------------------------------------------------------------
+
+TimeSeriesColumnWriter::TimeSeriesColumnWriter(const TimeSeriesWriterConfig& config)
+    : config_(config) {
+    config_.block_rows = std::max<size_t>(config_.block_rows, 1);
+    config_.buffers = std::max<size_t>(config_.buffers, 2);
+    block_bytes_ = time_series_block_bytes(config_.block_rows);
+    for (size_t c = 0; c < TIME_SERIES_COLUMN_COUNT; ++c) {
+        offsets_[c] = time_series_column_offset(config_.block_rows, static_cast<TimeSeriesColumn>(c));
+    }
+}
+
+TimeSeriesColumnWriter::~TimeSeriesColumnWriter() {
+    close();
+}
+
+bool TimeSeriesColumnWriter::open() {
+    if (running_) return true;
+    error_.clear();
+
+    out_.open(config_.path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        error_ = "cannot create " + config_.path;
+        return false;
+    }
+    // Placeholder header; close() writes the final counts
+    TimeSeriesFileHeader header{};
+    std::memcpy(header.magic, TIME_SERIES_MAGIC, sizeof(header.magic));
+    header.version = TIME_SERIES_VERSION;
+    header.column_count = TIME_SERIES_COLUMN_COUNT;
+    header.block_rows = config_.block_rows;
+    header.block_bytes = block_bytes_;
+    header.price_scale = PRICE_SCALE;
+    header.blocks_offset = sizeof(TimeSeriesFileHeader);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (blocks_.empty()) {
+        blocks_.resize(config_.buffers);
+        for (Block& block : blocks_) {
+            block.data = std::make_unique<char[]>(block_bytes_);  // Zeroed: faults the pages in
+        }
+    }
+    free_.clear();
+    pending_.clear();
+    for (Block& block : blocks_) free_.push_back(&block);
+    current_ = free_.back();
+    free_.pop_back();
+    current_->rows = 0;
+
+    rows_ = 0;
+    stalls_ = 0;
+    blocks_written_ = 0;
+    write_failed_ = !out_.good();
+    stopping_ = false;
+    running_ = true;
+    writer_ = std::thread([this] { writer_loop(); });
+    return true;
+}
+
+void TimeSeriesColumnWriter::append(const TimeSeriesRow& row) {
+    if (!running_) return;
+    Block& block = *current_;
+    char* data = block.data.get();
+    const size_t i = block.rows;
+
+    auto* header = reinterpret_cast<TimeSeriesBlockHeader*>(data);
+    if (i == 0) {
+        header->first_sequence = row.sequence_num;
+        header->first_timestamp = row.timestamp;
+    }
+    header->last_sequence = row.sequence_num;
+    header->last_timestamp = row.timestamp;
+
+    const auto column = [&](TimeSeriesColumn c) { return data + offsets_[static_cast<size_t>(c)]; };
+    put<uint64_t>(column(TimeSeriesColumn::SequenceNum), i, row.sequence_num);
+    put<uint64_t>(column(TimeSeriesColumn::Timestamp), i, row.timestamp);
+    put<int64_t>(column(TimeSeriesColumn::TradePrice), i, row.trade_price);
+    put<uint64_t>(column(TimeSeriesColumn::TradeQuantity), i, row.trade_quantity);
+    put<int64_t>(column(TimeSeriesColumn::Spread), i, row.spread);
+    put<double>(column(TimeSeriesColumn::SpreadBps), i, row.spread_bps);
+    put<double>(column(TimeSeriesColumn::Microprice), i, row.microprice);
+    put<double>(column(TimeSeriesColumn::Imbalance), i, row.imbalance);
+    put<double>(column(TimeSeriesColumn::TickVol), i, row.tick_vol);
+    put<double>(column(TimeSeriesColumn::DepthImbalance), i, row.depth_imbalance);
+    put<uint8_t>(column(TimeSeriesColumn::AggressorSide), i,
+                 row.aggressor_side == Side::Buy ? uint8_t{0} : uint8_t{1});
+
+    ++block.rows;
+    ++rows_;
+    if (block.rows == config_.block_rows) submit(true);
+}
+
+void TimeSeriesColumnWriter::submit(bool take_next) {
+    Block* block = current_;
+    auto* header = reinterpret_cast<TimeSeriesBlockHeader*>(block->data.get());
+    header->rows = block->rows;
+    // A partial (last) block: clear the stale tail of every column
+    for (size_t c = 0; c < TIME_SERIES_COLUMN_COUNT; ++c) {
+        const size_t width = TIME_SERIES_COLUMNS[c].width;
+        const size_t used = width * block->rows;
+        std::memset(block->data.get() + offsets_[c] + used, 0, width * config_.block_rows - used);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.push_back(block);
+    current_ = nullptr;
+    ready_.notify_one();
+    if (!take_next) return;
+    if (free_.empty()) {
+        ++stalls_;
+        freed_.wait(lock, [this] { return !free_.empty(); });
+    }
+    current_ = free_.back();
+    free_.pop_back();
+    current_->rows = 0;
+}
+
+void TimeSeriesColumnWriter::close() {
+    if (!running_) return;
+    if (current_ && current_->rows > 0) {
+        submit(false);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_one();
+    writer_.join();
+    running_ = false;
+    current_ = nullptr;
+
+    TimeSeriesFileHeader header{};
+    std::memcpy(header.magic, TIME_SERIES_MAGIC, sizeof(header.magic));
+    header.version = TIME_SERIES_VERSION;
+    header.column_count = TIME_SERIES_COLUMN_COUNT;
+    header.block_rows = config_.block_rows;
+    header.block_bytes = block_bytes_;
+    header.row_count = rows_;
+    header.block_count = blocks_written_;
+    header.price_scale = PRICE_SCALE;
+    header.blocks_offset = sizeof(TimeSeriesFileHeader);
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.close();
+    if (out_.fail()) write_failed_ = true;
+}
+
+uint64_t TimeSeriesColumnWriter::blocks_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_written_;
+}
+
+bool TimeSeriesColumnWriter::write_failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_failed_;
+}
+
+void TimeSeriesColumnWriter::writer_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        ready_.wait(lock, [this] { return !pending_.empty() || stopping_; });
+        if (pending_.empty()) break;  // Stopping, and everything is written
+        Block* block = pending_.front();
+        pending_.erase(pending_.begin());
+        lock.unlock();
+        out_.write(block->data.get(), static_cast<std::streamsize>(block_bytes_));
+        const bool ok = out_.good();
+        lock.lock();
+        ++blocks_written_;
+        if (!ok) write_failed_ = true;
+        free_.push_back(block);
+        freed_.notify_one();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TimeSeriesColumnReader
+// ---------------------------------------------------------------------------
+
+TimeSeriesColumnReader::~TimeSeriesColumnReader() {
+    close();
+}
+
+bool TimeSeriesColumnReader::open(const std::string& path) {
+    close();
+    error_.clear();
+
+#if defined(HFT_TS_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            const auto size = static_cast<size_t>(st.st_size);
+            void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                data_ = static_cast<const char*>(map);
+                size_ = size;
+                mapped_ = true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    if (!mapped_) {
+        // Not mappable (or no mmap): read it whole
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            error_ = "cannot open " + path;
+            return false;
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    if (size_ < sizeof(TimeSeriesFileHeader)) {
+        error_ = path + ": too short for a time-series header";
+        close();
+        return false;
+    }
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, TIME_SERIES_MAGIC, sizeof(header_.magic)) != 0 ||
+        header_.version != TIME_SERIES_VERSION || header_.column_count != TIME_SERIES_COLUMN_COUNT) {
+        error_ = path + ": not a time-series column file";
+        close();
+        return false;
+    }
+    if (header_.block_rows == 0 || header_.block_bytes != time_series_block_bytes(header_.block_rows) ||
+        header_.blocks_offset < sizeof(TimeSeriesFileHeader) ||
+        header_.row_count > header_.block_count * header_.block_rows ||
+        size_ < header_.blocks_offset + header_.block_count * header_.block_bytes) {
+        error_ = path + ": truncated or inconsistent time-series file";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TimeSeriesColumnReader::close() {
+#if defined(HFT_TS_MMAP)
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+    header_ = TimeSeriesFileHeader{};
+}
+
+TimeSeriesRow TimeSeriesColumnReader::row(uint64_t row) const {
+    const size_t b = static_cast<size_t>(row / header_.block_rows);
+    const size_t i = static_cast<size_t>(row % header_.block_rows);
+    TimeSeriesRow out{};
+    out.sequence_num = get<uint64_t>(column(b, TimeSeriesColumn::SequenceNum), i);
+    out.timestamp = get<uint64_t>(column(b, TimeSeriesColumn::Timestamp), i);
+    out.trade_price = get<int64_t>(column(b, TimeSeriesColumn::TradePrice), i);
+    out.trade_quantity = get<uint64_t>(column(b, TimeSeriesColumn::TradeQuantity), i);
+    out.spread = get<int64_t>(column(b, TimeSeriesColumn::Spread), i);
+    out.spread_bps = get<double>(column(b, TimeSeriesColumn::SpreadBps), i);
+    out.microprice = get<double>(column(b, TimeSeriesColumn::Microprice), i);
+    out.imbalance = get<double>(column(b, TimeSeriesColumn::Imbalance), i);
+    out.tick_vol = get<double>(column(b, TimeSeriesColumn::TickVol), i);
+    out.depth_imbalance = get<double>(column(b, TimeSeriesColumn::DepthImbalance), i);
+    out.aggressor_side =
+        get<uint8_t>(column(b, TimeSeriesColumn::AggressorSide), i) == 0 ? Side::Buy : Side::Sell;
+    return out;
+}
+
+}  // namespace hft
@@ -0,0 +1,270 @@
+#pragma once
+
+/// @file time_series_columns.h
+/// @brief Streaming columnar file of the per-trade analytics time series,
+///        its background writer and a memory-mapped reader.
+///
+/// Cold-path component. Holding one TimeSeriesRow per trade for a whole
+/// day and formatting it as CSV at the end costs gigabytes and a long
+/// single-threaded tail. TimeSeriesColumnWriter instead fills fixed-size
+/// column blocks as rows arrive and hands each full block to a writer
+/// thread, so memory stays at `buffers` blocks however long the run is.
+/// append() waits for a free block rather than dropping rows.
+///
+/// Layout (little-endian, as written by the host):
+///   TimeSeriesFileHeader    64 bytes
+///   block[block_count]      block_bytes each, at 64 + i * block_bytes
+/// A block is a 64-byte TimeSeriesBlockHeader, then one array per column
+/// (TIME_SERIES_COLUMNS order) of block_rows values, each array starting
+/// on a 64-byte boundary (time_series_column_offset). Only the last block
+/// may hold fewer than block_rows rows; its arrays are still full size.
+/// So every column of every block sits at a fixed offset, and the file
+/// can be memory-mapped and viewed as typed arrays (numpy.memmap, or
+/// TimeSeriesColumnReader and the Python TimeSeriesFile) without parsing.
+///
+/// Prices are fixed-point at the header's price_scale; microprice is a
+/// double on the same scale.
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+
+namespace hft {
+
+/// A single time-series row captured on each Trade event.
+struct TimeSeriesRow {
+    uint64_t sequence_num;
+    Timestamp timestamp;
+    Price trade_price;
+    Quantity trade_quantity;
+    Price spread;
+    double spread_bps;
+    double microprice;
+    double imbalance;
+    double tick_vol;
+    double depth_imbalance;
+    Side aggressor_side;
+};
+
+// ---------------------------------------------------------------------------
+// Format
+// ---------------------------------------------------------------------------
+
+/// First 8 bytes of every time-series column file.
+constexpr char TIME_SERIES_MAGIC[8] = {'H', 'F', 'T', 'C', 'O', 'L', 'T', 'S'};
+constexpr uint32_t TIME_SERIES_VERSION = 1;
+
+enum class TimeSeriesColumn : uint8_t {
+    SequenceNum,
+    Timestamp,
+    TradePrice,
+    TradeQuantity,
+    Spread,
+    SpreadBps,
+    Microprice,
+    Imbalance,
+    TickVol,
+    DepthImbalance,
+    AggressorSide
+};
+constexpr size_t TIME_SERIES_COLUMN_COUNT = 11;
+
+/// Name and element type of a column. `kind` and `width` follow numpy's
+/// dtype codes ('u' / 'i' / 'f', bytes), so "<" + kind + width is its dtype.
+struct TimeSeriesColumnInfo {
+    const char* name;
+    char kind;
+    uint8_t width;
+};
+
+constexpr std::array<TimeSeriesColumnInfo, TIME_SERIES_COLUMN_COUNT> TIME_SERIES_COLUMNS = {{
+    {"sequence_num", 'u', 8},
+    {"timestamp", 'u', 8},
+    {"trade_price", 'i', 8},
+    {"trade_quantity", 'u', 8},
+    {"spread", 'i', 8},
+    {"spread_bps", 'f', 8},
+    {"microprice", 'f', 8},
+    {"imbalance", 'f', 8},
+    {"tick_vol", 'f', 8},
+    {"depth_imbalance", 'f', 8},
+    {"aggressor_side", 'u', 1},  // 0 = Buy, 1 = Sell
+}};
+
+struct TimeSeriesFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t column_count;         // TIME_SERIES_COLUMN_COUNT
+    uint64_t block_rows;           // Rows per block (the last may hold fewer)
+    uint64_t block_bytes;          // Stride between blocks
+    uint64_t row_count;            // Set when the writer closes
+    uint64_t block_count;
+    int64_t price_scale;
+    uint64_t blocks_offset;        // = sizeof(TimeSeriesFileHeader)
+};
+
+static_assert(sizeof(TimeSeriesFileHeader) == 64, "TimeSeriesFileHeader must be 64 bytes");
+
+struct TimeSeriesBlockHeader {
+    uint64_t rows;
+    uint64_t first_sequence;
+    uint64_t last_sequence;
+    Timestamp first_timestamp;
+    Timestamp last_timestamp;
+    uint64_t reserved[3];
+};
+
+static_assert(sizeof(TimeSeriesBlockHeader) == 64, "TimeSeriesBlockHeader must be 64 bytes");
+
+/// Byte offset of `column`'s array within a block of `block_rows` rows.
+[[nodiscard]] constexpr size_t time_series_column_offset(size_t block_rows,
+                                                         TimeSeriesColumn column) noexcept {
+    size_t offset = sizeof(TimeSeriesBlockHeader);
+    for (size_t c = 0; c < static_cast<size_t>(column); ++c) {
+        offset += (TIME_SERIES_COLUMNS[c].width * block_rows + 63) & ~size_t{63};
+    }
+    return offset;
+}
+
+/// Bytes of one block of `block_rows` rows.
+[[nodiscard]] constexpr size_t time_series_block_bytes(size_t block_rows) noexcept {
+    return time_series_column_offset(block_rows, TimeSeriesColumn::AggressorSide) +
+           ((block_rows + 63) & ~size_t{63});
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+struct TimeSeriesWriterConfig {
+    std::string path;
+    size_t block_rows = 65536;   // Rows per block (about 5 MB)
+    size_t buffers = 4;          // Blocks in memory (>= 2)
+};
+
+class TimeSeriesColumnWriter {
+public:
+    explicit TimeSeriesColumnWriter(const TimeSeriesWriterConfig& config);
+    ~TimeSeriesColumnWriter();
+
+    TimeSeriesColumnWriter(const TimeSeriesColumnWriter&) = delete;
+    TimeSeriesColumnWriter& operator=(const TimeSeriesColumnWriter&) = delete;
+
+    /// Create the file, allocate the blocks and start the writer thread.
+    /// Returns false (see error()) on failure.
+    [[nodiscard]] bool open();
+
+    /// Add one row. Waits only if every block is queued for writing.
+    void append(const TimeSeriesRow& row);
+
+    /// Write the partial block, wait for the writer and finish the header.
+    /// Idempotent; also called by the destructor.
+    void close();
+
+    [[nodiscard]] bool is_open() const { return running_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+    [[nodiscard]] const std::string& path() const { return config_.path; }
+
+    [[nodiscard]] uint64_t rows_appended() const { return rows_; }
+    /// Appends that found no free block and waited for the writer.
+    [[nodiscard]] uint64_t stalls() const { return stalls_; }
+    [[nodiscard]] uint64_t blocks_written() const;
+    [[nodiscard]] bool write_failed() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t rows = 0;
+    };
+
+    /// Queue current_ for writing and take a free block (waiting if none).
+    void submit(bool take_next);
+
+    void writer_loop();
+
+    TimeSeriesWriterConfig config_;
+    std::string error_;
+    size_t block_bytes_ = 0;
+    std::array<size_t, TIME_SERIES_COLUMN_COUNT> offsets_{};
+    std::vector<Block> blocks_;
+    std::ofstream out_;
+
+    // Appending thread
+    Block* current_ = nullptr;
+    uint64_t rows_ = 0;
+    uint64_t stalls_ = 0;
+    bool running_ = false;
+
+    // Shared, under mutex_
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;     // Writer: a block is pending
+    std::condition_variable freed_;     // Appender: a block is free
+    std::vector<Block*> free_;
+    std::vector<Block*> pending_;       // FIFO, written in order
+    bool stopping_ = false;
+    uint64_t blocks_written_ = 0;
+    bool write_failed_ = false;
+
+    std::thread writer_;
+};
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+/// Read-only view of a finished column file, memory-mapped where the
+/// platform allows it (read whole otherwise).
+class TimeSeriesColumnReader {
+public:
+    TimeSeriesColumnReader() = default;
+    ~TimeSeriesColumnReader();
+
+    TimeSeriesColumnReader(const TimeSeriesColumnReader&) = delete;
+    TimeSeriesColumnReader& operator=(const TimeSeriesColumnReader&) = delete;
+
+    /// Map `path` and validate its header and size. Returns false (see
+    /// error()) if it is not a complete column file.
+    [[nodiscard]] bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] const std::string& error() const { return error_; }
+    [[nodiscard]] const TimeSeriesFileHeader& header() const { return header_; }
+    [[nodiscard]] uint64_t row_count() const { return header_.row_count; }
+    [[nodiscard]] uint64_t block_count() const { return header_.block_count; }
+
+    [[nodiscard]] const TimeSeriesBlockHeader& block(size_t index) const {
+        return *reinterpret_cast<const TimeSeriesBlockHeader*>(block_data(index));
+    }
+
+    /// `column`'s array in block `index`: block(index).rows values of the
+    /// column's type.
+    [[nodiscard]] const void* column(size_t index, TimeSeriesColumn column) const {
+        return block_data(index) + time_series_column_offset(header_.block_rows, column);
+    }
+
+    /// Row `row` of the file, reassembled from its columns.
+    [[nodiscard]] TimeSeriesRow row(uint64_t row) const;
+
+private:
+    [[nodiscard]] const char* block_data(size_t index) const {
+        return data_ + header_.blocks_offset + index * header_.block_bytes;
+    }
+
+    std::string error_;
+    TimeSeriesFileHeader header_{};
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;     // When not mapped
+};
+
+}  // namespace hft
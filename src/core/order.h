@@ -14,22 +14,48 @@
 
 namespace hft {
 
+/// Field order is deliberate: everything the matching loop reads or writes
+/// on a resting order (price-time walk, fills, STP, iceberg check, unlink)
+/// sits in the first 64 bytes — the hot prefix. Fields only needed on
+/// entry, replenishment, reporting, expiry or mass cancel (instrument_id,
+/// iceberg_slice_qty, timestamp, stop_price, expire_time, participant
+/// links) form the cold tail.
+///
+/// With HFT_LINE_ALIGNED_ORDERS, Order requests cache-line-aligned pool
+/// slots (see MemoryPool), so the hot prefix is exactly one line and the
+/// cold tail sits in the slot's second line at the same pool index.
 struct Order {
+    // --- Hot line (64 bytes) ---
     OrderId order_id;
+    Price price;
+    Quantity quantity;
+    Quantity visible_quantity;   // Iceberg: displayed quantity
+    Quantity filled_quantity;
+    Order* next;                // Intrusive list: next order in price level
+    Order* prev;                // Intrusive list: prev order in price level
     ParticipantId participant_id;
-    InstrumentId instrument_id;
     Side side;
     OrderType type;
     TimeInForce time_in_force;
     OrderStatus status;
-    Price price;
-    Quantity quantity;
-    Quantity visible_quantity;   // Iceberg: displayed quantity
+
+    // --- Cold tail ---
+    InstrumentId instrument_id;
+    uint32_t participant_slot;   // ParticipantIndex entry (set while resting)
     Quantity iceberg_slice_qty;  // Iceberg: original display slice size (for replenishment)
-    Quantity filled_quantity;
     Timestamp timestamp;
-    Order* next;                // Intrusive list: next order in price level
-    Order* prev;                // Intrusive list: prev order in price level
+    Price stop_price;            // Stop / StopLimit: trigger price
+    Timestamp expire_time;       // DAY / GTD: expiry (0 = none / session close)
+    Order* participant_next;     // Intrusive list: next order of this participant
+    Order* participant_prev;     // Intrusive list: prev order of this participant
+
+#if defined(HFT_LINE_ALIGNED_ORDERS)
+    /// Pool slots for Order are cache-line aligned (see MemoryPool).
+    static constexpr size_t pool_slot_alignment = 64;
+#endif
+
+    /// Bytes at the start of the struct that the matching loop touches.
+    static constexpr size_t hot_bytes = 64;
 
     /// Remaining unfilled quantity.
     [[nodiscard]] Quantity remaining_quantity() const noexcept {
@@ -51,5 +77,7 @@ static_assert(sizeof(Order) <= 128,
               "Order must fit in 2 cache lines (128 bytes)");
 static_assert(alignof(Order) <= 64,
               "Order alignment must not exceed cache line size");
+static_assert(offsetof(Order, instrument_id) == Order::hot_bytes,
+              "Matching-critical Order fields must fill exactly one cache line");
 
 }  // namespace hft
@@ -0,0 +1,24 @@
+#pragma once
+
+/// @file prefetch.h
+/// @brief Software prefetch hint used by the batch submission paths.
+///
+/// A hint only: never faults, so any address (including one past the end
+/// of a table) is safe to pass.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+namespace hft {
+
+/// Pull the cache line holding `addr` into L1 ahead of a write.
+inline void prefetch_write(const void* addr) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+    __builtin_prefetch(addr, 1, 3);
+#endif
+}
+
+}  // namespace hft
@@ -2,13 +2,43 @@
 
 /// @file trade.h
 /// @brief Trade struct — POD record of a matched trade on the hot path.
+///
+/// Besides the two order ids, price and quantity, a Trade carries what the
+/// engine knows at the fill and a consumer would otherwise have to guess or
+/// look up in the live book: which side was the aggressor, who owned the
+/// resting order, and whether the fill emptied the order or its level. So
+/// trade-driven analytics need no book access, and the gateway settles risk
+/// without an order lookup.
+///
+/// Fills of a continuous match set TRADE_AGGRESSOR. Auction prints leave it
+/// clear (both sides rested), as does a zero-initialised Trade from any other
+/// producer, so consumers fall back to inferring the side.
+///
+/// Trade is 56 bytes. An EventMessage carries the six 64-bit fields as its
+/// 48-byte TradeEventData payload and the rest in its header (see
+/// set_trade() / event_trade() in transport/message.h), so events stay one
+/// cache line. The resting participant is 16 bits wide for the same
+/// reason, with TRADE_PARTICIPANT_UNKNOWN for larger ids and for auction
+/// prints.
 
+#include <cstdint>
 #include <type_traits>
 
 #include "core/types.h"
 
 namespace hft {
 
+/// Trade::flags bits.
+enum TradeFlags : uint8_t {
+    TRADE_AGGRESSOR = 1 << 0,        // aggressor_side and resting_participant_id are set
+    TRADE_LEVEL_EXHAUSTED = 1 << 1,  // The resting level (either, for auctions) is now empty
+    TRADE_RESTING_FILLED = 1 << 2    // The resting order is now fully filled
+};
+
+/// Trade::resting_participant_id when the id does not fit in 16 bits (or
+/// for auction prints, which have two resting sides).
+constexpr uint16_t TRADE_PARTICIPANT_UNKNOWN = UINT16_MAX;
+
 struct Trade {
     uint64_t trade_id;
     OrderId buy_order_id;
@@ -16,13 +46,37 @@ struct Trade {
     Price price;
     Quantity quantity;
     Timestamp timestamp;
+    uint16_t resting_participant_id;   // Or TRADE_PARTICIPANT_UNKNOWN
+    Side aggressor_side;               // Valid if TRADE_AGGRESSOR is set
+    uint8_t flags;                     // TradeFlags
+    uint8_t pad_[4];
+
+    [[nodiscard]] bool has_aggressor() const noexcept { return (flags & TRADE_AGGRESSOR) != 0; }
+    [[nodiscard]] bool level_exhausted() const noexcept {
+        return (flags & TRADE_LEVEL_EXHAUSTED) != 0;
+    }
+    [[nodiscard]] bool resting_filled() const noexcept {
+        return (flags & TRADE_RESTING_FILLED) != 0;
+    }
+    [[nodiscard]] OrderId aggressor_order_id() const noexcept {
+        return (aggressor_side == Side::Buy) ? buy_order_id : sell_order_id;
+    }
+    [[nodiscard]] OrderId resting_order_id() const noexcept {
+        return (aggressor_side == Side::Buy) ? sell_order_id : buy_order_id;
+    }
 };
 
+/// The 16-bit Trade::resting_participant_id for `participant`.
+[[nodiscard]] constexpr uint16_t trade_participant(ParticipantId participant) noexcept {
+    return participant < TRADE_PARTICIPANT_UNKNOWN ? static_cast<uint16_t>(participant)
+                                                   : TRADE_PARTICIPANT_UNKNOWN;
+}
+
 static_assert(std::is_trivially_copyable_v<Trade>,
               "Trade must be trivially copyable for hot-path use");
 static_assert(std::is_standard_layout_v<Trade>,
               "Trade must be standard layout");
-static_assert(sizeof(Trade) == 48,
-              "Trade should be exactly 48 bytes (6 x 8-byte fields)");
+static_assert(sizeof(Trade) == 56,
+              "Trade should be exactly 56 bytes (6 x 8-byte fields + 8 bytes of fill state)");
 
 }  // namespace hft
@@ -18,14 +18,17 @@ enum class OrderType : uint8_t {
     IOC,    // Immediate-or-Cancel
     FOK,    // Fill-or-Kill
     GTC,    // Good-til-Cancelled (same as Limit with TIF=GTC)
-    Iceberg
+    Iceberg,
+    Stop,      // Market order released once a trade prints through stop_price
+    StopLimit  // Limit order (at price) released the same way
 };
 
 enum class TimeInForce : uint8_t {
     GTC,  // Good-til-Cancelled
     IOC,  // Immediate-or-Cancel
     FOK,  // Fill-or-Kill
-    DAY   // Day order
+    DAY,  // Day order: expires at the session close
+    GTD   // Good-til-Date: expires at Order::expire_time
 };
 
 enum class OrderStatus : uint8_t {
@@ -34,7 +37,8 @@ enum class OrderStatus : uint8_t {
     PartialFill,
     Filled,
     Cancelled,
-    Rejected
+    Rejected,
+    Expired     // DAY / GTD order reached its expiry
 };
 
 /// Fixed-point price: actual_price * PRICE_SCALE.
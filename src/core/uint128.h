@@ -0,0 +1,109 @@
+#pragma once
+
+/// @file uint128.h
+/// @brief 64 x 64-bit products that need 128 bits, on every supported
+///        compiler.
+///
+/// GCC and Clang provide unsigned __int128: HFT_HAS_UINT128 is defined and
+/// hft::uint128 names it, and the helpers below are one multiply (and a
+/// divide) on it. MSVC has no such type; there the helpers run on 32-bit
+/// limbs (detail::), which stay compiled everywhere so tests can check them
+/// against the native type.
+
+#include <cstdint>
+
+#if defined(__SIZEOF_INT128__)
+#define HFT_HAS_UINT128 1
+#endif
+
+namespace hft {
+
+#if defined(HFT_HAS_UINT128)
+__extension__ typedef unsigned __int128 uint128;  // -Wpedantic clean
+#endif
+
+namespace detail {
+
+/// 128-bit value as two halves.
+struct Wide128 {
+    uint64_t hi;
+    uint64_t lo;
+};
+
+[[nodiscard]] inline bool wide_less(const Wide128& a, const Wide128& b) noexcept {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+/// a * b, from four 32 x 32-bit partial products.
+[[nodiscard]] inline Wide128 wide_mul(uint64_t a, uint64_t b) noexcept {
+    const uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const uint64_t ll = a_lo * b_lo;
+    const uint64_t lh = a_lo * b_hi;
+    const uint64_t hl = a_hi * b_lo;
+    const uint64_t hh = a_hi * b_hi;
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+    return Wide128{hh + (lh >> 32) + (hl >> 32) + (mid >> 32),
+                   (mid << 32) | (ll & 0xFFFFFFFFu)};
+}
+
+/// floor(a * b / d) by shift-and-subtract; the quotient must fit in 64 bits.
+[[nodiscard]] inline uint64_t wide_mul_div(uint64_t a, uint64_t b, uint64_t d) noexcept {
+    const Wide128 p = wide_mul(a, b);
+    uint64_t rem = p.hi;  // < d while the quotient fits
+    uint64_t quot = p.lo;
+    for (int i = 0; i < 64; ++i) {
+        const bool carry = (rem >> 63) != 0;
+        rem = (rem << 1) | (quot >> 63);
+        quot <<= 1;
+        if (carry || rem >= d) {
+            rem -= d;
+            quot |= 1;
+        }
+    }
+    return quot;
+}
+
+/// Whether floor(a * b / d) > limit: a * b >= limit * d + d.
+[[nodiscard]] inline bool wide_mul_div_exceeds(uint64_t a, uint64_t b, uint64_t d,
+                                               uint64_t limit) noexcept {
+    Wide128 bound = wide_mul(limit, d);
+    bound.lo += d;
+    if (bound.lo < d) {
+        if (++bound.hi == 0) return false;  // Bound is 2^128: nothing exceeds it
+    }
+    return !wide_less(wide_mul(a, b), bound);
+}
+
+}  // namespace detail
+
+/// floor(a * b / d) without overflowing the product. The quotient must fit
+/// in 64 bits (e.g. a <= d or b <= d).
+[[nodiscard]] inline uint64_t mul_div_u64(uint64_t a, uint64_t b, uint64_t d) noexcept {
+#if defined(HFT_HAS_UINT128)
+    return static_cast<uint64_t>(static_cast<uint128>(a) * b / d);
+#else
+    return detail::wide_mul_div(a, b, d);
+#endif
+}
+
+/// Whether a * b > c * d, exactly.
+[[nodiscard]] inline bool mul_greater(uint64_t a, uint64_t b, uint64_t c, uint64_t d) noexcept {
+#if defined(HFT_HAS_UINT128)
+    return static_cast<uint128>(a) * b > static_cast<uint128>(c) * d;
+#else
+    return detail::wide_less(detail::wide_mul(c, d), detail::wide_mul(a, b));
+#endif
+}
+
+/// Whether floor(a * b / d) > limit, exactly.
+[[nodiscard]] inline bool mul_div_exceeds(uint64_t a, uint64_t b, uint64_t d,
+                                          uint64_t limit) noexcept {
+#if defined(HFT_HAS_UINT128)
+    return static_cast<uint128>(a) * b / d > limit;
+#else
+    return detail::wide_mul_div_exceeds(a, b, d, limit);
+#endif
+}
+
+}  // namespace hft
@@ -0,0 +1,61 @@
+#include "feed/background_replay.h"
+
+#include <utility>
+
+namespace hft {
+
+BackgroundReplay::BackgroundReplay(EventBuffer& buffer, std::function<void()> run,
+                                   const BackgroundReplayConfig& config)
+    : buffer_(buffer), run_(std::move(run)), config_(config) {}
+
+BackgroundReplay::~BackgroundReplay() { stop(); }
+
+bool BackgroundReplay::start() {
+    if (started() || consumer_ != EventBuffer::INVALID_CONSUMER) return false;
+    consumer_ = buffer_.add_consumer(config_.gating);
+    if (consumer_ == EventBuffer::INVALID_CONSUMER) return false;
+
+    finished_.store(false, std::memory_order_relaxed);
+    events_read_ = 0;
+    lost_ = 0;
+    thread_ = std::thread([this] {
+        run_();
+        finished_.store(true, std::memory_order_release);
+    });
+    return true;
+}
+
+size_t BackgroundReplay::next_batch(EventMessage* out, size_t max) {
+    if (consumer_ == EventBuffer::INVALID_CONSUMER || max == 0) return 0;
+
+    // The ring's wakeup signal belongs to a pipelined run and goes away
+    // with it, so wait without one (Block sleeps block_timeout_us)
+    Waiter waiter(config_.wait);
+    auto ready = [this] { return buffer_.size(consumer_) != 0 || finished(); };
+    for (;;) {
+        // Read finished_ first: once it is set, everything is published
+        const bool done = finished();
+        const size_t n = buffer_.try_pop_n(consumer_, out, max);
+        if (n != 0) {
+            events_read_ += n;
+            return n;
+        }
+        if (done && buffer_.size(consumer_) == 0) return 0;
+        waiter.idle(ready);
+    }
+}
+
+void BackgroundReplay::stop() {
+    if (consumer_ == EventBuffer::INVALID_CONSUMER) return;
+    buffer_.set_gating(consumer_, false);
+    if (thread_.joinable()) thread_.join();
+    lost_ = buffer_.lost(consumer_);
+    buffer_.remove_consumer(consumer_);
+    consumer_ = EventBuffer::INVALID_CONSUMER;
+}
+
+uint64_t BackgroundReplay::lost() const noexcept {
+    return consumer_ != EventBuffer::INVALID_CONSUMER ? buffer_.lost(consumer_) : lost_;
+}
+
+}  // namespace hft
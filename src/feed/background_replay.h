@@ -0,0 +1,98 @@
+#pragma once
+
+/// @file background_replay.h
+/// @brief Runs a replay on a thread of its own while the caller drains its
+///        events in batches through a cursor on the event ring.
+///
+/// Cold-path component behind the Python event iterator
+/// (ReplayEngine.events()). start() adds a cursor to the engine's
+/// EventBuffer (EventBuffer::add_consumer) and calls the engine's run() on
+/// a new thread; next_batch() copies the cursor's next events out in one
+/// go, waiting per WaitConfig while the ring is empty, and returns 0 once
+/// the replay has finished and everything it published has been read.
+///
+/// A gating cursor (the default) loses nothing: when the reader falls a
+/// whole ring behind, the replay waits for it (BackpressurePolicy::Block)
+/// or spills. A non-gating cursor never holds the replay back, and events
+/// the ring overwrote before they were read are counted in lost().
+///
+/// The run() thread is the one that calls the engine's own callbacks, so
+/// they run concurrently with the reader. Stats and the book are the
+/// engine's as usual, valid once finished() is true.
+///
+/// Usage:
+///   ReplayEngine engine(config);   // config.enable_publisher = true
+///   ReplayStats stats;
+///   BackgroundReplay replay(*engine.event_buffer(), [&] { stats = engine.run(); });
+///   replay.start();
+///   std::vector<EventMessage> batch(4096);
+///   while (size_t n = replay.next_batch(batch.data(), batch.size())) { ... }
+///   replay.stop();
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "transport/event_buffer.h"
+#include "transport/message.h"
+#include "transport/wait_strategy.h"
+
+namespace hft {
+
+struct BackgroundReplayConfig {
+    bool gating = true;   // Hold the replay back rather than lose events
+    WaitConfig wait;      // How next_batch() waits on an empty ring
+};
+
+class BackgroundReplay {
+public:
+    /// @param buffer The engine's event ring (ReplayEngine::event_buffer()).
+    /// @param run    Runs the replay to completion (e.g. calls engine.run()).
+    BackgroundReplay(EventBuffer& buffer, std::function<void()> run,
+                     const BackgroundReplayConfig& config = {});
+    ~BackgroundReplay();
+
+    BackgroundReplay(const BackgroundReplay&) = delete;
+    BackgroundReplay& operator=(const BackgroundReplay&) = delete;
+
+    /// Add the cursor and start the replay thread. Returns false if already
+    /// started or the ring has no free cursor.
+    bool start();
+
+    /// Copy up to `max` of the next events into `out`, waiting while none
+    /// are available. Returns 0 once the replay has finished and all of its
+    /// events were read (or before start()).
+    size_t next_batch(EventMessage* out, size_t max);
+
+    /// Stop reading: the cursor stops holding the replay back, the replay
+    /// runs to its end, the thread is joined and the cursor removed.
+    /// Events not yet read are discarded.
+    void stop();
+
+    [[nodiscard]] bool started() const noexcept { return thread_.joinable(); }
+
+    /// run() has returned (its results are safe to read).
+    [[nodiscard]] bool finished() const noexcept {
+        return finished_.load(std::memory_order_acquire);
+    }
+
+    /// Events returned by next_batch().
+    [[nodiscard]] uint64_t events_read() const noexcept { return events_read_; }
+
+    /// Events overwritten before they were read (non-gating cursor only).
+    [[nodiscard]] uint64_t lost() const noexcept;
+
+private:
+    EventBuffer& buffer_;
+    std::function<void()> run_;
+    BackgroundReplayConfig config_;
+    EventBuffer::ConsumerId consumer_ = EventBuffer::INVALID_CONSUMER;
+    std::atomic<bool> finished_{false};
+    std::thread thread_;
+    uint64_t events_read_ = 0;
+    uint64_t lost_ = 0;   // Captured when the cursor is removed
+};
+
+}  // namespace hft
@@ -0,0 +1,336 @@
+#include "feed/batch_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFT_BATCH_MMAP 1
+#endif
+
+#include "feed/compressed_input.h"
+
+namespace hft {
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Shared inputs
+// ---------------------------------------------------------------------------
+
+/// One input file, mapped read-only (read whole where mapping is not
+/// possible) for every job that replays it.
+struct BatchReplay::SharedInput {
+    std::string path;
+    const char* data = nullptr;   // nullptr: each job opens `path` itself
+    size_t size = 0;
+    bool mapped = false;
+    std::vector<char> buffer;     // Fallback when the file cannot be mapped
+    std::string error;            // The file cannot be read
+
+    explicit SharedInput(std::string p) : path(std::move(p)) {}
+
+    ~SharedInput() {
+#if defined(HFT_BATCH_MMAP)
+        if (mapped) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    SharedInput(const SharedInput&) = delete;
+    SharedInput& operator=(const SharedInput&) = delete;
+
+    void open() {
+        const Compression compression = detect_compression(path);
+        if (compression != Compression::None) {
+            if (!compression_supported(compression)) {
+                error = std::string(compression_name(compression)) +
+                        " input, not supported by this build";
+            }
+            return;  // Streamed by each job
+        }
+#if defined(HFT_BATCH_MMAP)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open";
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            size = static_cast<size_t>(st.st_size);
+            if (size == 0) {
+                ::close(fd);
+                return;  // Nothing to share: the job opens the empty file
+            }
+            void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (map != MAP_FAILED) {
+                ::madvise(map, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(map);
+                mapped = true;
+                return;
+            }
+        } else {
+            ::close(fd);
+        }
+        size = 0;
+#endif
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            error = "cannot open";
+            return;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!buffer.empty()) {
+            data = buffer.data();
+            size = buffer.size();
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Manifest
+// ---------------------------------------------------------------------------
+
+bool load_batch_manifest(const std::string& path, std::vector<BatchReplayJob>& jobs,
+                         std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = path + ": cannot open";
+        return false;
+    }
+    std::string line;
+    size_t number = 0;
+    while (std::getline(in, line)) {
+        ++number;
+        std::istringstream fields(line);
+        std::vector<std::string> parts;
+        for (std::string field; fields >> field;) parts.push_back(std::move(field));
+        if (parts.empty() || parts[0][0] == '#') continue;
+        if (parts.size() < 2 || parts.size() > 3) {
+            error = path + ":" + std::to_string(number) +
+                    ": expected <day> <input> [symbol]";
+            return false;
+        }
+        BatchReplayJob job;
+        job.day = std::move(parts[0]);
+        job.input_path = std::move(parts[1]);
+        if (parts.size() == 3) job.symbol = std::move(parts[2]);
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Batch execution
+// ---------------------------------------------------------------------------
+
+BatchReplay::BatchReplay(const BatchReplayConfig& config) : config_(config) {
+    // Inline, publisher-less pipelines (see the header)
+    ReplayConfig& replay = config_.replay;
+    replay.input_path.clear();
+    replay.symbol.clear();
+    replay.output_path.clear();
+    replay.enable_publisher = false;
+    replay.pipelined = false;
+    replay.threading = ThreadingConfig{};
+    replay.journal.directory.clear();
+    replay.multicast.group.clear();
+    replay.checkpoint_directory.clear();
+    replay.checkpoint_every_records = 0;
+    replay.checkpoint_every_ns = 0;
+    replay.metrics_name.clear();
+    replay.trace_sample_every = 0;
+}
+
+BatchReplay::~BatchReplay() = default;
+
+BatchReplayStats BatchReplay::run() {
+    BatchReplayStats stats;
+    const auto start = std::chrono::steady_clock::now();
+    const size_t job_count = config_.jobs.size();
+    stats.jobs.resize(job_count);
+
+    map_inputs(stats);
+    stats.map_seconds = seconds_since(start);
+
+    size_t workers = config_.workers;
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, job_count);
+    stats.workers = workers;
+
+    next_job_.store(0, std::memory_order_relaxed);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([this, w, &stats] { work(w, stats); });
+    }
+    for (auto& t : threads) t.join();
+
+    for (const BatchJobResult& job : stats.jobs) {
+        if (!job.ok) ++stats.jobs_failed;
+        stats.total_messages += job.stats.total_messages;
+        stats.parse_errors += job.stats.parse_errors;
+        stats.orders_accepted += job.stats.orders_accepted;
+        stats.orders_rejected += job.stats.orders_rejected;
+        stats.orders_cancelled += job.stats.orders_cancelled;
+        stats.trades_generated += job.stats.trades_generated;
+    }
+    stats.elapsed_seconds = seconds_since(start);
+    stats.messages_per_second =
+        stats.elapsed_seconds > 0.0
+            ? static_cast<double>(stats.total_messages) / stats.elapsed_seconds
+            : 0.0;
+
+    inputs_.clear();  // Unmapped once every job is done
+    input_of_.clear();
+
+    if (!config_.output_path.empty()) write_report(stats);
+    return stats;
+}
+
+void BatchReplay::map_inputs(BatchReplayStats& stats) {
+    inputs_.clear();
+    input_of_.assign(config_.jobs.size(), 0);
+    std::unordered_map<std::string, size_t> by_path;
+    for (size_t i = 0; i < config_.jobs.size(); ++i) {
+        const std::string& path = config_.jobs[i].input_path;
+        auto [it, inserted] = by_path.emplace(path, inputs_.size());
+        if (inserted) {
+            inputs_.push_back(std::make_unique<SharedInput>(path));
+            SharedInput& input = *inputs_.back();
+            input.open();
+            if (input.data) {
+                ++stats.inputs_shared;
+                stats.input_bytes += input.size;
+            }
+        }
+        input_of_[i] = it->second;
+    }
+}
+
+void BatchReplay::work(size_t worker, BatchReplayStats& stats) {
+    // Built here so the book, pool and index are first touched by the
+    // thread (and NUMA node) that replays into them
+    ReplayEngine engine(config_.replay);
+    bool used = false;
+    for (;;) {
+        const size_t i = next_job_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= config_.jobs.size()) break;
+        const BatchReplayJob& job = config_.jobs[i];
+        const SharedInput& input = *inputs_[input_of_[i]];
+        BatchJobResult& result = stats.jobs[i];
+        result.worker = worker;
+        if (!input.error.empty()) {
+            result.error = input.error;
+            continue;
+        }
+
+        if (used) (void)engine.reset();
+        used = true;
+        engine.set_input(job.input_path, job.symbol,
+                         input.data ? std::string_view(input.data, input.size)
+                                    : std::string_view{});
+        result.stats = engine.run();
+        result.ok = result.stats.input_opened;
+        if (!result.ok) result.error = "cannot read";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+
+void BatchReplay::write_report(const BatchReplayStats& stats) const {
+    auto price_to_double = [](Price p) -> double {
+        return static_cast<double>(p) / static_cast<double>(PRICE_SCALE);
+    };
+
+    nlohmann::json report;
+    auto& batch = report["batch"];
+    batch["jobs"] = stats.jobs.size();
+    batch["jobs_failed"] = stats.jobs_failed;
+    batch["workers"] = stats.workers;
+    batch["inputs_shared"] = stats.inputs_shared;
+    batch["input_bytes"] = stats.input_bytes;
+    batch["map_seconds"] = stats.map_seconds;
+    batch["elapsed_seconds"] = stats.elapsed_seconds;
+    batch["messages_per_second"] = stats.messages_per_second;
+
+    auto& totals = report["totals"];
+    totals["messages"] = stats.total_messages;
+    totals["parse_errors"] = stats.parse_errors;
+    totals["orders_accepted"] = stats.orders_accepted;
+    totals["orders_rejected"] = stats.orders_rejected;
+    totals["orders_cancelled"] = stats.orders_cancelled;
+    totals["trades_generated"] = stats.trades_generated;
+
+    report["jobs"] = nlohmann::json::array();
+    for (size_t i = 0; i < stats.jobs.size(); ++i) {
+        const BatchReplayJob& job = config_.jobs[i];
+        const BatchJobResult& result = stats.jobs[i];
+        const ReplayStats& s = result.stats;
+        nlohmann::json entry;
+        entry["day"] = job.day;
+        entry["input_file"] = job.input_path;
+        if (!job.symbol.empty()) entry["symbol"] = job.symbol;
+        entry["worker"] = result.worker;
+        entry["ok"] = result.ok;
+        if (!result.ok) {
+            entry["error"] = result.error;
+            report["jobs"].push_back(std::move(entry));
+            continue;
+        }
+        entry["messages"]["total"] = s.total_messages;
+        entry["messages"]["add"] = s.add_messages;
+        entry["messages"]["cancel"] = s.cancel_messages;
+        entry["messages"]["modify"] = s.modify_messages;
+        entry["messages"]["trade"] = s.trade_messages;
+        entry["messages"]["parse_errors"] = s.parse_errors;
+        if (!job.symbol.empty()) entry["messages"]["other_symbols"] = s.other_symbol_messages;
+        entry["orders"]["accepted"] = s.orders_accepted;
+        entry["orders"]["rejected"] = s.orders_rejected;
+        entry["orders"]["cancelled"] = s.orders_cancelled;
+        entry["orders"]["cancel_failures"] = s.cancel_failures;
+        entry["orders"]["modified"] = s.orders_modified;
+        entry["orders"]["modify_failures"] = s.modify_failures;
+        entry["trades"]["generated"] = s.trades_generated;
+        entry["final_state"]["order_count"] = s.final_order_count;
+        char digest[17];
+        std::snprintf(digest, sizeof(digest), "%016llx",
+                      static_cast<unsigned long long>(s.final_book_digest));
+        entry["final_state"]["book_digest"] = digest;
+        entry["final_state"]["best_bid"] = price_to_double(s.final_best_bid);
+        entry["final_state"]["best_ask"] = price_to_double(s.final_best_ask);
+        entry["final_state"]["spread"] = price_to_double(s.final_spread);
+        entry["performance"]["elapsed_seconds"] = s.elapsed_seconds;
+        entry["performance"]["messages_per_second"] = s.messages_per_second;
+        report["jobs"].push_back(std::move(entry));
+    }
+
+    std::ofstream out(config_.output_path);
+    if (out.is_open()) {
+        out << report.dump(2) << "\n";
+    } else {
+        std::cerr << "Failed to write report to: " << config_.output_path << "\n";
+    }
+}
+
+}  // namespace hft
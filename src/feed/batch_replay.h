@@ -0,0 +1,137 @@
+#pragma once
+
+/// @file batch_replay.h
+/// @brief Replays a manifest of sessions (days x instruments) on a pool of
+///        reusable pipelines and merges their results into one report.
+///
+/// Cold-path component behind `replay --batch`. Running the replay binary
+/// once per day-file pays for building and faulting a book, pool and
+/// order index every time; a BatchReplay builds one ReplayEngine per
+/// worker thread, on that thread, and moves it from job to job with
+/// ReplayEngine::reset(), which hands the resting orders back to the pool
+/// and clears the index in bulk instead of reallocating.
+///
+/// Every distinct uncompressed input is mapped read-only once, before the
+/// workers start, and shared: jobs replaying different symbols of one
+/// multi-instrument day parse the same pages in place
+/// (L3FeedParser::open_buffer). Compressed inputs are streamed per job.
+///
+/// Workers take jobs in manifest order from a shared counter, so a long
+/// day does not hold up the days queued behind it on other workers.
+/// Results come back in manifest order whatever ran where, and a
+/// pipeline's state never carries from one job into the next, so the
+/// merged report is that of running the jobs one by one.
+///
+/// Jobs run inline and publish no events: the journal, multicast feed,
+/// checkpoints, metrics region, thread placement and pipelined mode of
+/// BatchReplayConfig::replay are ignored. Parallelism comes from the
+/// workers.
+///
+/// Manifest (load_batch_manifest): one job per line,
+///
+///     <day> <input> [symbol]
+///
+/// separated by spaces or tabs; blank lines and lines starting with '#'
+/// are skipped. Without a symbol, the whole file is one instrument.
+///
+/// Usage:
+///   BatchReplayConfig config;
+///   config.replay.min_price = ...;        // Geometry of every pipeline
+///   std::string error;
+///   if (!load_batch_manifest("nightly.txt", config.jobs, error)) ...
+///   config.workers = 8;
+///   config.output_path = "nightly.json";
+///   BatchReplayStats stats = BatchReplay(config).run();
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "feed/replay_engine.h"
+
+namespace hft {
+
+/// One session of a batch: a day's file, optionally one of its symbols.
+struct BatchReplayJob {
+    std::string day;         // Label in the report (e.g. "2024-01-02")
+    std::string input_path;
+    std::string symbol;      // Empty = every record (ReplayConfig::symbol)
+};
+
+struct BatchReplayConfig {
+    /// Geometry and options of every worker's pipeline. input_path,
+    /// symbol and output_path are taken from the jobs instead.
+    ReplayConfig replay;
+    std::vector<BatchReplayJob> jobs;
+    /// Pipelines replaying jobs at once (0 = one per hardware thread);
+    /// never more than there are jobs.
+    size_t workers = 1;
+    /// Merged JSON report of the whole batch (empty = none).
+    std::string output_path;
+};
+
+/// Outcome of one job.
+struct BatchJobResult {
+    bool ok = false;
+    std::string error;       // Why the input could not be read
+    size_t worker = 0;       // Which pipeline replayed it
+    ReplayStats stats;
+};
+
+/// Statistics of a batch, with each job's in manifest order.
+struct BatchReplayStats {
+    std::vector<BatchJobResult> jobs;
+    size_t workers = 0;
+    size_t jobs_failed = 0;
+    size_t inputs_shared = 0;       // Distinct inputs mapped once for all jobs
+    uint64_t input_bytes = 0;       // Their total size
+    uint64_t total_messages = 0;    // Summed over the jobs
+    uint64_t parse_errors = 0;
+    uint64_t orders_accepted = 0;
+    uint64_t orders_rejected = 0;
+    uint64_t orders_cancelled = 0;
+    uint64_t trades_generated = 0;
+    double map_seconds = 0.0;       // Mapping the shared inputs
+    double elapsed_seconds = 0.0;   // Wall time, mapping included
+    double messages_per_second = 0.0;
+};
+
+/// Read a manifest (see above) and append its jobs to `jobs`. Returns false
+/// with `error` set (naming the line) if the file cannot be read or a line
+/// has fewer than two or more than three fields.
+bool load_batch_manifest(const std::string& path, std::vector<BatchReplayJob>& jobs,
+                         std::string& error);
+
+class BatchReplay {
+public:
+    explicit BatchReplay(const BatchReplayConfig& config);
+    ~BatchReplay();
+
+    BatchReplay(const BatchReplay&) = delete;
+    BatchReplay& operator=(const BatchReplay&) = delete;
+
+    /// Replay every job. Blocks until the last worker finishes, then writes
+    /// the merged report if BatchReplayConfig::output_path is set.
+    BatchReplayStats run();
+
+private:
+    struct SharedInput;  // batch_replay.cpp
+
+    /// Map each distinct uncompressed input once; job i reads inputs_[input_of_[i]].
+    void map_inputs(BatchReplayStats& stats);
+
+    /// Worker body: build a pipeline, then replay jobs until none are left.
+    void work(size_t worker, BatchReplayStats& stats);
+
+    void write_report(const BatchReplayStats& stats) const;
+
+    BatchReplayConfig config_;
+    std::vector<std::unique_ptr<SharedInput>> inputs_;
+    std::vector<size_t> input_of_;   // Per job
+    std::atomic<size_t> next_job_{0};
+};
+
+}  // namespace hft
@@ -0,0 +1,363 @@
+#include "feed/cl_ord_id_table.h"
+
+#include <cstring>
+
+#include "core/trade.h"
+#include "matching/match_result.h"
+
+namespace hft {
+namespace fix {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t p = 16;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/// The order is off the book once its result says so.
+bool terminal(MatchStatus status) noexcept {
+    switch (status) {
+        case MatchStatus::Filled:
+        case MatchStatus::Cancelled:
+        case MatchStatus::Rejected:
+        case MatchStatus::SelfTradePrevented:
+            return true;
+        case MatchStatus::PartialFill:
+        case MatchStatus::Resting:
+        case MatchStatus::Modified:
+            return false;
+    }
+    return false;
+}
+
+/// Whether slot `home` lies cyclically in (hole, j]: such a slot is
+/// reachable without passing the hole and stays put.
+bool in_run(size_t home, size_t hole, size_t j) noexcept {
+    return hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Construction
+// ---------------------------------------------------------------------------
+
+ClOrdIdTable::ClOrdIdTable(size_t capacity, OrderId first_order_id)
+    : entries_(capacity == 0 ? 1 : capacity),
+      by_key_(round_up_pow2(entries_.size() * 2), KeySlot{0, NONE}),
+      by_order_(by_key_.size(), OrderSlot{NO_ORDER, NONE, 0}),
+      mask_(by_key_.size() - 1),
+      next_order_id_(first_order_id == NO_ORDER ? 1 : first_order_id) {
+    clear();
+}
+
+void ClOrdIdTable::clear() noexcept {
+    for (KeySlot& slot : by_key_) slot = KeySlot{0, NONE};
+    for (OrderSlot& slot : by_order_) slot = OrderSlot{NO_ORDER, NONE, 0};
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        entries_[i].next = (i + 1 < entries_.size()) ? static_cast<uint32_t>(i + 1) : NONE;
+    }
+    free_ = 0;
+    size_ = 0;
+    orders_ = 0;
+}
+
+void ClOrdIdTable::reset(OrderId first_order_id) noexcept {
+    clear();
+    next_order_id_ = first_order_id == NO_ORDER ? 1 : first_order_id;
+}
+
+// ---------------------------------------------------------------------------
+// Keys
+// ---------------------------------------------------------------------------
+
+bool ClOrdIdTable::make_key(std::string_view cl_ord_id, Key& key) noexcept {
+    if (cl_ord_id.size() > MAX_LENGTH) return false;
+    std::memset(key.words, 0, sizeof(key.words));
+    std::memcpy(key.words, cl_ord_id.data(), cl_ord_id.size());
+    key.length = static_cast<uint32_t>(cl_ord_id.size());
+    return true;
+}
+
+uint32_t ClOrdIdTable::hash_key(const Key& key) noexcept {
+    // Multiply-xorshift over the words, as SymbolInterner hashes its prefix
+    uint64_t h = key.length;
+    for (uint64_t w : key.words) {
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+    }
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return static_cast<uint32_t>(h);
+}
+
+size_t ClOrdIdTable::hash_order(OrderId id) noexcept {
+    // Ids are sequential; spread them over the index
+    uint64_t h = id * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    return static_cast<size_t>(h);
+}
+
+size_t ClOrdIdTable::find_key(const Key& key, uint32_t hash) const noexcept {
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+        const KeySlot& slot = by_key_[i];
+        if (slot.entry == NONE) return NONE;
+        if (slot.hash != hash) continue;
+        const Key& k = entries_[slot.entry].key;
+        if (k.length == key.length && k.words[0] == key.words[0] &&
+            k.words[1] == key.words[1] && k.words[2] == key.words[2] &&
+            k.words[3] == key.words[3]) {
+            return i;
+        }
+    }
+}
+
+size_t ClOrdIdTable::find_order(OrderId id) const noexcept {
+    if (id == NO_ORDER) return NONE;
+    for (size_t i = hash_order(id) & mask_;; i = (i + 1) & mask_) {
+        const OrderSlot& slot = by_order_[i];
+        if (slot.order_id == id) return i;
+        if (slot.order_id == NO_ORDER) return NONE;
+    }
+}
+
+OrderId ClOrdIdTable::find(std::string_view cl_ord_id) const noexcept {
+    Key key;
+    if (!make_key(cl_ord_id, key)) return NO_ORDER;
+    const size_t i = find_key(key, hash_key(key));
+    return i == NONE ? NO_ORDER : entries_[by_key_[i].entry].order_id;
+}
+
+// ---------------------------------------------------------------------------
+// Binding
+// ---------------------------------------------------------------------------
+
+FixError ClOrdIdTable::bind(std::string_view cl_ord_id, OrderId order_id) noexcept {
+    if (cl_ord_id.empty()) return FixError::MissingClOrdID;
+    Key key;
+    if (!make_key(cl_ord_id, key)) return FixError::ClOrdIDTooLong;
+    const uint32_t hash = hash_key(key);
+    if (find_key(key, hash) != NONE) return FixError::DuplicateClOrdID;
+    if (free_ == NONE) return FixError::ClOrdIDTableFull;
+
+    const uint32_t e = free_;
+    Entry& entry = entries_[e];
+    free_ = entry.next;
+    entry.key = key;
+    entry.order_id = order_id;
+    entry.next = NONE;
+
+    size_t i = hash & mask_;
+    while (by_key_[i].entry != NONE) i = (i + 1) & mask_;
+    by_key_[i] = KeySlot{hash, e};
+
+    const size_t s = find_order(order_id);
+    if (s != NONE) {
+        entry.next = by_order_[s].head;
+        by_order_[s].head = e;
+    } else {
+        size_t j = hash_order(order_id) & mask_;
+        while (by_order_[j].order_id != NO_ORDER) j = (j + 1) & mask_;
+        by_order_[j] = OrderSlot{order_id, e, 0};
+        ++orders_;
+    }
+    ++size_;
+    return FixError::None;
+}
+
+FixError ClOrdIdTable::bind_new(std::string_view cl_ord_id, OrderId& id) noexcept {
+    const FixError error = bind(cl_ord_id, next_order_id_);
+    if (error == FixError::None) id = next_order_id_++;
+    return error;
+}
+
+FixError ClOrdIdTable::bind_replace(std::string_view orig_cl_ord_id,
+                                    std::string_view cl_ord_id, OrderId& id) noexcept {
+    const OrderId target = find(orig_cl_ord_id);
+    if (target == NO_ORDER) return FixError::UnknownOrigClOrdID;
+    const FixError error = bind(cl_ord_id, target);
+    if (error == FixError::None) id = target;
+    return error;
+}
+
+OrderId ClOrdIdTable::assign(std::string_view cl_ord_id) noexcept {
+    OrderId id = NO_ORDER;
+    (void)bind_new(cl_ord_id, id);
+    return id;
+}
+
+OrderId ClOrdIdTable::replace(std::string_view orig_cl_ord_id,
+                              std::string_view cl_ord_id) noexcept {
+    OrderId id = NO_ORDER;
+    (void)bind_replace(orig_cl_ord_id, cl_ord_id, id);
+    return id;
+}
+
+FixError ClOrdIdTable::resolve(const FixMessageView& msg, OrderMessage& out) noexcept {
+    OrderId id = NO_ORDER;
+    FixError error = FixError::None;
+    switch (msg.msg_type) {
+        case MsgType::NewOrderSingle:
+            error = bind_new(msg.cl_ord_id, id);
+            break;
+        case MsgType::OrderCancelRequest:
+            id = find(msg.orig_cl_ord_id);
+            if (id == NO_ORDER) error = FixError::UnknownOrigClOrdID;
+            break;
+        case MsgType::OrderCancelReplace:
+            error = bind_replace(msg.orig_cl_ord_id, msg.cl_ord_id, id);
+            break;
+        default:
+            return FixError::NotAnOrder;
+    }
+    if (error == FixError::None) out.order.order_id = id;
+    return error;
+}
+
+// ---------------------------------------------------------------------------
+// Reclaiming
+// ---------------------------------------------------------------------------
+
+void ClOrdIdTable::on_result(const OrderMessage& msg, const GatewayResult& result) noexcept {
+    if (result.deferred) return;
+    const size_t s = find_order(msg.order.order_id);
+    if (s == NONE) return;
+
+    switch (msg.type) {
+        case MessageType::Add:
+            if (!result.accepted || terminal(result.match_status)) drop_after(s, NONE);
+            break;
+        case MessageType::Cancel:
+            // Accepted or not, the order is no longer on the book
+            drop_after(s, NONE);
+            break;
+        case MessageType::Modify: {
+            if (result.accepted) {
+                if (terminal(result.match_status)) {
+                    drop_after(s, NONE);
+                } else {
+                    drop_after(s, by_order_[s].head);   // The replace's ClOrdID
+                }
+            } else {
+                // Refused replace: the order keeps its previous ClOrdID. A
+                // refused amend also reads OrderNotFound, so a rejection
+                // never reclaims the order itself.
+                drop_pending(s);
+            }
+            break;
+        }
+    }
+}
+
+void ClOrdIdTable::on_event(const EventMessage& event) noexcept {
+    if (event.type == EventType::Trade) {
+        const Trade trade = event_trade(event);
+        if (trade.has_aggressor() && trade.resting_filled()) {
+            (void)release(trade.resting_order_id());
+        }
+        return;
+    }
+    if (event.type == EventType::LevelUpdate || event.type == EventType::MassCancel ||
+        event.type == EventType::BookDigest) {
+        return;
+    }
+
+    const size_t s = find_order(event.data.order_event.order_id);
+    if (s == NONE) return;
+    switch (event.type) {
+        case EventType::OrderAccepted:
+        case EventType::OrderPartialFill:
+            by_order_[s].live = 1;
+            break;
+        case EventType::OrderModified:
+            by_order_[s].live = 1;
+            drop_after(s, by_order_[s].head);
+            break;
+        case EventType::OrderRejected:
+            if (by_order_[s].live) {
+                drop_pending(s);
+            } else {
+                drop_after(s, NONE);
+            }
+            break;
+        case EventType::OrderFilled:
+        case EventType::OrderCancelled:
+        case EventType::OrderExpired:
+            drop_after(s, NONE);
+            break;
+        default:
+            break;
+    }
+}
+
+std::string_view ClOrdIdTable::cl_ord_id(OrderId id) const noexcept {
+    const size_t s = find_order(id);
+    if (s == NONE) return {};
+    const Key& key = entries_[by_order_[s].head].key;
+    return std::string_view(reinterpret_cast<const char*>(key.words), key.length);
+}
+
+bool ClOrdIdTable::release(OrderId id) noexcept {
+    const size_t s = find_order(id);
+    if (s == NONE) return false;
+    drop_after(s, NONE);
+    return true;
+}
+
+void ClOrdIdTable::drop_after(size_t order_slot, uint32_t keep) noexcept {
+    uint32_t e = NONE;
+    if (keep == NONE) {
+        e = by_order_[order_slot].head;
+        erase_order_slot(order_slot);
+        --orders_;
+    } else {
+        e = entries_[keep].next;
+        entries_[keep].next = NONE;
+    }
+    while (e != NONE) {
+        const uint32_t older = entries_[e].next;
+        free_entry(e);
+        e = older;
+    }
+}
+
+void ClOrdIdTable::drop_pending(size_t order_slot) noexcept {
+    const uint32_t head = by_order_[order_slot].head;
+    if (entries_[head].next == NONE) return;
+    by_order_[order_slot].head = entries_[head].next;
+    free_entry(head);
+}
+
+void ClOrdIdTable::free_entry(uint32_t entry) noexcept {
+    size_t i = hash_key(entries_[entry].key) & mask_;
+    while (by_key_[i].entry != entry) i = (i + 1) & mask_;
+    erase_key_slot(i);
+    entries_[entry].next = free_;
+    free_ = entry;
+    --size_;
+}
+
+void ClOrdIdTable::erase_key_slot(size_t hole) noexcept {
+    // Backward shift: pull later members of the probe run into the hole
+    for (size_t j = (hole + 1) & mask_; by_key_[j].entry != NONE; j = (j + 1) & mask_) {
+        if (in_run(by_key_[j].hash & mask_, hole, j)) continue;
+        by_key_[hole] = by_key_[j];
+        hole = j;
+    }
+    by_key_[hole] = KeySlot{0, NONE};
+}
+
+void ClOrdIdTable::erase_order_slot(size_t hole) noexcept {
+    for (size_t j = (hole + 1) & mask_; by_order_[j].order_id != NO_ORDER;
+         j = (j + 1) & mask_) {
+        if (in_run(hash_order(by_order_[j].order_id) & mask_, hole, j)) continue;
+        by_order_[hole] = by_order_[j];
+        hole = j;
+    }
+    by_order_[hole] = OrderSlot{NO_ORDER, NONE, 0};
+}
+
+}  // namespace fix
+}  // namespace hft
@@ -0,0 +1,185 @@
+#pragma once
+
+/// @file cl_ord_id_table.h
+/// @brief Per-session ClOrdID -> OrderId intern table for FIX order entry.
+///
+/// Cold-path component between a FIX session and its OrderGateway. FIX
+/// clients name orders by string ClOrdID (tag 11) and cancel / replace them
+/// by OrigClOrdID (tag 41), while the engine keys on numeric OrderIds. The
+/// table hands every new order the session's next OrderId (so the book's
+/// direct index sees monotonically assigned ids) and resolves the targets
+/// of cancels and replaces. Unlike FixParser::cl_ord_id_to_order_id(), it
+/// cannot collide, and it catches a reused ClOrdID or an unknown target.
+///
+/// Each ClOrdID is stored inline as up to MAX_LENGTH bytes in four zero
+/// padded words. Two open-addressing indexes (linear probing, kept at most
+/// half full) map hashed ClOrdID bytes and OrderIds to fixed entries: a
+/// lookup is a hash, a 32-bit tag compare and four word compares. All
+/// storage is sized at construction, so resolve(), on_result() and
+/// on_event() never allocate. Erasing shifts the probe chain back instead
+/// of leaving tombstones, so a long session does not degrade.
+///
+/// A replace (35=G) binds its new ClOrdID to the order next to the old
+/// one; once the modify is settled only one of them stays. One replace per
+/// order may be in flight. Entries are reclaimed when an order reaches a
+/// terminal state, found from either of two sources:
+///   - on_result(), for a caller that sees the GatewayResults: a rejected
+///     add, an add or modify ending Filled / Cancelled (IOC, market, STP)
+///     / Rejected, or a cancel. An accepted modify keeps the new ClOrdID,
+///     a refused one the old (without reclaiming the order: the gateway
+///     reports a refused amend as OrderNotFound). Results of throttled
+///     orders (GatewayResult::deferred) are ignored.
+///   - on_event(), for a caller that only sees the published events (as
+///     an order-entry server does): OrderFilled, OrderCancelled and
+///     OrderExpired, a Trade that fills the resting order
+///     (Trade::resting_filled()), and OrderRejected of an order with no
+///     accept, fill or modify event yet. OrderRejected of a live order is
+///     a refused amend, OrderModified an accepted one.
+/// Feeding both is harmless: every step is idempotent. Mass cancels carry
+/// no order ids: call release() per order, or clear().
+///
+/// Usage:
+///   ClOrdIdTable ids(100'000, first_session_order_id);
+///   OrderMessage om;
+///   if (FixParser::parse_into(raw, om, ids, instrument) == FixError::None) {
+///       GatewayResult r = gateway.process(om);
+///       ids.on_result(om, r);
+///   }
+///   // Events of the session's instrument, as they are published:
+///   ids.on_event(event);
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "core/types.h"
+#include "feed/fix_message.h"
+#include "gateway/order_gateway.h"
+#include "transport/message.h"
+
+namespace hft {
+namespace fix {
+
+class ClOrdIdTable {
+public:
+    /// Longest ClOrdID the table stores (longer ones are refused).
+    static constexpr size_t MAX_LENGTH = 32;
+
+    /// Returned when no order is bound (never assigned to an order).
+    static constexpr OrderId NO_ORDER = 0;
+
+    /// @param capacity        Live ClOrdIDs held at once (pending replaces
+    ///                        hold two per order).
+    /// @param first_order_id  The first OrderId assigned. Sessions sharing
+    ///                        a book need disjoint ranges.
+    explicit ClOrdIdTable(size_t capacity = 65536, OrderId first_order_id = 1);
+
+    /// Set out.order.order_id from the session's bindings: a new order
+    /// (35=D) is assigned the next OrderId, a cancel (35=F) names its
+    /// OrigClOrdID's order, a replace (35=G) likewise and binds its
+    /// ClOrdID too. On failure `out` is left as it was.
+    [[nodiscard]] FixError resolve(const FixMessageView& msg, OrderMessage& out) noexcept;
+
+    /// Bind a new order's ClOrdID. Returns its OrderId, or NO_ORDER if the
+    /// ClOrdID is live, too long or the table is full.
+    [[nodiscard]] OrderId assign(std::string_view cl_ord_id) noexcept;
+
+    /// Bind a replace's ClOrdID to OrigClOrdID's order (keeping both until
+    /// on_result()). Returns the order's OrderId, or NO_ORDER on failure.
+    [[nodiscard]] OrderId replace(std::string_view orig_cl_ord_id,
+                                  std::string_view cl_ord_id) noexcept;
+
+    /// OrderId bound to `cl_ord_id`, or NO_ORDER.
+    [[nodiscard]] OrderId find(std::string_view cl_ord_id) const noexcept;
+
+    /// Newest ClOrdID bound to `id` (the one reports echo), or empty. The
+    /// view stays valid until that binding is dropped.
+    [[nodiscard]] std::string_view cl_ord_id(OrderId id) const noexcept;
+
+    /// Settle the bindings of `msg` (as resolved) with its gateway result.
+    void on_result(const OrderMessage& msg, const GatewayResult& result) noexcept;
+
+    /// Settle the bindings of the order(s) a published event is about.
+    void on_event(const EventMessage& event) noexcept;
+
+    /// Drop every ClOrdID bound to `id`. Returns false if none was.
+    bool release(OrderId id) noexcept;
+
+    /// Live ClOrdIDs.
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    /// Orders with at least one live ClOrdID.
+    [[nodiscard]] size_t order_count() const noexcept { return orders_; }
+
+    [[nodiscard]] size_t capacity() const noexcept { return entries_.size(); }
+
+    /// The OrderId the next new order gets.
+    [[nodiscard]] OrderId next_order_id() const noexcept { return next_order_id_; }
+
+    /// Drop every binding (OrderIds keep counting up).
+    void clear() noexcept;
+
+    /// Drop every binding and number new orders from `first_order_id`
+    /// (a new session reusing the table).
+    void reset(OrderId first_order_id) noexcept;
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Key {
+        uint64_t words[MAX_LENGTH / 8];
+        uint32_t length;
+    };
+
+    /// One live ClOrdID. An order's entries are chained newest first.
+    struct Entry {
+        Key key;
+        OrderId order_id;
+        uint32_t next;   // Older alias of the same order, or the free list
+    };
+
+    struct KeySlot {
+        uint32_t hash;   // Low hash bits: home slot and compare tag
+        uint32_t entry;  // NONE when empty
+    };
+
+    struct OrderSlot {
+        OrderId order_id;  // NO_ORDER when empty
+        uint32_t head;     // Newest entry of the order
+        uint32_t live;     // An accept, fill or modify event was seen
+    };
+
+    [[nodiscard]] static bool make_key(std::string_view cl_ord_id, Key& key) noexcept;
+    [[nodiscard]] static uint32_t hash_key(const Key& key) noexcept;
+    [[nodiscard]] static size_t hash_order(OrderId id) noexcept;
+
+    [[nodiscard]] size_t find_key(const Key& key, uint32_t hash) const noexcept;
+    [[nodiscard]] size_t find_order(OrderId id) const noexcept;
+
+    /// Bind `key` to `order_id` as its newest alias.
+    [[nodiscard]] FixError bind(std::string_view cl_ord_id, OrderId order_id) noexcept;
+    [[nodiscard]] FixError bind_new(std::string_view cl_ord_id, OrderId& id) noexcept;
+    [[nodiscard]] FixError bind_replace(std::string_view orig_cl_ord_id,
+                                        std::string_view cl_ord_id, OrderId& id) noexcept;
+
+    /// Drop the aliases of slot `order_slot` after `keep` (NONE: all).
+    void drop_after(size_t order_slot, uint32_t keep) noexcept;
+    /// A refused replace: drop the newest alias if there is an older one.
+    void drop_pending(size_t order_slot) noexcept;
+    void free_entry(uint32_t entry) noexcept;
+    void erase_key_slot(size_t i) noexcept;
+    void erase_order_slot(size_t i) noexcept;
+
+    std::vector<Entry> entries_;
+    std::vector<KeySlot> by_key_;
+    std::vector<OrderSlot> by_order_;
+    size_t mask_ = 0;              // Both indexes have the same size
+    uint32_t free_ = NONE;
+    size_t size_ = 0;
+    size_t orders_ = 0;
+    OrderId next_order_id_;
+};
+
+}  // namespace fix
+}  // namespace hft
@@ -0,0 +1,461 @@
+#include "feed/compressed_input.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(HFT_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(HFT_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(HFT_HAVE_LZ4)
+#include <lz4frame.h>
+#endif
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Format detection
+// ---------------------------------------------------------------------------
+
+Compression detect_compression(const char* head, size_t n) {
+    const auto* b = reinterpret_cast<const unsigned char*>(head);
+    if (n >= 2 && b[0] == 0x1F && b[1] == 0x8B) return Compression::Gzip;
+    if (n >= 4 && b[0] == 0x28 && b[1] == 0xB5 && b[2] == 0x2F && b[3] == 0xFD) {
+        return Compression::Zstd;
+    }
+    if (n >= 4 && b[0] == 0x04 && b[1] == 0x22 && b[2] == 0x4D && b[3] == 0x18) {
+        return Compression::Lz4;
+    }
+    return Compression::None;
+}
+
+Compression detect_compression(const std::string& path) {
+    char head[4] = {};
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return Compression::None;
+    const size_t n = std::fread(head, 1, sizeof(head), f);
+    std::fclose(f);
+    return detect_compression(head, n);
+}
+
+bool compression_supported(Compression c) {
+    switch (c) {
+        case Compression::None: return true;
+#if defined(HFT_HAVE_ZLIB)
+        case Compression::Gzip: return true;
+#endif
+#if defined(HFT_HAVE_ZSTD)
+        case Compression::Zstd: return true;
+#endif
+#if defined(HFT_HAVE_LZ4)
+        case Compression::Lz4: return true;
+#endif
+        default: return false;
+    }
+}
+
+const char* compression_name(Compression c) {
+    switch (c) {
+        case Compression::Gzip: return "gzip";
+        case Compression::Zstd: return "zstd";
+        case Compression::Lz4: return "lz4";
+        default: return "none";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Decoders
+// ---------------------------------------------------------------------------
+
+/// One codec's streaming decompressor.
+class DecompressingReader::Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /// Decompress up to `cap` bytes into `out`. Returns the count, 0 at the
+    /// end of the stream, or -1 on an error (described by error).
+    virtual long read(char* out, size_t cap) = 0;
+
+    std::string error;
+};
+
+namespace {
+
+/// Compressed bytes read from the file per refill.
+constexpr size_t INPUT_CHUNK = 256 * 1024;
+
+#if defined(HFT_HAVE_ZLIB)
+
+class GzipDecoder final : public DecompressingReader::Decoder {
+public:
+    explicit GzipDecoder(gzFile file) : file_(file) { gzbuffer(file_, INPUT_CHUNK); }
+    ~GzipDecoder() override { gzclose(file_); }
+
+    long read(char* out, size_t cap) override {
+        const unsigned n = cap > (1u << 30) ? (1u << 30) : static_cast<unsigned>(cap);
+        const int got = gzread(file_, out, n);
+        if (got < 0) {
+            int code = 0;
+            error = gzerror(file_, &code);
+            return -1;
+        }
+        if (got == 0) {
+            // A truncated member reads as EOF with Z_BUF_ERROR recorded
+            int code = Z_OK;
+            const char* what = gzerror(file_, &code);
+            if (code != Z_OK || !gzeof(file_)) {
+                error = code != Z_OK ? what : "gzip read failed";
+                return -1;
+            }
+        }
+        return got;
+    }
+
+private:
+    gzFile file_;
+};
+
+#endif
+
+#if defined(HFT_HAVE_ZSTD)
+
+class ZstdDecoder final : public DecompressingReader::Decoder {
+public:
+    explicit ZstdDecoder(std::FILE* file)
+        : file_(file), ctx_(ZSTD_createDCtx()), in_(INPUT_CHUNK) {}
+    ~ZstdDecoder() override {
+        ZSTD_freeDCtx(ctx_);
+        std::fclose(file_);
+    }
+
+    long read(char* out, size_t cap) override {
+        ZSTD_outBuffer ob{out, cap, 0};
+        while (ob.pos == 0) {
+            bool eof = false;
+            if (ib_.pos == ib_.size) {
+                const size_t n = std::fread(in_.data(), 1, in_.size(), file_);
+                if (n == 0) {
+                    if (pending_ == 0) return 0;
+                    // Out of input, but the last call may have stopped only
+                    // because `out` was full: flush what the context holds.
+                    eof = true;
+                }
+                ib_ = {in_.data(), n, 0};
+            }
+            pending_ = ZSTD_decompressStream(ctx_, &ob, &ib_);
+            if (ZSTD_isError(pending_)) {
+                error = ZSTD_getErrorName(pending_);
+                return -1;
+            }
+            if (eof && ob.pos == 0) {
+                if (pending_ == 0) return 0;
+                error = "truncated zstd stream";
+                return -1;
+            }
+        }
+        return static_cast<long>(ob.pos);
+    }
+
+private:
+    std::FILE* file_;
+    ZSTD_DCtx* ctx_;
+    std::vector<char> in_;
+    ZSTD_inBuffer ib_{nullptr, 0, 0};
+    size_t pending_ = 0;   // 0 once a frame is complete
+};
+
+#endif
+
+#if defined(HFT_HAVE_LZ4)
+
+class Lz4Decoder final : public DecompressingReader::Decoder {
+public:
+    explicit Lz4Decoder(std::FILE* file) : file_(file), in_(INPUT_CHUNK) {
+        (void)LZ4F_createDecompressionContext(&ctx_, LZ4F_VERSION);
+    }
+    ~Lz4Decoder() override {
+        LZ4F_freeDecompressionContext(ctx_);
+        std::fclose(file_);
+    }
+
+    long read(char* out, size_t cap) override {
+        size_t produced = 0;
+        while (produced == 0) {
+            bool eof = false;
+            if (in_pos_ == in_size_) {
+                in_size_ = std::fread(in_.data(), 1, in_.size(), file_);
+                in_pos_ = 0;
+                if (in_size_ == 0) {
+                    if (pending_ == 0) return 0;
+                    // Out of input, but the last call may have stopped only
+                    // because `out` was full: flush what the context holds.
+                    eof = true;
+                }
+            }
+            size_t out_size = cap;
+            size_t in_size = in_size_ - in_pos_;
+            pending_ = LZ4F_decompress(ctx_, out, &out_size, in_.data() + in_pos_,
+                                       &in_size, nullptr);
+            if (LZ4F_isError(pending_)) {
+                error = LZ4F_getErrorName(pending_);
+                return -1;
+            }
+            in_pos_ += in_size;
+            produced = out_size;
+            if (eof && produced == 0) {
+                if (pending_ == 0) return 0;
+                error = "truncated lz4 stream";
+                return -1;
+            }
+        }
+        return static_cast<long>(produced);
+    }
+
+private:
+    std::FILE* file_;
+    LZ4F_dctx* ctx_ = nullptr;
+    std::vector<char> in_;
+    size_t in_pos_ = 0;
+    size_t in_size_ = 0;
+    size_t pending_ = 0;   // 0 once a frame is complete
+};
+
+#endif
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Compression (archiving tools and tests)
+// ---------------------------------------------------------------------------
+
+bool compress_file(const std::string& in_path, const std::string& out_path,
+                   Compression c) {
+    std::FILE* in = std::fopen(in_path.c_str(), "rb");
+    if (!in) return false;
+    std::vector<char> buf(INPUT_CHUNK);
+    bool ok = false;
+
+    switch (c) {
+#if defined(HFT_HAVE_ZLIB)
+        case Compression::Gzip: {
+            gzFile out = gzopen(out_path.c_str(), "wb6");
+            if (!out) break;
+            ok = true;
+            size_t n;
+            while (ok && (n = std::fread(buf.data(), 1, buf.size(), in)) > 0) {
+                ok = gzwrite(out, buf.data(), static_cast<unsigned>(n)) ==
+                     static_cast<int>(n);
+            }
+            ok = (gzclose(out) == Z_OK) && ok;
+            break;
+        }
+#endif
+#if defined(HFT_HAVE_ZSTD)
+        case Compression::Zstd: {
+            std::FILE* out = std::fopen(out_path.c_str(), "wb");
+            if (!out) break;
+            ZSTD_CCtx* ctx = ZSTD_createCCtx();
+            std::vector<char> obuf(ZSTD_CStreamOutSize());
+            ok = true;
+            bool last = false;
+            while (ok && !last) {
+                const size_t n = std::fread(buf.data(), 1, buf.size(), in);
+                last = n < buf.size();
+                ZSTD_inBuffer ib{buf.data(), n, 0};
+                const ZSTD_EndDirective mode = last ? ZSTD_e_end : ZSTD_e_continue;
+                size_t remaining;
+                do {
+                    ZSTD_outBuffer ob{obuf.data(), obuf.size(), 0};
+                    remaining = ZSTD_compressStream2(ctx, &ob, &ib, mode);
+                    if (ZSTD_isError(remaining) ||
+                        std::fwrite(obuf.data(), 1, ob.pos, out) != ob.pos) {
+                        ok = false;
+                        break;
+                    }
+                } while (last ? remaining != 0 : ib.pos != ib.size);
+            }
+            ZSTD_freeCCtx(ctx);
+            ok = (std::fclose(out) == 0) && ok;
+            break;
+        }
+#endif
+#if defined(HFT_HAVE_LZ4)
+        case Compression::Lz4: {
+            std::FILE* out = std::fopen(out_path.c_str(), "wb");
+            if (!out) break;
+            LZ4F_cctx* ctx = nullptr;
+            (void)LZ4F_createCompressionContext(&ctx, LZ4F_VERSION);
+            std::vector<char> obuf(LZ4F_compressBound(buf.size(), nullptr) +
+                                   LZ4F_HEADER_SIZE_MAX);
+            size_t r = LZ4F_compressBegin(ctx, obuf.data(), obuf.size(), nullptr);
+            ok = !LZ4F_isError(r) && std::fwrite(obuf.data(), 1, r, out) == r;
+            size_t n;
+            while (ok && (n = std::fread(buf.data(), 1, buf.size(), in)) > 0) {
+                r = LZ4F_compressUpdate(ctx, obuf.data(), obuf.size(), buf.data(), n,
+                                        nullptr);
+                ok = !LZ4F_isError(r) && std::fwrite(obuf.data(), 1, r, out) == r;
+            }
+            if (ok) {
+                r = LZ4F_compressEnd(ctx, obuf.data(), obuf.size(), nullptr);
+                ok = !LZ4F_isError(r) && std::fwrite(obuf.data(), 1, r, out) == r;
+            }
+            LZ4F_freeCompressionContext(ctx);
+            ok = (std::fclose(out) == 0) && ok;
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+
+    ok = !std::ferror(in) && ok;
+    std::fclose(in);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// DecompressingReader
+// ---------------------------------------------------------------------------
+
+DecompressingReader::DecompressingReader(size_t block_bytes)
+    : block_bytes_(block_bytes == 0 ? DEFAULT_BLOCK_BYTES : block_bytes) {}
+
+DecompressingReader::~DecompressingReader() {
+    close();
+}
+
+bool DecompressingReader::open(const std::string& path) {
+    close();
+    error_.clear();
+    compression_ = detect_compression(path);
+    if (compression_ == Compression::None) {
+        error_ = "not a compressed file: " + path;
+        return false;
+    }
+    if (!compression_supported(compression_)) {
+        error_ = std::string(compression_name(compression_)) +
+                 " input is not supported by this build";
+        return false;
+    }
+
+    switch (compression_) {
+#if defined(HFT_HAVE_ZLIB)
+        case Compression::Gzip:
+            if (gzFile f = gzopen(path.c_str(), "rb")) {
+                decoder_ = std::make_unique<GzipDecoder>(f);
+            }
+            break;
+#endif
+#if defined(HFT_HAVE_ZSTD)
+        case Compression::Zstd:
+            if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+                decoder_ = std::make_unique<ZstdDecoder>(f);
+            }
+            break;
+#endif
+#if defined(HFT_HAVE_LZ4)
+        case Compression::Lz4:
+            if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+                decoder_ = std::make_unique<Lz4Decoder>(f);
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    if (!decoder_) {
+        error_ = "cannot open " + path;
+        return false;
+    }
+
+    for (Block& b : blocks_) {
+        b.data.resize(block_bytes_);
+        b.length = 0;
+        b.full = false;
+        b.last = false;
+    }
+    thread_ = std::thread([this] { produce(); });
+    return true;
+}
+
+void DecompressingReader::produce() {
+    for (int i = 0;; i ^= 1) {
+        Block& b = blocks_[i];
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&] { return stop_ || !b.full; });
+            if (stop_) return;
+        }
+
+        size_t length = 0;
+        bool last = false;
+        while (length < block_bytes_) {
+            const long n = decoder_->read(b.data.data() + length, block_bytes_ - length);
+            if (n <= 0) {
+                if (n < 0) {
+                    error_ = decoder_->error;
+                    failed_ = true;
+                }
+                last = true;
+                break;
+            }
+            length += static_cast<size_t>(n);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            b.length = length;
+            b.last = last;
+            b.full = true;
+        }
+        cv_.notify_all();
+        if (last) return;
+    }
+}
+
+std::string_view DecompressingReader::next_block() {
+    if (!thread_.joinable()) return {};
+    if (held_ >= 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            blocks_[held_].full = false;
+        }
+        cv_.notify_all();
+        held_ = -1;
+    }
+    if (done_) return {};
+
+    Block& b = blocks_[next_];
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return b.full; });
+    }
+    held_ = next_;
+    next_ ^= 1;
+    done_ = b.last;
+    bytes_out_ += b.length;
+    if (b.length == 0) return next_block();  // Only an empty last block
+    return {b.data.data(), b.length};
+}
+
+void DecompressingReader::close() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+    decoder_.reset();
+    stop_ = false;
+    held_ = -1;
+    next_ = 0;
+    done_ = false;
+    failed_ = false;
+    bytes_out_ = 0;
+}
+
+}  // namespace hft
@@ -0,0 +1,121 @@
+#pragma once
+
+/// @file compressed_input.h
+/// @brief Streaming decompression of archived L3 files (gzip, zstd, lz4).
+///
+/// Cold-path component. DecompressingReader opens a compressed file and
+/// hands out its decompressed bytes block by block. A background thread
+/// decompresses into two alternating blocks, so decompression of block
+/// N + 1 overlaps with the caller parsing (and matching) block N, and
+/// nothing is decompressed to disk.
+///
+/// L3FeedParser::open() uses it transparently when a file starts with a
+/// gzip, zstd or lz4 frame magic. Each codec is built in when its
+/// development package (zlib, libzstd, liblz4) is found at configure time;
+/// compression_supported() reports which are.
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hft {
+
+enum class Compression : uint8_t { None, Gzip, Zstd, Lz4 };
+
+/// Compression of a file starting with `head` (its first n bytes), by
+/// frame magic.
+[[nodiscard]] Compression detect_compression(const char* head, size_t n);
+
+/// Compression of the file at `path` (None if unreadable).
+[[nodiscard]] Compression detect_compression(const std::string& path);
+
+/// Whether this build can read (and write) `c`.
+[[nodiscard]] bool compression_supported(Compression c);
+
+/// "none", "gzip", "zstd" or "lz4".
+[[nodiscard]] const char* compression_name(Compression c);
+
+/// Compress the file at `in_path` into `out_path` (archiving tools and
+/// tests). Returns false on I/O error or an unsupported codec.
+bool compress_file(const std::string& in_path, const std::string& out_path,
+                   Compression c);
+
+/// Double-buffered, background-thread decompressor over one file.
+///
+/// Usage:
+///   DecompressingReader reader;
+///   if (!reader.open("day.csv.zst")) { reader.error(); ... }
+///   for (auto block = reader.next_block(); !block.empty();
+///        block = reader.next_block()) {
+///       // consume block (valid until the next call)
+///   }
+///   if (reader.failed()) { reader.error(); ... }
+class DecompressingReader {
+public:
+    /// Decompressed bytes per block.
+    static constexpr size_t DEFAULT_BLOCK_BYTES = size_t{4} << 20;
+
+    explicit DecompressingReader(size_t block_bytes = DEFAULT_BLOCK_BYTES);
+    ~DecompressingReader();
+
+    DecompressingReader(const DecompressingReader&) = delete;
+    DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+    /// Open `path` and start decompressing. Returns false if it cannot be
+    /// read, is not compressed, or its codec is not built in (see error()).
+    bool open(const std::string& path);
+
+    /// The next block of decompressed bytes, valid until the next call;
+    /// empty at the end of the stream or after an error.
+    std::string_view next_block();
+
+    /// Stop the decompression thread and close the file.
+    void close();
+
+    /// Whether decompression stopped on corrupt or truncated input.
+    [[nodiscard]] bool failed() const { return failed_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    [[nodiscard]] Compression compression() const { return compression_; }
+
+    /// Decompressed bytes handed out so far.
+    [[nodiscard]] uint64_t bytes_out() const { return bytes_out_; }
+
+    class Decoder;  // compressed_input.cpp
+
+private:
+    struct Block {
+        std::vector<char> data;
+        size_t length = 0;
+        bool full = false;   // Filled by the decoder, not yet released
+        bool last = false;   // End of stream (or error) after this block
+    };
+
+    /// Decompression thread body.
+    void produce();
+
+    size_t block_bytes_;
+    Compression compression_ = Compression::None;
+    std::unique_ptr<Decoder> decoder_;
+    Block blocks_[2];
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    // Consumer side
+    int held_ = -1;          // Block the caller is reading, if any
+    int next_ = 0;           // Block the next call returns
+    bool done_ = false;
+    bool failed_ = false;    // Written by the producer before publishing `last`
+    std::string error_;
+    uint64_t bytes_out_ = 0;
+};
+
+}  // namespace hft
@@ -0,0 +1,183 @@
+#include "feed/fix_framer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hft {
+namespace fix {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+/// Every frame starts with BeginString "8=FIX.x.y" or "8=FIXT.1.1".
+static constexpr std::string_view FRAME_START = "8=FIX";
+
+/// "10=nnn<d>"
+static constexpr size_t TRAILER_BYTES = 7;
+
+/// BeginString values longer than this are not FIX.
+static constexpr size_t MAX_BEGIN_STRING = 32;
+
+/// BodyLength digits accepted (bounded by max_message anyway).
+static constexpr size_t MAX_LENGTH_DIGITS = 7;
+
+static bool is_delimiter(char c) { return c == '\x01' || c == '|'; }
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// ---------------------------------------------------------------------------
+// FixFramer
+// ---------------------------------------------------------------------------
+
+FixFramer::FixFramer(size_t capacity, size_t max_message)
+    : buffer_(std::max(capacity, 2 * max_message)), max_message_(max_message) {}
+
+char* FixFramer::prepare(size_t& available) {
+    if (head_ == tail_) {
+        head_ = tail_ = 0;
+    } else if (buffer_.size() - tail_ < max_message_ && head_ > 0) {
+        // Only the partial frame (< max_message) is left once next() has
+        // been drained; offsets within it (summed_) are head-relative.
+        std::memmove(buffer_.data(), buffer_.data() + head_, tail_ - head_);
+        tail_ -= head_;
+        head_ = 0;
+    }
+    available = buffer_.size() - tail_;
+    return buffer_.data() + tail_;
+}
+
+void FixFramer::commit(size_t n) {
+    tail_ += std::min(n, buffer_.size() - tail_);
+}
+
+size_t FixFramer::feed(const char* data, size_t n) {
+    size_t available = 0;
+    char* p = prepare(available);
+    const size_t accepted = std::min(n, available);
+    std::memcpy(p, data, accepted);
+    commit(accepted);
+    return accepted;
+}
+
+void FixFramer::reset() {
+    head_ = tail_ = 0;
+    have_header_ = false;
+}
+
+bool FixFramer::next(std::string_view& message) {
+    for (;;) {
+        if (!have_header_) {
+            if (head_ == tail_) return false;
+            if (!read_header()) return false;
+            if (!have_header_) continue;  // Skipped a bad header
+        }
+
+        const char* p = buffer_.data() + head_;
+        const size_t avail = tail_ - head_;
+        const size_t body_end = frame_length_ - TRAILER_BYTES;
+
+        // Sum only the bytes that arrived since the last call
+        const size_t upto = std::min(avail, body_end);
+        for (size_t i = summed_; i < upto; ++i) sum_ += static_cast<uint8_t>(p[i]);
+        summed_ = std::max(summed_, upto);
+
+        if (avail < frame_length_) return false;
+
+        const char* t = p + body_end;
+        if (t[0] != '1' || t[1] != '0' || t[2] != '=' || !is_digit(t[3]) ||
+            !is_digit(t[4]) || !is_digit(t[5]) || t[6] != delim_) {
+            resync(Error::BadTrailer);
+            continue;
+        }
+        const uint32_t declared = static_cast<uint32_t>(
+            (t[3] - '0') * 100 + (t[4] - '0') * 10 + (t[5] - '0'));
+        if (declared != sum_ % 256) {
+            resync(Error::ChecksumMismatch);
+            continue;
+        }
+
+        message = std::string_view(p, frame_length_);
+        head_ += frame_length_;
+        have_header_ = false;
+        ++messages_;
+        return true;
+    }
+}
+
+bool FixFramer::read_header() {
+    const char* p = buffer_.data() + head_;
+    const size_t avail = tail_ - head_;
+
+    const size_t prefix = std::min(avail, FRAME_START.size());
+    if (std::memcmp(p, FRAME_START.data(), prefix) != 0) {
+        resync(Error::Garbage);
+        return true;
+    }
+    if (avail < FRAME_START.size()) return false;
+
+    // BeginString value, then its delimiter (SOH or '|')
+    size_t i = FRAME_START.size();
+    const size_t begin_limit = std::min(avail, MAX_BEGIN_STRING);
+    while (i < begin_limit && !is_delimiter(p[i])) ++i;
+    if (i == begin_limit) {
+        if (avail < MAX_BEGIN_STRING) return false;
+        resync(Error::BadHeader);
+        return true;
+    }
+    const char delim = p[i];
+
+    // "9=<digits><d>"
+    if (avail < i + 3) return false;
+    if (p[i + 1] != '9' || p[i + 2] != '=') {
+        resync(Error::BadHeader);
+        return true;
+    }
+    size_t j = i + 3;
+    size_t body_length = 0;
+    while (j < avail && is_digit(p[j]) && j - (i + 3) < MAX_LENGTH_DIGITS) {
+        body_length = body_length * 10 + static_cast<size_t>(p[j] - '0');
+        ++j;
+    }
+    if (j == avail) return false;
+    if (j == i + 3 || p[j] != delim) {
+        resync(Error::BadHeader);
+        return true;
+    }
+
+    const size_t frame_length = j + 1 + body_length + TRAILER_BYTES;
+    if (frame_length > max_message_) {
+        resync(Error::Oversize);
+        return true;
+    }
+
+    have_header_ = true;
+    delim_ = delim;
+    frame_length_ = frame_length;
+    summed_ = 0;
+    sum_ = 0;
+    return true;
+}
+
+void FixFramer::resync(Error e) {
+    ++errors_;
+    last_error_ = e;
+    have_header_ = false;
+
+    const std::string_view rest(buffer_.data() + head_ + 1, tail_ - head_ - 1);
+    size_t skip = rest.find(FRAME_START);
+    if (skip == std::string_view::npos) {
+        // Keep a trailing partial "8=FIX" that the next read may complete
+        size_t keep = std::min(rest.size(), FRAME_START.size() - 1);
+        while (keep > 0 &&
+               rest.compare(rest.size() - keep, keep, FRAME_START.substr(0, keep)) != 0) {
+            --keep;
+        }
+        skip = rest.size() - keep;
+    }
+    discarded_bytes_ += skip + 1;
+    head_ += skip + 1;
+}
+
+}  // namespace fix
+}  // namespace hft
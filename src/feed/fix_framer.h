@@ -0,0 +1,135 @@
+#pragma once
+
+/// @file fix_framer.h
+/// @brief Incremental FIX session framer over a streaming receive buffer.
+///
+/// Cold-path component. A TCP session reads arbitrary byte chunks straight
+/// into the framer's receive buffer (prepare() / commit()); next() then
+/// yields every complete message in place, as a view into that buffer,
+/// ready for FixParser::parse_view() or parse_into().
+///
+/// Framing follows the FIX header: "8=FIX...<d>9=<len><d>" gives the
+/// exact message length (header + BodyLength + the 7-byte "10=nnn<d>"
+/// trailer), so a partial message is never rescanned. Its checksum is
+/// summed incrementally as bytes arrive, and the trailer is checked once
+/// the last byte is in. A frame with a bad header, trailer or checksum is
+/// counted and skipped by resynchronising on the next "8=FIX".
+///
+/// The buffer is linear, not wrapped: a partial message left at its end
+/// is moved to the front by prepare() when the tail runs short, which is
+/// the only copy the framer makes. Messages from next() stay valid until
+/// the following prepare(), feed() or reset().
+///
+/// Usage:
+///   FixFramer framer;
+///   for (;;) {
+///       size_t space = 0;
+///       char* p = framer.prepare(space);
+///       ssize_t n = ::recv(fd, p, space, 0);
+///       if (n <= 0) break;
+///       framer.commit(static_cast<size_t>(n));
+///       std::string_view msg;
+///       OrderMessage om;
+///       while (framer.next(msg)) {
+///           if (FixParser::parse_into(msg, om) == FixError::None) { ... }
+///       }
+///   }
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace hft {
+namespace fix {
+
+class FixFramer {
+public:
+    /// Why a frame was skipped.
+    enum class Error : uint8_t {
+        None,
+        Garbage,           ///< Bytes that do not start with "8=FIX"
+        BadHeader,         ///< Missing or malformed BodyLength (tag 9)
+        Oversize,          ///< Message longer than max_message()
+        BadTrailer,        ///< No "10=nnn<d>" where BodyLength says it ends
+        ChecksumMismatch
+    };
+
+    /// Receive buffer size.
+    static constexpr size_t DEFAULT_CAPACITY = size_t{1} << 20;
+
+    /// Largest accepted message (header + body + trailer).
+    static constexpr size_t DEFAULT_MAX_MESSAGE = size_t{16} << 10;
+
+    /// @param capacity     Receive buffer bytes (at least 2 * max_message).
+    /// @param max_message  Longest message accepted; longer frames are
+    ///                     skipped as Error::Oversize.
+    explicit FixFramer(size_t capacity = DEFAULT_CAPACITY,
+                       size_t max_message = DEFAULT_MAX_MESSAGE);
+
+    /// Writable space at the end of the buffer for the next read, after
+    /// moving any partial message to the front if the tail is short.
+    /// `available` is set to its size, which is at least half the capacity
+    /// once next() has been drained.
+    char* prepare(size_t& available);
+
+    /// Mark `n` bytes written at prepare()'s pointer as received.
+    void commit(size_t n);
+
+    /// Copy `data` into the buffer (prepare + memcpy + commit). Returns how
+    /// many bytes were accepted; less than n only if next() has not been
+    /// drained.
+    size_t feed(const char* data, size_t n);
+
+    /// Frame the next complete, checksum-valid message. Returns false when
+    /// more bytes are needed. Invalid frames are skipped (see errors()).
+    bool next(std::string_view& message);
+
+    /// Drop all buffered bytes and partial state (e.g. on reconnect).
+    void reset();
+
+    /// Received bytes not yet returned by next().
+    [[nodiscard]] size_t buffered() const { return tail_ - head_; }
+
+    [[nodiscard]] size_t capacity() const { return buffer_.size(); }
+    [[nodiscard]] size_t max_message() const { return max_message_; }
+
+    /// Messages returned by next().
+    [[nodiscard]] uint64_t messages() const { return messages_; }
+
+    /// Frames skipped, and the bytes skipped with them.
+    [[nodiscard]] uint64_t errors() const { return errors_; }
+    [[nodiscard]] uint64_t discarded_bytes() const { return discarded_bytes_; }
+
+    /// Reason for the most recent skipped frame.
+    [[nodiscard]] Error last_error() const { return last_error_; }
+
+private:
+    /// Parse "8=...<d>9=<len><d>" at head_. Returns false if more bytes
+    /// are needed; on a malformed header, skips it and returns true with
+    /// have_header_ still false.
+    bool read_header();
+
+    /// Skip the frame at head_ (reason `e`) up to the next "8=FIX".
+    void resync(Error e);
+
+    std::vector<char> buffer_;
+    size_t max_message_;
+    size_t head_ = 0;           // First byte of the current frame
+    size_t tail_ = 0;           // End of received bytes
+
+    // Current frame, once its header has been read
+    bool have_header_ = false;
+    char delim_ = '\0';
+    size_t frame_length_ = 0;   // Header + body + trailer
+    size_t summed_ = 0;         // Bytes of the frame already in sum_
+    uint32_t sum_ = 0;          // Checksum of the frame's first summed_ bytes
+
+    uint64_t messages_ = 0;
+    uint64_t errors_ = 0;
+    uint64_t discarded_bytes_ = 0;
+    Error last_error_ = Error::None;
+};
+
+}  // namespace fix
+}  // namespace hft
@@ -7,8 +7,14 @@
 /// serializer, message type constants, FIX-specific enum values, and the
 /// FixMessage struct that holds a parsed FIX message before conversion to
 /// the engine's internal OrderMessage format.
+///
+/// FixMessageView is the allocation-free form: its strings view the raw
+/// message and failures are FixError codes, so FixParser::parse_view() and
+/// parse_into() can run in front of the gateway on every inbound message.
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "core/types.h"
 
@@ -99,6 +105,79 @@ constexpr char Rejected    = '8';
 // Parsed FIX message
 // ---------------------------------------------------------------------------
 
+/// Why a FIX message was rejected.
+enum class FixError : uint8_t {
+    None,
+    EmptyMessage,
+    MissingMsgType,
+    InvalidMsgType,        ///< Tag 35 is not a single character
+    UnsupportedMsgType,
+    MissingClOrdID,
+    MissingOrigClOrdID,
+    MissingSide,
+    MissingOrdType,
+    MissingOrderQty,       ///< Missing or zero
+    MissingSymbol,
+    MissingPrice,          ///< Limit order without tag 44
+    ChecksumMismatch,
+    BodyLengthMismatch,
+    NotAnOrder,            ///< parse_into() of a valid non-order message (35=8)
+    DuplicateClOrdID,      ///< ClOrdIdTable: tag 11 names a live order
+    UnknownOrigClOrdID,    ///< ClOrdIdTable: tag 41 names no live order
+    ClOrdIDTooLong,        ///< ClOrdIdTable: longer than MAX_LENGTH
+    ClOrdIDTableFull       ///< ClOrdIdTable: every entry is in use
+};
+
+/// Static description of `e` (e.g. "missing Symbol (tag 55)").
+[[nodiscard]] constexpr const char* fix_error_text(FixError e) noexcept {
+    switch (e) {
+        case FixError::None:               return "";
+        case FixError::EmptyMessage:       return "empty message";
+        case FixError::MissingMsgType:     return "missing MsgType (tag 35)";
+        case FixError::InvalidMsgType:     return "invalid MsgType";
+        case FixError::UnsupportedMsgType: return "unsupported MsgType";
+        case FixError::MissingClOrdID:     return "missing ClOrdID (tag 11)";
+        case FixError::MissingOrigClOrdID: return "missing OrigClOrdID (tag 41)";
+        case FixError::MissingSide:        return "missing Side (tag 54)";
+        case FixError::MissingOrdType:     return "missing OrdType (tag 40)";
+        case FixError::MissingOrderQty:    return "missing or zero OrderQty (tag 38)";
+        case FixError::MissingSymbol:      return "missing Symbol (tag 55)";
+        case FixError::MissingPrice:       return "Limit order missing Price (tag 44)";
+        case FixError::ChecksumMismatch:   return "checksum mismatch";
+        case FixError::BodyLengthMismatch: return "BodyLength mismatch";
+        case FixError::NotAnOrder:         return "not an order message";
+        case FixError::DuplicateClOrdID:   return "duplicate ClOrdID (tag 11)";
+        case FixError::UnknownOrigClOrdID: return "unknown OrigClOrdID (tag 41)";
+        case FixError::ClOrdIDTooLong:     return "ClOrdID too long";
+        case FixError::ClOrdIDTableFull:   return "too many open orders";
+    }
+    return "";
+}
+
+/// A parsed FIX message whose strings view the raw message (valid while
+/// that buffer is). Populated by FixParser::parse_view().
+struct FixMessageView {
+    char msg_type = '\0';               ///< Tag 35 value
+    std::string_view begin_string;      ///< Tag 8
+    std::string_view sender_comp_id;    ///< Tag 49
+    std::string_view target_comp_id;    ///< Tag 56
+    std::string_view cl_ord_id;         ///< Tag 11
+    std::string_view orig_cl_ord_id;    ///< Tag 41
+    std::string_view symbol;            ///< Tag 55
+    char fix_side = '\0';               ///< Tag 54
+    char fix_ord_type = '\0';           ///< Tag 40
+    char fix_tif = '\0';                ///< Tag 59
+    Price price = 0;                    ///< Tag 44, converted to fixed-point
+    Quantity quantity = 0;              ///< Tag 38
+    std::string_view transact_time;     ///< Tag 60
+    int body_length = 0;                ///< Tag 9 (declared body length)
+    int actual_body_length = 0;         ///< Measured, when tags 9 and 10 are present
+    std::string_view checksum;          ///< Tag 10 (declared checksum)
+    bool valid = false;
+    FixError error = FixError::None;
+    std::string_view error_detail;      ///< Offending tag 35 value, if any
+};
+
 /// Intermediate representation of a parsed FIX message.
 /// Populated by FixParser::parse(), consumed by FixParser::to_order_message().
 struct FixMessage {
@@ -119,6 +198,7 @@ struct FixMessage {
     std::string checksum;               ///< Tag 10 (declared checksum)
     bool valid = false;                 ///< True if parsing succeeded
     std::string error;                  ///< Error description on failure
+    FixError error_code = FixError::None;
 };
 
 }  // namespace fix
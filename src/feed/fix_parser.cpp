@@ -1,12 +1,13 @@
 #include "feed/fix_parser.h"
 
-#include <array>
 #include <cstdint>
 #include <cstring>
 #include <string>
 #include <string_view>
 
+#include "feed/cl_ord_id_table.h"
 #include "feed/l3_feed_parser.h"
+#include "feed/structural_scanner.h"
 
 namespace hft {
 namespace fix {
@@ -21,10 +22,7 @@ static constexpr char SOH = '\x01';
 /// Detect which delimiter the message uses (SOH or pipe).
 static char detect_delimiter(std::string_view raw) {
     // If the message contains SOH, use that; otherwise assume pipe.
-    for (char c : raw) {
-        if (c == SOH) return SOH;
-    }
-    return '|';
+    return std::memchr(raw.data(), SOH, raw.size()) ? SOH : '|';
 }
 
 /// Parse an integer from a string_view. Returns -1 on failure.
@@ -38,280 +36,272 @@ static int parse_int(std::string_view sv) {
     return result;
 }
 
+/// Name used in "<MsgType> missing ..." errors.
+static const char* msg_type_name(char msg_type) {
+    switch (msg_type) {
+        case MsgType::NewOrderSingle:     return "NewOrderSingle";
+        case MsgType::OrderCancelRequest: return "OrderCancelRequest";
+        case MsgType::OrderCancelReplace: return "OrderCancelReplace";
+        default:                          return "message";
+    }
+}
+
+static bool fail(FixMessageView& out, FixError error) {
+    out.error = error;
+    return false;
+}
+
 // ---------------------------------------------------------------------------
 // FixParser — public API
 // ---------------------------------------------------------------------------
 
-FixMessage FixParser::parse(std::string_view raw) {
-    FixMessage msg;
-
-    if (raw.empty()) {
-        msg.error = "empty message";
-        return msg;
-    }
-
-    char delim = detect_delimiter(raw);
-
-    // Tag lookup: flat array for tags 0-200, small array for tags 150-199
-    // We use string_view into the original raw buffer for zero-copy.
-    // Tags 0-60 cover most fields; 150-151 are ExecType/LeavesQty.
-    constexpr size_t PRIMARY_SIZE = 201;
-    std::array<std::string_view, PRIMARY_SIZE> tags{};
-
-    // Parse all tag=value pairs
-    size_t pos = 0;
-    while (pos < raw.size()) {
-        // Find next delimiter or end
-        size_t end = raw.find(delim, pos);
-        if (end == std::string_view::npos) {
-            end = raw.size();
+bool FixParser::parse_view(std::string_view raw, FixMessageView& out) noexcept {
+    out = FixMessageView{};
+
+    if (raw.empty()) return fail(out, FixError::EmptyMessage);
+
+    const char delim = detect_delimiter(raw);
+
+    // Parse all tag=value pairs: one bitmask of delimiters and '=' per
+    // 64-byte block, walked bit by bit. Later duplicates of a tag win.
+    const StructuralSet structurals(delim, '=');
+    constexpr size_t NPOS = std::string_view::npos;
+    size_t start = 0;          // First byte of the current field
+    size_t eq = NPOS;          // Its first '='
+    size_t body_start = NPOS;  // Byte after tag 9's field
+    size_t tag10_start = NPOS; // First byte of the "10=" field
+    std::string_view msg_type;
+    std::string_view side;
+    std::string_view ord_type;
+    std::string_view tif;
+    std::string_view price;
+    std::string_view quantity;
+    std::string_view body_length;
+
+    auto store_field = [&](size_t end) {
+        if (eq == NPOS || eq == start) return;
+        const int tag_num = parse_int(raw.substr(start, eq - start));
+        const std::string_view value = raw.substr(eq + 1, end - eq - 1);
+        switch (tag_num) {
+            case Tag::BeginString:  out.begin_string = value; break;
+            case Tag::BodyLength:
+                body_length = value;
+                if (body_start == NPOS) body_start = end + 1;
+                break;
+            case Tag::CheckSum:
+                out.checksum = value;
+                if (tag10_start == NPOS) tag10_start = start;
+                break;
+            case Tag::ClOrdID:      out.cl_ord_id = value; break;
+            case Tag::MsgType:      msg_type = value; break;
+            case Tag::OrderQty:     quantity = value; break;
+            case Tag::OrdType:      ord_type = value; break;
+            case Tag::OrigClOrdID:  out.orig_cl_ord_id = value; break;
+            case Tag::Price:        price = value; break;
+            case Tag::SenderCompID: out.sender_comp_id = value; break;
+            case Tag::Side:         side = value; break;
+            case Tag::Symbol:       out.symbol = value; break;
+            case Tag::TargetCompID: out.target_comp_id = value; break;
+            case Tag::TimeInForce:  tif = value; break;
+            case Tag::TransactTime: out.transact_time = value; break;
+            default: break;  // Not used by our subset
         }
-
-        std::string_view field = raw.substr(pos, end - pos);
-        pos = end + 1;
-
-        if (field.empty()) continue;
-
-        // Find '='
-        size_t eq = field.find('=');
-        if (eq == std::string_view::npos || eq == 0) continue;
-
-        int tag_num = parse_int(field.substr(0, eq));
-        if (tag_num < 0) continue;
-
-        std::string_view value = field.substr(eq + 1);
-
-        if (tag_num < static_cast<int>(PRIMARY_SIZE)) {
-            tags[static_cast<size_t>(tag_num)] = value;
+    };
+
+    for (size_t base = 0; base < raw.size(); base += 64) {
+        uint64_t mask = structural_mask(raw.data() + base, raw.size() - base, structurals);
+        while (mask) {
+            const size_t i = base + lowest_bit(mask);
+            mask &= mask - 1;
+            if (raw[i] != delim) {
+                if (eq == NPOS) eq = i;
+                continue;
+            }
+            store_field(i);
+            start = i + 1;
+            eq = NPOS;
         }
-        // Tags >= 201 are not used by our subset
     }
+    if (start < raw.size()) store_field(raw.size());
 
     // --- Extract fields ---
 
-    // Tag 8: BeginString
-    if (!tags[Tag::BeginString].empty()) {
-        msg.begin_string = std::string(tags[Tag::BeginString]);
-    }
-
-    // Tag 9: BodyLength
-    if (!tags[Tag::BodyLength].empty()) {
-        msg.body_length = parse_int(tags[Tag::BodyLength]);
-    }
-
-    // Tag 10: CheckSum
-    if (!tags[Tag::CheckSum].empty()) {
-        msg.checksum = std::string(tags[Tag::CheckSum]);
-    }
+    if (!body_length.empty()) out.body_length = parse_int(body_length);
 
     // Tag 35: MsgType (required)
-    if (tags[Tag::MsgType].empty()) {
-        msg.error = "missing MsgType (tag 35)";
-        return msg;
-    }
-    if (tags[Tag::MsgType].size() != 1) {
-        msg.error = "invalid MsgType: " + std::string(tags[Tag::MsgType]);
-        return msg;
-    }
-    msg.msg_type = tags[Tag::MsgType][0];
-
-    // Validate message type
-    if (msg.msg_type != MsgType::NewOrderSingle &&
-        msg.msg_type != MsgType::OrderCancelRequest &&
-        msg.msg_type != MsgType::OrderCancelReplace &&
-        msg.msg_type != MsgType::ExecutionReport) {
-        msg.error = "unsupported MsgType: " + std::string(1, msg.msg_type);
-        return msg;
-    }
-
-    // Tag 49: SenderCompID
-    if (!tags[Tag::SenderCompID].empty()) {
-        msg.sender_comp_id = std::string(tags[Tag::SenderCompID]);
-    }
-
-    // Tag 56: TargetCompID
-    if (!tags[Tag::TargetCompID].empty()) {
-        msg.target_comp_id = std::string(tags[Tag::TargetCompID]);
+    if (msg_type.empty()) return fail(out, FixError::MissingMsgType);
+    if (msg_type.size() != 1) {
+        out.error_detail = msg_type;
+        return fail(out, FixError::InvalidMsgType);
     }
+    out.msg_type = msg_type[0];
 
-    // Tag 11: ClOrdID
-    if (!tags[Tag::ClOrdID].empty()) {
-        msg.cl_ord_id = std::string(tags[Tag::ClOrdID]);
+    if (out.msg_type != MsgType::NewOrderSingle &&
+        out.msg_type != MsgType::OrderCancelRequest &&
+        out.msg_type != MsgType::OrderCancelReplace &&
+        out.msg_type != MsgType::ExecutionReport) {
+        out.error_detail = msg_type;
+        return fail(out, FixError::UnsupportedMsgType);
     }
 
-    // Tag 41: OrigClOrdID (cancel/replace)
-    if (!tags[Tag::OrigClOrdID].empty()) {
-        msg.orig_cl_ord_id = std::string(tags[Tag::OrigClOrdID]);
-    }
-
-    // Tag 55: Symbol
-    if (!tags[Tag::Symbol].empty()) {
-        msg.symbol = std::string(tags[Tag::Symbol]);
-    }
-
-    // Tag 54: Side
-    if (!tags[Tag::Side].empty() && tags[Tag::Side].size() == 1) {
-        msg.fix_side = tags[Tag::Side][0];
-    }
+    if (side.size() == 1) out.fix_side = side[0];
+    if (ord_type.size() == 1) out.fix_ord_type = ord_type[0];
+    if (tif.size() == 1) out.fix_tif = tif[0];
 
-    // Tag 40: OrdType
-    if (!tags[Tag::OrdType].empty() && tags[Tag::OrdType].size() == 1) {
-        msg.fix_ord_type = tags[Tag::OrdType][0];
-    }
-
-    // Tag 59: TimeInForce
-    if (!tags[Tag::TimeInForce].empty() && tags[Tag::TimeInForce].size() == 1) {
-        msg.fix_tif = tags[Tag::TimeInForce][0];
-    }
-
-    // Tag 44: Price — parse to fixed-point via L3FeedParser
-    if (!tags[Tag::Price].empty()) {
-        msg.price = L3FeedParser::parse_price(tags[Tag::Price]);
-    }
-
-    // Tag 38: OrderQty
-    if (!tags[Tag::OrderQty].empty()) {
-        msg.quantity = L3FeedParser::parse_quantity(tags[Tag::OrderQty]);
-    }
-
-    // Tag 60: TransactTime
-    if (!tags[Tag::TransactTime].empty()) {
-        msg.transact_time = std::string(tags[Tag::TransactTime]);
-    }
+    // Tag 44 / 38: fixed-point via L3FeedParser
+    if (!price.empty()) out.price = L3FeedParser::parse_price(price);
+    if (!quantity.empty()) out.quantity = L3FeedParser::parse_quantity(quantity);
 
     // --- Validate required fields per message type ---
 
-    switch (msg.msg_type) {
+    switch (out.msg_type) {
         case MsgType::NewOrderSingle:
-            if (msg.cl_ord_id.empty()) {
-                msg.error = "NewOrderSingle missing ClOrdID (tag 11)";
-                return msg;
-            }
-            if (msg.fix_side == '\0') {
-                msg.error = "NewOrderSingle missing Side (tag 54)";
-                return msg;
-            }
-            if (msg.fix_ord_type == '\0') {
-                msg.error = "NewOrderSingle missing OrdType (tag 40)";
-                return msg;
-            }
-            if (msg.quantity == 0) {
-                msg.error = "NewOrderSingle missing or zero OrderQty (tag 38)";
-                return msg;
-            }
-            if (msg.symbol.empty()) {
-                msg.error = "NewOrderSingle missing Symbol (tag 55)";
-                return msg;
-            }
+            if (out.cl_ord_id.empty()) return fail(out, FixError::MissingClOrdID);
+            if (out.fix_side == '\0') return fail(out, FixError::MissingSide);
+            if (out.fix_ord_type == '\0') return fail(out, FixError::MissingOrdType);
+            if (out.quantity == 0) return fail(out, FixError::MissingOrderQty);
+            if (out.symbol.empty()) return fail(out, FixError::MissingSymbol);
             // Limit orders require price
-            if (msg.fix_ord_type == OrdTypeValue::Limit && msg.price == 0) {
-                msg.error = "Limit order missing Price (tag 44)";
-                return msg;
+            if (out.fix_ord_type == OrdTypeValue::Limit && out.price == 0) {
+                return fail(out, FixError::MissingPrice);
             }
             break;
 
         case MsgType::OrderCancelRequest:
-            if (msg.cl_ord_id.empty()) {
-                msg.error = "OrderCancelRequest missing ClOrdID (tag 11)";
-                return msg;
-            }
-            if (msg.orig_cl_ord_id.empty()) {
-                msg.error = "OrderCancelRequest missing OrigClOrdID (tag 41)";
-                return msg;
-            }
-            if (msg.symbol.empty()) {
-                msg.error = "OrderCancelRequest missing Symbol (tag 55)";
-                return msg;
-            }
+            if (out.cl_ord_id.empty()) return fail(out, FixError::MissingClOrdID);
+            if (out.orig_cl_ord_id.empty()) return fail(out, FixError::MissingOrigClOrdID);
+            if (out.symbol.empty()) return fail(out, FixError::MissingSymbol);
             break;
 
         case MsgType::OrderCancelReplace:
-            if (msg.cl_ord_id.empty()) {
-                msg.error = "OrderCancelReplace missing ClOrdID (tag 11)";
-                return msg;
-            }
-            if (msg.orig_cl_ord_id.empty()) {
-                msg.error = "OrderCancelReplace missing OrigClOrdID (tag 41)";
-                return msg;
-            }
-            if (msg.fix_side == '\0') {
-                msg.error = "OrderCancelReplace missing Side (tag 54)";
-                return msg;
-            }
-            if (msg.symbol.empty()) {
-                msg.error = "OrderCancelReplace missing Symbol (tag 55)";
-                return msg;
-            }
-            if (msg.fix_ord_type == '\0') {
-                msg.error = "OrderCancelReplace missing OrdType (tag 40)";
-                return msg;
-            }
-            if (msg.quantity == 0) {
-                msg.error = "OrderCancelReplace missing or zero OrderQty (tag 38)";
-                return msg;
-            }
+            if (out.cl_ord_id.empty()) return fail(out, FixError::MissingClOrdID);
+            if (out.orig_cl_ord_id.empty()) return fail(out, FixError::MissingOrigClOrdID);
+            if (out.fix_side == '\0') return fail(out, FixError::MissingSide);
+            if (out.symbol.empty()) return fail(out, FixError::MissingSymbol);
+            if (out.fix_ord_type == '\0') return fail(out, FixError::MissingOrdType);
+            if (out.quantity == 0) return fail(out, FixError::MissingOrderQty);
             break;
 
-        case MsgType::ExecutionReport:
+        default:
             // Execution reports are inbound for the serializer path;
             // we just parse them without strict validation here.
-            // fallthrough
-        default:
             break;
     }
 
     // --- Checksum validation (if tag 10 present) ---
-    if (!msg.checksum.empty()) {
-        if (!validate_checksum(raw)) {
-            msg.error = "checksum mismatch";
-            return msg;
+    // Sum of every byte before "10=", i.e. through the delimiter before it
+    if (!out.checksum.empty()) {
+        const int declared = parse_int(out.checksum);
+        if (tag10_start == 0 || declared < 0 || declared > 255 ||
+            compute_checksum(raw.substr(0, tag10_start)) != static_cast<uint8_t>(declared)) {
+            return fail(out, FixError::ChecksumMismatch);
         }
     }
 
     // --- BodyLength validation (if tag 9 present) ---
-    if (msg.body_length > 0) {
-        // Body starts after "8=...<delim>9=...<delim>" and ends before "10=..."
-        // Find the end of tag 9's value (start of body)
-        std::string tag9_prefix = "9=";
-        size_t tag9_pos = raw.find(tag9_prefix);
-        if (tag9_pos != std::string_view::npos) {
-            size_t body_start = raw.find(delim, tag9_pos);
-            if (body_start != std::string_view::npos) {
-                body_start += 1;  // skip delimiter
-
-                // Find "10=" — body ends just before it
-                std::string tag10_marker = std::string(1, delim) + "10=";
-                size_t tag10_delim = raw.find(tag10_marker, body_start);
-                // Also check if body starts with "10="
-                std::string tag10_start = "10=";
-                if (tag10_delim == std::string_view::npos) {
-                    // Check if raw ends with 10=xxx (no leading delimiter)
-                    size_t bare_10 = raw.find(tag10_start, body_start);
-                    if (bare_10 != std::string_view::npos) {
-                        tag10_delim = bare_10 - 1;  // point to char before '1' in '10='
-                    }
-                }
-
-                if (tag10_delim != std::string_view::npos) {
-                    // Body length = from body_start to tag10_delim (inclusive of delimiter before 10=)
-                    size_t actual_body_len = tag10_delim + 1 - body_start;
-                    if (static_cast<int>(actual_body_len) != msg.body_length) {
-                        msg.error = "BodyLength mismatch: declared " +
-                                    std::to_string(msg.body_length) + ", actual " +
-                                    std::to_string(actual_body_len);
-                        return msg;
-                    }
-                }
-            }
+    // The body runs from after tag 9's delimiter through the delimiter
+    // before "10="
+    if (out.body_length > 0 && body_start != NPOS && tag10_start != NPOS &&
+        tag10_start >= body_start) {
+        out.actual_body_length = static_cast<int>(tag10_start - body_start);
+        if (out.actual_body_length != out.body_length) {
+            return fail(out, FixError::BodyLengthMismatch);
         }
     }
 
-    msg.valid = true;
+    out.valid = true;
+    return true;
+}
+
+FixMessage FixParser::parse(std::string_view raw) {
+    FixMessageView view;
+    parse_view(raw, view);
+
+    FixMessage msg;
+    msg.msg_type = view.msg_type;
+    msg.begin_string = std::string(view.begin_string);
+    msg.sender_comp_id = std::string(view.sender_comp_id);
+    msg.target_comp_id = std::string(view.target_comp_id);
+    msg.cl_ord_id = std::string(view.cl_ord_id);
+    msg.orig_cl_ord_id = std::string(view.orig_cl_ord_id);
+    msg.symbol = std::string(view.symbol);
+    msg.fix_side = view.fix_side;
+    msg.fix_ord_type = view.fix_ord_type;
+    msg.fix_tif = view.fix_tif;
+    msg.price = view.price;
+    msg.quantity = view.quantity;
+    msg.transact_time = std::string(view.transact_time);
+    msg.body_length = view.body_length;
+    msg.checksum = std::string(view.checksum);
+    msg.valid = view.valid;
+    msg.error_code = view.error;
+
+    // Readable error text
+    switch (view.error) {
+        case FixError::None:
+            break;
+        case FixError::InvalidMsgType:
+        case FixError::UnsupportedMsgType:
+            msg.error = std::string(fix_error_text(view.error)) + ": " +
+                        std::string(view.error_detail);
+            break;
+        case FixError::MissingClOrdID:
+        case FixError::MissingOrigClOrdID:
+        case FixError::MissingSide:
+        case FixError::MissingOrdType:
+        case FixError::MissingOrderQty:
+        case FixError::MissingSymbol:
+            msg.error = std::string(msg_type_name(view.msg_type)) + " " +
+                        fix_error_text(view.error);
+            break;
+        case FixError::BodyLengthMismatch:
+            msg.error = std::string(fix_error_text(view.error)) + ": declared " +
+                        std::to_string(view.body_length) + ", actual " +
+                        std::to_string(view.actual_body_length);
+            break;
+        default:
+            msg.error = fix_error_text(view.error);
+            break;
+    }
     return msg;
 }
 
+FixError FixParser::parse_into(std::string_view raw, OrderMessage& out,
+                               InstrumentId id) noexcept {
+    FixMessageView view;
+    if (!parse_view(raw, view)) return view.error;
+    if (view.msg_type == MsgType::ExecutionReport) return FixError::NotAnOrder;
+    out = to_order_message(view, id);
+    return FixError::None;
+}
+
+FixError FixParser::parse_into(std::string_view raw, OrderMessage& out, ClOrdIdTable& ids,
+                               InstrumentId id) noexcept {
+    FixMessageView view;
+    if (!parse_view(raw, view)) return view.error;
+    if (view.msg_type == MsgType::ExecutionReport) return FixError::NotAnOrder;
+    OrderMessage msg = to_order_message(view, id);
+    const FixError error = ids.resolve(view, msg);
+    if (error == FixError::None) out = msg;
+    return error;
+}
+
 OrderMessage FixParser::to_order_message(const FixMessage& msg,
                                           InstrumentId id) {
+    FixMessageView view;
+    view.msg_type = msg.msg_type;
+    view.cl_ord_id = msg.cl_ord_id;
+    view.orig_cl_ord_id = msg.orig_cl_ord_id;
+    view.fix_side = msg.fix_side;
+    view.fix_ord_type = msg.fix_ord_type;
+    view.fix_tif = msg.fix_tif;
+    view.price = msg.price;
+    view.quantity = msg.quantity;
+    return to_order_message(view, id);
+}
+
+OrderMessage FixParser::to_order_message(const FixMessageView& msg,
+                                          InstrumentId id) noexcept {
     OrderMessage om{};
     om.instrument_id = id;
 
@@ -371,6 +361,8 @@ OrderMessage FixParser::to_order_message(const FixMessage& msg,
     om.order.quantity = msg.quantity;
     om.order.visible_quantity = msg.quantity;
     om.order.iceberg_slice_qty = 0;
+    om.order.stop_price = 0;
+    om.order.expire_time = 0;
     om.order.filled_quantity = 0;
     om.order.timestamp = 0;
     om.order.next = nullptr;
@@ -392,7 +384,8 @@ bool FixParser::validate_checksum(std::string_view raw) {
     char delim = detect_delimiter(raw);
 
     // Find "10=" preceded by delimiter (or at very start, unlikely)
-    std::string tag10_with_delim = std::string(1, delim) + "10=";
+    const char marker[] = {delim, '1', '0', '='};
+    const std::string_view tag10_with_delim(marker, sizeof(marker));
     size_t tag10_pos = raw.find(tag10_with_delim);
     size_t checksum_body_end = 0;
 
@@ -11,6 +11,11 @@
 ///   35=D  New Order Single   -> MessageType::Add
 ///   35=F  Order Cancel Request -> MessageType::Cancel
 ///   35=G  Order Cancel/Replace -> MessageType::Modify
+///
+/// parse() returns an owning FixMessage with a readable error. The gateway
+/// path uses parse_view() / parse_into() instead, which allocate nothing:
+/// fields view the caller's buffer and failures are FixError codes. The
+/// order id is a ClOrdID hash unless a session's ClOrdIdTable is given.
 
 #include <string>
 #include <string_view>
@@ -22,18 +27,39 @@
 namespace hft {
 namespace fix {
 
+class ClOrdIdTable;
+
 class FixParser {
 public:
     /// Parse a raw FIX string (SOH or pipe delimited) into a FixMessage.
     /// On failure, the returned FixMessage has valid=false and error set.
     static FixMessage parse(std::string_view raw);
 
+    /// Parse `raw` into `out` without allocating; out's strings view `raw`.
+    /// Returns out.valid (on failure out.error says why).
+    static bool parse_view(std::string_view raw, FixMessageView& out) noexcept;
+
+    /// Parse a 35=D/F/G message straight into `out`. Returns FixError::None
+    /// on success; a valid execution report yields FixError::NotAnOrder.
+    static FixError parse_into(std::string_view raw, OrderMessage& out,
+                               InstrumentId id = DEFAULT_INSTRUMENT_ID) noexcept;
+
+    /// parse_into() with the order id taken from the session's ClOrdID
+    /// bindings (ClOrdIdTable::resolve) instead of a ClOrdID hash.
+    static FixError parse_into(std::string_view raw, OrderMessage& out, ClOrdIdTable& ids,
+                               InstrumentId id = DEFAULT_INSTRUMENT_ID) noexcept;
+
     /// Convert a parsed FixMessage into an OrderMessage for the gateway.
     /// Requires msg.valid == true. Maps D->Add, F->Cancel, G->Modify.
     static OrderMessage to_order_message(
         const FixMessage& msg,
         InstrumentId id = DEFAULT_INSTRUMENT_ID);
 
+    /// to_order_message() of a parsed view.
+    static OrderMessage to_order_message(
+        const FixMessageView& msg,
+        InstrumentId id = DEFAULT_INSTRUMENT_ID) noexcept;
+
     /// Convert pipe-delimited FIX to SOH-delimited.
     static std::string pipe_to_soh(std::string_view pipe_msg);
 
@@ -46,7 +72,8 @@ public:
 
     /// Hash a ClOrdID string to an OrderId using FNV-1a.
     /// Deterministic and reasonably collision-resistant for demo data.
-    /// NOTE: Not suitable for production use — collisions are possible.
+    /// NOTE: Not suitable for production use — collisions are possible;
+    /// sessions use ClOrdIdTable instead.
     static OrderId cl_ord_id_to_order_id(std::string_view cl_ord_id);
 
     /// Map FIX Side char ('1'/'2') to engine Side enum.
@@ -1,10 +1,10 @@
 #include "feed/fix_serializer.h"
 
 #include <cstdint>
-#include <cstdio>
+#include <cstring>
 #include <string>
+#include <utility>
 
-#include "feed/fix_parser.h"
 
 namespace hft {
 namespace fix {
@@ -15,207 +15,299 @@ namespace fix {
 
 static constexpr char SOH = '\x01';
 
-/// Build the FIX message body (tags between 9 and 10).
-static std::string build_body(
-    const EventMessage& event,
-    const std::string& symbol,
-    const std::string& sender,
-    const std::string& target,
-    char delim) {
+/// "00" "01" ... "99"
+static constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/// Decimal digits of v.
+static unsigned digits10(uint64_t v) {
+    unsigned n = 1;
+    for (;;) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
 
-    std::string body;
-    body.reserve(256);
+/// Write v right-aligned in out[0, width), zero-padded (width >= digits10(v)).
+static void write_digits(uint64_t v, unsigned width, char* out) {
+    char* p = out + width;
+    while (v >= 100) {
+        const size_t i = static_cast<size_t>(v % 100) * 2;
+        v /= 100;
+        *--p = DIGIT_PAIRS[i + 1];
+        *--p = DIGIT_PAIRS[i];
+    }
+    if (v >= 10) {
+        const size_t i = static_cast<size_t>(v) * 2;
+        *--p = DIGIT_PAIRS[i + 1];
+        *--p = DIGIT_PAIRS[i];
+    } else {
+        *--p = static_cast<char>('0' + v);
+    }
+    while (p > out) *--p = '0';
+}
 
-    // Tag 35: MsgType = '8' (Execution Report)
-    body += "35=8";
-    body += delim;
+/// |price| split at the decimal point.
+static uint64_t price_magnitude(Price price) {
+    return price < 0 ? 0 - static_cast<uint64_t>(price) : static_cast<uint64_t>(price);
+}
 
-    // Tag 49: SenderCompID
-    body += "49=";
-    body += sender;
-    body += delim;
+/// Length of format_price(price).
+static size_t price_length(Price price) {
+    const uint64_t whole = price_magnitude(price) / PRICE_SCALE;
+    return (price < 0 ? 1 : 0) + digits10(whole) + 1 + 8;
+}
 
-    // Tag 56: TargetCompID
-    body += "56=";
-    body += target;
-    body += delim;
+/// "[-]<int>.<8 digits>" into out; returns its length.
+static size_t write_price(Price price, char* out) {
+    const uint64_t magnitude = price_magnitude(price);
+    const uint64_t whole = magnitude / PRICE_SCALE;
+    const uint64_t frac = magnitude % PRICE_SCALE;
+    char* p = out;
+    if (price < 0) *p++ = '-';
+    const unsigned whole_digits = digits10(whole);
+    write_digits(whole, whole_digits, p);
+    p += whole_digits;
+    *p++ = '.';
+    write_digits(frac, 8, p);
+    return static_cast<size_t>(p + 8 - out);
+}
 
-    // Determine fields from event type
-    char exec_type = FixSerializer::to_fix_exec_type(event.type);
-    char ord_status = FixSerializer::to_fix_ord_status(event.type);
+using Segment = ExecutionReportWriter::Segment;
 
-    if (event.type == EventType::Trade) {
-        const auto& trade = event.data.trade;
+/// `text` with its byte sum (reduced mod 256 only once per report).
+static Segment make_segment(std::string text) {
+    Segment seg;
+    for (char c : text) seg.sum += static_cast<uint8_t>(c);
+    seg.text = std::move(text);
+    return seg;
+}
 
-        // Tag 37: OrderID (use buy_order_id)
-        body += "37=";
-        body += std::to_string(trade.buy_order_id);
-        body += delim;
-
-        // Tag 11: ClOrdID (use sell_order_id as a proxy)
-        body += "11=";
-        body += std::to_string(trade.sell_order_id);
-        body += delim;
-
-        // Tag 17: ExecID
-        body += "17=EXEC-";
-        body += std::to_string(trade.trade_id);
-        body += delim;
-
-        // Tag 150: ExecType
-        body += "150=";
-        body += exec_type;
-        body += delim;
-
-        // Tag 39: OrdStatus
-        body += "39=";
-        body += ord_status;
-        body += delim;
-
-        // Tag 55: Symbol
-        body += "55=";
-        body += symbol;
-        body += delim;
-
-        // Tag 54: Side (Buy side of the trade)
-        body += "54=";
-        body += FixSerializer::to_fix_side(Side::Buy);
-        body += delim;
-
-        // Tag 44: Price
-        body += "44=";
-        body += FixSerializer::format_price(trade.price);
-        body += delim;
-
-        // Tag 32: LastQty
-        body += "32=";
-        body += std::to_string(trade.quantity);
-        body += delim;
-
-        // Tag 31: LastPx
-        body += "31=";
-        body += FixSerializer::format_price(trade.price);
-        body += delim;
-
-        // Tag 14: CumQty
-        body += "14=";
-        body += std::to_string(trade.quantity);
-        body += delim;
-
-        // Tag 151: LeavesQty
-        body += "151=0";
-        body += delim;
-
-        // Tag 60: TransactTime
-        body += "60=";
-        body += std::to_string(trade.timestamp);
-        body += delim;
+namespace {
+
+/// One item of a report: a template segment, a character or a number,
+/// with its rendered length.
+struct Piece {
+    enum Kind : uint8_t { Text, Char, Uint, Px, Bytes } kind;
+    uint32_t length;
+    const Segment* seg;
+    uint64_t value;
+    const char* bytes = nullptr;  // Bytes: `length` of them
+};
+
+/// Output position plus the running checksum of everything written.
+struct Cursor {
+    char* p;
+    uint32_t sum = 0;
+
+    void put(const Segment& seg) {
+        std::memcpy(p, seg.text.data(), seg.text.size());
+        p += seg.text.size();
+        sum += seg.sum;
+    }
 
-    } else {
-        // Order event (Accepted, Cancelled, Rejected, Filled, PartialFill, Modified)
-        const auto& oe = event.data.order_event;
+    void put(char c) {
+        *p++ = c;
+        sum += static_cast<uint8_t>(c);
+    }
+
+    void put_written(size_t n) {
+        for (size_t i = 0; i < n; ++i) sum += static_cast<uint8_t>(p[i]);
+        p += n;
+    }
+
+    void put(const Piece& piece) {
+        switch (piece.kind) {
+            case Piece::Text: put(*piece.seg); break;
+            case Piece::Char: put(static_cast<char>(piece.value)); break;
+            case Piece::Uint:
+                write_digits(piece.value, piece.length, p);
+                put_written(piece.length);
+                break;
+            case Piece::Px:
+                put_written(write_price(static_cast<Price>(piece.value), p));
+                break;
+            case Piece::Bytes:
+                std::memcpy(p, piece.bytes, piece.length);
+                put_written(piece.length);
+                break;
+        }
+    }
+};
 
-        // Tag 37: OrderID
-        body += "37=";
-        body += std::to_string(oe.order_id);
-        body += delim;
-
-        // Tag 11: ClOrdID (same as OrderID for simplicity)
-        body += "11=";
-        body += std::to_string(oe.order_id);
-        body += delim;
-
-        // Tag 17: ExecID
-        body += "17=EXEC-";
-        body += std::to_string(event.sequence_num);
-        body += delim;
-
-        // Tag 150: ExecType
-        body += "150=";
-        body += exec_type;
-        body += delim;
-
-        // Tag 39: OrdStatus
-        body += "39=";
-        body += ord_status;
-        body += delim;
-
-        // Tag 55: Symbol
-        body += "55=";
-        body += symbol;
-        body += delim;
-
-        // Tag 54: Side (not available in OrderEventData; default to Buy)
-        body += "54=1";
-        body += delim;
-
-        // Tag 44: Price
-        body += "44=";
-        body += FixSerializer::format_price(oe.price);
-        body += delim;
-
-        // Tag 38: OrderQty (use filled + remaining as proxy for original qty)
-        body += "38=";
-        body += std::to_string(oe.filled_quantity + oe.remaining_quantity);
-        body += delim;
-
-        // Tag 14: CumQty
-        body += "14=";
-        body += std::to_string(oe.filled_quantity);
-        body += delim;
-
-        // Tag 151: LeavesQty
-        body += "151=";
-        body += std::to_string(oe.remaining_quantity);
-        body += delim;
-
-        // Tag 60: TransactTime
-        body += "60=";
-        body += std::to_string(oe.timestamp);
-        body += delim;
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// ExecutionReportWriter
+// ---------------------------------------------------------------------------
+
+ExecutionReportWriter::ExecutionReportWriter(std::string_view symbol,
+                                             std::string_view sender,
+                                             std::string_view target,
+                                             char delim)
+    : delim_(delim) {
+    const std::string d(1, delim);
+    begin_ = make_segment("8=FIX.4.2" + d + "9=");
+    session_ = make_segment(d + "35=8" + d + "49=" + std::string(sender) + d +
+                            "56=" + std::string(target) + d + "37=");
+    cl_ord_id_ = make_segment(d + "11=");
+    exec_id_ = make_segment(d + "17=EXEC-");
+    exec_type_ = make_segment(d + "150=");
+    ord_status_ = make_segment(d + "39=");
+    symbol_ = make_segment(d + "55=" + std::string(symbol) + d + "54=1" + d + "44=");
+    last_qty_ = make_segment(d + "32=");
+    last_px_ = make_segment(d + "31=");
+    order_qty_ = make_segment(d + "38=");
+    cum_qty_ = make_segment(d + "14=");
+    no_leaves_ = make_segment(d + "151=0" + d + "60=");
+    leaves_qty_ = make_segment(d + "151=");
+    time_ = make_segment(d + "60=");
+    trailer_ = make_segment("10=");
+
+    // Every segment once, plus the widest values: BodyLength and six
+    // integers (20 digits), the ClOrdID, two prices (29 bytes), two flag
+    // characters, the closing delimiter and the 4-byte checksum value
+    max_report_bytes_ = 0;
+    for (const Segment* seg : {&begin_, &session_, &cl_ord_id_, &exec_id_, &exec_type_,
+                               &ord_status_, &symbol_, &last_qty_, &last_px_, &order_qty_,
+                               &cum_qty_, &no_leaves_, &leaves_qty_, &time_, &trailer_}) {
+        max_report_bytes_ += seg->text.size();
     }
+    max_report_bytes_ += 7 * 20 + MAX_CL_ORD_ID + 2 * 29 + 2 + 1 + 4;
+}
 
-    return body;
+size_t ExecutionReportWriter::write(const EventMessage& event, char* out,
+                                    size_t capacity) const noexcept {
+    return write_report(event, 0, {}, out, capacity);
 }
 
-/// Wrap body with BeginString, BodyLength, and CheckSum.
-static std::string wrap_message(const std::string& body, char delim) {
-    // Tag 8 and 9 prefix
-    std::string prefix;
-    prefix += "8=FIX.4.2";
-    prefix += delim;
-    prefix += "9=";
-    prefix += std::to_string(body.size());
-    prefix += delim;
-
-    // Compute checksum over prefix + body
-    std::string pre_checksum = prefix + body;
-    uint8_t cs = FixParser::compute_checksum(pre_checksum);
-
-    // Format checksum as 3-digit zero-padded
-    char cs_buf[4];
-    std::snprintf(cs_buf, sizeof(cs_buf), "%03u", static_cast<unsigned>(cs));
-
-    std::string result = pre_checksum;
-    result += "10=";
-    result += cs_buf;
-    result += delim;
-
-    return result;
+size_t ExecutionReportWriter::write(const EventMessage& event, OrderId order_id,
+                                    std::string_view cl_ord_id, char* out,
+                                    size_t capacity) const noexcept {
+    if (cl_ord_id.size() > MAX_CL_ORD_ID) return 0;
+    return write_report(event, order_id, cl_ord_id, out, capacity);
+}
+
+size_t ExecutionReportWriter::write_report(const EventMessage& event, OrderId order_id,
+                                           std::string_view cl_ord_id, char* out,
+                                           size_t capacity) const noexcept {
+    if (capacity < max_report_bytes_) return 0;
+
+    Piece pieces[24];
+    size_t count = 0;
+    size_t body_length = 0;
+    auto add = [&](Piece::Kind kind, size_t length, const Segment* seg, uint64_t value) {
+        pieces[count++] = {kind, static_cast<uint32_t>(length), seg, value};
+        body_length += length;
+    };
+    auto text = [&](const Segment& seg) { add(Piece::Text, seg.text.size(), &seg, 0); };
+    auto chr = [&](char c) { add(Piece::Char, 1, nullptr, static_cast<uint8_t>(c)); };
+    auto num = [&](uint64_t v) { add(Piece::Uint, digits10(v), nullptr, v); };
+    auto px = [&](Price p) {
+        add(Piece::Px, price_length(p), nullptr, static_cast<uint64_t>(p));
+    };
+    auto bytes = [&](std::string_view b) {
+        add(Piece::Bytes, b.size(), nullptr, 0);
+        pieces[count - 1].bytes = b.data();
+    };
+
+    text(session_);
+    if (!cl_ord_id.empty()) {
+        num(order_id);               // 37: the session's order
+        text(cl_ord_id_);
+        bytes(cl_ord_id);            // 11: as the client named it
+        text(exec_id_);
+        num(event.type == EventType::Trade ? event.data.trade.trade_id
+                                           : event.sequence_num);
+    } else if (event.type == EventType::Trade) {
+        const auto& trade = event.data.trade;
+        num(trade.buy_order_id);     // 37: OrderID (buy side)
+        text(cl_ord_id_);
+        num(trade.sell_order_id);    // 11: ClOrdID (sell side as a proxy)
+        text(exec_id_);
+        num(trade.trade_id);
+    } else {
+        const auto& oe = event.data.order_event;
+        num(oe.order_id);
+        text(cl_ord_id_);
+        num(oe.order_id);            // ClOrdID = OrderID for simplicity
+        text(exec_id_);
+        num(event.sequence_num);
+    }
+    text(exec_type_);
+    chr(FixSerializer::to_fix_exec_type(event.type));
+    text(ord_status_);
+    chr(FixSerializer::to_fix_ord_status(event.type));
+    text(symbol_);                   // Side is not in the event; always Buy
+    if (event.type == EventType::Trade) {
+        const auto& trade = event.data.trade;
+        px(trade.price);
+        text(last_qty_);
+        num(trade.quantity);
+        text(last_px_);
+        px(trade.price);
+        text(cum_qty_);
+        num(trade.quantity);
+        text(no_leaves_);
+        num(trade.timestamp);
+    } else {
+        const auto& oe = event.data.order_event;
+        px(oe.price);
+        text(order_qty_);            // Filled + remaining as the original qty
+        num(oe.filled_quantity + oe.remaining_quantity);
+        text(cum_qty_);
+        num(oe.filled_quantity);
+        text(leaves_qty_);
+        num(oe.remaining_quantity);
+        text(time_);
+        num(oe.timestamp);
+    }
+    chr(delim_);
+
+    // BodyLength runs from after the "9=" field's delimiter (the first
+    // byte of session_) through the delimiter before "10="
+    body_length -= 1;
+
+    Cursor cursor{out};
+    cursor.put(begin_);
+    cursor.put(Piece{Piece::Uint, digits10(body_length), nullptr, body_length});
+    for (size_t i = 0; i < count; ++i) cursor.put(pieces[i]);
+
+    const uint32_t checksum = cursor.sum % 256;
+    cursor.put(trailer_);
+    write_digits(checksum, 3, cursor.p);
+    cursor.p += 3;
+    *cursor.p++ = delim_;
+    return static_cast<size_t>(cursor.p - out);
 }
 
 // ---------------------------------------------------------------------------
 // FixSerializer — public API
 // ---------------------------------------------------------------------------
 
+/// One report through a writer built for this call.
+static std::string render(const EventMessage& event, const std::string& symbol,
+                          const std::string& sender, const std::string& target,
+                          char delim) {
+    const ExecutionReportWriter writer(symbol, sender, target, delim);
+    std::string out(writer.max_report_bytes(), '\0');
+    out.resize(writer.write(event, &out[0], out.size()));
+    return out;
+}
+
 std::string FixSerializer::to_execution_report(
     const EventMessage& event,
     const std::string& symbol,
     const std::string& sender,
     const std::string& target) {
 
-    std::string body = build_body(event, symbol, sender, target, SOH);
-    return wrap_message(body, SOH);
+    return render(event, symbol, sender, target, SOH);
 }
 
 std::string FixSerializer::to_execution_report_pretty(
@@ -224,8 +316,7 @@ std::string FixSerializer::to_execution_report_pretty(
     const std::string& sender,
     const std::string& target) {
 
-    std::string body = build_body(event, symbol, sender, target, '|');
-    return wrap_message(body, '|');
+    return render(event, symbol, sender, target, '|');
 }
 
 char FixSerializer::to_fix_side(Side side) {
@@ -263,26 +354,8 @@ char FixSerializer::to_fix_ord_status(EventType type) {
 }
 
 std::string FixSerializer::format_price(Price price) {
-    if (price == 0) return "0.00000000";
-
-    bool negative = (price < 0);
-    int64_t abs_price = negative ? -price : price;
-
-    int64_t integer_part = abs_price / PRICE_SCALE;
-    int64_t frac_part = abs_price % PRICE_SCALE;
-
-    // Format fractional part as 8 digits with leading zeros
-    std::string frac_str = std::to_string(frac_part);
-    while (frac_str.size() < 8) {
-        frac_str.insert(frac_str.begin(), '0');
-    }
-
-    std::string result;
-    if (negative) result += "-";
-    result += std::to_string(integer_part);
-    result += ".";
-    result += frac_str;
-    return result;
+    char buf[32];
+    return std::string(buf, write_price(price, buf));
 }
 
 }  // namespace fix
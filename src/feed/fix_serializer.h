@@ -6,8 +6,17 @@
 /// Cold-path component. Converts the engine's internal EventMessage (Trade,
 /// OrderAccepted, OrderCancelled, etc.) into FIX 4.2 Execution Report
 /// messages (35=8) for downstream consumers.
+///
+/// ExecutionReportWriter is the per-session fast path: the session's
+/// constant segments (header, CompIDs, symbol) are rendered once with
+/// their checksum contributions, and each report is written straight into
+/// a caller-owned buffer (e.g. a send ring slot) with no allocation. The
+/// std::string functions below are built on it and produce the same bytes.
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "core/types.h"
 #include "feed/fix_message.h"
@@ -16,6 +25,66 @@
 namespace hft {
 namespace fix {
 
+/// Pre-rendered ExecutionReport templates for one FIX session.
+///
+/// Usage:
+///   ExecutionReportWriter writer("BTCUSDT", "HFT-ENGINE", "CLIENT-7");
+///   char* slot = ring.reserve(writer.max_report_bytes());
+///   size_t n = writer.write(event, slot, writer.max_report_bytes());
+///   ring.commit(n);
+class ExecutionReportWriter {
+public:
+    explicit ExecutionReportWriter(std::string_view symbol = "N/A",
+                                   std::string_view sender = "HFT-ENGINE",
+                                   std::string_view target = "CLIENT",
+                                   char delim = '\x01');
+
+    /// Longest ClOrdID write() echoes.
+    static constexpr size_t MAX_CL_ORD_ID = 32;
+
+    /// Upper bound on the size of any report this writer produces.
+    [[nodiscard]] size_t max_report_bytes() const { return max_report_bytes_; }
+
+    /// Write the ExecutionReport for `event` to out[0, capacity). Returns
+    /// its length, or 0 if capacity < max_report_bytes().
+    size_t write(const EventMessage& event, char* out, size_t capacity) const noexcept;
+
+    /// write() for one order of the session (for a Trade, either side):
+    /// tag 37 is `order_id` and tag 11 echoes `cl_ord_id` (non-empty, at
+    /// most MAX_CL_ORD_ID bytes, else 0 is returned).
+    size_t write(const EventMessage& event, OrderId order_id, std::string_view cl_ord_id,
+                 char* out, size_t capacity) const noexcept;
+
+    /// A string of `text` and its checksum contribution.
+    struct Segment {
+        std::string text;
+        uint32_t sum = 0;
+    };
+
+private:
+    size_t write_report(const EventMessage& event, OrderId order_id,
+                        std::string_view cl_ord_id, char* out,
+                        size_t capacity) const noexcept;
+
+    Segment begin_;       // "8=FIX.4.2<d>9="
+    Segment session_;     // "<d>35=8<d>49=S<d>56=T<d>37="
+    Segment cl_ord_id_;   // "<d>11="
+    Segment exec_id_;     // "<d>17=EXEC-"
+    Segment exec_type_;   // "<d>150="
+    Segment ord_status_;  // "<d>39="
+    Segment symbol_;      // "<d>55=SYM<d>54=1<d>44="
+    Segment last_qty_;    // "<d>32="
+    Segment last_px_;     // "<d>31="
+    Segment order_qty_;   // "<d>38="
+    Segment cum_qty_;     // "<d>14="
+    Segment no_leaves_;   // "<d>151=0<d>60="
+    Segment leaves_qty_;  // "<d>151="
+    Segment time_;        // "<d>60="
+    Segment trailer_;     // "10="
+    char delim_;
+    size_t max_report_bytes_;
+};
+
 class FixSerializer {
 public:
     /// Serialize an EventMessage to a FIX 4.2 Execution Report (SOH-delimited).
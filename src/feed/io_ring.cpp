@@ -0,0 +1,215 @@
+#include "feed/io_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace hft {
+namespace fix {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static int sys_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                      flags, nullptr, 0));
+}
+
+static int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+static std::string errno_text(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+// ---------------------------------------------------------------------------
+// Setup / teardown
+// ---------------------------------------------------------------------------
+
+bool IoRing::open(unsigned entries, std::string& error) {
+    close();
+
+    // Single issuer + deferred task work keeps completion processing on
+    // the I/O thread, inside its own io_uring_enter(); older kernels
+    // refuse the flags with EINVAL and get a plain ring.
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER |
+                   IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_R_DISABLED;
+    params.cq_entries = std::max(entries, 16u) * 4;
+    fd_ = sys_setup(entries, &params);
+    if (fd_ < 0 && errno == EINVAL) {
+        params = io_uring_params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = std::max(entries, 16u) * 4;
+        fd_ = sys_setup(entries, &params);
+    }
+    if (fd_ < 0) {
+        error = errno_text("io_uring_setup");
+        return false;
+    }
+    disabled_ = (params.flags & IORING_SETUP_R_DISABLED) != 0;
+    deferred_ = (params.flags & IORING_SETUP_DEFER_TASKRUN) != 0;
+
+    sq_map_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) sq_map_bytes_ = cq_map_bytes_ = std::max(sq_map_bytes_, cq_map_bytes_);
+
+    sq_map_ = ::mmap(nullptr, sq_map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED) {
+        sq_map_ = nullptr;
+        error = errno_text("mmap(sq ring)");
+        close();
+        return false;
+    }
+    if (single_mmap) {
+        cq_map_ = sq_map_;
+    } else {
+        cq_map_ = ::mmap(nullptr, cq_map_bytes_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_map_ == MAP_FAILED) {
+            cq_map_ = nullptr;
+            error = errno_text("mmap(cq ring)");
+            close();
+            return false;
+        }
+    }
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        error = errno_text("mmap(sqes)");
+        close();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_map_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    // SQE i always sits at array index i
+    auto* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) array[i] = i;
+    sqe_head_ = sqe_tail_ = *sq_tail_;
+
+    char* cq = static_cast<char*>(cq_map_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+void IoRing::close() noexcept {
+    if (sqes_ != nullptr) ::munmap(sqes_, sqes_bytes_);
+    if (cq_map_ != nullptr && cq_map_ != sq_map_) ::munmap(cq_map_, cq_map_bytes_);
+    if (sq_map_ != nullptr) ::munmap(sq_map_, sq_map_bytes_);
+    if (fd_ >= 0) ::close(fd_);
+    if (buf_ring_ != nullptr) ::munmap(buf_ring_, buf_ring_bytes_);
+    sqes_ = nullptr;
+    sq_map_ = cq_map_ = nullptr;
+    buf_ring_ = nullptr;
+    fd_ = -1;
+    disabled_ = deferred_ = false;
+}
+
+bool IoRing::enable() noexcept {
+    if (!disabled_) return true;
+    if (sys_register(fd_, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0) return false;
+    disabled_ = false;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Buffers
+// ---------------------------------------------------------------------------
+
+bool IoRing::register_buffers(const iovec* buffers, unsigned count) noexcept {
+    return sys_register(fd_, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+}
+
+bool IoRing::register_buffer_ring(uint16_t group, char* base, size_t buffer_bytes,
+                                  uint16_t count) {
+    if (count == 0 || (count & (count - 1)) != 0) return false;
+    buf_ring_bytes_ = static_cast<size_t>(count) * sizeof(io_uring_buf);
+    void* ring = ::mmap(nullptr, buf_ring_bytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return false;
+    buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (sys_register(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        ::munmap(buf_ring_, buf_ring_bytes_);
+        buf_ring_ = nullptr;
+        return false;
+    }
+    buf_base_ = base;
+    buf_bytes_ = buffer_bytes;
+    buf_mask_ = static_cast<uint16_t>(count - 1);
+    buf_tail_ = 0;
+    for (uint16_t bid = 0; bid < count; ++bid) recycle_buffer(bid);
+    publish_buffers();
+    return true;
+}
+
+void IoRing::recycle_buffer(uint16_t bid) noexcept {
+    // The ring is an array of io_uring_buf whose first entry's last field
+    // doubles as the tail; index it directly, since <linux/io_uring.h>
+    // offsets `bufs` by 8 bytes when compiled as C++
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(buf_ring_)[buf_tail_ & buf_mask_];
+    buf.addr = reinterpret_cast<uint64_t>(buf_base_ + static_cast<size_t>(bid) * buf_bytes_);
+    buf.len = static_cast<uint32_t>(buf_bytes_);
+    buf.bid = bid;
+    ++buf_tail_;
+}
+
+void IoRing::publish_buffers() noexcept {
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+// ---------------------------------------------------------------------------
+// Submission
+// ---------------------------------------------------------------------------
+
+io_uring_sqe* IoRing::get_sqe() noexcept {
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) return nullptr;
+    io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ++sqe_tail_;
+    return sqe;
+}
+
+int IoRing::submit(unsigned wait_for) noexcept {
+    const unsigned to_submit = sqe_tail_ - sqe_head_;
+    if (to_submit > 0) {
+        __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+        sqe_head_ = sqe_tail_;
+    }
+    // Deferred task work only runs (and posts completions) on GETEVENTS
+    unsigned flags = 0;
+    if (wait_for > 0 || deferred_) flags |= IORING_ENTER_GETEVENTS;
+    if (to_submit == 0 && flags == 0) return 0;
+    const int rc = sys_enter(fd_, to_submit, wait_for, flags);
+    if (rc < 0) return errno == EINTR ? 0 : -errno;
+    return rc;
+}
+
+}  // namespace fix
+}  // namespace hft
@@ -0,0 +1,138 @@
+#pragma once
+
+/// @file io_ring.h
+/// @brief Minimal io_uring wrapper over the raw system calls.
+///
+/// Cold-path component for OrderEntryServer. It sets up one ring, maps its
+/// submission and completion queues, and exposes exactly what a single
+/// I/O thread needs: SQE acquisition, one io_uring_enter() per loop
+/// iteration (submit and optionally wait), completion iteration,
+/// registered (fixed) buffers and provided-buffer rings for multishot
+/// receive. No liburing dependency: only <linux/io_uring.h>.
+///
+/// The ring is created disabled, single-issuer and with deferred task
+/// work where the kernel supports it (6.1+), falling back to a plain ring
+/// otherwise. Buffers are registered from the creating thread; the I/O
+/// thread then calls enable() before its first submission.
+///
+/// Usage:
+///   IoRing ring;
+///   if (!ring.open(256, error)) { ... }
+///   ring.enable();                      // On the thread that submits
+///   io_uring_sqe* sqe = ring.get_sqe(); // Fill, set user_data
+///   ring.submit(1);                     // Submit and wait for one
+///   ring.for_each_cqe([](const io_uring_cqe& cqe) { ... });
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+namespace hft {
+namespace fix {
+
+class IoRing {
+public:
+    IoRing() = default;
+    ~IoRing() { close(); }
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    /// Create the ring with at least `entries` submission slots and a
+    /// completion queue four times that (multishot requests post many
+    /// completions per submission).
+    /// Returns false with `error` set on failure (kernel without io_uring,
+    /// or io_uring disabled by sysctl / seccomp).
+    [[nodiscard]] bool open(unsigned entries, std::string& error);
+
+    /// Unmap and close. Idempotent; in-flight requests are cancelled by
+    /// the kernel.
+    void close() noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return fd_ >= 0; }
+
+    /// Enable a ring opened disabled; call on the submitting thread before
+    /// its first submit(). No-op if it was not disabled.
+    [[nodiscard]] bool enable() noexcept;
+
+    /// Register `count` fixed buffers (IORING_OP_{READ,WRITE}_FIXED
+    /// address into them by buf_index).
+    [[nodiscard]] bool register_buffers(const iovec* buffers, unsigned count) noexcept;
+
+    /// Register a provided-buffer ring for group `group`: `count` (a power
+    /// of two) buffers of `buffer_bytes` each, carved from `base`. All of
+    /// them are handed to the kernel at once.
+    [[nodiscard]] bool register_buffer_ring(uint16_t group, char* base, size_t buffer_bytes,
+                                            uint16_t count);
+
+    /// Hand provided buffer `bid` back to the kernel. Recycled buffers
+    /// become visible at the next publish_buffers().
+    void recycle_buffer(uint16_t bid) noexcept;
+    void publish_buffers() noexcept;
+
+    /// Next free SQE, zeroed, or nullptr if the submission queue is full
+    /// (call submit(0) and retry).
+    [[nodiscard]] io_uring_sqe* get_sqe() noexcept;
+
+    /// Submit queued SQEs and wait for at least `wait_for` completions.
+    /// Returns the number submitted, or -errno (EINTR is reported as 0).
+    int submit(unsigned wait_for) noexcept;
+
+    /// Queued SQEs not yet submitted.
+    [[nodiscard]] unsigned pending() const noexcept { return sqe_tail_ - sqe_head_; }
+
+    /// Call `f(const io_uring_cqe&)` for every completion posted so far and
+    /// release them. Returns how many there were.
+    template <typename F>
+    unsigned for_each_cqe(F&& f) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        const unsigned count = tail - head;
+        for (; head != tail; ++head) f(cqes_[head & cq_mask_]);
+        __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    /// Whether the ring runs deferred task work (completions are only
+    /// posted inside submit()).
+    [[nodiscard]] bool deferred_taskrun() const noexcept { return deferred_; }
+
+private:
+    int fd_ = -1;
+    bool disabled_ = false;
+    bool deferred_ = false;
+
+    // Submission queue
+    void* sq_map_ = nullptr;
+    size_t sq_map_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_bytes_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sqe_head_ = 0;   // Oldest SQE not yet handed to the kernel
+    unsigned sqe_tail_ = 0;   // Next SQE to fill
+
+    // Completion queue (shares sq_map_ with IORING_FEAT_SINGLE_MMAP)
+    void* cq_map_ = nullptr;
+    size_t cq_map_bytes_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    // Provided-buffer ring (one group)
+    io_uring_buf_ring* buf_ring_ = nullptr;
+    size_t buf_ring_bytes_ = 0;
+    char* buf_base_ = nullptr;
+    size_t buf_bytes_ = 0;
+    uint16_t buf_mask_ = 0;
+    uint16_t buf_tail_ = 0;   // Local tail; published by publish_buffers()
+};
+
+}  // namespace fix
+}  // namespace hft
@@ -0,0 +1,152 @@
+#include "feed/l3_binary_format.h"
+
+#include <cstring>
+#include <limits>
+
+namespace hft {
+
+bool is_l3_binary_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(L3_BINARY_MAGIC)] = {};
+    if (!file.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, L3_BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// L3BinaryWriter
+// ---------------------------------------------------------------------------
+
+L3BinaryWriter::~L3BinaryWriter() {
+    if (file_.is_open()) (void)close();
+}
+
+bool L3BinaryWriter::open(const std::string& path) {
+    if (file_.is_open()) (void)close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) return false;
+
+    header_ = {};
+    std::memcpy(header_.magic, L3_BINARY_MAGIC, sizeof(header_.magic));
+    header_.version = L3_BINARY_VERSION;
+    header_.record_size = sizeof(L3BinaryRecord);
+    header_.price_scale = PRICE_SCALE;
+    header_.records_offset = sizeof(L3BinaryHeader);
+    last_timestamp_ = 0;
+    first_ = true;
+    last_symbol_ = 0;
+    symbols_.clear();
+    symbol_ids_.clear();
+
+    // Placeholder; close() rewrites it with the final counts
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    return static_cast<bool>(file_);
+}
+
+bool L3BinaryWriter::append(const L3BinaryRecord& record) {
+    file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    ++header_.record_count;
+    return static_cast<bool>(file_);
+}
+
+bool L3BinaryWriter::write(const L3Record& record) {
+    if (!file_.is_open() || !record.valid) return false;
+
+    L3BinaryRecord out{};
+    out.symbol_id = L3_BINARY_NO_SYMBOL;
+    if (!record.symbol.empty()) {
+        // Rows of one symbol cluster: skip the hash when it repeats
+        if (last_symbol_ < symbols_.size() && symbols_[last_symbol_] == record.symbol) {
+            out.symbol_id = static_cast<uint16_t>(last_symbol_);
+        } else {
+            std::string symbol(record.symbol);
+            auto it = symbol_ids_.find(symbol);
+            if (it == symbol_ids_.end()) {
+                if (symbols_.size() >= L3_BINARY_NO_SYMBOL) return false;
+                it = symbol_ids_.emplace(symbol, static_cast<uint16_t>(symbols_.size())).first;
+                symbols_.push_back(std::move(symbol));
+            }
+            out.symbol_id = it->second;
+            last_symbol_ = it->second;
+        }
+    }
+
+    if (first_) {
+        header_.base_timestamp = record.timestamp;
+        last_timestamp_ = record.timestamp;
+        first_ = false;
+    } else if (record.timestamp < last_timestamp_ ||
+               record.timestamp - last_timestamp_ >
+                   std::numeric_limits<uint32_t>::max()) {
+        L3BinaryRecord rebase{};
+        rebase.order_id = record.timestamp;
+        rebase.event_type = L3_BINARY_TIME_BASE;
+        rebase.symbol_id = L3_BINARY_NO_SYMBOL;
+        if (!append(rebase)) return false;
+        last_timestamp_ = record.timestamp;
+    }
+
+    out.order_id = record.order_id;
+    out.price = record.price;
+    out.quantity = record.quantity;
+    out.timestamp_delta = static_cast<uint32_t>(record.timestamp - last_timestamp_);
+    out.event_type = static_cast<uint8_t>(record.event_type);
+    out.side = static_cast<uint8_t>(record.side);
+    last_timestamp_ = record.timestamp;
+    return append(out);
+}
+
+bool L3BinaryWriter::close() {
+    if (!file_.is_open()) return false;
+
+    header_.symbol_table_offset =
+        header_.records_offset + header_.record_count * sizeof(L3BinaryRecord);
+    header_.symbol_count = static_cast<uint32_t>(symbols_.size());
+    for (const std::string& symbol : symbols_) {
+        const auto len = static_cast<uint16_t>(symbol.size());
+        file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        file_.write(symbol.data(), len);
+    }
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    const bool ok = static_cast<bool>(file_);
+    file_.close();
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// CSV conversion
+// ---------------------------------------------------------------------------
+
+L3ConvertStats convert_l3_csv_to_binary(const std::string& csv_path,
+                                        const std::string& binary_path) {
+    L3ConvertStats stats;
+    L3FeedParser parser;
+    if (!parser.open(csv_path)) return stats;
+    L3BinaryWriter writer;
+    if (!writer.open(binary_path)) return stats;
+
+    stats.csv_bytes = parser.file_size();
+    L3Record record;
+    bool ok = true;
+    while (parser.next(record)) {
+        ++stats.rows_read;
+        if (!record.valid) {
+            ++stats.rows_skipped;
+            continue;
+        }
+        if (!writer.write(record)) {
+            ok = false;
+            break;
+        }
+    }
+    stats.records_written = writer.record_count();
+    stats.symbol_count = writer.symbol_count();
+    ok = writer.close() && ok;
+
+    std::ifstream out(binary_path, std::ios::binary | std::ios::ate);
+    stats.binary_bytes = out ? static_cast<uint64_t>(out.tellg()) : 0;
+    stats.ok = ok;
+    return stats;
+}
+
+}  // namespace hft
@@ -0,0 +1,136 @@
+#pragma once
+
+/// @file l3_binary_format.h
+/// @brief Fixed-width binary L3 capture format, and the writer / CSV
+///        converter that produce it.
+///
+/// Cold-path component. Re-parsing decimal CSV costs more than matching
+/// it, so research runs that replay the same day many times convert it
+/// once (`replay --input day.csv --convert day.l3b`) and replay the
+/// binary file. L3FeedParser::open() recognises the magic and then yields
+/// the same L3Records straight from the mapped pages: no text, no decimal
+/// conversion, no symbol lookups.
+///
+/// Layout (little-endian, as written by the host):
+///   L3BinaryHeader      64 bytes
+///   L3BinaryRecord[]    32 bytes each, record_count of them
+///   symbol dictionary   per symbol: uint16_t length, then the bytes,
+///                       in symbol_id order, at symbol_table_offset
+///
+/// Timestamps are stored as the delta from the previous record. A gap that
+/// does not fit 32 bits (about 4.3 s in nanoseconds) is preceded by a
+/// TimeBase record carrying the absolute timestamp. Prices are fixed-point
+/// at the header's price_scale; the reader rescales if that differs from
+/// PRICE_SCALE. Only valid records are written.
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "feed/l3_feed_parser.h"
+
+namespace hft {
+
+/// First 8 bytes of every binary L3 file.
+constexpr char L3_BINARY_MAGIC[8] = {'H', 'F', 'T', 'L', '3', 'B', 'I', 'N'};
+constexpr uint32_t L3_BINARY_VERSION = 1;
+
+struct L3BinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;          // sizeof(L3BinaryRecord)
+    int64_t price_scale;           // Fixed-point scale of record prices
+    uint64_t record_count;         // TimeBase records included
+    uint64_t base_timestamp;       // Timestamp the first delta applies to
+    uint64_t records_offset;       // = sizeof(L3BinaryHeader)
+    uint64_t symbol_table_offset;
+    uint32_t symbol_count;         // 0 = single-instrument file
+    uint32_t reserved;
+};
+
+static_assert(sizeof(L3BinaryHeader) == 64, "L3BinaryHeader must be 64 bytes");
+
+/// L3BinaryRecord::event_type of a record that only rebases the clock
+/// (order_id holds the absolute timestamp).
+constexpr uint8_t L3_BINARY_TIME_BASE = 0xFE;
+/// L3BinaryRecord::symbol_id of a record without a symbol.
+constexpr uint16_t L3_BINARY_NO_SYMBOL = 0xFFFF;
+
+struct L3BinaryRecord {
+    OrderId order_id;
+    Price price;
+    Quantity quantity;
+    uint32_t timestamp_delta;  // From the previous record
+    uint8_t event_type;        // L3EventType, or L3_BINARY_TIME_BASE
+    uint8_t side;              // Side
+    uint16_t symbol_id;        // Dictionary index, or L3_BINARY_NO_SYMBOL
+};
+
+static_assert(sizeof(L3BinaryRecord) == 32, "L3BinaryRecord must be 32 bytes");
+
+/// Whether `path` starts with L3_BINARY_MAGIC.
+bool is_l3_binary_file(const std::string& path);
+
+/// Streams valid L3Records into a binary L3 file.
+///
+/// Usage:
+///   L3BinaryWriter writer;
+///   writer.open("day.l3b");
+///   while (parser.next(record)) if (record.valid) writer.write(record);
+///   writer.close();  // Writes the dictionary and final header
+class L3BinaryWriter {
+public:
+    L3BinaryWriter() = default;
+    ~L3BinaryWriter();
+
+    L3BinaryWriter(const L3BinaryWriter&) = delete;
+    L3BinaryWriter& operator=(const L3BinaryWriter&) = delete;
+
+    /// Create (truncate) `path`. Returns false if it cannot be written.
+    bool open(const std::string& path);
+
+    /// Append one valid record. Returns false on a write error or when the
+    /// dictionary is full (65535 symbols).
+    bool write(const L3Record& record);
+
+    /// Write the symbol dictionary and header, and close the file.
+    /// Returns false on a write error.
+    bool close();
+
+    /// Records written so far (TimeBase records included).
+    [[nodiscard]] uint64_t record_count() const { return header_.record_count; }
+    [[nodiscard]] size_t symbol_count() const { return symbols_.size(); }
+
+private:
+    bool append(const L3BinaryRecord& record);
+
+    std::ofstream file_;
+    L3BinaryHeader header_{};
+    Timestamp last_timestamp_ = 0;
+    bool first_ = true;
+    size_t last_symbol_ = 0;
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, uint16_t> symbol_ids_;
+};
+
+/// Result of convert_l3_csv_to_binary().
+struct L3ConvertStats {
+    bool ok = false;
+    uint64_t rows_read = 0;        // Data rows (headers and blanks excluded)
+    uint64_t rows_skipped = 0;     // Invalid rows, not written
+    uint64_t records_written = 0;
+    size_t symbol_count = 0;
+    uint64_t csv_bytes = 0;
+    uint64_t binary_bytes = 0;
+};
+
+/// Convert an L3 CSV file (6- or 7-column) to the binary format.
+L3ConvertStats convert_l3_csv_to_binary(const std::string& csv_path,
+                                        const std::string& binary_path);
+
+}  // namespace hft
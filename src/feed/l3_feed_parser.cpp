@@ -1,52 +1,346 @@
 #include "feed/l3_feed_parser.h"
 
 #include <algorithm>
-#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFT_L3_MMAP 1
+#endif
+
+#include "feed/compressed_input.h"
+#include "feed/l3_binary_format.h"
+#include "feed/structural_scanner.h"
 
 namespace hft {
 
+namespace {
+
+/// Case-insensitive match of `str` against an upper-case ASCII literal.
+bool iequals(std::string_view str, std::string_view upper) {
+    if (str.size() != upper.size()) return false;
+    for (size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        if (c != upper[i]) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Parallel ingestion state
+// ---------------------------------------------------------------------------
+//
+// Chunk k is parsed into slot k % slots.size(). A worker claims the next
+// chunk index, waits until its slot has been released for that chunk,
+// parses without the lock and marks the slot ready; next() consumes the
+// slots strictly in chunk order and releases each for chunk k + slots.
+// Workers intern symbols into their own parser; next() maps those ids to
+// the owner's in consumption order, so ids match a sequential parse.
+
+struct L3FeedParser::ParallelIngest {
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    struct ErrorSpan {
+        size_t record;    // Index in Slot::records
+        uint64_t line;    // Line within the chunk
+        size_t offset;    // Message in Slot::errors
+        size_t length;
+    };
+
+    struct Slot {
+        std::vector<L3Record> records;
+        std::string errors;                 // Messages of the invalid records
+        std::vector<ErrorSpan> error_spans;
+        uint64_t lines = 0;
+        size_t worker = 0;
+        uint64_t seq = 0;                   // Chunk the slot is released for
+        bool ready = false;
+    };
+
+    std::vector<Chunk> chunks;
+    std::vector<Slot> slots;
+    std::vector<std::unique_ptr<L3FeedParser>> parsers;  // One per worker
+    std::vector<std::vector<uint32_t>> symbol_maps;      // Worker id -> owner id
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next_chunk = 0;
+    bool stop = false;
+
+    // Consumer (next()) state
+    size_t current = 0;       // Chunk being consumed
+    size_t index = 0;         // Next record in it
+    size_t next_error = 0;    // Next ErrorSpan in it
+    uint64_t line_base = 0;   // Lines in earlier chunks
+    bool holding = false;     // Slot of `current` is ready and being read
+
+    void work(size_t worker, const char* data, bool has_symbol_column) {
+        L3FeedParser& parser = *parsers[worker];
+        for (;;) {
+            size_t k;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (stop || next_chunk >= chunks.size()) return;
+                k = next_chunk++;
+                Slot& slot = slots[k % slots.size()];
+                cv.wait(lock, [&] { return stop || slot.seq == k; });
+                if (stop) return;
+            }
+
+            Slot& slot = slots[k % slots.size()];
+            slot.records.clear();
+            slot.errors.clear();
+            slot.error_spans.clear();
+            parser.attach(data + chunks[k].begin, chunks[k].end - chunks[k].begin,
+                          has_symbol_column);
+            L3Record record;
+            while (parser.next(record)) {
+                if (!record.valid) {
+                    slot.error_spans.push_back({slot.records.size(), parser.lines_read_,
+                                                slot.errors.size(), record.error.size()});
+                    slot.errors.append(record.error);
+                }
+                slot.records.push_back(record);
+            }
+            // Errors point into the parser's buffer until now; rebase them
+            for (const ErrorSpan& span : slot.error_spans) {
+                slot.records[span.record].error =
+                    std::string_view(slot.errors.data() + span.offset, span.length);
+            }
+            slot.lines = parser.lines_read_;
+            slot.worker = worker;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.ready = true;
+            }
+            cv.notify_all();
+        }
+    }
+};
+
 // ---------------------------------------------------------------------------
 // File I/O
 // ---------------------------------------------------------------------------
 
+L3FeedParser::L3FeedParser() = default;
+
 L3FeedParser::~L3FeedParser() {
     close();
 }
 
 bool L3FeedParser::open(const std::string& path) {
     close();
-    file_.open(path);
-    if (!file_.is_open()) {
-        return false;
+    lines_read_ = 0;
+    parse_errors_ = 0;
+    has_symbol_column_ = false;
+
+    if (detect_compression(path) != Compression::None) return open_compressed(path);
+
+#if defined(HFT_L3_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            return true;  // Empty file: nothing to map
+        }
+        void* map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            ::madvise(map, size_, MADV_SEQUENTIAL);
+            ::close(fd);
+            data_ = static_cast<const char*>(map);
+            mapped_ = true;
+            if (!open_binary()) return false;
+            start_parallel();
+            return true;
+        }
     }
+    ::close(fd);
+    size_ = 0;
+#endif
+
+    // Not mappable (pipe, special file, no mmap): read it whole
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    buffer_.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    if (!open_binary()) return false;
+    start_parallel();
+    return true;
+}
+
+bool L3FeedParser::open_buffer(const char* data, size_t size) {
+    close();
     lines_read_ = 0;
     parse_errors_ = 0;
     has_symbol_column_ = false;
+    if (detect_compression(data, size) != Compression::None) return false;
+
+    data_ = data;  // Not ours: close() leaves it alone
+    size_ = size;
+    if (!open_binary()) return false;
+    start_parallel();
+    return true;
+}
+
+bool L3FeedParser::open_compressed(const std::string& path) {
+    auto reader = std::make_unique<DecompressingReader>();
+    if (!reader->open(path)) return false;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    size_ = file ? static_cast<size_t>(file.tellg()) : 0;
+    path_ = path;
+
+    std::string_view first = reader->next_block();
+    if (first.size() >= sizeof(L3_BINARY_MAGIC) &&
+        std::memcmp(first.data(), L3_BINARY_MAGIC, sizeof(L3_BINARY_MAGIC)) == 0) {
+        // Binary: records are addressed in place, so inflate it whole
+        for (std::string_view block = first; !block.empty(); block = reader->next_block()) {
+            buffer_.insert(buffer_.end(), block.begin(), block.end());
+        }
+        if (reader->failed()) {
+            close();
+            return false;
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return open_binary();
+    }
+
+    reader_ = std::move(reader);
+    block_ = first;
+    block_pos_ = 0;
     return true;
 }
 
+std::string_view L3FeedParser::input_error() const {
+    if (!reader_ || !reader_->failed()) return {};
+    return reader_->error();
+}
+
+bool L3FeedParser::open_binary() {
+    if (size_ < sizeof(L3BinaryHeader) ||
+        std::memcmp(data_, L3_BINARY_MAGIC, sizeof(L3_BINARY_MAGIC)) != 0) {
+        return true;  // CSV
+    }
+    L3BinaryHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    const uint64_t records_end =
+        header.records_offset + header.record_count * sizeof(L3BinaryRecord);
+    if (header.version != L3_BINARY_VERSION ||
+        header.record_size != sizeof(L3BinaryRecord) ||
+        header.records_offset % alignof(L3BinaryRecord) != 0 ||
+        header.price_scale <= 0 || records_end > size_ ||
+        header.symbol_table_offset < records_end ||
+        header.symbol_table_offset > size_) {
+        close();
+        return false;
+    }
+
+    // Dictionary: views into the mapped bytes
+    size_t pos = header.symbol_table_offset;
+    for (uint32_t i = 0; i < header.symbol_count; ++i) {
+        uint16_t len;
+        if (pos + sizeof(len) > size_) break;
+        std::memcpy(&len, data_ + pos, sizeof(len));
+        pos += sizeof(len);
+        if (pos + len > size_) break;
+        symbols_.emplace_back(data_ + pos, len);
+        symbol_index_.insert(symbols_.back(), static_cast<uint32_t>(symbols_.size() - 1));
+        pos += len;
+    }
+    if (symbols_.size() != header.symbol_count) {
+        close();
+        return false;
+    }
+
+    binary_records_ = reinterpret_cast<const L3BinaryRecord*>(data_ + header.records_offset);
+    binary_count_ = header.record_count;
+    binary_index_ = 0;
+    binary_base_ = header.base_timestamp;
+    binary_timestamp_ = binary_base_;
+    if (header.price_scale < PRICE_SCALE) {
+        price_mul_ = PRICE_SCALE / header.price_scale;
+    } else {
+        price_div_ = header.price_scale / PRICE_SCALE;
+    }
+    has_symbol_column_ = header.symbol_count != 0;
+    return true;
+}
+
+bool L3FeedParser::next_binary(L3Record& record) {
+    while (binary_index_ < binary_count_) {
+        const L3BinaryRecord& r = binary_records_[binary_index_++];
+        ++lines_read_;
+        if (r.event_type == L3_BINARY_TIME_BASE) [[unlikely]] {
+            binary_timestamp_ = r.order_id;
+            continue;
+        }
+        binary_timestamp_ += r.timestamp_delta;
+
+        record.timestamp = binary_timestamp_;
+        record.event_type = static_cast<L3EventType>(r.event_type);
+        record.order_id = r.order_id;
+        record.side = static_cast<Side>(r.side);
+        record.price = r.price * price_mul_ / price_div_;
+        record.quantity = r.quantity;
+        if (r.symbol_id != L3_BINARY_NO_SYMBOL && r.symbol_id < symbols_.size()) {
+            record.symbol_id = r.symbol_id;
+            record.symbol = symbols_[r.symbol_id];
+        } else {
+            record.symbol_id = L3_NO_SYMBOL;
+            record.symbol = {};
+        }
+        record.valid = true;
+        record.error = {};
+        return true;
+    }
+    return false;
+}
+
 bool L3FeedParser::next(L3Record& record) {
-    while (std::getline(file_, current_line_)) {
+    if (binary_records_) return next_binary(record);
+    if (parallel_) return next_parallel(record);
+
+    std::string_view line;
+    while (read_line(line)) {
         ++lines_read_;
 
         // Trim trailing whitespace / carriage return
-        while (!current_line_.empty() &&
-               (current_line_.back() == '\r' || current_line_.back() == '\n' ||
-                current_line_.back() == ' ')) {
-            current_line_.pop_back();
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.remove_suffix(1);
         }
 
         // Skip empty lines
-        if (current_line_.empty()) {
+        if (line.empty()) {
             continue;
         }
 
         // Skip header lines
-        if (is_header(current_line_)) {
+        if (is_header(line)) {
             continue;
         }
 
-        if (!parse_line(current_line_, record)) {
+        if (!parse_line(line, record)) {
             ++parse_errors_;
             record.valid = false;
             // record.error is set by parse_line
@@ -59,19 +353,288 @@ bool L3FeedParser::next(L3Record& record) {
     return false;  // EOF
 }
 
+bool L3FeedParser::read_line(std::string_view& line) {
+    if (reader_) return read_streamed_line(line);
+    if (cursor_ >= size_) return false;
+    const char* begin = data_ + cursor_;
+    const size_t left = size_ - cursor_;
+    const char* nl = static_cast<const char*>(std::memchr(begin, '\n', left));
+    const size_t len = nl ? static_cast<size_t>(nl - begin) : left;
+    cursor_ += nl ? len + 1 : len;
+    line = std::string_view(begin, len);
+    return true;
+}
+
+bool L3FeedParser::read_streamed_line(std::string_view& line) {
+    carry_.clear();
+    for (;;) {
+        if (block_pos_ == block_.size()) {
+            block_ = reader_->next_block();
+            block_pos_ = 0;
+            if (block_.empty()) {
+                // End of stream: a final line without '\n', if any
+                line = carry_;
+                return !carry_.empty();
+            }
+        }
+        const char* begin = block_.data() + block_pos_;
+        const size_t left = block_.size() - block_pos_;
+        const char* nl = static_cast<const char*>(std::memchr(begin, '\n', left));
+        if (!nl) {
+            // The line continues in the next block; that one replaces this
+            carry_.append(begin, left);
+            block_pos_ = block_.size();
+            continue;
+        }
+        const size_t len = static_cast<size_t>(nl - begin);
+        block_pos_ += len + 1;
+        if (carry_.empty()) {
+            line = std::string_view(begin, len);
+        } else {
+            carry_.append(begin, len);
+            line = carry_;
+        }
+        return true;
+    }
+}
+
 void L3FeedParser::reset() {
-    if (file_.is_open()) {
-        file_.clear();
-        file_.seekg(0);
-        lines_read_ = 0;
-        parse_errors_ = 0;
-        has_symbol_column_ = false;
+    stop_parallel();
+    cursor_ = 0;
+    lines_read_ = 0;
+    parse_errors_ = 0;
+    has_symbol_column_ = binary_records_ && !symbols_.empty();
+    binary_index_ = 0;
+    binary_timestamp_ = binary_base_;
+    if (reader_) {
+        // Streams cannot seek: decompress again from the start
+        carry_.clear();
+        block_ = {};
+        block_pos_ = 0;
+        if (!reader_->open(path_)) reader_.reset();
+    }
+    start_parallel();
+}
+
+L3FeedPosition L3FeedParser::tell() const {
+    L3FeedPosition position;
+    position.offset = binary_records_ ? binary_index_ : cursor_;
+    position.lines_read = lines_read_;
+    position.parse_errors = parse_errors_;
+    position.binary_timestamp = binary_timestamp_;
+    position.has_symbol_column = has_symbol_column_;
+    return position;
+}
+
+bool L3FeedParser::seek(const L3FeedPosition& position) {
+    if (!seekable()) return false;
+    if (position.offset > (binary_records_ ? binary_count_ : size_)) return false;
+    if (binary_records_) {
+        binary_index_ = position.offset;
+        binary_timestamp_ = position.binary_timestamp;
+    } else {
+        cursor_ = static_cast<size_t>(position.offset);
+        has_symbol_column_ = position.has_symbol_column;
     }
+    lines_read_ = position.lines_read;
+    parse_errors_ = position.parse_errors;
+    return true;
 }
 
 void L3FeedParser::close() {
-    if (file_.is_open()) {
-        file_.close();
+    stop_parallel();
+#if defined(HFT_L3_MMAP)
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    cursor_ = 0;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    reader_.reset();
+    path_.clear();
+    block_ = {};
+    block_pos_ = 0;
+    carry_.clear();
+    symbols_.clear();
+    symbol_index_.clear();
+    symbol_storage_.clear();
+    last_symbol_id_ = L3_NO_SYMBOL;
+    binary_records_ = nullptr;
+    binary_count_ = 0;
+    binary_index_ = 0;
+    binary_base_ = 0;
+    binary_timestamp_ = 0;
+    price_mul_ = 1;
+    price_div_ = 1;
+}
+
+uint32_t L3FeedParser::intern(std::string_view symbol) {
+    // Rows of one symbol tend to cluster; check the last hit first
+    if (last_symbol_id_ != L3_NO_SYMBOL && symbols_[last_symbol_id_] == symbol) {
+        return last_symbol_id_;
+    }
+    const uint32_t found = symbol_index_.find(symbol);
+    if (found != SymbolInterner::NOT_FOUND) {
+        last_symbol_id_ = found;
+        return last_symbol_id_;
+    }
+    if (reader_) {
+        // Streamed blocks are recycled: keep a copy
+        symbol_storage_.emplace_back(symbol);
+        symbols_.push_back(symbol_storage_.back());
+    } else {
+        symbols_.push_back(symbol);
+    }
+    last_symbol_id_ = static_cast<uint32_t>(symbols_.size() - 1);
+    symbol_index_.insert(symbols_.back(), last_symbol_id_);
+    return last_symbol_id_;
+}
+
+void L3FeedParser::set_error(L3Record& record, const char* what,
+                             std::string_view detail) {
+    // Truncates to the buffer; no allocation on the error path either
+    const size_t what_len = std::min(std::strlen(what), sizeof(error_));
+    const size_t detail_len = std::min(detail.size(), sizeof(error_) - what_len);
+    std::memcpy(error_, what, what_len);
+    if (detail_len != 0) std::memcpy(error_ + what_len, detail.data(), detail_len);
+    const size_t len = what_len + detail_len;
+    record.error = std::string_view(error_, len);
+}
+
+// ---------------------------------------------------------------------------
+// Parallel ingestion
+// ---------------------------------------------------------------------------
+
+void L3FeedParser::set_parse_threads(size_t threads, size_t chunk_bytes) {
+    parse_threads_ = threads;
+    chunk_bytes_ = chunk_bytes == 0 ? DEFAULT_CHUNK_BYTES : chunk_bytes;
+}
+
+size_t L3FeedParser::parse_threads() const {
+    return parallel_ ? parallel_->threads.size() : 0;
+}
+
+void L3FeedParser::attach(const char* data, size_t size, bool has_symbol_column) {
+    data_ = data;
+    size_ = size;
+    cursor_ = 0;
+    lines_read_ = 0;
+    parse_errors_ = 0;
+    has_symbol_column_ = has_symbol_column;
+}
+
+void L3FeedParser::start_parallel() {
+    if (parse_threads_ == 0 || binary_records_ || reader_ || size_ <= chunk_bytes_) return;
+
+    // The symbol column is detected once, from the first data line, since
+    // workers start mid-file
+    for (size_t pos = 0; pos < size_ && !has_symbol_column_;) {
+        const char* begin = data_ + pos;
+        const char* nl = static_cast<const char*>(std::memchr(begin, '\n', size_ - pos));
+        size_t len = nl ? static_cast<size_t>(nl - begin) : size_ - pos;
+        pos += nl ? len + 1 : len;
+        while (len > 0 && (begin[len - 1] == '\r' || begin[len - 1] == ' ')) --len;
+        std::string_view line(begin, len);
+        if (line.empty() || is_header(line)) continue;
+        std::string_view fields[MAX_FIELDS];
+        const size_t count = split_fields(line, fields, MAX_FIELDS);
+        has_symbol_column_ = count >= 7 && !fields[0].empty() &&
+                             (fields[0][0] < '0' || fields[0][0] > '9');
+        break;
+    }
+
+    auto pi = std::make_unique<ParallelIngest>();
+    for (size_t begin = 0; begin < size_;) {
+        size_t end = std::min(begin + chunk_bytes_, size_);
+        if (end < size_) {
+            const void* nl = std::memchr(data_ + end, '\n', size_ - end);
+            end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data_) + 1 : size_;
+        }
+        pi->chunks.push_back({begin, end});
+        begin = end;
+    }
+
+    const size_t workers = std::min(parse_threads_, pi->chunks.size());
+    pi->slots.resize(std::min(workers * 2, pi->chunks.size()));
+    for (size_t i = 0; i < pi->slots.size(); ++i) {
+        pi->slots[i].seq = i;
+        pi->slots[i].records.reserve(chunk_bytes_ / 32);  // ~44-byte rows
+    }
+    pi->symbol_maps.resize(workers);
+    for (size_t w = 0; w < workers; ++w) {
+        pi->parsers.push_back(std::make_unique<L3FeedParser>());
+    }
+    ParallelIngest* raw = pi.get();
+    const char* data = data_;
+    const bool has_symbol_column = has_symbol_column_;
+    for (size_t w = 0; w < workers; ++w) {
+        pi->threads.emplace_back([raw, w, data, has_symbol_column] {
+            raw->work(w, data, has_symbol_column);
+        });
+    }
+    parallel_ = std::move(pi);
+}
+
+void L3FeedParser::stop_parallel() {
+    if (!parallel_) return;
+    {
+        std::lock_guard<std::mutex> lock(parallel_->mutex);
+        parallel_->stop = true;
+    }
+    parallel_->cv.notify_all();
+    for (std::thread& t : parallel_->threads) t.join();
+    parallel_.reset();
+}
+
+bool L3FeedParser::next_parallel(L3Record& record) {
+    ParallelIngest& pi = *parallel_;
+    const size_t slot_count = pi.slots.size();
+    for (;;) {
+        if (pi.holding) {
+            ParallelIngest::Slot& slot = pi.slots[pi.current % slot_count];
+            if (pi.index < slot.records.size()) {
+                record = slot.records[pi.index++];
+                if (record.symbol_id != L3_NO_SYMBOL) {
+                    std::vector<uint32_t>& map = pi.symbol_maps[slot.worker];
+                    if (record.symbol_id >= map.size()) {
+                        map.resize(record.symbol_id + 1, L3_NO_SYMBOL);
+                    }
+                    uint32_t& id = map[record.symbol_id];
+                    if (id == L3_NO_SYMBOL) id = intern(record.symbol);
+                    record.symbol_id = id;
+                }
+                if (!record.valid) {
+                    ++parse_errors_;
+                    lines_read_ = pi.line_base + slot.error_spans[pi.next_error++].line;
+                }
+                return true;
+            }
+
+            pi.line_base += slot.lines;
+            lines_read_ = pi.line_base;
+            {
+                std::lock_guard<std::mutex> lock(pi.mutex);
+                slot.ready = false;
+                slot.seq += slot_count;
+            }
+            pi.cv.notify_all();
+            pi.holding = false;
+            ++pi.current;
+        }
+
+        if (pi.current >= pi.chunks.size()) return false;
+        ParallelIngest::Slot& slot = pi.slots[pi.current % slot_count];
+        {
+            std::unique_lock<std::mutex> lock(pi.mutex);
+            pi.cv.wait(lock, [&] { return slot.ready && slot.seq == pi.current; });
+        }
+        pi.holding = true;
+        pi.index = 0;
+        pi.next_error = 0;
     }
 }
 
@@ -79,70 +642,70 @@ void L3FeedParser::close() {
 // Static parsing utilities
 // ---------------------------------------------------------------------------
 
+size_t L3FeedParser::split_fields(std::string_view line, std::string_view* fields,
+                                  size_t max) {
+    if (max == 0) return 0;
+    size_t count = 0;
+    size_t start = 0;
+
+    // One comma bitmask per 64-byte block, walked bit by bit
+    for (size_t base = 0; base < line.size(); base += 64) {
+        uint64_t mask = structural_mask(line.data() + base, line.size() - base, ',');
+        while (mask) {
+            const size_t comma = base + lowest_bit(mask);
+            mask &= mask - 1;
+            fields[count++] = line.substr(start, comma - start);
+            if (count == max) return count;
+            start = comma + 1;
+        }
+    }
+
+    fields[count++] = line.substr(start);
+    return count;
+}
+
 std::vector<std::string_view> L3FeedParser::split_csv(std::string_view line) {
     std::vector<std::string_view> fields;
     size_t start = 0;
 
-    while (start <= line.size()) {
-        size_t comma = line.find(',', start);
-        if (comma == std::string_view::npos) {
-            fields.push_back(line.substr(start));
-            break;
+    for (size_t base = 0; base < line.size(); base += 64) {
+        uint64_t mask = structural_mask(line.data() + base, line.size() - base, ',');
+        while (mask) {
+            const size_t comma = base + lowest_bit(mask);
+            mask &= mask - 1;
+            fields.push_back(line.substr(start, comma - start));
+            start = comma + 1;
         }
-        fields.push_back(line.substr(start, comma - start));
-        start = comma + 1;
     }
+    fields.push_back(line.substr(start));
 
     return fields;
 }
 
 L3EventType L3FeedParser::parse_event_type(std::string_view str) {
     // Case-insensitive comparison
-    if (str.size() == 3) {
-        char c0 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[0])));
-        char c1 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[1])));
-        char c2 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[2])));
-        if (c0 == 'A' && c1 == 'D' && c2 == 'D') return L3EventType::Add;
-    }
-    if (str.size() == 6) {
-        std::string upper(str.size(), '\0');
-        for (size_t i = 0; i < str.size(); ++i) {
-            upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-        }
-        if (upper == "CANCEL") return L3EventType::Cancel;
-        if (upper == "MODIFY") return L3EventType::Modify;
-    }
-    if (str.size() == 5) {
-        std::string upper(str.size(), '\0');
-        for (size_t i = 0; i < str.size(); ++i) {
-            upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-        }
-        if (upper == "TRADE") return L3EventType::Trade;
+    switch (str.size()) {
+        case 3:
+            if (iequals(str, "ADD")) return L3EventType::Add;
+            break;
+        case 5:
+            if (iequals(str, "TRADE")) return L3EventType::Trade;
+            break;
+        case 6:
+            if (iequals(str, "CANCEL")) return L3EventType::Cancel;
+            if (iequals(str, "MODIFY")) return L3EventType::Modify;
+            break;
+        default:
+            break;
     }
     return L3EventType::Invalid;
 }
 
 Side L3FeedParser::parse_side(std::string_view str, bool& ok) {
+    ok = true;
+    if (iequals(str, "BUY")) return Side::Buy;
+    if (iequals(str, "SELL")) return Side::Sell;
     ok = false;
-    if (str.size() == 3) {
-        char c0 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[0])));
-        char c1 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[1])));
-        char c2 = static_cast<char>(std::toupper(static_cast<unsigned char>(str[2])));
-        if (c0 == 'B' && c1 == 'U' && c2 == 'Y') {
-            ok = true;
-            return Side::Buy;
-        }
-    }
-    if (str.size() == 4) {
-        std::string upper(str.size(), '\0');
-        for (size_t i = 0; i < str.size(); ++i) {
-            upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-        }
-        if (upper == "SELL") {
-            ok = true;
-            return Side::Sell;
-        }
-    }
     return Side::Buy;
 }
 
@@ -227,6 +790,8 @@ OrderMessage L3FeedParser::to_order_message(const L3Record& record,
     msg.order.quantity = record.quantity;
     msg.order.visible_quantity = record.quantity;
     msg.order.iceberg_slice_qty = 0;
+    msg.order.stop_price = 0;
+    msg.order.expire_time = 0;
     msg.order.filled_quantity = 0;
     msg.order.timestamp = record.timestamp;
     msg.order.next = nullptr;
@@ -250,6 +815,8 @@ OrderMessage L3FeedParser::to_modify_message(const L3Record& record,
     msg.order.quantity = record.quantity;
     msg.order.visible_quantity = record.quantity;
     msg.order.iceberg_slice_qty = 0;
+    msg.order.stop_price = 0;
+    msg.order.expire_time = 0;
     msg.order.filled_quantity = 0;
     msg.order.timestamp = record.timestamp;
     msg.order.next = nullptr;
@@ -257,16 +824,32 @@ OrderMessage L3FeedParser::to_modify_message(const L3Record& record,
     return msg;
 }
 
+OrderMessage L3FeedParser::to_cancel_message(const L3Record& record,
+                                              InstrumentId instrument_id) {
+    OrderMessage msg{};
+    msg.type = MessageType::Cancel;
+    msg.instrument_id = instrument_id;
+    msg.order.order_id = record.order_id;
+    msg.order.instrument_id = instrument_id;
+    msg.order.side = record.side;
+    msg.order.price = record.price;
+    msg.order.timestamp = record.timestamp;
+    return msg;
+}
+
 // ---------------------------------------------------------------------------
 // Line parsing
 // ---------------------------------------------------------------------------
 
 bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
     record = {};
+    record.symbol_id = L3_NO_SYMBOL;
 
-    auto fields = split_csv(line);
-    if (fields.size() < 2) {
-        record.error = "too few fields";
+    std::string_view field_array[MAX_FIELDS];
+    const std::string_view* fields = field_array;
+    const size_t field_count = split_fields(line, field_array, MAX_FIELDS);
+    if (field_count < 2) {
+        set_error(record, "too few fields");
         return false;
     }
 
@@ -275,41 +858,42 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
     size_t offset = 0;
     if (has_symbol_column_) {
         offset = 1;
-    } else if (fields.size() >= 7 && !fields[0].empty() &&
+    } else if (field_count >= 7 && !fields[0].empty() &&
                (fields[0][0] < '0' || fields[0][0] > '9')) {
         has_symbol_column_ = true;
         offset = 1;
     }
 
     if (offset == 1) {
-        record.symbol = std::string(fields[0]);
+        record.symbol_id = intern(fields[0]);
+        record.symbol = symbols_[record.symbol_id];
     }
 
     size_t ts_idx = offset;
     size_t et_idx = offset + 1;
 
     // Field ts_idx: timestamp
-    if (ts_idx >= fields.size() || fields[ts_idx].empty()) {
-        record.error = "empty timestamp";
+    if (ts_idx >= field_count || fields[ts_idx].empty()) {
+        set_error(record, "empty timestamp");
         return false;
     }
     record.timestamp = 0;
     for (char c : fields[ts_idx]) {
         if (c < '0' || c > '9') {
-            record.error = "invalid timestamp";
+            set_error(record, "invalid timestamp");
             return false;
         }
         record.timestamp = record.timestamp * 10 + static_cast<uint64_t>(c - '0');
     }
 
     // Field et_idx: event_type
-    if (et_idx >= fields.size()) {
-        record.error = "missing event_type";
+    if (et_idx >= field_count) {
+        set_error(record, "missing event_type");
         return false;
     }
     record.event_type = parse_event_type(fields[et_idx]);
     if (record.event_type == L3EventType::Invalid) {
-        record.error = "invalid event type: " + std::string(fields[1]);
+        set_error(record, "invalid event type: ", fields[et_idx]);
         return false;
     }
 
@@ -325,20 +909,20 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
     switch (record.event_type) {
         case L3EventType::Add: {
             // Need: order_id, side, price, quantity
-            if (fields.size() < min_full) {
-                record.error = "ADD requires 6 data fields";
+            if (field_count < min_full) {
+                set_error(record, "ADD requires 6 data fields");
                 return false;
             }
 
             // order_id
             record.order_id = 0;
             if (fields[oid_idx].empty()) {
-                record.error = "ADD requires order_id";
+                set_error(record, "ADD requires order_id");
                 return false;
             }
             for (char c : fields[oid_idx]) {
                 if (c < '0' || c > '9') {
-                    record.error = "invalid order_id";
+                    set_error(record, "invalid order_id");
                     return false;
                 }
                 record.order_id = record.order_id * 10 + static_cast<uint64_t>(c - '0');
@@ -348,21 +932,21 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
             bool side_ok = false;
             record.side = parse_side(fields[side_idx], side_ok);
             if (!side_ok) {
-                record.error = "invalid side: " + std::string(fields[side_idx]);
+                set_error(record, "invalid side: ", fields[side_idx]);
                 return false;
             }
 
             // price
             record.price = parse_price(fields[px_idx]);
             if (record.price == 0 && !fields[px_idx].empty() && fields[px_idx] != "0") {
-                record.error = "invalid price: " + std::string(fields[px_idx]);
+                set_error(record, "invalid price: ", fields[px_idx]);
                 return false;
             }
 
             // quantity
             record.quantity = parse_quantity(fields[qty_idx]);
             if (record.quantity == 0) {
-                record.error = "invalid quantity: " + std::string(fields[qty_idx]);
+                set_error(record, "invalid quantity: ", fields[qty_idx]);
                 return false;
             }
 
@@ -371,20 +955,20 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
 
         case L3EventType::Cancel: {
             // Need: order_id; others optional/empty
-            if (fields.size() < min_cancel) {
-                record.error = "CANCEL requires at least 3 data fields";
+            if (field_count < min_cancel) {
+                set_error(record, "CANCEL requires at least 3 data fields");
                 return false;
             }
 
             // order_id
             record.order_id = 0;
             if (fields[oid_idx].empty()) {
-                record.error = "CANCEL requires order_id";
+                set_error(record, "CANCEL requires order_id");
                 return false;
             }
             for (char c : fields[oid_idx]) {
                 if (c < '0' || c > '9') {
-                    record.error = "invalid order_id";
+                    set_error(record, "invalid order_id");
                     return false;
                 }
                 record.order_id = record.order_id * 10 + static_cast<uint64_t>(c - '0');
@@ -396,8 +980,8 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
         case L3EventType::Trade: {
             // Informational: side, price, quantity
             // order_id is empty/optional for trades
-            if (fields.size() < min_full) {
-                record.error = "TRADE requires 6 data fields";
+            if (field_count < min_full) {
+                set_error(record, "TRADE requires 6 data fields");
                 return false;
             }
 
@@ -423,20 +1007,20 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
 
         case L3EventType::Modify: {
             // Same fields as ADD: order_id, side, price, quantity
-            if (fields.size() < min_full) {
-                record.error = "MODIFY requires 6 data fields";
+            if (field_count < min_full) {
+                set_error(record, "MODIFY requires 6 data fields");
                 return false;
             }
 
             // order_id
             record.order_id = 0;
             if (fields[oid_idx].empty()) {
-                record.error = "MODIFY requires order_id";
+                set_error(record, "MODIFY requires order_id");
                 return false;
             }
             for (char c : fields[oid_idx]) {
                 if (c < '0' || c > '9') {
-                    record.error = "invalid order_id";
+                    set_error(record, "invalid order_id");
                     return false;
                 }
                 record.order_id = record.order_id * 10 + static_cast<uint64_t>(c - '0');
@@ -446,21 +1030,21 @@ bool L3FeedParser::parse_line(std::string_view line, L3Record& record) {
             bool side_ok = false;
             record.side = parse_side(fields[side_idx], side_ok);
             if (!side_ok) {
-                record.error = "invalid side: " + std::string(fields[side_idx]);
+                set_error(record, "invalid side: ", fields[side_idx]);
                 return false;
             }
 
             // price
             record.price = parse_price(fields[px_idx]);
             if (record.price == 0 && !fields[px_idx].empty() && fields[px_idx] != "0") {
-                record.error = "invalid price: " + std::string(fields[px_idx]);
+                set_error(record, "invalid price: ", fields[px_idx]);
                 return false;
             }
 
             // quantity
             record.quantity = parse_quantity(fields[qty_idx]);
             if (record.quantity == 0) {
-                record.error = "invalid quantity: " + std::string(fields[qty_idx]);
+                set_error(record, "invalid quantity: ", fields[qty_idx]);
                 return false;
             }
 
@@ -480,16 +1064,8 @@ bool L3FeedParser::is_header(std::string_view line) {
     // Check if the line starts with common header words (case-insensitive)
     if (line.size() < 4) return false;
 
-    auto fields = split_csv(line);
-    if (fields.empty()) return false;
-
-    // Lower-case first field
-    std::string first(fields[0]);
-    for (auto& c : first) {
-        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    }
-
-    return first == "timestamp" || first == "symbol";
+    std::string_view first = line.substr(0, line.find(','));
+    return iequals(first, "TIMESTAMP") || iequals(first, "SYMBOL");
 }
 
 }  // namespace hft
@@ -8,14 +8,39 @@
 ///
 /// Price parsing uses integer arithmetic only (no stod) to avoid
 /// floating-point rounding errors in fixed-point conversion.
+///
+/// The file is memory-mapped (read into one buffer where mapping is not
+/// possible) and parsed in place: lines are found with memchr, fields are
+/// split into a fixed array of string_views, and symbols are interned to
+/// small integer ids. After the first occurrence of each symbol, next()
+/// allocates nothing, so multi-GB daily files are bounded by the page
+/// cache rather than the allocator.
+///
+/// Files in the binary L3 format (l3_binary_format.h) are recognised by
+/// their magic and replayed from the mapped records without any parsing.
+///
+/// gzip, zstd and lz4 files (compressed_input.h) are recognised too. A
+/// compressed CSV is streamed: a background thread decompresses blocks
+/// while next() parses the previous one, so only two blocks are resident.
+/// A compressed binary file is decompressed into memory, since its symbol
+/// dictionary is at the end.
+///
+/// set_parse_threads() enables parallel ingestion of large CSV files: the
+/// mapping is split into chunks at newline boundaries, worker threads
+/// parse chunks into pre-sized record blocks, and next() hands the blocks
+/// out in file order. Records, symbol ids and error counts are the same
+/// as a single-threaded parse, so matching stays deterministic.
 
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
+#include <deque>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "core/types.h"
+#include "feed/symbol_interner.h"
 #include "transport/message.h"
 
 namespace hft {
@@ -23,6 +48,12 @@ namespace hft {
 /// Type of event in an L3 feed record.
 enum class L3EventType : uint8_t { Add, Cancel, Trade, Modify, Invalid };
 
+struct L3BinaryRecord;       // l3_binary_format.h
+class DecompressingReader;   // compressed_input.h
+
+/// L3Record::symbol_id of a record without a symbol column.
+constexpr uint32_t L3_NO_SYMBOL = UINT32_MAX;
+
 /// A single parsed record from an L3 CSV file.
 struct L3Record {
     Timestamp timestamp;
@@ -31,9 +62,23 @@ struct L3Record {
     Side side;
     Price price;          // fixed-point (PRICE_SCALE)
     Quantity quantity;
-    std::string symbol;   // empty for single-instrument (6-column) files
+    /// Symbol column, viewing the parser's symbol table (valid until it is
+    /// closed); empty for single-instrument (6-column) files.
+    std::string_view symbol;
+    uint32_t symbol_id;   // Interned id of symbol, or L3_NO_SYMBOL
     bool valid;
-    std::string error;
+    /// Parse error, viewing the parser's message buffer (valid until the
+    /// next call).
+    std::string_view error;
+};
+
+/// Resume point in a seekable input (see L3FeedParser::tell()).
+struct L3FeedPosition {
+    uint64_t offset = 0;             // Byte offset (CSV) or record index (binary)
+    uint64_t lines_read = 0;
+    uint64_t parse_errors = 0;
+    Timestamp binary_timestamp = 0;  // Binary: running delta-decoded timestamp
+    bool has_symbol_column = false;
 };
 
 /// Streaming CSV parser for L3 market data files.
@@ -49,25 +94,81 @@ struct L3Record {
 ///   parser.close();
 class L3FeedParser {
 public:
-    L3FeedParser() = default;
+    L3FeedParser();
     ~L3FeedParser();
 
     L3FeedParser(const L3FeedParser&) = delete;
     L3FeedParser& operator=(const L3FeedParser&) = delete;
 
-    /// Open a CSV file for reading. Returns false if the file cannot be opened.
+    /// Open (map) a CSV file for reading. Returns false if the file cannot
+    /// be opened, or is compressed with a codec this build lacks.
     bool open(const std::string& path);
 
+    /// Parse `size` bytes at `data` in place instead of a file: an
+    /// uncompressed CSV or binary L3 image the caller keeps alive until
+    /// close() (e.g. one read-only mapping shared by several parsers).
+    /// Returns false if it is compressed or a malformed binary file.
+    bool open_buffer(const char* data, size_t size);
+
     /// Read the next record from the file. Returns false at EOF.
     /// On parse error, record.valid is false and record.error describes the issue.
     bool next(L3Record& record);
 
-    /// Reset to the beginning of the file.
+    /// Reset to the beginning of the file. Symbol ids are kept.
     void reset();
 
-    /// Close the file.
+    /// Whether tell() / seek() work on the open input: mapped CSV and
+    /// binary files parsed on the caller (not compressed streams, not
+    /// parallel ingestion).
+    [[nodiscard]] bool seekable() const { return !reader_ && !parallel_; }
+
+    /// Position of the next record next() would return.
+    [[nodiscard]] L3FeedPosition tell() const;
+
+    /// Continue from a position tell() returned on the same file, so the
+    /// next record is the one that followed it. Returns false if the input
+    /// is not seekable or the position lies past its end.
+    bool seek(const L3FeedPosition& position);
+
+    /// Default size of a parallel ingestion chunk.
+    static constexpr size_t DEFAULT_CHUNK_BYTES = size_t{4} << 20;
+
+    /// Parse CSV files on `threads` worker threads, in chunks of about
+    /// `chunk_bytes` (0 threads = on the caller, the default). Takes effect
+    /// at the next open() and applies to files of more than one chunk.
+    /// With workers, whether the file has a symbol column is decided by its
+    /// first data line, and lines_read() advances a chunk at a time except
+    /// on invalid records, where it is exact.
+    void set_parse_threads(size_t threads, size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+    /// Worker threads parsing the open file (0 = parsing on the caller).
+    [[nodiscard]] size_t parse_threads() const;
+
+    /// Close (unmap) the file. Invalidates record symbols and symbol_name().
     void close();
 
+    /// Symbol interned as `id` (as seen in L3Record::symbol_id); empty if
+    /// unknown. Ids are dense, in order of first appearance.
+    [[nodiscard]] std::string_view symbol_name(uint32_t id) const {
+        return id < symbols_.size() ? symbols_[id] : std::string_view{};
+    }
+
+    /// Number of distinct symbols seen so far.
+    [[nodiscard]] size_t symbol_count() const { return symbols_.size(); }
+
+    /// Bytes in the open file (compressed size for compressed files).
+    [[nodiscard]] size_t file_size() const { return size_; }
+
+    /// Whether the open file is streamed through a decompressor.
+    [[nodiscard]] bool is_compressed_stream() const { return reader_ != nullptr; }
+
+    /// Why a compressed stream ended early (corrupt or truncated input);
+    /// empty if it did not.
+    [[nodiscard]] std::string_view input_error() const;
+
+    /// Whether the open file is in the binary L3 format.
+    [[nodiscard]] bool is_binary() const { return binary_records_ != nullptr; }
+
     /// Number of lines read so far (including header and error lines).
     [[nodiscard]] uint64_t lines_read() const { return lines_read_; }
 
@@ -89,6 +190,11 @@ public:
         const L3Record& record,
         InstrumentId instrument_id = DEFAULT_INSTRUMENT_ID);
 
+    /// Convert an L3Record (CANCEL) to an OrderMessage for batch submission.
+    static OrderMessage to_cancel_message(
+        const L3Record& record,
+        InstrumentId instrument_id = DEFAULT_INSTRUMENT_ID);
+
     /// Parse a decimal price string to fixed-point int64_t.
     /// Uses integer arithmetic only — no stod.
     /// Returns 0 on parse failure.
@@ -105,21 +211,94 @@ public:
     /// Returns Side::Buy on failure (caller should check event_type validity).
     static Side parse_side(std::string_view str, bool& ok);
 
+    /// Most fields split_fields() separates; later ones are ignored.
+    static constexpr size_t MAX_FIELDS = 16;
+
+    /// Split a CSV line into at most `max` fields, in place. Returns the
+    /// number written.
+    static size_t split_fields(std::string_view line, std::string_view* fields,
+                               size_t max);
+
     /// Split a CSV line into fields.
     static std::vector<std::string_view> split_csv(std::string_view line);
 
 private:
+    struct ParallelIngest;  // l3_feed_parser.cpp
+
+    /// Start parallel ingestion workers if configured and worthwhile.
+    void start_parallel();
+
+    /// Stop and join the workers, if any.
+    void stop_parallel();
+
+    /// next() with parallel ingestion.
+    bool next_parallel(L3Record& record);
+
+    /// Parse the unowned CSV range [data, data + size) (worker parsers).
+    void attach(const char* data, size_t size, bool has_symbol_column);
+
+    /// open() for gzip / zstd / lz4 files.
+    bool open_compressed(const std::string& path);
+
+    /// Next raw line (without its '\n'); false at the end of the input.
+    bool read_line(std::string_view& line);
+
+    /// read_line() for a compressed stream.
+    bool read_streamed_line(std::string_view& line);
+
+    /// Validate a binary file's header and dictionary and switch to it.
+    bool open_binary();
+
+    /// next() for binary files.
+    bool next_binary(L3Record& record);
+
     /// Parse a single line into an L3Record.
     bool parse_line(std::string_view line, L3Record& record);
 
+    /// Set record.error to `what` followed by `detail`, without allocating.
+    void set_error(L3Record& record, const char* what,
+                   std::string_view detail = {});
+
+    /// Intern a symbol, returning its id.
+    uint32_t intern(std::string_view symbol);
+
     /// Check if a line is a header row.
     static bool is_header(std::string_view line);
 
-    std::ifstream file_;
-    std::string current_line_;
+    const char* data_ = nullptr;   // Mapped file, or buffer_.data()
+    size_t size_ = 0;
+    size_t cursor_ = 0;            // Start of the next line
+    bool mapped_ = false;
+    std::vector<char> buffer_;     // Fallback when the file cannot be mapped
+    std::vector<std::string_view> symbols_;  // Views into data_ (or symbol_storage_), index = id
+    SymbolInterner symbol_index_;            // symbols_ -> id
+    std::deque<std::string> symbol_storage_; // Symbol bytes of streamed input
+
+    // Compressed CSV streams (see compressed_input.h)
+    std::unique_ptr<DecompressingReader> reader_;
+    std::string path_;
+    std::string_view block_;       // Decompressed block being parsed
+    size_t block_pos_ = 0;
+    std::string carry_;            // Line spanning two blocks
+    uint32_t last_symbol_id_ = L3_NO_SYMBOL;
     uint64_t lines_read_ = 0;
     uint64_t parse_errors_ = 0;
     bool has_symbol_column_ = false;
+    char error_[128] = {};
+
+    // Parallel ingestion (see set_parse_threads())
+    size_t parse_threads_ = 0;
+    size_t chunk_bytes_ = DEFAULT_CHUNK_BYTES;
+    std::unique_ptr<ParallelIngest> parallel_;
+
+    // Binary files (see l3_binary_format.h)
+    const L3BinaryRecord* binary_records_ = nullptr;
+    uint64_t binary_count_ = 0;
+    uint64_t binary_index_ = 0;
+    Timestamp binary_base_ = 0;
+    Timestamp binary_timestamp_ = 0;
+    int64_t price_mul_ = 1;        // File price scale -> PRICE_SCALE
+    int64_t price_div_ = 1;
 };
 
 }  // namespace hft
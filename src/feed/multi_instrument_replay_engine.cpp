@@ -1,12 +1,14 @@
 #include "feed/multi_instrument_replay_engine.h"
 
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
 #include <nlohmann/json.hpp>
 
 #include "orderbook/order_book.h"
+#include "transport/wait_strategy.h"
 
 namespace hft {
 
@@ -18,13 +20,24 @@ MultiInstrumentReplayEngine::MultiInstrumentReplayEngine(
         registry_.register_instrument(cfg);
     }
 
-    // Create shared event buffer and router
+    // Create shared event buffer and router; with auto_discover, pipelines
+    // of new symbols are added by run() as they first appear
     event_buffer_ = std::make_unique<EventBuffer>();
-
-    if (!config_.auto_discover) {
+    if (!partitioned()) {
         router_ = std::make_unique<InstrumentRouter>(registry_, event_buffer_.get());
+        return;
     }
-    // If auto_discover, router is created lazily after first pass discovers symbols
+
+    // Partitioned: the workers own every pipeline, the serial router none
+    static const InstrumentRegistry no_instruments;
+    router_ = std::make_unique<InstrumentRouter>(no_instruments, event_buffer_.get());
+    ShardedRouterConfig shard_config;
+    shard_config.num_shards = config_.matching_workers;
+    shard_config.assignment = config_.worker_assignment;
+    shard_config.threading = config_.threading;
+    shard_config.merged_stream = config_.merge_events;
+    shard_config.count_outcomes = true;
+    sharded_ = std::make_unique<ShardedRouter>(registry_, shard_config);
 }
 
 MultiInstrumentReplayEngine::~MultiInstrumentReplayEngine() = default;
@@ -37,66 +50,71 @@ void MultiInstrumentReplayEngine::register_event_callback(
 MultiReplayStats MultiInstrumentReplayEngine::run() {
     MultiReplayStats stats{};
 
+    if (!lock_process_memory(config_.threading)) {
+        std::cerr << "Warning: mlockall failed; pages stay swappable\n";
+    }
+    // Auto-discovered pipelines are built during the replay, so NUMA_LOCAL
+    // memory lands on the matching CPU's node (partitioned: the workers
+    // match, and the caller only parses)
+    ScopedThreadPlacement placement(config_.threading,
+                                    partitioned() ? ThreadRole::Ingress : ThreadRole::Matching);
+
     L3FeedParser parser;
+    parser.set_parse_threads(config_.parse_threads, config_.parse_chunk_bytes);
     if (!parser.open(config_.input_path)) {
         std::cerr << "Failed to open input file: " << config_.input_path << "\n";
         return stats;
     }
 
-    // Auto-discovery pass: read through to find all symbols, then rewind
-    if (config_.auto_discover && !router_) {
-        L3Record record;
-        while (parser.next(record)) {
-            if (!record.valid) continue;
-            if (!record.symbol.empty() &&
-                auto_symbol_map_.find(record.symbol) == auto_symbol_map_.end()) {
-                InstrumentId id = next_auto_id_++;
-                auto_symbol_map_[record.symbol] = id;
-
-                InstrumentConfig cfg;
-                cfg.instrument_id = id;
-                cfg.symbol = record.symbol;
-                cfg.min_price = config_.default_min_price;
-                cfg.max_price = config_.default_max_price;
-                cfg.tick_size = config_.default_tick_size;
-                cfg.max_orders = config_.default_max_orders;
-                registry_.register_instrument(cfg);
-            }
-        }
-        parser.reset();
-
-        if (registry_.count() == 0) {
-            std::cerr << "No instruments discovered in file\n";
-            return stats;
-        }
-
-        router_ = std::make_unique<InstrumentRouter>(registry_, event_buffer_.get());
-    }
-
     // Set up publisher and callbacks
     publisher_ = std::make_unique<MarketDataPublisher>(*event_buffer_);
     for (auto& cb : callbacks_) {
         publisher_->register_callback(cb);
     }
 
-    // Build symbol -> InstrumentId map for routing
-    std::unordered_map<std::string, InstrumentId> symbol_map;
-    for (const auto& cfg : registry_.instruments()) {
-        symbol_map[cfg.symbol] = cfg.instrument_id;
-    }
-
-    // Initialize per-instrument stats
-    std::unordered_map<InstrumentId, size_t> id_to_stat_index;
+    // Initialize per-instrument stats (auto-discovered ones are appended)
     for (const auto& cfg : registry_.instruments()) {
-        size_t idx = stats.per_instrument.size();
         PerInstrumentStats ps;
         ps.instrument_id = cfg.instrument_id;
         ps.symbol = cfg.symbol;
         stats.per_instrument.push_back(ps);
-        id_to_stat_index[cfg.instrument_id] = idx;
     }
 
     auto start_time = std::chrono::high_resolution_clock::now();
+    if (sharded_) sharded_->start();
+
+    // Book-changing records are routed in batches (see ReplayEngine::run).
+    const size_t batch_size = (config_.batch_size == 0) ? 1 : config_.batch_size;
+    std::vector<OrderMessage> batch;
+    std::vector<size_t> stat_index;
+    std::vector<GatewayResult> results(batch_size);
+    batch.reserve(batch_size);
+    stat_index.reserve(batch_size);
+
+    // Parser symbol id -> index into stats.per_instrument (or a marker),
+    // so each symbol is looked up by name only once
+    constexpr size_t UNRESOLVED_SYMBOL = SIZE_MAX;
+    std::vector<size_t> symbol_stats;
+    size_t default_stat = UNRESOLVED_SYMBOL;  // Rows without a symbol column
+
+    // Serial: batch for the router. Partitioned: straight to the workers,
+    // merging their events every batch_size messages
+    size_t since_pump = 0;
+    auto route = [&](const OrderMessage& msg, size_t stat) {
+        if (sharded_) {
+            submit_partitioned(msg);
+            if (++since_pump == batch_size) {
+                since_pump = 0;
+                (void)pump_merged_events();
+            }
+            return;
+        }
+        batch.push_back(msg);
+        stat_index.push_back(stat);
+        if (batch.size() == batch_size) {
+            flush_batch(batch, stat_index, results, stats);
+        }
+    };
 
     L3Record record;
     while (parser.next(record)) {
@@ -111,60 +129,44 @@ MultiReplayStats MultiInstrumentReplayEngine::run() {
             continue;
         }
 
-        // Resolve instrument_id from symbol
-        InstrumentId inst_id = DEFAULT_INSTRUMENT_ID;
-        if (!record.symbol.empty()) {
-            auto it = symbol_map.find(record.symbol);
-            if (it == symbol_map.end()) {
+        size_t stat = default_stat;
+        if (record.symbol_id != L3_NO_SYMBOL) {
+            if (record.symbol_id >= symbol_stats.size()) {
+                symbol_stats.resize(record.symbol_id + 1, UNRESOLVED_SYMBOL);
+            }
+            size_t& resolved = symbol_stats[record.symbol_id];
+            if (resolved == UNRESOLVED_SYMBOL) {
+                resolved = resolve_symbol(record.symbol, stats);
+            }
+            if (resolved == UNKNOWN_STAT) {
                 if (config_.verbose) {
                     std::cerr << "Unknown symbol: " << record.symbol << "\n";
                 }
                 continue;
             }
-            inst_id = it->second;
+            stat = resolved;
+        } else if (stat == UNRESOLVED_SYMBOL) {
+            stat = default_stat = find_stat(DEFAULT_INSTRUMENT_ID, stats);
         }
-
-        auto stat_it = id_to_stat_index.find(inst_id);
-        if (stat_it == id_to_stat_index.end()) continue;
-        PerInstrumentStats& ps = stats.per_instrument[stat_it->second];
+        if (stat == UNKNOWN_STAT) continue;
+        PerInstrumentStats& ps = stats.per_instrument[stat];
+        const InstrumentId inst_id = ps.instrument_id;
 
         switch (record.event_type) {
-            case L3EventType::Add: {
+            case L3EventType::Add:
                 ++ps.add_messages;
-                OrderMessage msg = L3FeedParser::to_order_message(record, inst_id);
-                GatewayResult result = router_->process_order(msg);
-                if (result.accepted) {
-                    ++ps.orders_accepted;
-                    ps.trades_generated += result.trade_count;
-                } else {
-                    ++ps.orders_rejected;
-                }
+                route(L3FeedParser::to_order_message(record, inst_id), stat);
                 break;
-            }
 
-            case L3EventType::Cancel: {
+            case L3EventType::Cancel:
                 ++ps.cancel_messages;
-                bool cancelled = router_->process_cancel(inst_id, record.order_id);
-                if (cancelled) {
-                    ++ps.orders_cancelled;
-                } else {
-                    ++ps.cancel_failures;
-                }
+                route(L3FeedParser::to_cancel_message(record, inst_id), stat);
                 break;
-            }
 
-            case L3EventType::Modify: {
+            case L3EventType::Modify:
                 ++ps.modify_messages;
-                OrderMessage msg = L3FeedParser::to_modify_message(record, inst_id);
-                GatewayResult result = router_->process_modify(msg);
-                if (result.accepted) {
-                    ++ps.orders_modified;
-                    ps.trades_generated += result.trade_count;
-                } else {
-                    ++ps.modify_failures;
-                }
+                route(L3FeedParser::to_modify_message(record, inst_id), stat);
                 break;
-            }
 
             case L3EventType::Trade:
                 ++ps.trade_messages;
@@ -174,13 +176,35 @@ MultiReplayStats MultiInstrumentReplayEngine::run() {
                 ++stats.parse_errors;
                 break;
         }
+    }
+    flush_batch(batch, stat_index, results, stats);
 
-        // Drain publisher events
-        if (publisher_) {
-            (void)publisher_->poll();
+    if (sharded_) {
+        // Let the workers finish, keeping their rings moving, then take
+        // the last of their events and the counted results
+        while (!sharded_->idle()) {
+            if (pump_merged_events() == 0) cpu_relax();
+        }
+        sharded_->stop();
+        while (pump_merged_events() != 0) {
+        }
+        for (auto& ps : stats.per_instrument) {
+            if (const InstrumentOutcomes* o = sharded_->outcomes(ps.instrument_id)) {
+                ps.orders_accepted = o->orders_accepted;
+                ps.orders_rejected = o->orders_rejected;
+                ps.orders_cancelled = o->orders_cancelled;
+                ps.cancel_failures = o->cancel_failures;
+                ps.orders_modified = o->orders_modified;
+                ps.modify_failures = o->modify_failures;
+                ps.trades_generated = o->trades_generated;
+            }
         }
     }
 
+    if (config_.auto_discover && registry_.count() == 0) {
+        std::cerr << "No instruments discovered in file\n";
+    }
+
     // Final drain
     if (publisher_) {
         (void)publisher_->poll();
@@ -189,6 +213,9 @@ MultiReplayStats MultiInstrumentReplayEngine::run() {
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end_time - start_time;
 
+    if (!parser.input_error().empty()) {
+        std::cerr << "Warning: input ended early: " << parser.input_error() << "\n";
+    }
     stats.parse_errors = parser.parse_errors();
     stats.elapsed_seconds = elapsed.count();
     stats.messages_per_second =
@@ -198,14 +225,25 @@ MultiReplayStats MultiInstrumentReplayEngine::run() {
 
     // Collect final per-instrument book state
     for (auto& ps : stats.per_instrument) {
-        const OrderBook* book = router_->order_book(ps.instrument_id);
+        const OrderBook* book = order_book(ps.instrument_id);
         if (book) {
             ps.final_order_count = book->order_count();
+            ps.final_book_digest = book->compute_state_digest();
             const PriceLevel* bid = book->best_bid();
             const PriceLevel* ask = book->best_ask();
             ps.final_best_bid = bid ? bid->price : 0;
             ps.final_best_ask = ask ? ask->price : 0;
         }
+        if (const InstrumentPipeline* p = pipeline(ps.instrument_id)) {
+            ps.memory = p->memory_usage();
+        }
+    }
+    stats.memory = sharded_ ? sharded_->memory_usage() : router_->memory_usage();
+    stats.event_ring = heap_usage(event_buffer_.get(), sizeof(EventBuffer));
+    if (sharded_) {
+        for (size_t w = 0; w < sharded_->shard_count(); ++w) {
+            stats.event_ring += heap_usage(&sharded_->shard_events(w), sizeof(EventBuffer));
+        }
     }
 
     parser.close();
@@ -217,6 +255,125 @@ MultiReplayStats MultiInstrumentReplayEngine::run() {
     return stats;
 }
 
+size_t MultiInstrumentReplayEngine::find_stat(InstrumentId id,
+                                              const MultiReplayStats& stats) const {
+    for (size_t i = 0; i < stats.per_instrument.size(); ++i) {
+        if (stats.per_instrument[i].instrument_id == id) return i;
+    }
+    return UNKNOWN_STAT;
+}
+
+size_t MultiInstrumentReplayEngine::resolve_symbol(std::string_view symbol,
+                                                   MultiReplayStats& stats) {
+    const std::string name(symbol);
+    if (const InstrumentConfig* cfg = registry_.find_by_symbol(name)) {
+        return find_stat(cfg->instrument_id, stats);
+    }
+    if (!config_.auto_discover) return UNKNOWN_STAT;
+
+    // First sight of a new symbol: register it and build its pipeline
+    while (registry_.find_by_id(next_auto_id_)) ++next_auto_id_;
+    InstrumentConfig cfg;
+    cfg.instrument_id = next_auto_id_++;
+    cfg.symbol = name;
+    cfg.min_price = config_.default_min_price;
+    cfg.max_price = config_.default_max_price;
+    cfg.tick_size = config_.default_tick_size;
+    cfg.max_orders = config_.default_max_orders;
+    const bool routed = registry_.register_instrument(cfg) &&
+                        (sharded_ ? sharded_->add_instrument(cfg) : router_->add_instrument(cfg));
+    if (!routed) {
+        return UNKNOWN_STAT;
+    }
+
+    PerInstrumentStats ps;
+    ps.instrument_id = cfg.instrument_id;
+    ps.symbol = name;
+    stats.per_instrument.push_back(ps);
+    return stats.per_instrument.size() - 1;
+}
+
+const OrderBook* MultiInstrumentReplayEngine::order_book(InstrumentId id) const {
+    return sharded_ ? sharded_->order_book(id) : router_->order_book(id);
+}
+
+const InstrumentPipeline* MultiInstrumentReplayEngine::pipeline(InstrumentId id) const {
+    return sharded_ ? sharded_->pipeline(id) : router_->pipeline(id);
+}
+
+void MultiInstrumentReplayEngine::submit_partitioned(const OrderMessage& msg) {
+    if (sharded_->shard_of(msg.instrument_id) == ShardedRouter::INVALID_SHARD) return;
+    while (!sharded_->submit(msg)) {
+        // Ingress full: the worker may be waiting on its event ring
+        if (pump_merged_events() == 0) cpu_relax();
+    }
+}
+
+size_t MultiInstrumentReplayEngine::pump_merged_events() {
+    if (!config_.merge_events) return 0;
+    constexpr size_t CHUNK = 256;
+    EventMessage merged[CHUNK];
+    const size_t n = sharded_->merge(merged, CHUNK);
+    for (size_t i = 0; i < n; ++i) {
+        while (!event_buffer_->try_push(merged[i])) {
+            // Full: dispatch what it holds; other cursors drain on their own
+            if (publisher_->poll() == 0) cpu_relax();
+        }
+    }
+    (void)publisher_->poll();
+    return n;
+}
+
+void MultiInstrumentReplayEngine::flush_batch(
+    std::vector<OrderMessage>& batch, std::vector<size_t>& stat_index,
+    std::vector<GatewayResult>& results, MultiReplayStats& stats) {
+    if (batch.empty()) return;
+    router_->process_batch(batch.data(), batch.size(), results.data());
+    // Between batches, off the message path
+    (void)router_->release_throttled();
+    (void)router_->maintain();
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        PerInstrumentStats& ps = stats.per_instrument[stat_index[i]];
+        const GatewayResult& result = results[i];
+
+        switch (batch[i].type) {
+            case MessageType::Add:
+                if (result.accepted) {
+                    ++ps.orders_accepted;
+                    ps.trades_generated += result.trade_count;
+                } else {
+                    ++ps.orders_rejected;
+                }
+                break;
+
+            case MessageType::Cancel:
+                if (result.accepted) {
+                    ++ps.orders_cancelled;
+                } else {
+                    ++ps.cancel_failures;
+                }
+                break;
+
+            case MessageType::Modify:
+                if (result.accepted) {
+                    ++ps.orders_modified;
+                    ps.trades_generated += result.trade_count;
+                } else {
+                    ++ps.modify_failures;
+                }
+                break;
+        }
+    }
+    batch.clear();
+    stat_index.clear();
+
+    // Drain publisher events once per batch
+    if (publisher_) {
+        (void)publisher_->poll();
+    }
+}
+
 void MultiInstrumentReplayEngine::write_report(
     const MultiReplayStats& stats) const {
     nlohmann::json report;
@@ -231,6 +388,18 @@ void MultiInstrumentReplayEngine::write_report(
     auto price_to_double = [](Price p) -> double {
         return static_cast<double>(p) / static_cast<double>(PRICE_SCALE);
     };
+    auto memory_to_json = [](const MemoryUsage& usage) {
+        nlohmann::json j;
+        j["reserved_bytes"] = usage.reserved_bytes;
+        j["touched_bytes"] = usage.touched_bytes;
+        j["high_water_bytes"] = usage.high_water_bytes;
+        return j;
+    };
+
+    report["memory"]["total"] = memory_to_json(stats.memory.total());
+    report["memory"]["instruments"] = memory_to_json(stats.memory.instruments);
+    report["memory"]["shared_pool"] = memory_to_json(stats.memory.shared_pool);
+    report["memory"]["event_ring"] = memory_to_json(stats.event_ring);
 
     nlohmann::json instruments = nlohmann::json::array();
     for (const auto& ps : stats.per_instrument) {
@@ -247,8 +416,17 @@ void MultiInstrumentReplayEngine::write_report(
         inst["orders"]["modified"] = ps.orders_modified;
         inst["trades"]["generated"] = ps.trades_generated;
         inst["final_state"]["order_count"] = ps.final_order_count;
+        char digest[17];
+        std::snprintf(digest, sizeof(digest), "%016llx",
+                      static_cast<unsigned long long>(ps.final_book_digest));
+        inst["final_state"]["book_digest"] = digest;
         inst["final_state"]["best_bid"] = price_to_double(ps.final_best_bid);
         inst["final_state"]["best_ask"] = price_to_double(ps.final_best_ask);
+        inst["memory"]["total"] = memory_to_json(ps.memory.total());
+        inst["memory"]["levels"] = memory_to_json(ps.memory.book.levels);
+        inst["memory"]["order_index"] = memory_to_json(ps.memory.book.order_index);
+        inst["memory"]["pool"] = memory_to_json(ps.memory.pool);
+        inst["memory"]["event_overflow"] = memory_to_json(ps.memory.events);
         instruments.push_back(inst);
     }
     report["instruments"] = instruments;
@@ -6,18 +6,42 @@
 /// Reads a 7-column CSV (symbol,timestamp,event_type,...), routes each
 /// message to the correct per-instrument pipeline via InstrumentRouter,
 /// and collects per-instrument statistics.
+///
+/// With auto_discover, a symbol's instrument and pipeline are created the
+/// first time it appears, so the file is read once. Symbols are resolved
+/// by their parser-interned id, so a row costs no name lookup.
+///
+/// Partitioned replay (MultiReplayConfig::matching_workers > 0): books of
+/// different instruments are independent, so the caller only parses and
+/// routes, and a ShardedRouter runs the pipelines on that many matching
+/// workers, each owning a subset of the instruments (auto-discovered ones
+/// go to the least loaded worker). Every instrument still sees its orders
+/// in file order, so its book and PerInstrumentStats match the serial
+/// replay; the workers count the GatewayResults the stats need
+/// (ShardedRouterConfig::count_outcomes). With merge_events, the caller
+/// interleaves the workers' events by order timestamp into the global
+/// event ring (ShardedRouter::merge), so callbacks and cursors see one
+/// stream. Each instrument's events are exactly the serial replay's;
+/// across workers they follow the file's timestamps, except that events
+/// carrying none (cancels, level updates) take their worker's last
+/// timestamp and may come out ahead of other workers' events that
+/// preceded them in the file. Books are then read
+/// through order_book(); router() belongs to the serial mode and routes
+/// nothing.
 
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include "core/types.h"
 #include "feed/l3_feed_parser.h"
 #include "gateway/instrument_registry.h"
 #include "gateway/instrument_router.h"
+#include "gateway/sharded_router.h"
+#include "utils/thread_placement.h"
 #include "gateway/market_data_publisher.h"
 #include "transport/event_buffer.h"
 #include "transport/message.h"
@@ -34,7 +58,20 @@ struct MultiReplayConfig {
     Price default_max_price  = 100000LL * PRICE_SCALE;
     Price default_tick_size  = PRICE_SCALE / 100;
     size_t default_max_orders = 100000;
+    size_t batch_size = 64;       // messages per process_batch (1 = one at a time)
     bool verbose = false;
+    /// The replay runs on the caller, placed in the matching role.
+    ThreadingConfig threading;
+    /// Worker threads parsing the CSV in chunks (0 = on the caller).
+    size_t parse_threads = 0;
+    size_t parse_chunk_bytes = L3FeedParser::DEFAULT_CHUNK_BYTES;
+    /// > 0: partitioned replay on this many matching workers (worker w
+    /// takes matching role index w; the caller takes the ingress role).
+    size_t matching_workers = 0;
+    ShardAssignment worker_assignment = ShardAssignment::RoundRobin;
+    /// Partitioned: merge the workers' events into the global event ring.
+    /// Off, they are not published at all.
+    bool merge_events = true;
 };
 
 /// Per-instrument statistics collected during replay.
@@ -55,6 +92,8 @@ struct PerInstrumentStats {
     Price final_best_bid = 0;
     Price final_best_ask = 0;
     size_t final_order_count = 0;
+    uint64_t final_book_digest = 0;   // OrderBook::compute_state_digest()
+    PipelineMemoryUsage memory;       // At the end of the run
 };
 
 /// Aggregate statistics across all instruments.
@@ -64,6 +103,8 @@ struct MultiReplayStats {
     double elapsed_seconds = 0.0;
     double messages_per_second = 0.0;
     std::vector<PerInstrumentStats> per_instrument;
+    RouterMemoryUsage memory;         // All pipelines and the shared pool
+    MemoryUsage event_ring;           // Shared outbound EventBuffer
 };
 
 /// Multi-instrument replay engine.
@@ -81,25 +122,67 @@ public:
     /// Register a callback to receive EventMessages during replay.
     void register_event_callback(std::function<void(const EventMessage&)> cb);
 
-    /// Access the router (valid after construction).
+    /// Access the router (valid after construction). Serial mode only: a
+    /// partitioned replay's pipelines live in its workers.
     [[nodiscard]] const InstrumentRouter& router() const { return *router_; }
 
+    /// An instrument's book in either mode (after run()). nullptr if the
+    /// id is unknown.
+    [[nodiscard]] const OrderBook* order_book(InstrumentId id) const;
+
+    /// The partitioned replay's router (nullptr in serial mode).
+    [[nodiscard]] const ShardedRouter* sharded_router() const { return sharded_.get(); }
+
     /// Access the registry.
     [[nodiscard]] const InstrumentRegistry& registry() const { return registry_; }
 
+    /// The shared outbound event ring. Consumers on their own threads add
+    /// a cursor to it before run().
+    [[nodiscard]] EventBuffer* event_buffer() const { return event_buffer_.get(); }
+
 private:
+    /// Route the buffered messages and fold results into the per-instrument
+    /// stats (`stat_index[i]` selects the entry for message i).
+    void flush_batch(std::vector<OrderMessage>& batch,
+                     std::vector<size_t>& stat_index,
+                     std::vector<GatewayResult>& results,
+                     MultiReplayStats& stats);
+
+    /// Index into stats.per_instrument for `symbol`, registering it (and
+    /// adding its pipeline) under auto_discover. UNKNOWN_STAT if it is not
+    /// routed.
+    size_t resolve_symbol(std::string_view symbol, MultiReplayStats& stats);
+
+    /// Index into stats.per_instrument for `id`, or UNKNOWN_STAT.
+    size_t find_stat(InstrumentId id, const MultiReplayStats& stats) const;
+
     void write_report(const MultiReplayStats& stats) const;
 
+    [[nodiscard]] bool partitioned() const noexcept { return config_.matching_workers > 0; }
+
+    /// Partitioned: hand `msg` to its worker, merging events while the
+    /// worker's ingress is full.
+    void submit_partitioned(const OrderMessage& msg);
+
+    /// Partitioned: move the events the workers have published, in merged
+    /// order, into the global ring and dispatch them. Returns the number
+    /// moved.
+    size_t pump_merged_events();
+
+    [[nodiscard]] const InstrumentPipeline* pipeline(InstrumentId id) const;
+
+    static constexpr size_t UNKNOWN_STAT = SIZE_MAX - 1;
+
     MultiReplayConfig config_;
     InstrumentRegistry registry_;
     std::unique_ptr<EventBuffer> event_buffer_;
     std::unique_ptr<InstrumentRouter> router_;
+    std::unique_ptr<ShardedRouter> sharded_;   // Partitioned mode only
     std::unique_ptr<MarketDataPublisher> publisher_;
     std::vector<std::function<void(const EventMessage&)>> callbacks_;
 
     // Auto-discovery state
     InstrumentId next_auto_id_ = 0;
-    std::unordered_map<std::string, InstrumentId> auto_symbol_map_;
 };
 
 }  // namespace hft
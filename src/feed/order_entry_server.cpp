@@ -0,0 +1,802 @@
+#include "feed/order_entry_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "feed/fix_parser.h"
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+/// Provided-buffer group of the receive buffers.
+static constexpr uint16_t RECEIVE_GROUP = 0;
+
+/// Session slot bits in a session tag; the rest is the connection's
+/// generation, so a reused slot never reuses OrderIds.
+static constexpr uint32_t SLOT_BITS = 12;
+static constexpr uint32_t GENERATION_MASK = (1u << (32 - SLOT_BITS)) - 1;
+static_assert(OrderEntryServer::MAX_SESSIONS == (size_t{1} << SLOT_BITS),
+              "A session tag holds the slot in its low SLOT_BITS");
+
+/// What a completion belongs to: op | slot << 8 | generation << 32.
+enum Op : uint8_t { OP_ACCEPT = 1, OP_RECEIVE = 2, OP_WRITE = 3, OP_WAKEUP = 4 };
+
+static uint64_t user_data(Op op, uint32_t slot = 0, uint32_t generation = 0) {
+    return static_cast<uint64_t>(op) | (static_cast<uint64_t>(slot) << 8) |
+           (static_cast<uint64_t>(generation) << 32);
+}
+
+static std::string errno_text(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+static size_t round_down_pow2(size_t n) {
+    size_t p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+/// Bytes of a valid inbound binary message of this template (0: unknown).
+static size_t binary_length(uint16_t template_id) {
+    switch (static_cast<oep::Template>(template_id)) {
+        case oep::Template::NewOrder:
+            return sizeof(oep::MessageHeader) + sizeof(oep::NewOrder);
+        case oep::Template::CancelOrder:
+            return sizeof(oep::MessageHeader) + sizeof(oep::CancelOrder);
+        case oep::Template::ReplaceOrder:
+            return sizeof(oep::MessageHeader) + sizeof(oep::ReplaceOrder);
+        default:
+            return 0;
+    }
+}
+
+/// Whether `header` frames a known message that fits Session::partial.
+static bool valid_binary_header(const oep::MessageHeader& header) {
+    return header.length == binary_length(header.template_id) &&
+           header.length >= sizeof(oep::MessageHeader) &&
+           header.length <= oep::MAX_INBOUND_BYTES;
+}
+
+/// A binary ClOrdID as ClOrdIdTable key bytes.
+static std::string_view key_of(const uint64_t& cl_ord_id) {
+    return std::string_view(reinterpret_cast<const char*>(&cl_ord_id), sizeof(cl_ord_id));
+}
+
+// ---------------------------------------------------------------------------
+// Session
+// ---------------------------------------------------------------------------
+
+struct OrderEntryServer::Session {
+    Session(size_t orders, size_t receive_bytes, size_t max_message)
+        : ids(orders), framer(receive_bytes, max_message) {}
+
+    int fd = -1;
+    uint32_t slot = 0;
+    uint32_t generation = 0;
+    uint32_t tag = 0;              // generation << SLOT_BITS | slot
+    bool connected = false;        // False once shut down
+    bool receive_armed = false;    // Multishot receive outstanding
+    bool write_in_flight = false;
+    bool flush_queued = false;
+
+    fix::ClOrdIdTable ids;
+    fix::FixFramer framer;         // FIX
+    uint64_t framer_errors = 0;    // framer.errors() already counted
+    char partial[oep::MAX_INBOUND_BYTES];  // Binary: message split across receives
+    size_t partial_bytes = 0;
+
+    // Send buffer: [sent, fill) is pending; while a write is in flight
+    // the kernel reads [sent, in_flight) and reports go after fill.
+    char* out = nullptr;
+    size_t out_capacity = 0;
+    size_t out_sent = 0;
+    size_t out_in_flight = 0;
+    size_t out_fill = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Setup / teardown
+// ---------------------------------------------------------------------------
+
+OrderEntryServer::OrderEntryServer(const OrderEntryConfig& config, IngressBuffer& ingress)
+    : config_(config),
+      ingress_(ingress),
+      writer_(config.symbol, config.sender_comp_id, config.target_comp_id) {}
+
+OrderEntryServer::~OrderEntryServer() { close(); }
+
+bool OrderEntryServer::open() {
+    if (running_) return true;
+    error_.clear();
+    stopping_.store(false, std::memory_order_relaxed);
+
+    const size_t max_sessions = std::clamp<size_t>(config_.max_sessions, 1, MAX_SESSIONS);
+    const size_t receive_buffers =
+        round_down_pow2(std::clamp<size_t>(config_.receive_buffers, 1, 32768));
+    const size_t receive_bytes = std::max<size_t>(config_.receive_buffer_bytes, 256);
+    const size_t send_bytes = std::max(config_.send_buffer_bytes,
+                                       writer_.max_report_bytes() * 2);
+
+    if (!ring_.open(std::max(config_.ring_entries, 16u), error_)) return false;
+
+    // Receive side: one shared provided-buffer ring
+    receive_area_ = std::make_unique<char[]>(receive_buffers * receive_bytes);
+    if (!ring_.register_buffer_ring(RECEIVE_GROUP, receive_area_.get(), receive_bytes,
+                                    static_cast<uint16_t>(receive_buffers))) {
+        error_ = errno_text("register provided buffers");
+        ring_.close();
+        return false;
+    }
+
+    // Send side: one registered region, a slice per session
+    send_area_ = std::make_unique<char[]>(max_sessions * send_bytes);
+    iovec region{send_area_.get(), max_sessions * send_bytes};
+    if (!ring_.register_buffers(&region, 1)) {
+        error_ = errno_text("register send buffers (RLIMIT_MEMLOCK?)");
+        ring_.close();
+        return false;
+    }
+
+    // FIX sessions frame in a per-session buffer; binary ones need none
+    const bool fix = config_.protocol == OrderEntryProtocol::Fix;
+    const size_t framer_bytes = fix ? config_.session_receive_bytes : 0;
+    const size_t max_message = fix ? std::min(fix::FixFramer::DEFAULT_MAX_MESSAGE,
+                                              std::max<size_t>(framer_bytes / 2, 512))
+                                   : 64;
+    sessions_.clear();
+    free_sessions_.clear();
+    for (size_t i = 0; i < max_sessions; ++i) {
+        auto session = std::make_unique<Session>(config_.orders_per_session, framer_bytes,
+                                                 max_message);
+        session->slot = static_cast<uint32_t>(i);
+        session->out = send_area_.get() + i * send_bytes;
+        session->out_capacity = send_bytes;
+        sessions_.push_back(std::move(session));
+    }
+    for (size_t i = max_sessions; i-- > 0;) free_sessions_.push_back(static_cast<uint32_t>(i));
+    flush_list_.clear();
+    flush_list_.reserve(max_sessions);
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        error_ = errno_text("socket");
+        close();
+        return false;
+    }
+    const int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    if (::inet_pton(AF_INET, config_.bind_address.c_str(), &addr.sin_addr) != 1) {
+        error_ = "invalid bind address: " + config_.bind_address;
+        close();
+        return false;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        error_ = errno_text("bind");
+        close();
+        return false;
+    }
+    if (::listen(listen_fd_, config_.listen_backlog) < 0) {
+        error_ = errno_text("listen");
+        close();
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port_ = ntohs(addr.sin_port);
+
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        error_ = errno_text("eventfd");
+        close();
+        return false;
+    }
+
+    events_ = std::make_unique<EventRing>();
+    startup_.store(0, std::memory_order_relaxed);
+    io_thread_ = std::thread([this] { io_loop(); });
+    int state = 0;
+    while ((state = startup_.load(std::memory_order_acquire)) == 0) std::this_thread::yield();
+    running_ = true;
+    if (state != 1) {
+        error_ = "io_uring: cannot enable the ring on the I/O thread";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void OrderEntryServer::close() {
+    if (running_) {
+        stopping_.store(true, std::memory_order_release);
+        const uint64_t one = 1;
+        (void)!::write(wake_fd_, &one, sizeof(one));
+        if (io_thread_.joinable()) io_thread_.join();
+        running_ = false;
+    }
+    // The I/O thread is gone: in-flight requests die with the ring
+    ring_.close();
+    for (auto& session : sessions_) {
+        if (session->fd >= 0) {
+            ::close(session->fd);
+            session->fd = -1;
+            sessions_closed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        session->connected = false;
+    }
+    active_sessions_.store(0, std::memory_order_relaxed);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    listen_fd_ = wake_fd_ = -1;
+}
+
+OrderEntryStats OrderEntryServer::stats() const {
+    OrderEntryStats s;
+    s.sessions_accepted = sessions_accepted_.load(std::memory_order_relaxed);
+    s.sessions_refused = sessions_refused_.load(std::memory_order_relaxed);
+    s.sessions_closed = sessions_closed_.load(std::memory_order_relaxed);
+    s.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    s.messages_received = messages_received_.load(std::memory_order_relaxed);
+    s.orders_submitted = orders_submitted_.load(std::memory_order_relaxed);
+    s.orders_rejected = orders_rejected_.load(std::memory_order_relaxed);
+    s.messages_invalid = messages_invalid_.load(std::memory_order_relaxed);
+    s.messages_ignored = messages_ignored_.load(std::memory_order_relaxed);
+    s.events_dropped = events_dropped_.load(std::memory_order_relaxed);
+    s.reports_sent = reports_sent_.load(std::memory_order_relaxed);
+    s.reports_dropped = reports_dropped_.load(std::memory_order_relaxed);
+    s.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    s.send_calls = send_calls_.load(std::memory_order_relaxed);
+    s.receive_stalls = receive_stalls_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Event side (the event consumer thread)
+// ---------------------------------------------------------------------------
+
+bool OrderEntryServer::on_event(const EventMessage& event) noexcept {
+    if (!events_ || !events_->try_push(event)) {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    wake();
+    return true;
+}
+
+void OrderEntryServer::wake() noexcept {
+    // Orders the push before the sleeper check; pairs with the fence in
+    // io_loop() so a thread that re-checked the ring and found it empty
+    // is always seen sleeping here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!sleeping_.load(std::memory_order_relaxed)) return;
+    const uint64_t one = 1;
+    (void)!::write(wake_fd_, &one, sizeof(one));
+}
+
+// ---------------------------------------------------------------------------
+// I/O thread
+// ---------------------------------------------------------------------------
+
+void OrderEntryServer::io_loop() {
+    ScopedThreadPlacement placement(config_.threading, ThreadRole::Ingress);
+    if (!ring_.enable()) {
+        startup_.store(2, std::memory_order_release);
+        return;
+    }
+    arm_accept();
+    arm_wakeup();
+    startup_.store(1, std::memory_order_release);
+
+    for (;;) {
+        ring_.for_each_cqe([this](const io_uring_cqe& cqe) { handle_completion(cqe); });
+        ring_.publish_buffers();
+        drain_events();
+        for (uint32_t slot : flush_list_) {
+            Session& s = *sessions_[slot];
+            s.flush_queued = false;
+            flush_output(s);
+        }
+        flush_list_.clear();
+        if (stopping_.load(std::memory_order_acquire)) break;
+
+        unsigned wait_for = config_.busy_poll ? 0 : 1;
+        if (wait_for != 0) {
+            sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!events_->empty() || stopping_.load(std::memory_order_acquire)) wait_for = 0;
+        }
+        (void)ring_.submit(wait_for);
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+io_uring_sqe* OrderEntryServer::next_sqe() {
+    io_uring_sqe* sqe = ring_.get_sqe();
+    if (sqe == nullptr) {
+        // Queue full: hand the batch to the kernel now
+        (void)ring_.submit(0);
+        sqe = ring_.get_sqe();
+    }
+    return sqe;
+}
+
+void OrderEntryServer::arm_accept() {
+    io_uring_sqe* sqe = next_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = user_data(OP_ACCEPT);
+    accept_armed_ = true;
+}
+
+void OrderEntryServer::arm_wakeup() {
+    io_uring_sqe* sqe = next_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+    sqe->len = sizeof(wake_value_);
+    sqe->user_data = user_data(OP_WAKEUP);
+}
+
+void OrderEntryServer::arm_receive(Session& s) {
+    io_uring_sqe* sqe = next_sqe();
+    if (sqe == nullptr) {
+        shutdown_session(s);
+        release_session(s);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = s.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECEIVE_GROUP;
+    sqe->user_data = user_data(OP_RECEIVE, s.slot, s.generation);
+    s.receive_armed = true;
+}
+
+void OrderEntryServer::handle_completion(const io_uring_cqe& cqe) {
+    const auto op = static_cast<Op>(cqe.user_data & 0xFF);
+    if (op == OP_ACCEPT) {
+        on_accept(cqe.res, cqe.flags);
+        return;
+    }
+    if (op == OP_WAKEUP) {
+        if (!stopping_.load(std::memory_order_acquire)) arm_wakeup();
+        return;
+    }
+    const auto slot = static_cast<uint32_t>((cqe.user_data >> 8) & 0xFFFF);
+    const auto generation = static_cast<uint32_t>(cqe.user_data >> 32);
+    Session& s = *sessions_[slot];
+    if (op == OP_RECEIVE) {
+        on_receive(s, cqe.res, cqe.flags);
+    } else if (s.generation == generation) {
+        on_write(s, cqe.res);
+    }
+}
+
+void OrderEntryServer::on_accept(int result, uint32_t flags) {
+    if (result >= 0) open_session(result);
+    if ((flags & IORING_CQE_F_MORE) == 0) {
+        accept_armed_ = false;
+        if (!stopping_.load(std::memory_order_acquire)) arm_accept();
+    }
+}
+
+void OrderEntryServer::on_receive(Session& s, int result, uint32_t flags) {
+    if (flags & IORING_CQE_F_BUFFER) {
+        const auto bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (result > 0 && s.connected) {
+            const size_t buffer_bytes = std::max<size_t>(config_.receive_buffer_bytes, 256);
+            receive_bytes(s, receive_area_.get() + static_cast<size_t>(bid) * buffer_bytes,
+                          static_cast<size_t>(result));
+        }
+        ring_.recycle_buffer(bid);
+    }
+    if (flags & IORING_CQE_F_MORE) return;
+
+    // The multishot receive ended
+    s.receive_armed = false;
+    if (result == -ENOBUFS && s.connected) {
+        // Every provided buffer was in use; they are back once this batch
+        // of completions is processed
+        receive_stalls_.fetch_add(1, std::memory_order_relaxed);
+        arm_receive(s);
+    } else if (result > 0 && s.connected) {
+        arm_receive(s);
+    } else {
+        shutdown_session(s);   // EOF, reset, or shut down by us
+        release_session(s);
+    }
+}
+
+void OrderEntryServer::on_write(Session& s, int result) {
+    s.write_in_flight = false;
+    if (result < 0) {
+        shutdown_session(s);
+        release_session(s);
+        return;
+    }
+    bytes_sent_.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+    s.out_sent += static_cast<size_t>(result);
+    if (s.out_sent == s.out_fill) {
+        s.out_sent = s.out_in_flight = s.out_fill = 0;
+    } else if (s.connected && !s.flush_queued) {
+        // A short write, or reports queued meanwhile
+        s.flush_queued = true;
+        flush_list_.push_back(s.slot);
+    }
+    release_session(s);
+}
+
+// ---------------------------------------------------------------------------
+// Sessions
+// ---------------------------------------------------------------------------
+
+void OrderEntryServer::open_session(int fd) {
+    if (free_sessions_.empty() || stopping_.load(std::memory_order_acquire)) {
+        ::close(fd);
+        sessions_refused_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const uint32_t slot = free_sessions_.back();
+    free_sessions_.pop_back();
+    Session& s = *sessions_[slot];
+
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    s.fd = fd;
+    s.generation = (s.generation + 1) & GENERATION_MASK;
+    if (s.generation == 0) s.generation = 1;
+    s.tag = (s.generation << SLOT_BITS) | slot;
+    s.ids.reset((static_cast<OrderId>(s.tag) << 32) + 1);
+    s.framer.reset();
+    s.framer_errors = 0;
+    s.partial_bytes = 0;
+    s.out_sent = s.out_in_flight = s.out_fill = 0;
+    s.connected = true;
+    s.write_in_flight = false;
+    s.flush_queued = false;
+    arm_receive(s);
+
+    sessions_accepted_.fetch_add(1, std::memory_order_relaxed);
+    active_sessions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OrderEntryServer::shutdown_session(Session& s) {
+    if (!s.connected) return;
+    s.connected = false;
+    // Ends the multishot receive; release_session() closes the fd once
+    // no request refers to it
+    ::shutdown(s.fd, SHUT_RDWR);
+}
+
+void OrderEntryServer::release_session(Session& s) {
+    if (s.connected || s.receive_armed || s.write_in_flight || s.fd < 0) return;
+    ::close(s.fd);
+    s.fd = -1;
+    free_sessions_.push_back(s.slot);
+    sessions_closed_.fetch_add(1, std::memory_order_relaxed);
+    active_sessions_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Inbound
+// ---------------------------------------------------------------------------
+
+void OrderEntryServer::receive_bytes(Session& s, const char* data, size_t n) {
+    bytes_received_.fetch_add(n, std::memory_order_relaxed);
+    if (config_.protocol == OrderEntryProtocol::Fix) {
+        while (n > 0 && s.connected) {
+            const size_t accepted = s.framer.feed(data, n);
+            data += accepted;
+            n -= accepted;
+            receive_fix(s);
+            if (accepted == 0) break;   // next() was drained: cannot happen
+        }
+    } else {
+        receive_binary(s, data, n);
+    }
+}
+
+void OrderEntryServer::receive_fix(Session& s) {
+    std::string_view message;
+    while (s.framer.next(message)) {
+        messages_received_.fetch_add(1, std::memory_order_relaxed);
+        OrderMessage om{};
+        const fix::FixError e =
+            fix::FixParser::parse_into(message, om, s.ids, config_.instrument_id);
+        if (e == fix::FixError::None) {
+            om.order.participant_id = config_.participant_id;
+            submit(s, om);
+        } else if (e == fix::FixError::NotAnOrder || e == fix::FixError::UnsupportedMsgType) {
+            messages_ignored_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            messages_invalid_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    const uint64_t errors = s.framer.errors();
+    if (errors != s.framer_errors) {
+        messages_invalid_.fetch_add(errors - s.framer_errors, std::memory_order_relaxed);
+        s.framer_errors = errors;
+    }
+}
+
+void OrderEntryServer::receive_binary(Session& s, const char* data, size_t n) {
+    if (!s.connected) return;   // Bytes already queued behind a shutdown
+    oep::MessageHeader header{};
+    bool framed = true;
+    while (n > 0) {
+        // Whole messages decode in place, from the provided buffer
+        if (s.partial_bytes == 0 && n >= sizeof(header)) {
+            std::memcpy(&header, data, sizeof(header));
+            if (!valid_binary_header(header)) {
+                framed = false;
+                break;
+            }
+            if (n >= header.length) {
+                decode_binary(s, data, header);
+                data += header.length;
+                n -= header.length;
+                continue;
+            }
+        }
+        // A message split across receives: gather it in s.partial
+        size_t want = sizeof(header);
+        if (s.partial_bytes >= sizeof(header)) {
+            std::memcpy(&header, s.partial, sizeof(header));
+            if (!valid_binary_header(header)) {
+                framed = false;
+                break;
+            }
+            want = header.length;
+        }
+        const size_t take = std::min(n, want - s.partial_bytes);
+        std::memcpy(s.partial + s.partial_bytes, data, take);
+        s.partial_bytes += take;
+        data += take;
+        n -= take;
+        if (s.partial_bytes < sizeof(header)) continue;
+        std::memcpy(&header, s.partial, sizeof(header));
+        if (!valid_binary_header(header)) {
+            framed = false;   // Even if the header ended this receive
+            break;
+        }
+        if (s.partial_bytes == header.length) {
+            decode_binary(s, s.partial, header);
+            s.partial_bytes = 0;
+        }
+    }
+    if (!framed) {
+        // Unknown template or wrong length: the stream cannot be reframed
+        messages_invalid_.fetch_add(1, std::memory_order_relaxed);
+        s.partial_bytes = 0;
+        shutdown_session(s);
+    }
+}
+
+void OrderEntryServer::decode_binary(Session& s, const char* message,
+                                     const oep::MessageHeader& header) {
+    messages_received_.fetch_add(1, std::memory_order_relaxed);
+    const char* body = message + sizeof(header);
+
+    OrderMessage om{};
+    om.instrument_id = config_.instrument_id;
+    Order& order = om.order;
+    order.instrument_id = config_.instrument_id;
+    order.participant_id = config_.participant_id;
+    order.status = OrderStatus::New;
+    order.type = OrderType::Limit;
+    order.time_in_force = TimeInForce::GTC;
+
+    OrderId id = fix::ClOrdIdTable::NO_ORDER;
+    switch (static_cast<oep::Template>(header.template_id)) {
+        case oep::Template::NewOrder: {
+            oep::NewOrder m;
+            std::memcpy(&m, body, sizeof(m));
+            const auto type = static_cast<OrderType>(m.order_type);
+            const bool type_ok = type == OrderType::Limit || type == OrderType::Market ||
+                                 type == OrderType::IOC || type == OrderType::FOK;
+            if (m.side > 1 || !type_ok || m.quantity == 0 ||
+                m.time_in_force > static_cast<uint8_t>(TimeInForce::DAY)) {
+                break;
+            }
+            id = s.ids.assign(key_of(m.cl_ord_id));
+            om.type = MessageType::Add;
+            order.side = static_cast<Side>(m.side);
+            order.type = type;
+            order.time_in_force = static_cast<TimeInForce>(m.time_in_force);
+            order.price = m.price;
+            order.quantity = m.quantity;
+            order.visible_quantity = m.quantity;
+            break;
+        }
+        case oep::Template::CancelOrder: {
+            oep::CancelOrder m;
+            std::memcpy(&m, body, sizeof(m));
+            id = s.ids.find(key_of(m.orig_cl_ord_id));
+            om.type = MessageType::Cancel;
+            break;
+        }
+        case oep::Template::ReplaceOrder: {
+            oep::ReplaceOrder m;
+            std::memcpy(&m, body, sizeof(m));
+            if (m.quantity == 0) break;
+            id = s.ids.replace(key_of(m.orig_cl_ord_id), key_of(m.cl_ord_id));
+            om.type = MessageType::Modify;
+            order.price = m.price;
+            order.quantity = m.quantity;
+            order.visible_quantity = m.quantity;
+            break;
+        }
+        default:
+            break;
+    }
+    if (id == fix::ClOrdIdTable::NO_ORDER) {
+        messages_invalid_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    order.order_id = id;
+    submit(s, om);
+}
+
+void OrderEntryServer::submit(Session& s, const OrderMessage& om) {
+    if (ingress_.try_push(om)) [[likely]] {
+        orders_submitted_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    orders_rejected_.fetch_add(1, std::memory_order_relaxed);
+    report_rejection(s, om);
+    if (om.type != MessageType::Cancel) {
+        // Never reached the gateway: settle its binding as a rejection (a
+        // refused cancel leaves the order as it was)
+        GatewayResult result{};
+        result.accepted = false;
+        result.reject_reason = GatewayRejectReason::Throttled;
+        s.ids.on_result(om, result);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Outbound
+// ---------------------------------------------------------------------------
+
+void OrderEntryServer::drain_events() {
+    EventMessage event;
+    while (events_->try_pop(event)) {
+        Session* first = nullptr;
+        Session* second = nullptr;
+        auto route = [this](OrderId id) -> Session* {
+            const uint32_t tag = session_tag(id);
+            const uint32_t slot = tag & (MAX_SESSIONS - 1);
+            if (tag == 0 || slot >= sessions_.size()) return nullptr;
+            Session* s = sessions_[slot].get();
+            return (s->connected && s->tag == tag) ? s : nullptr;
+        };
+        switch (event.type) {
+            case EventType::Trade: {
+                const TradeEventData& trade = event.data.trade;
+                first = route(trade.buy_order_id);
+                second = route(trade.sell_order_id);
+                // Report both sides before on_event() may release them
+                if (first) report(*first, event, trade.buy_order_id);
+                if (second) report(*second, event, trade.sell_order_id);
+                if (second == first) second = nullptr;
+                break;
+            }
+            case EventType::LevelUpdate:
+            case EventType::MassCancel:
+            case EventType::BookDigest:
+                break;
+            default:
+                first = route(event.data.order_event.order_id);
+                if (first) report(*first, event, event.data.order_event.order_id);
+                break;
+        }
+        if (first) first->ids.on_event(event);
+        if (second) second->ids.on_event(event);
+    }
+}
+
+void OrderEntryServer::report(Session& s, const EventMessage& event, OrderId order_id) {
+    const std::string_view cl_ord_id = s.ids.cl_ord_id(order_id);
+    if (cl_ord_id.empty()) return;   // Not (or no longer) bound
+
+    if (config_.protocol == OrderEntryProtocol::Fix) {
+        const size_t max_bytes = writer_.max_report_bytes();
+        char* out = reserve_output(s, max_bytes);
+        if (out == nullptr) return;
+        s.out_fill += writer_.write(event, order_id, cl_ord_id, out, max_bytes);
+    } else {
+        constexpr size_t bytes = sizeof(oep::MessageHeader) + sizeof(oep::ExecutionReport);
+        char* out = reserve_output(s, bytes);
+        if (out == nullptr) return;
+        const oep::MessageHeader header{static_cast<uint16_t>(bytes),
+                                        static_cast<uint16_t>(oep::Template::ExecutionReport)};
+        oep::ExecutionReport r{};
+        std::memcpy(&r.cl_ord_id, cl_ord_id.data(),
+                    std::min(cl_ord_id.size(), sizeof(r.cl_ord_id)));
+        r.order_id = order_id;
+        r.event_type = static_cast<uint8_t>(event.type);
+        if (event.type == EventType::Trade) {
+            const TradeEventData& trade = event.data.trade;
+            r.exec_id = trade.trade_id;
+            r.price = trade.price;
+            r.last_quantity = trade.quantity;
+            r.timestamp = trade.timestamp;
+        } else {
+            const OrderEventData& oe = event.data.order_event;
+            r.exec_id = event.sequence_num;
+            r.status = static_cast<uint8_t>(oe.status);
+            r.price = oe.price;
+            r.filled_quantity = oe.filled_quantity;
+            r.remaining_quantity = oe.remaining_quantity;
+            r.timestamp = oe.timestamp;
+        }
+        std::memcpy(out, &header, sizeof(header));
+        std::memcpy(out + sizeof(header), &r, sizeof(r));
+        s.out_fill += bytes;
+    }
+    reports_sent_.fetch_add(1, std::memory_order_relaxed);
+    if (!s.flush_queued) {
+        s.flush_queued = true;
+        flush_list_.push_back(s.slot);
+    }
+}
+
+void OrderEntryServer::report_rejection(Session& s, const OrderMessage& om) {
+    EventMessage event{};
+    event.type = EventType::OrderRejected;
+    event.instrument_id = om.instrument_id;
+    OrderEventData& oe = event.data.order_event;
+    oe.order_id = om.order.order_id;
+    oe.status = OrderStatus::Rejected;
+    oe.remaining_quantity = om.order.quantity;
+    oe.price = om.order.price;
+    report(s, event, om.order.order_id);
+}
+
+char* OrderEntryServer::reserve_output(Session& s, size_t n) noexcept {
+    if (s.out_fill + n > s.out_capacity && !s.write_in_flight && s.out_sent > 0) {
+        std::memmove(s.out, s.out + s.out_sent, s.out_fill - s.out_sent);
+        s.out_fill -= s.out_sent;
+        s.out_sent = s.out_in_flight = 0;
+    }
+    if (s.out_fill + n > s.out_capacity) {
+        reports_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return s.out + s.out_fill;
+}
+
+void OrderEntryServer::flush_output(Session& s) {
+    if (!s.connected || s.write_in_flight || s.out_sent == s.out_fill) return;
+    io_uring_sqe* sqe = next_sqe();
+    if (sqe == nullptr) return;   // Retried with the next report
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = s.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(s.out + s.out_sent);
+    sqe->len = static_cast<uint32_t>(s.out_fill - s.out_sent);
+    sqe->buf_index = 0;
+    sqe->user_data = user_data(OP_WRITE, s.slot, s.generation);
+    s.out_in_flight = s.out_fill;
+    s.write_in_flight = true;
+    send_calls_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace hft
@@ -0,0 +1,319 @@
+#pragma once
+
+/// @file order_entry_server.h
+/// @brief io_uring TCP order-entry server in front of the ingress ring.
+///
+/// Cold-path component. OrderEntryServer accepts client TCP sessions on
+/// one port and runs them all on a single I/O thread over io_uring:
+///   - a multishot accept takes every new connection;
+///   - each session has one multishot receive drawing from a shared ring
+///     of provided buffers, so an idle session holds no buffer;
+///   - every message is framed (FIX, or the compact binary protocol of
+///     namespace oep), resolved through the session's ClOrdIdTable and
+///     decoded straight into an OrderMessage pushed on the IngressBuffer
+///     (the MPSC ring InstrumentRouter::drain() consumes);
+///   - execution reports are written into per-session send buffers, all
+///     slices of one registered buffer, and each session's pending
+///     reports leave as one IORING_OP_WRITE_FIXED per loop iteration; the
+///     iteration's writes and receive re-arms share one io_uring_enter().
+///
+/// Execution reports come from the event stream: register on_event() as a
+/// consumer (e.g. a MarketDataPublisher callback, one thread). Events are
+/// queued over an SPSC ring to the I/O thread, which routes them by order
+/// id: the server numbers the orders of each connection from
+/// (session tag << 32) + 1, so the upper half of an OrderId names its
+/// session. Other order sources sharing the books must keep their ids
+/// below 2^32. A Trade is reported to both sides' sessions. As in
+/// MulticastPublisher, the event thread never waits: with the event ring
+/// full, events are dropped and counted, and so are reports that do not
+/// fit a session's send buffer.
+///
+/// Refusals by the server itself (the ingress ring full) are answered with
+/// an OrderRejected report. Messages that do not parse, name an unknown
+/// OrigClOrdID or reuse a live ClOrdID are counted and dropped without a
+/// reply, as are FIX session-level messages (logon, heartbeats): sessions
+/// are plain TCP connections with no FIX session layer. Orders resting
+/// when their session disconnects stay on the book.
+///
+/// Usage:
+///   OrderEntryConfig config;
+///   config.port = 9001;
+///   OrderEntryServer server(config, ingress);
+///   if (!server.open()) { ... server.error() ... }
+///   publisher.register_callback([&](const EventMessage& e) { (void)server.on_event(e); });
+///   ...                                  // matching thread: router.drain(ingress, ...)
+///   server.close();                      // Closes every session, joins the I/O thread
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "feed/cl_ord_id_table.h"
+#include "feed/fix_framer.h"
+#include "feed/fix_serializer.h"
+#include "feed/io_ring.h"
+#include "transport/ingress_buffer.h"
+#include "transport/message.h"
+#include "transport/spsc_ring_buffer.h"
+#include "utils/thread_placement.h"
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Binary wire schema
+// ---------------------------------------------------------------------------
+
+namespace oep {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "The protocol is encoded in host order, which must be little-endian");
+
+enum class Template : uint16_t {
+    NewOrder = 1,
+    CancelOrder = 2,
+    ReplaceOrder = 3,
+    ExecutionReport = 8   // Server to client
+};
+
+/// Every message: this header, then the template's fixed block.
+struct MessageHeader {
+    uint16_t length;       // Whole message, header included
+    uint16_t template_id;  // Template
+};
+
+/// ClOrdIDs are opaque 8-byte values, unique among a session's live orders.
+struct NewOrder {
+    uint64_t cl_ord_id;
+    Price price;           // Ignored for market orders
+    Quantity quantity;
+    uint8_t side;          // Side
+    uint8_t order_type;    // OrderType (Limit, Market, IOC, FOK)
+    uint8_t time_in_force; // TimeInForce
+    uint8_t reserved[5];
+};
+
+struct CancelOrder {
+    uint64_t cl_ord_id;
+    uint64_t orig_cl_ord_id;
+};
+
+/// New price and quantity of the order named by orig_cl_ord_id, which
+/// takes cl_ord_id once the replace is accepted.
+struct ReplaceOrder {
+    uint64_t cl_ord_id;
+    uint64_t orig_cl_ord_id;
+    Price price;
+    Quantity quantity;
+};
+
+struct ExecutionReport {
+    uint64_t cl_ord_id;
+    OrderId order_id;
+    uint64_t exec_id;          // Trade id for fills, else the event sequence
+    uint8_t event_type;        // EventType
+    uint8_t status;            // OrderStatus (0 for trades)
+    uint8_t reserved[6];
+    Price price;               // Order price, or the trade price
+    Quantity last_quantity;    // Trades: quantity executed
+    Quantity filled_quantity;  // Order events: cumulative
+    Quantity remaining_quantity;
+    Timestamp timestamp;
+};
+
+static_assert(sizeof(MessageHeader) == 4 && sizeof(NewOrder) == 32 &&
+              sizeof(CancelOrder) == 16 && sizeof(ReplaceOrder) == 32 &&
+              sizeof(ExecutionReport) == 72,
+              "Wire structs have fixed, padding-free layouts");
+
+/// Longest inbound message.
+constexpr size_t MAX_INBOUND_BYTES = sizeof(MessageHeader) + sizeof(NewOrder);
+
+}  // namespace oep
+
+// ---------------------------------------------------------------------------
+// Server
+// ---------------------------------------------------------------------------
+
+enum class OrderEntryProtocol : uint8_t {
+    Fix,     // FIX 4.2 35=D/F/G in, 35=8 out (FixFramer, ExecutionReportWriter)
+    Binary   // namespace oep
+};
+
+struct OrderEntryConfig {
+    std::string bind_address = "0.0.0.0";  // Dotted IPv4
+    uint16_t port = 0;                      // 0 = ephemeral (see port())
+    int listen_backlog = 128;
+    OrderEntryProtocol protocol = OrderEntryProtocol::Fix;
+    InstrumentId instrument_id = DEFAULT_INSTRUMENT_ID;  // Every session's orders
+    ParticipantId participant_id = 0;       // Every session's orders
+    std::string symbol = "N/A";             // FIX reports: tag 55
+    std::string sender_comp_id = "HFT-ENGINE";
+    std::string target_comp_id = "CLIENT";
+    size_t max_sessions = 64;               // Concurrent (<= MAX_SESSIONS)
+    size_t orders_per_session = 4096;       // Live ClOrdIDs (ClOrdIdTable capacity)
+    size_t receive_buffers = 512;           // Provided buffers, a power of two
+    size_t receive_buffer_bytes = 4096;
+    size_t session_receive_bytes = 64 << 10;  // FIX: framer buffer per session
+    size_t send_buffer_bytes = 64 << 10;    // Registered send buffer per session
+    unsigned ring_entries = 256;            // Submission queue slots
+    /// Spin on the completion queue instead of sleeping in io_uring_enter().
+    bool busy_poll = false;
+    /// The I/O thread takes the Ingress role.
+    ThreadingConfig threading;
+};
+
+struct OrderEntryStats {
+    uint64_t sessions_accepted = 0;
+    uint64_t sessions_refused = 0;         // Over max_sessions
+    uint64_t sessions_closed = 0;
+    uint64_t bytes_received = 0;
+    uint64_t messages_received = 0;        // Framed messages
+    uint64_t orders_submitted = 0;         // Pushed on the ingress ring
+    uint64_t orders_rejected = 0;          // Ingress ring full (reported)
+    uint64_t messages_invalid = 0;         // Bad frame, parse or ClOrdID error
+    uint64_t messages_ignored = 0;         // Valid but not an order (FIX admin)
+    uint64_t events_dropped = 0;           // Event ring full
+    uint64_t reports_sent = 0;
+    uint64_t reports_dropped = 0;          // Send buffer full
+    uint64_t bytes_sent = 0;
+    uint64_t send_calls = 0;               // Write SQEs
+    uint64_t receive_stalls = 0;           // Receives re-armed after ENOBUFS
+};
+
+class OrderEntryServer {
+public:
+    /// Upper bound on OrderEntryConfig::max_sessions.
+    static constexpr size_t MAX_SESSIONS = 4096;
+
+    /// Events queued between on_event() and the I/O thread.
+    static constexpr size_t EVENT_RING_CAPACITY = 16384;
+
+    /// @param ingress  Ring the decoded orders are pushed on; must outlive
+    ///                 the server.
+    OrderEntryServer(const OrderEntryConfig& config, IngressBuffer& ingress);
+    ~OrderEntryServer();
+
+    OrderEntryServer(const OrderEntryServer&) = delete;
+    OrderEntryServer& operator=(const OrderEntryServer&) = delete;
+
+    /// Set up the ring and buffers, listen and start the I/O thread.
+    /// Returns false (see error()) on failure, e.g. without io_uring.
+    [[nodiscard]] bool open();
+
+    /// Stop the I/O thread, close every session and the listener.
+    /// Idempotent; also called by the destructor.
+    void close();
+
+    [[nodiscard]] bool is_open() const { return running_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    /// Port the listener is bound to (resolves a configured 0).
+    [[nodiscard]] uint16_t port() const { return bound_port_; }
+
+    /// Queue one event for execution reports. Call from one thread at a
+    /// time. Never blocks; returns false if the event was dropped.
+    bool on_event(const EventMessage& event) noexcept;
+
+    /// Sessions connected now.
+    [[nodiscard]] size_t session_count() const noexcept {
+        return active_sessions_.load(std::memory_order_relaxed);
+    }
+
+    /// Counters so far (approximate while running).
+    [[nodiscard]] OrderEntryStats stats() const;
+
+    /// The session tag in an OrderId this server assigned (0 for others).
+    [[nodiscard]] static uint32_t session_tag(OrderId id) noexcept {
+        return static_cast<uint32_t>(id >> 32);
+    }
+
+private:
+    using EventRing = SPSCRingBuffer<EventMessage, EVENT_RING_CAPACITY>;
+
+    struct Session;
+
+    void io_loop();
+    void handle_completion(const io_uring_cqe& cqe);
+    void on_accept(int result, uint32_t flags);
+    void on_receive(Session& s, int result, uint32_t flags);
+    void on_write(Session& s, int result);
+
+    void receive_bytes(Session& s, const char* data, size_t n);
+    void receive_fix(Session& s);
+    void receive_binary(Session& s, const char* data, size_t n);
+    void decode_binary(Session& s, const char* message, const oep::MessageHeader& header);
+
+    /// Push a resolved order on the ingress ring, or refuse it.
+    void submit(Session& s, const OrderMessage& om);
+
+    /// Route queued events to their sessions' send buffers.
+    void drain_events();
+    void report(Session& s, const EventMessage& event, OrderId order_id);
+    void report_rejection(Session& s, const OrderMessage& om);
+
+    /// Append `n` bytes of report space to `s`'s send buffer; nullptr if
+    /// it does not fit.
+    char* reserve_output(Session& s, size_t n) noexcept;
+    void flush_output(Session& s);
+
+    void arm_accept();
+    void arm_receive(Session& s);
+    void arm_wakeup();
+    [[nodiscard]] io_uring_sqe* next_sqe();
+
+    void open_session(int fd);
+    void shutdown_session(Session& s);
+    void release_session(Session& s);
+
+    /// Wake the I/O thread if it sleeps in io_uring_enter().
+    void wake() noexcept;
+
+    OrderEntryConfig config_;
+    IngressBuffer& ingress_;
+    std::string error_;
+    uint16_t bound_port_ = 0;
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;              // eventfd
+    uint64_t wake_value_ = 0;       // eventfd read target
+
+    fix::IoRing ring_;
+    std::unique_ptr<char[]> receive_area_;   // Provided buffers
+    std::unique_ptr<char[]> send_area_;      // Registered; one slice per session
+    std::vector<std::unique_ptr<Session>> sessions_;
+    std::vector<uint32_t> free_sessions_;    // Slots, used as a stack
+    std::vector<uint32_t> flush_list_;       // Sessions with reports to send
+    fix::ExecutionReportWriter writer_;
+    bool accept_armed_ = false;
+
+    std::unique_ptr<EventRing> events_;
+    std::thread io_thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<int> startup_{0};   // I/O thread: 1 running, 2 failed
+    bool running_ = false;
+    std::atomic<size_t> active_sessions_{0};
+
+    // Counters: written by the I/O thread (events_dropped_ by on_event())
+    std::atomic<uint64_t> sessions_accepted_{0};
+    std::atomic<uint64_t> sessions_refused_{0};
+    std::atomic<uint64_t> sessions_closed_{0};
+    std::atomic<uint64_t> bytes_received_{0};
+    std::atomic<uint64_t> messages_received_{0};
+    std::atomic<uint64_t> orders_submitted_{0};
+    std::atomic<uint64_t> orders_rejected_{0};
+    std::atomic<uint64_t> messages_invalid_{0};
+    std::atomic<uint64_t> messages_ignored_{0};
+    std::atomic<uint64_t> events_dropped_{0};
+    std::atomic<uint64_t> reports_sent_{0};
+    std::atomic<uint64_t> reports_dropped_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> send_calls_{0};
+    std::atomic<uint64_t> receive_stalls_{0};
+};
+
+}  // namespace hft
@@ -0,0 +1,71 @@
+#include "feed/playback_pacer.h"
+
+#include <chrono>
+#include <thread>
+
+#include "transport/wait_strategy.h"
+#include "utils/clock.h"
+
+namespace hft {
+
+PlaybackPacer::PlaybackPacer(double speed, uint64_t spin_ns, double tsc_per_ns)
+    : speed_(speed > 0.0 ? speed : 1.0),
+      tsc_per_ns_(tsc_per_ns > 0.0 ? tsc_per_ns : calibrate_tsc_frequency()),
+      spin_ticks_(static_cast<uint64_t>(static_cast<double>(spin_ns) * tsc_per_ns_)),
+      lateness_(1 << 16) {
+    lateness_.set_tsc_frequency(tsc_per_ns_);
+}
+
+uint64_t PlaybackPacer::deadline(Timestamp timestamp) {
+    if (!anchored_) {
+        anchored_ = true;
+        anchor_timestamp_ = last_timestamp_ = timestamp;
+        anchor_tsc_ = rdtsc();
+    }
+    // Out-of-order stamps are due with the latest one seen
+    if (timestamp > last_timestamp_) last_timestamp_ = timestamp;
+    const double offset_ns =
+        static_cast<double>(last_timestamp_ - anchor_timestamp_) / speed_;
+    return anchor_tsc_ + static_cast<uint64_t>(offset_ns * tsc_per_ns_);
+}
+
+bool PlaybackPacer::due(Timestamp timestamp) {
+    if (!anchored_) return true;
+    const Timestamp latest = timestamp > last_timestamp_ ? timestamp : last_timestamp_;
+    const double offset_ns = static_cast<double>(latest - anchor_timestamp_) / speed_;
+    return rdtsc() >= anchor_tsc_ + static_cast<uint64_t>(offset_ns * tsc_per_ns_);
+}
+
+void PlaybackPacer::wait(Timestamp timestamp) {
+    const uint64_t target = deadline(timestamp);
+    uint64_t now = rdtsc();
+    if (now >= target) {
+        ++overdue_;
+    } else {
+        if (target - now > spin_ticks_) {
+            ++sleeps_;
+            const double sleep_ns =
+                static_cast<double>(target - now - spin_ticks_) / tsc_per_ns_;
+            std::this_thread::sleep_for(
+                std::chrono::nanoseconds(static_cast<int64_t>(sleep_ns)));
+        }
+        while ((now = rdtsc()) < target) cpu_relax();
+    }
+    lateness_.record(now - target);
+}
+
+PacingStats PlaybackPacer::stats() {
+    PacingStats out;
+    out.paced_records = lateness_.size();
+    out.sleeps = sleeps_;
+    out.overdue_records = overdue_;
+    if (lateness_.size() == 0) return out;
+    const LatencyStats s = lateness_.compute();
+    out.error_p50_ns = s.p50_ns;
+    out.error_p99_ns = s.p99_ns;
+    out.error_p99_9_ns = s.p99_9_ns;
+    out.error_max_ns = s.max_ns;
+    return out;
+}
+
+}  // namespace hft
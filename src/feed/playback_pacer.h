@@ -0,0 +1,77 @@
+#pragma once
+
+/// @file playback_pacer.h
+/// @brief TSC-paced release of replayed records at their recorded spacing.
+///
+/// Cold-path component (its wait is a deliberate stall). ReplayEngine uses
+/// it for PlaybackSpeed::Realtime and FastForward: each record is released
+/// when `(timestamp - first timestamp) / speed` has elapsed since the first
+/// record, measured with rdtsc() against calibrate_tsc_frequency().
+///
+/// The schedule is absolute, so lateness on one record never shifts the
+/// ones after it (no drift), and records whose deadline has already passed
+/// go out back to back (bursts survive a slow consumer). Waits sleep in
+/// the OS until `spin_ns` before the deadline and spin the rest, since
+/// sleep granularity (~50-100 us) would otherwise smear microbursts.
+/// PacingStats reports how late records were released.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types.h"
+#include "utils/latency_histogram.h"
+
+namespace hft {
+
+/// Release lateness over a paced replay, in nanoseconds.
+struct PacingStats {
+    uint64_t paced_records = 0;
+    uint64_t sleeps = 0;          // Waits that slept before spinning
+    uint64_t overdue_records = 0; // Already due on arrival (burst or backlog)
+    double error_p50_ns = 0.0;
+    double error_p99_ns = 0.0;
+    double error_p99_9_ns = 0.0;
+    double error_max_ns = 0.0;
+};
+
+class PlaybackPacer {
+public:
+    /// Remaining wait below which the pacer spins instead of sleeping.
+    static constexpr uint64_t DEFAULT_SPIN_NS = 200'000;
+
+    /// @param speed       Replay speed multiplier (1 = recorded pace).
+    /// @param spin_ns     See DEFAULT_SPIN_NS.
+    /// @param tsc_per_ns  TSC frequency; 0 calibrates it (~150 ms).
+    explicit PlaybackPacer(double speed = 1.0, uint64_t spin_ns = DEFAULT_SPIN_NS,
+                           double tsc_per_ns = 0.0);
+
+    /// Whether a record stamped `timestamp` may be released now. The first
+    /// call anchors the schedule and is always due.
+    [[nodiscard]] bool due(Timestamp timestamp);
+
+    /// Block until the record stamped `timestamp` is due and record its
+    /// release lateness.
+    void wait(Timestamp timestamp);
+
+    /// Lateness percentiles over every wait() so far.
+    [[nodiscard]] PacingStats stats();
+
+    [[nodiscard]] double tsc_per_ns() const { return tsc_per_ns_; }
+
+private:
+    /// TSC deadline of `timestamp` (anchoring the schedule on first use).
+    uint64_t deadline(Timestamp timestamp);
+
+    double speed_;
+    double tsc_per_ns_;
+    uint64_t spin_ticks_;
+    bool anchored_ = false;
+    Timestamp anchor_timestamp_ = 0;
+    Timestamp last_timestamp_ = 0;
+    uint64_t anchor_tsc_ = 0;
+    uint64_t sleeps_ = 0;
+    uint64_t overdue_ = 0;
+    LatencyHistogram lateness_;
+};
+
+}  // namespace hft
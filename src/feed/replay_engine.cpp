@@ -1,13 +1,57 @@
 #include "feed/replay_engine.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <thread>
 
 #include <nlohmann/json.hpp>
 
+#include "gateway/book_snapshot.h"
+#include "utils/clock.h"
+
 namespace hft {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double rate(double count, double seconds) {
+    return (seconds > 0.0) ? count / seconds : 0.0;
+}
+
+/// Checkpoint index file header.
+struct CheckpointIndexHeader {
+    static constexpr uint64_t MAGIC = 0x3158444943544648ULL;  // "HFTCIDX1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+std::string checkpoint_index_path(const std::string& directory) {
+    return directory + "/checkpoints.index";
+}
+
+std::string checkpoint_path(const std::string& directory, uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/checkpoint-%06llu.snap",
+                  static_cast<unsigned long long>(index));
+    return directory + name;
+}
+
+}  // namespace
+
 // ---------------------------------------------------------------------------
 // Construction / Destruction
 // ---------------------------------------------------------------------------
@@ -15,20 +59,38 @@ namespace hft {
 ReplayEngine::ReplayEngine(const ReplayConfig& config)
     : config_(config) {
     // Allocate pipeline components
-    book_ = std::make_unique<OrderBook>(
-        config_.min_price, config_.max_price, config_.tick_size, config_.max_orders);
-    pool_ = std::make_unique<MemoryPool<Order>>(config_.max_orders);
+    InstrumentPipeline& p = pipeline_;
+    p.instrument_id = DEFAULT_INSTRUMENT_ID;
+    const bool multicast = !config_.multicast.group.empty();
+    OrderBookOptions book_options;
+    if (config_.level_updates ||
+        (multicast && (config_.multicast.content == MulticastContent::Levels ||
+                       !config_.multicast.snapshot_group.empty()))) {
+        book_options.level_deltas = LevelDeltaMode::Conflated;
+    }
+    book_options.state_digest = config_.digest_every > 0;
+    p.book = std::make_unique<OrderBook>(
+        config_.min_price, config_.max_price, config_.tick_size, config_.max_orders,
+        book_options);
+    p.pool = std::make_unique<MemoryPool<Order>>(config_.max_orders, MemoryBacking{},
+                                                 PoolGrowth{}, config_.pool_locality);
 
-    engine_ = std::make_unique<MatchingEngine>(
-        *book_, *pool_, SelfTradePreventionMode::None);
+    p.engine = std::make_unique<MatchingEngine>(
+        *p.book, *p.pool, SelfTradePreventionMode::None);
 
-    if (config_.enable_publisher) {
+    if (config_.enable_publisher || !config_.journal.directory.empty() || multicast) {
         event_buffer_ = std::make_unique<EventBuffer>();
-        gateway_ = std::make_unique<OrderGateway>(*engine_, *pool_, event_buffer_.get());
+        p.gateway = std::make_unique<OrderGateway>(*p.engine, *p.pool, event_buffer_.get());
+        p.gateway->set_backpressure(config_.backpressure);
         publisher_ = std::make_unique<MarketDataPublisher>(*event_buffer_);
     } else {
-        gateway_ = std::make_unique<OrderGateway>(*engine_, *pool_, nullptr);
+        p.gateway = std::make_unique<OrderGateway>(*p.engine, *p.pool, nullptr);
+    }
+    if (config_.quote_snapshot) {
+        p.quote = std::make_unique<QuoteSnapshotSlot>();
+        p.gateway->set_quote_snapshot(p.quote.get());
     }
+    if (config_.digest_every > 0) p.gateway->set_digest_every(config_.digest_every);
 }
 
 ReplayEngine::~ReplayEngine() = default;
@@ -49,6 +111,35 @@ void ReplayEngine::register_event_callback(
 ReplayStats ReplayEngine::run() {
     ReplayStats stats{};
 
+    // The journal consumes the event stream ahead of the other callbacks
+    if (!config_.journal.directory.empty()) {
+        JournalConfig journal_config = config_.journal;
+        journal_config.threading = config_.threading;
+        journal_ = std::make_unique<EventJournal>(journal_config);
+        if (journal_->open()) {
+            EventJournal* journal = journal_.get();
+            publisher_->register_callback(
+                [journal](const EventMessage& event) { (void)journal->append(event); });
+        } else {
+            std::cerr << "Warning: journal disabled: " << journal_->error() << "\n";
+            journal_.reset();
+        }
+    }
+
+    if (!config_.multicast.group.empty()) {
+        MulticastConfig multicast_config = config_.multicast;
+        multicast_config.threading = config_.threading;
+        multicast_ = std::make_unique<MulticastPublisher>(multicast_config);
+        if (multicast_->open()) {
+            MulticastPublisher* feed = multicast_.get();
+            publisher_->register_callback(
+                [feed](const EventMessage& event) { (void)feed->append(event); });
+        } else {
+            std::cerr << "Warning: multicast feed disabled: " << multicast_->error() << "\n";
+            multicast_.reset();
+        }
+    }
+
     // Register callbacks with the publisher
     if (publisher_) {
         for (auto& cb : callbacks_) {
@@ -56,126 +147,710 @@ ReplayStats ReplayEngine::run() {
         }
     }
 
-    L3FeedParser parser;
-    if (!parser.open(config_.input_path)) {
+    // Checkpoints need the inline loop on a seekable input; a seeked run
+    // leaves the index it started from alone
+    checkpointing_ = !seeked_ && !config_.checkpoint_directory.empty() &&
+                     (config_.checkpoint_every_records != 0 || config_.checkpoint_every_ns != 0);
+    if (checkpointing_ && config_.pipelined) {
+        std::cerr << "Warning: checkpoints need the inline mode; not written\n";
+        checkpointing_ = false;
+    }
+    if (!open_parser()) {
         std::cerr << "Failed to open input file: " << config_.input_path << "\n";
         return stats;
     }
+    L3FeedParser& parser = *parser_;
+    stats.input_opened = true;
+    if (checkpointing_) {
+        std::error_code ec;
+        std::filesystem::create_directories(config_.checkpoint_directory, ec);
+        if (ec || !parser.seekable()) {
+            std::cerr << "Warning: checkpoints disabled: "
+                      << (ec ? config_.checkpoint_directory + ": " + ec.message()
+                             : std::string("input is not seekable"))
+                      << "\n";
+            checkpointing_ = false;
+        }
+        checkpoints_.clear();
+    }
+
+    if (!config_.metrics_name.empty() && !metrics_) open_metrics();
+
+    if (!lock_process_memory(config_.threading)) {
+        std::cerr << "Warning: mlockall failed; pages stay swappable\n";
+    }
+
+    // Calibrated before the clock starts
+    std::unique_ptr<PlaybackPacer> pacer;
+    if (config_.speed != PlaybackSpeed::Max) {
+        const double speed =
+            (config_.speed == PlaybackSpeed::FastForward) ? config_.speed_multiplier : 1.0;
+        pacer = std::make_unique<PlaybackPacer>(speed, config_.pacing_spin_ns);
+    }
+
+    // Tracing: calibrated, and stale records discarded, before the clock starts
+    traces_.clear();
+    const bool tracing = config_.trace_sample_every != 0;
+    if (tracing) {
+#if defined(HFT_TRACE)
+        trace_tsc_per_ns_ = calibrate_tsc_frequency();
+        std::vector<TraceRecord> stale;
+        (void)TraceRegistry::instance().drain(stale);
+        set_trace_sampling(config_.trace_sample_every);
+#else
+        std::cerr << "Warning: built without HFT_ENABLE_TRACE; tracing ignored\n";
+#endif
+    }
+    const uint64_t trace_dropped = TraceRegistry::instance().dropped();
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
+    if (config_.pipelined) {
+        run_pipelined(parser, pacer.get(), stats);
+    } else {
+        ScopedThreadPlacement placement(config_.threading, ThreadRole::Matching);
+        run_inline(parser, pacer.get(), stats);
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+
+    if (tracing) {
+        set_trace_sampling(0);
+        std::vector<TraceRecord> records;
+        stats.trace_records = TraceRegistry::instance().drain(records);
+        stats.trace_dropped = TraceRegistry::instance().dropped() - trace_dropped;
+        traces_ = reconstruct_order_traces(std::move(records));
+        stats.traced_orders = traces_.size();
+    }
+
+    if (journal_) {
+        journal_->close();
+        const JournalStats journal = journal_->stats();
+        stats.journal_events = journal.events_written;
+        stats.journal_dropped = journal.events_dropped;
+        stats.journal_bytes = journal.bytes_written;
+        stats.journal_segments = journal.segments;
+        stats.journal_fsyncs = journal.fsyncs;
+        stats.journal_write_errors = journal.write_errors;
+    }
+
+    if (multicast_) {
+        multicast_->close();
+        const MulticastStats feed = multicast_->stats();
+        stats.multicast_datagrams = feed.datagrams_sent;
+        stats.multicast_bytes = feed.bytes_sent;
+        stats.multicast_dropped = feed.events_dropped;
+        stats.multicast_snapshots = feed.snapshots_sent;
+        stats.multicast_retransmitted = feed.datagrams_retransmitted;
+        stats.multicast_send_errors = feed.send_errors;
+    }
+
+    if (!parser.input_error().empty()) {
+        std::cerr << "Warning: input ended early: " << parser.input_error() << "\n";
+    }
+    if (checkpointing_) write_checkpoint_index();
+
+    // Collect final state (parse errors before a seek target are not ours)
+    stats.parse_errors = parser.parse_errors() - seek_stats_.parse_errors;
+    stats.seek_checkpoint_timestamp = seek_stats_.seek_checkpoint_timestamp;
+    stats.seek_warmup_records = seek_stats_.seek_warmup_records;
+    stats.seek_seconds = seek_stats_.seek_seconds;
+    stats.final_order_count = pipeline_.book->order_count();
+    stats.final_book_digest = pipeline_.book->compute_state_digest();
+    stats.backpressure_events = pipeline_.gateway->backpressure_count();
+    stats.backpressure_seconds = static_cast<double>(pipeline_.gateway->backpressure_ns()) * 1e-9;
+    stats.events_spilled = pipeline_.gateway->events_spilled();
+    stats.events_conflated = pipeline_.gateway->events_conflated();
+    stats.events_dropped = pipeline_.gateway->events_dropped();
+    stats.overflow_high_water = pipeline_.gateway->overflow_high_water();
+    if (pacer) {
+        const PacingStats pacing = pacer->stats();
+        stats.paced_records = pacing.paced_records;
+        stats.pacing_sleeps = pacing.sleeps;
+        stats.pacing_overdue = pacing.overdue_records;
+        stats.pacing_error_p50_ns = pacing.error_p50_ns;
+        stats.pacing_error_p99_ns = pacing.error_p99_ns;
+        stats.pacing_error_p99_9_ns = pacing.error_p99_9_ns;
+        stats.pacing_error_max_ns = pacing.error_max_ns;
+    }
+    stats.elapsed_seconds = elapsed.count();
+    stats.messages_per_second =
+        (stats.elapsed_seconds > 0.0)
+            ? static_cast<double>(stats.total_messages) / stats.elapsed_seconds
+            : 0.0;
+
+    const PriceLevel* best_bid = pipeline_.book->best_bid();
+    const PriceLevel* best_ask = pipeline_.book->best_ask();
+    stats.final_best_bid = best_bid ? best_bid->price : 0;
+    stats.final_best_ask = best_ask ? best_ask->price : 0;
+    stats.final_spread = pipeline_.book->spread();
+
+    stats.memory = pipeline_.memory_usage();
+    if (event_buffer_) stats.event_ring = heap_usage(event_buffer_.get(), sizeof(EventBuffer));
+    if (metrics_) publish_memory_metrics();
+
+    parser.close();
+    parser_.reset();
+
+    // Write JSON report if output path specified
+    if (!config_.output_path.empty()) {
+        write_report(stats);
+    }
+
+    return stats;
+}
+
+bool ReplayEngine::other_symbol(const L3Record& record, ReplayStats& stats) const {
+    // Invalid records carry no symbol; classify() counts them as errors
+    if (config_.symbol.empty() || !record.valid || record.symbol_id == symbol_id_) return false;
+    if (record.symbol != config_.symbol) {
+        ++stats.other_symbol_messages;
+        return true;
+    }
+    symbol_id_ = record.symbol_id;  // Ids are stable for the parser's life
+    return false;
+}
+
+bool ReplayEngine::classify(const L3Record& record, const L3FeedParser& parser,
+                            ReplayStats& stats, OrderMessage& msg) const {
+    if (!record.valid) {
+        ++stats.parse_errors;
+        if (config_.verbose) {
+            std::cerr << "Parse error at line " << parser.lines_read()
+                      << ": " << record.error << "\n";
+        }
+        return false;
+    }
+
+    switch (record.event_type) {
+        case L3EventType::Add:
+            ++stats.add_messages;
+            msg = L3FeedParser::to_order_message(record);
+            return true;
+
+        case L3EventType::Cancel:
+            ++stats.cancel_messages;
+            msg = L3FeedParser::to_cancel_message(record);
+            return true;
+
+        case L3EventType::Modify:
+            ++stats.modify_messages;
+            msg = L3FeedParser::to_modify_message(record);
+            return true;
+
+        case L3EventType::Trade:
+            ++stats.trade_messages;
+            // TRADE records are informational only — matching engine
+            // generates its own trades from ADD events
+            return false;
+
+        case L3EventType::Invalid:
+            ++stats.parse_errors;
+            return false;
+    }
+    return false;
+}
+
+void ReplayEngine::run_inline(L3FeedParser& parser, PlaybackPacer* pacer,
+                              ReplayStats& stats) {
+    // Book-changing records are buffered and submitted in batches so the
+    // gateway can prefetch ahead; TRADE and invalid records never touch the
+    // book, so counting them out of band keeps the semantics sequential.
+    const size_t batch_size = (config_.batch_size == 0) ? 1 : config_.batch_size;
+    std::vector<OrderMessage> batch;
+    std::vector<GatewayResult> results(batch_size);
+    batch.reserve(batch_size);
+
+    // Checkpoints go between records: the batch so far is flushed first
+    const Timestamp end = config_.end_timestamp;
+    uint64_t since_checkpoint = 0;
+    Timestamp last_checkpoint = 0;
+    bool anchored = false;
+    L3FeedPosition position;
+
     L3Record record;
-    while (parser.next(record)) {
+    OrderMessage msg{};
+    for (;;) {
+        if (checkpointing_) position = parser.tell();
+        HFT_TRACE_BEGIN(t_parse, 0);   // Key 0: stamped, kept if the order is sampled
+        if (!parser.next(record)) break;
+        HFT_TRACE_BEGIN(t_parsed, 0);
+        if (end != 0 && record.valid && record.timestamp > end) break;
+        if (checkpointing_ && record.valid) {
+            if (!anchored) {
+                anchored = true;
+                last_checkpoint = record.timestamp;
+            } else if ((config_.checkpoint_every_records != 0 &&
+                        since_checkpoint >= config_.checkpoint_every_records) ||
+                       (config_.checkpoint_every_ns != 0 &&
+                        record.timestamp >= last_checkpoint + config_.checkpoint_every_ns)) {
+                flush_batch(batch, results, stats);
+                write_checkpoint(record.timestamp, position, stats);
+                since_checkpoint = 0;
+                last_checkpoint = record.timestamp;
+            }
+            ++since_checkpoint;
+        }
+        if (pacer && record.valid) {
+            // Submit what is already due before waiting for this record
+            if (!pacer->due(record.timestamp)) flush_batch(batch, results, stats);
+            pacer->wait(record.timestamp);
+        }
+        if (other_symbol(record, stats)) continue;
         ++stats.total_messages;
+        if (!classify(record, parser, stats, msg)) continue;
+        HFT_TRACE_SPAN(TraceStage::Parse, msg.order.order_id, t_parse, t_parsed);
+        batch.push_back(msg);
+        if (batch.size() == batch_size) {
+            flush_batch(batch, results, stats);
+        }
+    }
+    flush_batch(batch, results, stats);
 
-        if (!record.valid) {
-            ++stats.parse_errors;
-            if (config_.verbose) {
-                std::cerr << "Parse error at line " << parser.lines_read()
-                          << ": " << record.error << "\n";
+    // Final drain, spilled backlog included
+    if (publisher_) {
+        do {
+            (void)publisher_->poll();
+        } while (pipeline_.gateway->drain_overflow() != 0);
+        (void)publisher_->poll();
+    }
+}
+
+void ReplayEngine::run_pipelined(L3FeedParser& parser, PlaybackPacer* pacer,
+                                 ReplayStats& stats) {
+    auto ingress = std::make_unique<IngressRing>();
+    std::atomic<bool> parse_done{false};
+    std::atomic<bool> match_done{false};
+
+    // Block: the producers of both rings wake their sleeping consumer
+    WakeupSignal ingress_signal;
+    WakeupSignal event_signal;
+    if (config_.consumer_wait.strategy == WaitStrategy::Block) {
+        ingress->set_wakeup(&ingress_signal);
+        if (publisher_) event_buffer_->set_wakeup(&event_signal);
+    }
+
+    // Parser thread: counts go to its own stats, merged after the join
+    ReplayStats parsed{};
+    std::thread parser_thread([&] {
+        ScopedThreadPlacement placement(config_.threading, ThreadRole::Ingress);
+        const auto t0 = Clock::now();
+        L3Record record;
+        OrderMessage msg{};
+        for (;;) {
+            HFT_TRACE_BEGIN(t_parse, 0);
+            if (!parser.next(record)) break;
+            HFT_TRACE_BEGIN(t_parsed, 0);
+            if (config_.end_timestamp != 0 && record.valid &&
+                record.timestamp > config_.end_timestamp) {
+                break;
+            }
+            if (pacer && record.valid) pacer->wait(record.timestamp);
+            if (other_symbol(record, parsed)) continue;
+            ++parsed.total_messages;
+            parser_records_.set(parsed.total_messages);
+            if (!classify(record, parser, parsed, msg)) continue;
+            HFT_TRACE_SPAN(TraceStage::Parse, msg.order.order_id, t_parse, t_parsed);
+            while (!ingress->try_push(msg)) {
+                ++parsed.parser_stalls;
+                parser_stalls_.set(parsed.parser_stalls);
+                std::this_thread::yield();
             }
-            continue;
         }
+        parsed.parse_seconds = seconds_since(t0);
+        parse_done.store(true, std::memory_order_release);
+        ingress_signal.notify();
+    });
+
+    // Publisher thread: drains the event ring until matching has finished
+    ReplayStats published{};
+    std::thread publisher_thread;
+    if (publisher_) {
+        publisher_thread = std::thread([&] {
+            ScopedThreadPlacement placement(config_.threading, ThreadRole::Publisher);
+            const auto t0 = Clock::now();
+            uint64_t samples = 0;
+            double depth_sum = 0.0;
+            Waiter waiter(config_.consumer_wait, event_buffer_->wakeup());
+            auto ready = [&] {
+                return !event_buffer_->empty() ||
+                       match_done.load(std::memory_order_acquire);
+            };
+            for (;;) {
+                bool last = match_done.load(std::memory_order_acquire);
+                size_t depth = event_buffer_->size();
+                published.event_depth_max = std::max(published.event_depth_max, depth);
+                depth_sum += static_cast<double>(depth);
+                ++samples;
+                size_t n = publisher_->poll();
+                published.events_published += n;
+                if (last) break;  // Everything was published before the flag
+                if (n == 0) {
+                    if (multicast_) multicast_->flush();
+                    waiter.idle(ready);
+                } else {
+                    waiter.reset();
+                }
+            }
+            published.publisher_idle_polls = waiter.stats().idle_polls;
+            published.publisher_wakeups = waiter.stats().wakeups;
+            published.event_depth_avg = depth_sum / static_cast<double>(samples);
+            published.publish_seconds = seconds_since(t0);
+        });
+    }
+
+    // Matching on the calling thread
+    {
+        ScopedThreadPlacement placement(config_.threading, ThreadRole::Matching);
+        const auto t0 = Clock::now();
+        const size_t batch_size = (config_.batch_size == 0) ? 1 : config_.batch_size;
+        std::vector<OrderMessage> batch(batch_size);
+        std::vector<GatewayResult> results(batch_size);
+        uint64_t samples = 0;
+        double depth_sum = 0.0;
+        uint64_t matched = 0;
+        Waiter waiter(config_.consumer_wait, ingress->wakeup());
+        auto ready = [&] {
+            return !ingress->empty() || parse_done.load(std::memory_order_acquire);
+        };
+        for (;;) {
+            bool last = parse_done.load(std::memory_order_acquire);
+            size_t depth = ingress->size();
+            stats.ingress_depth_max = std::max(stats.ingress_depth_max, depth);
+            depth_sum += static_cast<double>(depth);
+            ++samples;
+            size_t n = ingress->try_pop_n(batch.data(), batch_size);
+            if (n == 0) {
+                if (last) break;  // Every message was pushed before the flag
+                (void)pipeline_.gateway->release_throttled();
+                (void)pipeline_.gateway->maintain();
+                waiter.idle(ready);
+                continue;
+            }
+            waiter.reset();
+            process_batch(batch.data(), n, results.data());
+            fold_results(batch.data(), results.data(), n, stats);
+            matched += n;
+        }
+        stats.match_seconds = seconds_since(t0);
+        stats.match_messages_per_second =
+            rate(static_cast<double>(matched), stats.match_seconds);
+        stats.ingress_depth_avg = depth_sum / static_cast<double>(samples);
+        stats.matching_idle_polls = waiter.stats().idle_polls;
+        stats.matching_wakeups = waiter.stats().wakeups;
+        // The publisher is still draining: hand it the spilled backlog
+        (void)pipeline_.gateway->release_throttled();
+        while (pipeline_.gateway->drain_overflow() != 0) cpu_relax();
+    }
+    match_done.store(true, std::memory_order_release);
+    event_signal.notify();
+
+    parser_thread.join();
+    if (publisher_thread.joinable()) publisher_thread.join();
+    if (publisher_) event_buffer_->set_wakeup(nullptr);
+
+    stats.total_messages = parsed.total_messages;
+    stats.add_messages = parsed.add_messages;
+    stats.cancel_messages = parsed.cancel_messages;
+    stats.modify_messages = parsed.modify_messages;
+    stats.trade_messages = parsed.trade_messages;
+    stats.other_symbol_messages = parsed.other_symbol_messages;
+    stats.parser_stalls = parsed.parser_stalls;
+    stats.parse_seconds = parsed.parse_seconds;
+    stats.parse_messages_per_second =
+        rate(static_cast<double>(parsed.total_messages), parsed.parse_seconds);
+
+    stats.events_published = published.events_published;
+    stats.publisher_idle_polls = published.publisher_idle_polls;
+    stats.publisher_wakeups = published.publisher_wakeups;
+    stats.event_depth_max = published.event_depth_max;
+    stats.event_depth_avg = published.event_depth_avg;
+    stats.publish_seconds = published.publish_seconds;
+    stats.publish_events_per_second =
+        rate(static_cast<double>(published.events_published), published.publish_seconds);
+}
+
+void ReplayEngine::open_metrics() {
+    metrics_ = std::make_unique<MetricsRegion>();
+    if (!metrics_->open(config_.metrics_name)) {
+        std::cerr << "Warning: metrics disabled: " << metrics_->error() << "\n";
+        metrics_.reset();
+        return;
+    }
+    // Histograms are in TSC ticks; the exporter converts with this
+    MetricGauge tsc = metrics_->add_gauge("clock.tsc_per_us");
+    tsc.set(static_cast<int64_t>(calibrate_tsc_frequency() * 1000.0));
+
+    gateway_metrics_.bind(*metrics_, "gateway", METRICS_MATCHING_THREAD);
+    pipeline_.gateway->set_metrics(&gateway_metrics_);
+    batch_ticks_ = metrics_->add_histogram("gateway.batch_ticks", METRICS_MATCHING_THREAD);
+    if (publisher_) {
+        publisher_metrics_.bind(*metrics_, "publisher", METRICS_PUBLISHER_THREAD);
+        publisher_->set_metrics(&publisher_metrics_);
+    }
+    parser_records_ = metrics_->add_counter("parser.records", METRICS_PARSER_THREAD);
+    parser_stalls_ = metrics_->add_counter("parser.stalls", METRICS_PARSER_THREAD);
+    memory_total_metrics_.bind(*metrics_, "memory", METRICS_MATCHING_THREAD);
+    memory_levels_metrics_.bind(*metrics_, "memory.levels", METRICS_MATCHING_THREAD);
+    memory_order_index_metrics_.bind(*metrics_, "memory.order_index", METRICS_MATCHING_THREAD);
+    memory_pool_metrics_.bind(*metrics_, "memory.pool", METRICS_MATCHING_THREAD);
+    memory_events_metrics_.bind(*metrics_, "memory.events", METRICS_MATCHING_THREAD);
+    publish_memory_metrics();
+}
+
+void ReplayEngine::publish_memory_metrics() {
+    const PipelineMemoryUsage usage = pipeline_.memory_usage();
+    memory_total_metrics_.publish(usage.total());
+    memory_levels_metrics_.publish(usage.book.levels);
+    memory_order_index_metrics_.publish(usage.book.order_index);
+    memory_pool_metrics_.publish(usage.pool);
+    memory_events_metrics_.publish(usage.events);
+    memory_metrics_due_ = 0;
+}
+
+void ReplayEngine::process_batch(const OrderMessage* msgs, size_t count,
+                                 GatewayResult* results) {
+    if (batch_ticks_ == nullptr) {
+        pipeline_.gateway->process_batch(msgs, count, results);
+        return;
+    }
+    const uint64_t t0 = rdtsc_start();
+    pipeline_.gateway->process_batch(msgs, count, results);
+    batch_ticks_->record(rdtsc_end() - t0);
+    memory_metrics_due_ += count;
+    if (memory_metrics_due_ >= MEMORY_METRICS_EVERY) [[unlikely]] publish_memory_metrics();
+}
+
+void ReplayEngine::flush_batch(std::vector<OrderMessage>& batch,
+                               std::vector<GatewayResult>& results,
+                               ReplayStats& stats) {
+    if (batch.empty()) return;
+    process_batch(batch.data(), batch.size(), results.data());
+    fold_results(batch.data(), results.data(), batch.size(), stats);
+    batch.clear();
+    parser_records_.set(stats.total_messages);
+    // Between batches, off the message path
+    (void)pipeline_.gateway->release_throttled();
+    (void)pipeline_.gateway->maintain();
+
+    // Drain publisher events once per batch; the feed sends what they filled
+    if (publisher_) {
+        (void)publisher_->poll();
+        if (multicast_) multicast_->flush();
+        (void)pipeline_.gateway->drain_overflow();
+    }
+}
 
-        switch (record.event_type) {
-            case L3EventType::Add: {
-                ++stats.add_messages;
-                OrderMessage msg = L3FeedParser::to_order_message(record);
-                GatewayResult result = gateway_->process_order(msg);
+void ReplayEngine::fold_results(const OrderMessage* msgs,
+                                const GatewayResult* results, size_t count,
+                                ReplayStats& stats) const {
+    for (size_t i = 0; i < count; ++i) {
+        const OrderMessage& msg = msgs[i];
+        const GatewayResult& result = results[i];
+        switch (msg.type) {
+            case MessageType::Add:
                 if (result.accepted) {
                     ++stats.orders_accepted;
                     stats.trades_generated += result.trade_count;
                 } else {
                     ++stats.orders_rejected;
                     if (config_.verbose) {
-                        std::cerr << "Order " << record.order_id
+                        std::cerr << "Order " << msg.order.order_id
                                   << " rejected (reason "
                                   << static_cast<int>(result.reject_reason)
                                   << ")\n";
                     }
                 }
                 break;
-            }
 
-            case L3EventType::Cancel: {
-                ++stats.cancel_messages;
-                bool cancelled = gateway_->process_cancel(record.order_id);
-                if (cancelled) {
+            case MessageType::Cancel:
+                if (result.accepted) {
                     ++stats.orders_cancelled;
                 } else {
                     ++stats.cancel_failures;
                 }
                 break;
-            }
 
-            case L3EventType::Modify: {
-                ++stats.modify_messages;
-                OrderMessage msg = L3FeedParser::to_modify_message(record);
-                GatewayResult result = gateway_->process_modify(msg);
+            case MessageType::Modify:
                 if (result.accepted) {
                     ++stats.orders_modified;
                     stats.trades_generated += result.trade_count;
                 } else {
                     ++stats.modify_failures;
                     if (config_.verbose) {
-                        std::cerr << "Modify order " << record.order_id
+                        std::cerr << "Modify order " << msg.order.order_id
                                   << " failed (reason "
                                   << static_cast<int>(result.reject_reason)
                                   << ")\n";
                     }
                 }
                 break;
-            }
-
-            case L3EventType::Trade: {
-                ++stats.trade_messages;
-                // TRADE records are informational only — matching engine
-                // generates its own trades from ADD events
-                break;
-            }
-
-            case L3EventType::Invalid:
-                ++stats.parse_errors;
-                break;
-        }
-
-        // Drain publisher events if enabled
-        if (publisher_) {
-            (void)publisher_->poll();
         }
     }
+}
+
+// ---------------------------------------------------------------------------
+// Seekable replay
+// ---------------------------------------------------------------------------
+
+bool ReplayEngine::open_parser() {
+    if (parser_) return true;
+    parser_ = std::make_unique<L3FeedParser>();
+    // Parallel ingestion cannot tell() / seek()
+    const bool seekable = checkpointing_ || seeked_;
+    parser_->set_parse_threads(seekable ? 0 : config_.parse_threads,
+                               config_.parse_chunk_bytes);
+    symbol_id_ = L3_NO_SYMBOL;
+    const bool opened = input_data_.data()
+                            ? parser_->open_buffer(input_data_.data(), input_data_.size())
+                            : parser_->open(config_.input_path);
+    if (opened) return true;
+    parser_.reset();
+    return false;
+}
 
-    // Final drain
+bool ReplayEngine::reset() {
     if (publisher_) {
-        (void)publisher_->poll();
+        std::cerr << "reset() needs an engine without an event publisher\n";
+        return false;
     }
+    InstrumentPipeline& p = pipeline_;
+    MemoryPool<Order>& pool = *p.pool;
+    (void)p.book->clear([&pool](Order* order) { pool.deallocate(order); });
+    p.engine->restore_trade_state(0, 0);
+    p.gateway->restore_counters(0, 0, 0);
+    p.gateway->set_digest_every(p.gateway->digest_every());
+    parser_.reset();
+    seeked_ = false;
+    seek_stats_ = ReplayStats{};
+    traces_.clear();
+    return true;
+}
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end_time - start_time;
+void ReplayEngine::set_input(const std::string& path, const std::string& symbol,
+                             std::string_view data) {
+    config_.input_path = path;
+    config_.symbol = symbol;
+    input_data_ = data;
+}
 
-    // Collect final state
-    stats.parse_errors = parser.parse_errors();
-    stats.final_order_count = book_->order_count();
-    stats.elapsed_seconds = elapsed.count();
-    stats.messages_per_second =
-        (stats.elapsed_seconds > 0.0)
-            ? static_cast<double>(stats.total_messages) / stats.elapsed_seconds
-            : 0.0;
+std::vector<ReplayCheckpoint> ReplayEngine::load_checkpoints(const std::string& directory) {
+    std::vector<ReplayCheckpoint> checkpoints;
+    std::ifstream in(checkpoint_index_path(directory), std::ios::binary);
+    CheckpointIndexHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CheckpointIndexHeader::MAGIC ||
+        header.version != CheckpointIndexHeader::VERSION) {
+        return checkpoints;
+    }
+    checkpoints.resize(header.count);
+    if (!in.read(reinterpret_cast<char*>(checkpoints.data()),
+                 static_cast<std::streamsize>(header.count * sizeof(ReplayCheckpoint)))) {
+        checkpoints.clear();
+    }
+    return checkpoints;
+}
 
-    const PriceLevel* best_bid = book_->best_bid();
-    const PriceLevel* best_ask = book_->best_ask();
-    stats.final_best_bid = best_bid ? best_bid->price : 0;
-    stats.final_best_ask = best_ask ? best_ask->price : 0;
-    stats.final_spread = book_->spread();
+void ReplayEngine::write_checkpoint(Timestamp timestamp, const L3FeedPosition& position,
+                                    ReplayStats& stats) {
+    ReplayCheckpoint checkpoint;
+    checkpoint.timestamp = timestamp;
+    checkpoint.records = stats.total_messages;
+    checkpoint.position = position;
+    checkpoint.index = checkpoints_.size();
+    const std::string path = checkpoint_path(config_.checkpoint_directory, checkpoint.index);
+    const SnapshotStats saved = save_pipeline_snapshot(pipeline_, path);
+    if (!saved.ok) {
+        std::cerr << "Warning: checkpoints stopped: " << saved.error << "\n";
+        checkpointing_ = false;
+        return;
+    }
+    checkpoints_.push_back(checkpoint);
+    ++stats.checkpoints_written;
+}
 
-    parser.close();
+void ReplayEngine::write_checkpoint_index() const {
+    const std::string path = checkpoint_index_path(config_.checkpoint_directory);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    CheckpointIndexHeader header{};
+    header.magic = CheckpointIndexHeader::MAGIC;
+    header.version = CheckpointIndexHeader::VERSION;
+    header.count = checkpoints_.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(checkpoints_.data()),
+              static_cast<std::streamsize>(checkpoints_.size() * sizeof(ReplayCheckpoint)));
+    if (!out) std::cerr << "Warning: failed to write checkpoint index: " << path << "\n";
+}
 
-    // Write JSON report if output path specified
-    if (!config_.output_path.empty()) {
-        write_report(stats);
+bool ReplayEngine::seek(Timestamp timestamp) {
+    if (seeked_ || pipeline_.book->order_count() != 0) {
+        std::cerr << "seek() must precede run() on a fresh engine\n";
+        return false;
+    }
+    const auto t0 = Clock::now();
+    seeked_ = true;
+    if (!open_parser()) {
+        std::cerr << "Failed to open input file: " << config_.input_path << "\n";
+        return false;
+    }
+    L3FeedParser& parser = *parser_;
+    if (!parser.seekable()) {
+        std::cerr << "Cannot seek in " << config_.input_path << " (compressed stream)\n";
+        return false;
     }
 
-    return stats;
+    // Last checkpoint at or before the target
+    const ReplayCheckpoint* start = nullptr;
+    const std::vector<ReplayCheckpoint> checkpoints =
+        config_.checkpoint_directory.empty() ? std::vector<ReplayCheckpoint>{}
+                                             : load_checkpoints(config_.checkpoint_directory);
+    for (const ReplayCheckpoint& checkpoint : checkpoints) {
+        if (checkpoint.timestamp > timestamp) break;
+        start = &checkpoint;
+    }
+    if (start) {
+        const SnapshotStats restored = restore_pipeline_snapshot(
+            pipeline_, checkpoint_path(config_.checkpoint_directory, start->index));
+        if (!restored.ok || !parser.seek(start->position)) {
+            std::cerr << "Failed to load checkpoint " << start->index << ": "
+                      << (restored.ok ? std::string("bad position") : restored.error) << "\n";
+            return false;
+        }
+        seek_stats_.seek_checkpoint_timestamp = start->timestamp;
+    }
+
+    // Warm up to the target. No callbacks are registered yet, so polling
+    // the publisher only keeps the event ring draining.
+    const size_t batch_size = (config_.batch_size == 0) ? 1 : config_.batch_size;
+    std::vector<OrderMessage> batch;
+    std::vector<GatewayResult> results(batch_size);
+    batch.reserve(batch_size);
+    ReplayStats warmup{};
+    L3Record record;
+    OrderMessage msg{};
+    for (;;) {
+        const L3FeedPosition position = parser.tell();
+        if (!parser.next(record)) break;
+        if (record.valid && record.timestamp >= timestamp) {
+            (void)parser.seek(position);  // run() starts with this record
+            break;
+        }
+        if (other_symbol(record, warmup)) continue;
+        ++seek_stats_.seek_warmup_records;
+        if (!classify(record, parser, warmup, msg)) continue;
+        batch.push_back(msg);
+        if (batch.size() == batch_size) flush_batch(batch, results, warmup);
+    }
+    flush_batch(batch, results, warmup);
+    if (publisher_) {
+        do {
+            (void)publisher_->poll();
+        } while (pipeline_.gateway->drain_overflow() != 0);
+    }
+    seek_stats_.parse_errors = parser.parse_errors();
+    seek_stats_.seek_seconds = seconds_since(t0);
+    return true;
 }
 
 // ---------------------------------------------------------------------------
@@ -186,6 +861,10 @@ void ReplayEngine::write_report(const ReplayStats& stats) const {
     nlohmann::json report;
 
     report["input_file"] = config_.input_path;
+    if (!config_.symbol.empty()) {
+        report["symbol"] = config_.symbol;
+        report["messages"]["other_symbols"] = stats.other_symbol_messages;
+    }
     report["messages"]["total"] = stats.total_messages;
     report["messages"]["add"] = stats.add_messages;
     report["messages"]["cancel"] = stats.cancel_messages;
@@ -208,6 +887,11 @@ void ReplayEngine::write_report(const ReplayStats& stats) const {
     };
 
     report["final_state"]["order_count"] = stats.final_order_count;
+    // Hex string: JSON readers that parse numbers as doubles would round it
+    char digest[17];
+    std::snprintf(digest, sizeof(digest), "%016llx",
+                  static_cast<unsigned long long>(stats.final_book_digest));
+    report["final_state"]["book_digest"] = digest;
     report["final_state"]["best_bid"] = price_to_double(stats.final_best_bid);
     report["final_state"]["best_ask"] = price_to_double(stats.final_best_ask);
     report["final_state"]["spread"] = price_to_double(stats.final_spread);
@@ -215,6 +899,98 @@ void ReplayEngine::write_report(const ReplayStats& stats) const {
     report["performance"]["elapsed_seconds"] = stats.elapsed_seconds;
     report["performance"]["messages_per_second"] = stats.messages_per_second;
 
+    auto memory_to_json = [](const MemoryUsage& usage) {
+        nlohmann::json j;
+        j["reserved_bytes"] = usage.reserved_bytes;
+        j["touched_bytes"] = usage.touched_bytes;
+        j["high_water_bytes"] = usage.high_water_bytes;
+        return j;
+    };
+    auto& memory = report["memory"];
+    memory["total"] = memory_to_json(stats.memory.total());
+    memory["levels"] = memory_to_json(stats.memory.book.levels);
+    memory["order_index"] = memory_to_json(stats.memory.book.order_index);
+    memory["book_auxiliary"] = memory_to_json(stats.memory.book.auxiliary);
+    memory["pool"] = memory_to_json(stats.memory.pool);
+    memory["event_overflow"] = memory_to_json(stats.memory.events);
+    memory["other"] = memory_to_json(stats.memory.other);
+    if (stats.event_ring.reserved_bytes != 0) memory["event_ring"] = memory_to_json(stats.event_ring);
+
+    if (config_.enable_publisher) {
+        auto& bp = report["backpressure"];
+        bp["events"] = stats.backpressure_events;
+        bp["blocked_seconds"] = stats.backpressure_seconds;
+        bp["spilled"] = stats.events_spilled;
+        bp["conflated"] = stats.events_conflated;
+        bp["dropped"] = stats.events_dropped;
+        bp["overflow_high_water"] = stats.overflow_high_water;
+    }
+
+    if (!config_.journal.directory.empty()) {
+        auto& journal = report["journal"];
+        journal["directory"] = config_.journal.directory;
+        journal["events"] = stats.journal_events;
+        journal["dropped"] = stats.journal_dropped;
+        journal["bytes"] = stats.journal_bytes;
+        journal["segments"] = stats.journal_segments;
+        journal["fsyncs"] = stats.journal_fsyncs;
+        journal["write_errors"] = stats.journal_write_errors;
+    }
+
+    if (!config_.multicast.group.empty()) {
+        auto& feed = report["multicast"];
+        feed["group"] = config_.multicast.group;
+        feed["port"] = config_.multicast.port;
+        feed["datagrams"] = stats.multicast_datagrams;
+        feed["bytes"] = stats.multicast_bytes;
+        feed["dropped"] = stats.multicast_dropped;
+        feed["snapshots"] = stats.multicast_snapshots;
+        feed["retransmitted"] = stats.multicast_retransmitted;
+        feed["send_errors"] = stats.multicast_send_errors;
+    }
+
+    if (stats.checkpoints_written != 0) {
+        report["checkpoints"]["directory"] = config_.checkpoint_directory;
+        report["checkpoints"]["written"] = stats.checkpoints_written;
+    }
+    if (seeked_) {
+        auto& seek = report["seek"];
+        seek["checkpoint_timestamp"] = stats.seek_checkpoint_timestamp;
+        seek["warmup_records"] = stats.seek_warmup_records;
+        seek["seconds"] = stats.seek_seconds;
+    }
+
+    if (config_.speed != PlaybackSpeed::Max) {
+        auto& pacing = report["pacing"];
+        pacing["records"] = stats.paced_records;
+        pacing["sleeps"] = stats.pacing_sleeps;
+        pacing["overdue"] = stats.pacing_overdue;
+        pacing["error_p50_ns"] = stats.pacing_error_p50_ns;
+        pacing["error_p99_ns"] = stats.pacing_error_p99_ns;
+        pacing["error_p99_9_ns"] = stats.pacing_error_p99_9_ns;
+        pacing["error_max_ns"] = stats.pacing_error_max_ns;
+    }
+
+    if (config_.pipelined) {
+        auto& pipeline = report["pipeline"];
+        pipeline["parse"]["seconds"] = stats.parse_seconds;
+        pipeline["parse"]["messages_per_second"] = stats.parse_messages_per_second;
+        pipeline["parse"]["stalls"] = stats.parser_stalls;
+        pipeline["match"]["seconds"] = stats.match_seconds;
+        pipeline["match"]["messages_per_second"] = stats.match_messages_per_second;
+        pipeline["match"]["idle_polls"] = stats.matching_idle_polls;
+        pipeline["match"]["wakeups"] = stats.matching_wakeups;
+        pipeline["match"]["ingress_depth_max"] = stats.ingress_depth_max;
+        pipeline["match"]["ingress_depth_avg"] = stats.ingress_depth_avg;
+        pipeline["publish"]["seconds"] = stats.publish_seconds;
+        pipeline["publish"]["events"] = stats.events_published;
+        pipeline["publish"]["events_per_second"] = stats.publish_events_per_second;
+        pipeline["publish"]["idle_polls"] = stats.publisher_idle_polls;
+        pipeline["publish"]["wakeups"] = stats.publisher_wakeups;
+        pipeline["publish"]["event_depth_max"] = stats.event_depth_max;
+        pipeline["publish"]["event_depth_avg"] = stats.event_depth_avg;
+    }
+
     std::ofstream out(config_.output_path);
     if (out.is_open()) {
         out << report.dump(2) << "\n";
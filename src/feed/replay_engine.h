@@ -8,49 +8,173 @@
 /// MemoryPool, MatchingEngine, OrderGateway, EventBuffer, and
 /// MarketDataPublisher. Reads an L3 CSV file via L3FeedParser and feeds
 /// ADD/CANCEL events through the gateway.
+///
+/// By default parsing, matching and publishing share the calling thread.
+/// ReplayConfig::pipelined runs them as the deployment does instead: a
+/// parser thread feeds OrderMessages over an SPSC ring to the matching
+/// thread (the caller), which publishes into the EventBuffer drained by a
+/// publisher thread. Each stage is placed per ReplayConfig::threading
+/// (ingress, matching and publisher roles), and ReplayStats then reports
+/// per-stage throughput, stalls and queue depths — a parser that stalls on
+/// a full ring means matching is the bottleneck; a matcher that idles on
+/// an empty one means parsing is.
+///
+/// Seekable replay: with ReplayConfig::checkpoint_every_records or
+/// checkpoint_every_ns set, an inline run writes a book snapshot (see
+/// book_snapshot.h) into ReplayConfig::checkpoint_directory at that period,
+/// together with an index from feed timestamp to parser position. A later
+/// engine on the same file can then seek() to any timestamp: it restores
+/// the last checkpoint at or before it and replays only the records from
+/// there, so a window late in a long file starts in milliseconds.
+/// ReplayConfig::end_timestamp ends the run at the far side of the window.
+///
+/// Stage tracing: in builds with HFT_ENABLE_TRACE, ReplayConfig::
+/// trace_sample_every turns on the tracepoints (see utils/trace.h) for 1 in
+/// N orders for the run, and order_traces() then holds each sampled
+/// message's parse / validate / pool / match / publish / dispatch times.
+/// The trace rings are process-wide, so one traced engine runs at a time.
+///
+/// Live metrics: a non-empty ReplayConfig::metrics_name publishes the
+/// gateway and publisher counters, parser progress and a per-batch
+/// matching latency histogram into the shared-memory region
+/// /dev/shm/<name> (see metrics_region.h) while the run is in progress,
+/// for grafana/scripts/metrics_exporter.py to scrape. The region stays
+/// mapped until the engine is destroyed. Memory gauges (reserved / touched
+/// / high-water bytes of the pipeline, see InstrumentPipeline::
+/// memory_usage()) are refreshed at the start, every MEMORY_METRICS_EVERY
+/// messages and at the end of the run; the same breakdown is in
+/// ReplayStats::memory and the JSON report.
+///
+/// Reuse: reset() and set_input() ready a publisher-less engine for another
+/// file without rebuilding its pipeline, so a batch of sessions (see
+/// batch_replay.h) pays for allocating and faulting the book, pool and
+/// index once per engine rather than once per file.
 
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "core/types.h"
 #include "feed/l3_feed_parser.h"
+#include "feed/playback_pacer.h"
+#include "gateway/event_journal.h"
+#include "gateway/instrument_router.h"
 #include "gateway/market_data_publisher.h"
+#include "gateway/metrics_region.h"
+#include "gateway/multicast_publisher.h"
 #include "gateway/order_gateway.h"
 #include "matching/matching_engine.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
 #include "transport/event_buffer.h"
 #include "transport/message.h"
+#include "transport/spsc_ring_buffer.h"
+#include "transport/wait_strategy.h"
+#include "utils/thread_placement.h"
+#include "utils/trace_report.h"
 
 namespace hft {
 
-/// Playback speed mode.
+/// Playback speed mode. Realtime and FastForward release records at their
+/// recorded spacing (divided by speed_multiplier) via PlaybackPacer.
 enum class PlaybackSpeed : uint8_t { Max, Realtime, FastForward };
 
 /// Configuration for a replay session.
 struct ReplayConfig {
     std::string input_path;
+    /// Replay only this symbol's records of a multi-instrument (7-column or
+    /// binary) file, as one instrument; empty = every record. Files
+    /// without a symbol column are replayed whole.
+    std::string symbol;
     std::string output_path;                         // JSON report (empty = none)
     PlaybackSpeed speed = PlaybackSpeed::Max;
-    double speed_multiplier = 1.0;
+    double speed_multiplier = 1.0;                   // FastForward only
+    /// Paced waits sleep until this close to a deadline, then spin.
+    uint64_t pacing_spin_ns = PlaybackPacer::DEFAULT_SPIN_NS;
     Price min_price  = 41000LL * PRICE_SCALE;        // $41,000
     Price max_price  = 43000LL * PRICE_SCALE;        // $43,000
     Price tick_size  = PRICE_SCALE / 100;            // $0.01
     size_t max_orders = 100000;
+    PoolLocality pool_locality;                      // Order pool free lists (see MemoryPool)
+    size_t batch_size = 64;                          // Messages per process_batch (1 = one at a time)
     bool enable_publisher = false;
+    /// Journal the book's level changes so LevelUpdate events reach the
+    /// event callbacks (e.g. AnalyticsConfig::depth_from_level_updates).
+    bool level_updates = false;
+    /// Publish the book's BBO and top levels into a QuoteSnapshotSlot after
+    /// every call or batch (quote_snapshot()), for consumers on other
+    /// threads such as an AnalyticsThread.
+    bool quote_snapshot = false;
+    /// > 0: keep the book's state digest and stamp a BookDigest event into
+    /// the event stream every this many gateway calls (see OrderGateway).
+    /// The final digest is reported either way.
+    uint64_t digest_every = 0;
     bool verbose = false;
+
+    /// Run parser, matching and publisher as separate threads (see above).
+    /// Event callbacks then run on the publisher thread.
+    bool pipelined = false;
+    /// CPU pins, SCHED_FIFO and mlockall. The parser thread takes the
+    /// ingress role, the caller the matching role (in both modes).
+    ThreadingConfig threading;
+    /// How the pipelined matching and publisher threads wait on an empty
+    /// ring (Block attaches wakeup signals to both rings for the run).
+    WaitConfig consumer_wait;
+    /// What the gateway does when the publisher falls behind and the event
+    /// ring fills (spilled events are drained before the run returns).
+    BackpressureConfig backpressure;
+    /// Worker threads parsing the CSV in chunks (0 = the parser runs on
+    /// one thread); see L3FeedParser::set_parse_threads().
+    size_t parse_threads = 0;
+    size_t parse_chunk_bytes = L3FeedParser::DEFAULT_CHUNK_BYTES;
+    /// Write-ahead journal of the event stream (see event_journal.h); a
+    /// non-empty journal.directory turns it on, and the publisher with it.
+    JournalConfig journal;
+    /// Binary UDP feed of the event stream (see multicast_publisher.h); a
+    /// non-empty multicast.group turns it on, and the publisher with it.
+    /// Level content or a snapshot channel also turns on the book's level
+    /// deltas so LevelUpdate events reach it.
+    MulticastConfig multicast;
+
+    /// Seekable replay (see above). Checkpoints are written when either
+    /// period is non-zero, by inline runs on a seekable input (parse_threads
+    /// is then ignored); seek() reads them back from the same directory.
+    std::string checkpoint_directory;
+    uint64_t checkpoint_every_records = 0;
+    uint64_t checkpoint_every_ns = 0;                // Feed time
+    /// Stop before the first record stamped after this (0 = end of file).
+    Timestamp end_timestamp = 0;
+
+    /// Trace 1 in N orders through the pipeline stages (0 = off; needs an
+    /// HFT_ENABLE_TRACE build).
+    uint64_t trace_sample_every = 0;
+
+    /// Shared-memory metrics region to publish into (empty = off).
+    std::string metrics_name;
+};
+
+/// One entry of the checkpoint index: the book as of just before the
+/// record at `position`, stamped `timestamp`.
+struct ReplayCheckpoint {
+    Timestamp timestamp = 0;
+    uint64_t records = 0;        // Records read before it
+    L3FeedPosition position;
+    uint64_t index = 0;          // checkpoint-<index>.snap
 };
 
 /// Statistics collected during a replay session.
 struct ReplayStats {
+    bool input_opened = false;           // false: run() could not read the input
     uint64_t total_messages = 0;
     uint64_t add_messages = 0;
     uint64_t cancel_messages = 0;
     uint64_t trade_messages = 0;
     uint64_t parse_errors = 0;
+    uint64_t other_symbol_messages = 0;  // Skipped by ReplayConfig::symbol
     uint64_t orders_accepted = 0;
     uint64_t orders_rejected = 0;
     uint64_t orders_cancelled = 0;
@@ -63,8 +187,75 @@ struct ReplayStats {
     Price final_best_ask = 0;
     Price final_spread = 0;
     size_t final_order_count = 0;
+    uint64_t final_book_digest = 0;      // OrderBook::compute_state_digest()
     double elapsed_seconds = 0.0;
     double messages_per_second = 0.0;
+
+    // Pipelined mode only: per-stage throughput and queue behaviour.
+    // Stage rates are over each thread's own run time.
+    double parse_seconds = 0.0;
+    double match_seconds = 0.0;
+    double publish_seconds = 0.0;
+    double parse_messages_per_second = 0.0;
+    double match_messages_per_second = 0.0;
+    double publish_events_per_second = 0.0;
+    uint64_t events_published = 0;
+    uint64_t parser_stalls = 0;         // Pushes retried on a full ingress ring
+    uint64_t matching_idle_polls = 0;   // Pops that found the ingress ring empty
+    uint64_t publisher_idle_polls = 0;  // Polls that found no events
+    uint64_t matching_wakeups = 0;      // Blocked waits ended by the parser
+    uint64_t publisher_wakeups = 0;     // Blocked waits ended by matching
+    size_t ingress_depth_max = 0;       // Ingress ring depth, sampled per pop
+    double ingress_depth_avg = 0.0;
+    size_t event_depth_max = 0;         // Event ring depth, sampled per poll
+    double event_depth_avg = 0.0;
+    uint64_t backpressure_events = 0;   // Events that met a full event ring
+    double backpressure_seconds = 0.0;  // Matching time spent spinning on it
+    uint64_t events_spilled = 0;        // Through the overflow arena
+    uint64_t events_conflated = 0;      // Superseded while spilled
+    uint64_t events_dropped = 0;        // Block timeout expired
+    size_t overflow_high_water = 0;
+
+    // Realtime / FastForward only: how late records were released
+    // against their schedule (see PacingStats)
+    uint64_t paced_records = 0;
+    uint64_t pacing_sleeps = 0;
+    uint64_t pacing_overdue = 0;
+    double pacing_error_p50_ns = 0.0;
+    double pacing_error_p99_ns = 0.0;
+    double pacing_error_p99_9_ns = 0.0;
+    double pacing_error_max_ns = 0.0;
+
+    // Event journal only (see JournalStats)
+    uint64_t journal_events = 0;
+    uint64_t journal_dropped = 0;
+    uint64_t journal_bytes = 0;
+    uint64_t journal_segments = 0;
+    uint64_t journal_fsyncs = 0;
+    uint64_t journal_write_errors = 0;
+
+    // Multicast feed only (see MulticastStats)
+    uint64_t multicast_datagrams = 0;
+    uint64_t multicast_bytes = 0;
+    uint64_t multicast_dropped = 0;
+    uint64_t multicast_snapshots = 0;
+    uint64_t multicast_retransmitted = 0;
+    uint64_t multicast_send_errors = 0;
+
+    // Seekable replay only
+    uint64_t checkpoints_written = 0;
+    Timestamp seek_checkpoint_timestamp = 0;  // Restored by seek() (0 = none)
+    uint64_t seek_warmup_records = 0;         // Replayed from it up to the target
+    double seek_seconds = 0.0;
+
+    // Stage tracing only
+    uint64_t trace_records = 0;     // Collected from the trace rings
+    uint64_t trace_dropped = 0;     // Lost to full rings
+    uint64_t traced_orders = 0;     // Messages reconstructed (order_traces())
+
+    // Memory footprint at the end of the run
+    PipelineMemoryUsage memory;
+    MemoryUsage event_ring;         // Outbound EventBuffer (publisher only)
 };
 
 /// Orchestrates L3 data replay through the matching engine pipeline.
@@ -85,25 +276,155 @@ public:
     /// Run the replay to completion. Blocks until all records are processed.
     ReplayStats run();
 
+    /// Position the replay at `timestamp` before run(): restore the last
+    /// checkpoint at or before it (or start from the top of the file if
+    /// there is none) and replay the records in between without delivering
+    /// their events, so run() continues with the first record stamped at or
+    /// after `timestamp`. Returns false (with a message on stderr) if the
+    /// input is not seekable or a checkpoint fails to load.
+    bool seek(Timestamp timestamp);
+
+    /// Make the engine ready for another run() on a new input without
+    /// rebuilding it: resting orders go back to the pool
+    /// (OrderBook::clear), the trade, sequence and digest counters restart,
+    /// and any seek() is forgotten. The book, pool and index keep their
+    /// memory, so the next run starts warm. Returns false (with a message
+    /// on stderr) for an engine that publishes events, whose consumers
+    /// are bound to one run.
+    bool reset();
+
+    /// Input (and symbol filter) of the next run(). With `data`, the input
+    /// is parsed from that uncompressed image, which must outlive run()
+    /// (e.g. a read-only mapping shared by several engines), and `path`
+    /// only names it in messages and the report.
+    void set_input(const std::string& path, const std::string& symbol = {},
+                   std::string_view data = {});
+
+    /// Checkpoint index written into `directory` by an earlier run, oldest
+    /// first (empty if there is none).
+    [[nodiscard]] static std::vector<ReplayCheckpoint> load_checkpoints(
+        const std::string& directory);
+
     /// Register a callback to receive EventMessages during replay.
     /// Must be called before run().
     void register_event_callback(std::function<void(const EventMessage&)> cb);
 
     /// Access the order book (valid after run() completes).
-    [[nodiscard]] const OrderBook& order_book() const { return *book_; }
+    [[nodiscard]] const OrderBook& order_book() const { return *pipeline_.book; }
+
+    /// The outbound event ring (nullptr without the publisher). Consumers
+    /// on their own threads add a cursor to it before run().
+    [[nodiscard]] EventBuffer* event_buffer() const { return event_buffer_.get(); }
+
+    /// Per-message stage breakdowns of the traced orders (after run()).
+    [[nodiscard]] const std::vector<OrderTrace>& order_traces() const { return traces_; }
+
+    /// TSC ticks per nanosecond the traces were taken with.
+    [[nodiscard]] double trace_tsc_per_ns() const { return trace_tsc_per_ns_; }
+
+    /// The live metrics region (nullptr unless ReplayConfig::metrics_name).
+    [[nodiscard]] const MetricsRegion* metrics() const { return metrics_.get(); }
+
+    /// Writer labels of the metrics region's slots.
+    static constexpr uint32_t METRICS_MATCHING_THREAD = 0;
+    static constexpr uint32_t METRICS_PUBLISHER_THREAD = 1;
+    static constexpr uint32_t METRICS_PARSER_THREAD = 2;
+
+    /// Messages between two refreshes of the memory gauges.
+    static constexpr uint64_t MEMORY_METRICS_EVERY = uint64_t{1} << 20;
+
+    /// The book's published quote (nullptr unless ReplayConfig::quote_snapshot).
+    [[nodiscard]] const QuoteSnapshotSlot* quote_snapshot() const {
+        return pipeline_.quote.get();
+    }
 
 private:
+    /// Parser -> matching ring of the pipelined mode (1 MB).
+    using IngressRing = SPSCRingBuffer<OrderMessage, 8192>;
+
+    /// Count `record` into `stats`; if it changes the book, build its
+    /// message in `msg` and return true.
+    bool classify(const L3Record& record, const L3FeedParser& parser,
+                  ReplayStats& stats, OrderMessage& msg) const;
+
+    /// True (counted as another symbol's) if ReplayConfig::symbol is set
+    /// and `record` belongs to a different symbol.
+    bool other_symbol(const L3Record& record, ReplayStats& stats) const;
+
+    /// Parse, match and publish on the calling thread; `pacer` (if any)
+    /// holds each record back until it is due.
+    void run_inline(L3FeedParser& parser, PlaybackPacer* pacer, ReplayStats& stats);
+
+    /// Parser, matching and publisher threads (ReplayConfig::pipelined);
+    /// the parser thread does the pacing.
+    void run_pipelined(L3FeedParser& parser, PlaybackPacer* pacer, ReplayStats& stats);
+
+    /// Submit the buffered messages through the gateway and fold the
+    /// results into `stats`.
+    void flush_batch(std::vector<OrderMessage>& batch,
+                     std::vector<GatewayResult>& results, ReplayStats& stats);
+
+    /// Fold the gateway results of msgs[0..count) into `stats`.
+    void fold_results(const OrderMessage* msgs, const GatewayResult* results,
+                      size_t count, ReplayStats& stats) const;
+
+    /// Create and bind the metrics region on the first run().
+    void open_metrics();
+
+    /// Refresh the memory gauges (matching thread).
+    void publish_memory_metrics();
+
+    /// process_batch, timed into the metrics histogram when there is one.
+    void process_batch(const OrderMessage* msgs, size_t count, GatewayResult* results);
+
+    /// Open the input for run() unless seek() already did.
+    bool open_parser();
+
+    /// Snapshot the book as of just before the record at `position`.
+    void write_checkpoint(Timestamp timestamp, const L3FeedPosition& position,
+                          ReplayStats& stats);
+
+    /// Write checkpoints_ as the index of the checkpoint directory.
+    void write_checkpoint_index() const;
+
     /// Write a JSON report of the replay statistics.
     void write_report(const ReplayStats& stats) const;
 
     ReplayConfig config_;
-    std::unique_ptr<OrderBook> book_;
-    std::unique_ptr<MemoryPool<Order>> pool_;
-    std::unique_ptr<MatchingEngine> engine_;
+    InstrumentPipeline pipeline_;   // Book, pool, engine and gateway
     std::unique_ptr<EventBuffer> event_buffer_;
-    std::unique_ptr<OrderGateway> gateway_;
     std::unique_ptr<MarketDataPublisher> publisher_;
+    std::unique_ptr<EventJournal> journal_;
+    std::unique_ptr<MulticastPublisher> multicast_;
     std::vector<std::function<void(const EventMessage&)>> callbacks_;
+
+    std::string_view input_data_;            // set_input(): parsed in place
+    mutable uint32_t symbol_id_ = L3_NO_SYMBOL;  // Parser id of config_.symbol
+
+    // Seekable replay
+    std::unique_ptr<L3FeedParser> parser_;   // Kept open from seek() to run()
+    bool checkpointing_ = false;             // This run writes checkpoints
+    bool seeked_ = false;
+    std::vector<ReplayCheckpoint> checkpoints_;
+    ReplayStats seek_stats_{};               // Filled by seek(), folded into run()
+
+    // Stage tracing
+    std::vector<OrderTrace> traces_;
+    double trace_tsc_per_ns_ = 1.0;
+
+    // Live metrics
+    std::unique_ptr<MetricsRegion> metrics_;
+    GatewayMetrics gateway_metrics_;
+    PublisherMetrics publisher_metrics_;
+    MetricCounter parser_records_;
+    MetricCounter parser_stalls_;
+    HdrHistogram* batch_ticks_ = nullptr;   // In the region
+    MemoryMetrics memory_total_metrics_;
+    MemoryMetrics memory_levels_metrics_;
+    MemoryMetrics memory_order_index_metrics_;
+    MemoryMetrics memory_pool_metrics_;
+    MemoryMetrics memory_events_metrics_;
+    uint64_t memory_metrics_due_ = 0;       // Messages since the last refresh
 };
 
 }  // namespace hft
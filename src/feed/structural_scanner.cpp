@@ -0,0 +1,143 @@
+#include "feed/structural_scanner.h"
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Sanitizers flag the in-page over-read below, so they take the copy path
+#if defined(__SANITIZE_ADDRESS__)
+#define HFT_SCANNER_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HFT_SCANNER_SANITIZED 1
+#endif
+#endif
+#ifndef HFT_SCANNER_SANITIZED
+#define HFT_SCANNER_SANITIZED 0
+#endif
+
+namespace hft {
+
+namespace {
+
+/// Smallest page size of the supported targets.
+constexpr uintptr_t PAGE_BYTES = 4096;
+
+/// Bits [0, n) set.
+inline uint64_t low_bits(size_t n) noexcept {
+    return n >= 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+}
+
+#if defined(__AVX2__)
+
+inline uint32_t classify32(const char* p, const __m256i* needles) noexcept {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hit = _mm256_cmpeq_epi8(v, needles[0]);
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, needles[1]));
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, needles[2]));
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, needles[3]));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+}
+
+/// Mask of a full 64-byte block.
+inline uint64_t classify64(const char* p, const StructuralSet& set) noexcept {
+    // Unused slots repeat the last character, so four compares always work
+    const __m256i needles[4] = {_mm256_set1_epi8(set.chars[0]),
+                                _mm256_set1_epi8(set.chars[1]),
+                                _mm256_set1_epi8(set.chars[2]),
+                                _mm256_set1_epi8(set.chars[3])};
+    return uint64_t{classify32(p, needles)} |
+           (uint64_t{classify32(p + 32, needles)} << 32);
+}
+
+#elif defined(__SSE2__)
+
+inline uint32_t classify16(const char* p, const __m128i* needles) noexcept {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hit = _mm_cmpeq_epi8(v, needles[0]);
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, needles[1]));
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, needles[2]));
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, needles[3]));
+    return static_cast<uint32_t>(_mm_movemask_epi8(hit));
+}
+
+inline uint64_t classify64(const char* p, const StructuralSet& set) noexcept {
+    const __m128i needles[4] = {_mm_set1_epi8(set.chars[0]),
+                                _mm_set1_epi8(set.chars[1]),
+                                _mm_set1_epi8(set.chars[2]),
+                                _mm_set1_epi8(set.chars[3])};
+    return uint64_t{classify16(p, needles)} |
+           (uint64_t{classify16(p + 16, needles)} << 16) |
+           (uint64_t{classify16(p + 32, needles)} << 32) |
+           (uint64_t{classify16(p + 48, needles)} << 48);
+}
+
+#else
+
+inline uint64_t classify64(const char* p, const StructuralSet& set) noexcept {
+    return structural_mask_scalar(p, 64, set);
+}
+
+#endif
+
+}  // namespace
+
+uint64_t structural_mask_scalar(const char* p, size_t n,
+                                const StructuralSet& set) noexcept {
+    if (n > 64) n = 64;
+    uint64_t mask = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (uint8_t k = 0; k < set.count; ++k) {
+            if (p[i] == set.chars[k]) {
+                mask |= uint64_t{1} << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+uint64_t structural_mask(const char* p, size_t n, const StructuralSet& set) noexcept {
+    if (n >= 64) return classify64(p, set);
+#if !HFT_SCANNER_SANITIZED
+    // A load that stays inside p's page cannot fault; the bytes past n
+    // are masked off. Most CSV lines and FIX fields take this path.
+    if ((reinterpret_cast<uintptr_t>(p) & (PAGE_BYTES - 1)) <= PAGE_BYTES - 64) {
+        return classify64(p, set) & low_bits(n);
+    }
+#endif
+    // Short tail at a page end: classify a padded copy instead
+    alignas(64) char block[64];
+    std::memcpy(block, p, n);
+    return classify64(block, set) & low_bits(n);
+}
+
+size_t find_structurals(const char* p, size_t n, const StructuralSet& set,
+                        uint32_t* out, size_t max) noexcept {
+    size_t count = 0;
+    for (size_t base = 0; base < n; base += 64) {
+        uint64_t mask = structural_mask(p + base, n - base, set);
+        while (mask) {
+            if (count < max) {
+                out[count] = static_cast<uint32_t>(base + lowest_bit(mask));
+            }
+            ++count;
+            mask &= mask - 1;
+        }
+    }
+    return count;
+}
+
+const char* structural_scanner_isa() noexcept {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace hft
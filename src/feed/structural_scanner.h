@@ -0,0 +1,69 @@
+#pragma once
+
+/// @file structural_scanner.h
+/// @brief Vectorised search for the structural characters of the text
+///        feeds: ',' in L3 CSV, SOH or '|' and '=' in FIX.
+///
+/// simdjson-style: each call classifies up to 64 bytes at once into a
+/// bitmask (bit i set = byte i is structural), and parsers walk the set
+/// bits with count-trailing-zeros instead of testing every byte.
+/// structural_scanner.cpp is compiled with -march=native and picks AVX2,
+/// SSE2 or scalar code at build time (as level_kernels.cpp does);
+/// structural_mask_scalar() is the portable reference.
+///
+/// A block shorter than 64 bytes is loaded in place when the 64-byte load
+/// stays inside the same page (the excess bits are masked off); at a page
+/// end, or under AddressSanitizer, it is copied to a padded buffer first.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace hft {
+
+/// Up to four characters classified together.
+struct StructuralSet {
+    char chars[4] = {};
+    uint8_t count = 0;
+
+    constexpr StructuralSet() = default;
+    constexpr StructuralSet(char a) : chars{a, a, a, a}, count(1) {}
+    constexpr StructuralSet(char a, char b) : chars{a, b, b, b}, count(2) {}
+    constexpr StructuralSet(char a, char b, char c)
+        : chars{a, b, c, c}, count(3) {}
+    constexpr StructuralSet(char a, char b, char c, char d)
+        : chars{a, b, c, d}, count(4) {}
+};
+
+/// Bit i set iff p[i] is in `set`, for i < n (n <= 64; higher bits clear).
+[[nodiscard]] uint64_t structural_mask(const char* p, size_t n,
+                                       const StructuralSet& set) noexcept;
+
+/// Byte-at-a-time structural_mask(), for portability checks.
+[[nodiscard]] uint64_t structural_mask_scalar(const char* p, size_t n,
+                                              const StructuralSet& set) noexcept;
+
+/// Write the offsets of every structural character in [p, p + n) to
+/// out[0, max). Returns how many there are (which may exceed max).
+size_t find_structurals(const char* p, size_t n, const StructuralSet& set,
+                        uint32_t* out, size_t max) noexcept;
+
+/// Name of the instruction set the scanner was compiled for
+/// ("avx2", "sse2" or "scalar").
+[[nodiscard]] const char* structural_scanner_isa() noexcept;
+
+/// Index of the lowest set bit (mask != 0).
+[[nodiscard]] inline unsigned lowest_bit(uint64_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+    unsigned i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+}  // namespace hft
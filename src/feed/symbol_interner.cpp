@@ -0,0 +1,76 @@
+#include "feed/symbol_interner.h"
+
+#include <cstring>
+
+namespace hft {
+
+static size_t round_up_pow2(size_t n) {
+    size_t p = 16;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+SymbolInterner::SymbolInterner(size_t expected)
+    : slots_(round_up_pow2(expected * 2)), mask_(slots_.size() - 1) {}
+
+SymbolInterner::Key SymbolInterner::make_key(std::string_view symbol) noexcept {
+    Key key{0, 0};
+    const size_t n = symbol.size();
+    if (n == 0) return key;
+    std::memcpy(&key.lo, symbol.data(), n < 8 ? n : 8);
+    if (n > 8) std::memcpy(&key.hi, symbol.data() + 8, n < 16 ? n - 8 : 8);
+    return key;
+}
+
+size_t SymbolInterner::hash(const Key& key, size_t length) noexcept {
+    // Multiply-xorshift over the prefix words; the length separates
+    // symbols that share their first 16 bytes
+    uint64_t h = (key.lo * 0x9E3779B97F4A7C15ULL) ^ (key.hi * 0xC2B2AE3D27D4EB4FULL) ^ length;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return static_cast<size_t>(h);
+}
+
+uint32_t SymbolInterner::find(std::string_view symbol) const noexcept {
+    const Key key = make_key(symbol);
+    for (size_t i = hash(key, symbol.size()) & mask_;; i = (i + 1) & mask_) {
+        const Slot& slot = slots_[i];
+        if (slot.id == NOT_FOUND) return NOT_FOUND;
+        if (slot.lo == key.lo && slot.hi == key.hi && slot.length == symbol.size() &&
+            (symbol.size() <= 16 ||
+             std::memcmp(slot.data + 16, symbol.data() + 16, symbol.size() - 16) == 0)) {
+            return slot.id;
+        }
+    }
+}
+
+void SymbolInterner::insert(std::string_view symbol, uint32_t id) {
+    if (find(symbol) != NOT_FOUND) return;
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    const Key key = make_key(symbol);
+    size_t i = hash(key, symbol.size()) & mask_;
+    while (slots_[i].id != NOT_FOUND) i = (i + 1) & mask_;
+    slots_[i] = Slot{key.lo, key.hi, symbol.data(),
+                     static_cast<uint32_t>(symbol.size()), id};
+    ++size_;
+}
+
+void SymbolInterner::grow() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    mask_ = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == NOT_FOUND) continue;
+        size_t i = hash(Key{slot.lo, slot.hi}, slot.length) & mask_;
+        while (slots_[i].id != NOT_FOUND) i = (i + 1) & mask_;
+        slots_[i] = slot;
+    }
+}
+
+void SymbolInterner::clear() {
+    for (Slot& slot : slots_) slot = Slot{};
+    size_ = 0;
+}
+
+}  // namespace hft
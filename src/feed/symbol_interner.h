@@ -0,0 +1,65 @@
+#pragma once
+
+/// @file symbol_interner.h
+/// @brief Open-addressing symbol -> id table without per-lookup allocation.
+///
+/// Cold-path component. L3FeedParser interns the symbol column of every
+/// row, so a lookup must be cheap at hundreds of distinct symbols: a
+/// linear scan over the symbol list, or a std::unordered_map keyed by
+/// std::string, costs a compare per symbol or an allocation per row.
+///
+/// Each slot keeps the first 16 bytes of its symbol as two words next to
+/// the length and id, so a hit on a ticker-sized symbol is a hash and two
+/// word compares; longer symbols are compared in full after the prefix
+/// matches. The table is a power of two kept at most half full, and
+/// symbols are stored as views, which the caller keeps alive.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace hft {
+
+class SymbolInterner {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    explicit SymbolInterner(size_t expected = 64);
+
+    /// Id of `symbol`, or NOT_FOUND.
+    [[nodiscard]] uint32_t find(std::string_view symbol) const noexcept;
+
+    /// Map `symbol` to `id` unless it is already present. The bytes behind
+    /// `symbol` must outlive the interner (or the next clear()).
+    void insert(std::string_view symbol, uint32_t id);
+
+    [[nodiscard]] size_t size() const { return size_; }
+
+    void clear();
+
+private:
+    struct Slot {
+        uint64_t lo = 0;            // Symbol bytes 0-7, zero padded
+        uint64_t hi = 0;            // Symbol bytes 8-15, zero padded
+        const char* data = nullptr; // Full symbol (compared past 16 bytes)
+        uint32_t length = 0;
+        uint32_t id = NOT_FOUND;    // NOT_FOUND marks an empty slot
+    };
+
+    struct Key {
+        uint64_t lo;
+        uint64_t hi;
+    };
+
+    static Key make_key(std::string_view symbol) noexcept;
+    static size_t hash(const Key& key, size_t length) noexcept;
+
+    void grow();
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace hft
@@ -0,0 +1,182 @@
+#include "feed/workload_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+
+#include "feed/l3_feed_parser.h"
+
+namespace hft {
+
+namespace {
+
+/// Widen workload's price range to cover `price`.
+void cover(Workload& workload, Price price) {
+    if (price <= 0) return;
+    if (workload.min_price == 0 || price < workload.min_price) workload.min_price = price;
+    workload.max_price = std::max(workload.max_price, price);
+}
+
+/// Orders added and not yet cancelled, with O(1) random pick and removal.
+class LiveOrders {
+public:
+    struct Entry {
+        OrderId id;
+        Side side;
+    };
+
+    void add(OrderId id, Side side) {
+        index_[id] = entries_.size();
+        entries_.push_back({id, side});
+    }
+    [[nodiscard]] bool empty() const { return entries_.empty(); }
+    [[nodiscard]] const Entry& pick(std::mt19937_64& rng) const {
+        std::uniform_int_distribution<size_t> any(0, entries_.size() - 1);
+        return entries_[any(rng)];
+    }
+    void remove(OrderId id) {
+        auto it = index_.find(id);
+        const size_t i = it->second;
+        index_.erase(it);
+        if (i + 1 != entries_.size()) {
+            entries_[i] = entries_.back();
+            index_[entries_[i].id] = i;
+        }
+        entries_.pop_back();
+    }
+
+private:
+    std::vector<Entry> entries_;
+    std::unordered_map<OrderId, size_t> index_;
+};
+
+}  // namespace
+
+Workload generate_workload(const WorkloadConfig& config) {
+    Workload workload;
+    workload.name = "synthetic";
+    workload.tick_size = config.tick_size;
+    workload.messages.reserve(config.messages);
+
+    std::mt19937_64 rng(config.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::exponential_distribution<double> gap(config.arrival_rate / 1e9);
+    std::uniform_int_distribution<Quantity> quantity(config.min_quantity,
+                                                     std::max(config.min_quantity,
+                                                              config.max_quantity));
+    const double add_weight = 1.0;
+    const double total_weight = add_weight + config.cancel_to_add + config.modify_to_add;
+    const double alpha = config.distance_alpha > 0.0 ? config.distance_alpha : 1.0;
+
+    // Ticks from the touch: discrete power law, 0 at the touch
+    auto distance = [&]() -> Price {
+        const double u = 1.0 - unit(rng);   // (0, 1]
+        const double k = std::floor(std::pow(u, -1.0 / alpha)) - 1.0;
+        return static_cast<Price>(std::min(k, static_cast<double>(config.max_distance_ticks)));
+    };
+
+    const Price tick = config.tick_size;
+    double clock = static_cast<double>(config.start_timestamp);
+    OrderId next_id = 1;
+    LiveOrders live;
+
+    L3Record record{};
+    record.valid = true;
+    record.symbol_id = 0;
+    for (size_t i = 0; i < config.messages; ++i) {
+        clock += gap(rng);
+        record.timestamp = static_cast<Timestamp>(clock);
+        const Price bid_touch = config.mid - tick;
+        const Price ask_touch = config.mid + tick;
+
+        const double pick = unit(rng) * total_weight;
+        if (!live.empty() && pick >= add_weight + config.modify_to_add) {
+            const LiveOrders::Entry target = live.pick(rng);
+            record.order_id = target.id;
+            record.side = target.side;
+            record.price = 0;
+            record.quantity = 0;
+            workload.messages.push_back(L3FeedParser::to_cancel_message(record));
+            live.remove(target.id);
+            ++workload.cancels;
+            continue;
+        }
+        if (!live.empty() && pick >= add_weight) {
+            // Reprice at a fresh distance on the same side
+            const LiveOrders::Entry target = live.pick(rng);
+            record.order_id = target.id;
+            record.side = target.side;
+            record.price = target.side == Side::Buy ? bid_touch - distance() * tick
+                                                    : ask_touch + distance() * tick;
+            record.quantity = quantity(rng);
+            workload.messages.push_back(L3FeedParser::to_modify_message(record));
+            cover(workload, record.price);
+            ++workload.modifies;
+            continue;
+        }
+
+        record.order_id = next_id++;
+        record.side = unit(rng) < 0.5 ? Side::Buy : Side::Sell;
+        record.quantity = quantity(rng);
+        const Price cross = static_cast<Price>(config.aggressive_depth_ticks) * tick;
+        const bool aggressive = unit(rng) < config.aggressive_fraction;
+        if (aggressive) {
+            record.price = record.side == Side::Buy ? ask_touch + cross : bid_touch - cross;
+        } else {
+            record.price = record.side == Side::Buy ? bid_touch - distance() * tick
+                                                    : ask_touch + distance() * tick;
+        }
+        OrderMessage msg = L3FeedParser::to_order_message(record);
+        if (aggressive) {
+            msg.order.time_in_force = TimeInForce::IOC;   // Takes liquidity, never rests
+        } else {
+            live.add(record.order_id, record.side);
+        }
+        workload.messages.push_back(msg);
+        cover(workload, record.price);
+        ++workload.adds;
+    }
+    return workload;
+}
+
+bool load_workload(const std::string& path, Workload& workload, std::string& error) {
+    L3FeedParser parser;
+    if (!parser.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    workload = Workload{};
+    workload.name = path;
+
+    L3Record record;
+    while (parser.next(record)) {
+        if (!record.valid) continue;
+        switch (record.event_type) {
+            case L3EventType::Add:
+                workload.messages.push_back(L3FeedParser::to_order_message(record));
+                cover(workload, record.price);
+                ++workload.adds;
+                break;
+            case L3EventType::Cancel:
+                workload.messages.push_back(L3FeedParser::to_cancel_message(record));
+                ++workload.cancels;
+                break;
+            case L3EventType::Modify:
+                workload.messages.push_back(L3FeedParser::to_modify_message(record));
+                cover(workload, record.price);
+                ++workload.modifies;
+                break;
+            case L3EventType::Trade:
+            case L3EventType::Invalid:
+                break;   // Trades are the engine's own output
+        }
+    }
+    if (workload.messages.empty()) {
+        error = path + ": no add, cancel or modify records";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace hft
@@ -0,0 +1,75 @@
+#pragma once
+
+/// @file workload_generator.h
+/// @brief Order-flow workloads for benchmarks: recorded L3 traces and a
+///        parameterised synthetic generator.
+///
+/// Cold-path component. A Workload is the gateway messages of a session
+/// (Add / Cancel / Modify, in arrival order, with feed timestamps) plus
+/// the price range a book needs to hold them, built up front so a
+/// benchmark times only the engine.
+///
+/// load_workload() reads any input L3FeedParser accepts (CSV, binary,
+/// compressed). generate_workload() draws synthetic flow:
+///   - Poisson arrivals: exponential gaps at `arrival_rate` messages per
+///     second of feed time (so arrival-window batching sees real bursts);
+///   - message mix from `cancel_to_add` and `modify_to_add` (cancels and
+///     modifies per add), and `aggressive_fraction` of adds priced through
+///     the far touch as IOC;
+///   - passive prices at a power-law distance from the touch,
+///     P(distance >= k ticks) ~ (k + 1)^-`distance_alpha`, capped at
+///     `max_distance_ticks`;
+///   - cancel / modify targets drawn uniformly from the passive orders
+///     added and not yet cancelled (some will have filled, as cancels
+///     racing fills do in real flow).
+/// The mid stays put: passive orders never cross each other, so every
+/// trade comes from an aggressive order.
+/// The same seed yields the same workload.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+#include "transport/message.h"
+
+namespace hft {
+
+struct Workload {
+    std::string name;
+    std::vector<OrderMessage> messages;
+    Price min_price = 0;       // Lowest / highest price of any message
+    Price max_price = 0;
+    Price tick_size = PRICE_SCALE / 100;
+    size_t adds = 0;
+    size_t cancels = 0;
+    size_t modifies = 0;
+};
+
+struct WorkloadConfig {
+    uint64_t seed = 42;
+    size_t messages = 1'000'000;
+    double arrival_rate = 1'000'000.0;     // Messages per second of feed time
+    double cancel_to_add = 0.9;
+    double modify_to_add = 0.1;
+    double aggressive_fraction = 0.05;     // Of adds
+    double distance_alpha = 1.5;
+    uint32_t max_distance_ticks = 500;
+    uint32_t aggressive_depth_ticks = 5;   // Beyond the far touch
+    Price mid = 42'000LL * PRICE_SCALE;
+    Price tick_size = PRICE_SCALE / 100;
+    Quantity min_quantity = 1;
+    Quantity max_quantity = 100;
+    Timestamp start_timestamp = 1'704'067'200'000'000'000ULL;
+};
+
+/// Synthetic flow per `config` (see above).
+[[nodiscard]] Workload generate_workload(const WorkloadConfig& config);
+
+/// Every Add / Cancel / Modify record of `path`, with the price range of
+/// its adds. Returns false (with `error`) if it cannot be opened or holds
+/// no such records.
+[[nodiscard]] bool load_workload(const std::string& path, Workload& workload, std::string& error);
+
+}  // namespace hft
@@ -0,0 +1,354 @@
+#include "gateway/book_snapshot.h"
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+template <typename T>
+static void write_raw(std::ofstream& out, const T& value, SnapshotStats& stats) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    stats.bytes += sizeof(T);
+}
+
+template <typename T>
+static bool read_raw(std::ifstream& in, T* values, size_t count, SnapshotStats& stats) {
+    const size_t bytes = sizeof(T) * count;
+    in.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(bytes));
+    if (!in) return false;
+    stats.bytes += bytes;
+    return true;
+}
+
+static SnapshotStats fail(SnapshotStats& stats, std::string error) {
+    stats.ok = false;
+    stats.error = std::move(error);
+    return stats;
+}
+
+static uint32_t count_levels(const OrderBook& book, Side side) {
+    uint32_t n = 0;
+    for (const PriceLevel* l = book.next_level(side, nullptr); l;
+         l = book.next_level(side, l)) {
+        ++n;
+    }
+    return n;
+}
+
+static SnapshotOrder to_record(const Order& o) {
+    SnapshotOrder rec{};
+    rec.order_id = o.order_id;
+    rec.quantity = o.quantity;
+    rec.visible_quantity = o.visible_quantity;
+    rec.filled_quantity = o.filled_quantity;
+    rec.iceberg_slice_qty = o.iceberg_slice_qty;
+    rec.timestamp = o.timestamp;
+    rec.expire_time = o.expire_time;
+    rec.stop_price = o.stop_price;
+    rec.participant_id = o.participant_id;
+    rec.type = o.type;
+    rec.time_in_force = o.time_in_force;
+    rec.status = o.status;
+    return rec;
+}
+
+static void write_side(std::ofstream& out, const OrderBook& book, Side side,
+                       SnapshotStats& stats) {
+    for (const PriceLevel* l = book.next_level(side, nullptr); l;
+         l = book.next_level(side, l)) {
+        SnapshotLevel level{};
+        level.price = l->price;
+        level.order_count = l->order_count;
+        write_raw(out, level, stats);
+        for (const Order* o = l->head; o; o = o->next) write_raw(out, to_record(*o), stats);
+        ++stats.levels;
+        stats.orders += l->order_count;
+    }
+}
+
+/// Link one level of `records` (in time priority) into `p` at `price`.
+/// Returns false (error set) if the pool or the book cannot take it.
+static bool install_level(InstrumentPipeline& p, Side side, Price price,
+                          const std::vector<SnapshotOrder>& records,
+                          std::vector<Order*>& orders, SnapshotStats& stats) {
+    orders.clear();
+    for (const SnapshotOrder& rec : records) {
+        Order* o = p.pool->allocate(p.book->level_hint(price));
+        if (!o) break;
+        *o = Order{};
+        o->order_id = rec.order_id;
+        o->quantity = rec.quantity;
+        o->visible_quantity = rec.visible_quantity;
+        o->filled_quantity = rec.filled_quantity;
+        o->participant_id = rec.participant_id;
+        o->type = rec.type;
+        o->time_in_force = rec.time_in_force;
+        o->status = rec.status;
+        o->instrument_id = p.instrument_id;
+        o->iceberg_slice_qty = rec.iceberg_slice_qty;
+        o->timestamp = rec.timestamp;
+        o->stop_price = rec.stop_price;
+        o->expire_time = rec.expire_time;
+        orders.push_back(o);
+    }
+
+    const bool restored = orders.size() == records.size() &&
+        p.book->restore_level(side, price, orders.data(), orders.size());
+    if (!restored) {
+        for (Order* o : orders) p.pool->deallocate(o);
+        stats.error = (orders.size() < records.size())
+            ? "order pool exhausted for instrument " + std::to_string(p.instrument_id)
+            : "cannot restore level " + std::to_string(price) +
+              " of instrument " + std::to_string(p.instrument_id);
+        return false;
+    }
+
+    if (p.expiry) {
+        for (const Order* o : orders) {
+            if (o->expire_time != 0 && !p.expiry->schedule(o->order_id, o->expire_time)) {
+                stats.error = "expiry wheel full for instrument " +
+                              std::to_string(p.instrument_id);
+                return false;
+            }
+        }
+    }
+    ++stats.levels;
+    stats.orders += orders.size();
+    return true;
+}
+
+/// Read `levels` levels of `side` into `p`. Returns false (error set) on
+/// a short read or a level the book or pool cannot take.
+static bool read_side(std::ifstream& in, InstrumentPipeline& p, Side side,
+                      uint32_t levels, std::vector<SnapshotOrder>& records,
+                      std::vector<Order*>& orders, SnapshotStats& stats) {
+    for (uint32_t i = 0; i < levels; ++i) {
+        SnapshotLevel level{};
+        if (!read_raw(in, &level, 1, stats)) {
+            stats.error = "truncated snapshot";
+            return false;
+        }
+        records.resize(level.order_count);
+        if (!read_raw(in, records.data(), records.size(), stats)) {
+            stats.error = "truncated snapshot";
+            return false;
+        }
+        if (!install_level(p, side, level.price, records, orders, stats)) return false;
+    }
+    return true;
+}
+
+static bool has_stops(const InstrumentPipeline& p, SnapshotStats& stats) {
+    if (!p.stops || p.stops->size() == 0) return false;
+    stats.ok = false;
+    stats.error = "instrument " + std::to_string(p.instrument_id) +
+                  " has untriggered stop orders";
+    return true;
+}
+
+static void write_file_header(std::ofstream& out, size_t pipelines, SnapshotStats& stats) {
+    SnapshotFileHeader file{};
+    file.magic = SnapshotFileHeader::MAGIC;
+    file.version = SnapshotFileHeader::VERSION;
+    file.pipeline_count = static_cast<uint32_t>(pipelines);
+    write_raw(out, file, stats);
+}
+
+static bool read_file_header(std::ifstream& in, const std::string& path,
+                             SnapshotFileHeader& file, SnapshotStats& stats) {
+    if (!read_raw(in, &file, 1, stats) || file.magic != SnapshotFileHeader::MAGIC) {
+        stats.error = "not a book snapshot: " + path;
+        return false;
+    }
+    if (file.version != SnapshotFileHeader::VERSION) {
+        stats.error = "unsupported snapshot version " + std::to_string(file.version);
+        return false;
+    }
+    return true;
+}
+
+static SnapshotPipelineHeader make_header(const InstrumentPipeline& p) {
+    const OrderBook& book = *p.book;
+    SnapshotPipelineHeader header{};
+    header.instrument_id = p.instrument_id;
+    header.in_auction = p.engine->in_auction() ? 1 : 0;
+    header.min_price = book.min_price();
+    header.max_price = book.max_price();
+    header.tick_size = book.tick_size();
+    header.trade_count = p.engine->total_trade_count();
+    header.last_trade_price = p.engine->last_trade_price();
+    header.sequence_num = p.gateway->sequence_number();
+    header.orders_processed = p.gateway->orders_processed();
+    header.orders_rejected = p.gateway->orders_rejected();
+    header.bid_levels = count_levels(book, Side::Buy);
+    header.ask_levels = count_levels(book, Side::Sell);
+    header.order_count = book.order_count();
+    return header;
+}
+
+static void write_pipeline(std::ofstream& out, const InstrumentPipeline& p,
+                           SnapshotStats& stats) {
+    write_raw(out, make_header(p), stats);
+    write_side(out, *p.book, Side::Buy, stats);
+    write_side(out, *p.book, Side::Sell, stats);
+    ++stats.instruments;
+}
+
+/// Whether `p` can take the pipeline described by `header`: same price
+/// geometry, and empty. Sets the error if not.
+static bool check_target(const SnapshotPipelineHeader& header, const InstrumentPipeline& p,
+                         SnapshotStats& stats) {
+    const std::string instrument = std::to_string(header.instrument_id);
+    const OrderBook& book = *p.book;
+    if (book.min_price() != header.min_price || book.max_price() != header.max_price ||
+        book.tick_size() != header.tick_size) {
+        stats.error = "price geometry of instrument " + instrument +
+                      " does not match the snapshot";
+        return false;
+    }
+    if (book.order_count() != 0 || (p.stops && p.stops->size() > 0)) {
+        stats.error = "instrument " + instrument + " is not empty";
+        return false;
+    }
+    return true;
+}
+
+/// Once `p` holds the levels of `header`: verify them and carry over the
+/// engine and gateway state.
+static bool finish_pipeline(const SnapshotPipelineHeader& header, InstrumentPipeline& p,
+                            SnapshotStats& stats) {
+    if (p.book->order_count() != header.order_count) {
+        stats.error = "order count mismatch for instrument " +
+                      std::to_string(header.instrument_id);
+        return false;
+    }
+    p.engine->restore_trade_state(header.trade_count, header.last_trade_price);
+    if (header.in_auction) p.engine->begin_auction();
+    p.gateway->restore_counters(header.sequence_num, header.orders_processed,
+                                header.orders_rejected);
+    if (p.quote) p.quote->publish(*p.book, header.last_trade_price);
+    ++stats.instruments;
+    return true;
+}
+
+/// Restore the pipeline whose header was just read. Returns false (error
+/// set) if `p` does not match it or cannot take its orders.
+static bool read_pipeline(std::ifstream& in, const SnapshotPipelineHeader& header,
+                          InstrumentPipeline& p, std::vector<SnapshotOrder>& records,
+                          std::vector<Order*>& orders, SnapshotStats& stats) {
+    return check_target(header, p, stats) &&
+           read_side(in, p, Side::Buy, header.bid_levels, records, orders, stats) &&
+           read_side(in, p, Side::Sell, header.ask_levels, records, orders, stats) &&
+           finish_pipeline(header, p, stats);
+}
+
+static SnapshotStats finish_write(std::ofstream& out, const std::string& path,
+                                  SnapshotStats& stats) {
+    out.flush();
+    if (!out) return fail(stats, "write failed: " + path);
+    stats.ok = true;
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Save / restore
+// ---------------------------------------------------------------------------
+
+SnapshotStats save_snapshot(const InstrumentRouter& router, const std::string& path) {
+    SnapshotStats stats;
+    const size_t count = router.instrument_count();
+    for (size_t i = 0; i < count; ++i) {
+        if (has_stops(router.pipeline_at(i), stats)) return stats;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return fail(stats, "cannot open " + path);
+    write_file_header(out, count, stats);
+    for (size_t i = 0; i < count; ++i) write_pipeline(out, router.pipeline_at(i), stats);
+    return finish_write(out, path, stats);
+}
+
+SnapshotStats restore_snapshot(InstrumentRouter& router, const std::string& path) {
+    SnapshotStats stats;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail(stats, "cannot open " + path);
+    SnapshotFileHeader file{};
+    if (!read_file_header(in, path, file, stats)) return stats;
+
+    std::vector<SnapshotOrder> records;
+    std::vector<Order*> orders;
+    for (uint32_t i = 0; i < file.pipeline_count; ++i) {
+        SnapshotPipelineHeader header{};
+        if (!read_raw(in, &header, 1, stats)) return fail(stats, "truncated snapshot");
+        InstrumentPipeline* p = router.pipeline(header.instrument_id);
+        if (!p) {
+            return fail(stats, "instrument " + std::to_string(header.instrument_id) +
+                               " is not routed");
+        }
+        if (!read_pipeline(in, header, *p, records, orders, stats)) return stats;
+    }
+    stats.ok = true;
+    return stats;
+}
+
+SnapshotStats save_pipeline_snapshot(const InstrumentPipeline& pipeline,
+                                     const std::string& path) {
+    SnapshotStats stats;
+    if (has_stops(pipeline, stats)) return stats;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return fail(stats, "cannot open " + path);
+    write_file_header(out, 1, stats);
+    write_pipeline(out, pipeline, stats);
+    return finish_write(out, path, stats);
+}
+
+SnapshotStats restore_pipeline_snapshot(InstrumentPipeline& pipeline,
+                                        const std::string& path) {
+    SnapshotStats stats;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail(stats, "cannot open " + path);
+    SnapshotFileHeader file{};
+    if (!read_file_header(in, path, file, stats)) return stats;
+    if (file.pipeline_count != 1) return fail(stats, "not a single-pipeline snapshot: " + path);
+
+    SnapshotPipelineHeader header{};
+    if (!read_raw(in, &header, 1, stats)) return fail(stats, "truncated snapshot");
+    if (header.instrument_id != pipeline.instrument_id) {
+        return fail(stats, "snapshot is of instrument " +
+                           std::to_string(header.instrument_id));
+    }
+    std::vector<SnapshotOrder> records;
+    std::vector<Order*> orders;
+    if (!read_pipeline(in, header, pipeline, records, orders, stats)) return stats;
+    stats.ok = true;
+    return stats;
+}
+
+SnapshotStats clone_pipeline(const InstrumentPipeline& source, InstrumentPipeline& target) {
+    SnapshotStats stats;
+    if (has_stops(source, stats)) return stats;
+    const SnapshotPipelineHeader header = make_header(source);
+    if (!check_target(header, target, stats)) return stats;
+
+    std::vector<SnapshotOrder> records;
+    std::vector<Order*> orders;
+    const OrderBook& book = *source.book;
+    for (Side side : {Side::Buy, Side::Sell}) {
+        for (const PriceLevel* l = book.next_level(side, nullptr); l;
+             l = book.next_level(side, l)) {
+            records.clear();
+            for (const Order* o = l->head; o; o = o->next) records.push_back(to_record(*o));
+            if (!install_level(target, side, l->price, records, orders, stats)) return stats;
+        }
+    }
+    stats.ok = finish_pipeline(header, target, stats);
+    return stats;
+}
+
+}  // namespace hft
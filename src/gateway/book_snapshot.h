@@ -0,0 +1,136 @@
+#pragma once
+
+/// @file book_snapshot.h
+/// @brief Binary snapshot and restore of per-instrument book state.
+///
+/// Cold-path component. A snapshot records, for every pipeline of an
+/// InstrumentRouter, the resting orders of each price level in FIFO order
+/// plus the counters needed to carry on where the session left off (trade
+/// ids, last trade price, gateway sequence numbers, auction mode). Restore
+/// reads it into a router built from the same registry: orders are taken
+/// straight from each pipeline's pool and whole levels are linked with
+/// OrderBook::restore_level(), so warm-starting a deep book costs a
+/// sequential read rather than one add_order() per order.
+///
+/// File layout: a SnapshotFileHeader, then per pipeline a
+/// SnapshotPipelineHeader followed by its bid levels (best first) and ask
+/// levels (best first). Each level is a SnapshotLevel followed by its
+/// SnapshotOrder records. Structs are written raw (host byte order), so a
+/// snapshot is read back on the same architecture and build.
+///
+/// clone_pipeline() runs the same restore path from a live pipeline
+/// instead of a file, for a scratch copy to try order flow against (see
+/// what_if_sweep.h).
+///
+/// Not covered: untriggered stop orders (StopBook has no stable export),
+/// so pipelines holding any refuse to snapshot; and session-level state such
+/// as match statistics or the trade price range.
+///
+/// Usage:
+///   SnapshotStats saved = save_snapshot(router, "book.snap");
+///   ...
+///   InstrumentRouter fresh(registry, &events);
+///   SnapshotStats restored = restore_snapshot(fresh, "book.snap");
+///   if (!restored.ok) { ... restored.error ... }
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "core/types.h"
+#include "gateway/instrument_router.h"
+
+namespace hft {
+
+struct SnapshotFileHeader {
+    static constexpr uint64_t MAGIC = 0x3150414E53544648ULL;  // "HFTSNAP1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t pipeline_count;
+};
+
+struct SnapshotPipelineHeader {
+    InstrumentId instrument_id;
+    uint32_t in_auction;         // 1 if the engine was in call-auction mode
+    Price min_price;             // Geometry the restoring book must match
+    Price max_price;
+    Price tick_size;
+    uint64_t trade_count;        // BasicMatchingEngine trade id counter
+    Price last_trade_price;
+    uint64_t sequence_num;       // OrderGateway counters
+    uint64_t orders_processed;
+    uint64_t orders_rejected;
+    uint32_t bid_levels;
+    uint32_t ask_levels;
+    uint64_t order_count;        // Resting orders over both sides
+};
+
+struct SnapshotLevel {
+    Price price;
+    uint32_t order_count;
+    uint32_t reserved;
+};
+
+/// One resting order. Price and side come from its level; links are rebuilt.
+struct SnapshotOrder {
+    OrderId order_id;
+    Quantity quantity;
+    Quantity visible_quantity;
+    Quantity filled_quantity;
+    Quantity iceberg_slice_qty;
+    Timestamp timestamp;
+    Timestamp expire_time;
+    Price stop_price;
+    ParticipantId participant_id;
+    OrderType type;
+    TimeInForce time_in_force;
+    OrderStatus status;
+    uint8_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotPipelineHeader> &&
+              std::is_trivially_copyable_v<SnapshotOrder>,
+              "Snapshot records are written raw");
+
+struct SnapshotStats {
+    bool ok = false;
+    std::string error;           // Set when !ok
+    size_t instruments = 0;
+    size_t levels = 0;
+    size_t orders = 0;
+    uint64_t bytes = 0;
+};
+
+/// Write every pipeline of `router` to `path` (replacing it). Fails
+/// without writing if a pipeline holds untriggered stops.
+[[nodiscard]] SnapshotStats save_snapshot(const InstrumentRouter& router,
+                                          const std::string& path);
+
+/// Load `path` into `router`, whose pipelines for the snapshot's
+/// instruments must exist, be empty and have the same price geometry.
+/// Call from the matching thread before any traffic. On failure the router
+/// may hold part of the snapshot and should be discarded.
+[[nodiscard]] SnapshotStats restore_snapshot(InstrumentRouter& router,
+                                             const std::string& path);
+
+/// save_snapshot() / restore_snapshot() for a single pipeline outside a
+/// router (e.g. ReplayEngine checkpoints). The restoring pipeline must be
+/// empty and have the saved instrument id and price geometry.
+[[nodiscard]] SnapshotStats save_pipeline_snapshot(const InstrumentPipeline& pipeline,
+                                                   const std::string& path);
+[[nodiscard]] SnapshotStats restore_pipeline_snapshot(InstrumentPipeline& pipeline,
+                                                      const std::string& path);
+
+/// Copy the book and session state of `source` into `target` in memory,
+/// level by level as restore does (no file, no add_order() per order).
+/// `target` must be empty and have the same price geometry, e.g. a fresh
+/// build_instrument_pipeline() of the same config; reads of `source` are
+/// const, so several threads may clone one quiescent source at once.
+/// Fails like save_pipeline_snapshot() if `source` holds untriggered stops.
+[[nodiscard]] SnapshotStats clone_pipeline(const InstrumentPipeline& source,
+                                           InstrumentPipeline& target);
+
+}  // namespace hft
@@ -0,0 +1,132 @@
+#include "gateway/conflated_market_state.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// ConflatedMarketState — writer
+// ---------------------------------------------------------------------------
+
+ConflatedMarketState::ConflatedMarketState(size_t max_instruments)
+    : slot_count_(max_instruments),
+      slots_(std::make_unique<Slot[]>(max_instruments)),
+      images_(max_instruments) {
+    dirty_.reserve(max_instruments);
+    for (size_t i = 0; i < max_instruments; ++i) {
+        images_[i].state.instrument_id = static_cast<InstrumentId>(i);
+    }
+}
+
+void ConflatedMarketState::apply(const EventMessage& event) {
+    const InstrumentId id = event.instrument_id;
+    if (id >= slot_count_) {
+        ++events_ignored_;
+        return;
+    }
+    Image& image = images_[id];
+    if (event.type == EventType::LevelUpdate) {
+        const LevelUpdateEventData& l = event.data.level_update;
+        auto& side = (l.side == 0) ? image.bids : image.asks;
+        if (l.total_quantity == 0) {
+            side.erase(l.price);
+        } else {
+            side[l.price] = BookLevelState{l.price, l.total_quantity, l.order_count, 0};
+        }
+    } else if (event.type == EventType::Trade) {
+        image.state.last_trade_price = event.data.trade.price;
+        image.state.last_trade_quantity = event.data.trade.quantity;
+        image.state.last_trade_time = event.data.trade.timestamp;
+    } else {
+        return;  // Order events leave the book image to the level updates
+    }
+    image.state.sequence_num = event.sequence_num;
+    if (!image.dirty) {
+        image.dirty = true;
+        dirty_.push_back(id);
+    }
+    ++events_applied_;
+}
+
+size_t ConflatedMarketState::publish() noexcept {
+    for (InstrumentId id : dirty_) {
+        write_slot(id, images_[id]);
+        images_[id].dirty = false;
+    }
+    const size_t written = dirty_.size();
+    dirty_.clear();
+    return written;
+}
+
+void ConflatedMarketState::write_slot(InstrumentId id, Image& image) noexcept {
+    BookState& s = image.state;
+    s.bid_levels = 0;
+    for (auto it = image.bids.rbegin();
+         it != image.bids.rend() && s.bid_levels < CONFLATED_MAX_DEPTH; ++it) {
+        s.bids[s.bid_levels++] = it->second;
+    }
+    s.ask_levels = 0;
+    for (auto it = image.asks.begin();
+         it != image.asks.end() && s.ask_levels < CONFLATED_MAX_DEPTH; ++it) {
+        s.asks[s.ask_levels++] = it->second;
+    }
+
+    // Seqlock: odd while the copy is in progress
+    Slot& slot = slots_[id];
+    const uint64_t v = slot.version.load(std::memory_order_relaxed);
+    slot.version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.state, &s, sizeof(BookState));
+    slot.version.store(v + 2, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// ConflatedMarketState — readers
+// ---------------------------------------------------------------------------
+
+bool ConflatedMarketState::read(InstrumentId id, BookState& out) const noexcept {
+    if (id >= slot_count_) return false;
+    const Slot& slot = slots_[id];
+    for (;;) {
+        const uint64_t before = slot.version.load(std::memory_order_acquire);
+        if (before == 0) return false;
+        if (before & 1) continue;           // Writer mid-copy
+        std::memcpy(&out, &slot.state, sizeof(BookState));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) == before) return true;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ConflatedSubscriber
+// ---------------------------------------------------------------------------
+
+ConflatedSubscriber::ConflatedSubscriber(const ConflatedMarketState& state,
+                                         const SubscriptionConfig& config)
+    : state_(state),
+      depth_(config.mode == ConflationMode::TopOfBook
+                 ? 1u
+                 : static_cast<uint32_t>(std::clamp<size_t>(config.depth, 1,
+                                                            CONFLATED_MAX_DEPTH))),
+      interval_(config.max_rate_hz ? std::chrono::nanoseconds(1000000000 / config.max_rate_hz)
+                                   : std::chrono::nanoseconds(0)),
+      seen_(state.instrument_capacity(), 0) {}
+
+bool ConflatedSubscriber::due() noexcept {
+    if (interval_.count() == 0) return true;
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next_poll_) {
+        ++throttled_;
+        return false;
+    }
+    next_poll_ = now + interval_;
+    return true;
+}
+
+void ConflatedSubscriber::truncate(BookState& state) const noexcept {
+    state.bid_levels = std::min(state.bid_levels, depth_);
+    state.ask_levels = std::min(state.ask_levels, depth_);
+}
+
+}  // namespace hft
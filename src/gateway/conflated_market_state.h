@@ -0,0 +1,191 @@
+#pragma once
+
+/// @file conflated_market_state.h
+/// @brief Latest-state slots per instrument for slow market data subscribers.
+///
+/// Cold-path component. A MarketDataPublisher callback sees every event,
+/// so a slow consumer (a dashboard, the Python layer) either stalls the
+/// publisher or pushes backpressure into the gateway. Conflated
+/// subscribers read shared state instead:
+///
+///   ConflatedMarketState  — the publisher folds every event into a
+///                           per-instrument book image (set_conflated_state)
+///                           and, at the end of each poll(), writes the top
+///                           levels of each changed instrument into that
+///                           instrument's slot under a seqlock
+///   ConflatedSubscriber   — one per slow consumer, on any thread: delivers
+///                           the latest state of each instrument that
+///                           changed since its last poll, top of book or
+///                           depth-N, at most max_rate_hz times a second
+///
+/// The publisher never waits for a subscriber and nothing queues: a reader
+/// that falls behind skips the intermediate states (counted as conflated).
+/// Full-rate consumers keep using register_callback().
+///
+/// Depth comes from LevelUpdate events, so the books must publish level
+/// deltas (OrderBookOptions::level_deltas); trades set the last-trade
+/// fields either way.
+///
+/// Usage:
+///   ConflatedMarketState state(registry.size());
+///   publisher.set_conflated_state(&state);
+///   ...                                          // on the dashboard thread
+///   ConflatedSubscriber top(state, {ConflationMode::TopOfBook, 1, 10});
+///   top.poll([](const BookState& s) { ... s.bids[0] ... });
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "transport/message.h"
+
+namespace hft {
+
+/// Levels per side a slot holds.
+constexpr size_t CONFLATED_MAX_DEPTH = 10;
+
+struct BookLevelState {
+    Price price;
+    Quantity quantity;
+    uint32_t order_count;
+    uint32_t reserved;
+};
+
+/// One instrument's conflated state (levels best first).
+struct BookState {
+    InstrumentId instrument_id;
+    uint32_t bid_levels;          // Valid entries in bids / asks
+    uint32_t ask_levels;
+    uint32_t reserved;
+    uint64_t sequence_num;        // Last EventMessage folded in
+    Price last_trade_price;       // 0 = no trade yet
+    Quantity last_trade_quantity;
+    Timestamp last_trade_time;
+    BookLevelState bids[CONFLATED_MAX_DEPTH];
+    BookLevelState asks[CONFLATED_MAX_DEPTH];
+};
+
+class ConflatedMarketState {
+public:
+    /// @param max_instruments Slots, indexed by instrument id; events of
+    ///                        higher ids are ignored (and counted).
+    explicit ConflatedMarketState(size_t max_instruments);
+
+    ConflatedMarketState(const ConflatedMarketState&) = delete;
+    ConflatedMarketState& operator=(const ConflatedMarketState&) = delete;
+
+    // --- Writer (the publisher's thread) ---
+
+    /// Fold one event into its instrument's image.
+    void apply(const EventMessage& event);
+
+    /// Write every instrument changed since the last publish() into its
+    /// slot. Returns how many were written.
+    size_t publish() noexcept;
+
+    // --- Readers (any thread) ---
+
+    /// Copy the latest state of `id`. Returns false if `id` has no slot or
+    /// nothing was published for it yet. Retries while the writer is mid-copy.
+    bool read(InstrumentId id, BookState& out) const noexcept;
+
+    /// Even, and bumped by 2 on every publish of `id` (0 = none yet).
+    [[nodiscard]] uint64_t version(InstrumentId id) const noexcept {
+        return id < slot_count_ ? slots_[id].version.load(std::memory_order_acquire) : 0;
+    }
+
+    [[nodiscard]] size_t instrument_capacity() const noexcept { return slot_count_; }
+    [[nodiscard]] uint64_t events_applied() const noexcept { return events_applied_; }
+    [[nodiscard]] uint64_t events_ignored() const noexcept { return events_ignored_; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> version{0};   // Odd while being written
+        BookState state{};
+    };
+
+    /// Writer-side book image of one instrument.
+    struct Image {
+        std::map<Price, BookLevelState> bids;
+        std::map<Price, BookLevelState> asks;
+        BookState state{};                  // Last-trade and sequence fields
+        bool dirty = false;
+    };
+
+    void write_slot(InstrumentId id, Image& image) noexcept;
+
+    size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<Image> images_;
+    std::vector<InstrumentId> dirty_;
+    uint64_t events_applied_ = 0;
+    uint64_t events_ignored_ = 0;
+};
+
+enum class ConflationMode : uint8_t {
+    TopOfBook,  // Best bid and ask only
+    Depth       // Up to SubscriptionConfig::depth levels per side
+};
+
+struct SubscriptionConfig {
+    ConflationMode mode = ConflationMode::TopOfBook;
+    size_t depth = 5;                 // Depth mode (<= CONFLATED_MAX_DEPTH)
+    uint32_t max_rate_hz = 0;         // Polls delivering updates per second (0 = any)
+};
+
+/// A slow consumer's view of a ConflatedMarketState. Not thread-safe;
+/// use each from one thread.
+class ConflatedSubscriber {
+public:
+    ConflatedSubscriber(const ConflatedMarketState& state, const SubscriptionConfig& config);
+
+    /// Call `fn(const BookState&)` once for every instrument published
+    /// since the last delivering poll, truncated to the configured depth.
+    /// Returns the number delivered (0 if rate-limited).
+    template <typename Fn>
+    size_t poll(Fn&& fn) {
+        if (!due()) return 0;
+        size_t delivered = 0;
+        for (InstrumentId id = 0; id < seen_.size(); ++id) {
+            const uint64_t v = state_.version(id);
+            if (v == seen_[id]) continue;
+            if (!state_.read(id, scratch_)) continue;
+            // Versions step by 2 per publish; every step but the last was skipped
+            const uint64_t steps = (v - seen_[id]) / 2;
+            conflated_ += steps > 1 ? steps - 1 : 0;
+            seen_[id] = v;
+            truncate(scratch_);
+            fn(static_cast<const BookState&>(scratch_));
+            ++delivered;
+        }
+        delivered_ += delivered;
+        return delivered;
+    }
+
+    [[nodiscard]] uint64_t updates_delivered() const noexcept { return delivered_; }
+    /// Published states replaced by a newer one before this subscriber read them.
+    [[nodiscard]] uint64_t updates_conflated() const noexcept { return conflated_; }
+    [[nodiscard]] uint64_t polls_throttled() const noexcept { return throttled_; }
+
+private:
+    /// Rate limit: true (and the next slot booked) if a poll may deliver.
+    bool due() noexcept;
+    void truncate(BookState& state) const noexcept;
+
+    const ConflatedMarketState& state_;
+    uint32_t depth_;
+    std::chrono::nanoseconds interval_;
+    std::chrono::steady_clock::time_point next_poll_{};
+    std::vector<uint64_t> seen_;      // Version last delivered, per instrument
+    BookState scratch_{};
+    uint64_t delivered_ = 0;
+    uint64_t conflated_ = 0;
+    uint64_t throttled_ = 0;
+};
+
+}  // namespace hft
@@ -0,0 +1,472 @@
+#include "gateway/event_journal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+// Segment files are written with POSIX I/O; elsewhere open() fails with
+// an error (the reader only needs std::ifstream)
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define HFT_JOURNAL_POSIX 1
+#endif
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static constexpr size_t RECORD_BYTES = sizeof(EventMessage);
+
+static size_t round_up(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+/// Index of `name` if it is "<prefix>-NNNNNN.journal", else -1.
+static int64_t segment_index_of(const std::string& name, const std::string& prefix) {
+    static constexpr std::string_view SUFFIX = ".journal";
+    if (name.size() <= prefix.size() + 1 + SUFFIX.size()) return -1;
+    if (name.compare(0, prefix.size(), prefix) != 0 || name[prefix.size()] != '-') return -1;
+    if (name.compare(name.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) != 0) return -1;
+    int64_t index = 0;
+    for (size_t i = prefix.size() + 1; i < name.size() - SUFFIX.size(); ++i) {
+        if (name[i] < '0' || name[i] > '9') return -1;
+        index = index * 10 + (name[i] - '0');
+    }
+    return index;
+}
+
+/// Existing segments of `prefix` in `directory`, sorted by index.
+static std::vector<std::pair<int64_t, std::string>> list_segments(
+    const std::string& directory, const std::string& prefix) {
+    std::vector<std::pair<int64_t, std::string>> found;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        const int64_t index = segment_index_of(entry.path().filename().string(), prefix);
+        if (index >= 0) found.emplace_back(index, entry.path().string());
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+uint64_t journal_checksum(const EventMessage* records, size_t count) noexcept {
+    // FNV-1a over 64-bit words: cheap enough for the writer thread, and
+    // any torn or stale sector changes it
+    const auto* bytes = reinterpret_cast<const unsigned char*>(records);
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < count * RECORD_BYTES; i += sizeof(uint64_t)) {
+        uint64_t w;
+        std::memcpy(&w, bytes + i, sizeof(w));
+        h = (h ^ w) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+// ---------------------------------------------------------------------------
+// EventJournal — producer side
+// ---------------------------------------------------------------------------
+
+EventJournal::EventJournal(const JournalConfig& config) : config_(config) {}
+
+EventJournal::~EventJournal() {
+    close();
+    for (Buffer& buffer : buffers_) std::free(buffer.data);
+    std::free(scratch_);
+}
+
+std::string EventJournal::segment_path(const JournalConfig& config, uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%06llu.journal",
+                  static_cast<unsigned long long>(index));
+    return config.directory + "/" + config.prefix + name;
+}
+
+bool EventJournal::open() {
+    if (running_) return true;
+    if (config_.directory.empty()) {
+        error_ = "journal directory not set";
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(config_.directory, ec);
+    if (ec) {
+        error_ = "cannot create " + config_.directory + ": " + ec.message();
+        return false;
+    }
+
+    buffer_bytes_ = round_up(std::max(config_.buffer_bytes, 2 * BLOCK_ALIGN), BLOCK_ALIGN);
+    capacity_ = buffer_bytes_ / RECORD_BYTES - 1;  // Less the header
+    if (buffers_.empty()) {
+        buffers_.resize(std::max<size_t>(config_.buffers, 2));
+        for (Buffer& buffer : buffers_) {
+            buffer.data = static_cast<char*>(std::aligned_alloc(BLOCK_ALIGN, buffer_bytes_));
+            if (!buffer.data) {
+                error_ = "cannot allocate journal buffers";
+                return false;
+            }
+            std::memset(buffer.data, 0, buffer_bytes_);  // Fault the pages in now
+        }
+        scratch_ = static_cast<char*>(std::aligned_alloc(BLOCK_ALIGN, buffer_bytes_));
+        if (!scratch_) {
+            error_ = "cannot allocate journal buffers";
+            return false;
+        }
+    }
+    free_.clear();
+    pending_.clear();
+    free_.reserve(buffers_.size());
+    pending_.reserve(buffers_.size());
+    for (Buffer& buffer : buffers_) free_.push_back(&buffer);
+    free_count_.store(free_.size(), std::memory_order_relaxed);
+    current_ = nullptr;
+    open_ = nullptr;
+    acquire();
+
+    // Never overwrite an earlier run: continue after its last segment
+    const auto existing = list_segments(config_.directory, config_.prefix);
+    segment_index_ = existing.empty() ? 0 : static_cast<uint64_t>(existing.back().first) + 1;
+    if (!open_segment(segment_index_)) return false;
+
+    stopping_ = false;
+    running_ = true;
+    last_sync_ = std::chrono::steady_clock::now();
+    last_write_ = last_sync_;
+    writer_ = std::thread([this] { writer_loop(); });
+    return true;
+}
+
+bool EventJournal::append(const EventMessage& event) noexcept {
+    if (!current_) {
+        if (running_ && free_count_.load(std::memory_order_acquire) > 0) acquire();
+        if (!current_) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+            return false;
+        }
+    }
+    Buffer& buffer = *current_;
+    std::memcpy(buffer.data + RECORD_BYTES * (1 + buffer.count), &event, RECORD_BYTES);
+    ++buffer.count;
+    current_count_.store(buffer.count, std::memory_order_release);
+    appended_.store(appended_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (buffer.count == capacity_) {
+        submit();
+        if (free_count_.load(std::memory_order_acquire) > 0) acquire();
+    }
+    return true;
+}
+
+void EventJournal::flush() noexcept {
+    if (!running_ || !current_ || current_->count == 0) return;
+    submit();
+    if (free_count_.load(std::memory_order_acquire) > 0) acquire();
+}
+
+void EventJournal::acquire() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) return;
+    current_ = free_.back();
+    free_.pop_back();
+    free_count_.store(free_.size(), std::memory_order_release);
+    current_->count = 0;
+    current_->written = 0;
+    current_count_.store(0, std::memory_order_relaxed);
+    open_ = current_;
+}
+
+void EventJournal::submit() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(current_);
+        open_ = nullptr;
+    }
+    current_ = nullptr;
+    ready_.notify_one();
+}
+
+void EventJournal::close() {
+    if (!running_) return;
+    if (current_ && current_->count > 0) submit();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_one();
+    writer_.join();
+    running_ = false;
+    current_ = nullptr;
+}
+
+JournalStats EventJournal::stats() const {
+    JournalStats s;
+    s.events_appended = appended_.load(std::memory_order_relaxed);
+    s.events_dropped = dropped_.load(std::memory_order_relaxed);
+    s.events_written = events_written_.load(std::memory_order_relaxed);
+    s.blocks_written = blocks_written_.load(std::memory_order_relaxed);
+    s.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    s.segments = segments_.load(std::memory_order_relaxed);
+    s.fsyncs = fsyncs_.load(std::memory_order_relaxed);
+    s.write_errors = write_errors_.load(std::memory_order_relaxed);
+    s.direct_io = direct_io_;
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// EventJournal — writer thread
+// ---------------------------------------------------------------------------
+
+void EventJournal::writer_loop() {
+    ScopedThreadPlacement placement(config_.threading, ThreadRole::Journal);
+    const auto interval = std::chrono::milliseconds(config_.fsync_interval_ms);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (pending_.empty() && !stopping_) {
+            if (config_.fsync_interval_ms > 0) {
+                ready_.wait_for(lock, interval);
+            } else {
+                ready_.wait(lock);
+            }
+        }
+        if (!pending_.empty()) {
+            Buffer* buffer = pending_.front();
+            pending_.erase(pending_.begin());
+            lock.unlock();
+            write_block(*buffer);
+            lock.lock();
+            free_.push_back(buffer);
+            free_count_.store(free_.size(), std::memory_order_release);
+        } else if (stopping_) {
+            break;
+        } else if (config_.fsync_interval_ms > 0 && open_ &&
+                   std::chrono::steady_clock::now() - last_write_ >= interval) {
+            // Nothing filled up for a whole interval: write out what the
+            // producer's open buffer holds so far. Those records no longer
+            // change, and the buffer cannot be reused until this thread
+            // has written it.
+            Buffer* buffer = open_;
+            const uint32_t count = current_count_.load(std::memory_order_acquire);
+            if (count > buffer->written) {
+                lock.unlock();
+                write_range(*buffer, buffer->written, count);
+                buffer->written = count;
+                lock.lock();
+            }
+        }
+        if (config_.fsync == JournalFsync::Timed && dirty_ &&
+            std::chrono::steady_clock::now() - last_sync_ >= interval) {
+            lock.unlock();
+            sync();
+            lock.lock();
+        }
+    }
+    lock.unlock();
+    close_segment();
+}
+
+void EventJournal::write_block(Buffer& buffer) {
+    if (buffer.written == 0) {
+        write_records(buffer.data, buffer.count);
+    } else if (buffer.written < buffer.count) {
+        write_range(buffer, buffer.written, buffer.count);  // Rest of it
+    }
+}
+
+void EventJournal::write_range(const Buffer& buffer, uint32_t from, uint32_t to) {
+    std::memcpy(scratch_ + RECORD_BYTES, buffer.data + RECORD_BYTES * (1 + from),
+                RECORD_BYTES * (to - from));
+    write_records(scratch_, to - from);
+}
+
+void EventJournal::write_records(char* block, uint32_t count) {
+    const size_t used = RECORD_BYTES * (1 + count);
+    const size_t bytes = round_up(used, BLOCK_ALIGN);
+    last_write_ = std::chrono::steady_clock::now();
+
+    if (segment_size_ > 0 && segment_size_ + bytes > config_.segment_bytes) {
+        close_segment();
+        if (!open_segment(segment_index_ + 1)) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (fd_ < 0) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto* records = reinterpret_cast<const EventMessage*>(block + RECORD_BYTES);
+    JournalBlockHeader header{};
+    header.magic = JournalBlockHeader::MAGIC;
+    header.version = JournalBlockHeader::VERSION;
+    header.record_count = count;
+    header.segment_index = segment_index_;
+    header.block_index = block_index_;
+    header.first_sequence = records[0].sequence_num;
+    header.last_sequence = records[count - 1].sequence_num;
+    header.checksum = journal_checksum(records, count);
+    std::memcpy(block, &header, sizeof(header));
+    std::memset(block + used, 0, bytes - used);  // No stale records in the pad
+
+#if defined(HFT_JOURNAL_POSIX)
+    size_t done = 0;
+    while (done < bytes) {
+        const ssize_t n = ::pwrite(fd_, block + done, bytes - done,
+                                   static_cast<off_t>(segment_size_ + done));
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+#if defined(O_DIRECT)
+        } else if (n < 0 && errno == EINVAL && direct_io_) {
+            // The filesystem refused O_DIRECT after all: go buffered
+            const int flags = ::fcntl(fd_, F_GETFL);
+            ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+            direct_io_ = false;
+#endif
+        } else {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    segment_size_ += bytes;
+    ++block_index_;
+    dirty_ = true;
+    events_written_.fetch_add(count, std::memory_order_relaxed);
+    blocks_written_.fetch_add(1, std::memory_order_relaxed);
+    bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+    if (config_.fsync == JournalFsync::PerBatch) sync();
+#else
+    write_errors_.fetch_add(1, std::memory_order_relaxed);  // fd_ is never open
+#endif
+}
+
+bool EventJournal::open_segment(uint64_t index) {
+    const std::string path = segment_path(config_, index);
+    fd_ = -1;
+    direct_io_ = false;
+#if defined(HFT_JOURNAL_POSIX)
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#if defined(O_DIRECT)
+    if (config_.direct_io) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_io_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);  // e.g. tmpfs: no O_DIRECT
+    if (fd_ < 0) {
+        error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    segment_index_ = index;
+    segment_size_ = 0;
+    segments_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+#else
+    error_ = "cannot open " + path + ": the journal needs POSIX file I/O";
+    return false;
+#endif
+}
+
+void EventJournal::close_segment() {
+    if (fd_ < 0) return;
+    if (config_.fsync != JournalFsync::None && dirty_) sync();
+#if defined(HFT_JOURNAL_POSIX)
+    ::close(fd_);
+#endif
+    fd_ = -1;
+}
+
+void EventJournal::sync() {
+#if defined(__APPLE__)
+    if (fd_ >= 0 && ::fsync(fd_) == 0) {  // No fdatasync() declared
+        fsyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+#elif defined(HFT_JOURNAL_POSIX)
+    if (fd_ >= 0 && ::fdatasync(fd_) == 0) {
+        fsyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+    dirty_ = false;
+    last_sync_ = std::chrono::steady_clock::now();
+}
+
+// ---------------------------------------------------------------------------
+// EventJournalReader
+// ---------------------------------------------------------------------------
+
+bool EventJournalReader::open(const std::string& directory, const std::string& prefix) {
+    segments_.clear();
+    for (auto& [index, path] : list_segments(directory, prefix)) {
+        segments_.push_back(std::move(path));
+    }
+    segment_ = 0;
+    in_.close();
+    block_.clear();
+    index_ = 0;
+    return !segments_.empty();
+}
+
+bool EventJournalReader::next(EventMessage& event) {
+    while (index_ == block_.size()) {
+        if (!load_block()) return false;
+    }
+    event = block_[index_++];
+    ++events_read_;
+    return true;
+}
+
+bool EventJournalReader::load_block() {
+    // Bound on record_count, so a garbage header cannot size the read
+    static constexpr uint32_t MAX_RECORDS = 1u << 24;
+
+    while (segment_ < segments_.size()) {
+        if (!in_.is_open()) {
+            in_.open(segments_[segment_], std::ios::binary);
+            if (!in_) {
+                in_.close();
+                ++segment_;
+                continue;
+            }
+        }
+
+        JournalBlockHeader header;
+        in_.read(reinterpret_cast<char*>(&header), sizeof(header));
+        bool ok = in_.gcount() == static_cast<std::streamsize>(sizeof(header));
+        const bool at_end = in_.gcount() == 0;
+        if (ok) {
+            ok = header.magic == JournalBlockHeader::MAGIC &&
+                 header.version == JournalBlockHeader::VERSION &&
+                 header.record_count <= MAX_RECORDS;
+        }
+        if (ok) {
+            block_.resize(header.record_count);
+            const auto want = static_cast<std::streamsize>(header.record_count * RECORD_BYTES);
+            in_.read(reinterpret_cast<char*>(block_.data()), want);
+            ok = in_.gcount() == want &&
+                 journal_checksum(block_.data(), block_.size()) == header.checksum;
+        }
+        if (!ok) {
+            // End of segment, or a torn block that ends it
+            if (!at_end) ++corrupt_blocks_;
+            block_.clear();
+            in_.close();
+            in_.clear();
+            ++segment_;
+            continue;
+        }
+
+        const size_t used = RECORD_BYTES * (1 + header.record_count);
+        in_.ignore(static_cast<std::streamsize>(round_up(used, EventJournal::BLOCK_ALIGN) - used));
+        index_ = 0;
+        ++blocks_read_;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace hft
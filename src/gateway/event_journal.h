@@ -0,0 +1,240 @@
+#pragma once
+
+/// @file event_journal.h
+/// @brief Asynchronous write-ahead journal of the outbound event stream.
+///
+/// Cold-path component. EventJournal is an event consumer (typically a
+/// MarketDataPublisher callback) that records every EventMessage to disk
+/// for audit and recovery. append() only copies the event into a
+/// pre-allocated, 4 KB-aligned buffer; full buffers are handed to a
+/// writer thread, which writes them (O_DIRECT where the filesystem allows
+/// it), rotates segment files and applies the fsync policy. A buffer that
+/// fills slowly is not left in memory: every fsync_interval_ms the writer
+/// also writes the records appended to it so far as a block of their own,
+/// so a quiet stream still reaches disk without anyone calling flush().
+/// The consuming thread never waits on disk or on the writer: if every
+/// buffer is still queued for writing, events are dropped and counted
+/// instead (JournalStats::events_dropped).
+///
+/// On-disk layout: `<directory>/<prefix>-<NNNNNN>.journal` segments, each
+/// a sequence of blocks. A block is a 64-byte JournalBlockHeader followed
+/// by its records (raw 64-byte EventMessages), padded to a 4 KB multiple.
+/// The header carries a checksum of its records, so a torn write at the
+/// tail of the last segment is detected (and skipped) by
+/// EventJournalReader.
+///
+/// Writing needs POSIX file I/O (Linux, macOS); on other platforms open()
+/// fails with an error. EventJournalReader works everywhere.
+///
+/// Usage:
+///   EventJournal journal(config);
+///   if (!journal.open()) { ... journal.error() ... }
+///   publisher.register_callback([&](const EventMessage& e) { (void)journal.append(e); });
+///   ...
+///   journal.close();   // Writes the partial buffer and joins the writer
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "transport/message.h"
+#include "utils/thread_placement.h"
+
+namespace hft {
+
+/// When the writer makes journal data durable.
+enum class JournalFsync : uint8_t {
+    None,      // Leave it to the OS page cache / device
+    PerBatch,  // fdatasync after every block written
+    Timed      // fdatasync at most every fsync_interval_ms while dirty
+};
+
+struct JournalConfig {
+    std::string directory;            // Empty = journaling disabled
+    std::string prefix = "events";
+    size_t buffer_bytes = size_t{1} << 20;         // Per block (rounded to 4 KB)
+    size_t buffers = 8;                            // Blocks in flight (>= 2)
+    size_t segment_bytes = size_t{256} << 20;      // Rotate past this size
+    JournalFsync fsync = JournalFsync::Timed;
+    /// Timed: sync period. Any policy: the writer also writes out the
+    /// partially filled buffer this often (0 = only when full or flushed).
+    uint32_t fsync_interval_ms = 100;
+    bool direct_io = true;            // O_DIRECT (falls back if unsupported)
+    /// The writer thread takes the Journal role.
+    ThreadingConfig threading;
+};
+
+/// Block header, one cache line, at every 4 KB-aligned block start.
+struct JournalBlockHeader {
+    static constexpr uint64_t MAGIC = 0x314B4C424A544648ULL;  // "HFTJBLK1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_count;
+    uint64_t segment_index;
+    uint64_t block_index;        // Across the whole journal
+    uint64_t first_sequence;     // EventMessage::sequence_num of the records
+    uint64_t last_sequence;
+    uint64_t checksum;           // journal_checksum() of the records
+    uint64_t reserved;
+};
+
+static_assert(sizeof(JournalBlockHeader) == sizeof(EventMessage),
+              "Journal records stay 64-byte aligned after the header");
+
+/// Checksum stored in JournalBlockHeader::checksum.
+[[nodiscard]] uint64_t journal_checksum(const EventMessage* records, size_t count) noexcept;
+
+struct JournalStats {
+    uint64_t events_appended = 0;
+    uint64_t events_dropped = 0;      // No free buffer (writer behind)
+    uint64_t events_written = 0;
+    uint64_t blocks_written = 0;
+    uint64_t bytes_written = 0;       // Including headers and padding
+    uint64_t segments = 0;
+    uint64_t fsyncs = 0;
+    uint64_t write_errors = 0;
+    bool direct_io = false;           // O_DIRECT was in effect
+};
+
+class EventJournal {
+public:
+    /// Block alignment (and O_DIRECT granularity).
+    static constexpr size_t BLOCK_ALIGN = 4096;
+
+    explicit EventJournal(const JournalConfig& config);
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    /// Create the directory and first segment, allocate the buffers and
+    /// start the writer. Returns false (see error()) on failure.
+    [[nodiscard]] bool open();
+
+    /// Record one event. Never blocks on the writer or on disk; returns
+    /// false if the event was dropped because all buffers are in flight.
+    bool append(const EventMessage& event) noexcept;
+
+    /// Hand the partially filled buffer to the writer (non-blocking).
+    void flush() noexcept;
+
+    /// Flush, wait for the writer to drain, sync (unless JournalFsync::None)
+    /// and close the segment. Call from the appending thread (or after it
+    /// has stopped). Idempotent; also called by the destructor.
+    void close();
+
+    [[nodiscard]] bool is_open() const { return running_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    /// Counters so far (writer-side ones are approximate while running).
+    [[nodiscard]] JournalStats stats() const;
+
+    /// Path of segment `index` for `config`.
+    [[nodiscard]] static std::string segment_path(const JournalConfig& config,
+                                                  uint64_t index);
+
+private:
+    struct Buffer {
+        char* data = nullptr;
+        uint32_t count = 0;   // Records after the header
+        uint32_t written = 0; // Records already written out early (writer)
+    };
+
+    /// Take a free buffer as current_, or leave it null if none is free.
+    void acquire() noexcept;
+
+    /// Queue current_ for writing.
+    void submit() noexcept;
+
+    void writer_loop();
+    void write_block(Buffer& buffer);
+    /// Write records [from, to) of `buffer` as one block via scratch_.
+    void write_range(const Buffer& buffer, uint32_t from, uint32_t to);
+    /// Write `count` records laid out after the header slot at `block`.
+    void write_records(char* block, uint32_t count);
+    bool open_segment(uint64_t index);
+    void close_segment();
+    void sync();
+
+    JournalConfig config_;
+    std::string error_;
+    size_t buffer_bytes_ = 0;
+    size_t capacity_ = 0;               // Records per buffer
+    std::vector<Buffer> buffers_;
+
+    // Producer side (the appending thread)
+    Buffer* current_ = nullptr;
+    std::atomic<uint32_t> current_count_{0};  // current_->count, published
+    std::atomic<size_t> free_count_{0};
+    std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // Shared, under mutex_
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::vector<Buffer*> free_;
+    std::vector<Buffer*> pending_;      // FIFO, written in order
+    Buffer* open_ = nullptr;            // current_ as the writer sees it
+    bool stopping_ = false;
+
+    // Writer side
+    std::thread writer_;
+    bool running_ = false;
+    int fd_ = -1;
+    uint64_t segment_index_ = 0;
+    uint64_t segment_size_ = 0;
+    uint64_t block_index_ = 0;
+    bool dirty_ = false;                // Written since the last sync
+    char* scratch_ = nullptr;           // Aligned block for early writes
+    std::chrono::steady_clock::time_point last_sync_;
+    std::chrono::steady_clock::time_point last_write_;
+    std::atomic<uint64_t> events_written_{0};
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> segments_{0};
+    std::atomic<uint64_t> fsyncs_{0};
+    std::atomic<uint64_t> write_errors_{0};
+    bool direct_io_ = false;
+};
+
+/// Sequential reader over a journal directory, for recovery and audit.
+class EventJournalReader {
+public:
+    /// Open every `<prefix>-NNNNNN.journal` segment in `directory`, in
+    /// index order. Returns false if there is none.
+    [[nodiscard]] bool open(const std::string& directory,
+                            const std::string& prefix = "events");
+
+    /// Next recorded event. Returns false at the end of the journal. A
+    /// block with a bad header or checksum ends its segment (torn tail).
+    bool next(EventMessage& event);
+
+    [[nodiscard]] uint64_t events_read() const { return events_read_; }
+    [[nodiscard]] uint64_t blocks_read() const { return blocks_read_; }
+    [[nodiscard]] uint64_t corrupt_blocks() const { return corrupt_blocks_; }
+    [[nodiscard]] size_t segment_count() const { return segments_.size(); }
+
+private:
+    /// Load the next valid block into block_; false at end of journal.
+    bool load_block();
+
+    std::vector<std::string> segments_;
+    size_t segment_ = 0;
+    std::ifstream in_;                  // Current segment
+    std::vector<EventMessage> block_;
+    size_t index_ = 0;
+    uint64_t events_read_ = 0;
+    uint64_t blocks_read_ = 0;
+    uint64_t corrupt_blocks_ = 0;
+};
+
+}  // namespace hft
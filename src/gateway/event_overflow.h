@@ -0,0 +1,174 @@
+#pragma once
+
+/// @file event_overflow.h
+/// @brief What the OrderGateway does when its event ring is full, and the
+///        pre-allocated overflow arena behind the Spill / Conflate policies.
+///
+/// Zero heap allocation after construction. The arena is a FIFO of whole
+/// EventMessages that holds events the ring had no room for; the gateway
+/// drains it into the ring, oldest first, before publishing anything new,
+/// so consumers still see one stream in sequence order.
+///
+/// Conflate additionally replaces a pending order-state event with a newer
+/// one for the same order (and a pending LevelUpdate with a newer one for
+/// the same level): the older record is tombstoned and skipped by the
+/// drain. Trades and mass cancels are never conflated, and neither are
+/// rejections: an OrderRejected answers one message, not the lifecycle of
+/// the live order that may share its ID (a duplicate-ID reject must not
+/// replace that order's acceptance, nor be replaced by it). Order-state
+/// events never conflate across a pending trade or mass cancel, so every
+/// order's states stay in order with the trades that touched it. A
+/// conflated event leaves a gap in sequence_num.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "orderbook/backing_memory.h"
+#include "transport/message.h"
+
+namespace hft {
+
+/// Gateway behaviour when the event ring is full.
+enum class BackpressurePolicy : uint8_t {
+    Block,    // Spin until the consumer frees a slot (optionally timed out)
+    Spill,    // Queue in the overflow arena, drained in order
+    Conflate  // Spill, keeping only the latest pending state per order/level
+};
+
+struct BackpressureConfig {
+    BackpressurePolicy policy = BackpressurePolicy::Block;
+    /// Block: give up and drop the event after spinning this long
+    /// (0 = never drop).
+    uint64_t block_timeout_ns = 0;
+    /// Spill / Conflate: events the arena holds. When it is full too the
+    /// gateway spins without timeout, so nothing is lost.
+    size_t overflow_capacity = 65536;
+    /// Conflate: most recent pending events searched for one to replace.
+    size_t conflate_window = 256;
+};
+
+/// Whether `type` carries OrderEventData (one order's new state).
+[[nodiscard]] constexpr bool is_order_state_event(EventType type) noexcept {
+    return type != EventType::Trade && type != EventType::MassCancel &&
+           type != EventType::LevelUpdate && type != EventType::BookDigest;
+}
+
+/// Whether `type` is one step of a live order's lifecycle, so a newer
+/// state for the same order supersedes it.
+[[nodiscard]] constexpr bool is_conflatable_order_state(EventType type) noexcept {
+    return is_order_state_event(type) && type != EventType::OrderRejected;
+}
+
+/// Fixed-capacity FIFO of events waiting for room in the event ring.
+class EventOverflowArena {
+public:
+    EventOverflowArena() noexcept = default;
+
+    /// @param capacity Events held; 0 leaves the arena unused.
+    explicit EventOverflowArena(size_t capacity) { reset(capacity); }
+
+    ~EventOverflowArena() {
+        std::free(events_);
+        std::free(live_);
+    }
+
+    EventOverflowArena(const EventOverflowArena&) = delete;
+    EventOverflowArena& operator=(const EventOverflowArena&) = delete;
+
+    /// (Re)allocate for `capacity` events, discarding anything pending.
+    /// Cold path.
+    void reset(size_t capacity) {
+        std::free(events_);
+        std::free(live_);
+        events_ = nullptr;
+        live_ = nullptr;
+        capacity_ = capacity;
+        head_ = tail_ = live_count_ = 0;
+        if (capacity_ == 0) return;
+        events_ = static_cast<EventMessage*>(
+            std::calloc(capacity_, sizeof(EventMessage)));
+        live_ = static_cast<uint8_t*>(std::calloc(capacity_, 1));
+        if (!events_ || !live_) {
+            std::abort();  // Startup failure — no recovery
+        }
+    }
+
+    /// Records queued, tombstones included.
+    [[nodiscard]] size_t size() const noexcept { return tail_ - head_; }
+    [[nodiscard]] bool empty() const noexcept { return tail_ == head_; }
+    [[nodiscard]] bool full() const noexcept { return size() == capacity_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    /// Events still to be published.
+    [[nodiscard]] size_t live() const noexcept { return live_count_; }
+
+    /// Bytes per queued event (record plus its live flag).
+    static constexpr size_t EVENT_BYTES = sizeof(EventMessage) + 1;
+
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage = heap_usage(events_, capacity_ * sizeof(EventMessage));
+        usage += heap_usage(live_, capacity_);
+        return usage;
+    }
+
+    /// Append an event. full() must be false.
+    void push(const EventMessage& event) noexcept {
+        const size_t i = tail_++ % capacity_;
+        events_[i] = event;
+        live_[i] = 1;
+        ++live_count_;
+    }
+
+    /// Oldest live event, dropping tombstones ahead of it; nullptr if none.
+    [[nodiscard]] const EventMessage* front() noexcept {
+        while (head_ != tail_ && !live_[head_ % capacity_]) ++head_;
+        return head_ == tail_ ? nullptr : &events_[head_ % capacity_];
+    }
+
+    /// Remove the event front() returned.
+    void pop() noexcept {
+        live_[head_++ % capacity_] = 0;
+        --live_count_;
+    }
+
+    /// Tombstone the newest pending event that `event` supersedes, looking
+    /// back at most `window` records. @return true if one was replaced.
+    bool conflate(const EventMessage& event, size_t window) noexcept {
+        const bool order_state = is_conflatable_order_state(event.type);
+        if (!order_state && event.type != EventType::LevelUpdate) return false;
+        const size_t n = size() < window ? size() : window;
+        for (size_t k = 1; k <= n; ++k) {
+            const size_t i = (tail_ - k) % capacity_;
+            const EventMessage& e = events_[i];
+            if (order_state) {
+                if (e.type == EventType::Trade || e.type == EventType::MassCancel) {
+                    return false;  // Keep states in order with the fills
+                }
+                if (!live_[i] || !is_conflatable_order_state(e.type) ||
+                    e.data.order_event.order_id != event.data.order_event.order_id) {
+                    continue;
+                }
+            } else {
+                if (!live_[i] || e.type != EventType::LevelUpdate ||
+                    e.data.level_update.side != event.data.level_update.side ||
+                    e.data.level_update.price != event.data.level_update.price) {
+                    continue;
+                }
+            }
+            live_[i] = 0;
+            --live_count_;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    EventMessage* events_ = nullptr;
+    uint8_t* live_ = nullptr;   // 0 = tombstone (conflated or popped)
+    size_t capacity_ = 0;
+    size_t head_ = 0;           // Monotonic; index = value % capacity_
+    size_t tail_ = 0;
+    size_t live_count_ = 0;
+};
+
+}  // namespace hft
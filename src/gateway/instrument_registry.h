@@ -11,6 +11,11 @@
 #include <vector>
 
 #include "core/types.h"
+#include "gateway/event_overflow.h"
+#include "matching/match_result.h"
+#include "matching/matching_engine.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
 
 namespace hft {
 
@@ -22,6 +27,50 @@ struct InstrumentConfig {
     Price max_price = 0;
     Price tick_size = 0;
     size_t max_orders = 100000;
+    OrderBookOptions book_options;  // Flat ladder unless windowed mode is set
+    /// Backing for the order pool, level arrays and order-id map. Applied
+    /// to the whole pipeline; overrides book_options.memory.
+    MemoryBacking memory;
+    /// > 0: the order pool and order-id map start sized for this many
+    /// orders and grow (pool by this step, map by doubling) up to
+    /// max_orders. 0 pre-allocates max_orders up front. Segments are mapped
+    /// by the router's idle hook (InstrumentRouter::maintain).
+    size_t pool_segment_orders = 0;
+    /// Free lists by storage colour, allocated by level index so orders at
+    /// one price level share pages (see MemoryPool). Not applied to a
+    /// shared-pool view, which follows SharedPoolConfig::locality.
+    PoolLocality pool_locality;
+    /// Draw orders from the router's shared pool (if one is configured),
+    /// with max_orders as this instrument's quota.
+    bool shared_pool = false;
+    /// Self-trade prevention for this instrument's engine.
+    SelfTradePreventionMode stp_mode = SelfTradePreventionMode::None;
+    /// Order types the engine accepts. Turning off features an instrument
+    /// never trades selects a leaner compile-time engine; orders needing a
+    /// disabled feature are rejected.
+    MatchingFeatures matching_features;
+    /// > 0: attach a StopBook sized for this many live Stop/StopLimit
+    /// orders. 0 = stops are rejected.
+    size_t max_stop_orders = 0;
+    /// > 0: attach an ExpiryWheel with this many timers so DAY/GTD orders
+    /// expire. 0 = DAY orders never expire and GTD orders are rejected.
+    size_t max_timed_orders = 0;
+    /// Wheel resolution and the expiry of DAY orders without their own
+    /// expire_time (0 = such orders stay untimed).
+    Timestamp expiry_tick_ns = 1'000'000;
+    Timestamp session_close = 0;
+    /// Relative message rate, used by ShardAssignment::ByLoad to balance
+    /// instruments across router shards.
+    double expected_load = 1.0;
+    /// What this instrument's gateway does when the event ring is full.
+    BackpressureConfig backpressure;
+    /// Publish BBO and top-of-book depth into a QuoteSnapshotSlot for
+    /// readers on other threads (InstrumentRouter::quote_snapshot).
+    bool quote_snapshot = false;
+    /// > 0: keep the book's state digest (implies book_options.state_digest)
+    /// and stamp it into the event stream as a BookDigest event every this
+    /// many gateway calls (OrderGateway::set_digest_every).
+    uint64_t digest_every = 0;
 };
 
 /// Cold-path registry mapping InstrumentId <-> symbol with per-instrument config.
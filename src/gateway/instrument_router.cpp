@@ -5,38 +5,187 @@
 namespace hft {
 
 InstrumentRouter::InstrumentRouter(const InstrumentRegistry& registry,
-                                   EventBuffer* event_buffer) {
+                                   EventBuffer* event_buffer,
+                                   const SharedPoolConfig& shared)
+    : event_buffer_(event_buffer) {
+    if (shared.initial_orders > 0) {
+        PoolGrowth growth;
+        growth.segment_slots = shared.segment_orders;
+        growth.max_slots = shared.max_orders;
+        shared_pool_ = std::make_unique<MemoryPool<Order>>(
+            shared.initial_orders, shared.memory, growth, shared.locality);
+    }
+
+    auto table = std::make_unique<RoutingTable>();
     const auto& instruments = registry.instruments();
-    if (instruments.empty()) return;
+    if (!instruments.empty()) {
+        // Find max instrument_id to size the lookup table
+        InstrumentId max_id = 0;
+        for (const auto& cfg : instruments) {
+            max_id = std::max(max_id, cfg.instrument_id);
+        }
+        table->by_id.assign(static_cast<size_t>(max_id) + 1, nullptr);
+        pipelines_.reserve(instruments.size());
 
-    // Find max instrument_id to size the lookup table
-    InstrumentId max_id = 0;
-    for (const auto& cfg : instruments) {
-        max_id = std::max(max_id, cfg.instrument_id);
+        for (const auto& cfg : instruments) {
+            pipelines_.push_back(build_pipeline(cfg));
+            table->by_id[cfg.instrument_id] = pipelines_.back().get();
+            table->active.push_back(pipelines_.back().get());
+        }
     }
+    table_.store(table.release(), std::memory_order_release);
+}
+
+InstrumentRouter::~InstrumentRouter() {
+    delete table_.load(std::memory_order_relaxed);
+}
 
-    id_to_index_.assign(static_cast<size_t>(max_id) + 1, INVALID_INDEX);
-    pipelines_.reserve(instruments.size());
+// ---------------------------------------------------------------------------
+// Listing and delisting
+// ---------------------------------------------------------------------------
 
-    for (const auto& cfg : instruments) {
-        InstrumentPipeline pipeline;
-        pipeline.instrument_id = cfg.instrument_id;
-        pipeline.book = std::make_unique<OrderBook>(
-            cfg.min_price, cfg.max_price, cfg.tick_size, cfg.max_orders);
-        pipeline.pool = std::make_unique<MemoryPool<Order>>(cfg.max_orders);
-        pipeline.engine = std::make_unique<MatchingEngine>(
-            *pipeline.book, *pipeline.pool, SelfTradePreventionMode::None);
-        pipeline.gateway = std::make_unique<OrderGateway>(
-            *pipeline.engine, *pipeline.pool, event_buffer, cfg.instrument_id);
+bool InstrumentRouter::add_instrument(const InstrumentConfig& cfg) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const RoutingTable& current = routes();
+    if (current.find(cfg.instrument_id)) return false;
 
-        size_t index = pipelines_.size();
-        id_to_index_[cfg.instrument_id] = index;
-        pipelines_.push_back(std::move(pipeline));
+    // Everything is built here, off the matching thread's path
+    std::unique_ptr<InstrumentPipeline> pipeline = build_pipeline(cfg);
+    auto next = std::make_unique<RoutingTable>(current);
+    if (cfg.instrument_id >= next->by_id.size()) {
+        next->by_id.resize(static_cast<size_t>(cfg.instrument_id) + 1, nullptr);
     }
+    next->by_id[cfg.instrument_id] = pipeline.get();
+    next->active.push_back(pipeline.get());
+    pipelines_.push_back(std::move(pipeline));
+    publish(std::move(next), nullptr);
+    return true;
+}
+
+bool InstrumentRouter::retire_instrument(InstrumentId id) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const RoutingTable& current = routes();
+    InstrumentPipeline* target = current.find(id);
+    if (!target) return false;
+
+    auto next = std::make_unique<RoutingTable>(current);
+    next->by_id[id] = nullptr;
+    next->active.erase(std::find(next->active.begin(), next->active.end(), target));
+
+    auto owned = std::find_if(pipelines_.begin(), pipelines_.end(),
+                              [target](const auto& p) { return p.get() == target; });
+    std::unique_ptr<InstrumentPipeline> retired = std::move(*owned);
+    pipelines_.erase(owned);
+    publish(std::move(next), std::move(retired));
+    return true;
+}
+
+void InstrumentRouter::publish(std::unique_ptr<RoutingTable> next,
+                               std::unique_ptr<InstrumentPipeline> retired) {
+    RoutingTable* previous = table_.exchange(next.release(), std::memory_order_acq_rel);
+    const uint64_t epoch = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    retired_.push_back(Retired{epoch, std::unique_ptr<RoutingTable>(previous),
+                               std::move(retired)});
+    reclaim_locked();
+}
+
+size_t InstrumentRouter::reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    reclaim_locked();
+    return retired_.size();
+}
+
+void InstrumentRouter::reclaim_locked() {
+    const uint64_t acknowledged = quiescent_epoch_.load(std::memory_order_acquire);
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [acknowledged](const Retired& r) {
+                                      return r.epoch <= acknowledged;
+                                  }),
+                   retired_.end());
+}
+
+// ---------------------------------------------------------------------------
+// Pipeline construction
+// ---------------------------------------------------------------------------
+
+PipelineMemoryUsage InstrumentPipeline::memory_usage() const noexcept {
+    PipelineMemoryUsage usage;
+    if (book) usage.book = book->memory_usage();
+    if (pool) usage.pool = pool->memory_usage();
+    if (gateway) usage.events = gateway->memory_usage();
+    if (stops) usage.other += stops->memory_usage();
+    if (expiry) usage.other += expiry->memory_usage();
+    return usage;
 }
 
+std::unique_ptr<InstrumentPipeline> build_instrument_pipeline(
+    const InstrumentConfig& cfg, EventBuffer* event_buffer,
+    MemoryPool<Order>* shared_pool) {
+    auto owned = std::make_unique<InstrumentPipeline>();
+    InstrumentPipeline& pipeline = *owned;
+    pipeline.instrument_id = cfg.instrument_id;
+    OrderBookOptions book_options = cfg.book_options;
+    book_options.memory = cfg.memory;
+    if (cfg.digest_every > 0) book_options.state_digest = true;
+    size_t map_orders = cfg.max_orders;
+    if (cfg.pool_segment_orders > 0) {
+        // Growable pipeline: the order map starts at one segment too.
+        book_options.order_map_growable = true;
+        map_orders = std::min(cfg.pool_segment_orders, cfg.max_orders);
+    }
+    pipeline.book = std::make_unique<OrderBook>(
+        cfg.min_price, cfg.max_price, cfg.tick_size, map_orders,
+        book_options);
+    if (cfg.shared_pool && shared_pool) {
+        pipeline.pool = std::make_unique<MemoryPool<Order>>(
+            *shared_pool, cfg.max_orders);
+    } else if (cfg.pool_segment_orders > 0) {
+        PoolGrowth growth;
+        growth.segment_slots = cfg.pool_segment_orders;
+        growth.max_slots = cfg.max_orders;
+        pipeline.pool = std::make_unique<MemoryPool<Order>>(
+            std::min(cfg.pool_segment_orders, cfg.max_orders), cfg.memory,
+            growth, cfg.pool_locality);
+    } else {
+        pipeline.pool = std::make_unique<MemoryPool<Order>>(
+            cfg.max_orders, cfg.memory, PoolGrowth{}, cfg.pool_locality);
+    }
+    pipeline.engine = std::make_unique<MatchingEngine>(
+        *pipeline.book, *pipeline.pool, cfg.stp_mode,
+        cfg.matching_features);
+    if (cfg.max_stop_orders > 0) {
+        pipeline.stops = std::make_unique<StopBook>(
+            *pipeline.book, cfg.max_stop_orders, cfg.memory);
+        pipeline.engine->attach_stop_book(pipeline.stops.get());
+    }
+    if (cfg.max_timed_orders > 0) {
+        pipeline.expiry = std::make_unique<ExpiryWheel>(cfg.max_timed_orders,
+                                                        cfg.expiry_tick_ns);
+        pipeline.expiry->set_session_close(cfg.session_close);
+        pipeline.engine->attach_expiry_wheel(pipeline.expiry.get());
+    }
+    pipeline.gateway = std::make_unique<OrderGateway>(
+        *pipeline.engine, *pipeline.pool, event_buffer, cfg.instrument_id);
+    pipeline.gateway->set_backpressure(cfg.backpressure);
+    pipeline.gateway->set_digest_every(cfg.digest_every);
+    if (cfg.quote_snapshot) {
+        pipeline.quote = std::make_unique<QuoteSnapshotSlot>();
+        pipeline.gateway->set_quote_snapshot(pipeline.quote.get());
+    }
+    return owned;
+}
+
+std::unique_ptr<InstrumentPipeline> InstrumentRouter::build_pipeline(
+    const InstrumentConfig& cfg) {
+    return build_instrument_pipeline(cfg, event_buffer_, shared_pool_.get());
+}
+
+// ---------------------------------------------------------------------------
+// Routing
+// ---------------------------------------------------------------------------
+
 GatewayResult InstrumentRouter::process_order(const OrderMessage& msg) noexcept {
-    InstrumentPipeline* p = lookup(msg.instrument_id);
+    InstrumentPipeline* p = enter().find(msg.instrument_id);
     if (!p) {
         GatewayResult result{};
         result.accepted = false;
@@ -48,13 +197,72 @@ GatewayResult InstrumentRouter::process_order(const OrderMessage& msg) noexcept
 }
 
 bool InstrumentRouter::process_cancel(InstrumentId id, OrderId order_id) noexcept {
-    InstrumentPipeline* p = lookup(id);
+    InstrumentPipeline* p = enter().find(id);
     if (!p) return false;
     return p->gateway->process_cancel(order_id);
 }
 
+MassCancelResult InstrumentRouter::process_mass_cancel(
+    InstrumentId id, ParticipantId participant) noexcept {
+    InstrumentPipeline* p = enter().find(id);
+    if (!p) return {0, 0};
+    return p->gateway->process_mass_cancel(participant);
+}
+
+MassCancelResult InstrumentRouter::process_mass_cancel(
+    InstrumentId id, ParticipantId participant, Side side) noexcept {
+    InstrumentPipeline* p = enter().find(id);
+    if (!p) return {0, 0};
+    return p->gateway->process_mass_cancel(participant, side);
+}
+
+MassCancelResult InstrumentRouter::process_mass_cancel_all(
+    ParticipantId participant) noexcept {
+    MassCancelResult total{0, 0};
+    for (InstrumentPipeline* p : enter().active) {
+        MassCancelResult r = p->gateway->process_mass_cancel(participant);
+        total.cancelled_count += r.cancelled_count;
+        total.cancelled_quantity += r.cancelled_quantity;
+    }
+    return total;
+}
+
+uint32_t InstrumentRouter::process_time(Timestamp now) noexcept {
+    uint32_t expired = 0;
+    for (InstrumentPipeline* p : enter().active) {
+        expired += p->gateway->process_time(now);
+    }
+    return expired;
+}
+
+size_t InstrumentRouter::drain_overflow() noexcept {
+    size_t pending = 0;
+    for (InstrumentPipeline* p : enter().active) {
+        if (p->gateway->pending_overflow() != 0) [[unlikely]] {
+            pending += p->gateway->drain_overflow();
+        }
+    }
+    return pending;
+}
+
+size_t InstrumentRouter::release_throttled() noexcept {
+    size_t released = 0;
+    for (InstrumentPipeline* p : enter().active) {
+        released += p->gateway->release_throttled();
+    }
+    return released;
+}
+
+size_t InstrumentRouter::maintain() noexcept {
+    size_t worked = 0;
+    for (InstrumentPipeline* p : enter().active) {
+        if (p->gateway->maintain()) ++worked;
+    }
+    return worked;
+}
+
 GatewayResult InstrumentRouter::process_modify(const OrderMessage& msg) noexcept {
-    InstrumentPipeline* p = lookup(msg.instrument_id);
+    InstrumentPipeline* p = enter().find(msg.instrument_id);
     if (!p) {
         GatewayResult result{};
         result.accepted = false;
@@ -65,27 +273,103 @@ GatewayResult InstrumentRouter::process_modify(const OrderMessage& msg) noexcept
     return p->gateway->process_modify(msg);
 }
 
+void InstrumentRouter::process_batch(const OrderMessage* msgs, size_t count,
+                                     GatewayResult* results) noexcept {
+    route_batch(enter(), msgs, count, results);
+}
+
+void InstrumentRouter::route_batch(const RoutingTable& table, const OrderMessage* msgs,
+                                   size_t count, GatewayResult* results) noexcept {
+    constexpr size_t FAR = MatchingEngine::BATCH_PREFETCH_DISTANCE;
+    constexpr size_t NEAR = FAR / 2;
+
+    for (size_t i = 0; i < count && i < FAR; ++i) {
+        if (const InstrumentPipeline* p = table.find(msgs[i].instrument_id)) {
+            p->gateway->prefetch_far(msgs[i]);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i + FAR < count) {
+            if (const InstrumentPipeline* p = table.find(msgs[i + FAR].instrument_id)) {
+                p->gateway->prefetch_far(msgs[i + FAR]);
+            }
+        }
+        if (i + NEAR < count) {
+            if (const InstrumentPipeline* p = table.find(msgs[i + NEAR].instrument_id)) {
+                p->gateway->prefetch_near(msgs[i + NEAR]);
+            }
+        }
+
+        InstrumentPipeline* p = table.find(msgs[i].instrument_id);
+        if (!p) {
+            GatewayResult result{};
+            result.accepted = false;
+            result.reject_reason = (msgs[i].type == MessageType::Add)
+                                       ? GatewayRejectReason::InvalidPrice
+                                       : GatewayRejectReason::OrderNotFound;
+            result.match_status = MatchStatus::Rejected;
+            results[i] = result;
+            continue;
+        }
+        results[i] = p->gateway->process(msgs[i]);
+    }
+}
+
+size_t InstrumentRouter::drain(IngressBuffer& ingress, size_t max,
+                               bool count_outcomes) noexcept {
+    constexpr size_t CHUNK = 32;
+    OrderMessage msgs[CHUNK];
+    GatewayResult results[CHUNK];
+
+    const RoutingTable& table = enter();
+    size_t total = 0;
+    while (total < max) {
+        size_t want = (max - total < CHUNK) ? max - total : CHUNK;
+        size_t n = ingress.try_pop_n(msgs, want);
+        if (n == 0) break;
+        route_batch(table, msgs, n, results);
+        if (count_outcomes) {
+            for (size_t i = 0; i < n; ++i) {
+                if (InstrumentPipeline* p = table.find(msgs[i].instrument_id)) {
+                    p->outcomes.count(msgs[i].type, results[i]);
+                }
+            }
+        }
+        total += n;
+    }
+    return total;
+}
+
 const OrderBook* InstrumentRouter::order_book(InstrumentId id) const noexcept {
     const InstrumentPipeline* p = lookup(id);
     return p ? p->book.get() : nullptr;
 }
 
-const InstrumentPipeline* InstrumentRouter::pipeline(InstrumentId id) const noexcept {
-    return lookup(id);
+uint64_t InstrumentRouter::state_digest(InstrumentId id) const noexcept {
+    const InstrumentPipeline* p = lookup(id);
+    return p ? p->book->state_digest() : 0;
+}
+
+uint64_t InstrumentRouter::state_digest() const noexcept {
+    uint64_t digest = 0;
+    for (const InstrumentPipeline* p : routes().active) {
+        digest += BookDigest::mix(p->book->state_digest() ^ BookDigest::mix(p->instrument_id));
+    }
+    return digest;
 }
 
-InstrumentPipeline* InstrumentRouter::lookup(InstrumentId id) noexcept {
-    if (id >= id_to_index_.size()) return nullptr;
-    size_t index = id_to_index_[id];
-    if (index == INVALID_INDEX) return nullptr;
-    return &pipelines_[index];
+const InstrumentPipeline* InstrumentRouter::pipeline(InstrumentId id) const noexcept {
+    return lookup(id);
 }
 
-const InstrumentPipeline* InstrumentRouter::lookup(InstrumentId id) const noexcept {
-    if (id >= id_to_index_.size()) return nullptr;
-    size_t index = id_to_index_[id];
-    if (index == INVALID_INDEX) return nullptr;
-    return &pipelines_[index];
+RouterMemoryUsage InstrumentRouter::memory_usage() const noexcept {
+    RouterMemoryUsage usage;
+    for (const InstrumentPipeline* p : routes().active) {
+        usage.instruments += p->memory_usage().total();
+    }
+    if (shared_pool_) usage.shared_pool = shared_pool_->memory_usage();
+    return usage;
 }
 
 }  // namespace hft
@@ -7,8 +7,26 @@
 /// Each instrument gets its own OrderBook, MemoryPool, MatchingEngine, and
 /// OrderGateway. All share a single EventBuffer so downstream consumers
 /// see a unified event stream tagged with instrument_id.
+///
+/// InstrumentConfig::memory selects the backing (huge pages, NUMA node,
+/// pre-fault) of each pipeline's pool, book levels and order map. Pipelines
+/// are built in the constructor (and by add_instrument()), so construct the
+/// router on the matching thread when using MemoryBacking::NUMA_LOCAL.
+///
+/// Instruments can be listed and delisted mid-session. add_instrument()
+/// and retire_instrument() run on a control thread (or the matching
+/// thread): the pipeline is built there, then an immutable RoutingTable
+/// with it added or removed replaces the current one by an atomic pointer
+/// swap, RCU-style. The matching thread loads the table once per call, so
+/// a lookup stays one indexed load; at the start of each call it also
+/// acknowledges the latest swap, and a replaced table (and a retired
+/// pipeline) is freed by the next writer once that acknowledgement shows
+/// the matching thread has stopped using it.
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "core/order.h"
@@ -16,13 +34,86 @@
 #include "gateway/instrument_registry.h"
 #include "gateway/order_gateway.h"
 #include "matching/matching_engine.h"
+#include "orderbook/expiry_wheel.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
+#include "orderbook/stop_book.h"
 #include "transport/event_buffer.h"
+#include "transport/ingress_buffer.h"
 #include "transport/message.h"
 
 namespace hft {
 
+/// Optional order pool shared by every pipeline with
+/// InstrumentConfig::shared_pool set. Router pipelines all run on one
+/// thread, so memory then follows aggregate open interest rather than the
+/// sum of per-instrument worst cases.
+struct SharedPoolConfig {
+    size_t initial_orders = 0;   // 0 = no shared pool
+    size_t segment_orders = 0;   // Growth step (0 = fixed at initial_orders)
+    size_t max_orders = 0;       // Growth ceiling (0 = no ceiling)
+    MemoryBacking memory;
+    PoolLocality locality;
+};
+
+/// InstrumentPipeline::memory_usage(), by component.
+struct PipelineMemoryUsage {
+    BookMemoryUsage book;
+    MemoryUsage pool;     // A shared-pool view: its high-water mark only
+    MemoryUsage events;   // Gateway backpressure overflow arena
+    MemoryUsage other;    // Stop book, expiry wheel
+
+    [[nodiscard]] MemoryUsage total() const noexcept {
+        MemoryUsage sum = book.total();
+        sum += pool;
+        sum += events;
+        sum += other;
+        return sum;
+    }
+};
+
+/// GatewayResults of one instrument's messages, by outcome. Counted by
+/// InstrumentRouter::drain() when asked to (callers of process_batch see
+/// the results themselves).
+struct InstrumentOutcomes {
+    uint64_t orders_accepted = 0;
+    uint64_t orders_rejected = 0;
+    uint64_t orders_cancelled = 0;
+    uint64_t cancel_failures = 0;
+    uint64_t orders_modified = 0;
+    uint64_t modify_failures = 0;
+    uint64_t trades_generated = 0;
+
+    void count(MessageType type, const GatewayResult& result) noexcept {
+        switch (type) {
+            case MessageType::Add:
+                if (result.accepted) {
+                    ++orders_accepted;
+                    trades_generated += result.trade_count;
+                } else {
+                    ++orders_rejected;
+                }
+                break;
+            case MessageType::Cancel:
+                if (result.accepted) {
+                    ++orders_cancelled;
+                } else {
+                    ++cancel_failures;
+                }
+                break;
+            case MessageType::Modify:
+                if (result.accepted) {
+                    ++orders_modified;
+                    trades_generated += result.trade_count;
+                } else {
+                    ++modify_failures;
+                }
+                break;
+        }
+    }
+};
+
 /// A complete per-instrument processing pipeline.
 struct InstrumentPipeline {
     InstrumentId instrument_id;
@@ -30,46 +121,237 @@ struct InstrumentPipeline {
     std::unique_ptr<MemoryPool<Order>> pool;
     std::unique_ptr<MatchingEngine> engine;
     std::unique_ptr<OrderGateway> gateway;
+    std::unique_ptr<StopBook> stops;  // Only if max_stop_orders > 0
+    std::unique_ptr<ExpiryWheel> expiry;  // Only if max_timed_orders > 0
+    std::unique_ptr<QuoteSnapshotSlot> quote;  // Only if quote_snapshot
+    InstrumentOutcomes outcomes;  // drain(..., count_outcomes); matching thread
+
+    /// Memory reserved / touched by this pipeline's components. Reads
+    /// matching-thread state: call on the matching thread or while it is
+    /// idle. A few mincore() calls per component.
+    [[nodiscard]] PipelineMemoryUsage memory_usage() const noexcept;
 };
 
+/// InstrumentRouter::memory_usage().
+struct RouterMemoryUsage {
+    MemoryUsage instruments;  // Sum of the routed pipelines' totals
+    MemoryUsage shared_pool;  // Counted once, not per pipeline
+
+    [[nodiscard]] MemoryUsage total() const noexcept {
+        MemoryUsage sum = instruments;
+        sum += shared_pool;
+        return sum;
+    }
+};
+
+/// Build the pipeline `cfg` describes, as the router does for each of its
+/// instruments, but standalone (e.g. a scratch copy to clone a book into).
+/// `shared_pool` backs it if cfg.shared_pool is set and it is non-null.
+[[nodiscard]] std::unique_ptr<InstrumentPipeline> build_instrument_pipeline(
+    const InstrumentConfig& cfg, EventBuffer* event_buffer,
+    MemoryPool<Order>* shared_pool = nullptr);
+
 /// Routes inbound orders to the correct per-instrument pipeline.
 class InstrumentRouter {
 public:
     /// @param registry     Instrument definitions (must outlive this object).
     /// @param event_buffer Shared event buffer for all instruments (nullable).
+    /// @param shared       Optional shared order pool for opted-in instruments.
     InstrumentRouter(const InstrumentRegistry& registry,
-                     EventBuffer* event_buffer);
+                     EventBuffer* event_buffer,
+                     const SharedPoolConfig& shared = {});
+
+    ~InstrumentRouter();
 
     InstrumentRouter(const InstrumentRouter&) = delete;
     InstrumentRouter& operator=(const InstrumentRouter&) = delete;
 
+    /// Build a pipeline for an instrument not in the registry at
+    /// construction (e.g. a symbol listed intraday, or first seen
+    /// mid-replay) and start routing to it. Safe from any thread while the
+    /// matching thread keeps processing; existing pipelines never move.
+    /// Returns false if the id already has a pipeline.
+    bool add_instrument(const InstrumentConfig& cfg);
+
+    /// Stop routing to `id` (later messages for it are rejected as for an
+    /// unknown id). Its pipeline is freed once the matching thread has
+    /// moved past it, with any orders still resting; cancel them first to
+    /// publish their cancellation (a shared-pool pipeline's slots are only
+    /// returned when the router is destroyed). Safe from any thread.
+    /// Returns false if `id` has no pipeline.
+    bool retire_instrument(InstrumentId id);
+
+    /// Matching thread, while idle: acknowledge the latest table swap so
+    /// writers can free what it replaced (every call below does this too).
+    void quiesce() noexcept {
+        const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+        if (epoch != quiescent_epoch_.load(std::memory_order_relaxed)) [[unlikely]] {
+            quiescent_epoch_.store(epoch, std::memory_order_release);
+        }
+    }
+
+    /// Free replaced tables and retired pipelines the matching thread has
+    /// acknowledged (add / retire also do). Returns the number still held.
+    size_t reclaim();
+
     /// Submit an order to the correct instrument pipeline.
     [[nodiscard]] GatewayResult process_order(const OrderMessage& msg) noexcept;
 
     /// Cancel an order on the specified instrument.
     [[nodiscard]] bool process_cancel(InstrumentId id, OrderId order_id) noexcept;
 
+    /// Cancel every resting order of `participant` on one instrument
+    /// (optionally one side only). Unknown instruments cancel nothing.
+    MassCancelResult process_mass_cancel(InstrumentId id,
+                                         ParticipantId participant) noexcept;
+    MassCancelResult process_mass_cancel(InstrumentId id,
+                                         ParticipantId participant,
+                                         Side side) noexcept;
+
+    /// Cancel every resting order of `participant` on every instrument.
+    MassCancelResult process_mass_cancel_all(ParticipantId participant) noexcept;
+
+    /// Advance every instrument's expiry clock to `now` (instruments without
+    /// traffic are otherwise only expired by their next message). Returns
+    /// the total number of orders expired.
+    uint32_t process_time(Timestamp now) noexcept;
+
     /// Modify an order on the correct instrument pipeline.
     [[nodiscard]] GatewayResult process_modify(const OrderMessage& msg) noexcept;
 
+    /// Route msgs[0..count) (any MessageType, any instrument) strictly in
+    /// order, writing results[i] for each — see OrderGateway::process_batch.
+    /// Prefetches each upcoming message's lines in its own pipeline's book.
+    void process_batch(const OrderMessage* msgs, size_t count,
+                       GatewayResult* results) noexcept;
+
+    /// Matching-thread poll: pop up to `max` messages from `ingress` in
+    /// arrival order and route them through process_batch, a chunk at a
+    /// time. Outcomes reach consumers as events, and with count_outcomes
+    /// also each pipeline's InstrumentOutcomes. Returns the number
+    /// processed (0 if the queue is empty).
+    size_t drain(IngressBuffer& ingress, size_t max, bool count_outcomes = false) noexcept;
+
+    /// Publish events the gateways spilled under backpressure, as far as
+    /// the event ring has room. Returns the number still pending.
+    size_t drain_overflow() noexcept;
+
+    /// Process every pipeline's throttle-deferred messages whose buckets
+    /// have credit again (OrderGateway::release_throttled). Call while
+    /// idle, like drain_overflow(). Returns the number released.
+    size_t release_throttled() noexcept;
+
+    /// Idle-time upkeep of every pipeline's pool and order index
+    /// (OrderGateway::maintain). Call while idle. Returns the number of
+    /// pipelines that did any work.
+    size_t maintain() noexcept;
+
     /// Access an instrument's order book. Returns nullptr if unknown id.
     [[nodiscard]] const OrderBook* order_book(InstrumentId id) const noexcept;
 
+    /// An instrument's quote snapshot, readable from any thread until the
+    /// instrument is retired. nullptr if unknown or not configured
+    /// (InstrumentConfig::quote_snapshot).
+    [[nodiscard]] const QuoteSnapshotSlot* quote_snapshot(InstrumentId id) const noexcept {
+        const InstrumentPipeline* p = lookup(id);
+        return p ? p->quote.get() : nullptr;
+    }
+
+    /// An instrument's book state digest (OrderBook::state_digest()): equal
+    /// on two routers fed the same messages. 0 if the id is unknown or its
+    /// book keeps no digest (InstrumentConfig::digest_every or
+    /// book_options.state_digest). Matching thread, or while it is idle.
+    [[nodiscard]] uint64_t state_digest(InstrumentId id) const noexcept;
+
+    /// Every routed book's digest, each mixed with its instrument id and
+    /// summed: one value per router. Same threading rule.
+    [[nodiscard]] uint64_t state_digest() const noexcept;
+
     /// Access a full pipeline. Returns nullptr if unknown id.
     [[nodiscard]] const InstrumentPipeline* pipeline(InstrumentId id) const noexcept;
+    [[nodiscard]] InstrumentPipeline* pipeline(InstrumentId id) noexcept { return lookup(id); }
+
+    /// Pipeline `index` in [0, instrument_count()), in registration order.
+    [[nodiscard]] const InstrumentPipeline& pipeline_at(size_t index) const noexcept {
+        return *routes().active[index];
+    }
+
+    /// Shared order pool, or nullptr if none was configured.
+    [[nodiscard]] const MemoryPool<Order>* shared_pool() const noexcept {
+        return shared_pool_.get();
+    }
+
+    /// Memory of every routed pipeline plus the shared pool (per
+    /// instrument: pipeline_at(i).memory_usage()). Same threading rule as
+    /// InstrumentPipeline::memory_usage().
+    [[nodiscard]] RouterMemoryUsage memory_usage() const noexcept;
 
-    /// Number of registered instruments.
-    [[nodiscard]] size_t instrument_count() const noexcept { return pipelines_.size(); }
+    /// Number of routed instruments.
+    [[nodiscard]] size_t instrument_count() const noexcept { return routes().active.size(); }
+
+    /// Table swaps so far (each add / retire is one).
+    [[nodiscard]] uint64_t routing_epoch() const noexcept {
+        return epoch_.load(std::memory_order_acquire);
+    }
 
 private:
-    /// O(1) lookup: instrument_id -> index into pipelines_.
-    /// UINT32_MAX sentinel means "not mapped".
-    [[nodiscard]] InstrumentPipeline* lookup(InstrumentId id) noexcept;
-    [[nodiscard]] const InstrumentPipeline* lookup(InstrumentId id) const noexcept;
-
-    std::vector<InstrumentPipeline> pipelines_;
-    std::vector<size_t> id_to_index_;  // flat array, size = max_id + 1
-    static constexpr size_t INVALID_INDEX = SIZE_MAX;
+    /// Immutable once published. by_id is the flat id -> pipeline array
+    /// (nullptr = not routed); active lists the routed pipelines in
+    /// registration order.
+    struct RoutingTable {
+        std::vector<InstrumentPipeline*> by_id;
+        std::vector<InstrumentPipeline*> active;
+
+        [[nodiscard]] InstrumentPipeline* find(InstrumentId id) const noexcept {
+            return id < by_id.size() ? by_id[id] : nullptr;
+        }
+    };
+
+    /// A replaced table, or a retired pipeline, waiting for the matching
+    /// thread to acknowledge `epoch`.
+    struct Retired {
+        uint64_t epoch;
+        std::unique_ptr<RoutingTable> table;
+        std::unique_ptr<InstrumentPipeline> pipeline;
+    };
+
+    [[nodiscard]] const RoutingTable& routes() const noexcept {
+        return *table_.load(std::memory_order_acquire);
+    }
+    /// Matching-thread entry: acknowledge the latest swap, then load the table.
+    [[nodiscard]] const RoutingTable& enter() noexcept {
+        quiesce();
+        return routes();
+    }
+
+    [[nodiscard]] InstrumentPipeline* lookup(InstrumentId id) noexcept {
+        return routes().find(id);
+    }
+    [[nodiscard]] const InstrumentPipeline* lookup(InstrumentId id) const noexcept {
+        return routes().find(id);
+    }
+
+    void route_batch(const RoutingTable& table, const OrderMessage* msgs, size_t count,
+                     GatewayResult* results) noexcept;
+
+    std::unique_ptr<InstrumentPipeline> build_pipeline(const InstrumentConfig& cfg);
+
+    /// Publish `next` in place of the current table (writer mutex held);
+    /// the old table, and `retired` if any, are freed once acknowledged.
+    void publish(std::unique_ptr<RoutingTable> next,
+                 std::unique_ptr<InstrumentPipeline> retired);
+    void reclaim_locked();
+
+    EventBuffer* event_buffer_;
+    std::unique_ptr<MemoryPool<Order>> shared_pool_;  // Outlives the pipelines
+
+    std::atomic<RoutingTable*> table_;    // Owned; read by the matching thread
+    std::atomic<uint64_t> epoch_{0};      // Bumped after every swap
+    alignas(64) std::atomic<uint64_t> quiescent_epoch_{0};  // Matching thread's ack
+
+    alignas(64) std::mutex writer_mutex_;  // add / retire / reclaim
+    std::vector<std::unique_ptr<InstrumentPipeline>> pipelines_;  // Routed, owned
+    std::vector<Retired> retired_;
 };
 
 }  // namespace hft
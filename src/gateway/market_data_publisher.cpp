@@ -1,12 +1,27 @@
 #include "gateway/market_data_publisher.h"
 
-#include <thread>
+#include "gateway/metrics_region.h"
 
 namespace hft {
 
-MarketDataPublisher::MarketDataPublisher(EventBuffer& buffer) noexcept
-    : buffer_(buffer),
+MarketDataPublisher::MarketDataPublisher(EventBuffer& buffer,
+                                         EventBuffer::ConsumerId consumer,
+                                         const WaitConfig& wait) noexcept
+    : buffer_(&buffer),
+      packed_(nullptr),
+      consumer_(consumer),
       running_(false),
+      waiter_(wait, buffer.wakeup()),
+      events_processed_(0),
+      last_sequence_num_(0) {}
+
+MarketDataPublisher::MarketDataPublisher(PackedEventBuffer& buffer,
+                                         const WaitConfig& wait) noexcept
+    : buffer_(nullptr),
+      packed_(&buffer),
+      consumer_(EventBuffer::PRIMARY),
+      running_(false),
+      waiter_(wait, buffer.wakeup()),
       events_processed_(0),
       last_sequence_num_(0) {}
 
@@ -16,27 +31,66 @@ void MarketDataPublisher::register_callback(
 }
 
 size_t MarketDataPublisher::poll() noexcept {
+    if (packed_) return poll_packed();
+
     size_t count = 0;
-    EventMessage event{};
 
-    while (buffer_.try_pop(event)) {
-        for (auto& cb : callbacks_) {
-            cb(event);
+    if (!buffer_->is_gating(consumer_)) {
+        // The producer does not wait for this cursor: copy each event out
+        // so a slot reused mid-callback cannot change under it
+        EventMessage event{};
+        while (buffer_->try_pop(consumer_, event)) {
+            dispatch(event);
+            last_sequence_num_ = event.sequence_num;
+            ++events_processed_;
+            ++count;
         }
-        last_sequence_num_ = event.sequence_num;
+        finish_poll(count);
+        return count;
+    }
+
+    // Callbacks read each event in place; the slot is freed afterwards
+    while (const EventMessage* event = buffer_->peek(consumer_)) {
+        dispatch(*event);
+        last_sequence_num_ = event->sequence_num;
+        buffer_->release(consumer_);
         ++events_processed_;
         ++count;
     }
 
+    finish_poll(count);
     return count;
 }
 
+size_t MarketDataPublisher::poll_packed() noexcept {
+    size_t count = 0;
+    EventMessage event{};
+    while (packed_->try_pop(event)) {
+        dispatch(event);
+        last_sequence_num_ = event.sequence_num;
+        ++events_processed_;
+        ++count;
+    }
+    finish_poll(count);
+    return count;
+}
+
+void MarketDataPublisher::publish_metrics() noexcept {
+    metrics_->events_processed.set(events_processed_);
+    metrics_->last_sequence.set(static_cast<int64_t>(last_sequence_num_));
+}
+
 void MarketDataPublisher::run() {
     running_.store(true, std::memory_order_release);
 
+    auto ready = [this] {
+        return has_events() || !running_.load(std::memory_order_acquire);
+    };
     while (running_.load(std::memory_order_acquire)) {
         if (poll() == 0) {
-            std::this_thread::yield();
+            waiter_.idle(ready);
+        } else {
+            waiter_.reset();
         }
     }
 
@@ -46,6 +100,10 @@ void MarketDataPublisher::run() {
 
 void MarketDataPublisher::stop() noexcept {
     running_.store(false, std::memory_order_release);
+    WakeupSignal* signal = packed_ ? packed_->wakeup() : buffer_->wakeup();
+    if (signal) {
+        signal->notify();
+    }
 }
 
 }  // namespace hft
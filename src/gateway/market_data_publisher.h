@@ -1,27 +1,66 @@
 #pragma once
 
 /// @file market_data_publisher.h
-/// @brief Consumes EventMessages from the SPSC buffer and dispatches to
+/// @brief Consumes EventMessages from the event buffer and dispatches to
 ///        registered callbacks on a dedicated (cold-path) thread.
 ///
 /// Cold-path component. Uses std::function and std::vector for callback
 /// registration (called once at startup). The run() loop is designed for
 /// a dedicated consumer thread.
+///
+/// Each publisher reads through one EventBuffer cursor. Give independent
+/// consumers (analytics, journal, risk) their own publisher and cursor
+/// (EventBuffer::add_consumer) on their own thread rather than chaining
+/// their callbacks on one.
+///
+/// run() waits between empty polls according to its WaitConfig: spin,
+/// pause, yield (default), back off, or block until the producer publishes
+/// (WaitStrategy::Block, with a WakeupSignal attached to the buffer before
+/// the publisher is constructed).
+///
+/// A publisher built on a PackedEventBuffer decodes each compact record
+/// into a local EventMessage and passes that to the callbacks.
+///
+/// Slow consumers subscribe through a ConflatedMarketState instead of a
+/// callback (set_conflated_state): every event is folded into it ahead of
+/// the callbacks and the instruments it changed are published at the end
+/// of each poll(), so those readers get fresh state at their own pace.
+///
+/// set_metrics() publishes the event count and last sequence number into
+/// a shared-memory MetricsRegion (see metrics_region.h) after each poll()
+/// that dispatched events.
 
 #include <atomic>
 #include <cstdint>
 #include <functional>
 #include <vector>
 
+#include "gateway/conflated_market_state.h"
 #include "transport/event_buffer.h"
 #include "transport/message.h"
+#include "transport/packed_event_buffer.h"
+#include "transport/wait_strategy.h"
+#include "utils/trace.h"
 
 namespace hft {
 
+struct PublisherMetrics;
+
 class MarketDataPublisher {
 public:
-    /// @param buffer SPSC ring buffer to consume events from.
-    explicit MarketDataPublisher(EventBuffer& buffer) noexcept;
+    /// @param buffer   Event buffer to consume events from.
+    /// @param consumer Cursor to read through (default: the PRIMARY one).
+    /// @param wait     How run() waits when the buffer is empty.
+    explicit MarketDataPublisher(
+        EventBuffer& buffer,
+        EventBuffer::ConsumerId consumer = EventBuffer::PRIMARY,
+        const WaitConfig& wait = {}) noexcept;
+
+    /// @param buffer Packed event buffer to decode events from (its only
+    ///               consumer).
+    /// @param wait   How run() waits when the buffer is empty.
+    explicit MarketDataPublisher(PackedEventBuffer& buffer,
+                                 const WaitConfig& wait = {}) noexcept;
 
     MarketDataPublisher(const MarketDataPublisher&) = delete;
     MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
@@ -30,24 +69,80 @@ public:
     /// before run(). Not thread-safe with poll()/run().
     void register_callback(std::function<void(const EventMessage&)> callback);
 
+    /// Keep `state` current for conflated subscribers (nullptr detaches).
+    /// Cold-path — call before run(). Not thread-safe with poll()/run().
+    void set_conflated_state(ConflatedMarketState* state) noexcept { conflated_ = state; }
+
+    /// Publish counters into `metrics` (nullptr detaches). Cold-path —
+    /// call before run(). Not thread-safe with poll()/run().
+    void set_metrics(PublisherMetrics* metrics) noexcept { metrics_ = metrics; }
+
     /// Non-blocking drain of all available events. Returns count processed.
-    /// Invokes all registered callbacks for each event.
+    /// Invokes all registered callbacks for each event, passing the event
+    /// in place in the buffer (or decoded, for a packed buffer): the
+    /// reference is valid only for the call.
     [[nodiscard]] size_t poll() noexcept;
 
-    /// Blocking event loop — calls poll() in a loop, yields when empty.
-    /// Returns after stop() is called and remaining events are drained.
+    /// Blocking event loop — calls poll() in a loop, waiting per the
+    /// WaitConfig when empty. Returns after stop() is called and remaining
+    /// events are drained.
     void run();
 
-    /// Thread-safe signal to exit the run() loop.
+    /// Thread-safe signal to exit the run() loop. Wakes a blocked run().
     void stop() noexcept;
 
+    /// run()'s idle counters (approximate while it runs).
+    [[nodiscard]] const WaitStats& wait_stats() const noexcept { return waiter_.stats(); }
+
     [[nodiscard]] uint64_t events_processed() const noexcept { return events_processed_; }
     [[nodiscard]] uint64_t last_sequence_num() const noexcept { return last_sequence_num_; }
 
 private:
-    EventBuffer& buffer_;
+    [[nodiscard]] size_t poll_packed() noexcept;
+    /// End of a poll() that dispatched `count` events.
+    void finish_poll(size_t count) noexcept {
+        if (count == 0) return;
+        if (conflated_) (void)conflated_->publish();
+        if (metrics_) [[unlikely]] publish_metrics();
+    }
+    void publish_metrics() noexcept;
+    void dispatch(const EventMessage& event) {
+        HFT_TRACE_BEGIN(t_dispatch, trace_key(event));
+        if (conflated_) conflated_->apply(event);
+        for (auto& cb : callbacks_) {
+            cb(event);
+        }
+        HFT_TRACE_END_EVENTS(TraceStage::PublisherDispatch, trace_key(event), t_dispatch,
+                             event.sequence_num, 1);
+    }
+    /// The order an event belongs to, for tracepoints: a trade's aggressor.
+    [[nodiscard]] static uint64_t trace_key(const EventMessage& event) noexcept {
+        switch (event.type) {
+            case EventType::Trade:
+            {
+                const Trade trade = event_trade(event);
+                return trade.has_aggressor() ? trade.aggressor_order_id() : TRACE_NO_KEY;
+            }
+            case EventType::MassCancel:
+            case EventType::LevelUpdate:
+            case EventType::BookDigest:
+                return TRACE_NO_KEY;
+            default:
+                return event.data.order_event.order_id;
+        }
+    }
+    [[nodiscard]] bool has_events() const noexcept {
+        return packed_ ? !packed_->empty() : buffer_->size(consumer_) != 0;
+    }
+
+    EventBuffer* buffer_;          // Exactly one of buffer_ / packed_ is set
+    PackedEventBuffer* packed_;
+    EventBuffer::ConsumerId consumer_;
     std::vector<std::function<void(const EventMessage&)>> callbacks_;
+    ConflatedMarketState* conflated_ = nullptr;
+    PublisherMetrics* metrics_ = nullptr;
     std::atomic<bool> running_;
+    Waiter waiter_;
     uint64_t events_processed_;
     uint64_t last_sequence_num_;
 };
@@ -0,0 +1,81 @@
+#include "gateway/message_throttle.h"
+
+#include "utils/clock.h"
+
+namespace hft {
+
+MessageThrottle::MessageThrottle(const ThrottleConfig& config)
+    : ticks_per_ns_(config.tsc_ticks_per_ns > 0.0 ? config.tsc_ticks_per_ns
+                                                  : calibrate_tsc_frequency()),
+      action_(config.action),
+      participant_count_(config.max_participants),
+      instrument_count_(config.max_instruments),
+      participants_(std::make_unique<Bucket[]>(config.max_participants + 1)),
+      instruments_(std::make_unique<Bucket[]>(config.max_instruments + 1)),
+      queue_(config.action == ThrottleAction::Queue ? config.queue_capacity : 0) {
+    for (size_t i = 0; i <= participant_count_; ++i) {
+        configure(participants_[i], config.participant);
+    }
+    for (size_t i = 0; i <= instrument_count_; ++i) {
+        configure(instruments_[i], config.instrument);
+    }
+}
+
+void MessageThrottle::configure(Bucket& bucket, const ThrottleLimits& limits) const noexcept {
+    if (limits.messages_per_second == 0) {
+        bucket.cost = 0;
+        bucket.capacity = 0;
+    } else {
+        bucket.cost = static_cast<uint64_t>(1e9 * ticks_per_ns_ / limits.messages_per_second);
+        if (bucket.cost == 0) bucket.cost = 1;
+        bucket.capacity = bucket.cost * (limits.burst ? limits.burst : 1);
+    }
+    bucket.credit = bucket.capacity;  // Start with a full burst
+}
+
+bool MessageThrottle::set_participant_limits(ParticipantId participant,
+                                             const ThrottleLimits& limits) noexcept {
+    if (participant >= participant_count_) return false;
+    configure(participants_[participant], limits);
+    return true;
+}
+
+bool MessageThrottle::set_instrument_limits(InstrumentId instrument,
+                                            const ThrottleLimits& limits) noexcept {
+    if (instrument >= instrument_count_) return false;
+    configure(instruments_[instrument], limits);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Deferred queue
+// ---------------------------------------------------------------------------
+
+bool MessageThrottle::defer(const OrderMessage& msg) noexcept {
+    if (queued_ == queue_.size()) {
+        ++queue_full_;
+        return false;
+    }
+    queue_[(head_ + queued_) % queue_.size()] = msg;
+    ++queued_;
+    ++bucket(msg.order.participant_id).queued;
+    ++deferred_total_;
+    return true;
+}
+
+bool MessageThrottle::withdraw(OrderId order_id) noexcept {
+    for (size_t n = 0; n < queued_; ++n) {
+        const OrderMessage& msg = queue_[(head_ + n) % queue_.size()];
+        if (msg.type != MessageType::Add || msg.order.order_id != order_id) continue;
+        --bucket(msg.order.participant_id).queued;
+        for (size_t m = n + 1; m < queued_; ++m) {
+            queue_[(head_ + m - 1) % queue_.size()] = queue_[(head_ + m) % queue_.size()];
+        }
+        --queued_;
+        ++withdrawn_;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace hft
@@ -0,0 +1,203 @@
+#pragma once
+
+/// @file message_throttle.h
+/// @brief Per-participant and per-instrument token-bucket message-rate
+///        limits checked by the OrderGateway on every add and modify.
+///
+/// Zero heap allocation after construction. Each participant and each
+/// instrument has one cache-line Bucket in a flat array. Credit is kept in
+/// TSC ticks: a message costs 1 / messages_per_second worth of ticks, the
+/// bucket holds at most `burst` messages' worth and refills with elapsed
+/// ticks, so admit() is a subtract, a min and a compare per bucket with no
+/// division or clock conversion on the path. A message is admitted only if
+/// both its participant's and its instrument's bucket have credit, and
+/// then draws from both. Ids beyond the configured counts share one
+/// overflow bucket each.
+///
+/// Over-limit messages are either rejected (ThrottleAction::Reject,
+/// GatewayRejectReason::Throttled) or deferred into a bounded FIFO
+/// (ThrottleAction::Queue) that the gateway releases as credit returns.
+/// A participant with deferred messages queues every new one behind them,
+/// so its messages stay in order; other participants are not held up.
+/// A full queue rejects.
+///
+/// Cancels are never throttled, so a throttled participant can always pull
+/// its orders; a cancel of a deferred add withdraws it from the queue.
+///
+/// Not thread-safe: one MessageThrottle per matching thread (it may serve
+/// several gateways on that thread). Attach with OrderGateway::set_throttle().
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/types.h"
+#include "transport/message.h"
+
+namespace hft {
+
+struct ThrottleLimits {
+    uint32_t messages_per_second = 0;  // Sustained rate (0 = unlimited)
+    uint32_t burst = 0;                // Bucket depth in messages (0 = 1)
+};
+
+/// What happens to a message that finds its bucket empty.
+enum class ThrottleAction : uint8_t {
+    Reject,  // GatewayRejectReason::Throttled, OrderRejected published
+    Queue    // Deferred and processed once credit returns
+};
+
+struct ThrottleConfig {
+    ThrottleLimits participant;      // Every participant's until overridden
+    ThrottleLimits instrument;       // Every instrument's until overridden
+    ThrottleAction action = ThrottleAction::Reject;
+    size_t max_participants = 1024;
+    size_t max_instruments = 256;
+    size_t queue_capacity = 4096;    // Deferred messages (Queue only)
+    double tsc_ticks_per_ns = 0.0;   // 0 = calibrate at construction
+};
+
+class MessageThrottle {
+public:
+    explicit MessageThrottle(const ThrottleConfig& config);
+
+    MessageThrottle(const MessageThrottle&) = delete;
+    MessageThrottle& operator=(const MessageThrottle&) = delete;
+
+    /// Override one participant's / instrument's limits (refills its
+    /// bucket). Returns false if out of range.
+    bool set_participant_limits(ParticipantId participant, const ThrottleLimits& limits) noexcept;
+    bool set_instrument_limits(InstrumentId instrument, const ThrottleLimits& limits) noexcept;
+
+    /// Admit one message at TSC time `now`: draws one message of credit
+    /// from both buckets, or from neither and returns false.
+    [[nodiscard]] bool admit(ParticipantId participant, InstrumentId instrument,
+                             uint64_t now) noexcept {
+        Bucket& p = participants_[participant < participant_count_ ? participant
+                                                                   : participant_count_];
+        Bucket& i = instruments_[instrument < instrument_count_ ? instrument
+                                                                : instrument_count_];
+        const bool participant_ok = p.refill(now);
+        const bool instrument_ok = i.refill(now);  // Both refill either way
+        if (!(participant_ok && instrument_ok)) [[unlikely]] {
+            ++p.throttled;
+            ++throttled_;
+            return false;
+        }
+        p.credit -= p.cost;
+        i.credit -= i.cost;
+        ++admitted_;
+        return true;
+    }
+
+    // --- Deferred queue (ThrottleAction::Queue) ---
+
+    [[nodiscard]] bool queues() const noexcept { return action_ == ThrottleAction::Queue; }
+
+    /// Append `msg` behind everything deferred. Returns false if full.
+    bool defer(const OrderMessage& msg) noexcept;
+
+    /// Whether `participant` has deferred messages (new ones must queue).
+    [[nodiscard]] bool has_deferred(ParticipantId participant) const noexcept {
+        return bucket(participant).queued != 0;
+    }
+
+    /// Remove the deferred add of `order_id`. Returns false if none.
+    bool withdraw(OrderId order_id) noexcept;
+
+    /// Pass every deferred message whose buckets now have credit to
+    /// `fn(const OrderMessage&)`, oldest first. Once one of a participant's
+    /// messages stays deferred, its later ones do too. Returns the number
+    /// released.
+    template <typename Fn>
+    size_t release(uint64_t now, Fn&& fn) {
+        ++pass_;
+        const size_t count = queued_;
+        size_t kept = 0;
+        for (size_t n = 0; n < count; ++n) {
+            const OrderMessage msg = queue_[(head_ + n) % queue_.size()];
+            Bucket& p = bucket(msg.order.participant_id);
+            if (p.blocked_pass != pass_ &&
+                admit(msg.order.participant_id, msg.instrument_id, now)) {
+                --p.queued;
+                ++released_;
+                fn(msg);
+            } else {
+                p.blocked_pass = pass_;
+                queue_[(head_ + kept++) % queue_.size()] = msg;
+            }
+        }
+        queued_ = kept;
+        return count - kept;
+    }
+
+    [[nodiscard]] size_t deferred() const noexcept { return queued_; }
+
+    // --- Introspection ---
+
+    [[nodiscard]] uint64_t admitted() const noexcept { return admitted_; }
+    /// admit() calls that found a bucket empty (each deferral retry counts).
+    [[nodiscard]] uint64_t throttled() const noexcept { return throttled_; }
+    [[nodiscard]] uint64_t throttled(ParticipantId participant) const noexcept {
+        return bucket(participant).throttled;
+    }
+    [[nodiscard]] uint64_t deferred_total() const noexcept { return deferred_total_; }
+    [[nodiscard]] uint64_t released() const noexcept { return released_; }
+    [[nodiscard]] uint64_t withdrawn() const noexcept { return withdrawn_; }
+    [[nodiscard]] uint64_t queue_full() const noexcept { return queue_full_; }
+    [[nodiscard]] double tsc_ticks_per_ns() const noexcept { return ticks_per_ns_; }
+
+private:
+    struct alignas(64) Bucket {
+        uint64_t credit = 0;    // TSC ticks of credit
+        uint64_t capacity = 0;  // burst x cost
+        uint64_t cost = 0;      // Ticks per message (0 = unlimited)
+        uint64_t last = 0;      // TSC of the last refill
+        uint64_t throttled = 0;
+        uint64_t blocked_pass = 0;  // release() pass that kept one deferred
+        uint32_t queued = 0;        // Deferred messages (participants)
+
+        /// Top up from the ticks elapsed since the last call; true if one
+        /// message of credit is available.
+        bool refill(uint64_t now) noexcept {
+            if (now > last) {
+                const uint64_t room = capacity - credit;
+                credit += (now - last < room) ? now - last : room;
+                last = now;
+            }
+            return credit >= cost;
+        }
+    };
+    static_assert(sizeof(Bucket) == 64, "One cache line per bucket");
+
+    void configure(Bucket& bucket, const ThrottleLimits& limits) const noexcept;
+
+    [[nodiscard]] Bucket& bucket(ParticipantId participant) noexcept {
+        return participants_[participant < participant_count_ ? participant : participant_count_];
+    }
+    [[nodiscard]] const Bucket& bucket(ParticipantId participant) const noexcept {
+        return participants_[participant < participant_count_ ? participant : participant_count_];
+    }
+
+    double ticks_per_ns_;
+    ThrottleAction action_;
+    size_t participant_count_;
+    size_t instrument_count_;
+    std::unique_ptr<Bucket[]> participants_;  // + one shared overflow bucket
+    std::unique_ptr<Bucket[]> instruments_;   // + one shared overflow bucket
+
+    std::vector<OrderMessage> queue_;  // Ring of deferred messages
+    size_t head_ = 0;
+    size_t queued_ = 0;
+    uint64_t pass_ = 0;
+
+    uint64_t admitted_ = 0;
+    uint64_t throttled_ = 0;
+    uint64_t deferred_total_ = 0;
+    uint64_t released_ = 0;
+    uint64_t withdrawn_ = 0;
+    uint64_t queue_full_ = 0;
+};
+
+}  // namespace hft
@@ -0,0 +1,198 @@
+#include "gateway/metrics_region.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define HFT_METRICS_SHM 1
+#endif
+
+namespace hft {
+
+namespace {
+
+constexpr size_t align_up(size_t n, size_t to) noexcept {
+    return (n + to - 1) / to * to;
+}
+
+}  // namespace
+
+MetricsRegion::~MetricsRegion() {
+    close();
+}
+
+bool MetricsRegion::open(const std::string& name, const Layout& layout) {
+    close();
+    error_.clear();
+
+    const size_t slots_bytes = sizeof(MetricSlot) * layout.slots;
+    const size_t stride = align_up(sizeof(HdrHistogram::Storage), 64);
+    const size_t histogram_offset = sizeof(MetricsHeader) + slots_bytes;
+    const size_t size = histogram_offset + stride * layout.histograms;
+
+    if (name.empty()) {
+        base_ = std::aligned_alloc(64, align_up(size, 64));
+        if (base_ == nullptr) {
+            error_ = "cannot allocate metrics region";
+            return false;
+        }
+        std::memset(base_, 0, size);
+    } else {
+#if defined(HFT_METRICS_SHM)
+        const std::string path = name.front() == '/' ? name : "/" + name;
+        ::shm_unlink(path.c_str());   // A stale region from an earlier run
+        const int fd = ::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            error_ = "shm_open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            error_ = "ftruncate " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            ::shm_unlink(path.c_str());
+            return false;
+        }
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            error_ = "mmap " + path + ": " + std::strerror(errno);
+            ::shm_unlink(path.c_str());
+            return false;
+        }
+        base_ = map;   // Zero-filled by ftruncate
+        shared_ = true;
+        name_ = path;
+#else
+        error_ = "shared-memory metrics are not supported on this platform";
+        return false;
+#endif
+    }
+    size_ = size;
+
+    header_ = new (base_) MetricsHeader{};
+    slots_ = reinterpret_cast<MetricSlot*>(static_cast<char*>(base_) + sizeof(MetricsHeader));
+    header_->version = METRICS_VERSION;
+    header_->slot_capacity = layout.slots;
+    header_->histogram_capacity = layout.histograms;
+    header_->histogram_buckets = static_cast<uint32_t>(HdrHistogram::BUCKET_COUNT);
+    header_->sub_bucket_bits = HdrHistogram::SUB_BUCKET_BITS;
+#if defined(HFT_METRICS_SHM)
+    header_->pid = static_cast<uint32_t>(::getpid());
+#endif
+    header_->histogram_offset = histogram_offset;
+    header_->histogram_stride = stride;
+    // Magic last: a reader that sees it sees an initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, METRICS_MAGIC, sizeof(header_->magic));
+    return true;
+}
+
+void MetricsRegion::close() {
+    histograms_.clear();
+    if (base_ != nullptr) {
+#if defined(HFT_METRICS_SHM)
+        if (shared_) {
+            ::munmap(base_, size_);
+            ::shm_unlink(name_.c_str());
+        } else {
+            std::free(base_);
+        }
+#else
+        std::free(base_);
+#endif
+    }
+    base_ = nullptr;
+    size_ = 0;
+    shared_ = false;
+    header_ = nullptr;
+    slots_ = nullptr;
+    name_.clear();
+}
+
+MetricSlot* MetricsRegion::add_slot(const std::string& name, MetricKind kind, uint32_t thread,
+                                    uint64_t value) {
+    const uint32_t index = header_->slot_count.load(std::memory_order_relaxed);
+    if (index >= header_->slot_capacity) return nullptr;
+    MetricSlot& slot = slots_[index];
+    const size_t length = std::min(name.size(), METRIC_NAME_SIZE - 1);
+    std::memcpy(slot.name, name.data(), length);
+    slot.name[length] = '\0';
+    slot.kind = kind;
+    slot.thread = thread;
+    slot.value.store(value, std::memory_order_relaxed);
+    header_->slot_count.store(index + 1, std::memory_order_release);
+    return &slot;
+}
+
+MetricCounter MetricsRegion::add_counter(const std::string& name, uint32_t thread) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open()) return {};
+    MetricSlot* slot = add_slot(name, MetricKind::Counter, thread, 0);
+    return slot ? MetricCounter(&slot->value) : MetricCounter();
+}
+
+MetricGauge MetricsRegion::add_gauge(const std::string& name, uint32_t thread) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open()) return {};
+    MetricSlot* slot = add_slot(name, MetricKind::Gauge, thread, 0);
+    return slot ? MetricGauge(&slot->value) : MetricGauge();
+}
+
+HdrHistogram* MetricsRegion::add_histogram(const std::string& name, uint32_t thread) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open()) return nullptr;
+    const uint32_t index = header_->histogram_count.load(std::memory_order_relaxed);
+    if (index >= header_->histogram_capacity ||
+        header_->slot_count.load(std::memory_order_relaxed) >= header_->slot_capacity) {
+        return nullptr;
+    }
+    auto* storage = new (static_cast<char*>(base_) + header_->histogram_offset +
+                         header_->histogram_stride * index) HdrHistogram::Storage;
+    histograms_.push_back(std::make_unique<HdrHistogram>(*storage));
+    header_->histogram_count.store(index + 1, std::memory_order_release);
+    (void)add_slot(name, MetricKind::Histogram, thread, index);
+    return histograms_.back().get();
+}
+
+const MetricSlot* MetricsRegion::find(const std::string& name, uint32_t thread) const noexcept {
+    const uint32_t n = slot_count();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (slots_[i].thread == thread && name == slots_[i].name) return &slots_[i];
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Standard metric sets
+// ---------------------------------------------------------------------------
+
+void GatewayMetrics::bind(MetricsRegion& region, const std::string& prefix, uint32_t thread) {
+    orders_processed = region.add_counter(prefix + ".orders_processed", thread);
+    orders_rejected = region.add_counter(prefix + ".orders_rejected", thread);
+    events_published = region.add_counter(prefix + ".events_published", thread);
+    backpressure = region.add_counter(prefix + ".backpressure", thread);
+    events_spilled = region.add_counter(prefix + ".events_spilled", thread);
+    events_dropped = region.add_counter(prefix + ".events_dropped", thread);
+    pool_in_use = region.add_gauge(prefix + ".pool_in_use", thread);
+    pool_high_water = region.add_gauge(prefix + ".pool_high_water", thread);
+    overflow_pending = region.add_gauge(prefix + ".overflow_pending", thread);
+}
+
+void MemoryMetrics::bind(MetricsRegion& region, const std::string& prefix, uint32_t thread) {
+    reserved_bytes = region.add_gauge(prefix + ".reserved_bytes", thread);
+    touched_bytes = region.add_gauge(prefix + ".touched_bytes", thread);
+    high_water_bytes = region.add_gauge(prefix + ".high_water_bytes", thread);
+}
+
+void PublisherMetrics::bind(MetricsRegion& region, const std::string& prefix, uint32_t thread) {
+    events_processed = region.add_counter(prefix + ".events_processed", thread);
+    last_sequence = region.add_gauge(prefix + ".last_sequence", thread);
+}
+
+}  // namespace hft
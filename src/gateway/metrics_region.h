@@ -0,0 +1,226 @@
+#pragma once
+
+/// @file metrics_region.h
+/// @brief Live engine metrics in a shared-memory region, scraped by a
+///        sidecar exporter (grafana/scripts/metrics_exporter.py).
+///
+/// Cold-path setup, hot-path updates. A MetricsRegion is one POSIX shared
+/// memory object (/dev/shm/<name>) laid out as a 64-byte header, a table
+/// of 64-byte metric slots, then HdrHistogram::Storage blocks. Components
+/// register their metrics once at startup (add_counter / add_gauge /
+/// add_histogram, mutex-guarded) and get back handles that update the
+/// mapped memory directly: a relaxed atomic store for counters and gauges,
+/// HdrHistogram::record() for histograms. No syscall, lock or locked
+/// instruction on the update path.
+///
+/// Each slot is written by one thread (the `thread` label it was
+/// registered with) and sits on its own cache line, so writers on
+/// different threads never share a line. Readers in any process see each
+/// value whole (aligned 64-bit stores) but not a consistent snapshot
+/// across slots; the exporter samples them about once a second.
+///
+/// With an empty name the region lives on the heap (tests, or metrics
+/// read only in-process). The creator unlinks the object on close().
+///
+/// OrderGateway::set_metrics() and MarketDataPublisher::set_metrics() bind
+/// the standard sets (GatewayMetrics, PublisherMetrics below) and refresh
+/// them at the end of each call / batch / poll.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "orderbook/backing_memory.h"
+#include "utils/hdr_histogram.h"
+
+namespace hft {
+
+inline constexpr char METRICS_MAGIC[8] = {'H', 'F', 'T', 'M', 'E', 'T', 'R', '1'};
+inline constexpr uint32_t METRICS_VERSION = 1;
+inline constexpr size_t METRIC_NAME_SIZE = 40;   // Including the terminating NUL
+
+enum class MetricKind : uint32_t {
+    Counter = 1,     // Monotonic total
+    Gauge = 2,       // Current value (signed, stored as its two's complement bits)
+    Histogram = 3    // `value` = index of its HdrHistogram::Storage block
+};
+
+/// Region header. Counts are published with release after a slot is
+/// filled, so a reader that loads them with acquire sees whole slots.
+struct MetricsHeader {
+    char magic[8];                           // METRICS_MAGIC
+    uint32_t version;                        // METRICS_VERSION
+    uint32_t slot_capacity;
+    uint32_t histogram_capacity;
+    uint32_t histogram_buckets;              // HdrHistogram::BUCKET_COUNT
+    uint32_t sub_bucket_bits;                // HdrHistogram::SUB_BUCKET_BITS
+    uint32_t pid;                            // Creating process
+    std::atomic<uint32_t> slot_count;
+    std::atomic<uint32_t> histogram_count;
+    uint64_t histogram_offset;               // Byte offset of histogram block 0
+    uint64_t histogram_stride;               // Bytes between histogram blocks
+    uint64_t reserved;
+};
+
+static_assert(sizeof(MetricsHeader) == 64, "MetricsHeader must be 64 bytes");
+
+/// One metric, one cache line.
+struct alignas(64) MetricSlot {
+    char name[METRIC_NAME_SIZE];
+    MetricKind kind;
+    uint32_t thread;                         // Writer label (exported as a tag)
+    std::atomic<uint64_t> value;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(MetricSlot) == 64, "MetricSlot must be one cache line");
+
+/// Single-writer monotonic counter. Default-constructed handles are
+/// unbound and ignore updates.
+class MetricCounter {
+public:
+    MetricCounter() = default;
+    explicit MetricCounter(std::atomic<uint64_t>* value) noexcept : value_(value) {}
+
+    void add(uint64_t n = 1) noexcept {
+        if (value_) value_->store(value_->load(std::memory_order_relaxed) + n,
+                                  std::memory_order_relaxed);
+    }
+    /// Publish an absolute total kept elsewhere.
+    void set(uint64_t total) noexcept {
+        if (value_) value_->store(total, std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t value() const noexcept {
+        return value_ ? value_->load(std::memory_order_relaxed) : 0;
+    }
+    [[nodiscard]] bool bound() const noexcept { return value_ != nullptr; }
+
+private:
+    std::atomic<uint64_t>* value_ = nullptr;
+};
+
+/// Single-writer signed gauge.
+class MetricGauge {
+public:
+    MetricGauge() = default;
+    explicit MetricGauge(std::atomic<uint64_t>* value) noexcept : value_(value) {}
+
+    void set(int64_t v) noexcept {
+        if (value_) value_->store(static_cast<uint64_t>(v), std::memory_order_relaxed);
+    }
+    [[nodiscard]] int64_t value() const noexcept {
+        return value_ ? static_cast<int64_t>(value_->load(std::memory_order_relaxed)) : 0;
+    }
+    [[nodiscard]] bool bound() const noexcept { return value_ != nullptr; }
+
+private:
+    std::atomic<uint64_t>* value_ = nullptr;
+};
+
+/// Creates and owns the mapped region and the registered histograms.
+class MetricsRegion {
+public:
+    struct Layout {
+        uint32_t slots = 256;
+        uint32_t histograms = 8;             // ~144 KB each
+    };
+
+    MetricsRegion() = default;
+    ~MetricsRegion();
+
+    MetricsRegion(const MetricsRegion&) = delete;
+    MetricsRegion& operator=(const MetricsRegion&) = delete;
+
+    /// Create /dev/shm/<name> (replacing a stale one), or a heap region
+    /// when `name` is empty. False (see error()) if it cannot be created.
+    [[nodiscard]] bool open(const std::string& name, const Layout& layout);
+    [[nodiscard]] bool open(const std::string& name) { return open(name, Layout{}); }
+    /// Unmap, and unlink the shared-memory object.
+    void close();
+
+    [[nodiscard]] bool is_open() const noexcept { return header_ != nullptr; }
+    [[nodiscard]] const std::string& name() const noexcept { return name_; }
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+    [[nodiscard]] size_t size_bytes() const noexcept { return size_; }
+
+    /// Register a metric written by thread `thread`. Names longer than
+    /// METRIC_NAME_SIZE - 1 are truncated. Returns an unbound handle (or
+    /// nullptr) when the region is closed or full.
+    [[nodiscard]] MetricCounter add_counter(const std::string& name, uint32_t thread = 0);
+    [[nodiscard]] MetricGauge add_gauge(const std::string& name, uint32_t thread = 0);
+    /// Histogram in the region's storage, valid until close().
+    [[nodiscard]] HdrHistogram* add_histogram(const std::string& name, uint32_t thread = 0);
+
+    [[nodiscard]] uint32_t slot_count() const noexcept {
+        return header_ ? header_->slot_count.load(std::memory_order_acquire) : 0;
+    }
+    [[nodiscard]] const MetricSlot& slot(uint32_t i) const noexcept { return slots_[i]; }
+    /// Slot of `name` / `thread`, or nullptr.
+    [[nodiscard]] const MetricSlot* find(const std::string& name,
+                                         uint32_t thread = 0) const noexcept;
+
+private:
+    [[nodiscard]] MetricSlot* add_slot(const std::string& name, MetricKind kind, uint32_t thread,
+                                       uint64_t value);
+
+    std::string name_;       // Empty for a heap region
+    std::string error_;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    bool shared_ = false;
+    MetricsHeader* header_ = nullptr;
+    MetricSlot* slots_ = nullptr;
+    std::vector<std::unique_ptr<HdrHistogram>> histograms_;
+    std::mutex mutex_;       // Registration only
+};
+
+// ---------------------------------------------------------------------------
+// Standard metric sets
+// ---------------------------------------------------------------------------
+
+/// OrderGateway counters, refreshed at the end of every call or batch.
+struct GatewayMetrics {
+    MetricCounter orders_processed;
+    MetricCounter orders_rejected;
+    MetricCounter events_published;          // Event sequence number
+    MetricCounter backpressure;
+    MetricCounter events_spilled;
+    MetricCounter events_dropped;
+    MetricGauge pool_in_use;
+    MetricGauge pool_high_water;
+    MetricGauge overflow_pending;
+
+    /// Register the set as "<prefix>.orders_processed" etc.
+    void bind(MetricsRegion& region, const std::string& prefix = "gateway", uint32_t thread = 0);
+};
+
+/// One component's MemoryUsage as gauges. memory_usage() takes syscalls,
+/// so the owner refreshes these at startup and every so often, not per call.
+struct MemoryMetrics {
+    MetricGauge reserved_bytes;
+    MetricGauge touched_bytes;
+    MetricGauge high_water_bytes;
+
+    /// Register the set as "<prefix>.reserved_bytes" etc.
+    void bind(MetricsRegion& region, const std::string& prefix = "memory", uint32_t thread = 0);
+    void publish(const MemoryUsage& usage) noexcept {
+        reserved_bytes.set(static_cast<int64_t>(usage.reserved_bytes));
+        touched_bytes.set(static_cast<int64_t>(usage.touched_bytes));
+        high_water_bytes.set(static_cast<int64_t>(usage.high_water_bytes));
+    }
+};
+
+/// MarketDataPublisher counters, refreshed after every non-empty poll.
+struct PublisherMetrics {
+    MetricCounter events_processed;
+    MetricGauge last_sequence;
+
+    void bind(MetricsRegion& region, const std::string& prefix = "publisher",
+              uint32_t thread = 0);
+};
+
+}  // namespace hft
@@ -0,0 +1,549 @@
+#include "gateway/multicast_publisher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// The feed goes out over BSD sockets; elsewhere open() fails with an error
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFT_MULTICAST_POSIX 1
+#endif
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static constexpr size_t MAX_DATAGRAM_BYTES = 65507;   // IPv4 UDP payload limit
+static constexpr size_t MIN_DATAGRAM_BYTES = 128;     // Fits any single message
+static constexpr size_t MAX_SEND_BATCH = 64;
+static constexpr uint32_t CLOCK_CHECK_EVERY = 64;     // Appends between snapshot clock reads
+static constexpr size_t MAX_RETRANSMIT_COUNT = 1024;  // Datagrams per request
+
+#if defined(HFT_MULTICAST_POSIX)
+static_assert(sizeof(sockaddr_in) == 16, "Destinations are stored as raw sockaddr_in");
+
+static uint64_t wall_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+/// Fill `out` with `address`:`port`. Returns false if `address` is not a
+/// dotted IPv4 address.
+static bool make_address(const std::string& address, uint16_t port, sockaddr_in& out) {
+    std::memset(&out, 0, sizeof(out));
+    out.sin_family = AF_INET;
+    out.sin_port = htons(port);
+    return ::inet_pton(AF_INET, address.c_str(), &out.sin_addr) == 1;
+}
+
+static std::string errno_text(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+/// Close-on-exec UDP socket, optionally non-blocking.
+static int udp_socket(bool nonblocking) {
+#if defined(SOCK_CLOEXEC) && defined(SOCK_NONBLOCK)
+    return ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | (nonblocking ? SOCK_NONBLOCK : 0), 0);
+#else
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);  // e.g. macOS: no socket() flags
+    if (fd >= 0) {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        if (nonblocking) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    return fd;
+#endif
+}
+
+#if defined(__linux__)
+using Datagram = mmsghdr;
+
+/// Send up to `count` datagrams in one call. Returns how many went, or -1.
+static int send_datagrams(int fd, Datagram* datagrams, size_t count) {
+    return ::sendmmsg(fd, datagrams, static_cast<unsigned>(count), 0);
+}
+#else
+struct Datagram {
+    msghdr msg_hdr;
+};
+
+/// No sendmmsg(): one sendmsg() per call. Returns 1, or -1.
+static int send_datagrams(int fd, Datagram* datagrams, size_t /*count*/) {
+    return ::sendmsg(fd, &datagrams->msg_hdr, 0) < 0 ? -1 : 1;
+}
+#endif
+#endif  // HFT_MULTICAST_POSIX
+
+/// Write a message header and `body` at `at`; `block_length` covers
+/// anything the caller appends after the body (snapshot groups).
+template <typename Body>
+static void put_message(char* at, mdp::Template id, const Body& body,
+                        size_t block_length = sizeof(Body)) {
+    mdp::MessageHeader header{};
+    header.block_length = static_cast<uint16_t>(block_length);
+    header.template_id = static_cast<uint16_t>(id);
+    header.schema_id = mdp::SCHEMA_ID;
+    header.version = mdp::SCHEMA_VERSION;
+    std::memcpy(at, &header, sizeof(header));
+    std::memcpy(at + sizeof(header), &body, sizeof(Body));
+}
+
+static bool is_order_update(EventType type) {
+    switch (type) {
+        case EventType::OrderAccepted:
+        case EventType::OrderCancelled:
+        case EventType::OrderRejected:
+        case EventType::OrderFilled:
+        case EventType::OrderPartialFill:
+        case EventType::OrderModified:
+        case EventType::OrderExpired:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MulticastPublisher — producer side
+// ---------------------------------------------------------------------------
+
+MulticastPublisher::MulticastPublisher(const MulticastConfig& config) : config_(config) {}
+
+MulticastPublisher::~MulticastPublisher() { close(); }
+
+bool MulticastPublisher::open() {
+    if (running_) return true;
+#if defined(HFT_MULTICAST_POSIX)
+    sockaddr_in incremental{};
+    if (config_.group.empty() || !make_address(config_.group, config_.port, incremental)) {
+        error_ = "invalid multicast group '" + config_.group + "'";
+        return false;
+    }
+    sockaddr_in snapshot{};
+    const bool snapshots = !config_.snapshot_group.empty();
+    if (snapshots && !make_address(config_.snapshot_group, config_.snapshot_port, snapshot)) {
+        error_ = "invalid snapshot group '" + config_.snapshot_group + "'";
+        return false;
+    }
+    std::memcpy(incremental_addr_, &incremental, sizeof(incremental));
+    std::memcpy(snapshot_addr_, &snapshot, sizeof(snapshot));
+
+    socket_ = udp_socket(false);
+    if (socket_ < 0) {
+        error_ = errno_text("socket");
+        return false;
+    }
+    const int ttl = config_.ttl;
+    const int loop = config_.loopback ? 1 : 0;
+    ::setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    ::setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    if (!config_.interface_address.empty()) {
+        in_addr iface{};
+        if (::inet_pton(AF_INET, config_.interface_address.c_str(), &iface) != 1 ||
+            ::setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0) {
+            error_ = "invalid multicast interface '" + config_.interface_address + "'";
+            close();
+            return false;
+        }
+    }
+
+    if (config_.retransmit_port != 0 && config_.retransmit_history > 0) {
+        retransmit_socket_ = udp_socket(true);
+        sockaddr_in bind_addr{};
+        bind_addr.sin_family = AF_INET;
+        bind_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        bind_addr.sin_port = htons(config_.retransmit_port);
+        socklen_t len = sizeof(bind_addr);
+        if (retransmit_socket_ < 0 ||
+            ::bind(retransmit_socket_, reinterpret_cast<sockaddr*>(&bind_addr), len) != 0 ||
+            ::getsockname(retransmit_socket_, reinterpret_cast<sockaddr*>(&bind_addr), &len) != 0) {
+            error_ = errno_text("retransmit socket");
+            ::close(socket_);
+            socket_ = -1;
+            if (retransmit_socket_ >= 0) ::close(retransmit_socket_);
+            retransmit_socket_ = -1;
+            return false;
+        }
+        bound_retransmit_port_ = ntohs(bind_addr.sin_port);
+    }
+
+    // Multiple of 8 so every slot's PacketHeader stays aligned
+    slot_bytes_ = std::clamp(config_.mtu, MIN_DATAGRAM_BYTES, MAX_DATAGRAM_BYTES) & ~size_t{7};
+    const size_t datagrams = std::clamp<size_t>(config_.datagrams, 2, MAX_DATAGRAMS);
+    slots_ = std::make_unique<char[]>(datagrams * slot_bytes_);
+    slot_size_.assign(datagrams, 0);
+    pending_ = std::make_unique<SlotRing>();
+    free_ = std::make_unique<SlotRing>();
+    pending_->set_wakeup(&signal_);
+    for (uint32_t i = 0; i < datagrams; ++i) (void)free_->try_push(i);
+    if (retransmit_socket_ >= 0) {
+        history_.assign(config_.retransmit_history * slot_bytes_, 0);
+        history_seq_.assign(config_.retransmit_history, 0);
+        history_size_.assign(config_.retransmit_history, 0);
+    }
+
+    current_ = -1;
+    packet_seq_[0] = packet_seq_[1] = 0;
+    instrument_seq_.assign(config_.max_instruments, 0);
+    images_.clear();
+    if (!config_.snapshot_group.empty()) images_.resize(config_.max_instruments);
+    next_snapshot_ = std::chrono::steady_clock::now();
+    stopping_.store(false, std::memory_order_relaxed);
+    running_ = true;
+    sender_ = std::thread([this] { sender_loop(); });
+    return true;
+#else
+    error_ = "multicast publishing needs BSD sockets";
+    return false;
+#endif
+}
+
+char* MulticastPublisher::reserve(mdp::Channel channel, size_t bytes) noexcept {
+    if (current_ >= 0 &&
+        (current_channel_ != channel || slot_size_[current_] + bytes > slot_bytes_)) {
+        submit();
+    }
+    if (current_ < 0) {
+        uint32_t slot;
+        if (!free_->try_pop(slot)) return nullptr;
+        current_ = slot;
+        current_channel_ = channel;
+        mdp::PacketHeader header{};
+        header.sequence = ++packet_seq_[static_cast<size_t>(channel)];
+        header.channel = static_cast<uint8_t>(channel);
+        std::memcpy(slots_.get() + slot * slot_bytes_, &header, sizeof(header));
+        slot_size_[slot] = sizeof(header);
+    }
+    char* packet = slots_.get() + static_cast<size_t>(current_) * slot_bytes_;
+    char* at = packet + slot_size_[current_];
+    slot_size_[current_] = static_cast<uint16_t>(slot_size_[current_] + bytes);
+    auto* header = reinterpret_cast<mdp::PacketHeader*>(packet);
+    ++header->message_count;
+    return at;
+}
+
+void MulticastPublisher::submit() noexcept {
+    // pending_ holds every slot index, so this cannot fail
+    (void)pending_->try_push(static_cast<uint32_t>(current_));
+    current_ = -1;
+}
+
+void MulticastPublisher::add_instrument(InstrumentId id) {
+    if (id >= instrument_seq_.size()) instrument_seq_.resize(id + size_t{1}, 0);
+    if (!config_.snapshot_group.empty() && id >= images_.size()) {
+        images_.resize(id + size_t{1});
+    }
+}
+
+bool MulticastPublisher::append(const EventMessage& event) noexcept {
+    if (!running_) return false;
+    const InstrumentId id = event.instrument_id;
+    if (id >= instrument_seq_.size()) [[unlikely]] {
+        rejected_.store(rejected_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    const bool snapshots = !config_.snapshot_group.empty();
+    if (snapshots && event.type == EventType::LevelUpdate) {
+        apply_level(event.data.level_update, id);
+    }
+
+    bool carried = event.type == EventType::Trade || event.type == EventType::LevelUpdate;
+    if (config_.content == MulticastContent::Events) {
+        carried = carried || event.type == EventType::MassCancel || is_order_update(event.type);
+    }
+    if (!carried) {
+        skipped_.store(skipped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t body_bytes = sizeof(mdp::OrderUpdateBody);
+    if (event.type == EventType::Trade) body_bytes = sizeof(mdp::TradeBody);
+    if (event.type == EventType::LevelUpdate) body_bytes = sizeof(mdp::LevelUpdateBody);
+    if (event.type == EventType::MassCancel) body_bytes = sizeof(mdp::MassCancelBody);
+    char* at = reserve(mdp::Channel::Incremental, sizeof(mdp::MessageHeader) + body_bytes);
+    if (!at) {
+        dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    // Numbered only once it has room, so drops do not leave unfillable gaps
+    const uint64_t seq = ++instrument_seq_[id];
+
+    if (event.type == EventType::Trade) {
+        const TradeEventData& t = event.data.trade;
+        mdp::TradeBody body{};
+        body.instrument_id = id;
+        body.instrument_sequence = seq;
+        body.trade_id = t.trade_id;
+        body.buy_order_id = t.buy_order_id;
+        body.sell_order_id = t.sell_order_id;
+        body.price = t.price;
+        body.quantity = t.quantity;
+        body.timestamp = t.timestamp;
+        put_message(at, mdp::Template::Trade, body);
+    } else if (event.type == EventType::LevelUpdate) {
+        const LevelUpdateEventData& l = event.data.level_update;
+        mdp::LevelUpdateBody body{};
+        body.instrument_id = id;
+        body.side = l.side;
+        body.instrument_sequence = seq;
+        body.price = l.price;
+        body.total_quantity = l.total_quantity;
+        body.order_count = l.order_count;
+        put_message(at, mdp::Template::LevelUpdate, body);
+    } else if (event.type == EventType::MassCancel) {
+        const MassCancelEventData& m = event.data.mass_cancel;
+        mdp::MassCancelBody body{};
+        body.instrument_id = id;
+        body.side = m.side;
+        body.instrument_sequence = seq;
+        body.participant_id = m.participant_id;
+        body.cancelled_count = m.cancelled_count;
+        body.cancelled_quantity = m.cancelled_quantity;
+        put_message(at, mdp::Template::MassCancel, body);
+    } else {
+        const OrderEventData& o = event.data.order_event;
+        mdp::OrderUpdateBody body{};
+        body.instrument_id = id;
+        body.event_type = static_cast<uint8_t>(event.type);
+        body.status = static_cast<uint8_t>(o.status);
+        body.instrument_sequence = seq;
+        body.order_id = o.order_id;
+        body.price = o.price;
+        body.filled_quantity = o.filled_quantity;
+        body.remaining_quantity = o.remaining_quantity;
+        body.timestamp = o.timestamp;
+        put_message(at, mdp::Template::OrderUpdate, body);
+    }
+    appended_.store(appended_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (snapshots && ++appends_since_clock_ >= CLOCK_CHECK_EVERY) {
+        appends_since_clock_ = 0;
+        if (std::chrono::steady_clock::now() >= next_snapshot_) send_snapshots();
+    }
+    return true;
+}
+
+void MulticastPublisher::flush() noexcept {
+    if (!running_) return;
+    if (!config_.snapshot_group.empty() && std::chrono::steady_clock::now() >= next_snapshot_) {
+        send_snapshots();
+    }
+    if (current_ >= 0) submit();
+}
+
+void MulticastPublisher::apply_level(const LevelUpdateEventData& level, InstrumentId id) {
+    auto& side = (level.side == 0) ? images_[id].bids : images_[id].asks;
+    if (level.total_quantity == 0) {
+        side.erase(level.price);
+        return;
+    }
+    mdp::SnapshotEntry& entry = side[level.price];
+    entry.price = level.price;
+    entry.total_quantity = level.total_quantity;
+    entry.order_count = level.order_count;
+    entry.side = level.side;
+}
+
+void MulticastPublisher::send_snapshots() {
+    next_snapshot_ = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(config_.snapshot_interval_ms);
+    constexpr size_t FIXED = sizeof(mdp::MessageHeader) + sizeof(mdp::SnapshotBody) +
+                             sizeof(mdp::GroupSize);
+    const size_t per_chunk = (slot_bytes_ - sizeof(mdp::PacketHeader) - FIXED) /
+                             sizeof(mdp::SnapshotEntry);
+
+    std::vector<const mdp::SnapshotEntry*> entries;
+    for (InstrumentId id = 0; id < images_.size(); ++id) {
+        const LevelImage& image = images_[id];
+        if (id >= instrument_seq_.size() || instrument_seq_[id] == 0) continue;
+        entries.clear();
+        for (auto it = image.bids.rbegin(); it != image.bids.rend(); ++it) {
+            entries.push_back(&it->second);
+        }
+        for (const auto& [price, entry] : image.asks) entries.push_back(&entry);
+
+        const size_t chunks = std::max<size_t>(1, (entries.size() + per_chunk - 1) / per_chunk);
+        for (size_t c = 0; c < chunks; ++c) {
+            const size_t first = c * per_chunk;
+            const size_t n = std::min(per_chunk, entries.size() - first);
+            char* at = reserve(mdp::Channel::Snapshot, FIXED + n * sizeof(mdp::SnapshotEntry));
+            if (!at) {
+                // Sender behind: try again next interval rather than stall
+                if (current_ >= 0) submit();
+                return;
+            }
+            mdp::SnapshotBody body{};
+            body.instrument_id = id;
+            body.chunk = static_cast<uint16_t>(c);
+            body.chunk_count = static_cast<uint16_t>(chunks);
+            body.last_instrument_sequence = instrument_seq_[id];
+            put_message(at, mdp::Template::Snapshot, body,
+                        FIXED - sizeof(mdp::MessageHeader) + n * sizeof(mdp::SnapshotEntry));
+
+            mdp::GroupSize group{};
+            group.block_length = sizeof(mdp::SnapshotEntry);
+            group.num_in_group = static_cast<uint16_t>(n);
+            char* p = at + sizeof(mdp::MessageHeader) + sizeof(mdp::SnapshotBody);
+            std::memcpy(p, &group, sizeof(group));
+            p += sizeof(group);
+            for (size_t i = 0; i < n; ++i) {
+                std::memcpy(p, entries[first + i], sizeof(mdp::SnapshotEntry));
+                p += sizeof(mdp::SnapshotEntry);
+            }
+            snapshots_.store(snapshots_.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        }
+    }
+    if (current_ >= 0 && current_channel_ == mdp::Channel::Snapshot) submit();
+}
+
+void MulticastPublisher::close() {
+    if (running_) {
+        if (current_ >= 0) submit();
+        stopping_.store(true, std::memory_order_release);
+        signal_.notify();
+        sender_.join();
+        running_ = false;
+        current_ = -1;
+    }
+#if defined(HFT_MULTICAST_POSIX)
+    if (socket_ >= 0) ::close(socket_);
+    if (retransmit_socket_ >= 0) ::close(retransmit_socket_);
+#endif
+    socket_ = -1;
+    retransmit_socket_ = -1;
+}
+
+MulticastStats MulticastPublisher::stats() const {
+    MulticastStats s;
+    s.events_appended = appended_.load(std::memory_order_relaxed);
+    s.events_dropped = dropped_.load(std::memory_order_relaxed);
+    s.events_skipped = skipped_.load(std::memory_order_relaxed);
+    s.events_rejected = rejected_.load(std::memory_order_relaxed);
+    s.datagrams_sent = datagrams_sent_.load(std::memory_order_relaxed);
+    s.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    s.send_calls = send_calls_.load(std::memory_order_relaxed);
+    s.send_errors = send_errors_.load(std::memory_order_relaxed);
+    s.snapshots_sent = snapshots_.load(std::memory_order_relaxed);
+    s.retransmit_requests = retransmit_requests_.load(std::memory_order_relaxed);
+    s.datagrams_retransmitted = retransmitted_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// MulticastPublisher — sender thread
+// ---------------------------------------------------------------------------
+
+void MulticastPublisher::sender_loop() {
+    ScopedThreadPlacement placement(config_.threading, ThreadRole::Multicast);
+    Waiter waiter(config_.wait, &signal_);
+    const size_t batch = std::clamp<size_t>(config_.send_batch, 1, MAX_SEND_BATCH);
+    uint32_t slots[MAX_SEND_BATCH];
+
+    for (;;) {
+        const size_t n = pending_->try_pop_n(slots, batch);
+        if (n > 0) {
+            waiter.reset();
+            send_batch(slots, n);
+            continue;
+        }
+        if (retransmit_socket_ >= 0) serve_retransmits();
+        if (stopping_.load(std::memory_order_acquire)) {
+            if (pending_->empty()) break;
+            continue;
+        }
+        waiter.idle([this] {
+            return !pending_->empty() || stopping_.load(std::memory_order_acquire);
+        });
+    }
+}
+
+void MulticastPublisher::send_batch(const uint32_t* slots, size_t count) {
+#if defined(HFT_MULTICAST_POSIX)
+    Datagram messages[MAX_SEND_BATCH];
+    iovec iov[MAX_SEND_BATCH];
+    const uint64_t now = wall_clock_ns();
+    for (size_t i = 0; i < count; ++i) {
+        char* packet = slots_.get() + static_cast<size_t>(slots[i]) * slot_bytes_;
+        auto* header = reinterpret_cast<mdp::PacketHeader*>(packet);
+        header->sending_time = now;
+        iov[i].iov_base = packet;
+        iov[i].iov_len = slot_size_[slots[i]];
+        std::memset(&messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_iov = &iov[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = (header->channel == 0) ? incremental_addr_ : snapshot_addr_;
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+
+    size_t done = 0;
+    while (done < count) {
+        const int sent = send_datagrams(socket_, messages + done, count - done);
+        send_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (sent > 0) {
+            for (size_t i = done; i < done + static_cast<size_t>(sent); ++i) {
+                bytes_sent_.fetch_add(iov[i].iov_len, std::memory_order_relaxed);
+            }
+            datagrams_sent_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            done += static_cast<size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // The kernel refused this datagram: skip it, keep the rest
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            ++done;
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i) {
+        const char* packet = slots_.get() + static_cast<size_t>(slots[i]) * slot_bytes_;
+        const auto* header = reinterpret_cast<const mdp::PacketHeader*>(packet);
+        if (!history_seq_.empty() && header->channel == 0) {
+            const size_t h = header->sequence % history_seq_.size();
+            std::memcpy(history_.data() + h * slot_bytes_, packet, slot_size_[slots[i]]);
+            history_seq_[h] = header->sequence;
+            history_size_[h] = slot_size_[slots[i]];
+        }
+        // free_ holds every slot index, so this cannot fail
+        (void)free_->try_push(slots[i]);
+    }
+}
+
+void MulticastPublisher::serve_retransmits() {
+#if defined(HFT_MULTICAST_POSIX)
+    for (;;) {
+        mdp::RetransmitRequest request{};
+        sockaddr_in from{};
+        socklen_t from_len = sizeof(from);
+        const ssize_t n = ::recvfrom(retransmit_socket_, &request, sizeof(request), 0,
+                                     reinterpret_cast<sockaddr*>(&from), &from_len);
+        if (n < 0) return;  // EAGAIN: nothing queued
+        if (n != static_cast<ssize_t>(sizeof(request))) continue;
+        retransmit_requests_.fetch_add(1, std::memory_order_relaxed);
+
+        const uint64_t count = std::min<uint64_t>(
+            {request.count, history_seq_.size(), MAX_RETRANSMIT_COUNT});
+        for (uint64_t seq = request.first_sequence; seq < request.first_sequence + count; ++seq) {
+            const size_t h = seq % history_seq_.size();
+            if (history_seq_[h] != seq) continue;  // Never sent or overwritten
+            char* packet = history_.data() + h * slot_bytes_;
+            reinterpret_cast<mdp::PacketHeader*>(packet)->flags |= mdp::FLAG_RETRANSMIT;
+            if (::sendto(retransmit_socket_, packet, history_size_[h], 0,
+                         reinterpret_cast<const sockaddr*>(&from), from_len) > 0) {
+                retransmitted_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                send_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+#endif
+}
+
+}  // namespace hft
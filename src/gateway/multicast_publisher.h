@@ -0,0 +1,351 @@
+#pragma once
+
+/// @file multicast_publisher.h
+/// @brief Binary UDP (multicast) market data feed of the event stream.
+///
+/// Cold-path component. MulticastPublisher is an event consumer (typically
+/// a MarketDataPublisher callback) that turns EventMessages into a compact
+/// binary feed for consumers on other hosts. append() encodes each event
+/// into the current datagram, never larger than MulticastConfig::mtu; full
+/// datagrams are handed over an SPSC ring to a sender thread, which sends
+/// them with sendmmsg() in batches (one sendmsg() each where there is no
+/// sendmmsg(); without BSD sockets open() fails). As in EventJournal, the
+/// appending thread never waits: with every datagram slot in flight,
+/// events are dropped and counted.
+///
+/// Wire format (namespace mdp): fixed-layout little-endian structs in the
+/// style of SBE. A datagram is a PacketHeader followed by messages, each a
+/// MessageHeader and a fixed block. Packets carry a per-channel sequence
+/// number, and every incremental message a per-instrument one, so a
+/// consumer detects gaps both ways.
+///
+/// Recovery:
+///   - Gap fill: the sender keeps the last retransmit_history incremental
+///     datagrams. A RetransmitRequest sent to retransmit_port is answered,
+///     unicast to the requester, with the datagrams still held (flagged
+///     FLAG_RETRANSMIT).
+///   - Snapshots: with a snapshot channel configured, the publisher keeps
+///     an L2 image per instrument from LevelUpdate events and sends it
+///     every snapshot_interval_ms on that channel, stamped with the last
+///     instrument sequence number it includes. A late joiner applies the
+///     snapshot, then the incremental messages after that number. Level
+///     updates must be enabled on the books (OrderBookOptions::level_deltas).
+///
+/// Usage:
+///   MulticastConfig config;
+///   config.group = "239.1.1.1";
+///   config.port = 30001;
+///   MulticastPublisher feed(config);
+///   if (!feed.open()) { ... feed.error() ... }
+///   publisher.register_callback([&](const EventMessage& e) { (void)feed.append(e); });
+///   ...                   // feed.flush() after each poll bounds latency
+///   feed.close();         // Sends the partial datagram and joins the sender
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "transport/message.h"
+#include "transport/spsc_ring_buffer.h"
+#include "transport/wait_strategy.h"
+#include "utils/thread_placement.h"
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Wire schema
+// ---------------------------------------------------------------------------
+
+namespace mdp {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "The feed is encoded in host order, which must be little-endian");
+
+constexpr uint16_t SCHEMA_ID = 1;
+constexpr uint16_t SCHEMA_VERSION = 1;
+
+enum class Template : uint16_t {
+    Trade = 1,
+    OrderUpdate = 2,     // Accepted, cancelled, rejected, filled, modified, expired
+    LevelUpdate = 3,
+    MassCancel = 4,
+    Snapshot = 5         // Snapshot channel only
+};
+
+enum class Channel : uint8_t { Incremental = 0, Snapshot = 1 };
+
+/// PacketHeader::flags: a datagram re-sent in answer to a RetransmitRequest.
+constexpr uint8_t FLAG_RETRANSMIT = 1;
+
+struct PacketHeader {
+    uint64_t sequence;       // Per channel, from 1
+    uint64_t sending_time;   // Wall clock, ns since the epoch
+    uint16_t message_count;
+    uint8_t channel;         // Channel
+    uint8_t flags;
+    uint32_t reserved;
+};
+
+struct MessageHeader {
+    uint16_t block_length;   // Bytes after this header
+    uint16_t template_id;    // Template
+    uint16_t schema_id;
+    uint16_t version;
+};
+
+struct TradeBody {
+    InstrumentId instrument_id;
+    uint32_t reserved;
+    uint64_t instrument_sequence;
+    uint64_t trade_id;
+    OrderId buy_order_id;
+    OrderId sell_order_id;
+    Price price;
+    Quantity quantity;
+    Timestamp timestamp;
+};
+
+struct OrderUpdateBody {
+    InstrumentId instrument_id;
+    uint8_t event_type;      // EventType
+    uint8_t status;          // OrderStatus
+    uint16_t reserved;
+    uint64_t instrument_sequence;
+    OrderId order_id;
+    Price price;
+    Quantity filled_quantity;
+    Quantity remaining_quantity;
+    Timestamp timestamp;
+};
+
+struct LevelUpdateBody {
+    InstrumentId instrument_id;
+    uint8_t side;            // 0 = Buy, 1 = Sell
+    uint8_t reserved[3];
+    uint64_t instrument_sequence;
+    Price price;
+    Quantity total_quantity; // 0 removes the level
+    uint32_t order_count;
+    uint32_t reserved2;
+};
+
+struct MassCancelBody {
+    InstrumentId instrument_id;
+    uint8_t side;            // 0 = Buy, 1 = Sell, 2 = both
+    uint8_t reserved[3];
+    uint64_t instrument_sequence;
+    ParticipantId participant_id;
+    uint32_t cancelled_count;
+    Quantity cancelled_quantity;
+};
+
+/// Snapshot message: this block, a GroupSize, then num_in_group
+/// SnapshotEntry records. Books too deep for one datagram are split into
+/// chunk_count messages.
+struct SnapshotBody {
+    InstrumentId instrument_id;
+    uint16_t chunk;
+    uint16_t chunk_count;
+    uint64_t last_instrument_sequence;  // Incremental messages up to this are in it
+};
+
+struct GroupSize {
+    uint16_t block_length;   // Bytes per entry
+    uint16_t num_in_group;
+};
+
+struct SnapshotEntry {
+    Price price;
+    Quantity total_quantity;
+    uint32_t order_count;
+    uint8_t side;
+    uint8_t reserved[3];
+};
+
+/// Sent by a consumer to the retransmit port.
+struct RetransmitRequest {
+    uint64_t first_sequence;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PacketHeader) == 24 && sizeof(MessageHeader) == 8 &&
+              sizeof(TradeBody) == 64 && sizeof(OrderUpdateBody) == 56 &&
+              sizeof(LevelUpdateBody) == 40 && sizeof(MassCancelBody) == 32 &&
+              sizeof(SnapshotBody) == 16 && sizeof(GroupSize) == 4 &&
+              sizeof(SnapshotEntry) == 24 && sizeof(RetransmitRequest) == 16,
+              "Wire structs have fixed, padding-free layouts");
+
+}  // namespace mdp
+
+// ---------------------------------------------------------------------------
+// Publisher
+// ---------------------------------------------------------------------------
+
+/// What the incremental channel carries.
+enum class MulticastContent : uint8_t {
+    Events,  // Every event
+    Levels   // L2 only: LevelUpdate and Trade
+};
+
+struct MulticastConfig {
+    std::string group;                 // Destination IPv4 (multicast or unicast); empty = off
+    uint16_t port = 0;
+    std::string interface_address;     // IP_MULTICAST_IF (empty = the default route)
+    uint8_t ttl = 1;
+    bool loopback = true;              // IP_MULTICAST_LOOP
+    size_t mtu = 1472;                 // Max datagram bytes (1500 - IP - UDP), rounded to 8
+    MulticastContent content = MulticastContent::Events;
+    /// Instrument ids [0, max_instruments) get sequence counters (and
+    /// level images) at open(); add_instrument() extends the range.
+    size_t max_instruments = 256;
+    size_t datagrams = 1024;           // Slots in flight (<= MAX_DATAGRAMS)
+    size_t send_batch = 32;            // Datagrams per sendmmsg()
+    size_t retransmit_history = 4096;  // Datagrams kept for gap fill (0 = none)
+    uint16_t retransmit_port = 0;      // UDP port for RetransmitRequests (0 = none)
+    std::string snapshot_group;        // Snapshot channel (empty = none)
+    uint16_t snapshot_port = 0;
+    uint32_t snapshot_interval_ms = 1000;
+    /// How the sender waits for datagrams (Block sleeps until one is queued).
+    WaitConfig wait;
+    /// The sender thread takes the Multicast role.
+    ThreadingConfig threading;
+};
+
+struct MulticastStats {
+    uint64_t events_appended = 0;
+    uint64_t events_dropped = 0;       // No free datagram (sender behind)
+    uint64_t events_skipped = 0;       // Not carried by MulticastContent
+    uint64_t events_rejected = 0;      // Instrument id not added (see max_instruments)
+    uint64_t datagrams_sent = 0;       // Incremental and snapshot
+    uint64_t bytes_sent = 0;
+    uint64_t send_calls = 0;           // sendmmsg() (or sendmsg()) calls
+    uint64_t send_errors = 0;          // Datagrams the kernel refused
+    uint64_t snapshots_sent = 0;       // Snapshot messages
+    uint64_t retransmit_requests = 0;
+    uint64_t datagrams_retransmitted = 0;
+};
+
+class MulticastPublisher {
+public:
+    /// Upper bound on MulticastConfig::datagrams.
+    static constexpr size_t MAX_DATAGRAMS = 4096;
+
+    explicit MulticastPublisher(const MulticastConfig& config);
+    ~MulticastPublisher();
+
+    MulticastPublisher(const MulticastPublisher&) = delete;
+    MulticastPublisher& operator=(const MulticastPublisher&) = delete;
+
+    /// Open the sockets, allocate the datagram slots and start the sender.
+    /// Returns false (see error()) on failure.
+    [[nodiscard]] bool open();
+
+    /// Make room for instrument `id` (ids below max_instruments already
+    /// have it). Cold path: call from the appending thread, before any of
+    /// the instrument's events.
+    void add_instrument(InstrumentId id);
+
+    /// Encode one event. Never blocks on the sender or the network;
+    /// returns false if the event was dropped, is not carried, or names an
+    /// instrument the publisher was not sized for.
+    bool append(const EventMessage& event) noexcept;
+
+    /// Hand the partially filled datagram to the sender (non-blocking).
+    void flush() noexcept;
+
+    /// Flush, let the sender drain and join it, close the sockets. Call
+    /// from the appending thread (or after it has stopped). Idempotent;
+    /// also called by the destructor.
+    void close();
+
+    [[nodiscard]] bool is_open() const { return running_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+    /// Counters so far (sender-side ones are approximate while running).
+    [[nodiscard]] MulticastStats stats() const;
+
+    /// Last sequence number sent for `id` on the incremental channel.
+    [[nodiscard]] uint64_t instrument_sequence(InstrumentId id) const noexcept {
+        return id < instrument_seq_.size() ? instrument_seq_[id] : 0;
+    }
+
+    /// Port the retransmit socket is bound to (resolves a configured 0
+    /// only when retransmission is on; 0 = none).
+    [[nodiscard]] uint16_t retransmit_port() const { return bound_retransmit_port_; }
+
+private:
+    using SlotRing = SPSCRingBuffer<uint32_t, MAX_DATAGRAMS>;
+
+    /// Per-instrument L2 image for the snapshot channel.
+    struct LevelImage {
+        std::map<Price, mdp::SnapshotEntry> bids;
+        std::map<Price, mdp::SnapshotEntry> asks;
+    };
+
+    /// Reserve `bytes` in the current `channel` datagram (starting a new
+    /// one as needed); nullptr if no slot is free.
+    char* reserve(mdp::Channel channel, size_t bytes) noexcept;
+
+    /// Queue the current datagram for the sender.
+    void submit() noexcept;
+
+    void apply_level(const LevelUpdateEventData& level, InstrumentId id);
+    void send_snapshots();
+
+    void sender_loop();
+    void send_batch(const uint32_t* slots, size_t count);
+    void serve_retransmits();
+
+    MulticastConfig config_;
+    std::string error_;
+    size_t slot_bytes_ = 0;
+    std::unique_ptr<char[]> slots_;     // datagrams x slot_bytes_
+    std::vector<uint16_t> slot_size_;
+
+    // Producer side (the appending thread)
+    std::unique_ptr<SlotRing> pending_; // Producer -> sender
+    std::unique_ptr<SlotRing> free_;    // Sender -> producer
+    int64_t current_ = -1;              // Slot being filled
+    mdp::Channel current_channel_ = mdp::Channel::Incremental;
+    uint64_t packet_seq_[2] = {0, 0};   // Per channel
+    std::vector<uint64_t> instrument_seq_;
+    std::vector<LevelImage> images_;    // By instrument id, if snapshotting
+    std::chrono::steady_clock::time_point next_snapshot_;
+    uint32_t appends_since_clock_ = 0;
+    std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> snapshots_{0};
+
+    // Sender side
+    std::thread sender_;
+    std::atomic<bool> stopping_{false};
+    bool running_ = false;
+    WakeupSignal signal_;
+    int socket_ = -1;                   // Incremental and snapshot sends
+    int retransmit_socket_ = -1;
+    uint16_t bound_retransmit_port_ = 0;
+    std::vector<char> history_;         // retransmit_history x slot_bytes_
+    std::vector<uint64_t> history_seq_; // Sequence held in each history slot
+    std::vector<uint16_t> history_size_;
+    std::atomic<uint64_t> datagrams_sent_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> send_calls_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> retransmit_requests_{0};
+    std::atomic<uint64_t> retransmitted_{0};
+    // Destinations (sockaddr_in), set by open()
+    alignas(8) unsigned char incremental_addr_[16] = {};
+    alignas(8) unsigned char snapshot_addr_[16] = {};
+};
+
+}  // namespace hft
@@ -0,0 +1,59 @@
+#include "gateway/order_columns.h"
+
+#include "transport/message.h"
+
+namespace hft {
+
+void submit_order_columns(OrderGateway& gateway, const OrderColumns& orders,
+                          GatewayResult* results) noexcept {
+    const InstrumentId instrument = gateway.instrument_id();
+    OrderMessage chunk[ORDER_COLUMNS_CHUNK];
+    for (size_t base = 0; base < orders.count; base += ORDER_COLUMNS_CHUNK) {
+        const size_t n = orders.count - base < ORDER_COLUMNS_CHUNK ? orders.count - base
+                                                                   : ORDER_COLUMNS_CHUNK;
+        for (size_t j = 0; j < n; ++j) {
+            const size_t i = base + j;
+            OrderMessage& msg = chunk[j];
+            msg = OrderMessage{};
+            msg.type = MessageType::Add;
+            msg.instrument_id = instrument;
+            Order& order = msg.order;
+            order.order_id = orders.order_ids[i];
+            order.instrument_id = instrument;
+            order.side = static_cast<Side>(orders.sides[i]);
+            order.type = orders.types ? static_cast<OrderType>(orders.types[i])
+                                      : OrderType::Limit;
+            order.time_in_force = orders.time_in_force
+                                      ? static_cast<TimeInForce>(orders.time_in_force[i])
+                                      : TimeInForce::GTC;
+            order.status = OrderStatus::New;
+            order.price = orders.prices[i];
+            order.quantity = orders.quantities[i];
+            order.visible_quantity = orders.quantities[i];
+            order.participant_id = orders.participant_ids ? orders.participant_ids[i] : 0;
+            order.timestamp = orders.timestamps ? orders.timestamps[i] : 0;
+        }
+        gateway.process_batch(chunk, n, results + base);
+    }
+}
+
+void cancel_order_columns(OrderGateway& gateway, const OrderId* order_ids, size_t count,
+                          GatewayResult* results, const Timestamp* timestamps) noexcept {
+    const InstrumentId instrument = gateway.instrument_id();
+    OrderMessage chunk[ORDER_COLUMNS_CHUNK];
+    for (size_t base = 0; base < count; base += ORDER_COLUMNS_CHUNK) {
+        const size_t n = count - base < ORDER_COLUMNS_CHUNK ? count - base : ORDER_COLUMNS_CHUNK;
+        for (size_t j = 0; j < n; ++j) {
+            OrderMessage& msg = chunk[j];
+            msg = OrderMessage{};
+            msg.type = MessageType::Cancel;
+            msg.instrument_id = instrument;
+            msg.order.order_id = order_ids[base + j];
+            msg.order.instrument_id = instrument;
+            msg.order.timestamp = timestamps ? timestamps[base + j] : 0;
+        }
+        gateway.process_batch(chunk, n, results + base);
+    }
+}
+
+}  // namespace hft
@@ -0,0 +1,60 @@
+#pragma once
+
+/// @file order_columns.h
+/// @brief Orders given as parallel columns (one array per field), run
+///        through an OrderGateway in batches.
+///
+/// Cold-path adapter for column-oriented callers, such as Python backtests
+/// that pass numpy arrays (MatchingSession.submit_batch). The columns are
+/// turned into OrderMessages one chunk at a time in a stack buffer, and
+/// each chunk goes through OrderGateway::process_batch. Each order then
+/// costs the gateway's own work plus filling one message. There are no
+/// per-order allocations or calls back into the caller.
+///
+/// A null optional column takes the defaults an L3 feed add uses: Limit,
+/// GTC, participant 0, timestamp 0 and fully visible quantity. Orders carry
+/// the gateway's instrument ID. Enum columns are their underlying integer,
+/// which is what a numpy uint8 array holds.
+///
+/// Usage:
+///   OrderColumns orders;
+///   orders.count = n;
+///   orders.order_ids = ids; orders.sides = sides;
+///   orders.prices = prices; orders.quantities = quantities;
+///   std::vector<GatewayResult> results(n);
+///   submit_order_columns(gateway, orders, results.data());
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types.h"
+#include "gateway/order_gateway.h"
+
+namespace hft {
+
+struct OrderColumns {
+    size_t count = 0;
+    const OrderId* order_ids = nullptr;              // Required
+    const uint8_t* sides = nullptr;                  // Side, required
+    const Price* prices = nullptr;                   // Required (Market ignores it)
+    const Quantity* quantities = nullptr;            // Required
+    const uint8_t* types = nullptr;                  // OrderType (Limit)
+    const uint8_t* time_in_force = nullptr;          // TimeInForce (GTC)
+    const ParticipantId* participant_ids = nullptr;  // (0)
+    const Timestamp* timestamps = nullptr;           // (0)
+};
+
+/// Messages filled per process_batch call.
+inline constexpr size_t ORDER_COLUMNS_CHUNK = 64;
+
+/// Add orders[0..count) in order, writing results[i] for order i.
+void submit_order_columns(OrderGateway& gateway, const OrderColumns& orders,
+                          GatewayResult* results) noexcept;
+
+/// Cancel order_ids[0..count) in order. results[i] is accepted with
+/// MatchStatus::Cancelled, or rejected with OrderNotFound.
+void cancel_order_columns(OrderGateway& gateway, const OrderId* order_ids, size_t count,
+                          GatewayResult* results,
+                          const Timestamp* timestamps = nullptr) noexcept;
+
+}  // namespace hft
@@ -1,9 +1,60 @@
 #include "gateway/order_gateway.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
+#include "gateway/metrics_region.h"
+#include "utils/clock.h"
+#include "utils/trace.h"
+
 namespace hft {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Spin on `attempt` until it succeeds or `timeout_ns` has passed (0 = no
+/// limit), adding the time spent to `blocked_ns`.
+template <typename Attempt>
+bool spin_until(Attempt&& attempt, uint64_t timeout_ns, uint64_t& blocked_ns) noexcept {
+    const auto t0 = Clock::now();
+    for (;;) {
+        const bool ok = attempt();
+        const auto waited = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0)
+                .count());
+        if (ok || (timeout_ns != 0 && waited >= timeout_ns)) {
+            blocked_ns += waited;
+            return ok;
+        }
+        cpu_relax();
+    }
+}
+
+/// Whether the order `src` submitted with outcome `result` now rests on
+/// the book (untriggered stops live in the stop book and are not counted
+/// until they are elected and rest; see count_stop_rest).
+bool rests_on_book(const Order& src, const MatchSummary& result) noexcept {
+    if (result.remaining_quantity == 0) return false;
+    if (result.status != MatchStatus::Resting && result.status != MatchStatus::PartialFill) {
+        return false;
+    }
+    switch (src.type) {
+        case OrderType::Market:
+        case OrderType::IOC:
+        case OrderType::FOK:
+        case OrderType::Stop:
+        case OrderType::StopLimit:
+            return false;
+        default:
+            return src.time_in_force != TimeInForce::IOC &&
+                   src.time_in_force != TimeInForce::FOK;
+    }
+}
+
+}  // namespace
+
 // ---------------------------------------------------------------------------
 // Construction
 // ---------------------------------------------------------------------------
@@ -13,18 +64,59 @@ OrderGateway::OrderGateway(MatchingEngine& engine, MemoryPool<Order>& pool,
                            InstrumentId instrument_id) noexcept
     : engine_(engine),
       pool_(pool),
+      pool_localized_(pool.colours() > 1),
       event_buffer_(event_buffer),
+      packed_buffer_(nullptr),
       instrument_id_(instrument_id),
       sequence_num_(0),
       orders_processed_(0),
       orders_rejected_(0),
-      backpressure_count_(0) {}
+      backpressure_count_(0),
+      backpressure_ns_(0),
+      events_spilled_(0),
+      events_conflated_(0),
+      events_dropped_(0),
+      overflow_high_water_(0),
+      in_batch_(false),
+      target_(EventTarget::InPlace),
+      scratch_{},
+      risk_(nullptr),
+      risk_order_id_(0),
+      risk_participant_(0),
+      risk_rest_order_(0),
+      throttle_(nullptr),
+      quote_snapshot_(nullptr),
+      metrics_(nullptr),
+      digest_every_(0),
+      digest_due_(0) {}
+
+void OrderGateway::set_backpressure(const BackpressureConfig& config) {
+    backpressure_ = config;
+    if (backpressure_.overflow_capacity == 0) {
+        backpressure_.policy = BackpressurePolicy::Block;  // Nowhere to spill
+    }
+    overflow_.reset(backpressure_.policy == BackpressurePolicy::Block
+                        ? 0 : backpressure_.overflow_capacity);
+}
 
 // ---------------------------------------------------------------------------
 // Order submission
 // ---------------------------------------------------------------------------
 
 GatewayResult OrderGateway::process_order(const OrderMessage& msg) noexcept {
+    if (throttle_) [[unlikely]] {
+        GatewayResult result{};
+        if (!pass_throttle(msg, result)) {
+            update_metrics();
+            return result;
+        }
+    }
+    const GatewayResult result = submit_add(msg);
+    update_metrics();
+    return result;
+}
+
+GatewayResult OrderGateway::submit_add(const OrderMessage& msg) noexcept {
     GatewayResult result{};
     result.accepted = false;
     result.reject_reason = GatewayRejectReason::None;
@@ -34,6 +126,8 @@ GatewayResult OrderGateway::process_order(const OrderMessage& msg) noexcept {
     result.remaining_quantity = 0;
 
     const Order& src = msg.order;
+    process_time(src.timestamp);
+    HFT_TRACE_BEGIN(t_validate, src.order_id);
 
     // --- Gateway-level validation ---
 
@@ -41,23 +135,45 @@ GatewayResult OrderGateway::process_order(const OrderMessage& msg) noexcept {
     if (src.quantity == 0) {
         result.reject_reason = GatewayRejectReason::InvalidQuantity;
         ++orders_rejected_;
+        HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
         publish_rejection(src);
         return result;
     }
 
-    // Non-Market orders must have a positive price
-    if (src.type != OrderType::Market && src.price <= 0) {
+    // Non-Market orders must have a positive price (a Stop releases as Market)
+    if (src.type != OrderType::Market && src.type != OrderType::Stop &&
+        src.price <= 0) {
         result.reject_reason = GatewayRejectReason::InvalidPrice;
         ++orders_rejected_;
+        HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
         publish_rejection(src);
         return result;
     }
 
+    if (risk_) [[unlikely]] {
+        if (risk_->check(src, engine_.book().mid_price()) != RiskReject::None) {
+            result.reject_reason = GatewayRejectReason::RiskLimit;
+            ++orders_rejected_;
+            HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
+            publish_rejection(src);
+            return result;
+        }
+        risk_order_id_ = src.order_id;
+        risk_participant_ = src.participant_id;
+        risk_rest_order_ = src.order_id;
+    }
+
+    HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
+
     // Allocate from pool
-    Order* order = pool_.allocate();
+    HFT_TRACE_BEGIN(t_pool, src.order_id);
+    Order* order = pool_localized_ ? pool_.allocate(engine_.book().level_hint(src.price))
+                                   : pool_.allocate();
+    HFT_TRACE_END(TraceStage::PoolAllocate, src.order_id, t_pool);
     if (!order) {
         result.reject_reason = GatewayRejectReason::PoolExhausted;
         ++orders_rejected_;
+        risk_order_id_ = risk_rest_order_ = 0;
         publish_rejection(src);
         return result;
     }
@@ -76,12 +192,25 @@ GatewayResult OrderGateway::process_order(const OrderMessage& msg) noexcept {
 
     // --- Submit to matching engine ---
 
-    MatchResult match_result = engine_.submit_order(order);
+    // Trades are published straight from the matching loop.
+    HFT_TRACE_LET(first_event, sequence_num_ + 1);
+    HFT_TRACE_BEGIN(t_match, order_copy.order_id);
+    MatchSummary match_result = engine_.submit_order(
+        order, TradeSink{&OrderGateway::publish_trade, this});
     // `order` may be deallocated at this point — do not dereference.
-
-    // --- Decompose and publish events ---
-
-    decompose_and_publish(match_result, order_copy);
+    risk_order_id_ = 0;
+    HFT_TRACE_END(TraceStage::Match, order_copy.order_id, t_match);
+
+    HFT_TRACE_BEGIN(t_publish, order_copy.order_id);
+    publish_order_status(match_result, order_copy);
+    finish_update();
+    HFT_TRACE_END_EVENTS(TraceStage::EventPublish, order_copy.order_id, t_publish, first_event,
+                         sequence_num_ + 1 - first_event);
+    // (Counted already if it elected a stop: see track_stop_release)
+    if (risk_ && risk_rest_order_ != 0 && rests_on_book(order_copy, match_result)) [[unlikely]] {
+        risk_->on_rest(order_copy.participant_id);
+    }
+    risk_rest_order_ = 0;
 
     // --- Build lightweight result ---
 
@@ -95,11 +224,98 @@ GatewayResult OrderGateway::process_order(const OrderMessage& msg) noexcept {
     return result;
 }
 
+// ---------------------------------------------------------------------------
+// Throttle
+// ---------------------------------------------------------------------------
+
+bool OrderGateway::pass_throttle(const OrderMessage& msg, GatewayResult& result) noexcept {
+    const uint64_t now = rdtsc();
+    const ParticipantId participant = msg.order.participant_id;
+    result.match_status = MatchStatus::Rejected;
+    result.reject_reason = GatewayRejectReason::Throttled;
+
+    if (throttle_->queues()) {
+        if (throttle_->deferred() != 0) release_throttled();
+        // Behind its own deferred messages, or over the limit: queue it
+        if (!throttle_->has_deferred(participant) &&
+            throttle_->admit(participant, msg.instrument_id, now)) {
+            return true;
+        }
+        if (throttle_->defer(msg)) {
+            result.deferred = true;
+            return false;
+        }
+    } else if (throttle_->admit(participant, msg.instrument_id, now)) {
+        return true;
+    }
+
+    ++orders_rejected_;
+    publish_rejection(msg.order);
+    return false;
+}
+
+void OrderGateway::set_risk(PreTradeRisk* risk) noexcept {
+    risk_ = risk;
+    engine_.set_stop_release_sink(risk ? OrderSink{&OrderGateway::track_stop_release, this}
+                                       : OrderSink{nullptr, nullptr});
+    engine_.set_stop_rest_sink(risk ? OrderSink{&OrderGateway::count_stop_rest, this}
+                                    : OrderSink{nullptr, nullptr});
+    engine_.set_stp_cancel_sink(risk ? OrderSink{&OrderGateway::count_stp_cancel, this}
+                                     : OrderSink{nullptr, nullptr});
+}
+
+void OrderGateway::track_stop_release(void* context, const Order& order) noexcept {
+    // The stop is the aggressor of the trades that follow
+    auto* self = static_cast<OrderGateway*>(context);
+    if (self->risk_rest_order_ != 0) {
+        // The order that elected it rests before the stop can trade with it
+        if (self->engine_.book().find_order(self->risk_rest_order_) != nullptr) {
+            self->risk_->on_rest(self->risk_participant_);
+        }
+        self->risk_rest_order_ = 0;
+    }
+    self->risk_order_id_ = order.order_id;
+    self->risk_participant_ = order.participant_id;
+}
+
+void OrderGateway::count_stop_rest(void* context, const Order& order) noexcept {
+    static_cast<OrderGateway*>(context)->risk_->on_rest(order.participant_id);
+}
+
+void OrderGateway::count_stp_cancel(void* context, const Order& order) noexcept {
+    static_cast<OrderGateway*>(context)->risk_->on_done(order.participant_id);
+}
+
+bool OrderGateway::maintain() noexcept {
+    const bool grown = pool_.growth_pending() && pool_.grow();
+    return engine_.maintain_book() || grown;
+}
+
+size_t OrderGateway::release_throttled() noexcept {
+    if (!throttle_ || throttle_->deferred() == 0) return 0;
+    return throttle_->release(rdtsc(), [this](const OrderMessage& msg) {
+        (void)(msg.type == MessageType::Modify ? submit_modify(msg) : submit_add(msg));
+    });
+}
+
 // ---------------------------------------------------------------------------
 // Modify
 // ---------------------------------------------------------------------------
 
 GatewayResult OrderGateway::process_modify(const OrderMessage& msg) noexcept {
+    if (throttle_) [[unlikely]] {
+        GatewayResult result{};
+        if (!pass_throttle(msg, result)) {
+            update_metrics();
+            return result;
+        }
+    }
+    const GatewayResult result = submit_modify(msg);
+    update_metrics();
+    return result;
+}
+
+GatewayResult OrderGateway::submit_modify(const OrderMessage& msg) noexcept {
     GatewayResult result{};
     result.accepted = false;
     result.reject_reason = GatewayRejectReason::None;
@@ -109,11 +325,14 @@ GatewayResult OrderGateway::process_modify(const OrderMessage& msg) noexcept {
     result.remaining_quantity = 0;
 
     const Order& src = msg.order;
+    process_time(src.timestamp);
+    HFT_TRACE_BEGIN(t_validate, src.order_id);
 
     // Gateway-level validation
     if (src.quantity == 0) {
         result.reject_reason = GatewayRejectReason::InvalidQuantity;
         ++orders_rejected_;
+        HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
         publish_rejection(src);
         return result;
     }
@@ -121,13 +340,40 @@ GatewayResult OrderGateway::process_modify(const OrderMessage& msg) noexcept {
     if (src.price <= 0) {
         result.reject_reason = GatewayRejectReason::InvalidPrice;
         ++orders_rejected_;
+        HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
         publish_rejection(src);
         return result;
     }
 
+    // Risk: the amended order as it would stand
+    ParticipantId participant = 0;
+    const Order* resting = risk_ ? engine_.book().find_order(src.order_id) : nullptr;
+    if (resting) [[unlikely]] {
+        Order amended = *resting;
+        amended.price = src.price;
+        amended.quantity = src.quantity;
+        if (risk_->check(amended, engine_.book().mid_price(), false) != RiskReject::None) {
+            result.reject_reason = GatewayRejectReason::RiskLimit;
+            ++orders_rejected_;
+            HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
+            publish_rejection(src);
+            return result;
+        }
+        participant = resting->participant_id;
+        risk_order_id_ = src.order_id;
+        risk_participant_ = participant;
+    }
+
+    HFT_TRACE_END(TraceStage::GatewayValidate, src.order_id, t_validate);
+
     // Submit to matching engine
-    MatchResult match_result = engine_.modify_order(
-        src.order_id, src.price, src.quantity, src.timestamp);
+    HFT_TRACE_LET(first_event, sequence_num_ + 1);
+    HFT_TRACE_BEGIN(t_match, src.order_id);
+    MatchSummary match_result = engine_.modify_order(
+        src.order_id, src.price, src.quantity, src.timestamp,
+        TradeSink{&OrderGateway::publish_trade, this});
+    risk_order_id_ = 0;
+    HFT_TRACE_END(TraceStage::Match, src.order_id, t_match);
 
     if (match_result.status == MatchStatus::Rejected) {
         result.reject_reason = GatewayRejectReason::OrderNotFound;
@@ -142,7 +388,14 @@ GatewayResult OrderGateway::process_modify(const OrderMessage& msg) noexcept {
     order_copy.price = src.price;
     order_copy.timestamp = src.timestamp;
 
-    decompose_and_publish(match_result, order_copy);
+    HFT_TRACE_BEGIN(t_publish, src.order_id);
+    publish_order_status(match_result, order_copy);
+    finish_update();
+    HFT_TRACE_END_EVENTS(TraceStage::EventPublish, src.order_id, t_publish, first_event,
+                         sequence_num_ + 1 - first_event);
+    if (resting && match_result.remaining_quantity == 0) [[unlikely]] {
+        risk_->on_done(participant);
+    }
 
     result.accepted = true;
     result.match_status = match_result.status;
@@ -159,85 +412,222 @@ GatewayResult OrderGateway::process_modify(const OrderMessage& msg) noexcept {
 // ---------------------------------------------------------------------------
 
 bool OrderGateway::process_cancel(OrderId order_id) noexcept {
+    const Order* resting = risk_ ? engine_.book().find_order(order_id) : nullptr;
+    const ParticipantId participant = resting ? resting->participant_id : 0;
+    HFT_TRACE_BEGIN(t_match, order_id);
     bool success = engine_.cancel_order(order_id);
+    HFT_TRACE_END(TraceStage::Match, order_id, t_match);
+    if (success && resting) [[unlikely]] risk_->on_done(participant);
+    if (!success && throttle_ && throttle_->deferred() != 0) [[unlikely]] {
+        success = throttle_->withdraw(order_id);  // Never reached the book
+    }
 
-    if (success && event_buffer_) {
-        EventMessage event{};
-        event.type = EventType::OrderCancelled;
-        event.instrument_id = instrument_id_;
-        event.sequence_num = next_sequence_num();
+    HFT_TRACE_LET(first_event, sequence_num_ + 1);
+    HFT_TRACE_BEGIN(t_publish, order_id);
+    if (success && publishes()) {
+        EventMessage& event = begin_event(EventType::OrderCancelled);
         event.data.order_event.order_id = order_id;
         event.data.order_event.status = OrderStatus::Cancelled;
         event.data.order_event.filled_quantity = 0;
         event.data.order_event.remaining_quantity = 0;
         event.data.order_event.price = 0;
         event.data.order_event.timestamp = 0;
-        publish_event(event);
+        commit_event();
     }
+    finish_update();
+    HFT_TRACE_END_EVENTS(TraceStage::EventPublish, order_id, t_publish, first_event,
+                         sequence_num_ + 1 - first_event);
+    update_metrics();
 
     return success;
 }
 
+MassCancelResult OrderGateway::process_mass_cancel(ParticipantId participant) noexcept {
+    MassCancelResult result = engine_.mass_cancel(participant);
+    if (risk_) [[unlikely]] risk_->on_done(participant, result.cancelled_count);
+    publish_mass_cancel(participant, 2, result);
+    finish_update();
+    update_metrics();
+    return result;
+}
+
+MassCancelResult OrderGateway::process_mass_cancel(ParticipantId participant,
+                                                   Side side) noexcept {
+    MassCancelResult result = engine_.mass_cancel(participant, side);
+    if (risk_) [[unlikely]] risk_->on_done(participant, result.cancelled_count);
+    publish_mass_cancel(participant, static_cast<uint8_t>(side), result);
+    finish_update();
+    update_metrics();
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Expiry
+// ---------------------------------------------------------------------------
+
+uint32_t OrderGateway::process_time(Timestamp now) noexcept {
+    uint32_t expired =
+        engine_.expire_orders(now, OrderSink{&OrderGateway::publish_expiry, this});
+    if (expired != 0) finish_update();
+    return expired;
+}
+
+// ---------------------------------------------------------------------------
+// Call auction
+// ---------------------------------------------------------------------------
+
+AuctionResult OrderGateway::process_uncross(Timestamp timestamp,
+                                            Price reference_price) noexcept {
+    AuctionResult result = engine_.uncross(
+        timestamp, TradeSink{&OrderGateway::publish_trade, this},
+        reference_price);
+    risk_order_id_ = 0;  // Set by any stop the uncross released
+    finish_update();
+    update_metrics();
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Batch submission
+// ---------------------------------------------------------------------------
+
+GatewayResult OrderGateway::process(const OrderMessage& msg) noexcept {
+    switch (msg.type) {
+        case MessageType::Add:
+            return process_order(msg);
+        case MessageType::Modify:
+            return process_modify(msg);
+        case MessageType::Cancel:
+            break;
+    }
+    process_time(msg.order.timestamp);
+
+    GatewayResult result{};
+    result.accepted = process_cancel(msg.order.order_id);
+    result.reject_reason = result.accepted ? GatewayRejectReason::None
+                                           : GatewayRejectReason::OrderNotFound;
+    result.match_status = result.accepted ? MatchStatus::Cancelled
+                                          : MatchStatus::Rejected;
+    return result;
+}
+
+void OrderGateway::prefetch_far(const OrderMessage& msg) const noexcept {
+    const OrderBook& book = engine_.book();
+    book.prefetch_index(msg.order.order_id);
+    if (msg.type != MessageType::Cancel) {
+        book.prefetch_level(msg.order.side, msg.order.price);
+    }
+}
+
+void OrderGateway::prefetch_near(const OrderMessage& msg) const noexcept {
+    if (msg.type != MessageType::Add) {
+        engine_.book().prefetch_order(msg.order.order_id);
+    }
+}
+
+void OrderGateway::process_batch(const OrderMessage* msgs, size_t count,
+                                 GatewayResult* results) noexcept {
+    constexpr size_t FAR = MatchingEngine::BATCH_PREFETCH_DISTANCE;
+    constexpr size_t NEAR = FAR / 2;
+
+    // Warm-up: the first messages get no lead time from the loop below.
+    for (size_t i = 0; i < count && i < FAR; ++i) prefetch_far(msgs[i]);
+
+    in_batch_ = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + FAR < count) prefetch_far(msgs[i + FAR]);
+        if (i + NEAR < count) prefetch_near(msgs[i + NEAR]);
+        results[i] = process(msgs[i]);
+    }
+    in_batch_ = false;
+    finish_update(false);
+    update_metrics();
+}
+
 // ---------------------------------------------------------------------------
 // Event decomposition
 // ---------------------------------------------------------------------------
 
-void OrderGateway::decompose_and_publish(const MatchResult& result,
-                                          const Order& order_copy) noexcept {
-    if (!event_buffer_) return;
+void OrderGateway::publish_trade(void* context, const Trade& trade) noexcept {
+    auto* self = static_cast<OrderGateway*>(context);
+    if (self->risk_) [[unlikely]] self->track_fill(trade);
+    if (!self->publishes()) return;
 
-    // Trades published first (price-time priority audit trail)
-    for (uint32_t i = 0; i < result.trade_count; ++i) {
-        EventMessage event{};
-        event.type = EventType::Trade;
-        event.instrument_id = instrument_id_;
-        event.sequence_num = next_sequence_num();
-        event.data.trade = result.trades[i];
-        publish_event(event);
+    // Trades precede the terminal status (price-time priority audit trail)
+    EventMessage& event = self->begin_event(EventType::Trade);
+    set_trade(event, trade);
+    self->commit_event();
+}
+
+void OrderGateway::track_fill(const Trade& trade) noexcept {
+    if (trade.has_aggressor() && trade.resting_participant_id != TRADE_PARTICIPANT_UNKNOWN &&
+        trade.aggressor_order_id() == risk_order_id_ && risk_order_id_ != 0) [[likely]] {
+        // The trade names both owners: no book lookup
+        const Side resting_side = (trade.aggressor_side == Side::Buy) ? Side::Sell : Side::Buy;
+        risk_->on_fill(risk_participant_, trade.aggressor_side, trade.quantity);
+        risk_->on_fill(trade.resting_participant_id, resting_side, trade.quantity);
+        if (trade.resting_filled()) risk_->on_done(trade.resting_participant_id);
+        return;
+    }
+    // Auction prints, elected stops and wide participant ids
+    for (Side side : {Side::Buy, Side::Sell}) {
+        const OrderId id = (side == Side::Buy) ? trade.buy_order_id : trade.sell_order_id;
+        if (id == risk_order_id_ && id != 0) {
+            risk_->on_fill(risk_participant_, side, trade.quantity);
+            continue;
+        }
+        const Order* resting = engine_.book().find_order(id);
+        if (!resting) continue;
+        risk_->on_fill(resting->participant_id, side, trade.quantity);
+        if (resting->remaining_quantity() == 0) risk_->on_done(resting->participant_id);
     }
+}
 
-    // Then terminal order status
-    EventMessage event{};
-    event.instrument_id = instrument_id_;
-    event.sequence_num = next_sequence_num();
-    event.data.order_event.order_id = order_copy.order_id;
-    event.data.order_event.filled_quantity = result.filled_quantity;
-    event.data.order_event.remaining_quantity = result.remaining_quantity;
-    event.data.order_event.price = order_copy.price;
-    event.data.order_event.timestamp = order_copy.timestamp;
+void OrderGateway::publish_order_status(const MatchSummary& result,
+                                        const Order& order_copy) noexcept {
+    if (!publishes()) return;
 
+    EventType type = EventType::OrderRejected;
+    OrderStatus status = OrderStatus::Rejected;
     switch (result.status) {
         case MatchStatus::Filled:
-            event.type = EventType::OrderFilled;
-            event.data.order_event.status = OrderStatus::Filled;
+            type = EventType::OrderFilled;
+            status = OrderStatus::Filled;
             break;
         case MatchStatus::PartialFill:
-            event.type = EventType::OrderPartialFill;
-            event.data.order_event.status = OrderStatus::PartialFill;
+            type = EventType::OrderPartialFill;
+            status = OrderStatus::PartialFill;
             break;
         case MatchStatus::Resting:
-            event.type = EventType::OrderAccepted;
-            event.data.order_event.status = OrderStatus::Accepted;
+            type = EventType::OrderAccepted;
+            status = OrderStatus::Accepted;
             break;
         case MatchStatus::Cancelled:
-            event.type = EventType::OrderCancelled;
-            event.data.order_event.status = OrderStatus::Cancelled;
+            type = EventType::OrderCancelled;
+            status = OrderStatus::Cancelled;
             break;
         case MatchStatus::Rejected:
-            event.type = EventType::OrderRejected;
-            event.data.order_event.status = OrderStatus::Rejected;
+            type = EventType::OrderRejected;
+            status = OrderStatus::Rejected;
             break;
         case MatchStatus::SelfTradePrevented:
-            event.type = EventType::OrderCancelled;
-            event.data.order_event.status = OrderStatus::Cancelled;
+            type = EventType::OrderCancelled;
+            status = OrderStatus::Cancelled;
             break;
         case MatchStatus::Modified:
-            event.type = EventType::OrderModified;
-            event.data.order_event.status = OrderStatus::Accepted;
+            type = EventType::OrderModified;
+            status = OrderStatus::Accepted;
             break;
     }
 
-    publish_event(event);
+    EventMessage& event = begin_event(type);
+    event.data.order_event.order_id = order_copy.order_id;
+    event.data.order_event.status = status;
+    event.data.order_event.filled_quantity = result.filled_quantity;
+    event.data.order_event.remaining_quantity = result.remaining_quantity;
+    event.data.order_event.price = order_copy.price;
+    event.data.order_event.timestamp = order_copy.timestamp;
+    commit_event();
 }
 
 // ---------------------------------------------------------------------------
@@ -245,28 +635,194 @@ void OrderGateway::decompose_and_publish(const MatchResult& result,
 // ---------------------------------------------------------------------------
 
 void OrderGateway::publish_rejection(const Order& src) noexcept {
-    if (!event_buffer_) return;
+    if (!publishes()) return;
 
-    EventMessage event{};
-    event.type = EventType::OrderRejected;
-    event.instrument_id = instrument_id_;
-    event.sequence_num = next_sequence_num();
+    EventMessage& event = begin_event(EventType::OrderRejected);
     event.data.order_event.order_id = src.order_id;
     event.data.order_event.status = OrderStatus::Rejected;
     event.data.order_event.filled_quantity = 0;
     event.data.order_event.remaining_quantity = src.quantity;
     event.data.order_event.price = src.price;
     event.data.order_event.timestamp = src.timestamp;
-    publish_event(event);
+    commit_event();
 }
 
-void OrderGateway::publish_event(const EventMessage& event) noexcept {
-    if (!event_buffer_) return;
+void OrderGateway::publish_expiry(void* context, const Order& order) noexcept {
+    auto* self = static_cast<OrderGateway*>(context);
+    if (self->risk_) [[unlikely]] self->risk_->on_done(order.participant_id);
+    if (!self->publishes()) return;
+
+    EventMessage& event = self->begin_event(EventType::OrderExpired);
+    event.data.order_event.order_id = order.order_id;
+    event.data.order_event.status = OrderStatus::Expired;
+    event.data.order_event.filled_quantity = order.filled_quantity;
+    event.data.order_event.remaining_quantity = order.remaining_quantity();
+    event.data.order_event.price = order.price;
+    event.data.order_event.timestamp = order.expire_time;
+    self->commit_event();
+}
 
-    while (!event_buffer_->try_push(event)) {
+void OrderGateway::publish_mass_cancel(ParticipantId participant, uint8_t side,
+                                       const MassCancelResult& result) noexcept {
+    if (!publishes() || result.cancelled_count == 0) return;
+
+    EventMessage& event = begin_event(EventType::MassCancel);
+    event.data.mass_cancel.participant_id = participant;
+    event.data.mass_cancel.side = side;
+    event.data.mass_cancel.cancelled_count = result.cancelled_count;
+    event.data.mass_cancel.cancelled_quantity = result.cancelled_quantity;
+    commit_event();
+}
+
+void OrderGateway::publish_metrics() noexcept {
+    GatewayMetrics& m = *metrics_;
+    m.orders_processed.set(orders_processed_);
+    m.orders_rejected.set(orders_rejected_);
+    m.events_published.set(sequence_num_);
+    m.backpressure.set(backpressure_count_);
+    m.events_spilled.set(events_spilled_);
+    m.events_dropped.set(events_dropped_);
+    m.pool_in_use.set(static_cast<int64_t>(pool_.size()));
+    m.pool_high_water.set(static_cast<int64_t>(pool_.high_water_mark()));
+    m.overflow_pending.set(static_cast<int64_t>(overflow_.live()));
+}
+
+void OrderGateway::publish_level_deltas() noexcept {
+    // Drain in stack-sized chunks; without a buffer the journal is just
+    // emptied so it cannot fill up.
+    LevelDelta deltas[64];
+    size_t n;
+    while ((n = engine_.take_level_deltas(deltas, 64)) != 0) {
+        if (!publishes()) continue;
+        for (size_t i = 0; i < n; ++i) {
+            EventMessage& event = begin_event(EventType::LevelUpdate);
+            event.data.level_update.price = deltas[i].price;
+            event.data.level_update.total_quantity = deltas[i].total_quantity;
+            event.data.level_update.order_count = deltas[i].order_count;
+            event.data.level_update.side = static_cast<uint8_t>(deltas[i].side);
+            commit_event();
+        }
+    }
+}
+
+void OrderGateway::publish_digest() noexcept {
+    digest_due_ = digest_every_;
+    if (!publishes()) return;
+    const OrderBook& book = engine_.book();
+    const PriceLevel* bid = book.best_bid();
+    const PriceLevel* ask = book.best_ask();
+    EventMessage& event = begin_event(EventType::BookDigest);
+    event.data.book_digest = BookDigestEventData{};
+    event.data.book_digest.digest = book.state_digest();
+    event.data.book_digest.order_count = book.order_count();
+    event.data.book_digest.best_bid = bid ? bid->price : 0;
+    event.data.book_digest.best_ask = ask ? ask->price : 0;
+    commit_event();
+}
+
+// ---------------------------------------------------------------------------
+// Event publication and backpressure
+// ---------------------------------------------------------------------------
+
+EventMessage& OrderGateway::begin_event(EventType type) noexcept {
+    EventMessage* slot;
+    if (!overflow_.empty()) [[unlikely]] {
+        (void)drain_overflow();
+    }
+    if (packed_buffer_) [[unlikely]] {
+        slot = &scratch_;  // Encoded into the ring by commit_event()
+        target_ = EventTarget::Packed;
+    } else if (!overflow_.empty()) [[unlikely]] {
         ++backpressure_count_;
-        // Spin-wait — backpressure from slow consumer
+        slot = &scratch_;  // Queued behind the backlog to keep the order
+        target_ = EventTarget::Overflow;
+    } else if ((slot = event_buffer_->claim()) != nullptr) [[likely]] {
+        target_ = EventTarget::InPlace;
+    } else {
+        slot = claim_under_backpressure();
+    }
+    *slot = EventMessage{};
+    slot->type = type;
+    slot->instrument_id = instrument_id_;
+    slot->sequence_num = next_sequence_num();
+    return *slot;
+}
+
+EventMessage* OrderGateway::claim_under_backpressure() noexcept {
+    ++backpressure_count_;
+    if (backpressure_.policy != BackpressurePolicy::Block) {
+        target_ = EventTarget::Overflow;
+        return &scratch_;
+    }
+    // Spin-wait — backpressure from slow consumer
+    EventMessage* slot = nullptr;
+    if (spin_until([&] { return (slot = event_buffer_->claim()) != nullptr; },
+                   backpressure_.block_timeout_ns, backpressure_ns_)) {
+        target_ = EventTarget::InPlace;
+        return slot;
+    }
+    target_ = EventTarget::Drop;
+    return &scratch_;
+}
+
+void OrderGateway::commit_scratch_event() noexcept {
+    switch (target_) {
+        case EventTarget::InPlace:
+            event_buffer_->commit();
+            break;
+        case EventTarget::Packed:
+            if (overflow_.empty() && packed_buffer_->try_push(scratch_)) [[likely]] {
+                break;
+            }
+            ++backpressure_count_;
+            if (backpressure_.policy != BackpressurePolicy::Block) {
+                spill_scratch_event();
+            } else if (!spin_until([this] { return packed_buffer_->try_push(scratch_); },
+                                   backpressure_.block_timeout_ns, backpressure_ns_)) {
+                ++events_dropped_;
+            }
+            break;
+        case EventTarget::Overflow:
+            spill_scratch_event();
+            break;
+        case EventTarget::Drop:
+            ++events_dropped_;
+            break;
+    }
+    target_ = EventTarget::InPlace;
+}
+
+void OrderGateway::spill_scratch_event() noexcept {
+    if (backpressure_.policy == BackpressurePolicy::Conflate &&
+        overflow_.conflate(scratch_, backpressure_.conflate_window)) {
+        ++events_conflated_;
+    }
+    if (overflow_.full()) [[unlikely]] {
+        // Arena exhausted too: wait for the consumer rather than lose events
+        (void)spin_until([this] { (void)drain_overflow(); return !overflow_.full(); },
+                         0, backpressure_ns_);
+    }
+    overflow_.push(scratch_);
+    ++events_spilled_;
+    overflow_high_water_ = std::max(overflow_high_water_, overflow_.live());
+    (void)drain_overflow();
+}
+
+bool OrderGateway::try_publish(const EventMessage& event) noexcept {
+    if (packed_buffer_) return packed_buffer_->try_push(event);
+    EventMessage* slot = event_buffer_->claim();
+    if (!slot) return false;
+    *slot = event;
+    event_buffer_->commit();
+    return true;
+}
+
+size_t OrderGateway::drain_overflow() noexcept {
+    while (const EventMessage* event = overflow_.front()) {
+        if (!try_publish(*event)) break;
+        overflow_.pop();
     }
+    return overflow_.live();
 }
 
 uint64_t OrderGateway::next_sequence_num() noexcept {
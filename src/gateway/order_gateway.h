@@ -2,31 +2,79 @@
 
 /// @file order_gateway.h
 /// @brief Order ingestion gateway — validates, submits to matching engine,
-///        decomposes results into EventMessages for the SPSC event buffer.
+///        streams fills and order status as EventMessages into the SPSC
+///        event buffer.
 ///
 /// Cold-path library. Sits on Thread 1 (the matching thread) but uses
 /// std::function-free, allocation-free logic. The event buffer pointer
 /// is nullable for testing without a publisher.
+///
+/// When the book journals level changes (OrderBookOptions::level_deltas),
+/// each call also publishes LevelUpdate events after its order events;
+/// process_batch publishes them once, after the last message, so a
+/// conflated journal yields one update per changed level per batch.
+///
+/// set_packed_event_buffer() switches the gateway to the compact encoding:
+/// events are built in a scratch slot and published into a
+/// PackedEventBuffer instead of the EventBuffer.
+///
+/// set_backpressure() chooses what happens when the ring is full (see
+/// event_overflow.h): spin, optionally dropping after a timeout; spill to
+/// an overflow arena drained in order; or spill and conflate order-state
+/// events. Events are built in place in the ring while it has room; only
+/// events that meet a full ring or a backlog go through a scratch copy.
+///
+/// set_risk() attaches pre-trade risk limits (see pre_trade_risk.h): adds
+/// and modifies are checked before they reach the engine, and the
+/// participant's open-order count and position are updated from the
+/// outcome. Without one the path costs a single predictable branch.
+///
+/// set_throttle() attaches token-bucket message-rate limits (see
+/// message_throttle.h), checked before validation: over-limit adds and
+/// modifies are rejected or deferred and released as credit returns.
+///
+/// set_quote_snapshot() publishes the book's BBO and top levels into a
+/// seqlock slot (see quote_snapshot.h) at the end of every call, or once
+/// per process_batch, for readers on other threads.
+///
+/// set_metrics() publishes the gateway's counters and pool occupancy into
+/// a shared-memory MetricsRegion (see metrics_region.h) at the same points:
+/// a handful of relaxed stores per call or batch.
+///
+/// set_digest_every() stamps the book's state digest (see book_digest.h)
+/// into the event stream as a BookDigest event after every Nth call,
+/// counted per message inside a batch too, so replicas fed the same
+/// messages stamp at the same sequence numbers whatever their batching
+/// (unless level updates, which batching does move, are published).
 
 #include <cstdint>
 
 #include "core/order.h"
 #include "core/types.h"
+#include "gateway/event_overflow.h"
+#include "gateway/message_throttle.h"
+#include "gateway/pre_trade_risk.h"
 #include "matching/match_result.h"
 #include "matching/matching_engine.h"
 #include "orderbook/memory_pool.h"
+#include "orderbook/quote_snapshot.h"
 #include "transport/event_buffer.h"
 #include "transport/message.h"
+#include "transport/packed_event_buffer.h"
 
 namespace hft {
 
+struct GatewayMetrics;
+
 /// Reason the gateway rejected an order before it reached the engine.
 enum class GatewayRejectReason : uint8_t {
     None,
     InvalidPrice,
     InvalidQuantity,
     PoolExhausted,
-    OrderNotFound
+    OrderNotFound,
+    RiskLimit,      // Failed a pre-trade risk check (PreTradeRisk::rejects)
+    Throttled       // Over a message-rate limit (MessageThrottle)
 };
 
 /// Lightweight result returned to the caller of process_order().
@@ -38,12 +86,15 @@ struct GatewayResult {
     uint32_t trade_count;
     Quantity filled_quantity;
     Quantity remaining_quantity;
+    bool deferred;  // Throttled and queued: processed later, events follow then
 };
 
 class OrderGateway {
 public:
     /// @param engine        Matching engine to forward validated orders to.
-    /// @param pool          Memory pool for Order allocation.
+    /// @param pool          Memory pool for Order allocation. A pool with
+    ///                      colour lists (PoolLocality) is given each
+    ///                      order's level index as its hint.
     /// @param event_buffer  Nullable — if nullptr, no events are published.
     /// @param instrument_id Instrument this gateway serves (default: 0).
     OrderGateway(MatchingEngine& engine, MemoryPool<Order>& pool,
@@ -53,6 +104,75 @@ public:
     OrderGateway(const OrderGateway&) = delete;
     OrderGateway& operator=(const OrderGateway&) = delete;
 
+    /// Publish into `packed` (compact encoding) instead of the event
+    /// buffer; nullptr switches back. Call before traffic.
+    void set_packed_event_buffer(PackedEventBuffer* packed) noexcept {
+        packed_buffer_ = packed;
+    }
+
+    /// Full-ring behaviour (default: spin forever). Allocates the overflow
+    /// arena for Spill / Conflate; call before traffic.
+    void set_backpressure(const BackpressureConfig& config);
+    [[nodiscard]] const BackpressureConfig& backpressure() const noexcept {
+        return backpressure_;
+    }
+
+    /// Check adds and modifies against `risk` and keep its per-participant
+    /// state current (nullptr detaches). Call before traffic. A stop counts
+    /// as an open order once it is elected and rests on the book.
+    void set_risk(PreTradeRisk* risk) noexcept;
+    [[nodiscard]] PreTradeRisk* risk() const noexcept { return risk_; }
+
+    /// Rate-limit adds and modifies with `throttle` (nullptr detaches).
+    /// Call before traffic.
+    void set_throttle(MessageThrottle* throttle) noexcept { throttle_ = throttle; }
+    [[nodiscard]] MessageThrottle* throttle() const noexcept { return throttle_; }
+
+    /// Publish BBO and depth into `slot` after every call / batch that
+    /// changes them (nullptr detaches). Call before traffic.
+    void set_quote_snapshot(QuoteSnapshotSlot* slot) noexcept { quote_snapshot_ = slot; }
+    [[nodiscard]] QuoteSnapshotSlot* quote_snapshot() const noexcept { return quote_snapshot_; }
+
+    /// Publish counters into `metrics` after every call / batch (nullptr
+    /// detaches). Call before traffic, from the gateway's thread.
+    void set_metrics(GatewayMetrics* metrics) noexcept {
+        metrics_ = metrics;
+        if (metrics_) publish_metrics();
+    }
+    [[nodiscard]] GatewayMetrics* metrics() const noexcept { return metrics_; }
+
+    /// Publish a BookDigest event after every `calls` calls that reach the
+    /// engine (adds and modifies past validation, cancels, mass cancels,
+    /// uncrosses, time steps that expire orders); 0 turns stamping off.
+    /// The book must maintain its digest (OrderBookOptions::state_digest
+    /// or OrderBook::enable_state_digest()).
+    void set_digest_every(uint64_t calls) noexcept {
+        digest_every_ = calls;
+        digest_due_ = calls;
+    }
+    [[nodiscard]] uint64_t digest_every() const noexcept { return digest_every_; }
+
+    /// Process deferred messages whose buckets have credit again (also
+    /// done before every throttled add or modify while any are deferred).
+    /// Call while idle so deferred messages do not wait for new traffic.
+    /// @return messages released.
+    size_t release_throttled() noexcept;
+
+    /// Move spilled events into the ring while it has room (also done
+    /// before every new event). Call while idle so a backlog does not sit
+    /// in the arena. @return events still pending.
+    size_t drain_overflow() noexcept;
+    [[nodiscard]] size_t pending_overflow() const noexcept { return overflow_.live(); }
+
+    /// Idle-time upkeep that is never done while processing a message: map
+    /// the order pool's next spare segment once allocation has adopted the
+    /// last one (growable pools, see MemoryPool::grow()), and prepare,
+    /// release and purge the book's order-id tables
+    /// (OrderBook::maintain_index). Call while idle, like drain_overflow().
+    /// Until then, a pool that runs dry again rejects adds.
+    /// @return true if any work was done.
+    bool maintain() noexcept;
+
     /// Validate an inbound order, submit to the matching engine, and
     /// publish decomposed EventMessages to the event buffer.
     [[nodiscard]] GatewayResult process_order(const OrderMessage& msg) noexcept;
@@ -60,36 +180,215 @@ public:
     /// Cancel an order by ID. Publishes OrderCancelled if successful.
     [[nodiscard]] bool process_cancel(OrderId order_id) noexcept;
 
+    /// Cancel every resting order of `participant` (optionally one side
+    /// only). Publishes a single MassCancel event if any order was removed,
+    /// not one OrderCancelled per order.
+    MassCancelResult process_mass_cancel(ParticipantId participant) noexcept;
+    MassCancelResult process_mass_cancel(ParticipantId participant,
+                                         Side side) noexcept;
+
     /// Modify a resting order's price and/or quantity. Publishes
     /// OrderModified, plus Trade/OrderFilled events if the new price crosses.
     [[nodiscard]] GatewayResult process_modify(const OrderMessage& msg) noexcept;
 
+    /// Advance the engine's expiry clock to `now`, publishing OrderExpired
+    /// for every DAY/GTD order it removes. process_order / process_modify
+    /// and batched cancels call this with the message timestamp, so replay
+    /// time drives expiry by itself; call it directly to expire on wall
+    /// time while no messages arrive. Returns the number expired.
+    uint32_t process_time(Timestamp now) noexcept;
+
+    /// Uncross a call auction started with engine.begin_auction(): executes
+    /// at the equilibrium price and publishes one Trade event per fill.
+    AuctionResult process_uncross(Timestamp timestamp,
+                                  Price reference_price = 0) noexcept;
+
+    /// Process msgs[0..count) strictly in order, dispatching on msg.type
+    /// (Add / Cancel / Modify), and write results[i] for each. A cancel
+    /// reports accepted=true with MatchStatus::Cancelled, or OrderNotFound.
+    /// Index slots and level heads are prefetched a few messages ahead, and
+    /// resting orders targeted by cancels/modifies half as far ahead.
+    void process_batch(const OrderMessage* msgs, size_t count,
+                       GatewayResult* results) noexcept;
+
+    /// Issue the far-stage prefetches for a message that will be processed
+    /// shortly (index slot and level head).
+    void prefetch_far(const OrderMessage& msg) const noexcept;
+
+    /// Issue the near-stage prefetch (the resting order a cancel/modify
+    /// targets). Its index slot should already be in flight via prefetch_far.
+    void prefetch_near(const OrderMessage& msg) const noexcept;
+
+    /// Process one message of any type (the per-message step of
+    /// process_batch).
+    [[nodiscard]] GatewayResult process(const OrderMessage& msg) noexcept;
+
     [[nodiscard]] uint64_t orders_processed() const noexcept { return orders_processed_; }
     [[nodiscard]] uint64_t orders_rejected() const noexcept { return orders_rejected_; }
     [[nodiscard]] uint64_t sequence_number() const noexcept { return sequence_num_; }
+    [[nodiscard]] InstrumentId instrument_id() const noexcept { return instrument_id_; }
+
+    /// Snapshot restore: continue event sequence numbers and counters from
+    /// a saved session.
+    void restore_counters(uint64_t sequence_num, uint64_t orders_processed,
+                          uint64_t orders_rejected) noexcept {
+        sequence_num_ = sequence_num;
+        orders_processed_ = orders_processed;
+        orders_rejected_ = orders_rejected;
+    }
+    /// Events that found the ring full (or behind a backlog).
     [[nodiscard]] uint64_t backpressure_count() const noexcept { return backpressure_count_; }
+    /// Time spent spinning on a full ring.
+    [[nodiscard]] uint64_t backpressure_ns() const noexcept { return backpressure_ns_; }
+    [[nodiscard]] uint64_t events_spilled() const noexcept { return events_spilled_; }
+    [[nodiscard]] uint64_t events_conflated() const noexcept { return events_conflated_; }
+    /// Block with a timeout: events given up on.
+    [[nodiscard]] uint64_t events_dropped() const noexcept { return events_dropped_; }
+    /// Most events the overflow arena has held at once.
+    [[nodiscard]] size_t overflow_high_water() const noexcept { return overflow_high_water_; }
+
+    /// The backpressure overflow arena; high-water = overflow_high_water()
+    /// events. Cold path.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage = overflow_.memory_usage();
+        usage.high_water_bytes = overflow_high_water_ * EventOverflowArena::EVENT_BYTES;
+        return usage;
+    }
 
 private:
-    /// Spin-wait push to the event buffer.
-    void publish_event(const EventMessage& event) noexcept;
+    /// process_order / process_modify past the throttle.
+    [[nodiscard]] GatewayResult submit_add(const OrderMessage& msg) noexcept;
+    [[nodiscard]] GatewayResult submit_modify(const OrderMessage& msg) noexcept;
+
+    /// True if `msg` may proceed now; otherwise fills `result` as
+    /// rejected or deferred.
+    [[nodiscard]] bool pass_throttle(const OrderMessage& msg, GatewayResult& result) noexcept;
+
+    /// End of a call or batch (nothing while a batch is in progress):
+    /// publish journalled level changes as LevelUpdate events and refresh
+    /// the quote snapshot. `message` is false for the end of a batch, which
+    /// does not count towards digest stamps (its messages did).
+    void finish_update(bool message = true) noexcept {
+        if (digest_every_ != 0 && message) [[unlikely]] {
+            if (--digest_due_ == 0) publish_digest();
+        }
+        if (in_batch_) return;
+        if (engine_.book().pending_level_deltas() != 0) [[unlikely]] {
+            publish_level_deltas();
+        }
+        if (quote_snapshot_) [[unlikely]] {
+            quote_snapshot_->publish(engine_.book(), engine_.last_trade_price());
+        }
+    }
+    void publish_level_deltas() noexcept;
+    void publish_digest() noexcept;
+
+    /// End of a public call or batch, its counters final: refresh metrics.
+    void update_metrics() noexcept {
+        if (metrics_ && !in_batch_) [[unlikely]] publish_metrics();
+    }
+    void publish_metrics() noexcept;
+
+    /// Whether events are published at all.
+    [[nodiscard]] bool publishes() const noexcept {
+        return event_buffer_ != nullptr || packed_buffer_ != nullptr;
+    }
+
+    /// Where the event being built goes on commit_event().
+    enum class EventTarget : uint8_t {
+        InPlace,   // Claimed EventBuffer slot
+        Packed,    // Scratch, encoded into packed_buffer_
+        Overflow,  // Scratch, queued behind the backlog
+        Drop       // Scratch, Block timed out
+    };
+
+    /// Claim the next event buffer slot (or the scratch slot, see
+    /// EventTarget) and stamp its header; the caller fills `data` in
+    /// place, then calls commit_event(). publishes() must hold.
+    [[nodiscard]] EventMessage& begin_event(EventType type) noexcept;
+    void commit_event() noexcept {
+        if (target_ == EventTarget::InPlace) [[likely]] {
+            event_buffer_->commit();
+        } else {
+            commit_scratch_event();
+        }
+    }
+    void commit_scratch_event() noexcept;
+
+    /// Slow path of begin_event(): the event buffer is full.
+    [[nodiscard]] EventMessage* claim_under_backpressure() noexcept;
+
+    /// Non-blocking publish of a finished event into the active ring.
+    [[nodiscard]] bool try_publish(const EventMessage& event) noexcept;
+
+    /// Queue the scratch event in the arena (conflating if configured),
+    /// spinning on the ring while the arena is full.
+    void spill_scratch_event() noexcept;
 
     /// Publish an OrderRejected event for a gateway-level rejection.
     void publish_rejection(const Order& src) noexcept;
 
-    /// Decompose a MatchResult into Trade + order status EventMessages.
-    void decompose_and_publish(const MatchResult& result,
-                               const Order& order_copy) noexcept;
+    /// MassCancel event for a sweep of `participant` (side 2 = both).
+    void publish_mass_cancel(ParticipantId participant, uint8_t side,
+                             const MassCancelResult& result) noexcept;
+
+    /// Risk state for one fill: the order being submitted is known; the
+    /// resting side is looked up in the book (still linked at this point).
+    void track_fill(const Trade& trade) noexcept;
+
+    /// OrderSink callback: publish OrderExpired for an expired order.
+    static void publish_expiry(void* context, const Order& order) noexcept;
+
+    /// OrderSink callback: an elected stop is about to be submitted; its
+    /// fills go to its owner.
+    static void track_stop_release(void* context, const Order& order) noexcept;
+
+    /// OrderSink callback: an elected stop now rests on the book.
+    static void count_stop_rest(void* context, const Order& order) noexcept;
+
+    /// OrderSink callback: self-trade prevention cancelled a resting order.
+    static void count_stp_cancel(void* context, const Order& order) noexcept;
+
+    /// TradeSink callback: publish one Trade EventMessage as the engine
+    /// executes it (context = this gateway).
+    static void publish_trade(void* context, const Trade& trade) noexcept;
+
+    /// Publish the terminal order status event after matching. Trades have
+    /// already been streamed by publish_trade().
+    void publish_order_status(const MatchSummary& summary,
+                              const Order& order_copy) noexcept;
 
     [[nodiscard]] uint64_t next_sequence_num() noexcept;
 
     MatchingEngine& engine_;
     MemoryPool<Order>& pool_;
+    bool pool_localized_;  // Pool has colour lists: allocate by level index
     EventBuffer* event_buffer_;
+    PackedEventBuffer* packed_buffer_;
     InstrumentId instrument_id_;
     uint64_t sequence_num_;
     uint64_t orders_processed_;
     uint64_t orders_rejected_;
     uint64_t backpressure_count_;
+    uint64_t backpressure_ns_;
+    uint64_t events_spilled_;
+    uint64_t events_conflated_;
+    uint64_t events_dropped_;
+    size_t overflow_high_water_;
+    bool in_batch_;  // process_batch: defer level updates to its end
+    EventTarget target_;
+    BackpressureConfig backpressure_;
+    EventOverflowArena overflow_;
+    EventMessage scratch_;  // Event being built when target_ != InPlace
+    PreTradeRisk* risk_;
+    OrderId risk_order_id_;          // Order being submitted / modified
+    ParticipantId risk_participant_; // Its participant
+    OrderId risk_rest_order_;        // New order not yet counted by on_rest
+    MessageThrottle* throttle_;
+    QuoteSnapshotSlot* quote_snapshot_;
+    GatewayMetrics* metrics_;
+    uint64_t digest_every_;  // Calls between BookDigest stamps (0 = off)
+    uint64_t digest_due_;    // Calls left until the next stamp
 };
 
 }  // namespace hft
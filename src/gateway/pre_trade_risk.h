@@ -0,0 +1,186 @@
+#pragma once
+
+/// @file pre_trade_risk.h
+/// @brief Per-participant pre-trade risk limits checked by the OrderGateway
+///        before an order reaches the matching engine.
+///
+/// Zero heap allocation after construction. One cache-line Account per
+/// participant, in a flat array indexed by ParticipantId, holds the limits
+/// and the running state they are checked against, so a check is one
+/// indexed load and a handful of compares:
+///
+///   max_order_quantity  order size
+///   max_order_notional  price x quantity (in price units), market orders
+///                       valued at the reference price
+///   price_band_bps      limit price within this many basis points of the
+///                       reference price (the book mid; skipped while one
+///                       side is empty)
+///   max_open_orders     resting orders of the participant
+///   max_position        |net filled position| if the order fills in full
+///
+/// Zero disables a limit. The gateway keeps the running state up to date
+/// incrementally: open orders from rests, cancels, expiries, mass cancels
+/// and fills that take a resting order out; positions from every fill.
+/// Participants beyond RiskConfig::max_participants are rejected outright.
+///
+/// One PreTradeRisk serves one gateway (positions are per instrument).
+/// Attach with OrderGateway::set_risk(); rejections carry
+/// GatewayRejectReason::RiskLimit and are counted here by cause.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/order.h"
+#include "core/types.h"
+#include "core/uint128.h"
+
+namespace hft {
+
+struct RiskLimits {
+    Quantity max_order_quantity = 0;
+    uint64_t max_order_notional = 0;
+    uint32_t max_open_orders = 0;
+    uint32_t price_band_bps = 0;
+    Quantity max_position = 0;
+};
+
+struct RiskConfig {
+    RiskLimits limits;               // Every participant's until set_limits()
+    size_t max_participants = 1024;  // Accounts in the flat array
+};
+
+/// Why a check failed.
+enum class RiskReject : uint8_t {
+    None,
+    OrderQuantity,
+    OrderNotional,
+    PriceBand,
+    OpenOrders,
+    Position,
+    UnknownParticipant,
+    Count_
+};
+
+class PreTradeRisk {
+public:
+    explicit PreTradeRisk(const RiskConfig& config)
+        : capacity_(config.max_participants),
+          accounts_(std::make_unique<Account[]>(config.max_participants)) {
+        for (size_t i = 0; i < capacity_; ++i) accounts_[i].limits = config.limits;
+    }
+
+    PreTradeRisk(const PreTradeRisk&) = delete;
+    PreTradeRisk& operator=(const PreTradeRisk&) = delete;
+
+    /// Override the limits of one participant. Returns false if out of range.
+    bool set_limits(ParticipantId participant, const RiskLimits& limits) noexcept {
+        if (participant >= capacity_) return false;
+        accounts_[participant].limits = limits;
+        return true;
+    }
+
+    /// Check `order` against its participant's limits. `reference` values
+    /// market orders and centres the price band (0 = none). `new_order`
+    /// also applies the open-order limit (not for modifies). Counts a
+    /// failure under its cause.
+    [[nodiscard]] RiskReject check(const Order& order, Price reference,
+                                   bool new_order = true) noexcept {
+        const RiskReject reason = evaluate(order, reference, new_order);
+        if (reason != RiskReject::None) [[unlikely]] {
+            ++rejects_[static_cast<size_t>(reason)];
+        }
+        return reason;
+    }
+
+    // --- State updates (from the gateway) ---
+
+    /// An order of `participant` now rests on the book.
+    void on_rest(ParticipantId participant) noexcept {
+        if (participant < capacity_) ++accounts_[participant].open_orders;
+    }
+
+    /// `count` resting orders of `participant` left the book.
+    void on_done(ParticipantId participant, uint32_t count = 1) noexcept {
+        if (participant >= capacity_) return;
+        uint32_t& open = accounts_[participant].open_orders;
+        open = (count < open) ? open - count : 0;
+    }
+
+    /// `participant` bought (Side::Buy) or sold `quantity`.
+    void on_fill(ParticipantId participant, Side side, Quantity quantity) noexcept {
+        if (participant >= capacity_) return;
+        const auto q = static_cast<int64_t>(quantity);
+        accounts_[participant].position += (side == Side::Buy) ? q : -q;
+    }
+
+    // --- Introspection ---
+
+    [[nodiscard]] int64_t position(ParticipantId participant) const noexcept {
+        return participant < capacity_ ? accounts_[participant].position : 0;
+    }
+    [[nodiscard]] uint32_t open_orders(ParticipantId participant) const noexcept {
+        return participant < capacity_ ? accounts_[participant].open_orders : 0;
+    }
+    [[nodiscard]] uint64_t rejects(RiskReject reason) const noexcept {
+        return rejects_[static_cast<size_t>(reason)];
+    }
+    [[nodiscard]] size_t max_participants() const noexcept { return capacity_; }
+
+private:
+    struct alignas(64) Account {
+        RiskLimits limits;
+        int64_t position = 0;     // Net filled quantity (buys positive)
+        uint32_t open_orders = 0;
+    };
+    static_assert(sizeof(Account) == 64, "One cache line per participant");
+
+    [[nodiscard]] RiskReject evaluate(const Order& order, Price reference,
+                                      bool new_order) const noexcept {
+        if (order.participant_id >= capacity_) [[unlikely]] {
+            return RiskReject::UnknownParticipant;
+        }
+        const Account& a = accounts_[order.participant_id];
+        const RiskLimits& l = a.limits;
+
+        if (l.max_order_quantity != 0 && order.quantity > l.max_order_quantity) {
+            return RiskReject::OrderQuantity;
+        }
+
+        const bool priced = order.type != OrderType::Market && order.type != OrderType::Stop;
+        const Price price = priced ? order.price : reference;
+        if (l.max_order_notional != 0 && price > 0) {
+            if (mul_div_exceeds(static_cast<uint64_t>(price), order.quantity,
+                                static_cast<uint64_t>(PRICE_SCALE), l.max_order_notional)) {
+                return RiskReject::OrderNotional;
+            }
+        }
+
+        if (l.price_band_bps != 0 && priced && reference > 0) {
+            const Price distance = (order.price > reference) ? order.price - reference
+                                                             : reference - order.price;
+            if (mul_greater(static_cast<uint64_t>(distance), 10000,
+                            static_cast<uint64_t>(reference), l.price_band_bps)) {
+                return RiskReject::PriceBand;
+            }
+        }
+
+        if (new_order && l.max_open_orders != 0 && a.open_orders >= l.max_open_orders) {
+            return RiskReject::OpenOrders;
+        }
+
+        if (l.max_position != 0) {
+            const auto q = static_cast<int64_t>(order.quantity);
+            const int64_t after = a.position + ((order.side == Side::Buy) ? q : -q);
+            const auto magnitude = static_cast<Quantity>(after < 0 ? -after : after);
+            if (magnitude > l.max_position) return RiskReject::Position;
+        }
+        return RiskReject::None;
+    }
+
+    size_t capacity_;
+    std::unique_ptr<Account[]> accounts_;
+    uint64_t rejects_[static_cast<size_t>(RiskReject::Count_)] = {};
+};
+
+}  // namespace hft
@@ -0,0 +1,302 @@
+#include "gateway/sharded_router.h"
+
+#include <algorithm>
+
+namespace hft {
+
+namespace {
+
+/// Ordering key of an event for merge(): the timestamp of the order that
+/// caused it. Events without one (mass cancels, level updates, digests) and clocks
+/// that step back keep the shard's previous key, so keys never decrease
+/// within a shard.
+Timestamp event_key(const EventMessage& event, Timestamp last) noexcept {
+    Timestamp ts = 0;
+    switch (event.type) {
+        case EventType::Trade:
+            ts = event.data.trade.timestamp;
+            break;
+        case EventType::LevelUpdate:
+        case EventType::MassCancel:
+        case EventType::BookDigest:
+            break;
+        default:
+            ts = event.data.order_event.timestamp;
+            break;
+    }
+    return ts > last ? ts : last;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Construction / Destruction
+// ---------------------------------------------------------------------------
+
+ShardedRouter::ShardedRouter(const InstrumentRegistry& registry,
+                             const ShardedRouterConfig& config)
+    : config_(config) {
+    if (config_.num_shards == 0) config_.num_shards = 1;
+    if (config_.drain_batch == 0) config_.drain_batch = 1;
+
+    std::vector<std::vector<const InstrumentConfig*>> members;
+    assign(registry, members);
+
+    InstrumentId max_id = 0;
+    for (const auto& cfg : registry.instruments()) {
+        max_id = std::max(max_id, cfg.instrument_id);
+    }
+    id_to_shard_.assign(static_cast<size_t>(max_id) + 1, INVALID_SHARD);
+
+    shards_.reserve(config_.num_shards);
+    for (size_t s = 0; s < config_.num_shards; ++s) {
+        auto shard = std::make_unique<Shard>();
+        for (const InstrumentConfig* cfg : members[s]) {
+            shard->registry.register_instrument(*cfg);
+            id_to_shard_[cfg->instrument_id] = s;
+            shard->load += cfg->expected_load;
+        }
+        shard->events = std::make_unique<EventBuffer>();
+        if (!config_.merged_stream) {
+            shard->events->remove_consumer(EventBuffer::PRIMARY);
+        }
+        shard->ingress = std::make_unique<IngressBuffer>();
+        if (config_.worker_wait.strategy == WaitStrategy::Block) {
+            shard->ingress->set_wakeup(&shard->ingress_signal);
+        }
+        shard->waiter = Waiter(config_.worker_wait, shard->ingress->wakeup());
+        shard->router = std::make_unique<InstrumentRouter>(
+            shard->registry, shard->events.get(), config_.shared_pool);
+        shard->index = s;
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ShardedRouter::~ShardedRouter() {
+    stop();
+}
+
+void ShardedRouter::assign(
+    const InstrumentRegistry& registry,
+    std::vector<std::vector<const InstrumentConfig*>>& out) const {
+    const size_t n = config_.num_shards;
+    out.assign(n, {});
+    const auto& instruments = registry.instruments();
+
+    if (config_.assignment == ShardAssignment::RoundRobin) {
+        for (size_t i = 0; i < instruments.size(); ++i) {
+            out[i % n].push_back(&instruments[i]);
+        }
+        return;
+    }
+
+    // Longest-processing-time first: heaviest instrument onto the
+    // currently lightest shard. Ties keep registration order.
+    std::vector<const InstrumentConfig*> order;
+    order.reserve(instruments.size());
+    for (const auto& cfg : instruments) order.push_back(&cfg);
+    std::stable_sort(order.begin(), order.end(),
+                     [](const InstrumentConfig* a, const InstrumentConfig* b) {
+                         return a->expected_load > b->expected_load;
+                     });
+    std::vector<double> load(n, 0.0);
+    for (const InstrumentConfig* cfg : order) {
+        size_t lightest = static_cast<size_t>(
+            std::min_element(load.begin(), load.end()) - load.begin());
+        out[lightest].push_back(cfg);
+        load[lightest] += cfg->expected_load;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+void ShardedRouter::start() {
+    if (running_) return;
+    stop_requested_.store(false, std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+        Shard* s = shard.get();
+        s->worker = std::thread([this, s] { run_worker(*s); });
+    }
+    running_ = true;
+}
+
+void ShardedRouter::stop() {
+    if (!running_) return;
+    stop_requested_.store(true, std::memory_order_release);
+    for (auto& shard : shards_) {
+        shard->ingress_signal.notify();  // Wake a blocked worker
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+    running_ = false;
+}
+
+void ShardedRouter::run_worker(Shard& shard) noexcept {
+    ScopedThreadPlacement placement(config_.threading, ThreadRole::Matching,
+                                    shard.index);
+    const size_t batch = config_.drain_batch;
+    auto ready = [this, &shard] {
+        return !shard.ingress->empty() ||
+               stop_requested_.load(std::memory_order_acquire);
+    };
+    // Messages whose events still sit in a gateway's overflow arena are
+    // counted as processed only once it drains, so merge() never sees a
+    // shard as caught up while it holds back earlier events.
+    uint64_t uncounted = 0;
+    auto count = [&shard, &uncounted](size_t pending) {
+        if (pending == 0 && uncounted != 0) {
+            // Release: the events published for these messages are visible
+            // to whoever sees the count.
+            shard.processed.fetch_add(uncounted, std::memory_order_release);
+            uncounted = 0;
+        }
+    };
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        size_t n = shard.router->drain(*shard.ingress, batch, config_.count_outcomes);
+        if (n == 0) {
+            // Deferred messages go out once credit returns, not with the
+            // next message; a spilled backlog keeps the worker polling
+            (void)shard.router->release_throttled();
+            size_t pending = shard.router->drain_overflow();
+            count(pending);
+            if (pending != 0) {
+                cpu_relax();
+            } else {
+                (void)shard.router->maintain();
+                shard.waiter.idle(ready);
+            }
+            continue;
+        }
+        shard.waiter.reset();
+        uncounted += n;
+        count(shard.router->drain_overflow());
+    }
+    // Finish what was submitted before stop(), backlog included
+    while (size_t n = shard.router->drain(*shard.ingress, batch, config_.count_outcomes)) {
+        uncounted += n;
+    }
+    (void)shard.router->release_throttled();
+    size_t pending;
+    while ((pending = shard.router->drain_overflow()) != 0) cpu_relax();
+    count(pending);
+}
+
+bool ShardedRouter::add_instrument(const InstrumentConfig& cfg) {
+    if (shard_of(cfg.instrument_id) != INVALID_SHARD) return false;
+    Shard* lightest = shards_.front().get();
+    for (auto& shard : shards_) {
+        if (shard->load < lightest->load) lightest = shard.get();
+    }
+    // The router builds and publishes the pipeline safely under a running
+    // worker; the shard's registry copy is only read at construction
+    if (!lightest->router->add_instrument(cfg)) return false;
+    lightest->load += cfg.expected_load;
+    if (cfg.instrument_id >= id_to_shard_.size()) {
+        id_to_shard_.resize(static_cast<size_t>(cfg.instrument_id) + 1, INVALID_SHARD);
+    }
+    id_to_shard_[cfg.instrument_id] = lightest->index;
+    return true;
+}
+
+bool ShardedRouter::submit(const OrderMessage& msg) noexcept {
+    size_t s = shard_of(msg.instrument_id);
+    if (s == INVALID_SHARD) [[unlikely]] return false;
+    Shard& shard = *shards_[s];
+    // Count before pushing so submitted never lags what the worker can
+    // see; merge() then cannot mistake a queued message for caught up.
+    shard.submitted.fetch_add(1, std::memory_order_acq_rel);
+    if (!shard.ingress->try_push(msg)) [[unlikely]] {
+        shard.submitted.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    return true;
+}
+
+bool ShardedRouter::idle() const noexcept {
+    for (const auto& shard : shards_) {
+        if (shard->processed.load(std::memory_order_acquire) !=
+            shard->submitted.load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Merged stream
+// ---------------------------------------------------------------------------
+
+const EventMessage* ShardedRouter::merge_head(Shard& shard, Timestamp& key,
+                                              bool& caught_up) noexcept {
+    const EventMessage* head = shard.events->peek();
+    if (!head) {
+        caught_up = false;
+        const uint64_t submitted = shard.submitted.load(std::memory_order_acquire);
+        if (shard.processed.load(std::memory_order_acquire) != submitted) {
+            return nullptr;  // Worker may still publish earlier events
+        }
+        // Everything submitted is processed; anything it published is
+        // visible now.
+        head = shard.events->peek();
+        if (!head) {
+            caught_up = true;
+            return nullptr;
+        }
+    }
+    key = event_key(*head, shard.last_key);
+    return head;
+}
+
+size_t ShardedRouter::merge(EventMessage* out, size_t max) noexcept {
+    size_t n = 0;
+    while (n < max) {
+        Shard* best = nullptr;
+        const EventMessage* best_event = nullptr;
+        Timestamp best_key = 0;
+        for (auto& shard : shards_) {
+            Timestamp key = 0;
+            bool caught_up = false;
+            const EventMessage* head = merge_head(*shard, key, caught_up);
+            if (!head) {
+                if (!caught_up) return n;  // Cannot rule out an earlier event
+                continue;
+            }
+            // Strict < keeps the lower shard first on equal keys
+            if (!best || key < best_key) {
+                best = shard.get();
+                best_event = head;
+                best_key = key;
+            }
+        }
+        if (!best) break;
+        out[n++] = *best_event;
+        best->last_key = best_key;
+        best->events->release();
+    }
+    return n;
+}
+
+const OrderBook* ShardedRouter::order_book(InstrumentId id) const noexcept {
+    size_t s = shard_of(id);
+    return s == INVALID_SHARD ? nullptr : shards_[s]->router->order_book(id);
+}
+
+const InstrumentPipeline* ShardedRouter::pipeline(InstrumentId id) const noexcept {
+    size_t s = shard_of(id);
+    return s == INVALID_SHARD ? nullptr : shards_[s]->router->pipeline(id);
+}
+
+RouterMemoryUsage ShardedRouter::memory_usage() const noexcept {
+    RouterMemoryUsage usage;
+    for (const auto& shard : shards_) {
+        const RouterMemoryUsage part = shard->router->memory_usage();
+        usage.instruments += part.instruments;
+        usage.shared_pool += part.shared_pool;
+    }
+    return usage;
+}
+
+}  // namespace hft
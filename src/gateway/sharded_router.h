@@ -0,0 +1,193 @@
+#pragma once
+
+/// @file sharded_router.h
+/// @brief Multi-core instrument router — one matching thread per shard of
+///        instruments, each with its own ingress and event ring.
+///
+/// A single InstrumentRouter runs every instrument on one thread. This
+/// router splits the registry into shards, builds one InstrumentRouter per
+/// shard and runs each on its own worker thread. Every shard has a private
+/// IngressBuffer (submitters route by instrument_id) and a private
+/// EventBuffer, so shards share no hot cache lines and scale with cores
+/// until the instrument mix stops dividing evenly.
+///
+/// Instruments are assigned round-robin in registration order, or by
+/// InstrumentConfig::expected_load (heaviest first onto the least loaded
+/// shard). add_instrument() places one more while the workers run, on the
+/// shard with the least expected load. An instrument never moves, so its
+/// orders keep their arrival order and each OrderGateway keeps numbering
+/// its events from one. With count_outcomes each worker also counts its
+/// instruments' GatewayResults (outcomes()), which submit() cannot return.
+///
+/// Consumers that only follow some instruments read the shard rings
+/// directly (add_consumer on shard_events()). Consumers that need a single
+/// global stream call merge(), which interleaves the shards by the
+/// timestamp of the order that caused each event, keeping every shard's
+/// own order. merge() only emits an event once every other shard either
+/// has a later event pending or has processed everything submitted to it,
+/// so the stream is exact when one thread submits in timestamp order (as a
+/// feed replay does); with racing submitters only per-shard order holds.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/types.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "transport/event_buffer.h"
+#include "transport/ingress_buffer.h"
+#include "transport/message.h"
+#include "transport/wait_strategy.h"
+#include "utils/thread_placement.h"
+
+namespace hft {
+
+/// How instruments are spread over the shards.
+enum class ShardAssignment : uint8_t {
+    RoundRobin,  // Registration order, one instrument per shard in turn
+    ByLoad       // Greedy on InstrumentConfig::expected_load
+};
+
+struct ShardedRouterConfig {
+    size_t num_shards = 1;
+    ShardAssignment assignment = ShardAssignment::RoundRobin;
+    /// Shard s's worker takes matching role index s (CPU pin, SCHED_FIFO).
+    ThreadingConfig threading;
+    /// Messages a worker routes per poll of its ingress.
+    size_t drain_batch = 256;
+    /// How a worker waits on an empty ingress. Block attaches a
+    /// WakeupSignal to each shard's ingress.
+    WaitConfig worker_wait;
+    /// Keep the PRIMARY cursor of each shard ring for merge(). Turn off
+    /// when only per-shard consumers read the rings, or the shards stall
+    /// once a ring fills.
+    bool merged_stream = true;
+    /// Applied to each shard's router separately.
+    SharedPoolConfig shared_pool;
+    /// Workers count each instrument's GatewayResults (outcomes()).
+    bool count_outcomes = false;
+};
+
+/// Instrument router with one worker thread per shard.
+class ShardedRouter {
+public:
+    static constexpr size_t INVALID_SHARD = SIZE_MAX;
+
+    /// @param registry Instrument definitions (copied into the shards).
+    ShardedRouter(const InstrumentRegistry& registry,
+                  const ShardedRouterConfig& config);
+    ~ShardedRouter();
+
+    ShardedRouter(const ShardedRouter&) = delete;
+    ShardedRouter& operator=(const ShardedRouter&) = delete;
+
+    /// Start one worker per shard. No-op if already running.
+    void start();
+
+    /// Drain each shard's ingress, then join the workers.
+    void stop();
+
+    [[nodiscard]] bool running() const noexcept { return running_; }
+
+    /// Build a pipeline for an instrument not in the registry at
+    /// construction, on the shard with the least expected load, and start
+    /// routing to it. Call from the submitting thread (submit() reads the
+    /// id-to-shard table unlocked); the workers may keep running. Returns
+    /// false if the id is already routed.
+    bool add_instrument(const InstrumentConfig& cfg);
+
+    /// Route a message to its instrument's shard (any thread).
+    /// @return false if the instrument is unknown or the shard's ingress
+    ///         is full — retry or shed.
+    [[nodiscard]] bool submit(const OrderMessage& msg) noexcept;
+
+    /// Interleave every shard's pending events into `out` (one thread
+    /// only; requires merged_stream). @return events written.
+    [[nodiscard]] size_t merge(EventMessage* out, size_t max) noexcept;
+
+    /// Whether every submitted message has been processed (approximate).
+    [[nodiscard]] bool idle() const noexcept;
+
+    /// Shard owning an instrument, or INVALID_SHARD.
+    [[nodiscard]] size_t shard_of(InstrumentId id) const noexcept {
+        return id < id_to_shard_.size() ? id_to_shard_[id] : INVALID_SHARD;
+    }
+
+    [[nodiscard]] size_t shard_count() const noexcept { return shards_.size(); }
+
+    /// A shard's event ring, for consumers following its instruments only.
+    [[nodiscard]] EventBuffer& shard_events(size_t shard) noexcept {
+        return *shards_[shard]->events;
+    }
+
+    /// Messages a shard has routed so far.
+    [[nodiscard]] uint64_t shard_processed(size_t shard) const noexcept {
+        return shards_[shard]->processed.load(std::memory_order_acquire);
+    }
+
+    /// A shard worker's idle counters (approximate while it runs).
+    [[nodiscard]] const WaitStats& shard_wait_stats(size_t shard) const noexcept {
+        return shards_[shard]->waiter.stats();
+    }
+
+    /// A shard's router — only while stopped, or from its worker.
+    [[nodiscard]] const InstrumentRouter& shard_router(size_t shard) const noexcept {
+        return *shards_[shard]->router;
+    }
+
+    /// An instrument's book — only while stopped. nullptr if unknown.
+    [[nodiscard]] const OrderBook* order_book(InstrumentId id) const noexcept;
+
+    /// An instrument's pipeline — only while stopped. nullptr if unknown.
+    [[nodiscard]] const InstrumentPipeline* pipeline(InstrumentId id) const noexcept;
+
+    /// An instrument's counted results (count_outcomes) — only while
+    /// stopped. nullptr if unknown.
+    [[nodiscard]] const InstrumentOutcomes* outcomes(InstrumentId id) const noexcept {
+        const InstrumentPipeline* p = pipeline(id);
+        return p ? &p->outcomes : nullptr;
+    }
+
+    /// Memory of every shard's router — only while stopped.
+    [[nodiscard]] RouterMemoryUsage memory_usage() const noexcept;
+
+private:
+    struct Shard {
+        InstrumentRegistry registry;              // Outlives router
+        std::unique_ptr<EventBuffer> events;
+        std::unique_ptr<IngressBuffer> ingress;
+        std::unique_ptr<InstrumentRouter> router;
+        std::thread worker;
+        WakeupSignal ingress_signal;              // Attached for Block
+        Waiter waiter;
+        size_t index = 0;
+        double load = 0.0;                        // Sum of expected_load
+        // Submitters count up submitted, the worker processed; merge()
+        // treats a shard as caught up when the two match.
+        alignas(64) std::atomic<uint64_t> submitted{0};
+        alignas(64) std::atomic<uint64_t> processed{0};
+        // merge() state: ordering key of the last event taken
+        alignas(64) Timestamp last_key = 0;
+    };
+
+    void assign(const InstrumentRegistry& registry,
+                std::vector<std::vector<const InstrumentConfig*>>& out) const;
+    void run_worker(Shard& shard) noexcept;
+
+    /// Shard's next event and its ordering key; nullptr if none. Sets
+    /// `caught_up` when the shard has nothing pending that could follow.
+    [[nodiscard]] const EventMessage* merge_head(Shard& shard, Timestamp& key,
+                                                 bool& caught_up) noexcept;
+
+    ShardedRouterConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<size_t> id_to_shard_;  // flat array, size = max_id + 1
+    std::atomic<bool> stop_requested_{false};
+    bool running_ = false;
+};
+
+}  // namespace hft
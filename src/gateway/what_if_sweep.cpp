@@ -0,0 +1,89 @@
+#include "gateway/what_if_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gateway/order_gateway.h"
+
+namespace hft {
+
+/// The config scratch pipelines are built from: private pool, no events
+/// or quote slot to publish.
+static InstrumentConfig scratch_config(const InstrumentConfig& config) {
+    InstrumentConfig scratch = config;
+    scratch.shared_pool = false;
+    scratch.quote_snapshot = false;
+    return scratch;
+}
+
+WhatIfSweep::WhatIfSweep(const InstrumentPipeline& base, const InstrumentConfig& config)
+    : config_(scratch_config(config)),
+      frozen_(build_instrument_pipeline(config_, nullptr)) {
+    frozen_stats_ = clone_pipeline(base, *frozen_);
+}
+
+std::vector<WhatIfResult> WhatIfSweep::run(const std::vector<WhatIfVariant>& variants,
+                                           size_t threads) const {
+    std::vector<WhatIfResult> results(variants.size());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, variants.size());
+
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < variants.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            results[i] = run_one(variants[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(work);
+    work();  // The caller is one of the workers
+    for (std::thread& w : workers) w.join();
+    return results;
+}
+
+WhatIfResult WhatIfSweep::run_one(const WhatIfVariant& variant) const {
+    WhatIfResult result;
+    result.name = variant.name;
+    result.messages = variant.messages.size();
+    if (!frozen_stats_.ok) {
+        result.error = "frozen copy unavailable: " + frozen_stats_.error;
+        return result;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<InstrumentPipeline> p = build_instrument_pipeline(config_, nullptr);
+    const SnapshotStats cloned = clone_pipeline(*frozen_, *p);
+    if (!cloned.ok) {
+        result.error = cloned.error;
+        return result;
+    }
+
+    std::vector<GatewayResult> outcomes(variant.messages.size());
+    p->gateway->process_batch(variant.messages.data(), variant.messages.size(),
+                              outcomes.data());
+    for (const GatewayResult& r : outcomes) {
+        if (r.accepted && r.match_status != MatchStatus::Rejected) {
+            ++result.accepted;
+        } else {
+            ++result.rejected;
+        }
+        result.trades += r.trade_count;
+        result.filled_quantity += r.filled_quantity;
+        ++result.status_counts[static_cast<size_t>(r.match_status)];
+    }
+
+    const OrderBook& book = *p->book;
+    result.order_count = book.order_count();
+    if (const PriceLevel* bid = book.best_bid()) result.best_bid = bid->price;
+    if (const PriceLevel* ask = book.best_ask()) result.best_ask = ask->price;
+    result.last_trade_price = p->engine->last_trade_price();
+    result.wall_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    result.ok = true;
+    return result;
+}
+
+}  // namespace hft
@@ -0,0 +1,99 @@
+#pragma once
+
+/// @file what_if_sweep.h
+/// @brief Replays alternative order sequences against copies of one book,
+///        in parallel, and reports how each variant would have matched.
+///
+/// Cold-path component. A WhatIfSweep freezes the state of a pipeline once
+/// (clone_pipeline(), so the live pipeline may carry on afterwards) and
+/// then, for each variant, builds a scratch pipeline from the same config,
+/// clones the frozen copy into it and feeds it the variant's messages
+/// through OrderGateway::process_batch. Variants run on a small pool of
+/// worker threads that each take the next unclaimed variant; the frozen
+/// copy is only read, so workers share it without locking. Scratch
+/// pipelines publish no events and are freed once their result is taken.
+///
+/// Each WhatIfResult counts the GatewayResults of its variant by outcome
+/// and records the book it left behind. Results come back in variant
+/// order and do not depend on the thread count.
+///
+/// Usage:
+///   WhatIfSweep sweep(router.pipeline_at(0), *registry.find_by_id(id));
+///   std::vector<WhatIfResult> results = sweep.run(variants);
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+#include "gateway/book_snapshot.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "matching/match_result.h"
+#include "transport/message.h"
+
+namespace hft {
+
+/// One alternative order sequence to try against the frozen book.
+struct WhatIfVariant {
+    std::string name;
+    std::vector<OrderMessage> messages;  // Add / Cancel / Modify, in order
+};
+
+/// Number of MatchStatus values (WhatIfResult::status_counts).
+constexpr size_t WHAT_IF_STATUS_COUNT = static_cast<size_t>(MatchStatus::Modified) + 1;
+
+/// How one variant played out.
+struct WhatIfResult {
+    std::string name;
+    bool ok = false;
+    std::string error;            // Set when !ok (the clone failed)
+    size_t messages = 0;
+    size_t accepted = 0;
+    size_t rejected = 0;          // Refused by the gateway or the engine
+    uint64_t trades = 0;
+    Quantity filled_quantity = 0; // Aggressor quantity filled
+    uint64_t status_counts[WHAT_IF_STATUS_COUNT] = {};  // By MatchStatus
+    size_t order_count = 0;       // Resting orders afterwards
+    Price best_bid = 0;           // Afterwards (0 = side empty)
+    Price best_ask = 0;
+    Price last_trade_price = 0;
+    uint64_t wall_ns = 0;         // Clone + replay
+
+    [[nodiscard]] uint64_t count(MatchStatus status) const noexcept {
+        return status_counts[static_cast<size_t>(status)];
+    }
+};
+
+class WhatIfSweep {
+public:
+    /// Freeze the current state of `base`, which must have been built from
+    /// `config` (build_instrument_pipeline() or an InstrumentRouter). Call
+    /// on the thread that owns `base`. Check ok() before run().
+    WhatIfSweep(const InstrumentPipeline& base, const InstrumentConfig& config);
+
+    WhatIfSweep(const WhatIfSweep&) = delete;
+    WhatIfSweep& operator=(const WhatIfSweep&) = delete;
+
+    [[nodiscard]] bool ok() const noexcept { return frozen_stats_.ok; }
+    [[nodiscard]] const std::string& error() const noexcept { return frozen_stats_.error; }
+    /// Resting orders in the frozen copy.
+    [[nodiscard]] size_t frozen_orders() const noexcept { return frozen_stats_.orders; }
+
+    /// Run every variant and return one result per variant, in order.
+    /// `threads` = 0 picks std::thread::hardware_concurrency(); never more
+    /// threads than variants. Every result is !ok if the freeze failed.
+    [[nodiscard]] std::vector<WhatIfResult> run(const std::vector<WhatIfVariant>& variants,
+                                                size_t threads = 0) const;
+
+private:
+    [[nodiscard]] WhatIfResult run_one(const WhatIfVariant& variant) const;
+
+    InstrumentConfig config_;
+    std::unique_ptr<InstrumentPipeline> frozen_;
+    SnapshotStats frozen_stats_;
+};
+
+}  // namespace hft
@@ -4,48 +4,205 @@
 /// Usage:
 ///   ./replay --input data/btcusdt_l3_sample.csv [--output report.json]
 ///            [--speed max|realtime|2x] [--verbose]
+///            [--pipelined [--cpus <parser>,<matching>,<publisher>]
+///                         [--wait spin|pause|yield|backoff|block]]
+///            [--mlock] [--fifo <priority>] [--parse-threads <n>]
+///            [--matching-workers <n>]
 ///            [--analytics] [--analytics-json <path>] [--analytics-csv <path>]
+///            [--analytics-thread [<cpu>]] [--analytics-workers <n>]
+///            [--analytics-columns <path>]
+///            [--analytics-bars <type:threshold>]... [--analytics-bars-csv <path>]
+///            [--analytics-sample <module>=<trigger>[:<n>]]...
+///            [--trace <n> [--trace-csv <path>]]
+///            [--metrics <name> [--metrics-linger <seconds>]]
+///   ./replay --input day.csv --convert day.l3b
+///   ./replay --batch manifest.txt [--batch-workers <n>] [--output report.json]
 ///
 /// Automatically detects multi-instrument CSV files (7-column format with
-/// "symbol" header) and uses MultiInstrumentReplayEngine.
-
+/// "symbol" header) and uses MultiInstrumentReplayEngine. --input also
+/// accepts binary L3 files written by --convert (see l3_binary_format.h),
+/// and gzip / zstd / lz4 compressed files (see compressed_input.h).
+/// --batch replays every <day> <input> [symbol] line of a manifest on a
+/// pool of reusable pipelines and writes one merged report (see
+/// batch_replay.h).
+
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "analytics/analytics_engine.h"
+#include "analytics/analytics_thread.h"
+#include "analytics/bar_aggregator.h"
 #include "analytics/multi_instrument_analytics.h"
 #include "core/types.h"
+#include "feed/batch_replay.h"
+#include "feed/l3_binary_format.h"
+#include "feed/l3_feed_parser.h"
 #include "feed/multi_instrument_replay_engine.h"
 #include "feed/replay_engine.h"
+#include "utils/thread_placement.h"
 
 using namespace hft;
 
+/// Where the replay's threads ran, if any placement was requested.
+static void print_thread_topology(const ThreadingConfig& threading) {
+    if (!threading.any()) return;
+    std::cout << "\nThread placement:\n" << thread_topology_report();
+}
+
 static void print_usage(const char* program) {
     std::cerr
         << "Usage: " << program << " --input <file.csv> [options]\n"
         << "\n"
         << "Options:\n"
-        << "  --input  <path>          Input L3 CSV file (required)\n"
+        << "  --input  <path>          Input L3 CSV or binary file, optionally compressed (required)\n"
+        << "  --convert <path>         Write the input as a binary L3 file and exit\n"
+        << "  --batch <manifest>       Replay each <day> <input> [symbol] line of the manifest\n"
+        << "                           instead of --input, into one merged report\n"
+        << "  --batch-workers <n>      Batch pipelines run at once (default 1, 0 = all cores)\n"
         << "  --output <path>          Output JSON report file\n"
         << "  --speed  <mode>          Playback speed: max (default), realtime, <N>x\n"
         << "  --verbose                Print detailed progress\n"
+        << "  --pipelined              Parser, matching and publisher on separate threads\n"
+        << "  --cpus <p>,<m>,<u>       Pin those threads to CPUs (with --pipelined)\n"
+        << "  --wait <strategy>        Idle wait: spin, pause, yield (default), backoff, block\n"
+        << "  --mlock                  Lock all memory (mlockall) before replaying\n"
+        << "  --fifo <priority>        Run placed threads SCHED_FIFO at this priority\n"
+        << "  --parse-threads <n>      Parse the CSV on n worker threads, in file order\n"
+        << "  --matching-workers <n>   Multi-instrument: match instruments on n worker threads\n"
+        << "  --journal <dir>          Journal the event stream to segment files in dir\n"
+        << "  --journal-fsync <mode>   Journal fsync: none, batch, timed (default)\n"
+        << "  --multicast <ip:port>    Publish the event stream as a binary UDP feed\n"
+        << "  --multicast-levels       Feed only level updates and trades\n"
+        << "  --multicast-snapshot <ip:port>  Send L2 snapshots to this channel\n"
+        << "  --multicast-retransmit <port>   Answer gap-fill requests on this port\n"
+        << "  --checkpoint-dir <dir>   Seekable replay: checkpoint directory\n"
+        << "  --checkpoint-every <n>   Write a checkpoint every n records\n"
+        << "  --checkpoint-seconds <s> Write a checkpoint every s seconds of feed time\n"
+        << "  --seek <timestamp>       Start at this feed timestamp (ns) from the checkpoints\n"
+        << "  --until <timestamp>      Stop after this feed timestamp (ns)\n"
+        << "  --digest-every <n>       Stamp the book's state digest into the event stream\n"
+        << "                           every n gateway calls\n"
+        << "  --trace <n>              Time 1 in n orders through each pipeline stage\n"
+        << "                           (builds with -DHFT_ENABLE_TRACE=ON)\n"
+        << "  --trace-csv <path>       Write each traced order's stage breakdown to a CSV\n"
+        << "  --metrics <name>         Publish live metrics in /dev/shm/<name> for\n"
+        << "                           grafana/scripts/metrics_exporter.py\n"
+        << "  --metrics-linger <s>     Keep the metrics region up s seconds after the run\n"
         << "  --analytics              Enable analytics and print summary\n"
         << "  --analytics-json <path>  Write analytics JSON to file\n"
         << "  --analytics-csv  <path>  Write analytics time-series CSV to file\n"
+        << "  --analytics-columns <path> Stream the time series to a binary column file\n"
+        << "                           (multi-instrument: <path>.<instrument id>)\n"
+        << "  --analytics-bars <type:n> Aggregate time|tick|volume|dollar bars (repeatable;\n"
+        << "                           time in ns, e.g. time:1000000000, volume:500)\n"
+        << "  --analytics-bars-csv <path> Write every completed bar to a CSV\n"
+        << "  --analytics-sample <module>=<trigger>[:n]\n"
+        << "                           Sample spread|microprice|volatility|impact|depth on\n"
+        << "                           every|trades|nth:<n>|interval:<ns>|bbo (repeatable)\n"
+        << "  --analytics-thread [cpu] Run analytics on its own thread (optionally pinned),\n"
+        << "                           reading published quotes instead of the book\n"
+        << "  --analytics-workers <n>  Multi-instrument: split instruments' analytics over n threads\n"
         << "  --help                   Show this help message\n";
 }
 
+/// Per-stage latency of the traced orders.
+static void print_trace_summary(const ReplayEngine& engine, const ReplayStats& stats,
+                                uint64_t every) {
+    const TraceSummary summary =
+        summarize_order_traces(engine.order_traces(), engine.trace_tsc_per_ns());
+    std::cout << "\nStage latency (1 in " << every << " orders, " << summary.orders
+              << " traced, " << stats.trace_dropped << " records dropped):\n";
+    auto row = [](const char* name, const LatencyStats& s) {
+        if (s.sample_count == 0) return;
+        std::cout << "  " << std::left << std::setw(14) << name << std::right
+                  << std::setw(8) << s.sample_count << std::fixed << std::setprecision(1)
+                  << "  p50 " << s.p50_ns << "  p99 " << s.p99_ns << "  p99.9 " << s.p99_9_ns
+                  << "  max " << s.max_ns << " ns\n"
+                  << std::defaultfloat;
+    };
+    for (size_t i = 0; i < TRACE_STAGE_COUNT; ++i) {
+        row(trace_stage_name(static_cast<TraceStage>(i)), summary.stages[i]);
+    }
+    row("queue", summary.queue);
+    row("total", summary.total);
+}
+
+/// The final book digest, as hex (matches the JSON report).
+static void print_digest(uint64_t digest) {
+    std::cout << "  Digest:  " << std::hex << std::setw(16) << std::setfill('0') << digest
+              << std::dec << std::setfill(' ') << "\n";
+}
+
+/// Split "address:port" into `address` and `port`.
+static bool parse_endpoint(const char* text, std::string& address, uint16_t& port) {
+    const char* colon = std::strrchr(text, ':');
+    if (!colon || colon == text) return false;
+    const long value = std::strtol(colon + 1, nullptr, 10);
+    if (value <= 0 || value > 65535) return false;
+    address.assign(text, colon);
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+/// Parse "<module>=<trigger>[:<n>]" (e.g. "depth=interval:1000000",
+/// "impact=nth:10", "spread=bbo") into the module's SampleConfig.
+static bool parse_sample_spec(const char* spec, AnalyticsConfig& config) {
+    const char* eq = std::strchr(spec, '=');
+    if (eq == nullptr) return false;
+    const std::string module(spec, eq);
+    SampleConfig* target = module == "spread"       ? &config.spread_sampling
+                         : module == "microprice"   ? &config.microprice_sampling
+                         : module == "volatility"   ? &config.volatility_sampling
+                         : module == "impact"       ? &config.impact_sampling
+                         : module == "depth"        ? &config.depth_sampling
+                                                    : nullptr;
+    if (target == nullptr) return false;
+
+    const char* colon = std::strchr(eq + 1, ':');
+    const std::string trigger = colon ? std::string(eq + 1, colon) : std::string(eq + 1);
+    SampleConfig sampling;
+    if (trigger == "every") {
+        sampling.trigger = SampleTrigger::EveryEvent;
+    } else if (trigger == "trades") {
+        sampling.trigger = SampleTrigger::Trades;
+    } else if (trigger == "bbo") {
+        sampling.trigger = SampleTrigger::BboChange;
+    } else if (trigger == "nth" || trigger == "interval") {
+        sampling.trigger = trigger == "nth" ? SampleTrigger::EveryNth : SampleTrigger::Interval;
+        if (colon == nullptr) return false;
+        char* end = nullptr;
+        sampling.every = std::strtoull(colon + 1, &end, 10);
+        if (*end != '\0' || sampling.every == 0) return false;
+    } else {
+        return false;
+    }
+    *target = sampling;
+    return true;
+}
+
 static void print_price(const char* label, Price price) {
     double value = static_cast<double>(price) / static_cast<double>(PRICE_SCALE);
     std::cout << "  " << label << ": $" << value << "\n";
 }
 
-/// Detect if a CSV file is multi-instrument (7-column with "symbol" header).
+/// Detect if a CSV file is multi-instrument (7-column with "symbol" header),
+/// or a binary L3 file has a symbol dictionary.
 static bool is_multi_instrument_csv(const std::string& path) {
+    if (is_l3_binary_file(path)) {
+        L3FeedParser parser;
+        return parser.open(path) && parser.has_symbol_column();
+    }
+
     std::ifstream file(path);
     if (!file.is_open()) return false;
 
@@ -72,6 +229,20 @@ int main(int argc, char* argv[]) {
     bool enable_analytics = false;
     std::string analytics_json_path;
     std::string analytics_csv_path;
+    std::string analytics_columns_path;
+    std::vector<BarConfig> analytics_bars;
+    AnalyticsConfig analytics_sampling;   // Only its *_sampling fields are used
+    std::string analytics_bars_csv_path;
+    bool analytics_thread = false;
+    size_t analytics_workers = 0;
+    size_t matching_workers = 0;
+    std::string convert_path;
+    bool seek = false;
+    Timestamp seek_timestamp = 0;
+    std::string trace_csv_path;
+    double metrics_linger_seconds = 0.0;
+    std::string batch_manifest;
+    size_t batch_workers = 1;
 
     // Hand-rolled argument parsing
     for (int i = 1; i < argc; ++i) {
@@ -85,6 +256,24 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
             config.input_path = argv[i];
+        } else if (std::strcmp(argv[i], "--convert") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --convert requires a path argument\n";
+                return 1;
+            }
+            convert_path = argv[i];
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --batch requires a manifest path\n";
+                return 1;
+            }
+            batch_manifest = argv[i];
+        } else if (std::strcmp(argv[i], "--batch-workers") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --batch-workers requires a worker count\n";
+                return 1;
+            }
+            batch_workers = std::strtoul(argv[i], nullptr, 10);
         } else if (std::strcmp(argv[i], "--output") == 0) {
             if (++i >= argc) {
                 std::cerr << "Error: --output requires a path argument\n";
@@ -115,6 +304,169 @@ int main(int argc, char* argv[]) {
             }
         } else if (std::strcmp(argv[i], "--verbose") == 0) {
             config.verbose = true;
+        } else if (std::strcmp(argv[i], "--pipelined") == 0) {
+            config.pipelined = true;
+        } else if (std::strcmp(argv[i], "--cpus") == 0) {
+            int parser_cpu = -1;
+            int matching_cpu = -1;
+            int publisher_cpu = -1;
+            if (++i >= argc ||
+                std::sscanf(argv[i], "%d,%d,%d", &parser_cpu, &matching_cpu,
+                            &publisher_cpu) != 3) {
+                std::cerr << "Error: --cpus requires <parser>,<matching>,<publisher>\n";
+                return 1;
+            }
+            config.threading.ingress_cpus = {parser_cpu};
+            config.threading.matching_cpus = {matching_cpu};
+            config.threading.publisher_cpus = {publisher_cpu};
+        } else if (std::strcmp(argv[i], "--mlock") == 0) {
+            config.threading.lock_memory = true;
+        } else if (std::strcmp(argv[i], "--fifo") == 0) {
+            if (++i >= argc || std::atoi(argv[i]) < 1 || std::atoi(argv[i]) > 99) {
+                std::cerr << "Error: --fifo requires a priority in 1..99\n";
+                return 1;
+            }
+            config.threading.realtime = true;
+            config.threading.realtime_priority = std::atoi(argv[i]);
+        } else if (std::strcmp(argv[i], "--parse-threads") == 0) {
+            if (++i >= argc || std::atoi(argv[i]) < 0) {
+                std::cerr << "Error: --parse-threads requires a thread count\n";
+                return 1;
+            }
+            config.parse_threads = static_cast<size_t>(std::atoi(argv[i]));
+        } else if (std::strcmp(argv[i], "--matching-workers") == 0) {
+            if (++i >= argc || std::atoi(argv[i]) < 0) {
+                std::cerr << "Error: --matching-workers requires a thread count\n";
+                return 1;
+            }
+            matching_workers = static_cast<size_t>(std::atoi(argv[i]));
+        } else if (std::strcmp(argv[i], "--wait") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --wait requires a strategy\n";
+                return 1;
+            }
+            std::string mode = argv[i];
+            if (mode == "spin") {
+                config.consumer_wait.strategy = WaitStrategy::BusySpin;
+            } else if (mode == "pause") {
+                config.consumer_wait.strategy = WaitStrategy::Pause;
+            } else if (mode == "yield") {
+                config.consumer_wait.strategy = WaitStrategy::Yield;
+            } else if (mode == "backoff") {
+                config.consumer_wait.strategy = WaitStrategy::Backoff;
+            } else if (mode == "block") {
+                config.consumer_wait.strategy = WaitStrategy::Block;
+            } else {
+                std::cerr << "Error: unknown wait strategy: " << mode << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--journal") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --journal requires a directory\n";
+                return 1;
+            }
+            config.journal.directory = argv[i];
+        } else if (std::strcmp(argv[i], "--journal-fsync") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --journal-fsync requires a mode\n";
+                return 1;
+            }
+            std::string mode = argv[i];
+            if (mode == "none") {
+                config.journal.fsync = JournalFsync::None;
+            } else if (mode == "batch") {
+                config.journal.fsync = JournalFsync::PerBatch;
+            } else if (mode == "timed") {
+                config.journal.fsync = JournalFsync::Timed;
+            } else {
+                std::cerr << "Error: unknown journal fsync mode: " << mode << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--multicast") == 0) {
+            if (++i >= argc ||
+                !parse_endpoint(argv[i], config.multicast.group, config.multicast.port)) {
+                std::cerr << "Error: --multicast requires <ip:port>\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--multicast-levels") == 0) {
+            config.multicast.content = MulticastContent::Levels;
+        } else if (std::strcmp(argv[i], "--multicast-snapshot") == 0) {
+            if (++i >= argc || !parse_endpoint(argv[i], config.multicast.snapshot_group,
+                                               config.multicast.snapshot_port)) {
+                std::cerr << "Error: --multicast-snapshot requires <ip:port>\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--multicast-retransmit") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --multicast-retransmit requires a port\n";
+                return 1;
+            }
+            config.multicast.retransmit_port = static_cast<uint16_t>(std::atoi(argv[i]));
+        } else if (std::strcmp(argv[i], "--checkpoint-dir") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --checkpoint-dir requires a directory\n";
+                return 1;
+            }
+            config.checkpoint_directory = argv[i];
+        } else if (std::strcmp(argv[i], "--checkpoint-every") == 0) {
+            if (++i >= argc || std::atoll(argv[i]) <= 0) {
+                std::cerr << "Error: --checkpoint-every requires a record count\n";
+                return 1;
+            }
+            config.checkpoint_every_records = std::strtoull(argv[i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--checkpoint-seconds") == 0) {
+            if (++i >= argc || std::atof(argv[i]) <= 0.0) {
+                std::cerr << "Error: --checkpoint-seconds requires a period\n";
+                return 1;
+            }
+            config.checkpoint_every_ns = static_cast<uint64_t>(std::atof(argv[i]) * 1e9);
+        } else if (std::strcmp(argv[i], "--seek") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --seek requires a timestamp\n";
+                return 1;
+            }
+            seek = true;
+            seek_timestamp = std::strtoull(argv[i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--until") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --until requires a timestamp\n";
+                return 1;
+            }
+            config.end_timestamp = std::strtoull(argv[i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--digest-every") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --digest-every requires a call count\n";
+                return 1;
+            }
+            config.digest_every = std::strtoull(argv[i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --trace requires a sampling rate\n";
+                return 1;
+            }
+            config.trace_sample_every = std::strtoull(argv[i], nullptr, 10);
+            if (config.trace_sample_every == 0) {
+                std::cerr << "Error: --trace needs a rate of at least 1\n";
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--trace-csv") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --trace-csv requires a path argument\n";
+                return 1;
+            }
+            trace_csv_path = argv[i];
+        } else if (std::strcmp(argv[i], "--metrics") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --metrics requires a region name\n";
+                return 1;
+            }
+            config.metrics_name = argv[i];
+        } else if (std::strcmp(argv[i], "--metrics-linger") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --metrics-linger requires a number of seconds\n";
+                return 1;
+            }
+            metrics_linger_seconds = std::atof(argv[i]);
         } else if (std::strcmp(argv[i], "--analytics") == 0) {
             enable_analytics = true;
         } else if (std::strcmp(argv[i], "--analytics-json") == 0) {
@@ -131,6 +483,47 @@ int main(int argc, char* argv[]) {
             }
             analytics_csv_path = argv[i];
             enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-columns") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --analytics-columns requires a path argument\n";
+                return 1;
+            }
+            analytics_columns_path = argv[i];
+            enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-bars") == 0) {
+            BarConfig bar;
+            if (++i >= argc || !parse_bar_spec(argv[i], bar)) {
+                std::cerr << "Error: --analytics-bars requires <time|tick|volume|dollar>:<threshold>\n";
+                return 1;
+            }
+            analytics_bars.push_back(bar);
+            enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-sample") == 0) {
+            if (++i >= argc || !parse_sample_spec(argv[i], analytics_sampling)) {
+                std::cerr << "Error: --analytics-sample requires <module>=<trigger>[:<n>]\n";
+                return 1;
+            }
+            enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-bars-csv") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --analytics-bars-csv requires a path argument\n";
+                return 1;
+            }
+            analytics_bars_csv_path = argv[i];
+            enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-workers") == 0) {
+            if (++i >= argc) {
+                std::cerr << "Error: --analytics-workers requires a thread count\n";
+                return 1;
+            }
+            analytics_workers = std::strtoul(argv[i], nullptr, 10);
+            enable_analytics = true;
+        } else if (std::strcmp(argv[i], "--analytics-thread") == 0) {
+            analytics_thread = true;
+            enable_analytics = true;
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                config.threading.analytics_cpus = {std::atoi(argv[++i])};
+            }
         } else {
             std::cerr << "Error: unknown option: " << argv[i] << "\n";
             print_usage(argv[0]);
@@ -138,13 +531,102 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!batch_manifest.empty()) {
+        if (!config.input_path.empty() || enable_analytics || seek) {
+            std::cerr << "Warning: --input, --seek and analytics are ignored with --batch\n";
+        }
+        BatchReplayConfig batch;
+        batch.replay = config;
+        batch.workers = batch_workers;
+        batch.output_path = config.output_path;
+        std::string error;
+        if (!load_batch_manifest(batch_manifest, batch.jobs, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        if (batch.jobs.empty()) {
+            std::cerr << "Error: no jobs in " << batch_manifest << "\n";
+            return 1;
+        }
+
+        std::cout << "Replaying batch: " << batch_manifest << " (" << batch.jobs.size()
+                  << " jobs)\n";
+        BatchReplayStats stats = BatchReplay(batch).run();
+
+        std::cout << "\n=== Batch Complete ===\n"
+                  << "  Jobs:      " << stats.jobs.size() << " (" << stats.jobs_failed
+                  << " failed) on " << stats.workers << " workers\n"
+                  << "  Inputs:    " << stats.inputs_shared << " shared, "
+                  << stats.input_bytes << " bytes\n"
+                  << "  Messages:  " << stats.total_messages << "\n"
+                  << "  Trades:    " << stats.trades_generated << "\n"
+                  << "  Elapsed:   " << std::fixed << std::setprecision(3)
+                  << stats.elapsed_seconds << "s\n"
+                  << "  Rate:      " << std::setprecision(0) << stats.messages_per_second
+                  << " msg/s\n"
+                  << std::defaultfloat;
+        for (size_t j = 0; j < stats.jobs.size(); ++j) {
+            const BatchReplayJob& job = batch.jobs[j];
+            const BatchJobResult& result = stats.jobs[j];
+            std::cout << "\n" << job.day << "  " << job.input_path;
+            if (!job.symbol.empty()) std::cout << "  " << job.symbol;
+            std::cout << "\n";
+            if (!result.ok) {
+                std::cout << "  Failed:  " << result.error << "\n";
+                continue;
+            }
+            std::cout << "  Messages: " << result.stats.total_messages
+                      << "  Trades: " << result.stats.trades_generated << "\n";
+            print_digest(result.stats.final_book_digest);
+        }
+        if (!batch.output_path.empty()) {
+            std::cout << "\nReport written to: " << batch.output_path << "\n";
+        }
+        return stats.jobs_failed == 0 ? 0 : 1;
+    }
+
     if (config.input_path.empty()) {
         std::cerr << "Error: --input is required\n";
         print_usage(argv[0]);
         return 1;
     }
 
+    if (!convert_path.empty()) {
+        L3ConvertStats cs = convert_l3_csv_to_binary(config.input_path, convert_path);
+        if (!cs.ok) {
+            std::cerr << "Error: conversion to " << convert_path << " failed\n";
+            return 1;
+        }
+        std::cout << "Converted " << config.input_path << " -> " << convert_path << "\n"
+                  << "  Rows:    " << cs.rows_read << " (" << cs.rows_skipped
+                  << " invalid, skipped)\n"
+                  << "  Records: " << cs.records_written << "\n"
+                  << "  Symbols: " << cs.symbol_count << "\n"
+                  << "  Size:    " << cs.csv_bytes << " -> " << cs.binary_bytes
+                  << " bytes\n";
+        return 0;
+    }
+
     // Detect multi-instrument CSV
+    // Completed bars stream to the CSV as they close (from the analytics
+    // workers too, hence the lock)
+    std::ofstream bars_out;
+    std::mutex bars_mutex;
+    BarSink bar_sink;
+    if (!analytics_bars_csv_path.empty()) {
+        if (analytics_bars.empty()) analytics_bars.push_back(BarConfig{});
+        bars_out.open(analytics_bars_csv_path);
+        if (!bars_out.is_open()) {
+            std::cerr << "Error: cannot write bars CSV: " << analytics_bars_csv_path << "\n";
+            return 1;
+        }
+        write_bar_csv_header(bars_out);
+        bar_sink = [&bars_out, &bars_mutex](const Bar& bar) {
+            std::lock_guard<std::mutex> lock(bars_mutex);
+            write_bar_csv_row(bars_out, bar);
+        };
+    }
+
     bool multi_instrument = is_multi_instrument_csv(config.input_path);
 
     if (multi_instrument) {
@@ -155,7 +637,30 @@ int main(int argc, char* argv[]) {
         multi_config.input_path = config.input_path;
         multi_config.output_path = config.output_path;
         multi_config.auto_discover = true;
+        if (!config.journal.directory.empty()) {
+            std::cerr << "Warning: --journal applies to single-instrument replays only\n";
+        }
+        if (!config.multicast.group.empty()) {
+            std::cerr << "Warning: --multicast applies to single-instrument replays only\n";
+        }
+        if (seek || !config.checkpoint_directory.empty()) {
+            std::cerr << "Warning: checkpoints and --seek apply to single-instrument replays only\n";
+        }
+        if (!config.metrics_name.empty()) {
+            std::cerr << "Warning: --metrics applies to single-instrument replays only\n";
+        }
+        if (config.digest_every > 0) {
+            std::cerr << "Warning: --digest-every applies to single-instrument replays only\n";
+        }
         multi_config.verbose = config.verbose;
+        multi_config.threading = config.threading;
+        multi_config.parse_threads = config.parse_threads;
+        if (matching_workers > 0 && enable_analytics) {
+            // Analytics builds on the serial router's books
+            std::cerr << "Warning: --matching-workers is ignored with analytics\n";
+        } else {
+            multi_config.matching_workers = matching_workers;
+        }
 
         MultiInstrumentReplayEngine engine(multi_config);
 
@@ -170,6 +675,7 @@ int main(int argc, char* argv[]) {
                 });
 
             MultiReplayStats stats = engine.run();
+            print_thread_topology(config.threading);
 
             if (stats.total_messages == 0) {
                 std::cerr << "No messages processed. Check input file path.\n";
@@ -177,10 +683,16 @@ int main(int argc, char* argv[]) {
             }
 
             // Create analytics post-run and replay buffered events
-            analytics = std::make_unique<MultiInstrumentAnalytics>(engine.router());
+            AnalyticsConfig analytics_config = analytics_sampling;
+            analytics_config.time_series_columns_path = analytics_columns_path;
+            analytics_config.bars = analytics_bars;
+            analytics = std::make_unique<MultiInstrumentAnalytics>(
+                engine.router(), analytics_config, analytics_workers, config.threading);
+            if (bar_sink) analytics->set_bar_sink(bar_sink);
             for (const auto& event : buffered_events) {
                 analytics->on_event(event);
             }
+            analytics->flush_bars();  // Finishes the workers first
 
             // Print summary
             std::cout << "\n=== Multi-Instrument Replay Summary ===\n";
@@ -196,6 +708,7 @@ int main(int argc, char* argv[]) {
                           << "  Rejected: " << ps.orders_rejected << "\n";
                 std::cout << "  Trades generated: " << ps.trades_generated << "\n";
                 std::cout << "  Final orders: " << ps.final_order_count << "\n";
+                print_digest(ps.final_book_digest);
                 print_price("Best bid", ps.final_best_bid);
                 print_price("Best ask", ps.final_best_ask);
             }
@@ -210,8 +723,12 @@ int main(int argc, char* argv[]) {
                 analytics->write_json(analytics_json_path);
                 std::cout << "\nAnalytics JSON written to: " << analytics_json_path << "\n";
             }
+            if (bars_out.is_open()) {
+                std::cout << "Analytics bars written to: " << analytics_bars_csv_path << "\n";
+            }
         } else {
             MultiReplayStats stats = engine.run();
+            print_thread_topology(config.threading);
 
             if (stats.total_messages == 0) {
                 std::cerr << "No messages processed. Check input file path.\n";
@@ -231,6 +748,7 @@ int main(int argc, char* argv[]) {
                           << "  Rejected: " << ps.orders_rejected << "\n";
                 std::cout << "  Trades generated: " << ps.trades_generated << "\n";
                 std::cout << "  Final orders: " << ps.final_order_count << "\n";
+                print_digest(ps.final_book_digest);
                 print_price("Best bid", ps.final_best_bid);
                 print_price("Best ask", ps.final_best_ask);
             }
@@ -241,10 +759,16 @@ int main(int argc, char* argv[]) {
         }
     } else {
         // --- Single-instrument path (original) ---
+        if (matching_workers > 0) {
+            std::cerr << "Warning: --matching-workers applies to multi-instrument replays only\n";
+        }
 
-        // Analytics requires the publisher to generate events
+        // Analytics requires the publisher to generate events, and keeps the
+        // depth profile from the level deltas
         if (enable_analytics) {
             config.enable_publisher = true;
+            config.level_updates = true;
+            config.quote_snapshot = analytics_thread;
         }
 
         std::cout << "Replaying: " << config.input_path << "\n";
@@ -252,15 +776,46 @@ int main(int argc, char* argv[]) {
         ReplayEngine engine(config);
 
         std::unique_ptr<AnalyticsEngine> analytics;
+        std::unique_ptr<AnalyticsThread> analytics_consumer;
         if (enable_analytics) {
-            analytics = std::make_unique<AnalyticsEngine>(engine.order_book());
-            engine.register_event_callback(
-                [&analytics](const EventMessage& event) {
-                    analytics->on_event(event);
-                });
+            AnalyticsConfig analytics_config = analytics_sampling;
+            analytics_config.depth_from_level_updates = true;
+            analytics_config.time_series_columns_path = analytics_columns_path;
+            analytics_config.bars = analytics_bars;
+            if (analytics_thread) {
+                // Its own cursor on the event ring; gating, so the report
+                // sees every event (matching waits only on a full ring)
+                analytics = std::make_unique<AnalyticsEngine>(*engine.quote_snapshot(),
+                                                              analytics_config);
+                AnalyticsThreadConfig thread_config;
+                thread_config.gating = true;
+                thread_config.threading = config.threading;
+                analytics_consumer =
+                    std::make_unique<AnalyticsThread>(*engine.event_buffer(), thread_config);
+                analytics_consumer->register_callback(
+                    [&analytics](const EventMessage& event) {
+                        analytics->on_event(event);
+                    });
+            } else {
+                analytics = std::make_unique<AnalyticsEngine>(engine.order_book(),
+                                                              analytics_config);
+                engine.register_event_callback(
+                    [&analytics](const EventMessage& event) {
+                        analytics->on_event(event);
+                    });
+            }
+            if (bar_sink) analytics->set_bar_sink(bar_sink);
         }
 
+        if (seek && !engine.seek(seek_timestamp)) return 1;
+        if (analytics_consumer && !analytics_consumer->start()) {
+            std::cerr << "Error: no free event ring cursor for the analytics thread\n";
+            return 1;
+        }
         ReplayStats stats = engine.run();
+        if (analytics_consumer) analytics_consumer->stop();
+        if (analytics) analytics->flush_bars();
+        print_thread_topology(config.threading);
 
         if (stats.total_messages == 0) {
             std::cerr << "No messages processed. Check input file path.\n";
@@ -286,6 +841,7 @@ int main(int argc, char* argv[]) {
 
         std::cout << "\nFinal book state:\n";
         std::cout << "  Orders:  " << stats.final_order_count << "\n";
+        print_digest(stats.final_book_digest);
         print_price("Best bid", stats.final_best_bid);
         print_price("Best ask", stats.final_best_ask);
         print_price("Spread ", stats.final_spread);
@@ -294,10 +850,89 @@ int main(int argc, char* argv[]) {
         std::cout << "  Elapsed:  " << stats.elapsed_seconds << " s\n";
         std::cout << "  Throughput: " << stats.messages_per_second << " msgs/s\n";
 
+        const MemoryUsage memory = stats.memory.total();
+        std::cout << "\nMemory (MB reserved / touched / high-water):\n";
+        std::cout << "  Pipeline: " << memory.reserved_bytes / 1e6 << " / "
+                  << memory.touched_bytes / 1e6 << " / "
+                  << memory.high_water_bytes / 1e6 << "\n";
+
+        if (config.speed != PlaybackSpeed::Max) {
+            std::cout << "\nPacing (release lateness):\n";
+            std::cout << "  Records: " << stats.paced_records << ", "
+                      << stats.pacing_overdue << " already due, "
+                      << stats.pacing_sleeps << " sleeps\n";
+            std::cout << "  p50 " << stats.pacing_error_p50_ns / 1000.0 << " us, p99 "
+                      << stats.pacing_error_p99_ns / 1000.0 << " us, p99.9 "
+                      << stats.pacing_error_p99_9_ns / 1000.0 << " us, max "
+                      << stats.pacing_error_max_ns / 1000.0 << " us\n";
+        }
+
+        if (!config.journal.directory.empty()) {
+            std::cout << "\nJournal (" << config.journal.directory << "):\n";
+            std::cout << "  Events: " << stats.journal_events << " written, "
+                      << stats.journal_dropped << " dropped\n";
+            std::cout << "  Bytes:  " << stats.journal_bytes << " in "
+                      << stats.journal_segments << " segment(s), "
+                      << stats.journal_fsyncs << " fsyncs\n";
+        }
+
+        if (!config.multicast.group.empty()) {
+            std::cout << "\nMulticast (" << config.multicast.group << ":"
+                      << config.multicast.port << "):\n";
+            std::cout << "  Datagrams: " << stats.multicast_datagrams << " ("
+                      << stats.multicast_bytes << " bytes), "
+                      << stats.multicast_snapshots << " snapshots, "
+                      << stats.multicast_retransmitted << " retransmitted\n";
+            std::cout << "  Dropped:   " << stats.multicast_dropped << " events, "
+                      << stats.multicast_send_errors << " send errors\n";
+        }
+
+        if (stats.checkpoints_written != 0) {
+            std::cout << "\nCheckpoints: " << stats.checkpoints_written << " written to "
+                      << config.checkpoint_directory << "\n";
+        }
+        if (seek) {
+            std::cout << "\nSeek to " << seek_timestamp << ": from checkpoint at "
+                      << stats.seek_checkpoint_timestamp << ", "
+                      << stats.seek_warmup_records << " warm-up records, "
+                      << stats.seek_seconds * 1000.0 << " ms\n";
+        }
+
+        if (config.pipelined) {
+            std::cout << "\nPipeline stages:\n";
+            std::cout << "  Parse:   " << stats.parse_messages_per_second
+                      << " msgs/s, " << stats.parser_stalls << " stalls on full ring\n";
+            std::cout << "  Match:   " << stats.match_messages_per_second
+                      << " msgs/s, " << stats.matching_idle_polls << " idle polls, "
+                      << stats.matching_wakeups << " wakeups, ingress depth avg " << stats.ingress_depth_avg
+                      << " / max " << stats.ingress_depth_max << "\n";
+            if (config.enable_publisher) {
+                std::cout << "  Publish: " << stats.publish_events_per_second
+                          << " events/s, " << stats.publisher_idle_polls << " idle polls, "
+                          << stats.publisher_wakeups << " wakeups, event depth avg " << stats.event_depth_avg
+                          << " / max " << stats.event_depth_max << "\n";
+            }
+        }
+
+        if (stats.traced_orders != 0) {
+            print_trace_summary(engine, stats, config.trace_sample_every);
+            if (!trace_csv_path.empty()) {
+                std::ofstream trace_out(trace_csv_path);
+                write_order_traces_csv(trace_out, engine.order_traces(),
+                                       engine.trace_tsc_per_ns());
+                std::cout << "Order traces written to: " << trace_csv_path << "\n";
+            }
+        }
+
         if (!config.output_path.empty()) {
             std::cout << "\nReport written to: " << config.output_path << "\n";
         }
 
+        if (analytics_consumer) {
+            std::cout << "\nAnalytics thread: " << analytics_consumer->events_processed()
+                      << " events, " << analytics_consumer->lost() << " lost\n";
+        }
+
         if (analytics) {
             analytics->print_summary();
 
@@ -309,6 +944,23 @@ int main(int argc, char* argv[]) {
                 analytics->write_csv(analytics_csv_path);
                 std::cout << "Analytics CSV written to: " << analytics_csv_path << "\n";
             }
+            if (const TimeSeriesColumnWriter* columns = analytics->time_series_writer()) {
+                analytics->close_time_series();
+                std::cout << "Analytics columns written to: " << columns->path() << " ("
+                          << columns->rows_appended() << " rows, " << columns->blocks_written()
+                          << " blocks)\n";
+            }
+            if (bars_out.is_open()) {
+                std::cout << "Analytics bars written to: " << analytics_bars_csv_path << "\n";
+            }
+        }
+
+        if (const MetricsRegion* metrics = engine.metrics();
+            metrics != nullptr && metrics_linger_seconds > 0.0) {
+            // One more scrape of the final values before the region goes
+            std::cout << "\nMetrics region " << metrics->name() << " kept for "
+                      << metrics_linger_seconds << " s\n";
+            std::this_thread::sleep_for(std::chrono::duration<double>(metrics_linger_seconds));
         }
     }
 
@@ -1,16 +1,22 @@
 #pragma once
 
 /// @file match_result.h
-/// @brief MatchResult POD struct and SelfTradePreventionMode enum.
+/// @brief MatchResult POD struct, SelfTradePreventionMode and AllocationMode.
 ///
 /// MatchResult holds up to MAX_TRADES_PER_MATCH trades on the stack —
 /// no heap allocation, no callbacks, no virtual dispatch. Designed for
 /// the hot path where every allocation matters.
+///
+/// The streaming form (TradeSink + MatchSummary) hands each fill to the
+/// caller as it happens instead: no 3 KB result copy, no second pass over
+/// the trades, and no cap on fills per aggressive order. A sink is a plain
+/// function pointer plus context, so it stays free of virtual dispatch.
 
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
+#include "core/order.h"
 #include "core/trade.h"
 #include "core/types.h"
 
@@ -24,6 +30,14 @@ enum class SelfTradePreventionMode : uint8_t {
     CancelBoth      // Cancel both aggressive and resting
 };
 
+/// How an aggressive order's quantity is shared among the resting orders
+/// of one price level when it cannot take the whole level.
+enum class AllocationMode : uint8_t {
+    Fifo,             // Time priority: oldest order first
+    ProRata,          // Proportional to resting size, residual lots FIFO
+    PriceTimeProRata  // Oldest order filled first, the rest pro-rata
+};
+
 /// Status of a submitted order after matching.
 enum class MatchStatus : uint8_t {
     Filled,         // Fully filled — no remainder
@@ -48,6 +62,58 @@ struct MatchResult {
     Trade trades[MAX_TRADES_PER_MATCH];
 };
 
+/// Outcome of a mass cancel.
+struct MassCancelResult {
+    uint32_t cancelled_count;     // Orders removed and deallocated
+    Quantity cancelled_quantity;  // Sum of their remaining quantity
+};
+
+/// Outcome of a streaming submit/modify — MatchResult without the trades.
+struct MatchSummary {
+    MatchStatus status;
+    uint32_t trade_count;
+    Quantity filled_quantity;
+    Quantity remaining_quantity;
+};
+
+/// Receives every trade of a streaming submit/modify, in execution order.
+/// Called from inside the matching loop: the callback must not touch the
+/// engine or the book.
+struct TradeSink {
+    using Callback = void (*)(void* context, const Trade& trade) noexcept;
+
+    Callback on_trade;
+    void* context;
+
+    void operator()(const Trade& trade) const noexcept {
+        on_trade(context, trade);
+    }
+};
+
+/// Receives each order the engine removes on its own account (expiry), just
+/// before it returns to the pool. The callback must not touch the engine.
+struct OrderSink {
+    using Callback = void (*)(void* context, const Order& order) noexcept;
+
+    Callback on_order;
+    void* context;
+
+    void operator()(const Order& order) const noexcept {
+        on_order(context, order);
+    }
+};
+
+/// Wrap any callable `void(const Trade&) noexcept` (held by reference) as a
+/// TradeSink.
+template <typename Fn>
+[[nodiscard]] TradeSink make_trade_sink(Fn& fn) noexcept {
+    return TradeSink{
+        [](void* ctx, const Trade& trade) noexcept {
+            (*static_cast<Fn*>(ctx))(trade);
+        },
+        &fn};
+}
+
 static_assert(std::is_trivially_copyable_v<MatchResult>,
               "MatchResult must be trivially copyable for hot-path use");
 static_assert(std::is_standard_layout_v<MatchResult>,
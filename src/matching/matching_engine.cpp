@@ -1,30 +1,119 @@
 #include "matching/matching_engine.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+#include "core/uint128.h"
 
 namespace hft {
 
 // ---------------------------------------------------------------------------
-// Construction
+// Public API
 // ---------------------------------------------------------------------------
 
-MatchingEngine::MatchingEngine(OrderBook& book, MemoryPool<Order>& pool,
-                               SelfTradePreventionMode stp) noexcept
-    : book_(book), pool_(pool), stp_mode_(stp), trade_id_counter_(0) {}
+namespace {
 
-// ---------------------------------------------------------------------------
-// Public API
-// ---------------------------------------------------------------------------
+/// Legacy sink: append into MatchResult::trades (bounded by the caller's
+/// trade limit).
+void append_to_result(void* context, const Trade& trade) noexcept {
+    auto* result = static_cast<MatchResult*>(context);
+    result->trades[result->trade_count++] = trade;
+}
+
+void copy_summary(MatchResult& result, const MatchSummary& summary) noexcept {
+    result.status = summary.status;
+    result.trade_count = summary.trade_count;
+    result.filled_quantity = summary.filled_quantity;
+    result.remaining_quantity = summary.remaining_quantity;
+}
+
+}  // namespace
+
+template <typename Policy>
+MatchResult BasicMatchingEngine<Policy>::submit_order(Order* order) noexcept {
+    MatchResult result{};
+    TradeSink sink{&append_to_result, &result};
+    copy_summary(result, submit_new(order, sink, MAX_TRADES_PER_MATCH));
+    return result;
+}
+
+template <typename Policy>
+MatchSummary BasicMatchingEngine<Policy>::submit_order(Order* order,
+                                                       const TradeSink& sink) noexcept {
+    MatchSummary summary = submit_new(order, sink, UINT32_MAX);
+    release_stops(sink);
+    return summary;
+}
+
+template <typename Policy>
+void BasicMatchingEngine<Policy>::process_batch(Order* const* orders, size_t count,
+                                                MatchSummary* results,
+                                                const TradeSink& sink) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        if (i + BATCH_PREFETCH_DISTANCE < count) {
+            const Order* ahead = orders[i + BATCH_PREFETCH_DISTANCE];
+            book_.prefetch_index(ahead->order_id);
+            book_.prefetch_level(ahead->side, ahead->price);
+        }
+        results[i] = submit_new(orders[i], sink, UINT32_MAX);
+        release_stops(sink);
+    }
+}
 
-MatchResult MatchingEngine::submit_order(Order* order) noexcept {
+template <typename Policy>
+MatchResult BasicMatchingEngine<Policy>::modify_order(OrderId id, Price new_price,
+                                                      Quantity new_quantity,
+                                                      Timestamp new_timestamp) noexcept {
     MatchResult result{};
+    TradeSink sink{&append_to_result, &result};
+    copy_summary(result, modify_impl(id, new_price, new_quantity, new_timestamp,
+                                     sink, MAX_TRADES_PER_MATCH));
+    return result;
+}
+
+template <typename Policy>
+MatchSummary BasicMatchingEngine<Policy>::modify_order(OrderId id, Price new_price,
+                                                       Quantity new_quantity,
+                                                       Timestamp new_timestamp,
+                                                       const TradeSink& sink) noexcept {
+    MatchSummary summary = modify_impl(id, new_price, new_quantity,
+                                       new_timestamp, sink, UINT32_MAX);
+    release_stops(sink);
+    return summary;
+}
+
+template <typename Policy>
+MatchSummary BasicMatchingEngine<Policy>::submit_new(Order* order, const TradeSink& sink,
+                                                     uint32_t trade_limit) noexcept {
+    if (order->time_in_force == TimeInForce::DAY ||
+        order->time_in_force == TimeInForce::GTD) [[unlikely]] {
+        if (!arm_expiry(order)) {
+            MatchSummary result{};
+            result.status = MatchStatus::Rejected;
+            result.trade_count = 0;
+            result.filled_quantity = 0;
+            result.remaining_quantity = order->remaining_quantity();
+            order->status = OrderStatus::Rejected;
+            pool_.deallocate(order);
+            return result;
+        }
+    }
+    return submit_impl(order, sink, trade_limit);
+}
+
+template <typename Policy>
+MatchSummary BasicMatchingEngine<Policy>::submit_impl(Order* order, const TradeSink& sink,
+                                                      uint32_t trade_limit) noexcept {
+    MatchSummary result{};
     result.status = MatchStatus::Rejected;
     result.trade_count = 0;
     result.filled_quantity = 0;
     result.remaining_quantity = order->remaining_quantity();
 
-    // Validate price for non-Market orders
-    if (order->type != OrderType::Market) {
+    // Validate price for non-Market orders (a Stop releases as Market)
+    if (order->type != OrderType::Market && order->type != OrderType::Stop) {
         if (!book_.is_valid_price(order->price)) [[unlikely]] {
             order->status = OrderStatus::Rejected;
             pool_.deallocate(order);
@@ -32,9 +121,28 @@ MatchResult MatchingEngine::submit_order(Order* order) noexcept {
         }
     }
 
+    // Order types compiled out of this engine are rejected up front
+    if constexpr (!Policy::icebergs) {
+        if (order->type == OrderType::Iceberg) [[unlikely]] {
+            order->status = OrderStatus::Rejected;
+            pool_.deallocate(order);
+            return result;
+        }
+    }
+
+    if (StopBook::is_stop(order->type)) [[unlikely]] {
+        accept_stop(order, result);
+        return result;
+    }
+
+    if (auction_) [[unlikely]] {
+        accumulate(order, result);
+        return result;
+    }
+
     // FOK: check feasibility before matching
     if (order->type == OrderType::FOK) {
-        if (!check_fok_feasibility(order)) [[unlikely]] {
+        if (!Policy::fok || !check_fok_feasibility(order)) [[unlikely]] {
             order->status = OrderStatus::Rejected;
             pool_.deallocate(order);
             return result;
@@ -42,13 +150,16 @@ MatchResult MatchingEngine::submit_order(Order* order) noexcept {
     }
 
     // Attempt matching
-    match_order(order, result);
+    match_order(order, result, sink, trade_limit);
     result.remaining_quantity = order->remaining_quantity();
+    elect_stops();
 
     // STP cancelled the aggressive order — deallocate and return
-    if (result.status == MatchStatus::SelfTradePrevented) [[unlikely]] {
-        pool_.deallocate(order);
-        return result;
+    if constexpr (Policy::stp != SelfTradePreventionMode::None) {
+        if (result.status == MatchStatus::SelfTradePrevented) [[unlikely]] {
+            pool_.deallocate(order);
+            return result;
+        }
     }
 
     if (order->remaining_quantity() == 0) {
@@ -76,25 +187,65 @@ MatchResult MatchingEngine::submit_order(Order* order) noexcept {
         } else {
             result.status = MatchStatus::Resting;
         }
-        book_.add_order(order);
+        if (!book_.add_order(order).success) [[unlikely]] {
+            // Duplicate ID, or windowed book with a full overflow store
+            result.status = MatchStatus::Rejected;
+            order->status = OrderStatus::Rejected;
+            pool_.deallocate(order);
+        }
     }
 
+    book_.maybe_recenter();
     return result;
 }
 
-bool MatchingEngine::cancel_order(OrderId id) noexcept {
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::cancel_order(OrderId id) noexcept {
     auto cr = book_.cancel_order(id);
     if (cr.success) {
         pool_.deallocate(cr.order);
+        book_.maybe_recenter();
         return true;
     }
+    if (stops_) [[unlikely]] {
+        if (Order* stop = stops_->cancel(id)) {
+            stop->status = OrderStatus::Cancelled;
+            pool_.deallocate(stop);
+            return true;
+        }
+    }
     return false;
 }
 
-MatchResult MatchingEngine::modify_order(OrderId id, Price new_price,
-                                          Quantity new_quantity,
-                                          Timestamp new_timestamp) noexcept {
-    MatchResult result{};
+template <typename Policy>
+MassCancelResult BasicMatchingEngine<Policy>::mass_cancel_impl(
+    ParticipantId participant, bool one_side, Side side) noexcept {
+    MassCancelResult result{0, 0};
+    Order* order = book_.participant_head(participant);
+    while (order) {
+        Order* next = order->participant_next;  // Unlinked below
+        if (!one_side || order->side == side) {
+            result.cancelled_quantity += order->remaining_quantity();
+            ++result.cancelled_count;
+            book_.remove_order(order);
+            order->status = OrderStatus::Cancelled;
+            pool_.deallocate(order);
+        }
+        order = next;
+    }
+    if (result.cancelled_count > 0) {
+        book_.maybe_recenter();
+    }
+    return result;
+}
+
+template <typename Policy>
+MatchSummary BasicMatchingEngine<Policy>::modify_impl(OrderId id, Price new_price,
+                                                      Quantity new_quantity,
+                                                      Timestamp new_timestamp,
+                                                      const TradeSink& sink,
+                                                      uint32_t trade_limit) noexcept {
+    MatchSummary result{};
     result.status = MatchStatus::Rejected;
     result.trade_count = 0;
     result.filled_quantity = 0;
@@ -108,8 +259,17 @@ MatchResult MatchingEngine::modify_order(OrderId id, Price new_price,
     Order* order = mr.order;
     result.remaining_quantity = order->remaining_quantity();
 
-    // Attempt matching at the new price
-    match_order(order, result);
+    // Same-price size-down: amended on the book, priority kept, cannot cross
+    if (mr.in_place) {
+        result.status = MatchStatus::Modified;
+        return result;
+    }
+
+    // Attempt matching at the new price (auction mode: just re-rest)
+    if (!auction_) [[likely]] {
+        match_order(order, result, sink, trade_limit);
+        elect_stops();
+    }
     result.remaining_quantity = order->remaining_quantity();
 
     if (order->remaining_quantity() == 0) {
@@ -125,9 +285,15 @@ MatchResult MatchingEngine::modify_order(OrderId id, Price new_price,
         } else {
             result.status = MatchStatus::Modified;
         }
-        book_.add_order(order);
+        if (!book_.add_order(order).success) [[unlikely]] {
+            // Duplicate ID, or windowed book with a full overflow store
+            result.status = MatchStatus::Rejected;
+            order->status = OrderStatus::Rejected;
+            pool_.deallocate(order);
+        }
     }
 
+    book_.maybe_recenter();
     return result;
 }
 
@@ -135,9 +301,12 @@ MatchResult MatchingEngine::modify_order(OrderId id, Price new_price,
 // Core matching loop
 // ---------------------------------------------------------------------------
 
-void MatchingEngine::match_order(Order* order, MatchResult& result) noexcept {
+template <typename Policy>
+void BasicMatchingEngine<Policy>::match_order(Order* order, MatchSummary& result,
+                                              const TradeSink& sink,
+                                              uint32_t trade_limit) noexcept {
     while (order->remaining_quantity() > 0 &&
-           result.trade_count < MAX_TRADES_PER_MATCH) {
+           result.trade_count < trade_limit) {
 
         // Get the best opposite-side level
         PriceLevel* level = (order->side == Side::Buy)
@@ -147,54 +316,340 @@ void MatchingEngine::match_order(Order* order, MatchResult& result) noexcept {
         if (!level) break;
         if (!price_crosses(order, level)) break;
 
+        // Pro-rata venues share the level out first; the FIFO walk below
+        // then takes the rounding residual (or the whole level)
+        if (allocation_ != AllocationMode::Fifo) [[unlikely]] {
+            if (allocate_pro_rata(order, level, result, sink, trade_limit)) {
+                return;
+            }
+        }
+
         // Walk orders at this price level (FIFO)
         while (order->remaining_quantity() > 0 &&
                !level->empty() &&
-               result.trade_count < MAX_TRADES_PER_MATCH) {
-
-            Order* resting = level->front();
-
-            // Self-trade prevention
-            if (stp_mode_ != SelfTradePreventionMode::None) [[unlikely]] {
-                if (check_self_trade(order, resting)) {
-                    if (handle_self_trade(order, resting, level, result)) {
-                        // Aggressive order was cancelled — stop matching
-                        return;
-                    }
-                    // Resting order was cancelled — continue with next resting
-                    continue;
-                }
+               result.trade_count < trade_limit) {
+            if (fill_against(order, level->front(), order->remaining_quantity(),
+                             level, result, sink)) {
+                // Aggressive order was cancelled by STP — stop matching
+                return;
             }
+        }
+    }
+}
 
-            // Determine fill quantity
-            Quantity resting_available = resting->remaining_visible();
-            Quantity fill_qty = std::min(order->remaining_quantity(),
-                                         resting_available);
-
-            execute_fill(order, resting, fill_qty, level, result);
-
-            // Handle resting order post-fill
-            if (resting->remaining_quantity() == 0) {
-                // Fully filled — remove from book and deallocate
-                book_.remove_order(resting);
-                resting->status = OrderStatus::Filled;
-                pool_.deallocate(resting);
-            } else if (resting->remaining_visible() == 0 &&
-                       resting->type == OrderType::Iceberg) {
-                // Iceberg visible exhausted — remove, replenish, re-add
-                book_.remove_order(resting);
-                replenish_iceberg(resting);
-                book_.add_order(resting);
-            }
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::fill_against(Order* order, Order* resting,
+                                               Quantity cap, PriceLevel* level,
+                                               MatchSummary& result,
+                                               const TradeSink& sink) noexcept {
+    // Self-trade prevention. A cancelled resting order simply drops out.
+    if constexpr (Policy::stp != SelfTradePreventionMode::None) {
+        if (check_self_trade(order, resting)) [[unlikely]] {
+            return handle_self_trade(order, resting, result);
+        }
+    }
+
+    // Determine fill quantity (only icebergs hide part of it)
+    Quantity resting_available = Policy::icebergs
+                                     ? resting->remaining_visible()
+                                     : resting->remaining_quantity();
+    Quantity fill_qty = std::min(cap, resting_available);
+
+    execute_fill(order, resting, fill_qty, level, result, sink);
+    settle_resting(resting);
+    return false;
+}
+
+template <typename Policy>
+void BasicMatchingEngine<Policy>::settle_resting(Order* resting) noexcept {
+    if (resting->remaining_quantity() == 0) {
+        // Fully filled — remove from book and deallocate
+        book_.remove_order(resting);
+        resting->status = OrderStatus::Filled;
+        pool_.deallocate(resting);
+    } else if constexpr (Policy::icebergs) {
+        if (resting->remaining_visible() == 0 &&
+            resting->type == OrderType::Iceberg) {
+            // Iceberg visible exhausted — remove, replenish, re-add
+            book_.remove_order(resting);
+            replenish_iceberg(resting);
+            book_.add_order(resting);
         }
     }
 }
 
+// ---------------------------------------------------------------------------
+// Pro-rata allocation
+// ---------------------------------------------------------------------------
+
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::allocate_pro_rata(Order* order, PriceLevel* level,
+                                                    MatchSummary& result,
+                                                    const TradeSink& sink,
+                                                    uint32_t trade_limit) noexcept {
+    if (allocation_ == AllocationMode::PriceTimeProRata) {
+        // Top-of-queue priority: the oldest order is filled first
+        if (fill_against(order, level->front(), order->remaining_quantity(),
+                         level, result, sink)) {
+            return true;
+        }
+        if (level->empty() || order->remaining_quantity() == 0 ||
+            result.trade_count >= trade_limit) {
+            return false;
+        }
+    }
+
+    // Shares are fixed against the level as it stands now. Taking the whole
+    // level is the same under any allocation — leave it to the FIFO walk.
+    const Quantity incoming = order->remaining_quantity();
+    const Quantity total = level->total_quantity;
+    if (incoming >= total) return false;
+
+    // Single pass. Rounding down keeps the shares' sum <= incoming. Stop at
+    // the current tail: a replenished iceberg re-queues behind it.
+    Order* resting = level->front();
+    Order* const last = level->tail;
+    while (result.trade_count < trade_limit) {
+        Order* next = resting->next;  // fill_against may unlink `resting`
+        const bool at_last = (resting == last);
+
+        Quantity share = mul_div_u64(incoming, resting->remaining_quantity(), total);
+        if (share > 0 &&
+            fill_against(order, resting, share, level, result, sink)) {
+            return true;
+        }
+
+        if (at_last) break;
+        resting = next;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Stop orders
+// ---------------------------------------------------------------------------
+
+template <typename Policy>
+void BasicMatchingEngine<Policy>::accept_stop(Order* order,
+                                              MatchSummary& result) noexcept {
+    // Trigger already reached by the last trade: elect on entry
+    bool triggered = last_trade_price_ != 0 &&
+                     (order->side == Side::Buy
+                          ? last_trade_price_ >= order->stop_price
+                          : last_trade_price_ <= order->stop_price);
+    bool ok = stops_ && (triggered ? stops_->add_elected(order)
+                                   : stops_->add(order));
+    if (!ok) [[unlikely]] {
+        // No stop book, bad trigger price, or duplicate ID
+        order->status = OrderStatus::Rejected;
+        pool_.deallocate(order);
+        return;
+    }
+    order->status = OrderStatus::Accepted;
+    result.status = MatchStatus::Resting;
+}
+
+template <typename Policy>
+void BasicMatchingEngine<Policy>::elect_stops() noexcept {
+    if (trade_low_ > trade_high_) return;  // No trades since the last call
+    if (stops_) [[unlikely]] {
+        stops_->elect(trade_low_, trade_high_);
+    }
+    trade_low_ = INT64_MAX;
+    trade_high_ = INT64_MIN;
+}
+
+template <typename Policy>
+uint32_t BasicMatchingEngine<Policy>::release_stops(const TradeSink& sink) noexcept {
+    if (!stops_) [[likely]] return 0;
+
+    // Each release may elect more stops; they queue behind the current ones
+    uint32_t released = 0;
+    while (Order* order = stops_->pop_elected()) {
+        const OrderId id = order->order_id;
+        if (stop_release_sink_.on_order) [[unlikely]] stop_release_sink_(*order);
+        const MatchSummary summary = submit_impl(order, sink, UINT32_MAX);
+        // `order` is only compared from here on: it may be back in the pool
+        if (stop_rest_sink_.on_order && summary.remaining_quantity != 0 &&
+            (summary.status == MatchStatus::Resting ||
+             summary.status == MatchStatus::PartialFill) &&
+            book_.find_order(id) == order) [[unlikely]] {
+            stop_rest_sink_(*order);
+        }
+        ++released;
+    }
+    return released;
+}
+
+// ---------------------------------------------------------------------------
+// DAY / GTD expiry
+// ---------------------------------------------------------------------------
+
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::arm_expiry(Order* order) noexcept {
+    if (!expiry_) {
+        // Untimed without a wheel: DAY degrades to GTC, GTD cannot be honoured
+        return order->time_in_force == TimeInForce::DAY;
+    }
+    if (order->expire_time == 0 && order->time_in_force == TimeInForce::DAY) {
+        order->expire_time = expiry_->session_close();
+        if (order->expire_time == 0) return true;  // No session close set
+    }
+    if (order->expire_time <= expiry_->clock()) [[unlikely]] {
+        return false;  // GTD without an expiry, or already expired
+    }
+    if (!expiry_->schedule(order->order_id, order->expire_time)) [[unlikely]] {
+        // Full: most timers usually belong to orders filled or cancelled
+        // since, so one purge frees room
+        expiry_->purge(&BasicMatchingEngine::timer_live, this);
+        return expiry_->schedule(order->order_id, order->expire_time);
+    }
+    return true;
+}
+
+template <typename Policy>
+Order* BasicMatchingEngine<Policy>::find_timed(OrderId id,
+                                               Timestamp expire_time) const noexcept {
+    Order* order = book_.find_order(id);
+    if (!order && stops_) {
+        order = stops_->find(id);
+    }
+    return (order && order->expire_time == expire_time) ? order : nullptr;
+}
+
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::timer_live(void* context, OrderId id,
+                                             Timestamp expire_time) noexcept {
+    return static_cast<const BasicMatchingEngine*>(context)->find_timed(
+               id, expire_time) != nullptr;
+}
+
+template <typename Policy>
+uint32_t BasicMatchingEngine<Policy>::expire_orders(Timestamp now,
+                                                    const OrderSink& sink) noexcept {
+    if (!expiry_) return 0;
+
+    uint32_t expired = 0;
+    OrderId id;
+    Timestamp expire_time;
+    while (expiry_->pop_expired(now, id, expire_time)) {
+        // Timers are not disarmed on fill or cancel: skip stale ones
+        Order* order = book_.find_order(id);
+        const bool stop = !order && stops_;
+        if (stop) order = stops_->find(id);
+        if (!order || order->expire_time != expire_time) continue;
+
+        if (stop) {
+            (void)stops_->cancel(id);
+        } else {
+            book_.remove_order(order);
+        }
+        order->status = OrderStatus::Expired;
+        sink(*order);
+        pool_.deallocate(order);
+        ++expired;
+    }
+    if (expired > 0) {
+        book_.maybe_recenter();
+    }
+    return expired;
+}
+
+// ---------------------------------------------------------------------------
+// Call auction
+// ---------------------------------------------------------------------------
+
+template <typename Policy>
+void BasicMatchingEngine<Policy>::accumulate(Order* order,
+                                             MatchSummary& result) noexcept {
+    if (order->type == OrderType::Market || order->type == OrderType::IOC ||
+        order->type == OrderType::FOK) [[unlikely]] {
+        order->status = OrderStatus::Rejected;
+        pool_.deallocate(order);
+        return;
+    }
+    if (!book_.add_order(order).success) [[unlikely]] {
+        order->status = OrderStatus::Rejected;
+        pool_.deallocate(order);
+        return;
+    }
+    result.status = MatchStatus::Resting;
+    book_.maybe_recenter();
+}
+
+template <typename Policy>
+AuctionResult BasicMatchingEngine<Policy>::uncross(Timestamp timestamp,
+                                                   const TradeSink& sink,
+                                                   Price reference_price) noexcept {
+    AuctionResult result{book_.compute_uncross(reference_price), 0};
+    auction_ = false;
+
+    // Pair the best bid and best ask fronts until the equilibrium volume is
+    // done. Every level crossed at the equilibrium price is consumed in
+    // price-time order, so both fronts stay on the right side of it.
+    Quantity left = result.quote.volume;
+    while (left > 0) {
+        PriceLevel* bid_level = book_.best_bid_level();
+        PriceLevel* ask_level = book_.best_ask_level();
+        if (!bid_level || !ask_level) [[unlikely]] break;
+
+        Order* buy = bid_level->front();
+        Order* sell = ask_level->front();
+        Quantity qty = std::min(
+            left, Policy::icebergs
+                      ? std::min(buy->remaining_visible(),
+                                 sell->remaining_visible())
+                      : std::min(buy->remaining_quantity(),
+                                 sell->remaining_quantity()));
+
+        book_.reduce_level_quantity(bid_level, *buy, qty);
+        book_.reduce_level_quantity(ask_level, *sell, qty);
+        buy->filled_quantity += qty;
+        sell->filled_quantity += qty;
+        buy->status = buy->remaining_quantity() == 0 ? OrderStatus::Filled
+                                                     : OrderStatus::PartialFill;
+        sell->status = sell->remaining_quantity() == 0 ? OrderStatus::Filled
+                                                       : OrderStatus::PartialFill;
+
+        Trade trade;
+        trade.trade_id = next_trade_id();
+        trade.resting_participant_id = TRADE_PARTICIPANT_UNKNOWN;
+        trade.aggressor_side = Side::Buy;
+        trade.flags = 0;  // Auction print: no aggressor
+        if (bid_level->total_quantity == 0 || ask_level->total_quantity == 0) {
+            trade.flags |= TRADE_LEVEL_EXHAUSTED;
+        }
+        trade.buy_order_id = buy->order_id;
+        trade.sell_order_id = sell->order_id;
+        trade.price = result.quote.price;
+        trade.quantity = qty;
+        trade.timestamp = timestamp;
+        sink(trade);
+        ++result.trade_count;
+
+        settle_resting(buy);
+        settle_resting(sell);
+        left -= qty;
+    }
+
+    if (result.trade_count > 0) {
+        last_trade_price_ = result.quote.price;
+        trade_low_ = std::min(trade_low_, result.quote.price);
+        trade_high_ = std::max(trade_high_, result.quote.price);
+        elect_stops();
+    }
+
+    book_.maybe_recenter();
+    release_stops(sink);
+    return result;
+}
+
 // ---------------------------------------------------------------------------
 // FOK feasibility check
 // ---------------------------------------------------------------------------
 
-bool MatchingEngine::check_fok_feasibility(const Order* order) const noexcept {
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::check_fok_feasibility(const Order* order) const noexcept {
     // Walk opposite side to see if enough quantity is available.
     // For buy orders: check sell side. For sell orders: check buy side.
     Side opposite = (order->side == Side::Buy) ? Side::Sell : Side::Buy;
@@ -206,11 +661,13 @@ bool MatchingEngine::check_fok_feasibility(const Order* order) const noexcept {
 // Fill execution
 // ---------------------------------------------------------------------------
 
-void MatchingEngine::execute_fill(Order* aggressive, Order* resting,
-                                   Quantity fill_qty, PriceLevel* level,
-                                   MatchResult& result) noexcept {
+template <typename Policy>
+void BasicMatchingEngine<Policy>::execute_fill(Order* aggressive, Order* resting,
+                                               Quantity fill_qty, PriceLevel* level,
+                                               MatchSummary& result,
+                                               const TradeSink& sink) noexcept {
     // Update price level quantity FIRST
-    level->total_quantity -= fill_qty;
+    book_.reduce_level_quantity(level, *resting, fill_qty);
 
     // Update order fill quantities
     aggressive->filled_quantity += fill_qty;
@@ -229,8 +686,13 @@ void MatchingEngine::execute_fill(Order* aggressive, Order* resting,
     }
 
     // Generate trade — price = resting order's price (passive price improvement)
-    Trade& trade = result.trades[result.trade_count];
+    Trade trade;
     trade.trade_id = next_trade_id();
+    trade.resting_participant_id = trade_participant(resting->participant_id);
+    trade.aggressor_side = aggressive->side;
+    trade.flags = TRADE_AGGRESSOR;
+    if (level->total_quantity == 0) trade.flags |= TRADE_LEVEL_EXHAUSTED;
+    if (resting->status == OrderStatus::Filled) trade.flags |= TRADE_RESTING_FILLED;
     trade.buy_order_id = (aggressive->side == Side::Buy)
                              ? aggressive->order_id
                              : resting->order_id;
@@ -240,7 +702,11 @@ void MatchingEngine::execute_fill(Order* aggressive, Order* resting,
     trade.price = resting->price;
     trade.quantity = fill_qty;
     trade.timestamp = aggressive->timestamp;
+    sink(trade);
 
+    last_trade_price_ = trade.price;
+    trade_low_ = std::min(trade_low_, trade.price);
+    trade_high_ = std::max(trade_high_, trade.price);
     ++result.trade_count;
     result.filled_quantity += fill_qty;
 }
@@ -249,42 +715,38 @@ void MatchingEngine::execute_fill(Order* aggressive, Order* resting,
 // Self-trade prevention
 // ---------------------------------------------------------------------------
 
-bool MatchingEngine::check_self_trade(const Order* aggressive,
-                                       const Order* resting) noexcept {
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::check_self_trade(const Order* aggressive,
+                                                   const Order* resting) noexcept {
     return aggressive->participant_id == resting->participant_id;
 }
 
-bool MatchingEngine::handle_self_trade(Order* aggressive, Order* resting,
-                                        PriceLevel* /*level*/,
-                                        MatchResult& result) noexcept {
-    switch (stp_mode_) {
-        case SelfTradePreventionMode::CancelNewest:
-            // Cancel aggressive order — stop matching
-            aggressive->status = OrderStatus::Cancelled;
-            result.status = MatchStatus::SelfTradePrevented;
-            result.remaining_quantity = aggressive->remaining_quantity();
-            return true;  // Stop matching
-
-        case SelfTradePreventionMode::CancelOldest:
-            // Cancel resting order — continue matching
-            book_.remove_order(resting);
-            resting->status = OrderStatus::Cancelled;
-            pool_.deallocate(resting);
-            return false;  // Continue matching
-
-        case SelfTradePreventionMode::CancelBoth:
-            // Cancel both
-            book_.remove_order(resting);
-            resting->status = OrderStatus::Cancelled;
-            pool_.deallocate(resting);
-            aggressive->status = OrderStatus::Cancelled;
-            result.status = MatchStatus::SelfTradePrevented;
-            result.remaining_quantity = aggressive->remaining_quantity();
-            return true;  // Stop matching
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::handle_self_trade(Order* aggressive,
+                                                    Order* resting,
+                                                    MatchSummary& result) noexcept {
+    constexpr SelfTradePreventionMode mode = Policy::stp;
+
+    if constexpr (mode == SelfTradePreventionMode::CancelOldest ||
+                  mode == SelfTradePreventionMode::CancelBoth) {
+        // Cancel resting order
+        book_.remove_order(resting);
+        resting->status = OrderStatus::Cancelled;
+        if (stp_cancel_sink_.on_order) [[unlikely]] stp_cancel_sink_(*resting);
+        pool_.deallocate(resting);
+    }
 
-        case SelfTradePreventionMode::None:
-        default:
-            return false;  // Should not reach here
+    if constexpr (mode == SelfTradePreventionMode::CancelNewest ||
+                  mode == SelfTradePreventionMode::CancelBoth) {
+        // Cancel aggressive order — stop matching
+        aggressive->status = OrderStatus::Cancelled;
+        result.status = MatchStatus::SelfTradePrevented;
+        result.remaining_quantity = aggressive->remaining_quantity();
+        return true;
+    } else {
+        (void)aggressive;
+        (void)result;
+        return false;  // Continue matching (CancelOldest)
     }
 }
 
@@ -292,7 +754,8 @@ bool MatchingEngine::handle_self_trade(Order* aggressive, Order* resting,
 // Iceberg replenishment
 // ---------------------------------------------------------------------------
 
-void MatchingEngine::replenish_iceberg(Order* order) noexcept {
+template <typename Policy>
+void BasicMatchingEngine<Policy>::replenish_iceberg(Order* order) noexcept {
     Quantity remaining = order->remaining_quantity();
     Quantity new_visible = std::min(order->iceberg_slice_qty, remaining);
     // visible_quantity tracks total visible since order creation.
@@ -304,8 +767,9 @@ void MatchingEngine::replenish_iceberg(Order* order) noexcept {
 // Price crossing
 // ---------------------------------------------------------------------------
 
-bool MatchingEngine::price_crosses(const Order* order,
-                                    const PriceLevel* level) noexcept {
+template <typename Policy>
+bool BasicMatchingEngine<Policy>::price_crosses(const Order* order,
+                                                const PriceLevel* level) noexcept {
     // Market orders always cross
     if (order->type == OrderType::Market) [[unlikely]] {
         return true;
@@ -321,8 +785,156 @@ bool MatchingEngine::price_crosses(const Order* order,
 // Trade ID generation
 // ---------------------------------------------------------------------------
 
-uint64_t MatchingEngine::next_trade_id() noexcept {
+template <typename Policy>
+uint64_t BasicMatchingEngine<Policy>::next_trade_id() noexcept {
     return ++trade_id_counter_;
 }
 
+// ---------------------------------------------------------------------------
+// Instantiations
+// ---------------------------------------------------------------------------
+
+#define HFT_INSTANTIATE_MATCHING_ENGINE(stp, icebergs, fok) \
+    template class BasicMatchingEngine<MatchingPolicy<stp, icebergs, fok>>;
+HFT_FOR_EACH_MATCHING_POLICY(HFT_INSTANTIATE_MATCHING_ENGINE)
+#undef HFT_INSTANTIATE_MATCHING_ENGINE
+
+// ---------------------------------------------------------------------------
+// MatchingEngine front
+// ---------------------------------------------------------------------------
+
+namespace {
+
+template <typename Engine>
+constexpr MatchingEngine::Ops OPS_FOR = {
+    [](void* e, Order* order) noexcept {
+        return static_cast<Engine*>(e)->submit_order(order);
+    },
+    [](void* e, Order* order, const TradeSink& sink) noexcept {
+        return static_cast<Engine*>(e)->submit_order(order, sink);
+    },
+    [](void* e, Order* const* orders, size_t count, MatchSummary* results,
+       const TradeSink& sink) noexcept {
+        static_cast<Engine*>(e)->process_batch(orders, count, results, sink);
+    },
+    [](void* e, OrderId id) noexcept {
+        return static_cast<Engine*>(e)->cancel_order(id);
+    },
+    [](void* e, OrderId id, Price price, Quantity quantity,
+       Timestamp timestamp) noexcept {
+        return static_cast<Engine*>(e)->modify_order(id, price, quantity,
+                                                     timestamp);
+    },
+    [](void* e, OrderId id, Price price, Quantity quantity,
+       Timestamp timestamp, const TradeSink& sink) noexcept {
+        return static_cast<Engine*>(e)->modify_order(id, price, quantity,
+                                                     timestamp, sink);
+    },
+    [](const void* e) noexcept {
+        return static_cast<const Engine*>(e)->total_trade_count();
+    },
+    [](void* e) noexcept { static_cast<Engine*>(e)->begin_auction(); },
+    [](const void* e) noexcept {
+        return static_cast<const Engine*>(e)->in_auction();
+    },
+    [](void* e, Timestamp timestamp, const TradeSink& sink,
+       Price reference_price) noexcept {
+        return static_cast<Engine*>(e)->uncross(timestamp, sink,
+                                                reference_price);
+    },
+    [](void* e, StopBook* stops) noexcept {
+        static_cast<Engine*>(e)->attach_stop_book(stops);
+    },
+    [](const void* e) noexcept {
+        return static_cast<const Engine*>(e)->stop_book();
+    },
+    [](void* e, const OrderSink& sink) noexcept {
+        static_cast<Engine*>(e)->set_stop_release_sink(sink);
+    },
+    [](void* e, const OrderSink& sink) noexcept {
+        static_cast<Engine*>(e)->set_stop_rest_sink(sink);
+    },
+    [](void* e, const OrderSink& sink) noexcept {
+        static_cast<Engine*>(e)->set_stp_cancel_sink(sink);
+    },
+    [](void* e, const TradeSink& sink) noexcept {
+        return static_cast<Engine*>(e)->release_stops(sink);
+    },
+    [](const void* e) noexcept {
+        return static_cast<const Engine*>(e)->last_trade_price();
+    },
+    [](void* e, ParticipantId participant, bool one_side, Side side) noexcept {
+        return one_side ? static_cast<Engine*>(e)->mass_cancel(participant, side)
+                        : static_cast<Engine*>(e)->mass_cancel(participant);
+    },
+    [](void* e, ExpiryWheel* wheel) noexcept {
+        static_cast<Engine*>(e)->attach_expiry_wheel(wheel);
+    },
+    [](void* e, Timestamp now, const OrderSink& sink) noexcept {
+        return static_cast<Engine*>(e)->expire_orders(now, sink);
+    },
+    [](void* e, uint64_t trade_count, Price last_trade_price) noexcept {
+        static_cast<Engine*>(e)->restore_trade_state(trade_count, last_trade_price);
+    },
+};
+
+/// Construct the engine for <Stp, features> in `storage`; returns its table.
+template <SelfTradePreventionMode Stp, bool Icebergs, bool Fok>
+const MatchingEngine::Ops* emplace(void* storage, OrderBook& book,
+                                   MemoryPool<Order>& pool,
+                                   AllocationMode allocation) noexcept {
+    using Engine = BasicMatchingEngine<MatchingPolicy<Stp, Icebergs, Fok>>;
+    static_assert(sizeof(Engine) ==
+                      sizeof(BasicMatchingEngine<DefaultMatchingPolicy>) &&
+                  alignof(Engine) ==
+                      alignof(BasicMatchingEngine<DefaultMatchingPolicy>),
+                  "all engine instantiations must share one layout");
+    static_assert(std::is_trivially_destructible_v<Engine>,
+                  "MatchingEngine never runs the engine destructor");
+    new (storage) Engine(book, pool, allocation);
+    return &OPS_FOR<Engine>;
+}
+
+template <SelfTradePreventionMode Stp>
+const MatchingEngine::Ops* emplace(void* storage, OrderBook& book,
+                                   MemoryPool<Order>& pool,
+                                   const MatchingFeatures& f) noexcept {
+    if (f.icebergs) {
+        return f.fok ? emplace<Stp, true, true>(storage, book, pool, f.allocation)
+                     : emplace<Stp, true, false>(storage, book, pool, f.allocation);
+    }
+    return f.fok ? emplace<Stp, false, true>(storage, book, pool, f.allocation)
+                 : emplace<Stp, false, false>(storage, book, pool, f.allocation);
+}
+
+}  // namespace
+
+MatchingEngine::MatchingEngine(OrderBook& book, MemoryPool<Order>& pool,
+                               SelfTradePreventionMode stp,
+                               const MatchingFeatures& features) noexcept
+    : ops_(nullptr), book_(book), expiry_(nullptr), stp_mode_(stp),
+      features_(features) {
+    switch (stp) {
+        case SelfTradePreventionMode::None:
+            ops_ = emplace<SelfTradePreventionMode::None>(storage_, book, pool,
+                                                          features);
+            break;
+        case SelfTradePreventionMode::CancelNewest:
+            ops_ = emplace<SelfTradePreventionMode::CancelNewest>(
+                storage_, book, pool, features);
+            break;
+        case SelfTradePreventionMode::CancelOldest:
+            ops_ = emplace<SelfTradePreventionMode::CancelOldest>(
+                storage_, book, pool, features);
+            break;
+        case SelfTradePreventionMode::CancelBoth:
+            ops_ = emplace<SelfTradePreventionMode::CancelBoth>(
+                storage_, book, pool, features);
+            break;
+    }
+    if (!ops_) [[unlikely]] {
+        std::abort();  // Unknown STP mode
+    }
+}
+
 }  // namespace hft
@@ -7,53 +7,311 @@
 /// trades. Supports Limit, Market, IOC, FOK, GTC, and Iceberg order types.
 /// Self-trade prevention is configurable at construction.
 ///
+/// Within a price level fills go in time priority by default. The ProRata
+/// and PriceTimeProRata allocation modes (futures venues) instead share an
+/// aggressive order that cannot take the whole level in proportion to
+/// resting size — one integer pass over the level, rounding down, with the
+/// leftover lots handed out FIFO.
+///
+/// Call-auction mode (begin_auction / uncross) lets orders accumulate on a
+/// crossed book without matching, then executes them all at a single
+/// equilibrium price in one bulk pass — the opening/closing cross.
+///
 /// Zero heap allocation on the hot path — all trades are returned in a
-/// fixed-size MatchResult struct on the stack.
+/// fixed-size MatchResult struct on the stack (at most MAX_TRADES_PER_MATCH
+/// fills per call), or streamed one by one into a TradeSink (no cap).
+///
+/// Stop and StopLimit orders wait in an attached StopBook. Every batch of
+/// trades elects the stops it traded through, and the streaming calls then
+/// re-inject them through submit_order (Stop as Market, StopLimit as
+/// Limit) in the StopBook's deterministic order, cascading until no more
+/// stops elect.
+///
+/// DAY and GTD orders are timed through an attached ExpiryWheel: each is
+/// armed on entry (GTD at Order::expire_time, DAY at the wheel's session
+/// close unless it carries its own expire_time), and expire_orders() removes
+/// whichever are still live once the clock reaches their expiry. Without a
+/// wheel, DAY orders behave as GTC and GTD orders are rejected.
+///
+/// BasicMatchingEngine<Policy> fixes the STP mode and the iceberg / FOK
+/// feature set at compile time, so the inner matching loop carries no
+/// branches for features an instrument never uses. Orders needing a
+/// disabled feature are rejected. MatchingEngine is the type-erased front
+/// used by the gateway and router: it picks the instantiation matching its
+/// runtime configuration once, at construction, and forwards each call
+/// through a small function table (no virtual dispatch).
 
+#include <cstddef>
 #include <cstdint>
 
 #include "core/order.h"
 #include "core/price_level.h"
 #include "core/types.h"
 #include "matching/match_result.h"
+#include "orderbook/expiry_wheel.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
+#include "orderbook/stop_book.h"
 
 namespace hft {
 
-class MatchingEngine {
+// ---------------------------------------------------------------------------
+// Policies
+// ---------------------------------------------------------------------------
+
+/// Compile-time feature set of a BasicMatchingEngine.
+template <SelfTradePreventionMode Stp, bool Icebergs, bool Fok>
+struct MatchingPolicy {
+    static constexpr SelfTradePreventionMode stp = Stp;
+    static constexpr bool icebergs = Icebergs;  // Iceberg orders accepted
+    static constexpr bool fok = Fok;            // FOK orders accepted
+};
+
+/// Every order type, CancelNewest STP — the classic engine.
+using DefaultMatchingPolicy =
+    MatchingPolicy<SelfTradePreventionMode::CancelNewest, true, true>;
+
+/// Runtime selection of the order-type features (see MatchingEngine).
+struct MatchingFeatures {
+    bool icebergs = true;
+    bool fok = true;
+    /// Level allocation. A runtime setting (checked once per level), not
+    /// part of the compile-time policy.
+    AllocationMode allocation = AllocationMode::Fifo;
+};
+
+/// Outcome of an auction uncross.
+struct AuctionResult {
+    AuctionQuote quote;    // Equilibrium price / volume / surpluses
+    uint32_t trade_count;  // Trades emitted (one per resting-order pair)
+};
+
+// ---------------------------------------------------------------------------
+// BasicMatchingEngine
+// ---------------------------------------------------------------------------
+
+/// Matching engine specialised on `Policy`. Member definitions live in
+/// matching_engine.cpp and are instantiated there for every
+/// MatchingPolicy combination.
+template <typename Policy>
+class BasicMatchingEngine {
 public:
-    /// @param book   Order book to match against (caller owns lifetime).
-    /// @param pool   Memory pool for Order allocation/deallocation.
-    /// @param stp    Self-trade prevention mode.
-    MatchingEngine(OrderBook& book, MemoryPool<Order>& pool,
-                   SelfTradePreventionMode stp = SelfTradePreventionMode::CancelNewest) noexcept;
+    /// How far ahead the batch paths prefetch.
+    static constexpr size_t BATCH_PREFETCH_DISTANCE = 4;
 
-    MatchingEngine(const MatchingEngine&) = delete;
-    MatchingEngine& operator=(const MatchingEngine&) = delete;
+    /// @param book       Order book to match against (caller owns lifetime).
+    /// @param pool       Memory pool for Order allocation/deallocation.
+    /// @param allocation How fills are shared within a price level.
+    BasicMatchingEngine(OrderBook& book, MemoryPool<Order>& pool,
+                        AllocationMode allocation = AllocationMode::Fifo) noexcept
+        : book_(book), pool_(pool), stops_(nullptr), stop_release_sink_{nullptr, nullptr},
+          stop_rest_sink_{nullptr, nullptr}, stp_cancel_sink_{nullptr, nullptr},
+          expiry_(nullptr), trade_id_counter_(0),
+          last_trade_price_(0), trade_low_(INT64_MAX), trade_high_(INT64_MIN),
+          auction_(false), allocation_(allocation) {}
+
+    BasicMatchingEngine(const BasicMatchingEngine&) = delete;
+    BasicMatchingEngine& operator=(const BasicMatchingEngine&) = delete;
 
     /// Submit an order for matching. The order must be allocated from `pool_`.
     /// Fully filled orders are deallocated. Remaining GTC/Limit orders rest
     /// on the book. IOC/Market remainders are cancelled and deallocated.
+    /// Iceberg/FOK orders are rejected if the policy disables them.
     [[nodiscard]] MatchResult submit_order(Order* order) noexcept;
 
-    /// Cancel an order by ID. Removes from book and deallocates from pool.
+    /// Streaming submit: same semantics, but each trade goes to `sink` as it
+    /// executes and the sweep is not capped at MAX_TRADES_PER_MATCH. Stops
+    /// elected by the trades are then released (see release_stops()); their
+    /// trades go to the same sink.
+    [[nodiscard]] MatchSummary submit_order(Order* order,
+                                            const TradeSink& sink) noexcept;
+
+    /// Batch submit: streaming submit_order() for orders[0..count) in order,
+    /// writing results[i] for each. While order i matches, the index slot and
+    /// level head of order i + BATCH_PREFETCH_DISTANCE are prefetched, so
+    /// their cache misses overlap useful work. Strictly sequential — the
+    /// outcome is identical to calling submit_order() in a loop.
+    void process_batch(Order* const* orders, size_t count,
+                       MatchSummary* results, const TradeSink& sink) noexcept;
+
+    /// Cancel an order by ID — resting, or a stop (waiting or elected).
+    /// Removes it and deallocates from pool.
     [[nodiscard]] bool cancel_order(OrderId id) noexcept;
 
-    /// Modify a resting order's price and/or quantity. The order loses time
-    /// priority (cancel-and-replace semantics). If the new price crosses the
+    /// Cancel every resting order of `participant` (kill switch, disconnect)
+    /// in one walk of its participant list: each is unlinked and
+    /// deallocated. Stop orders are not included.
+    [[nodiscard]] MassCancelResult mass_cancel(ParticipantId participant) noexcept {
+        return mass_cancel_impl(participant, false, Side::Buy);
+    }
+
+    /// Mass cancel restricted to one side.
+    [[nodiscard]] MassCancelResult mass_cancel(ParticipantId participant,
+                                               Side side) noexcept {
+        return mass_cancel_impl(participant, true, side);
+    }
+
+    /// Modify a resting order's price and/or quantity. A same-price size-down
+    /// is amended in place and keeps time priority; any other change loses it
+    /// (cancel-and-replace semantics). If the new price crosses the
     /// opposite side, matching occurs.
     [[nodiscard]] MatchResult modify_order(OrderId id, Price new_price,
                                            Quantity new_quantity,
                                            Timestamp new_timestamp) noexcept;
 
-    [[nodiscard]] SelfTradePreventionMode stp_mode() const noexcept { return stp_mode_; }
+    /// Streaming modify — see the streaming submit_order().
+    [[nodiscard]] MatchSummary modify_order(OrderId id, Price new_price,
+                                            Quantity new_quantity,
+                                            Timestamp new_timestamp,
+                                            const TradeSink& sink) noexcept;
+
+    /// Enter call-auction mode. Until uncross(), Limit/GTC/Iceberg orders
+    /// (and modifies) rest on the book without matching, even when they
+    /// cross; Market/IOC/FOK orders are rejected. Cancels work as usual.
+    void begin_auction() noexcept { auction_ = true; }
+    [[nodiscard]] bool in_auction() const noexcept { return auction_; }
+
+    /// Equilibrium the book would uncross at right now (no side effects).
+    [[nodiscard]] AuctionQuote indicative_uncross(
+        Price reference_price = 0) const noexcept {
+        return book_.compute_uncross(reference_price);
+    }
+
+    /// Execute the auction: every crossing order trades at the single
+    /// equilibrium price (see OrderBook::compute_uncross), best-priced and
+    /// then oldest orders first on each side. Trades go to `sink` stamped
+    /// with `timestamp`. Self-trade prevention is not applied to the cross.
+    /// Leaves the book uncrossed and returns to continuous matching.
+    AuctionResult uncross(Timestamp timestamp, const TradeSink& sink,
+                          Price reference_price = 0) noexcept;
+
+    /// Attach the trigger book for Stop/StopLimit orders (caller owns it;
+    /// it must mirror this engine's book). Without one, stops are rejected.
+    /// A stop whose trigger the last trade already reached is elected on
+    /// entry.
+    void attach_stop_book(StopBook* stops) noexcept { stops_ = stops; }
+    [[nodiscard]] StopBook* stop_book() const noexcept { return stops_; }
+
+    /// Tell `sink` about every elected stop just before it is submitted, so
+    /// its trades can be credited to its owner (the stop is the aggressor of
+    /// the trades that follow, up to the next call). Pass {nullptr, nullptr}
+    /// to detach.
+    void set_stop_release_sink(const OrderSink& sink) noexcept { stop_release_sink_ = sink; }
+
+    /// Tell `sink` about every released stop that comes to rest on the book
+    /// (it was not on the book while it waited for its trigger). Pass
+    /// {nullptr, nullptr} to detach.
+    void set_stop_rest_sink(const OrderSink& sink) noexcept { stop_rest_sink_ = sink; }
+
+    /// Tell `sink` about every resting order that self-trade prevention
+    /// cancels (CancelOldest / CancelBoth), just before it returns to the
+    /// pool. Pass {nullptr, nullptr} to detach.
+    void set_stp_cancel_sink(const OrderSink& sink) noexcept { stp_cancel_sink_ = sink; }
+
+    /// Submit every elected stop, in election order, streaming trades into
+    /// `sink`; stops those submissions elect are released in turn. The
+    /// streaming calls do this themselves. Stops elected by a MatchResult
+    /// call stay queued until the next streaming call or release_stops().
+    /// Returns the number of orders released.
+    uint32_t release_stops(const TradeSink& sink) noexcept;
+
+    /// Price of the most recent trade (0 before the first).
+    [[nodiscard]] Price last_trade_price() const noexcept { return last_trade_price_; }
+
+    /// Attach the timer wheel for DAY/GTD orders (caller owns it). Orders
+    /// accepted before this are never timed.
+    void attach_expiry_wheel(ExpiryWheel* wheel) noexcept { expiry_ = wheel; }
+    [[nodiscard]] ExpiryWheel* expiry_wheel() const noexcept { return expiry_; }
+
+    /// Advance the expiry clock to `now` and remove every resting order or
+    /// stop whose expiry has been reached: each is marked Expired, passed
+    /// to `sink` and deallocated. Returns the number expired.
+    uint32_t expire_orders(Timestamp now, const OrderSink& sink) noexcept;
+
+    [[nodiscard]] static constexpr SelfTradePreventionMode stp_mode() noexcept {
+        return Policy::stp;
+    }
+    [[nodiscard]] AllocationMode allocation() const noexcept { return allocation_; }
     [[nodiscard]] uint64_t total_trade_count() const noexcept { return trade_id_counter_; }
     [[nodiscard]] const OrderBook& book() const noexcept { return book_; }
 
+    /// Snapshot restore: continue trade ids after `trade_count` and stop
+    /// triggers from `last_trade_price`.
+    void restore_trade_state(uint64_t trade_count, Price last_trade_price) noexcept {
+        trade_id_counter_ = trade_count;
+        last_trade_price_ = last_trade_price;
+    }
+
+    /// Drain the book's journalled level changes (OrderBook::take_level_deltas).
+    size_t take_level_deltas(LevelDelta* out, size_t max) noexcept {
+        return book_.take_level_deltas(out, max);
+    }
+
 private:
+    /// Entry point of a new order: arms its expiry timer, then
+    /// submit_impl(). Released stops skip this (their timer is armed).
+    [[nodiscard]] MatchSummary submit_new(Order* order, const TradeSink& sink,
+                                          uint32_t trade_limit) noexcept;
+
+    /// Resolve and arm a DAY/GTD order's expiry. False if the order must be
+    /// rejected: GTD without a wheel or expiry, already expired, or no
+    /// timer left even after purging stale ones.
+    [[nodiscard]] bool arm_expiry(Order* order) noexcept;
+
+    /// ExpiryWheel::LiveCheck: the order is still resting (or a stop) with
+    /// this expiry.
+    static bool timer_live(void* context, OrderId id,
+                           Timestamp expire_time) noexcept;
+
+    /// Resting order or stop `id`, if its expire_time is `expire_time`.
+    [[nodiscard]] Order* find_timed(OrderId id, Timestamp expire_time) const noexcept;
+
+    /// Shared by both submit forms; stops after `trade_limit` trades.
+    [[nodiscard]] MatchSummary submit_impl(Order* order, const TradeSink& sink,
+                                           uint32_t trade_limit) noexcept;
+    [[nodiscard]] MatchSummary modify_impl(OrderId id, Price new_price,
+                                           Quantity new_quantity,
+                                           Timestamp new_timestamp,
+                                           const TradeSink& sink,
+                                           uint32_t trade_limit) noexcept;
+
+    [[nodiscard]] MassCancelResult mass_cancel_impl(ParticipantId participant,
+                                                    bool one_side,
+                                                    Side side) noexcept;
+
+    /// Rest (or elect) an incoming Stop/StopLimit order in stops_.
+    void accept_stop(Order* order, MatchSummary& result) noexcept;
+
+    /// Elect the stops crossed by the trades since the last call.
+    void elect_stops() noexcept;
+
+    /// Auction mode: rest an order without matching (Market/IOC/FOK are
+    /// rejected).
+    void accumulate(Order* order, MatchSummary& result) noexcept;
+
     /// Core matching loop — walks opposite side levels, fills, generates trades.
-    void match_order(Order* order, MatchResult& result) noexcept;
+    void match_order(Order* order, MatchSummary& result, const TradeSink& sink,
+                     uint32_t trade_limit) noexcept;
+
+    /// Pro-rata pass over `level` (allocation_ != Fifo): each resting order
+    /// gets floor(incoming * its size / level size), capped at what it
+    /// shows; PriceTimeProRata fills the front order first. Does nothing if
+    /// the order can take the whole level. Leftover lots are left for the
+    /// FIFO walk. Returns true if STP cancelled the aggressive order.
+    [[nodiscard]] bool allocate_pro_rata(Order* order, PriceLevel* level,
+                                         MatchSummary& result,
+                                         const TradeSink& sink,
+                                         uint32_t trade_limit) noexcept;
+
+    /// Fill up to `cap` against one resting order, applying STP first.
+    /// Returns true if STP cancelled the aggressive order.
+    [[nodiscard]] bool fill_against(Order* order, Order* resting, Quantity cap,
+                                    PriceLevel* level, MatchSummary& result,
+                                    const TradeSink& sink) noexcept;
+
+    /// Post-fill handling of an order that stays on the book: remove it
+    /// once filled, or replenish an exhausted iceberg slice.
+    void settle_resting(Order* resting) noexcept;
 
     /// Check if a FOK order can be fully filled before attempting to match.
     [[nodiscard]] bool check_fok_feasibility(const Order* order) const noexcept;
@@ -61,17 +319,16 @@ private:
     /// Execute a fill between aggressive and resting orders.
     void execute_fill(Order* aggressive, Order* resting,
                       Quantity fill_qty, PriceLevel* level,
-                      MatchResult& result) noexcept;
+                      MatchSummary& result, const TradeSink& sink) noexcept;
 
     /// Check if two orders would be a self-trade.
     [[nodiscard]] static bool check_self_trade(const Order* aggressive,
                                                const Order* resting) noexcept;
 
-    /// Handle a self-trade according to stp_mode_. Returns true if the
+    /// Handle a self-trade according to Policy::stp. Returns true if the
     /// aggressive order should stop matching (was cancelled).
     [[nodiscard]] bool handle_self_trade(Order* aggressive, Order* resting,
-                                         PriceLevel* level,
-                                         MatchResult& result) noexcept;
+                                         MatchSummary& result) noexcept;
 
     /// Replenish an iceberg order's visible quantity after it's been fully matched.
     static void replenish_iceberg(Order* order) noexcept;
@@ -85,8 +342,245 @@ private:
 
     OrderBook& book_;
     MemoryPool<Order>& pool_;
-    SelfTradePreventionMode stp_mode_;
+    StopBook* stops_;         // Optional trigger book
+    OrderSink stop_release_sink_;  // Optional: stops about to be submitted
+    OrderSink stop_rest_sink_;  // Optional: released stops that rest
+    OrderSink stp_cancel_sink_;  // Optional: resting orders STP cancels
+    ExpiryWheel* expiry_;     // Optional DAY/GTD timers
     uint64_t trade_id_counter_;
+    Price last_trade_price_;
+    Price trade_low_;         // Trade price range since the last election
+    Price trade_high_;
+    bool auction_;  // Call-auction mode: accumulate, don't match
+    AllocationMode allocation_;
+};
+
+/// Apply X(stp, icebergs, fok) to every supported policy combination.
+#define HFT_FOR_EACH_MATCHING_POLICY(X)                              \
+    X(SelfTradePreventionMode::None, true, true)                     \
+    X(SelfTradePreventionMode::None, true, false)                    \
+    X(SelfTradePreventionMode::None, false, true)                    \
+    X(SelfTradePreventionMode::None, false, false)                   \
+    X(SelfTradePreventionMode::CancelNewest, true, true)             \
+    X(SelfTradePreventionMode::CancelNewest, true, false)            \
+    X(SelfTradePreventionMode::CancelNewest, false, true)            \
+    X(SelfTradePreventionMode::CancelNewest, false, false)           \
+    X(SelfTradePreventionMode::CancelOldest, true, true)             \
+    X(SelfTradePreventionMode::CancelOldest, true, false)            \
+    X(SelfTradePreventionMode::CancelOldest, false, true)            \
+    X(SelfTradePreventionMode::CancelOldest, false, false)           \
+    X(SelfTradePreventionMode::CancelBoth, true, true)               \
+    X(SelfTradePreventionMode::CancelBoth, true, false)              \
+    X(SelfTradePreventionMode::CancelBoth, false, true)              \
+    X(SelfTradePreventionMode::CancelBoth, false, false)
+
+#define HFT_EXTERN_MATCHING_ENGINE(stp, icebergs, fok) \
+    extern template class BasicMatchingEngine<MatchingPolicy<stp, icebergs, fok>>;
+HFT_FOR_EACH_MATCHING_POLICY(HFT_EXTERN_MATCHING_ENGINE)
+#undef HFT_EXTERN_MATCHING_ENGINE
+
+// ---------------------------------------------------------------------------
+// MatchingEngine — runtime-configured front
+// ---------------------------------------------------------------------------
+
+class MatchingEngine {
+public:
+    /// How far ahead the batch paths prefetch.
+    static constexpr size_t BATCH_PREFETCH_DISTANCE =
+        BasicMatchingEngine<DefaultMatchingPolicy>::BATCH_PREFETCH_DISTANCE;
+
+    /// @param book     Order book to match against (caller owns lifetime).
+    /// @param pool     Memory pool for Order allocation/deallocation.
+    /// @param stp      Self-trade prevention mode.
+    /// @param features Order types this instance accepts; disabled ones are
+    ///                 compiled out of the matching loop and rejected.
+    ///                 Also carries the level allocation mode.
+    MatchingEngine(OrderBook& book, MemoryPool<Order>& pool,
+                   SelfTradePreventionMode stp = SelfTradePreventionMode::CancelNewest,
+                   const MatchingFeatures& features = {}) noexcept;
+
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    /// See BasicMatchingEngine::submit_order().
+    [[nodiscard]] MatchResult submit_order(Order* order) noexcept {
+        return ops_->submit(storage_, order);
+    }
+
+    /// See the streaming BasicMatchingEngine::submit_order().
+    [[nodiscard]] MatchSummary submit_order(Order* order,
+                                            const TradeSink& sink) noexcept {
+        return ops_->submit_streaming(storage_, order, sink);
+    }
+
+    /// See BasicMatchingEngine::process_batch().
+    void process_batch(Order* const* orders, size_t count,
+                       MatchSummary* results, const TradeSink& sink) noexcept {
+        ops_->batch(storage_, orders, count, results, sink);
+    }
+
+    /// See BasicMatchingEngine::cancel_order().
+    [[nodiscard]] bool cancel_order(OrderId id) noexcept {
+        return ops_->cancel(storage_, id);
+    }
+
+    /// See BasicMatchingEngine::mass_cancel().
+    [[nodiscard]] MassCancelResult mass_cancel(ParticipantId participant) noexcept {
+        return ops_->mass_cancel(storage_, participant, false, Side::Buy);
+    }
+    [[nodiscard]] MassCancelResult mass_cancel(ParticipantId participant,
+                                               Side side) noexcept {
+        return ops_->mass_cancel(storage_, participant, true, side);
+    }
+
+    /// See BasicMatchingEngine::modify_order().
+    [[nodiscard]] MatchResult modify_order(OrderId id, Price new_price,
+                                           Quantity new_quantity,
+                                           Timestamp new_timestamp) noexcept {
+        return ops_->modify(storage_, id, new_price, new_quantity,
+                            new_timestamp);
+    }
+
+    /// See the streaming BasicMatchingEngine::modify_order().
+    [[nodiscard]] MatchSummary modify_order(OrderId id, Price new_price,
+                                            Quantity new_quantity,
+                                            Timestamp new_timestamp,
+                                            const TradeSink& sink) noexcept {
+        return ops_->modify_streaming(storage_, id, new_price, new_quantity,
+                                      new_timestamp, sink);
+    }
+
+    /// See BasicMatchingEngine::begin_auction().
+    void begin_auction() noexcept { ops_->begin_auction(storage_); }
+    [[nodiscard]] bool in_auction() const noexcept {
+        return ops_->in_auction(storage_);
+    }
+
+    /// See BasicMatchingEngine::indicative_uncross().
+    [[nodiscard]] AuctionQuote indicative_uncross(
+        Price reference_price = 0) const noexcept {
+        return book_.compute_uncross(reference_price);
+    }
+
+    /// See BasicMatchingEngine::uncross().
+    AuctionResult uncross(Timestamp timestamp, const TradeSink& sink,
+                          Price reference_price = 0) noexcept {
+        return ops_->uncross(storage_, timestamp, sink, reference_price);
+    }
+
+    /// See BasicMatchingEngine::attach_stop_book().
+    void attach_stop_book(StopBook* stops) noexcept {
+        ops_->attach_stop_book(storage_, stops);
+    }
+    [[nodiscard]] StopBook* stop_book() const noexcept {
+        return ops_->stop_book(storage_);
+    }
+
+    /// See BasicMatchingEngine::set_stop_release_sink().
+    void set_stop_release_sink(const OrderSink& sink) noexcept {
+        ops_->set_stop_release_sink(storage_, sink);
+    }
+
+    /// See BasicMatchingEngine::set_stop_rest_sink().
+    void set_stop_rest_sink(const OrderSink& sink) noexcept {
+        ops_->set_stop_rest_sink(storage_, sink);
+    }
+
+    /// See BasicMatchingEngine::set_stp_cancel_sink().
+    void set_stp_cancel_sink(const OrderSink& sink) noexcept {
+        ops_->set_stp_cancel_sink(storage_, sink);
+    }
+
+    /// See BasicMatchingEngine::release_stops().
+    uint32_t release_stops(const TradeSink& sink) noexcept {
+        return ops_->release_stops(storage_, sink);
+    }
+
+    [[nodiscard]] Price last_trade_price() const noexcept {
+        return ops_->last_trade_price(storage_);
+    }
+
+    /// See BasicMatchingEngine::attach_expiry_wheel().
+    void attach_expiry_wheel(ExpiryWheel* wheel) noexcept {
+        expiry_ = wheel;
+        ops_->attach_expiry_wheel(storage_, wheel);
+    }
+    [[nodiscard]] ExpiryWheel* expiry_wheel() const noexcept { return expiry_; }
+
+    /// See BasicMatchingEngine::expire_orders(). Inline check first: the
+    /// call through the table is made only when a timer may be due.
+    uint32_t expire_orders(Timestamp now, const OrderSink& sink) noexcept {
+        if (!expiry_ || !expiry_->due(now)) [[likely]] return 0;
+        return ops_->expire_orders(storage_, now, sink);
+    }
+
+    [[nodiscard]] SelfTradePreventionMode stp_mode() const noexcept { return stp_mode_; }
+    [[nodiscard]] const MatchingFeatures& features() const noexcept { return features_; }
+    [[nodiscard]] uint64_t total_trade_count() const noexcept {
+        return ops_->trade_count(storage_);
+    }
+    [[nodiscard]] const OrderBook& book() const noexcept { return book_; }
+
+    /// Idle-time upkeep of the book's order index (OrderBook::maintain_index).
+    bool maintain_book() noexcept { return book_.maintain_index(); }
+
+    /// See BasicMatchingEngine::restore_trade_state().
+    void restore_trade_state(uint64_t trade_count, Price last_trade_price) noexcept {
+        ops_->restore_trade_state(storage_, trade_count, last_trade_price);
+    }
+
+    /// Drain the book's journalled level changes (OrderBook::take_level_deltas).
+    size_t take_level_deltas(LevelDelta* out, size_t max) noexcept {
+        return book_.take_level_deltas(out, max);
+    }
+
+    /// Function table over one BasicMatchingEngine instantiation.
+    struct Ops {
+        MatchResult (*submit)(void* engine, Order* order) noexcept;
+        MatchSummary (*submit_streaming)(void* engine, Order* order,
+                                         const TradeSink& sink) noexcept;
+        void (*batch)(void* engine, Order* const* orders, size_t count,
+                      MatchSummary* results, const TradeSink& sink) noexcept;
+        bool (*cancel)(void* engine, OrderId id) noexcept;
+        MatchResult (*modify)(void* engine, OrderId id, Price new_price,
+                              Quantity new_quantity,
+                              Timestamp new_timestamp) noexcept;
+        MatchSummary (*modify_streaming)(void* engine, OrderId id,
+                                         Price new_price, Quantity new_quantity,
+                                         Timestamp new_timestamp,
+                                         const TradeSink& sink) noexcept;
+        uint64_t (*trade_count)(const void* engine) noexcept;
+        void (*begin_auction)(void* engine) noexcept;
+        bool (*in_auction)(const void* engine) noexcept;
+        AuctionResult (*uncross)(void* engine, Timestamp timestamp,
+                                 const TradeSink& sink,
+                                 Price reference_price) noexcept;
+        void (*attach_stop_book)(void* engine, StopBook* stops) noexcept;
+        StopBook* (*stop_book)(const void* engine) noexcept;
+        void (*set_stop_release_sink)(void* engine, const OrderSink& sink) noexcept;
+        void (*set_stop_rest_sink)(void* engine, const OrderSink& sink) noexcept;
+        void (*set_stp_cancel_sink)(void* engine, const OrderSink& sink) noexcept;
+        uint32_t (*release_stops)(void* engine, const TradeSink& sink) noexcept;
+        Price (*last_trade_price)(const void* engine) noexcept;
+        MassCancelResult (*mass_cancel)(void* engine, ParticipantId participant,
+                                        bool one_side, Side side) noexcept;
+        void (*attach_expiry_wheel)(void* engine, ExpiryWheel* wheel) noexcept;
+        uint32_t (*expire_orders)(void* engine, Timestamp now,
+                                  const OrderSink& sink) noexcept;
+        void (*restore_trade_state)(void* engine, uint64_t trade_count,
+                                    Price last_trade_price) noexcept;
+    };
+
+private:
+    // Every instantiation has the same members, so one buffer fits any.
+    using Storage = BasicMatchingEngine<DefaultMatchingPolicy>;
+
+    alignas(Storage) unsigned char storage_[sizeof(Storage)];
+    const Ops* ops_;
+    OrderBook& book_;
+    ExpiryWheel* expiry_;  // Mirrors the engine's, for the inline due check
+    SelfTradePreventionMode stp_mode_;
+    MatchingFeatures features_;
 };
 
 }  // namespace hft
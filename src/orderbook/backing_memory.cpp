@@ -0,0 +1,270 @@
+/// @file backing_memory.cpp
+/// @brief Huge-page / NUMA-aware allocation for startup-time hot-path blocks.
+
+#include "orderbook/backing_memory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace hft {
+
+namespace {
+
+constexpr size_t SMALL_PAGE = size_t{4} << 10;
+constexpr size_t HUGE_2MB = size_t{2} << 20;
+constexpr size_t HUGE_1GB = size_t{1} << 30;
+
+size_t round_up(size_t n, size_t to) noexcept {
+    return (n + to - 1) / to * to;
+}
+
+size_t page_bytes(PageMode mode) noexcept {
+    switch (mode) {
+        case PageMode::Huge1GB: return HUGE_1GB;
+        case PageMode::Huge2MB:
+        case PageMode::Transparent: return HUGE_2MB;
+        case PageMode::Default: break;
+    }
+    return SMALL_PAGE;
+}
+
+/// Write one byte per page so the kernel backs the whole block now.
+void touch_pages(void* data, size_t bytes, size_t stride) noexcept {
+    volatile char* p = static_cast<volatile char*>(data);
+    for (size_t off = 0; off < bytes; off += stride) {
+        p[off] = 0;
+    }
+}
+
+#ifdef __linux__
+
+// Linux UAPI values (linux/mman.h, linux/mempolicy.h). Spelled out here so
+// the build needs neither libnuma nor recent kernel headers.
+constexpr int HUGE_SHIFT = 26;
+constexpr int HUGE_FLAG_2MB = 21 << HUGE_SHIFT;
+constexpr int HUGE_FLAG_1GB = 30 << HUGE_SHIFT;
+constexpr int POLICY_BIND = 2;     // MPOL_BIND
+constexpr unsigned POLICY_MOVE = 2;  // MPOL_MF_MOVE
+
+void* map_anonymous(size_t bytes, int extra_flags) noexcept {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return (p == MAP_FAILED) ? nullptr : p;
+}
+
+int current_numa_node() noexcept {
+#ifdef SYS_getcpu
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return MemoryBacking::NUMA_ANY;
+}
+
+bool bind_to_node(void* data, size_t bytes, int node) noexcept {
+#ifdef SYS_mbind
+    if (node < 0 || node >= 64) return false;
+    unsigned long mask = 1UL << node;
+    return ::syscall(SYS_mbind, data, bytes, POLICY_BIND, &mask,
+                     sizeof(mask) * 8, POLICY_MOVE) == 0;
+#else
+    (void)data;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+}
+
+/// Try each page mode from `want` downwards until a mapping succeeds.
+BackingRegion map_region(size_t bytes, PageMode want) noexcept {
+    BackingRegion region;
+
+    if (want == PageMode::Huge1GB) {
+        size_t len = round_up(bytes, HUGE_1GB);
+        if (void* p = map_anonymous(len, MAP_HUGETLB | HUGE_FLAG_1GB)) {
+            region.data = p;
+            region.bytes = len;
+            region.pages = PageMode::Huge1GB;
+            return region;
+        }
+        want = PageMode::Huge2MB;
+    }
+    if (want == PageMode::Huge2MB) {
+        size_t len = round_up(bytes, HUGE_2MB);
+        if (void* p = map_anonymous(len, MAP_HUGETLB | HUGE_FLAG_2MB)) {
+            region.data = p;
+            region.bytes = len;
+            region.pages = PageMode::Huge2MB;
+            return region;
+        }
+        want = PageMode::Transparent;  // No reserved hugetlbfs pages
+    }
+    if (want == PageMode::Transparent) {
+        size_t len = round_up(bytes, HUGE_2MB);
+        if (void* p = map_anonymous(len, 0)) {
+            region.data = p;
+            region.bytes = len;
+            region.pages = (::madvise(p, len, MADV_HUGEPAGE) == 0)
+                               ? PageMode::Transparent
+                               : PageMode::Default;
+            return region;
+        }
+    }
+
+    size_t len = round_up(bytes, SMALL_PAGE);
+    region.data = map_anonymous(len, 0);
+    region.bytes = len;
+    region.pages = PageMode::Default;
+    return region;
+}
+
+#endif  // __linux__
+
+void* heap_alloc(size_t bytes, size_t alignment) noexcept {
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::calloc(bytes, 1);
+    }
+    size_t len = round_up(bytes, alignment);
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(len, alignment);
+#else
+    void* p = std::aligned_alloc(alignment, len);
+#endif
+    if (p) std::memset(p, 0, len);
+    return p;
+}
+
+void heap_free(void* p, size_t alignment) noexcept {
+#ifdef _MSC_VER
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+
+}  // namespace
+
+BackingRegion allocate_backing(size_t bytes, size_t alignment,
+                               const MemoryBacking& backing) noexcept {
+    if (bytes == 0) bytes = 1;
+    BackingRegion region;
+
+#ifdef __linux__
+    // Anything beyond plain pages needs page-granular anonymous memory.
+    if (backing.pages != PageMode::Default ||
+        backing.numa_node != MemoryBacking::NUMA_ANY) {
+        region = map_region(bytes, backing.pages);
+        if (!region.data) {
+            std::abort();  // Startup failure — no recovery
+        }
+        region.mapped = true;
+
+        int node = (backing.numa_node == MemoryBacking::NUMA_LOCAL)
+                       ? current_numa_node()
+                       : backing.numa_node;
+        if (node >= 0) {
+            // Bind before the first touch so pages are placed, not migrated.
+            region.numa_bound = bind_to_node(region.data, region.bytes, node);
+        }
+        if (backing.prefault) {
+            touch_pages(region.data, region.bytes, page_bytes(region.pages));
+        }
+        return region;
+    }
+#endif
+
+    region.data = heap_alloc(bytes, alignment);
+    if (!region.data) {
+        std::abort();  // Startup failure — no recovery
+    }
+    region.bytes = bytes;
+    region.alignment = alignment;
+    if (backing.prefault) {
+        touch_pages(region.data, bytes, SMALL_PAGE);
+    }
+    return region;
+}
+
+void release_backing(BackingRegion& region) noexcept {
+    if (!region.data) return;
+#ifdef __linux__
+    if (region.mapped) {
+        ::munmap(region.data, region.bytes);
+        region = BackingRegion{};
+        return;
+    }
+#endif
+    heap_free(region.data, region.alignment);
+    region = BackingRegion{};
+}
+
+size_t resident_bytes(const void* data, size_t bytes) noexcept {
+    if (!data || bytes == 0) return 0;
+#ifdef __linux__
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) return bytes;
+    const size_t page = static_cast<size_t>(page_size);
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data) / page * page;
+    const uintptr_t end =
+        round_up(reinterpret_cast<uintptr_t>(data) + bytes, page);
+
+    // One status byte per page, a bounded chunk at a time
+    constexpr size_t CHUNK_PAGES = 1024;
+    unsigned char status[CHUNK_PAGES];
+    size_t resident = 0;
+    for (uintptr_t at = begin; at < end; at += CHUNK_PAGES * page) {
+        const size_t pages = std::min<size_t>(CHUNK_PAGES, (end - at) / page);
+        if (::mincore(reinterpret_cast<void*>(at), pages * page, status) != 0) {
+            return bytes;  // Not queryable: report it as touched
+        }
+        for (size_t i = 0; i < pages; ++i) {
+            if (status[i] & 1) resident += page;
+        }
+    }
+    return std::min(resident, bytes);
+#else
+    return bytes;
+#endif
+}
+
+MemoryUsage backing_usage(const BackingRegion& region) noexcept {
+    return heap_usage(region.data, region.bytes);
+}
+
+MemoryUsage heap_usage(const void* data, size_t bytes) noexcept {
+    MemoryUsage usage;
+    if (!data) return usage;
+    usage.reserved_bytes = bytes;
+    usage.touched_bytes = resident_bytes(data, bytes);
+    usage.high_water_bytes = usage.touched_bytes;
+    return usage;
+}
+
+const char* page_mode_name(PageMode mode) noexcept {
+    switch (mode) {
+        case PageMode::Default: return "default";
+        case PageMode::Transparent: return "thp";
+        case PageMode::Huge2MB: return "huge-2mb";
+        case PageMode::Huge1GB: return "huge-1gb";
+    }
+    return "unknown";
+}
+
+}  // namespace hft
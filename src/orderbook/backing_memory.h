@@ -0,0 +1,107 @@
+#pragma once
+
+/// @file backing_memory.h
+/// @brief Pluggable backing store for the large pre-allocated hot-path arrays.
+///
+/// Startup-only component — every call here happens at construction or
+/// destruction, never on the order path. MemoryPool, FlatOrderMap and the
+/// OrderBook level arrays obtain their single big block through
+/// allocate_backing(), so one MemoryBacking value decides for an instrument:
+///
+///   - page size: regular 4 KB pages, transparent huge pages (madvise), or
+///     explicit 2 MB / 1 GB hugetlbfs pages (MAP_HUGETLB);
+///   - NUMA placement: bind the block to a node, or to the node of the
+///     constructing thread (construct the pipeline on the matching thread);
+///   - eager pre-fault: touch every page up front so first-touch faults do
+///     not land in the first trading burst.
+///
+/// Requests degrade rather than fail: if no hugetlbfs pages are reserved the
+/// block falls back to THP, then to regular pages. BackingRegion::pages
+/// records what was actually granted. Non-Linux builds always get heap
+/// memory; NUMA binding is silently skipped.
+///
+/// MemoryUsage is the footprint report the components built on these
+/// blocks return from memory_usage(): bytes reserved, bytes actually
+/// resident (mincore), and a high-water mark of what live entries needed.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hft {
+
+/// Page size requested for a backing region.
+enum class PageMode : uint8_t {
+    Default = 0,      // Heap (calloc / aligned_alloc), regular pages
+    Transparent = 1,  // Anonymous mmap + madvise(MADV_HUGEPAGE)
+    Huge2MB = 2,      // MAP_HUGETLB, 2 MB pages
+    Huge1GB = 3       // MAP_HUGETLB, 1 GB pages
+};
+
+struct MemoryBacking {
+    /// No NUMA binding.
+    static constexpr int NUMA_ANY = -1;
+    /// Bind to the node of the thread that performs the allocation.
+    static constexpr int NUMA_LOCAL = -2;
+
+    PageMode pages = PageMode::Default;
+    int numa_node = NUMA_ANY;   // >= 0 binds to that node
+    bool prefault = false;      // Touch every page during construction
+};
+
+/// A block obtained from allocate_backing(). Pass it back to
+/// release_backing() unchanged.
+struct BackingRegion {
+    void* data = nullptr;
+    size_t bytes = 0;                   // Mapped length (rounded up for mmap)
+    PageMode pages = PageMode::Default;  // What was actually granted
+    bool numa_bound = false;
+    bool mapped = false;                // mmap'd (else heap)
+    size_t alignment = 0;               // Heap path only
+};
+
+/// Allocate `bytes` of zero-filled memory aligned to at least `alignment`
+/// (a power of two, at most 4096). Aborts on failure like the rest of the
+/// startup path.
+[[nodiscard]] BackingRegion allocate_backing(size_t bytes, size_t alignment,
+                                             const MemoryBacking& backing) noexcept;
+
+/// Return a region to the system. Safe on an empty region.
+void release_backing(BackingRegion& region) noexcept;
+
+/// Memory footprint of a component. Combine with +=.
+///
+///   reserved_bytes   — allocated (mapped or heap) bytes
+///   touched_bytes    — of those, resident now (pages faulted in); equal to
+///                      reserved_bytes where residency cannot be queried
+///   high_water_bytes — peak bytes occupied by live entries (pool slots,
+///                      map entries); for plain arrays, touched_bytes,
+///                      since a page once touched stays resident
+///
+/// reserved_bytes far above high_water_bytes means over-provisioning.
+struct MemoryUsage {
+    size_t reserved_bytes = 0;
+    size_t touched_bytes = 0;
+    size_t high_water_bytes = 0;
+
+    MemoryUsage& operator+=(const MemoryUsage& other) noexcept {
+        reserved_bytes += other.reserved_bytes;
+        touched_bytes += other.touched_bytes;
+        high_water_bytes += other.high_water_bytes;
+        return *this;
+    }
+};
+
+/// Bytes of [data, data + bytes) currently resident, counted in whole
+/// pages and capped at `bytes`. A few syscalls (mincore): cold path only.
+[[nodiscard]] size_t resident_bytes(const void* data, size_t bytes) noexcept;
+
+/// Usage of a region from allocate_backing() (all zero for an empty one).
+[[nodiscard]] MemoryUsage backing_usage(const BackingRegion& region) noexcept;
+
+/// Usage of a plain heap block of `bytes` (all zero for nullptr).
+[[nodiscard]] MemoryUsage heap_usage(const void* data, size_t bytes) noexcept;
+
+/// Human-readable page mode, for logs and diagnostics.
+[[nodiscard]] const char* page_mode_name(PageMode mode) noexcept;
+
+}  // namespace hft
@@ -0,0 +1,90 @@
+#pragma once
+
+/// @file book_digest.h
+/// @brief Order-independent rolling hash of a book's resting state.
+///
+/// Hot-path component — a few multiplies per book change, no memory.
+/// Two books with the same resting orders (id, side, price, remaining
+/// quantity) have the same digest, however they got there, so a replay and
+/// a re-run, or a primary and its standby, can be compared by exchanging
+/// one 64-bit value instead of diffing depth dumps.
+///
+/// The digest is a sum modulo 2^64 of one term per resting order:
+///
+///     k  +  (k | 1) * remaining,    k = mix(id ^ mix(side, price))
+///
+/// The first part records which orders rest at which level; the second is
+/// linear in the order's remaining quantity, so a fill or an in-place amend
+/// of `q` moves the digest by (k | 1) * q. The odd multiplier is different
+/// per order, so books with equal level totals but different fills within a
+/// level still differ. Sums commute, so the order of adds and removals does
+/// not matter, and every update is O(1).
+/// Time priority within a level is not part of the digest.
+
+#include <cstdint>
+
+#include "core/order.h"
+#include "core/types.h"
+
+namespace hft {
+
+class BookDigest {
+public:
+    /// SplitMix64 finalizer: a cheap bijective 64-bit mix.
+    [[nodiscard]] static constexpr uint64_t mix(uint64_t x) noexcept {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /// Per-order key: the order's id mixed with its level.
+    [[nodiscard]] static constexpr uint64_t order_key(OrderId id, Side side,
+                                                      Price price) noexcept {
+        return mix(id ^ mix((static_cast<uint64_t>(price) << 1) |
+                            static_cast<uint64_t>(side)));
+    }
+
+    /// One resting order's contribution.
+    [[nodiscard]] static constexpr uint64_t order_term(OrderId id, Side side, Price price,
+                                                       Quantity remaining) noexcept {
+        const uint64_t key = order_key(id, side, price);
+        return key + (key | 1) * static_cast<uint64_t>(remaining);
+    }
+
+    [[nodiscard]] bool enabled() const noexcept { return enabled_; }
+    [[nodiscard]] uint64_t value() const noexcept { return value_; }
+
+    /// Start tracking from `value` (the digest of the current book).
+    void enable(uint64_t value) noexcept {
+        enabled_ = true;
+        value_ = value;
+    }
+    void disable() noexcept {
+        enabled_ = false;
+        value_ = 0;
+    }
+
+    void add(const Order& order) noexcept {
+        value_ += order_term(order.order_id, order.side, order.price,
+                             order.remaining_quantity());
+    }
+    void remove(const Order& order) noexcept {
+        value_ -= order_term(order.order_id, order.side, order.price,
+                             order.remaining_quantity());
+    }
+    /// A resting order's remaining quantity fell by `qty` (fill or
+    /// in-place amend).
+    void reduce(const Order& order, Quantity qty) noexcept {
+        value_ -= (order_key(order.order_id, order.side, order.price) | 1) *
+                  static_cast<uint64_t>(qty);
+    }
+
+private:
+    uint64_t value_ = 0;
+    bool enabled_ = false;
+};
+
+}  // namespace hft
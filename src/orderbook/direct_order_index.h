@@ -0,0 +1,229 @@
+#pragma once
+
+/// @file direct_order_index.h
+/// @brief Paged direct-indexed OrderId -> Order* index for dense,
+///        monotonically assigned order IDs.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Many venues hand out order IDs that increase within a session, so the
+/// live IDs cluster in a moving band. This index keeps a sliding window of
+/// `page_count` pages of PAGE_SLOTS pointers each, arranged as a ring: an
+/// in-window lookup is one shift, one mask and one load — no hashing, no
+/// probing.
+///
+/// When an insert lands past the window, the window slides forward and the
+/// pages it leaves behind are recycled: any orders still live on them
+/// (long-resting GTC orders) are spilled into the fallback FlatOrderMap.
+/// IDs below the window — spilled orders, or IDs under the first one seen —
+/// live in the fallback map. The window only moves forward, so every ID in
+/// [window_low(), window_high()) is authoritative in the ring. An insert
+/// that would slide the window while the fallback map has no room for the
+/// orders it would spill fails instead, and the window stays put.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/order.h"
+#include "core/prefetch.h"
+#include "core/types.h"
+#include "orderbook/backing_memory.h"
+#include "orderbook/flat_order_map.h"
+
+namespace hft {
+
+class DirectOrderIndex {
+public:
+    static constexpr size_t PAGE_SHIFT = 12;
+    static constexpr size_t PAGE_SLOTS = size_t{1} << PAGE_SHIFT;  // 4096 IDs
+
+    /// @param page_count Pages in the window, rounded up to a power of two
+    ///                   (0 = disabled; every call goes to `fallback`).
+    /// @param fallback   Hash map for IDs outside the window.
+    DirectOrderIndex(size_t page_count, FlatOrderMap& fallback,
+                     const MemoryBacking& backing = {})
+        : fallback_(fallback), slots_(nullptr), live_(nullptr),
+          page_count_(0), page_mask_(0), base_(0), low_page_(0),
+          low_id_(0), high_id_(0), started_(false), spilled_(0) {
+        if (page_count == 0) return;
+
+        page_count_ = 1;
+        while (page_count_ < page_count) page_count_ <<= 1;
+        page_mask_ = page_count_ - 1;
+
+        // Zero-filled: every slot starts empty, every page count at 0.
+        size_t slot_bytes = page_count_ * PAGE_SLOTS * sizeof(Order*);
+        region_ = allocate_backing(slot_bytes + page_count_ * sizeof(uint32_t),
+                                   alignof(Order*), backing);
+        slots_ = static_cast<Order**>(region_.data);
+        live_ = reinterpret_cast<uint32_t*>(
+            static_cast<char*>(region_.data) + slot_bytes);
+    }
+
+    ~DirectOrderIndex() { release_backing(region_); }
+
+    DirectOrderIndex(const DirectOrderIndex&) = delete;
+    DirectOrderIndex& operator=(const DirectOrderIndex&) = delete;
+    DirectOrderIndex(DirectOrderIndex&&) = delete;
+    DirectOrderIndex& operator=(DirectOrderIndex&&) = delete;
+
+    [[nodiscard]] bool enabled() const noexcept { return slots_ != nullptr; }
+
+    /// Insert a key-value pair. Returns false on a duplicate, ID 0, or a
+    /// full fallback map (for IDs it would hold or orders it would take).
+    bool insert(OrderId id, Order* order) noexcept {
+        if (id == 0) [[unlikely]] return false;
+        if (!started_) [[unlikely]] {
+            // Anchor the window on the first ID, page-aligned.
+            base_ = id & ~static_cast<OrderId>(PAGE_SLOTS - 1);
+            started_ = true;
+            update_bounds();
+        }
+        if (id < base_) [[unlikely]] {
+            return fallback_.insert(id, order);
+        }
+
+        size_t page = page_of(id);
+        if (page < low_page_) [[unlikely]] {
+            return fallback_.insert(id, order);
+        }
+        if (page >= low_page_ + page_count_) [[unlikely]] {
+            if (!slide_to(page)) return false;
+        }
+
+        Order*& slot = slot_ref(id);
+        if (slot) return false;  // Duplicate
+        slot = order;
+        ++live_[page & page_mask_];
+        return true;
+    }
+
+    /// Erase a key. Returns false if not found.
+    bool erase(OrderId id) noexcept {
+        if (in_window(id)) [[likely]] {
+            Order*& slot = slot_ref(id);
+            if (!slot) return false;
+            slot = nullptr;
+            --live_[page_of(id) & page_mask_];
+            return true;
+        }
+        return fallback_.erase(id);
+    }
+
+    /// Find an order by ID. Returns nullptr if not found.
+    [[nodiscard]] Order* find(OrderId id) const noexcept {
+        if (in_window(id)) [[likely]] {
+            return slots_[(page_of(id) & page_mask_) << PAGE_SHIFT |
+                          (id & (PAGE_SLOTS - 1))];
+        }
+        return fallback_.find(id);
+    }
+
+    /// Prefetch the slot for `id` (or its fallback-map home slot).
+    void prefetch(OrderId id) const noexcept {
+        if (in_window(id)) [[likely]] {
+            prefetch_write(&slots_[(page_of(id) & page_mask_) << PAGE_SHIFT |
+                                   (id & (PAGE_SLOTS - 1))]);
+        } else {
+            fallback_.prefetch(id);
+        }
+    }
+
+    /// Forget the window once every ID has been erased (the slots and page
+    /// counts are then already clear): the next insert anchors it afresh,
+    /// as on a new index. O(1).
+    void reset() noexcept {
+        base_ = 0;
+        low_page_ = 0;
+        low_id_ = 0;
+        high_id_ = 0;
+        started_ = false;
+    }
+
+    /// Lowest ID covered by the ring (inclusive).
+    [[nodiscard]] OrderId window_low() const noexcept { return low_id_; }
+    /// One past the highest ID covered by the ring.
+    [[nodiscard]] OrderId window_high() const noexcept { return high_id_; }
+    [[nodiscard]] size_t page_count() const noexcept { return page_count_; }
+
+    /// The slot window alone (the fallback map reports its own).
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        return backing_usage(region_);
+    }
+    /// Orders moved to the fallback map by page recycling (lifetime total).
+    [[nodiscard]] uint64_t spilled() const noexcept { return spilled_; }
+
+private:
+    [[nodiscard]] size_t page_of(OrderId id) const noexcept {
+        return static_cast<size_t>((id - base_) >> PAGE_SHIFT);
+    }
+
+    /// Empty range until the first insert anchors the window.
+    [[nodiscard]] bool in_window(OrderId id) const noexcept {
+        return id >= low_id_ && id < high_id_;
+    }
+
+    void update_bounds() noexcept {
+        low_id_ = base_ + (static_cast<OrderId>(low_page_) << PAGE_SHIFT);
+        high_id_ = low_id_ + (static_cast<OrderId>(page_count_) << PAGE_SHIFT);
+    }
+
+    Order*& slot_ref(OrderId id) noexcept {
+        return slots_[(page_of(id) & page_mask_) << PAGE_SHIFT |
+                      (id & (PAGE_SLOTS - 1))];
+    }
+
+    /// Move the window so `page` is its highest page, recycling every page
+    /// that falls out of it. Work is bounded by page_count_ pages. Returns
+    /// false, moving nothing, if the fallback map cannot take every order
+    /// those pages still hold.
+    bool slide_to(size_t page) noexcept {
+        size_t new_low = page - page_count_ + 1;
+        size_t recycle_end = (new_low - low_page_ < page_count_)
+                                 ? new_low
+                                 : low_page_ + page_count_;
+        size_t spilling = 0;
+        for (size_t p = low_page_; p < recycle_end; ++p) {
+            spilling += live_[p & page_mask_];
+        }
+        if (spilling > fallback_.room()) [[unlikely]] return false;
+        for (size_t p = low_page_; p < recycle_end; ++p) {
+            recycle(p);
+        }
+        low_page_ = new_low;
+        update_bounds();
+        return true;
+    }
+
+    /// Spill a departing page's live orders into the fallback map and
+    /// clear it for reuse. slide_to() made sure the map has room, and the
+    /// IDs are new to it (the window is authoritative for them).
+    void recycle(size_t page) noexcept {
+        size_t ring = page & page_mask_;
+        if (live_[ring] == 0) return;
+        Order** slots = slots_ + (ring << PAGE_SHIFT);
+        OrderId first = base_ + (static_cast<OrderId>(page) << PAGE_SHIFT);
+        for (size_t i = 0; i < PAGE_SLOTS; ++i) {
+            if (slots[i]) {
+                fallback_.insert(first + i, slots[i]);
+                slots[i] = nullptr;
+                ++spilled_;
+            }
+        }
+        live_[ring] = 0;
+    }
+
+    FlatOrderMap& fallback_;
+    BackingRegion region_;
+    Order** slots_;        // page_count_ * PAGE_SLOTS, ring of pages
+    uint32_t* live_;       // Live orders per ring page
+    size_t page_count_;
+    size_t page_mask_;
+    OrderId base_;         // ID of slot 0 of absolute page 0
+    size_t low_page_;      // Absolute page number of the window's low end
+    OrderId low_id_;       // Cached [low_id_, high_id_) window bounds
+    OrderId high_id_;
+    bool started_;
+    uint64_t spilled_;
+};
+
+}  // namespace hft
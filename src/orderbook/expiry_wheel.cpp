@@ -0,0 +1,212 @@
+#include "orderbook/expiry_wheel.h"
+
+#include <cstdlib>
+
+#include "orderbook/level_bitmap.h"
+
+namespace hft {
+
+ExpiryWheel::ExpiryWheel(size_t capacity, Timestamp tick_ns)
+    : nodes_(nullptr),
+      capacity_(capacity),
+      size_(0),
+      free_head_(NIL),
+      slots_{},
+      occupied_{},
+      due_{NIL, NIL},
+      now_tick_(0),
+      tick_ns_(tick_ns),
+      clock_(0),
+      next_due_(NEVER),
+      session_close_(0) {
+    if (capacity_ == 0 || capacity_ >= NIL || tick_ns_ == 0) {
+        std::abort();
+    }
+    nodes_ = static_cast<Node*>(std::calloc(capacity_, sizeof(Node)));
+    if (!nodes_) {
+        std::abort();
+    }
+    for (auto& level : slots_) {
+        for (Slot& slot : level) {
+            slot.head = NIL;
+            slot.tail = NIL;
+        }
+    }
+    // Free list in index order: node 0 is handed out first
+    for (size_t i = 0; i < capacity_; ++i) {
+        nodes_[i].next = (i + 1 < capacity_) ? static_cast<uint32_t>(i + 1) : NIL;
+    }
+    free_head_ = 0;
+}
+
+ExpiryWheel::~ExpiryWheel() {
+    std::free(nodes_);
+}
+
+// ---------------------------------------------------------------------------
+// Arming and popping
+// ---------------------------------------------------------------------------
+
+bool ExpiryWheel::schedule(OrderId id, Timestamp expire_time) noexcept {
+    if (free_head_ == NIL) [[unlikely]] {
+        return false;
+    }
+    uint32_t n = free_head_;
+    Node& node = nodes_[n];
+    free_head_ = node.next;
+    ++size_;
+
+    node.id = id;
+    node.expire_time = expire_time;
+    node.tick = expire_time / tick_ns_ + (expire_time % tick_ns_ != 0);
+    node.next = NIL;
+    place(n);
+    refresh_next_due();
+    return true;
+}
+
+bool ExpiryWheel::pop_expired(Timestamp now, OrderId& id,
+                              Timestamp& expire_time) noexcept {
+    if (now > clock_) clock_ = now;
+    if (due_.head == NIL) {
+        if (now < next_due_) return false;
+        advance(now / tick_ns_);
+        if (due_.head == NIL) {
+            refresh_next_due();
+            return false;
+        }
+    }
+
+    uint32_t n = due_.head;
+    due_.head = nodes_[n].next;
+    if (due_.head == NIL) due_.tail = NIL;
+    id = nodes_[n].id;
+    expire_time = nodes_[n].expire_time;
+    release(n);
+    if (due_.head == NIL) refresh_next_due();
+    return true;
+}
+
+void ExpiryWheel::release(uint32_t n) noexcept {
+    nodes_[n].next = free_head_;
+    free_head_ = n;
+    --size_;
+}
+
+// ---------------------------------------------------------------------------
+// Wheel mechanics
+// ---------------------------------------------------------------------------
+
+void ExpiryWheel::append(Slot& slot, Node* nodes, uint32_t n) noexcept {
+    if (slot.tail == NIL) {
+        slot.head = n;
+    } else {
+        nodes[slot.tail].next = n;
+    }
+    slot.tail = n;
+}
+
+void ExpiryWheel::place(uint32_t n) noexcept {
+    uint64_t tick = nodes_[n].tick;
+    if (tick <= now_tick_) {
+        append(due_, nodes_, n);
+        return;
+    }
+    unsigned level = highest_set_bit(tick ^ now_tick_) / LEVEL_BITS;
+    unsigned slot = static_cast<unsigned>(tick >> (level * LEVEL_BITS)) & (SLOTS - 1);
+    append(slots_[level][slot], nodes_, n);
+    occupied_[level] |= uint64_t{1} << slot;
+}
+
+uint64_t ExpiryWheel::next_event_tick(unsigned& level,
+                                      unsigned& slot) const noexcept {
+    uint64_t best = UINT64_MAX;
+    for (unsigned l = 0; l < LEVELS; ++l) {
+        if (occupied_[l] == 0) continue;
+        unsigned s = lowest_set_bit(occupied_[l]);
+        unsigned shift = l * LEVEL_BITS;
+        unsigned above = shift + LEVEL_BITS;
+        // Keep the bits above this level's group, zero those below it
+        uint64_t high = (above >= 64) ? 0 : (now_tick_ >> above) << above;
+        uint64_t t = high | (static_cast<uint64_t>(s) << shift);
+        if (t < best) {
+            best = t;
+            level = l;
+            slot = s;
+        }
+    }
+    return best;
+}
+
+void ExpiryWheel::advance(uint64_t target) noexcept {
+    unsigned level = 0;
+    unsigned slot = 0;
+    for (uint64_t t = next_event_tick(level, slot); t <= target;
+         t = next_event_tick(level, slot)) {
+        // Step to the slot's start and redistribute it: each timer drops
+        // to a lower level, or onto the due list if its tick is now
+        now_tick_ = t;
+        Slot cascade = slots_[level][slot];
+        slots_[level][slot] = Slot{NIL, NIL};
+        occupied_[level] &= ~(uint64_t{1} << slot);
+        for (uint32_t n = cascade.head; n != NIL;) {
+            uint32_t next = nodes_[n].next;
+            nodes_[n].next = NIL;
+            place(n);
+            n = next;
+        }
+    }
+    // No slot starts in (now_tick_, target]: every timer stays put
+    if (target > now_tick_) now_tick_ = target;
+}
+
+void ExpiryWheel::refresh_next_due() noexcept {
+    if (due_.head != NIL) {
+        next_due_ = 0;
+        return;
+    }
+    unsigned level = 0;
+    unsigned slot = 0;
+    uint64_t t = next_event_tick(level, slot);
+    next_due_ = (t > NEVER / tick_ns_) ? NEVER : t * tick_ns_;
+}
+
+// ---------------------------------------------------------------------------
+// Stale timers
+// ---------------------------------------------------------------------------
+
+size_t ExpiryWheel::purge_list(Slot& slot, LiveCheck live,
+                               void* context) noexcept {
+    size_t dropped = 0;
+    uint32_t n = slot.head;
+    slot = Slot{NIL, NIL};
+    while (n != NIL) {
+        uint32_t next = nodes_[n].next;
+        nodes_[n].next = NIL;
+        if (live(context, nodes_[n].id, nodes_[n].expire_time)) {
+            append(slot, nodes_, n);
+        } else {
+            release(n);
+            ++dropped;
+        }
+        n = next;
+    }
+    return dropped;
+}
+
+size_t ExpiryWheel::purge(LiveCheck live, void* context) noexcept {
+    size_t dropped = purge_list(due_, live, context);
+    for (unsigned l = 0; l < LEVELS; ++l) {
+        for (uint64_t bits = occupied_[l]; bits != 0; bits &= bits - 1) {
+            unsigned s = lowest_set_bit(bits);
+            dropped += purge_list(slots_[l][s], live, context);
+            if (slots_[l][s].head == NIL) {
+                occupied_[l] &= ~(uint64_t{1} << s);
+            }
+        }
+    }
+    refresh_next_due();
+    return dropped;
+}
+
+}  // namespace hft
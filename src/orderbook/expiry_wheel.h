@@ -0,0 +1,141 @@
+#pragma once
+
+/// @file expiry_wheel.h
+/// @brief Hierarchical timing wheel for DAY / GTD order expiry.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Timers live in a fixed node pool and are keyed on (OrderId, expire
+/// time); time is counted in ticks of `tick_ns`. Eleven levels of 64 slots
+/// cover the whole 64-bit tick range: a timer sits at the level of the
+/// highest 6-bit group in which its tick differs from the current one, in
+/// the slot given by its own bits of that group. Every occupied slot of a
+/// level therefore lies ahead of the current position, so the next slot to
+/// visit is the lowest set bit of the level's occupancy word, and advancing
+/// jumps straight to it — cost is O(levels) per timer over its lifetime,
+/// independent of how far the clock moves or how many orders rest.
+///
+/// Timers are never unlinked on cancel or fill. A popped timer is only a
+/// candidate: the engine checks that the order is still live with the same
+/// expire_time before expiring it. When the pool runs out, purge() drops
+/// every stale timer in one pass over the nodes (amortised O(1) as long as
+/// capacity comfortably exceeds the live timed orders).
+///
+/// Expiry resolution is one tick: an order expiring at `t` is released by
+/// the first advance to a time >= t rounded up to a tick boundary — never
+/// early, at most one tick late.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/types.h"
+#include "orderbook/backing_memory.h"
+
+namespace hft {
+
+class ExpiryWheel {
+public:
+    static constexpr Timestamp NEVER = UINT64_MAX;
+
+    /// Decides whether a popped timer still matches a live order.
+    using LiveCheck = bool (*)(void* context, OrderId id,
+                               Timestamp expire_time) noexcept;
+
+    /// @param capacity Maximum outstanding timers (live plus stale).
+    /// @param tick_ns  Wheel resolution in timestamp units (nanoseconds).
+    explicit ExpiryWheel(size_t capacity, Timestamp tick_ns = 1'000'000);
+    ~ExpiryWheel();
+
+    ExpiryWheel(const ExpiryWheel&) = delete;
+    ExpiryWheel& operator=(const ExpiryWheel&) = delete;
+
+    /// Arm a timer for `id` at `expire_time`. Returns false when the node
+    /// pool is full (see purge()).
+    [[nodiscard]] bool schedule(OrderId id, Timestamp expire_time) noexcept;
+
+    /// Record `now` as the latest time seen and report whether a timer may
+    /// be due — the cheap per-message check (no division, no traversal).
+    [[nodiscard]] bool due(Timestamp now) noexcept {
+        if (now > clock_) clock_ = now;
+        return now >= next_due_;
+    }
+
+    /// Advance to `now` and pop the next expired timer, oldest tick first
+    /// (arming order within a tick). Returns false when none is due.
+    [[nodiscard]] bool pop_expired(Timestamp now, OrderId& id,
+                                   Timestamp& expire_time) noexcept;
+
+    /// Drop every timer `live` rejects. Returns the number dropped.
+    size_t purge(LiveCheck live, void* context) noexcept;
+
+    /// Expiry given to DAY orders that carry no expire_time of their own.
+    /// 0 (the default) leaves such orders untimed.
+    void set_session_close(Timestamp close) noexcept { session_close_ = close; }
+    [[nodiscard]] Timestamp session_close() const noexcept { return session_close_; }
+
+    /// Latest time passed to due() / pop_expired().
+    [[nodiscard]] Timestamp clock() const noexcept { return clock_; }
+    [[nodiscard]] Timestamp tick_ns() const noexcept { return tick_ns_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+    /// The node array (the slot lists live inline). Cold path.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        return heap_usage(nodes_, capacity_ * sizeof(Node));
+    }
+    [[nodiscard]] bool full() const noexcept { return free_head_ == NIL; }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << LEVEL_BITS;
+    static constexpr unsigned LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS;
+
+    struct Node {
+        OrderId id;
+        Timestamp expire_time;
+        uint64_t tick;   // ceil(expire_time / tick_ns)
+        uint32_t next;   // Slot list / free list link
+        uint32_t pad_;
+    };
+
+    /// FIFO list of nodes (head/tail node indices).
+    struct Slot {
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    /// Put node `n` on the list its tick belongs to relative to now_tick_.
+    void place(uint32_t n) noexcept;
+    static void append(Slot& slot, Node* nodes, uint32_t n) noexcept;
+
+    /// Visit every slot whose start lies at or before `target`.
+    void advance(uint64_t target) noexcept;
+
+    /// First tick at which some occupied slot starts; UINT64_MAX if none.
+    /// Sets `level` / `slot` to where it is.
+    [[nodiscard]] uint64_t next_event_tick(unsigned& level,
+                                           unsigned& slot) const noexcept;
+
+    /// Recompute next_due_ after the lists changed.
+    void refresh_next_due() noexcept;
+
+    /// Filter one list through `live`, freeing the rest.
+    size_t purge_list(Slot& slot, LiveCheck live, void* context) noexcept;
+
+    void release(uint32_t n) noexcept;
+
+    Node* nodes_;
+    size_t capacity_;
+    size_t size_;
+    uint32_t free_head_;
+    Slot slots_[LEVELS][SLOTS];
+    uint64_t occupied_[LEVELS];
+    Slot due_;               // Expired, awaiting pop
+    uint64_t now_tick_;
+    Timestamp tick_ns_;
+    Timestamp clock_;
+    Timestamp next_due_;     // Earliest time a pop can yield; NEVER if empty
+    Timestamp session_close_;
+};
+
+}  // namespace hft
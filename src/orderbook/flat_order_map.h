@@ -7,6 +7,35 @@
 /// Uses linear probing with backward-shift deletion (no tombstones).
 /// Capacity is always a power of 2 for fast modulo via bitmask.
 ///
+/// Optional group-probing mode (OrderMapProbe::Group, Swiss-table style):
+/// a separate control-byte array holds a 7-bit hash tag per slot, and
+/// lookups compare a whole 16-slot group at once with SSE2 (baseline on
+/// x86-64; scalar elsewhere). A miss — the common case for cancels of
+/// already-filled orders — usually costs one 16-byte control load instead
+/// of a walk over several cache lines of entries. Erase marks the slot
+/// empty whenever its group still has an empty slot (no probe chain can
+/// pass through such a group); only erases from a full group leave a
+/// tombstone, and tombstones are purged by an O(capacity) in-place rehash
+/// in maintain(), never by erase().
+///
+/// Optional incremental growth (growable = true): once the live count passes
+/// half the capacity, a doubled table takes over and every later insert or
+/// erase migrates MIGRATE_STEP slots of the old table into it, so no single
+/// operation pays for a full rehash. While both tables exist, lookups try
+/// the new table first and fall back to the old one; the old table is never
+/// written except to mark erased keys (value = nullptr), which keeps its
+/// probe chains intact. A non-growable map rejects inserts once it is full
+/// instead of probing forever.
+///
+/// maintain() is the cold-path half, called while the owner is idle: it
+/// allocates (and zero-fills / pre-faults) the doubled table once the live
+/// count passes 3/8 of capacity, releases a drained old table, and purges
+/// tombstones past 1/16 of capacity. Insert and erase then only swap
+/// pointers. An owner that never calls maintain() still works: the doubled
+/// table is allocated inline once the live count passes 3/4 of capacity,
+/// a drained table is released when the next one drains, and tombstones
+/// are purged inline when they are all that keeps an insert out.
+///
 /// OrderId 0 is reserved as the empty sentinel and must not be used
 /// as a real order ID.
 
@@ -16,102 +45,100 @@
 #include <cstring>
 
 #include "core/order.h"
+#include "core/prefetch.h"
 #include "core/types.h"
+#include "orderbook/backing_memory.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HFT_ORDER_MAP_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace hft {
 
+/// Probe strategy for FlatOrderMap.
+enum class OrderMapProbe : uint8_t {
+    Linear = 0,  // One 16-byte entry per probe step, backward-shift erase
+    Group = 1    // 16-slot control-byte groups, SIMD tag compare
+};
+
 class FlatOrderMap {
 public:
+    /// Old-table slots migrated per insert/erase while a resize is running.
+    static constexpr size_t MIGRATE_STEP = 16;
+
     /// Construct with at least `min_capacity` usable slots.
     /// Actual capacity is the next power of 2 >= 2 * min_capacity
     /// to maintain load factor <= 0.5.
-    explicit FlatOrderMap(size_t min_capacity)
-        : entries_(nullptr), capacity_(0), capacity_mask_(0), size_(0) {
+    /// The slot array comes from allocate_backing() per `backing`.
+    explicit FlatOrderMap(size_t min_capacity,
+                          const MemoryBacking& backing = {},
+                          OrderMapProbe probe = OrderMapProbe::Linear,
+                          bool growable = false)
+        : backing_(backing), probe_(probe), growable_(growable), size_(0),
+          peak_size_(0), migrate_cursor_(0) {
         size_t desired = (min_capacity < 8) ? 16 : min_capacity * 2;
-        capacity_ = next_power_of_2(desired);
-        capacity_mask_ = capacity_ - 1;
-
-        entries_ = static_cast<Entry*>(
-            std::calloc(capacity_, sizeof(Entry)));
-        if (!entries_) {
-            std::abort();
-        }
+        cur_.allocate(next_power_of_2(desired), probe_, backing_);
     }
 
-    ~FlatOrderMap() { std::free(entries_); }
+    ~FlatOrderMap() {
+        release_backing(cur_.region);
+        release_backing(old_.region);
+        release_backing(next_.region);
+        release_backing(retired_);
+    }
 
     FlatOrderMap(const FlatOrderMap&) = delete;
     FlatOrderMap& operator=(const FlatOrderMap&) = delete;
     FlatOrderMap(FlatOrderMap&&) = delete;
     FlatOrderMap& operator=(FlatOrderMap&&) = delete;
 
-    /// Insert a key-value pair. Returns false if key already exists or key is 0.
+    /// Insert a key-value pair. Returns false if key already exists, key is 0,
+    /// or a non-growable map is full.
     bool insert(OrderId key, Order* value) noexcept {
         if (key == EMPTY_KEY) [[unlikely]] {
             return false;
         }
-
-        size_t i = hash(key) & capacity_mask_;
-        while (true) {
-            if (entries_[i].key == EMPTY_KEY) {
-                entries_[i].key = key;
-                entries_[i].value = value;
-                ++size_;
-                return true;
-            }
-            if (entries_[i].key == key) {
-                return false;  // Duplicate
-            }
-            i = (i + 1) & capacity_mask_;
+        if (old_.entries) [[unlikely]] {
+            if (old_.find_live(key) != NPOS) return false;  // Duplicate
+            migrate_step();
+        }
+        if (!cur_.has_room()) [[unlikely]] {
+            // Last resort for an owner that never calls maintain()
+            if (cur_.tombstones == 0) return false;  // Full
+            cur_.purge_tombstones();
+            if (!cur_.has_room()) return false;
         }
+        if (!cur_.insert(key, value)) {
+            return false;  // Duplicate
+        }
+        ++size_;
+        if (size_ > peak_size_) peak_size_ = size_;
+        if (growable_ && size_ > cur_.capacity / 2) [[unlikely]] {
+            // Switch to the table maintain() prepared; allocate one here
+            // only once the load gets well past the nominal 0.5
+            if (next_.entries || size_ > cur_.capacity / 4 * 3) start_resize();
+        }
+        return true;
     }
 
     /// Erase a key. Returns false if not found.
-    /// Uses backward-shift deletion to maintain probe chain integrity.
     bool erase(OrderId key) noexcept {
         if (key == EMPTY_KEY) [[unlikely]] {
             return false;
         }
-
-        size_t i = hash(key) & capacity_mask_;
-
-        // Find the key
-        while (true) {
-            if (entries_[i].key == EMPTY_KEY) {
-                return false;  // Not found
-            }
-            if (entries_[i].key == key) {
-                break;
-            }
-            i = (i + 1) & capacity_mask_;
+        bool erased = cur_.erase(key);
+        if (old_.entries) [[unlikely]] {
+            // Also drop any copy left in the old table (migrated or not).
+            erased |= old_.mark_erased(key);
+            migrate_step();
         }
-
-        // Found at index i. Backward-shift to fill the gap.
-        --size_;
-        size_t j = i;
-        while (true) {
-            j = (j + 1) & capacity_mask_;
-            if (entries_[j].key == EMPTY_KEY) {
-                break;
-            }
-
-            // k = ideal (home) index of entry at j
-            size_t k = hash(entries_[j].key) & capacity_mask_;
-
-            // Should we shift entry[j] into position i?
-            // Yes if i is in the cyclic range [k, j), meaning the entry
-            // at j would need to pass through i to reach j from k.
-            size_t dist_ki = (i - k) & capacity_mask_;
-            size_t dist_kj = (j - k) & capacity_mask_;
-            if (dist_ki < dist_kj) {
-                entries_[i] = entries_[j];
-                i = j;
-            }
-        }
-
-        entries_[i].key = EMPTY_KEY;
-        entries_[i].value = nullptr;
-        return true;
+        if (erased) --size_;
+        return erased;
     }
 
     /// Find an order by ID. Returns nullptr if not found.
@@ -119,33 +146,117 @@ public:
         if (key == EMPTY_KEY) [[unlikely]] {
             return nullptr;
         }
+        size_t slot = cur_.find(key);
+        if (slot != NPOS) [[likely]] {
+            return cur_.entries[slot].value;
+        }
+        if (old_.entries) [[unlikely]] {
+            slot = old_.find_live(key);
+            if (slot != NPOS) return old_.entries[slot].value;
+        }
+        return nullptr;
+    }
 
-        size_t i = hash(key) & capacity_mask_;
-        while (true) {
-            if (entries_[i].key == EMPTY_KEY) {
-                return nullptr;
-            }
-            if (entries_[i].key == key) {
-                return entries_[i].value;
-            }
-            i = (i + 1) & capacity_mask_;
+    /// Prefetch the home slot (and control group) of `key` in the current
+    /// table, ahead of a find/insert/erase a few messages later.
+    void prefetch(OrderId key) const noexcept {
+        size_t h = hash(key);
+        if (cur_.ctrl) {
+            size_t base = (h & cur_.group_mask) * GROUP_WIDTH;
+            prefetch_write(&cur_.ctrl[base]);
+            prefetch_write(&cur_.entries[base]);
+        } else {
+            prefetch_write(&cur_.entries[h & cur_.capacity_mask]);
         }
     }
 
     [[nodiscard]] size_t size() const noexcept { return size_; }
-    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] size_t capacity() const noexcept { return cur_.capacity; }
+    [[nodiscard]] OrderMapProbe probe() const noexcept { return probe_; }
+    [[nodiscard]] bool growable() const noexcept { return growable_; }
+    /// True while entries are still being migrated out of the old table.
+    [[nodiscard]] bool resizing() const noexcept {
+        return old_.entries != nullptr;
+    }
+    /// Group mode: erased slots awaiting the next in-place rehash.
+    [[nodiscard]] size_t tombstones() const noexcept {
+        return cur_.tombstones;
+    }
+    /// New keys that insert() is sure to accept from here on (a growable
+    /// map always has room: it resizes). Tombstones count as room, since
+    /// an insert short of it purges them.
+    [[nodiscard]] size_t room() const noexcept {
+        if (growable_) return SIZE_MAX;
+        return cur_.capacity - 1 - cur_.size;
+    }
+
+    /// True once maintain() has the next (doubled) table ready.
+    [[nodiscard]] bool next_table_ready() const noexcept {
+        return next_.entries != nullptr;
+    }
+
+    /// Idle-time upkeep, the part of resizing and tombstone purging that
+    /// allocates, releases or walks the whole table. Cold path: call while
+    /// no insert or erase is waiting. Returns true if it did any work.
+    bool maintain() noexcept {
+        bool worked = false;
+        if (retired_.data) {
+            release_backing(retired_);
+            retired_ = BackingRegion{};
+            worked = true;
+        }
+        if (growable_ && !next_.entries && !old_.entries &&
+            size_ > cur_.capacity / 8 * 3) {
+            next_.allocate(cur_.capacity * 2, probe_, backing_);
+            worked = true;
+        }
+        if (cur_.tombstones > cur_.capacity / 16) {
+            cur_.purge_tombstones();
+            worked = true;
+        }
+        return worked;
+    }
 
+    /// Most live keys held at once (survives clear()).
+    [[nodiscard]] size_t peak_size() const noexcept { return peak_size_; }
+
+    /// Current table (and a draining one mid-resize) reserved and
+    /// resident; high-water = peak_size() entries' bytes. Cold path.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage = backing_usage(cur_.region);
+        usage += backing_usage(old_.region);
+        usage += backing_usage(next_.region);
+        usage += backing_usage(retired_);
+        const size_t slot_bytes =
+            sizeof(Entry) + (probe_ == OrderMapProbe::Group ? 1 : 0);
+        usage.high_water_bytes = peak_size_ * slot_bytes;
+        return usage;
+    }
+
+    /// Cold path. A prepared next table is kept for the next fill.
     void clear() noexcept {
-        std::memset(entries_, 0, capacity_ * sizeof(Entry));
+        cur_.clear();
+        release_backing(old_.region);
+        old_ = Table{};
+        release_backing(retired_);
+        retired_ = BackingRegion{};
+        migrate_cursor_ = 0;
         size_ = 0;
     }
 
 private:
     static constexpr OrderId EMPTY_KEY = 0;
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    // Group mode control bytes: high bit set = no live entry.
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr uint8_t CTRL_EMPTY = 0x80;
+    static constexpr uint8_t CTRL_DELETED = 0xFE;
+    static constexpr uint8_t CTRL_PENDING = 0xFF;  // In-place rehash only
 
     struct Entry {
         OrderId key;    // 0 = empty slot
-        Order* value;
+        Order* value;   // nullptr in a draining table = erased
     };
 
     /// Fibonacci hashing for uint64_t keys.
@@ -165,10 +276,346 @@ private:
         return v + 1;
     }
 
-    Entry* entries_;
-    size_t capacity_;
-    size_t capacity_mask_;
-    size_t size_;
+    static uint8_t tag_of(size_t h) noexcept {
+        return static_cast<uint8_t>(h >> 57);  // Top 7 bits: 0..127
+    }
+
+    static unsigned first_bit(uint32_t mask) noexcept {
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward(&idx, mask);
+        return static_cast<unsigned>(idx);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    /// One open-addressing table. Linear mode when ctrl == nullptr.
+    struct Table {
+        BackingRegion region;
+        Entry* entries = nullptr;
+        uint8_t* ctrl = nullptr;   // Group mode control bytes
+        size_t capacity = 0;
+        size_t capacity_mask = 0;
+        size_t group_mask = 0;     // Group mode: number of groups - 1
+        size_t size = 0;
+        size_t tombstones = 0;
+
+        void allocate(size_t cap, OrderMapProbe probe,
+                      const MemoryBacking& backing) noexcept {
+            capacity = cap;
+            capacity_mask = cap - 1;
+
+            // Zero-filled: every key starts as EMPTY_KEY (aborts on
+            // failure). Group mode appends one control byte per slot.
+            size_t ctrl_bytes = (probe == OrderMapProbe::Group) ? cap : 0;
+            region = allocate_backing(cap * sizeof(Entry) + ctrl_bytes,
+                                      GROUP_WIDTH, backing);
+            entries = static_cast<Entry*>(region.data);
+
+            if (probe == OrderMapProbe::Group) {
+                ctrl = reinterpret_cast<uint8_t*>(entries + cap);
+                std::memset(ctrl, CTRL_EMPTY, cap);
+                group_mask = cap / GROUP_WIDTH - 1;
+            }
+        }
+
+        /// Keeps at least one empty slot so probe loops terminate.
+        [[nodiscard]] bool has_room() const noexcept {
+            return size + tombstones + 1 < capacity;
+        }
+
+        [[nodiscard]] size_t find(OrderId key) const noexcept {
+            if (ctrl) return group_find(key);
+
+            size_t i = hash(key) & capacity_mask;
+            while (true) {
+                if (entries[i].key == EMPTY_KEY) {
+                    return NPOS;
+                }
+                if (entries[i].key == key) {
+                    return i;
+                }
+                i = (i + 1) & capacity_mask;
+            }
+        }
+
+        /// Draining-table lookup: ignores keys marked erased.
+        [[nodiscard]] size_t find_live(OrderId key) const noexcept {
+            size_t slot = find(key);
+            return (slot != NPOS && entries[slot].value) ? slot : NPOS;
+        }
+
+        /// Draining table: mark `key` erased without disturbing probe
+        /// chains. Returns true if it was live.
+        bool mark_erased(OrderId key) noexcept {
+            size_t slot = find_live(key);
+            if (slot == NPOS) return false;
+            entries[slot].value = nullptr;
+            return true;
+        }
+
+        bool insert(OrderId key, Order* value) noexcept {
+            if (ctrl) return group_insert(key, value);
+
+            size_t i = hash(key) & capacity_mask;
+            while (true) {
+                if (entries[i].key == EMPTY_KEY) {
+                    entries[i].key = key;
+                    entries[i].value = value;
+                    ++size;
+                    return true;
+                }
+                if (entries[i].key == key) {
+                    return false;  // Duplicate
+                }
+                i = (i + 1) & capacity_mask;
+            }
+        }
+
+        /// Uses backward-shift deletion to maintain probe chain integrity.
+        bool erase(OrderId key) noexcept {
+            if (ctrl) return group_erase(key);
+
+            size_t i = find(key);
+            if (i == NPOS) {
+                return false;
+            }
+
+            // Found at index i. Backward-shift to fill the gap.
+            --size;
+            size_t j = i;
+            while (true) {
+                j = (j + 1) & capacity_mask;
+                if (entries[j].key == EMPTY_KEY) {
+                    break;
+                }
+
+                // k = ideal (home) index of entry at j
+                size_t k = hash(entries[j].key) & capacity_mask;
+
+                // Should we shift entry[j] into position i?
+                // Yes if i is in the cyclic range [k, j), meaning the entry
+                // at j would need to pass through i to reach j from k.
+                size_t dist_ki = (i - k) & capacity_mask;
+                size_t dist_kj = (j - k) & capacity_mask;
+                if (dist_ki < dist_kj) {
+                    entries[i] = entries[j];
+                    i = j;
+                }
+            }
+
+            entries[i].key = EMPTY_KEY;
+            entries[i].value = nullptr;
+            return true;
+        }
+
+        void clear() noexcept {
+            std::memset(entries, 0, capacity * sizeof(Entry));
+            if (ctrl) std::memset(ctrl, CTRL_EMPTY, capacity);
+            size = 0;
+            tombstones = 0;
+        }
+
+        // -------------------------------------------------------------------
+        // Group-probing mode
+        // -------------------------------------------------------------------
+
+        /// Bit i set iff ctrl byte i of the group equals `b`.
+        uint32_t match_byte(size_t base, uint8_t b) const noexcept {
+#ifdef HFT_ORDER_MAP_SSE2
+            __m128i c = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(ctrl + base));
+            __m128i cmp =
+                _mm_cmpeq_epi8(c, _mm_set1_epi8(static_cast<char>(b)));
+            return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                mask |= static_cast<uint32_t>(ctrl[base + i] == b) << i;
+            }
+            return mask;
+#endif
+        }
+
+        /// Bit i set iff slot i of the group holds no live entry.
+        uint32_t match_free(size_t base) const noexcept {
+#ifdef HFT_ORDER_MAP_SSE2
+            __m128i c = _mm_load_si128(
+                reinterpret_cast<const __m128i*>(ctrl + base));
+            return static_cast<uint32_t>(_mm_movemask_epi8(c));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                mask |= static_cast<uint32_t>(ctrl[base + i] >> 7) << i;
+            }
+            return mask;
+#endif
+        }
+
+        size_t group_find(OrderId key) const noexcept {
+            size_t h = hash(key);
+            uint8_t tag = tag_of(h);
+            size_t g = h & group_mask;
+            while (true) {
+                size_t base = g * GROUP_WIDTH;
+                for (uint32_t m = match_byte(base, tag); m != 0; m &= m - 1) {
+                    size_t slot = base + first_bit(m);
+                    if (entries[slot].key == key) [[likely]] return slot;
+                }
+                if (match_byte(base, CTRL_EMPTY) != 0) return NPOS;
+                g = (g + 1) & group_mask;
+            }
+        }
+
+        bool group_insert(OrderId key, Order* value) noexcept {
+            size_t h = hash(key);
+            uint8_t tag = tag_of(h);
+            size_t g = h & group_mask;
+            size_t target = NPOS;  // First free slot on the probe path
+
+            while (true) {
+                size_t base = g * GROUP_WIDTH;
+                for (uint32_t m = match_byte(base, tag); m != 0; m &= m - 1) {
+                    if (entries[base + first_bit(m)].key == key) {
+                        return false;  // Duplicate
+                    }
+                }
+                if (target == NPOS) {
+                    uint32_t free_mask = match_free(base);
+                    if (free_mask != 0) target = base + first_bit(free_mask);
+                }
+                if (match_byte(base, CTRL_EMPTY) != 0) break;
+                g = (g + 1) & group_mask;
+            }
+
+            if (ctrl[target] == CTRL_DELETED) --tombstones;
+            ctrl[target] = tag;
+            entries[target].key = key;
+            entries[target].value = value;
+            ++size;
+            return true;
+        }
+
+        bool group_erase(OrderId key) noexcept {
+            size_t slot = group_find(key);
+            if (slot == NPOS) return false;
+
+            entries[slot].key = EMPTY_KEY;
+            entries[slot].value = nullptr;
+            --size;
+
+            // A group with an empty slot never ended a probe chain's walk
+            // past it, so the slot can go straight back to empty.
+            size_t base = slot & ~(GROUP_WIDTH - 1);
+            if (match_byte(base, CTRL_EMPTY) != 0) {
+                ctrl[slot] = CTRL_EMPTY;
+                return true;
+            }
+            ctrl[slot] = CTRL_DELETED;
+            ++tombstones;  // Purged by maintain() (or an insert that needs the room)
+            return true;
+        }
+
+        /// Probe distance (in groups) of `slot` from the home group of `h`.
+        size_t probe_distance(size_t h, size_t slot) const noexcept {
+            return ((slot / GROUP_WIDTH) - (h & group_mask)) & group_mask;
+        }
+
+        /// In-place rehash: drop all tombstones and re-place every live
+        /// entry at the first free slot on its probe path. No allocation,
+        /// but O(capacity): see maintain().
+        void purge_tombstones() noexcept {
+            for (size_t i = 0; i < capacity; ++i) {
+                ctrl[i] = (ctrl[i] & 0x80) ? CTRL_EMPTY : CTRL_PENDING;
+            }
+
+            for (size_t i = 0; i < capacity; ++i) {
+                while (ctrl[i] == CTRL_PENDING) {
+                    size_t h = hash(entries[i].key);
+                    size_t g = h & group_mask;
+                    size_t target;
+                    while (true) {
+                        uint32_t free_mask = match_free(g * GROUP_WIDTH);
+                        if (free_mask != 0) {
+                            target = g * GROUP_WIDTH + first_bit(free_mask);
+                            break;
+                        }
+                        g = (g + 1) & group_mask;
+                    }
+
+                    if (probe_distance(h, target) == probe_distance(h, i)) {
+                        ctrl[i] = tag_of(h);  // Already in the right group
+                        break;
+                    }
+                    if (ctrl[target] == CTRL_EMPTY) {
+                        entries[target] = entries[i];
+                        ctrl[target] = tag_of(h);
+                        entries[i].key = EMPTY_KEY;
+                        entries[i].value = nullptr;
+                        ctrl[i] = CTRL_EMPTY;
+                        break;
+                    }
+                    // Target holds another unplaced entry: swap, re-place it.
+                    Entry tmp = entries[target];
+                    entries[target] = entries[i];
+                    entries[i] = tmp;
+                    ctrl[target] = tag_of(h);
+                }
+            }
+            tombstones = 0;
+        }
+    };
+
+    // -----------------------------------------------------------------------
+    // Incremental resize
+    // -----------------------------------------------------------------------
+
+    /// Retire the current table into old_ and switch to the doubled one,
+    /// allocating it here only if maintain() has not prepared it.
+    void start_resize() noexcept {
+        while (old_.entries) migrate_step();  // Previous resize still running
+
+        old_ = cur_;
+        if (next_.entries) {
+            cur_ = next_;
+            next_ = Table{};
+        } else {
+            cur_ = Table{};
+            cur_.allocate(old_.capacity * 2, probe_, backing_);
+        }
+        migrate_cursor_ = 0;
+    }
+
+    /// Copy the next MIGRATE_STEP old slots into cur_; hand old_ to
+    /// maintain() for release when done.
+    void migrate_step() noexcept {
+        size_t end = migrate_cursor_ + MIGRATE_STEP;
+        if (end > old_.capacity) end = old_.capacity;
+        for (size_t i = migrate_cursor_; i < end; ++i) {
+            const Entry& e = old_.entries[i];
+            if (e.key != EMPTY_KEY && e.value) {
+                cur_.insert(e.key, e.value);
+            }
+        }
+        migrate_cursor_ = end;
+        if (migrate_cursor_ == old_.capacity) {
+            release_backing(retired_);  // Only if maintain() never ran
+            retired_ = old_.region;
+            old_ = Table{};
+        }
+    }
+
+    Table cur_;
+    Table old_;                // Draining table during a resize, else empty
+    Table next_;               // Doubled table prepared by maintain()
+    BackingRegion retired_;    // Drained old_, released by maintain()
+    MemoryBacking backing_;
+    OrderMapProbe probe_;
+    bool growable_;
+    size_t size_;              // Live keys across both tables
+    size_t peak_size_;
+    size_t migrate_cursor_;    // Next old_ slot to migrate
 };
 
 }  // namespace hft
@@ -0,0 +1,223 @@
+#pragma once
+
+/// @file level_bitmap.h
+/// @brief Hierarchical occupancy bitset over price-level indices.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Layer 0 holds one bit per price level; each bit of layer k+1 summarises
+/// one 64-bit word of layer k (set iff that word is non-zero). Layers are
+/// added until the top layer is a single word (capped at MAX_LAYERS), so
+/// next/previous-set-bit queries cost a handful of tzcnt/lzcnt operations
+/// instead of a linear scan over empty PriceLevels.
+///
+/// With 64^3 = 262,144 bits per three layers, the default 200,000-level
+/// ladder resolves any query by touching at most six words.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "orderbook/backing_memory.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Bit-scan helpers (argument must be non-zero)
+// ---------------------------------------------------------------------------
+
+/// Index of the lowest set bit.
+[[nodiscard]] inline unsigned lowest_set_bit(uint64_t word) noexcept {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, word);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+/// Index of the highest set bit.
+[[nodiscard]] inline unsigned highest_set_bit(uint64_t word) noexcept {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, word);
+    return static_cast<unsigned>(idx);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(word));
+#endif
+}
+
+class LevelBitmap {
+public:
+    static constexpr size_t NPOS = SIZE_MAX;
+    static constexpr size_t MAX_LAYERS = 4;
+
+    /// Construct covering bit indices [0, num_bits). All bits start clear.
+    explicit LevelBitmap(size_t num_bits)
+        : storage_(nullptr), num_bits_(num_bits), num_layers_(0),
+          total_words_(0) {
+        size_t bits = (num_bits == 0) ? 1 : num_bits;
+        while (num_layers_ < MAX_LAYERS) {
+            size_t words = (bits + 63) / 64;
+            word_count_[num_layers_] = words;
+            total_words_ += words;
+            ++num_layers_;
+            if (words == 1) break;
+            bits = words;
+        }
+
+        storage_ = static_cast<uint64_t*>(
+            std::calloc(total_words_, sizeof(uint64_t)));
+        if (!storage_) {
+            std::abort();
+        }
+
+        uint64_t* p = storage_;
+        for (size_t l = 0; l < num_layers_; ++l) {
+            layers_[l] = p;
+            p += word_count_[l];
+        }
+    }
+
+    ~LevelBitmap() { std::free(storage_); }
+
+    LevelBitmap(const LevelBitmap&) = delete;
+    LevelBitmap& operator=(const LevelBitmap&) = delete;
+    LevelBitmap(LevelBitmap&&) = delete;
+    LevelBitmap& operator=(LevelBitmap&&) = delete;
+
+    /// Mark index `i` occupied. Summary bits are only touched when a word
+    /// transitions from zero to non-zero.
+    void set(size_t i) noexcept {
+        for (size_t l = 0; l < num_layers_; ++l) {
+            size_t w = i >> 6;
+            bool was_empty = (layers_[l][w] == 0);
+            layers_[l][w] |= (uint64_t{1} << (i & 63));
+            if (!was_empty) return;
+            i = w;
+        }
+    }
+
+    /// Mark index `i` empty. Summary bits are only touched when a word
+    /// transitions from non-zero to zero.
+    void clear(size_t i) noexcept {
+        for (size_t l = 0; l < num_layers_; ++l) {
+            size_t w = i >> 6;
+            layers_[l][w] &= ~(uint64_t{1} << (i & 63));
+            if (layers_[l][w] != 0) return;
+            i = w;
+        }
+    }
+
+    [[nodiscard]] bool test(size_t i) const noexcept {
+        return (layers_[0][i >> 6] >> (i & 63)) & 1u;
+    }
+
+    /// True if any bit is set.
+    [[nodiscard]] bool any() const noexcept {
+        const size_t top = num_layers_ - 1;
+        for (size_t w = 0; w < word_count_[top]; ++w) {
+            if (layers_[top][w] != 0) return true;
+        }
+        return false;
+    }
+
+    /// Lowest set index >= `from`, or NPOS.
+    [[nodiscard]] size_t find_next(size_t from) const noexcept {
+        if (from >= num_bits_) return NPOS;
+
+        size_t idx = from;
+        size_t layer = 0;
+
+        // Ascend until a word holds a set bit at or after idx.
+        for (;;) {
+            size_t w = idx >> 6;
+            if (w >= word_count_[layer]) return NPOS;
+            uint64_t m = layers_[layer][w] & (~uint64_t{0} << (idx & 63));
+            if (m != 0) {
+                idx = (w << 6) | lowest_set_bit(m);
+                break;
+            }
+            if (layer + 1 == num_layers_) {
+                // Top layer wider than one word: short linear scan.
+                for (++w; w < word_count_[layer]; ++w) {
+                    if (layers_[layer][w] != 0) break;
+                }
+                if (w >= word_count_[layer]) return NPOS;
+                idx = (w << 6) | lowest_set_bit(layers_[layer][w]);
+                break;
+            }
+            idx = w + 1;
+            ++layer;
+        }
+
+        // Descend to the leaf, always taking the lowest set child.
+        while (layer > 0) {
+            --layer;
+            idx = (idx << 6) | lowest_set_bit(layers_[layer][idx]);
+        }
+        return idx;
+    }
+
+    /// Highest set index <= `from`, or NPOS. `from` is clamped to the range.
+    [[nodiscard]] size_t find_prev(size_t from) const noexcept {
+        if (num_bits_ == 0) return NPOS;
+        size_t idx = (from >= num_bits_) ? num_bits_ - 1 : from;
+        size_t layer = 0;
+
+        // Ascend until a word holds a set bit at or before idx.
+        for (;;) {
+            size_t w = idx >> 6;
+            uint64_t m = layers_[layer][w] & (~uint64_t{0} >> (63 - (idx & 63)));
+            if (m != 0) {
+                idx = (w << 6) | highest_set_bit(m);
+                break;
+            }
+            if (w == 0) return NPOS;
+            if (layer + 1 == num_layers_) {
+                // Top layer wider than one word: short linear scan.
+                do {
+                    --w;
+                } while (w > 0 && layers_[layer][w] == 0);
+                if (layers_[layer][w] == 0) return NPOS;
+                idx = (w << 6) | highest_set_bit(layers_[layer][w]);
+                break;
+            }
+            idx = w - 1;
+            ++layer;
+        }
+
+        // Descend to the leaf, always taking the highest set child.
+        while (layer > 0) {
+            --layer;
+            idx = (idx << 6) | highest_set_bit(layers_[layer][idx]);
+        }
+        return idx;
+    }
+
+    /// Clear every bit.
+    void reset() noexcept {
+        for (size_t w = 0; w < total_words_; ++w) storage_[w] = 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return num_bits_; }
+    [[nodiscard]] size_t num_layers() const noexcept { return num_layers_; }
+
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        return heap_usage(storage_, total_words_ * sizeof(uint64_t));
+    }
+
+private:
+    uint64_t* storage_;                 // All layers, one allocation
+    uint64_t* layers_[MAX_LAYERS]{};    // layers_[0] = leaf bits
+    size_t word_count_[MAX_LAYERS]{};
+    size_t num_bits_;
+    size_t num_layers_;
+    size_t total_words_;
+};
+
+}  // namespace hft
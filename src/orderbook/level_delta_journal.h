@@ -0,0 +1,162 @@
+#pragma once
+
+/// @file level_delta_journal.h
+/// @brief Market-by-price change journal: one record per PriceLevel change.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// The OrderBook records every change to a level's total_quantity or
+/// order_count here (add, remove, fill, in-place amend), so a publisher can
+/// emit compact L2 deltas — side, price, new total, new count — instead of
+/// per-order events, and consumers keep an L2 book by overwriting levels.
+///
+/// Every mode keeps each change in sequence, with the level's state right
+/// after it. Conflated mode keeps a single record per level until the next
+/// take: a mark bit per (side, level) suppresses repeats, and the record
+/// is filled with the level's state at take time, so a burst of fills on
+/// one level becomes one update carrying the final total.
+///
+/// Records beyond the capacity are dropped and counted (dropped()); size
+/// the journal for the largest number of changes between two takes.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/price_level.h"
+#include "core/types.h"
+#include "orderbook/backing_memory.h"
+
+namespace hft {
+
+/// How the OrderBook journals level changes.
+enum class LevelDeltaMode : uint8_t {
+    Off,        // No journal (default)
+    Every,      // One record per change, in order
+    Conflated   // One record per changed level between takes
+};
+
+/// New state of one price level. total_quantity == 0 means the level is
+/// gone.
+struct LevelDelta {
+    Price price;
+    Quantity total_quantity;
+    uint32_t order_count;
+    Side side;
+    uint8_t pad_[3];
+};
+
+class LevelDeltaJournal {
+public:
+    /// @param mode       Off disables the journal (no allocation).
+    /// @param capacity   Records held between two takes.
+    /// @param num_levels Logical ticks per side (sizes the conflation marks).
+    LevelDeltaJournal(LevelDeltaMode mode, size_t capacity, size_t num_levels)
+        : entries_(nullptr), marks_{nullptr, nullptr}, capacity_(capacity),
+          mark_words_(0), size_(0), dropped_(0),
+          mode_(capacity ? mode : LevelDeltaMode::Off) {
+        if (mode_ == LevelDeltaMode::Off) return;
+        entries_ = static_cast<LevelDelta*>(
+            std::calloc(capacity_, sizeof(LevelDelta)));
+        if (!entries_) {
+            std::abort();
+        }
+        if (mode_ == LevelDeltaMode::Conflated) {
+            mark_words_ = (num_levels + 63) / 64;
+            marks_[0] = static_cast<uint64_t*>(std::calloc(mark_words_, sizeof(uint64_t)));
+            marks_[1] = static_cast<uint64_t*>(std::calloc(mark_words_, sizeof(uint64_t)));
+            if (!marks_[0] || !marks_[1]) {
+                std::abort();
+            }
+        }
+    }
+
+    ~LevelDeltaJournal() {
+        std::free(entries_);
+        std::free(marks_[0]);
+        std::free(marks_[1]);
+    }
+
+    LevelDeltaJournal(const LevelDeltaJournal&) = delete;
+    LevelDeltaJournal& operator=(const LevelDeltaJournal&) = delete;
+
+    [[nodiscard]] bool enabled() const noexcept {
+        return mode_ != LevelDeltaMode::Off;
+    }
+    [[nodiscard]] LevelDeltaMode mode() const noexcept { return mode_; }
+
+    /// Note that level `idx` (at `price`) on `side` changed to `level`.
+    void record(Side side, size_t idx, Price price,
+                const PriceLevel* level) noexcept {
+        if (size_ == capacity_) [[unlikely]] {
+            // Conflated: an already-marked level still has its record
+            if (mode_ != LevelDeltaMode::Conflated || !marked(side, idx)) {
+                ++dropped_;
+            }
+            return;
+        }
+        if (mode_ == LevelDeltaMode::Conflated) {
+            uint64_t& word = marks_[static_cast<size_t>(side)][idx >> 6];
+            uint64_t bit = uint64_t{1} << (idx & 63);
+            if (word & bit) return;
+            word |= bit;
+        }
+        LevelDelta& d = entries_[size_++];
+        d.price = price;
+        d.total_quantity = level->total_quantity;
+        d.order_count = level->order_count;
+        d.side = side;
+    }
+
+    /// Conflated mode: release the mark of a record that has been taken.
+    void unmark(Side side, size_t idx) noexcept {
+        marks_[static_cast<size_t>(side)][idx >> 6] &= ~(uint64_t{1} << (idx & 63));
+    }
+
+    [[nodiscard]] LevelDelta* entries() noexcept { return entries_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage = heap_usage(entries_, capacity_ * sizeof(LevelDelta));
+        usage += heap_usage(marks_[0], mark_words_ * sizeof(uint64_t));
+        usage += heap_usage(marks_[1], mark_words_ * sizeof(uint64_t));
+        return usage;
+    }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+    /// Drop the first `n` records (already taken).
+    void consume(size_t n) noexcept {
+        size_ -= n;
+        for (size_t i = 0; i < size_; ++i) {
+            entries_[i] = entries_[i + n];
+        }
+    }
+
+    /// Drop every pending record and its conflation mark.
+    void clear() noexcept {
+        size_ = 0;
+        if (mark_words_ != 0) {
+            std::memset(marks_[0], 0, mark_words_ * sizeof(uint64_t));
+            std::memset(marks_[1], 0, mark_words_ * sizeof(uint64_t));
+        }
+    }
+
+    /// Changes lost to a full journal since construction.
+    [[nodiscard]] uint64_t dropped() const noexcept { return dropped_; }
+
+private:
+    [[nodiscard]] bool marked(Side side, size_t idx) const noexcept {
+        return marks_[static_cast<size_t>(side)][idx >> 6] &
+               (uint64_t{1} << (idx & 63));
+    }
+
+    LevelDelta* entries_;
+    uint64_t* marks_[2];  // Conflated mode: bit per level, per side
+    size_t capacity_;
+    size_t mark_words_;
+    size_t size_;
+    uint64_t dropped_;
+    LevelDeltaMode mode_;
+};
+
+}  // namespace hft
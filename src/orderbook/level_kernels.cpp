@@ -0,0 +1,77 @@
+#include "orderbook/level_kernels.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace hft {
+
+#if defined(__AVX512F__)
+
+Quantity sum_quantities(const Quantity* qty, size_t n) noexcept {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_loadu_si512(qty + i));
+        acc1 = _mm512_add_epi64(acc1, _mm512_loadu_si512(qty + i + 8));
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_loadu_si512(qty + i));
+        i += 8;
+    }
+    if (i < n) {
+        __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+        acc1 = _mm512_add_epi64(acc1, _mm512_maskz_loadu_epi64(tail, qty + i));
+    }
+    // Horizontal add through memory: the _mm512_reduce/extract intrinsics
+    // trip -Wuninitialized in GCC 12's headers.
+    alignas(64) Quantity lanes[8];
+    _mm512_store_si512(lanes, _mm512_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+const char* level_kernel_isa() noexcept { return "avx512"; }
+
+#elif defined(__AVX2__)
+
+Quantity sum_quantities(const Quantity* qty, size_t n) noexcept {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_epi64(
+            acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty + i)));
+        acc1 = _mm256_add_epi64(
+            acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty + i + 4)));
+    }
+    if (i + 4 <= n) {
+        acc0 = _mm256_add_epi64(
+            acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty + i)));
+        i += 4;
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                                 _mm256_extracti128_si256(acc, 1));
+    Quantity total = static_cast<Quantity>(_mm_cvtsi128_si64(half)) +
+                     static_cast<Quantity>(_mm_extract_epi64(half, 1));
+    for (; i < n; ++i) total += qty[i];
+    return total;
+}
+
+const char* level_kernel_isa() noexcept { return "avx2"; }
+
+#else
+
+Quantity sum_quantities(const Quantity* qty, size_t n) noexcept {
+    Quantity total = 0;
+    for (size_t i = 0; i < n; ++i) total += qty[i];
+    return total;
+}
+
+const char* level_kernel_isa() noexcept { return "scalar"; }
+
+#endif
+
+}  // namespace hft
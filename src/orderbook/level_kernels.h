@@ -0,0 +1,26 @@
+#pragma once
+
+/// @file level_kernels.h
+/// @brief Vectorised kernels over dense per-level quantity arrays.
+///
+/// Used by OrderBook's dense level-stats layout (OrderBookOptions::
+/// dense_level_stats) for FOK liquidity sums. Implemented in
+/// level_kernels.cpp, which is compiled with the hot-path flags
+/// (-march=native) and picks AVX-512, AVX2 or scalar code at build time.
+/// Keeping the intrinsics out of this header means every caller links the
+/// same definition regardless of its own compile flags.
+
+#include <cstddef>
+
+#include "core/types.h"
+
+namespace hft {
+
+/// Sum of qty[0, n). No alignment requirement.
+[[nodiscard]] Quantity sum_quantities(const Quantity* qty, size_t n) noexcept;
+
+/// Name of the instruction set the kernels were compiled for
+/// ("avx512", "avx2" or "scalar").
+[[nodiscard]] const char* level_kernel_isa() noexcept;
+
+}  // namespace hft
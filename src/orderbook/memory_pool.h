@@ -11,19 +11,74 @@
 ///   MemoryPool<Order> pool(1'000'000);  // Pre-allocate 1M slots at startup
 ///   Order* o = pool.allocate();         // O(1), no heap alloc
 ///   pool.deallocate(o);                 // O(1), no heap alloc
+///
+/// Slot stride is sizeof(T) rounded up to the slot alignment: alignof(T),
+/// or T::pool_slot_alignment if T declares one. Order opts in under
+/// HFT_LINE_ALIGNED_ORDERS so its 64-byte hot prefix never straddles two
+/// cache lines.
+///
+/// The block comes from allocate_backing(), so an optional MemoryBacking
+/// selects huge pages, NUMA binding and eager pre-fault for it.
+///
+/// Growable mode (PoolGrowth::segment_slots > 0): capacity grows in
+/// fixed-size segments that are never moved, so Order* stay valid. One spare
+/// segment is always mapped and pre-faulted; allocate() adopts it in O(1)
+/// when the free list runs dry, and grow() maps the next spare off the hot
+/// path. Quota views (MemoryPool(shared, quota)) let several pipelines on
+/// one thread draw from a single shared pool, each capped at its quota.
+/// Neither mode is thread-safe.
+///
+/// Locality mode (PoolLocality::colours > 1): storage is cut into
+/// chunk_bytes granules dealt round-robin to `colours` free lists, and a
+/// freed slot always returns to the list of its granule. allocate(hint)
+/// pops from the list the hint selects, falling back to the nearest
+/// non-empty colour. OrderGateway passes the order's level index, so orders
+/// at one price level, and at the few levels sharing its colour, keep
+/// landing in the same pages and lines however long the book churns, and
+/// the FIFO walk in the matching loop stays on a handful of pages instead
+/// of chasing pointers across the whole slab.
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <new>
 #include <type_traits>
 
-#ifdef _MSC_VER
-#include <malloc.h>
-#endif
+#include "orderbook/backing_memory.h"
 
 namespace hft {
 
+/// Slot alignment for MemoryPool<T>: alignof(T) unless T opts into a
+/// stricter one with `static constexpr size_t pool_slot_alignment`.
+template <typename T, typename = void>
+struct pool_slot_alignment {
+    static constexpr size_t value = alignof(T);
+};
+
+template <typename T>
+struct pool_slot_alignment<T, std::void_t<decltype(T::pool_slot_alignment)>> {
+    static constexpr size_t value =
+        (T::pool_slot_alignment > alignof(T)) ? T::pool_slot_alignment
+                                              : alignof(T);
+};
+
+/// Segmented growth for MemoryPool. segment_slots == 0 keeps the pool at
+/// its construction capacity.
+struct PoolGrowth {
+    size_t segment_slots = 0;  // Slots added per segment
+    size_t max_slots = 0;      // Ceiling on total capacity (0 = no ceiling)
+};
+
+/// Allocation locality for MemoryPool. colours <= 1 keeps the single LIFO
+/// free list; otherwise both counts are rounded down to powers of two and
+/// colours is capped at MemoryPool::MAX_COLOURS.
+struct PoolLocality {
+    size_t colours = 1;         // Free lists, one per storage colour
+    size_t chunk_bytes = 4096;  // Granule of storage owned by one colour
+    unsigned hint_shift = 2;    // Hints equal above this bit share a colour
+};
+
 template <typename T>
 class MemoryPool {
     static_assert(std::is_trivially_destructible_v<T>,
@@ -32,40 +87,54 @@ class MemoryPool {
                   "T must be at least pointer-sized for free list overlay");
 
 public:
+    static constexpr size_t SLOT_ALIGN = pool_slot_alignment<T>::value;
+    static constexpr size_t SLOT_SIZE =
+        (sizeof(T) + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+
+    static_assert((SLOT_ALIGN & (SLOT_ALIGN - 1)) == 0,
+                  "Slot alignment must be a power of two");
+
     /// Allocate a contiguous block for `capacity` objects. This is the only
     /// heap allocation — everything after this is O(1) free-list ops.
-    explicit MemoryPool(size_t capacity)
-        : storage_(nullptr),
-          free_list_(nullptr),
+    /// With `growth.segment_slots > 0` the pool also keeps one spare segment
+    /// mapped and pre-faulted; see grow().
+    /// `locality` splits the free list by storage colour; see allocate().
+    explicit MemoryPool(size_t capacity, const MemoryBacking& backing = {},
+                        const PoolGrowth& growth = {},
+                        const PoolLocality& locality = {})
+        : backing_cfg_(backing),
+          growth_(growth),
+          parent_(nullptr),
           capacity_(capacity),
+          num_segments_(0),
           allocated_count_(0),
-          high_water_mark_(0) {
-        // Single contiguous allocation, cache-line aligned
-#ifdef _MSC_VER
-        storage_ = static_cast<char*>(
-            _aligned_malloc(capacity * sizeof(T), alignof(T)));
-#else
-        storage_ = static_cast<char*>(
-            std::aligned_alloc(alignof(T), capacity * sizeof(T)));
-#endif
-        if (!storage_) {
-            std::abort();  // Startup failure — no recovery
+          high_water_mark_(0),
+          grow_pending_(false) {
+        set_locality(locality);
+        map_segment(capacity, free_lists_);
+        if (growth_.segment_slots > 0) {
+            grow_pending_ = true;
+            grow();
         }
+    }
 
-        // Build free list back-to-front so first allocate() returns slot 0
-        for (size_t i = capacity; i > 0; --i) {
-            auto* node = reinterpret_cast<FreeNode*>(slot_ptr(i - 1));
-            node->next = free_list_;
-            free_list_ = node;
+    /// Quota view over a shared pool: allocations come from `shared`, but at
+    /// most `quota` slots may be live through this view at once. Used to let
+    /// several single-threaded pipelines draw from one slab. Owns no memory.
+    MemoryPool(MemoryPool& shared, size_t quota) noexcept
+        : parent_(&shared),
+          capacity_(quota),
+          num_segments_(0),
+          allocated_count_(0),
+          high_water_mark_(0),
+          grow_pending_(false) {}
+
+    ~MemoryPool() {
+        for (size_t s = 0; s <= num_segments_ && s < MAX_SEGMENTS; ++s) {
+            release_backing(segments_[s]);
         }
     }
 
-#ifdef _MSC_VER
-    ~MemoryPool() { _aligned_free(storage_); }
-#else
-    ~MemoryPool() { std::free(storage_); }
-#endif
-
     // Non-copyable, non-movable — owns the backing memory.
     MemoryPool(const MemoryPool&) = delete;
     MemoryPool& operator=(const MemoryPool&) = delete;
@@ -73,12 +142,26 @@ public:
     MemoryPool& operator=(MemoryPool&&) = delete;
 
     /// O(1) allocation from the free list. Returns nullptr if pool exhausted.
-    [[nodiscard]] T* allocate() noexcept {
-        if (!free_list_) [[unlikely]] {
-            return nullptr;
+    /// In locality mode `hint` picks the colour, (hint >> hint_shift) mod
+    /// colours: callers pass something that is close for objects used
+    /// together (a price level index). An empty colour borrows from the
+    /// nearest non-empty one, so the pool only runs dry when every colour
+    /// does. Ignored with a single free list.
+    [[nodiscard]] T* allocate(size_t hint = 0) noexcept {
+        if (parent_) [[unlikely]] {
+            return allocate_from_parent(hint);
+        }
+        size_t colour = (hint >> hint_shift_) & colour_mask_;
+        if (!free_lists_[colour]) [[unlikely]] {
+            size_t found = nearest_colour(colour);
+            if (found == NO_COLOUR) {
+                if (!adopt_spare()) return nullptr;
+                found = nearest_colour(colour);
+            }
+            colour = found;
         }
-        FreeNode* node = free_list_;
-        free_list_ = node->next;
+        FreeNode* node = free_lists_[colour];
+        free_lists_[colour] = node->next;
         ++allocated_count_;
         if (allocated_count_ > high_water_mark_) [[unlikely]] {
             high_water_mark_ = allocated_count_;
@@ -86,48 +169,227 @@ public:
         return reinterpret_cast<T*>(node);
     }
 
-    /// O(1) deallocation — pushes the slot back onto the free list.
+    /// O(1) deallocation — pushes the slot back onto the free list (of its
+    /// own colour in locality mode).
     void deallocate(T* ptr) noexcept {
+        if (parent_) [[unlikely]] {
+            parent_->deallocate(ptr);
+            --allocated_count_;
+            return;
+        }
         auto* node = reinterpret_cast<FreeNode*>(ptr);
-        node->next = free_list_;
-        free_list_ = node;
+        FreeNode*& head = free_lists_[colour_of(ptr)];
+        node->next = head;
+        head = node;
         --allocated_count_;
     }
 
+    /// Map the next spare segment if allocate() consumed the previous one.
+    /// Cold path: call while idle (OrderGateway::maintain), never while
+    /// processing a message. Returns true if a spare segment is ready
+    /// afterwards.
+    bool grow() noexcept {
+        if (parent_) return parent_->grow();
+        if (!grow_pending_) return spare_ready_;
+        grow_pending_ = false;
+
+        size_t slots = growth_.segment_slots;
+        if (growth_.max_slots > 0) {
+            if (capacity_ >= growth_.max_slots) return false;
+            slots = std::min(slots, growth_.max_slots - capacity_);
+        }
+        if (slots == 0 || num_segments_ >= MAX_SEGMENTS) return false;
+
+        spare_slots_ = slots;
+        map_segment(slots, spare_lists_);
+        spare_ready_ = true;
+        --num_segments_;  // Spare is not counted until adopted
+        return true;
+    }
+
+    /// True when a spare segment was consumed and grow() should run.
+    [[nodiscard]] bool growth_pending() const noexcept {
+        return parent_ ? parent_->growth_pending() : grow_pending_;
+    }
+
     [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
     [[nodiscard]] size_t size() const noexcept { return allocated_count_; }
     [[nodiscard]] size_t high_water_mark() const noexcept {
         return high_water_mark_;
     }
-    [[nodiscard]] bool full() const noexcept { return free_list_ == nullptr; }
+    [[nodiscard]] bool full() const noexcept {
+        if (parent_) {
+            return allocated_count_ >= capacity_ || parent_->full();
+        }
+        return allocated_count_ >= capacity_ && !spare_ready_;
+    }
     [[nodiscard]] bool empty() const noexcept {
         return allocated_count_ == 0;
     }
 
+    /// Number of segments handing out slots (1 for a fixed pool).
+    [[nodiscard]] size_t segment_count() const noexcept {
+        return parent_ ? parent_->segment_count() : num_segments_;
+    }
+
+    /// Free lists in locality mode (1 = a single LIFO list).
+    [[nodiscard]] size_t colours() const noexcept {
+        return parent_ ? parent_->colours() : colour_mask_ + 1;
+    }
+
+    /// Colour of a slot: the free list it returns to. Always 0 with a
+    /// single free list.
+    [[nodiscard]] size_t colour_of(const T* ptr) const noexcept {
+        if (parent_) return parent_->colour_of(ptr);
+        return (reinterpret_cast<uintptr_t>(ptr) >> chunk_shift_) & colour_mask_;
+    }
+
+    /// Colour allocate(hint) tries first.
+    [[nodiscard]] size_t colour_for(size_t hint) const noexcept {
+        if (parent_) return parent_->colour_for(hint);
+        return (hint >> hint_shift_) & colour_mask_;
+    }
+
     /// Check if a pointer belongs to this pool's storage region.
     [[nodiscard]] bool owns(const T* ptr) const noexcept {
+        if (parent_) return parent_->owns(ptr);
         auto addr = reinterpret_cast<uintptr_t>(ptr);
-        auto start = reinterpret_cast<uintptr_t>(storage_);
-        auto end = start + capacity_ * sizeof(T);
-        return addr >= start && addr < end;
+        for (size_t s = 0; s < num_segments_; ++s) {
+            auto start = reinterpret_cast<uintptr_t>(segments_[s].data);
+            auto end = start + segment_slots_[s] * SLOT_SIZE;
+            if (addr >= start && addr < end) return true;
+        }
+        return false;
+    }
+
+    /// Backing block actually granted for the first segment (page mode,
+    /// NUMA binding).
+    [[nodiscard]] const BackingRegion& backing() const noexcept {
+        return parent_ ? parent_->backing() : segments_[0];
+    }
+
+    /// Segments (and a mapped spare) reserved and resident, plus the
+    /// high-water mark in slot bytes. Threading the free list touches every
+    /// slot, so touched ~ reserved. A quota view owns no storage and reports
+    /// only its high-water mark: count the shared pool once. Cold path.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage;
+        if (!parent_) {
+            for (const BackingRegion& segment : segments_) {
+                usage += backing_usage(segment);
+            }
+        }
+        usage.high_water_bytes = high_water_mark_ * SLOT_SIZE;
+        return usage;
     }
 
+    static constexpr size_t MAX_SEGMENTS = 64;
+    static constexpr size_t MAX_COLOURS = 64;
+
 private:
     /// Overlay on a free slot — reuses the first pointer-sized bytes.
     struct FreeNode {
         FreeNode* next;
     };
 
-    /// Get a pointer to the i-th slot in the storage block.
-    char* slot_ptr(size_t index) noexcept {
-        return storage_ + index * sizeof(T);
+    static constexpr size_t NO_COLOUR = SIZE_MAX;
+
+    static size_t floor_pow2(size_t n) noexcept {
+        size_t p = 1;
+        while (p <= n / 2) p *= 2;
+        return p;
+    }
+
+    void set_locality(const PoolLocality& locality) noexcept {
+        const size_t colours =
+            floor_pow2(std::min(std::max<size_t>(locality.colours, 1), MAX_COLOURS));
+        colour_mask_ = colours - 1;
+        hint_shift_ = std::min(locality.hint_shift, 63u);
+        chunk_shift_ = 0;
+        for (size_t chunk = floor_pow2(std::max<size_t>(locality.chunk_bytes, 1));
+             chunk > 1; chunk /= 2) {
+            ++chunk_shift_;
+        }
+    }
+
+    /// Nearest colour to `colour` (alternating up and down) with a free
+    /// slot, or NO_COLOUR. At most `colours` probes; only runs when the
+    /// hinted colour is empty.
+    [[nodiscard]] size_t nearest_colour(size_t colour) const noexcept {
+        if (free_lists_[colour]) return colour;
+        for (size_t d = 1; d <= colour_mask_; ++d) {
+            const size_t up = (colour + d) & colour_mask_;
+            if (free_lists_[up]) return up;
+            const size_t down = (colour - d) & colour_mask_;
+            if (free_lists_[down]) return down;
+        }
+        return NO_COLOUR;
+    }
+
+    /// Map a segment of `slots` slots and thread it onto the colour lists
+    /// in `lists` (which also pre-faults it). Aborts on failure —
+    /// startup/cold path only.
+    void map_segment(size_t slots, FreeNode** lists) noexcept {
+        BackingRegion& region = segments_[num_segments_];
+        region = allocate_backing(slots * SLOT_SIZE, SLOT_ALIGN, backing_cfg_);
+        segment_slots_[num_segments_] = slots;
+        ++num_segments_;
+
+        // Build free lists back-to-front so first allocate() returns slot 0
+        // (the lowest slot of its colour in locality mode)
+        char* base = static_cast<char*>(region.data);
+        for (size_t i = slots; i > 0; --i) {
+            auto* node = reinterpret_cast<FreeNode*>(base + (i - 1) * SLOT_SIZE);
+            FreeNode*& head = lists[colour_of(reinterpret_cast<T*>(node))];
+            node->next = head;
+            head = node;
+        }
+    }
+
+    /// O(colours): hand the pre-built spare segment to the free lists. Only
+    /// called once every colour is empty, so the lists are moved, not
+    /// spliced.
+    bool adopt_spare() noexcept {
+        if (!spare_ready_) return false;
+        for (size_t c = 0; c <= colour_mask_; ++c) {
+            free_lists_[c] = spare_lists_[c];
+            spare_lists_[c] = nullptr;
+        }
+        spare_ready_ = false;
+        capacity_ += spare_slots_;
+        ++num_segments_;
+        grow_pending_ = true;
+        return true;
+    }
+
+    T* allocate_from_parent(size_t hint) noexcept {
+        if (allocated_count_ >= capacity_) return nullptr;  // Quota reached
+        T* ptr = parent_->allocate(hint);
+        if (!ptr) return nullptr;
+        ++allocated_count_;
+        if (allocated_count_ > high_water_mark_) {
+            high_water_mark_ = allocated_count_;
+        }
+        return ptr;
     }
 
-    char* storage_;
-    FreeNode* free_list_;
-    size_t capacity_;
+    BackingRegion segments_[MAX_SEGMENTS]{};  // [num_segments_] = spare
+    size_t segment_slots_[MAX_SEGMENTS]{};
+    MemoryBacking backing_cfg_;
+    PoolGrowth growth_;
+    FreeNode* free_lists_[MAX_COLOURS]{};   // [0, colour_mask_] in use
+    FreeNode* spare_lists_[MAX_COLOURS]{};  // Pre-faulted next segment (growable)
+    size_t colour_mask_ = 0;  // colours - 1
+    unsigned chunk_shift_ = 12;
+    unsigned hint_shift_ = 0;
+    bool spare_ready_ = false;
+    MemoryPool* parent_;      // Quota view: shared pool, else nullptr
+    size_t capacity_;         // Adopted slots (quota for a view)
+    size_t spare_slots_ = 0;
+    size_t num_segments_;
     size_t allocated_count_;
     size_t high_water_mark_;
+    bool grow_pending_;
 };
 
 }  // namespace hft
@@ -4,39 +4,92 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "orderbook/level_kernels.h"
+
 namespace hft {
 
+namespace {
+
+size_t ladder_levels(Price min_price, Price max_price, Price tick_size) {
+    return static_cast<size_t>((max_price - min_price) / tick_size) + 1;
+}
+
+/// Ring size for windowed mode, or 0 for a flat ladder. A window that would
+/// cover the whole range degenerates to the flat ladder.
+size_t window_size_for(const OrderBookOptions& options, size_t num_levels) {
+    if (options.window_levels == 0) return 0;
+    size_t w = 64;
+    while (w < options.window_levels) w <<= 1;
+    return (w >= num_levels) ? 0 : w;
+}
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+size_t align_up(size_t bytes) {
+    return (bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+}  // namespace
+
 OrderBook::OrderBook(Price min_price, Price max_price, Price tick_size,
-                     size_t max_orders)
+                     size_t max_orders, const OrderBookOptions& options)
     : bid_levels_(nullptr),
       ask_levels_(nullptr),
-      num_levels_(0),
+      num_levels_(ladder_levels(min_price, max_price, tick_size)),
+      window_size_(window_size_for(options, num_levels_)),
+      window_mask_(window_size_ ? window_size_ - 1 : 0),
+      window_base_(window_size_ ? (num_levels_ - window_size_) / 2 : 0),
+      bid_bitmap_(window_size_ ? window_size_ : num_levels_),
+      ask_bitmap_(window_size_ ? window_size_ : num_levels_),
+      bid_overflow_(window_size_ ? options.overflow_levels : 0),
+      ask_overflow_(window_size_ ? options.overflow_levels : 0),
+      bid_qty_(nullptr),
+      ask_qty_(nullptr),
+      bid_cnt_(nullptr),
+      ask_cnt_(nullptr),
       min_price_(min_price),
       max_price_(max_price),
       tick_size_(tick_size),
+      tick_div_(tick_size, max_price - min_price + tick_size),
       best_bid_idx_(INVALID_INDEX),
       best_ask_idx_(INVALID_INDEX),
-      order_map_(max_orders),
+      order_map_(max_orders, options.memory, options.order_map_probe,
+                 options.order_map_growable),
+      direct_index_(options.direct_index_pages, order_map_, options.memory),
+      participants_(options.max_participants),
+      level_deltas_(options.level_deltas, options.level_delta_capacity,
+                    num_levels_),
       order_count_(0) {
-    num_levels_ =
-        static_cast<size_t>((max_price - min_price) / tick_size) + 1;
-
-    // calloc zero-inits: price=0, total_quantity=0, order_count=0,
-    // head=nullptr, tail=nullptr — a valid empty PriceLevel.
-    bid_levels_ =
-        static_cast<PriceLevel*>(std::calloc(num_levels_, sizeof(PriceLevel)));
-    ask_levels_ =
-        static_cast<PriceLevel*>(std::calloc(num_levels_, sizeof(PriceLevel)));
-
-    if (!bid_levels_ || !ask_levels_) {
-        std::abort();
+    size_t slots = window_size_ ? window_size_ : num_levels_;
+    bool dense = options.dense_level_stats && window_size_ == 0;
+
+    // One backing block for both ladders and the dense mirrors, each array
+    // starting on its own cache line. Zero-filled: price=0,
+    // total_quantity=0, order_count=0, head=nullptr, tail=nullptr — a valid
+    // empty PriceLevel.
+    size_t level_bytes = align_up(slots * sizeof(PriceLevel));
+    size_t qty_bytes = dense ? align_up(slots * sizeof(Quantity)) : 0;
+    size_t cnt_bytes = dense ? align_up(slots * sizeof(uint32_t)) : 0;
+    level_region_ = allocate_backing(
+        2 * (level_bytes + qty_bytes + cnt_bytes), CACHE_LINE_SIZE,
+        options.memory);
+
+    char* p = static_cast<char*>(level_region_.data);
+    bid_levels_ = reinterpret_cast<PriceLevel*>(p);
+    ask_levels_ = reinterpret_cast<PriceLevel*>(p + level_bytes);
+    p += 2 * level_bytes;
+
+    if (dense) {
+        bid_qty_ = reinterpret_cast<Quantity*>(p);
+        ask_qty_ = reinterpret_cast<Quantity*>(p + qty_bytes);
+        p += 2 * qty_bytes;
+        bid_cnt_ = reinterpret_cast<uint32_t*>(p);
+        ask_cnt_ = reinterpret_cast<uint32_t*>(p + cnt_bytes);
     }
+    if (options.state_digest) digest_.enable(0);
 }
 
-OrderBook::~OrderBook() {
-    std::free(bid_levels_);
-    std::free(ask_levels_);
-}
+OrderBook::~OrderBook() { release_backing(level_region_); }
 
 // ---------------------------------------------------------------------------
 // Add / Cancel / Remove
@@ -47,16 +100,33 @@ AddResult OrderBook::add_order(Order* order) noexcept {
         return {false};
     }
 
-    if (!order_map_.insert(order->order_id, order)) [[unlikely]] {
-        return {false};  // Duplicate ID or ID == 0
+    size_t idx = price_to_index(order->price);
+    PriceLevel* level = level_for_insert(order->side, idx);
+    if (!level) [[unlikely]] {
+        return {false};  // Windowed mode: overflow store full
     }
 
-    size_t idx = price_to_index(order->price);
-    PriceLevel* levels =
-        (order->side == Side::Buy) ? bid_levels_ : ask_levels_;
+    if (!index_insert(order->order_id, order)) [[unlikely]] {
+        if (level->empty()) release_level(order->side, idx);
+        return {false};  // Duplicate ID, ID == 0, or order index full
+    }
+
+    if (!participants_.link(order)) [[unlikely]] {
+        index_erase(order->order_id);
+        if (level->empty()) release_level(order->side, idx);
+        return {false};  // Participant table full
+    }
 
-    levels[idx].price = order->price;
-    levels[idx].add_order(order);
+    if (level->empty()) {
+        occupy_level(order->side, idx);
+    }
+    level->price = order->price;
+    level->add_order(order);
+    if (digest_.enabled()) [[unlikely]] digest_.add(*order);
+    if (bid_qty_) [[unlikely]] sync_dense(order->side, idx, level);
+    if (level_deltas_.enabled()) [[unlikely]] {
+        level_deltas_.record(order->side, idx, order->price, level);
+    }
     ++order_count_;
 
     // Update best bid/ask
@@ -75,7 +145,7 @@ AddResult OrderBook::add_order(Order* order) noexcept {
 }
 
 CancelResult OrderBook::cancel_order(OrderId id) noexcept {
-    Order* order = order_map_.find(id);
+    Order* order = index_find(id);
     if (!order) [[unlikely]] {
         return {false, nullptr};
     }
@@ -88,31 +158,47 @@ CancelResult OrderBook::cancel_order(OrderId id) noexcept {
 ModifyResult OrderBook::modify_order(OrderId id, Price new_price,
                                      Quantity new_quantity,
                                      Timestamp new_timestamp) noexcept {
-    Order* order = order_map_.find(id);
+    Order* order = index_find(id);
     if (!order) [[unlikely]] {
-        return {false, nullptr, 0, 0};
+        return {false, nullptr, 0, 0, false};
     }
 
     // Only resting orders (Accepted or PartialFill) can be modified
     if (order->status != OrderStatus::Accepted &&
         order->status != OrderStatus::PartialFill) [[unlikely]] {
-        return {false, nullptr, 0, 0};
+        return {false, nullptr, 0, 0, false};
     }
 
     // New quantity must be greater than already-filled quantity
     if (new_quantity <= order->filled_quantity) [[unlikely]] {
-        return {false, nullptr, 0, 0};
+        return {false, nullptr, 0, 0, false};
     }
 
     // New price must be valid
     if (!is_valid_price(new_price)) [[unlikely]] {
-        return {false, nullptr, 0, 0};
+        return {false, nullptr, 0, 0, false};
     }
 
     // Capture old values for event publishing
     Price old_price = order->price;
     Quantity old_quantity = order->quantity;
 
+    // Same-price size-down: amend in place and keep queue position
+    if (new_price == old_price && new_quantity < old_quantity) {
+        size_t idx = price_to_index(old_price);
+        reduce_level_quantity(level_at(order->side, idx), *order,
+                              old_quantity - new_quantity);
+        order->quantity = new_quantity;
+        if (order->type == OrderType::Iceberg && order->iceberg_slice_qty > 0) {
+            // Keep the current slice unless the new size cuts into it
+            order->visible_quantity =
+                std::min(order->visible_quantity, new_quantity);
+        } else {
+            order->visible_quantity = new_quantity;
+        }
+        return {true, order, old_price, old_quantity, true};
+    }
+
     // Remove from current level and order map
     remove_order(order);
 
@@ -134,24 +220,31 @@ ModifyResult OrderBook::modify_order(OrderId id, Price new_price,
     order->next = nullptr;
     order->prev = nullptr;
 
-    return {true, order, old_price, old_quantity};
+    return {true, order, old_price, old_quantity, false};
 }
 
 void OrderBook::remove_order(Order* order) noexcept {
     size_t idx = price_to_index(order->price);
-    PriceLevel* levels =
-        (order->side == Side::Buy) ? bid_levels_ : ask_levels_;
+    PriceLevel* level = level_at(order->side, idx);
 
-    levels[idx].remove_order(order);
-    order_map_.erase(order->order_id);
+    level->remove_order(order);
+    if (digest_.enabled()) [[unlikely]] digest_.remove(*order);
+    if (bid_qty_) [[unlikely]] sync_dense(order->side, idx, level);
+    if (level_deltas_.enabled()) [[unlikely]] {
+        level_deltas_.record(order->side, idx, order->price, level);
+    }
+    index_erase(order->order_id);
+    participants_.unlink(order);
     --order_count_;
 
-    // If this level is now empty and was the best, find the new best.
-    if (levels[idx].empty()) {
-        if (order->side == Side::Buy && idx == best_bid_idx_) {
-            update_best_bid_after_remove(idx);
-        } else if (order->side == Side::Sell && idx == best_ask_idx_) {
-            update_best_ask_after_remove(idx);
+    // If this level is now empty, release it; if it was the best,
+    // find the new best.
+    if (level->empty()) {
+        release_level(order->side, idx);
+        if (order->side == Side::Buy) {
+            if (idx == best_bid_idx_) update_best_bid_after_remove(idx);
+        } else {
+            if (idx == best_ask_idx_) update_best_ask_after_remove(idx);
         }
     }
 }
@@ -162,58 +255,197 @@ void OrderBook::remove_order(Order* order) noexcept {
 
 const PriceLevel* OrderBook::best_bid() const noexcept {
     if (best_bid_idx_ == INVALID_INDEX) return nullptr;
-    return &bid_levels_[best_bid_idx_];
+    return level_at(Side::Buy, best_bid_idx_);
 }
 
 const PriceLevel* OrderBook::best_ask() const noexcept {
     if (best_ask_idx_ == INVALID_INDEX) return nullptr;
-    return &ask_levels_[best_ask_idx_];
+    return level_at(Side::Sell, best_ask_idx_);
 }
 
 PriceLevel* OrderBook::best_bid_level() noexcept {
     if (best_bid_idx_ == INVALID_INDEX) return nullptr;
-    return &bid_levels_[best_bid_idx_];
+    return level_at(Side::Buy, best_bid_idx_);
 }
 
 PriceLevel* OrderBook::best_ask_level() noexcept {
     if (best_ask_idx_ == INVALID_INDEX) return nullptr;
-    return &ask_levels_[best_ask_idx_];
+    return level_at(Side::Sell, best_ask_idx_);
 }
 
 Price OrderBook::spread() const noexcept {
     if (best_bid_idx_ == INVALID_INDEX || best_ask_idx_ == INVALID_INDEX) {
         return -1;
     }
-    return ask_levels_[best_ask_idx_].price - bid_levels_[best_bid_idx_].price;
+    return index_to_price(best_ask_idx_) - index_to_price(best_bid_idx_);
 }
 
 Price OrderBook::mid_price() const noexcept {
     if (best_bid_idx_ == INVALID_INDEX || best_ask_idx_ == INVALID_INDEX) {
         return 0;
     }
-    return (bid_levels_[best_bid_idx_].price +
-            ask_levels_[best_ask_idx_].price) / 2;
+    return (index_to_price(best_bid_idx_) + index_to_price(best_ask_idx_)) / 2;
+}
+
+BookMemoryUsage OrderBook::memory_usage() const noexcept {
+    BookMemoryUsage usage;
+    usage.levels = backing_usage(level_region_);
+    usage.levels += bid_bitmap_.memory_usage();
+    usage.levels += ask_bitmap_.memory_usage();
+    usage.levels += bid_overflow_.memory_usage();
+    usage.levels += ask_overflow_.memory_usage();
+    usage.order_index = order_map_.memory_usage();
+    usage.order_index += direct_index_.memory_usage();
+    usage.auxiliary = participants_.memory_usage();
+    usage.auxiliary += level_deltas_.memory_usage();
+    return usage;
 }
 
 Order* OrderBook::find_order(OrderId id) const noexcept {
-    return order_map_.find(id);
+    return index_find(id);
 }
 
 // ---------------------------------------------------------------------------
 // Price indexing
 // ---------------------------------------------------------------------------
 
-size_t OrderBook::price_to_index(Price price) const noexcept {
-    return static_cast<size_t>((price - min_price_) / tick_size_);
+bool OrderBook::is_valid_price(Price price) const noexcept {
+    if (price < min_price_ || price > max_price_) return false;
+    uint64_t offset = static_cast<uint64_t>(price - min_price_);
+    return tick_div_.divide(offset) * static_cast<uint64_t>(tick_size_) ==
+           offset;
 }
 
-Price OrderBook::index_to_price(size_t index) const noexcept {
-    return min_price_ + static_cast<Price>(index) * tick_size_;
+// ---------------------------------------------------------------------------
+// Level deltas
+// ---------------------------------------------------------------------------
+
+size_t OrderBook::drain_level_deltas(LevelDelta* out, size_t max) noexcept {
+    size_t n = std::min(max, level_deltas_.size());
+    const LevelDelta* entries = level_deltas_.entries();
+    bool conflated = level_deltas_.mode() == LevelDeltaMode::Conflated;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = entries[i];
+        if (!conflated) continue;
+        // Level's state now; a released windowed-mode level reads as gone
+        size_t idx = price_to_index(out[i].price);
+        const PriceLevel* level = level_at(out[i].side, idx);
+        out[i].total_quantity = level ? level->total_quantity : 0;
+        out[i].order_count = level ? level->order_count : 0;
+        level_deltas_.unmark(out[i].side, idx);
+    }
+    level_deltas_.consume(n);
+    return n;
 }
 
-bool OrderBook::is_valid_price(Price price) const noexcept {
-    return price >= min_price_ && price <= max_price_ &&
-           ((price - min_price_) % tick_size_ == 0);
+// ---------------------------------------------------------------------------
+// Level storage
+// ---------------------------------------------------------------------------
+
+PriceLevel* OrderBook::level_at(Side side, size_t idx) const noexcept {
+    PriceLevel* levels = (side == Side::Buy) ? bid_levels_ : ask_levels_;
+    if (window_size_ == 0) [[likely]] {
+        return &levels[idx];
+    }
+    if (in_window(idx)) [[likely]] {
+        return &levels[idx & window_mask_];
+    }
+    return ((side == Side::Buy) ? bid_overflow_ : ask_overflow_).find(idx);
+}
+
+PriceLevel* OrderBook::level_for_insert(Side side, size_t idx) noexcept {
+    if (window_size_ == 0 || in_window(idx)) [[likely]] {
+        return level_at(side, idx);
+    }
+    return ((side == Side::Buy) ? bid_overflow_ : ask_overflow_)
+        .find_or_insert(idx);
+}
+
+void OrderBook::occupy_level(Side side, size_t idx) noexcept {
+    // Overflow levels need no marking: their entry exists iff non-empty.
+    if (window_size_ == 0) [[likely]] {
+        ((side == Side::Buy) ? bid_bitmap_ : ask_bitmap_).set(idx);
+    } else if (in_window(idx)) {
+        ((side == Side::Buy) ? bid_bitmap_ : ask_bitmap_)
+            .set(idx & window_mask_);
+    }
+}
+
+void OrderBook::release_level(Side side, size_t idx) noexcept {
+    if (window_size_ == 0) [[likely]] {
+        ((side == Side::Buy) ? bid_bitmap_ : ask_bitmap_).clear(idx);
+    } else if (in_window(idx)) {
+        ((side == Side::Buy) ? bid_bitmap_ : ask_bitmap_)
+            .clear(idx & window_mask_);
+    } else {
+        ((side == Side::Buy) ? bid_overflow_ : ask_overflow_).erase(idx);
+    }
+}
+
+size_t OrderBook::ring_next(const LevelBitmap& bm, size_t from) const noexcept {
+    // In-window index i lives in slot (i & mask); slots from the base slot
+    // upward hold ascending indices, wrapping once through slot 0.
+    size_t end = window_base_ + window_size_;
+    if (from >= end) return INVALID_INDEX;
+    if (from < window_base_) from = window_base_;
+
+    size_t base_slot = window_base_ & window_mask_;
+    size_t slot = from & window_mask_;
+    size_t hit = bm.find_next(slot);
+    if (slot >= base_slot) {
+        if (hit == LevelBitmap::NPOS) hit = bm.find_next(0);
+        if (hit == LevelBitmap::NPOS || (hit < slot && hit >= base_slot)) {
+            return INVALID_INDEX;
+        }
+    } else if (hit == LevelBitmap::NPOS || hit >= base_slot) {
+        return INVALID_INDEX;
+    }
+    return window_base_ + ((hit - base_slot) & window_mask_);
+}
+
+size_t OrderBook::ring_prev(const LevelBitmap& bm, size_t from) const noexcept {
+    if (from < window_base_) return INVALID_INDEX;
+    size_t last = window_base_ + window_size_ - 1;
+    if (from > last) from = last;
+
+    size_t base_slot = window_base_ & window_mask_;
+    size_t slot = from & window_mask_;
+    size_t hit = bm.find_prev(slot);
+    if (slot >= base_slot) {
+        if (hit == LevelBitmap::NPOS || hit < base_slot) return INVALID_INDEX;
+    } else if (hit == LevelBitmap::NPOS) {
+        hit = bm.find_prev(window_size_ - 1);
+        if (hit == LevelBitmap::NPOS || hit < base_slot) return INVALID_INDEX;
+    }
+    return window_base_ + ((hit - base_slot) & window_mask_);
+}
+
+size_t OrderBook::next_occupied(Side side, size_t from) const noexcept {
+    const LevelBitmap& bm = (side == Side::Buy) ? bid_bitmap_ : ask_bitmap_;
+    if (window_size_ == 0) [[likely]] {
+        size_t hit = bm.find_next(from);
+        return (hit == LevelBitmap::NPOS) ? INVALID_INDEX : hit;
+    }
+    const OverflowLevels& ovf =
+        (side == Side::Buy) ? bid_overflow_ : ask_overflow_;
+    size_t r = ring_next(bm, from);
+    size_t o = ovf.find_next(from);
+    return std::min(r, o);  // INVALID_INDEX == NPOS == SIZE_MAX
+}
+
+size_t OrderBook::prev_occupied(Side side, size_t from) const noexcept {
+    const LevelBitmap& bm = (side == Side::Buy) ? bid_bitmap_ : ask_bitmap_;
+    if (window_size_ == 0) [[likely]] {
+        size_t hit = bm.find_prev(from);
+        return (hit == LevelBitmap::NPOS) ? INVALID_INDEX : hit;
+    }
+    const OverflowLevels& ovf =
+        (side == Side::Buy) ? bid_overflow_ : ask_overflow_;
+    size_t r = ring_prev(bm, from);
+    size_t o = ovf.find_prev(from);
+    if (r == INVALID_INDEX) return o;
+    if (o == OverflowLevels::NPOS) return r;
+    return std::max(r, o);
 }
 
 // ---------------------------------------------------------------------------
@@ -226,25 +458,127 @@ Quantity OrderBook::available_quantity(Side side, Price limit_price) const noexc
     if (side == Side::Sell) {
         // Buying: walk ask levels from best_ask upward to limit_price
         if (best_ask_idx_ == INVALID_INDEX) return 0;
+        if (limit_price < min_price_) return 0;
         size_t max_idx = price_to_index(
             (limit_price > max_price_) ? max_price_ : limit_price);
-        for (size_t i = best_ask_idx_; i <= max_idx && i < num_levels_; ++i) {
-            total += ask_levels_[i].total_quantity;
+        if (ask_qty_) return dense_sum_asks(best_ask_idx_, max_idx);
+        for (size_t i = best_ask_idx_; i <= max_idx;
+             i = next_occupied(Side::Sell, i + 1)) {
+            total += level_at(Side::Sell, i)->total_quantity;
         }
     } else {
         // Selling: walk bid levels from best_bid downward to limit_price
         if (best_bid_idx_ == INVALID_INDEX) return 0;
-        size_t min_idx = price_to_index(
-            (limit_price < min_price_) ? min_price_ : limit_price);
-        for (size_t i = best_bid_idx_;; --i) {
-            total += bid_levels_[i].total_quantity;
-            if (i == min_idx || i == 0) break;
+        if (limit_price > max_price_) return 0;
+        // Round a non-aligned limit up to the next tick: bids below it
+        // do not cross.
+        Price floor_price = (limit_price < min_price_) ? min_price_ : limit_price;
+        size_t min_idx = static_cast<size_t>(tick_div_.divide(
+            static_cast<uint64_t>(floor_price - min_price_ + tick_size_ - 1)));
+        if (bid_qty_) return dense_sum_bids(min_idx, best_bid_idx_);
+        for (size_t i = best_bid_idx_; i != INVALID_INDEX && i >= min_idx;
+             i = (i == 0) ? INVALID_INDEX : prev_occupied(Side::Buy, i - 1)) {
+            total += level_at(Side::Buy, i)->total_quantity;
         }
     }
 
     return total;
 }
 
+Quantity OrderBook::dense_sum_asks(size_t from, size_t to) const noexcept {
+    // Sum [from, to] one 64-tick bitmap block at a time; blocks with no
+    // occupied level are skipped via the bitmap, occupied ones are summed
+    // as a contiguous vector stream (empty ticks contribute zero).
+    Quantity total = 0;
+    for (size_t i = from; i <= to;) {
+        size_t block_end = std::min((i | 63) + 1, to + 1);
+        total += sum_quantities(ask_qty_ + i, block_end - i);
+        if (block_end > to) break;
+        i = next_occupied(Side::Sell, block_end);
+    }
+    return total;
+}
+
+Quantity OrderBook::dense_sum_bids(size_t from, size_t to) const noexcept {
+    // Mirror of dense_sum_asks, walking downward from `to` to `from`.
+    Quantity total = 0;
+    for (size_t i = to; i != INVALID_INDEX && i >= from;) {
+        size_t block_begin = std::max(i & ~size_t{63}, from);
+        total += sum_quantities(bid_qty_ + block_begin, i - block_begin + 1);
+        if (block_begin <= from) break;
+        i = prev_occupied(Side::Buy, block_begin - 1);
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+// Call-auction equilibrium
+// ---------------------------------------------------------------------------
+
+AuctionQuote OrderBook::compute_uncross(Price reference_price) const noexcept {
+    AuctionQuote best{0, 0, 0, 0};
+    if (best_bid_idx_ == INVALID_INDEX || best_ask_idx_ == INVALID_INDEX ||
+        best_bid_idx_ < best_ask_idx_) {
+        return best;  // Not crossed
+    }
+    const size_t lo = best_ask_idx_;
+    const size_t hi = best_bid_idx_;
+
+    // Bids below the best ask can never execute; the rest start counted.
+    Quantity bids_at_or_above = 0;
+    for (size_t i = hi; i != INVALID_INDEX && i >= lo;
+         i = (i == 0) ? INVALID_INDEX : prev_occupied(Side::Buy, i - 1)) {
+        bids_at_or_above += level_at(Side::Buy, i)->total_quantity;
+    }
+
+    // Ascending merge over both sides' occupied levels in [lo, hi]:
+    // asks accumulate up to p, bids strictly below p drop out after p.
+    Quantity asks_at_or_below = 0;
+    size_t ask_i = lo;
+    size_t bid_i = next_occupied(Side::Buy, lo);
+    Quantity best_surplus = 0;
+    Price best_distance = 0;
+
+    while (true) {
+        size_t p = std::min(ask_i, bid_i);
+        if (p == INVALID_INDEX || p > hi) break;
+
+        if (ask_i == p) {
+            asks_at_or_below += level_at(Side::Sell, p)->total_quantity;
+            ask_i = next_occupied(Side::Sell, p + 1);
+        }
+
+        Quantity volume = std::min(bids_at_or_above, asks_at_or_below);
+        Quantity surplus = (bids_at_or_above > asks_at_or_below)
+                               ? bids_at_or_above - asks_at_or_below
+                               : asks_at_or_below - bids_at_or_above;
+        Price price = index_to_price(p);
+        Price distance = (reference_price > 0)
+                             ? (price > reference_price ? price - reference_price
+                                                        : reference_price - price)
+                             : 0;
+
+        bool better = volume > best.volume ||
+                      (volume == best.volume && volume > 0 &&
+                       (surplus < best_surplus ||
+                        (surplus == best_surplus && distance < best_distance)));
+        if (better) {
+            best.price = price;
+            best.volume = volume;
+            best.buy_surplus = bids_at_or_above - volume;
+            best.sell_surplus = asks_at_or_below - volume;
+            best_surplus = surplus;
+            best_distance = distance;
+        }
+
+        if (bid_i == p) {
+            bids_at_or_above -= level_at(Side::Buy, p)->total_quantity;
+            bid_i = next_occupied(Side::Buy, p + 1);
+        }
+    }
+    return best;
+}
+
 // ---------------------------------------------------------------------------
 // Depth queries
 // ---------------------------------------------------------------------------
@@ -253,15 +587,19 @@ size_t OrderBook::get_bid_depth(DepthEntry* out, size_t max_levels) const noexce
     if (best_bid_idx_ == INVALID_INDEX || max_levels == 0) return 0;
 
     size_t count = 0;
-    for (size_t i = best_bid_idx_;; --i) {
-        if (!bid_levels_[i].empty()) {
-            out[count].price = bid_levels_[i].price;
-            out[count].quantity = bid_levels_[i].total_quantity;
-            out[count].order_count = bid_levels_[i].order_count;
-            ++count;
-            if (count >= max_levels) break;
+    for (size_t i = best_bid_idx_; i != INVALID_INDEX;
+         i = (i == 0) ? INVALID_INDEX : prev_occupied(Side::Buy, i - 1)) {
+        if (bid_qty_) {
+            out[count].price = index_to_price(i);
+            out[count].quantity = bid_qty_[i];
+            out[count].order_count = bid_cnt_[i];
+        } else {
+            const PriceLevel* level = level_at(Side::Buy, i);
+            out[count].price = level->price;
+            out[count].quantity = level->total_quantity;
+            out[count].order_count = level->order_count;
         }
-        if (i == 0) break;
+        if (++count >= max_levels) break;
     }
     return count;
 }
@@ -270,47 +608,209 @@ size_t OrderBook::get_ask_depth(DepthEntry* out, size_t max_levels) const noexce
     if (best_ask_idx_ == INVALID_INDEX || max_levels == 0) return 0;
 
     size_t count = 0;
-    for (size_t i = best_ask_idx_; i < num_levels_; ++i) {
-        if (!ask_levels_[i].empty()) {
-            out[count].price = ask_levels_[i].price;
-            out[count].quantity = ask_levels_[i].total_quantity;
-            out[count].order_count = ask_levels_[i].order_count;
-            ++count;
-            if (count >= max_levels) break;
+    for (size_t i = best_ask_idx_; i != INVALID_INDEX;
+         i = next_occupied(Side::Sell, i + 1)) {
+        if (ask_qty_) {
+            out[count].price = index_to_price(i);
+            out[count].quantity = ask_qty_[i];
+            out[count].order_count = ask_cnt_[i];
+        } else {
+            const PriceLevel* level = level_at(Side::Sell, i);
+            out[count].price = level->price;
+            out[count].quantity = level->total_quantity;
+            out[count].order_count = level->order_count;
         }
+        if (++count >= max_levels) break;
     }
     return count;
 }
 
 // ---------------------------------------------------------------------------
-// Best bid/ask maintenance
+// Level walk and bulk restore (snapshots)
 // ---------------------------------------------------------------------------
 
-void OrderBook::update_best_bid_after_remove(size_t emptied_idx) noexcept {
-    // Best bid = highest index with orders. Scan down from emptied_idx.
-    if (emptied_idx == 0) {
-        best_bid_idx_ = INVALID_INDEX;
-        return;
-    }
-    for (size_t i = emptied_idx - 1;; --i) {
-        if (!bid_levels_[i].empty()) {
-            best_bid_idx_ = i;
-            return;
+void OrderBook::reset_index() noexcept {
+    order_map_.clear();
+    direct_index_.reset();
+    level_deltas_.clear();
+    if (digest_.enabled()) digest_.enable(0);
+}
+
+uint64_t OrderBook::compute_state_digest() const noexcept {
+    uint64_t digest = 0;
+    for (Side side : {Side::Buy, Side::Sell}) {
+        for (const PriceLevel* l = next_level(side, nullptr); l; l = next_level(side, l)) {
+            for (const Order* o = l->head; o; o = o->next) {
+                digest += BookDigest::order_term(o->order_id, side, l->price,
+                                                 o->remaining_quantity());
+            }
         }
-        if (i == 0) break;
     }
-    best_bid_idx_ = INVALID_INDEX;
+    return digest;
 }
 
-void OrderBook::update_best_ask_after_remove(size_t emptied_idx) noexcept {
-    // Best ask = lowest index with orders. Scan up from emptied_idx.
-    for (size_t i = emptied_idx + 1; i < num_levels_; ++i) {
-        if (!ask_levels_[i].empty()) {
-            best_ask_idx_ = i;
-            return;
+const PriceLevel* OrderBook::next_level(Side side,
+                                        const PriceLevel* level) const noexcept {
+    size_t idx;
+    if (!level) {
+        idx = (side == Side::Buy) ? best_bid_idx_ : best_ask_idx_;
+    } else if (side == Side::Buy) {
+        const size_t from = price_to_index(level->price);
+        idx = (from == 0) ? INVALID_INDEX : prev_occupied(Side::Buy, from - 1);
+    } else {
+        idx = next_occupied(Side::Sell, price_to_index(level->price) + 1);
+    }
+    return (idx == INVALID_INDEX) ? nullptr : level_at(side, idx);
+}
+
+bool OrderBook::restore_level(Side side, Price price, Order* const* orders,
+                              size_t count) noexcept {
+    if (count == 0) return true;
+    if (!is_valid_price(price)) return false;
+
+    const size_t idx = price_to_index(price);
+    PriceLevel* level = level_for_insert(side, idx);
+    if (!level) return false;            // Windowed mode: overflow store full
+    if (!level->empty()) return false;   // Each level is restored once
+
+    // One pass: index, participant list and FIFO links together
+    Quantity total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Order* order = orders[i];
+        order->price = price;
+        order->side = side;
+        bool linked = index_insert(order->order_id, order);
+        if (linked && !participants_.link(order)) {
+            index_erase(order->order_id);
+            linked = false;
+        }
+        if (!linked) [[unlikely]] {
+            for (size_t j = 0; j < i; ++j) {
+                participants_.unlink(orders[j]);
+                index_erase(orders[j]->order_id);
+            }
+            release_level(side, idx);
+            return false;
         }
+        order->prev = (i == 0) ? nullptr : orders[i - 1];
+        order->next = (i + 1 == count) ? nullptr : orders[i + 1];
+        total += order->remaining_quantity();
+    }
+
+    occupy_level(side, idx);
+    level->price = price;
+    level->head = orders[0];
+    level->tail = orders[count - 1];
+    level->total_quantity = total;
+    level->order_count = static_cast<uint32_t>(count);
+    if (bid_qty_) sync_dense(side, idx, level);
+    if (digest_.enabled()) {
+        for (size_t i = 0; i < count; ++i) digest_.add(*orders[i]);
+    }
+    order_count_ += count;
+
+    if (side == Side::Buy) {
+        if (best_bid_idx_ == INVALID_INDEX || idx > best_bid_idx_) best_bid_idx_ = idx;
+    } else {
+        if (best_ask_idx_ == INVALID_INDEX || idx < best_ask_idx_) best_ask_idx_ = idx;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Best bid/ask maintenance
+// ---------------------------------------------------------------------------
+
+void OrderBook::update_best_bid_after_remove(size_t emptied_idx) noexcept {
+    // Best bid = highest occupied index below the emptied one.
+    best_bid_idx_ = (emptied_idx == 0)
+                        ? INVALID_INDEX
+                        : prev_occupied(Side::Buy, emptied_idx - 1);
+}
+
+void OrderBook::update_best_ask_after_remove(size_t emptied_idx) noexcept {
+    // Best ask = lowest occupied index above the emptied one.
+    best_ask_idx_ = next_occupied(Side::Sell, emptied_idx + 1);
+}
+
+// ---------------------------------------------------------------------------
+// Windowed ladder recentering
+// ---------------------------------------------------------------------------
+
+bool OrderBook::maybe_recenter() noexcept {
+    if (window_size_ == 0) return false;
+
+    size_t ref;
+    if (best_bid_idx_ != INVALID_INDEX && best_ask_idx_ != INVALID_INDEX) {
+        ref = best_bid_idx_ + (best_ask_idx_ - best_bid_idx_) / 2;
+    } else if (best_bid_idx_ != INVALID_INDEX) {
+        ref = best_bid_idx_;
+    } else if (best_ask_idx_ != INVALID_INDEX) {
+        ref = best_ask_idx_;
+    } else {
+        return false;
+    }
+
+    // Touch still inside the middle half of the window — nothing to do.
+    size_t quarter = window_size_ / 4;
+    if (ref >= window_base_ + quarter &&
+        ref < window_base_ + window_size_ - quarter) [[likely]] {
+        return false;
+    }
+
+    size_t half = window_size_ / 2;
+    size_t new_base = (ref > half) ? ref - half : 0;
+    if (new_base > num_levels_ - window_size_) {
+        new_base = num_levels_ - window_size_;
+    }
+    if (new_base == window_base_) return false;
+
+    // Departing levels are parked in overflow before arriving ones leave
+    // it, so the store must have room for all of them up front.
+    if (departing_levels(bid_bitmap_, new_base) > bid_overflow_.available() ||
+        departing_levels(ask_bitmap_, new_base) > ask_overflow_.available()) {
+        return false;
+    }
+
+    migrate_side(bid_levels_, bid_bitmap_, bid_overflow_, new_base);
+    migrate_side(ask_levels_, ask_bitmap_, ask_overflow_, new_base);
+    window_base_ = new_base;
+    return true;
+}
+
+size_t OrderBook::departing_levels(const LevelBitmap& bm,
+                                   size_t new_base) const noexcept {
+    size_t count = 0;
+    for (size_t i = ring_next(bm, window_base_); i != INVALID_INDEX;
+         i = ring_next(bm, i + 1)) {
+        if (i - new_base >= window_size_) ++count;
+    }
+    return count;
+}
+
+void OrderBook::migrate_side(PriceLevel* ring, LevelBitmap& bm,
+                             OverflowLevels& ovf, size_t new_base) noexcept {
+    // 1. Park in-window levels that fall outside the new window.
+    for (size_t i = ring_next(bm, window_base_); i != INVALID_INDEX;
+         i = ring_next(bm, i + 1)) {
+        if (i - new_base < window_size_) continue;
+        size_t slot = i & window_mask_;
+        PriceLevel* dst = ovf.find_or_insert(i);  // Capacity checked by caller
+        *dst = ring[slot];
+        std::memset(&ring[slot], 0, sizeof(PriceLevel));
+        bm.clear(slot);
+    }
+
+    // 2. Pull overflow levels that the new window covers into the ring.
+    //    They form one contiguous run of the sorted store.
+    size_t pos = ovf.lower_bound(new_base);
+    while (pos < ovf.size() && ovf.index_at(pos) < new_base + window_size_) {
+        size_t i = ovf.index_at(pos);
+        size_t slot = i & window_mask_;
+        ring[slot] = *ovf.level_at(pos);
+        bm.set(slot);
+        ovf.erase(i);  // Shifts the run down; pos now names the next entry
     }
-    best_ask_idx_ = INVALID_INDEX;
 }
 
 }  // namespace hft
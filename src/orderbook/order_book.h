@@ -7,18 +7,67 @@
 /// cache-friendly, O(1) access to any price level. Two separate arrays
 /// for bid and ask sides. Order lookup by ID via FlatOrderMap.
 ///
+/// Each side keeps a hierarchical occupancy bitmap (LevelBitmap) in step
+/// with its level array, so best-price recovery after a level empties and
+/// depth/liquidity walks jump straight to the next non-empty tick.
+///
+/// Optional windowed mode (OrderBookOptions::window_levels > 0): instead of
+/// one slot per tick in [min_price, max_price], each side keeps a
+/// power-of-two ring of levels covering a window around the touch, plus a
+/// small sorted OverflowLevels store for far-from-touch levels. Memory then
+/// follows active depth rather than the configured range, so the range can
+/// be set wide enough that a trending market never hits the band.
+/// maybe_recenter() slides the window after the touch drifts; the matching
+/// engine calls it once per operation, outside the matching loop, so
+/// PriceLevel pointers held during a match are never moved.
+///
+/// Optional dense level stats (OrderBookOptions::dense_level_stats, flat
+/// mode): per-side total_quantity[] and order_count[] arrays mirror the
+/// PriceLevel fields, so FOK liquidity sums stream 64-tick blocks of
+/// quantities through a SIMD kernel and depth snapshots read two compact
+/// arrays instead of one 40-byte PriceLevel per level.
+///
+/// Resting orders are also threaded onto per-participant intrusive lists
+/// (ParticipantIndex, OrderBookOptions::max_participants), so one
+/// participant's orders can be found without an ID list or a book scan.
+///
 /// Price range and tick size are fixed at construction. All memory is
-/// pre-allocated — zero heap allocation after startup.
+/// pre-allocated — zero heap allocation after startup. OrderBookOptions::memory
+/// picks the page size / NUMA node of the level arrays and order-id map;
+/// memory_usage() reports how much of it was reserved and touched.
 
 #include <cstddef>
 
 #include "core/order.h"
+#include "core/prefetch.h"
 #include "core/price_level.h"
 #include "core/types.h"
+#include "orderbook/backing_memory.h"
+#include "orderbook/book_digest.h"
+#include "orderbook/direct_order_index.h"
 #include "orderbook/flat_order_map.h"
+#include "orderbook/level_bitmap.h"
+#include "orderbook/level_delta_journal.h"
+#include "orderbook/overflow_levels.h"
+#include "orderbook/participant_index.h"
+#include "orderbook/tick_divider.h"
 
 namespace hft {
 
+/// OrderBook::memory_usage(), by component.
+struct BookMemoryUsage {
+    MemoryUsage levels;       // Ladders, dense stats, bitmaps, overflow store
+    MemoryUsage order_index;  // Order-id map and direct-index window
+    MemoryUsage auxiliary;    // Participant lists, level-delta journal
+
+    [[nodiscard]] MemoryUsage total() const noexcept {
+        MemoryUsage sum = levels;
+        sum += order_index;
+        sum += auxiliary;
+        return sum;
+    }
+};
+
 /// Snapshot of a single price level for depth queries.
 struct DepthEntry {
     Price price;
@@ -26,6 +75,15 @@ struct DepthEntry {
     uint32_t order_count;
 };
 
+/// Equilibrium of a crossed book (call-auction uncross). volume == 0 means
+/// the book is not crossed and price is 0.
+struct AuctionQuote {
+    Price price;             // Uncross price (a resting level's price)
+    Quantity volume;         // Quantity executable at `price`
+    Quantity buy_surplus;    // Bid quantity at >= price left unfilled
+    Quantity sell_surplus;   // Ask quantity at <= price left unfilled
+};
+
 struct AddResult {
     bool success;
 };
@@ -40,6 +98,55 @@ struct ModifyResult {
     Order* order;        // Detached order (still pool-allocated)
     Price old_price;     // For event publishing
     Quantity old_quantity;
+    bool in_place;       // Amended on the book: still resting, not detached
+};
+
+/// Construction-time layout options. Defaults give the classic flat ladder
+/// with one PriceLevel per tick across the whole price range.
+struct OrderBookOptions {
+    /// 0 = flat ladder. Otherwise the number of in-window levels per side,
+    /// rounded up to a power of two (windowed mode).
+    size_t window_levels = 0;
+
+    /// Windowed mode: maximum non-empty levels per side held outside the
+    /// window. Adds that would need more are rejected.
+    size_t overflow_levels = 1024;
+
+    /// Flat mode: mirror level quantities and order counts into dense
+    /// per-side arrays for vectorised liquidity and depth scans. Ignored in
+    /// windowed mode.
+    bool dense_level_stats = false;
+
+    /// Page size, NUMA binding and pre-fault for the level arrays and the
+    /// order-id map (see backing_memory.h).
+    MemoryBacking memory;
+
+    /// Probe strategy of the order-id map (find / cancel / modify lookups).
+    OrderMapProbe order_map_probe = OrderMapProbe::Linear;
+
+    /// Let the order-id map double incrementally instead of rejecting adds
+    /// once max_orders is reached (max_orders then only sizes the start).
+    bool order_map_growable = false;
+
+    /// > 0: index order IDs through a sliding window of this many 4096-ID
+    /// pages (DirectOrderIndex) for venues with monotonically assigned IDs;
+    /// the order-id map then only holds out-of-window IDs. 0 = hash only.
+    size_t direct_index_pages = 0;
+
+    /// Distinct participant_ids with a per-participant order list (mass
+    /// cancel). Adds for a participant beyond this are rejected. 0 = no
+    /// lists; participant_head() then always returns nullptr.
+    size_t max_participants = 1024;
+
+    /// Journal level changes for market-by-price deltas (take_level_deltas):
+    /// every change, or one per changed level between takes.
+    LevelDeltaMode level_deltas = LevelDeltaMode::Off;
+
+    /// Level-delta records held between two takes; more are dropped.
+    size_t level_delta_capacity = 4096;
+
+    /// Maintain state_digest() from the first add (see book_digest.h).
+    bool state_digest = false;
 };
 
 class OrderBook {
@@ -48,8 +155,9 @@ public:
     /// @param max_price  Highest supported price (fixed-point).
     /// @param tick_size  Minimum price increment (fixed-point).
     /// @param max_orders Maximum number of live orders (sizes the hash map).
+    /// @param options    Level storage layout (flat by default).
     OrderBook(Price min_price, Price max_price, Price tick_size,
-              size_t max_orders);
+              size_t max_orders, const OrderBookOptions& options = {});
     ~OrderBook();
 
     OrderBook(const OrderBook&) = delete;
@@ -57,16 +165,21 @@ public:
 
     /// Place an order on the book. Does not perform matching (Phase 3).
     /// Returns success=false if price is out of range, not tick-aligned,
-    /// or order ID is duplicate.
+    /// order ID is duplicate, (windowed mode) the order falls outside
+    /// the window and the overflow store is full, or its participant would
+    /// exceed max_participants.
     AddResult add_order(Order* order) noexcept;
 
     /// Cancel an order by ID. Returns the cancelled order pointer so the
     /// caller can return it to the memory pool.
     CancelResult cancel_order(OrderId id) noexcept;
 
-    /// Modify an order's price and/or quantity. Removes the order from its
-    /// current level, mutates fields in-place, and returns the detached order
-    /// for the caller to re-match and re-add. The order loses time priority.
+    /// Modify an order's price and/or quantity. A quantity decrease at the
+    /// same price is amended on the book (in_place = true): the order keeps
+    /// its queue position and timestamp, and the order-id map is untouched.
+    /// Any other change removes the order from its current level, mutates
+    /// fields in-place, and returns the detached order for the caller to
+    /// re-match and re-add; the order loses time priority.
     ModifyResult modify_order(OrderId id, Price new_price,
                               Quantity new_quantity,
                               Timestamp new_timestamp) noexcept;
@@ -75,6 +188,42 @@ public:
     /// Used by the matching engine after fills.
     void remove_order(Order* order) noexcept;
 
+    /// Reduce a resting level's quantity after a partial fill of `order`,
+    /// which rests there (called before its filled_quantity moves). The
+    /// matching engine goes through here rather than writing
+    /// PriceLevel::total_quantity so the dense level-stats arrays and the
+    /// state digest stay in step.
+    void reduce_level_quantity(PriceLevel* level, const Order& order,
+                               Quantity qty) noexcept {
+        const Side side = order.side;
+        level->total_quantity -= qty;
+        if (digest_.enabled()) [[unlikely]] digest_.reduce(order, qty);
+        if (bid_qty_) [[unlikely]] {
+            Quantity* dense = (side == Side::Buy) ? bid_qty_ : ask_qty_;
+            dense[price_to_index(level->price)] = level->total_quantity;
+        }
+        if (level_deltas_.enabled()) [[unlikely]] {
+            level_deltas_.record(side, price_to_index(level->price),
+                                 level->price, level);
+        }
+    }
+
+    /// Move up to `max` journalled level changes, oldest first, into `out`
+    /// and return how many; the rest stay queued. Conflated records carry
+    /// the level's state as of this call. Returns 0 when level deltas are
+    /// off (OrderBookOptions::level_deltas).
+    size_t take_level_deltas(LevelDelta* out, size_t max) noexcept {
+        if (level_deltas_.size() == 0) return 0;
+        return drain_level_deltas(out, max);
+    }
+    [[nodiscard]] size_t pending_level_deltas() const noexcept {
+        return level_deltas_.size();
+    }
+    /// Level changes lost to a full journal.
+    [[nodiscard]] uint64_t dropped_level_deltas() const noexcept {
+        return level_deltas_.dropped();
+    }
+
     /// Best bid level (highest price with buy orders), or nullptr.
     [[nodiscard]] const PriceLevel* best_bid() const noexcept;
 
@@ -94,21 +243,130 @@ public:
     /// Look up an order by ID. Returns nullptr if not found.
     [[nodiscard]] Order* find_order(OrderId id) const noexcept;
 
+    // Batch prefetch hints — never change state, safe for any argument.
+
+    /// Prefetch the order-id index slot for `id`.
+    void prefetch_index(OrderId id) const noexcept {
+        if (direct_index_.enabled()) {
+            direct_index_.prefetch(id);
+        } else {
+            order_map_.prefetch(id);
+        }
+    }
+
+    /// Prefetch a resting order (its index slot must already be cached, or
+    /// this stalls on the lookup).
+    void prefetch_order(OrderId id) const noexcept {
+        if (const Order* order = index_find(id)) prefetch_write(order);
+    }
+
+    /// Prefetch the `side` level head at `price`. Ignored for invalid
+    /// prices and for windowed-mode levels outside the window.
+    void prefetch_level(Side side, Price price) const noexcept {
+        if (price < min_price_ || price > max_price_) return;
+        size_t idx = price_to_index(price);
+        if (window_size_ != 0) {
+            if (!in_window(idx)) return;
+            idx &= window_mask_;
+        }
+        prefetch_write((side == Side::Buy) ? &bid_levels_[idx] : &ask_levels_[idx]);
+    }
+
+    /// Level index of `price` as a MemoryPool locality hint: neighbouring
+    /// ticks give neighbouring values. Meaningless, but harmless, for
+    /// prices outside the range.
+    [[nodiscard]] size_t level_hint(Price price) const noexcept {
+        return price_to_index(price);
+    }
+
     [[nodiscard]] size_t order_count() const noexcept { return order_count_; }
+
+    /// Order-independent hash of the resting orders (id, side, price,
+    /// remaining quantity), kept up to date in O(1) per add, cancel, fill
+    /// and amend once enabled; 0 while disabled. Equal books have equal
+    /// digests however they were built (see book_digest.h).
+    [[nodiscard]] uint64_t state_digest() const noexcept { return digest_.value(); }
+    [[nodiscard]] bool state_digest_enabled() const noexcept { return digest_.enabled(); }
+
+    /// Start maintaining state_digest(), seeded with a walk over the
+    /// resting orders. Cold path: O(orders), e.g. before traffic or when a
+    /// standby starts comparing.
+    void enable_state_digest() noexcept {
+        if (!digest_.enabled()) digest_.enable(compute_state_digest());
+    }
+
+    /// The digest recomputed from scratch by walking every level. Cold
+    /// path; equals state_digest() whenever that is enabled.
+    [[nodiscard]] uint64_t compute_state_digest() const noexcept;
+
     [[nodiscard]] bool empty() const noexcept { return order_count_ == 0; }
 
+    /// Oldest resting order of `participant`; follow participant_next for
+    /// the rest. nullptr if none (or participant lists are disabled).
+    [[nodiscard]] Order* participant_head(ParticipantId participant) const noexcept {
+        return participants_.head(participant);
+    }
+    [[nodiscard]] const ParticipantIndex& participants() const noexcept {
+        return participants_;
+    }
+
     [[nodiscard]] Price min_price() const noexcept { return min_price_; }
     [[nodiscard]] Price max_price() const noexcept { return max_price_; }
     [[nodiscard]] Price tick_size() const noexcept { return tick_size_; }
     [[nodiscard]] size_t num_levels() const noexcept { return num_levels_; }
 
+    /// Bytes reserved / resident per component. A few mincore() calls:
+    /// cold path, e.g. between sessions or from a monitoring pass.
+    [[nodiscard]] BookMemoryUsage memory_usage() const noexcept;
+
+    /// Backing block granted for the level arrays.
+    [[nodiscard]] const BackingRegion& level_backing() const noexcept {
+        return level_region_;
+    }
+
+    /// True if dense per-level quantity/count arrays are maintained.
+    [[nodiscard]] bool dense_level_stats() const noexcept {
+        return bid_qty_ != nullptr;
+    }
+
+    /// Windowed mode: ring size per side (0 in flat mode).
+    [[nodiscard]] size_t window_levels() const noexcept { return window_size_; }
+
+    /// Windowed mode: lowest price covered by the ring.
+    [[nodiscard]] Price window_low() const noexcept {
+        return index_to_price(window_base_);
+    }
+
+    /// Windowed mode: levels the overflow store holds per side (0 when flat).
+    [[nodiscard]] size_t overflow_capacity() const noexcept {
+        return bid_overflow_.capacity();
+    }
+
+    /// Windowed mode: number of non-empty levels held outside the window.
+    [[nodiscard]] size_t overflow_level_count(Side side) const noexcept {
+        return (side == Side::Buy) ? bid_overflow_.size() : ask_overflow_.size();
+    }
+
+    /// Windowed mode: slide the window so it is centred on the touch once
+    /// the touch has drifted out of the window's middle half. Levels that
+    /// leave the window move to the overflow store and vice versa. Skipped
+    /// if the overflow store cannot absorb the departing levels. No-op in
+    /// flat mode. Invalidates PriceLevel pointers. Returns true if moved.
+    bool maybe_recenter() noexcept;
     /// Check if a price is within range and tick-aligned.
     [[nodiscard]] bool is_valid_price(Price price) const noexcept;
 
     /// Total quantity available on `side` at prices that would cross `limit_price`.
-    /// Used by FOK feasibility check. Read-only walk of the flat price array.
+    /// Used by FOK feasibility check. Visits only occupied levels.
     [[nodiscard]] Quantity available_quantity(Side side, Price limit_price) const noexcept;
 
+    /// Call-auction equilibrium of a (possibly crossed) book: one ascending
+    /// cumulative-quantity pass over the occupied levels between best ask
+    /// and best bid. Picks the level price that maximises executable
+    /// volume, then minimises the surplus, then lies closest to
+    /// `reference_price` (0 = take the lowest such price).
+    [[nodiscard]] AuctionQuote compute_uncross(Price reference_price = 0) const noexcept;
+
     /// Fill `out` with up to `max_levels` non-empty bid levels starting from best bid.
     /// Returns number of levels filled. Bids are ordered best (highest) to worst.
     [[nodiscard]] size_t get_bid_depth(DepthEntry* out, size_t max_levels) const noexcept;
@@ -117,27 +375,153 @@ public:
     /// Returns number of levels filled. Asks are ordered best (lowest) to worst.
     [[nodiscard]] size_t get_ask_depth(DepthEntry* out, size_t max_levels) const noexcept;
 
+    /// The next non-empty `side` level away from the touch after `level`
+    /// (nullptr: start at the best level). Returns nullptr past the last.
+    /// Walks levels with their FIFO queues, e.g. for snapshots.
+    [[nodiscard]] const PriceLevel* next_level(Side side,
+                                               const PriceLevel* level) const noexcept;
+
+    /// Rebuild one empty level from `orders` (FIFO order, pool-allocated,
+    /// fields as they were while resting) without add_order(): the queue,
+    /// order-id index and participant lists are linked in one pass and the
+    /// level totals, occupancy and best price are set once. Statuses are
+    /// kept, and no level deltas are journalled. Returns false, leaving the
+    /// book unchanged, if the price is invalid, the level is not empty, an
+    /// ID is a duplicate or a participant does not fit.
+    bool restore_level(Side side, Price price, Order* const* orders,
+                       size_t count) noexcept;
+
+    /// Idle-time upkeep of the order-id index (FlatOrderMap::maintain):
+    /// the allocations, releases and whole-table walks that add and cancel
+    /// leave out. Cold path: call while idle. Returns true if it did work.
+    bool maintain_index() noexcept { return order_map_.maintain(); }
+
+    /// Empty the book for reuse, e.g. by the next session of a batch
+    /// replay: every resting order is unlinked and handed to `release`
+    /// (typically its pool's deallocate), then the order-id index, its
+    /// direct window and the level-delta journal are reset in bulk
+    /// (FlatOrderMap::clear). O(resting orders); the level arrays, index
+    /// and digest stay allocated and faulted in. Returns the orders
+    /// released.
+    template <typename Release>
+    size_t clear(Release&& release) noexcept {
+        size_t released = 0;
+        for (PriceLevel* level = best_bid_level(); level; level = best_bid_level()) {
+            Order* order = level->front();
+            remove_order(order);
+            release(order);
+            ++released;
+        }
+        for (PriceLevel* level = best_ask_level(); level; level = best_ask_level()) {
+            Order* order = level->front();
+            remove_order(order);
+            release(order);
+            ++released;
+        }
+        reset_index();
+        return released;
+    }
+
 private:
     static constexpr size_t INVALID_INDEX = SIZE_MAX;
 
-    [[nodiscard]] size_t price_to_index(Price price) const noexcept;
-    [[nodiscard]] Price index_to_price(size_t index) const noexcept;
+    [[nodiscard]] size_t price_to_index(Price price) const noexcept {
+        return static_cast<size_t>(
+            tick_div_.divide(static_cast<uint64_t>(price - min_price_)));
+    }
+    [[nodiscard]] Price index_to_price(size_t index) const noexcept {
+        return min_price_ + static_cast<Price>(index) * tick_size_;
+    }
+
+    /// Dense level stats: copy a level's totals into the side arrays.
+    void sync_dense(Side side, size_t idx, const PriceLevel* level) noexcept {
+        if (side == Side::Buy) {
+            bid_qty_[idx] = level->total_quantity;
+            bid_cnt_[idx] = level->order_count;
+        } else {
+            ask_qty_[idx] = level->total_quantity;
+            ask_cnt_[idx] = level->order_count;
+        }
+    }
+    [[nodiscard]] Quantity dense_sum_asks(size_t from, size_t to) const noexcept;
+    size_t drain_level_deltas(LevelDelta* out, size_t max) noexcept;
+    [[nodiscard]] Quantity dense_sum_bids(size_t from, size_t to) const noexcept;
+
+    // Order-id index: direct window when enabled, else the hash map.
+    bool index_insert(OrderId id, Order* order) noexcept {
+        return direct_index_.enabled() ? direct_index_.insert(id, order)
+                                       : order_map_.insert(id, order);
+    }
+    bool index_erase(OrderId id) noexcept {
+        return direct_index_.enabled() ? direct_index_.erase(id)
+                                       : order_map_.erase(id);
+    }
+    [[nodiscard]] Order* index_find(OrderId id) const noexcept {
+        return direct_index_.enabled() ? direct_index_.find(id)
+                                       : order_map_.find(id);
+    }
+    /// clear(): the book is empty; drop tombstones, the direct window and
+    /// the deltas its removals journalled.
+    void reset_index() noexcept;
+
+    // Level storage — in flat mode index == slot; in windowed mode in-window
+    // indices map to ring slot (index & window_mask_), the rest to overflow.
+    [[nodiscard]] bool in_window(size_t idx) const noexcept {
+        return idx - window_base_ < window_size_;
+    }
+    [[nodiscard]] PriceLevel* level_at(Side side, size_t idx) const noexcept;
+    [[nodiscard]] PriceLevel* level_for_insert(Side side, size_t idx) noexcept;
+    void occupy_level(Side side, size_t idx) noexcept;
+    void release_level(Side side, size_t idx) noexcept;
+
+    /// Lowest non-empty index >= from / highest non-empty index <= from,
+    /// or INVALID_INDEX.
+    [[nodiscard]] size_t next_occupied(Side side, size_t from) const noexcept;
+    [[nodiscard]] size_t prev_occupied(Side side, size_t from) const noexcept;
+    [[nodiscard]] size_t ring_next(const LevelBitmap& bm, size_t from) const noexcept;
+    [[nodiscard]] size_t ring_prev(const LevelBitmap& bm, size_t from) const noexcept;
 
     void update_best_bid_after_remove(size_t emptied_idx) noexcept;
     void update_best_ask_after_remove(size_t emptied_idx) noexcept;
 
-    PriceLevel* bid_levels_;
+    /// Windowed mode: move one side's levels to match a new window base.
+    void migrate_side(PriceLevel* ring, LevelBitmap& bm, OverflowLevels& ovf,
+                      size_t new_base) noexcept;
+    [[nodiscard]] size_t departing_levels(const LevelBitmap& bm,
+                                          size_t new_base) const noexcept;
+
+    BackingRegion level_region_;  // Owns both ladders and the dense arrays
+    PriceLevel* bid_levels_;  // Flat: one per tick. Windowed: ring slots.
     PriceLevel* ask_levels_;
-    size_t num_levels_;
+    size_t num_levels_;       // Logical ticks in [min_price, max_price]
+
+    size_t window_size_;      // 0 in flat mode
+    size_t window_mask_;
+    size_t window_base_;      // Lowest in-window index (windowed mode)
+
+    LevelBitmap bid_bitmap_;  // Bit per slot, set iff the level is non-empty
+    LevelBitmap ask_bitmap_;
+    OverflowLevels bid_overflow_;  // Windowed mode only
+    OverflowLevels ask_overflow_;
+
+    Quantity* bid_qty_;       // Dense level stats (nullptr unless enabled)
+    Quantity* ask_qty_;
+    uint32_t* bid_cnt_;
+    uint32_t* ask_cnt_;
 
     Price min_price_;
     Price max_price_;
     Price tick_size_;
+    TickDivider tick_div_;    // price offset / tick_size_ without a divide
 
     size_t best_bid_idx_;
     size_t best_ask_idx_;
 
     FlatOrderMap order_map_;
+    DirectOrderIndex direct_index_;  // Falls back to order_map_
+    ParticipantIndex participants_;
+    LevelDeltaJournal level_deltas_;
+    BookDigest digest_;
     size_t order_count_;
 };
 
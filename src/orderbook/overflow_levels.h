@@ -0,0 +1,164 @@
+#pragma once
+
+/// @file overflow_levels.h
+/// @brief Small sorted store for price levels outside the windowed ladder.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Used by OrderBook's windowed mode to hold the rare non-empty levels that
+/// fall outside the ring of in-window levels. Keeps a sorted array of
+/// {level index, slot} entries (binary search, memmove insert/erase) over a
+/// fixed pool of PriceLevel slots. Slots never move while occupied, so a
+/// PriceLevel* stays valid for as long as its level is non-empty — the
+/// matching loop relies on this.
+///
+/// Invariant maintained by OrderBook: an entry exists iff its level is
+/// non-empty.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/price_level.h"
+#include "orderbook/backing_memory.h"
+
+namespace hft {
+
+class OverflowLevels {
+public:
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    /// Pre-allocate room for `capacity` non-empty levels (0 = disabled).
+    explicit OverflowLevels(size_t capacity)
+        : entries_(nullptr), levels_(nullptr), free_slots_(nullptr),
+          capacity_(capacity), size_(0) {
+        if (capacity_ == 0) return;
+
+        entries_ = static_cast<Entry*>(std::calloc(capacity_, sizeof(Entry)));
+        levels_ = static_cast<PriceLevel*>(
+            std::calloc(capacity_, sizeof(PriceLevel)));
+        free_slots_ = static_cast<uint32_t*>(
+            std::calloc(capacity_, sizeof(uint32_t)));
+        if (!entries_ || !levels_ || !free_slots_) {
+            std::abort();
+        }
+
+        // Free stack, top at the end: slot 0 is handed out first.
+        for (size_t i = 0; i < capacity_; ++i) {
+            free_slots_[i] = static_cast<uint32_t>(capacity_ - 1 - i);
+        }
+    }
+
+    ~OverflowLevels() {
+        std::free(entries_);
+        std::free(levels_);
+        std::free(free_slots_);
+    }
+
+    OverflowLevels(const OverflowLevels&) = delete;
+    OverflowLevels& operator=(const OverflowLevels&) = delete;
+    OverflowLevels(OverflowLevels&&) = delete;
+    OverflowLevels& operator=(OverflowLevels&&) = delete;
+
+    /// Level stored for `index`, or nullptr.
+    [[nodiscard]] PriceLevel* find(size_t index) const noexcept {
+        size_t pos = lower_bound(index);
+        if (pos < size_ && entries_[pos].index == index) {
+            return &levels_[entries_[pos].slot];
+        }
+        return nullptr;
+    }
+
+    /// Level stored for `index`, creating an empty one if absent.
+    /// Returns nullptr if the store is full.
+    [[nodiscard]] PriceLevel* find_or_insert(size_t index) noexcept {
+        size_t pos = lower_bound(index);
+        if (pos < size_ && entries_[pos].index == index) {
+            return &levels_[entries_[pos].slot];
+        }
+        if (size_ == capacity_) [[unlikely]] {
+            return nullptr;
+        }
+
+        uint32_t slot = free_slots_[capacity_ - 1 - size_];
+        std::memmove(&entries_[pos + 1], &entries_[pos],
+                     (size_ - pos) * sizeof(Entry));
+        entries_[pos].index = index;
+        entries_[pos].slot = slot;
+        ++size_;
+        return &levels_[slot];
+    }
+
+    /// Drop the entry for `index` and reset its slot to an empty level.
+    void erase(size_t index) noexcept {
+        size_t pos = lower_bound(index);
+        if (pos >= size_ || entries_[pos].index != index) return;
+
+        uint32_t slot = entries_[pos].slot;
+        std::memset(&levels_[slot], 0, sizeof(PriceLevel));
+        std::memmove(&entries_[pos], &entries_[pos + 1],
+                     (size_ - pos - 1) * sizeof(Entry));
+        --size_;
+        free_slots_[capacity_ - 1 - size_] = slot;
+    }
+
+    /// Lowest stored index >= `from`, or NPOS.
+    [[nodiscard]] size_t find_next(size_t from) const noexcept {
+        size_t pos = lower_bound(from);
+        return (pos < size_) ? entries_[pos].index : NPOS;
+    }
+
+    /// Highest stored index <= `from`, or NPOS.
+    [[nodiscard]] size_t find_prev(size_t from) const noexcept {
+        size_t pos = (from == NPOS) ? size_ : lower_bound(from + 1);
+        return (pos > 0) ? entries_[pos - 1].index : NPOS;
+    }
+
+    /// Position-based access for bulk migration (sorted by index).
+    [[nodiscard]] size_t index_at(size_t pos) const noexcept {
+        return entries_[pos].index;
+    }
+    [[nodiscard]] PriceLevel* level_at(size_t pos) const noexcept {
+        return &levels_[entries_[pos].slot];
+    }
+
+    /// Position of the first entry with index >= `index`.
+    [[nodiscard]] size_t lower_bound(size_t index) const noexcept {
+        size_t lo = 0;
+        size_t hi = size_;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (entries_[mid].index < index) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] size_t available() const noexcept { return capacity_ - size_; }
+
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        MemoryUsage usage = heap_usage(entries_, capacity_ * sizeof(Entry));
+        usage += heap_usage(levels_, capacity_ * sizeof(PriceLevel));
+        usage += heap_usage(free_slots_, capacity_ * sizeof(uint32_t));
+        return usage;
+    }
+
+private:
+    struct Entry {
+        size_t index;   // Absolute level index (tick offset from min_price)
+        uint32_t slot;  // Position in levels_
+    };
+
+    Entry* entries_;         // Sorted ascending by index
+    PriceLevel* levels_;     // Slot storage — never moves
+    uint32_t* free_slots_;   // Stack of free slot numbers
+    size_t capacity_;
+    size_t size_;
+};
+
+}  // namespace hft
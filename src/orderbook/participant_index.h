@@ -0,0 +1,152 @@
+#pragma once
+
+/// @file participant_index.h
+/// @brief Per-participant intrusive lists over the resting orders of a book.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Every resting order is also linked, through Order::participant_next /
+/// participant_prev, into the list of its participant_id, so a mass cancel
+/// (kill switch, disconnect) walks exactly that participant's orders
+/// instead of tracking IDs or scanning the book. List heads live in a
+/// small fixed open-addressing table keyed by ParticipantId; entries are
+/// never removed (participants are few and long-lived), and each linked
+/// order caches its entry's slot in Order::participant_slot so unlinking
+/// needs no lookup.
+///
+/// Capacity 0 disables tracking: link() then always succeeds and lists
+/// stay empty.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "core/order.h"
+#include "core/types.h"
+#include "orderbook/backing_memory.h"
+
+namespace hft {
+
+class ParticipantIndex {
+public:
+    /// @param max_participants Distinct participants trackable (0 = off).
+    explicit ParticipantIndex(size_t max_participants)
+        : entries_(nullptr), mask_(0), size_(0), limit_(max_participants) {
+        if (limit_ == 0) return;
+        size_t cap = 16;
+        while (cap < limit_ * 2) cap <<= 1;  // Load factor <= 0.5
+        entries_ = static_cast<Entry*>(std::calloc(cap, sizeof(Entry)));
+        if (!entries_) {
+            std::abort();
+        }
+        mask_ = cap - 1;
+    }
+
+    ~ParticipantIndex() { std::free(entries_); }
+
+    ParticipantIndex(const ParticipantIndex&) = delete;
+    ParticipantIndex& operator=(const ParticipantIndex&) = delete;
+
+    [[nodiscard]] bool enabled() const noexcept { return entries_ != nullptr; }
+
+    /// Append `order` to its participant's list. Returns false only when
+    /// a new participant would exceed max_participants.
+    [[nodiscard]] bool link(Order* order) noexcept {
+        if (!entries_) return true;
+        Entry* e = find_or_insert(order->participant_id);
+        if (!e) [[unlikely]] return false;
+
+        order->participant_slot = static_cast<uint32_t>(e - entries_);
+        order->participant_next = nullptr;
+        order->participant_prev = e->tail;
+        if (e->tail) {
+            e->tail->participant_next = order;
+        } else {
+            e->head = order;
+        }
+        e->tail = order;
+        ++e->count;
+        return true;
+    }
+
+    /// Remove a linked `order` from its participant's list. O(1).
+    void unlink(Order* order) noexcept {
+        if (!entries_) return;
+        Entry& e = entries_[order->participant_slot];
+        if (order->participant_prev) {
+            order->participant_prev->participant_next = order->participant_next;
+        } else {
+            e.head = order->participant_next;
+        }
+        if (order->participant_next) {
+            order->participant_next->participant_prev = order->participant_prev;
+        } else {
+            e.tail = order->participant_prev;
+        }
+        order->participant_next = nullptr;
+        order->participant_prev = nullptr;
+        --e.count;
+    }
+
+    /// Oldest linked order of `participant`, or nullptr.
+    [[nodiscard]] Order* head(ParticipantId participant) const noexcept {
+        const Entry* e = find(participant);
+        return e ? e->head : nullptr;
+    }
+
+    /// Linked orders of `participant`.
+    [[nodiscard]] uint32_t count(ParticipantId participant) const noexcept {
+        const Entry* e = find(participant);
+        return e ? e->count : 0;
+    }
+
+    /// Distinct participants seen.
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept {
+        return heap_usage(entries_, entries_ ? (mask_ + 1) * sizeof(Entry) : 0);
+    }
+
+private:
+    struct Entry {
+        Order* head;
+        Order* tail;
+        ParticipantId id;
+        uint32_t count;
+        bool used;
+    };
+
+    static size_t hash(ParticipantId id) noexcept {
+        return static_cast<size_t>(id) * 0x9E3779B97F4A7C15ULL >> 32;
+    }
+
+    [[nodiscard]] const Entry* find(ParticipantId id) const noexcept {
+        if (!entries_) return nullptr;
+        for (size_t i = hash(id) & mask_;; i = (i + 1) & mask_) {
+            const Entry& e = entries_[i];
+            if (!e.used) return nullptr;
+            if (e.id == id) return &e;
+        }
+    }
+
+    [[nodiscard]] Entry* find_or_insert(ParticipantId id) noexcept {
+        for (size_t i = hash(id) & mask_;; i = (i + 1) & mask_) {
+            Entry& e = entries_[i];
+            if (e.used) {
+                if (e.id == id) return &e;
+                continue;
+            }
+            if (size_ == limit_) return nullptr;
+            e.used = true;
+            e.id = id;
+            ++size_;
+            return &e;
+        }
+    }
+
+    Entry* entries_;
+    size_t mask_;
+    size_t size_;
+    size_t limit_;
+};
+
+}  // namespace hft
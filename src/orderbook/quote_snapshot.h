@@ -0,0 +1,123 @@
+#pragma once
+
+/// @file quote_snapshot.h
+/// @brief Seqlock-published BBO and top-N depth of one book, readable from
+///        any thread.
+///
+/// Zero heap allocation. OrderBook is single-threaded: best_bid() and
+/// get_bid_depth() are only safe on the matching thread, and readers there
+/// share its cache lines. A QuoteSnapshotSlot decouples them: the matching
+/// thread calls publish() after each call or batch (OrderGateway does this
+/// when given a slot), which walks the top QUOTE_SNAPSHOT_DEPTH levels per
+/// side into a private staging copy and, only if it differs from the last
+/// published state, copies it into the shared snapshot under a seqlock.
+/// Readers on other cores copy the shared snapshot with read(), never
+/// touching the book or the writer's staging lines; a read retries only if
+/// it overlapped a publish.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "core/types.h"
+#include "orderbook/order_book.h"
+
+namespace hft {
+
+/// Levels per side a QuoteSnapshot holds.
+constexpr size_t QUOTE_SNAPSHOT_DEPTH = 10;
+
+/// Top of one book as of a publish (levels best first).
+struct QuoteSnapshot {
+    uint64_t publish_count;     // Publishes that changed the state (0 = none)
+    Price last_trade_price;     // 0 = no trade yet
+    uint32_t bid_levels;        // Valid entries in bids / asks
+    uint32_t ask_levels;
+    DepthEntry bids[QUOTE_SNAPSHOT_DEPTH];
+    DepthEntry asks[QUOTE_SNAPSHOT_DEPTH];
+
+    [[nodiscard]] bool has_bid() const noexcept { return bid_levels != 0; }
+    [[nodiscard]] bool has_ask() const noexcept { return ask_levels != 0; }
+    /// Mid price, or 0 if either side is empty (as OrderBook::mid_price).
+    [[nodiscard]] Price mid_price() const noexcept {
+        return (has_bid() && has_ask()) ? (bids[0].price + asks[0].price) / 2 : 0;
+    }
+};
+
+class QuoteSnapshotSlot {
+public:
+    QuoteSnapshotSlot() noexcept { std::memset(&staging_, 0, sizeof(staging_)); }
+
+    QuoteSnapshotSlot(const QuoteSnapshotSlot&) = delete;
+    QuoteSnapshotSlot& operator=(const QuoteSnapshotSlot&) = delete;
+
+    /// Writer (the book's thread): capture `book` and publish it if it
+    /// changed. Returns true if readers see a new state.
+    bool publish(const OrderBook& book, Price last_trade_price) noexcept {
+        DepthEntry bids[QUOTE_SNAPSHOT_DEPTH];
+        DepthEntry asks[QUOTE_SNAPSHOT_DEPTH];
+        const auto bid_levels = static_cast<uint32_t>(book.get_bid_depth(bids, QUOTE_SNAPSHOT_DEPTH));
+        const auto ask_levels = static_cast<uint32_t>(book.get_ask_depth(asks, QUOTE_SNAPSHOT_DEPTH));
+        if (staging_.publish_count != 0 && bid_levels == staging_.bid_levels &&
+            ask_levels == staging_.ask_levels &&
+            last_trade_price == staging_.last_trade_price &&
+            same_levels(bids, staging_.bids, bid_levels) &&
+            same_levels(asks, staging_.asks, ask_levels)) {
+            return false;
+        }
+
+        ++staging_.publish_count;
+        staging_.last_trade_price = last_trade_price;
+        staging_.bid_levels = bid_levels;
+        staging_.ask_levels = ask_levels;
+        std::memcpy(staging_.bids, bids, sizeof(DepthEntry) * bid_levels);
+        std::memcpy(staging_.asks, asks, sizeof(DepthEntry) * ask_levels);
+
+        // Seqlock: odd while the copy is in progress
+        const uint64_t v = version_.load(std::memory_order_relaxed);
+        version_.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&shared_, &staging_, sizeof(QuoteSnapshot));
+        version_.store(v + 2, std::memory_order_release);
+        return true;
+    }
+
+    /// Reader (any thread): copy the latest state. Returns false if nothing
+    /// was published yet.
+    bool read(QuoteSnapshot& out) const noexcept {
+        for (;;) {
+            const uint64_t before = version_.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1) continue;           // Writer mid-copy
+            std::memcpy(&out, &shared_, sizeof(QuoteSnapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version_.load(std::memory_order_relaxed) == before) return true;
+        }
+    }
+
+    /// Even, and bumped by 2 on every publish that changed the state
+    /// (0 = none yet). Poll this to skip unchanged copies.
+    [[nodiscard]] uint64_t version() const noexcept {
+        return version_.load(std::memory_order_acquire);
+    }
+
+private:
+    static bool same_levels(const DepthEntry* a, const DepthEntry* b, uint32_t n) noexcept {
+        for (uint32_t i = 0; i < n; ++i) {
+            if (a[i].price != b[i].price || a[i].quantity != b[i].quantity ||
+                a[i].order_count != b[i].order_count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Shared with readers
+    alignas(64) std::atomic<uint64_t> version_{0};
+    QuoteSnapshot shared_{};
+    // Writer only, on its own lines
+    alignas(64) QuoteSnapshot staging_;
+};
+
+}  // namespace hft
@@ -0,0 +1,229 @@
+#include "orderbook/stop_book.h"
+
+namespace hft {
+
+namespace {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+}  // namespace
+
+
+StopBook::StopBook(const OrderBook& book, size_t max_orders,
+                   const MemoryBacking& backing)
+    : buy_levels_(nullptr),
+      sell_levels_(nullptr),
+      num_levels_(static_cast<size_t>((book.max_price() - book.min_price()) /
+                                      book.tick_size()) + 1),
+      buy_bitmap_(book.window_levels() ? 0 : num_levels_),
+      sell_bitmap_(book.window_levels() ? 0 : num_levels_),
+      buy_sparse_(book.window_levels()
+                      ? book.window_levels() + book.overflow_capacity()
+                      : 0),
+      sell_sparse_(book.window_levels()
+                       ? book.window_levels() + book.overflow_capacity()
+                       : 0),
+      elected_{},
+      min_price_(book.min_price()),
+      max_price_(book.max_price()),
+      tick_size_(book.tick_size()),
+      tick_div_(tick_size_, max_price_ - min_price_ + tick_size_),
+      order_map_(max_orders, backing) {
+    if (sparse()) return;
+
+    // Zero-filled levels are valid empty PriceLevels; untouched pages of
+    // the ladder are never faulted in.
+    size_t ladder_bytes = (num_levels_ * sizeof(PriceLevel) + CACHE_LINE_SIZE -
+                           1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    ladder_region_ = allocate_backing(2 * ladder_bytes, CACHE_LINE_SIZE,
+                                      backing);
+    char* p = static_cast<char*>(ladder_region_.data);
+    buy_levels_ = reinterpret_cast<PriceLevel*>(p);
+    sell_levels_ = reinterpret_cast<PriceLevel*>(p + ladder_bytes);
+}
+
+StopBook::~StopBook() { release_backing(ladder_region_); }
+
+MemoryUsage StopBook::memory_usage() const noexcept {
+    MemoryUsage usage = backing_usage(ladder_region_);
+    usage += buy_bitmap_.memory_usage();
+    usage += sell_bitmap_.memory_usage();
+    usage += buy_sparse_.memory_usage();
+    usage += sell_sparse_.memory_usage();
+    usage += order_map_.memory_usage();
+    return usage;
+}
+
+bool StopBook::is_valid_trigger(Price price) const noexcept {
+    if (price < min_price_ || price > max_price_) return false;
+    uint64_t offset = static_cast<uint64_t>(price - min_price_);
+    return tick_div_.divide(offset) * static_cast<uint64_t>(tick_size_) ==
+           offset;
+}
+
+// ---------------------------------------------------------------------------
+// Resting stops
+// ---------------------------------------------------------------------------
+
+bool StopBook::add(Order* order) noexcept {
+    if (!is_valid_trigger(order->stop_price)) [[unlikely]] {
+        return false;
+    }
+    if (!order_map_.insert(order->order_id, order)) [[unlikely]] {
+        return false;  // Duplicate ID or ID == 0
+    }
+
+    size_t idx = price_to_index(order->stop_price);
+    bool buy = (order->side == Side::Buy);
+    PriceLevel* level;
+    if (sparse()) {
+        level = (buy ? buy_sparse_ : sell_sparse_).find_or_insert(idx);
+        if (!level) [[unlikely]] {
+            order_map_.erase(order->order_id);  // Level store full
+            return false;
+        }
+    } else {
+        level = &(buy ? buy_levels_ : sell_levels_)[idx];
+        if (level->empty()) (buy ? buy_bitmap_ : sell_bitmap_).set(idx);
+    }
+    if (level->empty()) level->price = order->stop_price;
+    level->add_order(order);
+    return true;
+}
+
+bool StopBook::add_elected(Order* order) noexcept {
+    if (!is_valid_trigger(order->stop_price)) [[unlikely]] {
+        return false;
+    }
+    if (!order_map_.insert(order->order_id, order)) [[unlikely]] {
+        return false;
+    }
+    convert(order);
+    elected_.add_order(order);
+    return true;
+}
+
+Order* StopBook::cancel(OrderId id) noexcept {
+    Order* order = order_map_.find(id);
+    if (!order) return nullptr;
+
+    if (is_stop(order->type)) {
+        // Still waiting on the ladder
+        size_t idx = price_to_index(order->stop_price);
+        bool buy = (order->side == Side::Buy);
+        PriceLevel* level = level_at(buy, idx);
+        level->remove_order(order);
+        if (level->empty()) release_level(buy, idx);
+    } else {
+        // Elected (already converted), not yet released
+        elected_.remove_order(order);
+    }
+    order_map_.erase(id);
+    return order;
+}
+
+// ---------------------------------------------------------------------------
+// Election
+// ---------------------------------------------------------------------------
+
+size_t StopBook::elect(Price low, Price high) noexcept {
+    const uint32_t before = elected_.order_count;
+
+    // Buy stops: every occupied level at or below `high`, lowest first
+    if (high >= min_price_) {
+        size_t last = (high > max_price_) ? num_levels_ - 1
+                                          : price_to_index(high);
+        for (size_t idx = next_level(true, 0);
+             idx != LevelBitmap::NPOS && idx <= last;
+             idx = next_level(true, idx + 1)) {
+            elect_level(true, idx);
+        }
+    }
+
+    // Sell stops: every occupied level at or above `low`, highest first
+    if (low <= max_price_) {
+        size_t first = (low < min_price_) ? 0 : price_to_index(low);
+        for (size_t idx = prev_level(false, LevelBitmap::NPOS);
+             idx != LevelBitmap::NPOS && idx >= first;
+             idx = (idx == 0) ? LevelBitmap::NPOS
+                              : prev_level(false, idx - 1)) {
+            elect_level(false, idx);
+        }
+    }
+
+    return elected_.order_count - before;
+}
+
+void StopBook::elect_level(bool buy, size_t idx) noexcept {
+    PriceLevel* level = level_at(buy, idx);
+    for (Order* o = level->head; o; o = o->next) {
+        convert(o);
+    }
+
+    // Splice the whole FIFO onto the elected tail
+    if (elected_.tail) {
+        elected_.tail->next = level->head;
+        level->head->prev = elected_.tail;
+    } else {
+        elected_.head = level->head;
+    }
+    elected_.tail = level->tail;
+    elected_.total_quantity += level->total_quantity;
+    elected_.order_count += level->order_count;
+
+    level->head = nullptr;
+    level->tail = nullptr;
+    level->total_quantity = 0;
+    level->order_count = 0;
+    release_level(buy, idx);
+}
+
+void StopBook::release_level(bool buy, size_t idx) noexcept {
+    if (sparse()) {
+        (buy ? buy_sparse_ : sell_sparse_).erase(idx);
+    } else {
+        (buy ? buy_bitmap_ : sell_bitmap_).clear(idx);
+    }
+}
+
+// OverflowLevels::NPOS and LevelBitmap::NPOS are both SIZE_MAX.
+size_t StopBook::next_level(bool buy, size_t from) const noexcept {
+    if (sparse()) return (buy ? buy_sparse_ : sell_sparse_).find_next(from);
+    return (buy ? buy_bitmap_ : sell_bitmap_).find_next(from);
+}
+
+size_t StopBook::prev_level(bool buy, size_t from) const noexcept {
+    if (sparse()) return (buy ? buy_sparse_ : sell_sparse_).find_prev(from);
+    return (buy ? buy_bitmap_ : sell_bitmap_).find_prev(from);
+}
+
+Order* StopBook::pop_elected() noexcept {
+    Order* order = elected_.front();
+    if (!order) return nullptr;
+    elected_.remove_order(order);
+    order_map_.erase(order->order_id);
+    return order;
+}
+
+void StopBook::convert(Order* order) noexcept {
+    order->type = (order->type == OrderType::Stop) ? OrderType::Market
+                                                   : OrderType::Limit;
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+
+Price StopBook::lowest_buy_stop() const noexcept {
+    size_t idx = next_level(true, 0);
+    if (idx == LevelBitmap::NPOS) return 0;
+    return min_price_ + static_cast<Price>(idx) * tick_size_;
+}
+
+Price StopBook::highest_sell_stop() const noexcept {
+    size_t idx = prev_level(false, LevelBitmap::NPOS);
+    if (idx == LevelBitmap::NPOS) return 0;
+    return min_price_ + static_cast<Price>(idx) * tick_size_;
+}
+
+}  // namespace hft
@@ -0,0 +1,141 @@
+#pragma once
+
+/// @file stop_book.h
+/// @brief Trigger ladder for resting Stop / StopLimit orders.
+///
+/// Hot-path component — zero heap allocation after construction.
+/// Stops wait on a per-side ladder indexed exactly like the OrderBook they
+/// belong to (one PriceLevel per tick, keyed by stop_price), with a
+/// LevelBitmap per side for occupancy. The ladders come from
+/// allocate_backing() with the instrument's MemoryBacking. When the book
+/// runs in windowed mode the full-range ladders are skipped: each side
+/// keeps its non-empty levels in an OverflowLevels store sized like the
+/// book's window plus overflow store instead. Buy stops trigger once a trade
+/// prints at or above their stop price, sell stops at or below. After a
+/// batch of trades spanning [low, high], elect() walks only the occupied
+/// levels that were crossed — the lowest buy levels up to `high`, the
+/// highest sell levels down to `low` — so its cost is O(triggered), not
+/// O(outstanding stops).
+///
+/// Elected orders are converted in place (Stop -> Market, StopLimit ->
+/// Limit) and queued FIFO on an elected list: buy levels in ascending
+/// stop price, then sell levels in descending stop price, time priority
+/// within a level. The matching engine drains that list through
+/// submit_order, so re-injection order is deterministic.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/order.h"
+#include "core/price_level.h"
+#include "core/types.h"
+#include "orderbook/flat_order_map.h"
+#include "orderbook/level_bitmap.h"
+#include "orderbook/order_book.h"
+#include "orderbook/overflow_levels.h"
+#include "orderbook/tick_divider.h"
+
+namespace hft {
+
+class StopBook {
+public:
+    /// Mirror `book`'s price range, tick size and level layout (flat or
+    /// windowed).
+    /// @param max_orders Maximum number of live stops (sizes the id map).
+    /// @param backing    Page policy for the ladders and the id map.
+    StopBook(const OrderBook& book, size_t max_orders,
+             const MemoryBacking& backing = {});
+    ~StopBook();
+
+    StopBook(const StopBook&) = delete;
+    StopBook& operator=(const StopBook&) = delete;
+
+    /// Rest a Stop/StopLimit order at its stop_price. Returns false if the
+    /// stop price is out of range or not tick-aligned, the ID is a
+    /// duplicate, or (windowed mode) the side's level store is full.
+    [[nodiscard]] bool add(Order* order) noexcept;
+
+    /// Queue a Stop/StopLimit order as elected straight away (its trigger
+    /// already traded through). Fails like add().
+    [[nodiscard]] bool add_elected(Order* order) noexcept;
+
+    /// Remove a resting or elected-but-unreleased stop. Returns the order
+    /// (caller returns it to the pool), or nullptr if unknown.
+    [[nodiscard]] Order* cancel(OrderId id) noexcept;
+
+    /// Elect every stop triggered by trades printed across [low, high].
+    /// Returns the number of orders elected.
+    size_t elect(Price low, Price high) noexcept;
+
+    /// Next elected order in release order, or nullptr. The order leaves
+    /// the stop book.
+    [[nodiscard]] Order* pop_elected() noexcept;
+
+    [[nodiscard]] Order* find(OrderId id) const noexcept {
+        return order_map_.find(id);
+    }
+    [[nodiscard]] bool is_valid_trigger(Price price) const noexcept;
+
+    /// Lowest buy / highest sell stop price, or 0 when that side is empty.
+    [[nodiscard]] Price lowest_buy_stop() const noexcept;
+    [[nodiscard]] Price highest_sell_stop() const noexcept;
+
+    /// Stops resting on the ladder plus elected ones awaiting release.
+    [[nodiscard]] size_t size() const noexcept { return order_map_.size(); }
+    [[nodiscard]] size_t elected_count() const noexcept {
+        return elected_.order_count;
+    }
+
+    /// True for Stop / StopLimit.
+    [[nodiscard]] static bool is_stop(OrderType type) noexcept {
+        return type == OrderType::Stop || type == OrderType::StopLimit;
+    }
+
+    /// True if levels live in per-side sparse stores (windowed book).
+    [[nodiscard]] bool sparse() const noexcept { return buy_sparse_.capacity() > 0; }
+
+    /// Stop ladders or level stores, bitmaps and order-id map. Cold path.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept;
+
+private:
+    [[nodiscard]] size_t price_to_index(Price price) const noexcept {
+        return static_cast<size_t>(
+            tick_div_.divide(static_cast<uint64_t>(price - min_price_)));
+    }
+
+    /// Existing level for `idx` on one side, or nullptr (sparse mode only).
+    [[nodiscard]] PriceLevel* level_at(bool buy, size_t idx) const noexcept {
+        if (sparse()) return (buy ? buy_sparse_ : sell_sparse_).find(idx);
+        return &(buy ? buy_levels_ : sell_levels_)[idx];
+    }
+
+    /// Mark `idx` empty: clear its bitmap bit or drop its sparse entry.
+    void release_level(bool buy, size_t idx) noexcept;
+
+    /// Next occupied level index on one side (see LevelBitmap).
+    [[nodiscard]] size_t next_level(bool buy, size_t from) const noexcept;
+    [[nodiscard]] size_t prev_level(bool buy, size_t from) const noexcept;
+
+    /// Convert and splice one triggered level onto the elected list.
+    void elect_level(bool buy, size_t idx) noexcept;
+
+    /// Turn an elected stop into the order it releases as.
+    static void convert(Order* order) noexcept;
+
+    BackingRegion ladder_region_;  // Owns both ladders (flat mode only)
+    PriceLevel* buy_levels_;   // Indexed by stop-price tick offset
+    PriceLevel* sell_levels_;
+    size_t num_levels_;
+    LevelBitmap buy_bitmap_;   // Flat mode only
+    LevelBitmap sell_bitmap_;
+    OverflowLevels buy_sparse_;   // Windowed mode only
+    OverflowLevels sell_sparse_;
+    PriceLevel elected_;       // Release queue (FIFO)
+    Price min_price_;
+    Price max_price_;
+    Price tick_size_;
+    TickDivider tick_div_;
+    FlatOrderMap order_map_;   // Resting and elected stops
+};
+
+}  // namespace hft
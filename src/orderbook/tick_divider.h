@@ -0,0 +1,71 @@
+#pragma once
+
+/// @file tick_divider.h
+/// @brief Exact division by a construction-time tick size without a divide
+///        instruction.
+///
+/// Hot-path component. OrderBook converts prices to level indices on every
+/// add, cancel and depth call; a 64-bit `div` costs 25-40 cycles there.
+/// The tick size is fixed per book, so it is turned into a reciprocal once
+/// (Granlund-Montgomery): for every 0 <= n < 2^N,
+///
+///     n / d == (n * M) >> S,   S = N + ceil(log2 d),  M = ceil(2^S / d)
+///
+/// which is one 64x64->128 multiply and one shift. Power-of-two ticks reduce
+/// to the same multiply with M a power of two. N is chosen from the largest
+/// offset the book will divide, so M always fits in 64 bits. Builds without
+/// a 128-bit integer type fall back to the plain division.
+
+#include <cstdint>
+
+#include "core/uint128.h"
+
+namespace hft {
+
+class TickDivider {
+public:
+    /// @param divisor    Tick size (> 0).
+    /// @param max_offset Largest numerator that will be divided
+    ///                   (0 <= max_offset < 2^62).
+    TickDivider(int64_t divisor, int64_t max_offset) noexcept
+        : divisor_(static_cast<uint64_t>(divisor)), multiplier_(0), shift_(0) {
+#if defined(HFT_HAS_UINT128)
+        unsigned n_bits = bit_width(static_cast<uint64_t>(max_offset));
+        unsigned l_bits = bit_width(divisor_ - 1);  // ceil(log2 d)
+        shift_ = n_bits + l_bits;
+        // M = ceil(2^S / d) < 2^(N+1) — fits because N + 1 <= 64.
+        uint128 pow = static_cast<uint128>(1) << shift_;
+        multiplier_ = static_cast<uint64_t>((pow + divisor_ - 1) / divisor_);
+#else
+        (void)max_offset;
+#endif
+    }
+
+    /// floor(n / divisor) for 0 <= n <= max_offset.
+    [[nodiscard]] uint64_t divide(uint64_t n) const noexcept {
+#if defined(HFT_HAS_UINT128)
+        return static_cast<uint64_t>(
+            (static_cast<uint128>(n) * multiplier_) >> shift_);
+#else
+        return n / divisor_;
+#endif
+    }
+
+    [[nodiscard]] uint64_t divisor() const noexcept { return divisor_; }
+
+private:
+    static unsigned bit_width(uint64_t v) noexcept {
+        unsigned bits = 0;
+        while (v) {
+            ++bits;
+            v >>= 1;
+        }
+        return bits;
+    }
+
+    uint64_t divisor_;
+    uint64_t multiplier_;
+    unsigned shift_;
+};
+
+}  // namespace hft
@@ -0,0 +1,297 @@
+#pragma once
+
+/// @file broadcast_ring_buffer.h
+/// @brief Single-producer multi-consumer sequenced broadcast ring
+///        (Disruptor-style).
+///
+/// Hot-path transport primitive. Zero allocation after construction,
+/// lock-free. Every consumer sees every element: each owns a cursor (the
+/// next sequence it will read) on its own cache line and advances it
+/// independently, so the publisher, analytics, journal writer and risk
+/// monitor can each run on their own core instead of behind one thread's
+/// callback chain.
+///
+/// The producer publishes with a release store of head_ and only waits for
+/// gating consumers: a slot is reused once every gating cursor has passed
+/// it. The minimum over those cursors is cached on the producer's line and
+/// recomputed only when the cache says the ring is full. A non-gating
+/// consumer never slows the producer; if it falls a whole lap behind it
+/// skips to the oldest element the producer cannot be rewriting (one lap
+/// minus one slot back) and counts the rest as lost().
+///
+/// Consumer 0 (PRIMARY) exists from construction and gates, and the
+/// consumer calls without an id act on it, so the ring is a drop-in for
+/// SPSCRingBuffer when no other consumer is added.
+///
+/// Memory ordering: acquire/release on head_ and the cursors — no seq_cst.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "transport/wait_strategy.h"
+
+namespace hft {
+
+/// Lock-free SPMC broadcast ring buffer.
+///
+/// @tparam T            Element type — must be trivially copyable.
+/// @tparam Capacity     Number of slots — must be a power of two.
+/// @tparam MaxConsumers Cursor slots, including PRIMARY.
+template <typename T, size_t Capacity, size_t MaxConsumers = 8>
+class BroadcastRingBuffer {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(Capacity > 0, "Capacity must be greater than zero");
+    static_assert(MaxConsumers > 0, "At least one consumer slot is required");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Element type must be trivially copyable");
+
+public:
+    using ConsumerId = uint32_t;
+    static constexpr ConsumerId PRIMARY = 0;
+    static constexpr ConsumerId INVALID_CONSUMER = UINT32_MAX;
+
+    BroadcastRingBuffer() noexcept {
+        cursors_[PRIMARY].active.store(true, std::memory_order_relaxed);
+        cursors_[PRIMARY].gating.store(true, std::memory_order_relaxed);
+    }
+
+    BroadcastRingBuffer(const BroadcastRingBuffer&) = delete;
+    BroadcastRingBuffer& operator=(const BroadcastRingBuffer&) = delete;
+    BroadcastRingBuffer(BroadcastRingBuffer&&) = delete;
+    BroadcastRingBuffer& operator=(BroadcastRingBuffer&&) = delete;
+
+    // -----------------------------------------------------------------------
+    // Consumer registration (cold path; safe while the producer runs)
+    // -----------------------------------------------------------------------
+
+    /// Register a consumer starting at the next element published. Call
+    /// from one thread at a time. @return its id, or INVALID_CONSUMER if
+    /// every slot is taken.
+    [[nodiscard]] ConsumerId add_consumer(bool gating = true) noexcept {
+        for (ConsumerId id = 0; id < MaxConsumers; ++id) {
+            Cursor& c = cursors_[id];
+            if (c.active.load(std::memory_order_acquire)) continue;
+            // The new cursor is at head_, at or ahead of every other one,
+            // so a producer that has not seen it yet cannot overrun it.
+            c.position.store(head_.load(std::memory_order_acquire),
+                             std::memory_order_relaxed);
+            c.lost = 0;
+            c.gating.store(gating, std::memory_order_relaxed);
+            c.active.store(true, std::memory_order_release);
+            return id;
+        }
+        return INVALID_CONSUMER;
+    }
+
+    /// Stop tracking a consumer; the producer no longer waits for it.
+    void remove_consumer(ConsumerId id) noexcept {
+        cursors_[id].active.store(false, std::memory_order_release);
+    }
+
+    /// Make a consumer gate the producer, or stop it from doing so.
+    void set_gating(ConsumerId id, bool gating) noexcept {
+        cursors_[id].gating.store(gating, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool is_gating(ConsumerId id) const noexcept {
+        return cursors_[id].gating.load(std::memory_order_acquire);
+    }
+
+    // -----------------------------------------------------------------------
+    // Producer
+    // -----------------------------------------------------------------------
+
+    /// Try to publish an item to every consumer.
+    /// @return true if published, false if a gating consumer is a lap behind.
+    [[nodiscard]] bool try_push(const T& item) noexcept {
+        T* slot = claim();
+        if (!slot) return false;
+        std::memcpy(slot, &item, sizeof(T));
+        commit();
+        return true;
+    }
+
+    /// Slot for the next item, filled in place and published with commit().
+    /// @return nullptr if the slowest gating consumer is a lap behind.
+    [[nodiscard]] T* claim() noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_gate_ >= Capacity) {
+            cached_gate_ = gating_minimum(head);
+            if (head - cached_gate_ >= Capacity) {
+                return nullptr;  // full
+            }
+        }
+        return &buffer_[head & kMask];
+    }
+
+    /// Publish the slot returned by the last claim().
+    void commit() noexcept {
+        head_.store(head_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+        if (wakeup_) [[unlikely]] wakeup_->notify();
+    }
+
+    // -----------------------------------------------------------------------
+    // Consumers (each id used by one thread)
+    // -----------------------------------------------------------------------
+
+    /// Try to read consumer `id`'s next item.
+    [[nodiscard]] bool try_pop(ConsumerId id, T& item) noexcept {
+        return try_pop_n(id, &item, 1) == 1;
+    }
+
+    /// Read up to `max` of consumer `id`'s next items, advancing its cursor
+    /// once. @return number of items read.
+    [[nodiscard]] size_t try_pop_n(ConsumerId id, T* out, size_t max) noexcept {
+        Cursor& c = cursors_[id];
+        size_t pos = c.position.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        if (head - pos >= Capacity && !c.gating.load(std::memory_order_relaxed)) {
+            pos = skip_lapped(c, head);
+        }
+        size_t n = (head - pos < max) ? head - pos : max;
+        if (n == 0) return 0;
+
+        const size_t first = pos & kMask;
+        const size_t run = (n < Capacity - first) ? n : Capacity - first;
+        std::memcpy(out, &buffer_[first], run * sizeof(T));
+        std::memcpy(out + run, &buffer_[0], (n - run) * sizeof(T));
+
+        if (!c.gating.load(std::memory_order_relaxed)) {
+            // Not gating: the producer may have reused a slot while it was
+            // copied. Keep only what was still a lap from head_ afterwards.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            head = head_.load(std::memory_order_relaxed);
+            if (head - pos >= Capacity) {
+                size_t stale = head - pos - Capacity + 1;
+                if (stale >= n) {
+                    c.lost += n;
+                    c.position.store(pos + n, std::memory_order_release);
+                    return 0;
+                }
+                std::memmove(out, out + stale, (n - stale) * sizeof(T));
+                c.lost += stale;
+                pos += stale;
+                n -= stale;
+            }
+        }
+        c.position.store(pos + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Consumer `id`'s next item, read in place and given back with
+    /// release(id). Gating consumers only: a non-gating consumer's slot can
+    /// be overwritten while it is being read. @return nullptr if none.
+    [[nodiscard]] const T* peek(ConsumerId id) noexcept {
+        const size_t pos = cursors_[id].position.load(std::memory_order_relaxed);
+        if (pos == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &buffer_[pos & kMask];
+    }
+
+    /// Advance consumer `id` past the item returned by the last peek(id).
+    void release(ConsumerId id) noexcept {
+        Cursor& c = cursors_[id];
+        c.position.store(c.position.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    }
+
+    /// Items published but not yet read by consumer `id` (approximate).
+    [[nodiscard]] size_t size(ConsumerId id) const noexcept {
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - cursors_[id].position.load(std::memory_order_acquire);
+    }
+
+    /// Items a non-gating consumer skipped after falling a lap behind.
+    [[nodiscard]] uint64_t lost(ConsumerId id) const noexcept {
+        return cursors_[id].lost;
+    }
+
+    // PRIMARY shorthands — the SPSCRingBuffer consumer interface.
+    [[nodiscard]] bool try_pop(T& item) noexcept { return try_pop(PRIMARY, item); }
+    [[nodiscard]] size_t try_pop_n(T* out, size_t max) noexcept {
+        return try_pop_n(PRIMARY, out, max);
+    }
+    [[nodiscard]] const T* peek() noexcept { return peek(PRIMARY); }
+    void release() noexcept { release(PRIMARY); }
+    [[nodiscard]] size_t size() const noexcept { return size(PRIMARY); }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    /// Whether the producer is blocked by a gating consumer (approximate).
+    [[nodiscard]] bool full() const noexcept {
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - gating_minimum(head) >= Capacity;
+    }
+
+    /// Fixed capacity of the buffer.
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    /// Cursor slots, including PRIMARY.
+    [[nodiscard]] static constexpr size_t max_consumers() noexcept {
+        return MaxConsumers;
+    }
+
+    // -----------------------------------------------------------------------
+    // Consumer wakeups (cold path; set before the producer starts)
+    // -----------------------------------------------------------------------
+
+    /// Notify `signal` after every publish, for consumers using
+    /// WaitStrategy::Block. nullptr (the default) detaches it.
+    void set_wakeup(WakeupSignal* signal) noexcept { wakeup_ = signal; }
+    [[nodiscard]] WakeupSignal* wakeup() const noexcept { return wakeup_; }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    struct alignas(64) Cursor {
+        std::atomic<size_t> position{0};  // Next sequence to read
+        std::atomic<bool> active{false};
+        std::atomic<bool> gating{false};
+        uint64_t lost = 0;                // Consumer-only
+    };
+
+    /// Lowest cursor among active gating consumers; `head` if there is none.
+    [[nodiscard]] size_t gating_minimum(size_t head) const noexcept {
+        size_t min = head;
+        for (const Cursor& c : cursors_) {
+            if (!c.active.load(std::memory_order_acquire) ||
+                !c.gating.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            const size_t pos = c.position.load(std::memory_order_acquire);
+            if (head - pos > head - min) min = pos;
+        }
+        return min;
+    }
+
+    /// Non-gating consumer a lap behind: jump to the oldest slot the
+    /// producer cannot be rewriting (the one at head_ may be claimed).
+    size_t skip_lapped(Cursor& c, size_t head) noexcept {
+        const size_t pos = c.position.load(std::memory_order_relaxed);
+        const size_t oldest = head - Capacity + 1;
+        c.lost += oldest - pos;
+        c.position.store(oldest, std::memory_order_relaxed);
+        return oldest;
+    }
+
+    // Producer writes head_; cached_gate_ is its last gating minimum.
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_gate_{0};
+    WakeupSignal* wakeup_{nullptr};
+    char pad_head_[64 - sizeof(std::atomic<size_t>) - sizeof(size_t) -
+                   sizeof(WakeupSignal*)];
+
+    Cursor cursors_[MaxConsumers];
+
+    // Buffer on its own cache-line boundary.
+    alignas(64) T buffer_[Capacity];
+};
+
+}  // namespace hft
@@ -3,16 +3,19 @@
 /// @file event_buffer.h
 /// @brief Type alias for the outbound event ring buffer.
 ///
-/// EventBuffer is the SPSC channel between the matching engine thread
-/// (producer) and the market data publisher thread (consumer).
-/// 65536 slots * 64 bytes = 4 MB — sized to absorb bursts without
+/// EventBuffer is the broadcast channel from the matching engine thread
+/// (producer) to every event consumer — the market data publisher, and
+/// optionally analytics, the journal writer and the risk monitor, each on
+/// its own thread with its own cursor (add_consumer). The PRIMARY cursor
+/// exists from construction, so a single consumer uses it like an SPSC
+/// queue. 65536 slots * 64 bytes = 4 MB — sized to absorb bursts without
 /// backpressure under normal conditions.
 
+#include "transport/broadcast_ring_buffer.h"
 #include "transport/message.h"
-#include "transport/spsc_ring_buffer.h"
 
 namespace hft {
 
-using EventBuffer = SPSCRingBuffer<EventMessage, 65536>;
+using EventBuffer = BroadcastRingBuffer<EventMessage, 65536>;
 
 }  // namespace hft
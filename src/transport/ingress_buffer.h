@@ -0,0 +1,18 @@
+#pragma once
+
+/// @file ingress_buffer.h
+/// @brief Type alias for the inbound order ring buffer.
+///
+/// IngressBuffer is the MPSC channel from every order source — FIX
+/// sessions, internal strategy threads — to the matching thread, which
+/// drains it (InstrumentRouter::drain). 8192 slots * 192-byte cells =
+/// 1.5 MB; each cell holds one 128-byte OrderMessage plus its sequence.
+
+#include "transport/message.h"
+#include "transport/mpsc_ring_buffer.h"
+
+namespace hft {
+
+using IngressBuffer = MPSCRingBuffer<OrderMessage, 8192>;
+
+}  // namespace hft
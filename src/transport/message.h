@@ -35,7 +35,7 @@ struct alignas(64) OrderMessage {
     MessageType type;            // 1 byte
     uint8_t pad_[3];             // 3 bytes padding
     InstrumentId instrument_id;  // 4 bytes — instrument routing key
-    Order order;                 // 88 bytes
+    Order order;                 // 120 bytes
     // implicit trailing padding to 128 bytes (alignas(64), next multiple)
 };
 
@@ -60,9 +60,30 @@ enum class EventType : uint8_t {
     OrderRejected,      // Order was rejected (e.g. FOK not feasible)
     OrderFilled,        // Order fully filled (terminal)
     OrderPartialFill,   // Order partially filled
-    OrderModified       // Order modified (price/quantity amended)
+    OrderModified,      // Order modified (price/quantity amended)
+    MassCancel,         // Batch of one participant's orders cancelled
+    OrderExpired,       // DAY / GTD order removed at its expiry
+    LevelUpdate,        // Price level's new total quantity and order count
+    BookDigest          // Periodic stamp of the book's state digest
 };
 
+/// Trade event data — the 64-bit fields of a Trade. Its flags, aggressor
+/// side and resting participant travel in the EventMessage header; use
+/// set_trade() and event_trade() rather than filling this directly.
+struct TradeEventData {
+    uint64_t trade_id;
+    OrderId buy_order_id;
+    OrderId sell_order_id;
+    Price price;
+    Quantity quantity;
+    Timestamp timestamp;
+};
+
+static_assert(sizeof(TradeEventData) == 48,
+              "TradeEventData must be exactly 48 bytes");
+static_assert(std::is_trivially_copyable_v<TradeEventData>,
+              "TradeEventData must be trivially copyable");
+
 /// Order event data — status update for a single order.
 struct OrderEventData {
     OrderId order_id;
@@ -79,10 +100,61 @@ static_assert(sizeof(OrderEventData) == 48,
 static_assert(std::is_trivially_copyable_v<OrderEventData>,
               "OrderEventData must be trivially copyable");
 
+/// Mass cancel event data — one event for a whole participant sweep.
+struct MassCancelEventData {
+    ParticipantId participant_id;
+    uint8_t side;                 // 0 = Buy, 1 = Sell, 2 = both sides
+    uint8_t pad_[3];
+    uint32_t cancelled_count;     // Orders removed
+    uint32_t pad2_;
+    Quantity cancelled_quantity;  // Sum of their remaining quantity
+    uint8_t reserved_[24];
+};
+
+static_assert(sizeof(MassCancelEventData) == 48,
+              "MassCancelEventData must be exactly 48 bytes");
+static_assert(std::is_trivially_copyable_v<MassCancelEventData>,
+              "MassCancelEventData must be trivially copyable");
+
+/// Level update event data — market-by-price delta for one level. A
+/// total_quantity of zero removes the level.
+struct LevelUpdateEventData {
+    Price price;
+    Quantity total_quantity;
+    uint32_t order_count;
+    uint8_t side;                 // 0 = Buy, 1 = Sell
+    uint8_t pad_[3];
+    uint8_t reserved_[24];
+};
+
+static_assert(sizeof(LevelUpdateEventData) == 48,
+              "LevelUpdateEventData must be exactly 48 bytes");
+static_assert(std::is_trivially_copyable_v<LevelUpdateEventData>,
+              "LevelUpdateEventData must be trivially copyable");
+
+/// Book digest event data — OrderBook::state_digest() after the call that
+/// published it, for replicas and re-runs to compare at the same sequence
+/// number.
+struct BookDigestEventData {
+    uint64_t digest;
+    uint64_t order_count;         // Resting orders
+    Price best_bid;               // 0 if the side is empty
+    Price best_ask;
+    uint8_t reserved_[16];
+};
+
+static_assert(sizeof(BookDigestEventData) == 48,
+              "BookDigestEventData must be exactly 48 bytes");
+static_assert(std::is_trivially_copyable_v<BookDigestEventData>,
+              "BookDigestEventData must be trivially copyable");
+
 /// Discriminated union of event payloads.
 union EventData {
-    Trade trade;               // 48 bytes
+    TradeEventData trade;      // 48 bytes
     OrderEventData order_event; // 48 bytes
+    MassCancelEventData mass_cancel; // 48 bytes
+    LevelUpdateEventData level_update; // 48 bytes
+    BookDigestEventData book_digest; // 48 bytes
 };
 
 static_assert(sizeof(EventData) == 48,
@@ -92,9 +164,14 @@ static_assert(std::is_trivially_copyable_v<EventData>,
 
 /// Fixed-size outbound event message. One event per trade or order status
 /// change — decomposed from MatchResult for efficient ring buffer transport.
+///
+/// trade_flags and trade_participant are only meaningful for Trade events
+/// (zero otherwise): Trade::flags, with TRADE_EVENT_SELL_AGGRESSOR standing
+/// for Trade::aggressor_side, and Trade::resting_participant_id.
 struct alignas(64) EventMessage {
     EventType type;              // 1 byte
-    uint8_t pad_[3];             // 3 bytes padding
+    uint8_t trade_flags;         // 1 byte — Trade events: TradeFlags + side
+    uint16_t trade_participant;  // 2 bytes — Trade events: resting participant
     InstrumentId instrument_id;  // 4 bytes — instrument routing key
     uint64_t sequence_num;       // 8 bytes — monotonically increasing sequence
     EventData data;              // 48 bytes
@@ -109,4 +186,34 @@ static_assert(sizeof(EventMessage) == 64,
 static_assert(alignof(EventMessage) == 64,
               "EventMessage must be cache-line aligned");
 
+/// EventMessage::trade_flags bit set when the aggressor was the seller.
+constexpr uint8_t TRADE_EVENT_SELL_AGGRESSOR = 1 << 7;
+
+/// Store `trade` in `event` (payload and header fields); the caller sets
+/// type, instrument_id and sequence_num.
+inline void set_trade(EventMessage& event, const Trade& trade) noexcept {
+    event.trade_flags = static_cast<uint8_t>(
+        trade.flags | (trade.aggressor_side == Side::Sell ? TRADE_EVENT_SELL_AGGRESSOR : 0));
+    event.trade_participant = trade.resting_participant_id;
+    event.data.trade = TradeEventData{trade.trade_id, trade.buy_order_id, trade.sell_order_id,
+                                      trade.price,    trade.quantity,     trade.timestamp};
+}
+
+/// The Trade carried by a Trade event.
+[[nodiscard]] inline Trade event_trade(const EventMessage& event) noexcept {
+    const TradeEventData& d = event.data.trade;
+    Trade trade{};
+    trade.trade_id = d.trade_id;
+    trade.buy_order_id = d.buy_order_id;
+    trade.sell_order_id = d.sell_order_id;
+    trade.price = d.price;
+    trade.quantity = d.quantity;
+    trade.timestamp = d.timestamp;
+    trade.resting_participant_id = event.trade_participant;
+    trade.aggressor_side =
+        (event.trade_flags & TRADE_EVENT_SELL_AGGRESSOR) ? Side::Sell : Side::Buy;
+    trade.flags = static_cast<uint8_t>(event.trade_flags & ~TRADE_EVENT_SELL_AGGRESSOR);
+    return trade;
+}
+
 }  // namespace hft
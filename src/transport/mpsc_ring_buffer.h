@@ -0,0 +1,183 @@
+#pragma once
+
+/// @file mpsc_ring_buffer.h
+/// @brief Bounded lock-free multi-producer single-consumer ring buffer.
+///
+/// Hot-path transport primitive for ingress: several gateway sessions or
+/// strategy threads submit to one matching thread. Zero allocation after
+/// construction.
+///
+/// Sequence-numbered cells (Vyukov's bounded queue, single-consumer form):
+/// each cell carries a sequence that says whether it is free for the
+/// producer of lap N or full for the consumer of lap N. Producers claim a
+/// position with one CAS on enqueue_pos_, write the cell, then publish it
+/// with a release store of its sequence — no lock, and a stalled producer
+/// only delays the consumer at its own cell. The consumer needs no atomic
+/// read-modify-write at all.
+///
+/// Arrival stamping is deterministic: the claimed position is a single
+/// total order over all producers, the consumer sees messages in exactly
+/// that order, and try_push / try_pop report it as the message's ticket.
+/// Replaying the same tickets reproduces the same interleaving.
+///
+/// Cells are cache-line aligned so producers writing neighbouring cells do
+/// not false-share; enqueue_pos_ and dequeue_pos_ sit on their own lines.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "transport/wait_strategy.h"
+
+namespace hft {
+
+/// Lock-free bounded MPSC ring buffer.
+///
+/// @tparam T        Element type — must be trivially copyable (POD messages).
+/// @tparam Capacity Number of cells — must be a power of two, at least 2.
+template <typename T, size_t Capacity>
+class MPSCRingBuffer {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(Capacity >= 2, "Capacity must be at least two");
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Element type must be trivially copyable");
+
+public:
+    MPSCRingBuffer() noexcept {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+    MPSCRingBuffer(MPSCRingBuffer&&) = delete;
+    MPSCRingBuffer& operator=(MPSCRingBuffer&&) = delete;
+
+    /// Try to push an item (any producer thread).
+    /// @param ticket Set to the item's arrival position on success.
+    /// @return true if the item was pushed, false if the buffer is full.
+    [[nodiscard]] bool try_push(const T& item, uint64_t& ticket) noexcept {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & kMask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff =
+                static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // Free for this lap: claim it (pos is reloaded on failure)
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // full: the consumer has not freed this cell
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        std::memcpy(&cell->data, &item, sizeof(T));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        if (wakeup_) [[unlikely]] wakeup_->notify();
+        ticket = pos;
+        return true;
+    }
+
+    [[nodiscard]] bool try_push(const T& item) noexcept {
+        uint64_t ticket;
+        return try_push(item, ticket);
+    }
+
+    /// Try to pop the oldest item (consumer thread only).
+    /// @param ticket Set to the item's arrival position on success.
+    /// @return true if an item was popped, false if the buffer is empty or
+    ///         the producer holding the next position has not finished.
+    [[nodiscard]] bool try_pop(T& item, uint64_t& ticket) noexcept {
+        const size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[pos & kMask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        std::memcpy(&item, &cell.data, sizeof(T));
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+        ticket = pos;
+        return true;
+    }
+
+    [[nodiscard]] bool try_pop(T& item) noexcept {
+        uint64_t ticket;
+        return try_pop(item, ticket);
+    }
+
+    /// Pop up to `max` consecutive items in arrival order (consumer thread
+    /// only). Stops early at a cell whose producer has not finished.
+    /// @return number of items popped.
+    [[nodiscard]] size_t try_pop_n(T* out, size_t max) noexcept {
+        const size_t start = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t n = 0;
+        while (n < max) {
+            const size_t pos = start + n;
+            Cell& cell = cells_[pos & kMask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            std::memcpy(&out[n], &cell.data, sizeof(T));
+            cell.sequence.store(pos + Capacity, std::memory_order_release);
+            ++n;
+        }
+        dequeue_pos_.store(start + n, std::memory_order_relaxed);
+        return n;
+    }
+
+    /// Number of claimed, not yet popped positions (approximate, racy).
+    [[nodiscard]] size_t size() const noexcept {
+        const size_t tail = dequeue_pos_.load(std::memory_order_acquire);
+        const size_t head = enqueue_pos_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    /// Whether the buffer is empty (approximate, racy between threads).
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    /// Fixed capacity of the buffer.
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return Capacity;
+    }
+
+    // -----------------------------------------------------------------------
+    // Consumer wakeups (cold path; set before the producer starts)
+    // -----------------------------------------------------------------------
+
+    /// Notify `signal` after every publish, for consumers using
+    /// WaitStrategy::Block. nullptr (the default) detaches it.
+    void set_wakeup(WakeupSignal* signal) noexcept { wakeup_ = signal; }
+    [[nodiscard]] WakeupSignal* wakeup() const noexcept { return wakeup_; }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // Producers CAS enqueue_pos_; only the consumer writes dequeue_pos_.
+    // wakeup_ is read-only once producers run.
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    WakeupSignal* wakeup_{nullptr};
+    char pad_enqueue_[64 - sizeof(std::atomic<size_t>) - sizeof(WakeupSignal*)];
+
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    char pad_dequeue_[64 - sizeof(std::atomic<size_t>)];
+
+    alignas(64) Cell cells_[Capacity];
+};
+
+}  // namespace hft
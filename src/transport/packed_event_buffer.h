@@ -0,0 +1,218 @@
+#pragma once
+
+/// @file packed_event_buffer.h
+/// @brief Compact outbound event stream — one or two 32-byte slots per
+///        event instead of a fixed 64-byte EventMessage.
+///
+/// Hot-path transport primitive, header-only, zero allocation after
+/// construction. Cancels, expiries and rejections, which dominate L3
+/// traffic, carry nothing a consumer needs beyond the order id, status,
+/// remaining quantity and sequence number. They travel as a 32-byte
+/// CompactOrderEvent; every other event is copied whole into two slots.
+/// The ring and every downstream copy then move about half the bytes on
+/// cancel-heavy flow.
+///
+/// Full records always start on an even slot, so they stay cache-line
+/// aligned exactly like EventBuffer slots; the producer fills an odd gap
+/// with a one-slot pad record. A record never wraps (the capacity is even).
+///
+/// The short form drops the price, filled quantity and timestamp of those
+/// events: decode() returns them as zero. Consumers needing them use
+/// EventBuffer.
+///
+/// Single producer (the matching thread), single consumer. Memory
+/// ordering: acquire/release on head_ and tail_, with cached copies of
+/// the other side's index as in SPSCRingBuffer.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "transport/message.h"
+#include "transport/wait_strategy.h"
+
+namespace hft {
+
+// ---------------------------------------------------------------------------
+// Short form
+// ---------------------------------------------------------------------------
+
+/// 32-byte form of an OrderCancelled / OrderExpired / OrderRejected event.
+struct alignas(32) CompactOrderEvent {
+    EventType type;              // 1 byte — same offset as EventMessage::type
+    OrderStatus status;          // 1 byte
+    uint8_t pad_[2];
+    InstrumentId instrument_id;  // 4 bytes
+    uint64_t sequence_num;       // 8 bytes
+    OrderId order_id;            // 8 bytes
+    Quantity remaining_quantity; // 8 bytes
+};
+
+static_assert(sizeof(CompactOrderEvent) == 32,
+              "CompactOrderEvent must be exactly 32 bytes (half a cache line)");
+static_assert(std::is_trivially_copyable_v<CompactOrderEvent>,
+              "CompactOrderEvent must be trivially copyable");
+
+/// Whether events of `type` travel in the short form.
+[[nodiscard]] constexpr bool is_compact_event(EventType type) noexcept {
+    return type == EventType::OrderCancelled ||
+           type == EventType::OrderExpired ||
+           type == EventType::OrderRejected;
+}
+
+/// Short form of an event for which is_compact_event() holds.
+[[nodiscard]] inline CompactOrderEvent encode_compact(const EventMessage& event) noexcept {
+    CompactOrderEvent c{};
+    c.type = event.type;
+    c.status = event.data.order_event.status;
+    c.instrument_id = event.instrument_id;
+    c.sequence_num = event.sequence_num;
+    c.order_id = event.data.order_event.order_id;
+    c.remaining_quantity = event.data.order_event.remaining_quantity;
+    return c;
+}
+
+/// Expand a short-form event (price, filled quantity, timestamp = 0).
+[[nodiscard]] inline EventMessage decode_compact(const CompactOrderEvent& c) noexcept {
+    EventMessage event{};
+    event.type = c.type;
+    event.instrument_id = c.instrument_id;
+    event.sequence_num = c.sequence_num;
+    event.data.order_event.order_id = c.order_id;
+    event.data.order_event.status = c.status;
+    event.data.order_event.remaining_quantity = c.remaining_quantity;
+    return event;
+}
+
+// ---------------------------------------------------------------------------
+// Ring
+// ---------------------------------------------------------------------------
+
+/// SPSC ring of 32-byte slots holding short and full event records.
+///
+/// @tparam Slots Number of 32-byte slots — must be a power of two, >= 2.
+template <size_t Slots>
+class PackedEventRing {
+    static_assert((Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+    static_assert(Slots >= 2, "Slots must hold at least one full record");
+
+public:
+    static constexpr size_t SLOT_BYTES = 32;
+
+    PackedEventRing() noexcept = default;
+
+    PackedEventRing(const PackedEventRing&) = delete;
+    PackedEventRing& operator=(const PackedEventRing&) = delete;
+    PackedEventRing(PackedEventRing&&) = delete;
+    PackedEventRing& operator=(PackedEventRing&&) = delete;
+
+    /// Encode and publish one event (producer side).
+    /// @return false if the ring has no room for it.
+    [[nodiscard]] bool try_push(const EventMessage& event) noexcept {
+        const bool compact = is_compact_event(event.type);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t pad = (!compact && (head & 1)) ? 1 : 0;
+        const size_t need = pad + (compact ? 1 : 2);
+        if (head + need - cached_tail_ > Slots) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head + need - cached_tail_ > Slots) {
+                return false;  // full
+            }
+        }
+        if (pad) {
+            slots_[head & kMask].bytes[0] = PAD_TAG;
+        }
+        Slot* slot = &slots_[(head + pad) & kMask];
+        if (compact) {
+            CompactOrderEvent c = encode_compact(event);
+            std::memcpy(slot, &c, SLOT_BYTES);
+        } else {
+            std::memcpy(slot, &event, sizeof(EventMessage));
+        }
+        head_.store(head + need, std::memory_order_release);
+        if (wakeup_) [[unlikely]] wakeup_->notify();
+        return true;
+    }
+
+    /// Pop and decode the next event (consumer side).
+    /// @return false if the ring is empty.
+    [[nodiscard]] bool try_pop(EventMessage& event) noexcept {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) return false;
+        }
+        if (slots_[tail & kMask].bytes[0] == PAD_TAG) {
+            ++tail;  // The full record after a pad is published with it
+        }
+        const Slot* slot = &slots_[tail & kMask];
+        const auto type = static_cast<EventType>(slot->bytes[0]);
+        if (is_compact_event(type)) {
+            CompactOrderEvent c;
+            std::memcpy(&c, slot, SLOT_BYTES);
+            event = decode_compact(c);
+            ++tail;
+        } else {
+            std::memcpy(&event, slot, sizeof(EventMessage));
+            tail += 2;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return true;
+    }
+
+    /// Slots published but not yet consumed (approximate).
+    [[nodiscard]] size_t size_slots() const noexcept {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size_slots() == 0; }
+
+    /// Bytes published since construction, pads included (approximate).
+    [[nodiscard]] uint64_t bytes_published() const noexcept {
+        return static_cast<uint64_t>(head_.load(std::memory_order_acquire)) * SLOT_BYTES;
+    }
+
+    [[nodiscard]] static constexpr size_t capacity_slots() noexcept { return Slots; }
+
+    // -----------------------------------------------------------------------
+    // Consumer wakeups (cold path; set before the producer starts)
+    // -----------------------------------------------------------------------
+
+    /// Notify `signal` after every publish, for consumers using
+    /// WaitStrategy::Block. nullptr (the default) detaches it.
+    void set_wakeup(WakeupSignal* signal) noexcept { wakeup_ = signal; }
+    [[nodiscard]] WakeupSignal* wakeup() const noexcept { return wakeup_; }
+
+private:
+    static constexpr size_t kMask = Slots - 1;
+    /// First byte of a pad slot; no EventType uses it.
+    static constexpr uint8_t PAD_TAG = 0xFF;
+
+    struct alignas(32) Slot {
+        uint8_t bytes[SLOT_BYTES];
+    };
+
+    // Producer writes head_; cached_tail_ is its last view of tail_.
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_tail_{0};
+    WakeupSignal* wakeup_{nullptr};
+    char pad_head_[64 - sizeof(std::atomic<size_t>) - sizeof(size_t) -
+                   sizeof(WakeupSignal*)];
+
+    // Consumer writes tail_; cached_head_ is its last view of head_.
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_{0};
+    char pad_tail_[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+    // Slots on their own cache-line boundary.
+    alignas(64) Slot slots_[Slots];
+};
+
+/// 131072 slots * 32 bytes = 4 MB, the footprint of EventBuffer, holding
+/// 64K full events or twice as many short ones.
+using PackedEventBuffer = PackedEventRing<131072>;
+
+}  // namespace hft
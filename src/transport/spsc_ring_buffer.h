@@ -9,12 +9,21 @@
 /// unsigned overflow is well-defined and avoids ABA problems.
 ///
 /// Memory ordering: acquire/release on head_ and tail_ — no seq_cst.
+///
+/// Each side keeps a private copy of the other side's index and reloads the
+/// shared atomic only when that copy says the buffer is full (producer) or
+/// empty (consumer), so a steady stream touches the other side's cache line
+/// once per lap instead of once per element. The _n forms move a batch with
+/// one release store; claim()/commit() and peek()/release() let callers
+/// build and read elements in place in the buffer, skipping the copy.
 
 #include <atomic>
 #include <cstddef>
 #include <cstring>
 #include <type_traits>
 
+#include "transport/wait_strategy.h"
+
 namespace hft {
 
 /// Lock-free SPSC ring buffer.
@@ -40,31 +49,103 @@ public:
     /// Try to push an item into the buffer (producer side).
     /// @return true if the item was pushed, false if the buffer is full.
     [[nodiscard]] bool try_push(const T& item) noexcept {
+        T* slot = claim();
+        if (!slot) return false;
+        std::memcpy(slot, &item, sizeof(T));
+        commit();
+        return true;
+    }
+
+    /// Push up to `count` items with a single publish (producer side).
+    /// @return number of items pushed (0 if the buffer is full).
+    [[nodiscard]] size_t try_push_n(const T* items, size_t count) noexcept {
         const size_t head = head_.load(std::memory_order_relaxed);
-        const size_t tail = tail_.load(std::memory_order_acquire);
+        size_t free = Capacity - (head - cached_tail_);
+        if (free < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free = Capacity - (head - cached_tail_);
+        }
+        const size_t n = (count < free) ? count : free;
+        if (n == 0) return 0;
+
+        // At most two runs: up to the end of the array, then from the start
+        const size_t first = head & kMask;
+        const size_t run = (n < Capacity - first) ? n : Capacity - first;
+        std::memcpy(&buffer_[first], items, run * sizeof(T));
+        std::memcpy(&buffer_[0], items + run, (n - run) * sizeof(T));
+        head_.store(head + n, std::memory_order_release);
+        if (wakeup_) [[unlikely]] wakeup_->notify();
+        return n;
+    }
 
-        if (head - tail >= Capacity) {
-            return false;  // full
+    /// Slot for the next item, to be filled in place and published with
+    /// commit() (producer side). Claiming again before commit() returns the
+    /// same slot. @return nullptr if the buffer is full.
+    [[nodiscard]] T* claim() noexcept {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ >= Capacity) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ >= Capacity) {
+                return nullptr;  // full
+            }
         }
+        return &buffer_[head & kMask];
+    }
 
-        std::memcpy(&buffer_[head & kMask], &item, sizeof(T));
-        head_.store(head + 1, std::memory_order_release);
-        return true;
+    /// Publish the slot returned by the last claim().
+    void commit() noexcept {
+        head_.store(head_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+        if (wakeup_) [[unlikely]] wakeup_->notify();
     }
 
     /// Try to pop an item from the buffer (consumer side).
     /// @return true if an item was popped, false if the buffer is empty.
     [[nodiscard]] bool try_pop(T& item) noexcept {
+        const T* slot = peek();
+        if (!slot) return false;
+        std::memcpy(&item, slot, sizeof(T));
+        release();
+        return true;
+    }
+
+    /// Pop up to `max` items with a single release (consumer side).
+    /// @return number of items popped (0 if the buffer is empty).
+    [[nodiscard]] size_t try_pop_n(T* out, size_t max) noexcept {
         const size_t tail = tail_.load(std::memory_order_relaxed);
-        const size_t head = head_.load(std::memory_order_acquire);
+        size_t avail = cached_head_ - tail;
+        if (avail < max) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            avail = cached_head_ - tail;
+        }
+        const size_t n = (max < avail) ? max : avail;
+        if (n == 0) return 0;
+
+        const size_t first = tail & kMask;
+        const size_t run = (n < Capacity - first) ? n : Capacity - first;
+        std::memcpy(out, &buffer_[first], run * sizeof(T));
+        std::memcpy(out + run, &buffer_[0], (n - run) * sizeof(T));
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
 
-        if (tail >= head) {
-            return false;  // empty
+    /// Oldest item, read in place and given back with release() (consumer
+    /// side). @return nullptr if the buffer is empty.
+    [[nodiscard]] const T* peek() noexcept {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return nullptr;  // empty
+            }
         }
+        return &buffer_[tail & kMask];
+    }
 
-        std::memcpy(&item, &buffer_[tail & kMask], sizeof(T));
-        tail_.store(tail + 1, std::memory_order_release);
-        return true;
+    /// Free the slot returned by the last peek() for the producer.
+    void release() noexcept {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
     }
 
     /// Number of items currently in the buffer (approximate, racy between threads).
@@ -89,16 +170,31 @@ public:
         return Capacity;
     }
 
+    // -----------------------------------------------------------------------
+    // Consumer wakeups (cold path; set before the producer starts)
+    // -----------------------------------------------------------------------
+
+    /// Notify `signal` after every publish, for consumers using
+    /// WaitStrategy::Block. nullptr (the default) detaches it.
+    void set_wakeup(WakeupSignal* signal) noexcept { wakeup_ = signal; }
+    [[nodiscard]] WakeupSignal* wakeup() const noexcept { return wakeup_; }
+
 private:
     static constexpr size_t kMask = Capacity - 1;
 
-    // Producer writes head_, consumer reads head_.
+    // Producer writes head_, consumer reads head_. cached_tail_ is the
+    // producer's last view of tail_ (producer-only).
     alignas(64) std::atomic<size_t> head_{0};
-    char pad_head_[64 - sizeof(std::atomic<size_t>)];
+    size_t cached_tail_{0};
+    WakeupSignal* wakeup_{nullptr};
+    char pad_head_[64 - sizeof(std::atomic<size_t>) - sizeof(size_t) -
+                   sizeof(WakeupSignal*)];
 
-    // Consumer writes tail_, producer reads tail_.
+    // Consumer writes tail_, producer reads tail_. cached_head_ is the
+    // consumer's last view of head_ (consumer-only).
     alignas(64) std::atomic<size_t> tail_{0};
-    char pad_tail_[64 - sizeof(std::atomic<size_t>)];
+    size_t cached_head_{0};
+    char pad_tail_[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
 
     // Buffer on its own cache-line boundary.
     alignas(64) T buffer_[Capacity];
@@ -0,0 +1,212 @@
+#pragma once
+
+/// @file wait_strategy.h
+/// @brief How a ring consumer waits when it finds nothing to read.
+///
+/// Hot-path transport primitive, header-only, zero allocation. A consumer
+/// loop calls Waiter::idle() after every empty poll and Waiter::reset()
+/// after every productive one; the WaitStrategy decides what an idle poll
+/// costs:
+///
+///   BusySpin  re-poll at once — lowest latency, one core at 100%
+///   Pause     spin with a CPU pause hint (_mm_pause) — same latency,
+///             less power, friendlier to a hyper-thread sibling
+///   Yield     sched_yield every idle poll (the historical default)
+///   Backoff   pause 1, 2, 4 ... spin_limit times, then yield — spins
+///             through short gaps and backs off on long ones
+///   Block     sleep on a WakeupSignal until the producer publishes, up to
+///             block_timeout_us — near-zero CPU when idle, a futex wake
+///             (several microseconds) when traffic resumes
+///
+/// Block needs the producer's ring to have a WakeupSignal attached
+/// (set_wakeup on the ring). Producers then pay a fence and one load per
+/// publish, plus a futex wake only while a consumer sleeps; rings without
+/// a signal pay one predictable branch. Without a signal a Block waiter
+/// just sleeps block_timeout_us between polls.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace hft {
+
+/// CPU hint that the caller is spin-waiting.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+enum class WaitStrategy : uint8_t {
+    BusySpin,
+    Pause,
+    Yield,
+    Backoff,
+    Block
+};
+
+struct WaitConfig {
+    WaitStrategy strategy = WaitStrategy::Yield;
+    /// Backoff: longest pause run before falling back to yield.
+    uint32_t spin_limit = 1024;
+    /// Block: longest sleep, which also bounds shutdown latency.
+    uint32_t block_timeout_us = 1000;
+};
+
+/// Wait counters of one consumer.
+struct WaitStats {
+    uint64_t idle_polls = 0;  // Empty polls (each one called idle())
+    uint64_t yields = 0;      // sched_yield calls
+    uint64_t blocks = 0;      // Sleeps on the signal (or timed sleeps)
+    uint64_t wakeups = 0;     // Sleeps ended by a producer's notify
+};
+
+// ---------------------------------------------------------------------------
+// WakeupSignal — producer-to-consumer wakeup (futex on Linux)
+// ---------------------------------------------------------------------------
+
+/// Attached to a ring by its owner. Consumers sleep on it; the ring's
+/// producer calls notify() after each publish, which is a load and a
+/// branch unless somebody is asleep.
+class WakeupSignal {
+public:
+    WakeupSignal() noexcept = default;
+    WakeupSignal(const WakeupSignal&) = delete;
+    WakeupSignal& operator=(const WakeupSignal&) = delete;
+
+    /// Producer: wake sleeping consumers, if any.
+    void notify() noexcept {
+        // Orders the publish before the sleeper check; pairs with the
+        // fence in wait() so a consumer that re-checked the ring and found
+        // it empty is always counted here.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) [[likely]] return;
+        epoch_.fetch_add(1, std::memory_order_release);
+        notifications_.fetch_add(1, std::memory_order_relaxed);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_),
+                FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    /// Consumer: sleep until notify() or `timeout_us` unless `ready()`
+    /// already holds once registered. @return true if woken by notify().
+    template <typename Ready>
+    bool wait(Ready&& ready, uint32_t timeout_us) noexcept {
+        const uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool woken = false;
+        if (!ready()) {
+#if defined(__linux__)
+            timespec ts;
+            ts.tv_sec = timeout_us / 1'000'000;
+            ts.tv_nsec = static_cast<long>(timeout_us % 1'000'000) * 1000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_),
+                    FUTEX_WAIT_PRIVATE, epoch, &ts, nullptr, 0);
+#else
+            std::this_thread::sleep_for(std::chrono::microseconds(timeout_us));
+#endif
+            woken = epoch_.load(std::memory_order_acquire) != epoch;
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        return woken;
+    }
+
+    /// notify() calls that found a sleeper.
+    [[nodiscard]] uint64_t notifications() const noexcept {
+        return notifications_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex word must be a plain 32-bit integer");
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<uint64_t> notifications_{0};
+};
+
+// ---------------------------------------------------------------------------
+// Waiter — one consumer's idle policy and counters
+// ---------------------------------------------------------------------------
+
+class Waiter {
+public:
+    explicit Waiter(const WaitConfig& config = {},
+                    WakeupSignal* signal = nullptr) noexcept
+        : config_(config), signal_(signal) {}
+
+    /// The last poll found nothing. `ready()` re-checks the ring; only
+    /// Block calls it (after registering as a sleeper).
+    template <typename Ready>
+    void idle(Ready&& ready) noexcept {
+        ++stats_.idle_polls;
+        switch (config_.strategy) {
+            case WaitStrategy::BusySpin:
+                break;
+            case WaitStrategy::Pause:
+                cpu_relax();
+                break;
+            case WaitStrategy::Yield:
+                yield();
+                break;
+            case WaitStrategy::Backoff:
+                if (spins_ < config_.spin_limit) {
+                    spins_ = spins_ ? spins_ * 2 : 1;
+                    for (uint32_t i = 0; i < spins_; ++i) cpu_relax();
+                } else {
+                    yield();
+                }
+                break;
+            case WaitStrategy::Block:
+                ++stats_.blocks;
+                if (signal_) {
+                    if (signal_->wait(ready, config_.block_timeout_us)) {
+                        ++stats_.wakeups;
+                    }
+                } else {
+                    std::this_thread::sleep_for(
+                        std::chrono::microseconds(config_.block_timeout_us));
+                }
+                break;
+        }
+    }
+
+    void idle() noexcept {
+        idle([] { return false; });
+    }
+
+    /// The last poll found work: restart the backoff.
+    void reset() noexcept { spins_ = 0; }
+
+    [[nodiscard]] const WaitStats& stats() const noexcept { return stats_; }
+    [[nodiscard]] const WaitConfig& config() const noexcept { return config_; }
+
+private:
+    void yield() noexcept {
+        ++stats_.yields;
+        std::this_thread::yield();
+    }
+
+    WaitConfig config_;
+    WakeupSignal* signal_;
+    uint32_t spins_ = 0;
+    WaitStats stats_;
+};
+
+}  // namespace hft
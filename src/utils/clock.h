@@ -46,12 +46,9 @@ inline uint64_t rdtsc_start() noexcept {
 /// the timestamp counter. Paired with rdtsc_start() for low-overhead timing.
 inline uint64_t rdtsc_end() noexcept {
     unsigned int aux;
-#ifdef _MSC_VER
+    // The intrinsic on every compiler: an "=A" asm output is only EAX on
+    // x86-64, which dropped the high half of the counter
     uint64_t tsc = __rdtscp(&aux);
-#else
-    uint64_t tsc;
-    __asm__ __volatile__("rdtscp" : "=A"(tsc), "=c"(aux));
-#endif
     _mm_lfence();  // Prevent subsequent instructions from reordering before
     return tsc;
 }
@@ -0,0 +1,210 @@
+#pragma once
+
+// hdr_histogram.h — Constant-memory log-linear histogram of uint64_t values
+//
+// Hot-path compatible record(): O(1), no allocation, no locks, no exceptions.
+// Storage is allocated once in the constructor and never grows, so a
+// histogram can run for the life of the process.
+//
+// Bucket layout (HDR style): values below 2 * SUB_BUCKETS (1024) get one
+// bucket each and are exact. Above that, each power-of-two range
+// [2^e, 2^(e+1)) is split into SUB_BUCKETS (512) linear buckets, so a
+// bucket's width is at most 1/512 of its values (~0.2% relative error).
+// Values above MAX_VALUE (2^44 - 1, ~1.6 h of 3 GHz TSC ticks) are counted
+// in the top bucket; min() and max() stay exact.
+//
+// Threading: one writer per instance (record(), merge() into it, clear()).
+// Counters are relaxed atomics written with plain load/store, which costs
+// the same as a non-atomic increment on x86, so any other thread may read
+// or merge() from a live instance without locking. Give each thread its
+// own histogram and merge them into a reporting instance.
+//
+// A histogram owns its Storage by default, or uses one the caller placed
+// (e.g. in a shared-memory metrics region another process reads). Storage
+// is standard layout over lock-free atomics only, so it is address-free.
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace hft {
+
+class HdrHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 9;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr unsigned VALUE_BITS = 44;
+    static constexpr uint64_t MAX_VALUE = (uint64_t{1} << VALUE_BITS) - 1;
+    /// Buckets covering [0, MAX_VALUE]: 2 * SUB_BUCKETS exact ones, then
+    /// SUB_BUCKETS per power of two up to 2^VALUE_BITS.
+    static constexpr size_t BUCKET_COUNT = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /// All of a histogram's state.
+    struct Storage {
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+        std::atomic<uint64_t> counts[BUCKET_COUNT];
+    };
+
+    HdrHistogram() : owned_(new Storage), s_(owned_.get()) { clear(); }
+
+    /// Record into caller-placed storage, cleared first unless `reset` is
+    /// false (attaching to one already in use).
+    explicit HdrHistogram(Storage& storage, bool reset = true) : s_(&storage) {
+        if (reset) clear();
+    }
+
+    HdrHistogram(const HdrHistogram&) = delete;
+    HdrHistogram& operator=(const HdrHistogram&) = delete;
+
+    /// Record one value. Single writer; allocation- and lock-free.
+    void record(uint64_t value) noexcept { record(value, 1); }
+
+    /// Record `count` occurrences of one value.
+    void record(uint64_t value, uint64_t count) noexcept {
+        if (count == 0) return;
+        bump(s_->counts[bucket_index(value)], count);
+        bump(s_->total, count);
+        bump(s_->sum, value * count);
+        if (value < s_->min.load(std::memory_order_relaxed)) {
+            s_->min.store(value, std::memory_order_relaxed);
+        }
+        if (value > s_->max.load(std::memory_order_relaxed)) {
+            s_->max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// Add another histogram's samples to this one. `other` may be live
+    /// (recording on its own thread): samples it records meanwhile may or
+    /// may not be included.
+    void merge(const HdrHistogram& other) noexcept {
+        if (other.count() == 0) return;
+        const size_t first = bucket_index(other.min());
+        const size_t last = bucket_index(other.max());
+        for (size_t i = first; i <= last; ++i) {
+            const uint64_t c = other.s_->counts[i].load(std::memory_order_relaxed);
+            if (c != 0) bump(s_->counts[i], c);
+        }
+        bump(s_->total, other.count());
+        bump(s_->sum, other.s_->sum.load(std::memory_order_relaxed));
+        if (other.min() < s_->min.load(std::memory_order_relaxed)) {
+            s_->min.store(other.min(), std::memory_order_relaxed);
+        }
+        if (other.max() > s_->max.load(std::memory_order_relaxed)) {
+            s_->max.store(other.max(), std::memory_order_relaxed);
+        }
+    }
+
+    /// Discard all samples (writer thread only).
+    void clear() noexcept {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) s_->counts[i].store(0, std::memory_order_relaxed);
+        s_->total.store(0, std::memory_order_relaxed);
+        s_->sum.store(0, std::memory_order_relaxed);
+        s_->min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        s_->max.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return s_->total.load(std::memory_order_relaxed); }
+
+    /// Smallest and largest recorded values (exact; 0 when empty).
+    [[nodiscard]] uint64_t min() const noexcept {
+        return count() == 0 ? 0 : s_->min.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t max() const noexcept { return s_->max.load(std::memory_order_relaxed); }
+
+    /// Mean of the recorded values (exact up to uint64_t sum overflow).
+    [[nodiscard]] double mean() const noexcept {
+        const uint64_t n = count();
+        return n == 0 ? 0.0
+                      : static_cast<double>(s_->sum.load(std::memory_order_relaxed)) /
+                            static_cast<double>(n);
+    }
+
+    /// The value at rank floor(p * (count - 1)) of the sorted samples,
+    /// as the middle of its bucket clamped to [min, max]: exact below
+    /// 2 * SUB_BUCKETS, otherwise within half a bucket (the top bucket
+    /// reports max() once values above MAX_VALUE are in it). p in [0, 1].
+    [[nodiscard]] uint64_t value_at_percentile(double p) const noexcept {
+        const uint64_t n = count();
+        if (n == 0) return 0;
+        p = p < 0.0 ? 0.0 : (p > 1.0 ? 1.0 : p);
+        const auto rank = static_cast<uint64_t>(std::floor(p * static_cast<double>(n - 1)));
+
+        const uint64_t lo = min();
+        const uint64_t hi = max();
+        const size_t first = bucket_index(lo);
+        const size_t last = bucket_index(hi);
+        uint64_t seen = 0;
+        for (size_t i = first; i <= last; ++i) {
+            seen += s_->counts[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                if (hi > MAX_VALUE && i == BUCKET_COUNT - 1) return hi;   // Clamped values
+                const uint64_t low = bucket_lowest(i);
+                const uint64_t mid = low + (bucket_highest(i) - low) / 2;
+                return mid < lo ? lo : (mid > hi ? hi : mid);
+            }
+        }
+        return hi;   // Only reachable while another thread is recording
+    }
+
+    /// Samples counted in bucket i.
+    [[nodiscard]] uint64_t bucket_count(size_t i) const noexcept {
+        return s_->counts[i].load(std::memory_order_relaxed);
+    }
+
+    /// Bucket holding `value` (values above MAX_VALUE share the top bucket).
+    [[nodiscard]] static size_t bucket_index(uint64_t value) noexcept {
+        if (value > MAX_VALUE) value = MAX_VALUE;
+        if (value < 2 * SUB_BUCKETS) return static_cast<size_t>(value);
+        const unsigned shift = highest_bit(value) - SUB_BUCKET_BITS;
+        return static_cast<size_t>(shift * SUB_BUCKETS + (value >> shift));
+    }
+
+    /// Smallest and largest value counted in bucket i.
+    [[nodiscard]] static uint64_t bucket_lowest(size_t i) noexcept {
+        if (i < 2 * SUB_BUCKETS) return i;
+        const uint64_t shift = i / SUB_BUCKETS - 1;
+        return (i - shift * SUB_BUCKETS) << shift;
+    }
+    [[nodiscard]] static uint64_t bucket_highest(size_t i) noexcept {
+        if (i < 2 * SUB_BUCKETS) return i;
+        const uint64_t shift = i / SUB_BUCKETS - 1;
+        return bucket_lowest(i) + (uint64_t{1} << shift) - 1;
+    }
+
+private:
+    /// Single-writer increment: no locked RMW.
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    static unsigned highest_bit(uint64_t value) noexcept {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+
+    std::unique_ptr<Storage> owned_;   // Null with caller-placed storage
+    Storage* s_;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "HdrHistogram::Storage must be address-free to be shared");
+static_assert(std::is_standard_layout_v<HdrHistogram::Storage>,
+              "HdrHistogram::Storage must be standard layout");
+
+}  // namespace hft
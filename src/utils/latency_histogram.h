@@ -1,15 +1,15 @@
 #pragma once
 
-// latency_histogram.h — Collect individual latency samples and compute percentiles
+// latency_histogram.h — Latency percentiles from TSC tick samples
 //
-// Cold-path utility: uses std::vector and std::sort.
-// Records raw TSC tick deltas, converts to nanoseconds on compute().
+// Records raw TSC tick deltas into an HdrHistogram (fixed log-linear
+// buckets: constant memory, O(1) allocation-free record(), percentiles
+// without sorting) and converts to nanoseconds on compute().
 
-#include <algorithm>
-#include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <vector>
+
+#include "utils/hdr_histogram.h"
 
 namespace hft {
 
@@ -25,14 +25,15 @@ struct LatencyStats {
     size_t sample_count = 0;
 };
 
-/// Collects individual latency samples (in TSC ticks) and computes
-/// percentile statistics. Cold-path utility — uses std::vector and std::sort.
+/// Collects latency samples (in TSC ticks) and computes percentile
+/// statistics. min, max and mean are exact; percentiles are exact below
+/// 1024 ticks and within ~0.1% above (see hdr_histogram.h). One writer per
+/// instance; per-thread instances combine with merge().
 class LatencyHistogram {
 public:
-    explicit LatencyHistogram(size_t reserve_count = 1'000'000)
-        : tsc_per_ns_(1.0) {
-        samples_.reserve(reserve_count);
-    }
+    /// @param reserve_count Unused: storage is fixed. Kept so existing
+    ///                      callers sized for their sample count still build.
+    explicit LatencyHistogram([[maybe_unused]] size_t reserve_count = 0) : tsc_per_ns_(1.0) {}
 
     /// Set TSC-to-nanosecond conversion factor (from calibrate_tsc_frequency()).
     void set_tsc_frequency(double tsc_per_ns) { tsc_per_ns_ = tsc_per_ns; }
@@ -42,52 +43,47 @@ public:
 
     /// Record a single latency sample in raw TSC ticks.
     /// Overhead is subtracted automatically if set via set_overhead().
-    void record(uint64_t tsc_ticks) {
+    void record(uint64_t tsc_ticks) noexcept {
         uint64_t adjusted = (tsc_ticks > overhead_) ? tsc_ticks - overhead_ : 0;
-        samples_.push_back(adjusted);
+        ticks_.record(adjusted);
     }
 
-    /// Sort samples and compute percentile statistics.
+    /// Add another histogram's samples (already overhead-adjusted, in
+    /// ticks of the same TSC). `other` may still be recording.
+    void merge(const LatencyHistogram& other) noexcept { ticks_.merge(other.ticks_); }
+
+    /// Compute percentile statistics from the buckets.
     /// Returns all values converted to nanoseconds.
-    [[nodiscard]] LatencyStats compute() {
+    [[nodiscard]] LatencyStats compute() const {
         LatencyStats stats{};
-        stats.sample_count = samples_.size();
-        if (samples_.empty()) return stats;
-
-        std::sort(samples_.begin(), samples_.end());
-
-        stats.min_ns = to_ns(samples_.front());
-        stats.max_ns = to_ns(samples_.back());
-        stats.p50_ns = to_ns(percentile(0.50));
-        stats.p90_ns = to_ns(percentile(0.90));
-        stats.p99_ns = to_ns(percentile(0.99));
-        stats.p99_9_ns = to_ns(percentile(0.999));
-
-        double sum = 0.0;
-        for (auto s : samples_) sum += to_ns(s);
-        stats.mean_ns = sum / static_cast<double>(stats.sample_count);
-
+        stats.sample_count = static_cast<size_t>(ticks_.count());
+        if (stats.sample_count == 0) return stats;
+
+        stats.min_ns = to_ns(ticks_.min());
+        stats.max_ns = to_ns(ticks_.max());
+        stats.p50_ns = to_ns(ticks_.value_at_percentile(0.50));
+        stats.p90_ns = to_ns(ticks_.value_at_percentile(0.90));
+        stats.p99_ns = to_ns(ticks_.value_at_percentile(0.99));
+        stats.p99_9_ns = to_ns(ticks_.value_at_percentile(0.999));
+        stats.mean_ns = ticks_.mean() / tsc_per_ns_;
         return stats;
     }
 
     /// Discard all recorded samples.
-    void clear() { samples_.clear(); }
+    void clear() { ticks_.clear(); }
 
     /// Number of recorded samples.
-    [[nodiscard]] size_t size() const { return samples_.size(); }
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(ticks_.count()); }
+
+    /// The underlying tick histogram.
+    [[nodiscard]] const HdrHistogram& ticks() const { return ticks_; }
 
 private:
     [[nodiscard]] double to_ns(uint64_t ticks) const {
         return static_cast<double>(ticks) / tsc_per_ns_;
     }
 
-    [[nodiscard]] uint64_t percentile(double p) const {
-        size_t idx = static_cast<size_t>(
-            std::floor(p * static_cast<double>(samples_.size() - 1)));
-        return samples_[idx];
-    }
-
-    std::vector<uint64_t> samples_;
+    HdrHistogram ticks_;
     double tsc_per_ns_;
     uint64_t overhead_ = 0;
 };
@@ -0,0 +1,255 @@
+#pragma once
+
+// perf_counters.h — Hardware performance counters around benchmark regions
+//
+// Cold-path benchmark utility (perf_event_open, Linux only):
+//   PerfEvent          — cycles, instructions, L1D / LLC / dTLB load misses,
+//                        branch misses
+//   PerfCounterGroup   — opens the counters for the calling thread;
+//                        start() / pause() / resume() / stop() bracket a
+//                        region, stop() returns a PerfSample
+//   PerfSample         — counts per event, per_op() normalisation, IPC
+//
+// User-space only (exclude_kernel), so perf_event_paranoid <= 2 suffices.
+// The counters are opened as two groups that each fit the PMU on their
+// own — {cycles, instructions, branch misses} and {L1D, LLC, dTLB} — so
+// ratios within a group are exact; if the kernel multiplexes a group,
+// its counts are scaled by time enabled / time running. Events this CPU
+// or VM does not expose are left out (PerfSample::has() is false), and
+// where perf_event_open is unavailable altogether every sample is empty
+// and error() says why. Start / stop cost a few syscalls each: bracket
+// whole measurement loops, not single operations.
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace hft {
+
+enum class PerfEvent : uint8_t {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1DMisses,     // L1 data-cache load misses
+    LLCMisses,     // Last-level cache load misses
+    DTLBMisses     // Data TLB load misses
+};
+
+inline constexpr size_t PERF_EVENT_COUNT = 6;
+
+inline const char* perf_event_name(PerfEvent event) noexcept {
+    switch (event) {
+        case PerfEvent::Cycles:       return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::L1DMisses:    return "l1d_misses";
+        case PerfEvent::LLCMisses:    return "llc_misses";
+        case PerfEvent::DTLBMisses:   return "dtlb_misses";
+    }
+    return "unknown";
+}
+
+/// Counts of one region.
+struct PerfSample {
+    std::array<uint64_t, PERF_EVENT_COUNT> counts{};
+    uint32_t available = 0;   // Bit per PerfEvent that was counted
+
+    [[nodiscard]] bool has(PerfEvent event) const noexcept {
+        return (available >> static_cast<unsigned>(event)) & 1u;
+    }
+    [[nodiscard]] bool empty() const noexcept { return available == 0; }
+    [[nodiscard]] uint64_t operator[](PerfEvent event) const noexcept {
+        return counts[static_cast<size_t>(event)];
+    }
+    [[nodiscard]] double per_op(PerfEvent event, uint64_t ops) const noexcept {
+        return ops != 0 ? static_cast<double>((*this)[event]) / static_cast<double>(ops) : 0.0;
+    }
+    /// Instructions per cycle, 0 unless both were counted.
+    [[nodiscard]] double ipc() const noexcept {
+        if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) ||
+            (*this)[PerfEvent::Cycles] == 0) {
+            return 0.0;
+        }
+        return static_cast<double>((*this)[PerfEvent::Instructions]) /
+               static_cast<double>((*this)[PerfEvent::Cycles]);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// PerfCounterGroup
+// ---------------------------------------------------------------------------
+
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() { open(); }
+    ~PerfCounterGroup() { close(); }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    /// At least one event is counted.
+    [[nodiscard]] bool available() const noexcept { return available_ != 0; }
+    /// Why some or all events are missing (empty if all opened).
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+
+    /// Zero the counts and start counting the calling thread.
+    void start() noexcept {
+        control(reset_request());
+        control(enable_request());
+    }
+    /// Stop counting without losing the counts (e.g. around setup work).
+    void pause() noexcept { control(disable_request()); }
+    void resume() noexcept { control(enable_request()); }
+
+    /// Stop counting and return the counts since start().
+    PerfSample stop() noexcept {
+        control(disable_request());
+        PerfSample sample;
+#if defined(__linux__)
+        for (const Group& group : groups_) {
+            if (group.leader < 0) continue;
+            // PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+            uint64_t data[3 + GROUP_SIZE] = {};
+            if (::read(group.leader, data, sizeof(data)) < 0) continue;
+            const uint64_t nr = data[0];
+            const uint64_t enabled = data[1];
+            const uint64_t running = data[2];
+            if (running == 0) continue;   // Never scheduled onto the PMU
+            for (uint64_t i = 0; i < nr && i < group.count; ++i) {
+                uint64_t value = data[3 + i];
+                if (running < enabled) {
+                    value = static_cast<uint64_t>(static_cast<double>(value) *
+                                                  static_cast<double>(enabled) /
+                                                  static_cast<double>(running));
+                }
+                const auto event = static_cast<size_t>(group.events[i]);
+                sample.counts[event] = value;
+                sample.available |= 1u << event;
+            }
+        }
+#endif
+        return sample;
+    }
+
+private:
+    static constexpr size_t GROUP_SIZE = 3;
+
+    struct Group {
+        int leader = -1;
+        size_t count = 0;
+        std::array<int, GROUP_SIZE> fds{-1, -1, -1};
+        std::array<PerfEvent, GROUP_SIZE> events{};
+    };
+
+#if defined(__linux__)
+    static unsigned long reset_request() noexcept { return PERF_EVENT_IOC_RESET; }
+    static unsigned long enable_request() noexcept { return PERF_EVENT_IOC_ENABLE; }
+    static unsigned long disable_request() noexcept { return PERF_EVENT_IOC_DISABLE; }
+
+    static void describe(PerfEvent event, perf_event_attr& attr) noexcept {
+        constexpr uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        switch (event) {
+            case PerfEvent::Cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                return;
+            case PerfEvent::Instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                return;
+            case PerfEvent::BranchMisses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                return;
+            case PerfEvent::L1DMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | read_miss;
+                return;
+            case PerfEvent::LLCMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_LL | read_miss;
+                return;
+            case PerfEvent::DTLBMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB | read_miss;
+                return;
+        }
+    }
+
+    void open() {
+        static constexpr PerfEvent LAYOUT[2][GROUP_SIZE] = {
+            {PerfEvent::Cycles, PerfEvent::Instructions, PerfEvent::BranchMisses},
+            {PerfEvent::L1DMisses, PerfEvent::LLCMisses, PerfEvent::DTLBMisses}};
+        int first_errno = 0;
+        for (size_t g = 0; g < 2; ++g) {
+            Group& group = groups_[g];
+            for (PerfEvent event : LAYOUT[g]) {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                describe(event, attr);
+                attr.disabled = group.leader < 0 ? 1 : 0;   // Members follow the leader
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+                const int fd = static_cast<int>(
+                    ::syscall(SYS_perf_event_open, &attr, 0, -1, group.leader, 0));
+                if (fd < 0) {
+                    if (first_errno == 0) first_errno = errno;
+                    if (!error_.empty()) error_ += "; ";
+                    error_ += std::string(perf_event_name(event)) + ": " + std::strerror(errno);
+                    continue;
+                }
+                if (group.leader < 0) group.leader = fd;
+                group.fds[group.count] = fd;
+                group.events[group.count] = event;
+                ++group.count;
+                available_ |= 1u << static_cast<unsigned>(event);
+            }
+        }
+        if (available_ == 0 && first_errno != 0) {
+            error_ = std::string("perf_event_open: ") + std::strerror(first_errno) +
+                     (first_errno == ENOENT ? " (no hardware PMU, e.g. a VM)"
+                                            : " (see /proc/sys/kernel/perf_event_paranoid)");
+        }
+    }
+
+    void close() noexcept {
+        for (Group& group : groups_) {
+            for (size_t i = 0; i < group.count; ++i) ::close(group.fds[i]);
+            group = Group{};
+        }
+        available_ = 0;
+    }
+
+    void control(unsigned long request) noexcept {
+        for (const Group& group : groups_) {
+            if (group.leader >= 0) ::ioctl(group.leader, request, PERF_IOC_FLAG_GROUP);
+        }
+    }
+#else
+    static unsigned long reset_request() noexcept { return 0; }
+    static unsigned long enable_request() noexcept { return 0; }
+    static unsigned long disable_request() noexcept { return 0; }
+    void open() { error_ = "hardware counters need Linux perf_event_open"; }
+    void close() noexcept {}
+    void control(unsigned long) noexcept {}
+#endif
+
+    std::array<Group, 2> groups_{};
+    uint32_t available_ = 0;
+    std::string error_;
+};
+
+}  // namespace hft
@@ -0,0 +1,238 @@
+#pragma once
+
+// thread_placement.h — Core pinning, real-time priority and memory locking
+//
+// Cold-path utilities applied once per thread at startup:
+//   ThreadingConfig        — CPU list per thread role, mlockall, SCHED_FIFO
+//   lock_process_memory()  — mlockall(MCL_CURRENT | MCL_FUTURE) if requested
+//   ScopedThreadPlacement  — pin the calling thread for its role and index,
+//                            optionally SCHED_FIFO; restores both on exit
+//   thread_topology_report() — what every placed thread asked for and got
+//
+// Every placement is recorded in a process-wide table so engines can
+// print the resulting topology at startup. Linux only; elsewhere the
+// calls succeed without doing anything and the report says so.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace hft {
+
+/// What a thread does; selects its CPU list in ThreadingConfig.
+enum class ThreadRole : uint8_t {
+    Ingress,    // Feed parser / order entry
+    Matching,   // Matching thread, one per router shard
+    Publisher,  // Market data publisher
+    Analytics,
+    Journal,
+    Multicast   // Market data datagram sender
+};
+
+inline const char* thread_role_name(ThreadRole role) noexcept {
+    switch (role) {
+        case ThreadRole::Ingress:   return "ingress";
+        case ThreadRole::Matching:  return "matching";
+        case ThreadRole::Publisher: return "publisher";
+        case ThreadRole::Analytics: return "analytics";
+        case ThreadRole::Journal:   return "journal";
+        case ThreadRole::Multicast: return "multicast";
+    }
+    return "unknown";
+}
+
+/// Runtime thread placement. Empty CPU lists leave threads unpinned.
+struct ThreadingConfig {
+    std::vector<int> ingress_cpus;
+    std::vector<int> matching_cpus;    // Index = router shard
+    std::vector<int> publisher_cpus;
+    std::vector<int> analytics_cpus;
+    std::vector<int> journal_cpus;
+    std::vector<int> multicast_cpus;
+    bool lock_memory = false;          // mlockall current and future pages
+    bool realtime = false;             // SCHED_FIFO for placed threads
+    int realtime_priority = 10;        // 1..99 (needs CAP_SYS_NICE)
+
+    [[nodiscard]] const std::vector<int>& cpus(ThreadRole role) const noexcept {
+        switch (role) {
+            case ThreadRole::Ingress:   return ingress_cpus;
+            case ThreadRole::Matching:  return matching_cpus;
+            case ThreadRole::Publisher: return publisher_cpus;
+            case ThreadRole::Analytics: return analytics_cpus;
+            case ThreadRole::Journal:   return journal_cpus;
+            case ThreadRole::Multicast: return multicast_cpus;
+        }
+        return ingress_cpus;
+    }
+
+    /// CPU for the `index`-th thread of `role`, or -1 if not pinned.
+    [[nodiscard]] int cpu_for(ThreadRole role, size_t index = 0) const noexcept {
+        const std::vector<int>& list = cpus(role);
+        return index < list.size() ? list[index] : -1;
+    }
+
+    /// Whether anything is configured at all.
+    [[nodiscard]] bool any() const noexcept {
+        return lock_memory || realtime || !ingress_cpus.empty() ||
+               !matching_cpus.empty() || !publisher_cpus.empty() ||
+               !analytics_cpus.empty() || !journal_cpus.empty() ||
+               !multicast_cpus.empty();
+    }
+};
+
+/// One placed thread, as recorded for the topology report.
+struct ThreadPlacementRecord {
+    ThreadRole role;
+    size_t index;
+    long tid;            // Kernel thread id (0 off Linux)
+    int requested_cpu;   // -1 = not pinned
+    bool pinned;         // Affinity applied
+    bool realtime_requested;
+    bool realtime;       // SCHED_FIFO applied
+};
+
+namespace detail {
+
+struct ThreadTopology {
+    std::mutex mutex;
+    std::vector<ThreadPlacementRecord> threads;
+    int memory_locked = -1;  // -1 not requested, 0 failed, 1 locked
+};
+
+inline ThreadTopology& thread_topology() {
+    static ThreadTopology topology;
+    return topology;
+}
+
+}  // namespace detail
+
+/// Lock all current and future pages if config.lock_memory is set, so the
+/// hot path never takes a major fault. RLIMIT_MEMLOCK (ulimit -l) must
+/// cover the whole working set, or later allocations fail. @return false
+/// if locking failed.
+inline bool lock_process_memory(const ThreadingConfig& config) {
+    if (!config.lock_memory) return true;
+    bool ok = false;
+#if defined(__linux__)
+    ok = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#endif
+    auto& topology = detail::thread_topology();
+    std::lock_guard<std::mutex> lock(topology.mutex);
+    topology.memory_locked = ok ? 1 : 0;
+    return ok;
+}
+
+/// Places the calling thread for its lifetime: pins it to the role's CPU
+/// and, if configured, switches it to SCHED_FIFO. Both are restored on
+/// destruction. Failures (no such CPU, no CAP_SYS_NICE) leave the thread
+/// as it was and show in the report.
+class ScopedThreadPlacement {
+public:
+    ScopedThreadPlacement(const ThreadingConfig& config, ThreadRole role,
+                          size_t index = 0) {
+        ThreadPlacementRecord record{role, index, 0, config.cpu_for(role, index),
+                                     false, config.realtime, false};
+#if defined(__linux__)
+        pthread_t self = pthread_self();
+        record.tid = static_cast<long>(syscall(SYS_gettid));
+        if (record.requested_cpu >= 0 &&
+            pthread_getaffinity_np(self, sizeof(saved_cpus_), &saved_cpus_) == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(record.requested_cpu, &set);
+            pinned_ = pthread_setaffinity_np(self, sizeof(set), &set) == 0;
+        }
+        if (config.realtime &&
+            pthread_getschedparam(self, &saved_policy_, &saved_param_) == 0) {
+            sched_param param{};
+            param.sched_priority = config.realtime_priority;
+            realtime_ = pthread_setschedparam(self, SCHED_FIFO, &param) == 0;
+        }
+#endif
+        record.pinned = pinned_;
+        record.realtime = realtime_;
+        auto& topology = detail::thread_topology();
+        std::lock_guard<std::mutex> lock(topology.mutex);
+        topology.threads.push_back(record);
+    }
+
+    ~ScopedThreadPlacement() {
+#if defined(__linux__)
+        pthread_t self = pthread_self();
+        if (realtime_) pthread_setschedparam(self, saved_policy_, &saved_param_);
+        if (pinned_) pthread_setaffinity_np(self, sizeof(saved_cpus_), &saved_cpus_);
+#endif
+    }
+
+    ScopedThreadPlacement(const ScopedThreadPlacement&) = delete;
+    ScopedThreadPlacement& operator=(const ScopedThreadPlacement&) = delete;
+
+    [[nodiscard]] bool pinned() const noexcept { return pinned_; }
+    [[nodiscard]] bool realtime() const noexcept { return realtime_; }
+
+private:
+#if defined(__linux__)
+    cpu_set_t saved_cpus_{};
+    int saved_policy_ = SCHED_OTHER;
+    sched_param saved_param_{};
+#endif
+    bool pinned_ = false;
+    bool realtime_ = false;
+};
+
+/// Every placement recorded so far.
+inline std::vector<ThreadPlacementRecord> thread_topology_records() {
+    auto& topology = detail::thread_topology();
+    std::lock_guard<std::mutex> lock(topology.mutex);
+    return topology.threads;
+}
+
+/// Forget recorded placements (e.g. between replays).
+inline void clear_thread_topology() {
+    auto& topology = detail::thread_topology();
+    std::lock_guard<std::mutex> lock(topology.mutex);
+    topology.threads.clear();
+}
+
+/// Human-readable table of the recorded placements and the memory lock.
+inline std::string thread_topology_report() {
+    auto& topology = detail::thread_topology();
+    std::lock_guard<std::mutex> lock(topology.mutex);
+    std::ostringstream out;
+#if defined(__linux__)
+    out << "  Online CPUs: " << sysconf(_SC_NPROCESSORS_ONLN) << "\n";
+#else
+    out << "  Thread placement unsupported on this platform\n";
+#endif
+    out << "  Memory lock: "
+        << (topology.memory_locked < 0 ? "off"
+            : topology.memory_locked ? "locked" : "FAILED")
+        << "\n";
+    for (const ThreadPlacementRecord& r : topology.threads) {
+        out << "  " << thread_role_name(r.role) << "[" << r.index << "]"
+            << " tid " << r.tid << ": ";
+        if (r.requested_cpu < 0) {
+            out << "unpinned";
+        } else {
+            out << "cpu " << r.requested_cpu << (r.pinned ? "" : " (FAILED)");
+        }
+        if (r.realtime_requested) {
+            out << (r.realtime ? ", SCHED_FIFO" : ", SCHED_FIFO (FAILED)");
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+}  // namespace hft
@@ -0,0 +1,235 @@
+#pragma once
+
+// trace.h — Per-stage latency tracepoints for sampled orders
+//
+// Each pipeline stage an order passes through (parse, gateway validation,
+// pool allocation, match, event publication, publisher dispatch) can be
+// bracketed with HFT_TRACE_BEGIN / HFT_TRACE_END. For a sampled order the
+// pair stamps rdtsc_start() / rdtsc_end() and pushes one TraceRecord into
+// the calling thread's TraceRing; trace_report.h turns the records back
+// into per-order stage breakdowns and histograms.
+//
+// Compile-time switch: the macros expand to nothing unless HFT_TRACE is
+// defined (CMake option HFT_ENABLE_TRACE), so a default build carries no
+// code, no branch and no state for them. With it defined, tracing is off
+// at run time until set_trace_sampling(N) picks 1 in N orders (order_id %
+// N == 0, so every stage of an order agrees without passing a flag); an
+// unsampled stage costs one relaxed load and a modulo.
+//
+// Rings are single-producer / single-consumer: the owning thread pushes
+// (dropping the record and counting it when the ring is full), and one
+// collector drains. A thread's ring is created on its first sampled
+// record (one allocation per thread) and outlives the thread. Timestamps
+// are compared across threads, which assumes an invariant, synchronized
+// TSC (any modern x86 server).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "utils/clock.h"
+
+namespace hft {
+
+/// Pipeline stages, in the order an order passes through them.
+enum class TraceStage : uint8_t {
+    Parse,               // Feed record -> OrderMessage
+    GatewayValidate,     // Gateway checks (quantity, price, risk)
+    PoolAllocate,        // MemoryPool<Order>::allocate()
+    Match,               // Matching engine call (its trades are published inside)
+    EventPublish,        // Status events into the event ring
+    PublisherDispatch    // One event through the publisher's callbacks
+};
+
+inline constexpr size_t TRACE_STAGE_COUNT = 6;
+
+/// Short stage name ("parse", "validate", ...).
+[[nodiscard]] inline const char* trace_stage_name(TraceStage stage) noexcept {
+    switch (stage) {
+        case TraceStage::Parse: return "parse";
+        case TraceStage::GatewayValidate: return "validate";
+        case TraceStage::PoolAllocate: return "pool_allocate";
+        case TraceStage::Match: return "match";
+        case TraceStage::EventPublish: return "publish";
+        case TraceStage::PublisherDispatch: return "dispatch";
+    }
+    return "unknown";
+}
+
+/// Key of records that are never sampled (events without an order).
+inline constexpr uint64_t TRACE_NO_KEY = UINT64_MAX;
+
+/// One stage of one sampled order.
+struct TraceRecord {
+    uint64_t key;          // Order id
+    uint64_t start_tsc;
+    uint64_t end_tsc;
+    uint64_t sequence;     // EventPublish: first event sequence; PublisherDispatch: the event's
+    uint32_t events;       // EventPublish: events published for the order (from `sequence`)
+    uint16_t thread;       // TraceRegistry ring index
+    TraceStage stage;
+    uint8_t pad_;
+};
+
+static_assert(sizeof(TraceRecord) == 40, "TraceRecord must be 40 bytes");
+
+/// Fixed-capacity SPSC ring of one thread's trace records.
+class TraceRing {
+public:
+    static constexpr size_t CAPACITY = size_t{1} << 16;   // 2.5 MB
+
+    explicit TraceRing(uint16_t thread) : records_(new TraceRecord[CAPACITY]), thread_(thread) {}
+
+    /// Owning thread only. Drops (and counts) the record when full.
+    void push(const TraceRecord& record) noexcept {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= CAPACITY) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+            return;
+        }
+        TraceRecord& slot = records_[head & (CAPACITY - 1)];
+        slot = record;
+        slot.thread = thread_;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /// Collector only: append the pending records to `out`.
+    size_t drain(std::vector<TraceRecord>& out) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; ++i) out.push_back(records_[i & (CAPACITY - 1)]);
+        tail_.store(head, std::memory_order_release);
+        return static_cast<size_t>(head - tail);
+    }
+
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint16_t thread() const noexcept { return thread_; }
+
+private:
+    std::unique_ptr<TraceRecord[]> records_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint16_t thread_;
+};
+
+/// Process-wide sampling rate and the set of per-thread rings.
+class TraceRegistry {
+public:
+    [[nodiscard]] static TraceRegistry& instance() {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    /// Trace 1 in `every` orders (0 = off).
+    void set_sample_every(uint64_t every) noexcept {
+        sample_every_.store(every, std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t sample_every() const noexcept {
+        return sample_every_.load(std::memory_order_relaxed);
+    }
+
+    /// The calling thread's ring, created on first use.
+    [[nodiscard]] TraceRing& ring() {
+        thread_local TraceRing* ring = nullptr;
+        if (ring == nullptr) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(std::make_unique<TraceRing>(static_cast<uint16_t>(rings_.size())));
+            ring = rings_.back().get();
+        }
+        return *ring;
+    }
+
+    /// Move every ring's pending records into `out`; returns how many.
+    size_t drain(std::vector<TraceRecord>& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t n = 0;
+        for (auto& ring : rings_) n += ring->drain(out);
+        return n;
+    }
+
+    /// Records dropped on full rings, over all threads.
+    [[nodiscard]] uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t n = 0;
+        for (const auto& ring : rings_) n += ring->dropped();
+        return n;
+    }
+
+private:
+    TraceRegistry() = default;
+
+    std::atomic<uint64_t> sample_every_{0};
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<TraceRing>> rings_;
+};
+
+/// Set the process-wide sampling rate (1 in `every` orders; 0 = off).
+inline void set_trace_sampling(uint64_t every) noexcept {
+    TraceRegistry::instance().set_sample_every(every);
+}
+
+/// Whether stages of order `key` are recorded. Key 0 is sampled whenever
+/// tracing is on (a stage that starts before its order is known).
+[[nodiscard]] inline bool trace_sampled(uint64_t key) noexcept {
+    const uint64_t every = TraceRegistry::instance().sample_every();
+    return every != 0 && key != TRACE_NO_KEY && key % every == 0;
+}
+
+/// Start stamp of a stage of `key` (0 = not sampled).
+[[nodiscard]] inline uint64_t trace_begin(uint64_t key) noexcept {
+    return trace_sampled(key) ? rdtsc_start() : 0;
+}
+
+/// Record a stage of `key` stamped [start_tsc, end_tsc] (no-op unless
+/// both stamps were taken and `key` is sampled).
+inline void trace_span(TraceStage stage, uint64_t key, uint64_t start_tsc, uint64_t end_tsc,
+                       uint64_t sequence = 0, uint32_t events = 0) noexcept {
+    if (start_tsc == 0 || end_tsc == 0 || !trace_sampled(key)) return;
+    TraceRegistry::instance().ring().push(
+        TraceRecord{key, start_tsc, end_tsc, sequence, events, 0, stage, 0});
+}
+
+/// Close a stage opened by trace_begin() now.
+inline void trace_end(TraceStage stage, uint64_t key, uint64_t start_tsc,
+                      uint64_t sequence = 0, uint32_t events = 0) noexcept {
+    if (start_tsc == 0) return;
+    trace_span(stage, key, start_tsc, rdtsc_end(), sequence, events);
+}
+
+}  // namespace hft
+
+// ---------------------------------------------------------------------------
+// Tracepoint macros
+// ---------------------------------------------------------------------------
+//
+//   HFT_TRACE_LET(var, expr)        const var = expr, kept only for tracing
+//   HFT_TRACE_BEGIN(var, key)       stamp the start of a stage of `key`
+//                                   (key 0: whenever tracing is on)
+//   HFT_TRACE_END(stage, key, var)  stamp its end and record it
+//   HFT_TRACE_END_EVENTS(stage, key, var, first_sequence, count)
+//                                   ... with the events it published
+//   HFT_TRACE_SPAN(stage, key, begin_var, end_var)
+//                                   record a stage between two stamps
+
+#if defined(HFT_TRACE)
+#define HFT_TRACE_LET(var, expr) [[maybe_unused]] const uint64_t var = (expr)
+#define HFT_TRACE_BEGIN(var, key) const uint64_t var = ::hft::trace_begin(key)
+#define HFT_TRACE_END(stage, key, var) ::hft::trace_end((stage), (key), (var))
+#define HFT_TRACE_END_EVENTS(stage, key, var, first_sequence, count) \
+    ::hft::trace_end((stage), (key), (var), (first_sequence), static_cast<uint32_t>(count))
+#define HFT_TRACE_SPAN(stage, key, begin_var, end_var) \
+    ::hft::trace_span((stage), (key), (begin_var), (end_var))
+#else
+#define HFT_TRACE_LET(var, expr) static_cast<void>(0)
+#define HFT_TRACE_BEGIN(var, key) static_cast<void>(0)
+#define HFT_TRACE_END(stage, key, var) static_cast<void>(0)
+#define HFT_TRACE_END_EVENTS(stage, key, var, first_sequence, count) static_cast<void>(0)
+#define HFT_TRACE_SPAN(stage, key, begin_var, end_var) static_cast<void>(0)
+#endif
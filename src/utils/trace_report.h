@@ -0,0 +1,201 @@
+#pragma once
+
+// trace_report.h — Per-order stage breakdowns from trace records
+//
+// Cold-path utility: uses std::vector, std::sort and std::unordered_map.
+// reconstruct_order_traces() groups the records collected from the trace
+// rings (trace.h) into one OrderTrace per message an order sent through
+// the pipeline; summarize_order_traces() feeds each stage, the end-to-end
+// time and the time between stages (queueing) into LatencyHistograms.
+//
+// Records of one order id are split into messages (an add and a later
+// cancel of the same order): each Parse starts one, and the gateway
+// stages, which run back to back per message, form a group that takes the
+// id's oldest unclaimed parse, as messages of one order reach the gateway
+// in feed order however far ahead the parser thread runs. Dispatch
+// records find their message by event sequence number, within the range
+// its EventPublish record covers, so they land correctly even when the
+// publisher runs behind on another thread.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/latency_histogram.h"
+#include "utils/trace.h"
+
+namespace hft {
+
+/// One message of one sampled order, stage by stage (TSC ticks).
+struct OrderTrace {
+    uint64_t order_id = 0;
+    uint64_t start_tsc = 0;                          // Earliest stage start
+    uint64_t end_tsc = 0;                            // Latest stage end
+    std::array<uint64_t, TRACE_STAGE_COUNT> stage_ticks{};   // Summed per stage
+    uint8_t stages = 0;                              // Bit per TraceStage seen
+    uint64_t first_sequence = 0;                     // Events published, if any
+    uint32_t events = 0;
+    uint32_t events_dispatched = 0;
+
+    [[nodiscard]] bool has(TraceStage stage) const noexcept {
+        return (stages & (1u << static_cast<unsigned>(stage))) != 0;
+    }
+    [[nodiscard]] uint64_t ticks(TraceStage stage) const noexcept {
+        return stage_ticks[static_cast<size_t>(stage)];
+    }
+    [[nodiscard]] uint64_t total_ticks() const noexcept { return end_tsc - start_tsc; }
+    /// End-to-end time not spent in any stage: waiting in rings between them.
+    [[nodiscard]] uint64_t queue_ticks() const noexcept {
+        uint64_t in_stages = 0;
+        for (uint64_t t : stage_ticks) in_stages += t;
+        return in_stages < total_ticks() ? total_ticks() - in_stages : 0;
+    }
+};
+
+/// Rebuild per-message traces from `records` (any order, any threads).
+/// Returns them ordered by start time.
+[[nodiscard]] inline std::vector<OrderTrace> reconstruct_order_traces(
+    std::vector<TraceRecord> records) {
+    std::sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.start_tsc < b.start_tsc;
+    });
+
+    std::vector<OrderTrace> traces;
+    std::unordered_map<uint64_t, std::deque<size_t>> parsed;   // Parsed, not yet at the gateway
+    std::unordered_map<uint64_t, size_t> at_gateway;           // Latest gateway message, per id
+    std::unordered_map<uint64_t, std::vector<size_t>> by_key;  // Traces with events, per id
+
+    auto add_stage = [](OrderTrace& trace, const TraceRecord& r) {
+        if (trace.stages == 0 || r.start_tsc < trace.start_tsc) trace.start_tsc = r.start_tsc;
+        trace.end_tsc = std::max(trace.end_tsc, r.end_tsc);
+        trace.stage_ticks[static_cast<size_t>(r.stage)] += r.end_tsc - r.start_tsc;
+        trace.stages |= static_cast<uint8_t>(1u << static_cast<unsigned>(r.stage));
+    };
+    auto new_trace = [&traces](uint64_t key) {
+        traces.emplace_back();
+        traces.back().order_id = key;
+        return traces.size() - 1;
+    };
+
+    for (const TraceRecord& r : records) {
+        if (r.stage == TraceStage::PublisherDispatch) continue;
+        if (r.stage == TraceStage::Parse) {
+            const size_t index = new_trace(r.key);
+            add_stage(traces[index], r);
+            parsed[r.key].push_back(index);
+            continue;
+        }
+        // Gateway stages run back to back per message: this one or a later
+        // one already seen means the next message, which takes the oldest
+        // parse of the id still waiting (or stands alone without one)
+        auto open = at_gateway.find(r.key);
+        if (open == at_gateway.end() ||
+            (traces[open->second].stages >> static_cast<unsigned>(r.stage)) != 0) {
+            std::deque<size_t>& waiting = parsed[r.key];
+            size_t index;
+            if (waiting.empty()) {
+                index = new_trace(r.key);
+            } else {
+                index = waiting.front();
+                waiting.pop_front();
+            }
+            open = at_gateway.insert_or_assign(r.key, index).first;
+        }
+        OrderTrace& trace = traces[open->second];
+        add_stage(trace, r);
+        if (r.stage == TraceStage::EventPublish && r.events != 0) {
+            trace.first_sequence = r.sequence;
+            trace.events = r.events;
+            by_key[r.key].push_back(open->second);
+        }
+    }
+
+    for (const TraceRecord& r : records) {
+        if (r.stage != TraceStage::PublisherDispatch) continue;
+        auto it = by_key.find(r.key);
+        if (it == by_key.end()) continue;   // Its message's publish record was lost
+        for (size_t index : it->second) {
+            OrderTrace& trace = traces[index];
+            if (r.sequence >= trace.first_sequence &&
+                r.sequence < trace.first_sequence + trace.events) {
+                add_stage(trace, r);
+                ++trace.events_dispatched;
+                break;
+            }
+        }
+    }
+
+    std::stable_sort(traces.begin(), traces.end(), [](const OrderTrace& a, const OrderTrace& b) {
+        return a.start_tsc < b.start_tsc;
+    });
+    return traces;
+}
+
+/// Latency distribution per stage, end to end and between stages.
+struct TraceSummary {
+    size_t orders = 0;                                 // Traces summarized
+    std::array<LatencyStats, TRACE_STAGE_COUNT> stages{};
+    LatencyStats total{};
+    LatencyStats queue{};
+};
+
+/// Histogram every trace's stages (those it has), total and queue time.
+[[nodiscard]] inline TraceSummary summarize_order_traces(const std::vector<OrderTrace>& traces,
+                                                         double tsc_per_ns) {
+    std::array<LatencyHistogram, TRACE_STAGE_COUNT> stages;
+    LatencyHistogram total;
+    LatencyHistogram queue;
+    for (auto& h : stages) h.set_tsc_frequency(tsc_per_ns);
+    total.set_tsc_frequency(tsc_per_ns);
+    queue.set_tsc_frequency(tsc_per_ns);
+
+    for (const OrderTrace& trace : traces) {
+        for (size_t s = 0; s < TRACE_STAGE_COUNT; ++s) {
+            if (trace.has(static_cast<TraceStage>(s))) stages[s].record(trace.stage_ticks[s]);
+        }
+        total.record(trace.total_ticks());
+        queue.record(trace.queue_ticks());
+    }
+
+    TraceSummary summary;
+    summary.orders = traces.size();
+    for (size_t s = 0; s < TRACE_STAGE_COUNT; ++s) summary.stages[s] = stages[s].compute();
+    summary.total = total.compute();
+    summary.queue = queue.compute();
+    return summary;
+}
+
+/// One CSV line per trace: order_id, start_tsc, one ns column per stage
+/// (empty where the trace lacks it), queue_ns, total_ns, events.
+inline void write_order_traces_csv(std::ostream& out, const std::vector<OrderTrace>& traces,
+                                   double tsc_per_ns) {
+    out << "order_id,start_tsc";
+    for (size_t s = 0; s < TRACE_STAGE_COUNT; ++s) {
+        out << "," << trace_stage_name(static_cast<TraceStage>(s)) << "_ns";
+    }
+    out << ",queue_ns,total_ns,events\n";
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    auto ns = [tsc_per_ns](uint64_t ticks) { return static_cast<double>(ticks) / tsc_per_ns; };
+    for (const OrderTrace& trace : traces) {
+        out << trace.order_id << "," << trace.start_tsc;
+        for (size_t s = 0; s < TRACE_STAGE_COUNT; ++s) {
+            out << ",";
+            if (trace.has(static_cast<TraceStage>(s))) out << ns(trace.stage_ticks[s]);
+        }
+        out << "," << ns(trace.queue_ticks()) << "," << ns(trace.total_ticks()) << ","
+            << trace.events << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // namespace hft
@@ -4,22 +4,38 @@
 #include <cmath>
 #include <cstdint>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
 #include "analytics/analytics_config.h"
 #include "analytics/analytics_engine.h"
+#include "analytics/analytics_thread.h"
+#include "analytics/bar_aggregator.h"
+#include "analytics/batch_analytics.h"
 #include "analytics/depth_profile.h"
+#include "analytics/market_view.h"
 #include "analytics/microprice_calculator.h"
+#include "analytics/multi_instrument_analytics.h"
 #include "analytics/order_flow_imbalance.h"
 #include "analytics/price_impact.h"
 #include "analytics/realized_volatility.h"
+#include "analytics/sample_gate.h"
+#include "analytics/rolling_window.h"
 #include "analytics/spread_analytics.h"
+#include "analytics/time_series_columns.h"
 #include "core/types.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "gateway/order_gateway.h"
+#include "matching/matching_engine.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
+#include "transport/event_buffer.h"
 #include "transport/message.h"
 
 using namespace hft;
@@ -109,6 +125,25 @@ Order* place_sell(OrderBook& book, MemoryPool<Order>& pool,
     return o;
 }
 
+/// Build a GTC limit add for an OrderGateway.
+OrderMessage make_limit_msg(OrderId id, Side side, Price price, Quantity qty) {
+    OrderMessage msg{};
+    msg.type = MessageType::Add;
+    msg.instrument_id = DEFAULT_INSTRUMENT_ID;
+    msg.order.order_id = id;
+    msg.order.participant_id = 1;
+    msg.order.instrument_id = DEFAULT_INSTRUMENT_ID;
+    msg.order.side = side;
+    msg.order.type = OrderType::Limit;
+    msg.order.time_in_force = TimeInForce::GTC;
+    msg.order.status = OrderStatus::New;
+    msg.order.price = price;
+    msg.order.quantity = qty;
+    msg.order.visible_quantity = qty;
+    msg.order.timestamp = 1000;
+    return msg;
+}
+
 }  // namespace
 
 // ============================================================================
@@ -336,6 +371,30 @@ TEST_F(MicropriceTest, JsonOutput) {
     EXPECT_TRUE(j["valid"].get<bool>());
 }
 
+// ============================================================================
+// RollingWindow tests
+// ============================================================================
+
+TEST(RollingWindowTest, SlidesThroughAPowerOfTwoRing) {
+    RollingWindow<int> w(5);
+    EXPECT_EQ(w.capacity(), 8u);
+    EXPECT_TRUE(w.empty());
+
+    // Keep the last 5 of 0..19, evicting first as the modules do
+    for (int i = 0; i < 20; ++i) {
+        if (w.size() >= 5) w.pop_front();
+        w.push_back(i);
+    }
+    ASSERT_EQ(w.size(), 5u);
+    EXPECT_EQ(w.front(), 15);
+    EXPECT_EQ(w.back(), 19);
+    for (size_t i = 0; i < w.size(); ++i) EXPECT_EQ(w[i], 15 + static_cast<int>(i));
+
+    w.clear();
+    EXPECT_TRUE(w.empty());
+    EXPECT_EQ(RollingWindow<int>(0).capacity(), 1u);
+}
+
 // ============================================================================
 // OrderFlowImbalance tests
 // ============================================================================
@@ -681,6 +740,79 @@ TEST_F(DepthProfileTest, JsonOutput) {
     EXPECT_TRUE(j.contains("snapshot_count"));
 }
 
+TEST_F(DepthProfileTest, AveragesWeightSlotsBySnapshots) {
+    Order* first = place_buy(book, pool, 1, 150 * PRICE_SCALE, 10);
+    DepthProfile dp(2);
+    auto event = make_accepted(9, 150 * PRICE_SCALE);
+    dp.on_event(event, book);
+    dp.on_event(event, book);
+
+    // A better level pushes the first one to slot 1 for the third snapshot
+    place_buy(book, pool, 2, 151 * PRICE_SCALE, 30);
+    dp.on_event(event, book);
+    EXPECT_DOUBLE_EQ(dp.avg_bid_depth(0), 50.0 / 3.0);
+    EXPECT_DOUBLE_EQ(dp.avg_bid_depth(1), 10.0 / 3.0);
+
+    (void)book.cancel_order(first->order_id);
+    dp.on_event(event, book);
+    EXPECT_DOUBLE_EQ(dp.avg_bid_depth(0), 80.0 / 4.0);
+    EXPECT_DOUBLE_EQ(dp.avg_bid_depth(1), 10.0 / 4.0);
+    EXPECT_DOUBLE_EQ(dp.avg_ask_depth(0), 0.0);
+    EXPECT_EQ(dp.snapshot_count(), 4u);
+}
+
+TEST(DepthProfileLevelUpdateTest, TracksScannedDepthFromDeltas) {
+    OrderBookOptions opts;
+    opts.level_deltas = LevelDeltaMode::Conflated;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 4096, opts);
+    MemoryPool<Order> pool(4096);
+    MatchingEngine engine(book, pool);
+    EventBuffer buffer;
+    OrderGateway gateway(engine, pool, &buffer);
+
+    constexpr size_t LEVELS = 5;
+    DepthProfile scanned(LEVELS);
+    DepthProfile incremental(LEVELS, true);
+
+    // Adds around the touch on 12 levels a side (some crossing), cancels
+    uint64_t state = 12345;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    };
+    std::vector<OrderId> live;
+    OrderId next_id = 1;
+    for (int step = 0; step < 3000; ++step) {
+        if (live.size() > 40 && next() % 3 == 0) {
+            // Orders filled since are no longer live; their cancel fails
+            const size_t pick = next() % live.size();
+            (void)gateway.process_cancel(live[pick]);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            const Side side = (next() & 1) ? Side::Buy : Side::Sell;
+            const auto offset = static_cast<Price>(next() % 12) * TICK;
+            const Price price = side == Side::Buy ? 150 * PRICE_SCALE - offset + TICK
+                                                  : 150 * PRICE_SCALE + offset;
+            const OrderMessage msg = make_limit_msg(next_id, side, price, 1 + next() % 20);
+            if (gateway.process_order(msg).accepted) live.push_back(next_id);
+            ++next_id;
+        }
+
+        EventMessage event{};
+        while (buffer.try_pop(event)) {
+            scanned.on_event(event, book);
+            incremental.on_event(event, book);
+        }
+        ASSERT_EQ(incremental.bid_depth(), scanned.bid_depth()) << "step " << step;
+        ASSERT_EQ(incremental.ask_depth(), scanned.ask_depth()) << "step " << step;
+        ASSERT_DOUBLE_EQ(incremental.depth_imbalance(), scanned.depth_imbalance());
+    }
+
+    EXPECT_LT(incremental.rescans() * 10, scanned.rescans());
+    EXPECT_LT(incremental.snapshot_count(), scanned.snapshot_count());
+}
+
 // ============================================================================
 // AnalyticsEngine tests
 // ============================================================================
@@ -856,6 +988,604 @@ TEST_F(AnalyticsEngineTest, LeeReadyTickTest) {
     EXPECT_NEAR(engine.order_flow().current_imbalance(), 0.0, 0.01);
 }
 
+TEST_F(AnalyticsEngineTest, CarriedAggressorOverridesTickTest) {
+    place_buy(book, pool, 100, 150 * PRICE_SCALE, 100);
+    place_sell(book, pool, 200, 151 * PRICE_SCALE, 100);
+
+    AnalyticsEngine engine(book);
+    engine.on_event(make_accepted(1, 150 * PRICE_SCALE));
+
+    // Below mid, but the engine says a buyer lifted it
+    auto trade = make_trade(book.mid_price() - TICK, 10, 1, 1000);
+    Trade carried = event_trade(trade);
+    carried.flags = TRADE_AGGRESSOR;
+    carried.aggressor_side = Side::Buy;
+    set_trade(trade, carried);
+    engine.on_event(trade);
+    EXPECT_GT(engine.order_flow().current_imbalance(), 0.0);
+}
+
+// ============================================================================
+// Sampling gates
+// ============================================================================
+
+TEST(SampleGateTest, TriggersSelectEvents) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 100);
+    MemoryPool<Order> pool(100);
+    const MarketView view(book);
+
+    // Accepted, accepted, trade, repeated
+    auto event_at = [](uint64_t i) {
+        return (i % 3 == 2) ? make_trade(150 * PRICE_SCALE, 1, i, 100 * i)
+                            : make_accepted(i, 150 * PRICE_SCALE, i, 100 * i);
+    };
+    auto admitted = [&](const SampleConfig& config, uint64_t events) {
+        SampleGate gate(config);
+        std::vector<uint64_t> seqs;
+        for (uint64_t i = 0; i < events; ++i) {
+            if (gate.admit(event_at(i), view)) seqs.push_back(i);
+        }
+        EXPECT_EQ(gate.admitted() + gate.skipped(), events);
+        return seqs;
+    };
+
+    EXPECT_EQ(admitted({}, 6).size(), 6u);
+    EXPECT_EQ(admitted({SampleTrigger::Trades, 1, true}, 9), (std::vector<uint64_t>{2, 5, 8}));
+    EXPECT_EQ(admitted({SampleTrigger::EveryNth, 4, false}, 12),
+              (std::vector<uint64_t>{3, 7, 11}));
+    EXPECT_EQ(admitted({SampleTrigger::EveryNth, 4, true}, 12),
+              (std::vector<uint64_t>{2, 3, 5, 7, 8, 11}));
+    // 100 ns per event, 250 ns buckets: the first event of each bucket
+    EXPECT_EQ(admitted({SampleTrigger::Interval, 250, false}, 10),
+              (std::vector<uint64_t>{0, 3, 5, 8}));
+
+    // BBO change: admitted on the first event and after each book change
+    SampleGate bbo({SampleTrigger::BboChange, 1, false});
+    EXPECT_TRUE(bbo.admit(event_at(0), view));
+    EXPECT_FALSE(bbo.admit(event_at(1), view));
+    EXPECT_FALSE(bbo.admit(event_at(2), view));
+    place_buy(book, pool, 1, 149 * PRICE_SCALE, 10);
+    EXPECT_TRUE(bbo.admit(event_at(3), view));
+    EXPECT_FALSE(bbo.admit(event_at(4), view));
+    place_buy(book, pool, 2, 149 * PRICE_SCALE, 5);   // Same price, more quantity
+    EXPECT_TRUE(bbo.admit(event_at(5), view));
+}
+
+TEST(SampleGateTest, EngineSkipsModulesOutsideTheirTrigger) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 100);
+    MemoryPool<Order> pool(100);
+    place_buy(book, pool, 1, 150 * PRICE_SCALE, 10);
+    place_sell(book, pool, 2, 151 * PRICE_SCALE, 10);
+
+    AnalyticsConfig config;
+    config.depth_sampling = {SampleTrigger::EveryNth, 10, false};
+    config.spread_sampling = {SampleTrigger::Trades, 1, true};
+    AnalyticsEngine sampled(book, config);
+    AnalyticsEngine full(book);
+
+    for (uint64_t i = 0; i < 100; ++i) {
+        const EventMessage event = (i % 4 == 3) ? make_trade(151 * PRICE_SCALE, 1, i, 10 * i)
+                                                : make_accepted(i, 150 * PRICE_SCALE, i, 10 * i);
+        sampled.on_event(event);
+        full.on_event(event);
+    }
+    EXPECT_EQ(sampled.depth().snapshot_count(), 10u);
+    EXPECT_EQ(full.depth().snapshot_count(), 100u);
+    EXPECT_EQ(sampled.depth_gate().skipped(), 90u);
+    EXPECT_EQ(sampled.spread().to_json()["spread_samples"], 25);
+    // The book did not move, so sampled results equal the full ones
+    EXPECT_DOUBLE_EQ(sampled.depth().depth_imbalance(), full.depth().depth_imbalance());
+    EXPECT_DOUBLE_EQ(sampled.spread().avg_effective_spread_bps(),
+                     full.spread().avg_effective_spread_bps());
+    // Unsampled modules see everything
+    EXPECT_EQ(sampled.order_flow().sample_count(), full.order_flow().sample_count());
+    EXPECT_EQ(sampled.microprice_gate().skipped(), 0u);
+}
+
+// ============================================================================
+// Bar aggregation
+// ============================================================================
+
+class BarAggregatorTest : public ::testing::Test {
+protected:
+    OrderBook book{MIN_PRICE, MAX_PRICE, TICK, 1000};
+    MemoryPool<Order> pool{1000};
+    std::vector<Bar> bars;
+
+    BarSink collect() {
+        return [this](const Bar& bar) { bars.push_back(bar); };
+    }
+};
+
+TEST_F(BarAggregatorTest, TimeBarsBucketTradeTimeAndSkipGaps) {
+    place_buy(book, pool, 100, 150 * PRICE_SCALE, 100);
+    place_sell(book, pool, 200, 151 * PRICE_SCALE, 100);
+    BarAggregator agg({BarType::Time, 1000}, collect());
+
+    // Bucket [1000, 2000): three trades; [2000, 3000): none; [3000, 4000): one
+    agg.on_event(make_trade(150 * PRICE_SCALE, 2, 1, 1100), book, Side::Buy);
+    agg.on_event(make_trade(152 * PRICE_SCALE, 1, 2, 1500), book, Side::Sell);
+    agg.on_event(make_trade(149 * PRICE_SCALE, 1, 3, 1999), book, Side::Buy);
+    agg.on_event(make_accepted(9, 150 * PRICE_SCALE, 4, 2500), book, Side::Buy);
+    EXPECT_TRUE(bars.empty());
+    agg.on_event(make_trade(151 * PRICE_SCALE, 5, 5, 3200), book, Side::Buy);
+
+    ASSERT_EQ(bars.size(), 1u);
+    const Bar& bar = bars[0];
+    EXPECT_EQ(bar.type, BarType::Time);
+    EXPECT_EQ(bar.open_time, 1000u);
+    EXPECT_EQ(bar.close_time, 2000u);
+    EXPECT_EQ(bar.first_sequence, 1u);
+    EXPECT_EQ(bar.last_sequence, 3u);
+    EXPECT_EQ(bar.open, 150 * PRICE_SCALE);
+    EXPECT_EQ(bar.high, 152 * PRICE_SCALE);
+    EXPECT_EQ(bar.low, 149 * PRICE_SCALE);
+    EXPECT_EQ(bar.close, 149 * PRICE_SCALE);
+    EXPECT_EQ(bar.volume, 4u);
+    EXPECT_EQ(bar.buy_volume, 3u);
+    EXPECT_EQ(bar.trade_count, 3u);
+    EXPECT_DOUBLE_EQ(bar.notional, 300.0 + 152.0 + 149.0);
+    EXPECT_DOUBLE_EQ(bar.vwap, (300.0 + 152.0 + 149.0) / 4.0 * PRICE_SCALE);
+    EXPECT_EQ(bar.spread_samples, 3u);
+    EXPECT_GT(bar.avg_spread_bps, 0.0);
+
+    EXPECT_TRUE(agg.has_open_bar());
+    EXPECT_EQ(agg.current().open_time, 3000u);
+    agg.flush();
+    ASSERT_EQ(bars.size(), 2u);
+    EXPECT_EQ(bars[1].trade_count, 1u);
+    EXPECT_FALSE(agg.has_open_bar());
+    EXPECT_EQ(agg.bars_emitted(), 2u);
+}
+
+TEST_F(BarAggregatorTest, ThresholdBarsCloseOnTheCrossingTrade) {
+    BarAggregator ticks({BarType::Tick, 3}, collect());
+    BarAggregator volume({BarType::Volume, 10}, {});
+    BarAggregator dollar({BarType::Dollar, 1000}, {});
+    std::vector<Bar> volume_bars;
+    volume.set_sink([&](const Bar& bar) { volume_bars.push_back(bar); });
+
+    for (uint64_t i = 0; i < 7; ++i) {
+        auto trade = make_trade(100 * PRICE_SCALE, 4, i + 1, 10 * i);
+        ticks.on_event(trade, book, Side::Buy);
+        volume.on_event(trade, book, Side::Buy);
+        dollar.on_event(trade, book, Side::Buy);
+    }
+
+    // Tick: 3 + 3, one left open
+    ASSERT_EQ(bars.size(), 2u);
+    EXPECT_EQ(bars[0].trade_count, 3u);
+    EXPECT_EQ(bars[1].first_sequence, 4u);
+    EXPECT_EQ(bars[1].open_time, 30u);
+    EXPECT_EQ(bars[1].close_time, 50u);
+    // Volume: 4 + 4 + 4 crosses 10 (overshoot of one trade), twice
+    ASSERT_EQ(volume_bars.size(), 2u);
+    EXPECT_EQ(volume_bars[0].volume, 12u);
+    EXPECT_EQ(volume_bars[0].trade_count, 3u);
+    // Dollar: $400 per trade, so every third trade closes a bar
+    EXPECT_EQ(dollar.bars_emitted(), 2u);
+    EXPECT_DOUBLE_EQ(dollar.last_bar().notional, 1200.0);
+    // Empty book: no spread samples
+    EXPECT_EQ(volume_bars[0].spread_samples, 0u);
+}
+
+TEST(BarSpecTest, ParsesTypeAndThreshold) {
+    BarConfig config;
+    ASSERT_TRUE(parse_bar_spec("volume:500", config));
+    EXPECT_EQ(config.type, BarType::Volume);
+    EXPECT_EQ(config.threshold, 500u);
+    ASSERT_TRUE(parse_bar_spec("time:1000000000", config));
+    EXPECT_EQ(config.type, BarType::Time);
+    EXPECT_FALSE(parse_bar_spec("volume", config));
+    EXPECT_FALSE(parse_bar_spec("volume:", config));
+    EXPECT_FALSE(parse_bar_spec("volume:0", config));
+    EXPECT_FALSE(parse_bar_spec("range:5", config));
+    EXPECT_FALSE(parse_bar_spec("tick:5x", config));
+}
+
+TEST_F(AnalyticsEngineTest, FeedsConfiguredBarAggregators) {
+    AnalyticsConfig config;
+    config.bars = {{BarType::Tick, 2}, {BarType::Time, 1'000}};
+    AnalyticsEngine engine(book, config);
+    ASSERT_EQ(engine.bars().size(), 2u);
+
+    std::vector<Bar> bars;
+    engine.set_bar_sink([&](const Bar& bar) { bars.push_back(bar); });
+    for (int i = 0; i < 5; ++i) {
+        engine.on_event(make_trade(150 * PRICE_SCALE, 1, i + 1, 400 * i));
+    }
+    // Tick bars close on trades 2 and 4; the bar [0, 1000) on trade 4 (t = 1200)
+    EXPECT_EQ(engine.bars()[0].bars_emitted(), 2u);
+    EXPECT_EQ(engine.bars()[1].bars_emitted(), 1u);
+    engine.flush_bars();
+    EXPECT_EQ(bars.size(), 5u);
+    EXPECT_EQ(engine.to_json()["bars"].size(), 2u);
+}
+
+// ============================================================================
+// Batch kernels
+// ============================================================================
+
+TEST(BatchAnalyticsTest, MatchesStreamingModulesRowForRow) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 4096);
+    MemoryPool<Order> pool(4096);
+    MatchingEngine engine(book, pool);
+    EventBuffer buffer;
+    OrderGateway gateway(engine, pool, &buffer);
+
+    constexpr size_t WINDOW = 20;
+    SpreadAnalytics spread;
+    MicropriceCalculator microprice;
+    OrderFlowImbalance imbalance(WINDOW);
+    RealizedVolatility volatility(WINDOW, 50'000);
+
+    // Columns as captured per event, and the modules' outputs after it
+    std::vector<Price> bid_px, ask_px, mids;
+    std::vector<Quantity> bid_qty, ask_qty;
+    std::vector<Timestamp> sample_ts;
+    std::vector<Price> trade_px;
+    std::vector<Quantity> trade_qty;
+    std::vector<uint8_t> trade_side;
+    std::vector<double> want_spread, want_micro, want_ofi, want_tick_vol, want_bar_vol;
+
+    uint64_t state = 777;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    };
+    for (OrderId id = 1; id <= 4000; ++id) {
+        const Side side = (next() & 1) ? Side::Buy : Side::Sell;
+        const auto offset = static_cast<Price>(next() % 10) * TICK;
+        const Price price = side == Side::Buy ? 150 * PRICE_SCALE - offset + 3 * TICK
+                                              : 150 * PRICE_SCALE + offset;
+        OrderMessage msg = make_limit_msg(id, side, price, 1 + next() % 20);
+        msg.order.participant_id = 1 + static_cast<ParticipantId>(id % 5);
+        msg.order.timestamp = 1000 * id;
+        (void)gateway.process_order(msg);
+
+        EventMessage event{};
+        while (buffer.try_pop(event)) {
+            const MarketView view(book);
+            spread.on_event(event, view);
+            microprice.on_event(event, view);
+            volatility.on_event(event, view);
+            bid_px.push_back(view.best_bid_price());
+            bid_qty.push_back(view.best_bid_quantity());
+            ask_px.push_back(view.best_ask_price());
+            ask_qty.push_back(view.best_ask_quantity());
+            want_spread.push_back(spread.current_spread_bps());
+            want_micro.push_back(microprice.is_valid() ? microprice.current_microprice() : 0.0);
+            if (event.type == EventType::Trade || event.type == EventType::OrderAccepted) {
+                sample_ts.push_back(event.type == EventType::Trade
+                                        ? event.data.trade.timestamp
+                                        : event.data.order_event.timestamp);
+                mids.push_back(view.mid_price());
+                want_bar_vol.push_back(volatility.time_bar_volatility());
+            }
+            if (event.type == EventType::Trade) {
+                const Trade trade = event_trade(event);
+                imbalance.on_event(event, view, trade.aggressor_side);
+                trade_px.push_back(trade.price);
+                trade_qty.push_back(trade.quantity);
+                trade_side.push_back(trade.aggressor_side == Side::Buy ? 0 : 1);
+                want_ofi.push_back(imbalance.current_imbalance());
+                want_tick_vol.push_back(volatility.tick_volatility());
+            }
+        }
+    }
+    ASSERT_GT(trade_px.size(), 500u);
+
+    const QuoteColumns quotes{bid_px.data(), bid_qty.data(), ask_px.data(), ask_qty.data(),
+                              bid_px.size()};
+    const TradeColumns trades{trade_px.data(), trade_qty.data(), trade_side.data(),
+                              trade_px.size()};
+    BatchOptions options;
+    options.threads = 3;
+    options.chunk_rows = 1000;
+
+    std::vector<double> got(quotes.rows);
+    batch_spread_bps(quotes, got.data(), options);
+    EXPECT_EQ(got, want_spread);
+    batch_microprice(quotes, got.data(), options);
+    EXPECT_EQ(got, want_micro);
+
+    const SpreadSummary summary = batch_spread_summary(quotes, options);
+    EXPECT_EQ(summary.avg_spread_bps, spread.avg_spread_bps());
+    EXPECT_EQ(summary.spread_samples, spread.to_json()["spread_samples"].get<uint64_t>());
+    EXPECT_EQ(summary.max_spread_bps, spread.to_json()["max_spread_bps"].get<double>());
+
+    got.resize(trades.rows);
+    batch_order_flow_imbalance(trades, WINDOW, got.data());
+    EXPECT_EQ(got, want_ofi);
+    batch_tick_volatility(trade_px.data(), trades.rows, WINDOW, got.data(), options);
+    EXPECT_EQ(got, want_tick_vol);
+
+    got.resize(sample_ts.size());
+    batch_time_bar_volatility(sample_ts.data(), mids.data(), sample_ts.size(), 50'000, WINDOW,
+                              got.data());
+    EXPECT_EQ(got, want_bar_vol);
+    EXPECT_GT(got.back(), 0.0);
+}
+
+// ============================================================================
+// Streaming time-series columns
+// ============================================================================
+
+TEST(TimeSeriesColumnsTest, RoundTripsBlocksAndPartialTail) {
+    const std::string path = "test_time_series.cols";
+    TimeSeriesWriterConfig config;
+    config.path = path;
+    config.block_rows = 100;
+    config.buffers = 2;
+
+    std::vector<TimeSeriesRow> rows;
+    for (uint64_t i = 0; i < 1050; ++i) {
+        TimeSeriesRow row{};
+        row.sequence_num = 10 + i;
+        row.timestamp = 1000 * i;
+        row.trade_price = 150 * PRICE_SCALE + static_cast<Price>(i) * TICK;
+        row.trade_quantity = i % 7 + 1;
+        row.spread = (i % 3 == 0) ? -1 : static_cast<Price>(i % 5) * TICK;
+        row.spread_bps = 0.5 * static_cast<double>(i);
+        row.microprice = 1.5e10 + static_cast<double>(i);
+        row.imbalance = (i % 2 == 0) ? 0.25 : -0.75;
+        row.tick_vol = 1e-4 * static_cast<double>(i);
+        row.depth_imbalance = -0.125;
+        row.aggressor_side = (i % 4 == 0) ? Side::Sell : Side::Buy;
+        rows.push_back(row);
+    }
+
+    {
+        TimeSeriesColumnWriter writer(config);
+        ASSERT_TRUE(writer.open()) << writer.error();
+        for (const auto& row : rows) writer.append(row);
+        writer.close();
+        EXPECT_EQ(writer.rows_appended(), 1050u);
+        EXPECT_EQ(writer.blocks_written(), 11u);
+        EXPECT_FALSE(writer.write_failed());
+    }
+
+    TimeSeriesColumnReader reader;
+    ASSERT_TRUE(reader.open(path)) << reader.error();
+    EXPECT_EQ(reader.row_count(), 1050u);
+    ASSERT_EQ(reader.block_count(), 11u);
+    EXPECT_EQ(reader.header().price_scale, PRICE_SCALE);
+    EXPECT_EQ(reader.block(0).rows, 100u);
+    EXPECT_EQ(reader.block(10).rows, 50u);
+    EXPECT_EQ(reader.block(10).first_sequence, 1010u);
+    EXPECT_EQ(reader.block(10).last_sequence, 1059u);
+
+    // Typed column view, at the documented fixed offset
+    const auto* prices = static_cast<const int64_t*>(reader.column(3, TimeSeriesColumn::TradePrice));
+    EXPECT_EQ(prices[7], rows[307].trade_price);
+    const auto* sides = static_cast<const uint8_t*>(reader.column(0, TimeSeriesColumn::AggressorSide));
+    EXPECT_EQ(sides[0], 1);
+    EXPECT_EQ(sides[1], 0);
+
+    for (uint64_t i = 0; i < rows.size(); ++i) {
+        const TimeSeriesRow got = reader.row(i);
+        ASSERT_EQ(got.sequence_num, rows[i].sequence_num) << i;
+        EXPECT_EQ(got.timestamp, rows[i].timestamp);
+        EXPECT_EQ(got.trade_price, rows[i].trade_price);
+        EXPECT_EQ(got.trade_quantity, rows[i].trade_quantity);
+        EXPECT_EQ(got.spread, rows[i].spread);
+        EXPECT_EQ(got.spread_bps, rows[i].spread_bps);
+        EXPECT_EQ(got.microprice, rows[i].microprice);
+        EXPECT_EQ(got.imbalance, rows[i].imbalance);
+        EXPECT_EQ(got.tick_vol, rows[i].tick_vol);
+        EXPECT_EQ(got.depth_imbalance, rows[i].depth_imbalance);
+        EXPECT_EQ(got.aggressor_side, rows[i].aggressor_side);
+    }
+    reader.close();
+    std::remove(path.c_str());
+}
+
+TEST(TimeSeriesColumnsTest, RejectsUnfinishedOrForeignFiles) {
+    const std::string path = "test_time_series_bad.cols";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "sequence_num,timestamp\n1,2\n";
+    }
+    TimeSeriesColumnReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.error().empty());
+    std::remove(path.c_str());
+}
+
+TEST_F(AnalyticsEngineTest, StreamsTimeSeriesToColumns) {
+    place_buy(book, pool, 100, 150 * PRICE_SCALE, 100);
+    place_sell(book, pool, 200, 151 * PRICE_SCALE, 100);
+
+    AnalyticsConfig config;
+    config.time_series_columns_path = "test_engine_series.cols";
+    config.time_series_block_rows = 4;
+    AnalyticsEngine streamed(book, config);
+    AnalyticsEngine in_memory(book);
+    ASSERT_NE(streamed.time_series_writer(), nullptr);
+
+    for (int i = 0; i < 10; ++i) {
+        auto trade = make_trade(150 * PRICE_SCALE + (i % 3) * TICK, 10 + i, i + 1, 1000 + i);
+        streamed.on_event(trade);
+        in_memory.on_event(trade);
+    }
+    EXPECT_EQ(streamed.trade_count(), 10u);
+    EXPECT_EQ(streamed.to_json().dump(), in_memory.to_json().dump());
+
+    // write_csv finishes the column file and reads it back
+    streamed.write_csv("test_engine_streamed.csv");
+    in_memory.write_csv("test_engine_memory.csv");
+    auto slurp = [](const std::string& path) {
+        std::ifstream in(path);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+    EXPECT_EQ(slurp("test_engine_streamed.csv"), slurp("test_engine_memory.csv"));
+
+    TimeSeriesColumnReader reader;
+    ASSERT_TRUE(reader.open(config.time_series_columns_path)) << reader.error();
+    EXPECT_EQ(reader.row_count(), 10u);
+    EXPECT_EQ(reader.block_count(), 3u);
+    reader.close();
+
+    std::remove("test_engine_streamed.csv");
+    std::remove("test_engine_memory.csv");
+    std::remove(config.time_series_columns_path.c_str());
+}
+
+// ============================================================================
+// Off-thread and parallel analytics: MarketView over a QuoteSnapshotSlot,
+// AnalyticsThread, MultiInstrumentAnalytics workers
+// ============================================================================
+
+TEST(MarketViewTest, SnapshotViewMatchesLiveBook) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 1000);
+    MemoryPool<Order> pool(1000);
+    for (int i = 0; i < 12; ++i) {
+        place_buy(book, pool, 1 + i, (149 - i) * PRICE_SCALE, 10 + i);
+        place_sell(book, pool, 101 + i, (151 + i) * PRICE_SCALE, 20 + i);
+    }
+    QuoteSnapshotSlot slot;
+    MarketView live(book);
+    MarketView snapshot(slot);
+
+    // Nothing published yet
+    EXPECT_FALSE(snapshot.refresh());
+    EXPECT_FALSE(snapshot.has_bid());
+    EXPECT_EQ(snapshot.spread(), -1);
+    EXPECT_EQ(snapshot.mid_price(), 0);
+
+    ASSERT_TRUE(slot.publish(book, 0));
+    EXPECT_TRUE(snapshot.refresh());
+    EXPECT_FALSE(snapshot.refresh());  // Same version
+    EXPECT_TRUE(live.live());
+    EXPECT_FALSE(snapshot.live());
+    EXPECT_EQ(snapshot.best_bid_price(), live.best_bid_price());
+    EXPECT_EQ(snapshot.best_ask_price(), live.best_ask_price());
+    EXPECT_EQ(snapshot.best_bid_quantity(), live.best_bid_quantity());
+    EXPECT_EQ(snapshot.best_ask_quantity(), live.best_ask_quantity());
+    EXPECT_EQ(snapshot.spread(), live.spread());
+    EXPECT_EQ(snapshot.mid_price(), live.mid_price());
+
+    // Depth stops at the snapshot's levels
+    DepthEntry from_book[12];
+    DepthEntry from_snapshot[12];
+    ASSERT_EQ(live.get_ask_depth(from_book, 12), 12u);
+    ASSERT_EQ(snapshot.get_ask_depth(from_snapshot, 12), QUOTE_SNAPSHOT_DEPTH);
+    EXPECT_EQ(snapshot.max_depth(), QUOTE_SNAPSHOT_DEPTH);
+    for (size_t i = 0; i < QUOTE_SNAPSHOT_DEPTH; ++i) {
+        EXPECT_EQ(from_snapshot[i].price, from_book[i].price);
+        EXPECT_EQ(from_snapshot[i].quantity, from_book[i].quantity);
+    }
+}
+
+TEST(AnalyticsThreadTest, ConsumesEventRingOffTheMatchingThread) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 4096);
+    MemoryPool<Order> pool(4096);
+    MatchingEngine engine(book, pool);
+    EventBuffer buffer;
+    OrderGateway gateway(engine, pool, &buffer);
+    QuoteSnapshotSlot slot;
+    gateway.set_quote_snapshot(&slot);
+
+    AnalyticsEngine inline_analytics(book);
+    AnalyticsEngine off_thread(slot);
+    AnalyticsThreadConfig config;
+    config.gating = true;
+    AnalyticsThread thread(buffer, config);
+    thread.register_callback([&off_thread](const EventMessage& e) { off_thread.on_event(e); });
+    ASSERT_TRUE(thread.start());
+    EXPECT_FALSE(thread.start());
+
+    // Resting quotes, then aggressive orders from both sides
+    uint64_t events = 0;
+    OrderId id = 1;
+    for (int round = 0; round < 200; ++round) {
+        const Price mid = (150 + round % 3) * PRICE_SCALE;
+        (void)gateway.process_order(make_limit_msg(id++, Side::Buy, mid - TICK, 10));
+        (void)gateway.process_order(make_limit_msg(id++, Side::Sell, mid + TICK, 10));
+        const Side aggressor = (round % 2) ? Side::Sell : Side::Buy;
+        OrderMessage take = make_limit_msg(
+            id++, aggressor, aggressor == Side::Buy ? mid + TICK : mid - TICK, 4);
+        take.order.participant_id = 2;
+        (void)gateway.process_order(take);
+        EventMessage event{};
+        while (buffer.try_pop(event)) {
+            inline_analytics.on_event(event);
+            ++events;
+        }
+    }
+    thread.stop();
+    EXPECT_FALSE(thread.running());
+
+    // Every event reached both; trade-driven metrics agree exactly
+    EXPECT_EQ(thread.events_processed(), events);
+    EXPECT_EQ(thread.lost(), 0u);
+    EXPECT_GT(inline_analytics.trade_count(), 0u);
+    EXPECT_EQ(off_thread.trade_count(), inline_analytics.trade_count());
+    EXPECT_DOUBLE_EQ(off_thread.order_flow().current_imbalance(),
+                     inline_analytics.order_flow().current_imbalance());
+    EXPECT_EQ(off_thread.order_flow().sample_count(),
+              inline_analytics.order_flow().sample_count());
+}
+
+TEST(MultiInstrumentAnalyticsTest, WorkersMatchSerialDispatch) {
+    InstrumentRegistry registry;
+    for (InstrumentId id = 0; id < 8; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = "SYM" + std::to_string(id);
+        cfg.min_price = MIN_PRICE;
+        cfg.max_price = MAX_PRICE;
+        cfg.tick_size = TICK;
+        cfg.max_orders = 64;
+        ASSERT_TRUE(registry.register_instrument(cfg));
+    }
+    InstrumentRouter router(registry, nullptr);
+
+    MultiInstrumentAnalytics serial(router);
+    MultiInstrumentAnalytics parallel(router, {}, 3);
+    ASSERT_EQ(parallel.instrument_count(), 8u);
+    ASSERT_EQ(parallel.worker_count(), 3u);
+
+    // Interleaved instruments, more events than one lane holds; ids past
+    // the router's are dropped
+    uint64_t routed = 0;
+    for (uint64_t seq = 1; seq <= 20000; ++seq) {
+        const auto id = static_cast<InstrumentId>((seq / 3) % 9);
+        EventMessage event = (seq % 3 == 0)
+            ? make_trade(150 * PRICE_SCALE + static_cast<Price>(seq % 7) * TICK,
+                         1 + seq % 5, seq, static_cast<Timestamp>(seq) * 1000)
+            : make_accepted(seq, 150 * PRICE_SCALE, seq, static_cast<Timestamp>(seq) * 1000);
+        if (event.type == EventType::Trade) {
+            Trade trade = event_trade(event);
+            trade.flags = TRADE_AGGRESSOR;
+            trade.aggressor_side = (seq % 2) ? Side::Buy : Side::Sell;
+            set_trade(event, trade);
+        }
+        event.instrument_id = id;
+        serial.on_event(event);
+        parallel.on_event(event);
+        routed += id < 8;
+    }
+    parallel.finish();
+
+    uint64_t processed = 0;
+    for (size_t w = 0; w < parallel.worker_count(); ++w) processed += parallel.worker_events(w);
+    EXPECT_EQ(processed, routed);
+    EXPECT_EQ(parallel.analytics(8), nullptr);
+    for (InstrumentId id = 0; id < 8; ++id) {
+        ASSERT_NE(parallel.analytics(id), nullptr);
+        EXPECT_GT(parallel.analytics(id)->trade_count(), 0u);
+    }
+    EXPECT_EQ(parallel.to_json().dump(), serial.to_json().dump());
+
+    // After finish() events go straight to the engines
+    const size_t before = parallel.analytics(0)->trade_count();
+    EventMessage late = make_trade(150 * PRICE_SCALE, 1, 30000, 30'000'000);
+    late.instrument_id = 0;
+    parallel.on_event(late);
+    EXPECT_EQ(parallel.analytics(0)->trade_count(), before + 1);
+}
+
 // ============================================================================
 // Integration test: replay-style event sequence
 // ============================================================================
@@ -0,0 +1,192 @@
+/// @file test_event_journal.cpp
+/// @brief Unit tests for EventJournal and EventJournalReader.
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gateway/event_journal.h"
+#include "transport/message.h"
+
+using namespace hft;
+
+// ===========================================================================
+// Helpers
+// ===========================================================================
+
+class EventJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = (std::filesystem::temp_directory_path() /
+               ("hft_journal_" + std::string(::testing::UnitTest::GetInstance()
+                                                   ->current_test_info()->name())))
+                  .string();
+        std::filesystem::remove_all(dir);
+        config.directory = dir;
+        config.buffer_bytes = 8192;  // 127 records per block
+        config.buffers = 4;
+        config.fsync = JournalFsync::None;
+        config.fsync_interval_ms = 0;  // Blocks only when full: exact counts
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    static EventMessage make_event(uint64_t seq) {
+        EventMessage e{};
+        e.type = EventType::Trade;
+        e.instrument_id = static_cast<InstrumentId>(seq % 3);
+        e.sequence_num = seq;
+        e.data.trade.trade_id = seq * 10;
+        e.data.trade.price = static_cast<Price>(seq) * PRICE_SCALE;
+        e.data.trade.quantity = static_cast<Quantity>(seq % 100 + 1);
+        return e;
+    }
+
+    std::vector<EventMessage> read_all(EventJournalReader& reader) const {
+        std::vector<EventMessage> events;
+        EXPECT_TRUE(reader.open(dir));
+        EventMessage e{};
+        while (reader.next(e)) events.push_back(e);
+        return events;
+    }
+
+    std::string dir;
+    JournalConfig config;
+};
+
+// ===========================================================================
+// Tests
+// ===========================================================================
+
+TEST_F(EventJournalTest, RoundTripsEventsAcrossSegments) {
+    config.segment_bytes = 16384;  // Two full blocks per segment
+    config.fsync = JournalFsync::PerBatch;
+    EventJournal journal(config);
+    ASSERT_TRUE(journal.open()) << journal.error();
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        // Four buffers may not be enough if the writer is descheduled;
+        // append() then drops rather than waits
+        while (!journal.append(make_event(i))) {}
+    }
+    journal.close();
+
+    const JournalStats stats = journal.stats();
+    EXPECT_EQ(stats.events_written, stats.events_appended);
+    EXPECT_EQ(stats.events_appended, 1000u);
+    EXPECT_EQ(stats.blocks_written, 8u);  // 7 full + the partial one
+    EXPECT_EQ(stats.bytes_written, 8u * 8192u);
+    EXPECT_EQ(stats.segments, 4u);
+    EXPECT_EQ(stats.fsyncs, 8u);
+    EXPECT_EQ(stats.write_errors, 0u);
+
+    EventJournalReader reader;
+    auto events = read_all(reader);
+    EXPECT_EQ(reader.segment_count(), 4u);
+    EXPECT_EQ(reader.corrupt_blocks(), 0u);
+    ASSERT_EQ(events.size(), 1000u);
+    for (uint64_t i = 0; i < events.size(); ++i) {
+        const EventMessage expected = make_event(i + 1);
+        ASSERT_EQ(std::memcmp(&events[i], &expected, sizeof(EventMessage)), 0) << i;
+    }
+}
+
+TEST_F(EventJournalTest, AppendDropsInsteadOfBlocking) {
+    EventJournal journal(config);
+    EXPECT_FALSE(journal.append(make_event(1)));  // Not open: nowhere to put it
+    EXPECT_EQ(journal.stats().events_dropped, 1u);
+
+    JournalConfig unset;
+    EventJournal disabled(unset);
+    EXPECT_FALSE(disabled.open());
+    EXPECT_FALSE(disabled.error().empty());
+}
+
+TEST_F(EventJournalTest, TornTailEndsTheSegment) {
+    {
+        EventJournal journal(config);
+        ASSERT_TRUE(journal.open());
+        for (uint64_t i = 1; i <= 200; ++i) while (!journal.append(make_event(i))) {}
+    }  // Destructor closes
+
+    // Corrupt a record of the second (partial) block
+    const std::string path = EventJournal::segment_path(config, 0);
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(8192 + 64 + 5 * 64 + 20);
+        f.put('\x7F');
+    }
+
+    EventJournalReader reader;
+    auto events = read_all(reader);
+    EXPECT_EQ(events.size(), 127u);
+    EXPECT_EQ(reader.blocks_read(), 1u);
+    EXPECT_EQ(reader.corrupt_blocks(), 1u);
+}
+
+TEST_F(EventJournalTest, ReopeningContinuesAfterExistingSegments) {
+    for (int run = 0; run < 2; ++run) {
+        EventJournal journal(config);
+        ASSERT_TRUE(journal.open());
+        for (uint64_t i = 1; i <= 10; ++i) {
+            ASSERT_TRUE(journal.append(make_event(run * 10 + i)));
+        }
+        journal.flush();
+        journal.close();
+    }
+    EXPECT_TRUE(std::filesystem::exists(EventJournal::segment_path(config, 0)));
+    EXPECT_TRUE(std::filesystem::exists(EventJournal::segment_path(config, 1)));
+
+    EventJournalReader reader;
+    auto events = read_all(reader);
+    ASSERT_EQ(events.size(), 20u);
+    for (uint64_t i = 0; i < 20; ++i) EXPECT_EQ(events[i].sequence_num, i + 1);
+}
+
+TEST_F(EventJournalTest, QuietStreamBecomesDurableWithoutFlush) {
+    config.fsync = JournalFsync::Timed;
+    config.fsync_interval_ms = 10;
+    EventJournal journal(config);
+    ASSERT_TRUE(journal.open()) << journal.error();
+
+    // Far from filling a buffer, and nobody calls flush(): the writer
+    // still writes and syncs the records within an interval or two
+    auto wait_for_written = [&](uint64_t n) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (journal.stats().events_written < n &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return journal.stats().events_written;
+    };
+    for (uint64_t i = 1; i <= 5; ++i) ASSERT_TRUE(journal.append(make_event(i)));
+    EXPECT_EQ(wait_for_written(5), 5u);
+
+    // More records in the same buffer are written after the first ones
+    for (uint64_t i = 6; i <= 8; ++i) ASSERT_TRUE(journal.append(make_event(i)));
+    EXPECT_EQ(wait_for_written(8), 8u);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (journal.stats().fsyncs == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_GT(journal.stats().fsyncs, 0u);
+
+    // Readable while the journal is still open, without duplicates
+    EventJournalReader reader;
+    auto events = read_all(reader);
+    ASSERT_EQ(events.size(), 8u);
+    for (uint64_t i = 0; i < 8; ++i) EXPECT_EQ(events[i].sequence_num, i + 1);
+
+    // Closing writes only what is left
+    ASSERT_TRUE(journal.append(make_event(9)));
+    journal.close();
+    EXPECT_EQ(journal.stats().events_written, 9u);
+    events = read_all(reader);
+    ASSERT_EQ(events.size(), 9u);
+    EXPECT_EQ(events.back().sequence_num, 9u);
+}
@@ -1,15 +1,25 @@
 /// @file test_fix_protocol.cpp
 /// @brief Comprehensive tests for FIX 4.2 parser and serializer.
 
+#include <algorithm>
+#include <climits>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "core/types.h"
+#include "feed/cl_ord_id_table.h"
+#include "feed/fix_framer.h"
 #include "feed/fix_message.h"
 #include "feed/fix_parser.h"
 #include "feed/fix_serializer.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "transport/event_buffer.h"
 #include "transport/message.h"
 
 using namespace hft;
@@ -177,6 +187,15 @@ TEST(FixParser, ParseNewOrderSingle) {
     EXPECT_EQ(msg.quantity, 10u);
 }
 
+TEST(FixParser, ValueMaySplitOnlyAtTheFirstEquals) {
+    auto raw = make_new_order("ORD=1==2", '1', "42000.50", "10");
+    auto msg = FixParser::parse(raw);
+
+    EXPECT_TRUE(msg.valid) << msg.error;
+    EXPECT_EQ(msg.cl_ord_id, "ORD=1==2");
+    EXPECT_EQ(msg.quantity, 10u);
+}
+
 TEST(FixParser, ParseSellOrder) {
     auto raw = make_new_order("ORD006", '2', "42005.00", "10");
     auto msg = FixParser::parse(raw);
@@ -632,6 +651,92 @@ TEST(FixParser, ToOrderMessage_InstrumentId) {
     EXPECT_EQ(om.order.instrument_id, 42u);
 }
 
+// ===========================================================================
+// Parser — zero-copy views and parse_into
+// ===========================================================================
+
+TEST(FixParser, ParseViewPointsIntoTheBuffer) {
+    const std::string raw = make_new_order("ORD042", '2', "42001.25", "7");
+    FixMessageView view;
+    ASSERT_TRUE(FixParser::parse_view(raw, view));
+    EXPECT_EQ(view.error, FixError::None);
+    EXPECT_EQ(view.msg_type, MsgType::NewOrderSingle);
+    EXPECT_EQ(view.cl_ord_id, "ORD042");
+    EXPECT_EQ(view.symbol, "BTCUSDT");
+    EXPECT_EQ(view.sender_comp_id, "TRADER1");
+    EXPECT_EQ(view.price, 42001LL * PRICE_SCALE + 25000000LL);
+    EXPECT_EQ(view.quantity, 7u);
+    EXPECT_EQ(view.body_length, view.actual_body_length);
+
+    const char* begin = raw.data();
+    const char* end = raw.data() + raw.size();
+    for (std::string_view field : {view.begin_string, view.cl_ord_id, view.symbol,
+                                   view.transact_time, view.checksum}) {
+        EXPECT_GE(field.data(), begin);
+        EXPECT_LE(field.data() + field.size(), end);
+    }
+}
+
+TEST(FixParser, ParseViewReportsErrorCodes) {
+    FixMessageView view;
+    EXPECT_FALSE(FixParser::parse_view("", view));
+    EXPECT_EQ(view.error, FixError::EmptyMessage);
+
+    EXPECT_FALSE(FixParser::parse_view("8=FIX.4.2|9=5|49=X|10=000|", view));
+    EXPECT_EQ(view.error, FixError::MissingMsgType);
+
+    EXPECT_FALSE(FixParser::parse_view("8=FIX.4.2|35=Z|", view));
+    EXPECT_EQ(view.error, FixError::UnsupportedMsgType);
+    EXPECT_EQ(view.error_detail, "Z");
+
+    EXPECT_FALSE(FixParser::parse_view(make_new_order("ORD001", '1', "0"), view));
+    EXPECT_EQ(view.error, FixError::MissingPrice);
+
+    EXPECT_FALSE(FixParser::parse_view(make_cancel("ORD016", ""), view));
+    EXPECT_EQ(view.error, FixError::MissingOrigClOrdID);
+
+    std::string corrupt = make_new_order();
+    corrupt[corrupt.size() - 2] = corrupt[corrupt.size() - 2] == '0' ? '1' : '0';
+    EXPECT_FALSE(FixParser::parse_view(corrupt, view));
+    EXPECT_EQ(view.error, FixError::ChecksumMismatch);
+
+    // The owning parse() keeps the code next to its readable error
+    const auto msg = FixParser::parse(make_cancel("ORD016", ""));
+    EXPECT_EQ(msg.error_code, FixError::MissingOrigClOrdID);
+    EXPECT_EQ(msg.error, "OrderCancelRequest missing OrigClOrdID (tag 41)");
+}
+
+TEST(FixParser, ParseIntoMatchesParseThenConvert) {
+    const std::string messages[] = {
+        make_new_order("ORD001", '1', "42000.50", "10"),
+        make_new_order("ORD013", '2', "42007.00", "20", '2', '3'),
+        make_new_order("ORD026", '1', "", "3", '1', '1'),
+        make_cancel("ORD016", "ORD001"),
+        make_cancel_replace("ORD021", "ORD003", "42003.50", "10"),
+    };
+    for (const std::string& raw : messages) {
+        const OrderMessage expected = FixParser::to_order_message(FixParser::parse(raw), 7);
+        OrderMessage om{};
+        ASSERT_EQ(FixParser::parse_into(raw, om, 7), FixError::None) << raw;
+        EXPECT_EQ(om.type, expected.type);
+        EXPECT_EQ(om.instrument_id, expected.instrument_id);
+        EXPECT_EQ(om.order.order_id, expected.order.order_id);
+        EXPECT_EQ(om.order.side, expected.order.side);
+        EXPECT_EQ(om.order.type, expected.order.type);
+        EXPECT_EQ(om.order.time_in_force, expected.order.time_in_force);
+        EXPECT_EQ(om.order.price, expected.order.price);
+        EXPECT_EQ(om.order.quantity, expected.order.quantity);
+    }
+}
+
+TEST(FixParser, ParseIntoRejectsNonOrders) {
+    OrderMessage om{};
+    EXPECT_EQ(FixParser::parse_into("8=FIX.4.2|35=8|49=HFT-ENGINE|", om),
+              FixError::NotAnOrder);
+    EXPECT_EQ(FixParser::parse_into(make_new_order("", '1'), om),
+              FixError::MissingClOrdID);
+}
+
 // ===========================================================================
 // Serializer — enum mapping
 // ===========================================================================
@@ -784,6 +889,50 @@ TEST(FixSerializer, SohOutputChecksumCorrectness) {
     EXPECT_TRUE(FixParser::validate_checksum(fix_str));
 }
 
+// ===========================================================================
+// Serializer — ExecutionReportWriter
+// ===========================================================================
+
+TEST(ExecutionReportWriter, MatchesTheStringSerializerByteForByte) {
+    // Reports produced by the std::string serializer before the writer
+    auto order = make_order_event(EventType::OrderPartialFill, 987654321,
+                                  4200050000000LL, 3, 7, 42, 1704067200000000000ULL);
+    auto trade = make_trade_event(UINT64_MAX, 1, 2, -150000000, 12, 9, 0);
+
+    const ExecutionReportWriter writer("BTCUSDT", "HFT-ENGINE", "CLIENT-7", '|');
+    std::vector<char> buf(writer.max_report_bytes());
+    const size_t n = writer.write(order, buf.data(), buf.size());
+    EXPECT_EQ(std::string(buf.data(), n),
+              "8=FIX.4.2|9=153|35=8|49=HFT-ENGINE|56=CLIENT-7|37=987654321|11=987654321|"
+              "17=EXEC-42|150=1|39=1|55=BTCUSDT|54=1|44=42000.50000000|38=10|14=3|151=7|"
+              "60=1704067200000000000|10=215|");
+    EXPECT_EQ(FixSerializer::to_execution_report_pretty(trade, "ETH"),
+              "8=FIX.4.2|9=144|35=8|49=HFT-ENGINE|56=CLIENT|37=1|11=2|"
+              "17=EXEC-18446744073709551615|150=2|39=2|55=ETH|54=1|44=-1.50000000|32=12|"
+              "31=-1.50000000|14=12|151=0|60=0|10=215|");
+}
+
+TEST(ExecutionReportWriter, ReportsReparseAndRespectCapacity) {
+    const ExecutionReportWriter writer("BTCUSDT");
+    std::vector<char> buf(writer.max_report_bytes());
+    for (EventType type : {EventType::OrderAccepted, EventType::OrderFilled,
+                           EventType::OrderCancelled, EventType::Trade}) {
+        const auto ev = type == EventType::Trade
+                            ? make_trade_event(UINT64_MAX, UINT64_MAX, UINT64_MAX, INT64_MAX,
+                                               UINT64_MAX, 1, UINT64_MAX)
+                            : make_order_event(type, UINT64_MAX, INT64_MIN, 1, 2, UINT64_MAX,
+                                               UINT64_MAX);
+        const size_t n = writer.write(ev, buf.data(), buf.size());
+        ASSERT_GT(n, 0u);
+        EXPECT_LE(n, writer.max_report_bytes());
+        FixMessageView view;
+        EXPECT_TRUE(FixParser::parse_view(std::string_view(buf.data(), n), view))
+            << fix_error_text(view.error);
+        EXPECT_EQ(view.msg_type, MsgType::ExecutionReport);
+    }
+    EXPECT_EQ(writer.write(make_trade_event(), buf.data(), buf.size() - 1), 0u);
+}
+
 // ===========================================================================
 // Serializer — round-trip
 // ===========================================================================
@@ -856,3 +1005,292 @@ TEST(FixParser, ParseSampleCancelReplaceMessage) {
     EXPECT_EQ(parsed.orig_cl_ord_id, "ORD003");
     EXPECT_EQ(parsed.price, 42003LL * PRICE_SCALE + 50000000LL);
 }
+
+// ===========================================================================
+// Framer — streaming session input
+// ===========================================================================
+
+/// `count` alternating D/F/G messages, concatenated.
+static std::vector<std::string> make_session(size_t count) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string id = "ORD" + std::to_string(i);
+        switch (i % 3) {
+            case 0: out.push_back(make_new_order(id, '1', "42000.50", std::to_string(1 + i))); break;
+            case 1: out.push_back(make_cancel(id, "ORD" + std::to_string(i - 1))); break;
+            default: out.push_back(make_cancel_replace(id, "ORD" + std::to_string(i - 2))); break;
+        }
+    }
+    return out;
+}
+
+TEST(FixFramer, FramesMessagesFedByteByByte) {
+    const auto session = make_session(3);
+    std::string stream;
+    for (const auto& m : session) stream += m;
+
+    FixFramer framer;
+    std::vector<std::string> framed;
+    std::string_view msg;
+    for (char c : stream) {
+        ASSERT_EQ(framer.feed(&c, 1), 1u);
+        while (framer.next(msg)) framed.emplace_back(msg);
+    }
+    EXPECT_EQ(framed, session);
+    EXPECT_EQ(framer.messages(), 3u);
+    EXPECT_EQ(framer.errors(), 0u);
+    EXPECT_EQ(framer.buffered(), 0u);
+}
+
+TEST(FixFramer, ArbitraryReadsThroughASmallBuffer) {
+    // A 1 KB buffer forces partial messages to be moved to the front
+    const auto session = make_session(300);
+    std::string stream;
+    for (const auto& m : session) stream += m;
+
+    FixFramer framer(1024, 512);
+    std::vector<std::string> framed;
+    size_t pos = 0;
+    size_t read_size = 1;
+    while (pos < stream.size()) {
+        size_t space = 0;
+        char* p = framer.prepare(space);
+        ASSERT_GE(space, 512u);
+        const size_t n = std::min({space, read_size, stream.size() - pos});
+        std::memcpy(p, stream.data() + pos, n);
+        framer.commit(n);
+        pos += n;
+        read_size = read_size * 7 % 601 + 1;
+
+        std::string_view msg;
+        OrderMessage om{};
+        while (framer.next(msg)) {
+            EXPECT_EQ(FixParser::parse_into(msg, om), FixError::None);
+            framed.emplace_back(msg);
+        }
+    }
+    EXPECT_EQ(framed, session);
+    EXPECT_EQ(framer.errors(), 0u);
+}
+
+TEST(FixFramer, SkipsGarbageAndCorruptFrames) {
+    const auto session = make_session(3);
+    std::string corrupt = session[1];
+    corrupt[corrupt.size() - 2] = corrupt[corrupt.size() - 2] == '0' ? '1' : '0';
+    const std::string stream = "\r\nnoise" + session[0] + corrupt + session[2];
+
+    FixFramer framer;
+    ASSERT_EQ(framer.feed(stream.data(), stream.size()), stream.size());
+    std::vector<std::string> framed;
+    std::string_view msg;
+    while (framer.next(msg)) framed.emplace_back(msg);
+
+    EXPECT_EQ(framed, (std::vector<std::string>{session[0], session[2]}));
+    EXPECT_EQ(framer.errors(), 2u);
+    EXPECT_EQ(framer.last_error(), FixFramer::Error::ChecksumMismatch);
+    EXPECT_EQ(framer.discarded_bytes(), 7u + corrupt.size());
+}
+
+TEST(FixFramer, RejectsOversizeAndMalformedHeaders) {
+    const std::string good = make_new_order();
+    FixFramer framer(4096, 256);
+    const std::string stream = "8=FIX.4.2|9=5000|35=D|" + std::string("8=FIX.4.2|9=x|") + good;
+    ASSERT_EQ(framer.feed(stream.data(), stream.size()), stream.size());
+
+    std::string_view msg;
+    ASSERT_TRUE(framer.next(msg));
+    EXPECT_EQ(msg, good);
+    EXPECT_EQ(framer.errors(), 2u);
+    EXPECT_EQ(framer.last_error(), FixFramer::Error::BadHeader);
+    EXPECT_FALSE(framer.next(msg));
+}
+
+// ===========================================================================
+// ClOrdIdTable — session ClOrdID bindings
+// ===========================================================================
+
+TEST(ClOrdIdTable, AssignsSequentialIdsAndRefusesBadClOrdIDs) {
+    ClOrdIdTable ids(4, 100);
+    EXPECT_EQ(ids.assign("A"), 100u);
+    EXPECT_EQ(ids.assign("B"), 101u);
+    EXPECT_EQ(ids.assign("A"), ClOrdIdTable::NO_ORDER);  // Live
+    EXPECT_EQ(ids.assign(std::string(ClOrdIdTable::MAX_LENGTH + 1, 'x')),
+              ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.assign(std::string(ClOrdIdTable::MAX_LENGTH, 'x')), 102u);
+    EXPECT_EQ(ids.find("A"), 100u);
+    EXPECT_EQ(ids.find("C"), ClOrdIdTable::NO_ORDER);
+
+    // A replace binds a second ClOrdID to the same order
+    EXPECT_EQ(ids.replace("B", "B2"), 101u);
+    EXPECT_EQ(ids.find("B2"), 101u);
+    EXPECT_EQ(ids.replace("nope", "C"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.size(), 4u);
+    EXPECT_EQ(ids.order_count(), 3u);
+    EXPECT_EQ(ids.assign("D"), ClOrdIdTable::NO_ORDER);  // Full
+
+    // Releasing an order frees all of its ClOrdIDs for reuse
+    EXPECT_TRUE(ids.release(101));
+    EXPECT_FALSE(ids.release(101));
+    EXPECT_EQ(ids.find("B"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.find("B2"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.assign("B"), 103u);
+    EXPECT_EQ(ids.size(), 3u);
+}
+
+TEST(ClOrdIdTable, ChurnKeepsEveryLiveBinding) {
+    // Erasing shifts probe runs back; check against a reference map
+    // through many cycles of a nearly full table
+    constexpr size_t CAPACITY = 200;
+    ClOrdIdTable ids(CAPACITY);
+    std::vector<std::pair<std::string, OrderId>> live;
+    uint64_t state = 7;
+    auto next = [&state](uint64_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % bound;
+    };
+    for (uint64_t i = 0; i < 20000; ++i) {
+        if (live.size() < CAPACITY && (live.empty() || next(3) != 0)) {
+            std::string cl_ord_id = "ORD-" + std::to_string(i);
+            const OrderId id = ids.assign(cl_ord_id);
+            ASSERT_NE(id, ClOrdIdTable::NO_ORDER);
+            live.emplace_back(std::move(cl_ord_id), id);
+        } else {
+            const size_t k = next(live.size());
+            ASSERT_TRUE(ids.release(live[k].second));
+            EXPECT_EQ(ids.find(live[k].first), ClOrdIdTable::NO_ORDER);
+            live[k] = live.back();
+            live.pop_back();
+        }
+        if (i % 1000 == 0) {
+            for (const auto& [cl_ord_id, id] : live) ASSERT_EQ(ids.find(cl_ord_id), id);
+        }
+    }
+    EXPECT_EQ(ids.size(), live.size());
+    for (const auto& [cl_ord_id, id] : live) EXPECT_EQ(ids.find(cl_ord_id), id);
+}
+
+TEST(ClOrdIdTable, SessionThroughTheGateway) {
+    InstrumentConfig cfg;
+    cfg.instrument_id = 3;
+    cfg.symbol = "BTCUSDT";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = PRICE_SCALE / 100;
+    cfg.max_orders = 100;
+    EventBuffer events;
+    auto pipeline = build_instrument_pipeline(cfg, &events);
+    ClOrdIdTable ids(16);
+
+    auto send = [&](const std::string& raw, FixError expected = FixError::None) {
+        OrderMessage om{};
+        EXPECT_EQ(FixParser::parse_into(raw, om, ids, cfg.instrument_id), expected) << raw;
+        if (expected != FixError::None) return;
+        ids.on_result(om, pipeline->gateway->process(om));
+        EventMessage e{};
+        while (events.try_pop(e)) ids.on_event(e);
+    };
+
+    send(make_new_order("BUY1", '1', "100.00", "10"));
+    send(make_new_order("BUY1", '1', "100.00", "10"), FixError::DuplicateClOrdID);
+    send(make_cancel("X1", "NOPE"), FixError::UnknownOrigClOrdID);
+    EXPECT_EQ(ids.find("BUY1"), 1u);
+    EXPECT_EQ(pipeline->book->order_count(), 1u);
+
+    // Accepted replace: only the new ClOrdID names the order
+    send(make_cancel_replace("BUY1-R", "BUY1", "101.00", "10"));
+    EXPECT_EQ(ids.find("BUY1"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.find("BUY1-R"), 1u);
+    EXPECT_EQ(pipeline->book->best_bid()->price, 101 * PRICE_SCALE);
+
+    // Refused replace (price out of range): the old ClOrdID stays
+    send(make_cancel_replace("BUY1-RR", "BUY1-R", "2000.00", "10"));
+    EXPECT_EQ(ids.find("BUY1-R"), 1u);
+    EXPECT_EQ(ids.find("BUY1-RR"), ClOrdIdTable::NO_ORDER);
+
+    // A sell that fills the resting buy reclaims both sides
+    send(make_new_order("SELL1", '2', "101.00", "10"));
+    EXPECT_EQ(pipeline->book->order_count(), 0u);
+    EXPECT_EQ(ids.find("BUY1-R"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.find("SELL1"), ClOrdIdTable::NO_ORDER);
+
+    // An IOC that cannot rest, and a cancel, reclaim their orders too
+    send(make_new_order("IOC1", '1', "100.00", "5", '2', '3'));
+    EXPECT_EQ(ids.find("IOC1"), ClOrdIdTable::NO_ORDER);
+    send(make_new_order("BUY2", '1', "99.00", "5"));
+    EXPECT_EQ(ids.find("BUY2"), 4u);
+    send(make_cancel("X2", "BUY2"));
+    EXPECT_EQ(ids.find("BUY2"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.size(), 0u);
+    EXPECT_EQ(ids.order_count(), 0u);
+    EXPECT_EQ(ids.next_order_id(), 5u);
+}
+
+TEST(ClOrdIdTable, SessionFromEventsAlone) {
+    // An order-entry server sees only the published events
+    InstrumentConfig cfg;
+    cfg.instrument_id = 3;
+    cfg.symbol = "BTCUSDT";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = PRICE_SCALE / 100;
+    cfg.max_orders = 100;
+    EventBuffer events;
+    auto pipeline = build_instrument_pipeline(cfg, &events);
+    ClOrdIdTable ids(16, 500);
+
+    auto send = [&](const std::string& raw) {
+        OrderMessage om{};
+        ASSERT_EQ(FixParser::parse_into(raw, om, ids, cfg.instrument_id), FixError::None);
+        (void)pipeline->gateway->process(om);
+        EventMessage e{};
+        while (events.try_pop(e)) ids.on_event(e);
+    };
+
+    // A rejected add is reclaimed; an accepted one is echoed by id
+    send(make_new_order("BAD", '1', "2000.00", "10"));
+    EXPECT_EQ(ids.find("BAD"), ClOrdIdTable::NO_ORDER);
+    send(make_new_order("BUY1", '1', "100.00", "10"));
+    EXPECT_EQ(ids.cl_ord_id(501), "BUY1");
+    EXPECT_EQ(ids.cl_ord_id(999), "");
+
+    // OrderModified keeps the new ClOrdID, OrderRejected of a live order
+    // (a refused amend) the old one
+    send(make_cancel_replace("BUY1-R", "BUY1", "101.00", "10"));
+    EXPECT_EQ(ids.find("BUY1"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.cl_ord_id(501), "BUY1-R");
+    send(make_cancel_replace("BUY1-RR", "BUY1-R", "2000.00", "10"));
+    EXPECT_EQ(ids.cl_ord_id(501), "BUY1-R");
+    EXPECT_EQ(ids.find("BUY1-RR"), ClOrdIdTable::NO_ORDER);
+
+    // Fills of both sides and a cancel reclaim everything
+    send(make_new_order("SELL1", '2', "101.00", "4"));
+    EXPECT_EQ(ids.find("SELL1"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.find("BUY1-R"), 501u);
+    send(make_cancel("X1", "BUY1-R"));
+    EXPECT_EQ(ids.find("BUY1-R"), ClOrdIdTable::NO_ORDER);
+    EXPECT_EQ(ids.size(), 0u);
+
+    // reset() starts a new session's numbering
+    ids.reset(900);
+    EXPECT_EQ(ids.assign("A"), 900u);
+}
+
+TEST(ExecutionReportWriter, EchoesTheSessionClOrdID) {
+    ExecutionReportWriter writer("BTCUSDT", "HFT-ENGINE", "CLIENT-7", '|');
+    EventMessage trade{};
+    trade.type = EventType::Trade;
+    trade.data.trade.trade_id = 77;
+    trade.data.trade.buy_order_id = 11;
+    trade.data.trade.sell_order_id = 22;
+    trade.data.trade.price = 100 * PRICE_SCALE;
+    trade.data.trade.quantity = 3;
+
+    std::string out(writer.max_report_bytes(), '\0');
+    const std::string cl_ord_id(ExecutionReportWriter::MAX_CL_ORD_ID, 'c');
+    out.resize(writer.write(trade, 22, cl_ord_id, &out[0], out.size()));
+    EXPECT_NE(out.find("|37=22|11=" + cl_ord_id + "|17=EXEC-77|"), std::string::npos) << out;
+    EXPECT_TRUE(FixParser::validate_checksum(out));
+
+    char small[8];
+    EXPECT_EQ(writer.write(trade, 22, cl_ord_id + "x", small, sizeof(small)), 0u);
+}
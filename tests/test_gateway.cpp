@@ -2,22 +2,33 @@
 /// @brief Unit tests for OrderGateway, MarketDataPublisher, and the
 ///        end-to-end event pipeline (Phase 5).
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <random>
 #include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 #include "core/order.h"
 #include "core/types.h"
+#include "gateway/conflated_market_state.h"
 #include "gateway/market_data_publisher.h"
+#include "gateway/metrics_region.h"
+#include "gateway/order_columns.h"
 #include "gateway/order_gateway.h"
+#include "gateway/pre_trade_risk.h"
 #include "matching/match_result.h"
 #include "matching/matching_engine.h"
+#include "orderbook/expiry_wheel.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
 #include "transport/event_buffer.h"
@@ -154,6 +165,35 @@ TEST_F(GatewayTest, RejectPoolExhausted) {
     EXPECT_EQ(events[0].type, EventType::OrderRejected);
 }
 
+TEST_F(GatewayTest, LocalityPoolGroupsOrdersByLevel) {
+    PoolLocality locality;
+    locality.colours = 8;
+    locality.hint_shift = 1;  // Pairs of neighbouring levels share a colour
+    MemoryPool<Order> local_pool(4096, {}, {}, locality);
+    MatchingEngine local_engine(*book, local_pool);
+    OrderGateway local_gw(local_engine, local_pool, buffer.get());
+
+    OrderId id = 1;
+    for (int round = 0; round < 4; ++round) {
+        for (Price p = 100; p < 116; ++p) {
+            auto msg = make_order_msg(id++, Side::Buy, OrderType::Limit,
+                                      p * PRICE_SCALE, 10);
+            ASSERT_TRUE(local_gw.process_order(msg).accepted);
+        }
+    }
+    drain_events(*buffer);
+
+    for (OrderId o = 1; o < id; ++o) {
+        const Order* order = book->find_order(o);
+        ASSERT_NE(order, nullptr);
+        EXPECT_EQ(local_pool.colour_of(order),
+                  local_pool.colour_for(book->level_hint(order->price)));
+    }
+    // Level index = price - 1 here: 101 and 102 are indices 100 and 101
+    EXPECT_EQ(local_pool.colour_for(book->level_hint(101 * PRICE_SCALE)),
+              local_pool.colour_for(book->level_hint(102 * PRICE_SCALE)));
+}
+
 // ===========================================================================
 // Gateway -> Matching engine integration
 // ===========================================================================
@@ -207,6 +247,111 @@ TEST_F(GatewayTest, CancelNonexistentFails) {
     EXPECT_FALSE(cancelled);
 }
 
+TEST_F(GatewayTest, MassCancelPublishesOneBatchedEvent) {
+    for (OrderId id = 1; id <= 5; ++id) {
+        (void)gateway->process_order(make_order_msg(
+            id, Side::Buy, OrderType::Limit,
+            static_cast<Price>(100 + id) * PRICE_SCALE, 10, id == 3 ? 2 : 1));
+    }
+    drain_events(*buffer);
+
+    MassCancelResult r = gateway->process_mass_cancel(1);
+    EXPECT_EQ(r.cancelled_count, 4u);
+    EXPECT_EQ(book->order_count(), 1u);
+
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, EventType::MassCancel);
+    EXPECT_EQ(events[0].data.mass_cancel.participant_id, 1u);
+    EXPECT_EQ(events[0].data.mass_cancel.side, 2u);
+    EXPECT_EQ(events[0].data.mass_cancel.cancelled_count, 4u);
+    EXPECT_EQ(events[0].data.mass_cancel.cancelled_quantity, 40u);
+
+    // Nothing left to cancel: no event
+    EXPECT_EQ(gateway->process_mass_cancel(1, Side::Buy).cancelled_count, 0u);
+    EXPECT_TRUE(drain_events(*buffer).empty());
+}
+
+TEST(GatewayLevelDeltaTest, PublishesLevelUpdatesPerCallOrPerBatch) {
+    OrderBookOptions opts;
+    opts.level_deltas = LevelDeltaMode::Conflated;
+    OrderBook book(1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 1000,
+                   opts);
+    MemoryPool<Order> pool(1000);
+    MatchingEngine engine(book, pool);
+    EventBuffer buffer;
+    OrderGateway gateway(engine, pool, &buffer);
+
+    // Single call: order status, then the level's new state
+    (void)gateway.process_order(make_order_msg(
+        1, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 10));
+    auto events = drain_events(buffer);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, EventType::OrderAccepted);
+    EXPECT_EQ(events[1].type, EventType::LevelUpdate);
+    EXPECT_EQ(events[1].data.level_update.price, 100 * PRICE_SCALE);
+    EXPECT_EQ(events[1].data.level_update.total_quantity, 10u);
+    EXPECT_EQ(events[1].data.level_update.order_count, 1u);
+    EXPECT_EQ(events[1].data.level_update.side, 1u);
+
+    // Batch: three changes to the ask level conflate into one update
+    OrderMessage msgs[3] = {
+        make_order_msg(2, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 5),
+        make_order_msg(3, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 12, 2),
+        make_order_msg(4, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 4, 2)};
+    GatewayResult results[3];
+    gateway.process_batch(msgs, 3, results);
+
+    events = drain_events(buffer);
+    std::vector<EventMessage> updates;
+    for (const auto& e : events) {
+        if (e.type == EventType::LevelUpdate) updates.push_back(e);
+    }
+    ASSERT_EQ(updates.size(), 2u);
+    EXPECT_EQ(updates[0].data.level_update.price, 100 * PRICE_SCALE);
+    EXPECT_EQ(updates[0].data.level_update.total_quantity, 3u);
+    EXPECT_EQ(updates[0].data.level_update.order_count, 1u);
+    EXPECT_EQ(updates[1].data.level_update.price, 99 * PRICE_SCALE);
+    EXPECT_EQ(updates[1].data.level_update.side, 0u);
+    EXPECT_EQ(events.back().type, EventType::LevelUpdate);
+}
+
+TEST_F(GatewayTest, MessageTimestampsDriveExpiry) {
+    ExpiryWheel wheel(64, 1);
+    engine->attach_expiry_wheel(&wheel);
+
+    auto gtd = make_order_msg(1, Side::Buy, OrderType::Limit,
+                              100 * PRICE_SCALE, 10);
+    gtd.order.time_in_force = TimeInForce::GTD;
+    gtd.order.expire_time = 2'000;
+    (void)gateway->process_order(gtd);
+    drain_events(*buffer);
+
+    // A later message expires the order before it is handled itself
+    auto next = make_order_msg(2, Side::Sell, OrderType::Limit,
+                               100 * PRICE_SCALE, 10);
+    next.order.timestamp = 2'500;
+    EXPECT_EQ(gateway->process_order(next).match_status, MatchStatus::Resting);
+
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, EventType::OrderExpired);
+    EXPECT_EQ(events[0].data.order_event.order_id, 1u);
+    EXPECT_EQ(events[0].data.order_event.status, OrderStatus::Expired);
+    EXPECT_EQ(events[0].data.order_event.remaining_quantity, 10u);
+    EXPECT_EQ(events[1].type, EventType::OrderAccepted);
+
+    // No traffic: wall time alone still expires
+    auto gtd2 = make_order_msg(3, Side::Buy, OrderType::Limit,
+                               90 * PRICE_SCALE, 10);
+    gtd2.order.timestamp = 2'600;
+    gtd2.order.time_in_force = TimeInForce::GTD;
+    gtd2.order.expire_time = 3'000;
+    (void)gateway->process_order(gtd2);
+    EXPECT_EQ(gateway->process_time(3'000), 1u);
+    EXPECT_EQ(book->order_count(), 1u);
+}
+
 // ===========================================================================
 // Event publishing
 // ===========================================================================
@@ -377,6 +522,35 @@ TEST_F(GatewayTest, TradesPublishedBeforeStatusEvents) {
     EXPECT_NE(events[1].type, EventType::Trade);
 }
 
+TEST_F(GatewayTest, LargeSweepPublishesEveryTrade) {
+    // 100 resting sells — more fills than a MatchResult can hold
+    constexpr OrderId N = 100;
+    for (OrderId i = 1; i <= N; ++i) {
+        auto sell = make_order_msg(i, Side::Sell, OrderType::Limit,
+                                   (100 + i) * PRICE_SCALE, 1,
+                                   /*participant=*/1);
+        (void)gateway->process_order(sell);
+    }
+    drain_events(*buffer);
+
+    auto buy = make_order_msg(N + 1, Side::Buy, OrderType::Limit,
+                              (100 + N) * PRICE_SCALE, N, /*participant=*/2);
+    auto result = gateway->process_order(buy);
+
+    EXPECT_EQ(result.match_status, MatchStatus::Filled);
+    EXPECT_EQ(result.trade_count, N);
+    EXPECT_EQ(result.filled_quantity, N);
+
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), N + 1);
+    for (OrderId i = 0; i < N; ++i) {
+        EXPECT_EQ(events[i].type, EventType::Trade);
+        EXPECT_EQ(events[i].data.trade.sell_order_id, i + 1);
+    }
+    EXPECT_EQ(events[N].type, EventType::OrderFilled);
+    EXPECT_EQ(book->order_count(), 0u);
+}
+
 TEST_F(GatewayTest, SelfTradePreventedPublishesOrderCancelled) {
     // Same participant (42) on both sides
     auto sell = make_order_msg(1, Side::Sell, OrderType::Limit,
@@ -641,6 +815,23 @@ TEST_F(GatewayTest, LastSequenceNumTracked) {
     EXPECT_EQ(publisher.last_sequence_num(), 2u);
 }
 
+TEST_F(GatewayTest, PublishersOnSeparateCursorsEachSeeEveryEvent) {
+    EventBuffer::ConsumerId journal_id = buffer->add_consumer();
+    ASSERT_NE(journal_id, EventBuffer::INVALID_CONSUMER);
+    MarketDataPublisher publisher(*buffer);
+    MarketDataPublisher journal(*buffer, journal_id);
+
+    for (OrderId i = 1; i <= 3; ++i) {
+        (void)gateway->process_order(make_order_msg(
+            i, Side::Buy, OrderType::Limit, (100 - i) * PRICE_SCALE, 10));
+    }
+
+    EXPECT_EQ(publisher.poll(), 3u);
+    EXPECT_EQ(journal.poll(), 2u + 1u);
+    EXPECT_EQ(journal.last_sequence_num(), 3u);
+    EXPECT_EQ(publisher.poll(), 0u);
+}
+
 // ===========================================================================
 // Null buffer
 // ===========================================================================
@@ -707,6 +898,210 @@ TEST_F(GatewayTest, MultiThreadedE2E) {
     }
 }
 
+TEST_F(GatewayTest, BlockingPublisherWakesOnPublishAndStop) {
+    WakeupSignal signal;
+    buffer->set_wakeup(&signal);
+    WaitConfig wait;
+    wait.strategy = WaitStrategy::Block;
+    wait.block_timeout_us = 10'000'000;  // Only a notify ends a wait in time
+    MarketDataPublisher publisher(*buffer, EventBuffer::PRIMARY, wait);
+    std::atomic<size_t> received{0};
+    publisher.register_callback([&](const EventMessage&) { ++received; });
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::thread pub_thread([&publisher]() { publisher.run(); });
+
+    constexpr int ORDER_COUNT = 20;
+    for (int i = 0; i < ORDER_COUNT; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        (void)gateway->process_order(make_order_msg(
+            static_cast<OrderId>(i + 1), Side::Buy, OrderType::Limit,
+            static_cast<Price>((100 - i) * PRICE_SCALE), 10));
+    }
+    while (received.load() < static_cast<size_t>(ORDER_COUNT)) {
+        std::this_thread::yield();
+    }
+    publisher.stop();
+    pub_thread.join();
+    buffer->set_wakeup(nullptr);
+
+    EXPECT_LT(std::chrono::steady_clock::now() - t0, std::chrono::seconds(5));
+    EXPECT_EQ(publisher.events_processed(), static_cast<uint64_t>(ORDER_COUNT));
+    EXPECT_GT(publisher.wait_stats().wakeups, 0u);
+    EXPECT_GT(signal.notifications(), 0u);
+}
+
+TEST_F(GatewayTest, PackedEventBufferCarriesTheSameStream) {
+    auto packed = std::make_unique<PackedEventBuffer>();
+    auto packed_book = std::make_unique<OrderBook>(
+        1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 10000);
+    auto packed_pool = std::make_unique<MemoryPool<Order>>(10000);
+    MatchingEngine packed_engine(*packed_book, *packed_pool);
+    OrderGateway packed_gw(packed_engine, *packed_pool, nullptr);
+    packed_gw.set_packed_event_buffer(packed.get());
+
+    // Rests, cancels and a crossing trade on both gateways
+    for (OrderGateway* gw : {gateway.get(), &packed_gw}) {
+        for (OrderId id = 1; id <= 6; ++id) {
+            (void)gw->process_order(make_order_msg(
+                id, Side::Sell, OrderType::Limit,
+                static_cast<Price>((100 + id) * PRICE_SCALE), 10));
+        }
+        for (OrderId id = 2; id <= 6; ++id) (void)gw->process_cancel(id);
+        auto buy = make_order_msg(7, Side::Buy, OrderType::Limit, 101 * PRICE_SCALE, 4);
+        buy.order.participant_id = 2;
+        (void)gw->process_order(buy);
+    }
+
+    std::vector<EventMessage> expected;
+    EventMessage e{};
+    while (buffer->try_pop(e)) expected.push_back(e);
+
+    MarketDataPublisher publisher(*packed);
+    std::vector<EventMessage> decoded;
+    publisher.register_callback([&](const EventMessage& ev) { decoded.push_back(ev); });
+    EXPECT_EQ(publisher.poll(), expected.size());
+
+    ASSERT_EQ(decoded.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(decoded[i].type, expected[i].type);
+        EXPECT_EQ(decoded[i].sequence_num, expected[i].sequence_num);
+        if (expected[i].type == EventType::Trade) {
+            EXPECT_EQ(std::memcmp(&decoded[i], &expected[i], sizeof(EventMessage)), 0);
+        } else {
+            EXPECT_EQ(decoded[i].data.order_event.order_id,
+                      expected[i].data.order_event.order_id);
+            EXPECT_EQ(decoded[i].data.order_event.remaining_quantity,
+                      expected[i].data.order_event.remaining_quantity);
+        }
+    }
+    // Five of the 13 events are cancels in the 32-byte form
+    EXPECT_LT(packed->bytes_published(), expected.size() * sizeof(EventMessage));
+}
+
+// ===========================================================================
+// Backpressure policies
+// ===========================================================================
+
+/// Rest and cancel `pairs` orders (two events each) through `gw`.
+static void add_cancel_pairs(OrderGateway& gw, OrderId first, size_t pairs) {
+    for (OrderId id = first; id < first + pairs; ++id) {
+        (void)gw.process_order(make_order_msg(id, Side::Buy, OrderType::Limit,
+                                              100 * PRICE_SCALE, 10));
+        (void)gw.process_cancel(id);
+    }
+}
+
+TEST_F(GatewayTest, SpillPolicyDeliversEveryEventInOrder) {
+    BackpressureConfig bp;
+    bp.policy = BackpressurePolicy::Spill;
+    bp.overflow_capacity = 1024;
+    gateway->set_backpressure(bp);
+
+    const size_t pairs = EventBuffer::capacity() / 2 + 200;  // 400 past full
+    add_cancel_pairs(*gateway, 1, pairs);
+    EXPECT_EQ(buffer->size(), EventBuffer::capacity());
+    EXPECT_EQ(gateway->pending_overflow(), 400u);
+    EXPECT_EQ(gateway->events_spilled(), 400u);
+    EXPECT_EQ(gateway->overflow_high_water(), 400u);
+    EXPECT_EQ(gateway->events_dropped(), 0u);
+
+    std::vector<EventMessage> events;
+    EventMessage e{};
+    do {
+        while (buffer->try_pop(e)) events.push_back(e);
+    } while (gateway->drain_overflow() != 0 || !buffer->empty());
+
+    ASSERT_EQ(events.size(), pairs * 2);
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ(events[i].sequence_num, i + 1);
+        EXPECT_EQ(events[i].type, (i % 2) ? EventType::OrderCancelled
+                                          : EventType::OrderAccepted);
+    }
+}
+
+TEST_F(GatewayTest, ConflatePolicyKeepsLatestStateAndEveryTrade) {
+    BackpressureConfig bp;
+    bp.policy = BackpressurePolicy::Conflate;
+    gateway->set_backpressure(bp);
+
+    // Fill the ring, then spill 100 add/cancel pairs and one trade
+    add_cancel_pairs(*gateway, 1, EventBuffer::capacity() / 2);
+    const OrderId first = EventBuffer::capacity() / 2 + 1;
+    add_cancel_pairs(*gateway, first, 100);
+    (void)gateway->process_order(make_order_msg(
+        900000, Side::Sell, OrderType::Limit, 200 * PRICE_SCALE, 5));
+    auto buy = make_order_msg(900001, Side::Buy, OrderType::Limit, 200 * PRICE_SCALE, 5, 2);
+    (void)gateway->process_order(buy);
+
+    // Each cancel superseded its order's acceptance
+    EXPECT_EQ(gateway->events_conflated(), 100u);
+    (void)drain_events(*buffer);
+    while (gateway->drain_overflow() != 0) (void)drain_events(*buffer);
+    auto events = drain_events(*buffer);
+
+    ASSERT_EQ(events.size(), 100u + 3u);  // Cancels, accept, trade, fill
+    uint64_t last_seq = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(events[i].type, EventType::OrderCancelled);
+        EXPECT_EQ(events[i].data.order_event.order_id, first + i);
+        EXPECT_GT(events[i].sequence_num, last_seq + 1);  // Gap = conflated
+        last_seq = events[i].sequence_num;
+    }
+    EXPECT_EQ(events[100].type, EventType::OrderAccepted);
+    EXPECT_EQ(events[101].type, EventType::Trade);
+    EXPECT_EQ(events[102].type, EventType::OrderFilled);
+    EXPECT_EQ(events[102].data.order_event.order_id, 900001u);
+}
+
+TEST_F(GatewayTest, ConflateNeverMixesARejectWithTheLiveOrder) {
+    BackpressureConfig bp;
+    bp.policy = BackpressurePolicy::Conflate;
+    gateway->set_backpressure(bp);
+    add_cancel_pairs(*gateway, 1, EventBuffer::capacity() / 2);
+
+    // A duplicate-ID add is rejected; the live order keeps its acceptance
+    const OrderId id = 900000;
+    (void)gateway->process_order(make_order_msg(
+        id, Side::Sell, OrderType::Limit, 200 * PRICE_SCALE, 5));
+    (void)gateway->process_order(make_order_msg(
+        id, Side::Sell, OrderType::Limit, 201 * PRICE_SCALE, 7));
+    (void)gateway->process_order(make_order_msg(
+        id, Side::Sell, OrderType::Limit, 202 * PRICE_SCALE, 9));
+    EXPECT_EQ(gateway->events_conflated(), 0u);
+
+    (void)drain_events(*buffer);
+    while (gateway->drain_overflow() != 0) (void)drain_events(*buffer);
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].type, EventType::OrderAccepted);
+    EXPECT_EQ(events[0].data.order_event.price, 200 * PRICE_SCALE);
+    EXPECT_EQ(events[1].type, EventType::OrderRejected);
+    EXPECT_EQ(events[2].type, EventType::OrderRejected);
+    EXPECT_NE(book->find_order(id), nullptr);
+}
+
+TEST_F(GatewayTest, BlockTimeoutDropsAndMeasuresBlockedTime) {
+    BackpressureConfig bp;
+    bp.block_timeout_ns = 20'000;
+    gateway->set_backpressure(bp);
+
+    add_cancel_pairs(*gateway, 1, EventBuffer::capacity() / 2 + 3);
+    EXPECT_EQ(gateway->events_dropped(), 6u);
+    EXPECT_EQ(gateway->backpressure_count(), 6u);
+    EXPECT_GE(gateway->backpressure_ns(), 6u * 20'000u);
+    EXPECT_EQ(gateway->pending_overflow(), 0u);
+
+    // The stream ends at the ring's capacity; the drops leave a gap
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), EventBuffer::capacity());
+    EXPECT_EQ(events.back().sequence_num, EventBuffer::capacity());
+    add_cancel_pairs(*gateway, 900000, 1);
+    events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].sequence_num, EventBuffer::capacity() + 7);
+}
+
 // ===========================================================================
 // Statistics
 // ===========================================================================
@@ -741,3 +1136,781 @@ TEST_F(GatewayTest, OrdersRejectedCounter) {
     EXPECT_EQ(gateway->orders_rejected(), 2u);
     EXPECT_EQ(gateway->orders_processed(), 0u);
 }
+
+// ===========================================================================
+// Batch submission
+// ===========================================================================
+
+TEST_F(GatewayTest, BatchMatchesSequentialProcessing) {
+    // Mixed add / cancel / modify stream around a narrow price band so
+    // plenty of messages cross or hit live orders.
+    std::mt19937 rng(7);
+    std::vector<OrderMessage> msgs;
+    OrderId next_id = 1;
+    for (int i = 0; i < 2000; ++i) {
+        Side side = (rng() & 1) ? Side::Buy : Side::Sell;
+        Price price = static_cast<Price>(95 + rng() % 11) * PRICE_SCALE;
+        Quantity qty = 1 + rng() % 20;
+        int kind = static_cast<int>(rng() % 10);
+        if (kind < 6 || next_id == 1) {
+            msgs.push_back(make_order_msg(next_id++, side, OrderType::Limit,
+                                          price, qty, 1 + rng() % 3));
+        } else {
+            OrderMessage msg = make_order_msg(1 + rng() % (next_id - 1), side,
+                                              OrderType::Limit, price, qty);
+            msg.type = (kind < 8) ? MessageType::Cancel : MessageType::Modify;
+            msgs.push_back(msg);
+        }
+    }
+
+    // Reference: one message at a time on a second pipeline
+    OrderBook ref_book(1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE,
+                       10000);
+    MemoryPool<Order> ref_pool(10000);
+    MatchingEngine ref_engine(ref_book, ref_pool);
+    EventBuffer ref_buffer;
+    OrderGateway ref_gateway(ref_engine, ref_pool, &ref_buffer);
+
+    std::vector<GatewayResult> expected;
+    for (const auto& msg : msgs) expected.push_back(ref_gateway.process(msg));
+
+    std::vector<GatewayResult> actual(msgs.size());
+    gateway->process_batch(msgs.data(), msgs.size(), actual.data());
+
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        ASSERT_EQ(actual[i].accepted, expected[i].accepted) << i;
+        EXPECT_EQ(actual[i].reject_reason, expected[i].reject_reason) << i;
+        EXPECT_EQ(actual[i].match_status, expected[i].match_status) << i;
+        EXPECT_EQ(actual[i].trade_count, expected[i].trade_count) << i;
+        EXPECT_EQ(actual[i].filled_quantity, expected[i].filled_quantity) << i;
+    }
+
+    auto ref_events = drain_events(ref_buffer);
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), ref_events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        EXPECT_EQ(events[i].type, ref_events[i].type) << i;
+        EXPECT_EQ(events[i].sequence_num, ref_events[i].sequence_num) << i;
+    }
+
+    EXPECT_EQ(book->order_count(), ref_book.order_count());
+    EXPECT_EQ(book->spread(), ref_book.spread());
+}
+
+TEST(GatewayDigestTest, StampsEveryNthCallWhateverTheBatching) {
+    // Mixed stream as above, run one at a time and in batches of 7
+    std::mt19937 rng(13);
+    std::vector<OrderMessage> msgs;
+    OrderId next_id = 1;
+    for (int i = 0; i < 600; ++i) {
+        Side side = (rng() & 1) ? Side::Buy : Side::Sell;
+        Price price = static_cast<Price>(95 + rng() % 11) * PRICE_SCALE;
+        Quantity qty = 1 + rng() % 20;
+        int kind = static_cast<int>(rng() % 10);
+        if (kind < 6 || next_id == 1) {
+            msgs.push_back(make_order_msg(next_id++, side, OrderType::Limit,
+                                          price, qty, 1 + rng() % 3));
+        } else {
+            OrderMessage msg = make_order_msg(1 + rng() % (next_id - 1), side,
+                                              OrderType::Limit, price, qty);
+            msg.type = (kind < 8) ? MessageType::Cancel : MessageType::Modify;
+            msgs.push_back(msg);
+        }
+    }
+
+    struct Pipeline {
+        OrderBook book;
+        MemoryPool<Order> pool;
+        MatchingEngine engine;
+        EventBuffer buffer;
+        OrderGateway gateway;
+        explicit Pipeline(const OrderBookOptions& opts)
+            : book(1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 10000, opts),
+              pool(10000),
+              engine(book, pool),
+              gateway(engine, pool, &buffer) {
+            gateway.set_digest_every(5);
+        }
+    };
+    OrderBookOptions opts;
+    opts.state_digest = true;
+    auto single = std::make_unique<Pipeline>(opts);
+    auto batched = std::make_unique<Pipeline>(opts);
+
+    std::vector<EventMessage> single_events, batched_events;
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        (void)single->gateway.process(msgs[i]);
+        for (const auto& e : drain_events(single->buffer)) single_events.push_back(e);
+        ASSERT_EQ(single->book.state_digest(), single->book.compute_state_digest()) << i;
+    }
+    std::vector<GatewayResult> results(7);
+    for (size_t i = 0; i < msgs.size(); i += 7) {
+        const size_t n = std::min<size_t>(7, msgs.size() - i);
+        batched->gateway.process_batch(msgs.data() + i, n, results.data());
+        for (const auto& e : drain_events(batched->buffer)) batched_events.push_back(e);
+    }
+
+    ASSERT_EQ(single_events.size(), batched_events.size());
+    size_t stamps = 0;
+    for (size_t i = 0; i < single_events.size(); ++i) {
+        ASSERT_EQ(single_events[i].type, batched_events[i].type) << i;
+        EXPECT_EQ(single_events[i].sequence_num, batched_events[i].sequence_num) << i;
+        if (single_events[i].type != EventType::BookDigest) continue;
+        ++stamps;
+        EXPECT_EQ(single_events[i].data.book_digest.digest,
+                  batched_events[i].data.book_digest.digest) << i;
+        EXPECT_EQ(single_events[i].data.book_digest.order_count,
+                  batched_events[i].data.book_digest.order_count) << i;
+    }
+    EXPECT_GT(stamps, 50u);
+    EXPECT_EQ(single->book.state_digest(), batched->book.state_digest());
+}
+
+TEST_F(GatewayTest, BatchCancelReportsOutcome) {
+    OrderMessage msgs[3] = {
+        make_order_msg(1, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 10),
+        make_order_msg(1, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 10),
+        make_order_msg(1, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 10),
+    };
+    msgs[1].type = MessageType::Cancel;
+    msgs[2].type = MessageType::Cancel;
+
+    GatewayResult results[3];
+    gateway->process_batch(msgs, 3, results);
+
+    EXPECT_EQ(results[0].match_status, MatchStatus::Resting);
+    EXPECT_TRUE(results[1].accepted);
+    EXPECT_EQ(results[1].match_status, MatchStatus::Cancelled);
+    EXPECT_FALSE(results[2].accepted);
+    EXPECT_EQ(results[2].reject_reason, GatewayRejectReason::OrderNotFound);
+    EXPECT_TRUE(book->empty());
+}
+
+TEST_F(GatewayTest, OrderColumnsMatchOneMessageAtATime) {
+    // Several chunks of crossing limits, IOCs and markets
+    std::mt19937 rng(11);
+    const size_t n = 3 * ORDER_COLUMNS_CHUNK + 5;
+    std::vector<OrderId> ids(n);
+    std::vector<uint8_t> sides(n);
+    std::vector<Price> prices(n);
+    std::vector<Quantity> quantities(n);
+    std::vector<uint8_t> types(n);
+    std::vector<ParticipantId> participants(n);
+    std::vector<Timestamp> timestamps(n);
+    for (size_t i = 0; i < n; ++i) {
+        ids[i] = i + 1;
+        sides[i] = static_cast<uint8_t>(rng() & 1);
+        prices[i] = static_cast<Price>(95 + rng() % 11) * PRICE_SCALE;
+        quantities[i] = 1 + rng() % 20;
+        const unsigned kind = rng() % 10;
+        types[i] = static_cast<uint8_t>(kind < 7 ? OrderType::Limit
+                                        : kind < 9 ? OrderType::IOC : OrderType::Market);
+        participants[i] = 1 + rng() % 3;
+        timestamps[i] = 1000 + i;
+    }
+
+    OrderBook ref_book(1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 10000);
+    MemoryPool<Order> ref_pool(10000);
+    MatchingEngine ref_engine(ref_book, ref_pool);
+    OrderGateway ref_gateway(ref_engine, ref_pool, nullptr);
+    std::vector<GatewayResult> expected;
+    for (size_t i = 0; i < n; ++i) {
+        OrderMessage msg = make_order_msg(ids[i], static_cast<Side>(sides[i]),
+                                          static_cast<OrderType>(types[i]), prices[i],
+                                          quantities[i], participants[i]);
+        msg.order.timestamp = timestamps[i];
+        expected.push_back(ref_gateway.process_order(msg));
+    }
+
+    OrderColumns orders;
+    orders.count = n;
+    orders.order_ids = ids.data();
+    orders.sides = sides.data();
+    orders.prices = prices.data();
+    orders.quantities = quantities.data();
+    orders.types = types.data();
+    orders.participant_ids = participants.data();
+    orders.timestamps = timestamps.data();
+    std::vector<GatewayResult> results(n);
+    submit_order_columns(*gateway, orders, results.data());
+
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(results[i].accepted, expected[i].accepted) << i;
+        EXPECT_EQ(results[i].match_status, expected[i].match_status) << i;
+        EXPECT_EQ(results[i].trade_count, expected[i].trade_count) << i;
+        EXPECT_EQ(results[i].filled_quantity, expected[i].filled_quantity) << i;
+        EXPECT_EQ(results[i].remaining_quantity, expected[i].remaining_quantity) << i;
+    }
+    EXPECT_EQ(book->order_count(), ref_book.order_count());
+    EXPECT_EQ(book->spread(), ref_book.spread());
+
+    // Cancel everything: resting orders go, the rest were never there
+    std::vector<GatewayResult> cancels(n);
+    cancel_order_columns(*gateway, ids.data(), n, cancels.data());
+    size_t cancelled = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (cancels[i].accepted) {
+            EXPECT_EQ(cancels[i].match_status, MatchStatus::Cancelled) << i;
+            ++cancelled;
+        } else {
+            EXPECT_EQ(cancels[i].reject_reason, GatewayRejectReason::OrderNotFound) << i;
+        }
+    }
+    EXPECT_EQ(cancelled, ref_book.order_count());
+    EXPECT_TRUE(book->empty());
+}
+
+TEST_F(GatewayTest, AuctionUncrossPublishesTrades) {
+    engine->begin_auction();
+    auto buy = make_order_msg(1, Side::Buy, OrderType::Limit,
+                              101 * PRICE_SCALE, 10, /*participant=*/1);
+    auto sell = make_order_msg(2, Side::Sell, OrderType::Limit,
+                               100 * PRICE_SCALE, 10, /*participant=*/2);
+    EXPECT_EQ(gateway->process_order(buy).match_status, MatchStatus::Resting);
+    EXPECT_EQ(gateway->process_order(sell).match_status, MatchStatus::Resting);
+    drain_events(*buffer);
+
+    AuctionResult result = gateway->process_uncross(5000);
+    EXPECT_EQ(result.trade_count, 1u);
+
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, EventType::Trade);
+    EXPECT_EQ(events[0].data.trade.quantity, 10u);
+    EXPECT_EQ(events[0].data.trade.price, 100 * PRICE_SCALE);
+    EXPECT_TRUE(book->empty());
+}
+
+TEST_F(GatewayTest, QuoteSnapshotPublishedPerCallAndOncePerBatch) {
+    QuoteSnapshotSlot slot;
+    gateway->set_quote_snapshot(&slot);
+
+    (void)gateway->process_order(make_order_msg(1, Side::Buy, OrderType::Limit,
+                                                99 * PRICE_SCALE, 10));
+    EXPECT_EQ(slot.version(), 2u);
+
+    std::vector<OrderMessage> msgs;
+    for (OrderId id = 2; id <= 5; ++id) {
+        msgs.push_back(make_order_msg(id, Side::Sell, OrderType::Limit,
+                                      (99 + id) * PRICE_SCALE, 5));
+    }
+    msgs.push_back(make_order_msg(6, Side::Buy, OrderType::Limit, 101 * PRICE_SCALE, 5, 2));
+    std::vector<GatewayResult> results(msgs.size());
+    gateway->process_batch(msgs.data(), msgs.size(), results.data());
+    EXPECT_EQ(slot.version(), 4u);
+
+    QuoteSnapshot snap{};
+    ASSERT_TRUE(slot.read(snap));
+    EXPECT_EQ(snap.bids[0].price, 99 * PRICE_SCALE);
+    EXPECT_EQ(snap.asks[0].price, 102 * PRICE_SCALE);
+    EXPECT_EQ(snap.ask_levels, 3u);
+    EXPECT_EQ(snap.last_trade_price, 101 * PRICE_SCALE);
+
+    // A rejected order leaves the book, and the snapshot, alone
+    (void)gateway->process_order(make_order_msg(7, Side::Buy, OrderType::Limit,
+                                                99 * PRICE_SCALE, 0));
+    EXPECT_EQ(slot.version(), 4u);
+}
+
+TEST_F(GatewayTest, MetricsPublishedPerCallAndOncePerBatch) {
+    MetricsRegion region;
+    ASSERT_TRUE(region.open(""));
+    GatewayMetrics metrics;
+    metrics.bind(region);
+    PublisherMetrics published;
+    published.bind(region, "publisher", 1);
+    gateway->set_metrics(&metrics);
+    MarketDataPublisher publisher(*buffer);
+    publisher.set_metrics(&published);
+
+    (void)gateway->process_order(make_order_msg(1, Side::Buy, OrderType::Limit,
+                                                99 * PRICE_SCALE, 10));
+    EXPECT_EQ(metrics.orders_processed.value(), 1u);
+    EXPECT_EQ(metrics.pool_in_use.value(), 1);
+
+    std::vector<OrderMessage> msgs;
+    msgs.push_back(make_order_msg(2, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 5));
+    msgs.push_back(make_order_msg(3, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 0));
+    msgs.push_back(make_order_msg(4, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 5, 2));
+    std::vector<GatewayResult> results(msgs.size());
+    gateway->process_batch(msgs.data(), msgs.size(), results.data());
+
+    EXPECT_EQ(metrics.orders_processed.value(), gateway->orders_processed());
+    EXPECT_EQ(metrics.orders_rejected.value(), 1u);
+    EXPECT_EQ(metrics.events_published.value(), gateway->sequence_number());
+    EXPECT_EQ(metrics.pool_in_use.value(), static_cast<int64_t>(pool->size()));
+    EXPECT_EQ(metrics.pool_high_water.value(), static_cast<int64_t>(pool->high_water_mark()));
+    EXPECT_EQ(published.events_processed.value(), 0u);
+
+    const size_t n = publisher.poll();
+    EXPECT_EQ(published.events_processed.value(), n);
+    EXPECT_EQ(published.last_sequence.value(),
+              static_cast<int64_t>(gateway->sequence_number()));
+
+    const MetricSlot* slot = region.find("gateway.orders_rejected");
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(slot->kind, MetricKind::Counter);
+    EXPECT_EQ(slot->value.load(), 1u);
+    ASSERT_NE(region.find("publisher.events_processed", 1), nullptr);
+    EXPECT_EQ(region.find("publisher.events_processed", 0), nullptr);
+}
+
+// ===========================================================================
+// Live metrics region
+// ===========================================================================
+
+TEST(MetricsRegionTest, RegistersUntilFull) {
+    MetricsRegion region;
+    EXPECT_FALSE(region.add_counter("closed").bound());
+    ASSERT_TRUE(region.open("", MetricsRegion::Layout{3, 1}));
+
+    MetricCounter counter = region.add_counter("a_counter_with_a_name_longer_than_the_slot", 7);
+    MetricGauge gauge = region.add_gauge("gauge");
+    HdrHistogram* histogram = region.add_histogram("latency");
+    ASSERT_TRUE(counter.bound());
+    ASSERT_TRUE(gauge.bound());
+    ASSERT_NE(histogram, nullptr);
+    EXPECT_FALSE(region.add_counter("no_room").bound());
+    EXPECT_EQ(region.add_histogram("no_room"), nullptr);
+    EXPECT_EQ(region.slot_count(), 3u);
+
+    counter.add(5);
+    counter.add();
+    gauge.set(-42);
+    histogram->record(100);
+    histogram->record(300);
+    EXPECT_EQ(counter.value(), 6u);
+    EXPECT_EQ(gauge.value(), -42);
+
+    EXPECT_STREQ(region.slot(0).name, "a_counter_with_a_name_longer_than_the_s");
+    EXPECT_EQ(region.slot(0).thread, 7u);
+    EXPECT_EQ(region.slot(1).value.load(), static_cast<uint64_t>(int64_t{-42}));
+    EXPECT_EQ(region.slot(2).kind, MetricKind::Histogram);
+    EXPECT_EQ(region.slot(2).value.load(), 0u);   // Histogram block 0
+    EXPECT_EQ(histogram->count(), 2u);
+    EXPECT_EQ(histogram->max(), 300u);
+
+    // Slots sit on their own cache lines
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&region.slot(1)) % 64, 0u);
+}
+
+TEST(MetricsRegionTest, SharedRegionIsReadableFromAnotherMapping) {
+    const std::string name = "/hft_test_metrics_" + std::to_string(::getpid());
+    MetricsRegion region;
+    ASSERT_TRUE(region.open(name)) << region.error();
+    EXPECT_EQ(region.name(), name);
+    MetricCounter counter = region.add_counter("events");
+    HdrHistogram* histogram = region.add_histogram("batch_ticks");
+    ASSERT_NE(histogram, nullptr);
+    counter.set(1234);
+    for (uint64_t v = 1; v <= 1000; ++v) histogram->record(v * 10);
+
+    // What the exporter sees: a second, read-only mapping of the object
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    void* map = ::mmap(nullptr, region.size_bytes(), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(map, MAP_FAILED);
+    const auto* base = static_cast<const char*>(map);
+    const auto* header = reinterpret_cast<const MetricsHeader*>(base);
+    EXPECT_EQ(std::memcmp(header->magic, METRICS_MAGIC, sizeof(header->magic)), 0);
+    EXPECT_EQ(header->pid, static_cast<uint32_t>(::getpid()));
+    ASSERT_EQ(header->slot_count.load(), 2u);
+    const auto* slots = reinterpret_cast<const MetricSlot*>(base + sizeof(MetricsHeader));
+    EXPECT_STREQ(slots[0].name, "events");
+    EXPECT_EQ(slots[0].value.load(), 1234u);
+    EXPECT_EQ(slots[1].kind, MetricKind::Histogram);
+    const auto* storage = reinterpret_cast<const HdrHistogram::Storage*>(
+        base + header->histogram_offset + header->histogram_stride * slots[1].value.load());
+    EXPECT_EQ(storage->total.load(), 1000u);
+    EXPECT_EQ(storage->max.load(), 10000u);
+    EXPECT_EQ(storage->counts[HdrHistogram::bucket_index(500)].load(), 1u);
+
+    counter.add(1);   // Live updates show through
+    EXPECT_EQ(slots[0].value.load(), 1235u);
+    ::munmap(map, region.size_bytes());
+
+    region.close();
+    EXPECT_LT(::shm_open(name.c_str(), O_RDONLY, 0), 0);   // Unlinked
+}
+
+// ===========================================================================
+// Pre-trade risk
+// ===========================================================================
+
+TEST_F(GatewayTest, RiskRejectsOrdersBreachingPerOrderLimits) {
+    RiskConfig config;
+    config.limits.max_order_quantity = 100;
+    config.limits.max_order_notional = 5000;   // Price units
+    config.limits.price_band_bps = 500;        // 5% of the mid
+    config.max_participants = 8;
+    PreTradeRisk risk(config);
+    gateway->set_risk(&risk);
+
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        1, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 10)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        2, Side::Sell, OrderType::Limit, 101 * PRICE_SCALE, 10)).accepted);
+    (void)drain_events(*buffer);
+
+    GatewayResult r = gateway->process_order(make_order_msg(
+        3, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 101));
+    EXPECT_FALSE(r.accepted);
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::OrderQuantity), 1u);
+
+    // 99 x 60 = 5940 > 5000; a market order is valued at the mid (100)
+    r = gateway->process_order(make_order_msg(
+        4, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 60));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    r = gateway->process_order(make_order_msg(
+        5, Side::Buy, OrderType::Market, 0, 51));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::OrderNotional), 2u);
+
+    // 106 is 6% away from the mid of 100
+    r = gateway->process_order(make_order_msg(
+        6, Side::Buy, OrderType::Limit, 106 * PRICE_SCALE, 10));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::PriceBand), 1u);
+
+    r = gateway->process_order(make_order_msg(
+        7, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 10, 8));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::UnknownParticipant), 1u);
+
+    // Each rejection is published and never reaches the book
+    auto events = drain_events(*buffer);
+    ASSERT_EQ(events.size(), 5u);
+    for (const auto& e : events) EXPECT_EQ(e.type, EventType::OrderRejected);
+    EXPECT_EQ(book->order_count(), 2u);
+    EXPECT_EQ(gateway->orders_rejected(), 5u);
+
+    // An amendment is checked as the order would stand
+    OrderMessage modify = make_order_msg(1, Side::Buy, OrderType::Limit,
+                                         99 * PRICE_SCALE, 500);
+    modify.type = MessageType::Modify;
+    r = gateway->process_modify(modify);
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(book->find_order(1)->quantity, 10u);
+}
+
+TEST_F(GatewayTest, RiskTracksOpenOrdersThroughTheirLifecycle) {
+    RiskConfig config;
+    config.limits.max_open_orders = 2;
+    config.max_participants = 8;
+    PreTradeRisk risk(config);
+    gateway->set_risk(&risk);
+
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        1, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 10)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        2, Side::Buy, OrderType::Limit, 98 * PRICE_SCALE, 10)).accepted);
+    EXPECT_EQ(risk.open_orders(1), 2u);
+
+    GatewayResult r = gateway->process_order(make_order_msg(
+        3, Side::Buy, OrderType::Limit, 97 * PRICE_SCALE, 10));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::OpenOrders), 1u);
+
+    // A cancel frees a slot; an IOC never takes one
+    EXPECT_TRUE(gateway->process_cancel(2));
+    EXPECT_EQ(risk.open_orders(1), 1u);
+    auto ioc = make_order_msg(4, Side::Buy, OrderType::IOC, 97 * PRICE_SCALE, 10);
+    ioc.order.time_in_force = TimeInForce::IOC;
+    EXPECT_TRUE(gateway->process_order(ioc).accepted);
+    EXPECT_EQ(risk.open_orders(1), 1u);
+
+    // A fill that takes the resting order out frees its slot
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        5, Side::Sell, OrderType::Limit, 99 * PRICE_SCALE, 10, 2)).accepted);
+    EXPECT_EQ(risk.open_orders(1), 0u);
+    EXPECT_EQ(risk.open_orders(2), 0u);
+
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        6, Side::Buy, OrderType::Limit, 99 * PRICE_SCALE, 10)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        7, Side::Sell, OrderType::Limit, 101 * PRICE_SCALE, 10)).accepted);
+    (void)gateway->process_mass_cancel(1);
+    EXPECT_EQ(risk.open_orders(1), 0u);
+}
+
+TEST_F(GatewayTest, RiskCountsAnElectedStopThatRests) {
+    StopBook stops(*book, 100);
+    engine->attach_stop_book(&stops);
+    RiskConfig config;
+    config.max_participants = 8;
+    PreTradeRisk risk(config);
+    gateway->set_risk(&risk);
+
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        1, Side::Buy, OrderType::Limit, 90 * PRICE_SCALE, 10)).accepted);
+    auto stop = make_order_msg(2, Side::Buy, OrderType::StopLimit, 99 * PRICE_SCALE, 10);
+    stop.order.stop_price = 100 * PRICE_SCALE;
+    EXPECT_TRUE(gateway->process_order(stop).accepted);
+    EXPECT_EQ(risk.open_orders(1), 1u);  // Waiting in the stop book
+
+    // A print at 100 elects the stop-limit, which rests at 99
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        3, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 5, 2)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        4, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 5, 3)).accepted);
+    ASSERT_NE(book->find_order(2), nullptr);
+    EXPECT_EQ(risk.open_orders(1), 2u);
+
+    // Cancelling it gives back only its own slot
+    EXPECT_TRUE(gateway->process_cancel(2));
+    EXPECT_EQ(risk.open_orders(1), 1u);
+    EXPECT_TRUE(gateway->process_cancel(1));
+    EXPECT_EQ(risk.open_orders(1), 0u);
+}
+
+TEST_F(GatewayTest, RiskCreditsElectedStopFillsToTheirOwner) {
+    StopBook stops(*book, 100);
+    engine->attach_stop_book(&stops);
+    RiskConfig config;
+    config.limits.max_position = 15;
+    config.max_participants = 8;
+    PreTradeRisk risk(config);
+    gateway->set_risk(&risk);
+    RiskLimits wide = config.limits;
+    wide.max_position = 1000;
+    for (ParticipantId p : {2u, 3u, 4u}) ASSERT_TRUE(risk.set_limits(p, wide));
+
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        1, Side::Sell, OrderType::Limit, 101 * PRICE_SCALE, 60, 2)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        2, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 5, 4)).accepted);
+    // Five buy stops of 10: each passes on its own, together they are 50 > 15
+    for (OrderId id = 10; id < 15; ++id) {
+        auto stop = make_order_msg(id, Side::Buy, OrderType::Stop, 0, 10, 1);
+        stop.order.stop_price = 100 * PRICE_SCALE;
+        EXPECT_TRUE(gateway->process_order(stop).accepted);
+    }
+
+    // Participant 3 prints at 100 and rests 10 there; the elected stops
+    // take that 10 and 40 of participant 2's offer
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        3, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 15, 3)).accepted);
+    EXPECT_EQ(book->find_order(3), nullptr);
+    EXPECT_EQ(risk.position(1), 50);
+    EXPECT_EQ(risk.position(2), -40);
+    EXPECT_EQ(risk.position(3), -15);
+    EXPECT_EQ(risk.position(4), 5);
+    EXPECT_EQ(risk.open_orders(1), 0u);
+    EXPECT_EQ(risk.open_orders(2), 1u);
+    EXPECT_EQ(risk.open_orders(3), 0u);
+    EXPECT_EQ(risk.open_orders(4), 0u);
+
+    // The owner's position now blocks further buying
+    GatewayResult r = gateway->process_order(make_order_msg(
+        20, Side::Buy, OrderType::Limit, 101 * PRICE_SCALE, 1, 1));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::Position), 1u);
+}
+
+TEST_F(GatewayTest, RiskReleasesRestingOrdersCancelledBySelfTradePrevention) {
+    for (auto mode : {SelfTradePreventionMode::CancelOldest,
+                      SelfTradePreventionMode::CancelBoth}) {
+        gateway.reset();
+        engine.reset();
+        book = std::make_unique<OrderBook>(
+            1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 10000);
+        engine = std::make_unique<MatchingEngine>(*book, *pool, mode);
+        gateway = std::make_unique<OrderGateway>(*engine, *pool, buffer.get());
+        RiskConfig config;
+        config.limits.max_open_orders = 3;
+        config.max_participants = 8;
+        PreTradeRisk risk(config);
+        gateway->set_risk(&risk);
+
+        // Each order crosses the last one of the same participant
+        for (OrderId id = 1; id <= 6; ++id) {
+            const Side side = (id % 2) ? Side::Sell : Side::Buy;
+            EXPECT_TRUE(gateway->process_order(make_order_msg(
+                id, side, OrderType::Limit, 100 * PRICE_SCALE, 10)).accepted) << id;
+            EXPECT_EQ(risk.open_orders(1), book->order_count()) << id;
+        }
+        EXPECT_EQ(book->order_count(),
+                  mode == SelfTradePreventionMode::CancelOldest ? 1u : 0u);
+        EXPECT_EQ(risk.rejects(RiskReject::OpenOrders), 0u);
+    }
+}
+
+TEST_F(GatewayTest, RiskPositionLimitCountsBothSidesOfEachFill) {
+    RiskConfig config;
+    config.limits.max_position = 15;
+    config.max_participants = 8;
+    PreTradeRisk risk(config);
+    gateway->set_risk(&risk);
+
+    // Participant 2 rests 30 to sell; participant 1 lifts 10 of it
+    RiskLimits wide = config.limits;
+    wide.max_position = 100;
+    ASSERT_TRUE(risk.set_limits(2, wide));
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        1, Side::Sell, OrderType::Limit, 100 * PRICE_SCALE, 30, 2)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        2, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 10, 1)).accepted);
+    EXPECT_EQ(risk.position(1), 10);
+    EXPECT_EQ(risk.position(2), -10);
+    EXPECT_EQ(risk.open_orders(2), 1u);
+
+    // Another 10 would take participant 1 to 20 > 15; selling reduces it
+    GatewayResult r = gateway->process_order(make_order_msg(
+        3, Side::Buy, OrderType::Limit, 100 * PRICE_SCALE, 10, 1));
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::RiskLimit);
+    EXPECT_EQ(risk.rejects(RiskReject::Position), 1u);
+    EXPECT_TRUE(gateway->process_order(make_order_msg(
+        4, Side::Sell, OrderType::Limit, 101 * PRICE_SCALE, 20, 1)).accepted);
+
+    EXPECT_EQ(risk.position(1), 10);
+    EXPECT_FALSE(risk.set_limits(8, wide));
+}
+
+// ===========================================================================
+// Conflated subscribers
+// ===========================================================================
+
+class ConflatedStateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        OrderBookOptions opts;
+        opts.level_deltas = LevelDeltaMode::Conflated;
+        book = std::make_unique<OrderBook>(
+            1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 10000, opts);
+        pool = std::make_unique<MemoryPool<Order>>(10000);
+        engine = std::make_unique<MatchingEngine>(*book, *pool);
+        buffer = std::make_unique<EventBuffer>();
+        gateway = std::make_unique<OrderGateway>(*engine, *pool, buffer.get());
+    }
+
+    void rest(OrderId id, Side side, Price price, Quantity qty, ParticipantId who = 1) {
+        (void)gateway->process_order(make_order_msg(
+            id, side, OrderType::Limit, price * PRICE_SCALE, qty, who));
+    }
+
+    std::unique_ptr<OrderBook> book;
+    std::unique_ptr<MemoryPool<Order>> pool;
+    std::unique_ptr<MatchingEngine> engine;
+    std::unique_ptr<EventBuffer> buffer;
+    std::unique_ptr<OrderGateway> gateway;
+};
+
+TEST_F(ConflatedStateTest, SubscribersSeeTheLatestBookAtTheirDepth) {
+    ConflatedMarketState state(4);
+    MarketDataPublisher publisher(*buffer);
+    publisher.set_conflated_state(&state);
+    size_t full = 0;
+    publisher.register_callback([&](const EventMessage&) { ++full; });
+
+    rest(1, Side::Buy, 99, 10);
+    rest(2, Side::Buy, 98, 20);
+    rest(3, Side::Buy, 97, 30);
+    rest(4, Side::Sell, 101, 5);
+    rest(5, Side::Sell, 102, 6);
+    rest(6, Side::Sell, 99, 4, 2);   // Trades 4 against the 99 bid
+    (void)publisher.poll();
+    EXPECT_GT(full, 6u);              // Full-rate callbacks still see everything
+
+    ConflatedSubscriber top(state, {ConflationMode::TopOfBook, 1, 0});
+    ConflatedSubscriber depth(state, {ConflationMode::Depth, 2, 0});
+    std::vector<BookState> tops;
+    std::vector<BookState> depths;
+    EXPECT_EQ(top.poll([&](const BookState& s) { tops.push_back(s); }), 1u);
+    EXPECT_EQ(depth.poll([&](const BookState& s) { depths.push_back(s); }), 1u);
+
+    ASSERT_EQ(tops.size(), 1u);
+    EXPECT_EQ(tops[0].instrument_id, 0u);
+    ASSERT_EQ(tops[0].bid_levels, 1u);
+    ASSERT_EQ(tops[0].ask_levels, 1u);
+    EXPECT_EQ(tops[0].bids[0].price, 99 * PRICE_SCALE);
+    EXPECT_EQ(tops[0].bids[0].quantity, 6u);
+    EXPECT_EQ(tops[0].asks[0].price, 101 * PRICE_SCALE);
+    EXPECT_EQ(tops[0].last_trade_price, 99 * PRICE_SCALE);
+    EXPECT_EQ(tops[0].last_trade_quantity, 4u);
+
+    ASSERT_EQ(depths.size(), 1u);
+    ASSERT_EQ(depths[0].bid_levels, 2u);
+    ASSERT_EQ(depths[0].ask_levels, 2u);
+    EXPECT_EQ(depths[0].bids[1].price, 98 * PRICE_SCALE);
+    EXPECT_EQ(depths[0].asks[1].price, 102 * PRICE_SCALE);
+
+    // Nothing new: nothing delivered
+    EXPECT_EQ(top.poll([](const BookState&) {}), 0u);
+
+    // Three publishes before the slow reader looks: it sees only the last
+    for (OrderId id = 10; id < 13; ++id) {
+        rest(id, Side::Buy, 100, 1);
+        (void)publisher.poll();
+    }
+    tops.clear();
+    EXPECT_EQ(top.poll([&](const BookState& s) { tops.push_back(s); }), 1u);
+    ASSERT_EQ(tops.size(), 1u);
+    EXPECT_EQ(tops[0].bids[0].price, 100 * PRICE_SCALE);
+    EXPECT_EQ(tops[0].bids[0].quantity, 3u);
+    EXPECT_EQ(tops[0].bids[0].order_count, 3u);
+    EXPECT_EQ(top.updates_conflated(), 2u);
+    EXPECT_EQ(top.updates_delivered(), 2u);
+}
+
+TEST_F(ConflatedStateTest, MaxRateThrottlesDeliveringPolls) {
+    ConflatedMarketState state(1);
+    MarketDataPublisher publisher(*buffer);
+    publisher.set_conflated_state(&state);
+    ConflatedSubscriber slow(state, {ConflationMode::TopOfBook, 1, 1});  // 1 Hz
+
+    rest(1, Side::Buy, 99, 10);
+    (void)publisher.poll();
+    EXPECT_EQ(slow.poll([](const BookState&) {}), 1u);
+
+    rest(2, Side::Buy, 100, 10);
+    (void)publisher.poll();
+    EXPECT_EQ(slow.poll([](const BookState&) {}), 0u);
+    EXPECT_EQ(slow.polls_throttled(), 1u);
+
+    BookState latest{};
+    ASSERT_TRUE(state.read(0, latest));
+    EXPECT_EQ(latest.bids[0].price, 100 * PRICE_SCALE);
+    EXPECT_FALSE(state.read(1, latest));   // No slot
+}
+
+TEST_F(ConflatedStateTest, ReadersOnOtherThreadsGetConsistentStates) {
+    ConflatedMarketState state(1);
+    MarketDataPublisher publisher(*buffer);
+    publisher.set_conflated_state(&state);
+    std::thread pub_thread([&publisher]() { publisher.run(); });
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> seen{0};
+    std::thread reader([&]() {
+        ConflatedSubscriber depth(state, {ConflationMode::Depth, 5, 0});
+        while (!done.load(std::memory_order_acquire)) {
+            (void)depth.poll([&](const BookState& s) {
+                // Every order in this test is 10 lots, and levels are best first
+                for (uint32_t i = 0; i < s.bid_levels; ++i) {
+                    if (s.bids[i].quantity != 10u * s.bids[i].order_count) ++torn;
+                    if (i > 0 && s.bids[i].price >= s.bids[i - 1].price) ++torn;
+                }
+                ++seen;
+            });
+        }
+    });
+
+    for (OrderId id = 1; id <= 2000; ++id) {
+        rest(id, Side::Buy, 100 + static_cast<Price>(id % 50), 10);
+        if (id % 2 == 0) (void)gateway->process_cancel(id - 1);
+    }
+    while (publisher.events_processed() == 0 || buffer->size(EventBuffer::PRIMARY) != 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    done.store(true, std::memory_order_release);
+    reader.join();
+    publisher.stop();
+    pub_thread.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_GT(seen.load(), 0u);
+}
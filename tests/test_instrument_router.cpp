@@ -1,15 +1,27 @@
 /// @file test_instrument_router.cpp
-/// @brief Unit tests for InstrumentRegistry and InstrumentRouter.
+/// @brief Unit tests for InstrumentRegistry, InstrumentRouter and
+///        ShardedRouter.
 
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "core/order.h"
 #include "core/types.h"
+#include "gateway/book_snapshot.h"
 #include "gateway/instrument_registry.h"
 #include "gateway/instrument_router.h"
+#include "gateway/message_throttle.h"
+#include "gateway/sharded_router.h"
+#include "gateway/what_if_sweep.h"
 #include "transport/event_buffer.h"
+#include "transport/ingress_buffer.h"
 #include "transport/message.h"
 
 using namespace hft;
@@ -210,6 +222,27 @@ TEST_F(InstrumentRouterTest, CancelRoutedCorrectly) {
     EXPECT_EQ(router->order_book(1)->order_count(), 0u);
 }
 
+TEST_F(InstrumentRouterTest, MassCancelAllSpansInstruments) {
+    (void)router->process_order(make_msg(0, 1, Side::Buy, 50 * PRICE_SCALE, 10));
+    (void)router->process_order(make_msg(1, 1, Side::Sell, 60 * PRICE_SCALE, 5));
+    (void)router->process_order(make_msg(1, 2, Side::Buy, 40 * PRICE_SCALE, 7));
+    drain(*buffer);
+
+    EXPECT_EQ(router->process_mass_cancel(1, 1, Side::Sell).cancelled_count, 1u);
+    EXPECT_EQ(router->order_book(1)->order_count(), 1u);
+
+    MassCancelResult r = router->process_mass_cancel_all(1);
+    EXPECT_EQ(r.cancelled_count, 2u);
+    EXPECT_EQ(r.cancelled_quantity, 17u);
+    EXPECT_TRUE(router->order_book(0)->empty());
+    EXPECT_TRUE(router->order_book(1)->empty());
+
+    auto events = drain(*buffer);
+    ASSERT_EQ(events.size(), 3u);  // One per instrument with cancels
+    EXPECT_EQ(events[1].instrument_id, 0u);
+    EXPECT_EQ(events[2].instrument_id, 1u);
+}
+
 TEST_F(InstrumentRouterTest, ModifyRoutedCorrectly) {
     auto msg = make_msg(0, 1, Side::Buy, 50 * PRICE_SCALE, 10);
     (void)router->process_order(msg);
@@ -278,6 +311,25 @@ TEST_F(InstrumentRouterTest, PerInstrumentOrderIsolation) {
     EXPECT_EQ(router->order_book(1)->order_count(), 3u);
 }
 
+TEST_F(InstrumentRouterTest, DrainIngressInArrivalOrder) {
+    auto ingress = std::make_unique<IngressBuffer>();
+    ASSERT_TRUE(ingress->try_push(make_msg(0, 1, Side::Sell, 100 * PRICE_SCALE, 10)));
+    ASSERT_TRUE(ingress->try_push(make_msg(1, 2, Side::Buy, 50 * PRICE_SCALE, 5)));
+    ASSERT_TRUE(ingress->try_push(make_msg(0, 1, Side::Sell, 0, 0, MessageType::Cancel)));
+
+    EXPECT_EQ(router->drain(*ingress, 2), 2u);  // Bounded by max
+    EXPECT_EQ(router->order_book(0)->order_count(), 1u);
+    EXPECT_EQ(router->order_book(1)->order_count(), 1u);
+
+    EXPECT_EQ(router->drain(*ingress, 64), 1u);
+    EXPECT_EQ(router->order_book(0)->order_count(), 0u);
+    EXPECT_EQ(router->drain(*ingress, 64), 0u);
+
+    auto events = drain(*buffer);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[2].type, EventType::OrderCancelled);
+}
+
 TEST_F(InstrumentRouterTest, PipelineAccessor) {
     const InstrumentPipeline* p = router->pipeline(0);
     ASSERT_NE(p, nullptr);
@@ -295,3 +347,894 @@ TEST_F(InstrumentRouterTest, OrderBookAccessor) {
     EXPECT_NE(router->order_book(1), nullptr);
     EXPECT_EQ(router->order_book(99), nullptr);
 }
+
+TEST_F(InstrumentRouterTest, AddInstrumentBuildsAPipeline) {
+    InstrumentConfig sol;
+    sol.instrument_id = 7;
+    sol.symbol = "SOLUSDT";
+    sol.min_price = 1 * PRICE_SCALE;
+    sol.max_price = 1000 * PRICE_SCALE;
+    sol.tick_size = 1 * PRICE_SCALE;
+    sol.max_orders = 100;
+
+    EXPECT_TRUE(router->add_instrument(sol));
+    EXPECT_FALSE(router->add_instrument(sol));  // Id already routed
+    EXPECT_EQ(router->instrument_count(), 3u);
+
+    EXPECT_TRUE(router->process_order(make_msg(7, 1, Side::Buy, 50 * PRICE_SCALE, 5)).accepted);
+    EXPECT_EQ(router->order_book(7)->order_count(), 1u);
+    EXPECT_EQ(router->order_book(0)->order_count(), 0u);
+    EXPECT_EQ(router->order_book(6), nullptr);
+
+    auto events = drain(*buffer);
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.front().instrument_id, 7u);
+
+    // An empty router grows on demand too
+    InstrumentRegistry empty;
+    InstrumentRouter dynamic(empty, nullptr);
+    EXPECT_EQ(dynamic.instrument_count(), 0u);
+    EXPECT_TRUE(dynamic.add_instrument(sol));
+    EXPECT_NE(dynamic.order_book(7), nullptr);
+}
+
+TEST_F(InstrumentRouterTest, RetireInstrumentStopsRoutingAndFreesAfterQuiesce) {
+    ASSERT_TRUE(router->process_order(make_msg(1, 1, Side::Buy, 50 * PRICE_SCALE, 5)).accepted);
+    const uint64_t epoch = router->routing_epoch();
+
+    EXPECT_TRUE(router->retire_instrument(1));
+    EXPECT_FALSE(router->retire_instrument(1));
+    EXPECT_EQ(router->routing_epoch(), epoch + 1);
+    EXPECT_EQ(router->instrument_count(), 1u);
+    EXPECT_EQ(router->pipeline_at(0).instrument_id, 0u);
+    EXPECT_EQ(router->order_book(1), nullptr);
+    EXPECT_FALSE(router->process_order(make_msg(1, 2, Side::Buy, 50 * PRICE_SCALE, 5)).accepted);
+    EXPECT_FALSE(router->process_cancel(1, 1));
+
+    // The replaced table and the pipeline wait for the matching thread's
+    // acknowledgement; process_cancel above gave it
+    EXPECT_EQ(router->reclaim(), 0u);
+
+    // Listing it again builds a fresh, empty pipeline
+    InstrumentConfig eth = *registry.find_by_id(1);
+    ASSERT_TRUE(router->add_instrument(eth));
+    EXPECT_EQ(router->reclaim(), 1u);  // Not acknowledged yet
+    router->quiesce();
+    EXPECT_EQ(router->reclaim(), 0u);
+    EXPECT_EQ(router->order_book(1)->order_count(), 0u);
+    EXPECT_EQ(router->pipeline_at(1).instrument_id, 1u);
+}
+
+TEST_F(InstrumentRouterTest, ListAndDelistWhileTheMatchingThreadRuns) {
+    InstrumentRouter live(registry, nullptr);  // No consumer drains events here
+    std::atomic<bool> stop{false};
+    uint64_t routed = 0;
+
+    // Matching thread: keep routing to every id the control thread touches
+    std::thread matching([&] {
+        OrderId next = 1;
+        OrderMessage msgs[4];
+        GatewayResult results[4];
+        while (!stop.load(std::memory_order_acquire)) {
+            for (InstrumentId i = 0; i < 4; ++i) {
+                msgs[i] = make_msg(i * 10, next++, Side::Buy, 50 * PRICE_SCALE, 1);
+            }
+            live.process_batch(msgs, 4, results);
+            for (const auto& r : results) routed += r.accepted;
+            for (InstrumentId i = 0; i < 4; ++i) {  // Keep the books small
+                (void)live.process_cancel(i * 10, msgs[i].order.order_id);
+            }
+        }
+    });
+
+    InstrumentConfig cfg = *registry.find_by_id(0);
+    cfg.max_orders = 64;
+    for (int round = 0; round < 200; ++round) {
+        for (InstrumentId id : {10u, 20u, 30u}) {
+            cfg.instrument_id = id;
+            ASSERT_TRUE(live.add_instrument(cfg));
+        }
+        for (InstrumentId id : {10u, 20u, 30u}) ASSERT_TRUE(live.retire_instrument(id));
+    }
+    stop.store(true, std::memory_order_release);
+    matching.join();
+
+    live.quiesce();
+    EXPECT_EQ(live.reclaim(), 0u);
+    EXPECT_EQ(live.instrument_count(), 2u);
+    EXPECT_GT(routed, 0u);
+    EXPECT_EQ(live.order_book(0)->order_count(), 0u);
+}
+
+TEST(InstrumentRouterConfigTest, QuoteSnapshotPerConfiguredInstrument) {
+    InstrumentRegistry registry;
+    InstrumentConfig cfg;
+    cfg.symbol = "BTCUSDT";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = 1 * PRICE_SCALE;
+    cfg.max_orders = 100;
+    cfg.instrument_id = 0;
+    cfg.quote_snapshot = true;
+    registry.register_instrument(cfg);
+    cfg.instrument_id = 1;
+    cfg.symbol = "ETHUSDT";
+    cfg.quote_snapshot = false;
+    registry.register_instrument(cfg);
+
+    InstrumentRouter router(registry, nullptr);
+    const QuoteSnapshotSlot* slot = router.quote_snapshot(0);
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(router.quote_snapshot(1), nullptr);
+    EXPECT_EQ(router.quote_snapshot(9), nullptr);
+
+    (void)router.process_order(make_msg(0, 1, Side::Buy, 50 * PRICE_SCALE, 5));
+    QuoteSnapshot snap{};
+    ASSERT_TRUE(slot->read(snap));
+    EXPECT_EQ(snap.bids[0].price, 50 * PRICE_SCALE);
+    EXPECT_EQ(snap.bids[0].quantity, 5u);
+}
+
+TEST(InstrumentRouterConfigTest, WindowedBookFromConfig) {
+    InstrumentRegistry registry;
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "BTCUSDT";
+    cfg.min_price = PRICE_SCALE / 100;
+    cfg.max_price = 1'000'000 * PRICE_SCALE;
+    cfg.tick_size = PRICE_SCALE / 100;
+    cfg.max_orders = 1000;
+    cfg.book_options.window_levels = 4096;
+    registry.register_instrument(cfg);
+
+    InstrumentRouter router(registry, nullptr);
+    const OrderBook* book = router.order_book(0);
+    ASSERT_NE(book, nullptr);
+    EXPECT_EQ(book->window_levels(), 4096u);
+
+    ASSERT_TRUE(router.process_order(
+        make_msg(0, 1, Side::Sell, 50'000 * PRICE_SCALE, 5)).accepted);
+    GatewayResult r = router.process_order(
+        make_msg(0, 2, Side::Buy, 50'000 * PRICE_SCALE, 5));
+    EXPECT_EQ(r.match_status, MatchStatus::Filled);
+    EXPECT_TRUE(book->empty());
+}
+
+TEST(InstrumentRouterConfigTest, MemoryBackingAppliedToPipeline) {
+    InstrumentRegistry registry;
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "ETHUSDT";
+    cfg.min_price = 1'000 * PRICE_SCALE;
+    cfg.max_price = 5'000 * PRICE_SCALE;
+    cfg.tick_size = PRICE_SCALE / 100;
+    cfg.max_orders = 1000;
+    cfg.memory.pages = PageMode::Transparent;
+    cfg.memory.prefault = true;
+    registry.register_instrument(cfg);
+
+    InstrumentRouter router(registry, nullptr);
+    const InstrumentPipeline* pipeline = router.pipeline(0);
+    ASSERT_NE(pipeline, nullptr);
+    EXPECT_TRUE(pipeline->pool->backing().mapped);
+    EXPECT_TRUE(pipeline->book->level_backing().mapped);
+
+    ASSERT_TRUE(router.process_order(
+        make_msg(0, 1, Side::Sell, 2'000 * PRICE_SCALE, 5)).accepted);
+    GatewayResult r = router.process_order(
+        make_msg(0, 2, Side::Buy, 2'000 * PRICE_SCALE, 5));
+    EXPECT_EQ(r.match_status, MatchStatus::Filled);
+}
+
+TEST(InstrumentRouterConfigTest, SharedPoolEnforcesQuotas) {
+    InstrumentRegistry registry;
+    for (InstrumentId id = 0; id < 2; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = id == 0 ? "BTCUSDT" : "ETHUSDT";
+        cfg.min_price = 1'000 * PRICE_SCALE;
+        cfg.max_price = 5'000 * PRICE_SCALE;
+        cfg.tick_size = PRICE_SCALE / 100;
+        cfg.max_orders = 3;
+        cfg.shared_pool = true;
+        registry.register_instrument(cfg);
+    }
+
+    SharedPoolConfig shared;
+    shared.initial_orders = 4;
+    InstrumentRouter router(registry, nullptr, shared);
+    ASSERT_NE(router.shared_pool(), nullptr);
+
+    OrderId next_id = 1;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(router.process_order(make_msg(
+            0, next_id++, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted);
+    }
+    GatewayResult over = router.process_order(
+        make_msg(0, next_id++, Side::Buy, 2'000 * PRICE_SCALE, 1));
+    EXPECT_FALSE(over.accepted);
+    EXPECT_EQ(over.reject_reason, GatewayRejectReason::PoolExhausted);
+
+    // One slot left in the slab for the second instrument.
+    EXPECT_TRUE(router.process_order(make_msg(
+        1, next_id++, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted);
+    EXPECT_FALSE(router.process_order(make_msg(
+        1, next_id++, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted);
+    EXPECT_EQ(router.shared_pool()->size(), 4u);
+}
+
+TEST(InstrumentRouterConfigTest, MemoryUsageCountsSharedPoolOnce) {
+    InstrumentRegistry registry;
+    for (InstrumentId id = 0; id < 2; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = id == 0 ? "BTCUSDT" : "ETHUSDT";
+        cfg.min_price = 1'000 * PRICE_SCALE;
+        cfg.max_price = 5'000 * PRICE_SCALE;
+        cfg.tick_size = PRICE_SCALE / 100;
+        cfg.max_orders = 64;
+        cfg.shared_pool = id == 1;
+        registry.register_instrument(cfg);
+    }
+    SharedPoolConfig shared;
+    shared.initial_orders = 256;
+    InstrumentRouter router(registry, nullptr, shared);
+
+    (void)router.process_order(make_msg(1, 1, Side::Buy, 2'000 * PRICE_SCALE, 1));
+
+    const PipelineMemoryUsage own = router.pipeline_at(0).memory_usage();
+    const PipelineMemoryUsage view = router.pipeline_at(1).memory_usage();
+    EXPECT_GE(own.pool.reserved_bytes, 64 * MemoryPool<Order>::SLOT_SIZE);
+    EXPECT_GT(own.book.levels.reserved_bytes, 0u);
+    EXPECT_EQ(view.pool.reserved_bytes, 0u);  // Lives in the shared pool
+    EXPECT_EQ(view.pool.high_water_bytes, MemoryPool<Order>::SLOT_SIZE);
+
+    const RouterMemoryUsage usage = router.memory_usage();
+    EXPECT_EQ(usage.instruments.reserved_bytes,
+              own.total().reserved_bytes + view.total().reserved_bytes);
+    EXPECT_GE(usage.shared_pool.reserved_bytes, 256 * MemoryPool<Order>::SLOT_SIZE);
+    EXPECT_EQ(usage.total().reserved_bytes,
+              usage.instruments.reserved_bytes + usage.shared_pool.reserved_bytes);
+}
+
+TEST(InstrumentRouterConfigTest, GrowablePoolScalesToMaxOrders) {
+    InstrumentRegistry registry;
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "BTCUSDT";
+    cfg.min_price = 1'000 * PRICE_SCALE;
+    cfg.max_price = 5'000 * PRICE_SCALE;
+    cfg.tick_size = PRICE_SCALE / 100;
+    cfg.max_orders = 100;
+    cfg.pool_segment_orders = 16;
+    registry.register_instrument(cfg);
+
+    InstrumentRouter router(registry, nullptr);
+    const InstrumentPipeline* pipeline = router.pipeline(0);
+    EXPECT_EQ(pipeline->pool->capacity(), 16u);
+
+    // The spare mapped at construction is adopted in O(1); the next one is
+    // only mapped by the idle hook, never while processing an order
+    for (OrderId id = 1; id <= 32; ++id) {
+        ASSERT_TRUE(router.process_order(make_msg(
+            0, id, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted) << id;
+    }
+    EXPECT_EQ(pipeline->pool->capacity(), 32u);
+    EXPECT_TRUE(pipeline->pool->growth_pending());
+    EXPECT_FALSE(router.process_order(
+        make_msg(0, 33, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted);
+
+    for (OrderId id = 33; id <= 100; ++id) {
+        (void)router.maintain();
+        ASSERT_TRUE(router.process_order(make_msg(
+            0, id, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted) << id;
+    }
+    EXPECT_EQ(pipeline->pool->capacity(), 100u);
+    EXPECT_FALSE(router.process_order(
+        make_msg(0, 101, Side::Buy, 2'000 * PRICE_SCALE, 1)).accepted);
+}
+
+TEST_F(InstrumentRouterTest, BatchRoutesMixedInstruments) {
+    OrderMessage msgs[5] = {
+        make_msg(0, 1, Side::Buy, 100 * PRICE_SCALE, 10),
+        make_msg(1, 1, Side::Sell, 100 * PRICE_SCALE, 10),
+        make_msg(99, 2, Side::Buy, 100 * PRICE_SCALE, 10),
+        make_msg(0, 3, Side::Sell, 100 * PRICE_SCALE, 4),
+        make_msg(1, 1, Side::Sell, 0, 0, MessageType::Cancel),
+    };
+    GatewayResult results[5];
+    router->process_batch(msgs, 5, results);
+
+    EXPECT_EQ(results[0].match_status, MatchStatus::Resting);
+    EXPECT_EQ(results[1].match_status, MatchStatus::Resting);  // no cross-instrument match
+    EXPECT_FALSE(results[2].accepted);
+    EXPECT_EQ(results[3].match_status, MatchStatus::Filled);
+    EXPECT_EQ(results[3].trade_count, 1u);
+    EXPECT_TRUE(results[4].accepted);
+    EXPECT_EQ(results[4].match_status, MatchStatus::Cancelled);
+
+    EXPECT_EQ(router->order_book(0)->order_count(), 1u);
+    EXPECT_EQ(router->order_book(1)->order_count(), 0u);
+}
+
+TEST(InstrumentRouterConfigTest, MatchingPolicyFromConfig) {
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "LEAN";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = 1 * PRICE_SCALE;
+    cfg.max_orders = 1000;
+    cfg.stp_mode = SelfTradePreventionMode::CancelNewest;
+    cfg.matching_features.icebergs = false;
+
+    InstrumentRegistry registry;
+    registry.register_instrument(cfg);
+    InstrumentRouter router(registry, nullptr);
+
+    const InstrumentPipeline* p = router.pipeline(0);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(p->engine->stp_mode(), SelfTradePreventionMode::CancelNewest);
+    EXPECT_FALSE(p->engine->features().icebergs);
+    EXPECT_TRUE(p->engine->features().fok);
+
+    // Same participant on both sides: STP cancels the aggressor
+    EXPECT_TRUE(router.process_order(
+        make_msg(0, 1, Side::Sell, 100 * PRICE_SCALE, 10)).accepted);
+    auto result = router.process_order(
+        make_msg(0, 2, Side::Buy, 100 * PRICE_SCALE, 10));
+    EXPECT_EQ(result.match_status, MatchStatus::SelfTradePrevented);
+
+    auto iceberg = make_msg(0, 3, Side::Buy, 90 * PRICE_SCALE, 10);
+    iceberg.order.type = OrderType::Iceberg;
+    iceberg.order.iceberg_slice_qty = 5;
+    iceberg.order.visible_quantity = 5;
+    EXPECT_EQ(router.process_order(iceberg).match_status, MatchStatus::Rejected);
+}
+
+TEST(InstrumentRouterConfigTest, StopBookFromConfig) {
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "STOPS";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = 1 * PRICE_SCALE;
+    cfg.max_orders = 1000;
+    cfg.max_stop_orders = 16;
+
+    InstrumentRegistry registry;
+    registry.register_instrument(cfg);
+    InstrumentRouter router(registry, nullptr);
+
+    const InstrumentPipeline* p = router.pipeline(0);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(p->stops, nullptr);
+    EXPECT_EQ(p->engine->stop_book(), p->stops.get());
+
+    auto ask = make_msg(0, 1, Side::Sell, 100 * PRICE_SCALE, 20);
+    ask.order.participant_id = 2;
+    EXPECT_TRUE(router.process_order(ask).accepted);
+
+    auto stop = make_msg(0, 2, Side::Buy, 0, 10);
+    stop.order.type = OrderType::Stop;
+    stop.order.stop_price = 100 * PRICE_SCALE;
+    EXPECT_EQ(router.process_order(stop).match_status, MatchStatus::Resting);
+    EXPECT_EQ(p->stops->size(), 1u);
+
+    // The first trade at 100 elects the stop, which takes the other 10
+    auto result = router.process_order(
+        make_msg(0, 3, Side::Buy, 100 * PRICE_SCALE, 10));
+    EXPECT_EQ(result.match_status, MatchStatus::Filled);
+    EXPECT_EQ(p->stops->size(), 0u);
+    EXPECT_TRUE(p->book->empty());
+}
+
+TEST(InstrumentRouterConfigTest, ExpiryWheelFromConfig) {
+    InstrumentConfig cfg;
+    cfg.instrument_id = 0;
+    cfg.symbol = "TIMED";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = 1 * PRICE_SCALE;
+    cfg.max_orders = 1000;
+    cfg.max_timed_orders = 16;
+    cfg.expiry_tick_ns = 10;
+    cfg.session_close = 5'000;
+
+    InstrumentRegistry registry;
+    registry.register_instrument(cfg);
+    InstrumentRouter router(registry, nullptr);
+
+    const InstrumentPipeline* p = router.pipeline(0);
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(p->expiry, nullptr);
+    EXPECT_EQ(p->engine->expiry_wheel(), p->expiry.get());
+    EXPECT_EQ(p->expiry->session_close(), 5'000u);
+
+    auto day = make_msg(0, 1, Side::Buy, 100 * PRICE_SCALE, 10);
+    day.order.time_in_force = TimeInForce::DAY;
+    EXPECT_EQ(router.process_order(day).match_status, MatchStatus::Resting);
+    EXPECT_EQ(router.process_time(4'999), 0u);
+    EXPECT_EQ(router.process_time(5'000), 1u);
+    EXPECT_TRUE(p->book->empty());
+}
+
+// ===========================================================================
+// Book snapshot tests
+// ===========================================================================
+
+static InstrumentRegistry make_snapshot_registry(Price tick = 1 * PRICE_SCALE) {
+    InstrumentRegistry reg;
+    for (InstrumentId id = 1; id <= 2; ++id) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = "SNAP" + std::to_string(id);
+        cfg.min_price = 1 * PRICE_SCALE;
+        cfg.max_price = 1000 * PRICE_SCALE;
+        cfg.tick_size = tick;
+        cfg.max_orders = 1000;
+        reg.register_instrument(cfg);
+    }
+    return reg;
+}
+
+static std::string snapshot_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static std::vector<OrderId> level_ids(const OrderBook& book, Side side, Price price) {
+    std::vector<OrderId> ids;
+    for (const PriceLevel* l = book.next_level(side, nullptr); l;
+         l = book.next_level(side, l)) {
+        if (l->price != price) continue;
+        for (const Order* o = l->head; o; o = o->next) ids.push_back(o->order_id);
+    }
+    return ids;
+}
+
+TEST(BookSnapshotTest, RoundTripPreservesQueuesAndCounters) {
+    const auto registry = make_snapshot_registry();
+    const std::string path = snapshot_path("hft_book_snapshot_roundtrip.snap");
+    auto events_a = std::make_unique<EventBuffer>();
+    auto events_b = std::make_unique<EventBuffer>();
+    InstrumentRouter original(registry, events_a.get());
+
+    const Price p99 = 99 * PRICE_SCALE, p100 = 100 * PRICE_SCALE;
+    const Price p101 = 101 * PRICE_SCALE, p102 = 102 * PRICE_SCALE;
+    (void)original.process_order(make_msg(1, 1, Side::Sell, p101, 10));
+    (void)original.process_order(make_msg(1, 2, Side::Sell, p101, 5));
+    (void)original.process_order(make_msg(1, 3, Side::Sell, p102, 7));
+    (void)original.process_order(make_msg(1, 4, Side::Buy, p101, 4));  // Partial on 1
+    (void)original.process_order(make_msg(1, 5, Side::Buy, p100, 3));
+    (void)original.process_order(make_msg(1, 6, Side::Buy, p100, 2));
+    (void)original.process_order(make_msg(1, 7, Side::Buy, p99, 6));
+    (void)original.process_order(make_msg(2, 8, Side::Buy, p100, 9));
+    (void)drain(*events_a);
+
+    const SnapshotStats saved = save_snapshot(original, path);
+    ASSERT_TRUE(saved.ok) << saved.error;
+    EXPECT_EQ(saved.instruments, 2u);
+    EXPECT_EQ(saved.levels, 5u);
+    EXPECT_EQ(saved.orders, 7u);
+
+    InstrumentRouter restored(registry, events_b.get());
+    const SnapshotStats loaded = restore_snapshot(restored, path);
+    ASSERT_TRUE(loaded.ok) << loaded.error;
+    EXPECT_EQ(loaded.orders, saved.orders);
+    EXPECT_EQ(loaded.bytes, saved.bytes);
+    EXPECT_TRUE(drain(*events_b).empty());  // Restore publishes nothing
+
+    const OrderBook& a = *original.order_book(1);
+    const OrderBook& b = *restored.order_book(1);
+    EXPECT_EQ(b.order_count(), a.order_count());
+    ASSERT_NE(b.best_bid(), nullptr);
+    ASSERT_NE(b.best_ask(), nullptr);
+    EXPECT_EQ(b.best_bid()->price, a.best_bid()->price);
+    EXPECT_EQ(b.best_ask()->price, a.best_ask()->price);
+    EXPECT_EQ(level_ids(b, Side::Sell, p101), (std::vector<OrderId>{1, 2}));
+    EXPECT_EQ(level_ids(b, Side::Buy, p100), (std::vector<OrderId>{5, 6}));
+    const Order* partial = b.find_order(1);
+    ASSERT_NE(partial, nullptr);
+    EXPECT_EQ(partial->filled_quantity, 4u);
+    EXPECT_EQ(partial->status, OrderStatus::PartialFill);
+    EXPECT_EQ(restored.order_book(2)->order_count(), 1u);
+
+    // The same sweep trades identically against both books
+    const auto sweep = make_msg(1, 9, Side::Buy, p102, 14);
+    const GatewayResult ra = original.process_order(sweep);
+    const GatewayResult rb = restored.process_order(sweep);
+    EXPECT_EQ(ra.match_status, rb.match_status);
+    const auto ea = drain(*events_a);
+    const auto eb = drain(*events_b);
+    ASSERT_EQ(ea.size(), eb.size());
+    for (size_t i = 0; i < ea.size(); ++i) {
+        EXPECT_EQ(ea[i].type, eb[i].type);
+        EXPECT_EQ(ea[i].sequence_num, eb[i].sequence_num);
+        if (ea[i].type == EventType::Trade) {
+            EXPECT_EQ(ea[i].data.trade.trade_id, eb[i].data.trade.trade_id);
+            EXPECT_EQ(ea[i].data.trade.sell_order_id, eb[i].data.trade.sell_order_id);
+            EXPECT_EQ(ea[i].data.trade.quantity, eb[i].data.trade.quantity);
+        }
+    }
+    EXPECT_EQ(restored.pipeline(1)->gateway->orders_processed(),
+              original.pipeline(1)->gateway->orders_processed());
+    EXPECT_EQ(level_ids(b, Side::Sell, p102), (std::vector<OrderId>{3}));
+    EXPECT_EQ(b.find_order(3)->filled_quantity, 3u);
+
+    // Restored orders cancel like any other
+    EXPECT_TRUE(restored.process_cancel(1, 7));
+    EXPECT_EQ(b.find_order(7), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(BookSnapshotTest, RestoreRejectsMismatchedOrBusyBooks) {
+    const auto registry = make_snapshot_registry();
+    const std::string path = snapshot_path("hft_book_snapshot_reject.snap");
+    InstrumentRouter original(registry, nullptr);
+    (void)original.process_order(make_msg(1, 1, Side::Buy, 100 * PRICE_SCALE, 5));
+    ASSERT_TRUE(save_snapshot(original, path).ok);
+
+    const auto other_tick = make_snapshot_registry(PRICE_SCALE / 100);
+    InstrumentRouter mismatched(other_tick, nullptr);
+    const SnapshotStats geometry = restore_snapshot(mismatched, path);
+    EXPECT_FALSE(geometry.ok);
+    EXPECT_NE(geometry.error.find("geometry"), std::string::npos);
+
+    InstrumentRouter busy(registry, nullptr);
+    (void)busy.process_order(make_msg(1, 1, Side::Sell, 200 * PRICE_SCALE, 5));
+    EXPECT_FALSE(restore_snapshot(busy, path).ok);
+
+    InstrumentRouter any(registry, nullptr);
+    EXPECT_FALSE(restore_snapshot(any, snapshot_path("hft_book_snapshot_missing.snap")).ok);
+    std::filesystem::remove(path);
+}
+
+TEST(BookSnapshotTest, RefusesUntriggeredStops) {
+    InstrumentConfig cfg;
+    cfg.instrument_id = 1;
+    cfg.symbol = "STOPS";
+    cfg.min_price = 1 * PRICE_SCALE;
+    cfg.max_price = 1000 * PRICE_SCALE;
+    cfg.tick_size = 1 * PRICE_SCALE;
+    cfg.max_orders = 1000;
+    cfg.max_stop_orders = 8;
+    InstrumentRegistry registry;
+    registry.register_instrument(cfg);
+    InstrumentRouter router(registry, nullptr);
+
+    auto stop = make_msg(1, 1, Side::Buy, 0, 5);
+    stop.order.type = OrderType::Stop;
+    stop.order.stop_price = 150 * PRICE_SCALE;
+    (void)router.process_order(stop);
+    ASSERT_EQ(router.pipeline(1)->stops->size(), 1u);
+
+    const SnapshotStats stats =
+        save_snapshot(router, snapshot_path("hft_book_snapshot_stops.snap"));
+    EXPECT_FALSE(stats.ok);
+    EXPECT_NE(stats.error.find("stop"), std::string::npos);
+}
+
+TEST(BookSnapshotTest, CloneCopiesQueuesAndDivergesIndependently) {
+    const auto registry = make_snapshot_registry();
+    const InstrumentConfig& cfg = *registry.find_by_id(1);
+    InstrumentRouter original(registry, nullptr);
+    const Price p100 = 100 * PRICE_SCALE, p101 = 101 * PRICE_SCALE;
+    (void)original.process_order(make_msg(1, 1, Side::Sell, p101, 10));
+    (void)original.process_order(make_msg(1, 2, Side::Sell, p101, 5));
+    (void)original.process_order(make_msg(1, 3, Side::Buy, p101, 4));  // Partial on 1
+    (void)original.process_order(make_msg(1, 4, Side::Buy, p100, 3));
+
+    auto copy = build_instrument_pipeline(cfg, nullptr);
+    const SnapshotStats cloned = clone_pipeline(*original.pipeline(1), *copy);
+    ASSERT_TRUE(cloned.ok) << cloned.error;
+    EXPECT_EQ(cloned.levels, 2u);
+    EXPECT_EQ(cloned.orders, 3u);
+    EXPECT_EQ(cloned.bytes, 0u);
+    EXPECT_EQ(level_ids(*copy->book, Side::Sell, p101), (std::vector<OrderId>{1, 2}));
+    EXPECT_EQ(copy->book->find_order(1)->filled_quantity, 4u);
+    EXPECT_EQ(copy->engine->total_trade_count(), original.pipeline(1)->engine->total_trade_count());
+    EXPECT_EQ(copy->gateway->sequence_number(), original.pipeline(1)->gateway->sequence_number());
+
+    // Trading the copy leaves the source alone
+    (void)copy->gateway->process_order(make_msg(1, 5, Side::Buy, p101, 11));
+    EXPECT_EQ(copy->book->best_ask(), nullptr);
+    EXPECT_EQ(level_ids(*original.order_book(1), Side::Sell, p101), (std::vector<OrderId>{1, 2}));
+    EXPECT_EQ(original.order_book(1)->order_count(), 3u);
+
+    // Only into an empty book of the same geometry
+    EXPECT_FALSE(clone_pipeline(*original.pipeline(1), *copy).ok);
+}
+
+TEST(RouterStateDigestTest, AgreesAcrossRoutersAndClones) {
+    InstrumentRegistry registry;
+    for (InstrumentId id : {1u, 2u}) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = id;
+        cfg.symbol = id == 1 ? "AAA" : "BBB";
+        cfg.min_price = 1 * PRICE_SCALE;
+        cfg.max_price = 1000 * PRICE_SCALE;
+        cfg.tick_size = 1 * PRICE_SCALE;
+        cfg.max_orders = 1000;
+        cfg.digest_every = 2;
+        registry.register_instrument(cfg);
+    }
+    EventBuffer events;
+    InstrumentRouter a(registry, &events);
+    InstrumentRouter b(registry, nullptr);
+    const Price p100 = 100 * PRICE_SCALE, p101 = 101 * PRICE_SCALE;
+
+    // Same messages per instrument, interleaved differently
+    const OrderMessage one[] = {make_msg(1, 1, Side::Sell, p101, 10),
+                                make_msg(1, 2, Side::Buy, p101, 4),
+                                make_msg(1, 3, Side::Buy, p100, 7)};
+    const OrderMessage two[] = {make_msg(2, 1, Side::Buy, p100, 5),
+                                make_msg(2, 2, Side::Sell, p101, 6)};
+    for (const auto& m : one) (void)a.process_order(m);
+    for (const auto& m : two) (void)a.process_order(m);
+    for (const auto& m : two) (void)b.process_order(m);
+    for (const auto& m : one) (void)b.process_order(m);
+
+    EXPECT_NE(a.state_digest(1), 0u);
+    EXPECT_EQ(a.state_digest(1), b.state_digest(1));
+    EXPECT_EQ(a.state_digest(2), b.state_digest(2));
+    EXPECT_NE(a.state_digest(1), a.state_digest(2));
+    EXPECT_EQ(a.state_digest(), b.state_digest());
+    EXPECT_EQ(a.state_digest(99), 0u);
+    EXPECT_EQ(a.state_digest(1), a.order_book(1)->compute_state_digest());
+
+    // Stamped after every second call per instrument, carrying the book
+    std::vector<EventMessage> stamps;
+    for (const auto& e : drain(events)) {
+        if (e.type == EventType::BookDigest) stamps.push_back(e);
+    }
+    ASSERT_EQ(stamps.size(), 2u);
+    EXPECT_EQ(stamps[0].instrument_id, 1u);
+    EXPECT_EQ(stamps[0].data.book_digest.order_count, 1u);
+    EXPECT_EQ(stamps[0].data.book_digest.best_ask, p101);
+    EXPECT_EQ(stamps[1].instrument_id, 2u);
+    EXPECT_EQ(stamps[1].data.book_digest.digest, a.state_digest(2));
+
+    // A clone restores into a digest-keeping book and agrees with it
+    auto copy = build_instrument_pipeline(*registry.find_by_id(1), nullptr);
+    ASSERT_TRUE(clone_pipeline(*a.pipeline(1), *copy).ok);
+    EXPECT_EQ(copy->book->state_digest(), a.state_digest(1));
+    (void)copy->gateway->process_order(make_msg(1, 4, Side::Buy, p101, 6));
+    EXPECT_NE(copy->book->state_digest(), a.state_digest(1));
+    EXPECT_EQ(copy->book->state_digest(), copy->book->compute_state_digest());
+}
+
+TEST(WhatIfSweepTest, VariantsRunAgainstTheFrozenBookOnAnyThreadCount) {
+    const auto registry = make_snapshot_registry();
+    const InstrumentConfig& cfg = *registry.find_by_id(1);
+    InstrumentRouter router(registry, nullptr);
+    for (OrderId id = 1; id <= 5; ++id) {
+        (void)router.process_order(make_msg(1, id, Side::Sell,
+                                            static_cast<Price>(100 + id) * PRICE_SCALE, 10));
+        (void)router.process_order(make_msg(1, 10 + id, Side::Buy,
+                                            static_cast<Price>(100 - id) * PRICE_SCALE, 10));
+    }
+    WhatIfSweep sweep(*router.pipeline(1), cfg);
+    ASSERT_TRUE(sweep.ok()) << sweep.error();
+    EXPECT_EQ(sweep.frozen_orders(), 10u);
+
+    // The live book moves on; the sweep still sees the frozen one
+    EXPECT_TRUE(router.process_cancel(1, 1));
+
+    // Variant i lifts i asks, then cancels a bid that exists and one that does not
+    std::vector<WhatIfVariant> variants;
+    for (Quantity i = 0; i < 6; ++i) {
+        WhatIfVariant v;
+        v.name = "lift" + std::to_string(i);
+        if (i > 0) v.messages.push_back(make_msg(1, 100, Side::Buy, 110 * PRICE_SCALE, 10 * i));
+        v.messages.push_back(make_msg(1, 11, Side::Buy, 0, 0, MessageType::Cancel));
+        v.messages.push_back(make_msg(1, 999, Side::Buy, 0, 0, MessageType::Cancel));
+        variants.push_back(v);
+    }
+
+    const std::vector<WhatIfResult> serial = sweep.run(variants, 1);
+    ASSERT_EQ(serial.size(), variants.size());
+    for (Quantity i = 0; i < 6; ++i) {
+        const WhatIfResult& r = serial[i];
+        ASSERT_TRUE(r.ok) << r.error;
+        EXPECT_EQ(r.name, variants[i].name);
+        EXPECT_EQ(r.trades, i);
+        EXPECT_EQ(r.filled_quantity, 10 * i);
+        EXPECT_EQ(r.count(MatchStatus::Cancelled), 1u);
+        EXPECT_EQ(r.rejected, 1u);
+        EXPECT_EQ(r.order_count, 9u - i);
+        EXPECT_EQ(r.best_ask, (i < 5) ? static_cast<Price>(101 + i) * PRICE_SCALE : 0);
+        EXPECT_EQ(r.best_bid, 98 * PRICE_SCALE);
+    }
+    EXPECT_EQ(serial[5].count(MatchStatus::Filled), 1u);
+    EXPECT_EQ(serial[5].last_trade_price, 105 * PRICE_SCALE);
+
+    const std::vector<WhatIfResult> parallel = sweep.run(variants, 4);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].trades, serial[i].trades);
+        EXPECT_EQ(parallel[i].order_count, serial[i].order_count);
+        EXPECT_EQ(parallel[i].best_ask, serial[i].best_ask);
+    }
+}
+
+// ===========================================================================
+// ShardedRouter tests
+// ===========================================================================
+
+static InstrumentRegistry make_sharded_registry(const std::vector<double>& loads) {
+    InstrumentRegistry reg;
+    for (size_t i = 0; i < loads.size(); ++i) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = static_cast<InstrumentId>(i);
+        cfg.symbol = "SYM" + std::to_string(i);
+        cfg.min_price = 1 * PRICE_SCALE;
+        cfg.max_price = 100 * PRICE_SCALE;
+        cfg.tick_size = PRICE_SCALE / 100;
+        cfg.max_orders = 1000;
+        cfg.expected_load = loads[i];
+        reg.register_instrument(cfg);
+    }
+    return reg;
+}
+
+TEST(ShardedRouterTest, AssignsRoundRobinOrByLoad) {
+    InstrumentRegistry reg = make_sharded_registry({3.0, 1.0, 1.0, 1.0});
+
+    ShardedRouterConfig rr;
+    rr.num_shards = 2;
+    ShardedRouter round_robin(reg, rr);
+    EXPECT_EQ(round_robin.shard_count(), 2u);
+    EXPECT_EQ(round_robin.shard_of(0), 0u);
+    EXPECT_EQ(round_robin.shard_of(1), 1u);
+    EXPECT_EQ(round_robin.shard_of(2), 0u);
+    EXPECT_EQ(round_robin.shard_of(3), 1u);
+    EXPECT_EQ(round_robin.shard_of(9), ShardedRouter::INVALID_SHARD);
+
+    ShardedRouterConfig by_load = rr;
+    by_load.assignment = ShardAssignment::ByLoad;
+    ShardedRouter balanced(reg, by_load);
+    EXPECT_EQ(balanced.shard_of(0), 0u);  // Heavy instrument alone
+    EXPECT_EQ(balanced.shard_of(1), 1u);
+    EXPECT_EQ(balanced.shard_of(2), 1u);
+    EXPECT_EQ(balanced.shard_of(3), 1u);
+    EXPECT_EQ(balanced.shard_router(1).instrument_count(), 3u);
+
+    EXPECT_FALSE(round_robin.submit(make_msg(9, 1, Side::Buy, 50 * PRICE_SCALE, 1)));
+}
+
+TEST(ShardedRouterTest, MergedStreamKeepsTimestampAndSequenceOrder) {
+    constexpr size_t INSTRUMENTS = 4;
+    constexpr uint64_t ROUNDS = 200;
+    InstrumentRegistry reg = make_sharded_registry(std::vector<double>(INSTRUMENTS, 1.0));
+    ShardedRouterConfig config;
+    config.num_shards = 2;
+    ShardedRouter router(reg, config);
+    router.start();
+
+    // Each round rests a sell and crosses it with a buy on every instrument
+    std::vector<EventMessage> events;
+    EventMessage out[64];
+    Timestamp ts = 1;
+    for (uint64_t r = 0; r < ROUNDS; ++r) {
+        for (InstrumentId inst = 0; inst < INSTRUMENTS; ++inst) {
+            auto sell = make_msg(inst, 2 * r + 1, Side::Sell, 50 * PRICE_SCALE, 5);
+            sell.order.timestamp = ts++;
+            auto buy = make_msg(inst, 2 * r + 2, Side::Buy, 50 * PRICE_SCALE, 5);
+            buy.order.participant_id = 2;
+            buy.order.timestamp = ts++;
+            while (!router.submit(sell)) std::this_thread::yield();
+            while (!router.submit(buy)) std::this_thread::yield();
+        }
+        size_t n = router.merge(out, 64);
+        events.insert(events.end(), out, out + n);
+    }
+    for (int spin = 0; spin < 1'000'000; ++spin) {
+        size_t n = router.merge(out, 64);
+        events.insert(events.end(), out, out + n);
+        if (n == 0 && router.idle() && router.shard_events(0).empty() &&
+            router.shard_events(1).empty()) {
+            break;
+        }
+        if (n == 0) std::this_thread::yield();
+    }
+    router.stop();
+
+    size_t trades = 0;
+    Timestamp last_ts = 0;
+    std::vector<uint64_t> last_seq(INSTRUMENTS, 0);
+    for (const EventMessage& e : events) {
+        Timestamp key = 0;
+        if (e.type == EventType::Trade) {
+            ++trades;
+            key = e.data.trade.timestamp;
+        } else {
+            key = e.data.order_event.timestamp;
+        }
+        EXPECT_GE(key, last_ts);
+        last_ts = key;
+        ASSERT_LT(e.instrument_id, INSTRUMENTS);
+        EXPECT_GT(e.sequence_num, last_seq[e.instrument_id]);
+        last_seq[e.instrument_id] = e.sequence_num;
+    }
+    EXPECT_EQ(trades, INSTRUMENTS * ROUNDS);
+    for (InstrumentId inst = 0; inst < INSTRUMENTS; ++inst) {
+        EXPECT_TRUE(router.order_book(inst)->empty());
+    }
+    EXPECT_EQ(router.shard_processed(0) + router.shard_processed(1),
+              2 * INSTRUMENTS * ROUNDS);
+}
+
+TEST(ShardedRouterTest, IdleWorkerReleasesThrottledMessages) {
+    InstrumentRegistry reg = make_sharded_registry({1.0});
+    ShardedRouterConfig config;
+    config.num_shards = 1;
+    config.merged_stream = false;
+    ShardedRouter router(reg, config);
+
+    ThrottleConfig limits;
+    limits.participant = {100, 1};  // One message now, the next ~10 ms later
+    limits.action = ThrottleAction::Queue;
+    limits.max_participants = 4;
+    limits.max_instruments = 1;
+    limits.tsc_ticks_per_ns = 1.0;  // No faster than the real TSC
+    MessageThrottle throttle(limits);
+    router.pipeline(0)->gateway->set_throttle(&throttle);
+    router.start();
+
+    while (!router.submit(make_msg(0, 1, Side::Buy, 40 * PRICE_SCALE, 5))) {}
+    while (!router.submit(make_msg(0, 2, Side::Buy, 41 * PRICE_SCALE, 5))) {}
+    while (!router.idle()) std::this_thread::yield();
+
+    // No further input: the idle worker sends the deferred add on its own
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (router.order_book(0)->order_count() < 2 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(router.order_book(0)->order_count(), 2u);
+    EXPECT_EQ(throttle.deferred(), 0u);
+    router.stop();
+}
+
+TEST(ShardedRouterTest, AddInstrumentWhileRunningAndCountOutcomes) {
+    InstrumentRegistry reg = make_sharded_registry({2.0, 1.0});
+    ShardedRouterConfig config;
+    config.num_shards = 2;
+    config.assignment = ShardAssignment::ByLoad;
+    config.merged_stream = false;
+    config.count_outcomes = true;
+    ShardedRouter router(reg, config);
+    router.start();
+
+    // The new instrument joins the lighter shard
+    InstrumentConfig extra = *reg.find_by_id(1);
+    extra.instrument_id = 5;
+    extra.symbol = "SYM5";
+    ASSERT_TRUE(router.add_instrument(extra));
+    EXPECT_FALSE(router.add_instrument(extra));
+    EXPECT_EQ(router.shard_of(5), 1u);
+
+    auto submit = [&](const OrderMessage& msg) {
+        while (!router.submit(msg)) std::this_thread::yield();
+    };
+    submit(make_msg(5, 1, Side::Sell, 50 * PRICE_SCALE, 5));
+    auto buy = make_msg(5, 2, Side::Buy, 50 * PRICE_SCALE, 5);
+    buy.order.participant_id = 2;
+    submit(buy);
+    submit(make_msg(5, 3, Side::Buy, 40 * PRICE_SCALE, 5));
+    submit(make_msg(5, 3, Side::Buy, 0, 0, MessageType::Cancel));
+    submit(make_msg(5, 99, Side::Buy, 0, 0, MessageType::Cancel));
+    submit(make_msg(0, 4, Side::Buy, 40 * PRICE_SCALE, 5));
+    while (!router.idle()) std::this_thread::yield();
+    router.stop();
+
+    const InstrumentOutcomes* o = router.outcomes(5);
+    ASSERT_NE(o, nullptr);
+    EXPECT_EQ(o->orders_accepted, 3u);
+    EXPECT_EQ(o->trades_generated, 1u);
+    EXPECT_EQ(o->orders_cancelled, 1u);
+    EXPECT_EQ(o->cancel_failures, 1u);
+    EXPECT_EQ(router.outcomes(0)->orders_accepted, 1u);
+    EXPECT_EQ(router.outcomes(7), nullptr);
+    EXPECT_TRUE(router.order_book(5)->empty());
+}
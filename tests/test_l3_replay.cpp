@@ -1,18 +1,33 @@
 /// @file test_l3_replay.cpp
 /// @brief Unit and integration tests for L3FeedParser and ReplayEngine (Phase 6).
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 #include "core/types.h"
+#include "feed/background_replay.h"
+#include "feed/batch_replay.h"
+#include "feed/compressed_input.h"
+#include "feed/l3_binary_format.h"
 #include "feed/l3_feed_parser.h"
+#include "feed/playback_pacer.h"
 #include "feed/replay_engine.h"
+#include "feed/structural_scanner.h"
+#include "feed/workload_generator.h"
+#include "gateway/event_journal.h"
+#include "gateway/metrics_region.h"
 #include "transport/message.h"
+#include "utils/clock.h"
 
 using namespace hft;
 
@@ -243,6 +258,68 @@ TEST(L3CsvSplit, SingleField) {
     EXPECT_EQ(fields[0], "hello");
 }
 
+TEST(L3CsvSplit, SplitFieldsStopsAtMax) {
+    std::string_view fields[3];
+    const size_t n = L3FeedParser::split_fields("a,b,c,d,e", fields, 3);
+    ASSERT_EQ(n, 3u);
+    EXPECT_EQ(fields[0], "a");
+    EXPECT_EQ(fields[1], "b");
+    EXPECT_EQ(fields[2], "c");
+}
+
+TEST(L3CsvSplit, FieldsSpanningBlockBoundaries) {
+    // 150-byte line: commas fall on both sides of the 64- and 128-byte marks
+    std::string line;
+    std::vector<std::string> expected;
+    for (int i = 0; line.size() < 150; ++i) {
+        expected.push_back(std::string(static_cast<size_t>(i % 13), 'x') + std::to_string(i));
+        if (!line.empty()) line += ',';
+        line += expected.back();
+    }
+    auto fields = L3FeedParser::split_csv(line);
+    ASSERT_EQ(fields.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) EXPECT_EQ(fields[i], expected[i]);
+}
+
+// ===========================================================================
+// Structural scanner tests
+// ===========================================================================
+
+TEST(StructuralScanner, MatchesScalarReference) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += static_cast<char>("ab,=|\x01\n0"[i * 7 % 8]);
+    }
+    const StructuralSet sets[] = {StructuralSet(','), StructuralSet('|', '='),
+                                  StructuralSet(',', '\n', '|', '\x01')};
+    for (const StructuralSet& set : sets) {
+        for (size_t start = 0; start < 70; ++start) {
+            for (size_t n = 0; n <= 64; n += 7) {
+                EXPECT_EQ(structural_mask(text.data() + start, n, set),
+                          structural_mask_scalar(text.data() + start, n, set))
+                    << structural_scanner_isa() << " start=" << start << " n=" << n;
+            }
+        }
+    }
+}
+
+TEST(StructuralScanner, FindStructuralsReportsEveryOffset) {
+    const std::string text = "8=FIX.4.4|35=D|11=ORD-1|" + std::string(100, 'z') + "|55=BTC";
+    uint32_t offsets[32];
+    const size_t n = find_structurals(text.data(), text.size(), StructuralSet('|'),
+                                      offsets, 32);
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '|') expected.push_back(static_cast<uint32_t>(i));
+    }
+    ASSERT_EQ(n, expected.size());
+    for (size_t i = 0; i < n; ++i) EXPECT_EQ(offsets[i], expected[i]);
+
+    // Past `max` only the count is reported
+    EXPECT_EQ(find_structurals(text.data(), text.size(), StructuralSet('|'), offsets, 1),
+              expected.size());
+}
+
 // ===========================================================================
 // Full line parsing tests
 // ===========================================================================
@@ -602,6 +679,476 @@ TEST(L3LineParsing, CancelWithExtraFields) {
     remove_temp_csv(path);
 }
 
+TEST(L3LineParsing, CrlfLinesAndMissingFinalNewline) {
+    auto path = write_temp_csv(
+        "timestamp,event_type,order_id,side,price,quantity\r\n"
+        "1000,ADD,1,BUY,100.50,10\r\n"
+        "\r\n"
+        "1001,ADD,2,sell,101,5,extra,fields");
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(path));
+
+    L3Record record;
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_TRUE(record.valid);
+    EXPECT_EQ(record.quantity, 10u);
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_TRUE(record.valid);
+    EXPECT_EQ(record.order_id, 2u);
+    EXPECT_EQ(record.side, Side::Sell);
+    EXPECT_EQ(record.quantity, 5u);
+    EXPECT_EQ(record.symbol_id, L3_NO_SYMBOL);
+    EXPECT_FALSE(parser.next(record));
+    EXPECT_EQ(parser.lines_read(), 4u);
+
+    // Errors carry the offending field
+    parser.close();
+    remove_temp_csv(path);
+    path = write_temp_csv("1000,ADD,1,UP,100,10\n");
+    ASSERT_TRUE(parser.open(path));
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_FALSE(record.valid);
+    EXPECT_EQ(record.error, "invalid side: UP");
+
+    parser.close();
+    remove_temp_csv(path);
+}
+
+/// Every record a parse of `path` yields, as text (errors with their line
+/// number), followed by the final line count.
+static std::vector<std::string> parse_all(const std::string& path, size_t threads,
+                                          size_t chunk_bytes, uint64_t* errors = nullptr) {
+    L3FeedParser parser;
+    parser.set_parse_threads(threads, chunk_bytes);
+    EXPECT_TRUE(parser.open(path));
+    EXPECT_EQ(parser.parse_threads() > 0, threads > 0);
+    std::vector<std::string> out;
+    L3Record r;
+    while (parser.next(r)) {
+        std::string line = std::to_string(r.timestamp) + " " +
+                           std::to_string(static_cast<int>(r.event_type)) + " " +
+                           std::to_string(r.order_id) + " " +
+                           std::to_string(static_cast<int>(r.side)) + " " +
+                           std::to_string(r.price) + " " + std::to_string(r.quantity) +
+                           " " + std::string(r.symbol) + "#" +
+                           std::to_string(r.symbol_id) + " " + (r.valid ? "ok" : "bad");
+        if (!r.valid) {
+            line += " " + std::string(r.error) + " @" + std::to_string(parser.lines_read());
+        }
+        out.push_back(line);
+    }
+    out.push_back("lines " + std::to_string(parser.lines_read()));
+    if (errors) *errors = parser.parse_errors();
+    return out;
+}
+
+TEST(L3ParallelIngestion, ChunkedParseMatchesSequential) {
+    std::string csv = "timestamp,event_type,order_id,side,price,quantity\r\n";
+    for (int i = 0; i < 3000; ++i) {
+        csv += std::to_string(1000 + i) + (i % 5 == 4 ? ",CANCEL," : ",ADD,") +
+               std::to_string(i) + (i % 2 ? ",SELL," : ",BUY,") +
+               std::to_string(100 + i % 50) + ".25," + std::to_string(1 + i % 7);
+        if (i % 97 == 0) csv += "\n1000,ADD,1,UP,100,10";   // Invalid side
+        if (i % 131 == 0) csv += "\n";                      // Blank line
+        csv += (i % 3 ? "\n" : "\r\n");
+    }
+    auto path = write_temp_csv(csv);
+
+    uint64_t seq_errors = 0;
+    uint64_t par_errors = 0;
+    const auto sequential = parse_all(path, 0, 0, &seq_errors);
+    // Chunks of ~1 KB: many chunks per worker, lines split at every offset
+    const auto parallel = parse_all(path, 3, 1000, &par_errors);
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        ASSERT_EQ(parallel[i], sequential[i]) << "record " << i;
+    }
+    EXPECT_EQ(par_errors, seq_errors);
+    EXPECT_GT(seq_errors, 0u);
+
+    remove_temp_csv(path);
+}
+
+TEST(L3ParallelIngestion, SymbolIdsFollowFirstAppearance) {
+    std::string csv = "symbol,timestamp,event_type,order_id,side,price,quantity\n";
+    const char* symbols[] = {"BTCUSDT", "ETHUSDT", "SOLUSDT", "XRPUSDT"};
+    for (int i = 0; i < 2000; ++i) {
+        // Later symbols first appear deep into the file
+        const int s = i < 500 ? 0 : (i < 1200 ? i % 2 : i % 4);
+        csv += std::string(symbols[s]) + "," + std::to_string(1000 + i) + ",ADD," +
+               std::to_string(i) + ",BUY,100," + std::to_string(1 + i % 9) + "\n";
+    }
+    auto path = write_temp_csv(csv);
+
+    const auto sequential = parse_all(path, 0, 0);
+    const auto parallel = parse_all(path, 4, 700);
+    EXPECT_EQ(parallel, sequential);
+
+    // reset() restarts the workers and keeps the interned ids
+    L3FeedParser parser;
+    parser.set_parse_threads(2, 700);
+    ASSERT_TRUE(parser.open(path));
+    EXPECT_TRUE(parser.has_symbol_column());
+    L3Record r;
+    uint64_t first_pass = 0;
+    while (parser.next(r)) ++first_pass;
+    EXPECT_EQ(parser.symbol_count(), 4u);
+    EXPECT_EQ(parser.symbol_name(3), "XRPUSDT");
+    parser.reset();
+    uint64_t second_pass = 0;
+    while (parser.next(r)) {
+        EXPECT_LT(r.symbol_id, 4u);
+        ++second_pass;
+    }
+    EXPECT_EQ(second_pass, first_pass);
+
+    parser.close();
+    remove_temp_csv(path);
+}
+
+// ===========================================================================
+// Binary L3 format
+// ===========================================================================
+
+TEST(L3BinaryFormat, ConvertedFileYieldsTheSameRecords) {
+    // A 10 s gap and a clock step back both need a TimeBase record
+    auto path = write_temp_csv(
+        "timestamp,event_type,order_id,side,price,quantity\n"
+        "1000,ADD,1,BUY,42000.12345678,10\n"
+        "2500,ADD,2,SELL,42001,3\n"
+        "10000002500,MODIFY,2,SELL,42002.5,4\n"
+        "10000000000,CANCEL,1,,,\n"
+        "bad,row\n"
+        "10000000001,TRADE,,BUY,42002.5,1\n");
+    const std::string binary_path = "test_l3_temp.l3b";
+
+    L3ConvertStats cs = convert_l3_csv_to_binary(path, binary_path);
+    ASSERT_TRUE(cs.ok);
+    EXPECT_EQ(cs.rows_read, 6u);
+    EXPECT_EQ(cs.rows_skipped, 1u);
+    EXPECT_EQ(cs.records_written, 5u + 2u);  // Two rebases
+    EXPECT_EQ(cs.symbol_count, 0u);
+    EXPECT_TRUE(is_l3_binary_file(binary_path));
+    EXPECT_FALSE(is_l3_binary_file(path));
+
+    L3FeedParser csv;
+    L3FeedParser binary;
+    ASSERT_TRUE(csv.open(path));
+    ASSERT_TRUE(binary.open(binary_path));
+    EXPECT_TRUE(binary.is_binary());
+    EXPECT_FALSE(binary.has_symbol_column());
+
+    for (int pass = 0; pass < 2; ++pass) {  // Again after reset()
+        L3Record expected;
+        L3Record actual;
+        size_t n = 0;
+        while (csv.next(expected)) {
+            if (!expected.valid) continue;
+            ASSERT_TRUE(binary.next(actual));
+            EXPECT_TRUE(actual.valid);
+            EXPECT_EQ(actual.timestamp, expected.timestamp);
+            EXPECT_EQ(actual.event_type, expected.event_type);
+            EXPECT_EQ(actual.order_id, expected.order_id);
+            EXPECT_EQ(actual.side, expected.side);
+            EXPECT_EQ(actual.price, expected.price);
+            EXPECT_EQ(actual.quantity, expected.quantity);
+            EXPECT_EQ(actual.symbol_id, L3_NO_SYMBOL);
+            ++n;
+        }
+        EXPECT_EQ(n, 5u);
+        EXPECT_FALSE(binary.next(actual));
+        csv.reset();
+        binary.reset();
+    }
+
+    binary.close();
+    csv.close();
+    remove_temp_csv(binary_path);
+    remove_temp_csv(path);
+}
+
+TEST(L3BinaryFormat, RejectsTruncatedFile) {
+    auto path = write_temp_csv("1000,ADD,1,BUY,100,10\n");
+    const std::string binary_path = "test_l3_temp.l3b";
+    ASSERT_TRUE(convert_l3_csv_to_binary(path, binary_path).ok);
+
+    // Cut the last record in half
+    std::string bytes;
+    {
+        std::ifstream in(binary_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes.resize(sizeof(L3BinaryHeader) + sizeof(L3BinaryRecord) / 2);
+    {
+        std::ofstream out(binary_path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+    L3FeedParser parser;
+    EXPECT_FALSE(parser.open(binary_path));
+
+    remove_temp_csv(binary_path);
+    remove_temp_csv(path);
+}
+
+TEST(L3BinaryFormat, TellAndSeekResumeMidFile) {
+    auto path = write_temp_csv(
+        "timestamp,event_type,order_id,side,price,quantity\n"
+        "1000,ADD,1,BUY,42000,10\n"
+        "2000,ADD,2,SELL,42001,3\n"
+        "bad,row\n"
+        "10000003000,ADD,3,SELL,42002,4\n"
+        "10000004000,CANCEL,1,,,\n");
+    const std::string binary_path = "test_l3_temp.l3b";
+    ASSERT_TRUE(convert_l3_csv_to_binary(path, binary_path).ok);
+
+    for (const std::string& input : {path, binary_path}) {
+        L3FeedParser parser;
+        ASSERT_TRUE(parser.open(input));
+        ASSERT_TRUE(parser.seekable());
+        L3Record record;
+        ASSERT_TRUE(parser.next(record));
+        ASSERT_TRUE(parser.next(record));
+        const L3FeedPosition mark = parser.tell();
+        std::vector<Timestamp> rest;
+        while (parser.next(record)) {
+            if (record.valid) rest.push_back(record.timestamp);
+        }
+        ASSERT_EQ(rest.size(), 2u);
+
+        // Resume at the mark: same records, same counters
+        ASSERT_TRUE(parser.seek(mark));
+        EXPECT_EQ(parser.lines_read(), mark.lines_read);
+        std::vector<Timestamp> again;
+        while (parser.next(record)) {
+            if (record.valid) again.push_back(record.timestamp);
+        }
+        EXPECT_EQ(again, rest);
+
+        L3FeedPosition past = mark;
+        past.offset = UINT64_MAX;
+        EXPECT_FALSE(parser.seek(past));
+        parser.close();
+    }
+
+    remove_temp_csv(binary_path);
+    remove_temp_csv(path);
+}
+
+// ===========================================================================
+// Compressed input
+// ===========================================================================
+
+TEST(CompressedInput, DetectsFrameMagic) {
+    EXPECT_EQ(detect_compression("\x1f\x8b\x08", 3), Compression::Gzip);
+    EXPECT_EQ(detect_compression("\x28\xb5\x2f\xfd", 4), Compression::Zstd);
+    EXPECT_EQ(detect_compression("\x04\x22\x4d\x18", 4), Compression::Lz4);
+    EXPECT_EQ(detect_compression("timestamp,", 10), Compression::None);
+    EXPECT_EQ(detect_compression("\x28\xb5", 2), Compression::None);
+}
+
+TEST(CompressedInput, StreamedCsvMatchesPlainFile) {
+    // 7-column rows across more than one 4 MB decompression block, so lines
+    // and symbols straddle block boundaries
+    std::string csv = "symbol,timestamp,event_type,order_id,side,price,quantity\n";
+    const char* symbols[] = {"BTCUSDT", "ETHUSDT", "SOLUSDT"};
+    for (int i = 0; csv.size() < (size_t{9} << 20); ++i) {
+        csv += std::string(symbols[i % 3]) + "," + std::to_string(1000 + i) +
+               (i % 4 == 3 ? ",CANCEL," : ",ADD,") + std::to_string(i) +
+               (i % 2 ? ",SELL," : ",BUY,") + std::to_string(100 + i % 50) + ".5," +
+               std::to_string(1 + i % 7) + (i % 1000 == 0 ? ",x,y\r\n" : "\n");
+        if (i % 50000 == 0) csv += "bad,row\n";
+    }
+    csv += "BTCUSDT,99,ADD,1,BUY,1,1";  // No final newline
+    auto path = write_temp_csv(csv);
+    const auto plain = parse_all(path, 0, 0);
+
+    for (Compression c : {Compression::Gzip, Compression::Zstd, Compression::Lz4}) {
+        if (!compression_supported(c)) continue;
+        const std::string packed = std::string("test_l3_temp.csv.") + compression_name(c);
+        ASSERT_TRUE(compress_file(path, packed, c)) << compression_name(c);
+        EXPECT_EQ(detect_compression(packed), c);
+
+        L3FeedParser parser;
+        ASSERT_TRUE(parser.open(packed));
+        EXPECT_TRUE(parser.is_compressed_stream());
+        EXPECT_LT(parser.file_size(), csv.size());
+        parser.close();
+
+        const auto streamed = parse_all(packed, 0, 0);
+        ASSERT_EQ(streamed.size(), plain.size()) << compression_name(c);
+        EXPECT_TRUE(streamed == plain) << compression_name(c);
+        remove_temp_csv(packed);
+    }
+    remove_temp_csv(path);
+}
+
+TEST(CompressedInput, FrameEndingOnABlockBoundaryIsNotTruncated) {
+    // The decoder fills the last block exactly while the whole frame is
+    // already read: the tail it still holds must be flushed, not reported
+    // as a truncated stream.
+    constexpr size_t BLOCK = 4096;
+    std::string plain;
+    for (uint32_t x = 1; plain.size() < 64 * BLOCK; x = x * 1103515245u + 12345u) {
+        plain += static_cast<char>('a' + (x >> 16) % 16);
+    }
+    plain.resize(64 * BLOCK);
+    auto path = write_temp_csv(plain);
+
+    for (Compression c : {Compression::Zstd, Compression::Lz4}) {
+        if (!compression_supported(c)) continue;
+        const std::string packed = std::string("test_l3_temp.bin.") + compression_name(c);
+        ASSERT_TRUE(compress_file(path, packed, c)) << compression_name(c);
+
+        for (size_t block : {BLOCK, 16 * BLOCK, 64 * BLOCK}) {
+            DecompressingReader reader(block);
+            ASSERT_TRUE(reader.open(packed)) << reader.error();
+            std::string out;
+            for (auto b = reader.next_block(); !b.empty(); b = reader.next_block()) {
+                out.append(b.data(), b.size());
+            }
+            EXPECT_FALSE(reader.failed()) << compression_name(c) << ": " << reader.error();
+            EXPECT_TRUE(out == plain) << compression_name(c) << " block " << block;
+            reader.close();
+        }
+        remove_temp_csv(packed);
+    }
+    remove_temp_csv(path);
+}
+
+TEST(CompressedInput, ResetDecompressesAgainWithTheSameSymbolIds) {
+    if (!compression_supported(Compression::Gzip)) return;
+    auto path = write_temp_csv(
+        "symbol,timestamp,event_type,order_id,side,price,quantity\n"
+        "ETHUSDT,1000,ADD,1,BUY,100,10\n"
+        "BTCUSDT,1001,ADD,2,SELL,101,5\n");
+    const std::string packed = "test_l3_temp.csv.gz";
+    ASSERT_TRUE(compress_file(path, packed, Compression::Gzip));
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(packed));
+    for (int pass = 0; pass < 2; ++pass) {
+        L3Record r;
+        ASSERT_TRUE(parser.next(r));
+        EXPECT_EQ(r.symbol, "ETHUSDT");
+        EXPECT_EQ(r.symbol_id, 0u);
+        ASSERT_TRUE(parser.next(r));
+        EXPECT_EQ(r.symbol, "BTCUSDT");
+        EXPECT_EQ(r.symbol_id, 1u);
+        EXPECT_FALSE(parser.next(r));
+        parser.reset();
+    }
+    EXPECT_EQ(parser.symbol_name(1), "BTCUSDT");
+
+    parser.close();
+    remove_temp_csv(packed);
+    remove_temp_csv(path);
+}
+
+TEST(CompressedInput, CompressedBinaryFileReplays) {
+    if (!compression_supported(Compression::Gzip)) return;
+    auto path = write_temp_csv(
+        "symbol,timestamp,event_type,order_id,side,price,quantity\n"
+        "ETHUSDT,1000,ADD,1,BUY,100,10\n"
+        "BTCUSDT,1001,ADD,2,SELL,101,5\n");
+    const std::string binary_path = "test_l3_temp.l3b";
+    const std::string packed = "test_l3_temp.l3b.gz";
+    ASSERT_TRUE(convert_l3_csv_to_binary(path, binary_path).ok);
+    ASSERT_TRUE(compress_file(binary_path, packed, Compression::Gzip));
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(packed));
+    EXPECT_TRUE(parser.is_binary());
+    EXPECT_TRUE(parser.has_symbol_column());
+    L3Record r;
+    ASSERT_TRUE(parser.next(r));
+    EXPECT_EQ(r.symbol, "ETHUSDT");
+    EXPECT_EQ(r.quantity, 10u);
+    ASSERT_TRUE(parser.next(r));
+    EXPECT_EQ(r.symbol, "BTCUSDT");
+    EXPECT_EQ(r.price, 101 * PRICE_SCALE);
+    EXPECT_FALSE(parser.next(r));
+
+    parser.close();
+    remove_temp_csv(packed);
+    remove_temp_csv(binary_path);
+    remove_temp_csv(path);
+}
+
+TEST(CompressedInput, TruncatedStreamEndsWithAnError) {
+    if (!compression_supported(Compression::Gzip)) return;
+    std::string csv;
+    for (int i = 0; i < 20000; ++i) {
+        csv += std::to_string(1000 + i) + ",ADD," + std::to_string(i) + ",BUY,100," +
+               std::to_string(i % 89 + 1) + "\n";
+    }
+    auto path = write_temp_csv(csv);
+    const std::string packed = "test_l3_temp.csv.gz";
+    ASSERT_TRUE(compress_file(path, packed, Compression::Gzip));
+    std::string bytes;
+    {
+        std::ifstream in(packed, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes.resize(bytes.size() / 2);
+    {
+        std::ofstream out(packed, std::ios::binary | std::ios::trunc);
+        out << bytes;
+    }
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(packed));
+    L3Record r;
+    uint64_t n = 0;
+    while (parser.next(r)) ++n;
+    EXPECT_LT(n, 20000u);
+    EXPECT_FALSE(parser.input_error().empty());
+
+    parser.close();
+    remove_temp_csv(packed);
+    remove_temp_csv(path);
+}
+
+// ===========================================================================
+// Playback pacing
+// ===========================================================================
+
+static double paced_seconds(PlaybackPacer& pacer, const std::vector<Timestamp>& stamps) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (Timestamp ts : stamps) pacer.wait(ts);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static double tsc_per_ns_once() {
+    static const double freq = calibrate_tsc_frequency();
+    return freq;
+}
+
+TEST(PlaybackPacer, ReleasesOnAnAbsoluteScheduleAndKeepsBursts) {
+    // Bursts of 5 identical stamps, 1 ms apart: 20 ms of schedule
+    std::vector<Timestamp> stamps;
+    for (Timestamp burst = 0; burst <= 20; ++burst) {
+        for (int i = 0; i < 5; ++i) stamps.push_back(1'000'000'000 + burst * 1'000'000);
+    }
+    PlaybackPacer pacer(1.0, PlaybackPacer::DEFAULT_SPIN_NS, tsc_per_ns_once());
+    EXPECT_GE(paced_seconds(pacer, stamps), 0.0195);
+
+    const PacingStats stats = pacer.stats();
+    EXPECT_EQ(stats.paced_records, stamps.size());
+    EXPECT_GE(stats.overdue_records, 21u * 4);  // All but each burst's first
+    EXPECT_GT(stats.sleeps, 0u);
+    EXPECT_GE(stats.error_max_ns, stats.error_p50_ns);
+}
+
+TEST(PlaybackPacer, FastForwardDividesTheSpacing) {
+    std::vector<Timestamp> stamps;
+    for (Timestamp i = 0; i <= 20; ++i) stamps.push_back(i * 2'000'000);  // 40 ms
+    PlaybackPacer pacer(4.0, PlaybackPacer::DEFAULT_SPIN_NS, tsc_per_ns_once());
+    const double seconds = paced_seconds(pacer, stamps);
+    EXPECT_GE(seconds, 0.0095);
+    EXPECT_LT(seconds, 0.035);
+    EXPECT_TRUE(pacer.due(0));  // Out-of-order stamps are never held back
+}
+
 // ===========================================================================
 // ReplayEngine integration tests
 // ===========================================================================
@@ -840,6 +1387,13 @@ TEST_F(ReplayEngineTest, JsonReportWritten) {
     EXPECT_NE(content.find("messages"), std::string::npos);
     EXPECT_NE(content.find("final_state"), std::string::npos);
     EXPECT_NE(content.find("performance"), std::string::npos);
+    EXPECT_NE(content.find("\"memory\""), std::string::npos);
+    EXPECT_NE(content.find("high_water_bytes"), std::string::npos);
+
+    // The same footprint is in the stats
+    EXPECT_GT(stats.memory.total().reserved_bytes, 0u);
+    EXPECT_GT(stats.memory.book.levels.reserved_bytes, 0u);
+    EXPECT_GT(stats.memory.pool.high_water_bytes, 0u);
 }
 
 TEST_F(ReplayEngineTest, EventCallbackFires) {
@@ -860,6 +1414,129 @@ TEST_F(ReplayEngineTest, EventCallbackFires) {
     EXPECT_GE(events.size(), 3u);
 }
 
+TEST_F(ReplayEngineTest, JournalRecordsThePublishedStream) {
+    auto config = make_config(
+        "1704067200000000000,ADD,1,SELL,42000.00,10\n"
+        "1704067200000100000,ADD,2,BUY,42000.00,4\n"
+        "1704067200000200000,CANCEL,1,SELL,0,0\n");
+    const std::string dir =
+        (std::filesystem::temp_directory_path() / "hft_replay_journal").string();
+    std::filesystem::remove_all(dir);
+    config.journal.directory = dir;  // Turns the publisher on by itself
+
+    ReplayEngine engine(config);
+    std::vector<EventMessage> events;
+    engine.register_event_callback([&](const EventMessage& e) { events.push_back(e); });
+    auto stats = engine.run();
+
+    ASSERT_GE(events.size(), 4u);
+    EXPECT_EQ(stats.journal_events, events.size());
+    EXPECT_EQ(stats.journal_dropped, 0u);
+    EXPECT_EQ(stats.journal_segments, 1u);
+
+    EventJournalReader reader;
+    ASSERT_TRUE(reader.open(dir));
+    EventMessage e{};
+    size_t i = 0;
+    while (reader.next(e)) {
+        ASSERT_LT(i, events.size());
+        EXPECT_EQ(e.sequence_num, events[i].sequence_num);
+        EXPECT_EQ(e.type, events[i].type);
+        ++i;
+    }
+    EXPECT_EQ(i, events.size());
+    std::filesystem::remove_all(dir);
+}
+
+/// A day of crossing adds and cancels, one record per millisecond.
+static std::string make_seek_csv(size_t records) {
+    std::string csv;
+    for (size_t i = 0; i < records; ++i) {
+        const uint64_t ts = 1'000'000'000ULL + i * 1'000'000ULL;
+        const uint64_t id = i + 1;
+        char line[96];
+        if (i % 5 == 4) {
+            std::snprintf(line, sizeof(line), "%llu,CANCEL,%llu,BUY,0,0\n",
+                          static_cast<unsigned long long>(ts),
+                          static_cast<unsigned long long>(id - 3));
+        } else {
+            const bool buy = (i * 7) % 3 != 0;
+            const int price = 42000 + static_cast<int>((i * 13) % 9) - 4;
+            std::snprintf(line, sizeof(line), "%llu,ADD,%llu,%s,%d.00,%zu\n",
+                          static_cast<unsigned long long>(ts),
+                          static_cast<unsigned long long>(id), buy ? "BUY" : "SELL",
+                          price, 1 + (i * 11) % 7);
+        }
+        csv += line;
+    }
+    return csv;
+}
+
+TEST_F(ReplayEngineTest, SeekFromCheckpointMatchesFullReplay) {
+    auto config = make_config(make_seek_csv(600));
+    const std::string dir =
+        (std::filesystem::temp_directory_path() / "hft_replay_checkpoints").string();
+    std::filesystem::remove_all(dir);
+    config.enable_publisher = true;
+    config.checkpoint_directory = dir;
+    config.checkpoint_every_records = 100;
+
+    ReplayEngine full(config);
+    std::vector<EventMessage> full_events;
+    full.register_event_callback([&](const EventMessage& e) { full_events.push_back(e); });
+    const ReplayStats full_stats = full.run();
+    EXPECT_EQ(full_stats.checkpoints_written, 5u);
+    const auto index = ReplayEngine::load_checkpoints(dir);
+    ASSERT_EQ(index.size(), 5u);
+    EXPECT_EQ(index[2].records, 300u);
+
+    // Record 350 onwards, from the checkpoint at record 300
+    const Timestamp target = 1'000'000'000ULL + 350 * 1'000'000ULL;
+    ReplayEngine seeked(config);
+    std::vector<EventMessage> tail;
+    seeked.register_event_callback([&](const EventMessage& e) { tail.push_back(e); });
+    ASSERT_TRUE(seeked.seek(target));
+    const ReplayStats stats = seeked.run();
+
+    EXPECT_EQ(stats.seek_checkpoint_timestamp, index[2].timestamp);
+    EXPECT_EQ(stats.seek_warmup_records, 50u);
+    EXPECT_EQ(stats.total_messages, 250u);
+    EXPECT_EQ(stats.checkpoints_written, 0u);  // The index is left alone
+    EXPECT_EQ(ReplayEngine::load_checkpoints(dir).size(), 5u);
+    EXPECT_EQ(stats.final_order_count, full_stats.final_order_count);
+    EXPECT_EQ(stats.final_best_bid, full_stats.final_best_bid);
+    EXPECT_EQ(stats.final_best_ask, full_stats.final_best_ask);
+
+    // The tail of the stream is event-for-event the full replay's
+    ASSERT_FALSE(tail.empty());
+    ASSERT_LE(tail.size(), full_events.size());
+    const size_t offset = full_events.size() - tail.size();
+    for (size_t i = 0; i < tail.size(); ++i) {
+        const EventMessage& expected = full_events[offset + i];
+        ASSERT_EQ(tail[i].sequence_num, expected.sequence_num);
+        EXPECT_EQ(tail[i].type, expected.type);
+        if (expected.type == EventType::Trade) {
+            EXPECT_EQ(tail[i].data.trade.trade_id, expected.data.trade.trade_id);
+            EXPECT_EQ(tail[i].data.trade.buy_order_id, expected.data.trade.buy_order_id);
+            EXPECT_EQ(tail[i].data.trade.quantity, expected.data.trade.quantity);
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ReplayEngineTest, SeekWithoutCheckpointsAndEndTimestampBoundTheWindow) {
+    auto config = make_config(make_seek_csv(200));
+    config.end_timestamp = 1'000'000'000ULL + 149 * 1'000'000ULL;
+
+    ReplayEngine engine(config);
+    ASSERT_TRUE(engine.seek(1'000'000'000ULL + 100 * 1'000'000ULL));
+    const ReplayStats stats = engine.run();
+    EXPECT_EQ(stats.seek_checkpoint_timestamp, 0u);  // Warmed up from the top
+    EXPECT_EQ(stats.seek_warmup_records, 100u);
+    EXPECT_EQ(stats.total_messages, 50u);            // Records 100..149
+    EXPECT_FALSE(engine.seek(0));                    // Only once, before run()
+}
+
 TEST_F(ReplayEngineTest, HeaderLineSkipped) {
     auto config = make_config(
         "timestamp,event_type,order_id,side,price,quantity\n"
@@ -894,6 +1571,387 @@ TEST_F(ReplayEngineTest, BuildBookAndVerifyState) {
     EXPECT_EQ(book.best_ask()->price, 42001LL * PRICE_SCALE);
 }
 
+TEST_F(ReplayEngineTest, PipelinedModeMatchesInline) {
+    std::string csv;
+    for (int i = 0; i < 3000; ++i) {
+        long long ts = 1704067200000000000LL + i * 1000LL;
+        int id = i + 1;
+        const char* side = (i % 2 == 0) ? "BUY" : "SELL";
+        int cents = 4200000 + ((i * 7) % 40) - 20;
+        csv += std::to_string(ts) + ",ADD," + std::to_string(id) + "," + side +
+               "," + std::to_string(cents / 100) + "." +
+               std::to_string(cents % 100 / 10) + std::to_string(cents % 10) + ",5\n";
+        if (i % 5 == 4) {
+            csv += std::to_string(ts + 1) + ",CANCEL," + std::to_string(id - 2) +
+                   ",BUY,0,0\n";
+        }
+    }
+    auto config = make_config(csv);
+    config.enable_publisher = true;
+    config.batch_size = 16;
+
+    ReplayEngine inline_engine(config);
+    size_t inline_events = 0;
+    inline_engine.register_event_callback([&](const EventMessage&) { ++inline_events; });
+    auto expected = inline_engine.run();
+
+    config.pipelined = true;
+    ReplayEngine engine(config);
+    size_t events = 0;
+    engine.register_event_callback([&](const EventMessage&) { ++events; });
+    auto stats = engine.run();
+
+    EXPECT_EQ(stats.total_messages, expected.total_messages);
+    EXPECT_EQ(stats.add_messages, 3000u);
+    EXPECT_EQ(stats.cancel_messages, expected.cancel_messages);
+    EXPECT_EQ(stats.orders_accepted, expected.orders_accepted);
+    EXPECT_EQ(stats.orders_cancelled, expected.orders_cancelled);
+    EXPECT_EQ(stats.cancel_failures, expected.cancel_failures);
+    EXPECT_EQ(stats.trades_generated, expected.trades_generated);
+    EXPECT_GT(stats.trades_generated, 0u);
+    EXPECT_EQ(stats.final_order_count, expected.final_order_count);
+    EXPECT_EQ(stats.final_best_bid, expected.final_best_bid);
+    EXPECT_EQ(stats.final_best_ask, expected.final_best_ask);
+
+    // Every event reached the publisher thread's callbacks
+    EXPECT_EQ(events, inline_events);
+    EXPECT_EQ(stats.events_published, events);
+    EXPECT_GT(stats.parse_messages_per_second, 0.0);
+    EXPECT_GT(stats.match_messages_per_second, 0.0);
+    EXPECT_LE(stats.ingress_depth_max, 8192u);
+
+    // Blocking waits change only how idle threads sleep
+    config.consumer_wait.strategy = WaitStrategy::Block;
+    ReplayEngine blocking(config);
+    size_t blocking_events = 0;
+    blocking.register_event_callback([&](const EventMessage&) { ++blocking_events; });
+    auto blocked = blocking.run();
+    EXPECT_EQ(blocked.trades_generated, expected.trades_generated);
+    EXPECT_EQ(blocked.final_order_count, expected.final_order_count);
+    EXPECT_EQ(blocking_events, inline_events);
+}
+
+#if defined(HFT_TRACE)
+TEST_F(ReplayEngineTest, TracesSampledOrdersThroughEveryStage) {
+    std::string csv;
+    for (int i = 0; i < 400; ++i) {
+        long long ts = 1704067200000000000LL + i * 1000LL;
+        int id = i + 1;
+        const char* side = (i % 2 == 0) ? "BUY" : "SELL";
+        csv += std::to_string(ts) + ",ADD," + std::to_string(id) + "," + side +
+               (i % 2 == 0 ? ",41999.00,5\n" : ",42001.00,5\n");
+        if (i % 4 == 3) {
+            csv += std::to_string(ts + 1) + ",CANCEL," + std::to_string(id) + ",BUY,0,0\n";
+        }
+    }
+    auto config = make_config(csv);
+    config.enable_publisher = true;
+    config.trace_sample_every = 4;
+
+    for (bool pipelined : {false, true}) {
+        config.pipelined = pipelined;
+        ReplayEngine engine(config);
+        auto stats = engine.run();
+        EXPECT_EQ(stats.trace_dropped, 0u);
+        // Ids 4, 8, ... 400: their add, and their cancel
+        ASSERT_EQ(engine.order_traces().size(), 200u) << "pipelined " << pipelined;
+        size_t adds = 0;
+        for (const OrderTrace& trace : engine.order_traces()) {
+            EXPECT_EQ(trace.order_id % 4, 0u);
+            EXPECT_TRUE(trace.has(TraceStage::Parse));
+            EXPECT_TRUE(trace.has(TraceStage::Match));
+            EXPECT_TRUE(trace.has(TraceStage::EventPublish));
+            EXPECT_TRUE(trace.has(TraceStage::PublisherDispatch));
+            EXPECT_EQ(trace.events_dispatched, trace.events);
+            if (trace.has(TraceStage::PoolAllocate)) ++adds;
+        }
+        EXPECT_EQ(adds, 100u);
+    }
+}
+#endif
+
+TEST_F(ReplayEngineTest, PublishesLiveMetrics) {
+    std::string csv;
+    for (int i = 0; i < 300; ++i) {
+        long long ts = 1704067200000000000LL + i * 1000LL;
+        const char* side = (i % 2 == 0) ? "BUY" : "SELL";
+        csv += std::to_string(ts) + ",ADD," + std::to_string(i + 1) + "," + side +
+               (i % 2 == 0 ? ",41999.00,5\n" : ",42001.00,5\n");
+    }
+    auto config = make_config(csv);
+    config.enable_publisher = true;
+    config.batch_size = 32;
+    config.metrics_name = "hft_test_replay_" + std::to_string(::getpid());
+
+    for (bool pipelined : {false, true}) {
+        config.pipelined = pipelined;
+        ReplayEngine engine(config);
+        auto stats = engine.run();
+        const MetricsRegion* metrics = engine.metrics();
+        ASSERT_NE(metrics, nullptr);
+
+        auto value = [&](const char* name, uint32_t thread) {
+            const MetricSlot* slot = metrics->find(name, thread);
+            EXPECT_NE(slot, nullptr) << name;
+            return slot ? slot->value.load() : 0;
+        };
+        EXPECT_EQ(value("gateway.orders_processed", ReplayEngine::METRICS_MATCHING_THREAD),
+                  stats.orders_accepted);
+        EXPECT_EQ(value("gateway.pool_in_use", ReplayEngine::METRICS_MATCHING_THREAD),
+                  stats.final_order_count);
+        EXPECT_EQ(value("parser.records", ReplayEngine::METRICS_PARSER_THREAD), 300u);
+        EXPECT_EQ(value("publisher.events_processed", ReplayEngine::METRICS_PUBLISHER_THREAD),
+                  value("gateway.events_published", ReplayEngine::METRICS_MATCHING_THREAD));
+        const MetricSlot* batches =
+            metrics->find("gateway.batch_ticks", ReplayEngine::METRICS_MATCHING_THREAD);
+        ASSERT_NE(batches, nullptr);
+        EXPECT_EQ(batches->kind, MetricKind::Histogram);
+        EXPECT_TRUE(std::filesystem::exists("/dev/shm/" + config.metrics_name));
+    }
+    EXPECT_FALSE(std::filesystem::exists("/dev/shm/" + config.metrics_name));
+}
+
+TEST_F(ReplayEngineTest, RealtimeAndFastForwardPaceTheReplay) {
+    std::string csv;
+    for (int i = 0; i < 20; ++i) {
+        csv += std::to_string(1704067200000000000ULL + i * 1'000'000ULL) + ",ADD," +
+               std::to_string(i + 1) + ",BUY,42000.00,1\n";
+    }
+    auto config = make_config(csv);
+    config.speed = PlaybackSpeed::Realtime;
+    const auto realtime = ReplayEngine(config).run();
+    EXPECT_EQ(realtime.orders_accepted, 20u);
+    EXPECT_EQ(realtime.paced_records, 20u);
+    EXPECT_GE(realtime.elapsed_seconds, 0.0185);
+
+    config.speed = PlaybackSpeed::FastForward;
+    config.speed_multiplier = 2.0;
+    config.pipelined = true;
+    const auto fast = ReplayEngine(config).run();
+    EXPECT_EQ(fast.orders_accepted, 20u);
+    EXPECT_EQ(fast.paced_records, 20u);
+    EXPECT_GE(fast.elapsed_seconds, 0.009);
+    EXPECT_GE(fast.pacing_error_max_ns, fast.pacing_error_p99_ns);
+}
+
+TEST_F(ReplayEngineTest, BackgroundReplayDeliversTheWholeStreamInBatches) {
+    // More events than the ring holds, so a gating reader holds matching back
+    auto config = make_config(make_seek_csv(60000));
+    config.enable_publisher = true;
+    ReplayEngine reference(config);
+    std::vector<EventMessage> expected;
+    reference.register_event_callback([&](const EventMessage& e) { expected.push_back(e); });
+    const ReplayStats reference_stats = reference.run();
+    ASSERT_GT(expected.size(), EventBuffer::capacity());
+
+    for (bool pipelined : {false, true}) {
+        config.pipelined = pipelined;
+        ReplayEngine engine(config);
+        uint64_t callback_events = 0;
+        engine.register_event_callback([&](const EventMessage&) { ++callback_events; });
+        ReplayStats stats;
+        BackgroundReplay replay(*engine.event_buffer(), [&] { stats = engine.run(); });
+        EXPECT_EQ(replay.next_batch(nullptr, 0), 0u);
+        ASSERT_TRUE(replay.start());
+        EXPECT_FALSE(replay.start());
+
+        std::vector<EventMessage> batch(1000);
+        std::vector<EventMessage> events;
+        while (size_t n = replay.next_batch(batch.data(), batch.size())) {
+            ASSERT_LE(n, batch.size());
+            events.insert(events.end(), batch.begin(), batch.begin() + n);
+        }
+        EXPECT_TRUE(replay.finished());
+        replay.stop();
+
+        EXPECT_EQ(replay.lost(), 0u);
+        EXPECT_EQ(replay.events_read(), expected.size());
+        EXPECT_EQ(callback_events, expected.size());
+        EXPECT_EQ(stats.trades_generated, reference_stats.trades_generated);
+        ASSERT_EQ(events.size(), expected.size()) << "pipelined=" << pipelined;
+        for (size_t i = 0; i < events.size(); ++i) {
+            ASSERT_EQ(events[i].sequence_num, expected[i].sequence_num) << i;
+            ASSERT_EQ(events[i].type, expected[i].type) << i;
+        }
+    }
+}
+
+TEST_F(ReplayEngineTest, StoppedBackgroundReplayStillRunsToTheEnd) {
+    auto config = make_config(make_seek_csv(60000));
+    config.enable_publisher = true;
+    ReplayEngine engine(config);
+    ReplayStats stats;
+    BackgroundReplay replay(*engine.event_buffer(), [&] { stats = engine.run(); });
+    ASSERT_TRUE(replay.start());
+
+    // Abandon the stream after one batch: the full ring must not stall the run
+    EventMessage batch[64];
+    EXPECT_GT(replay.next_batch(batch, 64), 0u);
+    replay.stop();
+    EXPECT_TRUE(replay.finished());
+    EXPECT_EQ(stats.total_messages, 60000u);
+    EXPECT_EQ(replay.next_batch(batch, 64), 0u);
+}
+
+/// Write `content` to `path` (for tests needing several inputs at once).
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+/// `csv` as a multi-instrument file: each record under one of `symbols`, in turn.
+static std::string tag_symbols(const std::string& csv, const std::vector<std::string>& symbols) {
+    std::string tagged = "symbol,timestamp,event_type,order_id,side,price,quantity\n";
+    size_t line_start = 0;
+    for (size_t n = 0; line_start < csv.size(); ++n) {
+        const size_t end = csv.find('\n', line_start);
+        tagged += symbols[n % symbols.size()] + "," +
+                  csv.substr(line_start, end - line_start + 1);
+        line_start = end + 1;
+    }
+    return tagged;
+}
+
+static void expect_same_replay(const ReplayStats& a, const ReplayStats& b) {
+    EXPECT_EQ(a.total_messages, b.total_messages);
+    EXPECT_EQ(a.orders_accepted, b.orders_accepted);
+    EXPECT_EQ(a.orders_cancelled, b.orders_cancelled);
+    EXPECT_EQ(a.cancel_failures, b.cancel_failures);
+    EXPECT_EQ(a.trades_generated, b.trades_generated);
+    EXPECT_EQ(a.final_order_count, b.final_order_count);
+    EXPECT_EQ(a.final_best_bid, b.final_best_bid);
+    EXPECT_EQ(a.final_best_ask, b.final_best_ask);
+    EXPECT_EQ(a.final_book_digest, b.final_book_digest);
+}
+
+TEST_F(ReplayEngineTest, ResetEngineReplaysLikeAFreshOne) {
+    auto config = make_config(make_seek_csv(3000));
+    const std::string second = "test_l3_second.csv";
+    write_file(second, make_seek_csv(1700));
+    const ReplayStats first_fresh = ReplayEngine(config).run();
+    ASSERT_GT(first_fresh.final_order_count, 0u);
+
+    // Orders resting from the first day must not leak into the second,
+    // nor their ids collide with its (both days reuse ids from 1)
+    ReplayEngine engine(config);
+    expect_same_replay(engine.run(), first_fresh);
+    ASSERT_TRUE(engine.reset());
+    engine.set_input(second);
+    const ReplayStats second_reused = engine.run();
+    config.input_path = second;
+    expect_same_replay(second_reused, ReplayEngine(config).run());
+
+    // And again, over a buffer the caller owns
+    std::ifstream in(temp_path_, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_TRUE(engine.reset());
+    engine.set_input(temp_path_, {}, bytes);
+    expect_same_replay(engine.run(), first_fresh);
+
+    config.enable_publisher = true;
+    ReplayEngine published(config);
+    EXPECT_FALSE(published.reset());
+    remove_temp_csv(second);
+}
+
+TEST_F(ReplayEngineTest, SymbolFilterReplaysOneInstrumentOfAMultiInstrumentFile) {
+    const std::string day = make_seek_csv(2000);
+    auto config = make_config(day);
+    const ReplayStats whole = ReplayEngine(config).run();
+
+    const std::string multi = "test_l3_multi.csv";
+    write_file(multi, tag_symbols(day, {"BTCUSDT", "ETHUSDT"}));
+    config.input_path = multi;
+    config.symbol = "ETHUSDT";
+    const ReplayStats eth = ReplayEngine(config).run();
+    EXPECT_EQ(eth.total_messages, 1000u);
+    EXPECT_EQ(eth.other_symbol_messages, 1000u);
+    EXPECT_EQ(eth.parse_errors, 0u);
+
+    config.symbol = "SOLUSDT";
+    const ReplayStats none = ReplayEngine(config).run();
+    EXPECT_TRUE(none.input_opened);
+    EXPECT_EQ(none.total_messages, 0u);
+    EXPECT_EQ(none.other_symbol_messages, 2000u);
+
+    // A file without a symbol column is replayed whole
+    config.input_path = temp_path_;
+    expect_same_replay(ReplayEngine(config).run(), whole);
+    remove_temp_csv(multi);
+}
+
+TEST_F(ReplayEngineTest, BatchReplayMatchesReplayingEachJobAlone) {
+    auto config = make_config(make_seek_csv(10));
+    config.digest_every = 100;
+    const std::vector<std::string> files = {"test_batch_day1.csv", "test_batch_day2.csv",
+                                            "test_batch_day3.csv"};
+    write_file(files[0], make_seek_csv(2500));
+    write_file(files[1], tag_symbols(make_seek_csv(3000), {"BTCUSDT", "ETHUSDT", "SOLUSDT"}));
+    write_file(files[2], make_seek_csv(900));
+
+    BatchReplayConfig batch;
+    batch.replay = config;
+    batch.workers = 2;
+    batch.output_path = "test_batch_report.json";
+    batch.jobs = {{"d1", files[0], ""},
+                  {"d2", files[1], "BTCUSDT"},
+                  {"d2", files[1], "ETHUSDT"},
+                  {"d2", files[1], "SOLUSDT"},
+                  {"d3", files[2], ""},
+                  {"d4", "test_batch_missing.csv", ""},
+                  {"d1", files[0], ""}};
+    const BatchReplayStats stats = BatchReplay(batch).run();
+
+    ASSERT_EQ(stats.jobs.size(), batch.jobs.size());
+    EXPECT_EQ(stats.workers, 2u);
+    EXPECT_EQ(stats.inputs_shared, 3u);
+    EXPECT_EQ(stats.jobs_failed, 1u);
+    EXPECT_FALSE(stats.jobs[5].ok);
+    EXPECT_FALSE(stats.jobs[5].error.empty());
+
+    uint64_t messages = 0;
+    for (size_t i = 0; i < batch.jobs.size(); ++i) {
+        if (i == 5) continue;
+        ASSERT_TRUE(stats.jobs[i].ok) << i;
+        config.input_path = batch.jobs[i].input_path;
+        config.symbol = batch.jobs[i].symbol;
+        const ReplayStats alone = ReplayEngine(config).run();
+        ASSERT_GT(alone.total_messages, 0u);
+        expect_same_replay(stats.jobs[i].stats, alone);
+        messages += alone.total_messages;
+    }
+    EXPECT_EQ(stats.total_messages, messages);
+
+    std::ifstream report(batch.output_path);
+    EXPECT_TRUE(report.is_open());
+    for (const auto& f : files) remove_temp_csv(f);
+    remove_temp_csv(batch.output_path);
+}
+
+TEST(BatchManifest, ParsesJobsAndNamesTheBadLine) {
+    const std::string path = "test_batch_manifest.txt";
+    write_file(path,
+               "# day      input            symbol\n"
+               "2024-01-02 day1.csv\n"
+               "\n"
+               "2024-01-03\tday2.csv.zst\tETHUSDT\n");
+    std::vector<BatchReplayJob> jobs;
+    std::string error;
+    ASSERT_TRUE(load_batch_manifest(path, jobs, error)) << error;
+    ASSERT_EQ(jobs.size(), 2u);
+    EXPECT_EQ(jobs[0].day, "2024-01-02");
+    EXPECT_EQ(jobs[0].input_path, "day1.csv");
+    EXPECT_TRUE(jobs[0].symbol.empty());
+    EXPECT_EQ(jobs[1].input_path, "day2.csv.zst");
+    EXPECT_EQ(jobs[1].symbol, "ETHUSDT");
+
+    write_file(path, "2024-01-02 day1.csv\n2024-01-03\n");
+    EXPECT_FALSE(load_batch_manifest(path, jobs, error));
+    EXPECT_EQ(error, path + ":2: expected <day> <input> [symbol]");
+    remove_temp_csv(path);
+    EXPECT_FALSE(load_batch_manifest(path, jobs, error));
+}
+
 // ===========================================================================
 // End-to-end: Replay the full sample CSV
 // ===========================================================================
@@ -945,3 +2003,171 @@ TEST(L3EndToEnd, ReplaySampleCSV) {
     EXPECT_LT(stats.elapsed_seconds, 5.0);
     EXPECT_GT(stats.messages_per_second, 10000.0);
 }
+
+TEST(L3EndToEnd, BinaryReplayMatchesCsvReplay) {
+    ReplayConfig config;
+    config.input_path = "data/btcusdt_l3_sample.csv";
+    for (const char* alt : {"../data/btcusdt_l3_sample.csv",
+                            "../../data/btcusdt_l3_sample.csv"}) {
+        if (std::ifstream(config.input_path).is_open()) break;
+        config.input_path = alt;
+    }
+    config.min_price = 41000LL * PRICE_SCALE;
+    config.max_price = 43000LL * PRICE_SCALE;
+    config.tick_size = PRICE_SCALE / 100;  // $0.01
+    config.max_orders = 100000;
+
+    const std::string binary_path = "test_l3_sample.l3b";
+    L3ConvertStats cs = convert_l3_csv_to_binary(config.input_path, binary_path);
+    ASSERT_TRUE(cs.ok);
+    EXPECT_LT(cs.binary_bytes, cs.csv_bytes);
+
+    ReplayStats from_csv = ReplayEngine(config).run();
+    config.input_path = binary_path;
+    ReplayStats from_binary = ReplayEngine(config).run();
+
+    EXPECT_EQ(from_binary.total_messages, from_csv.total_messages);
+    EXPECT_EQ(from_binary.add_messages, from_csv.add_messages);
+    EXPECT_EQ(from_binary.cancel_messages, from_csv.cancel_messages);
+    EXPECT_EQ(from_binary.trade_messages, from_csv.trade_messages);
+    EXPECT_EQ(from_binary.trades_generated, from_csv.trades_generated);
+    EXPECT_EQ(from_binary.orders_cancelled, from_csv.orders_cancelled);
+    EXPECT_EQ(from_binary.final_order_count, from_csv.final_order_count);
+    EXPECT_EQ(from_binary.final_best_bid, from_csv.final_best_bid);
+    EXPECT_EQ(from_binary.final_best_ask, from_csv.final_best_ask);
+
+    remove_temp_csv(binary_path);
+}
+
+TEST(L3EndToEnd, ParallelParseMatchesSequentialReplay) {
+    ReplayConfig config;
+    config.input_path = "data/btcusdt_l3_sample.csv";
+    for (const char* alt : {"../data/btcusdt_l3_sample.csv",
+                            "../../data/btcusdt_l3_sample.csv"}) {
+        if (std::ifstream(config.input_path).is_open()) break;
+        config.input_path = alt;
+    }
+    config.min_price = 41000LL * PRICE_SCALE;
+    config.max_price = 43000LL * PRICE_SCALE;
+    config.tick_size = PRICE_SCALE / 100;  // $0.01
+    config.max_orders = 100000;
+
+    ReplayStats sequential = ReplayEngine(config).run();
+    config.parse_threads = 3;
+    config.parse_chunk_bytes = 16 * 1024;  // Sample is ~220 KB
+    ReplayStats parallel = ReplayEngine(config).run();
+
+    EXPECT_GT(sequential.total_messages, 0u);
+    EXPECT_EQ(parallel.total_messages, sequential.total_messages);
+    EXPECT_EQ(parallel.parse_errors, sequential.parse_errors);
+    EXPECT_EQ(parallel.trades_generated, sequential.trades_generated);
+    EXPECT_EQ(parallel.orders_cancelled, sequential.orders_cancelled);
+    EXPECT_EQ(parallel.orders_modified, sequential.orders_modified);
+    EXPECT_EQ(parallel.final_order_count, sequential.final_order_count);
+    EXPECT_EQ(parallel.final_best_bid, sequential.final_best_bid);
+    EXPECT_EQ(parallel.final_best_ask, sequential.final_best_ask);
+}
+
+// ===========================================================================
+// Workloads (bench_workload inputs)
+// ===========================================================================
+
+TEST(WorkloadGenerator, SameSeedSameWorkload) {
+    WorkloadConfig config;
+    config.messages = 5000;
+    const Workload a = generate_workload(config);
+    const Workload b = generate_workload(config);
+    ASSERT_EQ(a.messages.size(), 5000u);
+    ASSERT_EQ(b.messages.size(), a.messages.size());
+    for (size_t i = 0; i < a.messages.size(); ++i) {
+        ASSERT_EQ(a.messages[i].type, b.messages[i].type);
+        ASSERT_EQ(a.messages[i].order.order_id, b.messages[i].order.order_id);
+        ASSERT_EQ(a.messages[i].order.price, b.messages[i].order.price);
+        ASSERT_EQ(a.messages[i].order.timestamp, b.messages[i].order.timestamp);
+    }
+
+    config.seed = 7;
+    const Workload c = generate_workload(config);
+    size_t differing = 0;
+    for (size_t i = 0; i < c.messages.size(); ++i) {
+        differing += c.messages[i].order.price != a.messages[i].order.price;
+    }
+    EXPECT_GT(differing, 0u);
+}
+
+TEST(WorkloadGenerator, FollowsConfiguredMixAndShape) {
+    WorkloadConfig config;
+    config.messages = 50'000;
+    config.cancel_to_add = 0.8;
+    config.modify_to_add = 0.2;
+    config.aggressive_fraction = 0.1;
+    config.arrival_rate = 100'000.0;   // 10 us mean gap
+    const Workload w = generate_workload(config);
+
+    EXPECT_EQ(w.adds + w.cancels + w.modifies, w.messages.size());
+    EXPECT_NEAR(static_cast<double>(w.cancels) / static_cast<double>(w.adds), 0.8, 0.05);
+    EXPECT_NEAR(static_cast<double>(w.modifies) / static_cast<double>(w.adds), 0.2, 0.03);
+
+    const Price tick = config.tick_size;
+    const Price limit = static_cast<Price>(config.max_distance_ticks + 1) * tick;
+    std::unordered_set<OrderId> added;
+    size_t aggressive = 0;
+    size_t at_touch = 0;
+    for (size_t i = 0; i < w.messages.size(); ++i) {
+        const OrderMessage& msg = w.messages[i];
+        if (i > 0) ASSERT_GE(msg.order.timestamp, w.messages[i - 1].order.timestamp);
+        if (msg.type != MessageType::Add) {
+            // Cancels and modifies only name orders added earlier
+            ASSERT_EQ(added.count(msg.order.order_id), 1u);
+            continue;
+        }
+        ASSERT_TRUE(added.insert(msg.order.order_id).second);
+        ASSERT_GE(msg.order.price, w.min_price);
+        ASSERT_LE(msg.order.price, w.max_price);
+        const bool buy = msg.order.side == Side::Buy;
+        if (msg.order.time_in_force == TimeInForce::IOC) {
+            ++aggressive;
+            EXPECT_TRUE(buy ? msg.order.price > config.mid : msg.order.price < config.mid);
+            continue;
+        }
+        const Price from_touch = buy ? config.mid - tick - msg.order.price
+                                     : msg.order.price - config.mid - tick;
+        ASSERT_GE(from_touch, 0);
+        ASSERT_LT(from_touch, limit);
+        at_touch += from_touch == 0;
+    }
+    EXPECT_NEAR(static_cast<double>(aggressive) / static_cast<double>(w.adds), 0.1, 0.02);
+    // P(distance 0) = 1 - 2^-alpha, about 0.65 at alpha 1.5
+    EXPECT_NEAR(static_cast<double>(at_touch) / static_cast<double>(w.adds - aggressive),
+                0.65, 0.03);
+    // Poisson at 100k/s: the whole session spans about 0.5 s of feed time
+    const double span = static_cast<double>(w.messages.back().order.timestamp -
+                                            w.messages.front().order.timestamp);
+    EXPECT_NEAR(span / 1e9, 0.5, 0.02);
+}
+
+TEST(WorkloadLoader, ReadsTraceRecords) {
+    auto path = write_temp_csv(
+        "timestamp,event_type,order_id,side,price,quantity\n"
+        "1704067200000000000,ADD,1,BUY,42150.50,10\n"
+        "1704067200000100000,ADD,2,SELL,42151.00,4\n"
+        "1704067200000200000,MODIFY,1,BUY,42150.00,8\n"
+        "1704067200000300000,TRADE,,BUY,42151.00,4\n"
+        "1704067200000400000,CANCEL,2,,,\n");
+    Workload w;
+    std::string error;
+    ASSERT_TRUE(load_workload(path, w, error)) << error;
+    remove_temp_csv(path);
+
+    ASSERT_EQ(w.messages.size(), 4u);
+    EXPECT_EQ(w.adds, 2u);
+    EXPECT_EQ(w.modifies, 1u);
+    EXPECT_EQ(w.cancels, 1u);
+    EXPECT_EQ(w.messages[2].type, MessageType::Modify);
+    EXPECT_EQ(w.messages[3].type, MessageType::Cancel);
+    EXPECT_EQ(w.min_price, 4215000LL * (PRICE_SCALE / 100));
+    EXPECT_EQ(w.max_price, 4215100LL * (PRICE_SCALE / 100));
+
+    EXPECT_FALSE(load_workload("does_not_exist.csv", w, error));
+    EXPECT_FALSE(error.empty());
+}
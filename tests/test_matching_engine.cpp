@@ -3,12 +3,14 @@
 #include <cstdlib>
 #include <new>
 #include <type_traits>
+#include <vector>
 
 #include "core/order.h"
 #include "core/trade.h"
 #include "core/types.h"
 #include "matching/match_result.h"
 #include "matching/matching_engine.h"
+#include "orderbook/expiry_wheel.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
 
@@ -532,6 +534,39 @@ TEST_F(MatchingEngineTest, TradeFieldsCorrect) {
     EXPECT_GT(t.trade_id, 0u);
 }
 
+TEST_F(MatchingEngineTest, TradeCarriesAggressorAndRestingState) {
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID, 100, 7));
+    rest_order(alloc_order(2, Side::Buy, OrderType::Limit, MID, 50, 8));
+    rest_order(alloc_order(3, Side::Buy, OrderType::Limit, MID - TICK, 50, 70000));
+
+    auto result = engine_->submit_order(
+        alloc_order(10, Side::Sell, OrderType::Limit, MID - TICK, 170, 2));
+    ASSERT_EQ(result.trade_count, 3u);
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_TRUE(result.trades[i].has_aggressor());
+        EXPECT_EQ(result.trades[i].aggressor_side, Side::Sell);
+        EXPECT_EQ(result.trades[i].aggressor_order_id(), 10u);
+    }
+
+    // Order 1 fully filled, its level still holds order 2
+    const Trade& first = result.trades[0];
+    EXPECT_EQ(first.resting_order_id(), 1u);
+    EXPECT_EQ(first.resting_participant_id, 7u);
+    EXPECT_TRUE(first.resting_filled());
+    EXPECT_FALSE(first.level_exhausted());
+
+    // Order 2 empties the MID level
+    EXPECT_EQ(result.trades[1].resting_participant_id, 8u);
+    EXPECT_TRUE(result.trades[1].level_exhausted());
+
+    // Order 3 is left partially filled; its id does not fit in 16 bits
+    const Trade& last = result.trades[2];
+    EXPECT_EQ(last.quantity, 20u);
+    EXPECT_EQ(last.resting_participant_id, TRADE_PARTICIPANT_UNKNOWN);
+    EXPECT_FALSE(last.resting_filled());
+    EXPECT_FALSE(last.level_exhausted());
+}
+
 TEST_F(MatchingEngineTest, TradeIdsMonotonic) {
     rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
     rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 100));
@@ -595,6 +630,40 @@ TEST_F(MatchingEngineTest, CancelNonexistentOrder) {
     EXPECT_FALSE(cancelled);
 }
 
+TEST_F(MatchingEngineTest, MassCancelRemovesOnlyThatParticipant) {
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID - TICK, 100, 5));
+    rest_order(alloc_order(2, Side::Buy, OrderType::Limit, MID - TICK, 40, 6));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID + TICK, 30, 5));
+    rest_order(alloc_order(4, Side::Buy, OrderType::Limit, MID - 2 * TICK, 20, 5));
+    size_t pooled = pool_->size();
+
+    MassCancelResult r = engine_->mass_cancel(5);
+    EXPECT_EQ(r.cancelled_count, 3u);
+    EXPECT_EQ(r.cancelled_quantity, 150u);
+    EXPECT_EQ(pool_->size(), pooled - 3);
+    EXPECT_EQ(book_->order_count(), 1u);
+    EXPECT_NE(book_->find_order(2), nullptr);
+    EXPECT_EQ(book_->best_bid()->price, MID - TICK);
+    EXPECT_EQ(book_->best_ask(), nullptr);
+
+    r = engine_->mass_cancel(5);
+    EXPECT_EQ(r.cancelled_count, 0u);
+}
+
+TEST_F(MatchingEngineTest, MassCancelOneSideCountsLeavesQuantity) {
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID - TICK, 100, 5));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID + TICK, 30, 5));
+    Order* buy = alloc_order(3, Side::Buy, OrderType::Limit, MID + TICK, 10, 6);
+    ASSERT_EQ(engine_->submit_order(buy).trade_count, 1u);
+
+    MassCancelResult r = engine_->mass_cancel(5, Side::Sell);
+    EXPECT_EQ(r.cancelled_count, 1u);
+    EXPECT_EQ(r.cancelled_quantity, 20u);  // Leaves quantity only
+    EXPECT_EQ(book_->best_ask(), nullptr);
+    EXPECT_NE(book_->find_order(1), nullptr);
+    EXPECT_EQ(book_->participants().count(5), 1u);
+}
+
 TEST_F(MatchingEngineTest, InvalidPriceRejected) {
     // Price not tick-aligned
     Order* buy = alloc_order(1, Side::Buy, OrderType::Limit,
@@ -713,6 +782,37 @@ TEST_F(MatchingEngineTest, ModifyLosesTimePriority) {
     EXPECT_EQ(buy_result.trades[0].sell_order_id, 2u);
 }
 
+TEST_F(MatchingEngineTest, ModifySizeDownKeepsTimePriority) {
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 100));
+
+    auto result = engine_->modify_order(1, MID, 60, 1000);
+    EXPECT_EQ(result.status, MatchStatus::Modified);
+    EXPECT_EQ(result.remaining_quantity, 60u);
+    EXPECT_EQ(book_->best_ask()->total_quantity, 160u);
+
+    // Order 1 is still first in the queue
+    auto buy_result = engine_->submit_order(
+        alloc_order(10, Side::Buy, OrderType::Limit, MID, 60));
+    EXPECT_EQ(buy_result.status, MatchStatus::Filled);
+    ASSERT_EQ(buy_result.trade_count, 1u);
+    EXPECT_EQ(buy_result.trades[0].sell_order_id, 1u);
+}
+
+TEST_F(MatchingEngineTest, ModifyIcebergSizeDownKeepsSlice) {
+    rest_order(alloc_iceberg(1, Side::Sell, MID, 100, 20));
+
+    auto result = engine_->modify_order(1, MID, 50, 1000);
+    EXPECT_EQ(result.status, MatchStatus::Modified);
+    auto* o = book_->find_order(1);
+    ASSERT_NE(o, nullptr);
+    EXPECT_EQ(o->visible_quantity, 20u);
+
+    (void)engine_->modify_order(1, MID, 10, 1001);
+    EXPECT_EQ(o->visible_quantity, 10u);
+    EXPECT_EQ(book_->best_ask()->total_quantity, 10u);
+}
+
 TEST_F(MatchingEngineTest, ModifyNonExistent) {
     auto result = engine_->modify_order(999, MID, 100, 1000);
     EXPECT_EQ(result.status, MatchStatus::Rejected);
@@ -961,6 +1061,567 @@ TEST_F(MatchingEngineTest, ZeroHeapAllocOnMatchPath) {
               MAX_TRADES_PER_MATCH * sizeof(Trade));
 }
 
+// ---------------------------------------------------------------------------
+// Streaming trade sink
+// ---------------------------------------------------------------------------
+
+struct CollectingSink {
+    Trade trades[256];
+    uint32_t count = 0;
+
+    void operator()(const Trade& trade) noexcept { trades[count++] = trade; }
+};
+
+TEST_F(MatchingEngineTest, StreamingSubmitIsNotCappedAt64Trades) {
+    constexpr OrderId N = 100;
+    for (OrderId i = 1; i <= N; ++i) {
+        rest_order(alloc_order(i, Side::Sell, OrderType::Limit,
+                               MID + static_cast<Price>(i) * TICK, 10));
+    }
+
+    CollectingSink collected;
+    Order* buy = alloc_order(1000, Side::Buy, OrderType::Limit,
+                             MID + static_cast<Price>(N) * TICK, N * 10, 2);
+    MatchSummary summary =
+        engine_->submit_order(buy, make_trade_sink(collected));
+
+    EXPECT_EQ(summary.status, MatchStatus::Filled);
+    EXPECT_EQ(summary.trade_count, N);
+    EXPECT_EQ(summary.filled_quantity, N * 10);
+    EXPECT_EQ(summary.remaining_quantity, 0u);
+    ASSERT_EQ(collected.count, N);
+    for (uint32_t i = 0; i < N; ++i) {
+        EXPECT_EQ(collected.trades[i].sell_order_id, i + 1);
+        EXPECT_EQ(collected.trades[i].buy_order_id, 1000u);
+        EXPECT_EQ(collected.trades[i].price,
+                  MID + static_cast<Price>(i + 1) * TICK);
+    }
+    EXPECT_EQ(book_->order_count(), 0u);
+}
+
+TEST_F(MatchingEngineTest, LegacySubmitStopsAt64Trades) {
+    constexpr OrderId N = 100;
+    for (OrderId i = 1; i <= N; ++i) {
+        rest_order(alloc_order(i, Side::Sell, OrderType::Limit,
+                               MID + static_cast<Price>(i) * TICK, 10));
+    }
+
+    Order* buy = alloc_order(1000, Side::Buy, OrderType::Limit,
+                             MID + static_cast<Price>(N) * TICK, N * 10, 2);
+    MatchResult result = engine_->submit_order(buy);
+
+    EXPECT_EQ(result.status, MatchStatus::PartialFill);
+    EXPECT_EQ(result.trade_count, MAX_TRADES_PER_MATCH);
+    EXPECT_EQ(result.filled_quantity, MAX_TRADES_PER_MATCH * 10);
+    EXPECT_EQ(result.trades[63].sell_order_id, 64u);
+}
+
+TEST_F(MatchingEngineTest, StreamingModifyEmitsTrades) {
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID + TICK, 50));
+    rest_order(alloc_order(2, Side::Buy, OrderType::Limit, MID, 50, 2));
+
+    CollectingSink collected;
+    MatchSummary summary = engine_->modify_order(
+        2, MID + TICK, 50, 10, make_trade_sink(collected));
+
+    EXPECT_EQ(summary.status, MatchStatus::Filled);
+    EXPECT_EQ(summary.trade_count, 1u);
+    ASSERT_EQ(collected.count, 1u);
+    EXPECT_EQ(collected.trades[0].buy_order_id, 2u);
+    EXPECT_EQ(collected.trades[0].quantity, 50u);
+}
+
+TEST_F(MatchingEngineTest, ProcessBatchMatchesSequentialSubmits) {
+    constexpr size_t N = 12;
+    Order* orders[N];
+    for (size_t i = 0; i < N; ++i) {
+        // Alternate sides around MID so later orders cross earlier ones
+        Side side = (i % 2 == 0) ? Side::Sell : Side::Buy;
+        Price price = MID + static_cast<Price>(i % 3) * TICK;
+        orders[i] = alloc_order(i + 1, side, OrderType::Limit, price, 10,
+                                static_cast<ParticipantId>(i + 1));
+    }
+
+    CollectingSink collected;
+    MatchSummary results[N];
+    engine_->process_batch(orders, N, results, make_trade_sink(collected));
+
+    uint32_t trades = 0;
+    for (size_t i = 0; i < N; ++i) trades += results[i].trade_count;
+    EXPECT_EQ(collected.count, trades);
+    EXPECT_EQ(results[0].status, MatchStatus::Resting);
+    EXPECT_EQ(results[1].status, MatchStatus::Filled);  // buy MID+TICK hits sell MID
+    EXPECT_EQ(collected.trades[0].sell_order_id, 1u);
+    EXPECT_EQ(collected.trades[0].buy_order_id, 2u);
+    EXPECT_EQ(book_->order_count() * 10 + trades * 20, N * 10);
+}
+
+// ---------------------------------------------------------------------------
+// Compile-time policies
+// ---------------------------------------------------------------------------
+
+TEST_F(MatchingEngineTest, FrontRejectsDisabledOrderTypes) {
+    MatchingFeatures lean;
+    lean.icebergs = false;
+    lean.fok = false;
+    MatchingEngine engine(*book_, *pool_, SelfTradePreventionMode::None, lean);
+    EXPECT_FALSE(engine.features().icebergs);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
+
+    auto iceberg = engine.submit_order(
+        alloc_iceberg(2, Side::Buy, MID, 50, 10, 2));
+    EXPECT_EQ(iceberg.status, MatchStatus::Rejected);
+    EXPECT_EQ(iceberg.trade_count, 0u);
+
+    auto fok = engine.submit_order(
+        alloc_order(3, Side::Buy, OrderType::FOK, MID, 50, 2));
+    EXPECT_EQ(fok.status, MatchStatus::Rejected);
+
+    auto ioc = engine.submit_order(
+        alloc_order(4, Side::Buy, OrderType::IOC, MID, 50, 2));
+    EXPECT_EQ(ioc.status, MatchStatus::Filled);
+    EXPECT_EQ(book_->best_ask()->total_quantity, 50u);
+    EXPECT_EQ(pool_->size(), 1u);  // Only the resting sell is live
+}
+
+TEST_F(MatchingEngineTest, LeanPolicyMatchesLikeGeneralEngine) {
+    using Lean = BasicMatchingEngine<
+        MatchingPolicy<SelfTradePreventionMode::None, false, false>>;
+    Lean engine(*book_, *pool_);
+    static_assert(Lean::stp_mode() == SelfTradePreventionMode::None);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 30));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID + TICK, 30));
+
+    // Same participant on both sides: no STP in this policy, so it trades
+    auto result = engine.submit_order(
+        alloc_order(3, Side::Buy, OrderType::Limit, MID + TICK, 50));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 2u);
+    EXPECT_EQ(result.trades[0].quantity, 30u);
+    EXPECT_EQ(result.trades[1].quantity, 20u);
+    EXPECT_EQ(engine.total_trade_count(), 2u);
+    EXPECT_EQ(book_->best_ask()->total_quantity, 10u);
+}
+
+TEST_F(MatchingEngineTest, CompileTimeCancelOldestPolicy) {
+    BasicMatchingEngine<
+        MatchingPolicy<SelfTradePreventionMode::CancelOldest, true, true>>
+        engine(*book_, *pool_);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 10, 7));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 10, 8));
+
+    auto result = engine.submit_order(
+        alloc_order(3, Side::Buy, OrderType::Limit, MID, 10, 7));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 1u);
+    EXPECT_EQ(result.trades[0].sell_order_id, 2u);  // Own order 1 cancelled
+    EXPECT_EQ(book_->find_order(1), nullptr);
+    EXPECT_TRUE(book_->empty());
+}
+
+// ---------------------------------------------------------------------------
+// Call auction
+// ---------------------------------------------------------------------------
+
+TEST_F(MatchingEngineTest, AuctionUncrossesAtMaxVolumePrice) {
+    CollectingSink collected;
+    TradeSink sink = make_trade_sink(collected);
+    engine_->begin_auction();
+    EXPECT_TRUE(engine_->in_auction());
+
+    // Crossed book: nothing trades while the auction accumulates
+    const Price P = MID;
+    Order* orders[] = {
+        alloc_order(1, Side::Buy, OrderType::Limit, P + 2 * TICK, 100),
+        alloc_order(2, Side::Buy, OrderType::Limit, P + TICK, 200),
+        alloc_order(3, Side::Buy, OrderType::Limit, P, 100),
+        alloc_order(4, Side::Sell, OrderType::Limit, P - TICK, 150),
+        alloc_order(5, Side::Sell, OrderType::Limit, P + TICK, 150),
+        alloc_order(6, Side::Sell, OrderType::Limit, P + 2 * TICK, 200),
+    };
+    for (Order* o : orders) {
+        EXPECT_EQ(engine_->submit_order(o, sink).status, MatchStatus::Resting);
+    }
+    EXPECT_EQ(collected.count, 0u);
+    EXPECT_EQ(book_->order_count(), 6u);
+
+    AuctionQuote quote = engine_->indicative_uncross();
+    EXPECT_EQ(quote.price, P + TICK);
+    EXPECT_EQ(quote.volume, 300u);
+    EXPECT_EQ(quote.buy_surplus, 0u);
+    EXPECT_EQ(quote.sell_surplus, 0u);
+
+    AuctionResult result = engine_->uncross(99, sink);
+    EXPECT_FALSE(engine_->in_auction());
+    EXPECT_EQ(result.quote.price, P + TICK);
+    EXPECT_EQ(result.quote.volume, 300u);
+    ASSERT_EQ(result.trade_count, 3u);
+    ASSERT_EQ(collected.count, 3u);
+
+    // Price-time order on both sides, all at the single cross price
+    const OrderId expect[3][2] = {{1, 4}, {2, 4}, {2, 5}};
+    const Quantity qty[3] = {100, 50, 150};
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(collected.trades[i].buy_order_id, expect[i][0]);
+        EXPECT_EQ(collected.trades[i].sell_order_id, expect[i][1]);
+        EXPECT_EQ(collected.trades[i].quantity, qty[i]);
+        EXPECT_EQ(collected.trades[i].price, P + TICK);
+        EXPECT_EQ(collected.trades[i].timestamp, 99u);
+        EXPECT_FALSE(collected.trades[i].has_aggressor());  // Both sides rested
+        EXPECT_TRUE(collected.trades[i].level_exhausted());
+    }
+
+    // Residual book is uncrossed
+    EXPECT_EQ(book_->order_count(), 2u);
+    EXPECT_EQ(book_->best_bid()->price, P);
+    EXPECT_EQ(book_->best_ask()->price, P + 2 * TICK);
+    EXPECT_EQ(engine_->indicative_uncross().volume, 0u);
+
+    // Continuous matching resumes
+    auto taker = engine_->submit_order(
+        alloc_order(7, Side::Sell, OrderType::IOC, P, 40), sink);
+    EXPECT_EQ(taker.status, MatchStatus::Filled);
+}
+
+TEST_F(MatchingEngineTest, AuctionRejectsImmediateOrdersAndReRestsModifies) {
+    engine_->begin_auction();
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
+
+    EXPECT_EQ(engine_->submit_order(
+                  alloc_order(2, Side::Buy, OrderType::IOC, MID, 10)).status,
+              MatchStatus::Rejected);
+    EXPECT_EQ(engine_->submit_order(
+                  alloc_order(3, Side::Buy, OrderType::Market, 0, 10)).status,
+              MatchStatus::Rejected);
+    EXPECT_EQ(engine_->submit_order(
+                  alloc_order(4, Side::Buy, OrderType::FOK, MID, 10)).status,
+              MatchStatus::Rejected);
+
+    auto rest = engine_->submit_order(
+        alloc_order(5, Side::Buy, OrderType::Limit, MID - TICK, 10));
+    EXPECT_EQ(rest.status, MatchStatus::Resting);
+
+    // Modify across the ask: re-rests, no trade
+    auto mod = engine_->modify_order(5, MID + TICK, 10, 50);
+    EXPECT_EQ(mod.status, MatchStatus::Modified);
+    EXPECT_EQ(mod.trade_count, 0u);
+    EXPECT_EQ(book_->order_count(), 2u);
+    EXPECT_EQ(pool_->size(), 2u);
+}
+
+TEST_F(MatchingEngineTest, AuctionTieBreaksOnReferencePrice) {
+    engine_->begin_auction();
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID + TICK, 100));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 100));
+
+    // MID and MID+TICK both execute 100 with no surplus
+    EXPECT_EQ(engine_->indicative_uncross().price, MID);
+    EXPECT_EQ(engine_->indicative_uncross(MID + 5 * TICK).price, MID + TICK);
+
+    CollectingSink collected;
+    auto result = engine_->uncross(1, make_trade_sink(collected), MID + TICK);
+    EXPECT_EQ(result.quote.price, MID + TICK);
+    EXPECT_EQ(result.trade_count, 1u);
+    EXPECT_TRUE(book_->empty());
+}
+
+TEST_F(MatchingEngineTest, UncrossOnUncrossedBookIsNoop) {
+    engine_->begin_auction();
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID - TICK, 100));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 100));
+
+    CollectingSink collected;
+    auto result = engine_->uncross(1, make_trade_sink(collected));
+    EXPECT_EQ(result.quote.volume, 0u);
+    EXPECT_EQ(result.trade_count, 0u);
+    EXPECT_FALSE(engine_->in_auction());
+    EXPECT_EQ(book_->order_count(), 2u);
+}
+
+// ---------------------------------------------------------------------------
+// Pro-rata allocation
+// ---------------------------------------------------------------------------
+
+TEST_F(MatchingEngineTest, ProRataSharesLevelBySize) {
+    MatchingFeatures features;
+    features.allocation = AllocationMode::ProRata;
+    MatchingEngine engine(*book_, *pool_, SelfTradePreventionMode::None,
+                          features);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 200));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID, 700));
+
+    auto result = engine.submit_order(
+        alloc_order(4, Side::Buy, OrderType::Limit, MID, 100));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 3u);
+    EXPECT_EQ(result.trades[0].quantity, 10u);
+    EXPECT_EQ(result.trades[1].quantity, 20u);
+    EXPECT_EQ(result.trades[2].quantity, 70u);
+    EXPECT_EQ(book_->find_order(3)->remaining_quantity(), 630u);
+}
+
+TEST_F(MatchingEngineTest, ProRataRoundingResidualGoesFifo) {
+    MatchingFeatures features;
+    features.allocation = AllocationMode::ProRata;
+    MatchingEngine engine(*book_, *pool_, SelfTradePreventionMode::None,
+                          features);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 3));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 3));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID, 3));
+
+    // floor(4 * 3 / 9) = 1 each; the fourth lot goes to the oldest order
+    auto result = engine.submit_order(
+        alloc_order(4, Side::Buy, OrderType::IOC, MID, 4));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 4u);
+    EXPECT_EQ(result.trades[3].sell_order_id, 1u);
+    EXPECT_EQ(book_->find_order(1)->remaining_quantity(), 1u);
+    EXPECT_EQ(book_->find_order(2)->remaining_quantity(), 2u);
+    EXPECT_EQ(book_->find_order(3)->remaining_quantity(), 2u);
+}
+
+TEST_F(MatchingEngineTest, PriceTimeProRataFillsFrontFirst) {
+    MatchingFeatures features;
+    features.allocation = AllocationMode::PriceTimeProRata;
+    MatchingEngine engine(*book_, *pool_, SelfTradePreventionMode::None,
+                          features);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 100));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 300));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID, 600));
+
+    // Order 1 takes 100 first, then 300 is shared 1:2 between 2 and 3
+    auto result = engine.submit_order(
+        alloc_order(4, Side::Buy, OrderType::Limit, MID, 400));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 3u);
+    EXPECT_EQ(result.trades[0].sell_order_id, 1u);
+    EXPECT_EQ(result.trades[0].quantity, 100u);
+    EXPECT_EQ(result.trades[1].quantity, 100u);
+    EXPECT_EQ(result.trades[2].quantity, 200u);
+    EXPECT_EQ(book_->find_order(1), nullptr);
+}
+
+TEST_F(MatchingEngineTest, ProRataSweepsWholeLevelsInTimeOrder) {
+    MatchingFeatures features;
+    features.allocation = AllocationMode::ProRata;
+    MatchingEngine engine(*book_, *pool_, SelfTradePreventionMode::None,
+                          features);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 10));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID, 30));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID + TICK, 20));
+    rest_order(alloc_order(4, Side::Sell, OrderType::Limit, MID + TICK, 20));
+
+    // Takes all of MID, then 10 of 40 at MID + TICK: 5 each
+    auto result = engine.submit_order(
+        alloc_order(5, Side::Buy, OrderType::Limit, MID + TICK, 50));
+    EXPECT_EQ(result.status, MatchStatus::Filled);
+    ASSERT_EQ(result.trade_count, 4u);
+    EXPECT_EQ(result.trades[0].quantity, 10u);
+    EXPECT_EQ(result.trades[1].quantity, 30u);
+    EXPECT_EQ(result.trades[2].quantity, 5u);
+    EXPECT_EQ(result.trades[3].quantity, 5u);
+    EXPECT_EQ(book_->best_ask()->total_quantity, 30u);
+}
+
+// ---------------------------------------------------------------------------
+// Stop orders
+// ---------------------------------------------------------------------------
+
+TEST_F(MatchingEngineTest, StopRejectedWithoutStopBook) {
+    Order* stop = alloc_order(1, Side::Buy, OrderType::Stop, 0, 10);
+    stop->stop_price = MID;
+    auto result = engine_->submit_order(stop);
+    EXPECT_EQ(result.status, MatchStatus::Rejected);
+}
+
+TEST_F(MatchingEngineTest, StopsElectAndCascadeInOrder) {
+    StopBook stops(*book_, POOL_SIZE);
+    engine_->attach_stop_book(&stops);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 10, 2));
+    rest_order(alloc_order(2, Side::Sell, OrderType::Limit, MID + TICK, 10, 2));
+    rest_order(alloc_order(3, Side::Sell, OrderType::Limit, MID + 2 * TICK, 10, 2));
+
+    // Buy stop at MID fires on the first trade and lifts MID + TICK, which
+    // in turn elects the stop-limit at MID + TICK.
+    Order* stop = alloc_order(10, Side::Buy, OrderType::Stop, 0, 10);
+    stop->stop_price = MID;
+    EXPECT_EQ(engine_->submit_order(stop).status, MatchStatus::Resting);
+    Order* stop_limit = alloc_order(11, Side::Buy, OrderType::StopLimit,
+                                    MID + 2 * TICK, 5);
+    stop_limit->stop_price = MID + TICK;
+    EXPECT_EQ(engine_->submit_order(stop_limit).status, MatchStatus::Resting);
+    Order* far = alloc_order(12, Side::Buy, OrderType::Stop, 0, 5);
+    far->stop_price = MID + 3 * TICK;
+    EXPECT_EQ(engine_->submit_order(far).status, MatchStatus::Resting);
+    EXPECT_EQ(stops.size(), 3u);
+
+    CollectingSink collected;
+    auto summary = engine_->submit_order(
+        alloc_order(20, Side::Buy, OrderType::Limit, MID, 10),
+        make_trade_sink(collected));
+    EXPECT_EQ(summary.status, MatchStatus::Filled);
+    EXPECT_EQ(summary.trade_count, 1u);
+
+    ASSERT_EQ(collected.count, 3u);
+    EXPECT_EQ(collected.trades[0].buy_order_id, 20u);
+    EXPECT_EQ(collected.trades[1].buy_order_id, 10u);  // Stop as Market
+    EXPECT_EQ(collected.trades[1].price, MID + TICK);
+    EXPECT_EQ(collected.trades[2].buy_order_id, 11u);  // Cascaded stop-limit
+    EXPECT_EQ(collected.trades[2].price, MID + 2 * TICK);
+    EXPECT_EQ(collected.trades[2].quantity, 5u);
+
+    EXPECT_EQ(engine_->last_trade_price(), MID + 2 * TICK);
+    EXPECT_EQ(stops.size(), 1u);  // Only the far stop still waits
+    EXPECT_TRUE(engine_->cancel_order(12));
+    EXPECT_EQ(stops.size(), 0u);
+}
+
+TEST_F(MatchingEngineTest, StopAlreadyThroughTriggerElectsOnEntry) {
+    StopBook stops(*book_, POOL_SIZE);
+    engine_->attach_stop_book(&stops);
+
+    rest_order(alloc_order(1, Side::Buy, OrderType::Limit, MID, 20, 2));
+    (void)engine_->submit_order(
+        alloc_order(2, Side::Sell, OrderType::Limit, MID, 10));
+    ASSERT_EQ(engine_->last_trade_price(), MID);
+
+    // Sell stop above the last trade: elected at once, released as Market
+    Order* stop = alloc_order(3, Side::Sell, OrderType::Stop, 0, 10);
+    stop->stop_price = MID + TICK;
+    CollectingSink collected;
+    auto summary = engine_->submit_order(stop, make_trade_sink(collected));
+    EXPECT_EQ(summary.status, MatchStatus::Resting);
+    ASSERT_EQ(collected.count, 1u);
+    EXPECT_EQ(collected.trades[0].sell_order_id, 3u);
+    EXPECT_TRUE(book_->empty());
+}
+
+TEST_F(MatchingEngineTest, LegacySubmitLeavesStopsForRelease) {
+    StopBook stops(*book_, POOL_SIZE);
+    engine_->attach_stop_book(&stops);
+
+    rest_order(alloc_order(1, Side::Sell, OrderType::Limit, MID, 20, 2));
+    Order* stop = alloc_order(2, Side::Buy, OrderType::Stop, 0, 10);
+    stop->stop_price = MID;
+    (void)engine_->submit_order(stop);
+
+    auto result = engine_->submit_order(
+        alloc_order(3, Side::Buy, OrderType::Limit, MID, 10));
+    EXPECT_EQ(result.trade_count, 1u);
+    EXPECT_EQ(stops.elected_count(), 1u);
+
+    CollectingSink collected;
+    EXPECT_EQ(engine_->release_stops(make_trade_sink(collected)), 1u);
+    ASSERT_EQ(collected.count, 1u);
+    EXPECT_EQ(collected.trades[0].buy_order_id, 2u);
+    EXPECT_TRUE(book_->empty());
+}
+
+// ---------------------------------------------------------------------------
+// DAY / GTD expiry
+// ---------------------------------------------------------------------------
+
+struct ExpiredOrders {
+    std::vector<OrderId> ids;
+
+    OrderSink sink() noexcept {
+        return OrderSink{[](void* ctx, const Order& order) noexcept {
+                             EXPECT_EQ(order.status, OrderStatus::Expired);
+                             static_cast<ExpiredOrders*>(ctx)->ids.push_back(
+                                 order.order_id);
+                         },
+                         this};
+    }
+};
+
+TEST_F(MatchingEngineTest, TimedOrdersWithoutWheel) {
+    Order* gtd = alloc_order(1, Side::Buy, OrderType::Limit, MID, 10);
+    gtd->time_in_force = TimeInForce::GTD;
+    gtd->expire_time = 1'000;
+    EXPECT_EQ(engine_->submit_order(gtd).status, MatchStatus::Rejected);
+
+    Order* day = alloc_order(2, Side::Buy, OrderType::Limit, MID, 10);
+    day->time_in_force = TimeInForce::DAY;
+    day->expire_time = 0;
+    EXPECT_EQ(engine_->submit_order(day).status, MatchStatus::Resting);
+
+    ExpiredOrders expired;
+    EXPECT_EQ(engine_->expire_orders(UINT64_MAX, expired.sink()), 0u);
+    EXPECT_EQ(book_->order_count(), 1u);
+}
+
+TEST_F(MatchingEngineTest, GtdOrderExpiresAtItsTime) {
+    ExpiryWheel wheel(64, 1);
+    engine_->attach_expiry_wheel(&wheel);
+
+    Order* resting = alloc_order(1, Side::Buy, OrderType::Limit, MID - TICK, 10);
+    resting->time_in_force = TimeInForce::GTD;
+    resting->expire_time = 1'000;
+    ASSERT_EQ(engine_->submit_order(resting).status, MatchStatus::Resting);
+
+    // Filled before its expiry: the timer goes stale and is skipped
+    Order* filled = alloc_order(2, Side::Sell, OrderType::Limit, MID, 10, 2);
+    filled->time_in_force = TimeInForce::GTD;
+    filled->expire_time = 500;
+    ASSERT_EQ(engine_->submit_order(filled).status, MatchStatus::Resting);
+    ASSERT_EQ(engine_->submit_order(
+                  alloc_order(3, Side::Buy, OrderType::Limit, MID, 10, 3))
+                  .status,
+              MatchStatus::Filled);
+
+    ExpiredOrders expired;
+    EXPECT_EQ(engine_->expire_orders(999, expired.sink()), 0u);
+    EXPECT_EQ(engine_->expire_orders(1'000, expired.sink()), 1u);
+    EXPECT_EQ(expired.ids, (std::vector<OrderId>{1}));
+    EXPECT_TRUE(book_->empty());
+    EXPECT_EQ(wheel.size(), 0u);
+
+    // Expiry already behind the clock: rejected without trading
+    Order* late = alloc_order(4, Side::Buy, OrderType::Limit, MID, 10);
+    late->time_in_force = TimeInForce::GTD;
+    late->expire_time = 1'000;
+    EXPECT_EQ(engine_->submit_order(late).status, MatchStatus::Rejected);
+}
+
+TEST_F(MatchingEngineTest, DayOrdersAndStopsExpireAtSessionClose) {
+    ExpiryWheel wheel(64, 100);
+    wheel.set_session_close(10'000);
+    engine_->attach_expiry_wheel(&wheel);
+    StopBook stops(*book_, POOL_SIZE);
+    engine_->attach_stop_book(&stops);
+
+    Order* day = alloc_order(1, Side::Sell, OrderType::Limit, MID + TICK, 10);
+    day->time_in_force = TimeInForce::DAY;
+    day->expire_time = 0;
+    ASSERT_EQ(engine_->submit_order(day).status, MatchStatus::Resting);
+
+    Order* stop = alloc_order(2, Side::Buy, OrderType::Stop, 0, 10);
+    stop->stop_price = MID + 5 * TICK;
+    stop->time_in_force = TimeInForce::DAY;
+    stop->expire_time = 0;
+    ASSERT_EQ(engine_->submit_order(stop).status, MatchStatus::Resting);
+
+    Order* gtc = alloc_order(3, Side::Buy, OrderType::Limit, MID - TICK, 10);
+    ASSERT_EQ(engine_->submit_order(gtc).status, MatchStatus::Resting);
+
+    ExpiredOrders expired;
+    EXPECT_EQ(engine_->expire_orders(9'999, expired.sink()), 0u);
+    EXPECT_EQ(engine_->expire_orders(10'000, expired.sink()), 2u);
+    EXPECT_EQ(expired.ids, (std::vector<OrderId>{1, 2}));
+    EXPECT_EQ(stops.size(), 0u);
+    EXPECT_EQ(book_->order_count(), 1u);
+    EXPECT_NE(book_->find_order(3), nullptr);
+}
+
 // ---------------------------------------------------------------------------
 // available_quantity helper
 // ---------------------------------------------------------------------------
@@ -979,5 +1640,159 @@ TEST_F(MatchingEngineTest, AvailableQuantityAccurate) {
     EXPECT_EQ(avail, 100u);
 }
 
+// ---------------------------------------------------------------------------
+// Windowed ladder
+// ---------------------------------------------------------------------------
+
+TEST(WindowedMatchingTest, SweepAcrossWindowAndOverflow) {
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBookOptions opts;
+    opts.window_levels = 64;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE, opts);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    auto make = [&pool](OrderId id, Side side, OrderType type, Price px,
+                        Quantity qty) {
+        Order* o = pool.allocate();
+        *o = Order{};
+        o->order_id = id;
+        o->side = side;
+        o->type = type;
+        o->price = px;
+        o->quantity = qty;
+        o->visible_quantity = qty;
+        o->timestamp = id;
+        return o;
+    };
+
+    // Asks from the touch out to 200 ticks: most end up outside the window.
+    for (OrderId i = 0; i < 200; ++i) {
+        auto r = engine.submit_order(
+            make(i + 1, Side::Sell, OrderType::Limit, MID + static_cast<Price>(i) * TICK, 10));
+        ASSERT_EQ(r.status, MatchStatus::Resting);
+    }
+    EXPECT_GT(book.overflow_level_count(Side::Sell), 0u);
+
+    // FOK feasibility reads across both stores.
+    EXPECT_EQ(book.available_quantity(Side::Sell, MID + 199 * TICK), 2000u);
+
+    // Sweep 60 levels, then let the engine recenter on the new touch.
+    auto r = engine.submit_order(
+        make(1000, Side::Buy, OrderType::IOC, MID + 59 * TICK, 600));
+    EXPECT_EQ(r.status, MatchStatus::Filled);
+    EXPECT_EQ(r.trade_count, 60u);
+    ASSERT_NE(book.best_ask(), nullptr);
+    EXPECT_EQ(book.best_ask()->price, MID + 60 * TICK);
+    EXPECT_LE(book.window_low(), MID + 60 * TICK);
+
+    // Second sweep reaches levels that started in overflow.
+    r = engine.submit_order(
+        make(1001, Side::Buy, OrderType::Limit, MID + 199 * TICK, 640));
+    EXPECT_EQ(r.status, MatchStatus::Filled);
+    EXPECT_EQ(r.trades[r.trade_count - 1].price, MID + 123 * TICK);
+    EXPECT_EQ(book.best_ask()->price, MID + 124 * TICK);
+}
+
+TEST(WindowedMatchingTest, StopBookFollowsTheWindowedLayout) {
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBookOptions opts;
+    opts.window_levels = 64;
+    opts.overflow_levels = 2;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE, opts);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+    StopBook stops(book, POOL_SIZE);
+    engine.attach_stop_book(&stops);
+
+    // No ladder over the full 2M-tick range: just 66 levels per side
+    ASSERT_TRUE(stops.sparse());
+    OrderBook flat_book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE);
+    StopBook flat_stops(flat_book, POOL_SIZE);
+    EXPECT_FALSE(flat_stops.sparse());
+    EXPECT_LT(stops.memory_usage().reserved_bytes * 100,
+              flat_stops.memory_usage().reserved_bytes);
+
+    auto make = [&pool](OrderId id, Side side, OrderType type, Price px,
+                        Quantity qty) {
+        Order* o = pool.allocate();
+        *o = Order{};
+        o->order_id = id;
+        o->side = side;
+        o->type = type;
+        o->price = px;
+        o->quantity = qty;
+        o->visible_quantity = qty;
+        o->timestamp = id;
+        return o;
+    };
+
+    (void)engine.submit_order(make(1, Side::Sell, OrderType::Limit, MID, 10));
+    (void)engine.submit_order(
+        make(2, Side::Sell, OrderType::Limit, MID + TICK, 10));
+
+    // Stops far outside the window still rest; cancel frees their level
+    Order* far = make(10, Side::Buy, OrderType::Stop, 0, 5);
+    far->stop_price = MAX_PRICE;
+    EXPECT_EQ(engine.submit_order(far).status, MatchStatus::Resting);
+    Order* near = make(11, Side::Buy, OrderType::Stop, 0, 10);
+    near->stop_price = MID;
+    EXPECT_EQ(engine.submit_order(near).status, MatchStatus::Resting);
+    EXPECT_EQ(stops.lowest_buy_stop(), MID);
+    EXPECT_TRUE(engine.cancel_order(10));
+    EXPECT_EQ(stops.size(), 1u);
+
+    // The trade at MID elects the near stop, which lifts MID + TICK
+    CollectingSink collected;
+    (void)engine.submit_order(make(20, Side::Buy, OrderType::Limit, MID, 10),
+                              make_trade_sink(collected));
+    ASSERT_EQ(collected.count, 2u);
+    EXPECT_EQ(collected.trades[1].buy_order_id, 11u);
+    EXPECT_EQ(collected.trades[1].price, MID + TICK);
+    EXPECT_EQ(stops.size(), 0u);
+    EXPECT_EQ(stops.lowest_buy_stop(), 0);
+
+    // Each side holds at most window + overflow distinct stop levels
+    for (OrderId i = 0; i < 66; ++i) {
+        Order* s = make(100 + i, Side::Sell, OrderType::Stop, 0, 1);
+        s->stop_price = MIN_PRICE + static_cast<Price>(i) * TICK;
+        ASSERT_TRUE(stops.add(s));
+    }
+    Order* extra = make(200, Side::Sell, OrderType::Stop, 0, 1);
+    extra->stop_price = MIN_PRICE + 66 * TICK;
+    EXPECT_FALSE(stops.add(extra));
+    EXPECT_EQ(stops.find(200), nullptr);
+}
+
+TEST(DenseStatsMatchingTest, PartialFillsVisibleInDenseDepth) {
+    MemoryPool<Order> pool(POOL_SIZE);
+    OrderBookOptions opts;
+    opts.dense_level_stats = true;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, POOL_SIZE, opts);
+    MatchingEngine engine(book, pool, SelfTradePreventionMode::None);
+
+    auto make = [&pool](OrderId id, Side side, Price px, Quantity qty) {
+        Order* o = pool.allocate();
+        *o = Order{};
+        o->order_id = id;
+        o->side = side;
+        o->type = OrderType::Limit;
+        o->price = px;
+        o->quantity = qty;
+        o->visible_quantity = qty;
+        return o;
+    };
+
+    (void)engine.submit_order(make(1, Side::Sell, MID, 100));
+    (void)engine.submit_order(make(2, Side::Sell, MID + TICK, 50));
+    auto r = engine.submit_order(make(3, Side::Buy, MID + TICK, 130));
+    EXPECT_EQ(r.status, MatchStatus::Filled);
+
+    DepthEntry d[2];
+    ASSERT_EQ(book.get_ask_depth(d, 2), 1u);
+    EXPECT_EQ(d[0].price, MID + TICK);
+    EXPECT_EQ(d[0].quantity, 20u);
+    EXPECT_EQ(d[0].order_count, 1u);
+    EXPECT_EQ(book.available_quantity(Side::Sell, MAX_PRICE), 20u);
+}
+
 }  // namespace
 }  // namespace hft
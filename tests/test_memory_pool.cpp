@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <vector>
 
 #include "core/order.h"
@@ -275,5 +277,327 @@ TEST(MemoryPoolTest, AllocatedMemoryIsWritable) {
     pool.deallocate(o);
 }
 
+struct LineAligned {
+    static constexpr size_t pool_slot_alignment = 64;
+    uint64_t words[11];  // 88 bytes, like Order
+};
+
+TEST(MemoryPoolTest, SlotAlignmentOptIn) {
+    using Pool = MemoryPool<LineAligned>;
+    static_assert(Pool::SLOT_ALIGN == 64);
+    static_assert(Pool::SLOT_SIZE == 128);
+
+    Pool pool(16);
+    for (size_t i = 0; i < 16; ++i) {
+        LineAligned* p = pool.allocate();
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0u);
+        EXPECT_TRUE(pool.owns(p));
+    }
+}
+
+TEST(MemoryPoolTest, OrderSlotsHonourConfiguredAlignment) {
+    using Pool = MemoryPool<Order>;
+    Pool pool(8);
+    for (size_t i = 0; i < 8; ++i) {
+        Order* o = pool.allocate();
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(o) % Pool::SLOT_ALIGN, 0u);
+    }
+#if defined(HFT_LINE_ALIGNED_ORDERS)
+    EXPECT_EQ(Pool::SLOT_SIZE, 128u);
+#else
+    EXPECT_EQ(Pool::SLOT_SIZE, sizeof(Order));
+#endif
+}
+
+TEST(MemoryPoolTest, PlainTypesKeepNaturalStride) {
+    struct Small {
+        void* p;
+        uint64_t v;
+    };
+    using Pool = MemoryPool<Small>;
+    static_assert(Pool::SLOT_ALIGN == alignof(Small));
+    static_assert(Pool::SLOT_SIZE == sizeof(Small));
+
+    Pool pool(4);
+    auto* a = reinterpret_cast<char*>(pool.allocate());
+    auto* b = reinterpret_cast<char*>(pool.allocate());
+    EXPECT_EQ(b - a, static_cast<std::ptrdiff_t>(sizeof(Small)));
+}
+
+TEST(MemoryPoolTest, DefaultBackingUsesHeap) {
+    MemoryPool<Order> pool(64);
+    EXPECT_FALSE(pool.backing().mapped);
+    EXPECT_EQ(pool.backing().pages, PageMode::Default);
+}
+
+TEST(MemoryPoolTest, HugePageRequestDegradesGracefully) {
+    // 1 GB pages are almost never reserved in CI; the request must fall
+    // back (2 MB -> THP -> regular pages) rather than fail.
+    MemoryBacking backing;
+    backing.pages = PageMode::Huge1GB;
+    backing.prefault = true;
+
+    MemoryPool<Order> pool(1000, backing);
+    const BackingRegion& region = pool.backing();
+    ASSERT_NE(region.data, nullptr);
+    EXPECT_TRUE(region.mapped);
+    EXPECT_GE(region.bytes, 1000 * MemoryPool<Order>::SLOT_SIZE);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        Order* o = pool.allocate();
+        ASSERT_NE(o, nullptr);
+        EXPECT_TRUE(pool.owns(o));
+        o->order_id = i + 1;
+    }
+    EXPECT_TRUE(pool.full());
+}
+
+TEST(MemoryPoolTest, NumaLocalBackingIsUsable) {
+    MemoryBacking backing;
+    backing.numa_node = MemoryBacking::NUMA_LOCAL;
+
+    MemoryPool<Order> pool(16, backing);
+    EXPECT_TRUE(pool.backing().mapped);
+    Order* o = pool.allocate();
+    ASSERT_NE(o, nullptr);
+    pool.deallocate(o);
+    EXPECT_TRUE(pool.empty());
+}
+
+TEST(BackingMemoryTest, RegionsAreZeroFilledAndAligned) {
+    const PageMode modes[] = {PageMode::Default, PageMode::Transparent,
+                              PageMode::Huge2MB};
+    for (PageMode mode : modes) {
+        MemoryBacking backing;
+        backing.pages = mode;
+        BackingRegion region = allocate_backing(10'000, 64, backing);
+        ASSERT_NE(region.data, nullptr) << page_mode_name(mode);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(region.data) % 64, 0u);
+
+        const auto* bytes = static_cast<const unsigned char*>(region.data);
+        size_t nonzero = 0;
+        for (size_t i = 0; i < 10'000; ++i) nonzero += (bytes[i] != 0);
+        EXPECT_EQ(nonzero, 0u) << page_mode_name(mode);
+
+        release_backing(region);
+        EXPECT_EQ(region.data, nullptr);
+    }
+}
+
+TEST(MemoryPoolTest, GrowableAddsSegmentsWithoutMovingSlots) {
+    PoolGrowth growth;
+    growth.segment_slots = 8;
+    MemoryPool<Order> pool(8, {}, growth);
+    EXPECT_EQ(pool.capacity(), 8u);
+    EXPECT_EQ(pool.segment_count(), 1u);
+
+    std::vector<Order*> live;
+    for (size_t i = 0; i < 8; ++i) {
+        live.push_back(pool.allocate());
+        live.back()->order_id = i + 1;
+    }
+    EXPECT_FALSE(pool.growth_pending());
+
+    // Ninth allocation adopts the pre-mapped spare in O(1).
+    live.push_back(pool.allocate());
+    ASSERT_NE(live.back(), nullptr);
+    EXPECT_EQ(pool.capacity(), 16u);
+    EXPECT_EQ(pool.segment_count(), 2u);
+    EXPECT_TRUE(pool.growth_pending());
+
+    EXPECT_TRUE(pool.grow());
+    EXPECT_FALSE(pool.growth_pending());
+
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(live[i]->order_id, i + 1);  // Old slots untouched
+    }
+    for (Order* o : live) EXPECT_TRUE(pool.owns(o));
+}
+
+TEST(MemoryPoolTest, GrowableStopsAtCeiling) {
+    PoolGrowth growth;
+    growth.segment_slots = 4;
+    growth.max_slots = 10;
+    MemoryPool<Order> pool(4, {}, growth);
+
+    size_t got = 0;
+    while (pool.allocate()) {
+        ++got;
+        pool.grow();
+    }
+    EXPECT_EQ(got, 10u);  // 4 + 4 + final 2-slot segment
+    EXPECT_EQ(pool.capacity(), 10u);
+    EXPECT_TRUE(pool.full());
+}
+
+TEST(MemoryPoolTest, QuotaViewsShareOneSlab) {
+    MemoryPool<Order> shared(10);
+    MemoryPool<Order> a(shared, 6);
+    MemoryPool<Order> b(shared, 6);
+
+    std::vector<Order*> from_a;
+    for (size_t i = 0; i < 6; ++i) from_a.push_back(a.allocate());
+    EXPECT_EQ(a.allocate(), nullptr);  // Quota reached
+    EXPECT_TRUE(a.full());
+    EXPECT_EQ(a.size(), 6u);
+
+    // b is limited by what is left in the slab, not its own quota.
+    size_t from_b = 0;
+    while (b.allocate()) ++from_b;
+    EXPECT_EQ(from_b, 4u);
+    EXPECT_EQ(shared.size(), 10u);
+
+    a.deallocate(from_a.back());
+    EXPECT_EQ(shared.size(), 9u);
+    EXPECT_NE(b.allocate(), nullptr);
+    EXPECT_TRUE(b.owns(from_a.front()));
+}
+
+TEST(MemoryPoolTest, SingleFreeListIgnoresHints) {
+    MemoryPool<Order> pool(16);
+    EXPECT_EQ(pool.colours(), 1u);
+    Order* a = pool.allocate(7);
+    pool.deallocate(a);
+    EXPECT_EQ(pool.allocate(1234), a);  // Still plain LIFO
+    EXPECT_EQ(pool.colour_of(a), 0u);
+}
+
+TEST(MemoryPoolTest, LocalityHintsLandInTheirColour) {
+    PoolLocality locality;
+    locality.colours = 8;
+    locality.chunk_bytes = 4096;
+    locality.hint_shift = 0;
+    MemoryPool<Order> pool(4096, {}, {}, locality);
+    EXPECT_EQ(pool.colours(), 8u);
+
+    std::vector<Order*> live;
+    for (size_t hint = 0; hint < 64; ++hint) {
+        for (int i = 0; i < 4; ++i) {
+            Order* o = pool.allocate(hint);
+            ASSERT_NE(o, nullptr);
+            EXPECT_EQ(pool.colour_of(o), pool.colour_for(hint));
+            // Every slot of a colour lies in one of that colour's chunks
+            EXPECT_EQ((reinterpret_cast<uintptr_t>(o) >> 12) % 8, hint % 8);
+            live.push_back(o);
+        }
+    }
+
+    // A freed slot returns to its own colour and is reused by that hint.
+    Order* freed = live[5];
+    const size_t colour = pool.colour_of(freed);
+    pool.deallocate(freed);
+    EXPECT_EQ(pool.allocate(colour + 8), freed);
+    for (Order* o : live) pool.deallocate(o);
+    EXPECT_TRUE(pool.empty());
+}
+
+TEST(MemoryPoolTest, LocalityBorrowsFromNeighbouringColours) {
+    PoolLocality locality;
+    locality.colours = 4;
+    locality.chunk_bytes = 1024;
+    locality.hint_shift = 2;
+    MemoryPool<Order> pool(256, {}, {}, locality);
+
+    // One hint drains every colour before the pool reports exhaustion.
+    std::vector<Order*> live;
+    while (Order* o = pool.allocate(4)) live.push_back(o);
+    EXPECT_EQ(live.size(), 256u);
+    EXPECT_TRUE(pool.full());
+    std::sort(live.begin(), live.end());
+    EXPECT_EQ(std::unique(live.begin(), live.end()), live.end());
+
+    // Freeing one slot of colour 3 serves any hint.
+    Order* back = nullptr;
+    for (Order* o : live) {
+        if (pool.colour_of(o) == 3) back = o;
+    }
+    ASSERT_NE(back, nullptr);
+    pool.deallocate(back);
+    EXPECT_FALSE(pool.full());
+    EXPECT_EQ(pool.allocate(0), back);
+}
+
+TEST(MemoryPoolTest, LocalityGrowsAndSharesThroughQuotaViews) {
+    PoolLocality locality;
+    locality.colours = 4;
+    locality.chunk_bytes = 512;
+    locality.hint_shift = 0;
+    PoolGrowth growth;
+    growth.segment_slots = 64;
+    MemoryPool<Order> shared(64, {}, growth, locality);
+    MemoryPool<Order> view(shared, 1000);
+    EXPECT_EQ(view.colours(), 4u);
+
+    std::vector<Order*> live;
+    for (size_t i = 0; i < 100; ++i) {
+        Order* o = view.allocate(i);
+        ASSERT_NE(o, nullptr) << i;
+        live.push_back(o);
+        shared.grow();
+    }
+    EXPECT_EQ(shared.segment_count(), 2u);
+    EXPECT_EQ(shared.size(), 100u);
+    // Once the spare segment is adopted, hints find their colour again.
+    Order* o = view.allocate(2);
+    EXPECT_EQ(view.colour_of(o), 2u);
+    view.deallocate(o);
+    for (Order* p : live) view.deallocate(p);
+    EXPECT_TRUE(shared.empty());
+}
+
+TEST(BackingMemoryTest, TouchedBytesFollowFirstTouch) {
+    MemoryBacking backing;
+    backing.pages = PageMode::Transparent;  // Anonymous mapping, untouched
+    BackingRegion region = allocate_backing(size_t{8} << 20, 64, backing);
+
+    MemoryUsage usage = backing_usage(region);
+    EXPECT_EQ(usage.reserved_bytes, region.bytes);
+    EXPECT_LE(usage.touched_bytes, usage.reserved_bytes);
+#ifdef __linux__
+    EXPECT_EQ(usage.touched_bytes, 0u);
+#endif
+
+    std::memset(region.data, 1, region.bytes);
+    usage = backing_usage(region);
+    EXPECT_EQ(usage.touched_bytes, region.bytes);
+    EXPECT_EQ(usage.high_water_bytes, usage.touched_bytes);
+    release_backing(region);
+
+    EXPECT_EQ(backing_usage(region).reserved_bytes, 0u);
+}
+
+TEST(MemoryPoolTest, MemoryUsageReportsSlabAndHighWater) {
+    MemoryPool<Order> pool(100);
+    MemoryUsage usage = pool.memory_usage();
+    EXPECT_GE(usage.reserved_bytes, 100 * MemoryPool<Order>::SLOT_SIZE);
+    EXPECT_EQ(usage.touched_bytes, usage.reserved_bytes);  // Free list pre-faults
+    EXPECT_EQ(usage.high_water_bytes, 0u);
+
+    std::vector<Order*> live;
+    for (int i = 0; i < 10; ++i) live.push_back(pool.allocate());
+    for (Order* o : live) pool.deallocate(o);
+    EXPECT_EQ(pool.memory_usage().high_water_bytes,
+              10 * MemoryPool<Order>::SLOT_SIZE);
+
+    // A quota view owns nothing: only its own high-water mark.
+    MemoryPool<Order> view(pool, 50);
+    view.deallocate(view.allocate());
+    usage = view.memory_usage();
+    EXPECT_EQ(usage.reserved_bytes, 0u);
+    EXPECT_EQ(usage.high_water_bytes, MemoryPool<Order>::SLOT_SIZE);
+}
+
+TEST(MemoryPoolTest, MemoryUsageCountsEverySegment) {
+    PoolGrowth growth;
+    growth.segment_slots = 4096;
+    MemoryPool<Order> pool(4096, {}, growth);
+    const size_t one = pool.memory_usage().reserved_bytes;  // Segment + spare
+
+    for (size_t i = 0; i < 4097; ++i) ASSERT_NE(pool.allocate(), nullptr);
+    ASSERT_TRUE(pool.grow());
+    EXPECT_GT(pool.memory_usage().reserved_bytes, one);
+}
+
 }  // namespace
 }  // namespace hft
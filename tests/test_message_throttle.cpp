@@ -0,0 +1,237 @@
+/// @file test_message_throttle.cpp
+/// @brief Unit tests for MessageThrottle and its use in OrderGateway.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/order.h"
+#include "core/types.h"
+#include "gateway/message_throttle.h"
+#include "gateway/order_gateway.h"
+#include "matching/matching_engine.h"
+#include "orderbook/memory_pool.h"
+#include "orderbook/order_book.h"
+#include "transport/event_buffer.h"
+#include "transport/message.h"
+
+using namespace hft;
+
+// ===========================================================================
+// Helpers
+// ===========================================================================
+
+namespace {
+
+/// 1 tick per ns, so 1000 msgs/s costs 1'000'000 ticks per message.
+constexpr uint64_t MS = 1'000'000;
+
+ThrottleConfig make_config(uint32_t rate, uint32_t burst) {
+    ThrottleConfig config;
+    config.participant = {rate, burst};
+    config.max_participants = 8;
+    config.max_instruments = 4;
+    config.tsc_ticks_per_ns = 1.0;
+    return config;
+}
+
+OrderMessage make_msg(OrderId id, ParticipantId participant,
+                      MessageType type = MessageType::Add) {
+    OrderMessage msg{};
+    msg.type = type;
+    msg.instrument_id = DEFAULT_INSTRUMENT_ID;
+    msg.order.order_id = id;
+    msg.order.participant_id = participant;
+    msg.order.instrument_id = DEFAULT_INSTRUMENT_ID;
+    msg.order.side = Side::Buy;
+    msg.order.type = OrderType::Limit;
+    msg.order.time_in_force = TimeInForce::GTC;
+    msg.order.status = OrderStatus::New;
+    msg.order.price = static_cast<Price>(90 + id % 10) * PRICE_SCALE;
+    msg.order.quantity = 10;
+    msg.order.visible_quantity = 10;
+    msg.order.timestamp = 1000;
+    return msg;
+}
+
+std::vector<EventMessage> drain_events(EventBuffer& buffer) {
+    std::vector<EventMessage> events;
+    EventMessage event{};
+    while (buffer.try_pop(event)) events.push_back(event);
+    return events;
+}
+
+}  // namespace
+
+// ===========================================================================
+// Token buckets
+// ===========================================================================
+
+TEST(MessageThrottleTest, BurstThenSustainedRate) {
+    MessageThrottle throttle(make_config(1000, 3));
+    const uint64_t t0 = 1'000'000'000;
+
+    // A full burst is available up front, then one message per ms
+    EXPECT_TRUE(throttle.admit(1, 0, t0));
+    EXPECT_TRUE(throttle.admit(1, 0, t0));
+    EXPECT_TRUE(throttle.admit(1, 0, t0));
+    EXPECT_FALSE(throttle.admit(1, 0, t0));
+    EXPECT_FALSE(throttle.admit(1, 0, t0 + MS / 2));
+    EXPECT_TRUE(throttle.admit(1, 0, t0 + MS));
+    EXPECT_FALSE(throttle.admit(1, 0, t0 + MS));
+
+    // Idle time refills no more than the burst
+    for (int i = 0; i < 3; ++i) EXPECT_TRUE(throttle.admit(1, 0, t0 + 100 * MS));
+    EXPECT_FALSE(throttle.admit(1, 0, t0 + 100 * MS));
+
+    // Other participants have their own buckets
+    EXPECT_TRUE(throttle.admit(2, 0, t0));
+    EXPECT_EQ(throttle.throttled(1), 4u);
+    EXPECT_EQ(throttle.throttled(2), 0u);
+    EXPECT_EQ(throttle.admitted(), 8u);
+}
+
+TEST(MessageThrottleTest, InstrumentLimitsAndOverflowBuckets) {
+    ThrottleConfig config = make_config(0, 0);  // Participants unlimited
+    config.instrument = {1000, 2};
+    MessageThrottle throttle(config);
+    const uint64_t t0 = 1'000'000'000;
+
+    // The instrument bucket is shared by every participant, and a failed
+    // admit draws from neither bucket
+    ASSERT_TRUE(throttle.set_participant_limits(3, {1000, 1}));
+    EXPECT_TRUE(throttle.admit(1, 0, t0));
+    EXPECT_TRUE(throttle.admit(2, 0, t0));
+    EXPECT_FALSE(throttle.admit(3, 0, t0));
+    EXPECT_TRUE(throttle.admit(3, 1, t0));
+    EXPECT_FALSE(throttle.admit(3, 2, t0));
+
+    // Ids past the configured counts share one bucket
+    ASSERT_TRUE(throttle.set_instrument_limits(3, {1000, 1}));
+    EXPECT_FALSE(throttle.set_instrument_limits(4, {1000, 1}));
+    EXPECT_TRUE(throttle.admit(1, 4, t0));
+    EXPECT_TRUE(throttle.admit(1, 9, t0));
+    EXPECT_FALSE(throttle.admit(1, 100, t0));
+}
+
+TEST(MessageThrottleTest, QueueReleasesInOrderPerParticipant) {
+    ThrottleConfig config = make_config(1000, 1);
+    config.action = ThrottleAction::Queue;
+    config.queue_capacity = 3;
+    MessageThrottle throttle(config);
+    const uint64_t t0 = 1'000'000'000;
+
+    // Participant 1 has spent its credit; participant 2 has not
+    ASSERT_TRUE(throttle.admit(1, 0, t0));
+    ASSERT_TRUE(throttle.defer(make_msg(1, 1)));
+    ASSERT_TRUE(throttle.defer(make_msg(2, 1)));
+    ASSERT_TRUE(throttle.defer(make_msg(3, 2)));
+    EXPECT_FALSE(throttle.defer(make_msg(4, 2)));
+    EXPECT_EQ(throttle.queue_full(), 1u);
+    EXPECT_TRUE(throttle.has_deferred(1));
+
+    // Order 2 stays behind order 1; participant 2 is not held up
+    std::vector<OrderId> released;
+    auto collect = [&](const OrderMessage& m) { released.push_back(m.order.order_id); };
+    EXPECT_EQ(throttle.release(t0, collect), 1u);
+    EXPECT_EQ(released, (std::vector<OrderId>{3}));
+    EXPECT_EQ(throttle.release(t0 + MS, collect), 1u);
+    EXPECT_EQ(throttle.release(t0 + 2 * MS, collect), 1u);
+    EXPECT_EQ(released, (std::vector<OrderId>{3, 1, 2}));
+    EXPECT_EQ(throttle.deferred(), 0u);
+    EXPECT_FALSE(throttle.has_deferred(1));
+
+    // Withdraw removes a deferred add and keeps the rest in order
+    ASSERT_TRUE(throttle.defer(make_msg(5, 1)));
+    ASSERT_TRUE(throttle.defer(make_msg(6, 1)));
+    ASSERT_TRUE(throttle.defer(make_msg(7, 1)));
+    EXPECT_TRUE(throttle.withdraw(6));
+    EXPECT_FALSE(throttle.withdraw(6));
+    released.clear();
+    EXPECT_EQ(throttle.release(t0 + 10 * MS, collect), 1u);
+    EXPECT_EQ(throttle.release(t0 + 11 * MS, collect), 1u);
+    EXPECT_EQ(released, (std::vector<OrderId>{5, 7}));
+}
+
+// ===========================================================================
+// OrderGateway
+// ===========================================================================
+
+class ThrottledGatewayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        book = std::make_unique<OrderBook>(
+            1 * PRICE_SCALE, 1000 * PRICE_SCALE, 1 * PRICE_SCALE, 1000);
+        pool = std::make_unique<MemoryPool<Order>>(1000);
+        engine = std::make_unique<MatchingEngine>(*book, *pool);
+        buffer = std::make_unique<EventBuffer>();
+        gateway = std::make_unique<OrderGateway>(*engine, *pool, buffer.get());
+    }
+
+    std::unique_ptr<OrderBook> book;
+    std::unique_ptr<MemoryPool<Order>> pool;
+    std::unique_ptr<MatchingEngine> engine;
+    std::unique_ptr<EventBuffer> buffer;
+    std::unique_ptr<OrderGateway> gateway;
+};
+
+TEST_F(ThrottledGatewayTest, RejectsOverLimitMessagesButNeverCancels) {
+    // 100 msgs/s: no credit comes back within the test
+    MessageThrottle throttle(make_config(100, 2));
+    gateway->set_throttle(&throttle);
+
+    EXPECT_TRUE(gateway->process_order(make_msg(1, 1)).accepted);
+    EXPECT_TRUE(gateway->process_order(make_msg(2, 1)).accepted);
+    GatewayResult r = gateway->process_order(make_msg(3, 1));
+    EXPECT_FALSE(r.accepted);
+    EXPECT_FALSE(r.deferred);
+    EXPECT_EQ(r.reject_reason, GatewayRejectReason::Throttled);
+
+    OrderMessage modify = make_msg(1, 1, MessageType::Modify);
+    modify.order.quantity = 20;
+    EXPECT_EQ(gateway->process_modify(modify).reject_reason, GatewayRejectReason::Throttled);
+    EXPECT_TRUE(gateway->process_order(make_msg(4, 2)).accepted);
+    EXPECT_TRUE(gateway->process_cancel(1));
+
+    auto events = drain_events(*buffer);
+    size_t rejected = 0;
+    for (const auto& e : events) rejected += e.type == EventType::OrderRejected;
+    EXPECT_EQ(rejected, 2u);
+    EXPECT_EQ(gateway->orders_rejected(), 2u);
+    EXPECT_EQ(book->order_count(), 2u);
+}
+
+TEST_F(ThrottledGatewayTest, QueueDefersUntilCreditReturns) {
+    ThrottleConfig config = make_config(100, 2);  // 10 ms per message
+    config.action = ThrottleAction::Queue;
+    MessageThrottle throttle(config);
+    gateway->set_throttle(&throttle);
+
+    for (OrderId id = 1; id <= 2; ++id) {
+        EXPECT_TRUE(gateway->process_order(make_msg(id, 1)).accepted);
+    }
+    for (OrderId id = 3; id <= 5; ++id) {
+        GatewayResult r = gateway->process_order(make_msg(id, 1));
+        EXPECT_FALSE(r.accepted);
+        EXPECT_TRUE(r.deferred);
+        EXPECT_EQ(r.reject_reason, GatewayRejectReason::Throttled);
+    }
+    EXPECT_EQ(gateway->orders_rejected(), 0u);
+    EXPECT_EQ(book->order_count(), 2u);
+
+    // Cancelling a deferred add withdraws it
+    EXPECT_TRUE(gateway->process_cancel(4));
+    EXPECT_EQ(throttle.deferred(), 2u);
+
+    // The ticks-per-ns guess only has to be no faster than the real TSC
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(gateway->release_throttled(), 2u);
+    EXPECT_EQ(book->order_count(), 4u);
+    EXPECT_NE(book->find_order(3), nullptr);
+    EXPECT_EQ(book->find_order(4), nullptr);
+    EXPECT_NE(book->find_order(5), nullptr);
+    EXPECT_EQ(gateway->release_throttled(), 0u);
+}
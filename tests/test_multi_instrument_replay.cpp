@@ -1,14 +1,19 @@
 /// @file test_multi_instrument_replay.cpp
 /// @brief Unit tests for multi-instrument CSV parsing and replay.
 
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "analytics/multi_instrument_analytics.h"
 #include "core/types.h"
+#include "feed/l3_binary_format.h"
 #include "feed/l3_feed_parser.h"
 #include "feed/multi_instrument_replay_engine.h"
 #include "transport/message.h"
@@ -101,6 +106,73 @@ TEST(MultiInstrumentParsing, SixColumnBackwardCompat) {
     std::remove(path.c_str());
 }
 
+TEST(MultiInstrumentParsing, SymbolsInternedInOrderOfFirstAppearance) {
+    std::string csv =
+        "symbol,timestamp,event_type,order_id,side,price,quantity\n"
+        "ETHUSDT,1000000,ADD,1,BUY,2000,1\n"
+        "BTCUSDT,1000001,ADD,2,SELL,42000,1\n"
+        "ETHUSDT,1000002,CANCEL,1,,,\n";
+
+    auto path = write_temp_csv(csv, "intern.csv");
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(path));
+
+    L3Record record;
+    std::vector<uint32_t> ids;
+    while (parser.next(record)) {
+        ASSERT_TRUE(record.valid);
+        ids.push_back(record.symbol_id);
+    }
+    EXPECT_EQ(ids, (std::vector<uint32_t>{0, 1, 0}));
+    EXPECT_EQ(parser.symbol_count(), 2u);
+    EXPECT_EQ(parser.symbol_name(0), "ETHUSDT");
+    EXPECT_EQ(parser.symbol_name(1), "BTCUSDT");
+
+    // Ids survive a rewind, so a discovery pass and the replay agree
+    parser.reset();
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_EQ(record.symbol_id, 0u);
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_EQ(record.symbol_id, 1u);
+
+    parser.close();
+    std::remove(path.c_str());
+}
+
+TEST(MultiInstrumentParsing, InternsHundredsOfSymbols) {
+    // Shared prefixes and names past the 16 bytes held inline in a slot
+    std::vector<std::string> symbols;
+    for (int i = 0; i < 300; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+        if (i % 50 == 0) symbols.push_back("LONG_INSTRUMENT_NAME_" + std::to_string(i));
+    }
+    std::string csv = "symbol,timestamp,event_type,order_id,side,price,quantity\n";
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            csv += symbols[i] + "," + std::to_string(1000 + i) + ",ADD," +
+                   std::to_string(i + 1) + ",BUY,100,1\n";
+        }
+    }
+    auto path = write_temp_csv(csv, "many_symbols.csv");
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(path));
+    L3Record record;
+    size_t row = 0;
+    while (parser.next(record)) {
+        ASSERT_TRUE(record.valid);
+        const size_t expected = row++ % symbols.size();
+        ASSERT_EQ(record.symbol_id, expected);
+        ASSERT_EQ(record.symbol, symbols[expected]);
+    }
+    EXPECT_EQ(row, 2 * symbols.size());
+    EXPECT_EQ(parser.symbol_count(), symbols.size());
+
+    parser.close();
+    std::remove(path.c_str());
+}
+
 TEST(MultiInstrumentParsing, ToOrderMessageWithInstrumentId) {
     L3Record record;
     record.timestamp = 1000;
@@ -257,3 +329,243 @@ TEST(MultiInstrumentReplay, PreConfiguredInstruments) {
 
     std::remove(path.c_str());
 }
+
+TEST(MultiInstrumentReplay, AutoDiscoverAddsPipelinesOnFirstSight) {
+    std::string csv =
+        "symbol,timestamp,event_type,order_id,side,price,quantity\n"
+        "BTCUSDT,1000000,ADD,1,BUY,100,10\n"
+        "SOLUSDT,1000001,ADD,2,SELL,20,5\n"
+        "ETHUSDT,1000002,ADD,3,SELL,200,5\n"
+        "SOLUSDT,1000003,ADD,4,BUY,20,5\n";
+    auto path = write_temp_csv(csv, "discover_mixed.csv");
+
+    // A configured instrument keeps its id; new symbols take the free ones
+    InstrumentConfig eth;
+    eth.instrument_id = 0;
+    eth.symbol = "ETHUSDT";
+    eth.min_price = 1 * PRICE_SCALE;
+    eth.max_price = 1000 * PRICE_SCALE;
+    eth.tick_size = 1 * PRICE_SCALE;
+    eth.max_orders = 1000;
+
+    MultiReplayConfig config;
+    config.input_path = path;
+    config.instruments = {eth};
+    config.auto_discover = true;
+    config.default_min_price = 1 * PRICE_SCALE;
+    config.default_max_price = 1000 * PRICE_SCALE;
+    config.default_tick_size = 1 * PRICE_SCALE;
+    config.default_max_orders = 1000;
+    config.batch_size = 2;
+
+    MultiInstrumentReplayEngine engine(config);
+    MultiReplayStats stats = engine.run();
+
+    EXPECT_EQ(stats.total_messages, 4u);
+    ASSERT_EQ(stats.per_instrument.size(), 3u);
+    EXPECT_EQ(stats.per_instrument[0].symbol, "ETHUSDT");
+    EXPECT_EQ(stats.per_instrument[1].symbol, "BTCUSDT");
+    EXPECT_EQ(stats.per_instrument[1].instrument_id, 1u);
+    EXPECT_EQ(stats.per_instrument[2].symbol, "SOLUSDT");
+    EXPECT_EQ(stats.per_instrument[2].instrument_id, 2u);
+    EXPECT_EQ(stats.per_instrument[2].trades_generated, 1u);
+
+    EXPECT_EQ(engine.registry().count(), 3u);
+    EXPECT_EQ(engine.router().instrument_count(), 3u);
+    ASSERT_NE(engine.router().order_book(1), nullptr);
+    EXPECT_EQ(engine.router().order_book(1)->order_count(), 1u);
+    EXPECT_EQ(engine.router().order_book(0)->order_count(), 1u);
+
+    std::remove(path.c_str());
+}
+
+TEST(MultiInstrumentReplay, BinaryFileAutoDiscoversSymbols) {
+    std::string csv =
+        "symbol,timestamp,event_type,order_id,side,price,quantity\n"
+        "BTCUSDT,1000000,ADD,1,BUY,100,10\n"
+        "ETHUSDT,1000001,ADD,2,SELL,200,5\n"
+        "BTCUSDT,1000002,ADD,3,SELL,100,4\n";
+    auto path = write_temp_csv(csv, "multi_bin.csv");
+    const std::string binary_path = "multi_bin.l3b";
+    L3ConvertStats cs = convert_l3_csv_to_binary(path, binary_path);
+    ASSERT_TRUE(cs.ok);
+    EXPECT_EQ(cs.symbol_count, 2u);
+
+    L3FeedParser parser;
+    ASSERT_TRUE(parser.open(binary_path));
+    EXPECT_TRUE(parser.has_symbol_column());
+    L3Record record;
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_EQ(record.symbol, "BTCUSDT");
+    ASSERT_TRUE(parser.next(record));
+    EXPECT_EQ(record.symbol, "ETHUSDT");
+    EXPECT_EQ(record.symbol_id, 1u);
+    parser.close();
+
+    MultiReplayConfig config;
+    config.input_path = binary_path;
+    config.auto_discover = true;
+    config.default_min_price = 1 * PRICE_SCALE;
+    config.default_max_price = 1000 * PRICE_SCALE;
+    config.default_tick_size = 1 * PRICE_SCALE;
+    config.default_max_orders = 1000;
+    MultiInstrumentReplayEngine engine(config);
+    MultiReplayStats stats = engine.run();
+
+    EXPECT_EQ(stats.total_messages, 3u);
+    ASSERT_EQ(stats.per_instrument.size(), 2u);
+    for (const auto& ps : stats.per_instrument) {
+        EXPECT_EQ(ps.trades_generated, ps.symbol == "BTCUSDT" ? 1u : 0u);
+    }
+
+    std::remove(binary_path.c_str());
+    std::remove(path.c_str());
+}
+
+// ===========================================================================
+// Partitioned replay: matching workers against the serial router
+// ===========================================================================
+
+/// Four symbols' adds, cancels and modifies around a common price, with
+/// strictly increasing timestamps so the merged stream has one valid order.
+static std::string make_mixed_feed(size_t rows) {
+    static const char* SYMBOLS[] = {"BTCUSDT", "ETHUSDT", "SOLUSDT", "XRPUSDT"};
+    std::ostringstream out;
+    out << "symbol,timestamp,event_type,order_id,side,price,quantity\n";
+    uint64_t state = 12345;
+    auto next = [&state](uint64_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % bound;
+    };
+    for (size_t i = 0; i < rows; ++i) {
+        const char* symbol = SYMBOLS[next(4)];
+        const uint64_t op = next(10);
+        const char* side = next(2) ? "BUY" : "SELL";
+        const uint64_t price = 95 + next(11);
+        const uint64_t qty = 1 + next(20);
+        out << symbol << ',' << 1000000 + i << ',';
+        if (op < 6 || i < 8) {
+            out << "ADD," << i + 1 << ',' << side << ',' << price << ',' << qty;
+        } else if (op < 9) {
+            out << "CANCEL," << 1 + next(i) << ",,,";
+        } else {
+            out << "MODIFY," << 1 + next(i) << ',' << side << ',' << price << ',' << qty;
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+static MultiReplayConfig mixed_feed_config(const std::string& path) {
+    InstrumentConfig eth;
+    eth.instrument_id = 0;
+    eth.symbol = "ETHUSDT";
+    eth.min_price = 1 * PRICE_SCALE;
+    eth.max_price = 1000 * PRICE_SCALE;
+    eth.tick_size = 1 * PRICE_SCALE;
+    eth.max_orders = 10000;
+
+    MultiReplayConfig config;
+    config.input_path = path;
+    config.instruments = {eth};
+    config.auto_discover = true;
+    config.default_min_price = 1 * PRICE_SCALE;
+    config.default_max_price = 1000 * PRICE_SCALE;
+    config.default_tick_size = 1 * PRICE_SCALE;
+    config.default_max_orders = 10000;
+    config.batch_size = 16;
+    return config;
+}
+
+TEST(MultiInstrumentReplay, PartitionedReplayMatchesSerial) {
+    auto path = write_temp_csv(make_mixed_feed(4000), "partitioned.csv");
+
+    MultiInstrumentReplayEngine serial(mixed_feed_config(path));
+    std::vector<EventMessage> serial_events;
+    serial.register_event_callback(
+        [&](const EventMessage& e) { serial_events.push_back(e); });
+    MultiReplayStats expected = serial.run();
+    ASSERT_EQ(expected.per_instrument.size(), 4u);
+    EXPECT_EQ(serial.sharded_router(), nullptr);
+
+    for (size_t workers : {2u, 3u}) {
+        SCOPED_TRACE(workers);
+        MultiReplayConfig config = mixed_feed_config(path);
+        config.matching_workers = workers;
+        MultiInstrumentReplayEngine engine(config);
+        std::vector<EventMessage> events;
+        engine.register_event_callback([&](const EventMessage& e) { events.push_back(e); });
+        MultiReplayStats stats = engine.run();
+
+        ASSERT_NE(engine.sharded_router(), nullptr);
+        EXPECT_EQ(engine.sharded_router()->shard_count(), workers);
+        EXPECT_EQ(stats.total_messages, expected.total_messages);
+        ASSERT_EQ(stats.per_instrument.size(), expected.per_instrument.size());
+        for (size_t i = 0; i < stats.per_instrument.size(); ++i) {
+            const PerInstrumentStats& a = stats.per_instrument[i];
+            const PerInstrumentStats& b = expected.per_instrument[i];
+            EXPECT_EQ(a.symbol, b.symbol);
+            EXPECT_EQ(a.instrument_id, b.instrument_id);
+            EXPECT_EQ(a.orders_accepted, b.orders_accepted);
+            EXPECT_EQ(a.orders_rejected, b.orders_rejected);
+            EXPECT_EQ(a.orders_cancelled, b.orders_cancelled);
+            EXPECT_EQ(a.cancel_failures, b.cancel_failures);
+            EXPECT_EQ(a.orders_modified, b.orders_modified);
+            EXPECT_EQ(a.modify_failures, b.modify_failures);
+            EXPECT_EQ(a.trades_generated, b.trades_generated);
+            EXPECT_EQ(a.final_order_count, b.final_order_count);
+            EXPECT_EQ(a.final_best_bid, b.final_best_bid);
+            EXPECT_EQ(a.final_best_ask, b.final_best_ask);
+            ASSERT_NE(engine.order_book(a.instrument_id), nullptr);
+            EXPECT_EQ(engine.order_book(a.instrument_id)->order_count(), a.final_order_count);
+        }
+
+        // Each instrument's events are the serial ones, in the same order
+        ASSERT_EQ(events.size(), serial_events.size());
+        std::vector<std::vector<EventMessage>> mine(stats.per_instrument.size());
+        std::vector<std::vector<EventMessage>> theirs(stats.per_instrument.size());
+        for (const EventMessage& e : events) mine.at(e.instrument_id).push_back(e);
+        for (const EventMessage& e : serial_events) theirs.at(e.instrument_id).push_back(e);
+        for (size_t inst = 0; inst < mine.size(); ++inst) {
+            ASSERT_EQ(mine[inst].size(), theirs[inst].size());
+            for (size_t i = 0; i < mine[inst].size(); ++i) {
+                ASSERT_EQ(std::memcmp(&mine[inst][i], &theirs[inst][i], sizeof(EventMessage)), 0)
+                    << "instrument " << inst << " event " << i;
+            }
+        }
+
+        // Across workers the stream follows the causing orders' timestamps
+        // (events without one, such as cancels, keep their worker's last)
+        const ShardedRouter& router = *engine.sharded_router();
+        std::vector<Timestamp> worker_key(workers, 0);
+        Timestamp last = 0;
+        for (const EventMessage& e : events) {
+            Timestamp& key = worker_key.at(router.shard_of(e.instrument_id));
+            const Timestamp ts = e.type == EventType::Trade ? e.data.trade.timestamp
+                                 : e.type == EventType::LevelUpdate ? 0
+                                 : e.data.order_event.timestamp;
+            if (ts > key) key = ts;
+            EXPECT_GE(key, last);
+            last = key;
+        }
+    }
+
+    // Without the merge the workers still match; only the events are dropped
+    MultiReplayConfig config = mixed_feed_config(path);
+    config.matching_workers = 2;
+    config.merge_events = false;
+    MultiInstrumentReplayEngine unmerged(config);
+    size_t unmerged_events = 0;
+    unmerged.register_event_callback([&](const EventMessage&) { ++unmerged_events; });
+    MultiReplayStats stats = unmerged.run();
+    EXPECT_EQ(unmerged_events, 0u);
+    ASSERT_EQ(stats.per_instrument.size(), expected.per_instrument.size());
+    for (size_t i = 0; i < stats.per_instrument.size(); ++i) {
+        EXPECT_EQ(stats.per_instrument[i].trades_generated,
+                  expected.per_instrument[i].trades_generated);
+        EXPECT_EQ(stats.per_instrument[i].final_order_count,
+                  expected.per_instrument[i].final_order_count);
+    }
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,369 @@
+/// @file test_multicast_publisher.cpp
+/// @brief Unit tests for MulticastPublisher and its wire format.
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gateway/multicast_publisher.h"
+#include "transport/message.h"
+
+using namespace hft;
+
+// ===========================================================================
+// Helpers
+// ===========================================================================
+
+namespace {
+
+/// UDP socket on 127.0.0.1 with an ephemeral port and a receive timeout.
+class Receiver {
+public:
+    Receiver() {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), len);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        timeval timeout{0, 200000};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~Receiver() { ::close(fd_); }
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+    [[nodiscard]] int fd() const { return fd_; }
+
+    /// Every datagram until the socket stays quiet for the timeout.
+    std::vector<std::vector<char>> drain() {
+        std::vector<std::vector<char>> out;
+        char buffer[65536];
+        for (;;) {
+            const ssize_t n = ::recv(fd_, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            out.emplace_back(buffer, buffer + n);
+        }
+        return out;
+    }
+
+private:
+    int fd_ = -1;
+    uint16_t port_ = 0;
+};
+
+/// A free UDP port (bound and released).
+uint16_t free_port() {
+    Receiver probe;
+    return probe.port();
+}
+
+struct Decoded {
+    mdp::PacketHeader packet{};
+    std::vector<mdp::MessageHeader> headers;
+    std::vector<const char*> bodies;   // Into the datagram
+};
+
+Decoded decode(const std::vector<char>& datagram) {
+    Decoded d;
+    std::memcpy(&d.packet, datagram.data(), sizeof(d.packet));
+    size_t offset = sizeof(d.packet);
+    for (uint16_t i = 0; i < d.packet.message_count; ++i) {
+        mdp::MessageHeader header;
+        std::memcpy(&header, datagram.data() + offset, sizeof(header));
+        d.headers.push_back(header);
+        d.bodies.push_back(datagram.data() + offset + sizeof(header));
+        offset += sizeof(header) + header.block_length;
+    }
+    EXPECT_EQ(offset, datagram.size());
+    return d;
+}
+
+template <typename T>
+T read_body(const char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+EventMessage trade(InstrumentId instrument, uint64_t trade_id) {
+    EventMessage e{};
+    e.type = EventType::Trade;
+    e.instrument_id = instrument;
+    e.data.trade.trade_id = trade_id;
+    e.data.trade.price = 100 + static_cast<Price>(trade_id);
+    e.data.trade.quantity = 10;
+    return e;
+}
+
+EventMessage level(InstrumentId instrument, uint8_t side, Price price, Quantity qty) {
+    EventMessage e{};
+    e.type = EventType::LevelUpdate;
+    e.instrument_id = instrument;
+    e.data.level_update.side = side;
+    e.data.level_update.price = price;
+    e.data.level_update.total_quantity = qty;
+    e.data.level_update.order_count = qty ? 1 : 0;
+    return e;
+}
+
+EventMessage accepted(InstrumentId instrument, OrderId id) {
+    EventMessage e{};
+    e.type = EventType::OrderAccepted;
+    e.instrument_id = instrument;
+    e.data.order_event.order_id = id;
+    e.data.order_event.status = OrderStatus::New;
+    e.data.order_event.remaining_quantity = 5;
+    return e;
+}
+
+MulticastConfig loopback_config(const Receiver& receiver) {
+    MulticastConfig config;
+    config.group = "127.0.0.1";
+    config.port = receiver.port();
+    config.datagrams = 16;
+    return config;
+}
+
+}  // namespace
+
+// ===========================================================================
+// Incremental channel
+// ===========================================================================
+
+TEST(MulticastPublisherTest, EncodesEventsWithPacketAndInstrumentSequences) {
+    Receiver receiver;
+    MulticastPublisher feed(loopback_config(receiver));
+    ASSERT_TRUE(feed.open()) << feed.error();
+
+    EXPECT_TRUE(feed.append(trade(1, 7)));
+    EXPECT_TRUE(feed.append(accepted(2, 42)));
+    EXPECT_TRUE(feed.append(level(1, 0, 100, 30)));
+    feed.flush();
+    EXPECT_TRUE(feed.append(trade(2, 8)));
+    feed.close();
+
+    EXPECT_EQ(feed.instrument_sequence(1), 2u);
+    EXPECT_EQ(feed.instrument_sequence(2), 2u);
+    const MulticastStats stats = feed.stats();
+    EXPECT_EQ(stats.events_appended, 4u);
+    EXPECT_EQ(stats.datagrams_sent, 2u);
+    EXPECT_EQ(stats.send_errors, 0u);
+
+    const auto datagrams = receiver.drain();
+    ASSERT_EQ(datagrams.size(), 2u);
+    const Decoded first = decode(datagrams[0]);
+    const Decoded second = decode(datagrams[1]);
+    EXPECT_EQ(first.packet.sequence, 1u);
+    EXPECT_EQ(second.packet.sequence, 2u);
+    EXPECT_EQ(first.packet.channel, static_cast<uint8_t>(mdp::Channel::Incremental));
+    EXPECT_GT(first.packet.sending_time, 0u);
+    ASSERT_EQ(first.packet.message_count, 3u);
+    ASSERT_EQ(second.packet.message_count, 1u);
+
+    EXPECT_EQ(first.headers[0].template_id, static_cast<uint16_t>(mdp::Template::Trade));
+    EXPECT_EQ(first.headers[0].schema_id, mdp::SCHEMA_ID);
+    const auto t = read_body<mdp::TradeBody>(first.bodies[0]);
+    EXPECT_EQ(t.instrument_id, 1u);
+    EXPECT_EQ(t.instrument_sequence, 1u);
+    EXPECT_EQ(t.trade_id, 7u);
+    EXPECT_EQ(t.price, 107);
+
+    EXPECT_EQ(first.headers[1].template_id, static_cast<uint16_t>(mdp::Template::OrderUpdate));
+    const auto o = read_body<mdp::OrderUpdateBody>(first.bodies[1]);
+    EXPECT_EQ(o.instrument_sequence, 1u);
+    EXPECT_EQ(o.order_id, 42u);
+    EXPECT_EQ(o.event_type, static_cast<uint8_t>(EventType::OrderAccepted));
+    EXPECT_EQ(o.remaining_quantity, 5u);
+
+    const auto l = read_body<mdp::LevelUpdateBody>(first.bodies[2]);
+    EXPECT_EQ(l.instrument_sequence, 2u);
+    EXPECT_EQ(l.price, 100);
+    EXPECT_EQ(l.total_quantity, 30u);
+
+    EXPECT_EQ(read_body<mdp::TradeBody>(second.bodies[0]).instrument_sequence, 2u);
+}
+
+TEST(MulticastPublisherTest, UnknownInstrumentIsRejectedUntilAdded) {
+    Receiver receiver;
+    MulticastConfig config = loopback_config(receiver);
+    config.max_instruments = 2;  // Counters sized at open(), never in append()
+    MulticastPublisher feed(config);
+    ASSERT_TRUE(feed.open()) << feed.error();
+
+    EXPECT_TRUE(feed.append(trade(1, 7)));
+    EXPECT_FALSE(feed.append(trade(5, 8)));
+    EXPECT_EQ(feed.stats().events_rejected, 1u);
+    EXPECT_EQ(feed.instrument_sequence(5), 0u);
+
+    feed.add_instrument(5);
+    EXPECT_TRUE(feed.append(trade(5, 9)));
+    feed.close();
+    EXPECT_EQ(feed.instrument_sequence(5), 1u);
+    EXPECT_EQ(feed.stats().events_appended, 2u);
+    EXPECT_EQ(feed.stats().events_rejected, 1u);
+}
+
+TEST(MulticastPublisherTest, DatagramsNeverExceedTheMtu) {
+    Receiver receiver;
+    MulticastConfig config = loopback_config(receiver);
+    config.mtu = 256;  // (256 - 24) / 72 = 3 trades per datagram
+    MulticastPublisher feed(config);
+    ASSERT_TRUE(feed.open()) << feed.error();
+    for (uint64_t i = 1; i <= 10; ++i) EXPECT_TRUE(feed.append(trade(0, i)));
+    feed.close();
+
+    const auto datagrams = receiver.drain();
+    ASSERT_EQ(datagrams.size(), 4u);
+    uint64_t next_trade = 1;
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        EXPECT_LE(datagrams[i].size(), 256u);
+        const Decoded d = decode(datagrams[i]);
+        EXPECT_EQ(d.packet.sequence, i + 1);
+        for (const char* body : d.bodies) {
+            EXPECT_EQ(read_body<mdp::TradeBody>(body).trade_id, next_trade++);
+        }
+    }
+    EXPECT_EQ(next_trade, 11u);
+}
+
+TEST(MulticastPublisherTest, LevelsContentSkipsOrderEvents) {
+    Receiver receiver;
+    MulticastConfig config = loopback_config(receiver);
+    config.content = MulticastContent::Levels;
+    MulticastPublisher feed(config);
+    ASSERT_TRUE(feed.open()) << feed.error();
+    EXPECT_FALSE(feed.append(accepted(0, 1)));
+    EXPECT_TRUE(feed.append(level(0, 1, 101, 4)));
+    EXPECT_TRUE(feed.append(trade(0, 1)));
+    feed.close();
+
+    EXPECT_EQ(feed.stats().events_skipped, 1u);
+    EXPECT_EQ(feed.instrument_sequence(0), 2u);
+    const auto datagrams = receiver.drain();
+    ASSERT_EQ(datagrams.size(), 1u);
+    const Decoded d = decode(datagrams[0]);
+    ASSERT_EQ(d.headers.size(), 2u);
+    EXPECT_EQ(d.headers[0].template_id, static_cast<uint16_t>(mdp::Template::LevelUpdate));
+    EXPECT_EQ(d.headers[1].template_id, static_cast<uint16_t>(mdp::Template::Trade));
+}
+
+// ===========================================================================
+// Recovery
+// ===========================================================================
+
+TEST(MulticastPublisherTest, AnswersRetransmitRequestsFromHistory) {
+    Receiver receiver;
+    MulticastConfig config = loopback_config(receiver);
+    config.retransmit_port = free_port();
+    config.retransmit_history = 8;
+    MulticastPublisher feed(config);
+    ASSERT_TRUE(feed.open()) << feed.error();
+    ASSERT_EQ(feed.retransmit_port(), config.retransmit_port);
+
+    for (uint64_t i = 1; i <= 5; ++i) {
+        EXPECT_TRUE(feed.append(trade(0, i)));
+        feed.flush();
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (feed.stats().datagrams_sent < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(receiver.drain().size(), 5u);
+
+    // Ask for 2..3 plus one never sent; only the held ones come back
+    Receiver client;
+    mdp::RetransmitRequest request{};
+    request.first_sequence = 2;
+    request.count = 2;
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    to.sin_port = htons(feed.retransmit_port());
+    ASSERT_EQ(::sendto(client.fd(), &request, sizeof(request), 0,
+                       reinterpret_cast<const sockaddr*>(&to), sizeof(to)),
+              static_cast<ssize_t>(sizeof(request)));
+    request.first_sequence = 9;
+    request.count = 1;
+    ASSERT_GT(::sendto(client.fd(), &request, sizeof(request), 0,
+                       reinterpret_cast<const sockaddr*>(&to), sizeof(to)), 0);
+
+    const auto replies = client.drain();
+    ASSERT_EQ(replies.size(), 2u);
+    for (size_t i = 0; i < replies.size(); ++i) {
+        const Decoded d = decode(replies[i]);
+        EXPECT_EQ(d.packet.sequence, i + 2);
+        EXPECT_EQ(d.packet.flags & mdp::FLAG_RETRANSMIT, mdp::FLAG_RETRANSMIT);
+        EXPECT_EQ(read_body<mdp::TradeBody>(d.bodies[0]).trade_id, i + 2);
+    }
+    feed.close();
+    EXPECT_EQ(feed.stats().retransmit_requests, 2u);
+    EXPECT_EQ(feed.stats().datagrams_retransmitted, 2u);
+}
+
+TEST(MulticastPublisherTest, SnapshotChannelCarriesTheLevelImage) {
+    Receiver receiver;
+    Receiver snapshots;
+    MulticastConfig config = loopback_config(receiver);
+    config.snapshot_group = "127.0.0.1";
+    config.snapshot_port = snapshots.port();
+    config.snapshot_interval_ms = 0;  // Every flush
+    MulticastPublisher feed(config);
+    ASSERT_TRUE(feed.open()) << feed.error();
+
+    EXPECT_TRUE(feed.append(level(3, 0, 100, 5)));
+    EXPECT_TRUE(feed.append(level(3, 0, 99, 7)));
+    EXPECT_TRUE(feed.append(level(3, 1, 102, 2)));
+    EXPECT_TRUE(feed.append(level(3, 0, 99, 0)));  // Removed
+    EXPECT_TRUE(feed.append(level(3, 1, 101, 9)));
+    feed.flush();
+    feed.close();
+
+    EXPECT_EQ(receiver.drain().size(), 1u);
+    const auto datagrams = snapshots.drain();
+    ASSERT_EQ(datagrams.size(), 1u);
+    const Decoded d = decode(datagrams[0]);
+    EXPECT_EQ(d.packet.sequence, 1u);
+    EXPECT_EQ(d.packet.channel, static_cast<uint8_t>(mdp::Channel::Snapshot));
+    ASSERT_EQ(d.headers.size(), 1u);
+    EXPECT_EQ(d.headers[0].template_id, static_cast<uint16_t>(mdp::Template::Snapshot));
+
+    const auto body = read_body<mdp::SnapshotBody>(d.bodies[0]);
+    EXPECT_EQ(body.instrument_id, 3u);
+    EXPECT_EQ(body.chunk, 0u);
+    EXPECT_EQ(body.chunk_count, 1u);
+    EXPECT_EQ(body.last_instrument_sequence, 5u);
+    const auto group = read_body<mdp::GroupSize>(d.bodies[0] + sizeof(body));
+    ASSERT_EQ(group.num_in_group, 3u);
+    ASSERT_EQ(group.block_length, sizeof(mdp::SnapshotEntry));
+
+    const char* entries = d.bodies[0] + sizeof(body) + sizeof(group);
+    const auto bid = read_body<mdp::SnapshotEntry>(entries);
+    const auto ask1 = read_body<mdp::SnapshotEntry>(entries + sizeof(mdp::SnapshotEntry));
+    const auto ask2 = read_body<mdp::SnapshotEntry>(entries + 2 * sizeof(mdp::SnapshotEntry));
+    EXPECT_EQ(bid.side, 0u);
+    EXPECT_EQ(bid.price, 100);
+    EXPECT_EQ(bid.total_quantity, 5u);
+    EXPECT_EQ(ask1.side, 1u);
+    EXPECT_EQ(ask1.price, 101);   // Best ask first
+    EXPECT_EQ(ask2.price, 102);
+    EXPECT_EQ(feed.stats().snapshots_sent, 1u);
+}
+
+TEST(MulticastPublisherTest, RejectsAnInvalidGroup) {
+    MulticastConfig config;
+    config.group = "not-an-address";
+    MulticastPublisher feed(config);
+    EXPECT_FALSE(feed.open());
+    EXPECT_FALSE(feed.error().empty());
+    EXPECT_FALSE(feed.append(trade(0, 1)));
+}
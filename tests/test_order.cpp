@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <cstddef>
 #include <cstring>
 #include <type_traits>
 
@@ -7,6 +8,7 @@
 #include "core/price_level.h"
 #include "core/trade.h"
 #include "core/types.h"
+#include "core/uint128.h"
 
 namespace hft {
 namespace {
@@ -75,9 +77,29 @@ TEST(OrderTest, FitsInTwoCacheLines) {
 
 TEST(OrderTest, FieldLayout) {
     // Verify there's no unexpected padding blowing up the size.
-    // 8 + 4 + 4 + 1 + 1 + 1 + 1 + [4 pad] + 8 + 8 + 8 + 8 + 8 + 8 + 8 + 8 = 88
-    // Includes instrument_id and iceberg_slice_qty fields.
-    EXPECT_LE(sizeof(Order), 96u);
+    // Hot: 8 * 7 + 4 + 1 + 1 + 1 + 1 = 64
+    // Cold: 4 + 4 + 8 + 8 + 8 + 8 + 8 + 8 = 56  -> 120
+    EXPECT_LE(sizeof(Order), 128u);
+}
+
+TEST(OrderTest, MatchingFieldsShareOneCacheLine) {
+    // Every field the matching loop touches on a resting order.
+    EXPECT_LT(offsetof(Order, order_id), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, price), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, quantity), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, visible_quantity), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, filled_quantity), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, next), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, prev), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, participant_id), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, side), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, type), Order::hot_bytes);
+    EXPECT_LT(offsetof(Order, status), Order::hot_bytes);
+
+    // Cold tail starts on the second line.
+    EXPECT_GE(offsetof(Order, instrument_id), Order::hot_bytes);
+    EXPECT_GE(offsetof(Order, iceberg_slice_qty), Order::hot_bytes);
+    EXPECT_GE(offsetof(Order, timestamp), Order::hot_bytes);
 }
 
 TEST(OrderTest, MemcpySafe) {
@@ -128,7 +150,7 @@ TEST(TradeTest, IsStandardLayout) {
 }
 
 TEST(TradeTest, ExactSize) {
-    EXPECT_EQ(sizeof(Trade), 48u);
+    EXPECT_EQ(sizeof(Trade), 56u);
 }
 
 TEST(TradeTest, FieldValues) {
@@ -384,5 +406,54 @@ TEST(PriceLevelTest, QuantityTracksPartialFills) {
     EXPECT_TRUE(level.empty());
 }
 
+// ---------------------------------------------------------------------------
+// 128-bit products (uint128.h)
+// ---------------------------------------------------------------------------
+
+TEST(Uint128Test, LimbFallbackMatchesExactResults) {
+    constexpr uint64_t MAX = UINT64_MAX;
+    // floor(a * b / d) with a quotient that fits
+    EXPECT_EQ(detail::wide_mul_div(MAX, MAX, MAX), MAX);
+    EXPECT_EQ(detail::wide_mul_div(MAX - 1, MAX, MAX), MAX - 1);
+    EXPECT_EQ(detail::wide_mul_div(7, 5, 3), 11u);
+    EXPECT_EQ(detail::wide_mul_div(uint64_t{1} << 63, 6, 8), uint64_t{3} << 61);
+    const detail::Wide128 p = detail::wide_mul(MAX, MAX);  // 2^128 - 2^65 + 1
+    EXPECT_EQ(p.hi, MAX - 1);
+    EXPECT_EQ(p.lo, 1u);
+    EXPECT_TRUE(detail::wide_less(detail::wide_mul(MAX - 1, MAX), p));
+    // floor(a * b / d) > limit at the edges
+    EXPECT_TRUE(detail::wide_mul_div_exceeds(MAX, MAX, 1, MAX));
+    EXPECT_FALSE(detail::wide_mul_div_exceeds(MAX, 1, 1, MAX));
+    EXPECT_FALSE(detail::wide_mul_div_exceeds(MAX, MAX, MAX, MAX));
+    EXPECT_TRUE(detail::wide_mul_div_exceeds(10, 10, 3, 32));   // 33 > 32
+    EXPECT_FALSE(detail::wide_mul_div_exceeds(10, 10, 3, 33));
+}
+
+#if defined(HFT_HAS_UINT128)
+TEST(Uint128Test, LimbFallbackAgreesWithTheNativeType) {
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto next = [&x] {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+    for (int i = 0; i < 10000; ++i) {
+        const uint64_t a = next() >> (i % 64), b = next(), c = next() >> (i % 32);
+        const uint64_t d = (next() >> (i % 48)) | 1;
+        const uint128 p = static_cast<uint128>(a) * b;
+        const detail::Wide128 w = detail::wide_mul(a, b);
+        ASSERT_EQ(w.hi, static_cast<uint64_t>(p >> 64));
+        ASSERT_EQ(w.lo, static_cast<uint64_t>(p));
+        ASSERT_EQ(detail::wide_less(detail::wide_mul(c, d), w),
+                  static_cast<uint128>(c) * d < p);
+        ASSERT_EQ(detail::wide_mul_div_exceeds(a, b, d, c), p / d > c);
+        const uint64_t small = a % (d + 1);  // small <= d: the quotient fits
+        ASSERT_EQ(detail::wide_mul_div(small, b, d),
+                  static_cast<uint64_t>(static_cast<uint128>(small) * b / d));
+    }
+}
+#endif
+
 }  // namespace
 }  // namespace hft
@@ -2,13 +2,22 @@
 
 #include <algorithm>
 #include <atomic>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include "core/order.h"
 #include "core/types.h"
+#include "orderbook/direct_order_index.h"
+#include "orderbook/expiry_wheel.h"
 #include "orderbook/flat_order_map.h"
+#include "orderbook/level_bitmap.h"
+#include "orderbook/level_kernels.h"
 #include "orderbook/memory_pool.h"
 #include "orderbook/order_book.h"
+#include "orderbook/quote_snapshot.h"
+#include "orderbook/stop_book.h"
+#include "orderbook/tick_divider.h"
 
 namespace hft {
 namespace {
@@ -159,6 +168,566 @@ TEST(FlatOrderMapTest, Clear) {
     EXPECT_EQ(map.find(2), nullptr);
 }
 
+TEST(FlatOrderMapTest, MemoryUsageTracksPeakEntries) {
+    FlatOrderMap map(64);
+    MemoryUsage usage = map.memory_usage();
+    EXPECT_EQ(usage.reserved_bytes, map.capacity() * 16);  // 16-byte entries
+    EXPECT_LE(usage.touched_bytes, usage.reserved_bytes);
+    EXPECT_EQ(usage.high_water_bytes, 0u);
+
+    std::vector<Order> orders(10);
+    for (size_t i = 0; i < orders.size(); ++i) map.insert(i + 1, &orders[i]);
+    for (size_t i = 0; i < 5; ++i) map.erase(i + 1);
+    EXPECT_EQ(map.peak_size(), 10u);
+    EXPECT_EQ(map.memory_usage().high_water_bytes, 10 * 16u);
+    map.clear();
+    EXPECT_EQ(map.peak_size(), 10u);
+}
+
+TEST(FlatOrderMapTest, GroupModeBasicOperations) {
+    FlatOrderMap map(64, {}, OrderMapProbe::Group);
+    EXPECT_EQ(map.probe(), OrderMapProbe::Group);
+    Order a{}, b{};
+    EXPECT_TRUE(map.insert(1, &a));
+    EXPECT_TRUE(map.insert(2, &b));
+    EXPECT_FALSE(map.insert(1, &b));
+    EXPECT_FALSE(map.insert(0, &a));
+    EXPECT_EQ(map.find(1), &a);
+    EXPECT_EQ(map.find(2), &b);
+    EXPECT_EQ(map.find(3), nullptr);
+    EXPECT_EQ(map.size(), 2u);
+
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.erase(1));
+    EXPECT_EQ(map.find(1), nullptr);
+    EXPECT_EQ(map.tombstones(), 0u);  // Group was never full
+
+    map.clear();
+    EXPECT_EQ(map.size(), 0u);
+    EXPECT_EQ(map.find(2), nullptr);
+    EXPECT_TRUE(map.insert(2, &a));
+}
+
+TEST(FlatOrderMapTest, GroupModeChurnMatchesModel) {
+    // 32 slots = two groups. Run at 0.75 load (past the nominal 0.5) so
+    // groups fill and tombstones appear; the idle hook purges them now and
+    // then, and between its runs an insert short of room purges inline.
+    FlatOrderMap map(16, {}, OrderMapProbe::Group);
+    ASSERT_EQ(map.capacity(), 32u);
+
+    constexpr size_t KEYS = 256;
+    std::vector<Order> orders(KEYS);
+    std::vector<bool> live(KEYS, false);
+    size_t live_count = 0;
+    bool saw_tombstone = false;
+
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    for (int step = 0; step < 50000; ++step) {
+        size_t k = rnd() % KEYS;
+        OrderId id = static_cast<OrderId>(k * 7919 + 1);
+        if (live[k]) {
+            ASSERT_TRUE(map.erase(id));
+            live[k] = false;
+            --live_count;
+        } else if (live_count < 24) {
+            ASSERT_TRUE(map.insert(id, &orders[k]));
+            live[k] = true;
+            ++live_count;
+        }
+        saw_tombstone |= map.tombstones() > 0;
+        if (step % 64 == 0) {
+            (void)map.maintain();
+            ASSERT_LE(map.tombstones(), map.capacity() / 16);
+        }
+
+        if (step % 97 == 0) {
+            for (size_t j = 0; j < KEYS; ++j) {
+                OrderId jid = static_cast<OrderId>(j * 7919 + 1);
+                ASSERT_EQ(map.find(jid), live[j] ? &orders[j] : nullptr)
+                    << "step " << step << " key " << j;
+            }
+        }
+    }
+    EXPECT_EQ(map.size(), live_count);
+    EXPECT_TRUE(saw_tombstone);
+}
+
+TEST(FlatOrderMapTest, ErasesLeaveTombstonesForMaintain) {
+    FlatOrderMap map(64, {}, OrderMapProbe::Group);
+    ASSERT_EQ(map.capacity(), 128u);
+    constexpr size_t KEYS = 1024;
+    std::vector<Order> orders(KEYS);
+    std::vector<bool> live(KEYS, false);
+    std::vector<size_t> held;
+
+    // Churn at 0.75 load so erases hit full groups. No erase purges, so
+    // tombstones pile up past the 1/8 an inline purge used to allow.
+    uint64_t x = 0x853C49E6748FEA9Bull;
+    size_t k = 0;
+    for (int step = 0; step < 20000 && map.tombstones() <= map.capacity() / 8; ++step) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        if (held.size() < 96) {
+            k = (k + 1) % KEYS;
+            if (live[k]) continue;
+            ASSERT_TRUE(map.insert(k + 1, &orders[k]));
+            live[k] = true;
+            held.push_back(k);
+        } else {
+            const size_t pick = x % held.size();
+            ASSERT_TRUE(map.erase(held[pick] + 1));
+            live[held[pick]] = false;
+            held[pick] = held.back();
+            held.pop_back();
+        }
+    }
+    ASSERT_GT(map.tombstones(), map.capacity() / 8);
+
+    EXPECT_TRUE(map.maintain());
+    EXPECT_EQ(map.tombstones(), 0u);
+    EXPECT_FALSE(map.maintain());
+    for (size_t j = 0; j < KEYS; ++j) {
+        ASSERT_EQ(map.find(j + 1), live[j] ? &orders[j] : nullptr) << j;
+    }
+}
+
+TEST(FlatOrderMapTest, GroupModeBackedOrderBook) {
+    OrderBookOptions opts;
+    opts.order_map_probe = OrderMapProbe::Group;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+
+    std::vector<Order> orders(1000);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        orders[i] = make_order(i + 1, Side::Buy,
+                               50'000 * PRICE_SCALE - (i % 50) * TICK, 10);
+        ASSERT_TRUE(book.add_order(&orders[i]).success);
+    }
+    for (size_t i = 0; i < orders.size(); i += 2) {
+        ASSERT_TRUE(book.cancel_order(i + 1).success);
+    }
+    EXPECT_FALSE(book.cancel_order(1).success);
+    EXPECT_EQ(book.find_order(2), &orders[1]);
+    EXPECT_EQ(book.order_count(), 500u);
+}
+
+TEST(FlatOrderMapTest, FixedMapRejectsInsertWhenFull) {
+    FlatOrderMap map(8);
+    ASSERT_EQ(map.capacity(), 16u);
+    std::vector<Order> orders(16);
+    for (size_t i = 0; i < 15; ++i) {
+        ASSERT_TRUE(map.insert(i + 1, &orders[i]));
+    }
+    EXPECT_FALSE(map.insert(16, &orders[15]));  // One slot kept empty
+    EXPECT_EQ(map.find(99), nullptr);           // Probe still terminates
+    EXPECT_EQ(map.size(), 15u);
+}
+
+class GrowableOrderMapTest : public ::testing::TestWithParam<OrderMapProbe> {};
+
+TEST_P(GrowableOrderMapTest, ResizesIncrementallyUnderChurn) {
+    FlatOrderMap map(8, {}, GetParam(), /*growable=*/true);
+    const size_t initial_capacity = map.capacity();
+
+    constexpr size_t KEYS = 20000;
+    std::vector<Order> orders(KEYS);
+    std::vector<bool> live(KEYS, false);
+    size_t live_count = 0;
+    bool saw_resize = false;
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    // Mostly inserts, so the map doubles many times while erases and
+    // lookups keep landing in both the old and the new table.
+    for (int step = 0; step < 60000; ++step) {
+        size_t k = rnd() % KEYS;
+        OrderId id = static_cast<OrderId>(k + 1);
+        if (live[k] && (rnd() % 3 == 0)) {
+            ASSERT_TRUE(map.erase(id));
+            EXPECT_FALSE(map.erase(id));
+            live[k] = false;
+            --live_count;
+        } else if (!live[k]) {
+            ASSERT_TRUE(map.insert(id, &orders[k]));
+            live[k] = true;
+            ++live_count;
+        } else {
+            ASSERT_FALSE(map.insert(id, &orders[k]));  // Duplicate
+            ASSERT_EQ(map.find(id), &orders[k]);
+        }
+        saw_resize |= map.resizing();
+        ASSERT_EQ(map.size(), live_count);
+    }
+
+    for (size_t k = 0; k < KEYS; ++k) {
+        ASSERT_EQ(map.find(k + 1), live[k] ? &orders[k] : nullptr) << k;
+    }
+    EXPECT_TRUE(saw_resize);
+    EXPECT_GT(map.capacity(), initial_capacity);
+    EXPECT_LE(map.size(), map.capacity() / 2);
+}
+
+TEST_P(GrowableOrderMapTest, MaintainPreparesTheNextTableAndReleasesTheOld) {
+    FlatOrderMap map(64, {}, GetParam(), /*growable=*/true);
+    const size_t capacity = map.capacity();
+    std::vector<Order> orders(capacity);
+    OrderId id = 1;
+
+    // Below 3/8 load there is nothing to prepare
+    while (map.size() <= capacity / 8 * 3) {
+        EXPECT_FALSE(map.maintain());
+        ASSERT_TRUE(map.insert(id, &orders[id - 1]));
+        ++id;
+    }
+    EXPECT_TRUE(map.maintain());
+    ASSERT_TRUE(map.next_table_ready());
+    const size_t reserved = map.memory_usage().reserved_bytes;
+
+    // The switch at 1/2 load adopts the prepared table: nothing allocated
+    while (!map.resizing()) {
+        ASSERT_TRUE(map.insert(id, &orders[id - 1]));
+        ++id;
+    }
+    EXPECT_EQ(map.capacity(), capacity * 2);
+    EXPECT_FALSE(map.next_table_ready());
+    EXPECT_EQ(map.memory_usage().reserved_bytes, reserved);
+
+    // Nor is the drained table released by the erase that finishes it
+    while (map.resizing()) {
+        ASSERT_TRUE(map.erase(id - 1));
+        --id;
+    }
+    EXPECT_EQ(map.memory_usage().reserved_bytes, reserved);
+    EXPECT_TRUE(map.maintain());
+    EXPECT_LT(map.memory_usage().reserved_bytes, reserved);
+    for (OrderId k = 1; k < id; ++k) ASSERT_EQ(map.find(k), &orders[k - 1]) << k;
+}
+
+INSTANTIATE_TEST_SUITE_P(Probes, GrowableOrderMapTest,
+                         ::testing::Values(OrderMapProbe::Linear,
+                                           OrderMapProbe::Group));
+
+TEST(FlatOrderMapTest, GrowableBookAcceptsPastInitialSize) {
+    OrderBookOptions opts;
+    opts.order_map_growable = true;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 16, opts);
+
+    std::vector<Order> orders(5000);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        orders[i] = make_order(i + 1, Side::Sell,
+                               50'000 * PRICE_SCALE + (i % 100) * TICK, 1);
+        ASSERT_TRUE(book.add_order(&orders[i]).success) << i;
+    }
+    for (size_t i = 0; i < orders.size(); ++i) {
+        ASSERT_EQ(book.find_order(i + 1), &orders[i]);
+    }
+}
+
+// ===================================================================
+// TickDivider tests
+// ===================================================================
+
+TEST(TickDividerTest, MatchesHardwareDivision) {
+    const int64_t ticks[] = {1, 2, 3, 7, 1'000, 1'000'000, 1 << 20,
+                             PRICE_SCALE / 100, 12'345'678};
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (int64_t tick : ticks) {
+        const int64_t max_offset = 20'000 * PRICE_SCALE + tick;
+        TickDivider div(tick, max_offset);
+        const uint64_t d = static_cast<uint64_t>(tick);
+
+        // Edges around every multiple near both ends of the range.
+        for (uint64_t q = 0; q < 1000; ++q) {
+            for (uint64_t base : {q * d, static_cast<uint64_t>(max_offset) -
+                                             q * d}) {
+                for (uint64_t n : {base - 1, base, base + 1}) {
+                    if (n > static_cast<uint64_t>(max_offset)) continue;
+                    ASSERT_EQ(div.divide(n), n / d) << tick << " " << n;
+                }
+            }
+        }
+        for (int i = 0; i < 100000; ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            uint64_t n = x % (static_cast<uint64_t>(max_offset) + 1);
+            ASSERT_EQ(div.divide(n), n / d) << tick << " " << n;
+        }
+    }
+}
+
+TEST(TickDividerTest, BookRejectsOffTickPrices) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    EXPECT_TRUE(book.is_valid_price(MIN_PRICE));
+    EXPECT_TRUE(book.is_valid_price(MAX_PRICE));
+    EXPECT_TRUE(book.is_valid_price(MIN_PRICE + 1234 * TICK));
+    EXPECT_FALSE(book.is_valid_price(MIN_PRICE + 1234 * TICK + 1));
+    EXPECT_FALSE(book.is_valid_price(MIN_PRICE + TICK - 1));
+    EXPECT_FALSE(book.is_valid_price(MIN_PRICE - TICK));
+    EXPECT_FALSE(book.is_valid_price(MAX_PRICE + TICK));
+}
+
+// ===================================================================
+// DirectOrderIndex tests
+// ===================================================================
+
+TEST(DirectOrderIndexTest, InWindowInsertFindErase) {
+    FlatOrderMap fallback(64);
+    DirectOrderIndex index(4, fallback);
+    ASSERT_TRUE(index.enabled());
+    Order a{}, b{};
+
+    EXPECT_TRUE(index.insert(10'000, &a));
+    EXPECT_TRUE(index.insert(10'001, &b));
+    EXPECT_FALSE(index.insert(10'000, &b));  // Duplicate
+    EXPECT_FALSE(index.insert(0, &a));
+    EXPECT_EQ(index.find(10'000), &a);
+    EXPECT_EQ(index.find(10'001), &b);
+    EXPECT_EQ(index.find(10'002), nullptr);
+    EXPECT_EQ(fallback.size(), 0u);  // Nothing hashed
+
+    EXPECT_TRUE(index.erase(10'000));
+    EXPECT_FALSE(index.erase(10'000));
+    EXPECT_EQ(index.find(10'000), nullptr);
+}
+
+TEST(DirectOrderIndexTest, SlidingWindowSpillsRestingOrders) {
+    FlatOrderMap fallback(64);
+    DirectOrderIndex index(2, fallback);
+    constexpr OrderId PAGE = DirectOrderIndex::PAGE_SLOTS;
+    Order resting{}, fresh{};
+
+    ASSERT_TRUE(index.insert(1, &resting));
+    EXPECT_EQ(index.window_low(), 0u);
+    EXPECT_EQ(index.window_high(), 2 * PAGE);
+
+    // Two pages ahead: the page holding ID 1 is recycled into the map.
+    ASSERT_TRUE(index.insert(3 * PAGE + 5, &fresh));
+    EXPECT_EQ(index.window_low(), 2 * PAGE);
+    EXPECT_EQ(index.spilled(), 1u);
+    EXPECT_EQ(fallback.size(), 1u);
+    EXPECT_EQ(index.find(1), &resting);
+    EXPECT_EQ(index.find(3 * PAGE + 5), &fresh);
+
+    // Below-window IDs keep working through the fallback map.
+    EXPECT_FALSE(index.insert(1, &fresh));
+    EXPECT_TRUE(index.erase(1));
+    EXPECT_EQ(index.find(1), nullptr);
+    EXPECT_EQ(fallback.size(), 0u);
+}
+
+TEST(DirectOrderIndexTest, SlideRefusedWhileTheFallbackCannotTakeTheSpill) {
+    FlatOrderMap fallback(8);  // 16 slots: room for 15 keys
+    ASSERT_EQ(fallback.room(), 15u);
+    DirectOrderIndex index(1, fallback);
+    constexpr OrderId PAGE = DirectOrderIndex::PAGE_SLOTS;
+    std::vector<Order> resting(20);
+    Order fresh{};
+    for (OrderId id = 1; id <= 20; ++id) {
+        ASSERT_TRUE(index.insert(id, &resting[id - 1]));
+    }
+
+    // Sliding would spill 20 live orders into a map with room for 15: the
+    // insert fails and not one of them is lost
+    EXPECT_FALSE(index.insert(PAGE + 1, &fresh));
+    EXPECT_EQ(index.window_low(), 0u);
+    EXPECT_EQ(index.spilled(), 0u);
+    EXPECT_EQ(fallback.size(), 0u);
+    for (OrderId id = 1; id <= 20; ++id) {
+        ASSERT_EQ(index.find(id), &resting[id - 1]) << id;
+    }
+
+    for (OrderId id = 1; id <= 10; ++id) ASSERT_TRUE(index.erase(id));
+    ASSERT_TRUE(index.insert(PAGE + 1, &fresh));
+    EXPECT_EQ(index.spilled(), 10u);
+    EXPECT_EQ(fallback.size(), 10u);
+    for (OrderId id = 11; id <= 20; ++id) {
+        ASSERT_EQ(index.find(id), &resting[id - 1]) << id;
+        ASSERT_TRUE(index.erase(id)) << id;
+    }
+    EXPECT_EQ(index.find(PAGE + 1), &fresh);
+}
+
+TEST(DirectOrderIndexTest, IdsBelowAnchorUseFallback) {
+    FlatOrderMap fallback(64);
+    DirectOrderIndex index(2, fallback);
+    Order a{}, b{};
+    ASSERT_TRUE(index.insert(100'000, &a));
+    ASSERT_TRUE(index.insert(7, &b));
+    EXPECT_EQ(fallback.size(), 1u);
+    EXPECT_EQ(index.find(7), &b);
+    EXPECT_EQ(index.find(100'000), &a);
+}
+
+TEST(DirectOrderIndexTest, MatchesHashMapUnderDriftingIds) {
+    FlatOrderMap fallback(8192);
+    DirectOrderIndex index(4, fallback);
+    FlatOrderMap model(8192);
+
+    constexpr size_t N = 3000;
+    std::vector<Order> orders(N);
+    std::vector<OrderId> ids;
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    // Monotonic IDs with gaps; random cancels leave some orders resting
+    // long enough for their pages to be recycled.
+    OrderId next_id = 1;
+    for (int step = 0; step < 40000; ++step) {
+        if (!ids.empty() && rnd() % 3 == 0) {
+            size_t pick = rnd() % ids.size();
+            OrderId id = ids[pick];
+            ASSERT_EQ(index.erase(id), model.erase(id));
+            ids[pick] = ids.back();
+            ids.pop_back();
+        } else if (ids.size() < N) {
+            next_id += 1 + rnd() % 8;
+            Order* o = &orders[next_id % N];
+            ASSERT_TRUE(index.insert(next_id, o));
+            ASSERT_TRUE(model.insert(next_id, o));
+            ids.push_back(next_id);
+        }
+        if (step % 500 == 0) {
+            for (OrderId id = (next_id > 20000 ? next_id - 20000 : 1);
+                 id <= next_id; ++id) {
+                ASSERT_EQ(index.find(id), model.find(id)) << id;
+            }
+        }
+    }
+    EXPECT_GT(index.spilled(), 0u);
+}
+
+TEST(DirectOrderIndexTest, OrderBookWithDirectIndex) {
+    OrderBookOptions opts;
+    opts.direct_index_pages = 8;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+
+    std::vector<Order> orders(2000);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        orders[i] = make_order(1'000'000 + i, Side::Buy,
+                               50'000 * PRICE_SCALE - (i % 20) * TICK, 5);
+        ASSERT_TRUE(book.add_order(&orders[i]).success);
+    }
+    EXPECT_FALSE(book.add_order(&orders[0]).success);  // Duplicate ID
+    EXPECT_EQ(book.find_order(1'000'123), &orders[123]);
+    EXPECT_TRUE(book.cancel_order(1'000'123).success);
+    EXPECT_EQ(book.find_order(1'000'123), nullptr);
+    EXPECT_EQ(book.order_count(), 1999u);
+}
+
+// ===================================================================
+// LevelBitmap tests
+// ===================================================================
+
+TEST(LevelBitmapTest, EmptyFindsNothing) {
+    LevelBitmap bm(1000);
+    EXPECT_FALSE(bm.any());
+    EXPECT_EQ(bm.find_next(0), LevelBitmap::NPOS);
+    EXPECT_EQ(bm.find_prev(999), LevelBitmap::NPOS);
+}
+
+TEST(LevelBitmapTest, SetTestClear) {
+    LevelBitmap bm(1000);
+    bm.set(5);
+    bm.set(700);
+    EXPECT_TRUE(bm.test(5));
+    EXPECT_TRUE(bm.test(700));
+    EXPECT_FALSE(bm.test(6));
+    bm.clear(5);
+    EXPECT_FALSE(bm.test(5));
+    EXPECT_TRUE(bm.any());
+    bm.clear(700);
+    EXPECT_FALSE(bm.any());
+}
+
+TEST(LevelBitmapTest, FindNextAndPrevAcrossWords) {
+    LevelBitmap bm(200'001);  // Default BTC ladder: three layers
+    EXPECT_EQ(bm.num_layers(), 3u);
+    bm.set(3);
+    bm.set(100'000);
+    bm.set(200'000);
+
+    EXPECT_EQ(bm.find_next(0), 3u);
+    EXPECT_EQ(bm.find_next(3), 3u);
+    EXPECT_EQ(bm.find_next(4), 100'000u);
+    EXPECT_EQ(bm.find_next(100'001), 200'000u);
+    EXPECT_EQ(bm.find_next(200'001), LevelBitmap::NPOS);
+
+    EXPECT_EQ(bm.find_prev(200'000), 200'000u);
+    EXPECT_EQ(bm.find_prev(199'999), 100'000u);
+    EXPECT_EQ(bm.find_prev(99'999), 3u);
+    EXPECT_EQ(bm.find_prev(2), LevelBitmap::NPOS);
+}
+
+TEST(LevelBitmapTest, ClearKeepsSiblingsInSameWord) {
+    LevelBitmap bm(4096);
+    bm.set(128);
+    bm.set(130);
+    bm.clear(128);
+    EXPECT_EQ(bm.find_next(0), 130u);
+    EXPECT_EQ(bm.find_prev(4095), 130u);
+}
+
+TEST(LevelBitmapTest, WideTopLayerScansLinearly) {
+    // 64^4 bits need four layers; one more word forces a two-word top layer.
+    constexpr size_t N = 64ull * 64 * 64 * 64 + 64;
+    LevelBitmap bm(N);
+    EXPECT_EQ(bm.num_layers(), LevelBitmap::MAX_LAYERS);
+    bm.set(1);
+    bm.set(N - 1);
+    EXPECT_EQ(bm.find_next(2), N - 1);
+    EXPECT_EQ(bm.find_prev(N - 2), 1u);
+}
+
+TEST(LevelBitmapTest, MatchesNaiveScan) {
+    constexpr size_t N = 5000;
+    LevelBitmap bm(N);
+    std::vector<bool> ref(N, false);
+    uint64_t x = 88172645463325252ull;
+    for (int step = 0; step < 20000; ++step) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        size_t i = x % N;
+        if (ref[i]) {
+            bm.clear(i);
+            ref[i] = false;
+        } else {
+            bm.set(i);
+            ref[i] = true;
+        }
+        size_t q = (x >> 20) % N;
+        size_t expect_next = LevelBitmap::NPOS;
+        for (size_t j = q; j < N; ++j) {
+            if (ref[j]) { expect_next = j; break; }
+        }
+        size_t expect_prev = LevelBitmap::NPOS;
+        for (size_t j = q + 1; j-- > 0;) {
+            if (ref[j]) { expect_prev = j; break; }
+        }
+        ASSERT_EQ(bm.find_next(q), expect_next);
+        ASSERT_EQ(bm.find_prev(q), expect_prev);
+    }
+}
+
 // ===================================================================
 // OrderBook tests
 // ===================================================================
@@ -511,6 +1080,34 @@ TEST_F(OrderBookTest, ModifyQuantity) {
     EXPECT_EQ(o->visible_quantity, 200u);
 }
 
+TEST_F(OrderBookTest, ModifySizeDownAmendsInPlace) {
+    Price px = 50000 * PRICE_SCALE;
+    Order* o1 = alloc_order(1, Side::Buy, px, 100);
+    Order* o2 = alloc_order(2, Side::Buy, px, 100);
+    book_->add_order(o1);
+    book_->add_order(o2);
+
+    auto result = book_->modify_order(1, px, 40, 1000);
+    EXPECT_TRUE(result.success);
+    EXPECT_TRUE(result.in_place);
+    EXPECT_EQ(result.old_quantity, 100u);
+    EXPECT_EQ(o1->quantity, 40u);
+    EXPECT_EQ(o1->visible_quantity, 40u);
+    EXPECT_EQ(o1->timestamp, 1u);  // Priority time kept
+
+    // Still resting, still at the front of the queue
+    EXPECT_EQ(book_->find_order(1), o1);
+    EXPECT_EQ(book_->order_count(), 2u);
+    EXPECT_EQ(book_->best_bid()->front(), o1);
+    EXPECT_EQ(book_->best_bid()->total_quantity, 140u);
+
+    // Size-up at the same price detaches as before
+    auto up = book_->modify_order(1, px, 60, 1001);
+    EXPECT_TRUE(up.success);
+    EXPECT_FALSE(up.in_place);
+    EXPECT_EQ(book_->order_count(), 1u);
+}
+
 TEST_F(OrderBookTest, ModifyNotFound) {
     auto result = book_->modify_order(999, 50000 * PRICE_SCALE, 100, 1000);
     EXPECT_FALSE(result.success);
@@ -622,6 +1219,741 @@ TEST_F(OrderBookTest, ManyLevelsAndOrders) {
     EXPECT_EQ(book_->best_bid()->price, new_best_bid);
 }
 
+// --- Sparse book: bitmap-driven best recovery and depth ---
+
+TEST_F(OrderBookTest, BestRecoveryAcrossWideGap) {
+    // Touch levels far apart: emptying the touch must jump the whole gap.
+    Price far_bid = MIN_PRICE + TICK;
+    Price near_bid = 49'999 * PRICE_SCALE;
+    Price near_ask = 50'001 * PRICE_SCALE;
+    Price far_ask = MAX_PRICE - TICK;
+
+    ASSERT_TRUE(book_->add_order(alloc_order(1, Side::Buy, far_bid, 10)).success);
+    ASSERT_TRUE(book_->add_order(alloc_order(2, Side::Buy, near_bid, 10)).success);
+    ASSERT_TRUE(book_->add_order(alloc_order(3, Side::Sell, near_ask, 10)).success);
+    ASSERT_TRUE(book_->add_order(alloc_order(4, Side::Sell, far_ask, 10)).success);
+
+    book_->cancel_order(2);
+    ASSERT_NE(book_->best_bid(), nullptr);
+    EXPECT_EQ(book_->best_bid()->price, far_bid);
+
+    book_->cancel_order(3);
+    ASSERT_NE(book_->best_ask(), nullptr);
+    EXPECT_EQ(book_->best_ask()->price, far_ask);
+
+    book_->cancel_order(1);
+    book_->cancel_order(4);
+    EXPECT_EQ(book_->best_bid(), nullptr);
+    EXPECT_EQ(book_->best_ask(), nullptr);
+}
+
+TEST_F(OrderBookTest, DepthSkipsEmptyTicks) {
+    OrderId id = 1;
+    for (int i = 0; i < 5; ++i) {
+        Price off = static_cast<Price>(i) * 1000 * TICK;
+        book_->add_order(alloc_order(id++, Side::Buy, 49'000 * PRICE_SCALE - off, 10 + i));
+        book_->add_order(alloc_order(id++, Side::Sell, 51'000 * PRICE_SCALE + off, 20 + i));
+    }
+
+    DepthEntry bids[8];
+    DepthEntry asks[8];
+    ASSERT_EQ(book_->get_bid_depth(bids, 8), 5u);
+    ASSERT_EQ(book_->get_ask_depth(asks, 8), 5u);
+    for (size_t i = 0; i < 5; ++i) {
+        Price off = static_cast<Price>(i) * 1000 * TICK;
+        EXPECT_EQ(bids[i].price, 49'000 * PRICE_SCALE - off);
+        EXPECT_EQ(bids[i].quantity, 10u + i);
+        EXPECT_EQ(asks[i].price, 51'000 * PRICE_SCALE + off);
+        EXPECT_EQ(asks[i].quantity, 20u + i);
+    }
+
+    // Truncated depth stops at max_levels.
+    EXPECT_EQ(book_->get_ask_depth(asks, 2), 2u);
+}
+
+TEST_F(OrderBookTest, AvailableQuantitySkipsEmptyTicks) {
+    book_->add_order(alloc_order(1, Side::Sell, 50'000 * PRICE_SCALE, 10));
+    book_->add_order(alloc_order(2, Side::Sell, 50'500 * PRICE_SCALE, 20));
+    book_->add_order(alloc_order(3, Side::Sell, 55'000 * PRICE_SCALE, 40));
+    book_->add_order(alloc_order(4, Side::Buy, 49'000 * PRICE_SCALE, 5));
+    book_->add_order(alloc_order(5, Side::Buy, 45'000 * PRICE_SCALE, 7));
+
+    EXPECT_EQ(book_->available_quantity(Side::Sell, 50'500 * PRICE_SCALE), 30u);
+    EXPECT_EQ(book_->available_quantity(Side::Sell, MAX_PRICE), 70u);
+    EXPECT_EQ(book_->available_quantity(Side::Sell, 49'999 * PRICE_SCALE), 0u);
+    EXPECT_EQ(book_->available_quantity(Side::Buy, 45'000 * PRICE_SCALE), 12u);
+    EXPECT_EQ(book_->available_quantity(Side::Buy, 45'001 * PRICE_SCALE), 5u);
+    EXPECT_EQ(book_->available_quantity(Side::Buy, MIN_PRICE), 12u);
+}
+
+// ===================================================================
+// Windowed ladder mode
+// ===================================================================
+
+TEST(WindowedOrderBookTest, WideRangeAllocatesOnlyWindow) {
+    // 10^8 ticks would need ~8 GB as a flat ladder.
+    OrderBookOptions opts;
+    opts.window_levels = 1000;  // Rounded up to 1024
+    OrderBook book(TICK, 1'000'000 * PRICE_SCALE, TICK, MAX_ORDERS, opts);
+    EXPECT_EQ(book.window_levels(), 1024u);
+    EXPECT_EQ(book.num_levels(), 100'000'000u);
+
+    Order bid = make_order(1, Side::Buy, 50'000 * PRICE_SCALE, 10);
+    Order ask = make_order(2, Side::Sell, 50'001 * PRICE_SCALE, 20);
+    ASSERT_TRUE(book.add_order(&bid).success);
+    ASSERT_TRUE(book.add_order(&ask).success);
+
+    // Initial window sits mid-range, so both levels start in overflow.
+    EXPECT_EQ(book.overflow_level_count(Side::Buy), 1u);
+    EXPECT_EQ(book.overflow_level_count(Side::Sell), 1u);
+    EXPECT_EQ(book.best_bid()->price, 50'000 * PRICE_SCALE);
+    EXPECT_EQ(book.best_ask()->total_quantity, 20u);
+
+    // Recentering pulls them into the ring; the touch stays where it was.
+    EXPECT_TRUE(book.maybe_recenter());
+    EXPECT_EQ(book.overflow_level_count(Side::Buy), 0u);
+    EXPECT_EQ(book.overflow_level_count(Side::Sell), 0u);
+    EXPECT_LE(book.window_low(), 50'000 * PRICE_SCALE);
+    EXPECT_EQ(book.best_bid()->price, 50'000 * PRICE_SCALE);
+    EXPECT_EQ(book.best_ask()->price, 50'001 * PRICE_SCALE);
+    EXPECT_FALSE(book.maybe_recenter());  // Already centred
+
+    book.cancel_order(1);
+    book.cancel_order(2);
+    EXPECT_TRUE(book.empty());
+    EXPECT_EQ(book.best_bid(), nullptr);
+}
+
+TEST(WindowedOrderBookTest, TrendingMarketMovesWindow) {
+    OrderBookOptions opts;
+    opts.window_levels = 256;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    std::vector<Order> orders(400);
+
+    // Bid ladder walking upward one tick at a time, far beyond one window.
+    Price px = 45'000 * PRICE_SCALE;
+    for (size_t i = 0; i < orders.size(); ++i) {
+        orders[i] = make_order(i + 1, Side::Buy, px + static_cast<Price>(i) * TICK, 1);
+        ASSERT_TRUE(book.add_order(&orders[i]).success);
+        book.maybe_recenter();
+    }
+
+    Price top = px + 399 * TICK;
+    EXPECT_EQ(book.best_bid()->price, top);
+    EXPECT_GT(book.overflow_level_count(Side::Buy), 0u);  // Trailing levels parked
+    EXPECT_GE(top, book.window_low());
+
+    // Depth merges ring and overflow in price order.
+    DepthEntry depth[400];
+    ASSERT_EQ(book.get_bid_depth(depth, 400), 400u);
+    for (size_t i = 0; i < 400; ++i) {
+        EXPECT_EQ(depth[i].price, top - static_cast<Price>(i) * TICK);
+    }
+    EXPECT_EQ(book.available_quantity(Side::Buy, px), 400u);
+
+    // Unwind from the top: best recovery crosses back into overflow levels.
+    for (size_t i = orders.size(); i > 1; --i) {
+        book.cancel_order(i);
+        ASSERT_EQ(book.best_bid()->price, px + static_cast<Price>(i - 2) * TICK);
+    }
+}
+
+TEST(WindowedOrderBookTest, OverflowFullRejectsAdd) {
+    OrderBookOptions opts;
+    opts.window_levels = 64;
+    opts.overflow_levels = 2;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+
+    Order a = make_order(1, Side::Sell, 41'000 * PRICE_SCALE, 1);
+    Order b = make_order(2, Side::Sell, 42'000 * PRICE_SCALE, 1);
+    Order c = make_order(3, Side::Sell, 43'000 * PRICE_SCALE, 1);
+    Order d = make_order(4, Side::Sell, 42'000 * PRICE_SCALE, 1);
+    EXPECT_TRUE(book.add_order(&a).success);
+    EXPECT_TRUE(book.add_order(&b).success);
+    EXPECT_FALSE(book.add_order(&c).success);
+    EXPECT_EQ(book.find_order(3), nullptr);
+    EXPECT_TRUE(book.add_order(&d).success);  // Existing overflow level
+
+    // Recentering on the 41,000 touch pulls it into the ring, freeing room.
+    EXPECT_TRUE(book.maybe_recenter());
+    EXPECT_EQ(book.overflow_level_count(Side::Sell), 1u);
+    EXPECT_TRUE(book.add_order(&c).success);
+}
+
+TEST(WindowedOrderBookTest, MatchesFlatBookUnderRandomFlow) {
+    OrderBookOptions opts;
+    opts.window_levels = 128;
+    opts.overflow_levels = 4096;
+    OrderBook flat(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    OrderBook windowed(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+
+    constexpr size_t N = 2000;
+    std::vector<Order> flat_orders(N);
+    std::vector<Order> win_orders(N);
+    std::vector<bool> live(N, false);
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    Price mid = 50'000 * PRICE_SCALE;
+    for (int step = 0; step < 20000; ++step) {
+        size_t slot = rnd() % N;
+        OrderId id = slot + 1;
+        if (live[slot]) {
+            ASSERT_TRUE(flat.cancel_order(id).success);
+            ASSERT_TRUE(windowed.cancel_order(id).success);
+            live[slot] = false;
+        } else {
+            // Drifting mid, mostly near-touch, occasionally far away.
+            if (step % 50 == 0) mid += static_cast<Price>(rnd() % 21) * TICK - 10 * TICK;
+            bool buy = rnd() & 1;
+            Price dist = (rnd() % 16 == 0) ? static_cast<Price>(rnd() % 5000)
+                                           : static_cast<Price>(rnd() % 60);
+            Price px = buy ? mid - (dist + 1) * TICK : mid + (dist + 1) * TICK;
+            Quantity qty = rnd() % 100 + 1;
+            flat_orders[slot] = make_order(id, buy ? Side::Buy : Side::Sell, px, qty);
+            win_orders[slot] = flat_orders[slot];
+            ASSERT_TRUE(flat.add_order(&flat_orders[slot]).success);
+            ASSERT_TRUE(windowed.add_order(&win_orders[slot]).success);
+            live[slot] = true;
+        }
+        if (step % 7 == 0) windowed.maybe_recenter();
+
+        ASSERT_EQ(flat.spread(), windowed.spread());
+        ASSERT_EQ(flat.mid_price(), windowed.mid_price());
+        if (step % 97 == 0) {
+            DepthEntry a[20], b[20];
+            size_t na = flat.get_bid_depth(a, 20);
+            ASSERT_EQ(na, windowed.get_bid_depth(b, 20));
+            for (size_t i = 0; i < na; ++i) {
+                ASSERT_EQ(a[i].price, b[i].price);
+                ASSERT_EQ(a[i].quantity, b[i].quantity);
+            }
+            na = flat.get_ask_depth(a, 20);
+            ASSERT_EQ(na, windowed.get_ask_depth(b, 20));
+            for (size_t i = 0; i < na; ++i) {
+                ASSERT_EQ(a[i].price, b[i].price);
+                ASSERT_EQ(a[i].order_count, b[i].order_count);
+            }
+            ASSERT_EQ(flat.available_quantity(Side::Sell, mid + 100 * TICK),
+                      windowed.available_quantity(Side::Sell, mid + 100 * TICK));
+            ASSERT_EQ(flat.available_quantity(Side::Buy, mid - 3000 * TICK),
+                      windowed.available_quantity(Side::Buy, mid - 3000 * TICK));
+        }
+    }
+}
+
+// ===================================================================
+// Dense level stats and SIMD kernels
+// ===================================================================
+
+TEST(LevelKernelsTest, SumMatchesScalarForAllLengthsAndOffsets) {
+    std::vector<Quantity> qty(200);
+    for (size_t i = 0; i < qty.size(); ++i) qty[i] = (i * 2654435761u) % 1000;
+
+    for (size_t off = 0; off < 8; ++off) {
+        for (size_t n = 0; n + off <= 150; ++n) {
+            Quantity expect = 0;
+            for (size_t i = 0; i < n; ++i) expect += qty[off + i];
+            ASSERT_EQ(sum_quantities(qty.data() + off, n), expect)
+                << "off=" << off << " n=" << n << " isa=" << level_kernel_isa();
+        }
+    }
+}
+
+TEST(DenseLevelStatsTest, IgnoredInWindowedMode) {
+    OrderBookOptions opts;
+    opts.dense_level_stats = true;
+    OrderBook flat(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    EXPECT_TRUE(flat.dense_level_stats());
+
+    opts.window_levels = 256;
+    OrderBook windowed(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    EXPECT_FALSE(windowed.dense_level_stats());
+}
+
+TEST(DenseLevelStatsTest, MatchesPlainBookUnderRandomFlow) {
+    OrderBookOptions opts;
+    opts.dense_level_stats = true;
+    OrderBook plain(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    OrderBook dense(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+
+    constexpr size_t N = 2000;
+    std::vector<Order> plain_orders(N);
+    std::vector<Order> dense_orders(N);
+    std::vector<bool> live(N, false);
+
+    uint64_t x = 0x2545F4914F6CDD1Dull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    Price mid = 50'000 * PRICE_SCALE;
+    for (int step = 0; step < 20000; ++step) {
+        size_t slot = rnd() % N;
+        OrderId id = slot + 1;
+        if (live[slot]) {
+            ASSERT_TRUE(plain.cancel_order(id).success);
+            ASSERT_TRUE(dense.cancel_order(id).success);
+            live[slot] = false;
+        } else {
+            bool buy = rnd() & 1;
+            Price dist = static_cast<Price>(rnd() % 300);
+            Price px = buy ? mid - (dist + 1) * TICK : mid + (dist + 1) * TICK;
+            Quantity qty = rnd() % 100 + 1;
+            plain_orders[slot] = make_order(id, buy ? Side::Buy : Side::Sell, px, qty);
+            dense_orders[slot] = plain_orders[slot];
+            ASSERT_TRUE(plain.add_order(&plain_orders[slot]).success);
+            ASSERT_TRUE(dense.add_order(&dense_orders[slot]).success);
+            live[slot] = true;
+        }
+
+        if (step % 53 == 0) {
+            DepthEntry a[10], b[10];
+            size_t n = plain.get_bid_depth(a, 10);
+            ASSERT_EQ(n, dense.get_bid_depth(b, 10));
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(a[i].price, b[i].price);
+                ASSERT_EQ(a[i].quantity, b[i].quantity);
+                ASSERT_EQ(a[i].order_count, b[i].order_count);
+            }
+            n = plain.get_ask_depth(a, 10);
+            ASSERT_EQ(n, dense.get_ask_depth(b, 10));
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(a[i].price, b[i].price);
+                ASSERT_EQ(a[i].quantity, b[i].quantity);
+                ASSERT_EQ(a[i].order_count, b[i].order_count);
+            }
+            Price reach = static_cast<Price>(rnd() % 400) * TICK;
+            ASSERT_EQ(plain.available_quantity(Side::Sell, mid + reach),
+                      dense.available_quantity(Side::Sell, mid + reach));
+            ASSERT_EQ(plain.available_quantity(Side::Buy, mid - reach),
+                      dense.available_quantity(Side::Buy, mid - reach));
+        }
+    }
+}
+
+TEST(DenseLevelStatsTest, ReduceLevelQuantityKeepsArraysInStep) {
+    OrderBookOptions opts;
+    opts.dense_level_stats = true;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    Order o = make_order(1, Side::Sell, 50'000 * PRICE_SCALE, 100);
+    ASSERT_TRUE(book.add_order(&o).success);
+
+    PriceLevel* level = book.best_ask_level();
+    o.filled_quantity += 30;
+    book.reduce_level_quantity(level, o, 30);
+
+    DepthEntry d[1];
+    ASSERT_EQ(book.get_ask_depth(d, 1), 1u);
+    EXPECT_EQ(d[0].quantity, 70u);
+    EXPECT_EQ(book.available_quantity(Side::Sell, MAX_PRICE), 70u);
+}
+
+// ===================================================================
+// StopBook
+// ===================================================================
+
+Order make_stop(OrderId id, Side side, Price stop_price, Quantity qty) {
+    Order o = make_order(id, side, 0, qty);
+    o.type = OrderType::Stop;
+    o.stop_price = stop_price;
+    return o;
+}
+
+TEST(StopBookTest, ElectsOnlyCrossedLevelsInOrder) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    StopBook stops(book, MAX_ORDERS);
+    constexpr Price MID = 50'000 * PRICE_SCALE;
+
+    Order buys[3] = {make_stop(1, Side::Buy, MID + 2 * TICK, 10),
+                     make_stop(2, Side::Buy, MID + TICK, 10),
+                     make_stop(3, Side::Buy, MID + 5 * TICK, 10)};
+    Order sells[2] = {make_stop(4, Side::Sell, MID - TICK, 10),
+                      make_stop(5, Side::Sell, MID - 3 * TICK, 10)};
+    for (Order& o : buys) ASSERT_TRUE(stops.add(&o));
+    for (Order& o : sells) ASSERT_TRUE(stops.add(&o));
+    EXPECT_EQ(stops.lowest_buy_stop(), MID + TICK);
+    EXPECT_EQ(stops.highest_sell_stop(), MID - TICK);
+
+    // Trades printed over [MID - TICK, MID + 2 * TICK]
+    EXPECT_EQ(stops.elect(MID - TICK, MID + 2 * TICK), 3u);
+    EXPECT_EQ(stops.elected_count(), 3u);
+    EXPECT_EQ(stops.size(), 5u);
+
+    Order* o = stops.pop_elected();
+    ASSERT_NE(o, nullptr);
+    EXPECT_EQ(o->order_id, 2u);  // Lowest buy trigger first
+    EXPECT_EQ(o->type, OrderType::Market);
+    EXPECT_EQ(stops.pop_elected()->order_id, 1u);
+    EXPECT_EQ(stops.pop_elected()->order_id, 4u);  // Then sells, highest first
+    EXPECT_EQ(stops.pop_elected(), nullptr);
+
+    EXPECT_EQ(stops.size(), 2u);
+    EXPECT_EQ(stops.lowest_buy_stop(), MID + 5 * TICK);
+    EXPECT_EQ(stops.highest_sell_stop(), MID - 3 * TICK);
+}
+
+TEST(StopBookTest, CancelRestingAndElected) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    StopBook stops(book, MAX_ORDERS);
+    constexpr Price MID = 50'000 * PRICE_SCALE;
+
+    Order a = make_stop(1, Side::Buy, MID, 10);
+    Order b = make_stop(2, Side::Buy, MID, 10);
+    b.type = OrderType::StopLimit;
+    b.price = MID + TICK;
+    Order bad = make_stop(3, Side::Sell, MID + 1, 10);  // Not tick-aligned
+    ASSERT_TRUE(stops.add(&a));
+    ASSERT_TRUE(stops.add(&b));
+    EXPECT_FALSE(stops.add(&bad));
+    EXPECT_FALSE(stops.add(&a));  // Duplicate
+
+    EXPECT_EQ(stops.cancel(1), &a);
+    EXPECT_EQ(stops.cancel(1), nullptr);
+
+    EXPECT_EQ(stops.elect(MID, MID), 1u);
+    EXPECT_EQ(b.type, OrderType::Limit);
+    EXPECT_EQ(stops.cancel(2), &b);  // Elected, not yet released
+    EXPECT_EQ(stops.elected_count(), 0u);
+    EXPECT_EQ(stops.pop_elected(), nullptr);
+    EXPECT_EQ(stops.lowest_buy_stop(), 0);
+}
+
+// ===================================================================
+// Participant lists
+// ===================================================================
+
+TEST_F(OrderBookTest, ParticipantListsTrackRestingOrders) {
+    Order* a = alloc_order(1, Side::Buy, 49'999 * PRICE_SCALE, 10);
+    Order* b = alloc_order(2, Side::Sell, 50'001 * PRICE_SCALE, 10);
+    Order* c = alloc_order(3, Side::Buy, 49'998 * PRICE_SCALE, 10);
+    b->participant_id = 7;
+    ASSERT_TRUE(book_->add_order(a).success);
+    ASSERT_TRUE(book_->add_order(b).success);
+    ASSERT_TRUE(book_->add_order(c).success);
+
+    EXPECT_EQ(book_->participants().count(1), 2u);
+    EXPECT_EQ(book_->participant_head(1), a);
+    EXPECT_EQ(a->participant_next, c);
+    EXPECT_EQ(book_->participant_head(7), b);
+    EXPECT_EQ(book_->participant_head(9), nullptr);
+
+    ASSERT_TRUE(book_->cancel_order(1).success);
+    EXPECT_EQ(book_->participant_head(1), c);
+    EXPECT_EQ(c->participant_prev, nullptr);
+    EXPECT_EQ(book_->participants().count(1), 1u);
+}
+
+TEST(ParticipantIndexTest, FullTableRejectsNewParticipant) {
+    OrderBookOptions opts;
+    opts.max_participants = 2;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    constexpr Price PX = 50'000 * PRICE_SCALE;
+
+    Order orders[4] = {make_order(1, Side::Buy, PX, 10),
+                       make_order(2, Side::Buy, PX, 10),
+                       make_order(3, Side::Buy, PX, 10),
+                       make_order(4, Side::Buy, PX, 10)};
+    orders[1].participant_id = 2;
+    orders[2].participant_id = 3;
+    orders[3].participant_id = 2;
+    ASSERT_TRUE(book.add_order(&orders[0]).success);
+    ASSERT_TRUE(book.add_order(&orders[1]).success);
+    EXPECT_FALSE(book.add_order(&orders[2]).success);  // Third participant
+    EXPECT_TRUE(book.add_order(&orders[3]).success);   // Known participant
+
+    EXPECT_EQ(book.order_count(), 3u);
+    EXPECT_EQ(book.find_order(3), nullptr);
+    EXPECT_EQ(book.best_bid_level()->order_count, 3u);
+
+    // Disabled lists accept any participant
+    opts.max_participants = 0;
+    OrderBook off(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    Order o = make_order(5, Side::Buy, PX, 10);
+    EXPECT_TRUE(off.add_order(&o).success);
+    EXPECT_EQ(off.participant_head(1), nullptr);
+}
+
+// ===================================================================
+// Level deltas
+// ===================================================================
+
+TEST(LevelDeltaTest, EveryModeRecordsEachChange) {
+    OrderBookOptions opts;
+    opts.level_deltas = LevelDeltaMode::Every;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    constexpr Price PX = 50'000 * PRICE_SCALE;
+
+    Order a = make_order(1, Side::Buy, PX, 10);
+    Order b = make_order(2, Side::Buy, PX, 5);
+    ASSERT_TRUE(book.add_order(&a).success);
+    ASSERT_TRUE(book.add_order(&b).success);
+    book.reduce_level_quantity(book.best_bid_level(), a, 3);
+    ASSERT_TRUE(book.cancel_order(1).success);
+    ASSERT_EQ(book.pending_level_deltas(), 4u);
+
+    LevelDelta out[8];
+    ASSERT_EQ(book.take_level_deltas(out, 2), 2u);  // Oldest first
+    EXPECT_EQ(out[0].price, PX);
+    EXPECT_EQ(out[0].side, Side::Buy);
+    EXPECT_EQ(out[0].total_quantity, 10u);
+    EXPECT_EQ(out[0].order_count, 1u);
+    EXPECT_EQ(out[1].total_quantity, 15u);
+    EXPECT_EQ(out[1].order_count, 2u);
+
+    ASSERT_EQ(book.take_level_deltas(out, 8), 2u);
+    EXPECT_EQ(out[0].total_quantity, 12u);
+    EXPECT_EQ(out[1].total_quantity, 2u);
+    EXPECT_EQ(out[1].order_count, 1u);
+    EXPECT_EQ(book.take_level_deltas(out, 8), 0u);
+
+    // Off by default
+    OrderBook off(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    Order c = make_order(3, Side::Sell, PX, 10);
+    ASSERT_TRUE(off.add_order(&c).success);
+    EXPECT_EQ(off.take_level_deltas(out, 8), 0u);
+}
+
+TEST(LevelDeltaTest, ConflatedModeKeepsOneFinalStatePerLevel) {
+    OrderBookOptions opts;
+    opts.level_deltas = LevelDeltaMode::Conflated;
+    opts.level_delta_capacity = 2;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    constexpr Price PX = 50'000 * PRICE_SCALE;
+
+    Order orders[4] = {make_order(1, Side::Buy, PX, 10),
+                       make_order(2, Side::Buy, PX, 20),
+                       make_order(3, Side::Sell, PX + TICK, 7),
+                       make_order(4, Side::Sell, PX + 2 * TICK, 1)};
+    for (Order& o : orders) ASSERT_TRUE(book.add_order(&o).success);
+    ASSERT_TRUE(book.cancel_order(3).success);  // Ask level now gone
+
+    // Two levels fit; the third is dropped, repeats are not
+    EXPECT_EQ(book.pending_level_deltas(), 2u);
+    EXPECT_EQ(book.dropped_level_deltas(), 1u);
+
+    LevelDelta out[4];
+    ASSERT_EQ(book.take_level_deltas(out, 4), 2u);
+    EXPECT_EQ(out[0].side, Side::Buy);
+    EXPECT_EQ(out[0].total_quantity, 30u);
+    EXPECT_EQ(out[0].order_count, 2u);
+    EXPECT_EQ(out[1].side, Side::Sell);
+    EXPECT_EQ(out[1].price, PX + TICK);
+    EXPECT_EQ(out[1].total_quantity, 0u);
+    EXPECT_EQ(out[1].order_count, 0u);
+
+    // Taken levels are journalled afresh
+    ASSERT_TRUE(book.cancel_order(2).success);
+    ASSERT_EQ(book.take_level_deltas(out, 4), 1u);
+    EXPECT_EQ(out[0].total_quantity, 10u);
+}
+
+// ===================================================================
+// ExpiryWheel
+// ===================================================================
+
+TEST(ExpiryWheelTest, FiresInExpiryOrderAcrossLevels) {
+    constexpr Timestamp MS = 1'000'000;
+    ExpiryWheel wheel(64, MS);
+    // Spread over several wheel levels, armed out of order
+    ASSERT_TRUE(wheel.schedule(1, 5 * MS));
+    ASSERT_TRUE(wheel.schedule(2, 1 * MS));
+    ASSERT_TRUE(wheel.schedule(3, 70 * MS));
+    ASSERT_TRUE(wheel.schedule(4, 5'000 * MS));
+    ASSERT_TRUE(wheel.schedule(5, 3 * 3'600'000 * MS));
+    ASSERT_TRUE(wheel.schedule(6, 5 * MS + 1));  // Rounds up to the 6 ms tick
+
+    OrderId id;
+    Timestamp at;
+    EXPECT_FALSE(wheel.due(MS - 1));
+    EXPECT_FALSE(wheel.pop_expired(MS - 1, id, at));
+
+    ASSERT_TRUE(wheel.pop_expired(5 * MS, id, at));
+    EXPECT_EQ(id, 2u);
+    ASSERT_TRUE(wheel.pop_expired(5 * MS, id, at));
+    EXPECT_EQ(id, 1u);
+    EXPECT_EQ(at, 5 * MS);
+    EXPECT_FALSE(wheel.pop_expired(5 * MS + 1, id, at));  // Never early
+
+    // One long jump releases the rest in tick order
+    std::vector<OrderId> fired;
+    while (wheel.pop_expired(4 * 3'600'000 * MS, id, at)) fired.push_back(id);
+    EXPECT_EQ(fired, (std::vector<OrderId>{6, 3, 4, 5}));
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_FALSE(wheel.due(5 * 3'600'000 * MS));
+}
+
+TEST(ExpiryWheelTest, MatchesSortedModelUnderRandomFlow) {
+    constexpr Timestamp TICK_NS = 1'000;
+    ExpiryWheel wheel(4096, TICK_NS);
+    std::vector<std::pair<uint64_t, OrderId>> pending;  // (tick, id)
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto rnd = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    };
+
+    Timestamp now = 0;
+    OrderId next_id = 1;
+    for (int step = 0; step < 200; ++step) {
+        for (int i = 0; i < 15; ++i) {
+            // Horizons from a few ticks to millions of ticks
+            Timestamp horizon = (rnd() % 64 + 1) << (rnd() % 26);
+            Timestamp at = now + horizon;
+            ASSERT_TRUE(wheel.schedule(next_id, at));
+            pending.emplace_back((at + TICK_NS - 1) / TICK_NS, next_id++);
+        }
+        now += (rnd() % 4 == 0) ? (rnd() % (TICK_NS << 22)) : rnd() % (TICK_NS * 64);
+
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        OrderId id;
+        Timestamp at;
+        std::vector<uint64_t> fired_ticks;
+        std::vector<OrderId> fired;
+        while (wheel.pop_expired(now, id, at)) {
+            fired.push_back(id);
+            fired_ticks.push_back((at + TICK_NS - 1) / TICK_NS);
+        }
+        size_t due = 0;
+        while (due < pending.size() && pending[due].first <= now / TICK_NS) ++due;
+        ASSERT_EQ(fired.size(), due) << "step " << step;
+        EXPECT_TRUE(std::is_sorted(fired_ticks.begin(), fired_ticks.end()));
+        std::vector<OrderId> expect;
+        for (size_t i = 0; i < due; ++i) expect.push_back(pending[i].second);
+        std::sort(fired.begin(), fired.end());
+        std::sort(expect.begin(), expect.end());
+        ASSERT_EQ(fired, expect) << "step " << step;
+        pending.erase(pending.begin(), pending.begin() + static_cast<ptrdiff_t>(due));
+        ASSERT_EQ(wheel.size(), pending.size());
+    }
+}
+
+TEST(ExpiryWheelTest, PurgeFreesStaleTimers) {
+    ExpiryWheel wheel(4, 1);
+    for (OrderId id = 1; id <= 4; ++id) {
+        ASSERT_TRUE(wheel.schedule(id, 100 * id));
+    }
+    EXPECT_TRUE(wheel.full());
+    EXPECT_FALSE(wheel.schedule(5, 50));
+
+    // Only even IDs are still live
+    auto live = [](void*, OrderId id, Timestamp) noexcept { return id % 2 == 0; };
+    EXPECT_EQ(wheel.purge(live, nullptr), 2u);
+    EXPECT_EQ(wheel.size(), 2u);
+    ASSERT_TRUE(wheel.schedule(5, 50));
+
+    OrderId id;
+    Timestamp at;
+    std::vector<OrderId> fired;
+    while (wheel.pop_expired(1'000, id, at)) fired.push_back(id);
+    EXPECT_EQ(fired, (std::vector<OrderId>{5, 2, 4}));
+}
+
+// ===================================================================
+// QuoteSnapshotSlot tests
+// ===================================================================
+
+TEST(QuoteSnapshotTest, PublishesOnlyChangedStates) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    MemoryPool<Order> pool(MAX_ORDERS);
+    QuoteSnapshotSlot slot;
+    QuoteSnapshot snap{};
+    EXPECT_FALSE(slot.read(snap));
+
+    const Price mid = 50'000 * PRICE_SCALE;
+    for (OrderId id = 1; id <= 12; ++id) {
+        Order* o = pool.allocate();
+        *o = make_order(id, Side::Buy, mid - static_cast<Price>(id) * TICK, 10 * id);
+        book.add_order(o);
+    }
+    Order* ask = pool.allocate();
+    *ask = make_order(100, Side::Sell, mid + TICK, 7);
+    book.add_order(ask);
+
+    EXPECT_TRUE(slot.publish(book, 0));
+    EXPECT_FALSE(slot.publish(book, 0));  // Unchanged: readers keep their lines
+    EXPECT_EQ(slot.version(), 2u);
+
+    ASSERT_TRUE(slot.read(snap));
+    EXPECT_EQ(snap.publish_count, 1u);
+    EXPECT_EQ(snap.bid_levels, QUOTE_SNAPSHOT_DEPTH);  // Capped at the depth
+    EXPECT_EQ(snap.ask_levels, 1u);
+    EXPECT_EQ(snap.bids[0].price, mid - TICK);
+    EXPECT_EQ(snap.bids[0].quantity, 10u);
+    EXPECT_EQ(snap.bids[9].price, mid - 10 * TICK);
+    EXPECT_EQ(snap.asks[0].quantity, 7u);
+    EXPECT_EQ(snap.mid_price(), book.mid_price());
+
+    // A change below the top N is invisible; a trade price is not
+    book.cancel_order(12);
+    EXPECT_FALSE(slot.publish(book, 0));
+    EXPECT_TRUE(slot.publish(book, mid));
+    book.cancel_order(100);
+    EXPECT_TRUE(slot.publish(book, mid));
+    ASSERT_TRUE(slot.read(snap));
+    EXPECT_FALSE(snap.has_ask());
+    EXPECT_EQ(snap.mid_price(), 0);
+    EXPECT_EQ(snap.last_trade_price, mid);
+    EXPECT_EQ(slot.version(), 6u);
+}
+
+TEST(QuoteSnapshotTest, ReadersOnOtherThreadsSeeConsistentCopies) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    MemoryPool<Order> pool(MAX_ORDERS);
+    QuoteSnapshotSlot slot;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+
+    // The writer keeps the best bid and ask the same size, so a torn copy
+    // shows as a mismatch
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            QuoteSnapshot snap{};
+            while (!done.load(std::memory_order_acquire)) {
+                if (!slot.read(snap) || !snap.has_bid() || !snap.has_ask()) continue;
+                if (snap.bids[0].quantity != snap.asks[0].quantity ||
+                    snap.last_trade_price != static_cast<Price>(snap.bids[0].quantity)) {
+                    ++torn;
+                }
+            }
+        });
+    }
+
+    const Price mid = 50'000 * PRICE_SCALE;
+    for (OrderId id = 1; id <= 20'000; ++id) {
+        Order* bid = pool.allocate();
+        Order* ask = pool.allocate();
+        *bid = make_order(2 * id, Side::Buy, mid - TICK, id);
+        *ask = make_order(2 * id + 1, Side::Sell, mid + TICK, id);
+        book.add_order(bid);
+        book.add_order(ask);
+        slot.publish(book, static_cast<Price>(id));
+        pool.deallocate(book.cancel_order(2 * id).order);
+        pool.deallocate(book.cancel_order(2 * id + 1).order);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    QuoteSnapshot last{};
+    ASSERT_TRUE(slot.read(last));
+    EXPECT_EQ(last.publish_count, 20'000u);
+}
+
 // ===================================================================
 // Zero heap allocation after construction
 //
@@ -656,6 +1988,200 @@ void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
 namespace hft {
 namespace {
 
+TEST(OrderBookMemoryTest, ReportsLevelsAndOrderIndex) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    const BookMemoryUsage before = book.memory_usage();
+    EXPECT_GE(before.levels.reserved_bytes,
+              2 * book.num_levels() * sizeof(PriceLevel));
+    EXPECT_GE(before.order_index.reserved_bytes, 2 * MAX_ORDERS * 16);
+    EXPECT_LE(before.levels.touched_bytes, before.levels.reserved_bytes);
+
+    std::vector<Order> orders(100);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        orders[i] = make_order(i + 1, Side::Buy, MIN_PRICE + static_cast<Price>(i) * TICK, 1);
+        ASSERT_TRUE(book.add_order(&orders[i]).success);
+    }
+    const BookMemoryUsage after = book.memory_usage();
+    EXPECT_EQ(after.levels.reserved_bytes, before.levels.reserved_bytes);
+    EXPECT_GE(after.order_index.high_water_bytes, 100 * 16u);
+
+    const MemoryUsage total = after.total();
+    EXPECT_EQ(total.reserved_bytes, after.levels.reserved_bytes +
+                                        after.order_index.reserved_bytes +
+                                        after.auxiliary.reserved_bytes);
+}
+
+// ===================================================================
+// State digest
+// ===================================================================
+
+TEST(BookDigestTest, IncrementalDigestMatchesRecomputeUnderRandomFlow) {
+    OrderBookOptions opts;
+    opts.state_digest = true;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    ASSERT_TRUE(book.state_digest_enabled());
+    EXPECT_EQ(book.state_digest(), 0u);
+
+    std::vector<Order> orders(4000);  // One per step at most
+    std::vector<OrderId> live;
+    std::mt19937 rng(11);
+    OrderId next_id = 1;
+    for (int step = 0; step < 4000; ++step) {
+        const int kind = static_cast<int>(rng() % 10);
+        if (live.empty() || kind < 5) {
+            Order& o = orders[next_id - 1];
+            const Side side = (rng() & 1) ? Side::Buy : Side::Sell;
+            // Bids below asks, so nothing here would cross
+            const Price base = side == Side::Buy ? 49'990 * PRICE_SCALE
+                                                 : 50'010 * PRICE_SCALE;
+            o = make_order(next_id++, side, base + static_cast<Price>(rng() % 8) * TICK,
+                           1 + rng() % 50);
+            ASSERT_TRUE(book.add_order(&o).success);
+            live.push_back(o.order_id);
+        } else {
+            const size_t pick = rng() % live.size();
+            Order& o = orders[live[pick] - 1];
+            if (kind < 7) {
+                ASSERT_TRUE(book.cancel_order(o.order_id).success);
+                live.erase(live.begin() + static_cast<std::ptrdiff_t>(pick));
+            } else if (kind < 9) {
+                // Partial or full fill at the front of the touch on o's side,
+                // the way the matching engine applies it
+                PriceLevel* level = o.side == Side::Buy ? book.best_bid_level()
+                                                        : book.best_ask_level();
+                Order* front = level->front();
+                const Quantity qty = 1 + rng() % front->remaining_quantity();
+                book.reduce_level_quantity(level, *front, qty);
+                front->filled_quantity += qty;
+                if (front->remaining_quantity() == 0) {
+                    book.remove_order(front);
+                    live.erase(std::find(live.begin(), live.end(), front->order_id));
+                }
+            } else {
+                // Size down in place, or reprice (re-added by the caller)
+                const bool reprice = rng() & 1;
+                const Quantity qty = o.filled_quantity + 1 + rng() % o.remaining_quantity();
+                const Price price = reprice ? o.price + TICK * (o.side == Side::Buy ? -1 : 1)
+                                            : o.price;
+                const ModifyResult r = book.modify_order(o.order_id, price, qty, step);
+                ASSERT_TRUE(r.success);
+                if (!r.in_place) ASSERT_TRUE(book.add_order(r.order).success);
+            }
+        }
+        ASSERT_EQ(book.state_digest(), book.compute_state_digest()) << step;
+    }
+    EXPECT_NE(book.state_digest(), 0u);
+}
+
+TEST(BookDigestTest, EqualBooksHaveEqualDigestsWhateverTheirHistory) {
+    OrderBookOptions opts;
+    opts.state_digest = true;
+    OrderBook a(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    OrderBook b(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    const Price bid = 49'999 * PRICE_SCALE;
+    const Price ask = 50'001 * PRICE_SCALE;
+
+    // a: three orders in one order, b: the reverse, plus an order that
+    // comes and goes and a size that starts larger and is amended down
+    Order a1 = make_order(1, Side::Buy, bid, 10);
+    Order a2 = make_order(2, Side::Buy, bid, 20);
+    Order a3 = make_order(3, Side::Sell, ask, 5);
+    ASSERT_TRUE(a.add_order(&a1).success);
+    ASSERT_TRUE(a.add_order(&a2).success);
+    ASSERT_TRUE(a.add_order(&a3).success);
+
+    Order b3 = make_order(3, Side::Sell, ask, 5);
+    Order b9 = make_order(9, Side::Sell, ask, 7);
+    Order b2 = make_order(2, Side::Buy, bid, 20);
+    Order b1 = make_order(1, Side::Buy, bid, 25);
+    ASSERT_TRUE(b.add_order(&b3).success);
+    ASSERT_TRUE(b.add_order(&b9).success);
+    ASSERT_TRUE(b.add_order(&b2).success);
+    ASSERT_TRUE(b.add_order(&b1).success);
+    EXPECT_NE(a.state_digest(), b.state_digest());
+    ASSERT_TRUE(b.cancel_order(9).success);
+    ASSERT_TRUE(b.modify_order(1, bid, 10, 0).in_place);
+    EXPECT_EQ(a.state_digest(), b.state_digest());
+
+    // Same totals per level, different orders: still told apart
+    b.reduce_level_quantity(b.best_bid_level(), b2, 5);
+    b2.filled_quantity += 5;
+    a.reduce_level_quantity(a.best_bid_level(), a1, 5);
+    a1.filled_quantity += 5;
+    EXPECT_EQ(a.best_bid()->total_quantity, b.best_bid()->total_quantity);
+    EXPECT_NE(a.state_digest(), b.state_digest());
+    EXPECT_EQ(a.state_digest(), a.compute_state_digest());
+    EXPECT_EQ(b.state_digest(), b.compute_state_digest());
+}
+
+TEST(BookDigestTest, EnablingLateSeedsFromTheCurrentBook) {
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS);
+    Order o1 = make_order(1, Side::Buy, 49'000 * PRICE_SCALE, 10);
+    Order o2 = make_order(2, Side::Sell, 51'000 * PRICE_SCALE, 10);
+    ASSERT_TRUE(book.add_order(&o1).success);
+    EXPECT_FALSE(book.state_digest_enabled());
+    EXPECT_EQ(book.state_digest(), 0u);
+    const uint64_t one_order = book.compute_state_digest();
+
+    book.enable_state_digest();
+    EXPECT_EQ(book.state_digest(), one_order);
+    ASSERT_TRUE(book.add_order(&o2).success);
+    ASSERT_TRUE(book.cancel_order(2).success);
+    EXPECT_EQ(book.state_digest(), one_order);
+}
+
+TEST(BookDigestTest, RestoredLevelsMatchTheBookTheyCameFrom) {
+    OrderBookOptions opts;
+    opts.state_digest = true;
+    OrderBook live(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    OrderBook restored(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    const Price price = 50'000 * PRICE_SCALE;
+
+    Order a = make_order(1, Side::Sell, price, 10);
+    Order b = make_order(2, Side::Sell, price, 30);
+    ASSERT_TRUE(live.add_order(&a).success);
+    ASSERT_TRUE(live.add_order(&b).success);
+    live.reduce_level_quantity(live.best_ask_level(), a, 4);
+    a.filled_quantity += 4;
+    a.status = OrderStatus::PartialFill;
+
+    Order copies[2] = {a, b};
+    copies[0].next = copies[0].prev = copies[1].next = copies[1].prev = nullptr;
+    Order* level[2] = {&copies[0], &copies[1]};
+    ASSERT_TRUE(restored.restore_level(Side::Sell, price, level, 2));
+    EXPECT_EQ(restored.state_digest(), live.state_digest());
+    EXPECT_EQ(restored.state_digest(), restored.compute_state_digest());
+}
+
+TEST(OrderBookClearTest, ReleasesEveryOrderAndTakesTheSameIdsAgain) {
+    OrderBookOptions opts;
+    opts.state_digest = true;
+    OrderBook book(MIN_PRICE, MAX_PRICE, TICK, MAX_ORDERS, opts);
+    std::vector<Order> orders(200);
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const Side side = i % 2 ? Side::Buy : Side::Sell;
+        const Price base = side == Side::Buy ? 49'990 * PRICE_SCALE : 50'010 * PRICE_SCALE;
+        orders[i] = make_order(i + 1, side, base + static_cast<Price>(i % 7) * TICK, 5);
+        ASSERT_TRUE(book.add_order(&orders[i]).success);
+    }
+
+    std::vector<OrderId> released;
+    EXPECT_EQ(book.clear([&](Order* o) { released.push_back(o->order_id); }), orders.size());
+    EXPECT_EQ(released.size(), orders.size());
+    EXPECT_TRUE(book.empty());
+    EXPECT_EQ(book.best_bid_level(), nullptr);
+    EXPECT_EQ(book.best_ask_level(), nullptr);
+    EXPECT_EQ(book.find_order(1), nullptr);
+    EXPECT_EQ(book.state_digest(), 0u);
+
+    // The index forgot every id, so the next session may reuse them
+    Order again = make_order(1, Side::Buy, 49'995 * PRICE_SCALE, 3);
+    ASSERT_TRUE(book.add_order(&again).success);
+    EXPECT_EQ(book.find_order(1), &again);
+    EXPECT_EQ(book.order_count(), 1u);
+    EXPECT_EQ(book.state_digest(), book.compute_state_digest());
+}
+
 TEST(OrderBookZeroAllocTest, AddCancelNoHeapAlloc) {
     // Construct everything first (heap alloc allowed here)
     OrderBook book(MIN_PRICE, MAX_PRICE, TICK, 256);
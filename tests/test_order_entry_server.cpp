@@ -0,0 +1,346 @@
+/// @file test_order_entry_server.cpp
+/// @brief Unit tests for OrderEntryServer over loopback TCP.
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "feed/fix_parser.h"
+#include "feed/order_entry_server.h"
+#include "gateway/instrument_registry.h"
+#include "gateway/instrument_router.h"
+#include "transport/event_buffer.h"
+#include "transport/ingress_buffer.h"
+
+using namespace hft;
+
+// ===========================================================================
+// Helpers
+// ===========================================================================
+
+namespace {
+
+/// TCP client on 127.0.0.1.
+class Client {
+public:
+    explicit Client(uint16_t port) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connected_ = ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    ~Client() { ::close(fd_); }
+
+    [[nodiscard]] bool connected() const { return connected_; }
+
+    void send(const void* data, size_t n) {
+        ASSERT_EQ(::send(fd_, data, n, 0), static_cast<ssize_t>(n));
+    }
+    void send(const std::string& s) { send(s.data(), s.size()); }
+
+    /// Read whatever has arrived; false once the server closed.
+    bool poll() {
+        char buffer[4096];
+        const ssize_t n = ::recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n == 0) return false;
+        if (n > 0) received_.append(buffer, static_cast<size_t>(n));
+        return true;
+    }
+
+    [[nodiscard]] const std::string& received() const { return received_; }
+
+private:
+    int fd_ = -1;
+    bool connected_ = false;
+    std::string received_;
+};
+
+/// One instrument's pipeline, fed from the ingress ring by the test
+/// thread (as a matching thread would), its events fed to the server.
+class Harness {
+public:
+    explicit Harness(OrderEntryProtocol protocol, size_t max_sessions = 8) {
+        InstrumentConfig cfg;
+        cfg.instrument_id = 5;
+        cfg.symbol = "BTCUSDT";
+        cfg.min_price = 1 * PRICE_SCALE;
+        cfg.max_price = 1000 * PRICE_SCALE;
+        cfg.tick_size = PRICE_SCALE / 100;
+        cfg.max_orders = 1000;
+        pipeline_ = build_instrument_pipeline(cfg, &events_);
+
+        OrderEntryConfig config;
+        config.bind_address = "127.0.0.1";
+        config.protocol = protocol;
+        config.instrument_id = cfg.instrument_id;
+        config.symbol = cfg.symbol;
+        config.max_sessions = max_sessions;
+        config.receive_buffers = 16;
+        config.send_buffer_bytes = 16 << 10;
+        server_ = std::make_unique<OrderEntryServer>(config, ingress_);
+        available_ = server_->open();
+    }
+
+    [[nodiscard]] bool available() const { return available_; }
+    [[nodiscard]] OrderEntryServer& server() { return *server_; }
+    [[nodiscard]] IngressBuffer& ingress() { return ingress_; }
+    [[nodiscard]] OrderBook& book() { return *pipeline_->book; }
+
+    /// Match queued orders and publish their events.
+    void pump() {
+        OrderMessage om{};
+        while (ingress_.try_pop(om)) (void)pipeline_->gateway->process(om);
+        EventMessage e{};
+        while (events_.try_pop(e)) (void)server_->on_event(e);
+    }
+
+    /// Pump until `done()` holds or a second passes.
+    template <typename Done>
+    bool pump_until(Done&& done) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (std::chrono::steady_clock::now() < deadline) {
+            pump();
+            if (done()) return true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return false;
+    }
+
+private:
+    IngressBuffer ingress_;
+    EventBuffer events_;
+    std::unique_ptr<InstrumentPipeline> pipeline_;
+    std::unique_ptr<OrderEntryServer> server_;
+    bool available_ = false;
+};
+
+/// SOH-delimited FIX 4.2 message with BodyLength and CheckSum.
+std::string fix_message(const std::string& body) {
+    std::string msg = "8=FIX.4.2\x01" "9=" + std::to_string(body.size()) + "\x01" + body;
+    char trailer[8];
+    std::snprintf(trailer, sizeof(trailer), "10=%03u\x01",
+                  static_cast<unsigned>(fix::FixParser::compute_checksum(msg)));
+    return msg + trailer;
+}
+
+std::string new_order(const std::string& cl_ord_id, char side, const std::string& price,
+                      const std::string& qty) {
+    return fix_message("35=D\x01" "11=" + cl_ord_id + "\x01" "55=BTCUSDT\x01" "54=" + side +
+                       "\x01" "38=" + qty + "\x01" "40=2\x01" "44=" + price + "\x01");
+}
+
+template <typename Body>
+std::string binary(oep::Template id, const Body& body) {
+    const oep::MessageHeader header{static_cast<uint16_t>(sizeof(header) + sizeof(body)),
+                                    static_cast<uint16_t>(id)};
+    std::string out(sizeof(header) + sizeof(body), '\0');
+    std::memcpy(&out[0], &header, sizeof(header));
+    std::memcpy(&out[sizeof(header)], &body, sizeof(body));
+    return out;
+}
+
+std::vector<oep::ExecutionReport> decode_reports(const std::string& bytes) {
+    std::vector<oep::ExecutionReport> out;
+    size_t at = 0;
+    while (bytes.size() - at >= sizeof(oep::MessageHeader) + sizeof(oep::ExecutionReport)) {
+        oep::ExecutionReport r{};
+        std::memcpy(&r, bytes.data() + at + sizeof(oep::MessageHeader), sizeof(r));
+        out.push_back(r);
+        at += sizeof(oep::MessageHeader) + sizeof(r);
+    }
+    return out;
+}
+
+}  // namespace
+
+#define REQUIRE_IO_URING(h)                                                   \
+    if (!(h).available()) GTEST_SKIP() << "io_uring: " << (h).server().error()
+
+// ===========================================================================
+// FIX sessions
+// ===========================================================================
+
+TEST(OrderEntryServer, FixSessionsTradeAndGetTheirReports) {
+    Harness h(OrderEntryProtocol::Fix);
+    REQUIRE_IO_URING(h);
+    Client buyer(h.server().port());
+    Client seller(h.server().port());
+    ASSERT_TRUE(buyer.connected() && seller.connected());
+    ASSERT_TRUE(h.pump_until([&] { return h.server().session_count() == 2; }));
+
+    // Split across writes: framed once the rest arrives
+    const std::string buy = new_order("BUY-1", '1', "100.00", "10");
+    buyer.send(buy.substr(0, 20));
+    buyer.send(buy.substr(20));
+    ASSERT_TRUE(h.pump_until([&] { return h.book().order_count() == 1; }));
+    ASSERT_TRUE(h.pump_until([&] {
+        buyer.poll();
+        return buyer.received().find("\x01" "11=BUY-1\x01") != std::string::npos;
+    }));
+    EXPECT_NE(buyer.received().find("\x01" "150=0\x01"), std::string::npos);  // New
+
+    // Each side sees the fill (LastQty 32) under its own ClOrdID
+    seller.send(new_order("SELL-1", '2', "100.00", "4"));
+    ASSERT_TRUE(h.pump_until([&] {
+        buyer.poll();
+        seller.poll();
+        return buyer.received().find("\x01" "32=4\x01") != std::string::npos &&
+               seller.received().find("\x01" "32=4\x01") != std::string::npos;
+    }));
+    EXPECT_EQ(buyer.received().find("SELL-1"), std::string::npos);
+    EXPECT_NE(seller.received().find("\x01" "11=SELL-1\x01"), std::string::npos);
+    EXPECT_EQ(seller.received().find("BUY-1"), std::string::npos);
+
+    // A reused live ClOrdID is refused; a non-order message is ignored
+    buyer.send(new_order("BUY-1", '1', "99.00", "1"));
+    buyer.send(fix_message("35=0\x01"));
+    ASSERT_TRUE(h.pump_until([&] {
+        return h.server().stats().messages_invalid == 1 &&
+               h.server().stats().messages_ignored == 1;
+    }));
+
+    const OrderEntryStats stats = h.server().stats();
+    EXPECT_EQ(stats.sessions_accepted, 2u);
+    EXPECT_EQ(stats.orders_submitted, 2u);
+    EXPECT_EQ(stats.messages_received, 4u);
+    EXPECT_EQ(h.book().order_count(), 1u);
+    h.server().close();
+    EXPECT_EQ(h.server().stats().sessions_closed, 2u);
+}
+
+// ===========================================================================
+// Binary sessions
+// ===========================================================================
+
+TEST(OrderEntryServer, BinaryOrdersReplaceAndCancel) {
+    Harness h(OrderEntryProtocol::Binary);
+    REQUIRE_IO_URING(h);
+    Client client(h.server().port());
+    ASSERT_TRUE(client.connected());
+
+    oep::NewOrder add{};
+    add.cl_ord_id = 1;
+    add.price = 100 * PRICE_SCALE;
+    add.quantity = 10;
+    add.side = static_cast<uint8_t>(Side::Buy);
+    add.order_type = static_cast<uint8_t>(OrderType::Limit);
+    const std::string bytes = binary(oep::Template::NewOrder, add);
+    for (char c : bytes) client.send(&c, 1);   // One byte per segment
+
+    oep::ReplaceOrder replace{};
+    replace.cl_ord_id = 2;
+    replace.orig_cl_ord_id = 1;
+    replace.price = 101 * PRICE_SCALE;
+    replace.quantity = 8;
+    oep::CancelOrder cancel{};
+    cancel.cl_ord_id = 3;
+    cancel.orig_cl_ord_id = 2;
+    ASSERT_TRUE(h.pump_until([&] {
+        client.poll();
+        return decode_reports(client.received()).size() == 1;
+    }));
+    client.send(binary(oep::Template::ReplaceOrder, replace) +
+                binary(oep::Template::CancelOrder, cancel));
+    ASSERT_TRUE(h.pump_until([&] {
+        client.poll();
+        return decode_reports(client.received()).size() == 3;
+    }));
+
+    const auto reports = decode_reports(client.received());
+    EXPECT_EQ(reports[0].event_type, static_cast<uint8_t>(EventType::OrderAccepted));
+    EXPECT_EQ(reports[0].cl_ord_id, 1u);
+    EXPECT_NE(OrderEntryServer::session_tag(reports[0].order_id), 0u);
+    EXPECT_EQ(reports[1].event_type, static_cast<uint8_t>(EventType::OrderModified));
+    EXPECT_EQ(reports[1].cl_ord_id, 2u);
+    EXPECT_EQ(reports[1].price, 101 * PRICE_SCALE);
+    EXPECT_EQ(reports[2].event_type, static_cast<uint8_t>(EventType::OrderCancelled));
+    EXPECT_EQ(reports[2].cl_ord_id, 2u);
+    EXPECT_EQ(reports[2].order_id, reports[0].order_id);
+    EXPECT_EQ(h.book().order_count(), 0u);
+}
+
+TEST(OrderEntryServer, RejectsWhenTheIngressRingIsFull) {
+    Harness h(OrderEntryProtocol::Binary);
+    REQUIRE_IO_URING(h);
+    OrderMessage filler{};
+    while (h.ingress().try_push(filler)) {}
+
+    Client client(h.server().port());
+    ASSERT_TRUE(client.connected());
+    oep::NewOrder add{};
+    add.cl_ord_id = 42;
+    add.price = 100 * PRICE_SCALE;
+    add.quantity = 1;
+    client.send(binary(oep::Template::NewOrder, add));
+
+    // Poll the socket only: the ring stays full
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (decode_reports(client.received()).empty() &&
+           std::chrono::steady_clock::now() < deadline) {
+        client.poll();
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    const auto reports = decode_reports(client.received());
+    ASSERT_EQ(reports.size(), 1u);
+    EXPECT_EQ(reports[0].event_type, static_cast<uint8_t>(EventType::OrderRejected));
+    EXPECT_EQ(reports[0].cl_ord_id, 42u);
+    EXPECT_EQ(h.server().stats().orders_rejected, 1u);
+
+    // The refused ClOrdID is free again
+    OrderMessage om{};
+    while (h.ingress().try_pop(om)) {}
+    client.send(binary(oep::Template::NewOrder, add));
+    ASSERT_TRUE(h.pump_until([&] { return h.book().order_count() == 1; }));
+}
+
+TEST(OrderEntryServer, RefusesSessionsOverTheLimitAndReusesSlots) {
+    Harness h(OrderEntryProtocol::Binary, 1);
+    REQUIRE_IO_URING(h);
+    auto first = std::make_unique<Client>(h.server().port());
+    ASSERT_TRUE(h.pump_until([&] { return h.server().session_count() == 1; }));
+    Client second(h.server().port());
+    ASSERT_TRUE(h.pump_until([&] { return !second.poll(); }));   // Closed by the server
+    EXPECT_EQ(h.server().stats().sessions_refused, 1u);
+
+    // A malformed frame ends the session; its slot takes the next one
+    const oep::MessageHeader bad{3, 99};
+    first->send(&bad, sizeof(bad));
+    ASSERT_TRUE(h.pump_until([&] { return h.server().session_count() == 0; }));
+    first.reset();
+    Client third(h.server().port());
+    ASSERT_TRUE(h.pump_until([&] { return h.server().session_count() == 1; }));
+    EXPECT_EQ(h.server().stats().sessions_accepted, 2u);
+    EXPECT_EQ(h.server().stats().messages_invalid, 1u);
+}
+
+TEST(OrderEntryServer, BadHeaderEndingOnAReceiveBoundaryEndsTheSession) {
+    Harness h(OrderEntryProtocol::Binary);
+    REQUIRE_IO_URING(h);
+    Client client(h.server().port());
+    ASSERT_TRUE(client.connected());
+
+    // Known template, oversized length: the header completes exactly at the
+    // end of the second receive, with nothing after it
+    const oep::MessageHeader bad{UINT16_MAX, static_cast<uint16_t>(oep::Template::NewOrder)};
+    const char* bytes = reinterpret_cast<const char*>(&bad);
+    client.send(bytes, 2);
+    ASSERT_TRUE(h.pump_until([&] { return h.server().stats().bytes_received == 2; }));
+    client.send(bytes + 2, sizeof(bad) - 2);
+
+    ASSERT_TRUE(h.pump_until([&] { return h.server().session_count() == 0; }));
+    EXPECT_FALSE(client.poll());
+    EXPECT_EQ(h.server().stats().messages_invalid, 1u);
+    EXPECT_EQ(h.server().stats().messages_received, 0u);
+}
@@ -1,16 +1,23 @@
 /// @file test_spsc_ring_buffer.cpp
-/// @brief Unit tests for SPSC ring buffer and transport message types.
+/// @brief Unit tests for the SPSC / MPSC / broadcast ring buffers and
+///        transport message types.
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "transport/broadcast_ring_buffer.h"
 #include "transport/message.h"
+#include "transport/mpsc_ring_buffer.h"
+#include "transport/packed_event_buffer.h"
 #include "transport/spsc_ring_buffer.h"
+#include "transport/wait_strategy.h"
 
 using namespace hft;
 
@@ -45,7 +52,42 @@ TEST(MessageLayout, EventDataUnionSize) {
 }
 
 TEST(MessageLayout, TradeSize) {
-    EXPECT_EQ(sizeof(Trade), 48);
+    EXPECT_EQ(sizeof(Trade), 56);
+    EXPECT_EQ(sizeof(TradeEventData), 48);
+}
+
+TEST(MessageLayout, TradeRoundTripsThroughAnEvent) {
+    Trade trade{};
+    trade.trade_id = UINT64_MAX;
+    trade.buy_order_id = 11;
+    trade.sell_order_id = 22;
+    trade.price = -150000000;
+    trade.quantity = 12;
+    trade.timestamp = 1704067200000000000ULL;
+    trade.resting_participant_id = 7;
+    trade.aggressor_side = Side::Sell;
+    trade.flags = TRADE_AGGRESSOR | TRADE_RESTING_FILLED;
+
+    EventMessage event{};
+    event.type = EventType::Trade;
+    set_trade(event, trade);
+    const Trade back = event_trade(event);
+    EXPECT_EQ(back.trade_id, UINT64_MAX);
+    EXPECT_EQ(back.buy_order_id, 11u);
+    EXPECT_EQ(back.sell_order_id, 22u);
+    EXPECT_EQ(back.price, -150000000);
+    EXPECT_EQ(back.quantity, 12u);
+    EXPECT_EQ(back.timestamp, 1704067200000000000ULL);
+    EXPECT_EQ(back.resting_participant_id, 7u);
+    EXPECT_EQ(back.aggressor_side, Side::Sell);
+    EXPECT_EQ(back.flags, TRADE_AGGRESSOR | TRADE_RESTING_FILLED);
+    EXPECT_EQ(back.resting_order_id(), 11u);
+
+    // A zeroed header reads as a trade without an aggressor
+    EventMessage bare{};
+    bare.type = EventType::Trade;
+    bare.data.trade.trade_id = 1;
+    EXPECT_FALSE(event_trade(bare).has_aggressor());
 }
 
 TEST(SPSCLayout, CacheLinePadding) {
@@ -181,6 +223,53 @@ TEST(SPSCSingleThread, CapacityOneEdgeCase) {
     EXPECT_EQ(val, 200);
 }
 
+TEST(SPSCSingleThread, BatchPushPopWrapsAround) {
+    SPSCRingBuffer<int, 8> rb;
+    int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int out[10] = {};
+
+    EXPECT_EQ(rb.try_push_n(in, 5), 5u);
+    EXPECT_EQ(rb.try_pop_n(out, 3), 3u);
+    // Head is at slot 5: the next batch wraps, and only 6 slots are free
+    EXPECT_EQ(rb.try_push_n(in + 5, 5), 5u);
+    EXPECT_EQ(rb.try_push_n(in, 10), 1u);
+    EXPECT_TRUE(rb.full());
+    EXPECT_EQ(rb.try_push_n(in, 1), 0u);
+
+    EXPECT_EQ(rb.try_pop_n(out + 3, 10), 8u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(out[i], i);
+    }
+    EXPECT_EQ(rb.try_pop_n(out, 10), 0u);
+    EXPECT_TRUE(rb.empty());
+}
+
+TEST(SPSCSingleThread, ClaimCommitPeekRelease) {
+    SPSCRingBuffer<int, 2> rb;
+    EXPECT_EQ(rb.peek(), nullptr);
+
+    int* slot = rb.claim();
+    ASSERT_NE(slot, nullptr);
+    *slot = 7;
+    EXPECT_TRUE(rb.empty());  // Not visible until committed
+    rb.commit();
+    ASSERT_NE(rb.claim(), nullptr);
+    *rb.claim() = 8;
+    rb.commit();
+    EXPECT_EQ(rb.claim(), nullptr);  // Full
+
+    const int* front = rb.peek();
+    ASSERT_NE(front, nullptr);
+    EXPECT_EQ(*front, 7);
+    EXPECT_EQ(rb.peek(), front);  // Same slot until released
+    rb.release();
+
+    int val = 0;
+    EXPECT_TRUE(rb.try_pop(val));
+    EXPECT_EQ(val, 8);
+    EXPECT_EQ(rb.peek(), nullptr);
+}
+
 // ===========================================================================
 // Message round-trip tests
 // ===========================================================================
@@ -400,6 +489,40 @@ TEST(SPSCMultiThread, OrderMessageStress) {
     }
 }
 
+TEST(SPSCMultiThread, BatchProducerConsumer) {
+    constexpr uint64_t kCount = 1'000'000;
+    SPSCRingBuffer<uint64_t, 1024> rb;
+
+    std::thread producer([&] {
+        uint64_t batch[37];
+        uint64_t next = 0;
+        while (next < kCount) {
+            size_t n = 0;
+            while (n < 37 && next + n < kCount) {
+                batch[n] = next + n;
+                ++n;
+            }
+            size_t pushed = 0;
+            while (pushed < n) {
+                pushed += rb.try_push_n(batch + pushed, n - pushed);
+            }
+            next += n;
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t out[64];
+    while (expected < kCount) {
+        size_t n = rb.try_pop_n(out, 64);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(out[i], expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(rb.empty());
+}
+
 TEST(SPSCMultiThread, AsymmetricSpeed) {
     // Producer is faster than consumer (consumer does extra work).
     constexpr size_t kCount = 100'000;
@@ -432,3 +555,281 @@ TEST(SPSCMultiThread, AsymmetricSpeed) {
     uint64_t expected = kCount * (kCount - 1) / 2;
     EXPECT_EQ(sum.load(std::memory_order_acquire), expected);
 }
+
+// ===========================================================================
+// MPSC ring buffer
+// ===========================================================================
+
+TEST(MPSCSingleThread, FifoWithConsecutiveTickets) {
+    MPSCRingBuffer<int, 4> q;
+    int val = 0;
+    uint64_t ticket = 99;
+    EXPECT_FALSE(q.try_pop(val, ticket));
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(q.try_push(i * 10, ticket));
+        EXPECT_EQ(ticket, static_cast<uint64_t>(i));
+    }
+    EXPECT_FALSE(q.try_push(40));  // full
+    EXPECT_EQ(q.size(), 4u);
+
+    EXPECT_TRUE(q.try_pop(val, ticket));
+    EXPECT_EQ(val, 0);
+    EXPECT_EQ(ticket, 0u);
+    // The freed cell takes the next lap's position
+    EXPECT_TRUE(q.try_push(40, ticket));
+    EXPECT_EQ(ticket, 4u);
+
+    int out[8] = {};
+    ASSERT_EQ(q.try_pop_n(out, 8), 4u);
+    EXPECT_EQ(out[0], 10);
+    EXPECT_EQ(out[3], 40);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MPSCMultiThread, ProducersKeepOrderAndTicketsAreTotal) {
+    constexpr size_t kProducers = 4;
+    constexpr uint64_t kPerProducer = 20'000;
+    MPSCRingBuffer<uint64_t, 256> q;  // small buffer to force contention
+
+    std::vector<std::thread> producers;
+    for (uint64_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&q, p] {
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                while (!q.try_push((p << 32) | i)) {
+                    std::this_thread::yield();  // backpressure
+                }
+            }
+        });
+    }
+
+    uint64_t next[kProducers] = {};
+    uint64_t expected_ticket = 0;
+    for (uint64_t popped = 0; popped < kProducers * kPerProducer;) {
+        uint64_t val = 0;
+        uint64_t ticket = 0;
+        if (!q.try_pop(val, ticket)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(ticket, expected_ticket++);
+        uint64_t p = val >> 32;
+        ASSERT_LT(p, kProducers);
+        ASSERT_EQ(val & 0xFFFFFFFFu, next[p]);  // Per-producer FIFO
+        ++next[p];
+        ++popped;
+    }
+    for (auto& t : producers) t.join();
+    EXPECT_TRUE(q.empty());
+}
+
+// ===========================================================================
+// Broadcast ring buffer
+// ===========================================================================
+
+TEST(BroadcastSingleThread, GatesOnSlowestGatingConsumer) {
+    BroadcastRingBuffer<int, 4, 4> rb;
+    auto second = rb.add_consumer();
+    ASSERT_NE(second, decltype(rb)::INVALID_CONSUMER);
+
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(rb.try_push(i));
+    EXPECT_FALSE(rb.try_push(4));  // Both cursors a lap behind
+
+    int out[4] = {};
+    ASSERT_EQ(rb.try_pop_n(out, 4), 4u);  // PRIMARY reads all
+    EXPECT_EQ(out[3], 3);
+    EXPECT_FALSE(rb.try_push(4));  // Still held by the second consumer
+
+    int val = -1;
+    ASSERT_TRUE(rb.try_pop(second, val));
+    EXPECT_EQ(val, 0);
+    EXPECT_TRUE(rb.try_push(4));
+    EXPECT_EQ(rb.size(second), 4u);
+    EXPECT_EQ(rb.size(), 1u);
+
+    // Once removed, it no longer holds the producer back
+    rb.remove_consumer(second);
+    EXPECT_TRUE(rb.try_pop(val));
+    EXPECT_EQ(val, 4);
+    for (int i = 5; i < 9; ++i) EXPECT_TRUE(rb.try_push(i));
+}
+
+TEST(BroadcastSingleThread, NonGatingConsumerSkipsWhenLapped) {
+    BroadcastRingBuffer<int, 4, 2> rb;
+    auto tap = rb.add_consumer(/*gating=*/false);
+    ASSERT_NE(tap, decltype(rb)::INVALID_CONSUMER);
+    EXPECT_EQ(rb.add_consumer(), decltype(rb)::INVALID_CONSUMER);  // Full
+
+    int val = -1;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(rb.try_push(i));
+        ASSERT_TRUE(rb.try_pop(val));  // PRIMARY keeps up
+    }
+    // The tap is ten behind a four-slot ring. The slot at head may be
+    // claimed by the producer, so only the newest three are kept
+    int out[8] = {};
+    ASSERT_EQ(rb.try_pop_n(tap, out, 8), 3u);
+    EXPECT_EQ(out[0], 7);
+    EXPECT_EQ(out[2], 9);
+    EXPECT_EQ(rb.lost(tap), 7u);
+}
+
+TEST(BroadcastMultiThread, EveryConsumerSeesEveryItemInOrder) {
+    constexpr uint64_t kCount = 200'000;
+    BroadcastRingBuffer<uint64_t, 256, 4> rb;
+    decltype(rb)::ConsumerId ids[3] = {decltype(rb)::PRIMARY, rb.add_consumer(),
+                                       rb.add_consumer()};
+    std::atomic<uint64_t> sums[3] = {};
+
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < 3; ++c) {
+        consumers.emplace_back([&, c] {
+            uint64_t expected = 0;
+            uint64_t sum = 0;
+            uint64_t out[16];
+            while (expected < kCount) {
+                size_t n = rb.try_pop_n(ids[c], out, 16);
+                if (n == 0) std::this_thread::yield();
+                for (size_t i = 0; i < n; ++i) {
+                    if (out[i] != expected) return;  // Sum check fails below
+                    sum += out[i];
+                    ++expected;
+                }
+            }
+            sums[c].store(sum, std::memory_order_release);
+        });
+    }
+
+    for (uint64_t i = 0; i < kCount; ++i) {
+        while (!rb.try_push(i)) {
+            std::this_thread::yield();  // backpressure
+        }
+    }
+    for (auto& t : consumers) t.join();
+
+    const uint64_t expected = kCount * (kCount - 1) / 2;
+    for (auto& s : sums) EXPECT_EQ(s.load(std::memory_order_acquire), expected);
+}
+
+// ===========================================================================
+// Packed event ring
+// ===========================================================================
+
+static EventMessage make_event(EventType type, uint64_t seq) {
+    EventMessage e{};
+    e.type = type;
+    e.instrument_id = 3;
+    e.sequence_num = seq;
+    if (type == EventType::Trade) {
+        e.data.trade.price = 100;
+        e.data.trade.quantity = seq;
+    } else {
+        e.data.order_event.order_id = seq * 10;
+        e.data.order_event.status = OrderStatus::Cancelled;
+        e.data.order_event.remaining_quantity = seq + 1;
+        e.data.order_event.price = 250;
+    }
+    return e;
+}
+
+TEST(PackedEventRing, ShortAndFullRecordsRoundTripAcrossWraps) {
+    PackedEventRing<8> ring;
+    EventMessage out{};
+
+    // cancel (1 slot), trade (pad + 2 slots), cancel (1)
+    EXPECT_TRUE(ring.try_push(make_event(EventType::OrderCancelled, 1)));
+    EXPECT_TRUE(ring.try_push(make_event(EventType::Trade, 2)));
+    EXPECT_TRUE(ring.try_push(make_event(EventType::OrderCancelled, 3)));
+    EXPECT_EQ(ring.size_slots(), 5u);
+    EXPECT_TRUE(ring.try_push(make_event(EventType::Trade, 4)));  // pad + 2
+    EXPECT_FALSE(ring.try_push(make_event(EventType::OrderCancelled, 5)));
+
+    ASSERT_TRUE(ring.try_pop(out));
+    EXPECT_EQ(out.type, EventType::OrderCancelled);
+    EXPECT_EQ(out.instrument_id, 3u);
+    EXPECT_EQ(out.sequence_num, 1u);
+    EXPECT_EQ(out.data.order_event.order_id, 10u);
+    EXPECT_EQ(out.data.order_event.remaining_quantity, 2u);
+    EXPECT_EQ(out.data.order_event.price, 0);  // Dropped by the short form
+
+    // Wrap: keep pushing and popping past the end several times
+    uint64_t next_pop = 2;
+    uint64_t next_push = 5;
+    for (int round = 0; round < 20; ++round) {
+        ASSERT_TRUE(ring.try_pop(out));
+        EXPECT_EQ(out.sequence_num, next_pop);
+        if (out.type == EventType::Trade) {
+            EXPECT_EQ(out.data.trade.quantity, next_pop);
+        }
+        ++next_pop;
+        EventType type = (next_push % 3 == 0) ? EventType::Trade
+                                              : EventType::OrderCancelled;
+        while (!ring.try_push(make_event(type, next_push))) {
+            ASSERT_TRUE(ring.try_pop(out));
+            EXPECT_EQ(out.sequence_num, next_pop++);
+        }
+        ++next_push;
+    }
+    while (ring.try_pop(out)) EXPECT_EQ(out.sequence_num, next_pop++);
+    EXPECT_EQ(next_pop, next_push);
+    EXPECT_TRUE(ring.empty());
+}
+
+// ===========================================================================
+// Wait strategies
+// ===========================================================================
+
+TEST(WaitStrategy, BackoffSpinsThenYieldsAndResets) {
+    WaitConfig config;
+    config.strategy = WaitStrategy::Backoff;
+    config.spin_limit = 4;
+    Waiter waiter(config);
+
+    waiter.idle();  // 1 pause
+    waiter.idle();  // 2
+    waiter.idle();  // 4 — at the limit
+    EXPECT_EQ(waiter.stats().yields, 0u);
+    waiter.idle();
+    waiter.idle();
+    EXPECT_EQ(waiter.stats().yields, 2u);
+
+    waiter.reset();
+    waiter.idle();
+    EXPECT_EQ(waiter.stats().yields, 2u);
+    EXPECT_EQ(waiter.stats().idle_polls, 6u);
+}
+
+TEST(WaitStrategy, BlockedConsumerWokenByProducer) {
+    constexpr uint64_t COUNT = 200;
+    auto ring = std::make_unique<SPSCRingBuffer<uint64_t, 64>>();
+    WakeupSignal signal;
+    ring->set_wakeup(&signal);
+
+    WaitConfig config;
+    config.strategy = WaitStrategy::Block;
+    config.block_timeout_us = 10'000'000;
+    Waiter waiter(config, ring->wakeup());
+
+    std::vector<uint64_t> got;
+    std::thread consumer([&] {
+        uint64_t v;
+        while (got.size() < COUNT) {
+            if (ring->try_pop(v)) {
+                got.push_back(v);
+                waiter.reset();
+            } else {
+                waiter.idle([&] { return !ring->empty(); });
+            }
+        }
+    });
+    for (uint64_t i = 0; i < COUNT; ++i) {
+        if (i % 20 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        while (!ring->try_push(i)) std::this_thread::yield();
+    }
+    consumer.join();
+
+    ASSERT_EQ(got.size(), COUNT);
+    for (uint64_t i = 0; i < COUNT; ++i) EXPECT_EQ(got[i], i);
+    EXPECT_GT(waiter.stats().blocks, 0u);
+    EXPECT_GT(waiter.stats().wakeups, 0u);
+}
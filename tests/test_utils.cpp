@@ -1,9 +1,19 @@
-// test_utils.cpp — Unit tests for clock.h and latency_histogram.h utilities
+// test_utils.cpp — Unit tests for clock.h, hdr_histogram.h,
+// latency_histogram.h, trace.h / trace_report.h, thread_placement.h and
+// perf_counters.h utilities
+
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "utils/clock.h"
+#include "utils/hdr_histogram.h"
 #include "utils/latency_histogram.h"
+#include "utils/perf_counters.h"
+#include "utils/thread_placement.h"
+#include "utils/trace_report.h"
 
 // ===========================================================================
 // clock.h tests
@@ -152,3 +162,305 @@ TEST(LatencyHistogram, SizeTracking) {
     hist.record(3);
     EXPECT_EQ(hist.size(), 3u);
 }
+
+TEST(LatencyHistogram, MergesPerThreadInstances) {
+    hft::LatencyHistogram a;
+    hft::LatencyHistogram b;
+    a.set_tsc_frequency(1.0);
+    for (uint64_t i = 1; i <= 500; ++i) a.record(i);
+    for (uint64_t i = 501; i <= 1000; ++i) b.record(i);
+    a.merge(b);
+
+    auto stats = a.compute();
+    EXPECT_EQ(stats.sample_count, 1000u);
+    EXPECT_DOUBLE_EQ(stats.min_ns, 1.0);
+    EXPECT_DOUBLE_EQ(stats.max_ns, 1000.0);
+    EXPECT_DOUBLE_EQ(stats.p50_ns, 500.0);
+    EXPECT_DOUBLE_EQ(stats.p99_ns, 990.0);
+}
+
+// ===========================================================================
+// hdr_histogram.h tests
+// ===========================================================================
+
+TEST(HdrHistogram, BucketsAreContiguous) {
+    using H = hft::HdrHistogram;
+    EXPECT_EQ(H::bucket_index(0), 0u);
+    EXPECT_EQ(H::bucket_index(1023), 1023u);
+    EXPECT_EQ(H::bucket_index(H::MAX_VALUE), H::BUCKET_COUNT - 1);
+    EXPECT_EQ(H::bucket_index(UINT64_MAX), H::BUCKET_COUNT - 1);
+    EXPECT_EQ(H::bucket_highest(H::BUCKET_COUNT - 1), H::MAX_VALUE);
+    for (size_t i = 1; i < H::BUCKET_COUNT; ++i) {
+        ASSERT_EQ(H::bucket_lowest(i), H::bucket_highest(i - 1) + 1) << "bucket " << i;
+        ASSERT_EQ(H::bucket_index(H::bucket_lowest(i)), i);
+        ASSERT_EQ(H::bucket_index(H::bucket_highest(i)), i);
+        // Width at most 1/512 of the bucket's values
+        ASSERT_LE((H::bucket_highest(i) - H::bucket_lowest(i)) * H::SUB_BUCKETS,
+                  H::bucket_lowest(i));
+    }
+}
+
+TEST(HdrHistogram, PercentilesWithinBucketError) {
+    hft::HdrHistogram hist;
+    // Geometric spread from 1 tick to ~10^9
+    std::vector<uint64_t> values;
+    for (double v = 1.0; v < 1e9; v *= 1.01) values.push_back(static_cast<uint64_t>(v));
+    for (uint64_t v : values) hist.record(v);
+
+    EXPECT_EQ(hist.count(), values.size());
+    EXPECT_EQ(hist.min(), values.front());
+    EXPECT_EQ(hist.max(), values.back());
+    for (double p : {0.0, 0.25, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        const auto exact = values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))];
+        const auto approx = hist.value_at_percentile(p);
+        EXPECT_NEAR(static_cast<double>(approx), static_cast<double>(exact),
+                    static_cast<double>(exact) / 1000.0 + 0.5) << "p=" << p;
+    }
+}
+
+TEST(HdrHistogram, ClampsValuesAboveRange) {
+    hft::HdrHistogram hist;
+    hist.record(UINT64_MAX / 2);
+    hist.record(5, 3);
+    EXPECT_EQ(hist.count(), 4u);
+    EXPECT_EQ(hist.max(), UINT64_MAX / 2);
+    EXPECT_EQ(hist.bucket_count(hft::HdrHistogram::BUCKET_COUNT - 1), 1u);
+    EXPECT_EQ(hist.value_at_percentile(0.5), 5u);
+    EXPECT_EQ(hist.value_at_percentile(1.0), UINT64_MAX / 2);
+
+    hist.clear();
+    EXPECT_EQ(hist.count(), 0u);
+    EXPECT_EQ(hist.min(), 0u);
+    EXPECT_EQ(hist.value_at_percentile(0.5), 0u);
+}
+
+TEST(HdrHistogram, MergeFromLiveWriter) {
+    hft::HdrHistogram live;
+    hft::HdrHistogram total;
+    constexpr uint64_t N = 200'000;
+    std::thread writer([&] {
+        for (uint64_t i = 0; i < N; ++i) live.record(100 + i % 5000);
+    });
+    // Snapshots taken while the writer runs never exceed it
+    for (int i = 0; i < 100; ++i) {
+        hft::HdrHistogram snapshot;
+        snapshot.merge(live);
+        EXPECT_LE(snapshot.count(), N);
+    }
+    writer.join();
+    total.merge(live);
+    total.merge(live);
+    EXPECT_EQ(total.count(), 2 * N);
+    EXPECT_EQ(total.min(), 100u);
+    EXPECT_EQ(total.max(), 5099u);
+    EXPECT_EQ(total.value_at_percentile(0.5), live.value_at_percentile(0.5));
+}
+
+// ===========================================================================
+// trace.h / trace_report.h tests
+// ===========================================================================
+
+namespace {
+
+hft::TraceRecord trace_record(hft::TraceStage stage, uint64_t key, uint64_t start,
+                              uint64_t end, uint64_t sequence = 0, uint32_t events = 0) {
+    return hft::TraceRecord{key, start, end, sequence, events, 0, stage, 0};
+}
+
+}  // namespace
+
+TEST(Trace, SamplesOneInNOrders) {
+    hft::set_trace_sampling(0);
+    EXPECT_FALSE(hft::trace_sampled(0));
+    EXPECT_EQ(hft::trace_begin(0), 0u);
+
+    hft::set_trace_sampling(4);
+    EXPECT_TRUE(hft::trace_sampled(0));
+    EXPECT_TRUE(hft::trace_sampled(8));
+    EXPECT_FALSE(hft::trace_sampled(9));
+    EXPECT_FALSE(hft::trace_sampled(hft::TRACE_NO_KEY));
+
+    std::vector<hft::TraceRecord> records;
+    (void)hft::TraceRegistry::instance().drain(records);
+    records.clear();
+    for (uint64_t id = 1; id <= 16; ++id) {
+        const uint64_t t0 = hft::trace_begin(id);
+        hft::trace_end(hft::TraceStage::Match, id, t0);
+    }
+    hft::set_trace_sampling(0);
+    EXPECT_EQ(hft::TraceRegistry::instance().drain(records), 4u);
+    for (const auto& r : records) {
+        EXPECT_EQ(r.key % 4, 0u);
+        EXPECT_EQ(r.stage, hft::TraceStage::Match);
+        EXPECT_GE(r.end_tsc, r.start_tsc);
+    }
+}
+
+TEST(Trace, RingDropsWhenFull) {
+    hft::TraceRing ring(7);
+    for (size_t i = 0; i < hft::TraceRing::CAPACITY + 10; ++i) {
+        ring.push(trace_record(hft::TraceStage::Parse, i, i, i + 1));
+    }
+    EXPECT_EQ(ring.dropped(), 10u);
+    std::vector<hft::TraceRecord> out;
+    EXPECT_EQ(ring.drain(out), hft::TraceRing::CAPACITY);
+    EXPECT_EQ(out.front().key, 0u);
+    EXPECT_EQ(out.back().key, hft::TraceRing::CAPACITY - 1);
+    EXPECT_EQ(out.front().thread, 7u);
+    // Room again after the drain
+    ring.push(trace_record(hft::TraceStage::Parse, 1, 1, 2));
+    EXPECT_EQ(ring.drain(out), 1u);
+}
+
+TEST(Trace, ReconstructsPerOrderBreakdowns) {
+    using hft::TraceStage;
+    // Order 10: add (events 1..3), publisher behind; then a cancel (event 5).
+    // Order 20 interleaves (event 4).
+    std::vector<hft::TraceRecord> records = {
+        trace_record(TraceStage::Parse, 10, 100, 110),
+        trace_record(TraceStage::GatewayValidate, 10, 120, 125),
+        trace_record(TraceStage::PoolAllocate, 10, 125, 127),
+        trace_record(TraceStage::Match, 10, 127, 160),
+        trace_record(TraceStage::EventPublish, 10, 160, 170, 1, 3),
+        trace_record(TraceStage::Parse, 20, 130, 140),
+        trace_record(TraceStage::Match, 20, 171, 180),
+        trace_record(TraceStage::EventPublish, 20, 180, 185, 4, 1),
+        trace_record(TraceStage::Parse, 10, 190, 200),
+        trace_record(TraceStage::Match, 10, 205, 210),
+        trace_record(TraceStage::EventPublish, 10, 210, 212, 5, 1),
+        // Dispatch of the add's events after the cancel was parsed
+        trace_record(TraceStage::PublisherDispatch, 10, 215, 220, 1, 1),
+        trace_record(TraceStage::PublisherDispatch, 10, 220, 224, 3, 1),
+        trace_record(TraceStage::PublisherDispatch, 20, 224, 226, 4, 1),
+        trace_record(TraceStage::PublisherDispatch, 10, 226, 230, 5, 1),
+    };
+    const auto traces = hft::reconstruct_order_traces(records);
+    ASSERT_EQ(traces.size(), 3u);
+
+    const hft::OrderTrace& add = traces[0];
+    EXPECT_EQ(add.order_id, 10u);
+    EXPECT_EQ(add.ticks(TraceStage::Parse), 10u);
+    EXPECT_EQ(add.ticks(TraceStage::GatewayValidate), 5u);
+    EXPECT_EQ(add.ticks(TraceStage::Match), 33u);
+    EXPECT_EQ(add.ticks(TraceStage::PublisherDispatch), 9u);
+    EXPECT_EQ(add.events_dispatched, 2u);
+    EXPECT_EQ(add.total_ticks(), 124u);   // 100 .. 224
+    EXPECT_EQ(add.queue_ticks(), 124u - 10 - 5 - 2 - 33 - 10 - 9);
+
+    EXPECT_EQ(traces[1].order_id, 20u);
+    EXPECT_FALSE(traces[1].has(TraceStage::PoolAllocate));
+    EXPECT_EQ(traces[1].events_dispatched, 1u);
+
+    const hft::OrderTrace& cancel = traces[2];
+    EXPECT_EQ(cancel.order_id, 10u);
+    EXPECT_EQ(cancel.ticks(TraceStage::PublisherDispatch), 4u);
+    EXPECT_EQ(cancel.total_ticks(), 40u);   // 190 .. 230
+
+    const hft::TraceSummary summary = hft::summarize_order_traces(traces, 1.0);
+    EXPECT_EQ(summary.orders, 3u);
+    EXPECT_EQ(summary.stages[static_cast<size_t>(TraceStage::Parse)].sample_count, 3u);
+    EXPECT_EQ(summary.stages[static_cast<size_t>(TraceStage::PoolAllocate)].sample_count, 1u);
+    EXPECT_DOUBLE_EQ(summary.total.max_ns, 124.0);
+}
+
+// ===========================================================================
+// Thread placement
+// ===========================================================================
+
+TEST(ThreadPlacement, CpuForRoleAndIndex) {
+    hft::ThreadingConfig config;
+    EXPECT_FALSE(config.any());
+    config.matching_cpus = {2, 3};
+    config.publisher_cpus = {5};
+    EXPECT_TRUE(config.any());
+    EXPECT_EQ(config.cpu_for(hft::ThreadRole::Matching, 0), 2);
+    EXPECT_EQ(config.cpu_for(hft::ThreadRole::Matching, 1), 3);
+    EXPECT_EQ(config.cpu_for(hft::ThreadRole::Matching, 2), -1);  // Unpinned shard
+    EXPECT_EQ(config.cpu_for(hft::ThreadRole::Publisher), 5);
+    EXPECT_EQ(config.cpu_for(hft::ThreadRole::Journal), -1);
+}
+
+TEST(ThreadPlacement, PinsRestoresAndReports) {
+    hft::clear_thread_topology();
+    hft::ThreadingConfig config;
+    config.matching_cpus = {0};
+    config.journal_cpus = {1000};  // No such CPU
+
+    bool pinned = false;
+    bool bogus_pinned = true;
+    std::thread worker([&] {
+        {
+            hft::ScopedThreadPlacement placement(config, hft::ThreadRole::Matching);
+            pinned = placement.pinned();
+#if defined(__linux__)
+            EXPECT_EQ(sched_getcpu(), 0);
+#endif
+        }
+        hft::ScopedThreadPlacement bogus(config, hft::ThreadRole::Journal);
+        bogus_pinned = bogus.pinned();
+    });
+    worker.join();
+
+    auto records = hft::thread_topology_records();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].role, hft::ThreadRole::Matching);
+    EXPECT_EQ(records[0].requested_cpu, 0);
+    EXPECT_FALSE(bogus_pinned);
+    std::string report = hft::thread_topology_report();
+    EXPECT_NE(report.find("journal[0]"), std::string::npos);
+    EXPECT_NE(report.find("cpu 1000 (FAILED)"), std::string::npos);
+#if defined(__linux__)
+    EXPECT_TRUE(pinned);
+    EXPECT_NE(report.find("matching[0]"), std::string::npos);
+#endif
+    hft::clear_thread_topology();
+}
+
+// ===========================================================================
+// Hardware performance counters
+// ===========================================================================
+
+TEST(PerfCounters, SampleNormalisation) {
+    hft::PerfSample sample;
+    EXPECT_TRUE(sample.empty());
+    EXPECT_EQ(sample.ipc(), 0.0);
+
+    sample.counts[static_cast<size_t>(hft::PerfEvent::Cycles)] = 4000;
+    sample.counts[static_cast<size_t>(hft::PerfEvent::Instructions)] = 10000;
+    sample.counts[static_cast<size_t>(hft::PerfEvent::L1DMisses)] = 30;
+    sample.available = (1u << static_cast<unsigned>(hft::PerfEvent::Cycles)) |
+                       (1u << static_cast<unsigned>(hft::PerfEvent::L1DMisses));
+    EXPECT_TRUE(sample.has(hft::PerfEvent::Cycles));
+    EXPECT_FALSE(sample.has(hft::PerfEvent::Instructions));
+    EXPECT_EQ(sample.ipc(), 0.0);  // Instructions not counted
+    EXPECT_DOUBLE_EQ(sample.per_op(hft::PerfEvent::Cycles, 100), 40.0);
+    EXPECT_DOUBLE_EQ(sample.per_op(hft::PerfEvent::L1DMisses, 100), 0.3);
+    EXPECT_EQ(sample.per_op(hft::PerfEvent::Cycles, 0), 0.0);
+
+    sample.available |= 1u << static_cast<unsigned>(hft::PerfEvent::Instructions);
+    EXPECT_DOUBLE_EQ(sample.ipc(), 2.5);
+}
+
+TEST(PerfCounters, CountsRegionOrExplainsWhyNot) {
+    hft::PerfCounterGroup counters;
+    counters.start();
+    volatile uint64_t sink = 0;
+    for (uint64_t i = 0; i < 100'000; ++i) sink = sink + i;
+    counters.pause();
+    for (uint64_t i = 0; i < 100'000; ++i) sink = sink + i;
+    counters.resume();
+    const hft::PerfSample sample = counters.stop();
+
+    if (!counters.available()) {
+        // No PMU (VM, container) or perf_event_paranoid too strict
+        EXPECT_FALSE(counters.error().empty());
+        EXPECT_TRUE(sample.empty());
+        GTEST_SKIP() << counters.error();
+    }
+    EXPECT_FALSE(sample.empty());
+    if (sample.has(hft::PerfEvent::Instructions)) {
+        // At least the counted loop's adds; not both loops' worth
+        EXPECT_GT(sample[hft::PerfEvent::Instructions], 100'000u);
+        EXPECT_LT(sample[hft::PerfEvent::Instructions], 100'000'000u);
+    }
+}